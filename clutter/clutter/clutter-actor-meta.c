@@ -42,6 +42,8 @@
 
 #include "clutter/clutter-actor-meta-private.h"
 
+#include "clutter/clutter-action.h"
+#include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-private.h"
 
@@ -325,6 +327,9 @@ clutter_actor_meta_set_enabled (ClutterActorMeta *meta,
     return;
 
   CLUTTER_ACTOR_META_GET_CLASS (meta)->set_enabled (meta, is_enabled);
+
+  if (CLUTTER_IS_ACTION (meta))
+    clutter_actor_invalidate_event_chains ();
 }
 
 /**
@@ -300,4 +300,28 @@ const GList * clutter_actor_peek_actions (ClutterActor *self);
 void clutter_actor_set_implicitly_grabbed (ClutterActor *actor,
                                            gboolean      is_implicitly_grabbed);
 
+AtkObject * clutter_actor_peek_accessible (ClutterActor *self);
+
+void clutter_actor_invalidate_event_chains (void);
+
+unsigned int clutter_actor_get_event_chain_age (void);
+
+void clutter_actor_set_animated_property (ClutterActor *self,
+                                          GParamSpec   *pspec,
+                                          const GValue *value);
+
+typedef struct _ClutterStagePointTransform
+{
+  double st[3][3];
+} ClutterStagePointTransform;
+
+gboolean clutter_actor_get_stage_point_transform (ClutterActor               *self,
+                                                  ClutterStagePointTransform *transform);
+
+void clutter_stage_point_transform_apply (const ClutterStagePointTransform *transform,
+                                          float                             x,
+                                          float                             y,
+                                          float                            *x_out,
+                                          float                            *y_out);
+
 G_END_DECLS
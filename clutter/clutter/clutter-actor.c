@@ -492,6 +492,8 @@
 #include "clutter/clutter-action-private.h"
 #include "clutter/clutter-actor-meta-private.h"
 #include "clutter/clutter-animatable.h"
+#include "clutter/clutter-bin-layout.h"
+#include "clutter/clutter-box-layout.h"
 #include "clutter/clutter-color-state.h"
 #include "clutter/clutter-constraint-private.h"
 #include "clutter/clutter-content-private.h"
@@ -501,6 +503,8 @@
 #include "clutter/clutter-enum-types.h"
 #include "clutter/clutter-fixed-layout.h"
 #include "clutter/clutter-flatten-effect.h"
+#include "clutter/clutter-flow-layout.h"
+#include "clutter/clutter-grid-layout.h"
 #include "clutter/clutter-interval.h"
 #include "clutter/clutter-main.h"
 #include "clutter/clutter-marshal.h"
@@ -543,49 +547,45 @@ typedef enum
  * will ask for 3 different preferred size in each allocation cycle */
 #define N_CACHED_SIZE_REQUESTS 3
 
-struct _ClutterActorPrivate
+/* The paint nodes created for the clip and transform of an actor when
+ * it was last painted, reused as long as neither changes */
+typedef struct _RetainedPaintNodes
 {
-  ClutterContext *context;
-
-  /* Accessibility */
-  AtkObject *accessible;
-  gchar *accessible_name;
-
-  /* request mode */
-  ClutterRequestMode request_mode;
+  ClutterPaintNode *root_node;
+  /* Owned by root_node, or root_node itself */
+  ClutterPaintNode *actor_node;
 
-  /* our cached size requests for different width / height */
-  SizeRequest width_requests[N_CACHED_SIZE_REQUESTS];
-  SizeRequest height_requests[N_CACHED_SIZE_REQUESTS];
-
-  /* An age of 0 means the entry is not set */
-  guint cached_height_age;
-  guint cached_width_age;
-
-  /* the bounding box of the actor, relative to the parent's
-   * allocation
-   */
-  ClutterActorBox allocation;
-
-  /* clip, in actor coordinates */
-  graphene_rect_t clip;
+  gboolean has_clip;
+  ClutterActorBox clip;
 
-  /* the cached transformation matrix; see apply_transform() */
+  gboolean has_transform;
   graphene_matrix_t transform;
+} RetainedPaintNodes;
 
-  graphene_matrix_t stage_relative_modelview;
-
-  float resource_scale;
-
-  guint8 opacity;
-  gint opacity_override;
-  unsigned int inhibit_culling_counter;
+/* The model an actor is bound to with clutter_actor_bind_model() */
+typedef struct _ChildModelBinding
+{
+  GListModel *model;
+  ClutterActorCreateChildFunc create_child_func;
+  gpointer create_child_data;
+  GDestroyNotify create_child_notify;
+} ChildModelBinding;
 
-  ClutterOffscreenRedirect offscreen_redirect;
+/* The Pango context of an actor, created on demand by
+ * clutter_actor_get_pango_context() */
+typedef struct _ActorPangoContext
+{
+  PangoContext *context;
+  gulong resolution_changed_id;
+  gulong font_changed_id;
+} ActorPangoContext;
 
-  /* This is an internal effect used to implement the
-     offscreen-redirect property */
-  ClutterEffect *flatten_effect;
+struct _ClutterActorPrivate
+{
+  /* State used on every paint and pick traversal comes first, so that
+   * walking the scene graph touches as few cache lines as possible;
+   * rarely used state is either at the end, or lazily allocated.
+   */
 
   /* scene graph */
   ClutterActor *parent;
@@ -596,50 +596,56 @@ struct _ClutterActorPrivate
 
   gint n_children;
 
-  /* tracks whenever the children of an actor are changed; the
-   * age is incremented by 1 whenever an actor is added or
-   * removed. the age is not incremented when the first or the
-   * last child pointers are changed, or when grandchildren of
-   * an actor are changed.
-   */
-  gint age;
-
-  gchar *name; /* a non-unique name, used for debugging */
+  guint8 opacity;
+  gint opacity_override;
+  unsigned int inhibit_culling_counter;
+  guint unmapped_paint_branch_counter;
 
-  /* a back-pointer to the Pango context that we can use
-   * to create pre-configured PangoLayout
+  /* whether the actor is inside a cloned branch; this
+   * value is propagated to all the actor's children
    */
-  PangoContext *pango_context;
+  gulong in_cloned_branch;
 
-  /* the text direction configured for this child - either by
-   * application code, or by the actor's parent
+  /* the bounding box of the actor, relative to the parent's
+   * allocation
    */
-  ClutterTextDirection text_direction;
+  ClutterActorBox allocation;
 
-  /* meta classes */
-  ClutterMetaGroup *actions;
-  ClutterMetaGroup *constraints;
-  ClutterMetaGroup *effects;
+  /* clip, in actor coordinates */
+  graphene_rect_t clip;
 
-  /* delegate object used to allocate the children of this actor */
-  ClutterLayoutManager *layout_manager;
+  ClutterMetaGroup *effects;
 
   /* delegate object used to paint the contents of this actor */
   ClutterContent *content;
 
-  ClutterActorBox content_box;
-  ClutterContentGravity content_gravity;
-  ClutterScalingFilter min_filter;
-  ClutterScalingFilter mag_filter;
-  ClutterContentRepeat content_repeat;
+  RetainedPaintNodes *retained_paint_nodes;
+
+  /* the cached transformation matrix; see apply_transform() */
+  graphene_matrix_t transform;
+
+  graphene_matrix_t stage_relative_modelview;
+
+  /* The paint volume of the actor when it was last drawn to the screen,
+   * stored in absolute coordinates.
+   */
+  ClutterPaintVolume visible_paint_volume;
+
+  ClutterPaintVolume paint_volume;
+
+  ClutterContext *context;
+
+  float resource_scale;
+
+  ClutterOffscreenRedirect offscreen_redirect;
+
+  /* This is an internal effect used to implement the
+     offscreen-redirect property */
+  ClutterEffect *flatten_effect;
 
   /* used when painting, to update the paint volume */
   ClutterEffect *current_effect;
 
-  /* color state contains properties like colorspace for
-   * each clutter actor */
-  ClutterColorState *color_state;
-
   /* This is used to store an effect which needs to be redrawn. A
      redraw can be queued to start from a particular effect. This is
      used by parametrised effects that can cache an image of the
@@ -654,44 +660,74 @@ struct _ClutterActorPrivate
      the list of effects that is next in the chain */
   const GList *next_effect_to_paint;
 
-  ClutterPaintVolume paint_volume;
+  CoglColor bg_color;
 
-  /* The paint volume of the actor when it was last drawn to the screen,
-   * stored in absolute coordinates.
-   */
-  ClutterPaintVolume visible_paint_volume;
+  ClutterActorBox content_box;
+  ClutterContentGravity content_gravity;
+  ClutterScalingFilter min_filter;
+  ClutterScalingFilter mag_filter;
+  ClutterContentRepeat content_repeat;
 
-  CoglColor bg_color;
+  /* color state contains properties like colorspace for
+   * each clutter actor */
+  ClutterColorState *color_state;
 
-  /* a string used for debugging messages */
-  char *debug_name;
+  GList *stage_views;
 
-  /* a set of clones of the actor */
-  GHashTable *clones;
+  GArray *next_redraw_clips;
 
-  /* whether the actor is inside a cloned branch; this
-   * value is propagated to all the actor's children
-   */
-  gulong in_cloned_branch;
+  /* request mode */
+  ClutterRequestMode request_mode;
 
-  guint unmapped_paint_branch_counter;
+  /* our cached size requests for different width / height */
+  SizeRequest width_requests[N_CACHED_SIZE_REQUESTS];
+  SizeRequest height_requests[N_CACHED_SIZE_REQUESTS];
 
-  GListModel *child_model;
-  ClutterActorCreateChildFunc create_child_func;
-  gpointer create_child_data;
-  GDestroyNotify create_child_notify;
+  /* An age of 0 means the entry is not set */
+  guint cached_height_age;
+  guint cached_width_age;
 
-  gulong resolution_changed_id;
-  gulong font_changed_id;
+  /* delegate object used to allocate the children of this actor */
+  ClutterLayoutManager *layout_manager;
   gulong layout_changed_id;
 
-  GList *stage_views;
+  /* meta classes */
+  ClutterMetaGroup *actions;
+  ClutterMetaGroup *constraints;
+
+  /* tracks whenever the children of an actor are changed; the
+   * age is incremented by 1 whenever an actor is added or
+   * removed. the age is not incremented when the first or the
+   * last child pointers are changed, or when grandchildren of
+   * an actor are changed.
+   */
+  gint age;
+
+  /* the text direction configured for this child - either by
+   * application code, or by the actor's parent
+   */
+  ClutterTextDirection text_direction;
+
+  /* a set of clones of the actor */
+  GHashTable *clones;
+
   GList *grabs;
 
   unsigned int n_pointers;
   unsigned int implicitly_grabbed_count;
 
-  GArray *next_redraw_clips;
+  gchar *name; /* a non-unique name, used for debugging */
+
+  /* a string used for debugging messages */
+  char *debug_name;
+
+  /* Accessibility */
+  AtkObject *accessible;
+  gchar *accessible_name;
+
+  ActorPangoContext *pango_context;
+
+  ChildModelBinding *child_model_binding;
 
   /* bitfields: KEEP AT THE END */
 
@@ -974,6 +1010,8 @@ static void pop_in_paint_unmapped_branch (ClutterActor *self,
                                           guint         count);
 
 static void clutter_actor_update_devices (ClutterActor *self);
+static void clutter_actor_real_pick (ClutterActor       *self,
+                                     ClutterPickContext *pick_context);
 
 static void clutter_actor_set_color_state_internal (ClutterActor      *self,
                                                     ClutterColorState *color_state);
@@ -1161,6 +1199,52 @@ clutter_actor_pick_box (ClutterActor          *self,
   clutter_pick_context_log_pick (pick_context, box, self);
 }
 
+/* Whether a change to the geometry or visibility of @self can change
+ * the result of a reactive pick. Non-reactive leaf actors using the
+ * default pick never end up in a reactive pick stack, so animating
+ * them must not throw away the pick stacks cached by the stage.
+ */
+static gboolean
+clutter_actor_may_affect_pick (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (clutter_actor_get_reactive (self))
+    return TRUE;
+
+  if (priv->n_children > 0)
+    return TRUE;
+
+  if (priv->effects != NULL)
+    return TRUE;
+
+  return CLUTTER_ACTOR_GET_CLASS (self)->pick != clutter_actor_real_pick;
+}
+
+/**
+ * clutter_actor_invalidate_pick:
+ * @self: a #ClutterActor
+ *
+ * Drops the pick stacks the stage of @self keeps between frames.
+ *
+ * Actors overriding [vfunc@Clutter.Actor.pick] must call this when
+ * something other than their allocation, transform, clip or mapped
+ * state changes what they log to the pick context.
+ */
+void
+clutter_actor_invalidate_pick (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL || CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return;
+
+  clutter_stage_invalidate_pick (CLUTTER_STAGE (stage));
+}
+
 static void
 clutter_actor_set_mapped (ClutterActor *self,
                           gboolean      mapped)
@@ -1184,6 +1268,9 @@ clutter_actor_set_mapped (ClutterActor *self,
     }
 
   CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_MAP_UNMAP);
+
+  if (clutter_actor_may_affect_pick (self))
+    clutter_actor_invalidate_pick (self);
 }
 
 /* this function updates the mapped and realized states according to
@@ -1459,7 +1546,7 @@ clutter_actor_real_map (ClutterActor *self)
    */
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MAPPED]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible && !clutter_actor_is_painting_unmapped (self))
     atk_object_notify_state_change (accessible,
                                     ATK_STATE_SHOWING,
@@ -1596,7 +1683,7 @@ clutter_actor_real_unmap (ClutterActor *self)
    */
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MAPPED]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible && !clutter_actor_is_painting_unmapped (self))
     atk_object_notify_state_change (accessible,
                                     ATK_STATE_SHOWING,
@@ -1773,7 +1860,7 @@ clutter_actor_show (ClutterActor *self)
   g_signal_emit (self, actor_signals[SHOW], 0);
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_VISIBLE]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible)
     atk_object_notify_state_change (accessible,
                                     ATK_STATE_VISIBLE,
@@ -1871,7 +1958,7 @@ clutter_actor_hide (ClutterActor *self)
   g_signal_emit (self, actor_signals[HIDE], 0);
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_VISIBLE]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible)
     atk_object_notify_state_change (accessible,
                                     ATK_STATE_VISIBLE,
@@ -2372,6 +2459,45 @@ absolute_geometry_changed_cb (ClutterActor *actor,
   return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
 }
 
+/*< private >
+ * get_redirect_effect:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the first effect of the actor if it redirects the actor
+ * offscreen, or the flatten effect otherwise. Offscreen effects keep the
+ * contents of the actor in its own coordinate space and at full opacity,
+ * so their cached image stays valid when only the opacity or the
+ * transformation of the actor changes.
+ */
+static ClutterEffect *
+get_redirect_effect (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->effects != NULL)
+    {
+      const GList *effects;
+
+      effects = _clutter_meta_group_peek_metas (priv->effects);
+      if (effects != NULL && CLUTTER_IS_OFFSCREEN_EFFECT (effects->data))
+        return effects->data;
+    }
+
+  return priv->flatten_effect;
+}
+
+static void
+queue_redraw_for_transform (ClutterActor *self)
+{
+  /* Queue a redraw from the redirect effect so that it can paint its
+     cached image with the new transformation instead of having to
+     redraw the actual actor. If there is no such effect then this is
+     equivalent to queueing a full redraw */
+  _clutter_actor_queue_redraw_full (self,
+                                    NULL, /* clip */
+                                    get_redirect_effect (self));
+}
+
 static void
 transform_changed (ClutterActor *actor)
 {
@@ -2386,6 +2512,10 @@ transform_changed (ClutterActor *actor)
                            NULL,
                            NULL);
 
+  if (clutter_actor_is_mapped (actor) &&
+      clutter_actor_may_affect_pick (actor))
+    clutter_actor_invalidate_pick (actor);
+
   if (!clutter_actor_has_transitions (actor) &&
       !CLUTTER_ACTOR_IN_RELAYOUT (actor))
     clutter_actor_update_devices (actor);
@@ -3184,6 +3314,22 @@ _clutter_actor_paint_cull_result (ClutterActor      *self,
 
 static int clone_paint_level = 0;
 
+/* Incremented whenever a change may affect the actors and actions an
+ * event is emitted to, see clutter_actor_collect_event_actors() */
+static unsigned int event_chain_age = 0;
+
+void
+clutter_actor_invalidate_event_chains (void)
+{
+  event_chain_age++;
+}
+
+unsigned int
+clutter_actor_get_event_chain_age (void)
+{
+  return event_chain_age;
+}
+
 void
 _clutter_actor_push_clone_paint (void)
 {
@@ -3275,6 +3421,9 @@ _clutter_actor_add_effect_internal (ClutterActor  *self,
     }
 
   _clutter_meta_group_add_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+
+  if (clutter_actor_is_mapped (self))
+    clutter_actor_invalidate_pick (self);
 }
 
 /* This is the same as clutter_actor_remove_effect except that it doesn't
@@ -3288,10 +3437,47 @@ _clutter_actor_remove_effect_internal (ClutterActor  *self,
   if (priv->effects == NULL)
     return;
 
-  _clutter_meta_group_remove_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+  _clutter_meta_group_remove_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+
+  if (clutter_actor_is_mapped (self))
+    clutter_actor_invalidate_pick (self);
+
+  if (_clutter_meta_group_peek_metas (priv->effects) == NULL)
+    g_clear_object (&priv->effects);
+}
+
+static gboolean
+is_painted_multiple_times (ClutterActor *self)
+{
+  ClutterActor *actor;
+  int n_paints;
+
+  if (self->priv->in_cloned_branch == 0)
+    return FALSE;
+
+  n_paints = clutter_actor_is_mapped (self) ? 1 : 0;
+
+  for (actor = self; actor; actor = actor->priv->parent)
+    {
+      if (actor->priv->clones)
+        {
+          GHashTableIter iter;
+          gpointer key;
+
+          g_hash_table_iter_init (&iter, actor->priv->clones);
+          while (g_hash_table_iter_next (&iter, &key, NULL))
+            {
+              if (clutter_actor_is_mapped (key) && ++n_paints > 1)
+                return TRUE;
+            }
+        }
+
+      /* See clutter_actor_has_mapped_clones() */
+      if (!clutter_actor_is_visible (actor))
+        return FALSE;
+    }
 
-  if (_clutter_meta_group_peek_metas (priv->effects) == NULL)
-    g_clear_object (&priv->effects);
+  return FALSE;
 }
 
 static gboolean
@@ -3318,6 +3504,14 @@ needs_flatten_effect (ClutterActor *self)
         return TRUE;
     }
 
+  /* Painting the actor into an offscreen once and reusing the image for
+   * every other paint in the frame, e.g. by clones, turns each of those
+   * into a single textured quad.
+   */
+  if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_FOR_CLONES &&
+      is_painted_multiple_times (self))
+    return TRUE;
+
   return FALSE;
 }
 
@@ -3432,6 +3626,83 @@ clutter_actor_paint_node (ClutterActor        *actor,
   return TRUE;
 }
 
+static void
+retained_paint_nodes_free (RetainedPaintNodes *retained_paint_nodes)
+{
+  clutter_paint_node_unref (retained_paint_nodes->root_node);
+  g_free (retained_paint_nodes);
+}
+
+static gboolean
+can_retain_paint_nodes (void)
+{
+  /* These debug modes add children to the actor node while painting */
+  return !(clutter_paint_debug_flags & (CLUTTER_DEBUG_REDRAWS |
+                                        CLUTTER_DEBUG_PAINT_VOLUMES));
+}
+
+static gboolean
+can_reuse_paint_nodes (ClutterActor            *self,
+                       gboolean                 has_clip,
+                       const ClutterActorBox   *clip,
+                       gboolean                 has_transform,
+                       const graphene_matrix_t *transform)
+{
+  RetainedPaintNodes *retained_paint_nodes = self->priv->retained_paint_nodes;
+
+  if (!retained_paint_nodes)
+    return FALSE;
+
+  if (!can_retain_paint_nodes ())
+    return FALSE;
+
+  /* Still being painted further up the stack, e.g. by a clone */
+  if (g_atomic_int_get (&retained_paint_nodes->root_node->ref_count) > 1)
+    return FALSE;
+
+  if (retained_paint_nodes->has_clip != has_clip ||
+      (has_clip && !clutter_actor_box_equal (&retained_paint_nodes->clip, clip)))
+    return FALSE;
+
+  if (retained_paint_nodes->has_transform != has_transform ||
+      (has_transform &&
+       !graphene_matrix_equal_fast (&retained_paint_nodes->transform,
+                                    transform)))
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+retain_paint_nodes (ClutterActor            *self,
+                    ClutterPaintNode        *root_node,
+                    ClutterPaintNode        *actor_node,
+                    gboolean                 has_clip,
+                    const ClutterActorBox   *clip,
+                    gboolean                 has_transform,
+                    const graphene_matrix_t *transform)
+{
+  ClutterActorPrivate *priv = self->priv;
+  RetainedPaintNodes *retained_paint_nodes;
+
+  g_clear_pointer (&priv->retained_paint_nodes, retained_paint_nodes_free);
+
+  if (!can_retain_paint_nodes ())
+    return;
+
+  retained_paint_nodes = g_new0 (RetainedPaintNodes, 1);
+  retained_paint_nodes->root_node = clutter_paint_node_ref (root_node);
+  retained_paint_nodes->actor_node = actor_node;
+  retained_paint_nodes->has_clip = has_clip;
+  if (has_clip)
+    retained_paint_nodes->clip = *clip;
+  retained_paint_nodes->has_transform = has_transform;
+  if (has_transform)
+    retained_paint_nodes->transform = *transform;
+
+  priv->retained_paint_nodes = retained_paint_nodes;
+}
+
 /**
  * clutter_actor_paint:
  * @self: A #ClutterActor
@@ -3458,8 +3729,10 @@ clutter_actor_paint (ClutterActor        *self,
   g_autoptr (ClutterPaintNode) root_node = NULL;
   ClutterActorPrivate *priv;
   ClutterActorBox clip;
+  graphene_matrix_t transform;
   gboolean culling_inhibited;
   gboolean clip_set = FALSE;
+  gboolean transform_set = FALSE;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
@@ -3496,9 +3769,6 @@ clutter_actor_paint (ClutterActor        *self,
     }
 #endif
 
-  actor_node = clutter_actor_node_new (self, -1);
-  root_node = clutter_paint_node_ref (actor_node);
-
   if (priv->has_clip)
     {
       clip.x1 = priv->clip.origin.x;
@@ -3516,33 +3786,10 @@ clutter_actor_paint (ClutterActor        *self,
       clip_set = TRUE;
     }
 
-  if (clip_set)
-    {
-      ClutterPaintNode *clip_node;
-
-      clip_node = clutter_clip_node_new ();
-      clutter_paint_node_add_rectangle (clip_node, &clip);
-      clutter_paint_node_add_child (clip_node, root_node);
-      clutter_paint_node_unref (root_node);
-
-      root_node = g_steal_pointer (&clip_node);
-    }
-
   if (priv->enable_model_view_transform)
     {
-      ClutterPaintNode *transform_node;
-      graphene_matrix_t transform;
-
       clutter_actor_get_transform (self, &transform);
-
-      if (!graphene_matrix_is_identity (&transform))
-        {
-          transform_node = clutter_transform_node_new (&transform);
-          clutter_paint_node_add_child (transform_node, root_node);
-          clutter_paint_node_unref (root_node);
-
-          root_node = g_steal_pointer (&transform_node);
-        }
+      transform_set = !graphene_matrix_is_identity (&transform);
 
 #ifdef CLUTTER_ENABLE_DEBUG
       /* Catch when out-of-band transforms have been made by actors not as part
@@ -3581,6 +3828,48 @@ clutter_actor_paint (ClutterActor        *self,
 #endif /* CLUTTER_ENABLE_DEBUG */
     }
 
+  if (can_reuse_paint_nodes (self,
+                             clip_set, &clip,
+                             transform_set, &transform))
+    {
+      actor_node =
+        clutter_paint_node_ref (priv->retained_paint_nodes->actor_node);
+      root_node =
+        clutter_paint_node_ref (priv->retained_paint_nodes->root_node);
+    }
+  else
+    {
+      actor_node = clutter_actor_node_new (self, -1);
+      root_node = clutter_paint_node_ref (actor_node);
+
+      if (clip_set)
+        {
+          ClutterPaintNode *clip_node;
+
+          clip_node = clutter_clip_node_new ();
+          clutter_paint_node_add_rectangle (clip_node, &clip);
+          clutter_paint_node_add_child (clip_node, root_node);
+          clutter_paint_node_unref (root_node);
+
+          root_node = g_steal_pointer (&clip_node);
+        }
+
+      if (transform_set)
+        {
+          ClutterPaintNode *transform_node;
+
+          transform_node = clutter_transform_node_new (&transform);
+          clutter_paint_node_add_child (transform_node, root_node);
+          clutter_paint_node_unref (root_node);
+
+          root_node = g_steal_pointer (&transform_node);
+        }
+
+      retain_paint_nodes (self, root_node, actor_node,
+                          clip_set, &clip,
+                          transform_set, &transform);
+    }
+
   /* We check whether we need to add the flatten effect before
    * each paint so that we can avoid having a mechanism for
    * applications to notify when the value of the
@@ -3998,6 +4287,13 @@ clutter_actor_remove_child_internal (ClutterActor                 *self,
   if (stop_transitions)
     _clutter_actor_stop_transitions (child);
 
+  /* Removing a mapped child without unmapping it means it's being
+   * re-added at a different depth, which changes the pick order.
+   */
+  if (clutter_actor_is_mapped (child) &&
+      clutter_actor_may_affect_pick (child))
+    clutter_actor_invalidate_pick (child);
+
   if (check_state)
     {
       /* we need to unrealize *before* we set parent_actor to NULL,
@@ -4019,6 +4315,8 @@ clutter_actor_remove_child_internal (ClutterActor                 *self,
 
   self->priv->age += 1;
 
+  clutter_actor_invalidate_event_chains ();
+
   if (self->priv->in_cloned_branch)
     clutter_actor_pop_in_cloned_branch (child, self->priv->in_cloned_branch);
 
@@ -4183,7 +4481,7 @@ clutter_actor_set_pivot_point_internal (ClutterActor           *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 }
 
 static inline void
@@ -4199,7 +4497,7 @@ clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 }
 
 /*< private >
@@ -4231,7 +4529,7 @@ clutter_actor_set_translation_internal (ClutterActor *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
   g_object_notify_by_pspec (obj, pspec);
 }
 
@@ -4360,7 +4658,7 @@ clutter_actor_set_rotation_angle_internal (ClutterActor *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), pspec);
 }
@@ -4481,7 +4779,7 @@ clutter_actor_set_scale_factor_internal (ClutterActor *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
   g_object_notify_by_pspec (obj, pspec);
 }
 
@@ -4538,6 +4836,7 @@ clutter_actor_set_clip_rect (ClutterActor          *self,
 
   queue_update_paint_volume (self);
   clutter_actor_queue_redraw (self);
+  clutter_actor_invalidate_pick (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
   g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
@@ -5354,28 +5653,33 @@ clutter_actor_dispose (GObject *object)
       g_assert (!clutter_actor_is_realized (self));
     }
 
-  g_clear_signal_handler (&priv->resolution_changed_id, backend);
-  g_clear_signal_handler (&priv->font_changed_id, backend);
-
   g_clear_pointer (&priv->accessible_name, g_free);
 
-  g_clear_object (&priv->pango_context);
+  if (priv->pango_context != NULL)
+    {
+      g_clear_signal_handler (&priv->pango_context->resolution_changed_id,
+                              backend);
+      g_clear_signal_handler (&priv->pango_context->font_changed_id,
+                              backend);
+      g_clear_object (&priv->pango_context->context);
+      g_clear_pointer (&priv->pango_context, g_free);
+    }
+
   g_clear_object (&priv->actions);
   g_clear_object (&priv->color_state);
   g_clear_object (&priv->constraints);
   g_clear_object (&priv->effects);
   g_clear_object (&priv->flatten_effect);
 
-  if (priv->child_model != NULL)
+  if (priv->child_model_binding != NULL)
     {
-      if (priv->create_child_notify != NULL)
-        priv->create_child_notify (priv->create_child_data);
+      ChildModelBinding *binding = priv->child_model_binding;
 
-      priv->create_child_func = NULL;
-      priv->create_child_data = NULL;
-      priv->create_child_notify = NULL;
+      if (binding->create_child_notify != NULL)
+        binding->create_child_notify (binding->create_child_data);
 
-      g_clear_object (&priv->child_model);
+      g_clear_object (&binding->model);
+      g_clear_pointer (&priv->child_model_binding, g_free);
     }
 
   if (priv->layout_manager != NULL)
@@ -5394,6 +5698,7 @@ clutter_actor_dispose (GObject *object)
   g_clear_pointer (&priv->clones, g_hash_table_unref);
   g_clear_pointer (&priv->stage_views, g_list_free);
   g_clear_pointer (&priv->next_redraw_clips, g_array_unref);
+  g_clear_pointer (&priv->retained_paint_nodes, retained_paint_nodes_free);
 
   G_OBJECT_CLASS (clutter_actor_parent_class)->dispose (object);
 }
@@ -5474,6 +5779,32 @@ clutter_actor_real_get_accessible (ClutterActor *actor)
   return priv->accessible;
 }
 
+/*
+ * clutter_actor_peek_accessible:
+ * @self: a #ClutterActor
+ *
+ * Returns the accessible object of @self if it has been created already.
+ *
+ * An accessible object that doesn't exist yet can't have been seen by
+ * an assistive technology, so state changes don't need to be announced
+ * for it, and it will pick up the current state when created. Lazily
+ * creating accessible objects only when they are asked for keeps actors
+ * free of accessibility overhead until an assistive technology looks at
+ * them.
+ *
+ * Actors implementing #ClutterActorClass.get_accessible() can't be
+ * peeked, and get their accessible object created as before.
+ */
+AtkObject *
+clutter_actor_peek_accessible (ClutterActor *self)
+{
+  if (CLUTTER_ACTOR_GET_CLASS (self)->get_accessible !=
+      clutter_actor_real_get_accessible)
+    return clutter_actor_get_accessible (self);
+
+  return self->priv->accessible;
+}
+
 static AtkObject *
 _clutter_actor_ref_accessible (AtkImplementor *implementor)
 {
@@ -8707,6 +9038,58 @@ clutter_actor_adjust_allocation (ClutterActor    *self,
   *allocation = adj_allocation;
 }
 
+/* The layout managers shipped with Clutter allocate the children only
+ * from their own state, the size of the container and the requests of
+ * the children; subclasses might not */
+static gboolean
+layout_manager_is_pure (ClutterLayoutManager *layout_manager)
+{
+  GType layout_type;
+
+  if (layout_manager == NULL)
+    return TRUE;
+
+  layout_type = G_OBJECT_TYPE (layout_manager);
+
+  return (layout_type == CLUTTER_TYPE_BIN_LAYOUT ||
+          layout_type == CLUTTER_TYPE_BOX_LAYOUT ||
+          layout_type == CLUTTER_TYPE_FIXED_LAYOUT ||
+          layout_type == CLUTTER_TYPE_FLOW_LAYOUT ||
+          layout_type == CLUTTER_TYPE_GRID_LAYOUT);
+}
+
+/*< private >
+ * can_skip_children_allocation:
+ * @self: a #ClutterActor
+ * @allocation: the new allocation of @self
+ *
+ * Checks whether the subtree of @self is independent from where @self
+ * is placed, so that moving it doesn't need its children to be laid
+ * out again. This is the case when no relayout was queued inside the
+ * subtree, the size didn't change and the children are allocated by
+ * a pure layout manager, as the children boxes are relative to @self.
+ */
+static gboolean
+can_skip_children_allocation (ClutterActor          *self,
+                              const ClutterActorBox *allocation)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->needs_allocation)
+    return FALSE;
+
+  if (CLUTTER_ACTOR_GET_CLASS (self)->allocate != clutter_actor_real_allocate)
+    return FALSE;
+
+  if (!layout_manager_is_pure (priv->layout_manager))
+    return FALSE;
+
+  return (clutter_actor_box_get_width (&priv->allocation) ==
+          clutter_actor_box_get_width (allocation) &&
+          clutter_actor_box_get_height (&priv->allocation) ==
+          clutter_actor_box_get_height (allocation));
+}
+
 static void
 clutter_actor_allocate_internal (ClutterActor           *self,
                                  const ClutterActorBox  *allocation)
@@ -8715,6 +9098,17 @@ clutter_actor_allocate_internal (ClutterActor           *self,
 
   CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
 
+  if (can_skip_children_allocation (self, allocation))
+    {
+      CLUTTER_NOTE (LAYOUT, "Moving %s without allocating its children",
+                    _clutter_actor_get_debug_name (self));
+
+      clutter_actor_set_allocation_internal (self, allocation);
+
+      CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
+      return;
+    }
+
   CLUTTER_NOTE (LAYOUT, "Calling %s::allocate()",
                 _clutter_actor_get_debug_name (self));
 
@@ -10175,15 +10569,15 @@ clutter_actor_set_opacity_internal (ClutterActor *self,
     {
       priv->opacity = opacity;
 
-      /* Queue a redraw from the flatten effect so that it can use
+      /* Queue a redraw from the redirect effect so that it can use
          its cached image if available instead of having to redraw the
          actual actor. If it doesn't end up using the FBO then the
          effect is still able to continue the paint anyway. If there
-         is no flatten effect yet then this is equivalent to queueing
+         is no such effect yet then this is equivalent to queueing
          a full redraw */
       _clutter_actor_queue_redraw_full (self,
                                         NULL, /* clip */
-                                        priv->flatten_effect);
+                                        get_redirect_effect (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_OPACITY]);
     }
@@ -10355,6 +10749,11 @@ clutter_actor_get_opacity (ClutterActor *self)
  * Custom actors that don't contain any overlapping primitives are
  * recommended to override the has_overlaps() virtual to return %FALSE
  * for maximum efficiency.
+ *
+ * Actors that are cloned a lot, such as previews shown in several places at
+ * once, can use %CLUTTER_OFFSCREEN_REDIRECT_FOR_CLONES so that they are
+ * only painted once per frame while that is the case, and reused by every
+ * clone as long as their contents don't change.
  */
 void
 clutter_actor_set_offscreen_redirect (ClutterActor *self,
@@ -10635,6 +11034,7 @@ clutter_actor_set_clip (ClutterActor *self,
 
   queue_update_paint_volume (self);
   clutter_actor_queue_redraw (self);
+  clutter_actor_invalidate_pick (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
   g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
@@ -10658,6 +11058,7 @@ clutter_actor_remove_clip (ClutterActor *self)
 
   queue_update_paint_volume (self);
   clutter_actor_queue_redraw (self);
+  clutter_actor_invalidate_pick (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_HAS_CLIP]);
 }
@@ -11117,6 +11518,8 @@ clutter_actor_add_child_internal (ClutterActor              *self,
 
   self->priv->age += 1;
 
+  clutter_actor_invalidate_event_chains ();
+
   if (self->priv->in_cloned_branch)
     clutter_actor_push_in_cloned_branch (child, self->priv->in_cloned_branch);
 
@@ -11881,9 +12284,11 @@ clutter_actor_set_reactive (ClutterActor *actor,
   else
     actor->flags &= ~CLUTTER_ACTOR_REACTIVE;
 
+  clutter_actor_invalidate_event_chains ();
+
   g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
 
-  accessible = clutter_actor_get_accessible (actor);
+  accessible = clutter_actor_peek_accessible (actor);
   if (accessible)
     atk_object_notify_state_change (accessible,
                                     ATK_STATE_SENSITIVE,
@@ -12384,6 +12789,28 @@ clutter_actor_set_final_state (ClutterAnimatable *animatable,
   clutter_actor_update_devices (actor);
 }
 
+/*
+ * clutter_actor_set_animated_property:
+ * @self: a #ClutterActor
+ * @pspec: an animatable property of #ClutterActor
+ * @value: the value to set
+ *
+ * Sets the value of an animatable property of #ClutterActor for a frame
+ * of a transition, like clutter_actor_set_final_state() would, without
+ * resolving the property by its name again.
+ */
+void
+clutter_actor_set_animated_property (ClutterActor *self,
+                                     GParamSpec   *pspec,
+                                     const GValue *value)
+{
+  g_assert (pspec->owner_type == CLUTTER_TYPE_ACTOR);
+  g_assert ((pspec->flags & CLUTTER_PARAM_ANIMATABLE) != 0);
+
+  clutter_actor_set_animatable_property (self, pspec->param_id, value, pspec);
+  clutter_actor_update_devices (self);
+}
+
 static ClutterActor *
 clutter_actor_get_actor (ClutterAnimatable *animatable)
 {
@@ -12399,46 +12826,25 @@ clutter_animatable_iface_init (ClutterAnimatableInterface *iface)
   iface->get_actor = clutter_actor_get_actor;
 }
 
-/**
- * clutter_actor_transform_stage_point:
- * @self: A #ClutterActor
- * @x: (in): x screen coordinate of the point to unproject
- * @y: (in): y screen coordinate of the point to unproject
- * @x_out: (out) (nullable): return location for the unprojected x coordinance
- * @y_out: (out) (nullable): return location for the unprojected y coordinance
- *
- * This function translates screen coordinates (@x, @y) to
- * coordinates relative to the actor. For example, it can be used to translate
- * screen events from global screen coordinates into actor-local coordinates.
- *
- * The conversion can fail, notably if the transform stack results in the
- * actor being projected on the screen as a mere line.
- *
- * The conversion should not be expected to be pixel-perfect due to the
- * nature of the operation. In general the error grows when the skewing
- * of the actor rectangle on screen increases.
- *
- * This function can be computationally intensive.
+/*
+ * clutter_actor_get_stage_point_transform:
  *
- * This function only works when the allocation is up-to-date, i.e. inside of
- * the [vfunc@Clutter.Actor.paint] implementation
+ * Retrieves the transformation applied by clutter_actor_transform_stage_point(),
+ * for callers transforming many points at once, which can then avoid
+ * projecting the actor and inverting the transformation for every point.
  *
- * Return value: %TRUE if conversion was successful.
+ * Return value: %TRUE if the transformation could be inverted.
  */
 gboolean
-clutter_actor_transform_stage_point (ClutterActor *self,
-				     gfloat        x,
-				     gfloat        y,
-				     gfloat       *x_out,
-				     gfloat       *y_out)
+clutter_actor_get_stage_point_transform (ClutterActor               *self,
+                                         ClutterStagePointTransform *transform)
 {
   graphene_point3d_t v[4];
-  double ST[3][3];
+  double (*ST)[3] = transform->st;
   double RQ[3][3];
   int du, dv;
   double px, py;
   double det;
-  float xf, yf, wf;
   ClutterActorPrivate *priv;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
@@ -12551,21 +12957,76 @@ clutter_actor_transform_stage_point (ClutterActor *self,
   if (fabs (det) <= DBL_EPSILON)
     return FALSE;
 
+#undef DET
+
+  return TRUE;
+}
+
+void
+clutter_stage_point_transform_apply (const ClutterStagePointTransform *transform,
+                                     float                             x,
+                                     float                             y,
+                                     float                            *x_out,
+                                     float                            *y_out)
+{
+  float xf, yf, wf;
+
   /*
-   * Now transform our point with the ST matrix; the notional w
+   * Transform our point with the ST matrix; the notional w
    * coordinate is 1, hence the last part is simply added.
    */
-  xf = (float) (x * ST[0][0] + y * ST[1][0] + ST[2][0]);
-  yf = (float) (x * ST[0][1] + y * ST[1][1] + ST[2][1]);
-  wf = (float) (x * ST[0][2] + y * ST[1][2] + ST[2][2]);
+  xf = (float) (x * transform->st[0][0] + y * transform->st[1][0] + transform->st[2][0]);
+  yf = (float) (x * transform->st[0][1] + y * transform->st[1][1] + transform->st[2][1]);
+  wf = (float) (x * transform->st[0][2] + y * transform->st[1][2] + transform->st[2][2]);
 
   if (x_out)
     *x_out = xf / wf;
 
   if (y_out)
     *y_out = yf / wf;
+}
 
-#undef DET
+/**
+ * clutter_actor_transform_stage_point:
+ * @self: A #ClutterActor
+ * @x: (in): x screen coordinate of the point to unproject
+ * @y: (in): y screen coordinate of the point to unproject
+ * @x_out: (out) (nullable): return location for the unprojected x coordinance
+ * @y_out: (out) (nullable): return location for the unprojected y coordinance
+ *
+ * This function translates screen coordinates (@x, @y) to
+ * coordinates relative to the actor. For example, it can be used to translate
+ * screen events from global screen coordinates into actor-local coordinates.
+ *
+ * The conversion can fail, notably if the transform stack results in the
+ * actor being projected on the screen as a mere line.
+ *
+ * The conversion should not be expected to be pixel-perfect due to the
+ * nature of the operation. In general the error grows when the skewing
+ * of the actor rectangle on screen increases.
+ *
+ * This function can be computationally intensive.
+ *
+ * This function only works when the allocation is up-to-date, i.e. inside of
+ * the [vfunc@Clutter.Actor.paint] implementation
+ *
+ * Return value: %TRUE if conversion was successful.
+ */
+gboolean
+clutter_actor_transform_stage_point (ClutterActor *self,
+				     gfloat        x,
+				     gfloat        y,
+				     gfloat       *x_out,
+				     gfloat       *y_out)
+{
+  ClutterStagePointTransform transform;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+
+  if (!clutter_actor_get_stage_point_transform (self, &transform))
+    return FALSE;
+
+  clutter_stage_point_transform_apply (&transform, x, y, x_out, y_out);
 
   return TRUE;
 }
@@ -13066,19 +13527,26 @@ clutter_actor_get_pango_context (ClutterActor *self)
 
   if (G_UNLIKELY (priv->pango_context == NULL))
     {
-      priv->pango_context = clutter_actor_create_pango_context (self);
+      ActorPangoContext *pango_context;
 
-      priv->resolution_changed_id =
+      pango_context = g_new0 (ActorPangoContext, 1);
+      pango_context->context = clutter_actor_create_pango_context (self);
+
+      pango_context->resolution_changed_id =
         g_signal_connect (backend, "resolution-changed",
-                          G_CALLBACK (update_pango_context), priv->pango_context);
-      priv->font_changed_id =
+                          G_CALLBACK (update_pango_context),
+                          pango_context->context);
+      pango_context->font_changed_id =
         g_signal_connect (backend, "font-changed",
-                          G_CALLBACK (update_pango_context), priv->pango_context);
+                          G_CALLBACK (update_pango_context),
+                          pango_context->context);
+
+      priv->pango_context = pango_context;
     }
   else
-    update_pango_context (backend, priv->pango_context);
+    update_pango_context (backend, priv->pango_context->context);
 
-  return priv->pango_context;
+  return priv->pango_context->context;
 }
 
 /**
@@ -13316,7 +13784,7 @@ clutter_actor_set_transform_internal (ClutterActor            *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_TRANSFORM]);
 
@@ -13629,6 +14097,8 @@ clutter_actor_add_action_internal (ClutterActor      *self,
   clutter_action_set_phase (action, phase);
   _clutter_meta_group_add_meta (priv->actions, CLUTTER_ACTOR_META (action));
 
+  clutter_actor_invalidate_event_chains ();
+
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ACTIONS]);
 }
 
@@ -13728,6 +14198,8 @@ clutter_actor_remove_action (ClutterActor  *self,
   if (_clutter_meta_group_peek_metas (priv->actions) == NULL)
     g_clear_object (&priv->actions);
 
+  clutter_actor_invalidate_event_chains ();
+
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ACTIONS]);
 }
 
@@ -13760,6 +14232,8 @@ clutter_actor_remove_action_by_name (ClutterActor *self,
 
   _clutter_meta_group_remove_meta (priv->actions, meta);
 
+  clutter_actor_invalidate_event_chains ();
+
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ACTIONS]);
 }
 
@@ -13825,6 +14299,8 @@ clutter_actor_clear_actions (ClutterActor *self)
     return;
 
   _clutter_meta_group_clear_metas_no_internal (self->priv->actions);
+
+  clutter_actor_invalidate_event_chains ();
 }
 
 /**
@@ -14049,6 +14525,7 @@ clutter_actor_set_clip_to_allocation (ClutterActor *self,
 
       queue_update_paint_volume (self);
       clutter_actor_queue_redraw (self);
+      clutter_actor_invalidate_pick (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CLIP_TO_ALLOCATION]);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_HAS_CLIP]);
@@ -14533,6 +15010,7 @@ gboolean
 clutter_actor_get_paint_box (ClutterActor    *self,
                              ClutterActorBox *box)
 {
+  ClutterActorPrivate *priv;
   ClutterActor *stage;
   ClutterPaintVolume *pv;
 
@@ -14543,6 +15021,23 @@ clutter_actor_get_paint_box (ClutterActor    *self,
   if (G_UNLIKELY (!stage))
     return FALSE;
 
+  priv = self->priv;
+
+  /* The paint volume in eye coordinates is kept up to date while the actor
+   * is mapped, so avoid transforming the paint volume all over again. A
+   * non-zero z position makes the paint box be enlarged for sub-pixel
+   * positioning, which depends on the untransformed volume.
+   */
+  if (priv->visible_paint_volume_valid &&
+      !priv->needs_visible_paint_volume_update &&
+      clutter_actor_get_z_position (self) == 0.0f)
+    {
+      _clutter_paint_volume_get_stage_paint_box (&priv->visible_paint_volume,
+                                                 CLUTTER_STAGE (stage),
+                                                 box);
+      return TRUE;
+    }
+
   pv = _clutter_actor_get_paint_volume_mutable (self);
   if (G_UNLIKELY (!pv))
     return FALSE;
@@ -18041,6 +18536,12 @@ _clutter_actor_detach_clone (ClutterActor *actor,
   if (g_hash_table_size (priv->clones) == 0)
     g_clear_pointer (&priv->clones, g_hash_table_unref);
 
+  /* Drop the cached image right away rather than on the next paint, which
+   * might not happen for a while if the source is hidden.
+   */
+  if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_FOR_CLONES)
+    add_or_remove_flatten_effect (actor);
+
   g_signal_emit (actor, actor_signals[DECLONED], 0, clone);
 }
 
@@ -18124,7 +18625,7 @@ clutter_actor_child_model__items_changed (GListModel *model,
                                           gpointer    user_data)
 {
   ClutterActor *parent = user_data;
-  ClutterActorPrivate *priv = parent->priv;
+  ChildModelBinding *binding = parent->priv->child_model_binding;
   guint i;
 
   while (removed--)
@@ -18136,8 +18637,8 @@ clutter_actor_child_model__items_changed (GListModel *model,
   for (i = 0; i < added; i++)
     {
       g_autoptr (GObject) item = g_list_model_get_item (model, position + i);
-      g_autoptr (ClutterActor) child = priv->create_child_func (
-        item, priv->create_child_data);
+      g_autoptr (ClutterActor) child = binding->create_child_func (
+        item, binding->create_child_data);
 
       /* The actor returned by the function can have a floating reference,
        * if the implementation is in pure C, or have a full reference, usually
@@ -18188,18 +18689,18 @@ clutter_actor_bind_model (ClutterActor                *self,
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
   g_return_if_fail (model == NULL || create_child_func != NULL);
 
-  if (priv->child_model != NULL)
+  if (priv->child_model_binding != NULL)
     {
-      if (priv->create_child_notify != NULL)
-        priv->create_child_notify (priv->create_child_data);
+      ChildModelBinding *binding = priv->child_model_binding;
+
+      if (binding->create_child_notify != NULL)
+        binding->create_child_notify (binding->create_child_data);
 
-      g_signal_handlers_disconnect_by_func (priv->child_model,
+      g_signal_handlers_disconnect_by_func (binding->model,
                                             clutter_actor_child_model__items_changed,
                                             self);
-      g_clear_object (&priv->child_model);
-      priv->create_child_func = NULL;
-      priv->create_child_data = NULL;
-      priv->create_child_notify = NULL;
+      g_clear_object (&binding->model);
+      g_clear_pointer (&priv->child_model_binding, g_free);
     }
 
   clutter_actor_destroy_all_children (self);
@@ -18207,19 +18708,20 @@ clutter_actor_bind_model (ClutterActor                *self,
   if (model == NULL)
     return;
 
-  priv->child_model = g_object_ref (model);
-  priv->create_child_func = create_child_func;
-  priv->create_child_data = user_data;
-  priv->create_child_notify = notify;
+  priv->child_model_binding = g_new0 (ChildModelBinding, 1);
+  priv->child_model_binding->model = g_object_ref (model);
+  priv->child_model_binding->create_child_func = create_child_func;
+  priv->child_model_binding->create_child_data = user_data;
+  priv->child_model_binding->create_child_notify = notify;
 
-  g_signal_connect (priv->child_model, "items-changed",
+  g_signal_connect (model, "items-changed",
                     G_CALLBACK (clutter_actor_child_model__items_changed),
                     self);
 
-  clutter_actor_child_model__items_changed (priv->child_model,
+  clutter_actor_child_model__items_changed (model,
                                             0,
                                             0,
-                                            g_list_model_get_n_items (priv->child_model),
+                                            g_list_model_get_n_items (model),
                                             self);
 }
 
@@ -18695,7 +19197,7 @@ clutter_actor_set_accessible_name (ClutterActor *self,
   if (g_strcmp0 (name, priv->accessible_name) == 0)
     return;
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   g_set_str (&priv->accessible_name, name);
 
   if (accessible)
@@ -18755,7 +19257,7 @@ clutter_actor_set_accessible_role (ClutterActor *self,
   if (self->accessible_role == role)
     return;
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   self->accessible_role = role;
 
   if (accessible)
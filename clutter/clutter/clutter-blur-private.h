@@ -19,19 +19,37 @@
 
 #include <glib-object.h>
 
+#include "clutter/clutter-macros.h"
 #include "cogl/cogl.h"
 
 G_BEGIN_DECLS
 
 typedef struct _ClutterBlur ClutterBlur;
 
+CLUTTER_EXPORT
 ClutterBlur * clutter_blur_new (CoglTexture *texture,
                                 float        radius);
 
+CLUTTER_EXPORT
 void clutter_blur_apply (ClutterBlur *blur);
 
+ClutterBlur * clutter_blur_new_with_framebuffer (CoglContext  *cogl_context,
+                                                 int           width,
+                                                 int           height,
+                                                 float         radius,
+                                                 GError      **error);
+
+CoglFramebuffer * clutter_blur_get_source_framebuffer (ClutterBlur *blur);
+
+gboolean clutter_blur_is_compatible (ClutterBlur *blur,
+                                     int          width,
+                                     int          height,
+                                     float        radius);
+
+CLUTTER_EXPORT
 CoglTexture * clutter_blur_get_texture (ClutterBlur *blur);
 
+CLUTTER_EXPORT
 void clutter_blur_free (ClutterBlur *blur);
 
 G_END_DECLS
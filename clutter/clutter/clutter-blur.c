@@ -20,6 +20,7 @@
 #include "clutter/clutter-blur-private.h"
 
 #include "clutter/clutter-backend.h"
+#include "clutter/clutter-mutter.h"
 
 /**
  * ClutterBlur:
@@ -127,6 +128,9 @@ typedef struct
 
 struct _ClutterBlur
 {
+  /* Only set when the blur owns the framebuffer of its source texture, so
+   * that it can be reused to blur new contents */
+  CoglFramebuffer *source_framebuffer;
   CoglTexture *source_texture;
   float sigma;
   float downscale_factor;
@@ -315,7 +319,9 @@ apply_blur_pass (BlurPass *pass)
   cogl_color_init_from_4f (&transparent, 0.0, 0.0, 0.0, 0.0);
 
   cogl_framebuffer_clear (pass->framebuffer,
-                          COGL_BUFFER_BIT_COLOR,
+                          (COGL_BUFFER_BIT_COLOR |
+                           COGL_BUFFER_BIT_DEPTH |
+                           COGL_BUFFER_BIT_STENCIL),
                           &transparent);
 
   cogl_framebuffer_draw_rectangle (pass->framebuffer,
@@ -323,6 +329,12 @@ apply_blur_pass (BlurPass *pass)
                                    0, 0,
                                    cogl_texture_get_width (pass->texture),
                                    cogl_texture_get_height (pass->texture));
+
+  /* Submits the pass right away, so the next pass samples a finished
+   * target, and avoids storing its unused depth and stencil buffers */
+  cogl_framebuffer_discard_buffers (pass->framebuffer,
+                                    COGL_BUFFER_BIT_DEPTH |
+                                    COGL_BUFFER_BIT_STENCIL);
 }
 
 static void
@@ -382,6 +394,96 @@ out:
   return g_steal_pointer (&blur);
 }
 
+/**
+ * clutter_blur_new_with_framebuffer:
+ * @cogl_context: a #CoglContext
+ * @width: width of the contents to blur
+ * @height: height of the contents to blur
+ * @radius: blur radius
+ * @error: return location for a #GError
+ *
+ * Creates a new #ClutterBlur along with the framebuffer the contents to
+ * blur are drawn to, see [method@Clutter.Blur.get_source_framebuffer].
+ * Since all of the intermediate framebuffers are owned by the blur, it
+ * can be applied again after new contents are drawn.
+ *
+ * Returns: (transfer full) (nullable): A newly created #ClutterBlur
+ */
+ClutterBlur *
+clutter_blur_new_with_framebuffer (CoglContext  *cogl_context,
+                                   int           width,
+                                   int           height,
+                                   float         radius,
+                                   GError      **error)
+{
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  ClutterBlur *blur;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  cogl_texture_set_premultiplied (texture, TRUE);
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return NULL;
+
+  cogl_framebuffer_orthographic (COGL_FRAMEBUFFER (offscreen),
+                                 0.0, 0.0,
+                                 width, height,
+                                 0.0, 1.0);
+
+  blur = clutter_blur_new (texture, radius);
+  if (!blur)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to create blur pipeline");
+      return NULL;
+    }
+
+  blur->source_framebuffer = COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+
+  return blur;
+}
+
+/**
+ * clutter_blur_get_source_framebuffer:
+ * @blur: a #ClutterBlur
+ *
+ * Retrieves the framebuffer of a blur created with
+ * clutter_blur_new_with_framebuffer().
+ *
+ * Returns: (transfer none) (nullable): a #CoglFramebuffer
+ */
+CoglFramebuffer *
+clutter_blur_get_source_framebuffer (ClutterBlur *blur)
+{
+  return blur->source_framebuffer;
+}
+
+/**
+ * clutter_blur_is_compatible:
+ * @blur: a #ClutterBlur
+ * @width: width of the contents to blur
+ * @height: height of the contents to blur
+ * @radius: blur radius
+ *
+ * Checks whether @blur can be reused to blur contents of the given size
+ * with the given radius.
+ *
+ * Returns: %TRUE if @blur has a source framebuffer matching the parameters
+ */
+gboolean
+clutter_blur_is_compatible (ClutterBlur *blur,
+                            int          width,
+                            int          height,
+                            float        radius)
+{
+  return (blur->source_framebuffer &&
+          cogl_texture_get_width (blur->source_texture) == width &&
+          cogl_texture_get_height (blur->source_texture) == height &&
+          G_APPROX_VALUE (blur->sigma, radius / 2.0f, FLT_EPSILON));
+}
+
 /**
  * clutter_blur_apply:
  * @blur: a #ClutterBlur
@@ -431,5 +533,31 @@ clutter_blur_free (ClutterBlur *blur)
   clear_blur_pass (&blur->pass[VERTICAL]);
   clear_blur_pass (&blur->pass[HORIZONTAL]);
   g_clear_object (&blur->source_texture);
+  g_clear_object (&blur->source_framebuffer);
   g_free (blur);
 }
+
+/**
+ * clutter_blur_prewarm: (skip)
+ * @cogl_context: a #CoglContext
+ *
+ * Blurs a small scratch texture, so that the program used by the
+ * blur passes is built before the first real blur is painted.
+ */
+void
+clutter_blur_prewarm (CoglContext *cogl_context)
+{
+  g_autoptr (CoglTexture) texture = NULL;
+  ClutterBlur *blur;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, 16, 16);
+  if (!cogl_texture_allocate (texture, NULL))
+    return;
+
+  blur = clutter_blur_new (texture, 4.0f);
+  if (!blur)
+    return;
+
+  clutter_blur_apply (blur);
+  clutter_blur_free (blur);
+}
@@ -230,6 +230,13 @@ clutter_brightness_contrast_effect_get_property (GObject    *gobject,
     }
 }
 
+static gboolean
+clutter_brightness_contrast_effect_is_shape_preserving (ClutterEffect *effect)
+{
+  /* Only the color channels are modified */
+  return TRUE;
+}
+
 static void
 clutter_brightness_contrast_effect_class_init (ClutterBrightnessContrastEffectClass *klass)
 {
@@ -241,6 +248,8 @@ clutter_brightness_contrast_effect_class_init (ClutterBrightnessContrastEffectCl
   offscreen_class->create_pipeline = clutter_brightness_contrast_effect_create_pipeline;
 
   effect_class->pre_paint = clutter_brightness_contrast_effect_pre_paint;
+  effect_class->is_shape_preserving =
+    clutter_brightness_contrast_effect_is_shape_preserving;
 
   gobject_class->set_property = clutter_brightness_contrast_effect_set_property;
   gobject_class->get_property = clutter_brightness_contrast_effect_get_property;
@@ -30,6 +30,9 @@
  * function of another actor, scaled to fit its own allocation.
  *
  * #ClutterClone can be used to efficiently clone any other actor.
+ * Every clone paints the source actor again; sources that are cloned more
+ * than once can be flattened into a single image shared by all clones with
+ * %CLUTTER_OFFSCREEN_REDIRECT_FOR_CLONES.
  *
  * #ClutterClone does not require the presence of support for FBOs
  * in the underlying GL or GLES implementation.
@@ -33,3 +33,7 @@ CoglSnippet * clutter_color_manager_lookup_snippet (ClutterColorManager
 void clutter_color_manager_add_snippet (ClutterColorManager            *color_manager,
                                         const ClutterColorTransformKey *key,
                                         CoglSnippet                    *snippet);
+
+ClutterColorState * clutter_color_manager_intern_color_state (ClutterColorManager *color_manager,
+                                                              ClutterColorState   *color_state,
+                                                              GEqualFunc           identical_func);
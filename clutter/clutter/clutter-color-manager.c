@@ -46,19 +46,38 @@ struct _ClutterColorManager
   ClutterContext *context;
 
   GHashTable *snippet_cache;
+  GPtrArray *color_states;
   unsigned int id_counter;
   ClutterColorState *default_color_state;
 };
 
 G_DEFINE_FINAL_TYPE (ClutterColorManager, clutter_color_manager, G_TYPE_OBJECT)
 
+static void
+on_color_state_disposed (gpointer  user_data,
+                         GObject  *where_the_object_was)
+{
+  ClutterColorManager *color_manager = user_data;
+
+  g_ptr_array_remove_fast (color_manager->color_states, where_the_object_was);
+}
+
 static void
 clutter_color_manager_finalize (GObject *object)
 {
   ClutterColorManager *color_manager = CLUTTER_COLOR_MANAGER (object);
+  unsigned int i;
 
   g_clear_object (&color_manager->default_color_state);
 
+  for (i = 0; i < color_manager->color_states->len; i++)
+    {
+      GObject *color_state = g_ptr_array_index (color_manager->color_states, i);
+
+      g_object_weak_unref (color_state, on_color_state_disposed, color_manager);
+    }
+  g_clear_pointer (&color_manager->color_states, g_ptr_array_unref);
+
   g_clear_pointer (&color_manager->snippet_cache, g_hash_table_unref);
 
   G_OBJECT_CLASS (clutter_color_manager_parent_class)->finalize (object);
@@ -136,6 +155,7 @@ clutter_color_manager_init (ClutterColorManager *color_manager)
                            clutter_color_transform_key_equal,
                            g_free,
                            g_object_unref);
+  color_manager->color_states = g_ptr_array_new ();
 }
 
 unsigned int
@@ -174,3 +194,38 @@ clutter_color_manager_add_snippet (ClutterColorManager            *color_manager
                        g_memdup2 (key, sizeof (*key)),
                        g_object_ref (snippet));
 }
+
+/*
+ * Takes ownership of @color_state and returns a reference to a color state
+ * with identical parameters, if one already exists, making it possible for
+ * users of color states with equal parameters to share a single instance.
+ */
+ClutterColorState *
+clutter_color_manager_intern_color_state (ClutterColorManager *color_manager,
+                                          ClutterColorState   *color_state,
+                                          GEqualFunc           identical_func)
+{
+  unsigned int i;
+
+  for (i = 0; i < color_manager->color_states->len; i++)
+    {
+      ClutterColorState *other_color_state =
+        g_ptr_array_index (color_manager->color_states, i);
+
+      if (G_OBJECT_TYPE (other_color_state) != G_OBJECT_TYPE (color_state))
+        continue;
+
+      if (identical_func (other_color_state, color_state))
+        {
+          g_object_unref (color_state);
+          return g_object_ref (other_color_state);
+        }
+    }
+
+  g_ptr_array_add (color_manager->color_states, color_state);
+  g_object_weak_ref (G_OBJECT (color_state),
+                     on_color_state_disposed,
+                     color_manager);
+
+  return color_state;
+}
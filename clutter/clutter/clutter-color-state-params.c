@@ -28,7 +28,11 @@
 
 #include "clutter/clutter-color-state-params.h"
 
+#include <string.h>
+
+#include "clutter/clutter-color-manager-private.h"
 #include "clutter/clutter-color-state-private.h"
+#include "clutter/clutter-context.h"
 #include "clutter/clutter-main.h"
 
 #define UNIFORM_NAME_GAMMA_EXP "gamma_exp"
@@ -1209,6 +1213,40 @@ clutter_color_state_params_equals (ClutterColorState *color_state,
          luminances_equal (color_state_params, other_color_state_params);
 }
 
+/**
+ * clutter_color_state_params_is_passthrough:
+ * @color_state_params: The source color state params
+ * @target_color_state_params: The target color state params
+ *
+ * Checks whether content in @color_state_params can be presented as-is in
+ * @target_color_state_params. This is the case when the color states are
+ * equal, but also when their luminance levels differ in a way the luminance
+ * mapping cancels out, e.g. PQ content with a lower peak and a matching lower
+ * reference level.
+ *
+ * Returns: %TRUE if no color transform would modify the content
+ */
+gboolean
+clutter_color_state_params_is_passthrough (ClutterColorStateParams *color_state_params,
+                                           ClutterColorStateParams *target_color_state_params)
+{
+  g_return_val_if_fail (CLUTTER_IS_COLOR_STATE_PARAMS (color_state_params),
+                        FALSE);
+  g_return_val_if_fail (CLUTTER_IS_COLOR_STATE_PARAMS (target_color_state_params),
+                        FALSE);
+
+  if (!colorimetry_equal (color_state_params, target_color_state_params) ||
+      !eotf_equal (color_state_params, target_color_state_params))
+    return FALSE;
+
+  if (luminances_equal (color_state_params, target_color_state_params))
+    return TRUE;
+
+  return G_APPROX_VALUE (get_luminance_mapping (color_state_params,
+                                                target_color_state_params),
+                         1.0f, 0.001f);
+}
+
 static char *
 clutter_color_state_params_to_string (ClutterColorState *color_state)
 {
@@ -1317,6 +1355,63 @@ clutter_color_state_params_get_blending (ClutterColorState *color_state,
                                                          color_state_params->luminance);
 }
 
+static gboolean
+clutter_color_state_params_identical (gconstpointer data,
+                                      gconstpointer other_data)
+{
+  const ClutterColorStateParams *color_state_params = data;
+  const ClutterColorStateParams *other_color_state_params = other_data;
+  const ClutterColorimetry *colorimetry = &color_state_params->colorimetry;
+  const ClutterColorimetry *other_colorimetry =
+    &other_color_state_params->colorimetry;
+  const ClutterEOTF *eotf = &color_state_params->eotf;
+  const ClutterEOTF *other_eotf = &other_color_state_params->eotf;
+  const ClutterLuminance *lum = &color_state_params->luminance;
+  const ClutterLuminance *other_lum = &other_color_state_params->luminance;
+
+  if (colorimetry->type != other_colorimetry->type)
+    return FALSE;
+
+  switch (colorimetry->type)
+    {
+    case CLUTTER_COLORIMETRY_TYPE_COLORSPACE:
+      if (colorimetry->colorspace != other_colorimetry->colorspace)
+        return FALSE;
+      break;
+    case CLUTTER_COLORIMETRY_TYPE_PRIMARIES:
+      if (memcmp (colorimetry->primaries, other_colorimetry->primaries,
+                  sizeof (ClutterPrimaries)) != 0)
+        return FALSE;
+      break;
+    }
+
+  if (eotf->type != other_eotf->type)
+    return FALSE;
+
+  switch (eotf->type)
+    {
+    case CLUTTER_EOTF_TYPE_NAMED:
+      if (eotf->tf_name != other_eotf->tf_name)
+        return FALSE;
+      break;
+    case CLUTTER_EOTF_TYPE_GAMMA:
+      if (eotf->gamma_exp != other_eotf->gamma_exp)
+        return FALSE;
+      break;
+    }
+
+  if (lum->type != other_lum->type)
+    return FALSE;
+
+  if (lum->type == CLUTTER_LUMINANCE_TYPE_EXPLICIT &&
+      (lum->min != other_lum->min ||
+       lum->max != other_lum->max ||
+       lum->ref != other_lum->ref))
+    return FALSE;
+
+  return TRUE;
+}
+
 static void
 clutter_color_state_params_class_init (ClutterColorStateParamsClass *klass)
 {
@@ -1362,7 +1457,10 @@ clutter_color_state_params_new (ClutterContext          *context,
  * Create a new ClutterColorStateParams object with all possible parameters.
  * Some arguments might not be valid to set with other arguments.
  *
- * Return value: A new ClutterColorState object.
+ * If a color state with identical parameters already exists, a new
+ * reference to it is returned instead.
+ *
+ * Return value: A ClutterColorState object.
  **/
 ClutterColorState *
 clutter_color_state_params_new_full (ClutterContext          *context,
@@ -1374,6 +1472,7 @@ clutter_color_state_params_new_full (ClutterContext          *context,
                                      float                    max_lum,
                                      float                    ref_lum)
 {
+  ClutterColorManager *color_manager;
   ClutterColorStateParams *color_state_params;
 
   color_state_params = g_object_new (CLUTTER_TYPE_COLOR_STATE_PARAMS,
@@ -1415,7 +1514,13 @@ clutter_color_state_params_new_full (ClutterContext          *context,
       color_state_params->luminance.type = CLUTTER_LUMINANCE_TYPE_DERIVED;
     }
 
-  return CLUTTER_COLOR_STATE (color_state_params);
+  /* Color states are immutable, so ones with identical parameters can be
+   * shared, letting users of the same color state end up with the same
+   * color transform pipelines. */
+  color_manager = clutter_context_get_color_manager (context);
+  return clutter_color_manager_intern_color_state (color_manager,
+                                                   CLUTTER_COLOR_STATE (color_state_params),
+                                                   clutter_color_state_params_identical);
 }
 
 /**
@@ -132,6 +132,10 @@ const ClutterEOTF * clutter_color_state_params_get_eotf (ClutterColorStateParams
 CLUTTER_EXPORT
 const ClutterLuminance * clutter_color_state_params_get_luminance (ClutterColorStateParams *color_state_params);
 
+CLUTTER_EXPORT
+gboolean clutter_color_state_params_is_passthrough (ClutterColorStateParams *color_state_params,
+                                                    ClutterColorStateParams *target_color_state_params);
+
 CLUTTER_EXPORT
 const ClutterLuminance * clutter_eotf_get_default_luminance (ClutterEOTF eotf);
 
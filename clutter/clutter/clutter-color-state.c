@@ -78,9 +78,9 @@ clutter_color_transform_key_hash (gconstpointer data)
 {
   const ClutterColorTransformKey *key = data;
 
-  return key->source_eotf_bits << 0 &
-         key->target_eotf_bits << 4 &
-         key->luminance_bit    << 8 &
+  return key->source_eotf_bits << 0 |
+         key->target_eotf_bits << 4 |
+         key->luminance_bit    << 8 |
          key->color_trans_bit  << 9;
 }
 
@@ -153,15 +153,25 @@ clutter_colorize_effect_get_property (GObject    *gobject,
     }
 }
 
+static gboolean
+clutter_colorize_effect_is_shape_preserving (ClutterEffect *effect)
+{
+  /* Only the color channels are modified */
+  return TRUE;
+}
+
 static void
 clutter_colorize_effect_class_init (ClutterColorizeEffectClass *klass)
 {
+  ClutterEffectClass *effect_class = CLUTTER_EFFECT_CLASS (klass);
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   ClutterOffscreenEffectClass *offscreen_class;
 
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->create_pipeline = clutter_colorize_effect_create_pipeline;
 
+  effect_class->is_shape_preserving = clutter_colorize_effect_is_shape_preserving;
+
   gobject_class->set_property = clutter_colorize_effect_set_property;
   gobject_class->get_property = clutter_colorize_effect_get_property;
   gobject_class->dispose = clutter_colorize_effect_dispose;
@@ -19,8 +19,10 @@
 
 #pragma once
 
+#include "clutter/clutter-blur-private.h"
 #include "clutter/clutter-context.h"
 #include "clutter-stage-manager-private.h"
+#include "pango/clutter-pango-layout-cache.h"
 
 struct _ClutterContext
 {
@@ -29,7 +31,14 @@ struct _ClutterContext
   ClutterBackend *backend;
   ClutterStageManager *stage_manager;
 
-  GAsyncQueue *events_queue;
+  /* Ring buffer of events queued from any thread, protected by
+   * events_lock. n_events is also read without the lock, atomically.
+   */
+  GMutex events_lock;
+  ClutterEvent **events;
+  unsigned int events_size;
+  unsigned int events_head;
+  int n_events;
 
   /* the event filters added via clutter_event_add_filter. these are
    * ordered from least recently added to most recently added */
@@ -38,6 +47,13 @@ struct _ClutterContext
   PangoRenderer *font_renderer;
   PangoFontMap *font_map;
 
+  /* Layouts shared between text actors */
+  ClutterPangoLayoutCache *layout_cache;
+
+  /* Blurs of recently painted blur nodes, kept for the next frames */
+  GQueue blur_pool;
+  unsigned int blur_pool_timeout_id;
+
   GSList *current_event;
 
   GList *repaint_funcs;
@@ -53,3 +69,17 @@ ClutterStageManager * clutter_context_get_stage_manager (ClutterContext *context
 gboolean clutter_context_get_show_fps (ClutterContext *context);
 
 PangoRenderer * clutter_context_get_font_renderer (ClutterContext *context);
+
+ClutterBlur * clutter_context_take_blur (ClutterContext *context,
+                                         int             width,
+                                         int             height,
+                                         float           radius);
+
+void clutter_context_release_blur (ClutterContext *context,
+                                   ClutterBlur    *blur);
+
+ClutterPangoLayoutCache * clutter_context_get_layout_cache (ClutterContext *context);
+
+void clutter_context_init_events_queue (ClutterContext *context);
+
+void clutter_context_clear_events_queue (ClutterContext *context);
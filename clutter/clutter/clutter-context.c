@@ -33,6 +33,13 @@
 #include "clutter/clutter-settings-private.h"
 #include "clutter/pango/clutter-pango-private.h"
 
+/* Estimated memory the layouts shared between text actors may use */
+#define LAYOUT_CACHE_MAX_SIZE (4 * 1024 * 1024)
+
+/* Number of blurs kept for reuse, and for how long once unused */
+#define BLUR_POOL_MAX_SIZE 4
+#define BLUR_POOL_TIMEOUT_S 2
+
 static gboolean clutter_show_fps = FALSE;
 static gboolean clutter_enable_accessibility = TRUE;
 
@@ -63,6 +70,7 @@ static const GDebugKey clutter_debug_keys[] = {
 
 static const GDebugKey clutter_pick_debug_keys[] = {
   { "nop-picking", CLUTTER_DEBUG_NOP_PICKING },
+  { "disable-pick-cache", CLUTTER_DEBUG_DISABLE_PICK_CACHE },
 };
 
 static const GDebugKey clutter_paint_debug_keys[] = {
@@ -77,6 +85,7 @@ static const GDebugKey clutter_paint_debug_keys[] = {
   { "damage-region", CLUTTER_DEBUG_PAINT_DAMAGE_REGION },
   { "disable-dynamic-max-render-time", CLUTTER_DEBUG_DISABLE_DYNAMIC_MAX_RENDER_TIME },
   { "max-render-time", CLUTTER_DEBUG_PAINT_MAX_RENDER_TIME },
+  { "disable-shadowfb-damage-detection", CLUTTER_DEBUG_DISABLE_SHADOWFB_DAMAGE_DETECTION },
 };
 
 typedef struct _ClutterContextPrivate
@@ -89,6 +98,15 @@ typedef struct _ClutterContextPrivate
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterContext, clutter_context, G_TYPE_OBJECT)
 
+static void
+clear_blur_pool (ClutterContext *context)
+{
+  g_clear_handle_id (&context->blur_pool_timeout_id, g_source_remove);
+
+  while (!g_queue_is_empty (&context->blur_pool))
+    clutter_blur_free (g_queue_pop_head (&context->blur_pool));
+}
+
 static void
 clutter_context_dispose (GObject *object)
 {
@@ -97,21 +115,34 @@ clutter_context_dispose (GObject *object)
 
   g_clear_object (&priv->pipeline_cache);
   g_clear_object (&priv->color_manager);
-  g_clear_pointer (&context->events_queue, g_async_queue_unref);
+  clutter_context_clear_events_queue (context);
+  clear_blur_pool (context);
   g_clear_pointer (&context->backend, clutter_backend_destroy);
   g_clear_object (&context->stage_manager);
   g_clear_object (&context->settings);
+  g_clear_pointer (&context->layout_cache, clutter_pango_layout_cache_free);
   g_clear_object (&context->font_map);
 
   G_OBJECT_CLASS (clutter_context_parent_class)->dispose (object);
 }
 
+static void
+clutter_context_finalize (GObject *object)
+{
+  ClutterContext *context = CLUTTER_CONTEXT (object);
+
+  g_mutex_clear (&context->events_lock);
+
+  G_OBJECT_CLASS (clutter_context_parent_class)->finalize (object);
+}
+
 static void
 clutter_context_class_init (ClutterContextClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = clutter_context_dispose;
+  object_class->finalize = clutter_context_finalize;
 
   clutter_interval_register_progress_funcs ();
 }
@@ -278,8 +309,7 @@ clutter_context_new (ClutterBackendConstructor   backend_constructor,
 
   context->stage_manager = g_object_new (CLUTTER_TYPE_STAGE_MANAGER, NULL);
 
-  context->events_queue =
-    g_async_queue_new_full ((GDestroyNotify) clutter_event_free);
+  clutter_context_init_events_queue (context);
   context->last_repaint_id = 1;
 
   priv->color_manager = g_object_new (CLUTTER_TYPE_COLOR_MANAGER,
@@ -400,3 +430,108 @@ clutter_context_get_font_renderer (ClutterContext *context)
 
   return context->font_renderer;
 }
+
+size_t
+clutter_context_get_glyph_cache_size (ClutterContext *context)
+{
+  g_return_val_if_fail (CLUTTER_IS_CONTEXT (context), 0);
+
+  if (!context->font_renderer)
+    return 0;
+
+  return clutter_pango_renderer_get_glyph_cache_size (context->font_renderer);
+}
+
+gboolean
+clutter_context_trim_glyph_cache (ClutterContext *context,
+                                  size_t          max_size)
+{
+  g_return_val_if_fail (CLUTTER_IS_CONTEXT (context), FALSE);
+
+  if (!context->font_renderer)
+    return FALSE;
+
+  return clutter_pango_renderer_trim_glyph_cache (context->font_renderer,
+                                                  max_size);
+}
+
+ClutterPangoLayoutCache *
+clutter_context_get_layout_cache (ClutterContext *context)
+{
+  g_return_val_if_fail (CLUTTER_IS_CONTEXT (context), NULL);
+
+  if (G_UNLIKELY (context->layout_cache == NULL))
+    {
+      context->layout_cache =
+        clutter_pango_layout_cache_new (LAYOUT_CACHE_MAX_SIZE);
+    }
+
+  return context->layout_cache;
+}
+
+/**
+ * clutter_context_take_blur: (skip)
+ *
+ * Takes a blur released with clutter_context_release_blur() that can be
+ * used to blur contents of the given size with the given radius. This
+ * avoids allocating the framebuffers of the blur passes again for each
+ * frame that something is blurred in, e.g. a blurred panel background.
+ *
+ * Returns: (transfer full) (nullable): a #ClutterBlur, or %NULL
+ */
+ClutterBlur *
+clutter_context_take_blur (ClutterContext *context,
+                           int             width,
+                           int             height,
+                           float           radius)
+{
+  GList *l;
+
+  for (l = context->blur_pool.head; l; l = l->next)
+    {
+      ClutterBlur *blur = l->data;
+
+      if (clutter_blur_is_compatible (blur, width, height, radius))
+        {
+          g_queue_delete_link (&context->blur_pool, l);
+          return blur;
+        }
+    }
+
+  return NULL;
+}
+
+static gboolean
+clear_blur_pool_cb (gpointer user_data)
+{
+  ClutterContext *context = user_data;
+
+  context->blur_pool_timeout_id = 0;
+  clear_blur_pool (context);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * clutter_context_release_blur: (skip)
+ * @blur: (transfer full): a #ClutterBlur created with
+ *   clutter_blur_new_with_framebuffer()
+ *
+ * Gives @blur back for reuse. Blurs that aren't taken again within a few
+ * seconds are freed.
+ */
+void
+clutter_context_release_blur (ClutterContext *context,
+                              ClutterBlur    *blur)
+{
+  g_queue_push_head (&context->blur_pool, blur);
+
+  while (g_queue_get_length (&context->blur_pool) > BLUR_POOL_MAX_SIZE)
+    clutter_blur_free (g_queue_pop_tail (&context->blur_pool));
+
+  g_clear_handle_id (&context->blur_pool_timeout_id, g_source_remove);
+  context->blur_pool_timeout_id =
+    g_timeout_add_seconds (BLUR_POOL_TIMEOUT_S, clear_blur_pool_cb, context);
+  g_source_set_name_by_id (context->blur_pool_timeout_id,
+                           "[clutter] clear_blur_pool");
+}
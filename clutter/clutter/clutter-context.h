@@ -78,3 +78,26 @@ ClutterColorManager * clutter_context_get_color_manager (ClutterContext *context
  */
 CLUTTER_EXPORT
 ClutterSettings * clutter_context_get_settings (ClutterContext *context);
+
+/**
+ * clutter_context_get_glyph_cache_size: (skip)
+ *
+ * Returns: The number of bytes used by the evictable glyphs of the
+ *   glyph cache
+ */
+CLUTTER_EXPORT
+size_t clutter_context_get_glyph_cache_size (ClutterContext *context);
+
+/**
+ * clutter_context_trim_glyph_cache: (skip)
+ * @max_size: The number of bytes the glyph cache may use
+ *
+ * Evicts the least recently used glyphs of the glyph cache until it uses
+ * less than @max_size bytes. Text drawn afterwards has its glyphs cached
+ * again.
+ *
+ * Returns: %TRUE if glyphs were evicted
+ */
+CLUTTER_EXPORT
+gboolean clutter_context_trim_glyph_cache (ClutterContext *context,
+                                           size_t          max_size);
@@ -22,6 +22,11 @@
 
 #define DAMAGE_HISTORY_LENGTH 0x10
 
+/* Regions with more rectangles than this are simplified before being
+ * recorded, so that repairing old buffers doesn't need to union many
+ * complex regions. */
+#define MAX_RECORDED_RECTANGLES 32
+
 struct _ClutterDamageHistory
 {
   MtkRegion *damages[DAMAGE_HISTORY_LENGTH];
@@ -63,12 +68,101 @@ clutter_damage_history_is_age_valid (ClutterDamageHistory *history,
   return TRUE;
 }
 
+static inline int64_t
+rectangle_area (const MtkRectangle *rect)
+{
+  return (int64_t) rect->width * rect->height;
+}
+
+/* Returns how many pixels outside of @a and @b merging them would add */
+static inline int64_t
+get_merge_cost (const MtkRectangle *a,
+                const MtkRectangle *b)
+{
+  MtkRectangle merged;
+
+  mtk_rectangle_union (a, b, &merged);
+
+  return rectangle_area (&merged) - rectangle_area (a) - rectangle_area (b);
+}
+
+static void
+merge_rectangles (MtkRectangle *rects,
+                  int          *n_rects,
+                  int           i,
+                  int           j)
+{
+  mtk_rectangle_union (&rects[i], &rects[j], &rects[i]);
+  rects[j] = rects[*n_rects - 1];
+  (*n_rects)--;
+}
+
+static MtkRegion *
+simplify_damage (const MtkRegion *damage)
+{
+  g_autofree MtkRectangle *rects = NULL;
+  int n_rects;
+  int i;
+
+  n_rects = mtk_region_num_rectangles (damage);
+  rects = g_new (MtkRectangle, n_rects);
+  for (i = 0; i < n_rects; i++)
+    rects[i] = mtk_region_get_rectangle (damage, i);
+
+  /* Rectangles of a region are sorted in bands from top to bottom, so
+   * neighbours in the list are close to each other. Merge them pairwise
+   * first, to keep the cost of the exhaustive search below bounded.
+   */
+  while (n_rects > MAX_RECORDED_RECTANGLES * 2)
+    {
+      int n_merged = 0;
+
+      for (i = 0; i + 1 < n_rects; i += 2)
+        mtk_rectangle_union (&rects[i], &rects[i + 1], &rects[n_merged++]);
+      if (i < n_rects)
+        rects[n_merged++] = rects[i];
+
+      n_rects = n_merged;
+    }
+
+  /* Then merge the pairs that add the least overdraw */
+  while (n_rects > MAX_RECORDED_RECTANGLES)
+    {
+      int64_t best_cost = G_MAXINT64;
+      int best_i = 0, best_j = 1;
+      int j;
+
+      for (i = 0; i < n_rects; i++)
+        {
+          for (j = i + 1; j < n_rects; j++)
+            {
+              int64_t cost = get_merge_cost (&rects[i], &rects[j]);
+
+              if (cost < best_cost)
+                {
+                  best_cost = cost;
+                  best_i = i;
+                  best_j = j;
+                }
+            }
+        }
+
+      merge_rectangles (rects, &n_rects, best_i, best_j);
+    }
+
+  return mtk_region_create_rectangles (rects, n_rects);
+}
+
 void
 clutter_damage_history_record (ClutterDamageHistory *history,
                                const MtkRegion      *damage)
 {
   g_clear_pointer (&history->damages[history->index], mtk_region_unref);
-  history->damages[history->index] = mtk_region_copy (damage);
+
+  if (mtk_region_num_rectangles (damage) > MAX_RECORDED_RECTANGLES)
+    history->damages[history->index] = simplify_damage (damage);
+  else
+    history->damages[history->index] = mtk_region_copy (damage);
 }
 
 static inline int
@@ -175,15 +175,25 @@ update_factor_uniform (ClutterDesaturateEffect *self)
                                   (float) priv->factor);
 }
 
+static gboolean
+clutter_desaturate_effect_is_shape_preserving (ClutterEffect *effect)
+{
+  /* Only the color channels are modified */
+  return TRUE;
+}
+
 static void
 clutter_desaturate_effect_class_init (ClutterDesaturateEffectClass *klass)
 {
+  ClutterEffectClass *effect_class = CLUTTER_EFFECT_CLASS (klass);
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   ClutterOffscreenEffectClass *offscreen_class;
 
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->create_pipeline = clutter_desaturate_effect_create_pipeline;
 
+  effect_class->is_shape_preserving = clutter_desaturate_effect_is_shape_preserving;
+
   /**
    * ClutterDesaturateEffect:factor:
    *
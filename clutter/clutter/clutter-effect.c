@@ -263,6 +263,12 @@ clutter_effect_real_pick (ClutterEffect      *effect,
   clutter_actor_continue_pick (actor, pick_context);
 }
 
+static gboolean
+clutter_effect_real_is_shape_preserving (ClutterEffect *effect)
+{
+  return FALSE;
+}
+
 static void
 clutter_effect_set_enabled (ClutterActorMeta *meta,
                             gboolean          is_enabled)
@@ -291,6 +297,7 @@ clutter_effect_class_init (ClutterEffectClass *klass)
   klass->paint = clutter_effect_real_paint;
   klass->paint_node = clutter_effect_real_paint_node;
   klass->pick = clutter_effect_real_pick;
+  klass->is_shape_preserving = clutter_effect_real_is_shape_preserving;
 }
 
 static void
@@ -395,3 +402,27 @@ clutter_effect_queue_repaint (ClutterEffect *effect)
                                       NULL, /* clip volume */
                                       effect /* effect */);
 }
+
+/**
+ * clutter_effect_is_shape_preserving:
+ * @effect: A #ClutterEffect
+ *
+ * Retrieves whether @effect preserves the shape of the actor it is
+ * applied to, that is, whether every pixel it paints is painted at the
+ * same position as, and is exactly as opaque as, the pixel the actor
+ * would have painted without the effect. Effects only changing the
+ * color of the actor, like #ClutterDesaturateEffect, are shape
+ * preserving.
+ *
+ * Compositors can keep culling opaque parts of actors that only have
+ * shape preserving effects applied.
+ *
+ * Return value: %TRUE if the effect preserves the shape of the actor
+ */
+gboolean
+clutter_effect_is_shape_preserving (ClutterEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_EFFECT (effect), FALSE);
+
+  return CLUTTER_EFFECT_GET_CLASS (effect)->is_shape_preserving (effect);
+}
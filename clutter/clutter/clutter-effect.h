@@ -50,6 +50,7 @@ G_DECLARE_DERIVABLE_TYPE (ClutterEffect,
  * @modify_paint_volume: virtual function
  * @paint: virtual function
  * @pick: virtual function
+ * @is_shape_preserving: virtual function
  *
  * The #ClutterEffectClass structure contains only private data
  */
@@ -79,11 +80,16 @@ struct _ClutterEffectClass
                                     ClutterEffectPaintFlags  flags);
   void     (* pick)                (ClutterEffect           *effect,
                                     ClutterPickContext      *pick_context);
+
+  gboolean (* is_shape_preserving) (ClutterEffect           *effect);
 };
 
 CLUTTER_EXPORT
 void    clutter_effect_queue_repaint    (ClutterEffect *effect);
 
+CLUTTER_EXPORT
+gboolean clutter_effect_is_shape_preserving (ClutterEffect *effect);
+
 /*
  * ClutterActor API
  */
@@ -403,6 +403,10 @@ typedef enum {
  *   most efficient thing to do based on its recent repaint behaviour. That
  *   means when its contents are changing less frequently than it's being used
  *   on stage.
+ * @CLUTTER_OFFSCREEN_REDIRECT_FOR_CLONES: Only redirect the actor while it
+ *   is painted more than once per frame because it, or one of its parents,
+ *   has mapped clones. The clones then paint the image of the actor instead
+ *   of painting the actor again.
  *
  * Possible flags to pass to clutter_actor_set_offscreen_redirect().
  */
@@ -410,7 +414,8 @@ typedef enum /*< prefix=CLUTTER_OFFSCREEN_REDIRECT >*/
 {
   CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY = 1 << 0,
   CLUTTER_OFFSCREEN_REDIRECT_ALWAYS                = 1 << 1,
-  CLUTTER_OFFSCREEN_REDIRECT_ON_IDLE               = 1 << 2
+  CLUTTER_OFFSCREEN_REDIRECT_ON_IDLE               = 1 << 2,
+  CLUTTER_OFFSCREEN_REDIRECT_FOR_CLONES            = 1 << 3
 } ClutterOffscreenRedirect;
 
 /**
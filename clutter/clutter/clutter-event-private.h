@@ -179,6 +179,17 @@ CLUTTER_EXPORT
 void            _clutter_event_push                     (const ClutterEvent *event,
                                                          gboolean            do_copy);
 
+CLUTTER_EXPORT
+void            _clutter_event_push_batch               (ClutterEvent **events,
+                                                         int            n_events);
+
+CLUTTER_EXPORT
+const ClutterEvent * clutter_event_peek                 (void);
+
+CLUTTER_EXPORT
+ClutterEvent *  clutter_event_coalesce_motion           (const ClutterEvent *event,
+                                                         const ClutterEvent *to_discard);
+
 CLUTTER_EXPORT
 const char * clutter_event_get_name (const ClutterEvent *event);
 
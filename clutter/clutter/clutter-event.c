@@ -977,34 +977,181 @@ ClutterEvent *
 clutter_event_get (void)
 {
   ClutterContext *context = _clutter_context_get_default ();
-  ClutterEvent *event;
+  ClutterEvent *event = NULL;
+
+  if (g_atomic_int_get (&context->n_events) == 0)
+    return NULL;
+
+  g_mutex_lock (&context->events_lock);
+
+  if (context->events && context->n_events > 0)
+    {
+      event = context->events[context->events_head];
+      context->events[context->events_head] = NULL;
+      context->events_head =
+        (context->events_head + 1) & (context->events_size - 1);
+      g_atomic_int_set (&context->n_events, context->n_events - 1);
+    }
 
-  event = g_async_queue_try_pop (context->events_queue);
+  g_mutex_unlock (&context->events_lock);
 
   return event;
 }
 
+/*< private >
+ * clutter_event_peek:
+ *
+ * Returns the event that clutter_event_get() would return next, without
+ * removing it from the queue. Only the thread getting events from the
+ * queue may call this.
+ *
+ * Returns: (transfer none) (nullable): The next event, or %NULL
+ */
+const ClutterEvent *
+clutter_event_peek (void)
+{
+  ClutterContext *context = _clutter_context_get_default ();
+  ClutterEvent *event = NULL;
+
+  if (g_atomic_int_get (&context->n_events) == 0)
+    return NULL;
+
+  g_mutex_lock (&context->events_lock);
+
+  if (context->events && context->n_events > 0)
+    event = context->events[context->events_head];
+
+  g_mutex_unlock (&context->events_lock);
+
+  return event;
+}
+
+static void
+push_event_unlocked (ClutterContext *context,
+                     ClutterEvent   *event)
+{
+  unsigned int tail;
+
+  if ((unsigned int) context->n_events == context->events_size)
+    {
+      ClutterEvent **events;
+      unsigned int i;
+
+      events = g_new0 (ClutterEvent *, context->events_size * 2);
+      for (i = 0; i < context->events_size; i++)
+        {
+          events[i] = context->events[(context->events_head + i) &
+                                      (context->events_size - 1)];
+        }
+
+      g_free (context->events);
+      context->events = events;
+      context->events_size *= 2;
+      context->events_head = 0;
+    }
+
+  tail = (context->events_head + context->n_events) &
+         (context->events_size - 1);
+  context->events[tail] = event;
+  g_atomic_int_set (&context->n_events, context->n_events + 1);
+}
+
+/*< private >
+ * _clutter_event_push_batch:
+ * @events: (array length=n_events) (transfer full): the events
+ * @n_events: the number of events
+ *
+ * Queues all @events at once, taking the queue lock and waking up the
+ * main context at most once, instead of once per event.
+ */
 void
-_clutter_event_push (const ClutterEvent *event,
-                     gboolean            do_copy)
+_clutter_event_push_batch (ClutterEvent **events,
+                           int            n_events)
 {
   ClutterContext *context = _clutter_context_get_default ();
+  gboolean was_empty;
+  int i;
 
   g_assert (context != NULL);
 
-  if (do_copy)
+  if (n_events == 0)
+    return;
+
+  g_mutex_lock (&context->events_lock);
+
+  if (!context->events)
     {
-      ClutterEvent *copy;
+      g_mutex_unlock (&context->events_lock);
 
-      copy = clutter_event_copy (event);
-      event = copy;
+      for (i = 0; i < n_events; i++)
+        clutter_event_free (events[i]);
+      return;
     }
 
-  g_async_queue_lock (context->events_queue);
-  g_async_queue_push_unlocked (context->events_queue, (gpointer) event);
-  if (g_async_queue_length_unlocked (context->events_queue) == 1)
+  was_empty = context->n_events == 0;
+
+  for (i = 0; i < n_events; i++)
+    push_event_unlocked (context, events[i]);
+
+  g_mutex_unlock (&context->events_lock);
+
+  if (was_empty)
     g_main_context_wakeup (NULL);
-  g_async_queue_unlock (context->events_queue);
+}
+
+void
+_clutter_event_push (const ClutterEvent *event,
+                     gboolean            do_copy)
+{
+  ClutterEvent *queued_event;
+
+  if (do_copy)
+    queued_event = clutter_event_copy (event);
+  else
+    queued_event = (ClutterEvent *) event;
+
+  _clutter_event_push_batch (&queued_event, 1);
+}
+
+#define INITIAL_EVENTS_QUEUE_SIZE 64
+
+void
+clutter_context_init_events_queue (ClutterContext *context)
+{
+  g_mutex_init (&context->events_lock);
+  context->events = g_new0 (ClutterEvent *, INITIAL_EVENTS_QUEUE_SIZE);
+  context->events_size = INITIAL_EVENTS_QUEUE_SIZE;
+  context->events_head = 0;
+  context->n_events = 0;
+}
+
+/* Frees all queued events, and makes any event queued afterwards be
+ * dropped.
+ */
+void
+clutter_context_clear_events_queue (ClutterContext *context)
+{
+  ClutterEvent **events;
+  unsigned int events_size, events_head;
+  int n_events, i;
+
+  g_mutex_lock (&context->events_lock);
+
+  events = g_steal_pointer (&context->events);
+  events_size = context->events_size;
+  events_head = context->events_head;
+  n_events = context->n_events;
+  g_atomic_int_set (&context->n_events, 0);
+
+  g_mutex_unlock (&context->events_lock);
+
+  if (!events)
+    return;
+
+  for (i = 0; i < n_events; i++)
+    clutter_event_free (events[(events_head + i) & (events_size - 1)]);
+
+  g_free (events);
 }
 
 /**
@@ -1037,7 +1184,7 @@ clutter_events_pending (void)
 
   g_return_val_if_fail (context != NULL, FALSE);
 
-  return g_async_queue_length (context->events_queue) > 0;
+  return g_atomic_int_get (&context->n_events) > 0;
 }
 
 /**
@@ -1738,6 +1885,88 @@ clutter_event_get_relative_motion (const ClutterEvent *event,
     return FALSE;
 }
 
+/*< private >
+ * clutter_event_coalesce_motion:
+ * @event: a motion event
+ * @to_discard: an earlier motion event of the same device
+ *
+ * Creates a motion event replacing both @to_discard and @event, with the
+ * position of @event and the accumulated relative motion of both.
+ *
+ * Returns: (transfer full) (nullable): The new event, or %NULL if the
+ *   events can't be coalesced
+ */
+ClutterEvent *
+clutter_event_coalesce_motion (const ClutterEvent *event,
+                               const ClutterEvent *to_discard)
+{
+  double dx, dy;
+  double dx_unaccel, dy_unaccel;
+  double dx_constrained, dy_constrained;
+  double dst_dx = 0.0, dst_dy = 0.0;
+  double dst_dx_unaccel = 0.0, dst_dy_unaccel = 0.0;
+  double dst_dx_constrained = 0.0, dst_dy_constrained = 0.0;
+  double *current_axes, *last_axes;
+  guint n_current_axes, n_last_axes;
+  graphene_point_t coords;
+
+  if (!clutter_event_get_relative_motion (to_discard,
+                                          &dx, &dy,
+                                          &dx_unaccel, &dy_unaccel,
+                                          &dx_constrained, &dy_constrained))
+    return NULL;
+
+  clutter_event_get_relative_motion (event,
+                                     &dst_dx, &dst_dy,
+                                     &dst_dx_unaccel, &dst_dy_unaccel,
+                                     &dst_dx_constrained, &dst_dy_constrained);
+
+  clutter_event_get_position (event, &coords);
+
+  /* All tablet axes but the wheel are absolute so we can use those
+   * as-is. But for wheels we only compress if the current value goes in the
+   * same direction.
+   */
+  current_axes = clutter_event_get_axes (to_discard, &n_current_axes);
+  last_axes = clutter_event_get_axes (event, &n_last_axes);
+
+  g_return_val_if_fail (!last_axes == !current_axes, NULL);
+
+  if (current_axes)
+    {
+      double current_val = 0.0;
+      double last_val = 0.0;
+
+      g_return_val_if_fail (n_current_axes == CLUTTER_INPUT_AXIS_LAST, NULL);
+      g_return_val_if_fail (n_last_axes == CLUTTER_INPUT_AXIS_LAST, NULL);
+      g_return_val_if_fail (n_current_axes == n_last_axes, NULL);
+
+      current_val = current_axes[CLUTTER_INPUT_AXIS_WHEEL];
+      last_val = last_axes[CLUTTER_INPUT_AXIS_WHEEL];
+
+      if ((current_val < 0.0 && last_val > 0.0) ||
+          (current_val > 0.0 && last_val < 0.0))
+        return NULL;
+
+      current_axes = g_memdup2 (current_axes, sizeof (double) * n_current_axes);
+      current_axes[CLUTTER_INPUT_AXIS_WHEEL] += last_axes[CLUTTER_INPUT_AXIS_WHEEL];
+    }
+
+  return clutter_event_motion_new (CLUTTER_EVENT_FLAG_RELATIVE_MOTION,
+                                   clutter_event_get_time_us (event),
+                                   clutter_event_get_source_device (event),
+                                   clutter_event_get_device_tool (event),
+                                   clutter_event_get_state (event),
+                                   coords,
+                                   GRAPHENE_POINT_INIT ((float) (dx + dst_dx),
+                                                        (float) (dy + dst_dy)),
+                                   GRAPHENE_POINT_INIT ((float) (dx_unaccel + dst_dx_unaccel),
+                                                        (float) (dy_unaccel + dst_dy_unaccel)),
+                                   GRAPHENE_POINT_INIT ((float) (dx_constrained + dst_dx_constrained),
+                                                        (float) (dy_constrained + dst_dy_constrained)),
+                                   current_axes);
+}
+
 const char *
 clutter_event_get_im_text (const ClutterEvent *event)
 {
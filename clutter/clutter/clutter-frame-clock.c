@@ -20,6 +20,7 @@
 #include "clutter/clutter-frame-clock.h"
 
 #include <glib/gstdio.h>
+#include <stdlib.h>
 
 #ifdef HAVE_TIMERFD
 #include <sys/timerfd.h>
@@ -42,16 +43,53 @@ enum
 
 static guint signals[N_SIGNALS];
 
+/* All frame clocks, used to order the dispatching of frame clocks that
+ * become ready at the same time. Only accessed from the main thread.
+ */
+static GList *frame_clocks;
+
 #define SYNC_DELAY_FALLBACK_FRACTION 0.875f
 
 #define MINIMUM_REFRESH_RATE 30.f
 
+#define N_FRAME_KINDS (CLUTTER_FRAME_KIND_CURSOR_ONLY + 1)
+
+/* Number of update durations kept per frame kind, about a second at 60 Hz */
+#define UPDATE_DURATION_HISTORY_SIZE 64
+
+/* Percentile of the recent update durations used as the estimate. Going
+ * for a high percentile rather than the maximum makes a single slow frame
+ * not push out the dispatch of every following frame.
+ */
+#define UPDATE_DURATION_PERCENTILE 95
+
+/* Number of presented frames kept for telemetry */
+#define FRAME_RECORD_HISTORY_SIZE 256
+
+/* Number of preceding frames described when reporting a hitch */
+#define HITCH_REPORT_N_FRAME_RECORDS 8
+
+/* How many consecutive frames need to take longer, or less long, than a
+ * refresh interval to render on the GPU to become, or stop being, GPU
+ * bound. Leaving is slower, to not flip-flop while the load varies. */
+#define GPU_BOUND_ENTER_FRAMES 8
+#define GPU_BOUND_LEAVE_FRAMES 60
+
 typedef struct _ClutterFrameListener
 {
   const ClutterFrameListenerIface *iface;
   gpointer user_data;
 } ClutterFrameListener;
 
+typedef struct _UpdateDurationHistory
+{
+  int64_t durations_us[UPDATE_DURATION_HISTORY_SIZE];
+  int n_durations;
+  int next_index;
+
+  int64_t estimate_us;
+} UpdateDurationHistory;
+
 typedef struct _ClutterClockSource
 {
   GSource source;
@@ -77,6 +115,7 @@ typedef enum _ClutterFrameClockState
 typedef struct _Frame
 {
   int use_count;
+  int64_t frame_count;
   int64_t dispatch_time_us;
   int64_t dispatch_lateness_us;
   int64_t presentation_time_us;
@@ -86,6 +125,7 @@ typedef struct _Frame
   ClutterFrameInfoFlag presentation_flags;
   gboolean has_next_presentation_time;
   gboolean got_measurements;
+  ClutterFrameKind kind;
 } Frame;
 
 struct _ClutterFrameClock
@@ -96,6 +136,11 @@ struct _ClutterFrameClock
   int64_t refresh_interval_us;
   int64_t minimum_refresh_interval_us;
 
+  /* In variable mode, throttle updates that weren't scheduled to happen
+   * immediately to the minimum refresh rate.
+   */
+  gboolean throttle_variable_updates;
+
   ClutterFrameListener listener;
 
   GSource *source;
@@ -123,12 +168,19 @@ struct _ClutterFrameClock
    */
   int64_t vblank_duration_us;
 
-  /* Last time we promoted short-term maximum to long-term one */
-  int64_t longterm_promotion_us;
-  /* Long-term maximum update duration */
-  int64_t longterm_max_update_duration_us;
-  /* Short-term maximum update duration */
-  int64_t shortterm_max_update_duration_us;
+  /* Recent update durations, by the kind of frame they were measured for */
+  UpdateDurationHistory update_duration_histories[N_FRAME_KINDS];
+
+  /* Ring buffer of the most recently presented frames */
+  ClutterFrameRecord frame_records[FRAME_RECORD_HISTORY_SIZE];
+  int n_frame_records;
+  int next_frame_record;
+
+  /* Whether GPU rendering takes longer than a refresh interval, which
+   * limits the frame rate to a fraction of the refresh rate while there
+   * can only be one frame in flight */
+  gboolean is_gpu_bound;
+  int n_gpu_bound_transition_frames;
 
   gboolean ever_got_measurements;
 
@@ -144,6 +196,10 @@ struct _ClutterFrameClock
 
   int64_t deadline_evasion_us;
 
+  /* Frames taking longer than this from dispatch to presentation are
+   * reported as hitches, or 0 to only report missed deadlines */
+  int64_t hitch_budget_us;
+
   char *output_name;
 };
 
@@ -293,34 +349,270 @@ maybe_reschedule_update (ClutterFrameClock *frame_clock)
     }
 }
 
+static int
+compare_durations (gconstpointer a,
+                   gconstpointer b)
+{
+  int64_t duration_a_us = *(const int64_t *) a;
+  int64_t duration_b_us = *(const int64_t *) b;
+
+  if (duration_a_us < duration_b_us)
+    return -1;
+  else if (duration_a_us > duration_b_us)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+add_update_duration (UpdateDurationHistory *history,
+                     int64_t                duration_us)
+{
+  int64_t sorted_durations_us[UPDATE_DURATION_HISTORY_SIZE];
+  int index;
+
+  history->durations_us[history->next_index] = duration_us;
+  history->next_index =
+    (history->next_index + 1) % UPDATE_DURATION_HISTORY_SIZE;
+  history->n_durations =
+    MIN (history->n_durations + 1, UPDATE_DURATION_HISTORY_SIZE);
+
+  memcpy (sorted_durations_us, history->durations_us,
+          history->n_durations * sizeof (int64_t));
+  qsort (sorted_durations_us, history->n_durations, sizeof (int64_t),
+         compare_durations);
+
+  index = (history->n_durations * UPDATE_DURATION_PERCENTILE + 99) / 100 - 1;
+  history->estimate_us = sorted_durations_us[CLAMP (index, 0,
+                                                    history->n_durations - 1)];
+}
+
+static ClutterFrameKind
+predict_next_frame_kind (ClutterFrameClock *frame_clock)
+{
+  const Frame *last_presentation = frame_clock->prev_presentation;
+
+  if (last_presentation)
+    return last_presentation->kind;
+  else
+    return CLUTTER_FRAME_KIND_COMPOSITED;
+}
+
+static int64_t
+estimate_update_duration_us (ClutterFrameClock *frame_clock,
+                             ClutterFrameKind   kind)
+{
+  const UpdateDurationHistory *history =
+    &frame_clock->update_duration_histories[kind];
+  int64_t max_estimate_us = 0;
+  int i;
+
+  if (history->n_durations > 0)
+    return history->estimate_us;
+
+  /* Nothing measured for this kind of frame yet, so be conservative */
+  for (i = 0; i < N_FRAME_KINDS; i++)
+    {
+      max_estimate_us =
+        MAX (max_estimate_us,
+             frame_clock->update_duration_histories[i].estimate_us);
+    }
+
+  return max_estimate_us;
+}
+
+static void
+update_gpu_bound (ClutterFrameClock *frame_clock,
+                  int64_t            gpu_duration_us)
+{
+  gboolean is_slow;
+  int n_transition_frames;
+
+  is_slow = gpu_duration_us > frame_clock->refresh_interval_us;
+  if (is_slow == frame_clock->is_gpu_bound)
+    {
+      frame_clock->n_gpu_bound_transition_frames = 0;
+      return;
+    }
+
+  n_transition_frames = frame_clock->is_gpu_bound ? GPU_BOUND_LEAVE_FRAMES
+                                                  : GPU_BOUND_ENTER_FRAMES;
+
+  frame_clock->n_gpu_bound_transition_frames++;
+  if (frame_clock->n_gpu_bound_transition_frames < n_transition_frames)
+    return;
+
+  frame_clock->is_gpu_bound = is_slow;
+  frame_clock->n_gpu_bound_transition_frames = 0;
+
+  CLUTTER_NOTE (FRAME_CLOCK, "%s GPU bound (%ld µs GPU time, %ld µs interval)",
+                frame_clock->is_gpu_bound ? "Became" : "No longer",
+                gpu_duration_us,
+                frame_clock->refresh_interval_us);
+}
+
+static const char *
+frame_clock_state_to_string (ClutterFrameClockState state)
+{
+  switch (state)
+    {
+    case CLUTTER_FRAME_CLOCK_STATE_INIT:
+      return "init";
+    case CLUTTER_FRAME_CLOCK_STATE_IDLE:
+      return "idle";
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
+      return "scheduled";
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
+      return "scheduled-now";
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
+      return "dispatching";
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      return "pending-presented";
+    }
+
+  g_assert_not_reached ();
+}
+
 static void
-maybe_update_longterm_max_duration_us (ClutterFrameClock *frame_clock,
-                                       ClutterFrameInfo  *frame_info)
+maybe_report_hitch (ClutterFrameClock        *frame_clock,
+                    const ClutterFrameRecord *record)
 {
-  /* Do not update long-term max if there has been no measurement */
-  if (!frame_clock->shortterm_max_update_duration_us)
+  g_autoptr (GString) reason = NULL;
+  int64_t duration_us = 0;
+  int n_records;
+  int i;
+
+  if (!cogl_is_flight_recorder_running ())
     return;
 
-  if ((frame_info->presentation_time - frame_clock->longterm_promotion_us) <
-      G_USEC_PER_SEC)
+  if (record->presentation_time_us != 0)
+    duration_us = record->presentation_time_us - record->dispatch_time_us;
+
+  if (!record->missed_vblank &&
+      (frame_clock->hitch_budget_us == 0 ||
+       duration_us <= frame_clock->hitch_budget_us))
     return;
 
-  if (frame_clock->longterm_max_update_duration_us >
-      frame_clock->shortterm_max_update_duration_us)
+  reason = g_string_new (NULL);
+  g_string_append_printf (reason,
+                          "Frame %ld %s on %s (%ld µs, budget %ld µs); "
+                          "mode %s, refresh interval %ld µs, state %s, "
+                          "%sGPU bound, deadline evasion %ld µs; "
+                          "previous frames:",
+                          record->frame_count,
+                          record->missed_vblank ? "missed its deadline"
+                                                : "exceeded its budget",
+                          frame_clock->output_name,
+                          duration_us,
+                          frame_clock->hitch_budget_us,
+                          frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_FIXED ?
+                          "fixed" : "variable",
+                          frame_clock->refresh_interval_us,
+                          frame_clock_state_to_string (frame_clock->state),
+                          frame_clock->is_gpu_bound ? "" : "not ",
+                          frame_clock->deadline_evasion_us);
+
+  /* The frame being reported is the most recent record */
+  n_records = MIN (frame_clock->n_frame_records - 1,
+                   HITCH_REPORT_N_FRAME_RECORDS);
+  for (i = n_records; i > 0; i--)
     {
-      /* Exponential drop-off toward the short-term max */
-      frame_clock->longterm_max_update_duration_us -=
-        (frame_clock->longterm_max_update_duration_us -
-         frame_clock->shortterm_max_update_duration_us) / 2;
+      int index = (frame_clock->next_frame_record - 1 - i +
+                   FRAME_RECORD_HISTORY_SIZE) % FRAME_RECORD_HISTORY_SIZE;
+      const ClutterFrameRecord *previous = &frame_clock->frame_records[index];
+
+      g_string_append_printf (reason, " %ld (cpu %ld µs, gpu %ld µs%s)",
+                              previous->frame_count,
+                              previous->cpu_duration_us,
+                              previous->gpu_duration_us,
+                              previous->missed_vblank ? ", missed" : "");
     }
-  else
+
+  cogl_request_flight_recorder_dump (reason->str);
+}
+
+static void
+record_presented_frame (ClutterFrameClock *frame_clock,
+                        Frame             *presented_frame,
+                        ClutterFrameInfo  *frame_info)
+{
+  ClutterFrameRecord *record;
+
+  record = &frame_clock->frame_records[frame_clock->next_frame_record];
+  frame_clock->next_frame_record =
+    (frame_clock->next_frame_record + 1) % FRAME_RECORD_HISTORY_SIZE;
+  frame_clock->n_frame_records =
+    MIN (frame_clock->n_frame_records + 1, FRAME_RECORD_HISTORY_SIZE);
+
+  *record = (ClutterFrameRecord) {
+    .frame_count = presented_frame->frame_count,
+    .dispatch_time_us = presented_frame->dispatch_time_us,
+    .presentation_time_us = frame_info->presentation_time,
+    .kind = presented_frame->kind,
+  };
+
+  if (frame_info->cpu_time_before_buffer_swap_us != 0)
     {
-      frame_clock->longterm_max_update_duration_us =
-        frame_clock->shortterm_max_update_duration_us;
+      record->cpu_duration_us = (frame_info->cpu_time_before_buffer_swap_us -
+                                 presented_frame->dispatch_time_us);
     }
 
-  frame_clock->shortterm_max_update_duration_us = 0;
-  frame_clock->longterm_promotion_us = frame_info->presentation_time;
+  if (frame_info->has_valid_gpu_rendering_duration)
+    {
+      record->gpu_duration_us = ns2us (frame_info->gpu_rendering_duration_ns);
+      update_gpu_bound (frame_clock, record->gpu_duration_us);
+    }
+
+  if (presented_frame->has_next_presentation_time &&
+      frame_info->presentation_time != 0)
+    {
+      record->missed_vblank =
+        (frame_info->presentation_time -
+         presented_frame->next_presentation_time_us) >
+        frame_clock->refresh_interval_us / 2;
+    }
+
+  maybe_report_hitch (frame_clock, record);
+}
+
+static char *
+describe_gpu_phases (ClutterFrameInfo *frame_info)
+{
+  GString *description;
+  int i, j;
+
+  description = g_string_new (NULL);
+
+  /* Phases can be entered several times per frame, e.g. once per window
+   * with an effect, so report the total time spent in each of them. */
+  for (i = 0; i < frame_info->n_gpu_phases; i++)
+    {
+      const ClutterFrameGpuPhase *gpu_phase = &frame_info->gpu_phases[i];
+      int64_t duration_ns = 0;
+
+      for (j = 0; j < i; j++)
+        {
+          if (g_str_equal (frame_info->gpu_phases[j].name, gpu_phase->name))
+            break;
+        }
+
+      if (j < i)
+        continue;
+
+      for (j = i; j < frame_info->n_gpu_phases; j++)
+        {
+          if (g_str_equal (frame_info->gpu_phases[j].name, gpu_phase->name))
+            duration_ns += frame_info->gpu_phases[j].duration_ns;
+        }
+
+      if (description->len > 0)
+        g_string_append (description, ", ");
+
+      g_string_append_printf (description, "%s %ld µs",
+                              gpu_phase->name, ns2us (duration_ns));
+    }
+
+  return g_string_free (description, FALSE);
 }
 
 void
@@ -363,6 +655,15 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
           frame_clock->n_missed_frames = n_missed_frames;
         }
 
+      if (frame_info->n_gpu_phases > 0)
+        {
+          g_autofree char *gpu_phases = NULL;
+
+          gpu_phases = describe_gpu_phases (frame_info);
+          CLUTTER_NOTE (FRAME_CLOCK, "GPU phases of frame %ld: %s",
+                        frame_info->frame_counter, gpu_phases);
+        }
+
       now_us = g_get_monotonic_time ();
       if ((now_us - frame_clock->missed_frame_report_time_us) > G_USEC_PER_SEC)
         {
@@ -411,6 +712,17 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                                   ns2us (frame_info->gpu_rendering_duration_ns));
         }
 
+      if (frame_info->n_gpu_phases > 0)
+        {
+          g_autofree char *gpu_phases = NULL;
+
+          if (description->len > 0)
+            g_string_append (description, ", ");
+
+          gpu_phases = describe_gpu_phases (frame_info);
+          g_string_append_printf (description, "GPU phases: %s", gpu_phases);
+        }
+
       COGL_TRACE_DESCRIBE (ClutterFrameClockNotifyPresented, description->str);
     }
 #endif
@@ -444,14 +756,14 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                     swap_to_rendering_done_us,
                     swap_to_flip_us);
 
-      frame_clock->shortterm_max_update_duration_us =
-        CLAMP (presented_frame->dispatch_lateness_us + dispatch_to_swap_us +
-               MAX (swap_to_rendering_done_us, swap_to_flip_us) +
-               frame_clock->deadline_evasion_us,
-               frame_clock->shortterm_max_update_duration_us,
-               frame_clock->refresh_interval_us);
-
-      maybe_update_longterm_max_duration_us (frame_clock, frame_info);
+      add_update_duration (&frame_clock->update_duration_histories[presented_frame->kind],
+                           CLAMP (presented_frame->dispatch_lateness_us +
+                                  dispatch_to_swap_us +
+                                  MAX (swap_to_rendering_done_us,
+                                       swap_to_flip_us) +
+                                  frame_clock->deadline_evasion_us,
+                                  0,
+                                  frame_clock->refresh_interval_us));
 
       presented_frame->got_measurements = TRUE;
       frame_clock->ever_got_measurements = TRUE;
@@ -462,6 +774,8 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                     presented_frame->dispatch_lateness_us);
     }
 
+  record_presented_frame (frame_clock, presented_frame, frame_info);
+
   if (frame_info->refresh_rate > 1.0)
     {
       clutter_frame_clock_set_refresh_rate (frame_clock,
@@ -532,10 +846,14 @@ clutter_frame_clock_compute_max_render_time_us (ClutterFrameClock *frame_clock)
    *   in parallel.
    * - The duration of vertical blank.
    * - A constant to account for variations in the above estimates.
+   *
+   * The update duration is estimated from recent frames of the same kind as
+   * the last presented one, as e.g. frames with offscreen effects or direct
+   * scanout frames tend to take very different amounts of time.
    */
   max_render_time_us =
-    MAX (frame_clock->longterm_max_update_duration_us,
-         frame_clock->shortterm_max_update_duration_us) +
+    estimate_update_duration_us (frame_clock,
+                                 predict_next_frame_kind (frame_clock)) +
     frame_clock->vblank_duration_us +
     clutter_max_render_time_constant_us;
 
@@ -669,8 +987,17 @@ calculate_next_update_time_us (ClutterFrameClock *frame_clock,
         }
     }
 
-  if (last_presentation->presentation_flags & CLUTTER_FRAME_INFO_FLAG_VSYNC &&
-      next_presentation_time_us != last_presentation_time_us + refresh_interval_us)
+  if (last_presentation->presentation_flags & CLUTTER_FRAME_INFO_FLAG_ASYNC)
+    {
+      /* The last frame was flipped asynchronously, without waiting for the
+       * vertical retrace, so the next one can be too; there is no point in
+       * aligning its update to the refresh cycle.
+       */
+      next_update_time_us = now_us;
+      min_render_time_allowed_us = 0;
+    }
+  else if (last_presentation->presentation_flags & CLUTTER_FRAME_INFO_FLAG_VSYNC &&
+           next_presentation_time_us != last_presentation_time_us + refresh_interval_us)
     {
       /* There was an idle period since the last presentation, so there seems
        * be no constantly updating actor. In this case it's best to start
@@ -762,7 +1089,14 @@ calculate_next_variable_update_timeout_us (ClutterFrameClock *frame_clock,
 
   now_us = g_get_monotonic_time ();
 
-  timeout_interval_us = frame_clock->minimum_refresh_interval_us;
+  /* Running animations, or anything else visible while throttling is
+   * disabled, should not be held back by the content driving the refresh
+   * rate, so update those at the maximum refresh rate.
+   */
+  if (frame_clock->throttle_variable_updates && !frame_clock->timelines)
+    timeout_interval_us = frame_clock->minimum_refresh_interval_us;
+  else
+    timeout_interval_us = frame_clock->refresh_interval_us;
 
   if (!last_presentation || last_presentation->presentation_time_us == 0)
     {
@@ -1044,6 +1378,7 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
   frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_DISPATCHING;
 
   frame_count = frame_clock->frame_count++;
+  this_dispatch->frame_count = frame_count;
 
   if (iface->new_frame)
     frame = iface->new_frame (frame_clock, frame_clock->listener.user_data);
@@ -1072,6 +1407,8 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
   result = iface->frame (frame_clock, frame, frame_clock->listener.user_data);
   COGL_TRACE_END (ClutterFrameClockFrame);
 
+  this_dispatch->kind = frame->kind;
+
   switch (frame_clock->state)
     {
     case CLUTTER_FRAME_CLOCK_STATE_INIT:
@@ -1107,16 +1444,109 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
 #endif
 }
 
+static gboolean
+was_dispatched_at (ClutterFrameClock *frame_clock,
+                   int64_t            time_us)
+{
+  return (frame_clock->prev_dispatch &&
+          frame_clock->prev_dispatch->dispatch_time_us == time_us);
+}
+
+static gboolean
+is_ready_for_dispatch (ClutterFrameClock *frame_clock,
+                       int64_t            time_us)
+{
+  int64_t ready_time_us;
+
+  switch (frame_clock->state)
+    {
+    case CLUTTER_FRAME_CLOCK_STATE_INIT:
+    case CLUTTER_FRAME_CLOCK_STATE_IDLE:
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      return FALSE;
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
+      break;
+    }
+
+  ready_time_us = g_source_get_ready_time (frame_clock->source);
+  if (ready_time_us == -1 || ready_time_us > time_us)
+    return FALSE;
+
+  return !was_dispatched_at (frame_clock, time_us);
+}
+
+static ClutterFrameClock *
+find_more_urgent_frame_clock (ClutterFrameClock *frame_clock,
+                              int64_t            time_us)
+{
+  ClutterFrameClock *most_urgent = NULL;
+  int64_t deadline_us;
+  GList *l;
+
+  if (frame_clock->has_next_frame_deadline)
+    deadline_us = frame_clock->next_frame_deadline_us;
+  else
+    deadline_us = G_MAXINT64;
+
+  for (l = frame_clocks; l; l = l->next)
+    {
+      ClutterFrameClock *other_frame_clock = l->data;
+
+      if (other_frame_clock == frame_clock)
+        continue;
+
+      if (!other_frame_clock->has_next_frame_deadline ||
+          other_frame_clock->next_frame_deadline_us >= deadline_us)
+        continue;
+
+      if (!is_ready_for_dispatch (other_frame_clock, time_us))
+        continue;
+
+      most_urgent = other_frame_clock;
+      deadline_us = other_frame_clock->next_frame_deadline_us;
+    }
+
+  return most_urgent;
+}
+
 static gboolean
 frame_clock_source_dispatch (GSource     *source,
                              GSourceFunc  callback,
                              gpointer     user_data)
 {
   ClutterClockSource *clock_source = (ClutterClockSource *) source;
-  ClutterFrameClock *frame_clock = clock_source->frame_clock;
+  g_autoptr (ClutterFrameClock) frame_clock = NULL;
+  ClutterFrameClock *more_urgent_frame_clock;
   int64_t dispatch_time_us;
 
+  frame_clock = g_object_ref (clock_source->frame_clock);
   dispatch_time_us = g_source_get_time (source);
+
+  /* Frame clocks of different outputs often become ready in the same main
+   * loop iteration, e.g. when their refresh cycles are in phase. They are
+   * painted one after the other, so dispatch the one closest to missing
+   * its deadline first, instead of in the order the sources were attached
+   * in.
+   */
+  while ((more_urgent_frame_clock =
+          find_more_urgent_frame_clock (frame_clock, dispatch_time_us)))
+    {
+      g_autoptr (ClutterFrameClock) other_frame_clock =
+        g_object_ref (more_urgent_frame_clock);
+
+      clutter_frame_clock_dispatch (other_frame_clock, dispatch_time_us);
+    }
+
+  if (g_source_is_destroyed (source))
+    return G_SOURCE_REMOVE;
+
+  /* Already dispatched by another frame clock this iteration */
+  if (g_source_get_ready_time (source) == -1 ||
+      was_dispatched_at (frame_clock, dispatch_time_us))
+    return G_SOURCE_CONTINUE;
+
   clutter_frame_clock_dispatch (frame_clock, dispatch_time_us);
 
   return G_SOURCE_CONTINUE;
@@ -1131,12 +1561,66 @@ clutter_frame_clock_record_flip_time (ClutterFrameClock *frame_clock,
   new_frame->flip_time_us = flip_time_us;
 }
 
+/**
+ * clutter_frame_clock_get_frame_records: (skip)
+ * @frame_clock: a #ClutterFrameClock
+ *
+ * Retrieves the records of the most recently presented frames, oldest
+ * first.
+ *
+ * Returns: (transfer full): A #GArray of #ClutterFrameRecord
+ */
+GArray *
+clutter_frame_clock_get_frame_records (ClutterFrameClock *frame_clock)
+{
+  GArray *records;
+  int first_record;
+  int i;
+
+  records = g_array_sized_new (FALSE, FALSE, sizeof (ClutterFrameRecord),
+                               frame_clock->n_frame_records);
+
+  first_record = (frame_clock->next_frame_record -
+                  frame_clock->n_frame_records +
+                  FRAME_RECORD_HISTORY_SIZE) % FRAME_RECORD_HISTORY_SIZE;
+
+  for (i = 0; i < frame_clock->n_frame_records; i++)
+    {
+      int index = (first_record + i) % FRAME_RECORD_HISTORY_SIZE;
+
+      g_array_append_val (records, frame_clock->frame_records[index]);
+    }
+
+  return records;
+}
+
+static const char *
+frame_kind_to_string (ClutterFrameKind kind)
+{
+  switch (kind)
+    {
+    case CLUTTER_FRAME_KIND_COMPOSITED:
+      return "composited";
+    case CLUTTER_FRAME_KIND_COMPOSITED_WITH_EFFECTS:
+      return "composited with effects";
+    case CLUTTER_FRAME_KIND_DIRECT_SCANOUT:
+      return "direct scanout";
+    case CLUTTER_FRAME_KIND_CURSOR_ONLY:
+      return "cursor only";
+    }
+
+  g_assert_not_reached ();
+}
+
 GString *
 clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clock)
 {
   const Frame *last_presentation = frame_clock->prev_presentation;
-  int64_t max_update_duration_us;
+  ClutterFrameKind next_frame_kind;
   GString *string;
+  int i;
+
+  next_frame_kind = predict_next_frame_kind (frame_clock);
 
   string = g_string_new (NULL);
   g_string_append_printf (string, "Max render time: %ld µs",
@@ -1147,17 +1631,41 @@ clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clo
   else
     g_string_append_printf (string, " (no measurements last frame)");
 
-  max_update_duration_us =
-    MAX (frame_clock->longterm_max_update_duration_us,
-         frame_clock->shortterm_max_update_duration_us);
-
   g_string_append_printf (string, "\nVblank duration: %ld µs +",
                           frame_clock->vblank_duration_us);
-  g_string_append_printf (string, "\nUpdate duration: %ld µs +",
-                          max_update_duration_us);
+  g_string_append_printf (string, "\nUpdate duration (%s): %ld µs +",
+                          frame_kind_to_string (next_frame_kind),
+                          estimate_update_duration_us (frame_clock,
+                                                       next_frame_kind));
   g_string_append_printf (string, "\nConstant: %d µs",
                           clutter_max_render_time_constant_us);
 
+  g_string_append_printf (string, "\nBuffering: double buffered%s",
+                          frame_clock->is_gpu_bound ?
+                          ", GPU bound" : "");
+
+  for (i = 0; i < N_FRAME_KINDS; i++)
+    {
+      const UpdateDurationHistory *history =
+        &frame_clock->update_duration_histories[i];
+
+      g_string_append_printf (string,
+                              "\nP%d update duration (%s): ",
+                              UPDATE_DURATION_PERCENTILE,
+                              frame_kind_to_string (i));
+
+      if (history->n_durations > 0)
+        {
+          g_string_append_printf (string, "%ld µs (%d frames)",
+                                  history->estimate_us,
+                                  history->n_durations);
+        }
+      else
+        {
+          g_string_append (string, "no measurements");
+        }
+    }
+
   return string;
 }
 
@@ -1282,11 +1790,13 @@ clutter_frame_clock_new (float                            refresh_rate,
   frame_clock->listener.user_data = user_data;
 
   init_frame_clock_source (frame_clock);
+  frame_clocks = g_list_prepend (frame_clocks, frame_clock);
 
   clutter_frame_clock_set_refresh_rate (frame_clock, refresh_rate);
 
   frame_clock->minimum_refresh_interval_us =
     (int64_t) (0.5 + G_USEC_PER_SEC / MINIMUM_REFRESH_RATE);
+  frame_clock->throttle_variable_updates = TRUE;
 
   frame_clock->vblank_duration_us = vblank_duration_us;
 
@@ -1312,6 +1822,7 @@ clutter_frame_clock_dispose (GObject *object)
   if (frame_clock->source)
     {
       g_signal_emit (frame_clock, signals[DESTROY], 0);
+      frame_clocks = g_list_remove (frame_clocks, frame_clock);
       g_source_destroy (frame_clock->source);
       g_clear_pointer (&frame_clock->source, g_source_unref);
     }
@@ -1351,3 +1862,50 @@ clutter_frame_clock_set_deadline_evasion (ClutterFrameClock *frame_clock,
 {
   frame_clock->deadline_evasion_us = deadline_evasion_us;
 }
+
+/**
+ * clutter_frame_clock_set_hitch_budget:
+ * @frame_clock: a #ClutterFrameClock
+ * @budget_us: the budget in microseconds, or 0
+ *
+ * Sets how long a frame may take from being dispatched until it is
+ * presented before it counts as a hitch. Hitches, as well as frames that
+ * miss their deadline, are reported to the flight recorder, if running.
+ */
+void
+clutter_frame_clock_set_hitch_budget (ClutterFrameClock *frame_clock,
+                                      int64_t            budget_us)
+{
+  frame_clock->hitch_budget_us = budget_us;
+}
+
+/**
+ * clutter_frame_clock_set_throttle_variable_updates:
+ * @frame_clock: a #ClutterFrameClock
+ * @throttle: whether to throttle updates in variable mode
+ *
+ * In variable mode, updates scheduled with
+ * clutter_frame_clock_schedule_update_now() are presented as soon as
+ * possible, while other updates are throttled to the minimum refresh
+ * rate, so that they don't disturb the cadence of the content driving
+ * the refresh rate. When that content doesn't cover the whole view, other
+ * content may be visible as well, and throttling should be disabled so
+ * that it is still updated at the maximum refresh rate.
+ */
+void
+clutter_frame_clock_set_throttle_variable_updates (ClutterFrameClock *frame_clock,
+                                                   gboolean           throttle)
+{
+  if (frame_clock->throttle_variable_updates == throttle)
+    return;
+
+  frame_clock->throttle_variable_updates = throttle;
+
+  if (frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_VARIABLE &&
+      frame_clock->state == CLUTTER_FRAME_CLOCK_STATE_SCHEDULED)
+    {
+      frame_clock->pending_reschedule = TRUE;
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+      maybe_reschedule_update (frame_clock);
+    }
+}
@@ -33,6 +33,51 @@ typedef enum _ClutterFrameResult
   CLUTTER_FRAME_RESULT_IDLE,
 } ClutterFrameResult;
 
+/**
+ * ClutterFrameKind:
+ * @CLUTTER_FRAME_KIND_COMPOSITED: The stage was painted
+ * @CLUTTER_FRAME_KIND_COMPOSITED_WITH_EFFECTS: The stage was painted, and
+ *   at least one offscreen effect had to be redrawn
+ * @CLUTTER_FRAME_KIND_DIRECT_SCANOUT: A client buffer was scanned out
+ *   directly, without painting the stage
+ * @CLUTTER_FRAME_KIND_CURSOR_ONLY: Nothing but the cursor was updated
+ *
+ * What kind of work a frame involved. The frame clock keeps separate
+ * update duration histories for each kind.
+ */
+typedef enum _ClutterFrameKind
+{
+  CLUTTER_FRAME_KIND_COMPOSITED,
+  CLUTTER_FRAME_KIND_COMPOSITED_WITH_EFFECTS,
+  CLUTTER_FRAME_KIND_DIRECT_SCANOUT,
+  CLUTTER_FRAME_KIND_CURSOR_ONLY,
+} ClutterFrameKind;
+
+/**
+ * ClutterFrameRecord:
+ * @frame_count: The frame count of the frame
+ * @dispatch_time_us: When the frame clock was dispatched for the frame
+ * @cpu_duration_us: Time from dispatch until the buffer swap, or 0 if not
+ *   measured
+ * @gpu_duration_us: Time from the buffer swap until the GPU finished
+ *   rendering, or 0 if not measured
+ * @presentation_time_us: When the frame was presented, or 0 if unknown
+ * @missed_vblank: Whether the frame was presented later than targeted
+ * @kind: The kind of the frame
+ *
+ * Timings of a presented frame, as recorded by the frame clock.
+ */
+typedef struct _ClutterFrameRecord
+{
+  int64_t frame_count;
+  int64_t dispatch_time_us;
+  int64_t cpu_duration_us;
+  int64_t gpu_duration_us;
+  int64_t presentation_time_us;
+  gboolean missed_vblank;
+  ClutterFrameKind kind;
+} ClutterFrameRecord;
+
 #define CLUTTER_TYPE_FRAME_CLOCK (clutter_frame_clock_get_type ())
 CLUTTER_EXPORT
 G_DECLARE_FINAL_TYPE (ClutterFrameClock, clutter_frame_clock,
@@ -107,6 +152,17 @@ void clutter_frame_clock_record_flip_time (ClutterFrameClock *frame_clock,
 
 GString * clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clock);
 
+CLUTTER_EXPORT
+GArray * clutter_frame_clock_get_frame_records (ClutterFrameClock *frame_clock);
+
 CLUTTER_EXPORT
 void clutter_frame_clock_set_deadline_evasion (ClutterFrameClock *frame_clock,
                                                int64_t            deadline_evasion_us);
+
+CLUTTER_EXPORT
+void clutter_frame_clock_set_hitch_budget (ClutterFrameClock *frame_clock,
+                                           int64_t            budget_us);
+
+CLUTTER_EXPORT
+void clutter_frame_clock_set_throttle_variable_updates (ClutterFrameClock *frame_clock,
+                                                        gboolean           throttle);
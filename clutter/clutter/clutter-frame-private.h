@@ -36,6 +36,8 @@ struct _ClutterFrame
 
   gboolean has_result;
   ClutterFrameResult result;
+
+  ClutterFrameKind kind;
 };
 
 CLUTTER_EXPORT
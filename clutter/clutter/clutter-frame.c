@@ -115,3 +115,16 @@ clutter_frame_set_result (ClutterFrame       *frame,
   frame->result = result;
   frame->has_result = TRUE;
 }
+
+void
+clutter_frame_set_kind (ClutterFrame     *frame,
+                        ClutterFrameKind  kind)
+{
+  frame->kind = kind;
+}
+
+ClutterFrameKind
+clutter_frame_get_kind (ClutterFrame *frame)
+{
+  return frame->kind;
+}
@@ -85,6 +85,7 @@
 
 #include "clutter-gesture.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-marshal.h"
@@ -132,6 +133,13 @@ struct _ClutterGesturePrivate
   GPtrArray *cancel_on_recognizing;
 
   GHashTable *can_not_cancel;
+
+  /* The actor transformation is computed at most once per event, as
+   * implementations tend to look at the coordinates of all points. */
+  gboolean in_event;
+  gboolean stage_point_transform_valid;
+  gboolean has_stage_point_transform;
+  ClutterStagePointTransform stage_point_transform;
 };
 
 enum
@@ -820,10 +828,9 @@ is_sequence_end_event (const ClutterEvent *event)
 }
 
 static gboolean
-clutter_gesture_handle_event (ClutterAction      *action,
-                              const ClutterEvent *event)
+handle_event (ClutterGesture     *self,
+              const ClutterEvent *event)
 {
-  ClutterGesture *self = CLUTTER_GESTURE (action);
   ClutterGesturePrivate *priv = clutter_gesture_get_instance_private (self);
   ClutterGestureClass *gesture_class = CLUTTER_GESTURE_GET_CLASS (self);
   ClutterInputDevice *device = clutter_event_get_device (event);
@@ -975,6 +982,26 @@ clutter_gesture_handle_event (ClutterAction      *action,
   return CLUTTER_EVENT_PROPAGATE;
 }
 
+static gboolean
+clutter_gesture_handle_event (ClutterAction      *action,
+                              const ClutterEvent *event)
+{
+  ClutterGesture *self = CLUTTER_GESTURE (action);
+  ClutterGesturePrivate *priv = clutter_gesture_get_instance_private (self);
+  gboolean was_in_event = priv->in_event;
+  gboolean retval;
+
+  priv->in_event = TRUE;
+  priv->stage_point_transform_valid = FALSE;
+
+  retval = handle_event (self, event);
+
+  priv->in_event = was_in_event;
+  priv->stage_point_transform_valid = FALSE;
+
+  return retval;
+}
+
 static void
 clutter_gesture_sequence_cancelled (ClutterAction        *action,
                                     ClutterInputDevice   *device,
@@ -1584,6 +1611,41 @@ clutter_gesture_get_points (ClutterGesture *self,
   return (unsigned int *) g_array_steal (points, n_points);
 }
 
+static void
+transform_stage_point (ClutterGesture   *self,
+                       graphene_point_t *coords)
+{
+  ClutterGesturePrivate *priv = clutter_gesture_get_instance_private (self);
+  ClutterActor *action_actor;
+
+  action_actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (self));
+  if (!action_actor)
+    return;
+
+  if (!priv->in_event)
+    {
+      clutter_actor_transform_stage_point (action_actor,
+                                           coords->x, coords->y,
+                                           &coords->x, &coords->y);
+      return;
+    }
+
+  if (!priv->stage_point_transform_valid)
+    {
+      priv->has_stage_point_transform =
+        clutter_actor_get_stage_point_transform (action_actor,
+                                                 &priv->stage_point_transform);
+      priv->stage_point_transform_valid = TRUE;
+    }
+
+  if (priv->has_stage_point_transform)
+    {
+      clutter_stage_point_transform_apply (&priv->stage_point_transform,
+                                           coords->x, coords->y,
+                                           &coords->x, &coords->y);
+    }
+}
+
 /**
  * clutter_gesture_get_point_coords:
  * @self: a #ClutterGesture
@@ -1599,8 +1661,7 @@ clutter_gesture_get_point_coords (ClutterGesture   *self,
 {
   ClutterGesturePrivate *priv;
   GestureSequenceData *seq_data;
-  ClutterActor *action_actor;
-  
+
   g_return_if_fail (CLUTTER_IS_GESTURE (self));
   g_return_if_fail (coords_out != NULL);
 
@@ -1611,13 +1672,7 @@ clutter_gesture_get_point_coords (ClutterGesture   *self,
 
   clutter_event_get_position (seq_data->latest_event, coords_out);
 
-  action_actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (self));
-  if (action_actor)
-    {
-      clutter_actor_transform_stage_point (action_actor,
-                                           coords_out->x, coords_out->y,
-                                           &coords_out->x, &coords_out->y);
-    }
+  transform_stage_point (self, coords_out);
 }
 
 /**
@@ -1657,7 +1712,6 @@ clutter_gesture_get_point_begin_coords (ClutterGesture   *self,
 {
   ClutterGesturePrivate *priv;
   GestureSequenceData *seq_data;
-  ClutterActor *action_actor;
 
   g_return_if_fail (CLUTTER_IS_GESTURE (self));
   g_return_if_fail (coords_out != NULL);
@@ -1669,13 +1723,7 @@ clutter_gesture_get_point_begin_coords (ClutterGesture   *self,
 
   clutter_event_get_position (seq_data->begin_event, coords_out);
 
-  action_actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (self));
-  if (action_actor)
-    {
-      clutter_actor_transform_stage_point (action_actor,
-                                           coords_out->x, coords_out->y,
-                                           &coords_out->x, &coords_out->y);
-    }
+  transform_stage_point (self, coords_out);
 }
 
 /**
@@ -1715,7 +1763,6 @@ clutter_gesture_get_point_previous_coords (ClutterGesture   *self,
 {
   ClutterGesturePrivate *priv;
   GestureSequenceData *seq_data;
-  ClutterActor *action_actor;
 
   g_return_if_fail (CLUTTER_IS_GESTURE (self));
   g_return_if_fail (coords_out != NULL);
@@ -1727,13 +1774,7 @@ clutter_gesture_get_point_previous_coords (ClutterGesture   *self,
 
   clutter_event_get_position (seq_data->previous_event, coords_out);
 
-  action_actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (self));
-  if (action_actor)
-    {
-      clutter_actor_transform_stage_point (action_actor,
-                                           coords_out->x, coords_out->y,
-                                           &coords_out->x, &coords_out->y);
-    }
+  transform_stage_point (self, coords_out);
 }
 
 /**
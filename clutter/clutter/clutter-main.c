@@ -544,22 +544,8 @@ void
 _clutter_clear_events_queue (void)
 {
   ClutterContext *context = _clutter_context_get_default ();
-  ClutterEvent *event;
-  GAsyncQueue *events_queue;
 
-  if (!context->events_queue)
-    return;
-
-  g_async_queue_lock (context->events_queue);
-
-  while ((event = g_async_queue_try_pop_unlocked (context->events_queue)))
-    clutter_event_free (event);
-
-  events_queue = context->events_queue;
-  context->events_queue = NULL;
-
-  g_async_queue_unlock (events_queue);
-  g_async_queue_unref (events_queue);
+  clutter_context_clear_events_queue (context);
 }
 
 /**
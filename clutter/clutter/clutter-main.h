@@ -62,6 +62,7 @@ typedef enum
 typedef enum
 {
   CLUTTER_DEBUG_NOP_PICKING = 1 << 0,
+  CLUTTER_DEBUG_DISABLE_PICK_CACHE = 1 << 1,
 } ClutterPickDebugFlag;
 
 typedef enum
@@ -77,6 +78,7 @@ typedef enum
   CLUTTER_DEBUG_PAINT_DAMAGE_REGION             = 1 << 8,
   CLUTTER_DEBUG_DISABLE_DYNAMIC_MAX_RENDER_TIME = 1 << 9,
   CLUTTER_DEBUG_PAINT_MAX_RENDER_TIME           = 1 << 10,
+  CLUTTER_DEBUG_DISABLE_SHADOWFB_DAMAGE_DETECTION = 1 << 11,
 } ClutterDrawDebugFlag;
 
 /**
@@ -26,6 +26,7 @@
 
 #include "clutter/clutter-backend.h"
 #include "clutter/clutter-backend-private.h"
+#include "clutter/clutter-blur-private.h"
 #include "clutter/clutter-damage-history.h"
 #include "clutter/clutter-event-private.h"
 #include "clutter/clutter-frame-private.h"
@@ -114,9 +115,15 @@ void clutter_get_debug_flags (ClutterDebugFlag     *debug_flags,
 CLUTTER_EXPORT
 void clutter_actor_notify_transform_invalid (ClutterActor *self);
 
+CLUTTER_EXPORT
+void clutter_actor_invalidate_pick (ClutterActor *self);
+
 CLUTTER_EXPORT
 void clutter_actor_get_relative_transformation_matrix (ClutterActor      *self,
                                                        ClutterActor      *ancestor,
                                                        graphene_matrix_t *matrix);
 
+CLUTTER_EXPORT
+void clutter_blur_prewarm (CoglContext *cogl_context);
+
 #undef __CLUTTER_H_INSIDE__
@@ -89,6 +89,7 @@
 
 #include "clutter/clutter-offscreen-effect.h"
 
+#include <float.h>
 #include <math.h>
 
 #include "cogl/cogl.h"
@@ -122,6 +123,9 @@ typedef struct _ClutterOffscreenEffectPrivate
   int target_width;
   int target_height;
 
+  /* The resource scale the cached image was painted with */
+  float resource_scale;
+
   gulong purge_handler_id;
 } ClutterOffscreenEffectPrivate;
 
@@ -414,6 +418,8 @@ clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
 
   cogl_framebuffer_set_projection_matrix (offscreen, &projection);
 
+  priv->resource_scale = resource_scale;
+
   return TRUE;
 
 disable_effect:
@@ -567,10 +573,31 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
     }
 
   /* If we've already got a cached image and the actor hasn't been redrawn
-   * then we can just use the cached image in the FBO.
+   * then we can just use the cached image in the FBO. Changes of the opacity
+   * or transformation of the actor alone keep it clean, but moving it to a
+   * monitor with a different scale means the image has to be painted again.
    */
-  if (priv->offscreen == NULL || (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY))
-    parent_class->paint (effect, node, paint_context, flags);
+  if (priv->offscreen == NULL ||
+      (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY) ||
+      !G_APPROX_VALUE (priv->resource_scale,
+                       clutter_actor_get_real_resource_scale (priv->actor),
+                       FLT_EPSILON))
+    {
+      ClutterFrame *frame = clutter_paint_context_get_frame (paint_context);
+      const char *prev_gpu_phase;
+
+      if (frame &&
+          clutter_frame_get_kind (frame) == CLUTTER_FRAME_KIND_COMPOSITED)
+        {
+          clutter_frame_set_kind (frame,
+                                  CLUTTER_FRAME_KIND_COMPOSITED_WITH_EFFECTS);
+        }
+
+      prev_gpu_phase = clutter_paint_context_begin_gpu_phase (paint_context,
+                                                              "effects");
+      parent_class->paint (effect, node, paint_context, flags);
+      clutter_paint_context_begin_gpu_phase (paint_context, prev_gpu_phase);
+    }
   else
     clutter_offscreen_effect_paint_texture (self, node, paint_context);
 }
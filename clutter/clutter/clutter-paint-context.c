@@ -260,6 +260,36 @@ clutter_paint_context_get_frame (ClutterPaintContext *paint_context)
   return paint_context->frame;
 }
 
+/**
+ * clutter_paint_context_begin_gpu_phase: (skip)
+ * @paint_context: The #ClutterPaintContext
+ * @name: A static string naming the phase
+ *
+ * Starts timing the GPU work of what is painted next as a phase of the frame,
+ * see cogl_onscreen_begin_gpu_phase(). Only paints of stage views done for a
+ * frame are timed.
+ *
+ * Returns: (nullable): The name of the phase that was ended, to be passed
+ *   back once the new phase is done
+ */
+const char *
+clutter_paint_context_begin_gpu_phase (ClutterPaintContext *paint_context,
+                                       const char          *name)
+{
+  CoglFramebuffer *onscreen;
+
+  if (!name || !paint_context->view || !paint_context->frame)
+    return NULL;
+
+  onscreen = clutter_stage_view_get_onscreen (paint_context->view);
+  if (!COGL_IS_ONSCREEN (onscreen))
+    return NULL;
+
+  return cogl_onscreen_begin_gpu_phase (COGL_ONSCREEN (onscreen),
+                                        clutter_paint_context_get_framebuffer (paint_context),
+                                        name);
+}
+
 void
 clutter_paint_context_push_target_color_state (ClutterPaintContext *paint_context,
                                                ClutterColorState   *color_state)
@@ -78,6 +78,10 @@ ClutterPaintFlag clutter_paint_context_get_paint_flags (ClutterPaintContext *pai
 CLUTTER_EXPORT
 ClutterFrame * clutter_paint_context_get_frame (ClutterPaintContext *paint_context);
 
+CLUTTER_EXPORT
+const char * clutter_paint_context_begin_gpu_phase (ClutterPaintContext *paint_context,
+                                                    const char          *name);
+
 CLUTTER_EXPORT
 void clutter_paint_context_push_color_state (ClutterPaintContext *paint_context,
                                              ClutterColorState   *color_state);
@@ -62,6 +62,42 @@ static inline void      clutter_paint_operation_clear   (ClutterPaintOperation *
 static void clutter_paint_node_remove_child (ClutterPaintNode *node,
                                              ClutterPaintNode *child);
 
+/* Most frames create and destroy about as many paint nodes as the frame
+ * before, so keep the operation arrays of destroyed nodes around for new
+ * nodes to reuse, instead of reallocating them for every frame.
+ */
+#define MAX_POOLED_OPERATIONS 256
+
+static GPtrArray *operations_pool = NULL;
+
+static GArray *
+acquire_operations (void)
+{
+  if (operations_pool && operations_pool->len > 0)
+    {
+      return g_ptr_array_steal_index_fast (operations_pool,
+                                           operations_pool->len - 1);
+    }
+
+  return g_array_new (FALSE, FALSE, sizeof (ClutterPaintOperation));
+}
+
+static void
+release_operations (GArray *operations)
+{
+  if (!operations_pool)
+    operations_pool = g_ptr_array_sized_new (MAX_POOLED_OPERATIONS);
+
+  if (operations_pool->len >= MAX_POOLED_OPERATIONS)
+    {
+      g_array_unref (operations);
+      return;
+    }
+
+  g_array_set_size (operations, 0);
+  g_ptr_array_add (operations_pool, operations);
+}
+
 static void
 value_paint_node_init (GValue *value)
 {
@@ -170,7 +206,7 @@ clutter_paint_node_real_finalize (ClutterPaintNode *node)
           clutter_paint_operation_clear (op);
         }
 
-      g_array_unref (node->operations);
+      release_operations (g_steal_pointer (&node->operations));
     }
 
   iter = node->first_child;
@@ -668,8 +704,7 @@ clutter_paint_node_maybe_init_operations (ClutterPaintNode *node)
   if (node->operations != NULL)
     return;
 
-  node->operations =
-    g_array_new (FALSE, FALSE, sizeof (ClutterPaintOperation));
+  node->operations = acquire_operations ();
 }
 
 /**
@@ -33,6 +33,7 @@
 #include "clutter/pango/clutter-pango-private.h"
 #include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-blur-private.h"
+#include "clutter/clutter-context-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-private.h"
 #include "clutter/clutter-paint-context-private.h"
@@ -1198,9 +1199,12 @@ clutter_layer_node_pre_draw (ClutterPaintNode *node,
   color_state = clutter_paint_context_get_color_state (paint_context);
   clutter_paint_context_push_target_color_state (paint_context, color_state);
 
-  /* clear out the target framebuffer */
+  /* clear out the target framebuffer. Clearing all of the buffers lets
+   * tiled GPUs start rendering without loading any previous contents */
   cogl_framebuffer_clear4f (lnode->offscreen,
-                            COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_DEPTH,
+                            (COGL_BUFFER_BIT_COLOR |
+                             COGL_BUFFER_BIT_DEPTH |
+                             COGL_BUFFER_BIT_STENCIL),
                             0.f, 0.f, 0.f, 0.f);
 
   cogl_framebuffer_push_matrix (lnode->offscreen);
@@ -1220,6 +1224,12 @@ clutter_layer_node_post_draw (ClutterPaintNode    *node,
   CoglFramebuffer *fb;
   guint i;
 
+  /* Only the color buffer is used after this, so tiled GPUs don't
+   * need to write the depth and stencil buffers back to memory */
+  cogl_framebuffer_discard_buffers (lnode->offscreen,
+                                    COGL_BUFFER_BIT_DEPTH |
+                                    COGL_BUFFER_BIT_STENCIL);
+
   /* switch to the previous framebuffer */
   cogl_framebuffer_pop_matrix (lnode->offscreen);
   clutter_paint_context_pop_framebuffer (paint_context);
@@ -1536,6 +1546,9 @@ struct _ClutterBlurNode
   ClutterLayerNode parent_instance;
 
   ClutterBlur *blur;
+
+  /* Where the blurred texture was painted to */
+  CoglFramebuffer *target_framebuffer;
 };
 
 G_DEFINE_TYPE (ClutterBlurNode, clutter_blur_node, CLUTTER_TYPE_LAYER_NODE)
@@ -1551,6 +1564,9 @@ clutter_blur_node_post_draw (ClutterPaintNode    *node,
   clutter_blur_apply (blur_node->blur);
 
   parent_class->post_draw (node, paint_context);
+
+  g_set_object (&blur_node->target_framebuffer,
+                clutter_paint_context_get_framebuffer (paint_context));
 }
 
 static void
@@ -1558,7 +1574,18 @@ clutter_blur_node_finalize (ClutterPaintNode *node)
 {
   ClutterBlurNode *blur_node = CLUTTER_BLUR_NODE (node);
 
-  g_clear_pointer (&blur_node->blur, clutter_blur_free);
+  if (blur_node->blur)
+    {
+      ClutterContext *context = _clutter_context_get_default ();
+
+      /* The next blur node reusing the blur draws over its textures, so
+       * what was painted with them must not be left in a journal */
+      if (blur_node->target_framebuffer)
+        cogl_framebuffer_flush (blur_node->target_framebuffer);
+
+      clutter_context_release_blur (context, g_steal_pointer (&blur_node->blur));
+    }
+  g_clear_object (&blur_node->target_framebuffer);
 
   CLUTTER_PAINT_NODE_CLASS (clutter_blur_node_parent_class)->finalize (node);
 }
@@ -1597,8 +1624,6 @@ clutter_blur_node_new (unsigned int width,
                        unsigned int height,
                        float        radius)
 {
-  g_autoptr (CoglOffscreen) offscreen = NULL;
-  g_autoptr (CoglTexture) texture = NULL;
   g_autoptr (GError) error = NULL;
   ClutterLayerNode *layer_node;
   ClutterBlurNode *blur_node;
@@ -1613,29 +1638,26 @@ clutter_blur_node_new (unsigned int width,
   backend = clutter_context_get_backend (context);
   cogl_context = clutter_backend_get_cogl_context (backend);
   blur_node = _clutter_paint_node_create (CLUTTER_TYPE_BLUR_NODE);
-  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
-
-  cogl_texture_set_premultiplied (texture, TRUE);
 
-  offscreen = cogl_offscreen_new_with_texture (texture);
-  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+  blur = clutter_context_take_blur (context, width, height, radius);
+  if (!blur)
     {
-      g_warning ("Unable to allocate paint node offscreen: %s",
-                 error->message);
-      goto out;
+      blur = clutter_blur_new_with_framebuffer (cogl_context,
+                                                width, height, radius,
+                                                &error);
     }
 
-  blur = clutter_blur_new (texture, radius);
-  blur_node->blur = blur;
-
   if (!blur)
     {
-      g_warning ("Failed to create blur pipeline");
+      g_warning ("Unable to create blur: %s", error->message);
       goto out;
     }
 
+  blur_node->blur = blur;
+
   layer_node = CLUTTER_LAYER_NODE (blur_node);
-  layer_node->offscreen = COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+  layer_node->offscreen =
+    g_object_ref (clutter_blur_get_source_framebuffer (blur));
   layer_node->pipeline = cogl_pipeline_copy (default_texture_pipeline);
   cogl_pipeline_set_layer_filters (layer_node->pipeline, 0,
                                    COGL_PIPELINE_FILTER_LINEAR,
@@ -1644,11 +1666,6 @@ clutter_blur_node_new (unsigned int width,
                                    0,
                                    clutter_blur_get_texture (blur));
 
-  cogl_framebuffer_orthographic (layer_node->offscreen,
-                                 0.0, 0.0,
-                                 width, height,
-                                 0.0, 1.0);
-
 out:
   return (ClutterPaintNode *) blur_node;
 }
@@ -27,6 +27,10 @@ struct _ClutterPickContext
   ClutterPickMode mode;
   ClutterPickStack *pick_stack;
 
+  /* Whether actors outside of the ray can be skipped. Pick stacks
+   * meant to be searched with more than one ray have no ray to test
+   * against */
+  gboolean cull;
   graphene_ray_t ray;
   graphene_point3d_t point;
 };
@@ -47,8 +51,13 @@ clutter_pick_context_new_for_view (ClutterStageView         *view,
   pick_context = g_new0 (ClutterPickContext, 1);
   g_ref_count_init (&pick_context->ref_count);
   pick_context->mode = mode;
-  graphene_ray_init_from_ray (&pick_context->ray, ray);
-  graphene_point3d_init_from_point (&pick_context->point, point);
+
+  if (point && ray)
+    {
+      pick_context->cull = TRUE;
+      graphene_ray_init_from_ray (&pick_context->ray, ray);
+      graphene_point3d_init_from_point (&pick_context->point, point);
+    }
 
   pick_context->pick_stack = clutter_pick_stack_new (cogl_context);
 
@@ -207,6 +216,9 @@ gboolean
 clutter_pick_context_intersects_box (ClutterPickContext   *pick_context,
                                      const graphene_box_t *box)
 {
+  if (!pick_context->cull)
+    return TRUE;
+
   return graphene_box_contains_point (box, &pick_context->point) ||
          graphene_ray_intersects_box (&pick_context->ray, box);
 }
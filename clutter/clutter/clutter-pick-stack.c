@@ -43,6 +43,40 @@ typedef struct
   int prev;
 } PickClipRecord;
 
+/* Sealed pick stacks that get searched more than once index their
+ * records in a uniform grid. The grid lives in the plane z = -1 of the
+ * eye space, where every ray leaving the camera maps to a single point,
+ * so a cell holds all the records that any ray through it may hit. */
+#define PICK_INDEX_MIN_RECORDS 32
+#define PICK_INDEX_MAX_CELLS_PER_SIDE 32
+/* Bounds are padded so that rays hitting a record right on its edge
+ * aren't lost to rounding errors. This is about a hundredth of a pixel
+ * at the usual stage depth */
+#define PICK_INDEX_EPSILON 1e-5f
+
+typedef struct
+{
+  float x1, y1, x2, y2;
+} PickBounds;
+
+typedef struct
+{
+  PickBounds bounds;
+  int n_columns;
+  int n_rows;
+  float cell_width;
+  float cell_height;
+
+  /* cell_offsets[n_columns * n_rows + 1] indices into cell_records, and
+   * each cell lists its record indices in painting order */
+  int *cell_offsets;
+  int *cell_records;
+
+  /* Records that can't be bounded in the index plane because part of
+   * them lies behind the camera. These are also added to every cell */
+  GArray *unbounded_records;
+} PickIndex;
+
 struct _ClutterPickStack
 {
   grefcount ref_count;
@@ -52,21 +86,35 @@ struct _ClutterPickStack
   GArray *clip_stack;
   int current_clip_stack_top;
 
+  /* Consecutive records usually share a matrix entry, so avoid
+   * resolving the same one over and over while projecting */
+  CoglMatrixEntry *projection_entry;
+  graphene_matrix_t projection_matrix;
+
+  int n_searches;
+  PickIndex *index;
+
   gboolean sealed : 1;
+  gboolean index_failed : 1;
 };
 
 G_DEFINE_BOXED_TYPE (ClutterPickStack, clutter_pick_stack,
                      clutter_pick_stack_ref, clutter_pick_stack_unref)
 
 static void
-project_vertices (CoglMatrixEntry       *matrix_entry,
+project_vertices (ClutterPickStack      *pick_stack,
+                  CoglMatrixEntry       *matrix_entry,
                   const ClutterActorBox *box,
                   graphene_point3d_t     vertices[4])
 {
-  graphene_matrix_t m;
+  const graphene_matrix_t *m = &pick_stack->projection_matrix;
   int i;
 
-  cogl_matrix_entry_get (matrix_entry, &m);
+  if (pick_stack->projection_entry != matrix_entry)
+    {
+      cogl_matrix_entry_get (matrix_entry, &pick_stack->projection_matrix);
+      pick_stack->projection_entry = matrix_entry;
+    }
 
   graphene_point3d_init (&vertices[0], box->x1, box->y1, 0.f);
   graphene_point3d_init (&vertices[1], box->x2, box->y1, 0.f);
@@ -77,7 +125,7 @@ project_vertices (CoglMatrixEntry       *matrix_entry,
     {
       float w = 1.f;
 
-      cogl_graphene_matrix_project_point (&m,
+      cogl_graphene_matrix_project_point (m,
                                           &vertices[i].x,
                                           &vertices[i].y,
                                           &vertices[i].z,
@@ -86,11 +134,13 @@ project_vertices (CoglMatrixEntry       *matrix_entry,
 }
 
 static void
-maybe_project_record (Record *rec)
+maybe_project_record (ClutterPickStack *pick_stack,
+                      Record           *rec)
 {
   if (!rec->projected)
     {
-      project_vertices (rec->matrix_entry, &rec->rect, rec->vertices);
+      project_vertices (pick_stack, rec->matrix_entry, &rec->rect,
+                        rec->vertices);
       rec->projected = TRUE;
     }
 }
@@ -120,11 +170,12 @@ is_axis_aligned_2d_rectangle (const graphene_point3d_t vertices[4])
 }
 
 static gboolean
-ray_intersects_input_region (Record                   *rec,
+ray_intersects_input_region (ClutterPickStack         *pick_stack,
+                             Record                   *rec,
                              const graphene_ray_t     *ray,
                              const graphene_point3d_t *point)
 {
-  maybe_project_record (rec);
+  maybe_project_record (pick_stack, rec);
 
   if (G_LIKELY (is_axis_aligned_2d_rectangle (rec->vertices)))
     {
@@ -193,7 +244,7 @@ ray_intersects_record (ClutterPickStack         *pick_stack,
 {
   int clip_index;
 
-  if (!ray_intersects_input_region (&rec->base, ray, point))
+  if (!ray_intersects_input_region (pick_stack, &rec->base, ray, point))
     return FALSE;
 
   clip_index = rec->clip_index;
@@ -202,7 +253,7 @@ ray_intersects_record (ClutterPickStack         *pick_stack,
       PickClipRecord *clip =
         &g_array_index (pick_stack->clip_stack, PickClipRecord, clip_index);
 
-      if (!ray_intersects_input_region (&clip->base, ray, point))
+      if (!ray_intersects_input_region (pick_stack, &clip->base, ray, point))
         return FALSE;
 
       clip_index = clip->prev;
@@ -245,9 +296,19 @@ remove_pick_stack_weak_refs (ClutterPickStack *pick_stack)
     }
 }
 
+static void
+pick_index_free (PickIndex *index)
+{
+  g_free (index->cell_offsets);
+  g_free (index->cell_records);
+  g_array_unref (index->unbounded_records);
+  g_free (index);
+}
+
 static void
 clutter_pick_stack_dispose (ClutterPickStack *pick_stack)
 {
+  g_clear_pointer (&pick_stack->index, pick_index_free);
   remove_pick_stack_weak_refs (pick_stack);
   g_clear_object (&pick_stack->matrix_stack);
   g_clear_pointer (&pick_stack->vertices_stack, g_array_unref);
@@ -519,29 +580,388 @@ calculate_clear_area (ClutterPickStack  *pick_stack,
   g_clear_pointer (&area, mtk_region_unref);
 }
 
+static gboolean
+get_record_index_bounds (ClutterPickStack *pick_stack,
+                         Record           *rec,
+                         PickBounds       *bounds)
+{
+  int i;
+
+  maybe_project_record (pick_stack, rec);
+
+  for (i = 0; i < 4; i++)
+    {
+      const graphene_point3d_t *v = &rec->vertices[i];
+      float x, y;
+
+      /* The camera looks down the negative z axis */
+      if (v->z > -FLT_EPSILON)
+        return FALSE;
+
+      x = v->x / -v->z;
+      y = v->y / -v->z;
+
+      if (i == 0)
+        {
+          *bounds = (PickBounds) { x, y, x, y };
+        }
+      else
+        {
+          bounds->x1 = MIN (bounds->x1, x);
+          bounds->y1 = MIN (bounds->y1, y);
+          bounds->x2 = MAX (bounds->x2, x);
+          bounds->y2 = MAX (bounds->y2, y);
+        }
+    }
+
+  return TRUE;
+}
+
+/* Returns FALSE if the record can't be hit at all, otherwise
+ * @bounded tells whether @bounds is usable */
+static gboolean
+get_pick_record_index_bounds (ClutterPickStack *pick_stack,
+                              PickRecord       *rec,
+                              PickBounds       *bounds,
+                              gboolean         *bounded)
+{
+  int clip_index;
+
+  *bounded = get_record_index_bounds (pick_stack, &rec->base, bounds);
+
+  /* Tighten the bounds by the clips, which may also show that the
+   * record is clipped away entirely */
+  clip_index = rec->clip_index;
+  while (clip_index >= 0)
+    {
+      PickClipRecord *clip =
+        &g_array_index (pick_stack->clip_stack, PickClipRecord, clip_index);
+      PickBounds clip_bounds;
+
+      if (get_record_index_bounds (pick_stack, &clip->base, &clip_bounds))
+        {
+          if (*bounded)
+            {
+              bounds->x1 = MAX (bounds->x1, clip_bounds.x1);
+              bounds->y1 = MAX (bounds->y1, clip_bounds.y1);
+              bounds->x2 = MIN (bounds->x2, clip_bounds.x2);
+              bounds->y2 = MIN (bounds->y2, clip_bounds.y2);
+            }
+          else
+            {
+              *bounds = clip_bounds;
+              *bounded = TRUE;
+            }
+
+          if (bounds->x1 > bounds->x2 || bounds->y1 > bounds->y2)
+            return FALSE;
+        }
+
+      clip_index = clip->prev;
+    }
+
+  return TRUE;
+}
+
+static int
+get_cell_coordinate (float value,
+                     float origin,
+                     float cell_size,
+                     int   n_cells)
+{
+  float cell = (value - origin) / cell_size;
+
+  /* Clamp before converting, as the bounds of records close to the
+   * camera plane can be huge */
+  return (int) CLAMP (cell, 0.f, (float) (n_cells - 1));
+}
+
+static void
+get_cell_range (PickIndex        *index,
+                const PickBounds *bounds,
+                int              *column1,
+                int              *row1,
+                int              *column2,
+                int              *row2)
+{
+  *column1 = get_cell_coordinate (bounds->x1, index->bounds.x1,
+                                  index->cell_width, index->n_columns);
+  *row1 = get_cell_coordinate (bounds->y1, index->bounds.y1,
+                               index->cell_height, index->n_rows);
+  *column2 = get_cell_coordinate (bounds->x2, index->bounds.x1,
+                                  index->cell_width, index->n_columns);
+  *row2 = get_cell_coordinate (bounds->y2, index->bounds.y1,
+                               index->cell_height, index->n_rows);
+}
+
+static PickIndex *
+build_pick_index (ClutterPickStack *pick_stack)
+{
+  g_autoptr (GArray) bounded_records = NULL;
+  g_autofree PickBounds *record_bounds = NULL;
+  PickIndex *index;
+  int n_records = pick_stack->vertices_stack->len;
+  int n_cells_per_side;
+  int n_cells;
+  int *cell_fill;
+  int pass;
+  int i;
+
+  COGL_TRACE_BEGIN_SCOPED (BuildPickIndex,
+                           "Clutter::PickStack::build_index()");
+
+  index = g_new0 (PickIndex, 1);
+  index->unbounded_records = g_array_new (FALSE, FALSE, sizeof (int));
+  bounded_records = g_array_new (FALSE, FALSE, sizeof (int));
+  record_bounds = g_new (PickBounds, n_records);
+
+  for (i = 0; i < n_records; i++)
+    {
+      PickRecord *rec =
+        &g_array_index (pick_stack->vertices_stack, PickRecord, i);
+      gboolean bounded;
+
+      if (rec->is_overlap || !rec->actor)
+        continue;
+
+      if (!get_pick_record_index_bounds (pick_stack, rec,
+                                         &record_bounds[i], &bounded))
+        continue;
+
+      if (!bounded)
+        {
+          g_array_append_val (index->unbounded_records, i);
+          continue;
+        }
+
+      record_bounds[i].x1 -= PICK_INDEX_EPSILON;
+      record_bounds[i].y1 -= PICK_INDEX_EPSILON;
+      record_bounds[i].x2 += PICK_INDEX_EPSILON;
+      record_bounds[i].y2 += PICK_INDEX_EPSILON;
+
+      if (bounded_records->len == 0)
+        {
+          index->bounds = record_bounds[i];
+        }
+      else
+        {
+          index->bounds.x1 = MIN (index->bounds.x1, record_bounds[i].x1);
+          index->bounds.y1 = MIN (index->bounds.y1, record_bounds[i].y1);
+          index->bounds.x2 = MAX (index->bounds.x2, record_bounds[i].x2);
+          index->bounds.y2 = MAX (index->bounds.y2, record_bounds[i].y2);
+        }
+
+      g_array_append_val (bounded_records, i);
+    }
+
+  /* Mostly 3D scenes don't benefit from the index */
+  if (index->unbounded_records->len > bounded_records->len)
+    {
+      pick_index_free (index);
+      return NULL;
+    }
+
+  n_cells_per_side = (int) ceilf (sqrtf (bounded_records->len));
+  n_cells_per_side = CLAMP (n_cells_per_side, 1, PICK_INDEX_MAX_CELLS_PER_SIDE);
+
+  index->n_columns = n_cells_per_side;
+  index->n_rows = n_cells_per_side;
+  index->cell_width =
+    MAX ((index->bounds.x2 - index->bounds.x1) / index->n_columns, FLT_EPSILON);
+  index->cell_height =
+    MAX ((index->bounds.y2 - index->bounds.y1) / index->n_rows, FLT_EPSILON);
+
+  n_cells = index->n_columns * index->n_rows;
+  index->cell_offsets = g_new0 (int, n_cells + 1);
+  cell_fill = g_new0 (int, n_cells);
+
+  /* Count the records of each cell in the first pass and store them in
+   * the second one, merging the bounded and unbounded records so that
+   * each cell stays in painting order */
+  for (pass = 0; pass < 2; pass++)
+    {
+      int next_bounded = 0;
+      int next_unbounded = 0;
+
+      while (next_bounded < bounded_records->len ||
+             next_unbounded < index->unbounded_records->len)
+        {
+          int bounded_rec = next_bounded < bounded_records->len ?
+            g_array_index (bounded_records, int, next_bounded) : G_MAXINT;
+          int unbounded_rec = next_unbounded < index->unbounded_records->len ?
+            g_array_index (index->unbounded_records, int, next_unbounded) :
+            G_MAXINT;
+          int column1, row1, column2, row2;
+          int rec_index;
+          int column, row;
+
+          if (bounded_rec < unbounded_rec)
+            {
+              rec_index = bounded_rec;
+              get_cell_range (index, &record_bounds[rec_index],
+                              &column1, &row1, &column2, &row2);
+              next_bounded++;
+            }
+          else
+            {
+              rec_index = unbounded_rec;
+              column1 = row1 = 0;
+              column2 = index->n_columns - 1;
+              row2 = index->n_rows - 1;
+              next_unbounded++;
+            }
+
+          for (row = row1; row <= row2; row++)
+            {
+              for (column = column1; column <= column2; column++)
+                {
+                  int cell = row * index->n_columns + column;
+
+                  if (pass == 0)
+                    index->cell_offsets[cell + 1]++;
+                  else
+                    index->cell_records[index->cell_offsets[cell] +
+                                        cell_fill[cell]++] = rec_index;
+                }
+            }
+        }
+
+      if (pass == 0)
+        {
+          for (i = 0; i < n_cells; i++)
+            index->cell_offsets[i + 1] += index->cell_offsets[i];
+
+          index->cell_records = g_new (int, index->cell_offsets[n_cells]);
+        }
+    }
+
+  g_free (cell_fill);
+
+  return index;
+}
+
+static gboolean
+pick_index_lookup (PickIndex            *index,
+                   const graphene_ray_t *ray,
+                   const int           **records,
+                   int                  *n_records)
+{
+  graphene_point3d_t origin;
+  graphene_vec3_t direction;
+  float z;
+  float x, y;
+  int column, row;
+  int cell;
+
+  /* Only rays leaving the camera can be looked up */
+  graphene_ray_get_origin (ray, &origin);
+  if (!graphene_point3d_equal (&origin, graphene_point3d_zero ()))
+    return FALSE;
+
+  graphene_ray_get_direction (ray, &direction);
+  z = graphene_vec3_get_z (&direction);
+  if (z > -FLT_EPSILON)
+    return FALSE;
+
+  x = graphene_vec3_get_x (&direction) / -z;
+  y = graphene_vec3_get_y (&direction) / -z;
+
+  if (x < index->bounds.x1 || x > index->bounds.x2 ||
+      y < index->bounds.y1 || y > index->bounds.y2)
+    {
+      *records = (const int *) index->unbounded_records->data;
+      *n_records = index->unbounded_records->len;
+      return TRUE;
+    }
+
+  column = get_cell_coordinate (x, index->bounds.x1,
+                                index->cell_width, index->n_columns);
+  row = get_cell_coordinate (y, index->bounds.y1,
+                             index->cell_height, index->n_rows);
+  cell = row * index->n_columns + column;
+
+  *records = index->cell_records + index->cell_offsets[cell];
+  *n_records = index->cell_offsets[cell + 1] - index->cell_offsets[cell];
+
+  return TRUE;
+}
+
+static PickIndex *
+ensure_pick_index (ClutterPickStack *pick_stack)
+{
+  /* Pick stacks are usually searched only once, so only pay for the
+   * index when one gets searched again */
+  if (pick_stack->index ||
+      pick_stack->index_failed ||
+      !pick_stack->sealed ||
+      pick_stack->n_searches < 2 ||
+      pick_stack->vertices_stack->len < PICK_INDEX_MIN_RECORDS)
+    return pick_stack->index;
+
+  pick_stack->index = build_pick_index (pick_stack);
+  pick_stack->index_failed = pick_stack->index == NULL;
+
+  return pick_stack->index;
+}
+
+static gboolean
+search_record (ClutterPickStack          *pick_stack,
+               int                        i,
+               const graphene_point3d_t  *point,
+               const graphene_ray_t      *ray,
+               MtkRegion                **clear_area)
+{
+  PickRecord *rec =
+    &g_array_index (pick_stack->vertices_stack, PickRecord, i);
+
+  if (rec->is_overlap || !rec->actor ||
+      !ray_intersects_record (pick_stack, rec, point, ray))
+    return FALSE;
+
+  if (clear_area)
+    calculate_clear_area (pick_stack, rec, i, clear_area);
+
+  return TRUE;
+}
+
 ClutterActor *
 clutter_pick_stack_search_actor (ClutterPickStack          *pick_stack,
                                  const graphene_point3d_t  *point,
                                  const graphene_ray_t      *ray,
                                  MtkRegion                **clear_area)
 {
+  PickIndex *index;
+  const int *records;
+  int n_records;
   int i;
 
+  pick_stack->n_searches++;
+
+  index = ensure_pick_index (pick_stack);
+  if (index && pick_index_lookup (index, ray, &records, &n_records))
+    {
+      for (i = n_records - 1; i >= 0; i--)
+        {
+          if (search_record (pick_stack, records[i], point, ray, clear_area))
+            {
+              return g_array_index (pick_stack->vertices_stack,
+                                    PickRecord, records[i]).actor;
+            }
+        }
+
+      return NULL;
+    }
+
   /* Search all "painted" pickable actors from front to back. A linear search
    * is required, and also performs fine since there is typically only
    * on the order of dozens of actors in the list (on screen) at a time.
    */
   for (i = pick_stack->vertices_stack->len - 1; i >= 0; i--)
     {
-      PickRecord *rec =
-        &g_array_index (pick_stack->vertices_stack, PickRecord, i);
-
-      if (!rec->is_overlap && rec->actor &&
-          ray_intersects_record (pick_stack, rec, point, ray))
+      if (search_record (pick_stack, i, point, ray, clear_area))
         {
-          if (clear_area)
-            calculate_clear_area (pick_stack, rec, i, clear_area);
-          return rec->actor;
+          return g_array_index (pick_stack->vertices_stack,
+                                PickRecord, i).actor;
         }
     }
 
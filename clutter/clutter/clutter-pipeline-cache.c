@@ -224,3 +224,40 @@ clutter_pipeline_cache_unset_all_pipelines (ClutterPipelineCache *pipeline_cache
 {
   g_hash_table_remove (pipeline_cache->groups, group);
 }
+
+/**
+ * clutter_pipeline_cache_get_n_pipelines: (skip)
+ */
+unsigned int
+clutter_pipeline_cache_get_n_pipelines (ClutterPipelineCache *pipeline_cache)
+{
+  GHashTableIter iter;
+  PipelineGroupEntry *group_entry;
+  unsigned int n_pipelines = 0;
+
+  g_hash_table_iter_init (&iter, pipeline_cache->groups);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &group_entry))
+    {
+      size_t i;
+
+      for (i = 0; i < group_entry->n_slots; i++)
+        {
+          if (group_entry->slots[i])
+            n_pipelines += g_hash_table_size (group_entry->slots[i]);
+        }
+    }
+
+  return n_pipelines;
+}
+
+/**
+ * clutter_pipeline_cache_clear: (skip)
+ *
+ * Drops all cached pipelines of all groups, which will be created again
+ * the next time they are needed.
+ */
+void
+clutter_pipeline_cache_clear (ClutterPipelineCache *pipeline_cache)
+{
+  g_hash_table_remove_all (pipeline_cache->groups);
+}
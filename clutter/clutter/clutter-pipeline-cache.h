@@ -57,3 +57,9 @@ void clutter_pipeline_cache_unset_pipeline (ClutterPipelineCache *pipeline_cache
 CLUTTER_EXPORT
 void clutter_pipeline_cache_unset_all_pipelines (ClutterPipelineCache *pipeline_cache,
                                                  ClutterPipelineGroup  group);
+
+CLUTTER_EXPORT
+unsigned int clutter_pipeline_cache_get_n_pipelines (ClutterPipelineCache *pipeline_cache);
+
+CLUTTER_EXPORT
+void clutter_pipeline_cache_clear (ClutterPipelineCache *pipeline_cache);
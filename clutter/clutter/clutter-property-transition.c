@@ -32,6 +32,7 @@
 
 #include "clutter/clutter-property-transition.h"
 
+#include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-animatable.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-interval.h"
@@ -43,6 +44,10 @@ typedef struct _ClutterPropertyTransitionPrivate
   char *property_name;
 
   GParamSpec *pspec;
+
+  /* whether pspec is an animatable property of ClutterActor itself, that
+   * can be set without going through the ClutterAnimatable interface */
+  gboolean is_actor_property;
 } ClutterPropertyTransitionPrivate;
 
 enum
@@ -58,6 +63,67 @@ static GParamSpec *obj_props[PROP_LAST] = { NULL, };
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterPropertyTransition, clutter_property_transition, CLUTTER_TYPE_TRANSITION)
 
+static gboolean
+uses_actor_animatable_iface (ClutterAnimatable *animatable)
+{
+  ClutterAnimatableInterface *iface;
+  ClutterAnimatableInterface *actor_iface;
+
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (animatable);
+  actor_iface = g_type_interface_peek (g_type_class_peek (CLUTTER_TYPE_ACTOR),
+                                       CLUTTER_TYPE_ANIMATABLE);
+
+  return (iface->set_final_state == actor_iface->set_final_state &&
+          iface->interpolate_value == actor_iface->interpolate_value);
+}
+
+static void
+clutter_property_transition_update_pspec (ClutterPropertyTransition *transition,
+                                          ClutterAnimatable         *animatable)
+{
+  ClutterPropertyTransitionPrivate *priv =
+    clutter_property_transition_get_instance_private (transition);
+
+  priv->pspec = NULL;
+  priv->is_actor_property = FALSE;
+
+  if (animatable == NULL || priv->property_name == NULL)
+    return;
+
+  priv->pspec = clutter_animatable_find_property (animatable,
+                                                  priv->property_name);
+  if (priv->pspec == NULL)
+    return;
+
+  priv->is_actor_property =
+    (CLUTTER_IS_ACTOR (animatable) &&
+     priv->pspec->owner_type == CLUTTER_TYPE_ACTOR &&
+     (priv->pspec->flags & CLUTTER_PARAM_ANIMATABLE) != 0 &&
+     uses_actor_animatable_iface (animatable));
+}
+
+static void
+clutter_property_transition_set_value (ClutterPropertyTransition *transition,
+                                       ClutterAnimatable         *animatable,
+                                       const GValue              *value)
+{
+  ClutterPropertyTransitionPrivate *priv =
+    clutter_property_transition_get_instance_private (transition);
+
+  if (priv->is_actor_property)
+    {
+      clutter_actor_set_animated_property (CLUTTER_ACTOR (animatable),
+                                           priv->pspec,
+                                           value);
+    }
+  else
+    {
+      clutter_animatable_set_final_state (animatable,
+                                          priv->property_name,
+                                          value);
+    }
+}
+
 static inline void
 clutter_property_transition_ensure_interval (ClutterPropertyTransition *transition,
                                              ClutterAnimatable         *animatable,
@@ -100,11 +166,7 @@ clutter_property_transition_attached (ClutterTransition *transition,
     clutter_property_transition_get_instance_private (self);
   ClutterInterval *interval;
 
-  if (priv->property_name == NULL)
-    return;
-
-  priv->pspec =
-    clutter_animatable_find_property (animatable, priv->property_name);
+  clutter_property_transition_update_pspec (self, animatable);
 
   if (priv->pspec == NULL)
     return;
@@ -125,6 +187,7 @@ clutter_property_transition_detached (ClutterTransition *transition,
     clutter_property_transition_get_instance_private (self);
 
   priv->pspec = NULL;
+  priv->is_actor_property = FALSE;
 }
 
 static void
@@ -159,34 +222,30 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   if (res)
     {
-      if (i_type != p_type || g_type_is_a (i_type, p_type))
+      if (i_type == p_type)
         {
-          if (g_value_type_transformable (i_type, p_type))
+          clutter_property_transition_set_value (self, animatable, &value);
+        }
+      else if (g_value_type_transformable (i_type, p_type))
+        {
+          GValue transform = G_VALUE_INIT;
+
+          g_value_init (&transform, p_type);
+
+          if (g_value_transform (&value, &transform))
             {
-              GValue transform = G_VALUE_INIT;
-
-              g_value_init (&transform, p_type);
-
-              if (g_value_transform (&value, &transform))
-                {
-                  clutter_animatable_set_final_state (animatable,
-                                                      priv->property_name,
-                                                      &transform);
-                }
-              else
-                g_warning ("%s: Unable to convert a value of type '%s' from "
-                           "the value type '%s' of the interval.",
-                           G_STRLOC,
-                           g_type_name (p_type),
-                           g_type_name (i_type));
-
-              g_value_unset (&transform);
+              clutter_property_transition_set_value (self, animatable,
+                                                     &transform);
             }
+          else
+            g_warning ("%s: Unable to convert a value of type '%s' from "
+                       "the value type '%s' of the interval.",
+                       G_STRLOC,
+                       g_type_name (p_type),
+                       g_type_name (i_type));
+
+          g_value_unset (&transform);
         }
-      else
-        clutter_animatable_set_final_state (animatable,
-                                            priv->property_name,
-                                            &value);
     }
 
   g_value_unset (&value);
@@ -337,15 +396,10 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
 
   g_free (priv->property_name);
   priv->property_name = g_strdup (property_name);
-  priv->pspec = NULL;
 
   animatable =
     clutter_transition_get_animatable (CLUTTER_TRANSITION (transition));
-  if (animatable != NULL)
-    {
-      priv->pspec = clutter_animatable_find_property (animatable,
-                                                      priv->property_name);
-    }
+  clutter_property_transition_update_pspec (transition, animatable);
 
   g_object_notify_by_pspec (G_OBJECT (transition),
                             obj_props[PROP_PROPERTY_NAME]);
@@ -146,6 +146,8 @@ ClutterGrab * clutter_stage_grab_input_only_inactive (ClutterStage        *self,
 
 void clutter_stage_invalidate_devices (ClutterStage *stage);
 
+void clutter_stage_invalidate_pick (ClutterStage *stage);
+
 GPtrArray * clutter_stage_get_active_gestures_array (ClutterStage *self);
 
 ClutterActor * clutter_stage_update_device_for_event (ClutterStage *stage,
@@ -23,12 +23,15 @@
 #include "clutter/clutter-stage-view-private.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "clutter/clutter-context-private.h"
 #include "clutter/clutter-damage-history.h"
+#include "clutter/clutter-debug.h"
 #include "clutter/clutter-frame-clock.h"
 #include "clutter/clutter-frame-private.h"
 #include "clutter/clutter-mutter.h"
+#include "clutter/clutter-paint-context.h"
 #include "clutter/clutter-stage-private.h"
 #include "cogl/cogl.h"
 
@@ -80,9 +83,20 @@ typedef struct _ClutterStageViewPrivate
 
   gboolean use_shadowfb;
   struct {
+    struct {
+      CoglDmaBufHandle *handle;
+      CoglDmaBufHandle *front_handle;
+      gboolean front_valid;
+      ClutterDamageHistory *damage_history;
+    } dma_buf;
     CoglOffscreen *framebuffer;
   } shadow;
 
+  struct {
+    CoglOffscreen *framebuffer;
+    gboolean captured;
+  } snapshot;
+
   CoglScanout *next_scanout;
 
   gboolean has_redraw_clip;
@@ -358,11 +372,13 @@ clutter_stage_view_invalidate_offscreen (ClutterStageView *view)
     {
       g_clear_object (&priv->offscreen_pipeline);
       g_clear_object (&priv->offscreen);
+      g_clear_object (&priv->snapshot.framebuffer);
       g_clear_handle_id (&priv->ensure_offscreen_idle_id, g_source_remove);
       return;
     }
 
   g_clear_object (&priv->offscreen_pipeline);
+  g_clear_object (&priv->snapshot.framebuffer);
 
   if (priv->ensure_offscreen_idle_id != 0)
     return;
@@ -510,6 +526,83 @@ paint_transformed_framebuffer (ClutterStageView *view,
   cogl_framebuffer_pop_matrix (dst_framebuffer);
 }
 
+static CoglDmaBufHandle *
+create_shadowfb_dma_buf (CoglRenderer     *cogl_renderer,
+                         CoglPixelFormat   format,
+                         int               width,
+                         int               height,
+                         GError          **error)
+{
+  CoglDmaBufHandle *handle;
+
+  /* Implicit modifiers; damage detection relies on the buffers being linear,
+   * which is what the software rendering setups using a shadow framebuffer
+   * end up allocating. */
+  handle = cogl_renderer_create_dma_buf (cogl_renderer, format,
+                                         NULL, 0,
+                                         width, height,
+                                         error);
+  if (!handle)
+    return NULL;
+
+  if (cogl_dma_buf_handle_get_n_planes (handle) != 1)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Multi-plane shadow buffers not supported");
+      cogl_dma_buf_handle_free (handle);
+      return NULL;
+    }
+
+  return handle;
+}
+
+static gboolean
+init_dma_buf_shadowfb (ClutterStageView  *view,
+                       CoglPixelFormat    format,
+                       int                width,
+                       int                height,
+                       GError           **error)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglContext *cogl_context =
+    cogl_framebuffer_get_context (priv->framebuffer);
+  CoglRenderer *cogl_renderer = cogl_context_get_renderer (cogl_context);
+  CoglDmaBufHandle *handle;
+  CoglDmaBufHandle *front_handle;
+  CoglFramebuffer *framebuffer;
+
+  if (!cogl_renderer_is_dma_buf_supported (cogl_renderer))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "DMA buffers not supported");
+      return FALSE;
+    }
+
+  handle = create_shadowfb_dma_buf (cogl_renderer, format,
+                                    width, height, error);
+  if (!handle)
+    return FALSE;
+
+  front_handle = create_shadowfb_dma_buf (cogl_renderer, format,
+                                          width, height, error);
+  if (!front_handle)
+    {
+      cogl_dma_buf_handle_free (handle);
+      return FALSE;
+    }
+
+  framebuffer = cogl_dma_buf_handle_get_framebuffer (handle);
+
+  priv->shadow.dma_buf.handle = handle;
+  priv->shadow.dma_buf.front_handle = front_handle;
+  priv->shadow.dma_buf.front_valid = FALSE;
+  priv->shadow.dma_buf.damage_history = clutter_damage_history_new ();
+  priv->shadow.framebuffer = COGL_OFFSCREEN (g_object_ref (framebuffer));
+
+  return TRUE;
+}
+
 static void
 init_shadowfb (ClutterStageView *view)
 {
@@ -525,6 +618,17 @@ init_shadowfb (ClutterStageView *view)
   width = cogl_framebuffer_get_width (priv->framebuffer);
   height = cogl_framebuffer_get_height (priv->framebuffer);
 
+  if (!(clutter_paint_debug_flags &
+        CLUTTER_DEBUG_DISABLE_SHADOWFB_DAMAGE_DETECTION))
+    {
+      if (init_dma_buf_shadowfb (view, format, width, height, &error))
+        return;
+
+      g_debug ("Not using damage detection for shadow framebuffer: %s",
+               error->message);
+      g_clear_error (&error);
+    }
+
   offscreen = create_offscreen (view, format, width, height, &error);
   if (!offscreen)
     {
@@ -545,6 +649,13 @@ clutter_stage_view_after_paint (ClutterStageView *view,
 
   g_warn_if_fail (priv->ensure_offscreen_idle_id == 0);
 
+  /* A snapshot that wasn't captured during this frame no longer matches
+   * what was painted, and isn't used anymore.
+   */
+  if (!priv->snapshot.captured)
+    g_clear_object (&priv->snapshot.framebuffer);
+  priv->snapshot.captured = FALSE;
+
   if (priv->offscreen)
     {
       if (priv->shadow.framebuffer)
@@ -569,6 +680,412 @@ clutter_stage_view_after_paint (ClutterStageView *view,
     }
 }
 
+static MtkRegion *
+transform_region_to_framebuffer (ClutterStageView *view,
+                                 const MtkRegion  *region,
+                                 int               width,
+                                 int               height)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  MtkRectangle framebuffer_rect = { 0, 0, width, height };
+  g_autoptr (MtkRegion) framebuffer_region = NULL;
+  int i;
+
+  framebuffer_region = mtk_region_create ();
+
+  for (i = 0; i < mtk_region_num_rectangles (region); i++)
+    {
+      MtkRectangle rect;
+      graphene_rect_t tmp;
+
+      rect = mtk_region_get_rectangle (region, i);
+
+      tmp = mtk_rectangle_to_graphene_rect (&rect);
+      graphene_rect_offset (&tmp, -priv->layout.x, -priv->layout.y);
+      graphene_rect_scale (&tmp, priv->scale, priv->scale, &tmp);
+      mtk_rectangle_from_graphene_rect (&tmp,
+                                        MTK_ROUNDING_STRATEGY_GROW,
+                                        &rect);
+
+      if (mtk_rectangle_intersect (&rect, &framebuffer_rect, &rect))
+        mtk_region_union_rectangle (framebuffer_region, &rect);
+    }
+
+  return g_steal_pointer (&framebuffer_region);
+}
+
+/**
+ * clutter_stage_view_capture_snapshot:
+ * @view: a #ClutterStageView
+ * @paint_context: the paint context of the current paint of @view
+ * @out_updated_region: (out) (optional): return location for the part of
+ *   the snapshot that changed, in stage coordinates
+ *
+ * Copies what has been painted into @view so far during the current frame
+ * into a texture, which can then be sampled by actors painted later in the
+ * same frame. E.g. a magnifier painted above the rest of the stage can
+ * resample the stage in one pass, instead of painting it again at a
+ * different scale.
+ *
+ * Only the redraw clip of the frame is copied; the rest of the texture is
+ * left as it was captured in earlier frames. This only stays correct if
+ * @view is captured at the same point during every frame; the snapshot is
+ * dropped after a frame without a capture. Users that draw parts of the
+ * snapshot elsewhere on the stage are responsible for queueing a redraw of
+ * where they draw @out_updated_region, which is seen on the next frame.
+ *
+ * The texture has the size of the framebuffer of @view, and is laid out
+ * like it, i.e. the layout of @view scaled by its scale.
+ *
+ * Returns: (transfer none) (nullable): the snapshot texture, or %NULL if
+ *   it couldn't be captured
+ */
+CoglTexture *
+clutter_stage_view_capture_snapshot (ClutterStageView     *view,
+                                     ClutterPaintContext  *paint_context,
+                                     MtkRegion           **out_updated_region)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglFramebuffer *framebuffer;
+  CoglFramebuffer *snapshot_framebuffer;
+  CoglContext *cogl_context;
+  const MtkRegion *redraw_clip;
+  g_autoptr (MtkRegion) updated_region = NULL;
+  g_autoptr (MtkRegion) framebuffer_region = NULL;
+  g_autoptr (GError) error = NULL;
+  int width, height;
+  int i;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE_VIEW (view), NULL);
+  g_return_val_if_fail (paint_context, NULL);
+
+  COGL_TRACE_BEGIN_SCOPED (CaptureSnapshot,
+                           "Clutter::StageView::capture_snapshot()");
+
+  framebuffer = clutter_stage_view_get_framebuffer (view);
+  if (clutter_paint_context_get_framebuffer (paint_context) != framebuffer)
+    {
+      g_warning ("Can't capture snapshot of view %s outside of its paint",
+                 priv->name);
+      return NULL;
+    }
+
+  cogl_context = cogl_framebuffer_get_context (framebuffer);
+  if (!cogl_context_has_feature (cogl_context,
+                                 COGL_FEATURE_ID_BLIT_FRAMEBUFFER))
+    return NULL;
+
+  width = cogl_framebuffer_get_width (framebuffer);
+  height = cogl_framebuffer_get_height (framebuffer);
+
+  if (priv->snapshot.framebuffer)
+    {
+      snapshot_framebuffer = COGL_FRAMEBUFFER (priv->snapshot.framebuffer);
+
+      if (cogl_framebuffer_get_width (snapshot_framebuffer) != width ||
+          cogl_framebuffer_get_height (snapshot_framebuffer) != height ||
+          cogl_framebuffer_get_internal_format (snapshot_framebuffer) !=
+          cogl_framebuffer_get_internal_format (framebuffer))
+        g_clear_object (&priv->snapshot.framebuffer);
+    }
+
+  redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
+
+  if (priv->snapshot.framebuffer && redraw_clip)
+    {
+      updated_region = mtk_region_copy (redraw_clip);
+      mtk_region_intersect_rectangle (updated_region, &priv->layout);
+    }
+  else
+    {
+      updated_region = mtk_region_create_rectangle (&priv->layout);
+    }
+
+  if (!priv->snapshot.framebuffer)
+    {
+      CoglPixelFormat format;
+
+      format = cogl_framebuffer_get_internal_format (framebuffer);
+      priv->snapshot.framebuffer = create_offscreen (view, format,
+                                                     width, height,
+                                                     &error);
+      if (!priv->snapshot.framebuffer)
+        {
+          g_warning ("Failed to create snapshot of view %s: %s",
+                     priv->name, error->message);
+          return NULL;
+        }
+
+      /* Outside of the redraw clip, the framebuffer may still contain what
+       * was drawn on top of the captured contents last frame, so the full
+       * view has to be painted again before the snapshot is complete.
+       */
+      if (redraw_clip &&
+          mtk_region_contains_rectangle (redraw_clip, &priv->layout) !=
+          MTK_REGION_OVERLAP_IN)
+        {
+          clutter_stage_view_add_redraw_clip (view, NULL);
+          clutter_stage_view_schedule_update (view);
+        }
+    }
+
+  snapshot_framebuffer = COGL_FRAMEBUFFER (priv->snapshot.framebuffer);
+  framebuffer_region = transform_region_to_framebuffer (view, updated_region,
+                                                        width, height);
+
+  for (i = 0; i < mtk_region_num_rectangles (framebuffer_region); i++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (framebuffer_region, i);
+
+      if (!cogl_framebuffer_blit (framebuffer, snapshot_framebuffer,
+                                  rect.x, rect.y,
+                                  rect.x, rect.y,
+                                  rect.width, rect.height,
+                                  &error))
+        {
+          g_warning ("Failed to capture snapshot of view %s: %s",
+                     priv->name, error->message);
+          g_clear_object (&priv->snapshot.framebuffer);
+          return NULL;
+        }
+    }
+
+  priv->snapshot.captured = TRUE;
+
+  if (out_updated_region)
+    *out_updated_region = g_steal_pointer (&updated_region);
+
+  return cogl_offscreen_get_texture (priv->snapshot.framebuffer);
+}
+
+#define SHADOWFB_TILE_SIZE 32
+
+static gboolean
+is_tile_dirty (const MtkRectangle *tile,
+               const uint8_t      *current_data,
+               const uint8_t      *front_data,
+               int                 bpp,
+               int                 stride)
+{
+  int y;
+
+  for (y = tile->y; y < tile->y + tile->height; y++)
+    {
+      size_t offset = (size_t) y * stride + (size_t) tile->x * bpp;
+
+      if (memcmp (current_data + offset,
+                  front_data + offset,
+                  (size_t) tile->width * bpp) != 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static MtkRegion *
+create_tile_aligned_region (const MtkRegion *region,
+                            int              width,
+                            int              height)
+{
+  MtkRegion *tile_region;
+  int i;
+
+  tile_region = mtk_region_create ();
+
+  for (i = 0; i < mtk_region_num_rectangles (region); i++)
+    {
+      MtkRectangle rect;
+      int x1, y1, x2, y2;
+
+      rect = mtk_region_get_rectangle (region, i);
+      x1 = (rect.x / SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE;
+      y1 = (rect.y / SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE;
+      x2 = MIN (width,
+                ((rect.x + rect.width + SHADOWFB_TILE_SIZE - 1) /
+                 SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE);
+      y2 = MIN (height,
+                ((rect.y + rect.height + SHADOWFB_TILE_SIZE - 1) /
+                 SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE);
+
+      mtk_region_union_rectangle (tile_region,
+                                  &MTK_RECTANGLE_INIT (x1, y1,
+                                                       x2 - x1, y2 - y1));
+    }
+
+  return tile_region;
+}
+
+static gboolean
+blit_shadowfb_region (CoglFramebuffer  *src,
+                      CoglFramebuffer  *dst,
+                      const MtkRegion  *region,
+                      GError          **error)
+{
+  int i;
+
+  for (i = 0; i < mtk_region_num_rectangles (region); i++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (region, i);
+
+      if (!cogl_framebuffer_blit (src, dst,
+                                  rect.x, rect.y,
+                                  rect.x, rect.y,
+                                  rect.width, rect.height,
+                                  error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * Compares the tiles touched by @damage_region against the front copy of the
+ * shadow framebuffer, i.e. what was last copied to the onscreen, and returns
+ * the part of @damage_region whose content actually changed. The front copy
+ * is updated to match.
+ */
+static MtkRegion *
+find_damaged_tiles (ClutterStageView  *view,
+                    const MtkRegion   *damage_region,
+                    GError           **error)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglDmaBufHandle *handle = priv->shadow.dma_buf.handle;
+  CoglDmaBufHandle *front_handle = priv->shadow.dma_buf.front_handle;
+  CoglFramebuffer *shadowfb = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
+  CoglFramebuffer *front_framebuffer =
+    cogl_dma_buf_handle_get_framebuffer (front_handle);
+  g_autoptr (MtkRegion) tile_region = NULL;
+  g_autoptr (MtkRegion) changed_region = NULL;
+  uint8_t *current_data = NULL;
+  uint8_t *front_data = NULL;
+  CoglPixelFormat format;
+  int width, height, stride, bpp;
+  int i;
+
+  COGL_TRACE_BEGIN_SCOPED (FindDamagedTiles,
+                           "Clutter::StageView::find_damaged_tiles()");
+
+  width = cogl_dma_buf_handle_get_width (handle);
+  height = cogl_dma_buf_handle_get_height (handle);
+  stride = cogl_dma_buf_handle_get_stride (handle, 0);
+  format = cogl_framebuffer_get_internal_format (shadowfb);
+  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+
+  if (stride != cogl_dma_buf_handle_get_stride (front_handle, 0))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Shadow buffer strides don't match");
+      return NULL;
+    }
+
+  if (!priv->shadow.dma_buf.front_valid)
+    {
+      MtkRectangle full_rect = { .width = width, .height = height };
+      g_autoptr (MtkRegion) full_region = NULL;
+
+      full_region = mtk_region_create_rectangle (&full_rect);
+      if (!blit_shadowfb_region (shadowfb, front_framebuffer,
+                                 full_region, error))
+        return NULL;
+
+      priv->shadow.dma_buf.front_valid = TRUE;
+      return mtk_region_copy (damage_region);
+    }
+
+  cogl_framebuffer_finish (shadowfb);
+
+  if (!cogl_dma_buf_handle_sync_read_start (handle, error))
+    goto err_sync_read_current;
+
+  if (!cogl_dma_buf_handle_sync_read_start (front_handle, error))
+    goto err_sync_read_front;
+
+  current_data = cogl_dma_buf_handle_mmap (handle, error);
+  if (!current_data)
+    goto err_mmap_current;
+
+  front_data = cogl_dma_buf_handle_mmap (front_handle, error);
+  if (!front_data)
+    goto err_mmap_front;
+
+  tile_region = create_tile_aligned_region (damage_region, width, height);
+  changed_region = mtk_region_create ();
+
+  for (i = 0; i < mtk_region_num_rectangles (tile_region); i++)
+    {
+      MtkRectangle rect;
+      int tile_x, tile_y;
+
+      rect = mtk_region_get_rectangle (tile_region, i);
+
+      for (tile_y = rect.y; tile_y < rect.y + rect.height;
+           tile_y += SHADOWFB_TILE_SIZE)
+        {
+          for (tile_x = rect.x; tile_x < rect.x + rect.width;
+               tile_x += SHADOWFB_TILE_SIZE)
+            {
+              MtkRectangle tile = {
+                .x = tile_x,
+                .y = tile_y,
+                .width = MIN (SHADOWFB_TILE_SIZE,
+                              rect.x + rect.width - tile_x),
+                .height = MIN (SHADOWFB_TILE_SIZE,
+                               rect.y + rect.height - tile_y),
+              };
+
+              if (is_tile_dirty (&tile, current_data, front_data,
+                                 bpp, stride))
+                mtk_region_union_rectangle (changed_region, &tile);
+            }
+        }
+    }
+
+  mtk_region_intersect (changed_region, damage_region);
+
+  cogl_dma_buf_handle_munmap (front_handle, front_data, NULL);
+  cogl_dma_buf_handle_munmap (handle, current_data, NULL);
+  cogl_dma_buf_handle_sync_read_end (front_handle, NULL);
+  cogl_dma_buf_handle_sync_read_end (handle, NULL);
+
+  if (!blit_shadowfb_region (shadowfb, front_framebuffer,
+                             changed_region, error))
+    return NULL;
+
+  return g_steal_pointer (&changed_region);
+
+err_mmap_front:
+  cogl_dma_buf_handle_munmap (handle, current_data, NULL);
+
+err_mmap_current:
+  cogl_dma_buf_handle_sync_read_end (front_handle, NULL);
+
+err_sync_read_front:
+  cogl_dma_buf_handle_sync_read_end (handle, NULL);
+
+err_sync_read_current:
+  return NULL;
+}
+
+static void
+disable_shadowfb_damage_detection (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  g_clear_pointer (&priv->shadow.dma_buf.front_handle,
+                   cogl_dma_buf_handle_free);
+  g_clear_pointer (&priv->shadow.dma_buf.damage_history,
+                   clutter_damage_history_free);
+}
+
 static void
 copy_shadowfb_to_onscreen (ClutterStageView *view,
                            const MtkRegion  *swap_region)
@@ -591,6 +1108,57 @@ copy_shadowfb_to_onscreen (ClutterStageView *view,
       damage_region = mtk_region_copy (swap_region);
     }
 
+  if (priv->shadow.dma_buf.front_handle)
+    {
+      ClutterDamageHistory *damage_history =
+        priv->shadow.dma_buf.damage_history;
+      g_autoptr (MtkRegion) changed_region = NULL;
+      g_autoptr (GError) error = NULL;
+
+      changed_region = find_damaged_tiles (view, damage_region, &error);
+      if (changed_region)
+        {
+          int buffer_age;
+
+          if (COGL_IS_ONSCREEN (priv->framebuffer))
+            buffer_age =
+              cogl_onscreen_get_buffer_age (COGL_ONSCREEN (priv->framebuffer));
+          else
+            buffer_age = 1;
+
+          clutter_damage_history_record (damage_history, changed_region);
+
+          /* The onscreen back buffer may be older than the front copy, so
+           * it also needs whatever changed in the frames it missed. */
+          if (clutter_damage_history_is_age_valid (damage_history,
+                                                   buffer_age))
+            {
+              int age;
+
+              for (age = 1; age <= buffer_age; age++)
+                {
+                  const MtkRegion *old_damage;
+
+                  old_damage =
+                    clutter_damage_history_lookup (damage_history, age);
+                  mtk_region_union (changed_region, old_damage);
+                }
+
+              mtk_region_intersect (changed_region, damage_region);
+              g_clear_pointer (&damage_region, mtk_region_unref);
+              damage_region = g_steal_pointer (&changed_region);
+            }
+
+          clutter_damage_history_step (damage_history);
+        }
+      else
+        {
+          g_warning ("Disabling shadow framebuffer damage detection: %s",
+                     error->message);
+          disable_shadowfb_damage_detection (view);
+        }
+    }
+
   for (i = 0; i < mtk_region_num_rectangles (damage_region); i++)
     {
       CoglFramebuffer *shadowfb = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
@@ -623,7 +1191,16 @@ clutter_stage_view_before_swap_buffer (ClutterStageView *view,
                            "Clutter::StageView::before_swap_buffer()");
 
   if (priv->shadow.framebuffer)
-    copy_shadowfb_to_onscreen (view, swap_region);
+    {
+      if (COGL_IS_ONSCREEN (priv->framebuffer))
+        {
+          cogl_onscreen_begin_gpu_phase (COGL_ONSCREEN (priv->framebuffer),
+                                         COGL_FRAMEBUFFER (priv->shadow.framebuffer),
+                                         "shadowfb-copy");
+        }
+
+      copy_shadowfb_to_onscreen (view, swap_region);
+    }
 }
 
 float
@@ -1072,6 +1649,7 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
 
   if (clutter_stage_view_has_redraw_clip (view))
     {
+      clutter_frame_set_kind (frame, CLUTTER_FRAME_KIND_COMPOSITED);
       clutter_stage_emit_before_paint (stage, view, frame);
 
       _clutter_stage_window_redraw_view (stage_window, view, frame);
@@ -1084,6 +1662,10 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
       if (clutter_context_get_show_fps (context))
         end_frame_timing_measurement (view);
     }
+  else
+    {
+      clutter_frame_set_kind (frame, CLUTTER_FRAME_KIND_CURSOR_ONLY);
+    }
 
   _clutter_stage_window_finish_frame (stage_window, view, frame);
 
@@ -1331,10 +1913,13 @@ clutter_stage_view_dispose (GObject *object)
   g_clear_pointer (&priv->name, g_free);
 
   g_clear_object (&priv->shadow.framebuffer);
+  g_clear_pointer (&priv->shadow.dma_buf.handle, cogl_dma_buf_handle_free);
+  disable_shadowfb_damage_detection (view);
 
   g_clear_object (&priv->color_state);
   g_clear_object (&priv->offscreen);
   g_clear_object (&priv->offscreen_pipeline);
+  g_clear_object (&priv->snapshot.framebuffer);
   g_clear_object (&priv->output_color_state);
   g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
   g_clear_pointer (&priv->accumulated_redraw_clip, mtk_region_unref);
@@ -91,3 +91,8 @@ ClutterColorState * clutter_stage_view_get_output_color_state (ClutterStageView
 
 CLUTTER_EXPORT
 MtkMonitorTransform clutter_stage_view_get_transform (ClutterStageView *view);
+
+CLUTTER_EXPORT
+CoglTexture * clutter_stage_view_capture_snapshot (ClutterStageView     *view,
+                                                   ClutterPaintContext  *paint_context,
+                                                   MtkRegion           **out_updated_region);
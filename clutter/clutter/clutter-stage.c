@@ -71,6 +71,10 @@
 
 #define MAX_FRUSTA 64
 
+/* Redraw clips with too many rectangles are culled against a grid of
+ * tiles covering their extents */
+#define N_CLIP_TILES_PER_AXIS 8
+
 typedef struct _PickRecord
 {
   graphene_point_t vertex[4];
@@ -104,6 +108,12 @@ typedef struct _PointerDeviceEntry
   unsigned int press_count;
   ClutterActor *implicit_grab_actor;
   GArray *event_emission_chain;
+
+  /* The emission chain for events outside of implicit grabs, reused
+   * while the current actor, grab and event chain age stay the same */
+  GArray *cached_event_emission_chain;
+  ClutterActor *cached_chain_grab_actor;
+  unsigned int cached_chain_age;
 } PointerDeviceEntry;
 
 typedef struct _ClutterStagePrivate
@@ -125,6 +135,7 @@ typedef struct _ClutterStagePrivate
   GQueue *event_queue;
   GPtrArray *cur_event_actors;
   GArray *cur_event_emission_chain;
+  gboolean in_cached_chain_emission;
 
   GSList *pending_relayouts;
 
@@ -135,6 +146,11 @@ typedef struct _ClutterStagePrivate
   GHashTable *pointer_devices;
   GHashTable *touch_sequences;
 
+  /* Reactive pick stacks of each view, built without culling against
+   * a ray so they stay valid until the pickable geometry changes */
+  GHashTable *pick_stacks;
+  gboolean pick_cache_warm;
+
   GPtrArray *all_active_gestures;
 
   guint actor_needs_immediate_relayout : 1;
@@ -392,6 +408,68 @@ setup_clip_frustum (ClutterStage       *stage,
                          &planes[4], &planes[5]);
 }
 
+static void
+add_tiled_clip_frusta (ClutterStage    *stage,
+                       const MtkRegion *redraw_clip,
+                       GArray          *clip_frusta)
+{
+  MtkRectangle extents;
+  int tile_width, tile_height;
+  int row, column;
+
+  extents = mtk_region_get_extents (redraw_clip);
+  tile_width = (extents.width + N_CLIP_TILES_PER_AXIS - 1) /
+               N_CLIP_TILES_PER_AXIS;
+  tile_height = (extents.height + N_CLIP_TILES_PER_AXIS - 1) /
+                N_CLIP_TILES_PER_AXIS;
+
+  for (row = 0; row < N_CLIP_TILES_PER_AXIS; row++)
+    {
+      MtkRectangle run = { 0 };
+      gboolean in_run = FALSE;
+
+      for (column = 0; column <= N_CLIP_TILES_PER_AXIS; column++)
+        {
+          MtkRectangle tile;
+          gboolean is_damaged = FALSE;
+
+          tile = (MtkRectangle) {
+            .x = extents.x + column * tile_width,
+            .y = extents.y + row * tile_height,
+            .width = tile_width,
+            .height = tile_height,
+          };
+
+          if (column < N_CLIP_TILES_PER_AXIS &&
+              mtk_rectangle_intersect (&tile, &extents, &tile))
+            {
+              is_damaged =
+                mtk_region_contains_rectangle (redraw_clip, &tile) !=
+                MTK_REGION_OVERLAP_OUT;
+            }
+
+          if (is_damaged)
+            {
+              /* Merge horizontally adjacent damaged tiles */
+              if (in_run)
+                mtk_rectangle_union (&run, &tile, &run);
+              else
+                run = tile;
+
+              in_run = TRUE;
+            }
+          else if (in_run)
+            {
+              graphene_frustum_t clip_frustum;
+
+              setup_clip_frustum (stage, &run, &clip_frustum);
+              g_array_append_val (clip_frusta, clip_frustum);
+              in_run = FALSE;
+            }
+        }
+    }
+}
+
 static void
 clutter_stage_do_paint_view (ClutterStage     *stage,
                              ClutterStageView *view,
@@ -425,15 +503,23 @@ clutter_stage_do_paint_view (ClutterStage     *stage,
           g_array_append_val (clip_frusta, clip_frustum);
         }
     }
+  else if (redraw_clip)
+    {
+      /* Culling against the extents of a fragmented redraw clip would
+       * paint most actors on large views, so cull against the damaged
+       * tiles of the extents instead.
+       */
+      clip_frusta = g_array_sized_new (FALSE, FALSE,
+                                       sizeof (graphene_frustum_t),
+                                       N_CLIP_TILES_PER_AXIS);
+      add_tiled_clip_frusta (stage, redraw_clip, clip_frusta);
+    }
   else
     {
       clip_frusta = g_array_sized_new (FALSE, FALSE,
                                        sizeof (graphene_frustum_t),
                                        1);
-      if (redraw_clip)
-        clip_rect = mtk_region_get_extents (redraw_clip);
-      else
-        clutter_stage_view_get_layout (view, &clip_rect);
+      clutter_stage_view_get_layout (view, &clip_rect);
 
       setup_clip_frustum (stage, &clip_rect, &clip_frustum);
       g_array_append_val (clip_frusta, clip_frustum);
@@ -449,6 +535,8 @@ clutter_stage_do_paint_view (ClutterStage     *stage,
   if (frame)
     clutter_paint_context_assign_frame (paint_context, frame);
 
+  clutter_paint_context_begin_gpu_phase (paint_context, "stage");
+
   clutter_actor_get_background_color (CLUTTER_ACTOR (stage), &bg_color);
   bg_color.alpha = 255;
 
@@ -711,78 +799,6 @@ _clutter_stage_queue_event (ClutterStage *stage,
   clutter_stage_schedule_update (stage);
 }
 
-static ClutterEvent *
-clutter_stage_compress_motion (ClutterStage       *stage,
-                               ClutterEvent       *event,
-                               const ClutterEvent *to_discard)
-{
-  double dx, dy;
-  double dx_unaccel, dy_unaccel;
-  double dx_constrained, dy_constrained;
-  double dst_dx = 0.0, dst_dy = 0.0;
-  double dst_dx_unaccel = 0.0, dst_dy_unaccel = 0.0;
-  double dst_dx_constrained = 0.0, dst_dy_constrained = 0.0;
-  double *current_axes, *last_axes;
-  guint n_current_axes, n_last_axes;
-  graphene_point_t coords;
-
-  if (!clutter_event_get_relative_motion (to_discard,
-                                          &dx, &dy,
-                                          &dx_unaccel, &dy_unaccel,
-                                          &dx_constrained, &dy_constrained))
-    return NULL;
-
-  clutter_event_get_relative_motion (event,
-                                     &dst_dx, &dst_dy,
-                                     &dst_dx_unaccel, &dst_dy_unaccel,
-                                     &dst_dx_constrained, &dst_dy_constrained);
-
-  clutter_event_get_position (event, &coords);
-
-  /* All tablet axes but the wheel are absolute so we can use those
-   * as-is. But for wheels we only compress if the current value goes in the
-   * same direction.
-   */
-  current_axes = clutter_event_get_axes (to_discard, &n_current_axes);
-  last_axes = clutter_event_get_axes (event, &n_last_axes);
-
-  g_return_val_if_fail (!last_axes == !current_axes, NULL);
-
-  if (current_axes)
-    {
-      double current_val = 0.0;
-      double last_val = 0.0;
-
-      g_return_val_if_fail (n_current_axes == CLUTTER_INPUT_AXIS_LAST, NULL);
-      g_return_val_if_fail (n_last_axes == CLUTTER_INPUT_AXIS_LAST, NULL);
-      g_return_val_if_fail (n_current_axes == n_last_axes, NULL);
-
-      current_val = current_axes[CLUTTER_INPUT_AXIS_WHEEL];
-      last_val = last_axes[CLUTTER_INPUT_AXIS_WHEEL];
-
-      if ((current_val < 0.0 && last_val > 0.0) ||
-          (current_val > 0.0 && last_val < 0.0))
-        return NULL;
-
-      current_axes = g_memdup2 (current_axes, sizeof (double) * n_current_axes);
-      current_axes[CLUTTER_INPUT_AXIS_WHEEL] += last_axes[CLUTTER_INPUT_AXIS_WHEEL];
-    }
-
-  return clutter_event_motion_new (CLUTTER_EVENT_FLAG_RELATIVE_MOTION,
-                                   clutter_event_get_time_us (event),
-                                   clutter_event_get_source_device (event),
-                                   clutter_event_get_device_tool (event),
-                                   clutter_event_get_state (event),
-                                   coords,
-                                   GRAPHENE_POINT_INIT ((float) (dx + dst_dx),
-                                                        (float) (dy + dst_dy)),
-                                   GRAPHENE_POINT_INIT ((float) (dx_unaccel + dst_dx_unaccel),
-                                                        (float) (dy_unaccel + dst_dy_unaccel)),
-                                   GRAPHENE_POINT_INIT ((float) (dx_constrained + dst_dx_constrained),
-                                                        (float) (dy_constrained + dst_dy_constrained)),
-                                   current_axes);
-}
-
 CLUTTER_EXPORT void
 _clutter_stage_process_queued_events (ClutterStage *stage)
 {
@@ -863,8 +879,7 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                 {
                   ClutterEvent *new_event;
 
-                  new_event =
-                    clutter_stage_compress_motion (stage, next_event, event);
+                  new_event = clutter_event_coalesce_motion (next_event, event);
                   if (new_event)
                     {
                       /* Replace the next event with the rewritten one */
@@ -1099,6 +1114,7 @@ _clutter_stage_do_pick_on_view (ClutterStage      *stage,
                                 ClutterStageView  *view,
                                 MtkRegion        **clear_area)
 {
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
   g_autoptr (ClutterPickStack) pick_stack = NULL;
   ClutterContext *context;
   ClutterBackend *backend;
@@ -1107,24 +1123,81 @@ _clutter_stage_do_pick_on_view (ClutterStage      *stage,
   graphene_point3d_t p;
   graphene_ray_t ray;
   ClutterActor *actor;
+  gboolean use_cache;
 
   COGL_TRACE_BEGIN_SCOPED (ClutterStagePickView, "Clutter::Stage::do_pick_on_view()");
 
   setup_ray_for_coordinates (stage, x, y, &p, &ray);
 
-  context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
-  backend = clutter_context_get_backend (context);
-  cogl_context = clutter_backend_get_cogl_context (backend);
-  pick_context = clutter_pick_context_new_for_view (view, cogl_context, mode, &p, &ray);
+  /* Only reactive picks happen often enough for caching to pay off */
+  use_cache = (mode == CLUTTER_PICK_REACTIVE &&
+               !(clutter_pick_debug_flags & CLUTTER_DEBUG_DISABLE_PICK_CACHE));
 
-  clutter_actor_pick (CLUTTER_ACTOR (stage), pick_context);
-  pick_stack = clutter_pick_context_steal_stack (pick_context);
-  clutter_pick_context_destroy (pick_context);
+  if (use_cache)
+    {
+      pick_stack = g_hash_table_lookup (priv->pick_stacks, view);
+      if (pick_stack)
+        clutter_pick_stack_ref (pick_stack);
+
+      /* A stack that can be searched with any ray costs more to build
+       * than a culled one, so only build it once the pickable geometry
+       * looks like it's going to stay around for more than one pick */
+      if (!pick_stack && !priv->pick_cache_warm)
+        {
+          priv->pick_cache_warm = TRUE;
+          use_cache = FALSE;
+        }
+    }
+
+  if (!pick_stack)
+    {
+      COGL_TRACE_BEGIN_SCOPED (ClutterStagePickViewBuild,
+                               "Clutter::Stage::do_pick_on_view#build()");
+
+      context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
+      backend = clutter_context_get_backend (context);
+      cogl_context = clutter_backend_get_cogl_context (backend);
+
+      /* Cached stacks are searched with other rays later on, so they
+       * can't be culled against this one */
+      pick_context = clutter_pick_context_new_for_view (view, cogl_context, mode,
+                                                        use_cache ? NULL : &p,
+                                                        use_cache ? NULL : &ray);
+
+      clutter_actor_pick (CLUTTER_ACTOR (stage), pick_context);
+      pick_stack = clutter_pick_context_steal_stack (pick_context);
+      clutter_pick_context_destroy (pick_context);
+
+      if (use_cache)
+        {
+          g_hash_table_insert (priv->pick_stacks,
+                               g_object_ref (view),
+                               clutter_pick_stack_ref (pick_stack));
+        }
+    }
 
   actor = clutter_pick_stack_search_actor (pick_stack, &p, &ray, clear_area);
   return actor ? actor : CLUTTER_ACTOR (stage);
 }
 
+/*
+ * clutter_stage_invalidate_pick:
+ * @stage: a #ClutterStage
+ *
+ * Drops the cached pick stacks. This needs to be called whenever
+ * something that may change the result of a reactive pick changes.
+ */
+void
+clutter_stage_invalidate_pick (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+
+  priv->pick_cache_warm = FALSE;
+
+  if (g_hash_table_size (priv->pick_stacks) > 0)
+    g_hash_table_remove_all (priv->pick_stacks);
+}
+
 /**
  * clutter_stage_get_view_at: (skip)
  */
@@ -1272,6 +1345,10 @@ clutter_stage_constructed (GObject *gobject)
   priv->pointer_devices =
     g_hash_table_new_full (NULL, NULL,
                            NULL, (GDestroyNotify) free_pointer_device_entry);
+  priv->pick_stacks =
+    g_hash_table_new_full (NULL, NULL,
+                           g_object_unref,
+                           (GDestroyNotify) clutter_pick_stack_unref);
   priv->touch_sequences =
     g_hash_table_new_full (NULL, NULL,
                            NULL, (GDestroyNotify) free_pointer_device_entry);
@@ -1386,6 +1463,7 @@ clutter_stage_dispose (GObject *object)
 
   g_hash_table_remove_all (priv->pointer_devices);
   g_hash_table_remove_all (priv->touch_sequences);
+  g_hash_table_remove_all (priv->pick_stacks);
 
   G_OBJECT_CLASS (clutter_stage_parent_class)->dispose (object);
 }
@@ -1409,6 +1487,7 @@ clutter_stage_finalize (GObject *object)
 
   g_hash_table_destroy (priv->pointer_devices);
   g_hash_table_destroy (priv->touch_sequences);
+  g_hash_table_destroy (priv->pick_stacks);
 
   G_OBJECT_CLASS (clutter_stage_parent_class)->finalize (object);
 }
@@ -1740,6 +1819,7 @@ clutter_stage_set_perspective (ClutterStage       *stage,
                            &priv->inverse_projection);
 
   _clutter_stage_dirty_projection (stage);
+  clutter_stage_invalidate_pick (stage);
   clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
 
@@ -1872,6 +1952,7 @@ clutter_stage_set_viewport (ClutterStage *stage,
 
   clutter_stage_update_view_perspective (stage);
   _clutter_stage_dirty_viewport (stage);
+  clutter_stage_invalidate_pick (stage);
 
   queue_full_redraw (stage);
 }
@@ -2927,6 +3008,7 @@ clutter_stage_peek_stage_views (ClutterStage *stage)
 void
 clutter_stage_clear_stage_views (ClutterStage *stage)
 {
+  clutter_stage_invalidate_pick (stage);
   clutter_actor_clear_stage_views_recursive (CLUTTER_ACTOR (stage), FALSE);
 }
 
@@ -3035,6 +3117,7 @@ free_pointer_device_entry (PointerDeviceEntry *entry)
   g_assert (!entry->press_count);
   g_assert (entry->event_emission_chain->len == 0);
   g_array_unref (entry->event_emission_chain);
+  g_clear_pointer (&entry->cached_event_emission_chain, g_array_unref);
 
   g_free (entry);
 }
@@ -3085,6 +3168,7 @@ clutter_stage_update_device_entry (ClutterStage         *self,
         _clutter_actor_set_has_pointer (entry->current_actor, FALSE);
 
       entry->current_actor = actor;
+      g_clear_pointer (&entry->cached_event_emission_chain, g_array_unref);
 
       if (actor)
         _clutter_actor_set_has_pointer (actor, TRUE);
@@ -3287,6 +3371,34 @@ create_event_emission_chain (ClutterStage *stage,
   priv->cur_event_actors->len = 0;
 }
 
+static GArray *
+ensure_cached_event_emission_chain (ClutterStage       *stage,
+                                    PointerDeviceEntry *entry,
+                                    ClutterActor       *grab_actor)
+{
+  unsigned int age = clutter_actor_get_event_chain_age ();
+  GArray *chain;
+
+  if (entry->cached_event_emission_chain &&
+      entry->cached_chain_grab_actor == grab_actor &&
+      entry->cached_chain_age == age)
+    return entry->cached_event_emission_chain;
+
+  /* The previous chain might still be in use by an emission further up
+   * the stack, so don't reuse it */
+  g_clear_pointer (&entry->cached_event_emission_chain, g_array_unref);
+
+  chain = g_array_sized_new (FALSE, TRUE, sizeof (EventReceiver), 32);
+  g_array_set_clear_func (chain, (GDestroyNotify) free_event_receiver);
+  create_event_emission_chain (stage, chain, grab_actor, entry->current_actor);
+
+  entry->cached_event_emission_chain = chain;
+  entry->cached_chain_grab_actor = grab_actor;
+  entry->cached_chain_age = age;
+
+  return chain;
+}
+
 typedef enum
 {
   EVENT_NOT_HANDLED,
@@ -4481,6 +4593,23 @@ clutter_stage_emit_event (ClutterStage       *self,
       if (state == EVENT_HANDLED_BY_ACTOR)
         remove_all_actions_from_chain (entry);
     }
+  else if (entry && !entry->sequence &&
+           target_actor == entry->current_actor &&
+           !priv->in_cached_chain_emission)
+    {
+      g_autoptr (GArray) chain = NULL;
+
+      /* Rapid motion and scroll events usually end up being emitted to
+       * the same actors and actions, so avoid collecting them every time.
+       */
+      chain = g_array_ref (ensure_cached_event_emission_chain (self,
+                                                               entry,
+                                                               seat_grab_actor));
+
+      priv->in_cached_chain_emission = TRUE;
+      emit_event (event, chain);
+      priv->in_cached_chain_emission = FALSE;
+    }
   else
     {
       create_event_emission_chain (self, priv->cur_event_emission_chain, seat_grab_actor, target_actor);
@@ -109,8 +109,24 @@ typedef enum
    * happen.
    */
   CLUTTER_FRAME_INFO_FLAG_VSYNC = 1 << 2,
+  /*
+   * The presentation was done with an asynchronous page flip, i.e. as soon
+   * as possible instead of at the next "vertical retrace", possibly tearing.
+   */
+  CLUTTER_FRAME_INFO_FLAG_ASYNC = 1 << 3,
 } ClutterFrameInfoFlag;
 
+/**
+ * ClutterFrameGpuPhase: (skip)
+ *
+ * GPU time spent in a named part of a frame.
+ */
+typedef struct _ClutterFrameGpuPhase
+{
+  const char *name;
+  int64_t duration_ns;
+} ClutterFrameGpuPhase;
+
 /**
  * ClutterFrameInfo: (skip)
  */
@@ -127,6 +143,9 @@ struct _ClutterFrameInfo
   gboolean has_valid_gpu_rendering_duration;
   int64_t gpu_rendering_duration_ns;
   int64_t cpu_time_before_buffer_swap_us;
+
+  const ClutterFrameGpuPhase *gpu_phases;
+  int n_gpu_phases;
 };
 
 CLUTTER_EXPORT
@@ -52,6 +52,7 @@
 #include "clutter/clutter-animatable.h"
 #include "clutter/clutter-backend-private.h"
 #include "clutter/clutter-binding-pool.h"
+#include "clutter/clutter-context-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-enum-types.h"
 #include "clutter/clutter-keysyms.h"
@@ -689,6 +690,42 @@ clutter_text_ensure_effective_attributes (ClutterText *self)
     }
 }
 
+static ClutterTextDirection
+clutter_text_resolve_direction (ClutterText *text,
+                                const char  *contents,
+                                gsize        contents_len)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ClutterTextDirection dir;
+
+  if (priv->password_char != 0)
+    dir = CLUTTER_TEXT_DIRECTION_DEFAULT;
+  else
+    dir = _clutter_find_base_dir (contents, contents_len);
+
+  if (dir == CLUTTER_TEXT_DIRECTION_DEFAULT)
+    {
+      if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
+        {
+          ClutterContext *clutter_context =
+            clutter_actor_get_context (CLUTTER_ACTOR (text));
+          ClutterBackend *backend =
+            clutter_context_get_backend (clutter_context);
+          ClutterSeat *seat =
+            clutter_backend_get_default_seat (backend);
+          ClutterKeymap *keymap = clutter_seat_get_keymap (seat);
+
+          dir = clutter_keymap_get_direction (keymap);
+        }
+      else
+        {
+          dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+        }
+    }
+
+  return dir;
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -739,30 +776,7 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
       PangoDirection pango_dir;
       PangoContext *context;
 
-      if (priv->password_char != 0)
-        dir = CLUTTER_TEXT_DIRECTION_DEFAULT;
-      else
-        dir = _clutter_find_base_dir (contents, contents_len);
-
-      if (dir == CLUTTER_TEXT_DIRECTION_DEFAULT)
-        {
-          if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
-            {
-              ClutterContext *clutter_context =
-                clutter_actor_get_context (CLUTTER_ACTOR (text));
-              ClutterBackend *backend =
-                clutter_context_get_backend (clutter_context);
-              ClutterSeat *seat =
-                clutter_backend_get_default_seat (backend);
-              ClutterKeymap *keymap = clutter_seat_get_keymap (seat);
-
-              dir = clutter_keymap_get_direction (keymap);
-            }
-          else
-            {
-              dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
-            }
-        }
+      dir = clutter_text_resolve_direction (text, contents, contents_len);
 
       pango_dir = clutter_text_direction_to_pango_direction (dir);
       context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
@@ -795,6 +809,70 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   return layout;
 }
 
+/* Layouts of text that can't be edited only depend on the text, its
+ * style and the available space, so they are shared with other actors
+ * showing the same text through the layout cache of the context. Password
+ * entries are excluded to not keep their contents around */
+static gboolean
+clutter_text_can_share_layouts (ClutterText *text)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+
+  return !priv->editable && priv->password_char == 0;
+}
+
+static PangoLayout *
+clutter_text_create_shared_layout (ClutterText        *text,
+                                   int                 width,
+                                   int                 height,
+                                   PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ClutterContext *context = clutter_actor_get_context (CLUTTER_ACTOR (text));
+  ClutterPangoLayoutCache *layout_cache =
+    clutter_context_get_layout_cache (context);
+  g_autofree char *contents = NULL;
+  ClutterTextDirection dir;
+  ClutterPangoLayoutKey key;
+  PangoLayout *layout;
+
+  contents = clutter_text_get_display_text (text);
+  dir = clutter_text_resolve_direction (text, contents, strlen (contents));
+
+  /* This will merge the markup attributes and the attributes
+   * property if needed */
+  clutter_text_ensure_effective_attributes (text);
+
+  key = (ClutterPangoLayoutKey) {
+    .pango_context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text)),
+    .text = contents,
+    .attrs = priv->effective_attrs,
+    .font_desc = priv->font_desc,
+    .base_dir = clutter_text_direction_to_pango_direction (dir),
+    .alignment = priv->alignment,
+    .wrap = priv->wrap_mode,
+    .ellipsize = ellipsize,
+    .width = width,
+    .height = height,
+    .justify = priv->justify,
+    .single_paragraph = priv->single_line_mode,
+  };
+
+  priv->resolved_direction = dir;
+
+  layout = clutter_pango_layout_cache_lookup (layout_cache, &key);
+  if (layout)
+    {
+      CLUTTER_NOTE (ACTOR, "ClutterText: %p: shared layout cache hit", text);
+      return layout;
+    }
+
+  layout = clutter_pango_layout_cache_create (layout_cache, &key);
+  clutter_ensure_glyph_cache_for_layout (context, layout);
+
+  return layout;
+}
+
 static void
 clutter_text_dirty_cache (ClutterText *text)
 {
@@ -1072,10 +1150,18 @@ clutter_text_create_layout (ClutterText *text,
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  if (clutter_text_can_share_layouts (text))
+    {
+      oldest_cache->layout =
+        clutter_text_create_shared_layout (text, width, height, ellipsize);
+    }
+  else
+    {
+      oldest_cache->layout =
+        clutter_text_create_layout_no_cache (text, width, height, ellipsize);
 
-  clutter_ensure_glyph_cache_for_layout (context, oldest_cache->layout);
+      clutter_ensure_glyph_cache_for_layout (context, oldest_cache->layout);
+    }
 
   /* Mark the 'time' this cache was created and advance the time */
   oldest_cache->age = priv->cache_age++;
@@ -4831,7 +4917,7 @@ clutter_text_set_editable (ClutterText *self,
 
   if (priv->editable != editable)
     {
-      accessible = clutter_actor_get_accessible (CLUTTER_ACTOR (self));
+      accessible = clutter_actor_peek_accessible (CLUTTER_ACTOR (self));
       priv->editable = editable;
 
       if (method)
@@ -4842,6 +4928,8 @@ clutter_text_set_editable (ClutterText *self,
             clutter_text_im_focus (self);
         }
 
+      /* Editable text doesn't use shared layouts */
+      clutter_text_dirty_cache (self);
       clutter_text_queue_redraw (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_EDITABLE]);
@@ -6172,7 +6260,7 @@ clutter_text_set_password_char (ClutterText *self,
 
   if (priv->password_char != wc)
     {
-      accessible = clutter_actor_get_accessible (CLUTTER_ACTOR (self));
+      accessible = clutter_actor_peek_accessible (CLUTTER_ACTOR (self));
       priv->password_char = wc;
 
       clutter_text_dirty_cache (self);
@@ -36,6 +36,13 @@
 #include "clutter/pango/clutter-pango-glyph-cache.h"
 #include "clutter/pango/clutter-pango-private.h"
 
+/* Dirty glyphs are only rasterized on worker threads when there are
+   enough of them to be worth handing over, e.g. when the text of a
+   whole stage has to be shown at a new scale after moving to a monitor
+   with a different scale */
+#define MIN_GLYPHS_FOR_WORKERS 64
+#define MAX_RASTERIZATION_THREADS 4
+
 struct _ClutterPangoGlyphCache
 {
   CoglContext *ctx;
@@ -59,8 +66,49 @@ struct _ClutterPangoGlyphCache
      optimization in clutter_pango_glyph_cache_set_dirty_glyphs to avoid
      iterating the hash table if we know none of them are dirty */
   gboolean has_dirty_glyphs;
+
+  /* Incremented on every lookup to find the least recently used glyphs */
+  uint64_t age;
+
+  /* Bytes used by the glyphs stored in the global atlas. Only those can
+     be evicted, as the local atlases never give back their space */
+  size_t size;
+
+  /* Worker threads rasterizing the dirty glyphs of one font each */
+  GThreadPool *rasterization_pool;
 };
 
+typedef struct _RasterizationBatch
+{
+  GMutex mutex;
+  GCond cond;
+  int n_pending;
+} RasterizationBatch;
+
+typedef struct _DirtyGlyph
+{
+  PangoGlyphCacheValue *value;
+  PangoGlyph glyph;
+  int draw_x;
+  int draw_y;
+  int draw_width;
+  int draw_height;
+  cairo_format_t format;
+  cairo_surface_t *surface;
+} DirtyGlyph;
+
+/* The glyphs of a font are rasterized together, as they would otherwise
+   contend for the lock of the font face. Only the cairo scaled font is
+   used off the main thread, as the PangoFont isn't thread safe */
+typedef struct _DirtyFont
+{
+  cairo_scaled_font_t *scaled_font;
+  GArray *glyphs;
+  gboolean has_color;
+
+  RasterizationBatch *batch;
+} DirtyFont;
+
 typedef struct _PangoGlyphCacheKey
 {
   PangoFont  *font;
@@ -131,6 +179,11 @@ clutter_pango_glyph_cache_new (CoglContext *ctx)
 
   cache->using_global_atlas = FALSE;
 
+  cache->age = 0;
+  cache->size = 0;
+
+  cache->rasterization_pool = NULL;
+
   return cache;
 }
 
@@ -161,6 +214,9 @@ clutter_pango_glyph_cache_free (ClutterPangoGlyphCache *cache)
 
   g_hook_list_clear (&cache->reorganize_callbacks);
 
+  if (cache->rasterization_pool)
+    g_thread_pool_free (cache->rasterization_pool, FALSE, TRUE);
+
   g_free (cache);
 }
 
@@ -209,6 +265,7 @@ clutter_pango_glyph_cache_add_to_global_atlas (ClutterPangoGlyphCache  *cache,
     }
 
   value->texture = texture;
+  cache->size += (size_t) value->draw_width * value->draw_height * 4;
   value->tx1 = 0;
   value->ty1 = 0;
   value->tx2 = 1;
@@ -345,17 +402,17 @@ clutter_pango_glyph_cache_lookup (ClutterPangoGlyphCache *cache,
       g_hash_table_insert (cache->hash_table, key, value);
     }
 
+  if (value)
+    value->last_used = ++cache->age;
+
   return value;
 }
 
 static gboolean
-font_has_color_glyphs (const PangoFont *font)
+font_has_color_glyphs (cairo_scaled_font_t *scaled_font)
 {
-  cairo_scaled_font_t *scaled_font;
   gboolean has_color = FALSE;
 
-  scaled_font = pango_cairo_font_get_scaled_font ((PangoCairoFont *) font);
-
   if (cairo_scaled_font_get_type (scaled_font) == CAIRO_FONT_TYPE_FT)
     {
       FT_Face ft_face = cairo_ft_scaled_font_lock_face (scaled_font);
@@ -367,37 +424,161 @@ font_has_color_glyphs (const PangoFont *font)
 }
 
 static void
-clutter_pango_glyph_cache_set_dirty_glyphs_cb (void *key_ptr,
-                                               void *value_ptr,
-                                               void *user_data)
+dirty_font_free (DirtyFont *dirty_font)
 {
-  PangoGlyphCacheKey *key = key_ptr;
-  PangoGlyphCacheValue *value = value_ptr;
-  cairo_surface_t *surface;
-  cairo_t *cr;
-  cairo_scaled_font_t *scaled_font;
-  cairo_glyph_t cairo_glyph;
-  cairo_format_t format_cairo;
-  CoglPixelFormat format_cogl;
+  unsigned int i;
 
-  if (value->dirty)
+  for (i = 0; i < dirty_font->glyphs->len; i++)
     {
-      CLUTTER_NOTE (PANGO, "redrawing glyph %i", key->glyph);
+      DirtyGlyph *dirty_glyph = &g_array_index (dirty_font->glyphs,
+                                                DirtyGlyph, i);
 
-      /* Glyphs that don't take up any space will end up without a
-        texture. These should never become dirty so they shouldn't end up
-        here */
-      g_return_if_fail (value->texture != NULL);
+      g_clear_pointer (&dirty_glyph->surface, cairo_surface_destroy);
+    }
+
+  g_array_unref (dirty_font->glyphs);
+  cairo_scaled_font_destroy (dirty_font->scaled_font);
+  g_free (dirty_font);
+}
+
+/* Called on the main thread or a worker thread */
+static void
+rasterize_dirty_font (DirtyFont *dirty_font)
+{
+  unsigned int i;
+
+  for (i = 0; i < dirty_font->glyphs->len; i++)
+    {
+      DirtyGlyph *dirty_glyph = &g_array_index (dirty_font->glyphs,
+                                                DirtyGlyph, i);
+      cairo_surface_t *surface;
+      cairo_glyph_t cairo_glyph;
+      cairo_t *cr;
+
+      surface = cairo_image_surface_create (dirty_glyph->format,
+                                            dirty_glyph->draw_width,
+                                            dirty_glyph->draw_height);
+      cr = cairo_create (surface);
+
+      cairo_set_scaled_font (cr, dirty_font->scaled_font);
+
+      cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
+
+      cairo_glyph.x = -dirty_glyph->draw_x;
+      cairo_glyph.y = -dirty_glyph->draw_y;
+      /* The PangoCairo glyph numbers directly map to Cairo glyph
+        numbers */
+      cairo_glyph.index = dirty_glyph->glyph;
+      cairo_show_glyphs (cr, &cairo_glyph, 1);
+
+      cairo_destroy (cr);
+      cairo_surface_flush (surface);
+
+      dirty_glyph->surface = surface;
+    }
+
+  dirty_font->has_color = font_has_color_glyphs (dirty_font->scaled_font);
+}
+
+static void
+rasterize_dirty_font_in_thread (void *data,
+                                void *user_data)
+{
+  DirtyFont *dirty_font = data;
+  RasterizationBatch *batch = dirty_font->batch;
+
+  rasterize_dirty_font (dirty_font);
+
+  g_mutex_lock (&batch->mutex);
+  batch->n_pending--;
+  g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+}
+
+static GThreadPool *
+ensure_rasterization_pool (ClutterPangoGlyphCache *cache)
+{
+  unsigned int n_threads;
+
+  if (cache->rasterization_pool)
+    return cache->rasterization_pool;
+
+  n_threads = MIN (g_get_num_processors () - 1, MAX_RASTERIZATION_THREADS);
+  if (n_threads == 0)
+    return NULL;
+
+  cache->rasterization_pool = g_thread_pool_new (rasterize_dirty_font_in_thread,
+                                                 NULL,
+                                                 (int) n_threads,
+                                                 FALSE,
+                                                 NULL);
+
+  return cache->rasterization_pool;
+}
+
+static void
+rasterize_dirty_fonts (ClutterPangoGlyphCache *cache,
+                       GPtrArray              *dirty_fonts,
+                       unsigned int            n_dirty_glyphs)
+{
+  RasterizationBatch batch = { 0 };
+  GThreadPool *pool = NULL;
+  unsigned int i;
+
+  if (n_dirty_glyphs >= MIN_GLYPHS_FOR_WORKERS && dirty_fonts->len > 1)
+    pool = ensure_rasterization_pool (cache);
+
+  if (!pool)
+    {
+      g_ptr_array_foreach (dirty_fonts, (GFunc) rasterize_dirty_font, NULL);
+      return;
+    }
+
+  CLUTTER_NOTE (PANGO, "Rasterizing %u glyphs of %u fonts in worker threads",
+                n_dirty_glyphs, dirty_fonts->len);
+
+  g_mutex_init (&batch.mutex);
+  g_cond_init (&batch.cond);
+  batch.n_pending = (int) dirty_fonts->len - 1;
+
+  /* Rasterize the first font here rather than just wait for the others */
+  for (i = 1; i < dirty_fonts->len; i++)
+    {
+      DirtyFont *dirty_font = g_ptr_array_index (dirty_fonts, i);
+
+      dirty_font->batch = &batch;
+      g_thread_pool_push (pool, dirty_font, NULL);
+    }
+
+  rasterize_dirty_font (g_ptr_array_index (dirty_fonts, 0));
+
+  g_mutex_lock (&batch.mutex);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.mutex);
+  g_mutex_unlock (&batch.mutex);
+
+  g_cond_clear (&batch.cond);
+  g_mutex_clear (&batch.mutex);
+}
+
+static void
+upload_dirty_font (DirtyFont *dirty_font)
+{
+  unsigned int i;
+
+  for (i = 0; i < dirty_font->glyphs->len; i++)
+    {
+      DirtyGlyph *dirty_glyph = &g_array_index (dirty_font->glyphs,
+                                                DirtyGlyph, i);
+      PangoGlyphCacheValue *value = dirty_glyph->value;
+      CoglPixelFormat format_cogl;
 
-      if (cogl_texture_get_format (value->texture) == COGL_PIXEL_FORMAT_A_8)
+      if (dirty_glyph->format == CAIRO_FORMAT_A8)
         {
-          format_cairo = CAIRO_FORMAT_A8;
           format_cogl = COGL_PIXEL_FORMAT_A_8;
         }
       else
         {
-          format_cairo = CAIRO_FORMAT_ARGB32;
-
           /* Cairo stores the data in native byte order as ARGB but Cogl's
             pixel formats specify the actual byte order. Therefore we
             need to use a different format depending on the
@@ -409,26 +590,6 @@ clutter_pango_glyph_cache_set_dirty_glyphs_cb (void *key_ptr,
 #endif
         }
 
-      surface = cairo_image_surface_create (format_cairo,
-                                            value->draw_width,
-                                            value->draw_height);
-      cr = cairo_create (surface);
-
-      scaled_font = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (key->font));
-      cairo_set_scaled_font (cr, scaled_font);
-
-      cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
-
-      cairo_glyph.x = -value->draw_x;
-      cairo_glyph.y = -value->draw_y;
-      /* The PangoCairo glyph numbers directly map to Cairo glyph
-        numbers */
-      cairo_glyph.index = key->glyph;
-      cairo_show_glyphs (cr, &cairo_glyph, 1);
-
-      cairo_destroy (cr);
-      cairo_surface_flush (surface);
-
       /* Copy the glyph to the texture */
       cogl_texture_set_region (value->texture,
                               0, /* src_x */
@@ -440,12 +601,10 @@ clutter_pango_glyph_cache_set_dirty_glyphs_cb (void *key_ptr,
                               value->draw_width, /* width */
                               value->draw_height, /* height */
                               format_cogl,
-                              cairo_image_surface_get_stride (surface),
-                              cairo_image_surface_get_data (surface));
-
-      cairo_surface_destroy (surface);
+                              cairo_image_surface_get_stride (dirty_glyph->surface),
+                              cairo_image_surface_get_data (dirty_glyph->surface));
 
-      value->has_color = font_has_color_glyphs (key->font);
+      value->has_color = dirty_font->has_color;
       value->dirty = FALSE;
     }
 }
@@ -453,14 +612,79 @@ clutter_pango_glyph_cache_set_dirty_glyphs_cb (void *key_ptr,
 void
 clutter_pango_glyph_cache_set_dirty_glyphs (ClutterPangoGlyphCache *cache)
 {
+  g_autoptr (GHashTable) dirty_fonts_by_font = NULL;
+  g_autoptr (GPtrArray) dirty_fonts = NULL;
+  unsigned int n_dirty_glyphs = 0;
+  GHashTableIter iter;
+  void *key_ptr;
+  void *value_ptr;
+
   /* If we know that there are no dirty glyphs then we can shortcut
      out early */
   if (!cache->has_dirty_glyphs)
     return;
 
-  g_hash_table_foreach (cache->hash_table,
-                        clutter_pango_glyph_cache_set_dirty_glyphs_cb,
-                        NULL);
+  dirty_fonts_by_font = g_hash_table_new (NULL, NULL);
+  dirty_fonts = g_ptr_array_new_with_free_func ((GDestroyNotify) dirty_font_free);
+
+  g_hash_table_iter_init (&iter, cache->hash_table);
+  while (g_hash_table_iter_next (&iter, &key_ptr, &value_ptr))
+    {
+      PangoGlyphCacheKey *key = key_ptr;
+      PangoGlyphCacheValue *value = value_ptr;
+      DirtyFont *dirty_font;
+      DirtyGlyph dirty_glyph;
+
+      if (!value->dirty)
+        continue;
+
+      CLUTTER_NOTE (PANGO, "redrawing glyph %i", key->glyph);
+
+      /* Glyphs that don't take up any space will end up without a
+        texture. These should never become dirty so they shouldn't end up
+        here */
+      if (value->texture == NULL)
+        {
+          g_warn_if_reached ();
+          continue;
+        }
+
+      dirty_font = g_hash_table_lookup (dirty_fonts_by_font, key->font);
+      if (!dirty_font)
+        {
+          cairo_scaled_font_t *scaled_font;
+
+          scaled_font =
+            pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (key->font));
+
+          dirty_font = g_new0 (DirtyFont, 1);
+          dirty_font->scaled_font = cairo_scaled_font_reference (scaled_font);
+          dirty_font->glyphs = g_array_new (FALSE, FALSE, sizeof (DirtyGlyph));
+
+          g_hash_table_insert (dirty_fonts_by_font, key->font, dirty_font);
+          g_ptr_array_add (dirty_fonts, dirty_font);
+        }
+
+      dirty_glyph = (DirtyGlyph) {
+        .value = value,
+        .glyph = key->glyph,
+        .draw_x = value->draw_x,
+        .draw_y = value->draw_y,
+        .draw_width = value->draw_width,
+        .draw_height = value->draw_height,
+        .format =
+          cogl_texture_get_format (value->texture) == COGL_PIXEL_FORMAT_A_8 ?
+          CAIRO_FORMAT_A8 : CAIRO_FORMAT_ARGB32,
+      };
+      g_array_append_val (dirty_font->glyphs, dirty_glyph);
+      n_dirty_glyphs++;
+    }
+
+  if (dirty_fonts->len > 0)
+    {
+      rasterize_dirty_fonts (cache, dirty_fonts, n_dirty_glyphs);
+      g_ptr_array_foreach (dirty_fonts, (GFunc) upload_dirty_font, NULL);
+    }
 
   cache->has_dirty_glyphs = FALSE;
 }
@@ -489,3 +713,92 @@ clutter_pango_glyph_cache_remove_reorganize_callback (ClutterPangoGlyphCache *ca
   if (hook)
     g_hook_destroy_link (&cache->reorganize_callbacks, hook);
 }
+
+size_t
+clutter_pango_glyph_cache_get_size (ClutterPangoGlyphCache *cache)
+{
+  return cache->size;
+}
+
+static gboolean
+is_in_global_atlas (PangoGlyphCacheValue *value)
+{
+  return value->texture && COGL_IS_ATLAS_TEXTURE (value->texture);
+}
+
+static int
+compare_last_used (const void *a,
+                   const void *b)
+{
+  PangoGlyphCacheValue *value_a = *(PangoGlyphCacheValue **) a;
+  PangoGlyphCacheValue *value_b = *(PangoGlyphCacheValue **) b;
+
+  if (value_a->last_used < value_b->last_used)
+    return -1;
+  else if (value_a->last_used > value_b->last_used)
+    return 1;
+  else
+    return 0;
+}
+
+static gboolean
+remove_evicted_glyph_cb (void *key,
+                         void *value,
+                         void *user_data)
+{
+  GHashTable *evicted = user_data;
+
+  return g_hash_table_contains (evicted, value);
+}
+
+/* Evicts the least recently used glyphs of the global atlas until they
+ * use less than max_size bytes. Glyphs drawn through a cached display
+ * list aren't looked up again, so the display lists are all dropped
+ * afterwards; this both releases their references on the evicted
+ * textures and lets the glyphs still in use be marked as such again.
+ */
+gboolean
+clutter_pango_glyph_cache_trim (ClutterPangoGlyphCache *cache,
+                                size_t                  max_size)
+{
+  g_autoptr (GPtrArray) values = NULL;
+  g_autoptr (GHashTable) evicted = NULL;
+  GHashTableIter iter;
+  void *value_ptr;
+  unsigned int i;
+
+  if (cache->size <= max_size)
+    return FALSE;
+
+  values = g_ptr_array_new ();
+
+  g_hash_table_iter_init (&iter, cache->hash_table);
+  while (g_hash_table_iter_next (&iter, NULL, &value_ptr))
+    {
+      if (is_in_global_atlas (value_ptr))
+        g_ptr_array_add (values, value_ptr);
+    }
+
+  g_ptr_array_sort (values, compare_last_used);
+
+  evicted = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < values->len && cache->size > max_size; i++)
+    {
+      PangoGlyphCacheValue *value = g_ptr_array_index (values, i);
+
+      cache->size -= (size_t) value->draw_width * value->draw_height * 4;
+      g_hash_table_add (evicted, value);
+    }
+
+  CLUTTER_NOTE (PANGO, "Evicting %u glyphs from the glyph cache",
+                g_hash_table_size (evicted));
+
+  g_hash_table_foreach_remove (cache->hash_table,
+                               remove_evicted_glyph_cb,
+                               evicted);
+
+  g_hook_list_invoke (&cache->reorganize_callbacks, FALSE);
+
+  return TRUE;
+}
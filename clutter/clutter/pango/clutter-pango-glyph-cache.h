@@ -59,6 +59,9 @@ typedef struct
   guint dirty : 1;
   /* Set to TRUE if the glyph has colors (eg. emoji) */
   guint has_color : 1;
+
+  /* Age of the cache when the glyph was last looked up */
+  uint64_t last_used;
 } PangoGlyphCacheValue;
 
 ClutterPangoGlyphCache * clutter_pango_glyph_cache_new (CoglContext *ctx);
@@ -81,4 +84,9 @@ void clutter_pango_glyph_cache_remove_reorganize_callback (ClutterPangoGlyphCach
 
 void clutter_pango_glyph_cache_set_dirty_glyphs (ClutterPangoGlyphCache *cache);
 
+size_t clutter_pango_glyph_cache_get_size (ClutterPangoGlyphCache *cache);
+
+gboolean clutter_pango_glyph_cache_trim (ClutterPangoGlyphCache *cache,
+                                         size_t                  max_size);
+
 G_END_DECLS
@@ -0,0 +1,380 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2024 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Many text actors of a shell show the same strings with the same style,
+ * e.g. the labels of an app grid or of a notification stack. Instead of
+ * having each of them shape its own layout, layouts that only depend on
+ * their key are shared between them through this cache.
+ */
+
+#include "config.h"
+
+#include <pango/pangocairo.h>
+#include <string.h>
+
+#include "clutter/pango/clutter-pango-layout-cache.h"
+
+/* Rough per layout and per line overhead of the pango structures, on
+ * top of the glyph strings and the log attributes of the text */
+#define LAYOUT_BASE_SIZE 512
+#define LAYOUT_LINE_SIZE 128
+
+typedef struct _LayoutCacheEntry
+{
+  PangoFontMap *font_map;
+  PangoLanguage *language;
+  cairo_font_options_t *font_options;
+  double resolution;
+
+  char *text;
+  PangoAttrList *attrs;
+  PangoFontDescription *font_desc;
+  PangoDirection base_dir;
+  PangoAlignment alignment;
+  PangoWrapMode wrap;
+  PangoEllipsizeMode ellipsize;
+  int width;
+  int height;
+  gboolean justify;
+  gboolean single_paragraph;
+
+  unsigned int hash;
+
+  PangoLayout *layout;
+  size_t size;
+  GList link;
+} LayoutCacheEntry;
+
+struct _ClutterPangoLayoutCache
+{
+  GHashTable *entries;
+
+  /* Most recently used entries first */
+  GQueue lru;
+
+  size_t size;
+  size_t max_size;
+};
+
+static unsigned int
+layout_cache_entry_hash (gconstpointer data)
+{
+  const LayoutCacheEntry *entry = data;
+
+  return entry->hash;
+}
+
+static gboolean
+attr_lists_equal (PangoAttrList *attrs0,
+                  PangoAttrList *attrs1)
+{
+  if (attrs0 == attrs1)
+    return TRUE;
+
+  if (!attrs0 || !attrs1)
+    return FALSE;
+
+  return pango_attr_list_equal (attrs0, attrs1);
+}
+
+static gboolean
+font_options_equal (const cairo_font_options_t *options0,
+                    const cairo_font_options_t *options1)
+{
+  if (options0 == options1)
+    return TRUE;
+
+  if (!options0 || !options1)
+    return FALSE;
+
+  return cairo_font_options_equal (options0, options1);
+}
+
+static gboolean
+font_descriptions_equal (const PangoFontDescription *desc0,
+                         const PangoFontDescription *desc1)
+{
+  if (desc0 == desc1)
+    return TRUE;
+
+  if (!desc0 || !desc1)
+    return FALSE;
+
+  return pango_font_description_equal (desc0, desc1);
+}
+
+static gboolean
+layout_cache_entry_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const LayoutCacheEntry *entry0 = a;
+  const LayoutCacheEntry *entry1 = b;
+
+  return (entry0->hash == entry1->hash &&
+          entry0->font_map == entry1->font_map &&
+          entry0->language == entry1->language &&
+          entry0->resolution == entry1->resolution &&
+          entry0->base_dir == entry1->base_dir &&
+          entry0->alignment == entry1->alignment &&
+          entry0->wrap == entry1->wrap &&
+          entry0->ellipsize == entry1->ellipsize &&
+          entry0->width == entry1->width &&
+          entry0->height == entry1->height &&
+          entry0->justify == entry1->justify &&
+          entry0->single_paragraph == entry1->single_paragraph &&
+          font_options_equal (entry0->font_options, entry1->font_options) &&
+          font_descriptions_equal (entry0->font_desc, entry1->font_desc) &&
+          g_str_equal (entry0->text, entry1->text) &&
+          attr_lists_equal (entry0->attrs, entry1->attrs));
+}
+
+static unsigned int
+hash_int (unsigned int hash,
+          int          value)
+{
+  return (hash * 31) + (unsigned int) value;
+}
+
+/* Fills in a lookup entry that borrows the data of the key */
+static void
+init_lookup_entry (LayoutCacheEntry            *entry,
+                   const ClutterPangoLayoutKey *key)
+{
+  unsigned int hash;
+
+  *entry = (LayoutCacheEntry) {
+    .font_map = pango_context_get_font_map (key->pango_context),
+    .language = pango_context_get_language (key->pango_context),
+    .font_options = (cairo_font_options_t *)
+      pango_cairo_context_get_font_options (key->pango_context),
+    .resolution = pango_cairo_context_get_resolution (key->pango_context),
+    .text = (char *) key->text,
+    .attrs = key->attrs,
+    .font_desc = (PangoFontDescription *) key->font_desc,
+    .base_dir = key->base_dir,
+    .alignment = key->alignment,
+    .wrap = key->wrap,
+    .ellipsize = key->ellipsize,
+    .width = key->width,
+    .height = key->height,
+    .justify = !!key->justify,
+    .single_paragraph = !!key->single_paragraph,
+  };
+
+  /* The attributes can't be hashed, so they are only compared */
+  hash = g_str_hash (entry->text);
+  if (entry->font_desc)
+    hash = hash_int (hash, pango_font_description_hash (entry->font_desc));
+  if (entry->font_options)
+    hash = hash_int (hash, cairo_font_options_hash (entry->font_options));
+  hash = hash_int (hash, GPOINTER_TO_INT (entry->font_map));
+  hash = hash_int (hash, entry->base_dir);
+  hash = hash_int (hash, entry->alignment);
+  hash = hash_int (hash, entry->wrap);
+  hash = hash_int (hash, entry->ellipsize);
+  hash = hash_int (hash, entry->width);
+  hash = hash_int (hash, entry->height);
+  hash = hash_int (hash, entry->justify);
+  hash = hash_int (hash, entry->single_paragraph);
+
+  entry->hash = hash;
+}
+
+static void
+layout_cache_entry_free (LayoutCacheEntry *entry)
+{
+  g_clear_object (&entry->layout);
+  g_clear_object (&entry->font_map);
+  g_clear_pointer (&entry->font_options, cairo_font_options_destroy);
+  g_clear_pointer (&entry->attrs, pango_attr_list_unref);
+  g_clear_pointer (&entry->font_desc, pango_font_description_free);
+  g_free (entry->text);
+  g_free (entry);
+}
+
+static PangoLayout *
+create_layout (const LayoutCacheEntry *entry)
+{
+  g_autoptr (PangoContext) context = NULL;
+  PangoLayout *layout;
+
+  context = pango_font_map_create_context (entry->font_map);
+  pango_context_set_language (context, entry->language);
+  pango_context_set_base_dir (context, entry->base_dir);
+  pango_cairo_context_set_font_options (context, entry->font_options);
+  pango_cairo_context_set_resolution (context, entry->resolution);
+
+  layout = pango_layout_new (context);
+  pango_layout_set_font_description (layout, entry->font_desc);
+  pango_layout_set_text (layout, entry->text, -1);
+
+  if (entry->attrs)
+    pango_layout_set_attributes (layout, entry->attrs);
+
+  pango_layout_set_alignment (layout, entry->alignment);
+  pango_layout_set_single_paragraph_mode (layout, entry->single_paragraph);
+  pango_layout_set_justify (layout, entry->justify);
+  pango_layout_set_wrap (layout, entry->wrap);
+
+  pango_layout_set_ellipsize (layout, entry->ellipsize);
+  pango_layout_set_width (layout, entry->width);
+  pango_layout_set_height (layout, entry->height);
+
+  return layout;
+}
+
+static size_t
+estimate_entry_size (LayoutCacheEntry *entry)
+{
+  size_t text_len = strlen (entry->text);
+  int n_lines;
+
+  n_lines = pango_layout_get_line_count (entry->layout);
+
+  return (sizeof (LayoutCacheEntry) +
+          text_len + 1 +
+          LAYOUT_BASE_SIZE +
+          n_lines * LAYOUT_LINE_SIZE +
+          text_len * (sizeof (PangoGlyphInfo) +
+                      sizeof (int) +
+                      sizeof (PangoLogAttr)));
+}
+
+static void
+remove_entry (ClutterPangoLayoutCache *cache,
+              LayoutCacheEntry        *entry)
+{
+  g_queue_unlink (&cache->lru, &entry->link);
+  cache->size -= entry->size;
+
+  g_hash_table_remove (cache->entries, entry);
+}
+
+static void
+evict_entries (ClutterPangoLayoutCache *cache)
+{
+  while (cache->size > cache->max_size &&
+         !g_queue_is_empty (&cache->lru))
+    remove_entry (cache, g_queue_peek_tail (&cache->lru));
+}
+
+ClutterPangoLayoutCache *
+clutter_pango_layout_cache_new (size_t max_size)
+{
+  ClutterPangoLayoutCache *cache = g_new0 (ClutterPangoLayoutCache, 1);
+
+  cache->entries =
+    g_hash_table_new_full (layout_cache_entry_hash,
+                           layout_cache_entry_equal,
+                           (GDestroyNotify) layout_cache_entry_free,
+                           NULL);
+  g_queue_init (&cache->lru);
+  cache->max_size = max_size;
+
+  return cache;
+}
+
+void
+clutter_pango_layout_cache_free (ClutterPangoLayoutCache *cache)
+{
+  clutter_pango_layout_cache_clear (cache);
+  g_hash_table_destroy (cache->entries);
+  g_free (cache);
+}
+
+PangoLayout *
+clutter_pango_layout_cache_lookup (ClutterPangoLayoutCache     *cache,
+                                   const ClutterPangoLayoutKey *key)
+{
+  LayoutCacheEntry lookup_entry;
+  LayoutCacheEntry *entry;
+
+  init_lookup_entry (&lookup_entry, key);
+
+  entry = g_hash_table_lookup (cache->entries, &lookup_entry);
+  if (!entry)
+    return NULL;
+
+  g_queue_unlink (&cache->lru, &entry->link);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+
+  return g_object_ref (entry->layout);
+}
+
+PangoLayout *
+clutter_pango_layout_cache_create (ClutterPangoLayoutCache     *cache,
+                                   const ClutterPangoLayoutKey *key)
+{
+  LayoutCacheEntry lookup_entry;
+  LayoutCacheEntry *entry;
+  LayoutCacheEntry *old_entry;
+
+  init_lookup_entry (&lookup_entry, key);
+
+  old_entry = g_hash_table_lookup (cache->entries, &lookup_entry);
+  if (old_entry)
+    remove_entry (cache, old_entry);
+
+  entry = g_new0 (LayoutCacheEntry, 1);
+  *entry = lookup_entry;
+  entry->font_map = g_object_ref (lookup_entry.font_map);
+  if (lookup_entry.font_options)
+    entry->font_options = cairo_font_options_copy (lookup_entry.font_options);
+  entry->text = g_strdup (lookup_entry.text);
+  if (lookup_entry.attrs)
+    entry->attrs = pango_attr_list_copy (lookup_entry.attrs);
+  if (lookup_entry.font_desc)
+    entry->font_desc = pango_font_description_copy (lookup_entry.font_desc);
+  entry->link = (GList) { .data = entry };
+
+  entry->layout = create_layout (entry);
+  entry->size = estimate_entry_size (entry);
+
+  if (entry->size > cache->max_size)
+    {
+      PangoLayout *layout = g_steal_pointer (&entry->layout);
+
+      layout_cache_entry_free (entry);
+      return layout;
+    }
+
+  g_hash_table_add (cache->entries, entry);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  cache->size += entry->size;
+
+  evict_entries (cache);
+
+  return g_object_ref (entry->layout);
+}
+
+size_t
+clutter_pango_layout_cache_get_size (ClutterPangoLayoutCache *cache)
+{
+  return cache->size;
+}
+
+void
+clutter_pango_layout_cache_clear (ClutterPangoLayoutCache *cache)
+{
+  while (!g_queue_is_empty (&cache->lru))
+    remove_entry (cache, g_queue_peek_head (&cache->lru));
+}
@@ -0,0 +1,72 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2024 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <pango/pango.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterPangoLayoutCache ClutterPangoLayoutCache;
+
+/* Everything a shared layout is built from. The pango context is only
+   used for its font map, language, font options and resolution; the
+   layouts in the cache use their own context so that they are not
+   affected by later changes to it */
+typedef struct _ClutterPangoLayoutKey
+{
+  PangoContext *pango_context;
+  const char *text;
+  PangoAttrList *attrs;
+  const PangoFontDescription *font_desc;
+  PangoDirection base_dir;
+  PangoAlignment alignment;
+  PangoWrapMode wrap;
+  PangoEllipsizeMode ellipsize;
+  int width;
+  int height;
+  gboolean justify;
+  gboolean single_paragraph;
+} ClutterPangoLayoutKey;
+
+/* Creates a cache keeping the least recently used layouts until their
+   estimated memory usage goes over max_size bytes */
+ClutterPangoLayoutCache * clutter_pango_layout_cache_new (size_t max_size);
+
+void clutter_pango_layout_cache_free (ClutterPangoLayoutCache *cache);
+
+/* Returns a new reference to the cached layout for the key, or NULL.
+   Shared layouts must not be modified */
+PangoLayout * clutter_pango_layout_cache_lookup (ClutterPangoLayoutCache     *cache,
+                                                 const ClutterPangoLayoutKey *key);
+
+/* Creates a layout for the key and adds it to the cache, evicting the
+   least recently used layouts if needed. Returns a new reference */
+PangoLayout * clutter_pango_layout_cache_create (ClutterPangoLayoutCache     *cache,
+                                                 const ClutterPangoLayoutKey *key);
+
+/* Returns the estimated memory used by the cached layouts in bytes */
+size_t clutter_pango_layout_cache_get_size (ClutterPangoLayoutCache *cache);
+
+void clutter_pango_layout_cache_clear (ClutterPangoLayoutCache *cache);
+
+G_END_DECLS
@@ -44,6 +44,11 @@ G_BEGIN_DECLS
 
 PangoRenderer * clutter_pango_renderer_new (CoglContext *context);
 
+size_t clutter_pango_renderer_get_glyph_cache_size (PangoRenderer *renderer);
+
+gboolean clutter_pango_renderer_trim_glyph_cache (PangoRenderer *renderer,
+                                                  size_t         max_size);
+
 /**
  * clutter_ensure_glyph_cache_for_layout:
  * @context: A #ClutterContext
@@ -106,6 +106,23 @@ clutter_pango_renderer_new (CoglContext *context)
                                        "context", context, NULL));
 }
 
+size_t
+clutter_pango_renderer_get_glyph_cache_size (PangoRenderer *renderer)
+{
+  ClutterPangoRenderer *priv = CLUTTER_PANGO_RENDERER (renderer);
+
+  return clutter_pango_glyph_cache_get_size (priv->glyph_cache);
+}
+
+gboolean
+clutter_pango_renderer_trim_glyph_cache (PangoRenderer *renderer,
+                                         size_t         max_size)
+{
+  ClutterPangoRenderer *priv = CLUTTER_PANGO_RENDERER (renderer);
+
+  return clutter_pango_glyph_cache_trim (priv->glyph_cache, max_size);
+}
+
 static void
 clutter_pango_renderer_slice_cb (CoglTexture *texture,
                                  const float *slice_coords,
@@ -44,6 +44,10 @@ struct _CoglAtlas
 
   CoglAtlasUpdatePositionCallback update_position_cb;
 
+  /* The size the atlas started with, it is never compacted below it */
+  unsigned int initial_width;
+  unsigned int initial_height;
+
   GHookList pre_reorganize_callbacks;
   GHookList post_reorganize_callbacks;
 };
@@ -52,6 +56,16 @@ void
 _cogl_atlas_remove (CoglAtlas          *atlas,
                     const MtkRectangle *rectangle);
 
+gboolean
+_cogl_atlas_needs_compaction (CoglAtlas *atlas,
+                              float      max_waste);
+
+gboolean
+_cogl_atlas_compact (CoglAtlas *atlas);
+
+size_t
+_cogl_atlas_get_size (CoglAtlas *atlas);
+
 CoglTexture *
 _cogl_atlas_copy_rectangle (CoglAtlas       *atlas,
                             int              x,
@@ -927,3 +927,49 @@ cogl_atlas_texture_remove_reorganize_callback (CoglContext *ctx,
   if (hook)
     g_hook_destroy_link (&ctx->atlas_reorganize_callbacks, hook);
 }
+
+gboolean
+cogl_atlas_texture_atlases_need_compaction (CoglContext *ctx,
+                                            float        max_waste)
+{
+  GSList *l;
+
+  for (l = ctx->atlases; l; l = l->next)
+    {
+      if (_cogl_atlas_needs_compaction (l->data, max_waste))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+void
+cogl_atlas_texture_compact_atlases (CoglContext *ctx,
+                                    float        max_waste)
+{
+  GSList *atlases;
+  GSList *l;
+
+  /* The reorganize callbacks may end up dropping atlases */
+  atlases = g_slist_copy_deep (ctx->atlases, (GCopyFunc) g_object_ref, NULL);
+
+  for (l = atlases; l; l = l->next)
+    {
+      if (_cogl_atlas_needs_compaction (l->data, max_waste))
+        _cogl_atlas_compact (l->data);
+    }
+
+  g_slist_free_full (atlases, g_object_unref);
+}
+
+size_t
+cogl_atlas_texture_get_atlases_size (CoglContext *ctx)
+{
+  size_t size = 0;
+  GSList *l;
+
+  for (l = ctx->atlases; l; l = l->next)
+    size += _cogl_atlas_get_size (l->data);
+
+  return size;
+}
@@ -159,4 +159,41 @@ cogl_atlas_texture_remove_reorganize_callback (CoglContext *ctx,
                                                GHookFunc callback,
                                                void *user_data);
 
+/**
+ * cogl_atlas_texture_atlases_need_compaction: (skip)
+ * @ctx: A #CoglContext
+ * @max_waste: The fraction of unused space an atlas may have
+ *
+ * Checks whether any of the shared atlases grew beyond its initial size
+ * and has more than @max_waste of its space unused.
+ *
+ * Returns: %TRUE if cogl_atlas_texture_compact_atlases() would be useful
+ */
+COGL_EXPORT gboolean
+cogl_atlas_texture_atlases_need_compaction (CoglContext *ctx,
+                                            float        max_waste);
+
+/**
+ * cogl_atlas_texture_compact_atlases: (skip)
+ * @ctx: A #CoglContext
+ * @max_waste: The fraction of unused space an atlas may have
+ *
+ * Repacks the textures of the shared atlases that have more than
+ * @max_waste of their space unused into smaller atlas textures. This
+ * notifies the reorganize callbacks like growing an atlas does, so it is
+ * best done when idle.
+ */
+COGL_EXPORT void
+cogl_atlas_texture_compact_atlases (CoglContext *ctx,
+                                    float        max_waste);
+
+/**
+ * cogl_atlas_texture_get_atlases_size: (skip)
+ * @ctx: A #CoglContext
+ *
+ * Returns: the size in bytes of the textures of all shared atlases
+ */
+COGL_EXPORT size_t
+cogl_atlas_texture_get_atlases_size (CoglContext *ctx);
+
 G_END_DECLS
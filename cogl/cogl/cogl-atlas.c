@@ -488,9 +488,13 @@ cogl_atlas_reserve_space (CoglAtlas             *atlas,
         _cogl_atlas_get_next_size (&map_width, &map_height);
     }
   else
-    _cogl_atlas_get_initial_size (atlas->context,
-                                  atlas->texture_format,
-                                  &map_width, &map_height);
+    {
+      _cogl_atlas_get_initial_size (atlas->context,
+                                    atlas->texture_format,
+                                    &map_width, &map_height);
+      atlas->initial_width = map_width;
+      atlas->initial_height = map_height;
+    }
 
   new_map = _cogl_atlas_create_map (atlas->context,
                                     atlas->texture_format,
@@ -593,6 +597,128 @@ _cogl_atlas_remove (CoglAtlas          *atlas,
                     _cogl_rectangle_map_get_height (atlas->map)));
 };
 
+gboolean
+_cogl_atlas_needs_compaction (CoglAtlas *atlas,
+                              float      max_waste)
+{
+  unsigned int map_width, map_height;
+  unsigned int remaining_space;
+
+  if (atlas->map == NULL)
+    return FALSE;
+
+  map_width = _cogl_rectangle_map_get_width (atlas->map);
+  map_height = _cogl_rectangle_map_get_height (atlas->map);
+
+  /* Atlases are only ever doubled in size, so one that still has its
+     initial size can't get any smaller */
+  if (map_width * map_height <= atlas->initial_width * atlas->initial_height)
+    return FALSE;
+
+  remaining_space = _cogl_rectangle_map_get_remaining_space (atlas->map);
+
+  return remaining_space > max_waste * (map_width * map_height);
+}
+
+/* Returns the size in bytes of the atlas texture */
+size_t
+_cogl_atlas_get_size (CoglAtlas *atlas)
+{
+  if (atlas->map == NULL)
+    return 0;
+
+  return ((size_t) _cogl_rectangle_map_get_width (atlas->map) *
+          _cogl_rectangle_map_get_height (atlas->map) *
+          cogl_pixel_format_get_bytes_per_pixel (atlas->texture_format, 0));
+}
+
+/* Repacks the rectangles of the atlas into the smallest texture they fit
+   in. This is used to give back the space left behind by removed
+   rectangles, which reserving space alone never does since the atlas is
+   only reorganized when it runs out of space */
+gboolean
+_cogl_atlas_compact (CoglAtlas *atlas)
+{
+  CoglAtlasGetRectanglesData data;
+  CoglRectangleMap *new_map;
+  CoglTexture *new_tex;
+  unsigned int n_rectangles;
+
+  if (atlas->map == NULL)
+    return FALSE;
+
+  n_rectangles = _cogl_rectangle_map_get_n_rectangles (atlas->map);
+  if (n_rectangles == 0)
+    return FALSE;
+
+  data.n_textures = 0;
+  data.textures = g_new (CoglAtlasRepositionData, n_rectangles);
+  _cogl_rectangle_map_foreach (atlas->map,
+                               _cogl_atlas_get_rectangles_cb,
+                               &data);
+
+  qsort (data.textures, data.n_textures,
+         sizeof (CoglAtlasRepositionData),
+         _cogl_atlas_compare_size_cb);
+
+  new_map = _cogl_atlas_create_map (atlas->context,
+                                    atlas->texture_format,
+                                    atlas->initial_width,
+                                    atlas->initial_height,
+                                    data.n_textures, data.textures);
+
+  if (new_map == NULL ||
+      (_cogl_rectangle_map_get_width (new_map) *
+       _cogl_rectangle_map_get_height (new_map) >=
+       _cogl_rectangle_map_get_width (atlas->map) *
+       _cogl_rectangle_map_get_height (atlas->map)))
+    {
+      COGL_NOTE (ATLAS, "%p: Compacting the atlas wouldn't save space",
+                 atlas);
+      g_clear_pointer (&new_map, _cogl_rectangle_map_free);
+      g_free (data.textures);
+      return FALSE;
+    }
+
+  new_tex = _cogl_atlas_create_texture (atlas,
+                                        _cogl_rectangle_map_get_width (new_map),
+                                        _cogl_rectangle_map_get_height (new_map));
+  if (new_tex == NULL)
+    {
+      COGL_NOTE (ATLAS, "%p: Could not create a CoglTexture2D", atlas);
+      _cogl_rectangle_map_free (new_map);
+      g_free (data.textures);
+      return FALSE;
+    }
+
+  COGL_NOTE (ATLAS, "%p: Atlas compacted from %ix%i to %ix%i",
+             atlas,
+             _cogl_rectangle_map_get_width (atlas->map),
+             _cogl_rectangle_map_get_height (atlas->map),
+             _cogl_rectangle_map_get_width (new_map),
+             _cogl_rectangle_map_get_height (new_map));
+
+  _cogl_atlas_notify_pre_reorganize (atlas);
+
+  _cogl_atlas_migrate (atlas,
+                       data.n_textures,
+                       data.textures,
+                       atlas->texture,
+                       new_tex,
+                       NULL);
+  _cogl_rectangle_map_free (atlas->map);
+  g_object_unref (atlas->texture);
+
+  atlas->map = new_map;
+  atlas->texture = new_tex;
+
+  g_free (data.textures);
+
+  _cogl_atlas_notify_post_reorganize (atlas);
+
+  return TRUE;
+}
+
 static CoglTexture *
 create_migration_texture (CoglContext *ctx,
                           int width,
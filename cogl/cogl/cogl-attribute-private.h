@@ -68,6 +68,9 @@ struct _CoglAttribute
   size_t offset;
   int n_components;
   CoglAttributeType type;
+  /* When non-zero the attribute advances once per this many
+   * instances instead of once per vertex */
+  unsigned int instance_divisor;
 };
 
 typedef enum
@@ -113,3 +116,7 @@ _cogl_flush_attributes_state (CoglFramebuffer *framebuffer,
 
 int
 _cogl_attribute_get_n_components (CoglAttribute *attribute);
+
+void
+_cogl_attribute_set_instance_divisor (CoglAttribute *attribute,
+                                      unsigned int   divisor);
@@ -383,3 +383,12 @@ _cogl_attribute_get_n_components (CoglAttribute *attribute)
 {
   return attribute->n_components;
 }
+
+/* Only honoured when the driver has
+ * COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS */
+void
+_cogl_attribute_set_instance_divisor (CoglAttribute *attribute,
+                                      unsigned int   divisor)
+{
+  attribute->instance_divisor = divisor;
+}
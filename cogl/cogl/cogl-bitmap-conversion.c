@@ -34,6 +34,7 @@
 #include "cogl/cogl-private.h"
 #include "cogl/cogl-bitmap-private.h"
 #include "cogl/cogl-context-private.h"
+#include "cogl/cogl-cpu-caps.h"
 #include "cogl/cogl-texture-private.h"
 #include "cogl/cogl-half-float.h"
 
@@ -261,133 +262,560 @@ _cogl_premult_alpha_first (uint8_t *dst)
 
 #undef MULT
 
-/* Use the SSE optimized version to premult four pixels at once when
-   it is available. The same assembler code works for x86 and x86-64
-   because it doesn't refer to any non-SSE registers directly */
+/* SIMD versions of the 8-bit (un)premultiplication and swizzling
+ * kernels. SSE2 is part of the x86-64 baseline so it can be used
+ * unconditionally when the compiler targets it. SSSE3 and AVX2 are
+ * only used when cogl_init_cpu_caps() found them at runtime. */
 #if defined(__SSE2__) && defined(__GNUC__) \
   && (defined(__x86_64) || defined(__i386))
-#define COGL_USE_PREMULT_SSE2
+#define COGL_USE_SSE2
+#include <emmintrin.h>
 #endif
 
-#ifdef COGL_USE_PREMULT_SSE2
+#if defined(__x86_64) && defined(__GNUC__)
+#define COGL_USE_X86_RUNTIME_SIMD
+#include <immintrin.h>
+#endif
 
-inline static void
-_cogl_premult_alpha_last_four_pixels_sse2 (uint8_t *p)
-{
-  /* 8 copies of 128 used below */
-  static const int16_t eight_halves[8] __attribute__ ((aligned (16))) =
-    { 128, 128, 128, 128, 128, 128, 128, 128 };
-  /* Mask of the rgb components of the four pixels */
-  static const int8_t just_rgb[16] __attribute__ ((aligned (16))) =
-    { 0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00,
-      0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00 };
-  /* Each SSE register only holds two pixels because we need to work
-     with 16-bit intermediate values. We still do four pixels by
-     interleaving two registers in the hope that it will pipeline
-     better */
-  asm (/* Load eight_halves into xmm5 for later */
-       "movdqa (%1), %%xmm5\n"
-       /* Clear xmm3 */
-       "pxor %%xmm3, %%xmm3\n"
-       /* Load two pixels from p into the low half of xmm0 */
-       "movlps (%0), %%xmm0\n"
-       /* Load the next set of two pixels from p into the low half of xmm1 */
-       "movlps 8(%0), %%xmm1\n"
-       /* Unpack 8 bytes from the low quad-words in each register to 8
-          16-bit values */
-       "punpcklbw %%xmm3, %%xmm0\n"
-       "punpcklbw %%xmm3, %%xmm1\n"
-       /* Copy alpha values of the first pixel in xmm0 to all
-          components of the first pixel in xmm2 */
-       "pshuflw $255, %%xmm0, %%xmm2\n"
-       /* same for xmm1 and xmm3 */
-       "pshuflw $255, %%xmm1, %%xmm3\n"
-       /* The above also copies the second pixel directly so we now
-          want to replace the RGB components with copies of the alpha
-          components */
-       "pshufhw $255, %%xmm2, %%xmm2\n"
-       "pshufhw $255, %%xmm3, %%xmm3\n"
-       /* Multiply the rgb components by the alpha */
-       "pmullw %%xmm2, %%xmm0\n"
-       "pmullw %%xmm3, %%xmm1\n"
-       /* Add 128 to each component */
-       "paddw %%xmm5, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Copy the results to temporary registers xmm4 and xmm5 */
-       "movdqa %%xmm0, %%xmm4\n"
-       "movdqa %%xmm1, %%xmm5\n"
-       /* Divide the results by 256 */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Add the temporaries back in */
-       "paddw %%xmm4, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Divide again */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Pack the results back as bytes */
-       "packuswb %%xmm1, %%xmm0\n"
-       /* Load just_rgb into xmm3 for later */
-       "movdqa (%2), %%xmm3\n"
-       /* Reload all four pixels into xmm2 */
-       "movups (%0), %%xmm2\n"
-       /* Mask out the alpha from the results */
-       "andps %%xmm3, %%xmm0\n"
-       /* Mask out the RGB from the original four pixels */
-       "andnps %%xmm2, %%xmm3\n"
-       /* Combine the two to get the right alpha values */
-       "orps %%xmm3, %%xmm0\n"
-       /* Write to memory */
-       "movdqu %%xmm0, (%0)\n"
-       : /* no outputs */
-       : "r" (p), "r" (eight_halves), "r" (just_rgb)
-       : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5");
-}
-
-#endif /* COGL_USE_PREMULT_SSE2 */
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define COGL_USE_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef COGL_USE_SSE2
+
+/* Each SSE register only holds two pixels when working with the 16-bit
+ * intermediate values, so four pixels are handled by processing two
+ * registers. This is the same rounding as MULT() above. */
+static inline __m128i
+_cogl_premult_two_pixels_sse2 (__m128i  pixels,
+                               gboolean alpha_first)
+{
+  __m128i alpha;
+  __m128i t;
+
+  if (alpha_first)
+    {
+      alpha = _mm_shufflelo_epi16 (pixels, 0x00);
+      alpha = _mm_shufflehi_epi16 (alpha, 0x00);
+    }
+  else
+    {
+      alpha = _mm_shufflelo_epi16 (pixels, 0xff);
+      alpha = _mm_shufflehi_epi16 (alpha, 0xff);
+    }
+
+  t = _mm_add_epi16 (_mm_mullo_epi16 (pixels, alpha), _mm_set1_epi16 (128));
+
+  return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+}
+
+static inline void
+_cogl_premult_four_pixels_sse2 (uint8_t  *p,
+                                gboolean  alpha_first)
+{
+  __m128i zero = _mm_setzero_si128 ();
+  __m128i alpha_mask = _mm_set1_epi32 (alpha_first ? 0x000000ff : 0xff000000);
+  __m128i pixels;
+  __m128i lo, hi;
+  __m128i result;
+
+  pixels = _mm_loadu_si128 ((const __m128i *) p);
+
+  lo = _cogl_premult_two_pixels_sse2 (_mm_unpacklo_epi8 (pixels, zero),
+                                      alpha_first);
+  hi = _cogl_premult_two_pixels_sse2 (_mm_unpackhi_epi8 (pixels, zero),
+                                      alpha_first);
+  result = _mm_packus_epi16 (lo, hi);
+
+  /* Keep the original alpha values */
+  result = _mm_or_si128 (_mm_and_si128 (alpha_mask, pixels),
+                         _mm_andnot_si128 (alpha_mask, result));
+
+  _mm_storeu_si128 ((__m128i *) p, result);
+}
+
+static inline __m128i
+_cogl_unpremult_pixel_sse2 (__m128i  pixel,
+                            gboolean alpha_first)
+{
+  __m128 components = _mm_cvtepi32_ps (pixel);
+  __m128 alpha;
+  __m128 quotient;
+
+  if (alpha_first)
+    alpha = _mm_shuffle_ps (components, components, 0x00);
+  else
+    alpha = _mm_shuffle_ps (components, components, 0xff);
+
+  /* The operands are small integers so the correctly rounded division
+   * truncates to the same value as the integer division in
+   * _cogl_unpremult_alpha_last(). A zero alpha gives inf or NaN, which
+   * converts to 0x80000000 and thus masks to 0, the same result as
+   * _cogl_unpremult_alpha_0(). Masking with 0xff also matches the
+   * truncation of the scalar version for invalid, non-premultiplied
+   * input. */
+  quotient = _mm_div_ps (_mm_mul_ps (components, _mm_set1_ps (255.0f)),
+                         alpha);
+
+  return _mm_and_si128 (_mm_cvttps_epi32 (quotient), _mm_set1_epi32 (0xff));
+}
+
+static inline void
+_cogl_unpremult_four_pixels_sse2 (uint8_t  *p,
+                                  gboolean  alpha_first)
+{
+  __m128i zero = _mm_setzero_si128 ();
+  __m128i alpha_mask = _mm_set1_epi32 (alpha_first ? 0x000000ff : 0xff000000);
+  __m128i pixels;
+  __m128i lo, hi;
+  __m128i p0, p1, p2, p3;
+  __m128i result;
+
+  pixels = _mm_loadu_si128 ((const __m128i *) p);
+
+  lo = _mm_unpacklo_epi8 (pixels, zero);
+  hi = _mm_unpackhi_epi8 (pixels, zero);
+
+  p0 = _cogl_unpremult_pixel_sse2 (_mm_unpacklo_epi16 (lo, zero), alpha_first);
+  p1 = _cogl_unpremult_pixel_sse2 (_mm_unpackhi_epi16 (lo, zero), alpha_first);
+  p2 = _cogl_unpremult_pixel_sse2 (_mm_unpacklo_epi16 (hi, zero), alpha_first);
+  p3 = _cogl_unpremult_pixel_sse2 (_mm_unpackhi_epi16 (hi, zero), alpha_first);
+
+  result = _mm_packus_epi16 (_mm_packs_epi32 (p0, p1),
+                             _mm_packs_epi32 (p2, p3));
+
+  result = _mm_or_si128 (_mm_and_si128 (alpha_mask, pixels),
+                         _mm_andnot_si128 (alpha_mask, result));
+
+  _mm_storeu_si128 ((__m128i *) p, result);
+}
+
+#endif /* COGL_USE_SSE2 */
+
+#ifdef COGL_USE_X86_RUNTIME_SIMD
+
+__attribute__ ((target ("avx2")))
+static int
+_cogl_premult_span_avx2 (uint8_t  *data,
+                         int       width,
+                         gboolean  alpha_first)
+{
+  __m256i zero = _mm256_setzero_si256 ();
+  __m256i half = _mm256_set1_epi16 (128);
+  __m256i alpha_mask =
+    _mm256_set1_epi32 (alpha_first ? 0x000000ff : 0xff000000);
+  int n_pixels = 0;
+
+  while (width - n_pixels >= 8)
+    {
+      uint8_t *p = data + n_pixels * 4;
+      __m256i pixels = _mm256_loadu_si256 ((const __m256i *) p);
+      __m256i lo = _mm256_unpacklo_epi8 (pixels, zero);
+      __m256i hi = _mm256_unpackhi_epi8 (pixels, zero);
+      __m256i alpha_lo, alpha_hi;
+      __m256i t_lo, t_hi;
+      __m256i result;
+
+      if (alpha_first)
+        {
+          alpha_lo = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (lo, 0x00),
+                                             0x00);
+          alpha_hi = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (hi, 0x00),
+                                             0x00);
+        }
+      else
+        {
+          alpha_lo = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (lo, 0xff),
+                                             0xff);
+          alpha_hi = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (hi, 0xff),
+                                             0xff);
+        }
+
+      t_lo = _mm256_add_epi16 (_mm256_mullo_epi16 (lo, alpha_lo), half);
+      t_hi = _mm256_add_epi16 (_mm256_mullo_epi16 (hi, alpha_hi), half);
+      lo = _mm256_srli_epi16 (_mm256_add_epi16 (t_lo,
+                                                _mm256_srli_epi16 (t_lo, 8)),
+                              8);
+      hi = _mm256_srli_epi16 (_mm256_add_epi16 (t_hi,
+                                                _mm256_srli_epi16 (t_hi, 8)),
+                              8);
+
+      /* Unpacking and packing both work per 128-bit lane so the pixels
+       * end up back in their original order */
+      result = _mm256_packus_epi16 (lo, hi);
+      result = _mm256_blendv_epi8 (result, pixels, alpha_mask);
+
+      _mm256_storeu_si256 ((__m256i *) p, result);
+
+      n_pixels += 8;
+    }
+
+  return n_pixels;
+}
+
+__attribute__ ((target ("ssse3")))
+static int
+_cogl_swizzle_span_ssse3 (const uint8_t *src,
+                          uint8_t       *dst,
+                          int            width,
+                          const uint8_t *shuffle)
+{
+  __m128i control = _mm_loadu_si128 ((const __m128i *) shuffle);
+  int n_pixels = 0;
+
+  while (width - n_pixels >= 4)
+    {
+      __m128i pixels =
+        _mm_loadu_si128 ((const __m128i *) (src + n_pixels * 4));
+
+      _mm_storeu_si128 ((__m128i *) (dst + n_pixels * 4),
+                        _mm_shuffle_epi8 (pixels, control));
+
+      n_pixels += 4;
+    }
+
+  return n_pixels;
+}
+
+__attribute__ ((target ("avx2")))
+static int
+_cogl_swizzle_span_avx2 (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width,
+                         const uint8_t *shuffle)
+{
+  /* vpshufb shuffles within each 128-bit lane, so the same control
+   * works for both halves */
+  __m256i control =
+    _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) shuffle));
+  int n_pixels = 0;
+
+  while (width - n_pixels >= 8)
+    {
+      __m256i pixels =
+        _mm256_loadu_si256 ((const __m256i *) (src + n_pixels * 4));
+
+      _mm256_storeu_si256 ((__m256i *) (dst + n_pixels * 4),
+                           _mm256_shuffle_epi8 (pixels, control));
+
+      n_pixels += 8;
+    }
+
+  return n_pixels;
+}
+
+#endif /* COGL_USE_X86_RUNTIME_SIMD */
+
+#ifdef COGL_USE_NEON
+
+static int
+_cogl_premult_span_neon (uint8_t  *data,
+                         int       width,
+                         gboolean  alpha_first)
+{
+  int alpha_index = alpha_first ? 0 : 3;
+  int n_pixels = 0;
+
+  while (width - n_pixels >= 8)
+    {
+      uint8_t *p = data + n_pixels * 4;
+      uint8x8x4_t pixels = vld4_u8 (p);
+      uint8x8_t alpha = pixels.val[alpha_index];
+      int i;
+
+      for (i = 0; i < 4; i++)
+        {
+          uint16x8_t t;
+
+          if (i == alpha_index)
+            continue;
+
+          /* (t + ((t + 128) >> 8) + 128) >> 8, i.e. the same as MULT() */
+          t = vmull_u8 (pixels.val[i], alpha);
+          pixels.val[i] = vraddhn_u16 (t, vrshrq_n_u16 (t, 8));
+        }
+
+      vst4_u8 (p, pixels);
+
+      n_pixels += 8;
+    }
+
+  return n_pixels;
+}
+
+static inline uint8x8_t
+_cogl_unpremult_component_neon (uint8x8_t   component,
+                                float32x4_t alpha_lo,
+                                float32x4_t alpha_hi)
+{
+  uint16x8_t c16 = vmovl_u8 (component);
+  float32x4_t c_lo = vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (c16)));
+  float32x4_t c_hi = vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (c16)));
+  uint32x4_t q_lo, q_hi;
+
+  /* See _cogl_unpremult_pixel_sse2() for why this matches the integer
+   * division. The narrowing moves truncate like the scalar version. */
+  q_lo = vcvtq_u32_f32 (vdivq_f32 (vmulq_n_f32 (c_lo, 255.0f), alpha_lo));
+  q_hi = vcvtq_u32_f32 (vdivq_f32 (vmulq_n_f32 (c_hi, 255.0f), alpha_hi));
+
+  return vmovn_u16 (vcombine_u16 (vmovn_u32 (q_lo), vmovn_u32 (q_hi)));
+}
+
+static int
+_cogl_unpremult_span_neon (uint8_t  *data,
+                           int       width,
+                           gboolean  alpha_first)
+{
+  int alpha_index = alpha_first ? 0 : 3;
+  int n_pixels = 0;
+
+  while (width - n_pixels >= 8)
+    {
+      uint8_t *p = data + n_pixels * 4;
+      uint8x8x4_t pixels = vld4_u8 (p);
+      uint8x8_t alpha = pixels.val[alpha_index];
+      uint8x8_t zero_alpha = vceq_u8 (alpha, vdup_n_u8 (0));
+      uint16x8_t alpha16 = vmovl_u8 (alpha);
+      float32x4_t alpha_lo = vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (alpha16)));
+      float32x4_t alpha_hi = vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (alpha16)));
+      int i;
+
+      for (i = 0; i < 4; i++)
+        {
+          if (i == alpha_index)
+            continue;
+
+          pixels.val[i] = _cogl_unpremult_component_neon (pixels.val[i],
+                                                          alpha_lo,
+                                                          alpha_hi);
+          pixels.val[i] = vbic_u8 (pixels.val[i], zero_alpha);
+        }
+
+      vst4_u8 (p, pixels);
+
+      n_pixels += 8;
+    }
+
+  return n_pixels;
+}
+
+static int
+_cogl_swizzle_span_neon (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width,
+                         const uint8_t *shuffle)
+{
+  uint8x16_t control = vld1q_u8 (shuffle);
+  int n_pixels = 0;
+
+  while (width - n_pixels >= 4)
+    {
+      uint8x16_t pixels = vld1q_u8 (src + n_pixels * 4);
+
+      vst1q_u8 (dst + n_pixels * 4, vqtbl1q_u8 (pixels, control));
+
+      n_pixels += 4;
+    }
+
+  return n_pixels;
+}
+
+#endif /* COGL_USE_NEON */
 
 static void
-_cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
-                                      int width)
+_cogl_bitmap_premult_span_8888 (uint8_t  *data,
+                                int       width,
+                                gboolean  alpha_first)
 {
-#ifdef COGL_USE_PREMULT_SSE2
+  int n_pixels = 0;
+
+#ifdef COGL_USE_X86_RUNTIME_SIMD
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+    n_pixels = _cogl_premult_span_avx2 (data, width, alpha_first);
+#endif
 
-  /* Process 4 pixels at a time */
-  while (width >= 4)
+#ifdef COGL_USE_SSE2
+  while (width - n_pixels >= 4)
     {
-      _cogl_premult_alpha_last_four_pixels_sse2 (data);
-      data += 4 * 4;
-      width -= 4;
+      _cogl_premult_four_pixels_sse2 (data + n_pixels * 4, alpha_first);
+      n_pixels += 4;
     }
+#endif
 
-  /* If there are any pixels left we will fall through and
-     handle them below */
+#ifdef COGL_USE_NEON
+  n_pixels = _cogl_premult_span_neon (data, width, alpha_first);
+#endif
 
-#endif /* COGL_USE_PREMULT_SSE2 */
+  /* If there are any pixels left handle them one by one */
+  data += n_pixels * 4;
+  width -= n_pixels;
 
   while (width-- > 0)
     {
-      _cogl_premult_alpha_last (data);
+      if (alpha_first)
+        _cogl_premult_alpha_first (data);
+      else
+        _cogl_premult_alpha_last (data);
       data += 4;
     }
 }
 
 static void
-_cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
-                                        int width)
+_cogl_bitmap_unpremult_span_8888 (uint8_t  *data,
+                                  int       width,
+                                  gboolean  alpha_first)
 {
-  int x;
+  int n_pixels = 0;
+
+#ifdef COGL_USE_SSE2
+  while (width - n_pixels >= 4)
+    {
+      _cogl_unpremult_four_pixels_sse2 (data + n_pixels * 4, alpha_first);
+      n_pixels += 4;
+    }
+#endif
+
+#ifdef COGL_USE_NEON
+  n_pixels = _cogl_unpremult_span_neon (data, width, alpha_first);
+#endif
 
-  for (x = 0; x < width; x++)
+  data += n_pixels * 4;
+  width -= n_pixels;
+
+  while (width-- > 0)
     {
-      if (data[3] == 0)
+      if (data[alpha_first ? 0 : 3] == 0)
         _cogl_unpremult_alpha_0 (data);
+      else if (alpha_first)
+        _cogl_unpremult_alpha_first (data);
       else
         _cogl_unpremult_alpha_last (data);
       data += 4;
     }
 }
 
+static void
+_cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
+                                      int width)
+{
+  _cogl_bitmap_premult_span_8888 (data, width, FALSE);
+}
+
+static void
+_cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
+                                        int width)
+{
+  _cogl_bitmap_unpremult_span_8888 (data, width, FALSE);
+}
+
+/* Swizzling between the 32-bit formats with 8-bit components */
+
+static gboolean
+get_8888_component_offsets (CoglPixelFormat  format,
+                            int             *offsets)
+{
+  static const int rgba_offsets[] = { 0, 1, 2, 3 };
+  static const int bgra_offsets[] = { 2, 1, 0, 3 };
+  static const int argb_offsets[] = { 1, 2, 3, 0 };
+  static const int abgr_offsets[] = { 3, 2, 1, 0 };
+  const int *component_offsets;
+
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+    case COGL_PIXEL_FORMAT_RGBX_8888:
+      component_offsets = rgba_offsets;
+      break;
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+    case COGL_PIXEL_FORMAT_BGRX_8888:
+      component_offsets = bgra_offsets;
+      break;
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+    case COGL_PIXEL_FORMAT_XRGB_8888:
+      component_offsets = argb_offsets;
+      break;
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+    case COGL_PIXEL_FORMAT_XBGR_8888:
+      component_offsets = abgr_offsets;
+      break;
+    default:
+      return FALSE;
+    }
+
+  memcpy (offsets, component_offsets, sizeof (int) * 4);
+
+  return TRUE;
+}
+
+/* Fills @shuffle with a 16-byte pshufb style control mask that moves
+ * four pixels from @src_format to @dst_format. This only covers formats
+ * where the conversion is a pure byte reordering. */
+static gboolean
+_cogl_bitmap_get_8888_shuffle (CoglPixelFormat  src_format,
+                               CoglPixelFormat  dst_format,
+                               uint8_t         *shuffle)
+{
+  int src_offsets[4];
+  int dst_offsets[4];
+  int i;
+
+  if (!get_8888_component_offsets (src_format, src_offsets) ||
+      !get_8888_component_offsets (dst_format, dst_offsets))
+    return FALSE;
+
+  /* Converting from an X format to an alpha format needs to fill in
+   * the alpha so leave that to the generic path */
+  if (!(src_format & COGL_A_BIT) && (dst_format & COGL_A_BIT))
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
+    shuffle[dst_offsets[i]] = src_offsets[i];
+
+  for (i = 4; i < 16; i++)
+    shuffle[i] = (i & ~3) + shuffle[i & 3];
+
+  return TRUE;
+}
+
+static void
+_cogl_bitmap_swizzle_span_8888 (const uint8_t *src,
+                                uint8_t       *dst,
+                                int            width,
+                                const uint8_t *shuffle)
+{
+  int n_pixels = 0;
+
+#ifdef COGL_USE_X86_RUNTIME_SIMD
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+    n_pixels = _cogl_swizzle_span_avx2 (src, dst, width, shuffle);
+
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_SSSE3))
+    n_pixels += _cogl_swizzle_span_ssse3 (src + n_pixels * 4,
+                                          dst + n_pixels * 4,
+                                          width - n_pixels,
+                                          shuffle);
+#endif
+
+#ifdef COGL_USE_NEON
+  n_pixels = _cogl_swizzle_span_neon (src, dst, width, shuffle);
+#endif
+
+  src += n_pixels * 4;
+  dst += n_pixels * 4;
+  width -= n_pixels;
+
+  while (width-- > 0)
+    {
+      dst[0] = src[shuffle[0]];
+      dst[1] = src[shuffle[1]];
+      dst[2] = src[shuffle[2]];
+      dst[3] = src[shuffle[3]];
+      src += 4;
+      dst += 4;
+    }
+}
+
 static void
 _cogl_bitmap_unpremult_unpacked_span_16 (uint16_t *data,
                                          int width)
@@ -576,6 +1004,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
   CoglPixelFormat dst_format;
   MediumType medium_type;
   gboolean need_premult;
+  uint8_t shuffle[16];
 
   src_format = cogl_bitmap_get_format (src_bmp);
   src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
@@ -635,6 +1064,34 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       return FALSE;
     }
 
+  /* Conversions between the common 32-bit formats are just a byte
+     reordering so they don't need to go through an unpacked row */
+  if (_cogl_bitmap_get_8888_shuffle (src_format, dst_format, shuffle))
+    {
+      for (y = 0; y < height; y++)
+        {
+          src = src_data + y * src_rowstride;
+          dst = dst_data + y * dst_rowstride;
+
+          _cogl_bitmap_swizzle_span_8888 (src, dst, width, shuffle);
+
+          if (need_premult)
+            {
+              gboolean alpha_first = !!(dst_format & COGL_AFIRST_BIT);
+
+              if (dst_format & COGL_PREMULT_BIT)
+                _cogl_bitmap_premult_span_8888 (dst, width, alpha_first);
+              else
+                _cogl_bitmap_unpremult_span_8888 (dst, width, alpha_first);
+            }
+        }
+
+      _cogl_bitmap_unmap (src_bmp);
+      _cogl_bitmap_unmap (dst_bmp);
+
+      return TRUE;
+    }
+
   medium_type = determine_medium_size (dst_format);
 
   /* Allocate a buffer to hold a temporary RGBA row */
@@ -838,7 +1295,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -875,19 +1332,8 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
         }
       else
         {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  if (p[0] == 0)
-                    _cogl_unpremult_alpha_0 (p);
-                  else
-                    _cogl_unpremult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_unpremult_unpacked_span_8 (p, width);
+          _cogl_bitmap_unpremult_span_8888 (p, width,
+                                            !!(format & COGL_AFIRST_BIT));
         }
     }
 
@@ -906,7 +1352,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -942,16 +1388,8 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
         }
       else
         {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  _cogl_premult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_premult_unpacked_span_8 (p, width);
+          _cogl_bitmap_premult_span_8888 (p, width,
+                                          !!(format & COGL_AFIRST_BIT));
         }
     }
 
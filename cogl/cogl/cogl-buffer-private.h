@@ -84,15 +84,19 @@ _cogl_buffer_map (CoglBuffer *buffer,
                   GError **error);
 
 /* This is a wrapper around cogl_buffer_map_range for internal use
-   when we want to map the buffer for write only to replace the entire
-   contents. If the map fails then it will fallback to writing to a
-   temporary buffer. When _cogl_buffer_unmap_for_fill_or_fallback is
-   called the temporary buffer will be copied into the array. Note
-   that these calls share a global array so they can not be nested. */
+   when we want to map the buffer for write only to replace the
+   contents of the range. @hints should be either
+   COGL_BUFFER_MAP_HINT_DISCARD to replace the entire contents or
+   COGL_BUFFER_MAP_HINT_DISCARD_RANGE to only replace the given range.
+   If the map fails then it will fallback to writing to a temporary
+   buffer. When _cogl_buffer_unmap_for_fill_or_fallback is called the
+   temporary buffer will be copied into the array. Note that these
+   calls share a global array so they can not be nested. */
 void *
 _cogl_buffer_map_range_for_fill_or_fallback (CoglBuffer *buffer,
                                              size_t offset,
-                                             size_t size);
+                                             size_t size,
+                                             CoglBufferMapHint hints);
 
 void
 _cogl_buffer_unmap_for_fill_or_fallback (CoglBuffer *buffer);
@@ -160,6 +160,7 @@ cogl_buffer_set_property (GObject      *gobject,
             CoglDriverClass *driver_klass = COGL_DRIVER_GET_CLASS (buffer->context->driver);
 
             driver_klass->buffer_create (buffer->context->driver, buffer);
+            buffer->context->render_stats.n_buffer_allocations++;
 
             buffer->flags |= COGL_BUFFER_FLAG_BUFFER_OBJECT;
           }
@@ -332,7 +333,8 @@ cogl_buffer_unmap (CoglBuffer *buffer)
 void *
 _cogl_buffer_map_range_for_fill_or_fallback (CoglBuffer *buffer,
                                              size_t offset,
-                                             size_t size)
+                                             size_t size,
+                                             CoglBufferMapHint hints)
 {
   CoglContext *ctx = buffer->context;
   void *ret;
@@ -346,7 +348,7 @@ _cogl_buffer_map_range_for_fill_or_fallback (CoglBuffer *buffer,
                                offset,
                                size,
                                COGL_BUFFER_ACCESS_WRITE,
-                               COGL_BUFFER_MAP_HINT_DISCARD,
+                               hints,
                                &ignore_error);
 
   if (ret)
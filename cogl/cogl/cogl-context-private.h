@@ -38,6 +38,7 @@
 #include "cogl/cogl-matrix-stack.h"
 #include "cogl/cogl-pipeline-private.h"
 #include "cogl/cogl-buffer-private.h"
+#include "cogl/cogl-attribute-buffer.h"
 #include "cogl/cogl-bitmask.h"
 #include "cogl/cogl-atlas.h"
 #include "cogl/cogl-driver-private.h"
@@ -93,6 +94,9 @@ struct _CoglContext
   int n_attribute_names;
 
   CoglBitmask       enabled_custom_attributes;
+  /* The attribute locations that currently have a non-zero
+   * instance divisor */
+  CoglBitmask       instanced_custom_attributes;
 
   /* These are temporary bitmasks that are used when disabling
    * builtin and custom attribute arrays. They are here just
@@ -130,6 +134,24 @@ struct _CoglContext
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
 
+  /* Streaming vertex buffer shared by all journals. Each flush writes
+   * its vertices after the ones of the previous flush, and the whole
+   * buffer is only discarded once it wraps around */
+  CoglAttributeBuffer *journal_vbo;
+  size_t            journal_vbo_offset;
+
+  /* Streaming pixel buffer that texture uploads are staged in, handed
+   * out range by range in the same way as the journal vertex buffer */
+  CoglPixelBuffer  *upload_buffer;
+  size_t            upload_buffer_offset;
+
+  /* State used by the journal to draw batches as instances of a
+   * single quad when the driver supports it */
+  CoglAttributeBuffer *journal_quad_corners;
+  CoglSnippet      *journal_instance_globals_snippet;
+  CoglSnippet      *journal_instance_transform_snippet;
+  GHashTable       *journal_instance_tex_coord_snippets;
+
   /* Some simple caching, to minimize state changes... */
   CoglPipeline     *current_pipeline;
   unsigned long     current_pipeline_changes_since_flush;
@@ -146,6 +168,9 @@ struct _CoglContext
   float                 depth_range_far_cache;
 
   CoglBuffer       *current_buffer[COGL_BUFFER_BIND_TARGET_COUNT];
+  /* The GL buffer object names currently bound to each target, which
+   * may stay bound after the CoglBuffer has been unbound */
+  GLuint            gl_buffer_binding_cache[COGL_BUFFER_BIND_TARGET_COUNT];
 
   /* Framebuffers */
   unsigned long     current_draw_buffer_state_flushed;
@@ -222,8 +247,16 @@ struct _CoglContext
   gboolean          buffer_map_fallback_in_use;
   size_t            buffer_map_fallback_offset;
 
+  /* Asynchronous reads of framebuffers still waiting for the GPU, oldest
+     first, and a small ring of pixel buffers they can read into */
+  GList            *pending_readbacks;
+  unsigned int      readback_poll_id;
+  GQueue            readback_buffers;
+
   CoglSamplerCache *sampler_cache;
 
+  CoglRenderStats   render_stats;
+
   unsigned long winsys_features
     [COGL_FLAGS_N_LONGS_FOR_SIZE (COGL_WINSYS_FEATURE_N_FEATURES)];
   void *winsys;
@@ -287,3 +320,14 @@ _cogl_context_set_current_modelview_entry (CoglContext *context,
 
 void
 _cogl_context_update_sync (CoglContext *context);
+
+CoglFence *
+_cogl_context_create_fence (CoglContext *context);
+
+gboolean
+_cogl_context_is_fence_signaled (CoglContext *context,
+                                 CoglFence   *fence);
+
+void
+_cogl_context_free_fence (CoglContext *context,
+                          CoglFence   *fence);
@@ -66,6 +66,9 @@ cogl_context_dispose (GObject *object)
   CoglContext *context = COGL_CONTEXT (object);
   const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
 
+  _cogl_framebuffer_cancel_readbacks (context);
+  g_queue_clear_full (&context->readback_buffers, g_object_unref);
+
   winsys->context_deinit (context);
 
   if (context->default_gl_texture_2d_tex)
@@ -84,6 +87,13 @@ cogl_context_dispose (GObject *object)
     g_array_free (context->journal_flush_attributes_array, TRUE);
   if (context->journal_clip_bounds)
     g_array_free (context->journal_clip_bounds, TRUE);
+  g_clear_object (&context->journal_vbo);
+  g_clear_object (&context->upload_buffer);
+  g_clear_object (&context->journal_quad_corners);
+  g_clear_object (&context->journal_instance_globals_snippet);
+  g_clear_object (&context->journal_instance_transform_snippet);
+  g_clear_pointer (&context->journal_instance_tex_coord_snippets,
+                   g_hash_table_destroy);
 
   if (context->rectangle_byte_indices)
     g_object_unref (context->rectangle_byte_indices);
@@ -107,6 +117,7 @@ cogl_context_dispose (GObject *object)
   g_hook_list_clear (&context->atlas_reorganize_callbacks);
 
   _cogl_bitmask_destroy (&context->enabled_custom_attributes);
+  _cogl_bitmask_destroy (&context->instanced_custom_attributes);
   _cogl_bitmask_destroy (&context->enable_custom_attributes_tmp);
   _cogl_bitmask_destroy (&context->changed_bits_tmp);
 
@@ -294,12 +305,21 @@ cogl_context_new (CoglDisplay *display,
   context->journal_flush_attributes_array =
     g_array_new (TRUE, FALSE, sizeof (CoglAttribute *));
   context->journal_clip_bounds = NULL;
+  context->journal_vbo = NULL;
+  context->journal_vbo_offset = 0;
+  context->upload_buffer = NULL;
+  context->upload_buffer_offset = 0;
+  context->journal_quad_corners = NULL;
+  context->journal_instance_globals_snippet = NULL;
+  context->journal_instance_transform_snippet = NULL;
+  context->journal_instance_tex_coord_snippets = NULL;
 
   context->current_pipeline = NULL;
   context->current_pipeline_changes_since_flush = 0;
   context->current_pipeline_with_color_attrib = FALSE;
 
   _cogl_bitmask_init (&context->enabled_custom_attributes);
+  _cogl_bitmask_init (&context->instanced_custom_attributes);
   _cogl_bitmask_init (&context->enable_custom_attributes_tmp);
   _cogl_bitmask_init (&context->changed_bits_tmp);
 
@@ -321,7 +341,10 @@ cogl_context_new (CoglDisplay *display,
   context->pipeline_cache = _cogl_pipeline_cache_new (context);
 
   for (i = 0; i < COGL_BUFFER_BIND_TARGET_COUNT; i++)
-    context->current_buffer[i] = NULL;
+    {
+      context->current_buffer[i] = NULL;
+      context->gl_buffer_binding_cache[i] = 0;
+    }
 
   context->stencil_pipeline = cogl_pipeline_new (context);
   cogl_pipeline_set_static_name (context->stencil_pipeline,
@@ -358,6 +381,7 @@ cogl_context_new (CoglDisplay *display,
   g_hook_list_init (&context->atlas_reorganize_callbacks, sizeof (GHook));
 
   context->buffer_map_fallback_array = g_byte_array_new ();
+  g_queue_init (&context->readback_buffers);
   context->buffer_map_fallback_in_use = FALSE;
 
   context->named_pipelines =
@@ -437,6 +461,18 @@ cogl_context_get_latest_sync_fd (CoglContext *context)
   return winsys->get_sync_fd (context);
 }
 
+int
+cogl_context_create_sync_fd (CoglContext *context)
+{
+  if (!cogl_context_has_feature (context, COGL_FEATURE_ID_SYNC_FD))
+    return -1;
+
+  _cogl_context_update_sync (context);
+  context->glFlush ();
+
+  return cogl_context_get_latest_sync_fd (context);
+}
+
 CoglGraphicsResetStatus
 cogl_context_get_graphics_reset_status (CoglContext *context)
 {
@@ -529,6 +565,43 @@ cogl_context_get_gpu_time_ns (CoglContext *context)
   return driver_klass->get_gpu_time_ns (context->driver, context);
 }
 
+void
+cogl_context_get_render_stats (CoglContext     *context,
+                               CoglRenderStats *stats)
+{
+  *stats = context->render_stats;
+}
+
+CoglFence *
+_cogl_context_create_fence (CoglContext *context)
+{
+  CoglDriverClass *driver_klass = COGL_DRIVER_GET_CLASS (context->driver);
+
+  if (!cogl_context_has_feature (context, COGL_FEATURE_ID_FENCE) ||
+      !driver_klass->create_fence)
+    return NULL;
+
+  return driver_klass->create_fence (context->driver, context);
+}
+
+gboolean
+_cogl_context_is_fence_signaled (CoglContext *context,
+                                 CoglFence   *fence)
+{
+  CoglDriverClass *driver_klass = COGL_DRIVER_GET_CLASS (context->driver);
+
+  return driver_klass->is_fence_signaled (context->driver, context, fence);
+}
+
+void
+_cogl_context_free_fence (CoglContext *context,
+                          CoglFence   *fence)
+{
+  CoglDriverClass *driver_klass = COGL_DRIVER_GET_CLASS (context->driver);
+
+  driver_klass->free_fence (context->driver, context, fence);
+}
+
 /* FIXME: we should distinguish renderer and context features */
 gboolean
 cogl_context_has_winsys_feature (CoglContext       *context,
@@ -552,3 +625,15 @@ cogl_context_flush (CoglContext *context)
   for (l = context->framebuffers; l; l = l->next)
     _cogl_framebuffer_flush_journal (l->data);
 }
+
+unsigned int
+cogl_context_get_pipeline_cache_size (CoglContext *context)
+{
+  return _cogl_pipeline_cache_get_n_entries (context->pipeline_cache);
+}
+
+void
+cogl_context_trim_pipeline_cache (CoglContext *context)
+{
+  _cogl_pipeline_cache_prune_unused (context->pipeline_cache);
+}
@@ -325,6 +325,37 @@ cogl_context_timestamp_query_get_time_ns (CoglContext        *context,
 COGL_EXPORT int64_t
 cogl_context_get_gpu_time_ns (CoglContext *context);
 
+/**
+ * CoglRenderStats:
+ * @n_journal_flushes: Number of non-empty journal flushes
+ * @n_program_links: Number of GLSL programs linked, i.e. pipelines that
+ *   weren't found in the program cache
+ * @n_texture_allocations: Number of textures allocated
+ * @n_buffer_allocations: Number of buffer objects allocated
+ *
+ * Counts of rendering work done by a context since it was created. The
+ * counts only ever increase, so that the difference of two snapshots
+ * describes the work done in between.
+ */
+typedef struct _CoglRenderStats
+{
+  uint64_t n_journal_flushes;
+  uint64_t n_program_links;
+  uint64_t n_texture_allocations;
+  uint64_t n_buffer_allocations;
+} CoglRenderStats;
+
+/**
+ * cogl_context_get_render_stats:
+ * @context: a #CoglContext pointer
+ * @stats: (out): the render stats
+ *
+ * Retrieves the rendering work done by @context so far.
+ */
+COGL_EXPORT void
+cogl_context_get_render_stats (CoglContext     *context,
+                               CoglRenderStats *stats);
+
 /**
  * cogl_context_get_latest_sync_fd
  * @context: a #CoglContext pointer
@@ -339,6 +370,21 @@ cogl_context_get_gpu_time_ns (CoglContext *context);
 COGL_EXPORT int
 cogl_context_get_latest_sync_fd (CoglContext *context);
 
+/**
+ * cogl_context_create_sync_fd
+ * @context: a #CoglContext pointer
+ *
+ * Flushes all GPU commands submitted so far, and returns a sync fd
+ * which will signal once they have completed. Unlike
+ * cogl_context_get_latest_sync_fd() this also covers commands that
+ * were issued directly and not through a framebuffer.
+ *
+ * Return value: a sync fd owned by the caller, or -1 if
+ * %COGL_FEATURE_ID_SYNC_FD is not supported.
+ */
+COGL_EXPORT int
+cogl_context_create_sync_fd (CoglContext *context);
+
 COGL_EXPORT gboolean
 cogl_context_has_winsys_feature (CoglContext       *context,
                                  CoglWinsysFeature  feature);
@@ -375,6 +421,27 @@ cogl_context_flush (CoglContext *context);
  *
  * Returns: (transfer none): a #CoglIndices
  */
+/**
+ * cogl_context_get_pipeline_cache_size: (skip)
+ * @context: a #CoglContext
+ *
+ * Returns: the number of template pipelines Cogl keeps around to share
+ *   generated shader programs between pipelines
+ */
+COGL_EXPORT unsigned int
+cogl_context_get_pipeline_cache_size (CoglContext *context);
+
+/**
+ * cogl_context_trim_pipeline_cache: (skip)
+ * @context: a #CoglContext
+ *
+ * Drops the template pipelines, and with them the generated shader
+ * programs, that no pipeline currently uses. Pipelines created later
+ * with the same state have to generate and link their programs again.
+ */
+COGL_EXPORT void
+cogl_context_trim_pipeline_cache (CoglContext *context);
+
 COGL_EXPORT CoglIndices *
 cogl_context_get_rectangle_indices (CoglContext *context,
                                     int          n_rectangles);
@@ -70,7 +70,8 @@ cpuid (uint32_t  ax,
        "=b" (p[1]),
        "=c" (p[2]),
        "=d" (p[3])
-     : "0" (ax)
+     : "0" (ax),
+       "2" (0) /* sub-leaf, needed for leaf 7 */
    );
 #else
    p[0] = 0;
@@ -101,6 +102,19 @@ cogl_init_cpu_caps (void)
                  ((xgetbv () & 6) == 6));   /* XMM & YMM */
       if (((regs2[2] >> 29) & 1) && has_avx)
         cogl_cpu_caps |= COGL_CPU_CAP_F16C;
+
+      if ((regs2[2] >> 9) & 1)
+        cogl_cpu_caps |= COGL_CPU_CAP_SSSE3;
+
+      if (regs[0] >= 0x00000007)
+        {
+          uint32_t regs7[4];
+
+          cpuid (0x00000007, regs7);
+
+          if (((regs7[1] >> 5) & 1) && has_avx)
+            cogl_cpu_caps |= COGL_CPU_CAP_AVX2;
+        }
     }
 #endif
 }
@@ -190,3 +190,9 @@ OPT (STENCILLING,
      N_("Stencil every clip entry"),
      N_("Disables optimizations that usually avoid stencilling when it's not "
         "needed. This exercises more of the stencilling logic than usual."))
+OPT (DISABLE_JOURNAL_INSTANCING,
+     N_("Root Cause"),
+     "disable-journal-instancing",
+     N_("Disable instanced journal rendering"),
+     N_("Always expand batched rectangles to four vertices each instead "
+        "of drawing them as instances of a single quad."))
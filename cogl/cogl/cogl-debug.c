@@ -83,6 +83,7 @@ static const GDebugKey cogl_behavioural_debug_keys[] = {
   { "sync-primitive", COGL_DEBUG_SYNC_PRIMITIVE },
   { "sync-frame", COGL_DEBUG_SYNC_FRAME},
   { "stencilling", COGL_DEBUG_STENCILLING },
+  { "disable-journal-instancing", COGL_DEBUG_DISABLE_JOURNAL_INSTANCING },
 };
 static const int n_cogl_behavioural_debug_keys =
   G_N_ELEMENTS (cogl_behavioural_debug_keys);
@@ -74,6 +74,7 @@ typedef enum
   COGL_DEBUG_SYNC_FRAME,
   COGL_DEBUG_TEXTURES,
   COGL_DEBUG_STENCILLING,
+  COGL_DEBUG_DISABLE_JOURNAL_INSTANCING,
 
   COGL_DEBUG_N_FLAGS
 } CoglDebugFlags;
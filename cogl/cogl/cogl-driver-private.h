@@ -37,6 +37,8 @@
 #include "cogl/cogl-sampler-cache-private.h"
 #include "cogl/cogl-texture-private.h"
 
+typedef struct _CoglFence CoglFence;
+
 G_DECLARE_DERIVABLE_TYPE (CoglDriver,
                           cogl_driver,
                           COGL,
@@ -151,6 +153,21 @@ struct _CoglDriverClass
 
   int64_t (* get_gpu_time_ns) (CoglDriver  *driver,
                                CoglContext *context);
+
+  /* Inserts a fence after the commands submitted so far, or returns NULL
+   * if fences aren't supported.
+   */
+  CoglFence * (* create_fence) (CoglDriver  *driver,
+                                CoglContext *context);
+
+  /* Checks whether a fence is signaled, without waiting for it */
+  gboolean (* is_fence_signaled) (CoglDriver  *driver,
+                                  CoglContext *context,
+                                  CoglFence   *fence);
+
+  void (* free_fence) (CoglDriver  *driver,
+                       CoglContext *context,
+                       CoglFence   *fence);
 };
 
 #define COGL_TYPE_DRIVER (cogl_driver_get_type ())
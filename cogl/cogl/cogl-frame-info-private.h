@@ -55,8 +55,26 @@ typedef enum _CoglFrameInfoFlag
    * happen.
    */
   COGL_FRAME_INFO_FLAG_VSYNC = 1 << 3,
+  /*
+   * The presentation was done with an asynchronous page flip, i.e. as soon
+   * as possible instead of at the next "vertical retrace", possibly tearing.
+   */
+  COGL_FRAME_INFO_FLAG_ASYNC = 1 << 4,
 } CoglFrameInfoFlag;
 
+/*
+ * A named part of a frame as seen by the GPU. The phase starts when the GPU
+ * reaches the timestamp query, and ends where the next phase starts, or, for
+ * the last phase, when the frame finished rendering.
+ */
+typedef struct _CoglFrameInfoGpuPhase
+{
+  const char *name;
+  CoglTimestampQuery *query;
+  int64_t start_time_ns;
+  int64_t duration_ns;
+} CoglFrameInfoGpuPhase;
+
 struct _CoglFrameInfo
 {
   GObject parent_instance;
@@ -78,6 +96,9 @@ struct _CoglFrameInfo
   int64_t gpu_time_before_buffer_swap_ns;
   int64_t cpu_time_before_buffer_swap_us;
 
+  GArray *gpu_phases;
+  gboolean gpu_phases_resolved;
+
   gboolean has_target_presentation_time;
   int64_t target_presentation_time_us;
 };
@@ -86,6 +107,9 @@ COGL_EXPORT
 CoglFrameInfo *cogl_frame_info_new (CoglContext *context,
                                     int64_t      global_frame_counter);
 
+void _cogl_frame_info_clear_gpu_phases (CoglContext *context,
+                                        GArray      *gpu_phases);
+
 COGL_EXPORT
 void cogl_frame_info_set_target_presentation_time (CoglFrameInfo *info,
                                                    int64_t        presentation_time_us);
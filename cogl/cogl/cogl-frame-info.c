@@ -32,6 +32,7 @@
 
 #include "cogl/cogl-frame-info-private.h"
 #include "cogl/cogl-context-private.h"
+#include "cogl/cogl-trace.h"
 
 G_DEFINE_FINAL_TYPE (CoglFrameInfo, cogl_frame_info, G_TYPE_OBJECT);
 
@@ -43,6 +44,12 @@ cogl_frame_info_dispose (GObject *object)
   if (info->timestamp_query)
     cogl_context_free_timestamp_query (info->context, info->timestamp_query);
 
+  if (info->gpu_phases)
+    {
+      _cogl_frame_info_clear_gpu_phases (info->context, info->gpu_phases);
+      g_clear_pointer (&info->gpu_phases, g_array_unref);
+    }
+
   G_OBJECT_CLASS (cogl_frame_info_parent_class)->dispose (object);
 }
 
@@ -124,6 +131,12 @@ cogl_frame_info_is_vsync (CoglFrameInfo *info)
   return !!(info->flags & COGL_FRAME_INFO_FLAG_VSYNC);
 }
 
+gboolean
+cogl_frame_info_is_async (CoglFrameInfo *info)
+{
+  return !!(info->flags & COGL_FRAME_INFO_FLAG_ASYNC);
+}
+
 unsigned int
 cogl_frame_info_get_sequence (CoglFrameInfo *info)
 {
@@ -167,3 +180,144 @@ cogl_frame_info_set_target_presentation_time (CoglFrameInfo *info,
   info->has_target_presentation_time = TRUE;
   info->target_presentation_time_us = presentation_time_us;
 }
+
+void
+_cogl_frame_info_clear_gpu_phases (CoglContext *context,
+                                   GArray      *gpu_phases)
+{
+  unsigned int i;
+
+  for (i = 0; i < gpu_phases->len; i++)
+    {
+      CoglFrameInfoGpuPhase *phase =
+        &g_array_index (gpu_phases, CoglFrameInfoGpuPhase, i);
+
+      if (phase->query)
+        cogl_context_free_timestamp_query (context, phase->query);
+      phase->query = NULL;
+    }
+
+  g_array_set_size (gpu_phases, 0);
+}
+
+#ifdef HAVE_PROFILER
+static void
+trace_gpu_phases (CoglFrameInfo *info)
+{
+  int64_t gpu_to_cpu_time_ns;
+  unsigned int i;
+
+  /* Map the GPU clock onto the monotonic clock using the pair of timestamps
+   * taken just before the buffer swap, so that the phases line up with the
+   * CPU side marks in the capture. */
+  if (info->gpu_time_before_buffer_swap_ns == 0 ||
+      info->cpu_time_before_buffer_swap_us == 0)
+    return;
+
+  gpu_to_cpu_time_ns = (info->cpu_time_before_buffer_swap_us * 1000 -
+                        info->gpu_time_before_buffer_swap_ns);
+
+  for (i = 0; i < info->gpu_phases->len; i++)
+    {
+      CoglFrameInfoGpuPhase *phase =
+        &g_array_index (info->gpu_phases, CoglFrameInfoGpuPhase, i);
+      g_autofree char *description = NULL;
+
+      if (phase->duration_ns < 0)
+        continue;
+
+      description = g_strdup_printf ("%s, frame %" G_GINT64_FORMAT,
+                                     phase->name,
+                                     info->global_frame_counter);
+      cogl_trace_mark_range ("Cogl::GPU::phase",
+                             description,
+                             phase->start_time_ns + gpu_to_cpu_time_ns,
+                             phase->duration_ns);
+    }
+}
+#endif
+
+static void
+resolve_gpu_phases (CoglFrameInfo *info)
+{
+  int64_t end_time_ns = -1;
+  unsigned int i;
+
+  if (info->gpu_phases_resolved)
+    return;
+
+  info->gpu_phases_resolved = TRUE;
+
+  if (!info->gpu_phases)
+    return;
+
+  for (i = 0; i < info->gpu_phases->len; i++)
+    {
+      CoglFrameInfoGpuPhase *phase =
+        &g_array_index (info->gpu_phases, CoglFrameInfoGpuPhase, i);
+
+      phase->start_time_ns =
+        cogl_context_timestamp_query_get_time_ns (info->context,
+                                                  phase->query);
+      phase->duration_ns = -1;
+    }
+
+  if (info->timestamp_query)
+    {
+      end_time_ns =
+        cogl_context_timestamp_query_get_time_ns (info->context,
+                                                  info->timestamp_query);
+    }
+
+  for (i = 0; i < info->gpu_phases->len; i++)
+    {
+      CoglFrameInfoGpuPhase *phase =
+        &g_array_index (info->gpu_phases, CoglFrameInfoGpuPhase, i);
+      int64_t phase_end_time_ns;
+
+      if (i + 1 < info->gpu_phases->len)
+        {
+          phase_end_time_ns =
+            g_array_index (info->gpu_phases, CoglFrameInfoGpuPhase,
+                           i + 1).start_time_ns;
+        }
+      else
+        {
+          phase_end_time_ns = end_time_ns;
+        }
+
+      if (phase_end_time_ns >= phase->start_time_ns)
+        phase->duration_ns = phase_end_time_ns - phase->start_time_ns;
+    }
+
+#ifdef HAVE_PROFILER
+  if (G_UNLIKELY (cogl_is_tracing_enabled ()))
+    trace_gpu_phases (info);
+#endif
+}
+
+unsigned int
+cogl_frame_info_get_n_gpu_phases (CoglFrameInfo *info)
+{
+  return info->gpu_phases ? info->gpu_phases->len : 0;
+}
+
+gboolean
+cogl_frame_info_get_gpu_phase (CoglFrameInfo  *info,
+                               unsigned int    index,
+                               const char    **name,
+                               int64_t        *duration_ns)
+{
+  CoglFrameInfoGpuPhase *phase;
+
+  g_return_val_if_fail (index < cogl_frame_info_get_n_gpu_phases (info),
+                        FALSE);
+
+  resolve_gpu_phases (info);
+
+  phase = &g_array_index (info->gpu_phases, CoglFrameInfoGpuPhase, index);
+  *name = phase->name;
+  *duration_ns = MAX (phase->duration_ns, 0);
+
+  return phase->duration_ns >= 0;
+}
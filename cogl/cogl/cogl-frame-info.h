@@ -121,6 +121,9 @@ gboolean cogl_frame_info_is_zero_copy (CoglFrameInfo *info);
 COGL_EXPORT
 gboolean cogl_frame_info_is_vsync (CoglFrameInfo *info);
 
+COGL_EXPORT
+gboolean cogl_frame_info_is_async (CoglFrameInfo *info);
+
 COGL_EXPORT
 unsigned int cogl_frame_info_get_sequence (CoglFrameInfo *info);
 
@@ -133,4 +136,35 @@ int64_t cogl_frame_info_get_rendering_duration_ns (CoglFrameInfo *info);
 COGL_EXPORT
 int64_t cogl_frame_info_get_time_before_buffer_swap_us (CoglFrameInfo *info);
 
+/**
+ * cogl_frame_info_get_n_gpu_phases:
+ * @info: a #CoglFrameInfo object
+ *
+ * Gets the number of GPU phases started with cogl_onscreen_begin_gpu_phase()
+ * while the frame was rendered.
+ *
+ * Return value: the number of GPU phases of the frame
+ */
+COGL_EXPORT
+unsigned int cogl_frame_info_get_n_gpu_phases (CoglFrameInfo *info);
+
+/**
+ * cogl_frame_info_get_gpu_phase:
+ * @info: a #CoglFrameInfo object
+ * @index: the index of the phase
+ * @name: (out): return location for the name of the phase
+ * @duration_ns: (out): return location for the GPU time spent in the phase
+ *
+ * Gets the GPU time spent in one of the phases of the frame. This must only
+ * be called once the frame completed, as it waits for the timestamp queries
+ * of the frame to be available.
+ *
+ * Return value: %TRUE if the duration of the phase is known
+ */
+COGL_EXPORT
+gboolean cogl_frame_info_get_gpu_phase (CoglFrameInfo  *info,
+                                        unsigned int    index,
+                                        const char    **name,
+                                        int64_t        *duration_ns);
+
 G_END_DECLS
@@ -146,6 +146,31 @@ cogl_framebuffer_driver_draw_indexed_attributes (CoglFramebufferDriver  *driver,
                                   flags);
 }
 
+void
+cogl_framebuffer_driver_draw_instanced_attributes (CoglFramebufferDriver  *driver,
+                                                   CoglPipeline           *pipeline,
+                                                   CoglVerticesMode        mode,
+                                                   int                     first_vertex,
+                                                   int                     n_vertices,
+                                                   int                     n_instances,
+                                                   CoglAttribute         **attributes,
+                                                   int                     n_attributes,
+                                                   CoglDrawFlags           flags)
+{
+  CoglFramebufferDriverClass *klass =
+    COGL_FRAMEBUFFER_DRIVER_GET_CLASS (driver);
+
+  klass->draw_instanced_attributes (driver,
+                                    pipeline,
+                                    mode,
+                                    first_vertex,
+                                    n_vertices,
+                                    n_instances,
+                                    attributes,
+                                    n_attributes,
+                                    flags);
+}
+
 gboolean
 cogl_framebuffer_driver_read_pixels_into_bitmap (CoglFramebufferDriver  *driver,
                                                  int                     x,
@@ -160,6 +185,16 @@ cogl_framebuffer_driver_read_pixels_into_bitmap (CoglFramebufferDriver  *driver,
   return klass->read_pixels_into_bitmap (driver, x, y, source, bitmap, error);
 }
 
+CoglPixelFormat
+cogl_framebuffer_driver_get_read_pixels_format (CoglFramebufferDriver *driver,
+                                                CoglPixelFormat        format)
+{
+  CoglFramebufferDriverClass *klass =
+    COGL_FRAMEBUFFER_DRIVER_GET_CLASS (driver);
+
+  return klass->get_read_pixels_format (driver, format);
+}
+
 static void
 cogl_framebuffer_driver_get_property (GObject    *object,
                                       guint       prop_id,
@@ -258,6 +293,19 @@ cogl_framebuffer_real_draw_indexed_attributes (CoglFramebufferDriver *driver,
 {
 }
 
+static void
+cogl_framebuffer_real_draw_instanced_attributes (CoglFramebufferDriver *driver,
+                                                 CoglPipeline          *pipeline,
+                                                 CoglVerticesMode       mode,
+                                                 int                    first_vertex,
+                                                 int                    n_vertices,
+                                                 int                    n_instances,
+                                                 CoglAttribute        **attributes,
+                                                 int                    n_attributes,
+                                                 CoglDrawFlags          flags)
+{
+}
+
 static gboolean
 cogl_framebuffer_real_read_pixels_into_bitmap (CoglFramebufferDriver  *framebuffer,
                                                int                     x,
@@ -269,6 +317,13 @@ cogl_framebuffer_real_read_pixels_into_bitmap (CoglFramebufferDriver  *framebuff
   return TRUE;
 }
 
+static CoglPixelFormat
+cogl_framebuffer_real_get_read_pixels_format (CoglFramebufferDriver *driver,
+                                              CoglPixelFormat        format)
+{
+  return format;
+}
+
 static void
 cogl_framebuffer_driver_init (CoglFramebufferDriver *driver)
 {
@@ -298,6 +353,10 @@ cogl_framebuffer_driver_class_init (CoglFramebufferDriverClass *klass)
   klass->draw_attributes = cogl_framebuffer_real_draw_attributes;
   klass->draw_indexed_attributes =
     cogl_framebuffer_real_draw_indexed_attributes;
+  klass->draw_instanced_attributes =
+    cogl_framebuffer_real_draw_instanced_attributes;
   klass->read_pixels_into_bitmap =
     cogl_framebuffer_real_read_pixels_into_bitmap;
+  klass->get_read_pixels_format =
+    cogl_framebuffer_real_get_read_pixels_format;
 }
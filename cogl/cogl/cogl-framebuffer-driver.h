@@ -86,12 +86,28 @@ struct _CoglFramebufferDriverClass
                                     int                     n_attributes,
                                     CoglDrawFlags           flags);
 
+  void (* draw_instanced_attributes) (CoglFramebufferDriver  *driver,
+                                      CoglPipeline           *pipeline,
+                                      CoglVerticesMode        mode,
+                                      int                     first_vertex,
+                                      int                     n_vertices,
+                                      int                     n_instances,
+                                      CoglAttribute         **attributes,
+                                      int                     n_attributes,
+                                      CoglDrawFlags           flags);
+
   gboolean (* read_pixels_into_bitmap) (CoglFramebufferDriver  *driver,
                                         int                     x,
                                         int                     y,
                                         CoglReadPixelsFlags     source,
                                         CoglBitmap             *bitmap,
                                         GError                **error);
+
+  /* Returns the format that pixels can be read in without any conversion
+   * on the CPU, which is needed to read into a pixel buffer asynchronously.
+   */
+  CoglPixelFormat (* get_read_pixels_format) (CoglFramebufferDriver *driver,
+                                              CoglPixelFormat        format);
 };
 
 CoglFramebuffer *
@@ -140,6 +156,17 @@ cogl_framebuffer_driver_draw_indexed_attributes (CoglFramebufferDriver  *driver,
                                                  int                     n_attributes,
                                                  CoglDrawFlags           flags);
 
+void
+cogl_framebuffer_driver_draw_instanced_attributes (CoglFramebufferDriver  *driver,
+                                                   CoglPipeline           *pipeline,
+                                                   CoglVerticesMode        mode,
+                                                   int                     first_vertex,
+                                                   int                     n_vertices,
+                                                   int                     n_instances,
+                                                   CoglAttribute         **attributes,
+                                                   int                     n_attributes,
+                                                   CoglDrawFlags           flags);
+
 gboolean
 cogl_framebuffer_driver_read_pixels_into_bitmap (CoglFramebufferDriver  *driver,
                                                  int                     x,
@@ -147,3 +174,7 @@ cogl_framebuffer_driver_read_pixels_into_bitmap (CoglFramebufferDriver  *driver,
                                                  CoglReadPixelsFlags     source,
                                                  CoglBitmap             *bitmap,
                                                  GError                **error);
+
+CoglPixelFormat
+cogl_framebuffer_driver_get_read_pixels_format (CoglFramebufferDriver *driver,
+                                                CoglPixelFormat        format);
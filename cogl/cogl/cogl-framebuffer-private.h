@@ -161,6 +161,9 @@ _cogl_framebuffer_flush_journal (CoglFramebuffer *framebuffer);
 void
 _cogl_framebuffer_flush_dependency_journals (CoglFramebuffer *framebuffer);
 
+void
+_cogl_framebuffer_cancel_readbacks (CoglContext *context);
+
 void
 cogl_context_flush_framebuffer_state (CoglContext          *context,
                                       CoglFramebuffer      *draw_buffer,
@@ -192,6 +195,17 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
                                            int n_attributes,
                                            CoglDrawFlags flags);
 
+void
+_cogl_framebuffer_draw_instanced_attributes (CoglFramebuffer *framebuffer,
+                                             CoglPipeline *pipeline,
+                                             CoglVerticesMode mode,
+                                             int first_vertex,
+                                             int n_vertices,
+                                             int n_instances,
+                                             CoglAttribute **attributes,
+                                             int n_attributes,
+                                             CoglDrawFlags flags);
+
 void
 cogl_framebuffer_set_viewport4fv (CoglFramebuffer *framebuffer,
                                   float *viewport);
@@ -33,6 +33,7 @@
 
 #include <string.h>
 
+#include "cogl/cogl-bitmap-private.h"
 #include "cogl/cogl-debug.h"
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-display-private.h"
@@ -44,6 +45,7 @@
 #include "cogl/cogl-journal-private.h"
 #include "cogl/cogl-pipeline-state-private.h"
 #include "cogl/cogl-offscreen.h"
+#include "cogl/cogl-pixel-buffer.h"
 #include "cogl/cogl-private.h"
 #include "cogl/cogl-primitives-private.h"
 #include "cogl/cogl-trace.h"
@@ -76,6 +78,23 @@ static guint signals[N_SIGNALS];
 static GQuark wire_pipeline_key = 0;
 #endif
 
+/* How many unused pixel buffers are kept around for asynchronous reads,
+ * and how often the pending reads are checked for completion */
+#define MAX_READBACK_BUFFERS 3
+#define READBACK_POLL_INTERVAL_MS 1
+
+typedef struct _CoglReadback
+{
+  CoglContext *context;
+
+  /* The pixels as read, either in a pixel buffer or in CPU memory */
+  CoglBitmap *bitmap;
+  CoglPixelBuffer *buffer;
+  gboolean needs_flip;
+
+  CoglFence *fence;
+} CoglReadback;
+
 typedef struct _CoglFramebufferPrivate
 {
   CoglContext *context;
@@ -1376,6 +1395,291 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
   return ret;
 }
 
+static CoglPixelBuffer *
+acquire_readback_buffer (CoglContext *context,
+                         size_t       size)
+{
+  GList *l;
+
+  for (l = context->readback_buffers.head; l; l = l->next)
+    {
+      CoglPixelBuffer *buffer = l->data;
+
+      if (cogl_buffer_get_size (COGL_BUFFER (buffer)) >= size)
+        {
+          g_queue_delete_link (&context->readback_buffers, l);
+          return buffer;
+        }
+    }
+
+  return cogl_pixel_buffer_new (context, size, NULL);
+}
+
+static void
+release_readback_buffer (CoglContext     *context,
+                         CoglPixelBuffer *buffer)
+{
+  g_queue_push_head (&context->readback_buffers, buffer);
+
+  while (g_queue_get_length (&context->readback_buffers) > MAX_READBACK_BUFFERS)
+    g_object_unref (g_queue_pop_tail (&context->readback_buffers));
+}
+
+static void
+cogl_readback_free (CoglReadback *readback)
+{
+  if (readback->fence)
+    _cogl_context_free_fence (readback->context, readback->fence);
+
+  g_clear_object (&readback->bitmap);
+
+  if (readback->buffer)
+    release_readback_buffer (readback->context, readback->buffer);
+
+  g_object_unref (readback->context);
+  g_free (readback);
+}
+
+static gboolean
+start_readback (CoglFramebuffer      *framebuffer,
+                CoglReadback         *readback,
+                int                   x,
+                int                   y,
+                int                   width,
+                int                   height,
+                CoglReadPixelsFlags   source,
+                CoglPixelFormat       format,
+                GError              **error)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+  CoglContext *context = priv->context;
+  CoglPixelFormat read_format;
+  int rowstride;
+
+  if (!cogl_framebuffer_allocate (framebuffer, error))
+    return FALSE;
+
+  if (!cogl_context_has_feature (context,
+                                 COGL_FEATURE_ID_MAP_BUFFER_FOR_READ))
+    {
+      readback->bitmap = _cogl_bitmap_new_with_malloc_buffer (context,
+                                                              width, height,
+                                                              format,
+                                                              error);
+      if (!readback->bitmap)
+        return FALSE;
+
+      return _cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                        x, y,
+                                                        source,
+                                                        readback->bitmap,
+                                                        error);
+    }
+
+  /* Reading into a pixel buffer only returns early if no conversion is
+   * needed, so the pixels are read exactly as the GPU provides them and
+   * converted and flipped when the read is finished instead */
+  read_format =
+    cogl_framebuffer_driver_get_read_pixels_format (priv->driver, format);
+  rowstride = width * cogl_pixel_format_get_bytes_per_pixel (read_format, 0);
+
+  readback->buffer = acquire_readback_buffer (context,
+                                              (size_t) rowstride * height);
+  readback->bitmap =
+    cogl_bitmap_new_from_buffer (COGL_BUFFER (readback->buffer),
+                                 read_format,
+                                 width, height,
+                                 rowstride,
+                                 0 /* offset */);
+  readback->needs_flip = ((source & COGL_READ_PIXELS_NO_FLIP) == 0 &&
+                          !cogl_framebuffer_is_y_flipped (framebuffer));
+
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  if (!cogl_framebuffer_driver_read_pixels_into_bitmap (priv->driver,
+                                                        x, y,
+                                                        source |
+                                                        COGL_READ_PIXELS_NO_FLIP,
+                                                        readback->bitmap,
+                                                        error))
+    return FALSE;
+
+  readback->fence = _cogl_context_create_fence (context);
+
+  return TRUE;
+}
+
+static gboolean
+poll_readbacks (gpointer user_data)
+{
+  CoglContext *context = user_data;
+
+  /* Reads complete in the order they were started */
+  while (context->pending_readbacks)
+    {
+      GTask *task = context->pending_readbacks->data;
+      CoglReadback *readback = g_task_get_task_data (task);
+
+      if (!g_task_return_error_if_cancelled (task))
+        {
+          if (readback->fence &&
+              !_cogl_context_is_fence_signaled (context, readback->fence))
+            return G_SOURCE_CONTINUE;
+
+          g_task_return_boolean (task, TRUE);
+        }
+
+      context->pending_readbacks =
+        g_list_delete_link (context->pending_readbacks,
+                            context->pending_readbacks);
+      g_object_unref (task);
+    }
+
+  context->readback_poll_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+void
+cogl_framebuffer_read_pixels_async (CoglFramebuffer     *framebuffer,
+                                    int                  x,
+                                    int                  y,
+                                    int                  width,
+                                    int                  height,
+                                    CoglReadPixelsFlags  source,
+                                    CoglPixelFormat      format,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+  CoglContext *context = priv->context;
+  g_autoptr (GTask) task = NULL;
+  GError *error = NULL;
+  CoglReadback *readback;
+
+  g_return_if_fail (COGL_IS_FRAMEBUFFER (framebuffer));
+  g_return_if_fail (source & COGL_READ_PIXELS_COLOR_BUFFER);
+  g_return_if_fail (cogl_pixel_format_get_n_planes (format) == 1);
+
+  task = g_task_new (framebuffer, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cogl_framebuffer_read_pixels_async);
+
+  readback = g_new0 (CoglReadback, 1);
+  readback->context = g_object_ref (context);
+  g_task_set_task_data (task, readback, (GDestroyNotify) cogl_readback_free);
+
+  if (!start_readback (framebuffer, readback,
+                       x, y, width, height,
+                       source, format,
+                       &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  context->pending_readbacks = g_list_append (context->pending_readbacks,
+                                              g_steal_pointer (&task));
+
+  if (!context->readback_poll_id)
+    {
+      context->readback_poll_id = g_timeout_add (READBACK_POLL_INTERVAL_MS,
+                                                 poll_readbacks,
+                                                 context);
+    }
+}
+
+static gboolean
+flip_bitmap (CoglBitmap  *bitmap,
+             GError     **error)
+{
+  int height = cogl_bitmap_get_height (bitmap);
+  int rowstride = cogl_bitmap_get_rowstride (bitmap);
+  g_autofree uint8_t *temprow = NULL;
+  uint8_t *pixels;
+  int y;
+
+  pixels = _cogl_bitmap_map (bitmap,
+                             COGL_BUFFER_ACCESS_READ |
+                             COGL_BUFFER_ACCESS_WRITE,
+                             0, /* hints */
+                             error);
+  if (!pixels)
+    return FALSE;
+
+  temprow = g_malloc (rowstride);
+
+  for (y = 0; y < height / 2; y++)
+    {
+      uint8_t *row = pixels + y * rowstride;
+      uint8_t *mirrored_row = pixels + (height - y - 1) * rowstride;
+
+      memcpy (temprow, row, rowstride);
+      memcpy (row, mirrored_row, rowstride);
+      memcpy (mirrored_row, temprow, rowstride);
+    }
+
+  _cogl_bitmap_unmap (bitmap);
+
+  return TRUE;
+}
+
+gboolean
+cogl_framebuffer_read_pixels_finish (CoglFramebuffer  *framebuffer,
+                                     GAsyncResult     *result,
+                                     CoglBitmap       *bitmap,
+                                     GError          **error)
+{
+  CoglReadback *readback;
+
+  g_return_val_if_fail (g_task_is_valid (result, framebuffer), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                        cogl_framebuffer_read_pixels_async, FALSE);
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return FALSE;
+
+  readback = g_task_get_task_data (G_TASK (result));
+
+  if (!_cogl_bitmap_convert_into_bitmap (readback->bitmap, bitmap, error))
+    return FALSE;
+
+  if (readback->needs_flip)
+    return flip_bitmap (bitmap, error);
+
+  return TRUE;
+}
+
+void
+_cogl_framebuffer_cancel_readbacks (CoglContext *context)
+{
+  GList *l;
+
+  g_clear_handle_id (&context->readback_poll_id, g_source_remove);
+
+  for (l = context->pending_readbacks; l; l = l->next)
+    {
+      GTask *task = l->data;
+      CoglReadback *readback = g_task_get_task_data (task);
+
+      /* The GPU resources go away with the context */
+      if (readback->fence)
+        {
+          _cogl_context_free_fence (context, readback->fence);
+          readback->fence = NULL;
+        }
+      g_clear_object (&readback->bitmap);
+      g_clear_object (&readback->buffer);
+
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                               "The context was destroyed");
+      g_object_unref (task);
+    }
+
+  g_clear_pointer (&context->pending_readbacks, g_list_free);
+}
+
 gboolean
 cogl_framebuffer_is_y_flipped (CoglFramebuffer *framebuffer)
 {
@@ -1493,6 +1797,9 @@ cogl_framebuffer_discard_buffers (CoglFramebuffer *framebuffer,
   CoglFramebufferPrivate *priv =
     cogl_framebuffer_get_instance_private (framebuffer);
 
+  /* Drawing still batched in the journal may need the buffers */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
   cogl_framebuffer_driver_discard_buffers (priv->driver, buffers);
 }
 
@@ -2204,6 +2511,34 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
     }
 }
 
+/* This is only used by the CoglJournal, which never uses it when the
+ * wireframe debug option is enabled, so unlike the functions above
+ * there is no wireframe path here. */
+void
+_cogl_framebuffer_draw_instanced_attributes (CoglFramebuffer *framebuffer,
+                                             CoglPipeline *pipeline,
+                                             CoglVerticesMode mode,
+                                             int first_vertex,
+                                             int n_vertices,
+                                             int n_instances,
+                                             CoglAttribute **attributes,
+                                             int n_attributes,
+                                             CoglDrawFlags flags)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+
+  cogl_framebuffer_driver_draw_instanced_attributes (priv->driver,
+                                                     pipeline,
+                                                     mode,
+                                                     first_vertex,
+                                                     n_vertices,
+                                                     n_instances,
+                                                     attributes,
+                                                     n_attributes,
+                                                     flags);
+}
+
 void
 cogl_framebuffer_draw_rectangle (CoglFramebuffer *framebuffer,
                                  CoglPipeline *pipeline,
@@ -40,6 +40,7 @@
 #include "cogl/cogl-texture.h"
 #include "mtk/mtk.h"
 
+#include <gio/gio.h>
 #include <glib-object.h>
 
 #include <graphene.h>
@@ -1018,6 +1019,58 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
                               CoglPixelFormat format,
                               uint8_t *pixels);
 
+/**
+ * cogl_framebuffer_read_pixels_async:
+ * @framebuffer: A #CoglFramebuffer
+ * @x: The x position to read from
+ * @y: The y position to read from
+ * @width: The width of the region of rectangles to read
+ * @height: The height of the region of rectangles to read
+ * @source: Identifies which auxiliary buffer you want to read
+ *          (only COGL_READ_PIXELS_COLOR_BUFFER supported currently)
+ * @format: The pixel format the pixels will be stored in
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: The callback to call once the pixels have been read
+ * @user_data: The data to pass to @callback
+ *
+ * Starts reading a rectangle of pixels like
+ * cogl_framebuffer_read_pixels_into_bitmap(), but without waiting for the
+ * GPU to finish the rendering of @framebuffer. The pixels are read into a
+ * pixel buffer when the driver supports it, and @callback is called on a
+ * later main loop iteration once they are available, at which point
+ * cogl_framebuffer_read_pixels_finish() must be called to retrieve them.
+ */
+COGL_EXPORT void
+cogl_framebuffer_read_pixels_async (CoglFramebuffer     *framebuffer,
+                                    int                  x,
+                                    int                  y,
+                                    int                  width,
+                                    int                  height,
+                                    CoglReadPixelsFlags  source,
+                                    CoglPixelFormat      format,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data);
+
+/**
+ * cogl_framebuffer_read_pixels_finish:
+ * @framebuffer: A #CoglFramebuffer
+ * @result: The #GAsyncResult passed to the callback
+ * @bitmap: The bitmap to store the results in
+ * @error: Return location for a #GError
+ *
+ * Finishes a read started with cogl_framebuffer_read_pixels_async() and
+ * stores the pixels in @bitmap, which must have the size of the read
+ * rectangle. The pixels are converted to the format of @bitmap if needed.
+ *
+ * Return value: %TRUE if the read succeeded or %FALSE otherwise.
+ */
+COGL_EXPORT gboolean
+cogl_framebuffer_read_pixels_finish (CoglFramebuffer  *framebuffer,
+                                     GAsyncResult     *result,
+                                     CoglBitmap       *bitmap,
+                                     GError          **error);
+
 COGL_EXPORT uint32_t
 cogl_framebuffer_error_quark (void);
 
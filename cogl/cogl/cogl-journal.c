@@ -37,6 +37,7 @@
 #include "cogl/cogl-texture-private.h"
 #include "cogl/cogl-texture-2d-private.h"
 #include "cogl/cogl-pipeline-private.h"
+#include "cogl/cogl-pipeline-state-private.h"
 #include "cogl/cogl-framebuffer-private.h"
 #include "cogl/cogl-profile.h"
 #include "cogl/cogl-attribute-private.h"
@@ -87,15 +88,45 @@
 #define COLOR_STRIDE      1 /* number of 32bit words */
 #define TEX_STRIDE        2 /* number of 32bit words */
 #define MIN_LAYER_PADDING  2
+/* Region clips with up to this many rectangles get drawn with one
+ * scissored draw per rectangle rather than with a stencil clip */
+#define MAX_SCISSORED_REGION_RECTANGLES 8
 #define GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS(N_LAYERS) \
   (POS_STRIDE + COLOR_STRIDE + \
    TEX_STRIDE * (N_LAYERS < MIN_LAYER_PADDING ? MIN_LAYER_PADDING : N_LAYERS))
 
+/* XXX NB:
+ * When the driver supports instanced arrays the journal instead uploads
+ * one record per quad and expands it to four vertices in the vertex
+ * shader. The record is arranged as follows:
+ *    3 * 3 GLfloats for the transformed top left, top right and bottom
+ *      left corners. The quad may be any parallelogram once transformed
+ *      so the fourth corner is derived from the other three
+ *    4 RGBA GLubytes,
+ *    4 GLfloats per layer for the top left and bottom right tex coords
+ *
+ * n_layers is padded in the same way as for the vertex array, and only
+ * software transformed quads are ever drawn this way. So for a given
+ * number of layers this gets the stride in 32bit words:
+ */
+#define INSTANCE_POS_STRIDE 9 /* number of 32bit words */
+#define INSTANCE_TEX_STRIDE 4 /* number of 32bit words */
+#define GET_JOURNAL_INSTANCE_STRIDE_FOR_N_LAYERS(N_LAYERS) \
+  (INSTANCE_POS_STRIDE + COLOR_STRIDE + \
+   INSTANCE_TEX_STRIDE * (N_LAYERS < MIN_LAYER_PADDING ? \
+                          MIN_LAYER_PADDING : N_LAYERS))
+
 /* If a batch is longer than this threshold then we'll assume it's not
    worth doing software clipping and it's cheaper to program the GPU
    to do the clip */
 #define COGL_JOURNAL_HARDWARE_CLIP_THRESHOLD 8
 
+/* The initial size of the vertex buffer ring shared by the journals.
+   It is grown to the next power of two if a single flush needs more */
+#define COGL_JOURNAL_VBO_RING_MIN_SIZE (256 * 1024)
+/* Each flush starts on a new cache line in the ring */
+#define ALIGN_VBO_OFFSET(offset) (((offset) + 63) & ~((size_t) 63))
+
 typedef struct _CoglJournalFlushState
 {
   CoglContext *ctx;
@@ -106,6 +137,10 @@ typedef struct _CoglJournalFlushState
   GArray *attributes;
   int current_attribute;
 
+  /* Whether the attribute buffer contains one record per quad rather
+   * than four vertices */
+  gboolean instanced;
+
   size_t stride;
   size_t array_offset;
   GLuint current_vertex;
@@ -128,17 +163,12 @@ static void
 cogl_journal_dispose (GObject *object)
 {
   CoglJournal *journal = COGL_JOURNAL (object);
-  int i;
 
   if (journal->entries)
     g_array_free (journal->entries, TRUE);
   if (journal->vertices)
     g_array_free (journal->vertices, TRUE);
 
-  for (i = 0; i < COGL_JOURNAL_VBO_POOL_SIZE; i++)
-    if (journal->vbo_pool[i])
-      g_object_unref (journal->vbo_pool[i]);
-
   G_OBJECT_CLASS (cogl_journal_parent_class)->dispose (object);
 }
 
@@ -274,6 +304,277 @@ batch_and_call (CoglJournalEntry *entries,
   batch_callback (batch_start, batch_len, data);
 }
 
+static CoglSnippet *
+get_instance_tex_coord_snippet (CoglContext *ctx,
+                                int          layer_index)
+{
+  CoglSnippet *snippet;
+  char *declarations;
+  char *pre;
+
+  if (ctx->journal_instance_tex_coord_snippets == NULL)
+    ctx->journal_instance_tex_coord_snippets =
+      g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+
+  snippet = g_hash_table_lookup (ctx->journal_instance_tex_coord_snippets,
+                                 GINT_TO_POINTER (layer_index));
+  if (snippet)
+    return snippet;
+
+  declarations =
+    g_strdup_printf ("attribute vec4 _cogl_journal_tex_rect%i_in;\n",
+                     layer_index);
+  pre =
+    g_strdup_printf ("  cogl_tex_coord = "
+                     "vec4 (mix (_cogl_journal_tex_rect%i_in.xy,\n"
+                     "                                "
+                     "_cogl_journal_tex_rect%i_in.zw,\n"
+                     "                                "
+                     "_cogl_journal_corner_in),\n"
+                     "                           0.0, 1.0);\n",
+                     layer_index,
+                     layer_index);
+
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_COORD_TRANSFORM,
+                              declarations,
+                              NULL);
+  cogl_snippet_set_pre (snippet, pre);
+
+  g_free (declarations);
+  g_free (pre);
+
+  g_hash_table_insert (ctx->journal_instance_tex_coord_snippets,
+                       GINT_TO_POINTER (layer_index),
+                       snippet);
+
+  return snippet;
+}
+
+static gboolean
+add_instance_tex_coord_snippet_cb (CoglPipeline *pipeline,
+                                   int           layer_index,
+                                   void         *user_data)
+{
+  CoglPipeline *instanced_pipeline = user_data;
+  CoglSnippet *snippet =
+    get_instance_tex_coord_snippet (pipeline->context, layer_index);
+
+  cogl_pipeline_add_layer_snippet (instanced_pipeline, layer_index, snippet);
+
+  return TRUE;
+}
+
+static GQuark
+get_instanced_pipeline_key (void)
+{
+  static GQuark key = 0;
+
+  if (G_UNLIKELY (key == 0))
+    key = g_quark_from_static_string ("cogl-journal-instanced-pipeline-key");
+
+  return key;
+}
+
+static void
+instanced_pipeline_destroyed_cb (CoglPipeline *weak_pipeline,
+                                 void         *user_data)
+{
+  CoglPipeline *original_pipeline = user_data;
+
+  g_object_set_qdata_full (G_OBJECT (original_pipeline),
+                           get_instanced_pipeline_key (),
+                           NULL, NULL);
+
+  g_object_unref (weak_pipeline);
+}
+
+/* Returns a weak copy of @pipeline with snippets that expand the
+ * per-quad records into the four corners of each quad. The snippets
+ * are shared between all pipelines so that the generated programs end
+ * up in the pipeline cache */
+static CoglPipeline *
+get_instanced_pipeline (CoglContext  *ctx,
+                        CoglPipeline *pipeline)
+{
+  CoglPipeline *instanced_pipeline;
+
+  instanced_pipeline = g_object_get_qdata (G_OBJECT (pipeline),
+                                           get_instanced_pipeline_key ());
+  if (instanced_pipeline)
+    return instanced_pipeline;
+
+  if (ctx->journal_instance_globals_snippet == NULL)
+    {
+      ctx->journal_instance_globals_snippet =
+        cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX_GLOBALS,
+                          "attribute vec2 _cogl_journal_corner_in;\n"
+                          "attribute vec3 _cogl_journal_p00_in;\n"
+                          "attribute vec3 _cogl_journal_p10_in;\n"
+                          "attribute vec3 _cogl_journal_p01_in;\n",
+                          NULL);
+
+      ctx->journal_instance_transform_snippet =
+        cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX_TRANSFORM, NULL, NULL);
+      cogl_snippet_set_replace (ctx->journal_instance_transform_snippet,
+                                "  vec3 pos = _cogl_journal_p00_in +\n"
+                                "    _cogl_journal_corner_in.x *\n"
+                                "    (_cogl_journal_p10_in - "
+                                "_cogl_journal_p00_in) +\n"
+                                "    _cogl_journal_corner_in.y *\n"
+                                "    (_cogl_journal_p01_in - "
+                                "_cogl_journal_p00_in);\n"
+                                "  cogl_position_out = "
+                                "cogl_modelview_projection_matrix *\n"
+                                "                      "
+                                "vec4 (pos, 1.0);\n");
+    }
+
+  instanced_pipeline =
+    _cogl_pipeline_weak_copy (pipeline,
+                              instanced_pipeline_destroyed_cb,
+                              pipeline);
+  cogl_pipeline_add_snippet (instanced_pipeline,
+                             ctx->journal_instance_globals_snippet);
+  cogl_pipeline_add_snippet (instanced_pipeline,
+                             ctx->journal_instance_transform_snippet);
+  cogl_pipeline_foreach_layer (pipeline,
+                               add_instance_tex_coord_snippet_cb,
+                               instanced_pipeline);
+
+  g_object_set_qdata_full (G_OBJECT (pipeline),
+                           get_instanced_pipeline_key (),
+                           instanced_pipeline,
+                           NULL);
+
+  return instanced_pipeline;
+}
+
+static CoglAttributeBuffer *
+get_quad_corners (CoglContext *ctx)
+{
+  /* Drawn as a triangle strip, in the same winding order as the
+   * rectangle indices */
+  static const float corners[] = {
+    0.0f, 0.0f,
+    0.0f, 1.0f,
+    1.0f, 0.0f,
+    1.0f, 1.0f,
+  };
+
+  if (ctx->journal_quad_corners == NULL)
+    ctx->journal_quad_corners =
+      cogl_attribute_buffer_new (ctx, sizeof (corners), corners);
+
+  return ctx->journal_quad_corners;
+}
+
+static CoglAttribute *
+add_instance_attribute (CoglJournalFlushState *state,
+                        const char            *name,
+                        size_t                 offset,
+                        int                    n_components,
+                        CoglAttributeType      type)
+{
+  CoglAttribute *attribute;
+
+  attribute = cogl_attribute_new (state->attribute_buffer,
+                                  name,
+                                  state->stride,
+                                  offset,
+                                  n_components,
+                                  type);
+  _cogl_attribute_set_instance_divisor (attribute, 1);
+  g_array_append_val (state->attributes, attribute);
+
+  return attribute;
+}
+
+typedef struct _AddInstanceTexRectState
+{
+  CoglJournalFlushState *flush_state;
+  size_t offset;
+} AddInstanceTexRectState;
+
+static gboolean
+add_instance_tex_rect_cb (CoglPipeline *pipeline,
+                          int           layer_index,
+                          void         *user_data)
+{
+  AddInstanceTexRectState *state = user_data;
+  char *name;
+
+  name = g_strdup_printf ("_cogl_journal_tex_rect%i_in", layer_index);
+  add_instance_attribute (state->flush_state,
+                          name,
+                          state->offset,
+                          4,
+                          COGL_ATTRIBUTE_TYPE_FLOAT);
+  g_free (name);
+
+  state->offset += INSTANCE_TEX_STRIDE * 4;
+
+  return TRUE;
+}
+
+/* There is no portable way to pass a base instance to GLES so instead
+ * the per-instance attributes are recreated pointing at the first quad
+ * of each batch */
+static void
+draw_instanced_batch (CoglJournalFlushState *state,
+                      int                    batch_len,
+                      CoglDrawFlags          draw_flags)
+{
+  CoglContext *ctx = state->ctx;
+  CoglFramebuffer *framebuffer = state->journal->framebuffer;
+  CoglPipeline *instanced_pipeline;
+  CoglAttribute *corner_attribute;
+  AddInstanceTexRectState tex_rect_state;
+  size_t offset;
+  int i;
+
+  instanced_pipeline = get_instanced_pipeline (ctx, state->pipeline);
+
+  offset = state->array_offset + (state->current_vertex / 4) * state->stride;
+
+  corner_attribute = cogl_attribute_new (get_quad_corners (ctx),
+                                         "_cogl_journal_corner_in",
+                                         sizeof (float) * 2,
+                                         0,
+                                         2,
+                                         COGL_ATTRIBUTE_TYPE_FLOAT);
+  g_array_append_val (state->attributes, corner_attribute);
+
+  add_instance_attribute (state, "_cogl_journal_p00_in",
+                          offset, 3, COGL_ATTRIBUTE_TYPE_FLOAT);
+  add_instance_attribute (state, "_cogl_journal_p10_in",
+                          offset + 3 * 4, 3, COGL_ATTRIBUTE_TYPE_FLOAT);
+  add_instance_attribute (state, "_cogl_journal_p01_in",
+                          offset + 6 * 4, 3, COGL_ATTRIBUTE_TYPE_FLOAT);
+  add_instance_attribute (state, "cogl_color_in",
+                          offset + INSTANCE_POS_STRIDE * 4,
+                          4, COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE);
+
+  tex_rect_state.flush_state = state;
+  tex_rect_state.offset = offset + (INSTANCE_POS_STRIDE + COLOR_STRIDE) * 4;
+  cogl_pipeline_foreach_layer (state->pipeline,
+                               add_instance_tex_rect_cb,
+                               &tex_rect_state);
+
+  _cogl_framebuffer_draw_instanced_attributes (framebuffer,
+                                               instanced_pipeline,
+                                               COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                               0, 4,
+                                               batch_len,
+                                               (CoglAttribute **)
+                                               state->attributes->data,
+                                               state->attributes->len,
+                                               draw_flags);
+
+  for (i = 0; i < state->attributes->len; i++)
+    g_object_unref (g_array_index (state->attributes, CoglAttribute *, i));
+  g_array_set_size (state->attributes, 0);
+}
+
 static void
 _cogl_journal_flush_modelview_and_entries (CoglJournalEntry *batch_start,
                                            int               batch_len,
@@ -307,7 +608,11 @@ _cogl_journal_flush_modelview_and_entries (CoglJournalEntry *batch_start,
   if (!_cogl_pipeline_get_real_blend_enabled (state->pipeline))
     draw_flags |= COGL_DRAW_COLOR_ATTRIBUTE_IS_OPAQUE;
 
-  if (batch_len > 1)
+  if (state->instanced)
+    {
+      draw_instanced_batch (state, batch_len, draw_flags);
+    }
+  else if (batch_len > 1)
     {
       CoglVerticesMode mode = COGL_VERTICES_MODE_TRIANGLES;
       int first_vertex = state->current_vertex * 6 / 4;
@@ -398,8 +703,20 @@ static gboolean
 compare_entry_modelviews (CoglJournalEntry *entry0,
                           CoglJournalEntry *entry1)
 {
+  graphene_point3d_t translation0;
+  graphene_point3d_t translation1;
+
   /* Batch together quads with the same model view matrix */
-  return entry0->modelview_entry == entry1->modelview_entry;
+  if (entry0->modelview_entry == entry1->modelview_entry)
+    return TRUE;
+
+  /* Sibling actors commonly end up with distinct entries describing
+   * the same pure translation, which can still share a batch */
+  return (_cogl_matrix_entry_get_translation (entry0->modelview_entry,
+                                              &translation0) &&
+          _cogl_matrix_entry_get_translation (entry1->modelview_entry,
+                                              &translation1) &&
+          graphene_point3d_equal (&translation0, &translation1));
 }
 
 /* At this point we have a run of quads that we know have compatible
@@ -536,6 +853,20 @@ _cogl_journal_flush_texcoord_vbo_offsets_and_entries (
 
   COGL_TIMER_START (_cogl_uprof_context, time_flush_texcoord_pipeline_entries);
 
+  /* In instanced mode all of the attributes are created for each
+   * draw instead */
+  if (state->instanced)
+    {
+      batch_and_call (batch_start,
+                      batch_len,
+                      compare_entry_pipelines,
+                      _cogl_journal_flush_pipeline_and_entries,
+                      data);
+      COGL_TIMER_STOP (_cogl_uprof_context,
+                       time_flush_texcoord_pipeline_entries);
+      return;
+    }
+
   /* NB: attributes 0 and 1 are position and color */
 
   for (i = 2; i < state->attributes->len; i++)
@@ -602,6 +933,25 @@ _cogl_journal_flush_vbo_offsets_and_entries (CoglJournalEntry *batch_start,
    * (though n_layers may be padded; see definition of
    *  GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS for details)
    */
+  if (state->instanced)
+    {
+      stride = GET_JOURNAL_INSTANCE_STRIDE_FOR_N_LAYERS (batch_start->n_layers);
+      state->stride = stride * sizeof (float);
+      state->current_vertex = 0;
+
+      batch_and_call (batch_start,
+                      batch_len,
+                      compare_entry_layer_numbers,
+                      _cogl_journal_flush_texcoord_vbo_offsets_and_entries,
+                      data);
+
+      state->array_offset += state->stride * batch_len;
+
+      COGL_TIMER_STOP (_cogl_uprof_context,
+                       time_flush_vbo_texcoord_pipeline_entries);
+      return;
+    }
+
   stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (batch_start->n_layers);
   stride *= sizeof (float);
   state->stride = stride;
@@ -689,31 +1039,62 @@ compare_entry_strides (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
     return FALSE;
 }
 
-/* At this point we know the batch has a unique clip stack */
+/* Returns the region of a region clip stack that can be replaced by
+ * drawing the batch once per region rectangle, each time with only a
+ * scissor set up. This avoids clearing and drawing into the stencil
+ * buffer for the common case of a redraw clip made of a few damage
+ * rectangles. Beyond MAX_SCISSORED_REGION_RECTANGLES the repeated draws
+ * are assumed to cost more than the stencil clip. */
+static MtkRegion *
+get_scissorable_clip_region (CoglClipStack *clip_stack)
+{
+  CoglClipStackRegion *region_entry;
+  CoglClipStack *entry;
+  int n_rectangles;
+
+  if (!clip_stack || clip_stack->type != COGL_CLIP_STACK_REGION)
+    return NULL;
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)))
+    return NULL;
+
+  region_entry = (CoglClipStackRegion *) clip_stack;
+  n_rectangles = mtk_region_num_rectangles (region_entry->region);
+  if (n_rectangles <= 1 || n_rectangles > MAX_SCISSORED_REGION_RECTANGLES)
+    return NULL;
+
+  /* The remaining clip entries must not need the stencil buffer either,
+   * otherwise it would have to be set up again for every rectangle */
+  for (entry = clip_stack->parent; entry; entry = entry->parent)
+    {
+      switch (entry->type)
+        {
+        case COGL_CLIP_STACK_RECT:
+          if (!((CoglClipStackRect *) entry)->can_be_scissor)
+            return NULL;
+          break;
+        case COGL_CLIP_STACK_REGION:
+          if (mtk_region_num_rectangles (((CoglClipStackRegion *) entry)->region) > 1)
+            return NULL;
+          break;
+        }
+    }
+
+  return region_entry->region;
+}
+
 static void
-_cogl_journal_flush_clip_stacks_and_entries (CoglJournalEntry *batch_start,
-                                             int               batch_len,
-                                             void             *data)
+flush_clip_stack_and_entries (CoglClipStack    *clip_stack,
+                              CoglJournalEntry *batch_start,
+                              int               batch_len,
+                              void             *data)
 {
   CoglJournalFlushState *state = data;
   CoglFramebuffer *framebuffer = state->journal->framebuffer;
   CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
   CoglMatrixStack *projection_stack;
 
-  COGL_STATIC_TIMER (time_flush_clip_stack_pipeline_entries,
-                     "Journal Flush", /* parent */
-                     "flush: clip+vbo+texcoords+pipeline+entries",
-                     "The time spent flushing clip + vbo + texcoord offsets + "
-                     "pipeline + entries",
-                     0 /* no application private data */);
-
-  COGL_TIMER_START (_cogl_uprof_context,
-                    time_flush_clip_stack_pipeline_entries);
-
-  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
-    g_print ("BATCHING:  clip stack batch len = %d\n", batch_len);
-
-  _cogl_clip_stack_flush (batch_start->clip_stack, framebuffer);
+  _cogl_clip_stack_flush (clip_stack, framebuffer);
 
   /* XXX: Because we are manually flushing clip state here we need to
    * make sure that the clip state gets updated the next time we flush
@@ -742,6 +1123,66 @@ _cogl_journal_flush_clip_stacks_and_entries (CoglJournalEntry *batch_start,
                   compare_entry_strides,
                   _cogl_journal_flush_vbo_offsets_and_entries, /* callback */
                   data);
+}
+
+/* At this point we know the batch has a unique clip stack */
+static void
+_cogl_journal_flush_clip_stacks_and_entries (CoglJournalEntry *batch_start,
+                                             int               batch_len,
+                                             void             *data)
+{
+  CoglJournalFlushState *state = data;
+  CoglClipStack *clip_stack = batch_start->clip_stack;
+  MtkRegion *clip_region;
+
+  COGL_STATIC_TIMER (time_flush_clip_stack_pipeline_entries,
+                     "Journal Flush", /* parent */
+                     "flush: clip+vbo+texcoords+pipeline+entries",
+                     "The time spent flushing clip + vbo + texcoord offsets + "
+                     "pipeline + entries",
+                     0 /* no application private data */);
+
+  COGL_TIMER_START (_cogl_uprof_context,
+                    time_flush_clip_stack_pipeline_entries);
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+    g_print ("BATCHING:  clip stack batch len = %d\n", batch_len);
+
+  clip_region = get_scissorable_clip_region (clip_stack);
+  if (clip_region)
+    {
+      size_t array_offset = state->array_offset;
+      int n_rectangles = mtk_region_num_rectangles (clip_region);
+      int i;
+
+      COGL_NOTE (CLIPPING, "Drawing batch once per each of %d region "
+                 "rectangles", n_rectangles);
+
+      /* The region rectangles never overlap, so every fragment still
+       * only gets drawn once */
+      for (i = 0; i < n_rectangles; i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (clip_region, i);
+          g_autoptr (MtkRegion) rect_region = NULL;
+          CoglClipStack *rect_clip_stack;
+
+          rect_region = mtk_region_create_rectangle (&rect);
+          rect_clip_stack =
+            cogl_clip_stack_push_region (_cogl_clip_stack_ref (clip_stack->parent),
+                                         rect_region);
+
+          state->array_offset = array_offset;
+          flush_clip_stack_and_entries (rect_clip_stack,
+                                        batch_start, batch_len,
+                                        data);
+
+          _cogl_clip_stack_unref (rect_clip_stack);
+        }
+    }
+  else
+    {
+      flush_clip_stack_and_entries (clip_stack, batch_start, batch_len, data);
+    }
 
   COGL_TIMER_STOP (_cogl_uprof_context,
                    time_flush_clip_stack_pipeline_entries);
@@ -1128,34 +1569,132 @@ compare_entry_viewports (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
   return memcmp (entry0->viewport, entry1->viewport, sizeof (float) * 4) == 0;
 }
 
-/* Gets a new vertex array from the pool. A reference is taken on the
-   array so it can be treated as if it was just newly allocated */
+/* Reserves @n_bytes in the vertex buffer ring shared by all journals
+   of the context. Flushes are appended one after another so that the
+   driver never has to wait for the GPU to finish with the vertices of
+   an earlier flush. Once the ring is full the whole buffer is
+   discarded which lets the driver orphan the old storage instead of
+   stalling, so no explicit fences are needed. A reference is taken on
+   the returned buffer */
 static CoglAttributeBuffer *
-create_attribute_buffer (CoglJournal *journal,
-                         size_t n_bytes)
+reserve_attribute_buffer_range (CoglJournal       *journal,
+                                size_t             n_bytes,
+                                size_t            *offset_out,
+                                CoglBufferMapHint *hints_out)
 {
   CoglContext *ctx = cogl_framebuffer_get_context (journal->framebuffer);
-  CoglAttributeBuffer *vbo;
+  size_t offset;
 
-  vbo = journal->vbo_pool[journal->next_vbo_in_pool];
+  if (ctx->journal_vbo &&
+      cogl_buffer_get_size (COGL_BUFFER (ctx->journal_vbo)) < n_bytes)
+    g_clear_object (&ctx->journal_vbo);
 
-  if (vbo == NULL)
+  if (ctx->journal_vbo == NULL)
     {
-      vbo = cogl_attribute_buffer_new_with_size (ctx, n_bytes);
-      journal->vbo_pool[journal->next_vbo_in_pool] = vbo;
+      size_t size = COGL_JOURNAL_VBO_RING_MIN_SIZE;
+
+      while (size < n_bytes)
+        size *= 2;
+
+      ctx->journal_vbo = cogl_attribute_buffer_new_with_size (ctx, size);
+      cogl_buffer_set_update_hint (COGL_BUFFER (ctx->journal_vbo),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+      ctx->journal_vbo_offset = 0;
+    }
+
+  offset = ALIGN_VBO_OFFSET (ctx->journal_vbo_offset);
+
+  if (offset == 0 ||
+      offset + n_bytes > cogl_buffer_get_size (COGL_BUFFER (ctx->journal_vbo)))
+    {
+      offset = 0;
+      *hints_out = COGL_BUFFER_MAP_HINT_DISCARD;
+    }
+  else
+    {
+      *hints_out = COGL_BUFFER_MAP_HINT_DISCARD_RANGE;
+    }
+
+  ctx->journal_vbo_offset = offset + n_bytes;
+  *offset_out = offset;
+
+  return g_object_ref (ctx->journal_vbo);
+}
+
+/* The modelview matrix of the quads being uploaded, kept as the rows
+ * scaling the x and y coordinates plus the translation, so that the
+ * corners of a quad can be transformed using a few vector operations
+ * instead of a full matrix-vector product per corner. */
+typedef struct _QuadTransform
+{
+  CoglMatrixEntry *modelview_entry;
+  graphene_vec4_t x_axis;
+  graphene_vec4_t y_axis;
+  graphene_vec4_t origin;
+} QuadTransform;
+
+static void
+quad_transform_update (QuadTransform   *transform,
+                       CoglMatrixEntry *modelview_entry)
+{
+  graphene_point3d_t translation;
+  graphene_matrix_t modelview;
+
+  if (transform->modelview_entry == modelview_entry)
+    return;
+
+  if (_cogl_matrix_entry_get_translation (modelview_entry, &translation))
+    {
+      graphene_vec4_init (&transform->x_axis, 1.0f, 0.0f, 0.0f, 0.0f);
+      graphene_vec4_init (&transform->y_axis, 0.0f, 1.0f, 0.0f, 0.0f);
+      graphene_vec4_init (&transform->origin,
+                          translation.x, translation.y, translation.z, 1.0f);
     }
-  else if (cogl_buffer_get_size (COGL_BUFFER (vbo)) < n_bytes)
+  else
     {
-      /* If the buffer is too small then we'll just recreate it */
-      g_object_unref (vbo);
-      vbo = cogl_attribute_buffer_new_with_size (ctx, n_bytes);
-      journal->vbo_pool[journal->next_vbo_in_pool] = vbo;
+      cogl_matrix_entry_get (modelview_entry, &modelview);
+      graphene_matrix_get_row (&modelview, 0, &transform->x_axis);
+      graphene_matrix_get_row (&modelview, 1, &transform->y_axis);
+      graphene_matrix_get_row (&modelview, 3, &transform->origin);
     }
+  transform->modelview_entry = modelview_entry;
+}
+
+/* Transforms the corners of the quad (x_1, y_1), (x_2, y_2) in the
+ * order (x_1, y_1), (x_1, y_2), (x_2, y_2), (x_2, y_1) */
+static void
+quad_transform_corners (const QuadTransform *transform,
+                        float                x_1,
+                        float                y_1,
+                        float                x_2,
+                        float                y_2,
+                        graphene_vec4_t      corners[4])
+{
+  graphene_vec4_t left, right, top, bottom;
+
+  graphene_vec4_scale (&transform->x_axis, x_1, &left);
+  graphene_vec4_add (&left, &transform->origin, &left);
+  graphene_vec4_scale (&transform->x_axis, x_2, &right);
+  graphene_vec4_add (&right, &transform->origin, &right);
+  graphene_vec4_scale (&transform->y_axis, y_1, &top);
+  graphene_vec4_scale (&transform->y_axis, y_2, &bottom);
+
+  graphene_vec4_add (&left, &top, &corners[0]);
+  graphene_vec4_add (&left, &bottom, &corners[1]);
+  graphene_vec4_add (&right, &bottom, &corners[2]);
+  graphene_vec4_add (&right, &top, &corners[3]);
+}
 
-  journal->next_vbo_in_pool = ((journal->next_vbo_in_pool + 1) %
-                               COGL_JOURNAL_VBO_POOL_SIZE);
+static inline void
+store_corner (const graphene_vec4_t *corner,
+              float                 *out)
+{
+  float v[4];
 
-  return g_object_ref (vbo);
+  graphene_vec4_to_float (corner, v);
+  out[0] = v[0];
+  out[1] = v[1];
+  out[2] = v[2];
 }
 
 static CoglAttributeBuffer *
@@ -1163,26 +1702,31 @@ upload_vertices (CoglJournal *journal,
                  const CoglJournalEntry *entries,
                  int n_entries,
                  size_t needed_vbo_len,
-                 GArray *vertices)
+                 GArray *vertices,
+                 size_t *offset_out)
 {
   CoglAttributeBuffer *attribute_buffer;
   CoglBuffer *buffer;
+  CoglBufferMapHint hints;
+  size_t offset;
   const float *vin;
   float *vout;
   int entry_num;
   int i;
-  CoglMatrixEntry *last_modelview_entry = NULL;
-  graphene_matrix_t modelview;
+  QuadTransform transform = { 0 };
 
   g_assert (needed_vbo_len);
 
-  attribute_buffer = create_attribute_buffer (journal, needed_vbo_len * 4);
+  attribute_buffer = reserve_attribute_buffer_range (journal,
+                                                     needed_vbo_len * 4,
+                                                     &offset,
+                                                     &hints);
   buffer = COGL_BUFFER (attribute_buffer);
-  cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
 
   vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
-                                                      0, /* offset */
-                                                      needed_vbo_len * 4);
+                                                      offset,
+                                                      needed_vbo_len * 4,
+                                                      hints);
   vin = &g_array_index (vertices, float, 0);
 
   /* Expand the number of vertices from 2 to 4 while uploading */
@@ -1211,27 +1755,16 @@ upload_vertices (CoglJournal *journal,
         }
       else
         {
-          float v[8];
-
-          v[0] = vin[0];
-          v[1] = vin[1];
-          v[2] = vin[0];
-          v[3] = vin[array_stride + 1];
-          v[4] = vin[array_stride];
-          v[5] = vin[array_stride + 1];
-          v[6] = vin[array_stride];
-          v[7] = vin[1];
-
-          if (entry->modelview_entry != last_modelview_entry)
-            cogl_matrix_entry_get (entry->modelview_entry, &modelview);
-          cogl_graphene_matrix_transform_points (&modelview,
-                                                 2, /* n_components */
-                                                 sizeof (float) * 2, /* stride_in */
-                                                 v, /* points_in */
-                                                 /* strideout */
-                                                 vb_stride * sizeof (float),
-                                                 vout, /* points_out */
-                                                 4 /* n_points */);
+          graphene_vec4_t corners[4];
+
+          quad_transform_update (&transform, entry->modelview_entry);
+          quad_transform_corners (&transform,
+                                  vin[0], vin[1],
+                                  vin[array_stride], vin[array_stride + 1],
+                                  corners);
+
+          for (i = 0; i < 4; i++)
+            store_corner (&corners[i], vout + vb_stride * i);
         }
 
       for (i = 0; i < entry->n_layers; i++)
@@ -1255,9 +1788,122 @@ upload_vertices (CoglJournal *journal,
 
   _cogl_buffer_unmap_for_fill_or_fallback (buffer);
 
+  *offset_out = offset;
+
+  return attribute_buffer;
+}
+
+static CoglAttributeBuffer *
+upload_instances (CoglJournal *journal,
+                  const CoglJournalEntry *entries,
+                  int n_entries,
+                  size_t needed_instance_len,
+                  GArray *vertices,
+                  size_t *offset_out)
+{
+  CoglAttributeBuffer *attribute_buffer;
+  CoglBuffer *buffer;
+  CoglBufferMapHint hints;
+  size_t offset;
+  const float *vin;
+  float *vout;
+  int entry_num;
+  int i;
+  QuadTransform transform = { 0 };
+
+  g_assert (needed_instance_len);
+
+  attribute_buffer = reserve_attribute_buffer_range (journal,
+                                                     needed_instance_len * 4,
+                                                     &offset,
+                                                     &hints);
+  buffer = COGL_BUFFER (attribute_buffer);
+
+  vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
+                                                      offset,
+                                                      needed_instance_len * 4,
+                                                      hints);
+  vin = &g_array_index (vertices, float, 0);
+
+  /* Write one record per quad with three of its corners transformed */
+  for (entry_num = 0; entry_num < n_entries; entry_num++)
+    {
+      const CoglJournalEntry *entry = entries + entry_num;
+      size_t instance_stride =
+        GET_JOURNAL_INSTANCE_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      size_t array_stride =
+        GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      graphene_vec4_t corners[4];
+
+      memcpy (vout + INSTANCE_POS_STRIDE, vin, 4);
+      vin++;
+
+      quad_transform_update (&transform, entry->modelview_entry);
+      quad_transform_corners (&transform,
+                              vin[0], vin[1],
+                              vin[array_stride], vin[array_stride + 1],
+                              corners);
+
+      /* The (x_1, y_1), (x_2, y_1) and (x_1, y_2) corners */
+      store_corner (&corners[0], vout);
+      store_corner (&corners[3], vout + 3);
+      store_corner (&corners[1], vout + 6);
+
+      for (i = 0; i < entry->n_layers; i++)
+        {
+          const float *tin = vin + 2;
+          float *tout = (vout + INSTANCE_POS_STRIDE + COLOR_STRIDE +
+                         i * INSTANCE_TEX_STRIDE);
+
+          tout[0] = tin[i * 2];
+          tout[1] = tin[i * 2 + 1];
+          tout[2] = tin[array_stride + i * 2];
+          tout[3] = tin[array_stride + i * 2 + 1];
+        }
+
+      vin += array_stride * 2;
+      vout += instance_stride;
+    }
+
+  _cogl_buffer_unmap_for_fill_or_fallback (buffer);
+
+  *offset_out = offset;
+
   return attribute_buffer;
 }
 
+/* The instanced path relies on the quads being transformed in software
+ * and replaces the vertex transform of the pipelines, so it can only be
+ * used when none of the pipelines have their own vertex processing */
+static gboolean
+can_draw_instanced (CoglContext *ctx,
+                    CoglJournal *journal)
+{
+  int i;
+
+  if (!_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS))
+    return FALSE;
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_JOURNAL_INSTANCING) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_RECTANGLES) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_JOURNAL) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_WIREFRAME)))
+    return FALSE;
+
+  for (i = 0; i < journal->entries->len; i++)
+    {
+      CoglJournalEntry *entry =
+        &g_array_index (journal->entries, CoglJournalEntry, i);
+
+      if (cogl_pipeline_get_user_program (entry->pipeline) ||
+          _cogl_pipeline_has_vertex_snippets (entry->pipeline))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 void
 _cogl_journal_discard (CoglJournal *journal)
 {
@@ -1278,6 +1924,7 @@ _cogl_journal_discard (CoglJournal *journal)
   g_array_set_size (journal->entries, 0);
   g_array_set_size (journal->vertices, 0);
   journal->needed_vbo_len = 0;
+  journal->needed_instance_len = 0;
   journal->fast_read_pixel_count = 0;
 }
 
@@ -1381,6 +2028,8 @@ _cogl_journal_flush (CoglJournal *journal)
   framebuffer = journal->framebuffer;
   ctx = cogl_framebuffer_get_context (framebuffer);
 
+  ctx->render_stats.n_journal_flushes++;
+
   /* The entries in this journal may depend on images in other
    * framebuffers which may require that we flush the journals
    * associated with those framebuffers before we can flush
@@ -1428,15 +2077,26 @@ _cogl_journal_flush (CoglJournal *journal)
                       &state); /* data */
     }
 
+  state.instanced = can_draw_instanced (ctx, journal);
+
   /* We upload the vertices after the clip stack pass in case it
      modifies the entries */
-  state.attribute_buffer =
-    upload_vertices (journal,
-                     &g_array_index (journal->entries, CoglJournalEntry, 0),
-                     journal->entries->len,
-                     journal->needed_vbo_len,
-                     journal->vertices);
-  state.array_offset = 0;
+  if (state.instanced)
+    state.attribute_buffer =
+      upload_instances (journal,
+                        &g_array_index (journal->entries, CoglJournalEntry, 0),
+                        journal->entries->len,
+                        journal->needed_instance_len,
+                        journal->vertices,
+                        &state.array_offset);
+  else
+    state.attribute_buffer =
+      upload_vertices (journal,
+                       &g_array_index (journal->entries, CoglJournalEntry, 0),
+                       journal->entries->len,
+                       journal->needed_vbo_len,
+                       journal->vertices,
+                       &state.array_offset);
 
   /* batch_and_call() batches a list of journal entries according to some
    * given criteria and calls a callback once for each determined batch.
@@ -1540,6 +2200,8 @@ _cogl_journal_log_quad (CoglJournal  *journal,
      depends on the number of layers in each entry and it's not easy
      calculate based on the length of the logged vertices array */
   journal->needed_vbo_len += GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (n_layers) * 4;
+  journal->needed_instance_len +=
+    GET_JOURNAL_INSTANCE_STRIDE_FOR_N_LAYERS (n_layers);
 
   /* XXX: All the jumping around to fill in this strided buffer doesn't
    * seem ideal. */
@@ -56,9 +56,15 @@ struct _CoglMatrixEntry
   CoglMatrixOp op;
   unsigned int ref_count;
 
-  /* Debugging, only used when defined(COGL_ENABLE_DEBUG)
-   * Used for performance tracing */
-  int composite_gets;
+  /* Whether every entry up to the root is a translation, a save or an
+   * identity, i.e. the composed matrix is a pure translation. */
+  unsigned int translation_only : 1;
+
+  /* The matrix of this entry composed with all of its ancestors.
+   * Entries never change once they have been pushed, so this is
+   * computed the first time it's needed and never invalidated. */
+  unsigned int composed_valid : 1;
+  graphene_matrix_t composed;
 };
 
 typedef struct _CoglMatrixEntryTranslate
@@ -115,9 +121,6 @@ typedef struct _CoglMatrixEntrySave
 {
   CoglMatrixEntry _parent_data;
 
-  graphene_matrix_t cache;
-  gboolean cache_valid;
-
 } CoglMatrixEntrySave;
 
 typedef union _CoglMatrixEntryFull
@@ -151,6 +154,13 @@ typedef struct _CoglMatrixEntryCache
 void
 _cogl_matrix_entry_identity_init (CoglMatrixEntry *entry);
 
+COGL_EXPORT_TEST const graphene_matrix_t *
+_cogl_matrix_entry_get_composed (CoglMatrixEntry *entry);
+
+COGL_EXPORT_TEST gboolean
+_cogl_matrix_entry_get_translation (CoglMatrixEntry    *entry,
+                                    graphene_point3d_t *translation);
+
 void
 _cogl_matrix_entry_cache_init (CoglMatrixEntryCache *cache);
 
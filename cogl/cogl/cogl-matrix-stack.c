@@ -55,10 +55,7 @@ _cogl_matrix_entry_new (CoglMatrixOp operation)
 
   entry->ref_count = 1;
   entry->op = operation;
-
-#ifdef COGL_ENABLE_DEBUG
-  entry->composite_gets = 0;
-#endif
+  entry->composed_valid = FALSE;
 
   return entry;
 }
@@ -107,6 +104,20 @@ _cogl_matrix_stack_push_entry (CoglMatrixStack *stack,
   entry->parent = stack->last_entry;
   stack->last_entry = entry;
 
+  switch (entry->op)
+    {
+    case COGL_MATRIX_OP_LOAD_IDENTITY:
+      entry->translation_only = TRUE;
+      break;
+    case COGL_MATRIX_OP_TRANSLATE:
+    case COGL_MATRIX_OP_SAVE:
+      entry->translation_only = entry->parent->translation_only;
+      break;
+    default:
+      entry->translation_only = FALSE;
+      break;
+    }
+
   return entry;
 }
 
@@ -154,9 +165,8 @@ _cogl_matrix_entry_identity_init (CoglMatrixEntry *entry)
   entry->ref_count = 1;
   entry->op = COGL_MATRIX_OP_LOAD_IDENTITY;
   entry->parent = NULL;
-#ifdef COGL_ENABLE_DEBUG
-  entry->composite_gets = 0;
-#endif
+  entry->translation_only = TRUE;
+  entry->composed_valid = FALSE;
 }
 
 void
@@ -266,11 +276,7 @@ cogl_matrix_stack_frustum (CoglMatrixStack *stack,
 void
 cogl_matrix_stack_push (CoglMatrixStack *stack)
 {
-  CoglMatrixEntrySave *entry;
-
-  entry = _cogl_matrix_stack_push_operation (stack, COGL_MATRIX_OP_SAVE);
-
-  entry->cache_valid = FALSE;
+  _cogl_matrix_stack_push_operation (stack, COGL_MATRIX_OP_SAVE);
 }
 
 CoglMatrixEntry *
@@ -333,131 +339,172 @@ cogl_matrix_stack_pop (CoglMatrixStack *stack)
   stack->last_entry = new_top;
 }
 
-/* In addition to writing the stack matrix into the give @matrix
- * argument this function *may* sometimes also return a pointer
- * to a matrix too so if we are querying the inverse matrix we
- * should query from the return matrix so that the result can
- * be cached within the stack. */
-graphene_matrix_t *
-cogl_matrix_entry_get (CoglMatrixEntry   *entry,
-                       graphene_matrix_t *matrix)
+static void
+_cogl_matrix_entry_compose (CoglMatrixEntry         *entry,
+                            const graphene_matrix_t *parent)
 {
-  CoglMatrixEntry *current;
-  int depth;
+  graphene_matrix_t op_matrix;
 
-  graphene_matrix_init_identity (matrix);
-
-  for (current = entry, depth = 0;
-       current;
-       current = current->parent, depth++)
+  switch (entry->op)
     {
-      switch (current->op)
-        {
-        case COGL_MATRIX_OP_TRANSLATE:
-          {
-            CoglMatrixEntryTranslate *translate =
-              (CoglMatrixEntryTranslate *) current;
-            graphene_matrix_translate (matrix, &translate->translate);
-            break;
-          }
-        case COGL_MATRIX_OP_ROTATE:
-          {
-            CoglMatrixEntryRotate *rotate =
-              (CoglMatrixEntryRotate *) current;
-            graphene_matrix_rotate (matrix, rotate->angle, &rotate->axis);
-            break;
-          }
-        case COGL_MATRIX_OP_ROTATE_EULER:
-          {
-            CoglMatrixEntryRotateEuler *rotate =
-              (CoglMatrixEntryRotateEuler *) current;
-            graphene_matrix_rotate_euler (matrix, &rotate->euler);
-            break;
-          }
-        case COGL_MATRIX_OP_SCALE:
+    case COGL_MATRIX_OP_LOAD_IDENTITY:
+      graphene_matrix_init_identity (&entry->composed);
+      return;
+
+    case COGL_MATRIX_OP_LOAD:
+      {
+        CoglMatrixEntryLoad *load = (CoglMatrixEntryLoad *) entry;
+        graphene_matrix_init_from_matrix (&entry->composed, &load->matrix);
+        return;
+      }
+
+    case COGL_MATRIX_OP_SAVE:
+      graphene_matrix_init_from_matrix (&entry->composed, parent);
+      return;
+
+    case COGL_MATRIX_OP_TRANSLATE:
+      {
+        CoglMatrixEntryTranslate *translate =
+          (CoglMatrixEntryTranslate *) entry;
+
+        /* Composing two translations only needs the offsets added */
+        if (entry->translation_only)
           {
-            CoglMatrixEntryScale *scale =
-              (CoglMatrixEntryScale *) current;
-            graphene_matrix_scale (matrix, scale->x, scale->y, scale->z);
-            break;
-          }
-        case COGL_MATRIX_OP_MULTIPLY:
-          {
-            CoglMatrixEntryMultiply *multiply =
-              (CoglMatrixEntryMultiply *) current;
-            graphene_matrix_multiply (matrix, &multiply->matrix, matrix);
-            break;
+            float v[16];
+
+            graphene_matrix_to_float (parent, v);
+            v[12] += translate->translate.x;
+            v[13] += translate->translate.y;
+            v[14] += translate->translate.z;
+            graphene_matrix_init_from_float (&entry->composed, v);
+            return;
           }
 
-        case COGL_MATRIX_OP_LOAD_IDENTITY:
-          goto applied;
+        graphene_matrix_init_translate (&op_matrix, &translate->translate);
+        break;
+      }
 
-        case COGL_MATRIX_OP_LOAD:
-          {
-            CoglMatrixEntryLoad *load = (CoglMatrixEntryLoad *) current;
-            graphene_matrix_multiply (matrix, &load->matrix, matrix);
-            goto applied;
-          }
-        case COGL_MATRIX_OP_SAVE:
-          {
-            CoglMatrixEntrySave *save = (CoglMatrixEntrySave *) current;
-            if (!save->cache_valid)
-              {
-                cogl_matrix_entry_get (current->parent, &save->cache);
-                save->cache_valid = TRUE;
-              }
-            graphene_matrix_multiply (matrix, &save->cache, matrix);
-            goto applied;
-          }
-        }
-    }
+    case COGL_MATRIX_OP_ROTATE:
+      {
+        CoglMatrixEntryRotate *rotate = (CoglMatrixEntryRotate *) entry;
+        graphene_matrix_init_rotate (&op_matrix, rotate->angle, &rotate->axis);
+        break;
+      }
 
-applied:
+    case COGL_MATRIX_OP_ROTATE_EULER:
+      {
+        CoglMatrixEntryRotateEuler *rotate =
+          (CoglMatrixEntryRotateEuler *) entry;
+        graphene_euler_to_matrix (&rotate->euler, &op_matrix);
+        break;
+      }
 
-#ifdef COGL_ENABLE_DEBUG
-  if (!current)
-    {
-      g_warning ("Inconsistent matrix stack");
-      return NULL;
-    }
+    case COGL_MATRIX_OP_SCALE:
+      {
+        CoglMatrixEntryScale *scale = (CoglMatrixEntryScale *) entry;
+        graphene_matrix_init_scale (&op_matrix, scale->x, scale->y, scale->z);
+        break;
+      }
 
-  entry->composite_gets++;
+    case COGL_MATRIX_OP_MULTIPLY:
+      {
+        CoglMatrixEntryMultiply *multiply = (CoglMatrixEntryMultiply *) entry;
+        graphene_matrix_init_from_matrix (&op_matrix, &multiply->matrix);
+        break;
+      }
 
-  if (COGL_DEBUG_ENABLED (COGL_DEBUG_PERFORMANCE) &&
-      entry->composite_gets >= 2)
-    {
-      COGL_NOTE (PERFORMANCE,
-                 "Re-composing a matrix stack entry multiple times");
+    default:
+      g_assert_not_reached ();
     }
-#endif
 
-  if (depth == 0)
+  graphene_matrix_multiply (&op_matrix, parent, &entry->composed);
+}
+
+const graphene_matrix_t *
+_cogl_matrix_entry_get_composed (CoglMatrixEntry *entry)
+{
+  CoglMatrixEntry **chain;
+  CoglMatrixEntry *current;
+  int depth;
+  int i;
+
+  if (entry->composed_valid)
+    return &entry->composed;
+
+  /* Find the closest ancestor that either already has its matrix
+   * composed or replaces the matrix entirely, and compose every entry
+   * from there down, so that siblings sharing ancestors with this
+   * entry find those already composed too. */
+  for (current = entry, depth = 1; ; current = current->parent, depth++)
     {
-      switch (entry->op)
+      if (current->op == COGL_MATRIX_OP_LOAD_IDENTITY ||
+          current->op == COGL_MATRIX_OP_LOAD)
+        break;
+
+      if (!current->parent)
         {
-        case COGL_MATRIX_OP_LOAD_IDENTITY:
-        case COGL_MATRIX_OP_TRANSLATE:
-        case COGL_MATRIX_OP_ROTATE:
-        case COGL_MATRIX_OP_ROTATE_EULER:
-        case COGL_MATRIX_OP_SCALE:
-        case COGL_MATRIX_OP_MULTIPLY:
+          g_warning ("Inconsistent matrix stack");
           return NULL;
-
-        case COGL_MATRIX_OP_LOAD:
-          {
-            CoglMatrixEntryLoad *load = (CoglMatrixEntryLoad *)entry;
-            return &load->matrix;
-          }
-        case COGL_MATRIX_OP_SAVE:
-          {
-            CoglMatrixEntrySave *save = (CoglMatrixEntrySave *)entry;
-            return &save->cache;
-          }
         }
-      g_warn_if_reached ();
-      return NULL;
+
+      if (current->parent->composed_valid)
+        break;
     }
 
+  chain = g_newa (CoglMatrixEntry *, depth);
+  for (current = entry, i = depth - 1; i >= 0; current = current->parent, i--)
+    chain[i] = current;
+
+  for (i = 0; i < depth; i++)
+    {
+      current = chain[i];
+
+      _cogl_matrix_entry_compose (current,
+                                  current->parent ?
+                                  &current->parent->composed : NULL);
+      current->composed_valid = TRUE;
+    }
+
+  return &entry->composed;
+}
+
+/* Returns whether the matrix of @entry is a pure translation, and if so
+ * writes the translation into @translation. */
+gboolean
+_cogl_matrix_entry_get_translation (CoglMatrixEntry    *entry,
+                                    graphene_point3d_t *translation)
+{
+  const graphene_matrix_t *composed;
+
+  if (!entry->translation_only)
+    return FALSE;
+
+  composed = _cogl_matrix_entry_get_composed (entry);
+  if (!composed)
+    return FALSE;
+
+  graphene_point3d_init (translation,
+                         graphene_matrix_get_x_translation (composed),
+                         graphene_matrix_get_y_translation (composed),
+                         graphene_matrix_get_z_translation (composed));
+  return TRUE;
+}
+
+/* The composed matrix is cached within the entry, so this always
+ * copies it into @matrix rather than handing out a pointer that could
+ * be used to modify the cache. */
+graphene_matrix_t *
+cogl_matrix_entry_get (CoglMatrixEntry   *entry,
+                       graphene_matrix_t *matrix)
+{
+  const graphene_matrix_t *composed;
+
+  composed = _cogl_matrix_entry_get_composed (entry);
+  if (composed)
+    graphene_matrix_init_from_matrix (matrix, composed);
+  else
+    graphene_matrix_init_identity (matrix);
+
   return NULL;
 }
 
@@ -535,8 +582,27 @@ cogl_matrix_entry_calculate_translation (CoglMatrixEntry *entry0,
    *
    * If we come across any non-translation operations during 3) or 4)
    * then bail out returning FALSE.
+   *
+   * When both entries are pure translations all the way to the root,
+   * the difference of their composed matrices gives the same result
+   * without walking either chain.
    */
 
+  if (entry0->translation_only && entry1->translation_only)
+    {
+      graphene_point3d_t translation0;
+      graphene_point3d_t translation1;
+
+      if (_cogl_matrix_entry_get_translation (entry0, &translation0) &&
+          _cogl_matrix_entry_get_translation (entry1, &translation1))
+        {
+          *x = translation1.x - translation0.x;
+          *y = translation1.y - translation0.y;
+          *z = translation1.z - translation0.z;
+          return TRUE;
+        }
+    }
+
   for (node0 = entry0; node0; node0 = node0->parent)
     {
       GSList *link;
@@ -49,6 +49,9 @@ typedef struct _CoglOnscreenPrivate
                                * cogl_onscreen_swap_region() or
                                * cogl_onscreen_swap_buffers() */
   GQueue pending_frame_infos;
+
+  /* CoglFrameInfoGpuPhase of the frame being rendered */
+  GArray *pending_gpu_phases;
 } CoglOnscreenPrivate;
 
 static void
@@ -110,6 +113,15 @@ cogl_onscreen_dispose (GObject *object)
     g_object_unref (frame_info);
   g_queue_clear (&priv->pending_frame_infos);
 
+  if (priv->pending_gpu_phases)
+    {
+      CoglContext *context =
+        cogl_framebuffer_get_context (COGL_FRAMEBUFFER (onscreen));
+
+      _cogl_frame_info_clear_gpu_phases (context, priv->pending_gpu_phases);
+      g_clear_pointer (&priv->pending_gpu_phases, g_array_unref);
+    }
+
   G_OBJECT_CLASS (cogl_onscreen_parent_class)->dispose (object);
 }
 
@@ -295,6 +307,8 @@ cogl_onscreen_swap_buffers_with_damage (CoglOnscreen    *onscreen,
 
   klass->swap_buffers_with_damage (onscreen, region, info, user_data);
 
+  info->gpu_phases = g_steal_pointer (&priv->pending_gpu_phases);
+
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_SYNC_FRAME)))
     cogl_framebuffer_finish (framebuffer);
 
@@ -349,6 +363,8 @@ cogl_onscreen_swap_region (CoglOnscreen    *onscreen,
 
   klass->swap_region (onscreen, region, info, user_data);
 
+  info->gpu_phases = g_steal_pointer (&priv->pending_gpu_phases);
+
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_SYNC_FRAME)))
     cogl_framebuffer_finish (framebuffer);
 
@@ -513,6 +529,38 @@ cogl_onscreen_get_frame_counter (CoglOnscreen *onscreen)
   return priv->frame_counter;
 }
 
+const char *
+cogl_onscreen_begin_gpu_phase (CoglOnscreen    *onscreen,
+                               CoglFramebuffer *framebuffer,
+                               const char      *name)
+{
+  CoglOnscreenPrivate *priv = cogl_onscreen_get_instance_private (onscreen);
+  CoglContext *context = cogl_framebuffer_get_context (framebuffer);
+  CoglFrameInfoGpuPhase phase = { 0 };
+  const char *prev_name = NULL;
+
+  if (!cogl_context_has_feature (context, COGL_FEATURE_ID_TIMESTAMP_QUERY))
+    return NULL;
+
+  if (!priv->pending_gpu_phases)
+    {
+      priv->pending_gpu_phases =
+        g_array_new (FALSE, FALSE, sizeof (CoglFrameInfoGpuPhase));
+    }
+  else if (priv->pending_gpu_phases->len > 0)
+    {
+      prev_name = g_array_index (priv->pending_gpu_phases,
+                                 CoglFrameInfoGpuPhase,
+                                 priv->pending_gpu_phases->len - 1).name;
+    }
+
+  phase.name = name;
+  phase.query = cogl_framebuffer_create_timestamp_query (framebuffer);
+  g_array_append_val (priv->pending_gpu_phases, phase);
+
+  return prev_name;
+}
+
 gboolean
 cogl_onscreen_get_window_handles (CoglOnscreen *onscreen,
                                   gpointer     *device_out,
@@ -406,6 +406,31 @@ cogl_onscreen_remove_frame_callback (CoglOnscreen *onscreen,
 COGL_EXPORT int64_t
 cogl_onscreen_get_frame_counter (CoglOnscreen *onscreen);
 
+/**
+ * cogl_onscreen_begin_gpu_phase:
+ * @onscreen: A #CoglOnscreen framebuffer
+ * @framebuffer: The framebuffer currently being drawn to
+ * @name: A static string naming the phase
+ *
+ * Starts a named phase of the frame that will be swapped next, ending the
+ * previous phase, if any. GPU timestamps are taken at the start of each
+ * phase, so that the GPU time spent in it can be retrieved with
+ * cogl_frame_info_get_gpu_phase() once the frame completed.
+ *
+ * @framebuffer is the one commands are being recorded for, e.g. an offscreen
+ * framebuffer used for an effect, and is flushed so that the timestamp
+ * covers everything drawn to it before.
+ *
+ * Does nothing if timestamp queries aren't supported.
+ *
+ * Return value: (nullable): the name of the phase that was ended, so that
+ *   it can be continued once the new phase is done
+ */
+COGL_EXPORT const char *
+cogl_onscreen_begin_gpu_phase (CoglOnscreen    *onscreen,
+                               CoglFramebuffer *framebuffer,
+                               const char      *name);
+
 COGL_EXPORT gboolean
 cogl_onscreen_get_window_handles (CoglOnscreen *onscreen,
                                   gpointer     *device_out,
@@ -113,6 +113,22 @@ _cogl_pipeline_cache_get_combined_template (CoglPipelineCache *cache,
                                         key_pipeline);
 }
 
+unsigned int
+_cogl_pipeline_cache_get_n_entries (CoglPipelineCache *cache)
+{
+  return (g_hash_table_size (cache->fragment_hash.table) +
+          g_hash_table_size (cache->vertex_hash.table) +
+          g_hash_table_size (cache->combined_hash.table));
+}
+
+void
+_cogl_pipeline_cache_prune_unused (CoglPipelineCache *cache)
+{
+  _cogl_pipeline_hash_table_prune_unused (&cache->fragment_hash);
+  _cogl_pipeline_hash_table_prune_unused (&cache->vertex_hash);
+  _cogl_pipeline_hash_table_prune_unused (&cache->combined_hash);
+}
+
 CoglPipelineHashTable *
 cogl_pipeline_cache_get_fragment_hash (CoglPipelineCache *cache)
 {
@@ -88,3 +88,16 @@ _cogl_pipeline_cache_get_vertex_template (CoglPipelineCache *cache,
 CoglPipelineCacheEntry *
 _cogl_pipeline_cache_get_combined_template (CoglPipelineCache *cache,
                                             CoglPipeline *key_pipeline);
+
+/*
+ * Returns the number of template pipelines in all of the hashes
+ */
+unsigned int
+_cogl_pipeline_cache_get_n_entries (CoglPipelineCache *cache);
+
+/*
+ * Drops all of the template pipelines that no pipeline currently uses,
+ * together with the programs generated for them
+ */
+void
+_cogl_pipeline_cache_prune_unused (CoglPipelineCache *cache);
@@ -172,6 +172,24 @@ prune_old_pipelines (CoglPipelineHashTable *hash)
   g_list_free (entries.head);
 }
 
+static gboolean
+is_entry_unused_cb (void *key,
+                    void *value,
+                    void *user_data)
+{
+  CoglPipelineCacheEntry *entry = value;
+
+  return entry->usage_count == 0;
+}
+
+void
+_cogl_pipeline_hash_table_prune_unused (CoglPipelineHashTable *hash)
+{
+  g_hash_table_foreach_remove (hash->table, is_entry_unused_cb, NULL);
+
+  hash->expected_min_size = MAX (g_hash_table_size (hash->table), 8);
+}
+
 CoglPipelineCacheEntry *
 _cogl_pipeline_hash_table_get (CoglPipelineHashTable *hash,
                                CoglPipeline *key_pipeline)
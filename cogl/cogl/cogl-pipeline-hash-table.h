@@ -76,3 +76,11 @@ _cogl_pipeline_hash_table_destroy (CoglPipelineHashTable *hash);
 CoglPipelineCacheEntry *
 _cogl_pipeline_hash_table_get (CoglPipelineHashTable *hash,
                                CoglPipeline *key_pipeline);
+
+/*
+ * Removes all of the pipelines that are currently not used from the
+ * hash, unlike the pruning done when adding pipelines, which only
+ * removes the oldest half of them.
+ */
+void
+_cogl_pipeline_hash_table_prune_unused (CoglPipelineHashTable *hash);
@@ -1348,10 +1348,14 @@ _cogl_pipeline_layer_hash_sampler_state (CoglPipelineLayer *authority,
                                          CoglPipelineLayer **authorities,
                                          CoglPipelineHashState *state)
 {
+  /* Hash the sampler object consistently with
+   * _cogl_pipeline_layer_sampler_equal() */
+  GLuint sampler_object = authority->sampler_cache_entry->sampler_object;
+
   state->hash =
     _cogl_util_one_at_a_time_hash (state->hash,
-                                   &authority->sampler_cache_entry,
-                                   sizeof (authority->sampler_cache_entry));
+                                   &sampler_object,
+                                   sizeof (sampler_object));
 }
 
 void
@@ -230,6 +230,22 @@ typedef struct _CoglPipelineHashState
   unsigned int hash;
 } CoglPipelineHashState;
 
+/*
+ * The hashes of the individual sparse state groups of a pipeline, kept
+ * around so that pipelines can be told apart without walking their
+ * ancestry. The effective state of a pipeline can only change through
+ * _cogl_pipeline_pre_change_notify(), which is where the hashes of the
+ * changed groups are invalidated.
+ */
+typedef struct _CoglPipelineFingerprints
+{
+  /* A mask of the sparse state groups with a valid hash */
+  unsigned int valid_groups;
+  /* The layer state groups that the layers hash was computed with */
+  unsigned long layer_differences;
+  unsigned int group_hashes[COGL_PIPELINE_STATE_SPARSE_COUNT];
+} CoglPipelineFingerprints;
+
 /*
  * CoglPipelineDestroyCallback
  * @pipeline: The #CoglPipeline that has been destroyed
@@ -336,6 +352,10 @@ struct _CoglPipeline
    */
   GArray *capabilities;
 
+  /* Lazily allocated the first time the pipeline gets compared or
+   * hashed, see _cogl_pipeline_get_fingerprint() */
+  CoglPipelineFingerprints *fingerprints;
+
   /* bitfields */
 
   /* Weak pipelines don't count as dependants on their parents which
@@ -698,6 +718,18 @@ _cogl_pipeline_hash (CoglPipeline *pipeline,
                      unsigned int differences,
                      unsigned long layer_differences);
 
+/*
+ * Returns a 64-bit digest of the state groups in @differences, combined
+ * from the cached hashes of the individual groups. Pipelines that are
+ * equal for the given masks have the same fingerprint so it can be used
+ * to cheaply reject comparisons. The texture data of layers is never
+ * part of the fingerprint.
+ */
+uint64_t
+_cogl_pipeline_get_fingerprint (CoglPipeline *pipeline,
+                                unsigned int differences,
+                                unsigned long layer_differences);
+
 /* Makes a copy of the given pipeline that is a child of the root
  * pipeline rather than a child of the source pipeline. That way the
  * new pipeline won't hold a reference to the source pipeline. The
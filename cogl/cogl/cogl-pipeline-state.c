@@ -1256,12 +1256,7 @@ _cogl_pipeline_hash_blend_state (CoglPipeline *authority,
                                  CoglPipelineHashState *state)
 {
   CoglPipelineBlendState *blend_state = &authority->big_state->blend_state;
-  unsigned int hash;
-
-  if (!authority->real_blend_enable)
-    return;
-
-  hash = state->hash;
+  unsigned int hash = state->hash;
 
   hash =
     _cogl_util_one_at_a_time_hash (hash, &blend_state->blend_equation_rgb,
@@ -1310,22 +1305,23 @@ _cogl_pipeline_hash_depth_state (CoglPipeline *authority,
                                  CoglPipelineHashState *state)
 {
   CoglDepthState *depth_state = &authority->big_state->depth_state;
+  uint8_t enabled = depth_state->test_enabled;
   unsigned int hash = state->hash;
 
+  hash = _cogl_util_one_at_a_time_hash (hash, &enabled, sizeof (enabled));
+
+  /* Like _cogl_pipeline_depth_state_equal() the rest of the state is
+   * ignored when depth testing is disabled */
   if (depth_state->test_enabled)
     {
-      uint8_t enabled = depth_state->test_enabled;
       CoglDepthTestFunction function = depth_state->test_function;
-      hash = _cogl_util_one_at_a_time_hash (hash, &enabled, sizeof (enabled));
-      hash = _cogl_util_one_at_a_time_hash (hash, &function, sizeof (function));
-    }
-
-  if (depth_state->write_enabled)
-    {
-      uint8_t enabled = depth_state->write_enabled;
+      uint8_t write_enabled = depth_state->write_enabled;
       float near_val = depth_state->range_near;
       float far_val = depth_state->range_far;
-      hash = _cogl_util_one_at_a_time_hash (hash, &enabled, sizeof (enabled));
+
+      hash = _cogl_util_one_at_a_time_hash (hash, &function, sizeof (function));
+      hash = _cogl_util_one_at_a_time_hash (hash, &write_enabled,
+                                            sizeof (write_enabled));
       hash = _cogl_util_one_at_a_time_hash (hash, &near_val, sizeof (near_val));
       hash = _cogl_util_one_at_a_time_hash (hash, &far_val, sizeof (far_val));
     }
@@ -197,6 +197,7 @@ cogl_pipeline_dispose (GObject *object)
   recursively_free_layer_caches (pipeline);
 
   g_clear_pointer (&pipeline->capabilities, g_array_unref);
+  g_clear_pointer (&pipeline->fingerprints, g_free);
 
   G_OBJECT_CLASS (cogl_pipeline_parent_class)->dispose (object);
 }
@@ -1269,6 +1270,9 @@ _cogl_pipeline_pre_change_notify (CoglPipeline     *pipeline,
 
   pipeline->age++;
 
+  if (pipeline->fingerprints)
+    pipeline->fingerprints->valid_groups &= ~change;
+
   if (change & COGL_PIPELINE_STATE_NEEDS_BIG_STATE &&
       !pipeline->has_big_state)
     {
@@ -2092,6 +2096,14 @@ _cogl_pipeline_equal (CoglPipeline *pipeline0,
       pipeline0->real_blend_enable != pipeline1->real_blend_enable)
     goto done;
 
+  /* Pipelines that differ usually already differ in one of the cached
+   * group hashes, which avoids walking their ancestry */
+  if (_cogl_pipeline_get_fingerprint (pipeline0, differences,
+                                      layer_differences) !=
+      _cogl_pipeline_get_fingerprint (pipeline1, differences,
+                                      layer_differences))
+    goto done;
+
   /* Then check sparse properties */
 
   pipelines_difference =
@@ -2540,20 +2552,96 @@ _cogl_pipeline_init_state_hash_functions (void)
   }
 }
 
+/* The uniforms can't be hashed and the texture data of layers is
+ * hashed using the GL texture, which can change without the pipeline
+ * being notified, e.g. when an atlas gets reorganized */
+#define CACHEABLE_STATE_GROUPS \
+  (COGL_PIPELINE_STATE_ALL_SPARSE & ~COGL_PIPELINE_STATE_UNIFORMS)
+#define CACHEABLE_LAYER_STATE_GROUPS \
+  (COGL_PIPELINE_LAYER_STATE_ALL_SPARSE & \
+   ~COGL_PIPELINE_LAYER_STATE_TEXTURE_DATA)
+
+static unsigned int
+hash_state_group (CoglPipeline  *authority,
+                  int            group,
+                  unsigned long  layer_differences)
+{
+  CoglPipelineHashState state;
+
+  state.hash = 0;
+  state.layer_differences = layer_differences;
+  state_hash_functions[group] (authority, &state);
+
+  return state.hash;
+}
+
+static gboolean
+has_cached_group_hash (CoglPipeline  *pipeline,
+                       int            group,
+                       unsigned long  layer_differences)
+{
+  CoglPipelineFingerprints *fingerprints = pipeline->fingerprints;
+
+  if (!fingerprints || !(fingerprints->valid_groups & (1 << group)))
+    return FALSE;
+
+  if (group == COGL_PIPELINE_STATE_LAYERS_INDEX &&
+      fingerprints->layer_differences != layer_differences)
+    return FALSE;
+
+  return TRUE;
+}
+
+static unsigned int
+get_state_group_hash (CoglPipeline  *pipeline,
+                      int            group,
+                      unsigned long  layer_differences)
+{
+  CoglPipelineFingerprints *fingerprints;
+  CoglPipeline *authority;
+  unsigned int hash;
+
+  if (!(CACHEABLE_STATE_GROUPS & (1 << group)) ||
+      (group == COGL_PIPELINE_STATE_LAYERS_INDEX &&
+       layer_differences & ~CACHEABLE_LAYER_STATE_GROUPS))
+    {
+      authority = _cogl_pipeline_get_authority (pipeline, 1 << group);
+      return hash_state_group (authority, group, layer_differences);
+    }
+
+  if (has_cached_group_hash (pipeline, group, layer_differences))
+    return pipeline->fingerprints->group_hashes[group];
+
+  /* Copies share the hashes of the state they inherit */
+  authority = _cogl_pipeline_get_authority (pipeline, 1 << group);
+  if (authority != pipeline &&
+      has_cached_group_hash (authority, group, layer_differences))
+    hash = authority->fingerprints->group_hashes[group];
+  else
+    hash = hash_state_group (authority, group, layer_differences);
+
+  if (!pipeline->fingerprints)
+    pipeline->fingerprints = g_new0 (CoglPipelineFingerprints, 1);
+
+  fingerprints = pipeline->fingerprints;
+  fingerprints->group_hashes[group] = hash;
+  fingerprints->valid_groups |= 1 << group;
+  if (group == COGL_PIPELINE_STATE_LAYERS_INDEX)
+    fingerprints->layer_differences = layer_differences;
+
+  return hash;
+}
+
 unsigned int
 _cogl_pipeline_hash (CoglPipeline *pipeline,
                      unsigned int differences,
                      unsigned long layer_differences)
 {
-  CoglPipeline *authorities[COGL_PIPELINE_STATE_SPARSE_COUNT];
-  unsigned int mask;
-  int i;
-  CoglPipelineHashState state;
+  unsigned long mask;
+  int bit;
+  unsigned int hash = 0;
   unsigned int final_hash = 0;
 
-  state.hash = 0;
-  state.layer_differences = layer_differences;
-
   _cogl_pipeline_update_real_blend_enable (pipeline, FALSE);
 
   /* hash non-sparse state */
@@ -2561,38 +2649,74 @@ _cogl_pipeline_hash (CoglPipeline *pipeline,
   if (differences & COGL_PIPELINE_STATE_REAL_BLEND_ENABLE)
     {
       gboolean enable = pipeline->real_blend_enable;
-      state.hash =
-        _cogl_util_one_at_a_time_hash (state.hash, &enable, sizeof (enable));
+      hash = _cogl_util_one_at_a_time_hash (hash, &enable, sizeof (enable));
     }
 
   /* hash sparse state */
 
   mask = differences & COGL_PIPELINE_STATE_ALL_SPARSE;
-  _cogl_pipeline_resolve_authorities (pipeline, mask, authorities);
 
-  for (i = 0; i < COGL_PIPELINE_STATE_SPARSE_COUNT; i++)
-    {
-      unsigned int current_state = (1<<i);
+  /* The blend state is irrelevant if blending is disabled */
+  if (!pipeline->real_blend_enable)
+    mask &= ~COGL_PIPELINE_STATE_BLEND;
 
-      /* XXX: we are hashing the un-mixed hash values of all the
-       * individual state groups; we should provide a means to test
-       * the quality of the final hash values we are getting with this
-       * approach... */
-      if (differences & current_state)
-        {
-          CoglPipeline *authority = authorities[i];
-          state_hash_functions[i] (authority, &state);
-          final_hash = _cogl_util_one_at_a_time_hash (final_hash, &state.hash,
-                                                      sizeof (state.hash));
-        }
+  COGL_FLAGS_FOREACH_START (&mask, 1, bit)
+    {
+      unsigned int group_hash;
 
-      if (current_state > differences)
-        break;
+      group_hash = get_state_group_hash (pipeline, bit, layer_differences);
+      hash = _cogl_util_one_at_a_time_hash (hash, &group_hash,
+                                            sizeof (group_hash));
+      final_hash = _cogl_util_one_at_a_time_hash (final_hash, &hash,
+                                                  sizeof (hash));
     }
+  COGL_FLAGS_FOREACH_END;
 
   return _cogl_util_one_at_a_time_mix (final_hash);
 }
 
+static inline uint64_t
+fingerprint_mix (uint64_t     fingerprint,
+                 unsigned int value)
+{
+  /* An FNV-1a step over the 32-bit group hashes */
+  return (fingerprint ^ value) * G_GUINT64_CONSTANT (0x100000001b3);
+}
+
+uint64_t
+_cogl_pipeline_get_fingerprint (CoglPipeline *pipeline,
+                                unsigned int differences,
+                                unsigned long layer_differences)
+{
+  uint64_t fingerprint = G_GUINT64_CONSTANT (0xcbf29ce484222325);
+  unsigned long mask;
+  int bit;
+
+  _cogl_pipeline_update_real_blend_enable (pipeline, FALSE);
+
+  layer_differences &= CACHEABLE_LAYER_STATE_GROUPS;
+  mask = differences & CACHEABLE_STATE_GROUPS;
+
+  /* Mirror _cogl_pipeline_equal(), which only compares the blend state
+   * once the pipelines are known to both have blending enabled */
+  if (differences & COGL_PIPELINE_STATE_REAL_BLEND_ENABLE)
+    fingerprint = fingerprint_mix (fingerprint, pipeline->real_blend_enable);
+  if (!(differences & COGL_PIPELINE_STATE_REAL_BLEND_ENABLE) ||
+      !pipeline->real_blend_enable)
+    mask &= ~COGL_PIPELINE_STATE_BLEND;
+
+  COGL_FLAGS_FOREACH_START (&mask, 1, bit)
+    {
+      fingerprint =
+        fingerprint_mix (fingerprint,
+                         get_state_group_hash (pipeline, bit,
+                                               layer_differences));
+    }
+  COGL_FLAGS_FOREACH_END;
+
+  return fingerprint;
+}
+
 typedef struct
 {
   CoglContext *context;
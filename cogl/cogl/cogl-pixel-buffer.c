@@ -49,6 +49,10 @@
 #include "cogl/cogl-pixel-buffer-private.h"
 #include "cogl/cogl-pixel-buffer.h"
 
+#define UPLOAD_BUFFER_MIN_SIZE (4 * 1024 * 1024)
+/* Keep every range suitably aligned for any pixel format */
+#define ALIGN_UPLOAD_OFFSET(offset) (((offset) + 63) & ~((size_t) 63))
+
 G_DEFINE_FINAL_TYPE (CoglPixelBuffer, cogl_pixel_buffer, COGL_TYPE_BUFFER)
 
 static void
@@ -89,3 +93,61 @@ cogl_pixel_buffer_new (CoglContext *context,
 
   return pixel_buffer;
 }
+
+CoglPixelBuffer *
+cogl_context_map_upload_range (CoglContext  *context,
+                               size_t        size,
+                               size_t       *offset_out,
+                               void        **data_out,
+                               GError      **error)
+{
+  CoglBuffer *buffer;
+  CoglBufferMapHint hints;
+  size_t offset;
+  void *data;
+
+  g_return_val_if_fail (size > 0, NULL);
+
+  if (context->upload_buffer &&
+      cogl_buffer_get_size (COGL_BUFFER (context->upload_buffer)) < size)
+    g_clear_object (&context->upload_buffer);
+
+  if (!context->upload_buffer)
+    {
+      size_t buffer_size = UPLOAD_BUFFER_MIN_SIZE;
+
+      while (buffer_size < size)
+        buffer_size *= 2;
+
+      context->upload_buffer = cogl_pixel_buffer_new (context, buffer_size,
+                                                      NULL);
+      cogl_buffer_set_update_hint (COGL_BUFFER (context->upload_buffer),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+      context->upload_buffer_offset = 0;
+    }
+
+  buffer = COGL_BUFFER (context->upload_buffer);
+  offset = ALIGN_UPLOAD_OFFSET (context->upload_buffer_offset);
+
+  if (offset == 0 || offset + size > cogl_buffer_get_size (buffer))
+    {
+      offset = 0;
+      hints = COGL_BUFFER_MAP_HINT_DISCARD;
+    }
+  else
+    {
+      hints = COGL_BUFFER_MAP_HINT_DISCARD_RANGE;
+    }
+
+  data = cogl_buffer_map_range (buffer, offset, size,
+                                COGL_BUFFER_ACCESS_WRITE, hints,
+                                error);
+  if (!data)
+    return NULL;
+
+  context->upload_buffer_offset = offset + size;
+
+  *offset_out = offset;
+  *data_out = data;
+  return g_object_ref (context->upload_buffer);
+}
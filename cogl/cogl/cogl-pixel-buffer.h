@@ -85,4 +85,33 @@ cogl_pixel_buffer_new (CoglContext *context,
                        size_t       size,
                        const void  *data);
 
+/**
+ * cogl_context_map_upload_range:
+ * @context: A #CoglContext
+ * @size: The number of bytes to reserve
+ * @offset_out: (out): Return location for the offset of the reserved range
+ * @data_out: (out): Return location for the mapped range
+ * @error: A #GError for exceptions
+ *
+ * Reserves @size bytes for staging pixel data in a streaming pixel buffer
+ * shared by all uploads of @context, and maps them for writing. Pixels
+ * can be written straight to @data_out, after which the buffer must be
+ * unmapped with cogl_buffer_unmap() before reserving the next range. The
+ * range can then be uploaded using bitmaps created with
+ * cogl_bitmap_new_from_buffer() at offsets starting from @offset_out.
+ *
+ * Ranges are handed out one after another, and the buffer storage is
+ * only discarded once it wraps around, so mapping never waits for
+ * uploads from previous ranges that are still in flight.
+ *
+ * Return value: (transfer full) (nullable): The #CoglPixelBuffer the range
+ *   was reserved in, or %NULL if it couldn't be mapped
+ */
+COGL_EXPORT CoglPixelBuffer *
+cogl_context_map_upload_range (CoglContext  *context,
+                               size_t        size,
+                               size_t       *offset_out,
+                               void        **data_out,
+                               GError      **error);
+
 G_END_DECLS
@@ -49,6 +49,8 @@ struct _CoglScanout
   gboolean has_src_rect;
   graphene_rect_t src_rect;
   MtkRectangle dst_rect;
+
+  gboolean allow_tearing;
 };
 
 G_DEFINE_FINAL_TYPE (CoglScanout, cogl_scanout, G_TYPE_OBJECT);
@@ -150,6 +152,19 @@ cogl_scanout_get_dst_rect (CoglScanout  *scanout,
   *dst_rect = scanout->dst_rect;
 }
 
+void
+cogl_scanout_set_allow_tearing (CoglScanout *scanout,
+                                gboolean     allow_tearing)
+{
+  scanout->allow_tearing = allow_tearing;
+}
+
+gboolean
+cogl_scanout_get_allow_tearing (CoglScanout *scanout)
+{
+  return scanout->allow_tearing;
+}
+
 static void
 cogl_scanout_finalize (GObject *object)
 {
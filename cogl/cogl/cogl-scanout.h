@@ -95,3 +95,16 @@ void cogl_scanout_set_src_rect (CoglScanout           *scanout,
 COGL_EXPORT
 void cogl_scanout_get_dst_rect (CoglScanout  *scanout,
                                 MtkRectangle *dst_rect);
+
+/**
+ * cogl_scanout_set_allow_tearing:
+ *
+ * Lets the scanout be presented as soon as possible instead of on the
+ * next vertical blank, if supported.
+ */
+COGL_EXPORT
+void cogl_scanout_set_allow_tearing (CoglScanout *scanout,
+                                     gboolean     allow_tearing);
+
+COGL_EXPORT
+gboolean cogl_scanout_get_allow_tearing (CoglScanout *scanout);
@@ -215,20 +215,27 @@ setup_spans (CoglContext *ctx,
     }
   else
     {
-      /* Decrease the size of largest slice until supported by GL */
+      int n_x_spans = 1;
+      int n_y_spans = 1;
+
+      /* Split the texture into more, evenly sized slices until they are
+       * supported by GL. Splitting the larger slice dimension one slice
+       * at a time, rather than halving it, keeps the number of slices,
+       * and the number of separate draws needed to paint them, as small
+       * as possible. */
       while (!tex_driver->texture_2d_can_create (ctx->texture_driver,
                                                  ctx,
                                                  max_width,
                                                  max_height,
                                                  internal_format))
         {
-          /* Alternate between width and height */
-          if (max_width > max_height)
-            max_width /= 2;
-          else
-            max_height /= 2;
-
-          if (max_width == 0 || max_height == 0)
+          /* Bail out early when no size at all can be created, e.g.
+           * because of the format, rather than after trying every split */
+          if ((max_width == 1 && max_height == 1) ||
+              (n_x_spans == 1 && n_y_spans == 1 &&
+               !tex_driver->texture_2d_can_create (ctx->texture_driver,
+                                                   ctx, 1, 1,
+                                                   internal_format)))
             {
               /* Maybe it would be ok to just g_warn_if_reached() for this
                * codepath */
@@ -237,6 +244,18 @@ setup_spans (CoglContext *ctx,
               free_spans (tex_2ds);
               return FALSE;
             }
+
+          /* Alternate between width and height */
+          if (max_width > max_height)
+            {
+              n_x_spans++;
+              max_width = (width + n_x_spans - 1) / n_x_spans;
+            }
+          else
+            {
+              n_y_spans++;
+              max_height = (height + n_y_spans - 1) / n_y_spans;
+            }
         }
 
       /* Determine the slices required to cover the bitmap area */
@@ -494,6 +494,11 @@ cogl_texture_2d_new_from_egl_image (CoglContext *ctx,
                         COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE),
                         NULL);
 
+  g_return_val_if_fail (!(flags & COGL_EGL_IMAGE_FLAG_EXTERNAL) ||
+                        cogl_context_has_feature
+                        (ctx, COGL_FEATURE_ID_TEXTURE_EGL_IMAGE_EXTERNAL),
+                        NULL);
+
   loader = _cogl_texture_create_loader ();
   loader->src_type = COGL_TEXTURE_SOURCE_TYPE_EGL_IMAGE;
   loader->src.egl_image.image = image;
@@ -72,6 +72,11 @@ typedef enum _CoglEglImageFlags
 {
   COGL_EGL_IMAGE_FLAG_NONE = 0,
   COGL_EGL_IMAGE_FLAG_NO_GET_DATA = 1 << 0,
+  /* Bind the image to GL_TEXTURE_EXTERNAL_OES, letting the driver
+   * convert e.g. YUV images while sampling. Requires
+   * COGL_FEATURE_ID_TEXTURE_EGL_IMAGE_EXTERNAL, and fragments sampling
+   * the texture must use a samplerExternalOES. */
+  COGL_EGL_IMAGE_FLAG_EXTERNAL = 1 << 1,
 } CoglEglImageFlags;
 
 /**
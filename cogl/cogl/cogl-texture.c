@@ -1190,6 +1190,8 @@ cogl_texture_allocate (CoglTexture *texture,
                  "does not support them");
 
   priv->allocated = COGL_TEXTURE_GET_CLASS (texture)->allocate (texture, error);
+  if (priv->allocated)
+    priv->context->render_stats.n_texture_allocations++;
 
   return priv->allocated;
 }
@@ -31,6 +31,8 @@
 
 #ifdef HAVE_PROFILER
 
+#include <fcntl.h>
+#include <glib/gstdio.h>
 #include <sysprof-capture.h>
 #include <sysprof-capture-writer.h>
 #include <sysprof-clock.h>
@@ -43,20 +45,81 @@
 
 #define CATEGORY "mutter"
 
+/* Number of trace points kept per thread by the flight recorder, must be a
+ * power of two */
+#define FLIGHT_RECORDER_RING_SIZE 16384
+#define FLIGHT_RECORDER_MIN_DUMP_INTERVAL_US (G_USEC_PER_SEC * 10)
+
 struct _CoglTraceContext
 {
   gatomicrefcount ref_count;
   SysprofCaptureWriter *writer;
 };
 
+typedef struct _CoglTraceRingEntry
+{
+  int64_t begin_time_ns;
+  int64_t duration_ns;
+  const char *name;
+  char description[40];
+} CoglTraceRingEntry;
+
+/*
+ * Trace points of a thread recorded by the flight recorder. Only the thread
+ * itself writes to the ring, and publishes entries by advancing the head,
+ * so recording never takes a lock. Readers copy the ring and drop whatever
+ * may have been overwritten while copying.
+ */
+typedef struct _CoglTraceRing
+{
+  char *group;
+  guint head;
+  CoglTraceRingEntry entries[FLIGHT_RECORDER_RING_SIZE];
+} CoglTraceRing;
+
 typedef struct _CoglTraceThreadContext
 {
   int cpu_id;
   GPid pid;
   char *group;
   CoglTraceContext *trace_context;
+  CoglTraceRing *ring;
 } CoglTraceThreadContext;
 
+typedef struct _CoglFlightRecorderAnnotation
+{
+  unsigned int id;
+  const char *name;
+  CoglFlightRecorderAnnotationFunc func;
+  gpointer user_data;
+} CoglFlightRecorderAnnotation;
+
+typedef struct _CoglFlightRecorder
+{
+  GMutex mutex;
+  gboolean running;
+  char *dump_dir;
+  int64_t duration_us;
+  int64_t last_dump_time_us;
+  GList *rings;
+
+  GList *annotations;
+  unsigned int last_annotation_id;
+} CoglFlightRecorder;
+
+typedef struct _CoglFlightRecorderDump
+{
+  int fd;
+  char *reason;
+  int64_t time_ns;
+  GPtrArray *groups;
+  GArray *entries;
+  GArray *entry_groups;
+
+  GPtrArray *annotation_names;
+  GPtrArray *annotations;
+} CoglFlightRecorderDump;
+
 typedef struct
 {
   char *group;
@@ -81,6 +144,8 @@ GPrivate cogl_trace_thread_data = G_PRIVATE_INIT (cogl_trace_thread_context_free
 CoglTraceContext *cogl_trace_context;
 GMutex cogl_trace_mutex;
 
+static CoglFlightRecorder flight_recorder;
+
 static CoglTraceContext *
 cogl_trace_context_new (int         fd,
                         const char *filename)
@@ -173,7 +238,8 @@ cogl_trace_thread_context_new (const char       *group,
   thread_context->pid = getpid ();
   thread_context->group =
     group ? g_strdup (group) : g_strdup_printf ("t:%d", tid);
-  thread_context->trace_context = cogl_trace_context_ref (trace_context);
+  if (trace_context)
+    thread_context->trace_context = cogl_trace_context_ref (trace_context);
 
   return thread_context;
 }
@@ -185,12 +251,20 @@ enable_tracing_idle_callback (gpointer user_data)
     g_private_get (&cogl_trace_thread_data);
   TraceData *data = user_data;
 
-  if (thread_context)
+  if (thread_context && thread_context->trace_context)
     {
       g_warning ("Tracing already enabled");
       return G_SOURCE_REMOVE;
     }
 
+  if (thread_context)
+    {
+      /* The flight recorder is running on this thread */
+      thread_context->trace_context =
+        cogl_trace_context_ref (data->trace_context);
+      return G_SOURCE_REMOVE;
+    }
+
   thread_context = cogl_trace_thread_context_new (data->group,
                                                   data->trace_context);
   g_private_set (&cogl_trace_thread_data, thread_context);
@@ -198,6 +272,17 @@ enable_tracing_idle_callback (gpointer user_data)
   return G_SOURCE_REMOVE;
 }
 
+static void
+cogl_trace_ring_free (CoglTraceRing *ring)
+{
+  g_mutex_lock (&flight_recorder.mutex);
+  flight_recorder.rings = g_list_remove (flight_recorder.rings, ring);
+  g_mutex_unlock (&flight_recorder.mutex);
+
+  g_free (ring->group);
+  g_free (ring);
+}
+
 static void
 cogl_trace_thread_context_free (gpointer data)
 {
@@ -206,6 +291,7 @@ cogl_trace_thread_context_free (gpointer data)
   if (!thread_context)
     return;
 
+  g_clear_pointer (&thread_context->ring, cogl_trace_ring_free);
   g_free (thread_context->group);
   g_free (thread_context);
 }
@@ -216,12 +302,20 @@ disable_tracing_idle_callback (gpointer user_data)
   CoglTraceThreadContext *thread_context =
     g_private_get (&cogl_trace_thread_data);
 
-  if (!thread_context)
+  if (!thread_context || !thread_context->trace_context)
     {
       g_warning ("Tracing not enabled");
       return G_SOURCE_REMOVE;
     }
 
+  if (thread_context->ring)
+    {
+      /* Keep the flight recorder running on this thread */
+      g_clear_pointer (&thread_context->trace_context,
+                       cogl_trace_context_unref);
+      return G_SOURCE_REMOVE;
+    }
+
   g_private_replace (&cogl_trace_thread_data, NULL);
 
   return G_SOURCE_REMOVE;
@@ -301,6 +395,28 @@ cogl_set_tracing_disabled_on_thread (GMainContext *main_context)
     }
 }
 
+static void
+cogl_trace_ring_add (CoglTraceRing *ring,
+                     int64_t        begin_time_ns,
+                     int64_t        duration_ns,
+                     const char    *name,
+                     const char    *description)
+{
+  guint head = ring->head;
+  CoglTraceRingEntry *entry;
+
+  entry = &ring->entries[head & (FLIGHT_RECORDER_RING_SIZE - 1)];
+  entry->begin_time_ns = begin_time_ns;
+  entry->duration_ns = duration_ns;
+  entry->name = name;
+  if (description)
+    g_strlcpy (entry->description, description, sizeof (entry->description));
+  else
+    entry->description[0] = '\0';
+
+  g_atomic_int_set (&ring->head, head + 1);
+}
+
 static void
 cogl_trace_end_with_description (CoglTraceHead *head,
                                  const char    *description)
@@ -313,6 +429,18 @@ cogl_trace_end_with_description (CoglTraceHead *head,
   trace_thread_context = g_private_get (&cogl_trace_thread_data);
   trace_context = trace_thread_context->trace_context;
 
+  if (trace_thread_context->ring)
+    {
+      cogl_trace_ring_add (trace_thread_context->ring,
+                           head->begin_time,
+                           end_time - head->begin_time,
+                           head->name,
+                           description);
+    }
+
+  if (!trace_context)
+    return;
+
   g_mutex_lock (&cogl_trace_mutex);
   if (!sysprof_capture_writer_add_mark (trace_context->writer,
                                         head->begin_time,
@@ -344,20 +472,43 @@ void
 cogl_trace_mark (const char *name,
                  const char *description)
 {
-  SysprofTimeStamp time;
+  cogl_trace_mark_range (name, description,
+                         g_get_monotonic_time () * 1000, 0);
+}
+
+/*
+ * Adds a mark for something that didn't happen on the calling thread while
+ * it was running, e.g. work done by the GPU, given its own begin time on the
+ * monotonic clock.
+ */
+void
+cogl_trace_mark_range (const char *name,
+                       const char *description,
+                       int64_t     begin_time_ns,
+                       int64_t     duration_ns)
+{
   CoglTraceContext *trace_context;
   CoglTraceThreadContext *trace_thread_context;
 
-  time = g_get_monotonic_time () * 1000;
   trace_thread_context = g_private_get (&cogl_trace_thread_data);
   trace_context = trace_thread_context->trace_context;
 
+  if (trace_thread_context->ring)
+    {
+      cogl_trace_ring_add (trace_thread_context->ring,
+                           begin_time_ns, duration_ns,
+                           name, description);
+    }
+
+  if (!trace_context)
+    return;
+
   g_mutex_lock (&cogl_trace_mutex);
   if (!sysprof_capture_writer_add_mark (trace_context->writer,
-                                        time,
+                                        begin_time_ns,
                                         trace_thread_context->cpu_id,
                                         trace_thread_context->pid,
-                                        0,
+                                        duration_ns,
                                         trace_thread_context->group,
                                         name,
                                         description))
@@ -395,10 +546,15 @@ cogl_trace_set_counter (unsigned int                counter,
   CoglTraceContext *trace_context;
   CoglTraceThreadContext *trace_thread_context;
 
-  time = g_get_monotonic_time () * 1000;
   trace_thread_context = g_private_get (&cogl_trace_thread_data);
   trace_context = trace_thread_context->trace_context;
 
+  /* Counters are not kept by the flight recorder */
+  if (!trace_context)
+    return;
+
+  time = g_get_monotonic_time () * 1000;
+
   g_mutex_lock (&cogl_trace_mutex);
 
   if (!sysprof_capture_writer_set_counters (trace_context->writer,
@@ -455,6 +611,8 @@ cogl_trace_define_counter (const char *name,
   trace_thread_context = g_private_get (&cogl_trace_thread_data);
   trace_context = trace_thread_context->trace_context;
 
+  g_return_val_if_fail (trace_context, 0);
+
   counter.id = sysprof_capture_writer_request_counter (trace_context->writer, 1);
   counter.type = type;
 
@@ -503,6 +661,425 @@ cogl_trace_define_counter_double (const char *name,
                                     SYSPROF_CAPTURE_COUNTER_DOUBLE);
 }
 
+gboolean
+cogl_is_capturing_traces (void)
+{
+  CoglTraceThreadContext *trace_thread_context =
+    g_private_get (&cogl_trace_thread_data);
+
+  return trace_thread_context && trace_thread_context->trace_context;
+}
+
+/*
+ * The flight recorder keeps the trace points of the last @duration_us of
+ * the threads it is enabled on in memory, without a capture being started.
+ * They are written to a capture when a dump is requested, either to a
+ * given file descriptor, or to a new file in @dump_dir.
+ */
+void
+cogl_start_flight_recorder (const char *dump_dir,
+                            int64_t     duration_us)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+
+  locker = g_mutex_locker_new (&flight_recorder.mutex);
+  g_return_if_fail (!flight_recorder.running);
+
+  flight_recorder.running = TRUE;
+  flight_recorder.dump_dir = g_strdup (dump_dir);
+  flight_recorder.duration_us = duration_us;
+  flight_recorder.last_dump_time_us = 0;
+}
+
+void
+cogl_stop_flight_recorder (void)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+
+  locker = g_mutex_locker_new (&flight_recorder.mutex);
+  flight_recorder.running = FALSE;
+  g_clear_pointer (&flight_recorder.dump_dir, g_free);
+}
+
+static gboolean
+enable_flight_recorder_idle_callback (gpointer user_data)
+{
+  CoglTraceThreadContext *thread_context =
+    g_private_get (&cogl_trace_thread_data);
+  const char *group = user_data;
+  CoglTraceRing *ring;
+
+  if (thread_context && thread_context->ring)
+    {
+      g_warning ("Flight recorder already enabled");
+      return G_SOURCE_REMOVE;
+    }
+
+  if (!thread_context)
+    {
+      thread_context = cogl_trace_thread_context_new (group, NULL);
+      g_private_set (&cogl_trace_thread_data, thread_context);
+    }
+
+  ring = g_new0 (CoglTraceRing, 1);
+  ring->group = g_strdup (thread_context->group);
+  thread_context->ring = ring;
+
+  g_mutex_lock (&flight_recorder.mutex);
+  flight_recorder.rings = g_list_prepend (flight_recorder.rings, ring);
+  g_mutex_unlock (&flight_recorder.mutex);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+disable_flight_recorder_idle_callback (gpointer user_data)
+{
+  CoglTraceThreadContext *thread_context =
+    g_private_get (&cogl_trace_thread_data);
+
+  if (!thread_context || !thread_context->ring)
+    {
+      g_warning ("Flight recorder not enabled");
+      return G_SOURCE_REMOVE;
+    }
+
+  if (thread_context->trace_context)
+    g_clear_pointer (&thread_context->ring, cogl_trace_ring_free);
+  else
+    g_private_replace (&cogl_trace_thread_data, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+invoke_on_main_context (GMainContext   *main_context,
+                        GSourceFunc     func,
+                        gpointer        user_data,
+                        GDestroyNotify  destroy)
+{
+  if (main_context == g_main_context_get_thread_default ())
+    {
+      func (user_data);
+      if (destroy)
+        destroy (user_data);
+    }
+  else
+    {
+      GSource *source;
+
+      source = g_idle_source_new ();
+      g_source_set_callback (source, func, user_data, destroy);
+      g_source_attach (source, main_context);
+      g_source_unref (source);
+    }
+}
+
+void
+cogl_set_flight_recorder_enabled_on_thread (GMainContext *main_context,
+                                            const char   *group)
+{
+  invoke_on_main_context (main_context,
+                          enable_flight_recorder_idle_callback,
+                          g_strdup (group),
+                          g_free);
+}
+
+void
+cogl_set_flight_recorder_disabled_on_thread (GMainContext *main_context)
+{
+  invoke_on_main_context (main_context,
+                          disable_flight_recorder_idle_callback,
+                          NULL, NULL);
+}
+
+static void
+snapshot_ring (CoglTraceRing          *ring,
+               int64_t                 min_time_ns,
+               CoglFlightRecorderDump *dump)
+{
+  g_autofree CoglTraceRingEntry *entries = NULL;
+  guint first, head, valid_head;
+  guint n_entries, n_overwritten;
+  guint group_index;
+  guint i;
+
+  head = g_atomic_int_get (&ring->head);
+  n_entries = MIN (head, FLIGHT_RECORDER_RING_SIZE);
+  first = head - n_entries;
+
+  entries = g_new (CoglTraceRingEntry, n_entries);
+  for (i = 0; i < n_entries; i++)
+    entries[i] = ring->entries[(first + i) & (FLIGHT_RECORDER_RING_SIZE - 1)];
+
+  /* The owning thread kept recording while the entries were copied; drop
+   * the ones it may have overwritten, including the one it may have been
+   * in the middle of writing. */
+  valid_head = g_atomic_int_get (&ring->head);
+  n_overwritten = 0;
+  if (valid_head - first >= FLIGHT_RECORDER_RING_SIZE)
+    n_overwritten = valid_head - first - FLIGHT_RECORDER_RING_SIZE + 1;
+
+  g_ptr_array_add (dump->groups, g_strdup (ring->group));
+  group_index = dump->groups->len - 1;
+
+  for (i = n_overwritten; i < n_entries; i++)
+    {
+      if (entries[i].begin_time_ns < min_time_ns)
+        continue;
+
+      g_array_append_val (dump->entries, entries[i]);
+      g_array_append_val (dump->entry_groups, group_index);
+    }
+}
+
+static void
+flight_recorder_dump_free (CoglFlightRecorderDump *dump)
+{
+  if (dump->fd != -1)
+    close (dump->fd);
+  g_free (dump->reason);
+  g_ptr_array_unref (dump->groups);
+  g_array_unref (dump->entries);
+  g_array_unref (dump->entry_groups);
+  g_ptr_array_unref (dump->annotation_names);
+  g_ptr_array_unref (dump->annotations);
+  g_free (dump);
+}
+
+static CoglFlightRecorderDump *
+flight_recorder_dump_new (int         fd,
+                          const char *reason)
+{
+  CoglFlightRecorderDump *dump;
+  int64_t min_time_ns;
+  GList *l;
+
+  dump = g_new0 (CoglFlightRecorderDump, 1);
+  dump->fd = fd;
+  dump->reason = g_strdup (reason);
+  dump->time_ns = g_get_monotonic_time () * 1000;
+  dump->groups = g_ptr_array_new_with_free_func (g_free);
+  dump->entries = g_array_new (FALSE, FALSE, sizeof (CoglTraceRingEntry));
+  dump->entry_groups = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  dump->annotation_names = g_ptr_array_new ();
+  dump->annotations = g_ptr_array_new_with_free_func (g_free);
+
+  min_time_ns = dump->time_ns - flight_recorder.duration_us * 1000;
+
+  for (l = flight_recorder.rings; l; l = l->next)
+    snapshot_ring (l->data, min_time_ns, dump);
+
+  for (l = flight_recorder.annotations; l; l = l->next)
+    {
+      CoglFlightRecorderAnnotation *annotation = l->data;
+      char *text;
+
+      text = annotation->func (annotation->user_data);
+      if (!text)
+        continue;
+
+      g_ptr_array_add (dump->annotation_names, (gpointer) annotation->name);
+      g_ptr_array_add (dump->annotations, text);
+    }
+
+  return dump;
+}
+
+static gpointer
+write_flight_recorder_dump (gpointer user_data)
+{
+  CoglFlightRecorderDump *dump = user_data;
+  SysprofCaptureWriter *writer;
+  GPid pid = getpid ();
+  guint i;
+
+  writer = sysprof_capture_writer_new_from_fd (dump->fd, BUFFER_LENGTH);
+  if (!writer)
+    {
+      g_warning ("Failed to create flight recorder capture writer");
+      flight_recorder_dump_free (dump);
+      return NULL;
+    }
+
+  /* The writer took over the file descriptor */
+  dump->fd = -1;
+
+  for (i = 0; i < dump->entries->len; i++)
+    {
+      CoglTraceRingEntry *entry =
+        &g_array_index (dump->entries, CoglTraceRingEntry, i);
+      guint group_index = g_array_index (dump->entry_groups, guint, i);
+
+      sysprof_capture_writer_add_mark (writer,
+                                       entry->begin_time_ns,
+                                       -1,
+                                       pid,
+                                       entry->duration_ns,
+                                       g_ptr_array_index (dump->groups,
+                                                          group_index),
+                                       entry->name,
+                                       entry->description);
+    }
+
+  sysprof_capture_writer_add_mark (writer,
+                                   dump->time_ns,
+                                   -1,
+                                   pid,
+                                   0,
+                                   "Flight recorder",
+                                   "Cogl::FlightRecorder::dump()",
+                                   dump->reason);
+
+  for (i = 0; i < dump->annotations->len; i++)
+    {
+      sysprof_capture_writer_add_mark (writer,
+                                       dump->time_ns,
+                                       -1,
+                                       pid,
+                                       0,
+                                       "Flight recorder",
+                                       g_ptr_array_index (dump->annotation_names, i),
+                                       g_ptr_array_index (dump->annotations, i));
+    }
+
+  sysprof_capture_writer_flush (writer);
+  sysprof_capture_writer_unref (writer);
+  flight_recorder_dump_free (dump);
+
+  return NULL;
+}
+
+static void
+start_flight_recorder_dump (int         fd,
+                            const char *reason)
+{
+  CoglFlightRecorderDump *dump;
+
+  dump = flight_recorder_dump_new (fd, reason);
+
+  /* Copying the rings is cheap, but writing the capture isn't, so don't
+   * make the thread that might just have missed a frame wait for it. */
+  g_thread_unref (g_thread_new ("Flight recorder dump",
+                                write_flight_recorder_dump,
+                                dump));
+}
+
+/* Takes ownership of @fd on success */
+gboolean
+cogl_dump_flight_recorder_to_fd (int          fd,
+                                 const char  *reason,
+                                 GError     **error)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+
+  locker = g_mutex_locker_new (&flight_recorder.mutex);
+  if (!flight_recorder.running)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_INITIALIZED,
+                   "Flight recorder not running");
+      return FALSE;
+    }
+
+  start_flight_recorder_dump (fd, reason);
+  return TRUE;
+}
+
+void
+cogl_request_flight_recorder_dump (const char *reason)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+  g_autofree char *filename = NULL;
+  g_autofree char *path = NULL;
+  int64_t now_us;
+  int fd;
+
+  locker = g_mutex_locker_new (&flight_recorder.mutex);
+  if (!flight_recorder.running || !flight_recorder.dump_dir)
+    return;
+
+  /* Hitches tend to come in bursts, only keep the first one of a burst */
+  now_us = g_get_monotonic_time ();
+  if (flight_recorder.last_dump_time_us != 0 &&
+      now_us - flight_recorder.last_dump_time_us <
+      FLIGHT_RECORDER_MIN_DUMP_INTERVAL_US)
+    return;
+
+  flight_recorder.last_dump_time_us = now_us;
+
+  filename = g_strdup_printf ("mutter-flight-recorder-%" G_GINT64_FORMAT ".syscap",
+                              g_get_real_time () / G_USEC_PER_SEC);
+  path = g_build_filename (flight_recorder.dump_dir, filename, NULL);
+
+  fd = g_open (path, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd == -1)
+    {
+      g_warning ("Failed to open flight recorder dump '%s': %s",
+                 path, g_strerror (errno));
+      return;
+    }
+
+  g_message ("Dumping flight recorder to '%s': %s", path, reason);
+
+  start_flight_recorder_dump (fd, reason);
+}
+
+gboolean
+cogl_is_flight_recorder_running (void)
+{
+  return g_atomic_int_get (&flight_recorder.running);
+}
+
+/*
+ * Adds a function providing state not covered by trace points to include
+ * in each dump, e.g. statistics. @name must be a static string. @func is
+ * called by the thread requesting the dump, with the flight recorder lock
+ * held, and returns the text of the annotation, or %NULL to omit it.
+ */
+unsigned int
+cogl_add_flight_recorder_annotation (const char                       *name,
+                                     CoglFlightRecorderAnnotationFunc  func,
+                                     gpointer                          user_data)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+  CoglFlightRecorderAnnotation *annotation;
+
+  locker = g_mutex_locker_new (&flight_recorder.mutex);
+
+  annotation = g_new0 (CoglFlightRecorderAnnotation, 1);
+  annotation->id = ++flight_recorder.last_annotation_id;
+  annotation->name = name;
+  annotation->func = func;
+  annotation->user_data = user_data;
+  flight_recorder.annotations = g_list_append (flight_recorder.annotations,
+                                               annotation);
+
+  return annotation->id;
+}
+
+void
+cogl_remove_flight_recorder_annotation (unsigned int id)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+  GList *l;
+
+  locker = g_mutex_locker_new (&flight_recorder.mutex);
+
+  for (l = flight_recorder.annotations; l; l = l->next)
+    {
+      CoglFlightRecorderAnnotation *annotation = l->data;
+
+      if (annotation->id == id)
+        {
+          flight_recorder.annotations =
+            g_list_delete_link (flight_recorder.annotations, l);
+          g_free (annotation);
+          return;
+        }
+    }
+}
+
 #else
 
 #include <string.h>
@@ -545,4 +1122,61 @@ cogl_set_tracing_disabled_on_thread (void *data)
   fprintf (stderr, "Tracing not enabled");
 }
 
+void
+cogl_start_flight_recorder (const char *dump_dir,
+                            int64_t     duration_us)
+{
+  fprintf (stderr, "Tracing not enabled");
+}
+
+void
+cogl_stop_flight_recorder (void)
+{
+}
+
+void
+cogl_set_flight_recorder_enabled_on_thread (void       *data,
+                                            const char *group)
+{
+}
+
+void
+cogl_set_flight_recorder_disabled_on_thread (void *data)
+{
+}
+
+gboolean
+cogl_dump_flight_recorder_to_fd (int          fd,
+                                 const char  *reason,
+                                 GError     **error)
+{
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+               "Tracing disabled at build time");
+  return FALSE;
+}
+
+void
+cogl_request_flight_recorder_dump (const char *reason)
+{
+}
+
+gboolean
+cogl_is_flight_recorder_running (void)
+{
+  return FALSE;
+}
+
+unsigned int
+cogl_add_flight_recorder_annotation (const char                       *name,
+                                     CoglFlightRecorderAnnotationFunc  func,
+                                     void                             *user_data)
+{
+  return 0;
+}
+
+void
+cogl_remove_flight_recorder_annotation (unsigned int id)
+{
+}
+
 #endif /* HAVE_PROFILER */
@@ -51,6 +51,8 @@ typedef struct _CoglTraceCounterData
   const char *description;
 } CoglTraceCounterData;
 
+typedef char * (* CoglFlightRecorderAnnotationFunc) (gpointer user_data);
+
 COGL_EXPORT
 GPrivate cogl_trace_thread_data;
 COGL_EXPORT
@@ -76,6 +78,42 @@ void cogl_set_tracing_enabled_on_thread (GMainContext *main_context,
 COGL_EXPORT
 void cogl_set_tracing_disabled_on_thread (GMainContext *main_context);
 
+COGL_EXPORT
+gboolean cogl_is_capturing_traces (void);
+
+COGL_EXPORT
+void cogl_start_flight_recorder (const char *dump_dir,
+                                 int64_t     duration_us);
+
+COGL_EXPORT
+void cogl_stop_flight_recorder (void);
+
+COGL_EXPORT
+void cogl_set_flight_recorder_enabled_on_thread (GMainContext *main_context,
+                                                 const char   *group);
+
+COGL_EXPORT
+void cogl_set_flight_recorder_disabled_on_thread (GMainContext *main_context);
+
+COGL_EXPORT
+gboolean cogl_dump_flight_recorder_to_fd (int          fd,
+                                          const char  *reason,
+                                          GError     **error);
+
+COGL_EXPORT
+void cogl_request_flight_recorder_dump (const char *reason);
+
+COGL_EXPORT
+gboolean cogl_is_flight_recorder_running (void);
+
+COGL_EXPORT
+unsigned int cogl_add_flight_recorder_annotation (const char                       *name,
+                                                  CoglFlightRecorderAnnotationFunc  func,
+                                                  gpointer                          user_data);
+
+COGL_EXPORT
+void cogl_remove_flight_recorder_annotation (unsigned int id);
+
 static inline void
 cogl_trace_begin (CoglTraceHead *head,
                   const char    *name)
@@ -95,6 +133,12 @@ COGL_EXPORT void
 cogl_trace_mark (const char *name,
                  const char *description);
 
+COGL_EXPORT void
+cogl_trace_mark_range (const char *name,
+                       const char *description,
+                       int64_t     begin_time_ns,
+                       int64_t     duration_ns);
+
 static inline void
 cogl_auto_trace_end_helper (CoglTraceHead **head)
 {
@@ -194,7 +238,7 @@ cogl_trace_counter_data_double (gpointer user_data)
 
 #define COGL_TRACE_INTERNAL_DEFINE_COUNTER(Name, name, description, func) \
   static GOnce CoglTraceCounter##Name = G_ONCE_INIT; \
-  if (cogl_is_tracing_enabled ()) \
+  if (cogl_is_capturing_traces ()) \
     { \
       static CoglTraceCounterData CoglTraceCounterData##Name = { \
         name, description, \
@@ -215,7 +259,7 @@ cogl_trace_counter_data_double (gpointer user_data)
 #define COGL_TRACE_INTERNAL_SET_COUNTER(Name, value, func) \
   G_STMT_START \
     { \
-      if (cogl_is_tracing_enabled ()) \
+      if (cogl_is_capturing_traces ()) \
         { \
           func (GPOINTER_TO_UINT (CoglTraceCounter##Name.retval), value); \
         } \
@@ -263,4 +307,39 @@ void cogl_set_tracing_enabled_on_thread (void       *data,
 COGL_EXPORT
 void cogl_set_tracing_disabled_on_thread (void *data);
 
+COGL_EXPORT
+void cogl_start_flight_recorder (const char *dump_dir,
+                                 int64_t     duration_us);
+
+COGL_EXPORT
+void cogl_stop_flight_recorder (void);
+
+COGL_EXPORT
+void cogl_set_flight_recorder_enabled_on_thread (void       *data,
+                                                 const char *group);
+
+COGL_EXPORT
+void cogl_set_flight_recorder_disabled_on_thread (void *data);
+
+COGL_EXPORT
+gboolean cogl_dump_flight_recorder_to_fd (int          fd,
+                                          const char  *reason,
+                                          GError     **error);
+
+COGL_EXPORT
+void cogl_request_flight_recorder_dump (const char *reason);
+
+typedef char * (* CoglFlightRecorderAnnotationFunc) (void *user_data);
+
+COGL_EXPORT
+gboolean cogl_is_flight_recorder_running (void);
+
+COGL_EXPORT
+unsigned int cogl_add_flight_recorder_annotation (const char                       *name,
+                                                  CoglFlightRecorderAnnotationFunc  func,
+                                                  void                             *user_data);
+
+COGL_EXPORT
+void cogl_remove_flight_recorder_annotation (unsigned int id);
+
 #endif /* HAVE_PROFILER */
@@ -110,6 +110,21 @@ setup_generic_buffered_attribute (CoglContext *context,
                                       attribute->normalized,
                                       attribute->stride,
                                       base + attribute->offset) );
+
+  /* The divisor is part of the attribute location state, so it only
+   * needs updating when switching between instanced and per-vertex
+   * data */
+  if ((attribute->instance_divisor != 0) !=
+      _cogl_bitmask_get (&context->instanced_custom_attributes,
+                         attrib_location))
+    {
+      GE( context, glVertexAttribDivisor (attrib_location,
+                                          attribute->instance_divisor) );
+      _cogl_bitmask_set (&context->instanced_custom_attributes,
+                         attrib_location,
+                         attribute->instance_divisor != 0);
+    }
+
   _cogl_bitmask_set (&context->enable_custom_attributes_tmp,
                      attrib_location, TRUE);
 }
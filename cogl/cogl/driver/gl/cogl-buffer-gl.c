@@ -89,7 +89,17 @@ void
 _cogl_buffer_gl_destroy (CoglDriver *driver,
                          CoglBuffer *buffer)
 {
-  GE( buffer->context, glDeleteBuffers (1, &buffer->gl_handle) );
+  CoglContext *ctx = buffer->context;
+  int i;
+
+  /* Deleting a buffer object unbinds it from every target */
+  for (i = 0; i < COGL_BUFFER_BIND_TARGET_COUNT; i++)
+    {
+      if (ctx->gl_buffer_binding_cache[i] == buffer->gl_handle)
+        ctx->gl_buffer_binding_cache[i] = 0;
+    }
+
+  GE( ctx, glDeleteBuffers (1, &buffer->gl_handle) );
 }
 
 static GLenum
@@ -128,6 +138,19 @@ convert_bind_target_to_gl_target (CoglBufferBindTarget target)
     }
 }
 
+static void
+bind_gl_buffer (CoglContext          *ctx,
+                CoglBufferBindTarget  target,
+                GLuint                gl_handle)
+{
+  if (ctx->gl_buffer_binding_cache[target] == gl_handle)
+    return;
+
+  GE( ctx, glBindBuffer (convert_bind_target_to_gl_target (target),
+                         gl_handle) );
+  ctx->gl_buffer_binding_cache[target] = gl_handle;
+}
+
 static gboolean
 recreate_store (CoglBuffer *buffer,
                 GError **error)
@@ -187,12 +210,16 @@ _cogl_buffer_bind_no_create (CoglBuffer *buffer,
 
   if (buffer->flags & COGL_BUFFER_FLAG_BUFFER_OBJECT)
     {
-      GLenum gl_target = convert_bind_target_to_gl_target (buffer->last_target);
-      GE( ctx, glBindBuffer (gl_target, buffer->gl_handle) );
+      bind_gl_buffer (ctx, target, buffer->gl_handle);
       return NULL;
     }
   else
-    return buffer->data;
+    {
+      /* Pointers into malloc'ed fallback buffers are only interpreted
+       * as such without a buffer object bound */
+      bind_gl_buffer (ctx, target, 0);
+      return buffer->data;
+    }
 }
 
 void *
@@ -421,11 +448,15 @@ _cogl_buffer_gl_unbind (CoglBuffer *buffer)
   /* the unbind should pair up with a previous bind */
   g_return_if_fail (ctx->current_buffer[buffer->last_target] == buffer);
 
-  if (buffer->flags & COGL_BUFFER_FLAG_BUFFER_OBJECT)
-    {
-      GLenum gl_target = convert_bind_target_to_gl_target (buffer->last_target);
-      GE( ctx, glBindBuffer (gl_target, 0) );
-    }
+  /* Attribute and index buffers stay bound, as nothing but binding
+   * another buffer through Cogl depends on those bindings, and the
+   * journal keeps drawing from the same buffers. Texture uploads and
+   * downloads from client memory do depend on no pixel buffer being
+   * bound though. */
+  if ((buffer->flags & COGL_BUFFER_FLAG_BUFFER_OBJECT) &&
+      (buffer->last_target == COGL_BUFFER_BIND_TARGET_PIXEL_PACK ||
+       buffer->last_target == COGL_BUFFER_BIND_TARGET_PIXEL_UNPACK))
+    bind_gl_buffer (ctx, buffer->last_target, 0);
 
   ctx->current_buffer[buffer->last_target] = NULL;
 }
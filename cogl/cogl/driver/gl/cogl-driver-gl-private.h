@@ -29,6 +29,7 @@
 #pragma once
 
 #include "cogl/cogl-driver-private.h"
+#include "cogl/driver/gl/cogl-program-binary-cache-private.h"
 
 typedef struct _CoglDriverGLPrivate
 {
@@ -38,6 +39,10 @@ typedef struct _CoglDriverGLPrivate
   /* This is used for generated fake unique sampler object numbers
    when the sampler object extension is not supported */
   GLuint next_fake_sampler_object_number;
+
+  /* Created lazily when the first program is linked */
+  CoglProgramBinaryCache *program_binary_cache;
+  gboolean program_binary_cache_initialized;
 } CoglDriverGLPrivate;
 
 
@@ -76,6 +76,9 @@ cogl_driver_gl_dispose (GObject *object)
     }
   g_array_free (priv->texture_units, TRUE);
 
+  g_clear_pointer (&priv->program_binary_cache,
+                   _cogl_program_binary_cache_free);
+
   G_OBJECT_CLASS (cogl_driver_gl_parent_class)->dispose (object);
 }
 
@@ -517,6 +520,67 @@ cogl_driver_gl_get_gpu_time_ns (CoglDriver  *driver,
   return gpu_time_ns;
 }
 
+#ifdef GL_ARB_sync
+struct _CoglFence
+{
+  GLsync sync;
+};
+#endif
+
+static CoglFence *
+cogl_driver_gl_create_fence (CoglDriver  *driver,
+                             CoglContext *context)
+{
+#ifdef GL_ARB_sync
+  CoglFence *fence;
+
+  /* Fences may also be provided by EGL, which isn't used here */
+  if (!context->glFenceSync)
+    return NULL;
+
+  fence = g_new0 (CoglFence, 1);
+  fence->sync = context->glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  /* Make sure the fence gets submitted, as it would otherwise never be
+   * signaled if nothing else flushes the commands before it is checked */
+  context->glFlush ();
+
+  return fence;
+#else
+  return NULL;
+#endif
+}
+
+static gboolean
+cogl_driver_gl_is_fence_signaled (CoglDriver  *driver,
+                                  CoglContext *context,
+                                  CoglFence   *fence)
+{
+#ifdef GL_ARB_sync
+  GLenum status;
+
+  status = context->glClientWaitSync (fence->sync, 0, 0);
+
+  return (status == GL_ALREADY_SIGNALED ||
+          status == GL_CONDITION_SATISFIED ||
+          status == GL_WAIT_FAILED);
+#else
+  g_assert_not_reached ();
+  return TRUE;
+#endif
+}
+
+static void
+cogl_driver_gl_free_fence (CoglDriver  *driver,
+                           CoglContext *context,
+                           CoglFence   *fence)
+{
+#ifdef GL_ARB_sync
+  GE (context, glDeleteSync (fence->sync));
+  g_free (fence);
+#endif
+}
+
 static void
 cogl_driver_gl_class_init (CoglDriverGLClass *klass)
 {
@@ -545,6 +609,9 @@ cogl_driver_gl_class_init (CoglDriverGLClass *klass)
   driver_klass->free_timestamp_query = cogl_driver_gl_free_timestamp_query;
   driver_klass->timestamp_query_get_time_ns = cogl_driver_gl_timestamp_query_get_time_ns;
   driver_klass->get_gpu_time_ns = cogl_driver_gl_get_gpu_time_ns;
+  driver_klass->create_fence = cogl_driver_gl_create_fence;
+  driver_klass->is_fence_signaled = cogl_driver_gl_is_fence_signaled;
+  driver_klass->free_fence = cogl_driver_gl_free_fence;
 }
 
 static void
@@ -387,6 +387,28 @@ cogl_gl_framebuffer_draw_indexed_attributes (CoglFramebufferDriver  *driver,
   _cogl_buffer_gl_unbind (buffer);
 }
 
+static void
+cogl_gl_framebuffer_draw_instanced_attributes (CoglFramebufferDriver  *driver,
+                                               CoglPipeline           *pipeline,
+                                               CoglVerticesMode        mode,
+                                               int                     first_vertex,
+                                               int                     n_vertices,
+                                               int                     n_instances,
+                                               CoglAttribute         **attributes,
+                                               int                     n_attributes,
+                                               CoglDrawFlags           flags)
+{
+  CoglFramebuffer *framebuffer =
+    cogl_framebuffer_driver_get_framebuffer (driver);
+
+  _cogl_flush_attributes_state (framebuffer, pipeline, flags,
+                                attributes, n_attributes);
+
+  GE (cogl_framebuffer_get_context (framebuffer),
+      glDrawArraysInstanced ((GLenum)mode, first_vertex, n_vertices,
+                             n_instances));
+}
+
 static gboolean
 cogl_gl_framebuffer_read_pixels_into_bitmap (CoglFramebufferDriver  *driver,
                                              int                     x,
@@ -641,6 +663,38 @@ EXIT:
   return status;
 }
 
+static CoglPixelFormat
+cogl_gl_framebuffer_get_read_pixels_format (CoglFramebufferDriver *driver,
+                                            CoglPixelFormat        format)
+{
+  CoglFramebuffer *framebuffer =
+    cogl_framebuffer_driver_get_framebuffer (driver);
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  CoglDriverGLClass *driver_gl_klass = COGL_DRIVER_GL_GET_CLASS (ctx->driver);
+  CoglPixelFormat internal_format =
+    cogl_framebuffer_get_internal_format (framebuffer);
+  CoglPixelFormat read_format;
+  GLenum gl_format;
+  GLenum gl_type;
+
+  read_format = driver_gl_klass->get_read_pixels_format (COGL_DRIVER_GL (ctx->driver),
+                                                         ctx,
+                                                         internal_format,
+                                                         format,
+                                                         &gl_format,
+                                                         &gl_type);
+
+  /* Keep the premultiplied state of the framebuffer, so that glReadPixels()
+   * can write the pixels as is */
+  if (_cogl_pixel_format_can_have_premult (read_format))
+    {
+      read_format = ((read_format & ~COGL_PREMULT_BIT) |
+                     (internal_format & COGL_PREMULT_BIT));
+    }
+
+  return read_format;
+}
+
 static void
 cogl_gl_framebuffer_init (CoglGlFramebuffer *gl_framebuffer)
 {
@@ -658,6 +712,10 @@ cogl_gl_framebuffer_class_init (CoglGlFramebufferClass *klass)
   driver_class->draw_attributes = cogl_gl_framebuffer_draw_attributes;
   driver_class->draw_indexed_attributes =
     cogl_gl_framebuffer_draw_indexed_attributes;
+  driver_class->draw_instanced_attributes =
+    cogl_gl_framebuffer_draw_instanced_attributes;
   driver_class->read_pixels_into_bitmap =
     cogl_gl_framebuffer_read_pixels_into_bitmap;
+  driver_class->get_read_pixels_format =
+    cogl_gl_framebuffer_get_read_pixels_format;
 }
@@ -39,3 +39,9 @@ extern const CoglPipelineFragend _cogl_pipeline_glsl_fragend;
 
 GLuint
 _cogl_pipeline_fragend_glsl_get_shader (CoglPipeline *pipeline);
+
+const char *
+_cogl_pipeline_fragend_glsl_get_shader_source_hash (CoglPipeline *pipeline);
+
+void
+_cogl_pipeline_fragend_glsl_compile_shader (CoglPipeline *pipeline);
@@ -88,6 +88,10 @@ typedef struct
   int ref_count;
 
   GLuint gl_shader;
+  /* The shader source is compiled lazily by the progend so that it can
+   * be skipped when a linked program binary can be used instead */
+  gboolean gl_shader_compiled;
+  char *source_hash;
   GString *header, *source;
   UnitState *unit_state;
 
@@ -160,6 +164,8 @@ destroy_shader_state (void *user_data)
       if (shader_state->gl_shader)
         GE( ctx, glDeleteShader (shader_state->gl_shader) );
 
+      g_free (shader_state->source_hash);
+
       g_free (shader_state->unit_state);
 
       g_free (shader_state);
@@ -211,6 +217,30 @@ _cogl_pipeline_fragend_glsl_get_shader (CoglPipeline *pipeline)
     return 0;
 }
 
+const char *
+_cogl_pipeline_fragend_glsl_get_shader_source_hash (CoglPipeline *pipeline)
+{
+  CoglPipelineFragendShaderState *shader_state = get_shader_state (pipeline);
+
+  if (shader_state)
+    return shader_state->source_hash;
+  else
+    return NULL;
+}
+
+void
+_cogl_pipeline_fragend_glsl_compile_shader (CoglPipeline *pipeline)
+{
+  CoglPipelineFragendShaderState *shader_state = get_shader_state (pipeline);
+
+  if (!shader_state || !shader_state->gl_shader ||
+      shader_state->gl_shader_compiled)
+    return;
+
+  _cogl_glsl_shader_compile (pipeline->context, shader_state->gl_shader);
+  shader_state->gl_shader_compiled = TRUE;
+}
+
 static CoglPipelineSnippetList *
 get_fragment_snippets (CoglPipeline *pipeline)
 {
@@ -367,6 +397,8 @@ _cogl_pipeline_fragend_glsl_start (CoglPipeline *pipeline,
             {
               GE( ctx, glDeleteShader (shader_state->gl_shader) );
               shader_state->gl_shader = 0;
+              shader_state->gl_shader_compiled = FALSE;
+              g_clear_pointer (&shader_state->source_hash, g_free);
             }
           return;
         }
@@ -992,7 +1024,6 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
 
@@ -1058,21 +1089,8 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
                                                      shader, GL_FRAGMENT_SHADER,
                                                      pipeline,
                                                      2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+                                                     source_strings, lengths,
+                                                     &shader_state->source_hash);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
@@ -157,4 +157,9 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                CoglPipeline *pipeline,
                                                GLsizei count_in,
                                                const char **strings_in,
-                                               const GLint *lengths_in);
+                                               const GLint *lengths_in,
+                                               char **out_source_hash);
+
+void
+_cogl_glsl_shader_compile (CoglContext *ctx,
+                           GLuint       shader_gl_handle);
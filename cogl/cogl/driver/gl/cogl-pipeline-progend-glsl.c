@@ -50,6 +50,7 @@
 #include "cogl/driver/gl/cogl-pipeline-fragend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-vertend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-progend-glsl-private.h"
+#include "cogl/driver/gl/cogl-program-binary-cache-private.h"
 #include "deprecated/cogl-program-private.h"
 #include "deprecated/cogl-shader-private.h"
 
@@ -351,12 +352,14 @@ dirty_program_state (CoglPipeline *pipeline)
                            NULL);
 }
 
-static void
+static gboolean
 link_program (CoglContext *ctx,
               GLint        gl_program)
 {
   GLint link_status;
 
+  ctx->render_stats.n_program_links++;
+
   GE( ctx, glLinkProgram (gl_program) );
 
   GE( ctx, glGetProgramiv (gl_program, GL_LINK_STATUS, &link_status) );
@@ -379,6 +382,28 @@ link_program (CoglContext *ctx,
 
       g_free (log);
     }
+
+  return link_status;
+}
+
+static char *
+get_program_binary_key (CoglPipeline           *pipeline,
+                        CoglProgramBinaryCache *binary_cache)
+{
+  const char *vertex_source_hash;
+  const char *fragment_source_hash;
+
+  vertex_source_hash =
+    _cogl_pipeline_vertend_glsl_get_shader_source_hash (pipeline);
+  fragment_source_hash =
+    _cogl_pipeline_fragend_glsl_get_shader_source_hash (pipeline);
+
+  if (!vertex_source_hash || !fragment_source_hash)
+    return NULL;
+
+  return _cogl_program_binary_cache_get_key (binary_cache,
+                                             vertex_source_hash,
+                                             fragment_source_hash);
 }
 
 typedef struct
@@ -843,6 +868,53 @@ _cogl_shader_compile_real (CoglShader   *shader,
     }
 }
 
+static gboolean
+build_program (CoglPipeline             *pipeline,
+               CoglPipelineProgramState *program_state,
+               CoglProgram              *user_program)
+{
+  CoglContext *ctx = pipeline->context;
+  GLuint backend_shader;
+  GSList *l;
+
+  /* Attach all of the shader from the user program */
+  if (user_program)
+    {
+      for (l = user_program->attached_shaders; l; l = l->next)
+        {
+          CoglShader *shader = l->data;
+
+          _cogl_shader_compile_real (shader, pipeline);
+
+          GE( ctx, glAttachShader (program_state->program,
+                                   shader->gl_handle) );
+        }
+
+      program_state->user_program_age = user_program->age;
+    }
+
+  /* Attach any shaders from the GLSL backends */
+  if ((backend_shader = _cogl_pipeline_fragend_glsl_get_shader (pipeline)))
+    {
+      _cogl_pipeline_fragend_glsl_compile_shader (pipeline);
+      GE( ctx, glAttachShader (program_state->program, backend_shader) );
+    }
+  if ((backend_shader = _cogl_pipeline_vertend_glsl_get_shader (pipeline)))
+    {
+      _cogl_pipeline_vertend_glsl_compile_shader (pipeline);
+      GE( ctx, glAttachShader (program_state->program, backend_shader) );
+    }
+
+  /* XXX: OpenGL as a special case requires the vertex position to
+   * be bound to generic attribute 0 so for simplicity we
+   * unconditionally bind the cogl_position_in attribute here...
+   */
+  GE( ctx, glBindAttribLocation (program_state->program,
+                                 0, "cogl_position_in"));
+
+  return link_program (ctx, program_state->program);
+}
+
 static void
 _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
                                  unsigned long pipelines_difference)
@@ -920,42 +992,33 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
 
   if (program_state->program == 0)
     {
-      GLuint backend_shader;
-      GSList *l;
+      CoglProgramBinaryCache *binary_cache = NULL;
+      g_autofree char *binary_key = NULL;
 
       GE_RET( program_state->program, ctx, glCreateProgram () );
 
-      /* Attach all of the shader from the user program */
-      if (user_program)
-        {
-          for (l = user_program->attached_shaders; l; l = l->next)
-            {
-              CoglShader *shader = l->data;
+      /* Programs using the deprecated CoglProgram API have sources that
+       * aren't covered by the generated shader hashes */
+      if (!user_program)
+        binary_cache = _cogl_program_binary_cache_get (ctx);
 
-              _cogl_shader_compile_real (shader, pipeline);
+      if (binary_cache)
+        binary_key = get_program_binary_key (pipeline, binary_cache);
 
-              GE( ctx, glAttachShader (program_state->program,
-                                       shader->gl_handle) );
+      if (!binary_key ||
+          !_cogl_program_binary_cache_load (binary_cache,
+                                            binary_key,
+                                            program_state->program))
+        {
+          if (build_program (pipeline, program_state, user_program) &&
+              binary_key)
+            {
+              _cogl_program_binary_cache_save (binary_cache,
+                                               binary_key,
+                                               program_state->program);
             }
-
-          program_state->user_program_age = user_program->age;
         }
 
-      /* Attach any shaders from the GLSL backends */
-      if ((backend_shader = _cogl_pipeline_fragend_glsl_get_shader (pipeline)))
-        GE( ctx, glAttachShader (program_state->program, backend_shader) );
-      if ((backend_shader = _cogl_pipeline_vertend_glsl_get_shader (pipeline)))
-        GE( ctx, glAttachShader (program_state->program, backend_shader) );
-
-      /* XXX: OpenGL as a special case requires the vertex position to
-       * be bound to generic attribute 0 so for simplicity we
-       * unconditionally bind the cogl_position_in attribute here...
-       */
-      GE( ctx, glBindAttribLocation (program_state->program,
-                                     0, "cogl_position_in"));
-
-      link_program (ctx, program_state->program);
-
       program_changed = TRUE;
     }
 
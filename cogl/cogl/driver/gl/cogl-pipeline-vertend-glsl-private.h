@@ -42,5 +42,11 @@ extern const CoglPipelineVertend _cogl_pipeline_glsl_vertend;
 GLuint
 _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline);
 
+const char *
+_cogl_pipeline_vertend_glsl_get_shader_source_hash (CoglPipeline *pipeline);
+
+void
+_cogl_pipeline_vertend_glsl_compile_shader (CoglPipeline *pipeline);
+
 COGL_EXPORT_TEST
 CoglPipelineVertendShaderState * cogl_pipeline_vertend_glsl_get_shader_state (CoglPipeline *pipeline);
@@ -54,6 +54,10 @@ struct _CoglPipelineVertendShaderState
   unsigned int ref_count;
 
   GLuint gl_shader;
+  /* The shader source is compiled lazily by the progend so that it can
+   * be skipped when a linked program binary can be used instead */
+  gboolean gl_shader_compiled;
+  char *source_hash;
   GString *header, *source;
 
   CoglPipelineCacheEntry *cache_entry;
@@ -120,6 +124,8 @@ destroy_shader_state (void *user_data)
       if (shader_state->gl_shader)
         GE( ctx, glDeleteShader (shader_state->gl_shader) );
 
+      g_free (shader_state->source_hash);
+
       g_free (shader_state);
     }
 
@@ -216,7 +222,8 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                CoglPipeline *pipeline,
                                                GLsizei count_in,
                                                const char **strings_in,
-                                               const GLint *lengths_in)
+                                               const GLint *lengths_in,
+                                               char **out_source_hash)
 {
   const char **strings = g_alloca (sizeof (char *) * (count_in + 5));
   GLint *lengths = g_alloca (sizeof (GLint) * (count_in + 5));
@@ -334,9 +341,44 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
       g_string_free (buf, TRUE);
     }
 
+  if (out_source_hash)
+    {
+      g_autoptr (GChecksum) checksum = NULL;
+      int i;
+
+      checksum = g_checksum_new (G_CHECKSUM_SHA256);
+      /* A length of -1 means null terminated for both GL and GChecksum */
+      for (i = 0; i < count; i++)
+        g_checksum_update (checksum, (const guchar *) strings[i], lengths[i]);
+
+      *out_source_hash = g_strdup (g_checksum_get_string (checksum));
+    }
+
   GE( ctx, glShaderSource (shader_gl_handle, count,
                            (const char **) strings, lengths) );
 }
+
+void
+_cogl_glsl_shader_compile (CoglContext *ctx,
+                           GLuint       shader_gl_handle)
+{
+  GLint compile_status;
+
+  GE( ctx, glCompileShader (shader_gl_handle) );
+  GE( ctx, glGetShaderiv (shader_gl_handle, GL_COMPILE_STATUS,
+                          &compile_status) );
+
+  if (!compile_status)
+    {
+      GLint len = 0;
+      char *shader_log;
+
+      GE( ctx, glGetShaderiv (shader_gl_handle, GL_INFO_LOG_LENGTH, &len) );
+      shader_log = g_alloca (len);
+      GE( ctx, glGetShaderInfoLog (shader_gl_handle, len, &len, shader_log) );
+      g_warning ("Shader compilation failed:\n%s", shader_log);
+    }
+}
 GLuint
 _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline)
 {
@@ -348,6 +390,30 @@ _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline)
     return 0;
 }
 
+const char *
+_cogl_pipeline_vertend_glsl_get_shader_source_hash (CoglPipeline *pipeline)
+{
+  CoglPipelineVertendShaderState *shader_state = get_shader_state (pipeline);
+
+  if (shader_state)
+    return shader_state->source_hash;
+  else
+    return NULL;
+}
+
+void
+_cogl_pipeline_vertend_glsl_compile_shader (CoglPipeline *pipeline)
+{
+  CoglPipelineVertendShaderState *shader_state = get_shader_state (pipeline);
+
+  if (!shader_state || !shader_state->gl_shader ||
+      shader_state->gl_shader_compiled)
+    return;
+
+  _cogl_glsl_shader_compile (pipeline->context, shader_state->gl_shader);
+  shader_state->gl_shader_compiled = TRUE;
+}
+
 static CoglPipelineSnippetList *
 get_vertex_snippets (CoglPipeline *pipeline)
 {
@@ -476,6 +542,8 @@ _cogl_pipeline_vertend_glsl_start (CoglPipeline *pipeline,
             {
               GE( ctx, glDeleteShader (shader_state->gl_shader) );
               shader_state->gl_shader = 0;
+              shader_state->gl_shader_compiled = FALSE;
+              g_clear_pointer (&shader_state->source_hash, g_free);
             }
           return;
         }
@@ -611,7 +679,6 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
       CoglPipelineSnippetList *vertex_snippets;
@@ -720,21 +787,8 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
                                                      shader, GL_VERTEX_SHADER,
                                                      pipeline,
                                                      2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+                                                     source_strings, lengths,
+                                                     &shader_state->source_hash);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
@@ -0,0 +1,75 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2026 Red Hat.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "cogl/cogl-context.h"
+#include "cogl/cogl-gl-header.h"
+
+typedef struct _CoglProgramBinaryCache CoglProgramBinaryCache;
+
+/*
+ * Returns the program binary cache of the context, creating it the
+ * first time it's needed. Returns %NULL if the driver can't retrieve
+ * program binaries or if program caches are disabled.
+ */
+CoglProgramBinaryCache *
+_cogl_program_binary_cache_get (CoglContext *ctx);
+
+void
+_cogl_program_binary_cache_free (CoglProgramBinaryCache *cache);
+
+/*
+ * Combines the hashes of the generated shader sources with the
+ * identity of the driver and GPU, so that binaries are never loaded
+ * into a driver different from the one that produced them.
+ */
+char *
+_cogl_program_binary_cache_get_key (CoglProgramBinaryCache *cache,
+                                    const char             *vertex_source_hash,
+                                    const char             *fragment_source_hash);
+
+/*
+ * Tries to load a previously saved binary for @key into @gl_program.
+ * Returns %TRUE if the program is linked and ready to be used, and
+ * %FALSE if it still needs to be compiled and linked from source.
+ */
+gboolean
+_cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  gl_program);
+
+/*
+ * Retrieves the binary of the linked @gl_program and writes it to the
+ * cache asynchronously.
+ */
+void
+_cogl_program_binary_cache_save (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  gl_program);
@@ -0,0 +1,269 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2026 Red Hat.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "cogl/cogl-context-private.h"
+#include "cogl/cogl-debug.h"
+#include "cogl/driver/gl/cogl-driver-gl-private.h"
+#include "cogl/driver/gl/cogl-program-binary-cache-private.h"
+#include "cogl/driver/gl/cogl-util-gl-private.h"
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+/* "CPB1" in little endian; bump when the file layout changes */
+#define PROGRAM_BINARY_MAGIC 0x31425043
+
+typedef struct _ProgramBinaryHeader
+{
+  uint32_t magic;
+  uint32_t format;
+  uint32_t length;
+} ProgramBinaryHeader;
+
+struct _CoglProgramBinaryCache
+{
+  CoglContext *context;
+
+  char *path;
+  char *driver_id;
+};
+
+static CoglProgramBinaryCache *
+program_binary_cache_new (CoglContext *ctx)
+{
+  CoglProgramBinaryCache *cache;
+  g_autofree char *path = NULL;
+  GLint n_formats = 0;
+
+  if (!_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_PROGRAM_BINARY))
+    return NULL;
+
+  /* Drivers may expose the entry points without supporting any format */
+  GE (ctx, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats));
+  if (n_formats <= 0)
+    return NULL;
+
+  path = g_build_filename (g_get_user_cache_dir (),
+                           "mutter", "cogl-program-binaries",
+                           NULL);
+  if (g_mkdir_with_parents (path, 0700) != 0)
+    {
+      g_debug ("Failed to create program binary cache directory %s: %s",
+               path, g_strerror (errno));
+      return NULL;
+    }
+
+  cache = g_new0 (CoglProgramBinaryCache, 1);
+  cache->context = ctx;
+  cache->path = g_steal_pointer (&path);
+  cache->driver_id =
+    g_strdup_printf ("%s\n%s\n%s",
+                     (const char *) ctx->glGetString (GL_VENDOR),
+                     (const char *) ctx->glGetString (GL_RENDERER),
+                     (const char *) ctx->glGetString (GL_VERSION));
+
+  return cache;
+}
+
+CoglProgramBinaryCache *
+_cogl_program_binary_cache_get (CoglContext *ctx)
+{
+  CoglDriverGL *driver_gl = COGL_DRIVER_GL (ctx->driver);
+  CoglDriverGLPrivate *priv = cogl_driver_gl_get_private (driver_gl);
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES)))
+    return NULL;
+
+  if (!priv->program_binary_cache_initialized)
+    {
+      priv->program_binary_cache = program_binary_cache_new (ctx);
+      priv->program_binary_cache_initialized = TRUE;
+    }
+
+  return priv->program_binary_cache;
+}
+
+void
+_cogl_program_binary_cache_free (CoglProgramBinaryCache *cache)
+{
+  g_free (cache->driver_id);
+  g_free (cache->path);
+  g_free (cache);
+}
+
+char *
+_cogl_program_binary_cache_get_key (CoglProgramBinaryCache *cache,
+                                    const char             *vertex_source_hash,
+                                    const char             *fragment_source_hash)
+{
+  g_autoptr (GChecksum) checksum = NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) cache->driver_id, -1);
+  g_checksum_update (checksum, (const guchar *) "\n", 1);
+  g_checksum_update (checksum, (const guchar *) vertex_source_hash, -1);
+  g_checksum_update (checksum, (const guchar *) "\n", 1);
+  g_checksum_update (checksum, (const guchar *) fragment_source_hash, -1);
+
+  return g_strdup (g_checksum_get_string (checksum));
+}
+
+static char *
+get_binary_path (CoglProgramBinaryCache *cache,
+                 const char             *key)
+{
+  g_autofree char *filename = NULL;
+
+  filename = g_strdup_printf ("%s.bin", key);
+
+  return g_build_filename (cache->path, filename, NULL);
+}
+
+static gboolean
+load_binary (CoglContext *ctx,
+             const char  *contents,
+             gsize        length,
+             GLuint       gl_program)
+{
+  ProgramBinaryHeader header;
+  GLint link_status = GL_FALSE;
+
+  if (length <= sizeof (header))
+    return FALSE;
+
+  memcpy (&header, contents, sizeof (header));
+  if (header.magic != PROGRAM_BINARY_MAGIC ||
+      header.length != length - sizeof (header))
+    return FALSE;
+
+  /* The driver rejects binaries it doesn't understand with an error
+   * rather than a failed link, so don't let that leak out as a warning */
+  _cogl_gl_util_clear_gl_errors (ctx);
+  ctx->glProgramBinary (gl_program, header.format,
+                        contents + sizeof (header), header.length);
+  if (_cogl_gl_util_get_error (ctx) != GL_NO_ERROR)
+    return FALSE;
+
+  GE (ctx, glGetProgramiv (gl_program, GL_LINK_STATUS, &link_status));
+
+  return link_status == GL_TRUE;
+}
+
+gboolean
+_cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  gl_program)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  gsize length;
+
+  path = get_binary_path (cache, key);
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return FALSE;
+
+  if (!load_binary (cache->context, contents, length, gl_program))
+    {
+      /* Most likely written by a driver that has since been updated in
+       * place; it will be replaced once the program has been relinked */
+      g_debug ("Discarding stale program binary %s", path);
+      g_unlink (path);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+on_binary_saved (GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  g_autoptr (GError) error = NULL;
+
+  if (!g_file_replace_contents_finish (G_FILE (source_object), result,
+                                       NULL, &error))
+    g_debug ("Failed to save program binary: %s", error->message);
+}
+
+void
+_cogl_program_binary_cache_save (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  gl_program)
+{
+  CoglContext *ctx = cache->context;
+  g_autofree char *path = NULL;
+  g_autoptr (GFile) file = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  ProgramBinaryHeader header;
+  GLint binary_length = 0;
+  GLsizei length = 0;
+  GLenum format = 0;
+  uint8_t *data;
+
+  GE (ctx, glGetProgramiv (gl_program, GL_PROGRAM_BINARY_LENGTH,
+                           &binary_length));
+  if (binary_length <= 0)
+    return;
+
+  data = g_malloc (sizeof (header) + binary_length);
+  GE (ctx, glGetProgramBinary (gl_program, binary_length,
+                               &length, &format,
+                               data + sizeof (header)));
+  if (length <= 0)
+    {
+      g_free (data);
+      return;
+    }
+
+  header.magic = PROGRAM_BINARY_MAGIC;
+  header.format = format;
+  header.length = length;
+  memcpy (data, &header, sizeof (header));
+
+  bytes = g_bytes_new_take (data, sizeof (header) + length);
+
+  path = get_binary_path (cache, key);
+  file = g_file_new_for_path (path);
+  g_file_replace_contents_bytes_async (file, bytes, NULL, FALSE,
+                                       G_FILE_CREATE_PRIVATE |
+                                       G_FILE_CREATE_REPLACE_DESTINATION,
+                                       NULL,
+                                       on_binary_saved, NULL);
+}
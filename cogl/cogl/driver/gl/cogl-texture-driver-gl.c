@@ -266,6 +266,56 @@ allocate_from_bitmap (CoglTexture2D     *tex_2d,
 }
 
 #if defined (HAVE_EGL) && defined (EGL_KHR_image_base)
+static gboolean
+allocate_from_egl_image_external (CoglTexture2D     *tex_2d,
+                                  CoglTextureLoader *loader,
+                                  GError           **error)
+{
+  CoglTexture *tex = COGL_TEXTURE (tex_2d);
+  CoglContext *ctx = cogl_texture_get_context (tex);
+  CoglPixelFormat internal_format;
+
+  internal_format =
+    _cogl_texture_determine_internal_format (tex,
+                                             loader->src.egl_image.format);
+
+  _cogl_gl_util_clear_gl_errors (ctx);
+
+  GE (ctx, glGenTextures (1, &tex_2d->gl_texture));
+  _cogl_bind_gl_texture_transient (ctx, GL_TEXTURE_EXTERNAL_OES,
+                                   tex_2d->gl_texture);
+
+  /* External textures only support clamping to the edge */
+  GE (ctx, glTexParameteri (GL_TEXTURE_EXTERNAL_OES,
+                            GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+  GE (ctx, glTexParameteri (GL_TEXTURE_EXTERNAL_OES,
+                            GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+  ctx->glEGLImageTargetTexture2D (GL_TEXTURE_EXTERNAL_OES,
+                                  loader->src.egl_image.image);
+  if (_cogl_gl_util_get_error (ctx) != GL_NO_ERROR)
+    {
+      g_set_error_literal (error,
+                           COGL_TEXTURE_ERROR,
+                           COGL_TEXTURE_ERROR_BAD_PARAMETER,
+                           "Could not bind the given EGLImage to an "
+                           "external CoglTexture2D");
+      GE (ctx, glDeleteTextures (1, &tex_2d->gl_texture));
+      return FALSE;
+    }
+
+  tex_2d->internal_format = internal_format;
+  tex_2d->gl_target = GL_TEXTURE_EXTERNAL_OES;
+  tex_2d->is_get_data_supported = FALSE;
+
+  _cogl_texture_set_allocated (tex,
+                               internal_format,
+                               loader->src.egl_image.width,
+                               loader->src.egl_image.height);
+
+  return TRUE;
+}
+
 static gboolean
 allocate_from_egl_image (CoglTexture2D     *tex_2d,
                          CoglTextureLoader *loader,
@@ -279,6 +329,9 @@ allocate_from_egl_image (CoglTexture2D     *tex_2d,
   CoglTextureDriverGLClass *tex_driver_klass =
     COGL_TEXTURE_DRIVER_GL_GET_CLASS (tex_driver_gl);
 
+  if (loader->src.egl_image.flags & COGL_EGL_IMAGE_FLAG_EXTERNAL)
+    return allocate_from_egl_image_external (tex_2d, loader, error);
+
   tex_2d->gl_texture = tex_driver_klass->gen (tex_driver_gl,
                                               ctx,
                                               GL_TEXTURE_2D,
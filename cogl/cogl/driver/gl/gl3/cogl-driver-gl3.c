@@ -539,6 +539,11 @@ cogl_driver_gl3_update_features (CoglDriver   *driver,
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE, TRUE);
 
+  if (ctx->glEGLImageTargetTexture2D &&
+      _cogl_check_extension ("GL_OES_EGL_image_external", gl_extensions))
+    COGL_FLAGS_SET (ctx->features,
+                    COGL_FEATURE_ID_TEXTURE_EGL_IMAGE_EXTERNAL, TRUE);
+
   COGL_FLAGS_SET (private_features,
                   COGL_PRIVATE_FEATURE_EXT_PACKED_DEPTH_STENCIL, TRUE);
 
@@ -546,6 +551,14 @@ cogl_driver_gl3_update_features (CoglDriver   *driver,
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS, TRUE);
 
+  if (ctx->glVertexAttribDivisor && ctx->glDrawArraysInstanced)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS, TRUE);
+
+  if (ctx->glGetProgramBinary && ctx->glProgramBinary)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 3) ||
       _cogl_check_extension ("GL_ARB_texture_swizzle", gl_extensions) ||
       _cogl_check_extension ("GL_EXT_texture_swizzle", gl_extensions))
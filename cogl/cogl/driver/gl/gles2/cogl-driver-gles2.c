@@ -759,6 +759,14 @@ cogl_driver_gles2_update_features (CoglDriver   *driver,
   if (context->glGenSamplers)
     COGL_FLAGS_SET (private_features, COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS, TRUE);
 
+  if (context->glVertexAttribDivisor && context->glDrawArraysInstanced)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS, TRUE);
+
+  if (context->glGetProgramBinary && context->glProgramBinary)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+
   if (context->glBlitFramebuffer)
     COGL_FLAGS_SET (context->features,
                     COGL_FEATURE_ID_BLIT_FRAMEBUFFER, TRUE);
@@ -790,6 +798,11 @@ cogl_driver_gles2_update_features (CoglDriver   *driver,
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE, TRUE);
 
+  if (context->glEGLImageTargetTexture2D &&
+      _cogl_check_extension ("GL_OES_EGL_image_external", gl_extensions))
+    COGL_FLAGS_SET (context->features,
+                    COGL_FEATURE_ID_TEXTURE_EGL_IMAGE_EXTERNAL, TRUE);
+
   if (_cogl_check_extension ("GL_OES_packed_depth_stencil", gl_extensions))
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_OES_PACKED_DEPTH_STENCIL, TRUE);
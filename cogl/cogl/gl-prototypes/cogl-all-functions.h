@@ -142,6 +142,16 @@ COGL_EXT_FUNCTION (void, glDiscardFramebuffer,
                     const GLenum    *attachments))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (invalidate_framebuffer, 4, 3,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0",
+                "invalidate_subdata\0")
+COGL_EXT_FUNCTION (void, glInvalidateFramebuffer,
+                   (GLenum           target,
+                    GLsizei          numAttachments,
+                    const GLenum    *attachments))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (IMG_multisampled_render_to_texture, 255, 255,
                 0, /* not in either GLES */
                 "\0",
@@ -203,6 +213,20 @@ COGL_EXT_FUNCTION (void, glGenVertexArrays,
                     GLuint *arrays))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (instanced_arrays, 3, 3,
+                COGL_EXT_IN_GLES3,
+                "ARB\0EXT\0",
+                "instanced_arrays\0")
+COGL_EXT_FUNCTION (void, glVertexAttribDivisor,
+                   (GLuint index,
+                    GLuint divisor))
+COGL_EXT_FUNCTION (void, glDrawArraysInstanced,
+                   (GLenum mode,
+                    GLint first,
+                    GLsizei count,
+                    GLsizei instancecount))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (map_region, 3, 0,
                 COGL_EXT_IN_GLES3,
                 "ARB:\0",
@@ -279,3 +303,15 @@ COGL_EXT_FUNCTION (void, glGenQueries,
 COGL_EXT_FUNCTION (void, glDeleteQueries,
                    (GLsizei n, const GLuint *ids))
 COGL_EXT_END ()
+
+COGL_EXT_BEGIN (get_program_binary, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0OES\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glGetProgramBinary,
+                   (GLuint program, GLsizei bufSize, GLsizei *length,
+                    GLenum *binaryFormat, void *binary))
+COGL_EXT_FUNCTION (void, glProgramBinary,
+                   (GLuint program, GLenum binaryFormat,
+                    const void *binary, GLsizei length))
+COGL_EXT_END ()
@@ -34,6 +34,10 @@
 #include "config.h"
 
 #include <X11/Xlib.h>
+#include <X11/Xlib-xcb.h>
+#include <drm_fourcc.h>
+#include <unistd.h>
+#include <xcb/dri3.h>
 
 #include "cogl/cogl-xlib-renderer-private.h"
 #include "cogl/cogl-xlib-renderer.h"
@@ -55,6 +59,10 @@ static const CoglWinsysEGLVtable _cogl_winsys_egl_vtable;
 typedef struct _CoglDisplayXlib
 {
   Window dummy_xwin;
+
+  /* Whether the X server can export pixmaps as dma-bufs, and the EGL
+   * implementation can import them */
+  gboolean have_dri3_pixmap_buffers;
 } CoglDisplayXlib;
 
 #ifdef EGL_KHR_image_pixmap
@@ -344,6 +352,29 @@ _cogl_winsys_egl_context_deinit (CoglContext *context)
                                        context);
 }
 
+#ifdef EGL_EXT_image_dma_buf_import
+static gboolean
+query_dri3_pixmap_buffers (Display *xdpy)
+{
+  xcb_connection_t *xcb_conn = XGetXCBConnection (xdpy);
+  const xcb_query_extension_reply_t *extension;
+  xcb_dri3_query_version_cookie_t cookie;
+  g_autofree xcb_dri3_query_version_reply_t *reply = NULL;
+
+  extension = xcb_get_extension_data (xcb_conn, &xcb_dri3_id);
+  if (!extension || !extension->present)
+    return FALSE;
+
+  /* DRI3BuffersFromPixmap was added in version 1.2 */
+  cookie = xcb_dri3_query_version (xcb_conn, 1, 2);
+  reply = xcb_dri3_query_version_reply (xcb_conn, cookie, NULL);
+  if (!reply)
+    return FALSE;
+
+  return reply->major_version > 1 || reply->minor_version >= 2;
+}
+#endif /* EGL_EXT_image_dma_buf_import */
+
 static gboolean
 _cogl_winsys_egl_context_created (CoglDisplay *display,
                                   GError **error)
@@ -417,6 +448,15 @@ _cogl_winsys_egl_context_created (CoglDisplay *display,
       goto fail;
     }
 
+#ifdef EGL_EXT_image_dma_buf_import
+  if (egl_renderer->private_features &
+      COGL_EGL_WINSYS_FEATURE_EGL_IMAGE_FROM_DMA_BUF)
+    {
+      xlib_display->have_dri3_pixmap_buffers =
+        query_dri3_pixmap_buffers (xlib_renderer->xdpy);
+    }
+#endif
+
   return TRUE;
 
 fail:
@@ -451,6 +491,155 @@ _cogl_winsys_egl_cleanup_context (CoglDisplay *display)
 
 #ifdef EGL_KHR_image_pixmap
 
+#ifdef EGL_EXT_image_dma_buf_import
+#define MAX_DMA_BUF_PLANES 4
+
+static uint32_t
+drm_format_for_pixmap (uint8_t depth,
+                       uint8_t bpp)
+{
+  switch (depth)
+    {
+    case 16:
+      if (bpp == 16)
+        return DRM_FORMAT_RGB565;
+      break;
+    case 24:
+      if (bpp == 32)
+        return DRM_FORMAT_XRGB8888;
+      break;
+    case 30:
+      if (bpp == 32)
+        return DRM_FORMAT_XRGB2101010;
+      break;
+    case 32:
+      if (bpp == 32)
+        return DRM_FORMAT_ARGB8888;
+      break;
+    }
+
+  return DRM_FORMAT_INVALID;
+}
+
+/* Imports the buffers backing the pixmap, exported by the X server
+ * through DRI3, which works on drivers lacking EGL_KHR_image_pixmap. */
+static EGLImageKHR
+create_dma_buf_image (CoglTexturePixmapX11 *tex_pixmap)
+{
+  static const EGLint plane_attribs[MAX_DMA_BUF_PLANES][5] = {
+    {
+      EGL_DMA_BUF_PLANE0_FD_EXT,
+      EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE0_PITCH_EXT,
+      EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT,
+    },
+    {
+      EGL_DMA_BUF_PLANE1_FD_EXT,
+      EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE1_PITCH_EXT,
+      EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT,
+    },
+    {
+      EGL_DMA_BUF_PLANE2_FD_EXT,
+      EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE2_PITCH_EXT,
+      EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT,
+    },
+    {
+      EGL_DMA_BUF_PLANE3_FD_EXT,
+      EGL_DMA_BUF_PLANE3_OFFSET_EXT,
+      EGL_DMA_BUF_PLANE3_PITCH_EXT,
+      EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
+      EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT,
+    },
+  };
+  CoglContext *ctx = cogl_texture_get_context (COGL_TEXTURE (tex_pixmap));
+  CoglRenderer *renderer = ctx->display->renderer;
+  CoglRendererEGL *egl_renderer = renderer->winsys;
+  CoglXlibRenderer *xlib_renderer = _cogl_xlib_renderer_get_data (renderer);
+  xcb_connection_t *xcb_conn = XGetXCBConnection (xlib_renderer->xdpy);
+  xcb_dri3_buffers_from_pixmap_cookie_t cookie;
+  g_autofree xcb_dri3_buffers_from_pixmap_reply_t *reply = NULL;
+  EGLint attribs[6 + MAX_DMA_BUF_PLANES * 10 + 1];
+  EGLImageKHR image = EGL_NO_IMAGE_KHR;
+  gboolean has_modifiers;
+  uint32_t drm_format;
+  uint32_t *strides;
+  uint32_t *offsets;
+  int *fds;
+  int n_attribs = 0;
+  int i;
+
+  cookie = xcb_dri3_buffers_from_pixmap (xcb_conn, tex_pixmap->pixmap);
+  reply = xcb_dri3_buffers_from_pixmap_reply (xcb_conn, cookie, NULL);
+  if (!reply)
+    return EGL_NO_IMAGE_KHR;
+
+  fds = xcb_dri3_buffers_from_pixmap_reply_fds (xcb_conn, reply);
+  strides = xcb_dri3_buffers_from_pixmap_strides (reply);
+  offsets = xcb_dri3_buffers_from_pixmap_offsets (reply);
+
+  has_modifiers = !!(egl_renderer->private_features &
+                     COGL_EGL_WINSYS_FEATURE_DMA_BUF_MODIFIERS);
+  drm_format = drm_format_for_pixmap (reply->depth, reply->bpp);
+
+  if (drm_format == DRM_FORMAT_INVALID ||
+      reply->nfd == 0 ||
+      reply->nfd > MAX_DMA_BUF_PLANES)
+    goto out;
+
+  /* Both explicit modifiers and a fourth plane are only available with
+   * EGL_EXT_image_dma_buf_import_modifiers */
+  if ((reply->modifier != DRM_FORMAT_MOD_INVALID ||
+       reply->nfd == MAX_DMA_BUF_PLANES) &&
+      !has_modifiers)
+    goto out;
+
+  attribs[n_attribs++] = EGL_WIDTH;
+  attribs[n_attribs++] = reply->width;
+  attribs[n_attribs++] = EGL_HEIGHT;
+  attribs[n_attribs++] = reply->height;
+  attribs[n_attribs++] = EGL_LINUX_DRM_FOURCC_EXT;
+  attribs[n_attribs++] = drm_format;
+
+  for (i = 0; i < reply->nfd; i++)
+    {
+      attribs[n_attribs++] = plane_attribs[i][0];
+      attribs[n_attribs++] = fds[i];
+      attribs[n_attribs++] = plane_attribs[i][1];
+      attribs[n_attribs++] = offsets[i];
+      attribs[n_attribs++] = plane_attribs[i][2];
+      attribs[n_attribs++] = strides[i];
+
+      if (reply->modifier != DRM_FORMAT_MOD_INVALID)
+        {
+          attribs[n_attribs++] = plane_attribs[i][3];
+          attribs[n_attribs++] = reply->modifier & 0xffffffff;
+          attribs[n_attribs++] = plane_attribs[i][4];
+          attribs[n_attribs++] = reply->modifier >> 32;
+        }
+    }
+
+  attribs[n_attribs++] = EGL_NONE;
+  g_assert (n_attribs <= (int) G_N_ELEMENTS (attribs));
+
+  image = _cogl_egl_create_image (ctx,
+                                  EGL_LINUX_DMA_BUF_EXT,
+                                  NULL,
+                                  attribs);
+
+out:
+  /* The EGL image holds its own references to the buffers */
+  for (i = 0; i < reply->nfd; i++)
+    close (fds[i]);
+
+  return image;
+}
+#endif /* EGL_EXT_image_dma_buf_import */
+
 static gboolean
 _cogl_winsys_texture_pixmap_x11_create (CoglTexturePixmapX11 *tex_pixmap)
 {
@@ -460,30 +649,53 @@ _cogl_winsys_texture_pixmap_x11_create (CoglTexturePixmapX11 *tex_pixmap)
   EGLint attribs[] = {EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE};
   CoglPixelFormat texture_format;
   CoglRendererEGL *egl_renderer;
+  CoglDisplayEGL *egl_display;
+  CoglDisplayXlib *xlib_display;
+  EGLImageKHR image = EGL_NO_IMAGE_KHR;
 
   egl_renderer = ctx->display->renderer->winsys;
+  egl_display = ctx->display->winsys;
+  xlib_display = egl_display->platform;
 
   if (!(egl_renderer->private_features &
-        COGL_EGL_WINSYS_FEATURE_EGL_IMAGE_FROM_X11_PIXMAP) ||
-      !_cogl_has_private_feature
+        COGL_EGL_WINSYS_FEATURE_EGL_IMAGE_FROM_X11_PIXMAP) &&
+      !xlib_display->have_dri3_pixmap_buffers)
+    {
+      tex_pixmap->winsys = NULL;
+      return FALSE;
+    }
+
+  if (!_cogl_has_private_feature
       (ctx, COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE))
     {
       tex_pixmap->winsys = NULL;
       return FALSE;
     }
 
-  egl_tex_pixmap = g_new0 (CoglTexturePixmapEGL, 1);
+  if (egl_renderer->private_features &
+      COGL_EGL_WINSYS_FEATURE_EGL_IMAGE_FROM_X11_PIXMAP)
+    {
+      image = _cogl_egl_create_image (ctx,
+                                      EGL_NATIVE_PIXMAP_KHR,
+                                      (EGLClientBuffer)tex_pixmap->pixmap,
+                                      attribs);
+    }
 
-  egl_tex_pixmap->image =
-    _cogl_egl_create_image (ctx,
-                            EGL_NATIVE_PIXMAP_KHR,
-                            (EGLClientBuffer)tex_pixmap->pixmap,
-                            attribs);
-  if (egl_tex_pixmap->image == EGL_NO_IMAGE_KHR)
+#ifdef EGL_EXT_image_dma_buf_import
+  if (image == EGL_NO_IMAGE_KHR && xlib_display->have_dri3_pixmap_buffers)
     {
-      g_free (egl_tex_pixmap);
-      return FALSE;
+      image = create_dma_buf_image (tex_pixmap);
+      if (image != EGL_NO_IMAGE_KHR)
+        COGL_NOTE (TEXTURE_PIXMAP, "Imported pixmap for %p as a dma-buf",
+                   tex_pixmap);
     }
+#endif
+
+  if (image == EGL_NO_IMAGE_KHR)
+    return FALSE;
+
+  egl_tex_pixmap = g_new0 (CoglTexturePixmapEGL, 1);
+  egl_tex_pixmap->image = image;
 
   texture_format = (tex_pixmap->depth >= 32 ?
                     COGL_PIXEL_FORMAT_RGBA_8888_PRE :
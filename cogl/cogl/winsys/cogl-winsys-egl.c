@@ -630,6 +630,13 @@ _cogl_egl_create_image (CoglContext *ctx,
   if (target == EGL_WAYLAND_BUFFER_WL)
     egl_ctx = EGL_NO_CONTEXT;
   else
+#endif
+#ifdef EGL_EXT_image_dma_buf_import
+  /* The same goes for EGL_LINUX_DMA_BUF_EXT, as required by
+   * EGL_EXT_image_dma_buf_import */
+  if (target == EGL_LINUX_DMA_BUF_EXT)
+    egl_ctx = EGL_NO_CONTEXT;
+  else
 #endif
     egl_ctx = egl_display->egl_context;
 
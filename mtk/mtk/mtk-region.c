@@ -29,9 +29,83 @@
 
 struct _MtkRegion
 {
+  gatomicrefcount ref_count;
+
   pixman_region32_t inner_region;
 };
 
+/* Regions are created and destroyed at a high rate while processing
+ * damage and culling each frame. pixman stores regions made of a single
+ * rectangle inline, so keeping a small per thread cache of region structs
+ * around makes creating and destroying such regions free of heap
+ * allocations. Regions may be freed by a different thread than the one
+ * that created them; they end up in the cache of the freeing thread.
+ */
+#define REGION_CACHE_SIZE 64
+
+typedef struct _RegionCache
+{
+  int n_regions;
+  MtkRegion *regions[REGION_CACHE_SIZE];
+} RegionCache;
+
+static void
+region_cache_free (gpointer data)
+{
+  RegionCache *cache = data;
+  int i;
+
+  for (i = 0; i < cache->n_regions; i++)
+    g_free (cache->regions[i]);
+  g_free (cache);
+}
+
+static GPrivate region_cache_private = G_PRIVATE_INIT (region_cache_free);
+
+static RegionCache *
+get_region_cache (void)
+{
+  RegionCache *cache;
+
+  cache = g_private_get (&region_cache_private);
+  if (G_UNLIKELY (!cache))
+    {
+      cache = g_new0 (RegionCache, 1);
+      g_private_set (&region_cache_private, cache);
+    }
+
+  return cache;
+}
+
+static MtkRegion *
+region_alloc (void)
+{
+  RegionCache *cache = get_region_cache ();
+  MtkRegion *region;
+
+  if (cache->n_regions > 0)
+    region = cache->regions[--cache->n_regions];
+  else
+    region = g_new (MtkRegion, 1);
+
+  g_atomic_ref_count_init (&region->ref_count);
+
+  return region;
+}
+
+static void
+region_free (MtkRegion *region)
+{
+  RegionCache *cache = get_region_cache ();
+
+  pixman_region32_fini (&region->inner_region);
+
+  if (cache->n_regions < REGION_CACHE_SIZE)
+    cache->regions[cache->n_regions++] = region;
+  else
+    g_free (region);
+}
+
 /**
  * mtk_region_ref:
  * @region: A region
@@ -45,15 +119,9 @@ mtk_region_ref (MtkRegion *region)
 {
   g_return_val_if_fail (region != NULL, NULL);
 
-  return g_atomic_rc_box_acquire (region);
-}
-
-static void
-clear_region (gpointer data)
-{
-  MtkRegion *region = data;
+  g_atomic_ref_count_inc (&region->ref_count);
 
-  pixman_region32_fini (&region->inner_region);
+  return region;
 }
 
 void
@@ -61,7 +129,8 @@ mtk_region_unref (MtkRegion *region)
 {
   g_return_if_fail (region != NULL);
 
-  g_atomic_rc_box_release_full (region, clear_region);
+  if (g_atomic_ref_count_dec (&region->ref_count))
+    region_free (region);
 }
 
 G_DEFINE_BOXED_TYPE (MtkRegion, mtk_region,
@@ -72,7 +141,7 @@ mtk_region_create (void)
 {
   MtkRegion *region;
 
-  region = g_atomic_rc_box_new0 (MtkRegion);
+  region = region_alloc ();
 
   pixman_region32_init (&region->inner_region);
 
@@ -182,18 +251,13 @@ void
 mtk_region_union_rectangle (MtkRegion          *region,
                             const MtkRectangle *rect)
 {
-  pixman_region32_t pixman_region;
-
   g_return_if_fail (region != NULL);
   g_return_if_fail (rect != NULL);
 
-  pixman_region32_init_rect (&pixman_region,
-                             rect->x, rect->y,
-                             rect->width, rect->height);
-  pixman_region32_union (&region->inner_region,
-                         &region->inner_region,
-                         &pixman_region);
-  pixman_region32_fini (&pixman_region);
+  pixman_region32_union_rect (&region->inner_region,
+                              &region->inner_region,
+                              rect->x, rect->y,
+                              rect->width, rect->height);
 }
 
 void
@@ -293,7 +357,7 @@ mtk_region_create_rectangle (const MtkRectangle *rect)
   MtkRegion *region;
   g_return_val_if_fail (rect != NULL, NULL);
 
-  region = g_atomic_rc_box_new0 (MtkRegion);
+  region = region_alloc ();
 
   pixman_region32_init_rect (&region->inner_region,
                              rect->x, rect->y,
@@ -313,7 +377,7 @@ mtk_region_create_rectangles (const MtkRectangle *rects,
   g_return_val_if_fail (rects != NULL, NULL);
   g_return_val_if_fail (n_rects != 0, NULL);
 
-  region = g_atomic_rc_box_new0 (MtkRegion);
+  region = mtk_region_create ();
 
   if (n_rects == 1)
     {
@@ -380,6 +444,61 @@ mtk_region_contains_rectangle (const MtkRegion    *region,
     }
 }
 
+/* Scaling by positive integers and translating by integers keeps the
+ * order of the rectangles and the band structure of the region intact,
+ * so it can be done on a copy of the region without having to sort and
+ * validate the rectangles again.
+ */
+static MtkRegion *
+copy_and_scale_translate (const MtkRegion *region,
+                          int              x_scale,
+                          int              y_scale,
+                          int              dx,
+                          int              dy)
+{
+  MtkRegion *copy;
+  pixman_box32_t *boxes;
+  int n_boxes, i;
+
+  g_assert (x_scale > 0 && y_scale > 0);
+
+  copy = mtk_region_copy (region);
+  if (!copy)
+    return NULL;
+
+  if (x_scale == 1 && y_scale == 1)
+    {
+      if (dx != 0 || dy != 0)
+        pixman_region32_translate (&copy->inner_region, dx, dy);
+      return copy;
+    }
+
+  if (!pixman_region32_not_empty (&copy->inner_region))
+    return copy;
+
+  boxes = pixman_region32_rectangles (&copy->inner_region, &n_boxes);
+  for (i = 0; i < n_boxes; i++)
+    {
+      boxes[i].x1 = boxes[i].x1 * x_scale + dx;
+      boxes[i].y1 = boxes[i].y1 * y_scale + dy;
+      boxes[i].x2 = boxes[i].x2 * x_scale + dx;
+      boxes[i].y2 = boxes[i].y2 * y_scale + dy;
+    }
+
+  /* Single rectangle regions store their only box in the extents */
+  if (boxes != &copy->inner_region.extents)
+    {
+      pixman_box32_t *extents = &copy->inner_region.extents;
+
+      extents->x1 = extents->x1 * x_scale + dx;
+      extents->y1 = extents->y1 * y_scale + dy;
+      extents->x2 = extents->x2 * x_scale + dx;
+      extents->y2 = extents->y2 * y_scale + dy;
+    }
+
+  return copy;
+}
+
 MtkRegion *
 mtk_region_scale (MtkRegion *region,
                   int        scale)
@@ -391,6 +510,9 @@ mtk_region_scale (MtkRegion *region,
   if (scale == 1)
     return mtk_region_copy (region);
 
+  if (scale > 0)
+    return copy_and_scale_translate (region, scale, scale, 0, 0);
+
   n_rects = mtk_region_num_rectangles (region);
   MTK_RECTANGLE_CREATE_ARRAY_SCOPED (n_rects, rects);
   for (i = 0; i < n_rects; i++)
@@ -463,9 +585,28 @@ mtk_region_apply_matrix_transform_expand (const MtkRegion   *region,
   MtkRectangle *rects;
   int n_rects, i;
 
+  double xx, yx, xy, yy, x0, y0;
+
   if (graphene_matrix_is_identity (transform))
     return mtk_region_copy (region);
 
+  if (mtk_region_is_empty (region))
+    return mtk_region_copy (region);
+
+  /* Most transforms seen while culling are integer translations, e.g. of
+   * window actors, or integer scales, which map rectangles exactly. */
+  if (graphene_matrix_to_2d (transform, &xx, &yx, &xy, &yy, &x0, &y0) &&
+      yx == 0.0 && xy == 0.0 &&
+      xx >= 1.0 && xx == floor (xx) && xx <= G_MAXINT16 &&
+      yy >= 1.0 && yy == floor (yy) && yy <= G_MAXINT16 &&
+      x0 == floor (x0) && fabs (x0) <= G_MAXINT32 &&
+      y0 == floor (y0) && fabs (y0) <= G_MAXINT32)
+    {
+      return copy_and_scale_translate (region,
+                                       (int) xx, (int) yy,
+                                       (int) x0, (int) y0);
+    }
+
   n_rects = mtk_region_num_rectangles (region);
   MTK_RECTANGLE_CREATE_ARRAY_SCOPED (n_rects, rects);
   for (i = 0; i < n_rects; i++)
@@ -120,6 +120,19 @@ meta_edid_info_new_parse (const uint8_t *edid,
   return g_steal_pointer (&info);
 }
 
+MetaEdidInfo *
+meta_edid_info_copy (const MetaEdidInfo *info)
+{
+  MetaEdidInfo *copy;
+
+  copy = g_memdup2 (info, sizeof (*info));
+  copy->manufacturer_code = g_strdup (info->manufacturer_code);
+  copy->dsc_serial_number = g_strdup (info->dsc_serial_number);
+  copy->dsc_product_name = g_strdup (info->dsc_product_name);
+
+  return copy;
+}
+
 void
 meta_edid_info_free (MetaEdidInfo *info)
 {
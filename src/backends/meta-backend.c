@@ -1159,6 +1159,61 @@ update_pointer_visibility_from_event (MetaBackend  *backend,
     }
 }
 
+static gboolean
+can_coalesce_motion (const ClutterEvent *event,
+                     const ClutterEvent *next_event)
+{
+  if (clutter_event_type (event) != CLUTTER_MOTION ||
+      clutter_event_type (next_event) != CLUTTER_MOTION)
+    return FALSE;
+
+  /* Tablet tools keep their full rate, e.g. for drawing applications */
+  if (clutter_event_get_device_tool (event) ||
+      clutter_event_get_device_tool (next_event))
+    return FALSE;
+
+  if ((clutter_event_get_flags (event) & CLUTTER_EVENT_FLAG_SYNTHETIC) ||
+      (clutter_event_get_flags (next_event) & CLUTTER_EVENT_FLAG_SYNTHETIC))
+    return FALSE;
+
+  return (clutter_event_get_device (event) ==
+          clutter_event_get_device (next_event) &&
+          clutter_event_get_state (event) ==
+          clutter_event_get_state (next_event));
+}
+
+static ClutterEvent *
+get_clutter_event (void)
+{
+  ClutterEvent *event;
+  const ClutterEvent *next_event;
+
+  event = clutter_event_get ();
+  if (!event)
+    return NULL;
+
+  /* Pointer motion queued faster than it is dispatched, e.g. from high
+   * polling rate mice, is coalesced into a single event, so that it is
+   * picked and forwarded to clients once. The relative motion is
+   * accumulated, so relative pointer clients still get all of it.
+   */
+  while ((next_event = clutter_event_peek ()) &&
+         can_coalesce_motion (event, next_event))
+    {
+      ClutterEvent *coalesced_event;
+
+      coalesced_event = clutter_event_coalesce_motion (next_event, event);
+      if (!coalesced_event)
+        break;
+
+      clutter_event_free (clutter_event_get ());
+      clutter_event_free (event);
+      event = coalesced_event;
+    }
+
+  return event;
+}
+
 static gboolean
 dispatch_clutter_event (MetaBackend *backend)
 {
@@ -1166,7 +1221,7 @@ dispatch_clutter_event (MetaBackend *backend)
   ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
   ClutterEvent *event;
 
-  event = clutter_event_get ();
+  event = get_clutter_event ();
   if (event)
     {
       g_warn_if_fail (!priv->in_init ||
@@ -1319,6 +1374,9 @@ meta_backend_initable_init (GInitable     *initable,
 
   g_assert (priv->context);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInit,
+                           "Meta::Backend::init()");
+
   priv->cancellable = g_cancellable_new ();
 
   g_bus_get (G_BUS_TYPE_SYSTEM,
@@ -1377,19 +1435,34 @@ meta_backend_initable_init (GInitable     *initable,
       !META_BACKEND_GET_CLASS (backend)->init_basic (backend, error))
     return FALSE;
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitMonitorManager,
+                           "Meta::Backend::init#monitor_manager()");
+
   priv->monitor_manager = meta_backend_create_monitor_manager (backend, error);
   if (!priv->monitor_manager)
     return FALSE;
 
+  COGL_TRACE_END (MetaBackendInitMonitorManager);
+
   priv->color_manager = meta_backend_create_color_manager (backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitRenderer,
+                           "Meta::Backend::init#renderer()");
+
   priv->renderer = meta_backend_create_renderer (backend, error);
   if (!priv->renderer)
     return FALSE;
 
+  COGL_TRACE_END (MetaBackendInitRenderer);
+
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitClutter,
+                           "Meta::Backend::init#clutter()");
+
   if (!init_clutter (backend, error))
     return FALSE;
 
+  COGL_TRACE_END (MetaBackendInitClutter);
+
   g_signal_connect_object (priv->default_seat, "device-added",
                            G_CALLBACK (on_device_added), backend, 0);
   g_signal_connect_object (priv->default_seat, "device-removed",
@@ -1400,16 +1473,29 @@ meta_backend_initable_init (GInitable     *initable,
 
   priv->input_mapper = meta_backend_create_input_mapper (backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitRender,
+                           "Meta::Backend::init#render()");
+
   if (META_BACKEND_GET_CLASS (backend)->init_render &&
       !META_BACKEND_GET_CLASS (backend)->init_render (backend, error))
     return FALSE;
 
   init_stage (backend);
 
+  COGL_TRACE_END (MetaBackendInitRender);
+
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitMonitors,
+                           "Meta::Backend::init#monitors()");
+
   meta_monitor_manager_setup (priv->monitor_manager);
 
   meta_backend_update_stage (backend);
 
+  COGL_TRACE_END (MetaBackendInitMonitors);
+
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitRemoteAccess,
+                           "Meta::Backend::init#remote_access()");
+
   priv->remote_access_controller =
     meta_remote_access_controller_new ();
 
@@ -1433,6 +1519,8 @@ meta_backend_initable_init (GInitable     *initable,
     priv->remote_access_controller,
     META_DBUS_SESSION_MANAGER (priv->input_capture));
 
+  COGL_TRACE_END (MetaBackendInitRemoteAccess);
+
   if (!meta_monitor_manager_is_headless (priv->monitor_manager))
     init_pointer_position (backend);
 
@@ -1445,10 +1533,15 @@ meta_backend_initable_init (GInitable     *initable,
 
   meta_settings_post_init (priv->settings);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitPost,
+                           "Meta::Backend::init#post()");
+
   if (META_BACKEND_GET_CLASS (backend)->init_post &&
       !META_BACKEND_GET_CLASS (backend)->init_post (backend, error))
     return FALSE;
 
+  COGL_TRACE_END (MetaBackendInitPost);
+
   while (TRUE)
     {
       if (!dispatch_clutter_event (backend))
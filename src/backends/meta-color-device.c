@@ -215,51 +215,28 @@ on_cd_device_changed (CdDevice        *cd_device,
   update_assigned_profile (color_device);
 }
 
-typedef struct
-{
-  GMainLoop *loop;
-  CdDevice *cd_device;
-  GError *error;
-} FindDeviceData;
-
 static void
-on_find_device (GObject      *source_object,
-                GAsyncResult *res,
-                gpointer      user_data)
+on_find_device_for_deletion (GObject      *source_object,
+                             GAsyncResult *res,
+                             gpointer      user_data)
 {
   CdClient *cd_client = CD_CLIENT (source_object);
-  FindDeviceData *data = user_data;
+  g_autofree char *cd_device_id = user_data;
+  g_autoptr (CdDevice) cd_device = NULL;
+  g_autoptr (GError) error = NULL;
 
-  data->cd_device = cd_client_find_device_finish (cd_client, res, &data->error);
-  g_main_loop_quit (data->loop);
-}
+  cd_device = cd_client_find_device_finish (cd_client, res, &error);
+  if (!cd_device)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        {
+          g_warning ("Failed to find colord device %s: %s",
+                     cd_device_id, error->message);
+        }
+      return;
+    }
 
-static CdDevice *
-find_device_sync (CdClient    *cd_client,
-                  const char  *cd_device_id,
-                  GError     **error)
-{
-  g_autoptr (GMainContext) main_context = NULL;
-  g_autoptr (GMainLoop) main_loop = NULL;
-  FindDeviceData data = {};
-
-  main_context = g_main_context_new ();
-  main_loop = g_main_loop_new (main_context, FALSE);
-  g_main_context_push_thread_default (main_context);
-
-  data = (FindDeviceData) {
-    .loop = main_loop,
-  };
-  cd_client_find_device (cd_client, cd_device_id, NULL,
-                         on_find_device,
-                         &data);
-  g_main_loop_run (main_loop);
-
-  g_main_context_pop_thread_default (main_context);
-
-  if (data.error)
-    g_propagate_error (error, data.error);
-  return data.cd_device;
+  cd_client_delete_device (cd_client, cd_device, NULL, NULL, NULL);
 }
 
 static void
@@ -296,21 +273,17 @@ meta_color_device_dispose (GObject *object)
   if (!cd_device && !color_device->is_ready &&
       cd_device_id && meta_color_manager_is_ready (color_manager))
     {
-      g_autoptr (GError) error = NULL;
-
-      cd_device = find_device_sync (cd_client,
-                                    cd_device_id,
-                                    &error);
-      if (!cd_device &&
-          !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-        {
-          g_warning ("Failed to find colord device %s: %s",
-                     cd_device_id, error->message);
-        }
+      /* The device may still be in the process of being created; colord
+       * handles requests from the same connection in order, so the lookup
+       * will find it once the creation has completed. */
+      cd_client_find_device (cd_client, cd_device_id, NULL,
+                             on_find_device_for_deletion,
+                             g_strdup (cd_device_id));
+    }
+  else if (cd_device)
+    {
+      cd_client_delete_device (cd_client, cd_device, NULL, NULL, NULL);
     }
-
-  if (cd_device)
-    cd_client_delete_device (cd_client, cd_device, NULL, NULL, NULL);
 
   g_clear_pointer (&color_device->cd_device_id, g_free);
   g_clear_object (&color_device->cd_device);
@@ -969,23 +942,102 @@ save_icc_profile (const char *file_path,
                            task);
 }
 
-static CdIcc *
-create_icc_profile_from_edid (MetaColorDevice     *color_device,
-                              const MetaEdidInfo  *edid_info,
-                              const char          *file_path,
-                              GError             **error)
+static void
+set_icc_checksum (CdIcc  *cd_icc,
+                  GBytes *bytes)
+{
+  g_autofree char *md5_checksum = NULL;
+
+  md5_checksum = g_compute_checksum_for_bytes (G_CHECKSUM_MD5, bytes);
+  cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_FILE_CHECKSUM, md5_checksum);
+}
+
+/* Everything needed to generate a device profile, copied from the monitor so
+ * that the profile can be generated in a thread */
+typedef struct
+{
+  char *device_id;
+  char *file_path;
+  MetaEdidInfo *edid_info;
+  cmsContext lcms_context;
+
+  char *edid_checksum_md5;
+  char *product;
+  char *vendor;
+  char *vendor_name;
+  char *serial;
+  char *display_name;
+
+  gboolean from_cache;
+  CdIcc *cd_icc;
+  GBytes *bytes;
+} ProfileGenerationData;
+
+static ProfileGenerationData *
+profile_generation_data_new (MetaColorDevice *color_device,
+                             const char      *file_path)
 {
   MetaColorManager *color_manager = color_device->color_manager;
   MetaMonitor *monitor = color_device->monitor;
+  const MetaEdidInfo *edid_info = meta_monitor_get_edid_info (monitor);
+  ProfileGenerationData *generation_data;
+  const char *vendor;
+
+  vendor = meta_monitor_get_vendor (monitor);
+
+  generation_data = g_new0 (ProfileGenerationData, 1);
+  generation_data->device_id = g_strdup (color_device->cd_device_id);
+  generation_data->file_path = g_strdup (file_path);
+  generation_data->edid_info =
+    edid_info ? meta_edid_info_copy (edid_info) : NULL;
+  generation_data->lcms_context =
+    meta_color_manager_get_lcms_context (color_manager);
+  generation_data->edid_checksum_md5 =
+    g_strdup (meta_monitor_get_edid_checksum_md5 (monitor));
+  generation_data->product = g_strdup (meta_monitor_get_product (monitor));
+  generation_data->vendor = g_strdup (vendor);
+  if (vendor)
+    {
+      MetaBackend *backend = meta_monitor_get_backend (monitor);
+
+      generation_data->vendor_name =
+        meta_backend_get_vendor_name (backend, vendor);
+    }
+  generation_data->serial = g_strdup (meta_monitor_get_serial (monitor));
+  generation_data->display_name =
+    g_strdup (meta_monitor_get_display_name (monitor));
+
+  return generation_data;
+}
+
+static void
+profile_generation_data_free (ProfileGenerationData *generation_data)
+{
+  g_free (generation_data->device_id);
+  g_free (generation_data->file_path);
+  g_clear_pointer (&generation_data->edid_info, meta_edid_info_free);
+  g_free (generation_data->edid_checksum_md5);
+  g_free (generation_data->product);
+  g_free (generation_data->vendor);
+  g_free (generation_data->vendor_name);
+  g_free (generation_data->serial);
+  g_free (generation_data->display_name);
+  g_clear_object (&generation_data->cd_icc);
+  g_clear_pointer (&generation_data->bytes, g_bytes_unref);
+  g_free (generation_data);
+}
+
+static CdIcc *
+create_icc_profile_from_edid (ProfileGenerationData  *generation_data,
+                              GError                **error)
+{
+  const MetaEdidInfo *edid_info = generation_data->edid_info;
   g_autoptr (CdIcc) cd_icc = NULL;
   cmsCIExyYTRIPLE chroma;
   cmsCIExyY white_point;
   cmsToneCurve *transfer_curve[3] = { NULL, NULL, NULL };
-  cmsContext lcms_context;
   const char *product;
-  const char *vendor;
-  const char *serial;
-  g_autofree char *vendor_name = NULL;
+  const char *vendor_name;
   cmsHPROFILE lcms_profile;
   const struct di_color_primaries *primaries =
     &edid_info->default_color_primaries;
@@ -1001,7 +1053,7 @@ create_icc_profile_from_edid (MetaColorDevice     *color_device,
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                    "EDID for %s contains bogus Color Characteristics",
-                   meta_color_device_get_id (color_device));
+                   generation_data->device_id);
       return NULL;
     }
 
@@ -1011,12 +1063,11 @@ create_icc_profile_from_edid (MetaColorDevice     *color_device,
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                    "EDID for %s contains bogus Display Transfer "
                    "Characteristics (GAMMA)",
-                   meta_color_device_get_id (color_device));
+                   generation_data->device_id);
       return NULL;
     }
 
-  lcms_context = meta_color_manager_get_lcms_context (color_manager);
-  if (!lcms_context)
+  if (!generation_data->lcms_context)
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                    "Internal error: no LCMS context available");
@@ -1040,7 +1091,7 @@ create_icc_profile_from_edid (MetaColorDevice     *color_device,
   transfer_curve[1] = transfer_curve[0];
   transfer_curve[2] = transfer_curve[0];
 
-  lcms_profile = cmsCreateRGBProfileTHR (lcms_context,
+  lcms_profile = cmsCreateRGBProfileTHR (generation_data->lcms_context,
                                          &white_point,
                                          &chroma,
                                          transfer_curve);
@@ -1051,7 +1102,7 @@ create_icc_profile_from_edid (MetaColorDevice     *color_device,
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                    "cmsCreateRGBProfileTHR for %s failed",
-                   meta_color_device_get_id (color_device));
+                   generation_data->device_id);
       return NULL;
     }
 
@@ -1063,52 +1114,49 @@ create_icc_profile_from_edid (MetaColorDevice     *color_device,
                            CD_ICC_LOAD_FLAGS_PRIMARIES, error))
     return NULL;
 
-  cd_icc_add_metadata (cd_icc, CD_PROFILE_PROPERTY_FILENAME, file_path);
+  cd_icc_add_metadata (cd_icc, CD_PROFILE_PROPERTY_FILENAME,
+                       generation_data->file_path);
   cd_icc_add_metadata (cd_icc,
                        CD_PROFILE_METADATA_DATA_SOURCE,
                        CD_PROFILE_METADATA_DATA_SOURCE_EDID);
   cd_icc_set_copyright (cd_icc, NULL,
                         "This profile is free of known copyright restrictions.");
 
-  product = meta_monitor_get_product (monitor);
-  vendor = meta_monitor_get_vendor (monitor);
-  serial = meta_monitor_get_serial (monitor);
-  if (vendor)
-    {
-      MetaBackend *backend = meta_monitor_get_backend (monitor);
-
-      vendor_name = meta_backend_get_vendor_name (backend, vendor);
-    }
+  product = generation_data->product;
 
   /* set 'ICC meta Tag for Monitor Profiles' data */
   cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_EDID_MD5,
-                       meta_monitor_get_edid_checksum_md5 (monitor));
+                       generation_data->edid_checksum_md5);
   if (product)
     cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_EDID_MODEL, product);
-  if (serial)
-    cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_EDID_SERIAL, serial);
-  if (vendor)
-    cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_EDID_MNFT, vendor);
-  if (vendor_name)
+  if (generation_data->serial)
+    {
+      cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_EDID_SERIAL,
+                           generation_data->serial);
+    }
+  if (generation_data->vendor)
+    {
+      cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_EDID_MNFT,
+                           generation_data->vendor);
+    }
+  if (generation_data->vendor_name)
     {
       cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_EDID_VENDOR,
-                           vendor_name);
+                           generation_data->vendor_name);
     }
 
   /* Set high level monitor details metadata */
   if (!product)
     product = "Unknown monitor";
   cd_icc_set_model (cd_icc, NULL, product);
-  cd_icc_set_description (cd_icc, NULL,
-                          meta_monitor_get_display_name (monitor));
+  cd_icc_set_description (cd_icc, NULL, generation_data->display_name);
 
-  if (!vendor_name)
-    {
-      if (vendor)
-        vendor_name = g_strdup (vendor);
-      else
-        vendor_name = g_strdup ("Unknown vendor");
-    }
+  if (generation_data->vendor_name)
+    vendor_name = generation_data->vendor_name;
+  else if (generation_data->vendor)
+    vendor_name = generation_data->vendor;
+  else
+    vendor_name = "Unknown vendor";
   cd_icc_set_manufacturer (cd_icc, NULL, vendor_name);
 
   /* Set the framework creator metadata */
@@ -1123,39 +1171,84 @@ create_icc_profile_from_edid (MetaColorDevice     *color_device,
                        PACKAGE_VERSION);
   cd_icc_add_metadata (cd_icc,
                        CD_PROFILE_METADATA_MAPPING_DEVICE_ID,
-                       color_device->cd_device_id);
+                       generation_data->device_id);
 
   return g_steal_pointer (&cd_icc);
 }
 
+/* Profiles generated from the EDID end up on disk keyed by the EDID
+ * checksum; reuse one if it was generated for the same EDID and device by
+ * the same version, instead of generating and writing it again */
+static gboolean
+load_cached_device_profile (ProfileGenerationData *generation_data)
+{
+  g_autoptr (CdIcc) cd_icc = NULL;
+  g_autofree char *contents = NULL;
+  size_t length;
+  const char *data_source;
+
+  if (!g_file_get_contents (generation_data->file_path,
+                            &contents, &length, NULL))
+    return FALSE;
+
+  cd_icc = cd_icc_new ();
+  if (!cd_icc_load_data (cd_icc,
+                         (uint8_t *) contents, length,
+                         (CD_ICC_LOAD_FLAGS_METADATA |
+                          CD_ICC_LOAD_FLAGS_PRIMARIES),
+                         NULL))
+    return FALSE;
+
+  if (g_strcmp0 (cd_icc_get_metadata_item (cd_icc,
+                                           CD_PROFILE_METADATA_CMF_VERSION),
+                 PACKAGE_VERSION) != 0)
+    return FALSE;
+
+  if (g_strcmp0 (cd_icc_get_metadata_item (cd_icc,
+                                           CD_PROFILE_METADATA_MAPPING_DEVICE_ID),
+                 generation_data->device_id) != 0)
+    return FALSE;
+
+  if (g_strcmp0 (cd_icc_get_metadata_item (cd_icc,
+                                           CD_PROFILE_METADATA_EDID_MD5),
+                 generation_data->edid_checksum_md5) != 0)
+    return FALSE;
+
+  data_source = cd_icc_get_metadata_item (cd_icc,
+                                          CD_PROFILE_METADATA_DATA_SOURCE);
+  if (g_strcmp0 (data_source, CD_PROFILE_METADATA_DATA_SOURCE_EDID) != 0)
+    return FALSE;
+
+  generation_data->from_cache = TRUE;
+  generation_data->cd_icc = g_steal_pointer (&cd_icc);
+  generation_data->bytes = g_bytes_new_take (g_steal_pointer (&contents),
+                                             length);
+  return TRUE;
+}
+
 static void
-create_device_profile_from_edid (MetaColorDevice *color_device,
-                                 GTask           *task)
+generate_device_profile_in_thread (GTask        *thread_task,
+                                   gpointer      source_object,
+                                   gpointer      task_data,
+                                   GCancellable *cancellable)
 {
-  const MetaEdidInfo *edid_info =
-    meta_monitor_get_edid_info (color_device->monitor);
-  GenerateProfileData *data = g_task_get_task_data (task);
+  ProfileGenerationData *generation_data = task_data;
   g_autoptr (CdIcc) cd_icc = NULL;
-  g_autoptr (GBytes) bytes = NULL;
-  g_autofree char *file_md5_checksum = NULL;
   g_autoptr (GError) error = NULL;
 
-  if (edid_info)
+  if (generation_data->edid_info &&
+      load_cached_device_profile (generation_data))
     {
-      meta_topic (META_DEBUG_COLOR,
-                  "Generating ICC profile for '%s' from EDID",
-                  meta_color_device_get_id (color_device));
+      g_task_return_boolean (thread_task, TRUE);
+      return;
+    }
 
-      cd_icc = create_icc_profile_from_edid (color_device,
-                                             edid_info, data->file_path,
-                                             &error);
+  if (generation_data->edid_info)
+    {
+      cd_icc = create_icc_profile_from_edid (generation_data, &error);
     }
   else
     {
-      meta_topic (META_DEBUG_COLOR,
-                  "Generating sRGB ICC profile for '%s' because EDID is missing",
-                  meta_color_device_get_id (color_device));
-
       cd_icc = cd_icc_new ();
 
       if (!cd_icc_create_default_full (cd_icc,
@@ -1166,38 +1259,97 @@ create_device_profile_from_edid (MetaColorDevice *color_device,
 
   if (!cd_icc)
     {
-      g_task_return_error (task, g_steal_pointer (&error));
-      g_object_unref (task);
+      g_task_return_error (thread_task, g_steal_pointer (&error));
       return;
     }
 
-  bytes = cd_icc_save_data (cd_icc, CD_ICC_SAVE_FLAGS_NONE, &error);
-  if (!bytes)
+  generation_data->bytes = cd_icc_save_data (cd_icc, CD_ICC_SAVE_FLAGS_NONE,
+                                             &error);
+  if (!generation_data->bytes)
+    {
+      g_task_return_error (thread_task, g_steal_pointer (&error));
+      return;
+    }
+
+  generation_data->cd_icc = g_steal_pointer (&cd_icc);
+  g_task_return_boolean (thread_task, TRUE);
+}
+
+static void
+on_device_profile_generated (GObject      *source_object,
+                             GAsyncResult *res,
+                             gpointer      user_data)
+{
+  GTask *thread_task = G_TASK (res);
+  g_autoptr (GTask) task = G_TASK (user_data);
+  ProfileGenerationData *generation_data =
+    g_task_get_task_data (thread_task);
+  GenerateProfileData *data = g_task_get_task_data (task);
+  g_autoptr (GError) error = NULL;
+
+  if (!g_task_propagate_boolean (thread_task, &error))
     {
       g_task_return_error (task, g_steal_pointer (&error));
-      g_object_unref (task);
       return;
     }
 
-  file_md5_checksum = g_compute_checksum_for_bytes (G_CHECKSUM_MD5, bytes);
-  cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_FILE_CHECKSUM,
-                       file_md5_checksum);
+  set_icc_checksum (generation_data->cd_icc, generation_data->bytes);
 
   data->color_calibration =
-    meta_color_calibration_new (cd_icc, NULL);
-  data->cd_icc = g_steal_pointer (&cd_icc);
-  data->bytes = g_steal_pointer (&bytes);
-  save_icc_profile (data->file_path, task);
+    meta_color_calibration_new (generation_data->cd_icc, NULL);
+  data->cd_icc = g_steal_pointer (&generation_data->cd_icc);
+  data->bytes = g_steal_pointer (&generation_data->bytes);
+
+  if (generation_data->from_cache)
+    {
+      MetaColorProfile *color_profile;
+
+      meta_topic (META_DEBUG_COLOR,
+                  "Using cached device profile '%s'", data->file_path);
+
+      color_profile =
+        meta_color_profile_new_from_icc (data->color_device->color_manager,
+                                         g_steal_pointer (&data->cd_icc),
+                                         g_steal_pointer (&data->bytes),
+                                         g_steal_pointer (&data->color_calibration));
+      g_task_return_pointer (task, color_profile, g_object_unref);
+      return;
+    }
+
+  save_icc_profile (data->file_path, g_steal_pointer (&task));
 }
 
 static void
-set_icc_checksum (CdIcc  *cd_icc,
-                  GBytes *bytes)
+create_device_profile_from_edid (MetaColorDevice *color_device,
+                                 GTask           *task)
 {
-  g_autofree char *md5_checksum = NULL;
+  GenerateProfileData *data = g_task_get_task_data (task);
+  ProfileGenerationData *generation_data;
+  g_autoptr (GTask) thread_task = NULL;
 
-  md5_checksum = g_compute_checksum_for_bytes (G_CHECKSUM_MD5, bytes);
-  cd_icc_add_metadata (cd_icc, CD_PROFILE_METADATA_FILE_CHECKSUM, md5_checksum);
+  if (meta_monitor_get_edid_info (color_device->monitor))
+    {
+      meta_topic (META_DEBUG_COLOR,
+                  "Generating ICC profile for '%s' from EDID",
+                  meta_color_device_get_id (color_device));
+    }
+  else
+    {
+      meta_topic (META_DEBUG_COLOR,
+                  "Generating sRGB ICC profile for '%s' because EDID is missing",
+                  meta_color_device_get_id (color_device));
+    }
+
+  generation_data = profile_generation_data_new (color_device,
+                                                 data->file_path);
+
+  thread_task = g_task_new (G_OBJECT (color_device),
+                            g_task_get_cancellable (task),
+                            on_device_profile_generated,
+                            task);
+  g_task_set_task_data (thread_task, generation_data,
+                        (GDestroyNotify) profile_generation_data_free);
+  g_task_run_in_thread (thread_task, generate_device_profile_in_thread);
 }
 
 static void
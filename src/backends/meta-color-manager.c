@@ -89,6 +89,7 @@ typedef struct _MetaColorManagerPrivate
 
   CdClient *cd_client;
   GCancellable *cancellable;
+  guint cd_client_connect_id;
 
   GHashTable *devices;
 
@@ -390,6 +391,38 @@ on_gsd_power_screen_ready (GObject      *source_object,
   update_device_properties (color_manager);
 }
 
+static gboolean
+connect_cd_client_idle (gpointer user_data)
+{
+  MetaColorManager *color_manager = META_COLOR_MANAGER (user_data);
+  MetaColorManagerPrivate *priv =
+    meta_color_manager_get_instance_private (color_manager);
+
+  priv->cd_client_connect_id = 0;
+
+  cd_client_connect (priv->cd_client, priv->cancellable, cd_client_connect_cb,
+                     color_manager);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+on_context_started (MetaContext      *context,
+                    MetaColorManager *color_manager)
+{
+  MetaColorManagerPrivate *priv =
+    meta_color_manager_get_instance_private (color_manager);
+
+  /* Syncing devices and profiles with colord isn't needed to show the first
+   * frame, so let startup get there first. */
+  priv->cd_client_connect_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                connect_cd_client_idle,
+                                                color_manager,
+                                                NULL);
+  g_source_set_name_by_id (priv->cd_client_connect_id,
+                           "[mutter] connect_cd_client_idle");
+}
+
 static void
 meta_color_manager_constructed (GObject *object)
 {
@@ -403,8 +436,11 @@ meta_color_manager_constructed (GObject *object)
   priv->temperature = DEFAULT_TEMPERATURE;
 
   priv->cd_client = cd_client_new ();
-  cd_client_connect (priv->cd_client, priv->cancellable, cd_client_connect_cb,
-                     color_manager);
+  g_signal_connect_object (meta_backend_get_context (priv->backend),
+                           "started",
+                           G_CALLBACK (on_context_started),
+                           color_manager,
+                           G_CONNECT_DEFAULT);
 
   meta_dbus_settings_daemon_color_proxy_new_for_bus (
     G_BUS_TYPE_SESSION,
@@ -435,6 +471,7 @@ meta_color_manager_dispose (GObject *object)
   MetaColorManagerPrivate *priv =
     meta_color_manager_get_instance_private (color_manager);
 
+  g_clear_handle_id (&priv->cd_client_connect_id, g_source_remove);
   g_cancellable_cancel (priv->cancellable);
   g_clear_object (&priv->cancellable);
   g_clear_pointer (&priv->devices, g_hash_table_unref);
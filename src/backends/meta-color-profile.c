@@ -58,52 +58,28 @@ struct _MetaColorProfile
 G_DEFINE_TYPE (MetaColorProfile, meta_color_profile,
                G_TYPE_OBJECT)
 
-typedef struct
-{
-  GMainLoop *loop;
-  CdProfile *cd_profile;
-  GError *error;
-} FindProfileData;
-
 static void
-on_find_profile (GObject      *source_object,
-                 GAsyncResult *res,
-                 gpointer      user_data)
+on_find_profile_for_deletion (GObject      *source_object,
+                              GAsyncResult *res,
+                              gpointer      user_data)
 {
   CdClient *cd_client = CD_CLIENT (source_object);
-  FindProfileData *data = user_data;
+  g_autofree char *cd_profile_id = user_data;
+  g_autoptr (CdProfile) cd_profile = NULL;
+  g_autoptr (GError) error = NULL;
 
-  data->cd_profile = cd_client_find_profile_finish (cd_client, res,
-                                                    &data->error);
-  g_main_loop_quit (data->loop);
-}
+  cd_profile = cd_client_find_profile_finish (cd_client, res, &error);
+  if (!cd_profile)
+    {
+      if (!g_error_matches (error, CD_CLIENT_ERROR, CD_CLIENT_ERROR_NOT_FOUND))
+        {
+          g_warning ("Failed to find colord profile %s: %s",
+                     cd_profile_id, error->message);
+        }
+      return;
+    }
 
-static CdProfile *
-find_profile_sync (CdClient    *cd_client,
-                   const char  *cd_profile_id,
-                   GError     **error)
-{
-  g_autoptr (GMainContext) main_context = NULL;
-  g_autoptr (GMainLoop) main_loop = NULL;
-  FindProfileData data = {};
-
-  main_context = g_main_context_new ();
-  main_loop = g_main_loop_new (main_context, FALSE);
-  g_main_context_push_thread_default (main_context);
-
-  data = (FindProfileData) {
-    .loop = main_loop,
-  };
-  cd_client_find_profile (cd_client, cd_profile_id, NULL,
-                          on_find_profile,
-                          &data);
-  g_main_loop_run (main_loop);
-
-  g_main_context_pop_thread_default (main_context);
-
-  if (data.error)
-    g_propagate_error (error, data.error);
-  return data.cd_profile;
+  cd_client_delete_profile (cd_client, cd_profile, NULL, NULL, NULL);
 }
 
 static void
@@ -119,29 +95,21 @@ meta_color_profile_finalize (GObject *object)
 
   if (color_profile->is_owner)
     {
-      CdProfile *cd_profile;
+      CdProfile *cd_profile = color_profile->cd_profile;
 
-      cd_profile = color_profile->cd_profile;
       if (!cd_profile && !color_profile->is_ready)
         {
-          g_autoptr (GError) error = NULL;
-
-          cd_profile = find_profile_sync (cd_client,
-                                          color_profile->cd_profile_id,
-                                          &error);
-          if (!cd_profile &&
-              !g_error_matches (error,
-                                CD_CLIENT_ERROR,
-                                CD_CLIENT_ERROR_NOT_FOUND))
-            {
-              g_warning ("Failed to find colord profile %s: %s",
-                         color_profile->cd_profile_id,
-                         error->message);
-            }
+          /* The profile may still be in the process of being created, see
+           * meta_color_device_dispose(). */
+          cd_client_find_profile (cd_client, color_profile->cd_profile_id,
+                                  NULL,
+                                  on_find_profile_for_deletion,
+                                  g_strdup (color_profile->cd_profile_id));
+        }
+      else if (cd_profile)
+        {
+          cd_client_delete_profile (cd_client, cd_profile, NULL, NULL, NULL);
         }
-
-      if (cd_profile)
-        cd_client_delete_profile (cd_client, cd_profile, NULL, NULL, NULL);
     }
 
   g_clear_pointer (&color_profile->cd_profile_id, g_free);
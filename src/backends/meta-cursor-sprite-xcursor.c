@@ -309,6 +309,18 @@ meta_cursor_sprite_xcursor_get_current_image (MetaCursorSpriteXcursor *sprite_xc
   return sprite_xcursor->xcursor_images->images[sprite_xcursor->current_frame];
 }
 
+int
+meta_cursor_sprite_xcursor_get_current_frame (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  return sprite_xcursor->current_frame;
+}
+
+int
+meta_cursor_sprite_xcursor_get_theme_scale (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  return sprite_xcursor->theme_scale;
+}
+
 static void
 meta_cursor_sprite_xcursor_tick_frame (MetaCursorSprite *sprite)
 {
@@ -641,7 +641,34 @@ meta_egl_create_dmabuf_image (MetaEgl         *egl,
                               const uint64_t  *modifiers,
                               GError         **error)
 {
-  EGLint attribs[39];
+  return meta_egl_create_dmabuf_image_full (egl, egl_display,
+                                            width, height,
+                                            drm_format,
+                                            n_planes,
+                                            fds, strides, offsets,
+                                            modifiers,
+                                            NULL,
+                                            error);
+}
+
+/* @extra_attribs is an optional EGL_NONE terminated list of up to
+ * META_EGL_MAX_EXTRA_DMABUF_IMAGE_ATTRIBS attribute/value pairs, e.g.
+ * color space hints for YUV formats. */
+EGLImageKHR
+meta_egl_create_dmabuf_image_full (MetaEgl         *egl,
+                                   EGLDisplay       egl_display,
+                                   unsigned int     width,
+                                   unsigned int     height,
+                                   uint32_t         drm_format,
+                                   uint32_t         n_planes,
+                                   const int       *fds,
+                                   const uint32_t  *strides,
+                                   const uint32_t  *offsets,
+                                   const uint64_t  *modifiers,
+                                   const EGLint    *extra_attribs,
+                                   GError         **error)
+{
+  EGLint attribs[39 + META_EGL_MAX_EXTRA_DMABUF_IMAGE_ATTRIBS * 2];
   int atti = 0;
 
   /* This requires the Mesa commit in
@@ -712,6 +739,19 @@ meta_egl_create_dmabuf_image (MetaEgl         *egl,
         }
     }
 
+  if (extra_attribs)
+    {
+      int i;
+
+      for (i = 0; extra_attribs[i] != EGL_NONE; i += 2)
+        {
+          g_assert (i < META_EGL_MAX_EXTRA_DMABUF_IMAGE_ATTRIBS * 2);
+
+          attribs[atti++] = extra_attribs[i];
+          attribs[atti++] = extra_attribs[i + 1];
+        }
+    }
+
   attribs[atti++] = EGL_NONE;
   g_assert (atti <= G_N_ELEMENTS (attribs));
 
@@ -753,6 +793,23 @@ meta_egl_swap_buffers (MetaEgl   *egl,
   return TRUE;
 }
 
+gboolean
+meta_egl_query_surface (MetaEgl    *egl,
+                        EGLDisplay  display,
+                        EGLSurface  surface,
+                        EGLint      attribute,
+                        EGLint     *value,
+                        GError    **error)
+{
+  if (!eglQuerySurface (display, surface, attribute, value))
+    {
+      set_egl_error (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 gboolean
 meta_egl_bind_wayland_display (MetaEgl            *egl,
                                EGLDisplay          display,
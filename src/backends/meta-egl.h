@@ -119,6 +119,21 @@ EGLImageKHR meta_egl_create_dmabuf_image (MetaEgl         *egl,
                                           const uint64_t  *modifiers,
                                           GError         **error);
 
+#define META_EGL_MAX_EXTRA_DMABUF_IMAGE_ATTRIBS 4
+
+EGLImageKHR meta_egl_create_dmabuf_image_full (MetaEgl         *egl,
+                                               EGLDisplay       egl_display,
+                                               unsigned int     width,
+                                               unsigned int     height,
+                                               uint32_t         drm_format,
+                                               uint32_t         n_planes,
+                                               const int       *fds,
+                                               const uint32_t  *strides,
+                                               const uint32_t  *offsets,
+                                               const uint64_t  *modifiers,
+                                               const EGLint    *extra_attribs,
+                                               GError         **error);
+
 EGLSurface meta_egl_create_window_surface (MetaEgl            *egl,
                                            EGLDisplay          display,
                                            EGLConfig           config,
@@ -159,6 +174,13 @@ gboolean meta_egl_swap_buffers (MetaEgl   *egl,
                                 EGLSurface surface,
                                 GError   **error);
 
+gboolean meta_egl_query_surface (MetaEgl    *egl,
+                                 EGLDisplay  display,
+                                 EGLSurface  surface,
+                                 EGLint      attribute,
+                                 EGLint     *value,
+                                 GError    **error);
+
 gboolean meta_egl_bind_wayland_display (MetaEgl            *egl,
                                         EGLDisplay          display,
                                         struct wl_display  *wayland_display,
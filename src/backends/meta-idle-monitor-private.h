@@ -34,7 +34,8 @@ typedef struct
   GDestroyNotify            notify;
   guint64                   timeout_msec;
   int                       idle_source_id;
-  GSource                  *timeout_source;
+  GList                    *link;
+  unsigned int              fired_serial;
 } MetaIdleMonitorWatch;
 
 struct _MetaIdleMonitorClass
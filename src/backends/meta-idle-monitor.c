@@ -59,6 +59,17 @@ struct _MetaIdleMonitor
   GHashTable *watches;
   ClutterInputDevice *device;
   int64_t last_event_time;
+
+  /* Idle watches sorted by timeout, sharing a single timeout source. The
+   * idle serial is bumped each time the user becomes active, and watches
+   * that fired during the current idle period carry the current serial.
+   */
+  GSource *timeout_source;
+  GList *idle_watches;
+  GList *next_idle_watch;
+  unsigned int idle_serial;
+
+  GList *user_active_watches;
 };
 
 G_DEFINE_TYPE (MetaIdleMonitor, meta_idle_monitor, G_TYPE_OBJECT)
@@ -95,6 +106,12 @@ meta_idle_monitor_dispose (GObject *object)
   g_clear_pointer (&monitor->watches, g_hash_table_destroy);
   g_clear_object (&monitor->session_proxy);
 
+  if (monitor->timeout_source)
+    {
+      g_source_destroy (monitor->timeout_source);
+      g_clear_pointer (&monitor->timeout_source, g_source_unref);
+    }
+
   G_OBJECT_CLASS (meta_idle_monitor_parent_class)->dispose (object);
 }
 
@@ -157,6 +174,49 @@ meta_idle_monitor_class_init (MetaIdleMonitorClass *klass)
   g_object_class_install_property (object_class, PROP_DEVICE, obj_props[PROP_DEVICE]);
 }
 
+static MetaIdleMonitorWatch *
+get_next_idle_watch (MetaIdleMonitor *monitor)
+{
+  while (monitor->next_idle_watch)
+    {
+      MetaIdleMonitorWatch *watch = monitor->next_idle_watch->data;
+
+      if (watch->fired_serial != monitor->idle_serial)
+        return watch;
+
+      monitor->next_idle_watch = monitor->next_idle_watch->next;
+    }
+
+  return NULL;
+}
+
+static void
+start_idle_period (MetaIdleMonitor *monitor)
+{
+  monitor->idle_serial++;
+  monitor->next_idle_watch = monitor->idle_watches;
+}
+
+static void
+update_timeout (MetaIdleMonitor *monitor)
+{
+  MetaIdleMonitorWatch *watch;
+
+  if (!monitor->timeout_source)
+    return;
+
+  watch = get_next_idle_watch (monitor);
+  if (monitor->inhibited || !watch)
+    {
+      g_source_set_ready_time (monitor->timeout_source, -1);
+      return;
+    }
+
+  g_source_set_ready_time (monitor->timeout_source,
+                           monitor->last_event_time +
+                           watch->timeout_msec * 1000);
+}
+
 static void
 free_watch (gpointer data)
 {
@@ -170,34 +230,23 @@ free_watch (gpointer data)
   if (watch->notify != NULL)
     watch->notify (watch->user_data);
 
-  if (watch->timeout_source != NULL)
-    g_source_destroy (watch->timeout_source);
-
-  g_object_unref (monitor);
-  g_free (watch);
-}
-
-static void
-update_inhibited_watch (gpointer key,
-                        gpointer value,
-                        gpointer user_data)
-{
-  MetaIdleMonitor *monitor = user_data;
-  MetaIdleMonitorWatch *watch = value;
-
-  if (!watch->timeout_source)
-    return;
-
-  if (monitor->inhibited)
+  if (watch->timeout_msec != 0)
     {
-      g_source_set_ready_time (watch->timeout_source, -1);
+      if (monitor->next_idle_watch == watch->link)
+        monitor->next_idle_watch = watch->link->next;
+
+      monitor->idle_watches = g_list_delete_link (monitor->idle_watches,
+                                                  watch->link);
+      update_timeout (monitor);
     }
   else
     {
-      g_source_set_ready_time (watch->timeout_source,
-                               monitor->last_event_time +
-                               watch->timeout_msec * 1000);
+      monitor->user_active_watches =
+        g_list_delete_link (monitor->user_active_watches, watch->link);
     }
+
+  g_object_unref (monitor);
+  g_free (watch);
 }
 
 static void
@@ -209,9 +258,7 @@ update_inhibited (MetaIdleMonitor *monitor,
 
   monitor->inhibited = inhibited;
 
-  g_hash_table_foreach (monitor->watches,
-                        update_inhibited_watch,
-                        monitor);
+  update_timeout (monitor);
 }
 
 static void
@@ -232,11 +279,59 @@ meta_idle_monitor_inhibited_actions_changed (GDBusProxy  *session,
       g_variant_unref (v);
 
       if (!inhibited)
-        monitor->last_event_time = g_get_monotonic_time ();
+        {
+          monitor->last_event_time = g_get_monotonic_time ();
+          start_idle_period (monitor);
+        }
       update_inhibited (monitor, inhibited);
     }
 }
 
+static gboolean
+idle_monitor_dispatch_timeout (GSource     *source,
+                               GSourceFunc  callback,
+                               gpointer     user_data)
+{
+  MetaIdleMonitor *monitor = META_IDLE_MONITOR (user_data);
+  unsigned int idle_serial = monitor->idle_serial;
+  int64_t now;
+
+  now = g_source_get_time (source);
+  if (g_source_get_ready_time (source) > now)
+    return G_SOURCE_CONTINUE;
+
+  g_object_ref (monitor);
+
+  /* Stop when the user became active again from within a callback */
+  while (!monitor->inhibited && monitor->idle_serial == idle_serial)
+    {
+      MetaIdleMonitorWatch *watch;
+
+      watch = get_next_idle_watch (monitor);
+      if (!watch ||
+          monitor->last_event_time + watch->timeout_msec * 1000 > now)
+        break;
+
+      watch->fired_serial = idle_serial;
+      monitor->next_idle_watch = watch->link->next;
+
+      meta_idle_monitor_watch_fire (watch);
+    }
+
+  update_timeout (monitor);
+
+  g_object_unref (monitor);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs idle_monitor_source_funcs = {
+  .prepare = NULL,
+  .check = NULL,
+  .dispatch = idle_monitor_dispatch_timeout,
+  .finalize = NULL,
+};
+
 static void
 meta_idle_monitor_init (MetaIdleMonitor *monitor)
 {
@@ -244,6 +339,13 @@ meta_idle_monitor_init (MetaIdleMonitor *monitor)
 
   monitor->watches = g_hash_table_new_full (NULL, NULL, NULL, free_watch);
   monitor->last_event_time = g_get_monotonic_time ();
+  monitor->idle_serial = 1;
+
+  monitor->timeout_source = g_source_new (&idle_monitor_source_funcs,
+                                          sizeof (GSource));
+  g_source_set_name (monitor->timeout_source, "[mutter] Idle monitor");
+  g_source_set_callback (monitor->timeout_source, NULL, monitor, NULL);
+  g_source_attach (monitor->timeout_source, NULL);
 
   /* Monitor inhibitors */
   monitor->session_proxy =
@@ -283,33 +385,34 @@ get_next_watch_serial (void)
   return serial;
 }
 
-static gboolean
-idle_monitor_dispatch_timeout (GSource     *source,
-                               GSourceFunc  callback,
-                               gpointer     user_data)
+static void
+insert_idle_watch (MetaIdleMonitor      *monitor,
+                   MetaIdleMonitorWatch *watch)
 {
-  MetaIdleMonitorWatch *watch = (MetaIdleMonitorWatch *) user_data;
-  int64_t now;
-  int64_t ready_time;
+  gboolean is_before_next = TRUE;
+  GList *l;
 
-  now = g_source_get_time (source);
-  ready_time = g_source_get_ready_time (source);
-  if (ready_time > now)
-    return G_SOURCE_CONTINUE;
+  for (l = monitor->idle_watches; l; l = l->next)
+    {
+      MetaIdleMonitorWatch *other_watch = l->data;
 
-  g_source_set_ready_time (watch->timeout_source, -1);
+      if (other_watch->timeout_msec > watch->timeout_msec)
+        break;
 
-  meta_idle_monitor_watch_fire (watch);
+      if (l == monitor->next_idle_watch)
+        is_before_next = FALSE;
+    }
 
-  return G_SOURCE_CONTINUE;
-}
+  monitor->idle_watches = g_list_insert_before (monitor->idle_watches,
+                                                l, watch);
+  watch->link = l ? l->prev : g_list_last (monitor->idle_watches);
 
-static GSourceFuncs idle_monitor_source_funcs = {
-  .prepare = NULL,
-  .check = NULL,
-  .dispatch = idle_monitor_dispatch_timeout,
-  .finalize = NULL,
-};
+  /* A watch with a timeout shorter than the time the user has already been
+   * idle for fires right away, just as it would have when added before.
+   */
+  if (is_before_next)
+    monitor->next_idle_watch = watch->link;
+}
 
 static MetaIdleMonitorWatch *
 make_watch (MetaIdleMonitor           *monitor,
@@ -331,21 +434,14 @@ make_watch (MetaIdleMonitor           *monitor,
 
   if (timeout_msec != 0)
     {
-      GSource *source = g_source_new (&idle_monitor_source_funcs,
-                                      sizeof (GSource));
-      g_source_set_name (source, "[mutter] Idle monitor");
-
-      g_source_set_callback (source, NULL, watch, NULL);
-      if (!monitor->inhibited)
-        {
-          g_source_set_ready_time (source,
-                                   monitor->last_event_time +
-                                   timeout_msec * 1000);
-        }
-      g_source_attach (source, NULL);
-      g_source_unref (source);
-
-      watch->timeout_source = source;
+      insert_idle_watch (monitor, watch);
+      update_timeout (monitor);
+    }
+  else
+    {
+      monitor->user_active_watches =
+        g_list_prepend (monitor->user_active_watches, watch);
+      watch->link = monitor->user_active_watches;
     }
 
   g_hash_table_insert (monitor->watches,
@@ -468,11 +564,20 @@ meta_idle_monitor_get_idletime (MetaIdleMonitor *monitor)
 void
 meta_idle_monitor_reset_idletime (MetaIdleMonitor *monitor)
 {
-  GList *node, *watch_ids;
+  GList *node, *watch_ids = NULL;
 
   monitor->last_event_time = g_get_monotonic_time ();
+  start_idle_period (monitor);
+
+  /* Only user active watches need to be looked at for every input event,
+   * idle watches are all rescheduled by moving the shared timeout.
+   */
+  for (node = monitor->user_active_watches; node; node = node->next)
+    {
+      MetaIdleMonitorWatch *watch = node->data;
 
-  watch_ids = g_hash_table_get_keys (monitor->watches);
+      watch_ids = g_list_prepend (watch_ids, GUINT_TO_POINTER (watch->id));
+    }
 
   for (node = watch_ids; node != NULL; node = node->next)
     {
@@ -484,26 +589,12 @@ meta_idle_monitor_reset_idletime (MetaIdleMonitor *monitor)
       if (!watch)
         continue;
 
-      if (watch->timeout_msec == 0)
-        {
-          meta_idle_monitor_watch_fire (watch);
-        }
-      else
-        {
-          if (monitor->inhibited)
-            {
-              g_source_set_ready_time (watch->timeout_source, -1);
-            }
-          else
-            {
-              g_source_set_ready_time (watch->timeout_source,
-                                       monitor->last_event_time +
-                                       watch->timeout_msec * 1000);
-            }
-        }
+      meta_idle_monitor_watch_fire (watch);
     }
 
   g_list_free (watch_ids);
+
+  update_timeout (monitor);
 }
 
 MetaIdleManager *
@@ -157,6 +157,101 @@ find_unassigned_crtc (MetaOutput *output,
   return NULL;
 }
 
+static gboolean
+is_possible_crtc (MetaOutput *output,
+                  MetaCrtc   *crtc)
+{
+  const MetaOutputInfo *output_info = meta_output_get_info (output);
+  unsigned int i;
+
+  for (i = 0; i < output_info->n_possible_crtcs; i++)
+    {
+      if (output_info->possible_crtcs[i] == crtc)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+is_possible_clone (MetaOutput *output,
+                   MetaOutput *other_output)
+{
+  const MetaOutputInfo *output_info = meta_output_get_info (output);
+  unsigned int i;
+
+  for (i = 0; i < output_info->n_possible_clones; i++)
+    {
+      if (output_info->possible_clones[i] == other_output)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+have_same_color_state (MetaOutput *output,
+                       MetaOutput *other_output)
+{
+  MetaMonitor *monitor = meta_output_get_monitor (output);
+  MetaMonitor *other_monitor = meta_output_get_monitor (other_output);
+
+  if (!monitor || !other_monitor)
+    return FALSE;
+
+  return (meta_monitor_get_color_space (monitor) ==
+          meta_monitor_get_color_space (other_monitor) &&
+          meta_monitor_get_hdr_metadata (monitor)->active ==
+          meta_monitor_get_hdr_metadata (other_monitor)->active);
+}
+
+/*
+ * Mirrored outputs showing the same part of the stage in the same mode on
+ * the same GPU can be driven by a single CRTC, if the hardware can clone
+ * them. That way they share a single stage view and scan out the same
+ * framebuffer, instead of each having their own view painting the same
+ * content.
+ */
+static MetaCrtcAssignment *
+find_clone_crtc_assignment (MetaOutput            *output,
+                            MetaCrtcMode          *crtc_mode,
+                            const graphene_rect_t *crtc_layout,
+                            MtkMonitorTransform    crtc_transform,
+                            GPtrArray             *crtc_assignments)
+{
+  unsigned int i;
+
+  for (i = 0; i < crtc_assignments->len; i++)
+    {
+      MetaCrtcAssignment *crtc_assignment =
+        g_ptr_array_index (crtc_assignments, i);
+      unsigned int j;
+
+      if (crtc_assignment->mode != crtc_mode ||
+          crtc_assignment->transform != crtc_transform ||
+          !graphene_rect_equal (&crtc_assignment->layout, crtc_layout))
+        continue;
+
+      if (!is_possible_crtc (output, crtc_assignment->crtc))
+        continue;
+
+      for (j = 0; j < crtc_assignment->outputs->len; j++)
+        {
+          MetaOutput *assigned_output =
+            g_ptr_array_index (crtc_assignment->outputs, j);
+
+          if (!is_possible_clone (output, assigned_output) ||
+              !have_same_color_state (output, assigned_output))
+            break;
+        }
+
+      if (j == crtc_assignment->outputs->len)
+        return crtc_assignment;
+    }
+
+  return NULL;
+}
+
 typedef struct
 {
   MetaMonitorManager *monitor_manager;
@@ -195,20 +290,6 @@ assign_monitor_crtc (MetaMonitor         *monitor,
 
   output = monitor_crtc_mode->output;
 
-  crtc = find_unassigned_crtc (output,
-                               data->crtc_assignments,
-                               data->reserved_crtcs);
-
-  if (!crtc)
-    {
-      MetaMonitorSpec *monitor_spec = meta_monitor_get_spec (monitor);
-
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
-                   "No available CRTC for monitor '%s %s' not found",
-                   monitor_spec->vendor, monitor_spec->product);
-      return FALSE;
-    }
-
   transform = data->logical_monitor_config->transform;
   crtc_transform = meta_monitor_logical_to_crtc_transform (monitor, transform);
 
@@ -247,21 +328,49 @@ assign_monitor_crtc (MetaMonitor         *monitor,
                                     width,
                                     height);
 
-  crtc_assignment = g_new0 (MetaCrtcAssignment, 1);
-  *crtc_assignment = (MetaCrtcAssignment) {
-    .crtc = crtc,
-    .mode = crtc_mode,
-    .layout = crtc_layout,
-    .transform = crtc_transform,
-    .outputs = g_ptr_array_new ()
-  };
-  g_ptr_array_add (crtc_assignment->outputs, output);
+  crtc_assignment = find_clone_crtc_assignment (output,
+                                                crtc_mode,
+                                                &crtc_layout,
+                                                crtc_transform,
+                                                data->crtc_assignments);
+  if (crtc_assignment)
+    {
+      g_ptr_array_add (crtc_assignment->outputs, output);
+    }
+  else
+    {
+      crtc = find_unassigned_crtc (output,
+                                   data->crtc_assignments,
+                                   data->reserved_crtcs);
 
-  if (!meta_crtc_assign_extra (crtc,
-                               crtc_assignment,
-                               data->crtc_assignments,
-                               error))
-    return FALSE;
+      if (!crtc)
+        {
+          MetaMonitorSpec *monitor_spec = meta_monitor_get_spec (monitor);
+
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "No available CRTC for monitor '%s %s' not found",
+                       monitor_spec->vendor, monitor_spec->product);
+          return FALSE;
+        }
+
+      crtc_assignment = g_new0 (MetaCrtcAssignment, 1);
+      *crtc_assignment = (MetaCrtcAssignment) {
+        .crtc = crtc,
+        .mode = crtc_mode,
+        .layout = crtc_layout,
+        .transform = crtc_transform,
+        .outputs = g_ptr_array_new ()
+      };
+      g_ptr_array_add (crtc_assignment->outputs, output);
+
+      if (!meta_crtc_assign_extra (crtc,
+                                   crtc_assignment,
+                                   data->crtc_assignments,
+                                   error))
+        return FALSE;
+
+      g_ptr_array_add (data->crtc_assignments, crtc_assignment);
+    }
 
   /*
    * Only one output can be marked as primary (due to Xrandr limitation),
@@ -292,7 +401,6 @@ assign_monitor_crtc (MetaMonitor         *monitor,
     .rgb_range = data->monitor_config->rgb_range,
   };
 
-  g_ptr_array_add (data->crtc_assignments, crtc_assignment);
   g_ptr_array_add (data->output_assignments, output_assignment);
 
   return TRUE;
@@ -0,0 +1,511 @@
+/*
+ * Copyright (C) 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A snapshot holds the monitor configurations parsed from one
+ * monitors.xml file, serialized as a GVariant in the user cache
+ * directory. It is mapped and read back directly as long as the
+ * modification time and checksum of the XML file it was created from
+ * still match, so that unchanged configuration files don't need to be
+ * parsed again.
+ */
+
+#include "config.h"
+
+#include "backends/meta-monitor-config-snapshot.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+#include "backends/meta-monitor-config-store.h"
+#include "core/util-private.h"
+
+/* Bump whenever the format below or the meaning of its values change */
+#define SNAPSHOT_FORMAT_VERSION 1
+
+#define MONITOR_SPEC_FORMAT "(msmsmsms)"
+#define MONITOR_MODE_SPEC_FORMAT "(iiduu)"
+#define MONITOR_CONFIG_FORMAT \
+  "(" MONITOR_SPEC_FORMAT MONITOR_MODE_SPEC_FORMAT "bbuu)"
+#define LOGICAL_MONITOR_CONFIG_FORMAT \
+  "((iiii)udbba" MONITOR_CONFIG_FORMAT ")"
+#define MONITORS_CONFIG_FORMAT \
+  "(ua" LOGICAL_MONITOR_CONFIG_FORMAT \
+  "a" MONITOR_SPEC_FORMAT \
+  "a" MONITOR_SPEC_FORMAT ")"
+#define POLICY_FORMAT "(baubb)"
+#define SNAPSHOT_FORMAT \
+  "(uutsa" MONITORS_CONFIG_FORMAT POLICY_FORMAT ")"
+
+void
+meta_monitor_config_file_policy_clear (MetaMonitorConfigFilePolicy *policy)
+{
+  g_clear_pointer (&policy->stores, g_list_free);
+}
+
+static char *
+get_snapshot_path (GFile *source_file)
+{
+  g_autofree char *path_checksum = NULL;
+  g_autofree char *file_name = NULL;
+
+  path_checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1,
+                                                 g_file_peek_path (source_file),
+                                                 -1);
+  file_name = g_strdup_printf ("%s.snapshot", path_checksum);
+
+  return g_build_filename (g_get_user_cache_dir (),
+                           "mutter", "monitor-configs", file_name,
+                           NULL);
+}
+
+static gboolean
+get_source_mtime (GFile    *source_file,
+                  uint64_t *out_mtime)
+{
+  g_autoptr (GFileInfo) file_info = NULL;
+
+  file_info = g_file_query_info (source_file,
+                                 G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                 G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                                 G_FILE_QUERY_INFO_NONE,
+                                 NULL, NULL);
+  if (!file_info)
+    return FALSE;
+
+  *out_mtime =
+    g_file_info_get_attribute_uint64 (file_info,
+                                      G_FILE_ATTRIBUTE_TIME_MODIFIED) *
+    G_USEC_PER_SEC +
+    g_file_info_get_attribute_uint32 (file_info,
+                                      G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  return TRUE;
+}
+
+static GVariant *
+serialize_monitor_spec (MetaMonitorSpec *monitor_spec)
+{
+  return g_variant_new (MONITOR_SPEC_FORMAT,
+                        monitor_spec->connector,
+                        monitor_spec->vendor,
+                        monitor_spec->product,
+                        monitor_spec->serial);
+}
+
+static GVariant *
+serialize_monitor_specs (GList *monitor_specs)
+{
+  GVariantBuilder builder;
+  GList *l;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" MONITOR_SPEC_FORMAT));
+  for (l = monitor_specs; l; l = l->next)
+    g_variant_builder_add_value (&builder, serialize_monitor_spec (l->data));
+
+  return g_variant_builder_end (&builder);
+}
+
+static GVariant *
+serialize_monitor_config (MetaMonitorConfig *monitor_config)
+{
+  MetaMonitorModeSpec *mode_spec = monitor_config->mode_spec;
+
+  return g_variant_new ("(@" MONITOR_SPEC_FORMAT MONITOR_MODE_SPEC_FORMAT "bbuu)",
+                        serialize_monitor_spec (monitor_config->monitor_spec),
+                        mode_spec->width,
+                        mode_spec->height,
+                        (double) mode_spec->refresh_rate,
+                        mode_spec->refresh_rate_mode,
+                        mode_spec->flags,
+                        monitor_config->enable_underscanning,
+                        monitor_config->has_max_bpc,
+                        monitor_config->max_bpc,
+                        monitor_config->rgb_range);
+}
+
+static GVariant *
+serialize_logical_monitor_config (MetaLogicalMonitorConfig *logical_monitor_config)
+{
+  GVariantBuilder builder;
+  GList *l;
+
+  g_variant_builder_init (&builder,
+                          G_VARIANT_TYPE ("a" MONITOR_CONFIG_FORMAT));
+  for (l = logical_monitor_config->monitor_configs; l; l = l->next)
+    g_variant_builder_add_value (&builder, serialize_monitor_config (l->data));
+
+  return g_variant_new ("((iiii)udbb@a" MONITOR_CONFIG_FORMAT ")",
+                        logical_monitor_config->layout.x,
+                        logical_monitor_config->layout.y,
+                        logical_monitor_config->layout.width,
+                        logical_monitor_config->layout.height,
+                        logical_monitor_config->transform,
+                        (double) logical_monitor_config->scale,
+                        logical_monitor_config->is_primary,
+                        logical_monitor_config->is_presentation,
+                        g_variant_builder_end (&builder));
+}
+
+static GVariant *
+serialize_monitors_config (MetaMonitorsConfig *config)
+{
+  GVariantBuilder builder;
+  GList *l;
+
+  g_variant_builder_init (&builder,
+                          G_VARIANT_TYPE ("a" LOGICAL_MONITOR_CONFIG_FORMAT));
+  for (l = config->logical_monitor_configs; l; l = l->next)
+    {
+      g_variant_builder_add_value (&builder,
+                                   serialize_logical_monitor_config (l->data));
+    }
+
+  return g_variant_new ("(u@a" LOGICAL_MONITOR_CONFIG_FORMAT
+                        "@a" MONITOR_SPEC_FORMAT
+                        "@a" MONITOR_SPEC_FORMAT ")",
+                        config->layout_mode,
+                        g_variant_builder_end (&builder),
+                        serialize_monitor_specs (config->disabled_monitor_specs),
+                        serialize_monitor_specs (config->for_lease_monitor_specs));
+}
+
+static GVariant *
+serialize_policy (const MetaMonitorConfigFilePolicy *policy)
+{
+  GVariantBuilder builder;
+  GList *l;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("au"));
+  for (l = policy->stores; l; l = l->next)
+    g_variant_builder_add (&builder, "u", GPOINTER_TO_INT (l->data));
+
+  return g_variant_new ("(b@aubb)",
+                        policy->has_stores,
+                        g_variant_builder_end (&builder),
+                        policy->has_dbus,
+                        policy->enable_dbus);
+}
+
+void
+meta_monitor_config_snapshot_save (GFile                             *source_file,
+                                   const char                        *source_checksum,
+                                   MetaMonitorsConfigFlag             config_flags,
+                                   GHashTable                        *configs,
+                                   const MetaMonitorConfigFilePolicy *policy)
+{
+  g_autofree char *snapshot_path = NULL;
+  g_autofree char *snapshot_dir = NULL;
+  g_autoptr (GVariant) snapshot = NULL;
+  g_autoptr (GError) error = NULL;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  MetaMonitorsConfig *config;
+  uint64_t mtime;
+
+  if (!get_source_mtime (source_file, &mtime))
+    return;
+
+  g_variant_builder_init (&builder,
+                          G_VARIANT_TYPE ("a" MONITORS_CONFIG_FORMAT));
+  g_hash_table_iter_init (&iter, configs);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &config))
+    g_variant_builder_add_value (&builder, serialize_monitors_config (config));
+
+  snapshot = g_variant_new ("(uuts@a" MONITORS_CONFIG_FORMAT "@" POLICY_FORMAT ")",
+                            SNAPSHOT_FORMAT_VERSION,
+                            config_flags,
+                            mtime,
+                            source_checksum,
+                            g_variant_builder_end (&builder),
+                            serialize_policy (policy));
+  g_variant_ref_sink (snapshot);
+
+  snapshot_path = get_snapshot_path (source_file);
+  snapshot_dir = g_path_get_dirname (snapshot_path);
+  if (g_mkdir_with_parents (snapshot_dir, 0700) == -1)
+    {
+      meta_topic (META_DEBUG_BACKEND,
+                  "Failed to create monitor config snapshot directory %s: %s",
+                  snapshot_dir, g_strerror (errno));
+      return;
+    }
+
+  if (!g_file_set_contents (snapshot_path,
+                            g_variant_get_data (snapshot),
+                            g_variant_get_size (snapshot),
+                            &error))
+    {
+      meta_topic (META_DEBUG_BACKEND,
+                  "Failed to write monitor config snapshot of %s: %s",
+                  g_file_peek_path (source_file), error->message);
+      return;
+    }
+
+  meta_topic (META_DEBUG_BACKEND,
+              "Wrote monitor config snapshot of %s to %s",
+              g_file_peek_path (source_file), snapshot_path);
+}
+
+static MetaMonitorSpec *
+deserialize_monitor_spec (GVariant *variant)
+{
+  MetaMonitorSpec *monitor_spec;
+
+  monitor_spec = g_new0 (MetaMonitorSpec, 1);
+  g_variant_get (variant, MONITOR_SPEC_FORMAT,
+                 &monitor_spec->connector,
+                 &monitor_spec->vendor,
+                 &monitor_spec->product,
+                 &monitor_spec->serial);
+
+  return monitor_spec;
+}
+
+static GList *
+deserialize_monitor_specs (GVariant *variant)
+{
+  GList *monitor_specs = NULL;
+  GVariantIter iter;
+  GVariant *child;
+
+  g_variant_iter_init (&iter, variant);
+  while ((child = g_variant_iter_next_value (&iter)))
+    {
+      monitor_specs = g_list_prepend (monitor_specs,
+                                      deserialize_monitor_spec (child));
+      g_variant_unref (child);
+    }
+
+  return g_list_reverse (monitor_specs);
+}
+
+static MetaMonitorConfig *
+deserialize_monitor_config (GVariant *variant)
+{
+  g_autoptr (GVariant) monitor_spec_variant = NULL;
+  MetaMonitorConfig *monitor_config;
+  MetaMonitorModeSpec *mode_spec;
+  double refresh_rate;
+  uint32_t refresh_rate_mode;
+  uint32_t mode_flags;
+  uint32_t rgb_range;
+
+  monitor_config = g_new0 (MetaMonitorConfig, 1);
+  mode_spec = g_new0 (MetaMonitorModeSpec, 1);
+
+  g_variant_get (variant, "(@" MONITOR_SPEC_FORMAT MONITOR_MODE_SPEC_FORMAT "bbuu)",
+                 &monitor_spec_variant,
+                 &mode_spec->width,
+                 &mode_spec->height,
+                 &refresh_rate,
+                 &refresh_rate_mode,
+                 &mode_flags,
+                 &monitor_config->enable_underscanning,
+                 &monitor_config->has_max_bpc,
+                 &monitor_config->max_bpc,
+                 &rgb_range);
+
+  mode_spec->refresh_rate = (float) refresh_rate;
+  mode_spec->refresh_rate_mode = refresh_rate_mode;
+  mode_spec->flags = mode_flags;
+
+  monitor_config->monitor_spec = deserialize_monitor_spec (monitor_spec_variant);
+  monitor_config->mode_spec = mode_spec;
+  monitor_config->rgb_range = rgb_range;
+
+  return monitor_config;
+}
+
+static MetaLogicalMonitorConfig *
+deserialize_logical_monitor_config (GVariant *variant)
+{
+  g_autoptr (GVariant) monitor_configs_variant = NULL;
+  MetaLogicalMonitorConfig *logical_monitor_config;
+  uint32_t transform;
+  double scale;
+  GVariantIter iter;
+  GVariant *child;
+
+  logical_monitor_config = g_new0 (MetaLogicalMonitorConfig, 1);
+
+  g_variant_get (variant, "((iiii)udbb@a" MONITOR_CONFIG_FORMAT ")",
+                 &logical_monitor_config->layout.x,
+                 &logical_monitor_config->layout.y,
+                 &logical_monitor_config->layout.width,
+                 &logical_monitor_config->layout.height,
+                 &transform,
+                 &scale,
+                 &logical_monitor_config->is_primary,
+                 &logical_monitor_config->is_presentation,
+                 &monitor_configs_variant);
+
+  logical_monitor_config->transform = transform;
+  logical_monitor_config->scale = (float) scale;
+
+  g_variant_iter_init (&iter, monitor_configs_variant);
+  while ((child = g_variant_iter_next_value (&iter)))
+    {
+      logical_monitor_config->monitor_configs =
+        g_list_prepend (logical_monitor_config->monitor_configs,
+                        deserialize_monitor_config (child));
+      g_variant_unref (child);
+    }
+  logical_monitor_config->monitor_configs =
+    g_list_reverse (logical_monitor_config->monitor_configs);
+
+  return logical_monitor_config;
+}
+
+static MetaMonitorsConfig *
+deserialize_monitors_config (GVariant               *variant,
+                             MetaMonitorsConfigFlag  config_flags)
+{
+  g_autoptr (GVariant) logical_monitor_configs_variant = NULL;
+  g_autoptr (GVariant) disabled_monitor_specs_variant = NULL;
+  g_autoptr (GVariant) for_lease_monitor_specs_variant = NULL;
+  GList *logical_monitor_configs = NULL;
+  uint32_t layout_mode;
+  GVariantIter iter;
+  GVariant *child;
+
+  g_variant_get (variant, "(u@a" LOGICAL_MONITOR_CONFIG_FORMAT
+                 "@a" MONITOR_SPEC_FORMAT
+                 "@a" MONITOR_SPEC_FORMAT ")",
+                 &layout_mode,
+                 &logical_monitor_configs_variant,
+                 &disabled_monitor_specs_variant,
+                 &for_lease_monitor_specs_variant);
+
+  g_variant_iter_init (&iter, logical_monitor_configs_variant);
+  while ((child = g_variant_iter_next_value (&iter)))
+    {
+      logical_monitor_configs =
+        g_list_prepend (logical_monitor_configs,
+                        deserialize_logical_monitor_config (child));
+      g_variant_unref (child);
+    }
+
+  return meta_monitors_config_new_full (g_list_reverse (logical_monitor_configs),
+                                        deserialize_monitor_specs (disabled_monitor_specs_variant),
+                                        deserialize_monitor_specs (for_lease_monitor_specs_variant),
+                                        layout_mode,
+                                        config_flags);
+}
+
+static void
+deserialize_policy (GVariant                    *variant,
+                    MetaMonitorConfigFilePolicy *policy)
+{
+  g_autoptr (GVariantIter) stores_iter = NULL;
+  uint32_t store;
+
+  g_variant_get (variant, POLICY_FORMAT,
+                 &policy->has_stores,
+                 &stores_iter,
+                 &policy->has_dbus,
+                 &policy->enable_dbus);
+
+  while (g_variant_iter_next (stores_iter, "u", &store))
+    {
+      if (store != META_CONFIG_STORE_SYSTEM &&
+          store != META_CONFIG_STORE_USER)
+        continue;
+
+      policy->stores = g_list_append (policy->stores, GINT_TO_POINTER (store));
+    }
+}
+
+gboolean
+meta_monitor_config_snapshot_load (GFile                        *source_file,
+                                   const char                   *source_checksum,
+                                   MetaMonitorsConfigFlag        config_flags,
+                                   GHashTable                  **out_configs,
+                                   MetaMonitorConfigFilePolicy  *out_policy)
+{
+  g_autofree char *snapshot_path = NULL;
+  g_autoptr (GMappedFile) mapped_file = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GVariant) snapshot = NULL;
+  g_autoptr (GVariant) configs_variant = NULL;
+  g_autoptr (GVariant) policy_variant = NULL;
+  g_autoptr (GHashTable) configs = NULL;
+  g_autofree char *snapshot_checksum = NULL;
+  uint32_t format_version;
+  uint32_t snapshot_config_flags;
+  uint64_t snapshot_mtime;
+  uint64_t mtime;
+  GVariantIter iter;
+  GVariant *child;
+
+  if (!get_source_mtime (source_file, &mtime))
+    return FALSE;
+
+  snapshot_path = get_snapshot_path (source_file);
+  mapped_file = g_mapped_file_new (snapshot_path, FALSE, NULL);
+  if (!mapped_file)
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  snapshot = g_variant_new_from_bytes (G_VARIANT_TYPE (SNAPSHOT_FORMAT),
+                                       bytes, FALSE);
+  g_variant_ref_sink (snapshot);
+
+  g_variant_get (snapshot, "(uuts@a" MONITORS_CONFIG_FORMAT "@" POLICY_FORMAT ")",
+                 &format_version,
+                 &snapshot_config_flags,
+                 &snapshot_mtime,
+                 &snapshot_checksum,
+                 &configs_variant,
+                 &policy_variant);
+
+  if (format_version != SNAPSHOT_FORMAT_VERSION ||
+      snapshot_config_flags != config_flags ||
+      snapshot_mtime != mtime ||
+      g_strcmp0 (snapshot_checksum, source_checksum) != 0)
+    {
+      meta_topic (META_DEBUG_BACKEND,
+                  "Ignoring stale monitor config snapshot of %s",
+                  g_file_peek_path (source_file));
+      return FALSE;
+    }
+
+  configs = g_hash_table_new_full (meta_monitors_config_key_hash,
+                                   meta_monitors_config_key_equal,
+                                   NULL,
+                                   g_object_unref);
+
+  g_variant_iter_init (&iter, configs_variant);
+  while ((child = g_variant_iter_next_value (&iter)))
+    {
+      MetaMonitorsConfig *config;
+
+      config = deserialize_monitors_config (child, config_flags);
+      g_hash_table_replace (configs, config->key, config);
+      g_variant_unref (child);
+    }
+
+  *out_policy = (MetaMonitorConfigFilePolicy) { 0 };
+  deserialize_policy (policy_variant, out_policy);
+
+  *out_configs = g_steal_pointer (&configs);
+
+  meta_topic (META_DEBUG_BACKEND,
+              "Loaded monitor config snapshot of %s",
+              g_file_peek_path (source_file));
+
+  return TRUE;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "backends/meta-monitor-config-manager.h"
+
+/* The policy declared by a single configuration file */
+typedef struct _MetaMonitorConfigFilePolicy
+{
+  gboolean has_stores;
+  GList *stores;
+
+  gboolean has_dbus;
+  gboolean enable_dbus;
+} MetaMonitorConfigFilePolicy;
+
+void meta_monitor_config_file_policy_clear (MetaMonitorConfigFilePolicy *policy);
+
+gboolean meta_monitor_config_snapshot_load (GFile                        *source_file,
+                                            const char                   *source_checksum,
+                                            MetaMonitorsConfigFlag        config_flags,
+                                            GHashTable                  **out_configs,
+                                            MetaMonitorConfigFilePolicy  *out_policy);
+
+void meta_monitor_config_snapshot_save (GFile                             *source_file,
+                                        const char                        *source_checksum,
+                                        MetaMonitorsConfigFlag             config_flags,
+                                        GHashTable                        *configs,
+                                        const MetaMonitorConfigFilePolicy *policy);
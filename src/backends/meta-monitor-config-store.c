@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include "backends/meta-monitor-config-manager.h"
+#include "backends/meta-monitor-config-snapshot.h"
 #include "backends/meta-monitor-config-utils.h"
 
 #define MONITORS_CONFIG_XML_FORMAT_VERSION 2
@@ -208,6 +209,8 @@ typedef struct
 
   MetaMonitorsConfigFlag extra_config_flags;
   gboolean should_update_file;
+
+  MetaMonitorConfigFilePolicy file_policy;
 } ConfigParser;
 
 G_DEFINE_TYPE (MetaMonitorConfigStore, meta_monitor_config_store,
@@ -246,6 +249,43 @@ enter_unknown_element (ConfigParser *parser,
              element_name, root_element_name);
 }
 
+static void
+set_stores_policy (MetaMonitorConfigStore *config_store,
+                   GFile                  *file,
+                   GList                  *stores)
+{
+  if (config_store->has_stores_policy)
+    {
+      g_warning ("Ignoring stores policy from '%s', "
+                 "it has already been configured",
+                 g_file_peek_path (file));
+      g_list_free (stores);
+    }
+  else
+    {
+      config_store->stores_policy = stores;
+      config_store->has_stores_policy = TRUE;
+    }
+}
+
+static void
+set_dbus_policy (MetaMonitorConfigStore *config_store,
+                 GFile                  *file,
+                 gboolean                enable_dbus)
+{
+  if (!config_store->has_dbus_policy)
+    {
+      config_store->has_dbus_policy = TRUE;
+      config_store->policy.enable_dbus = enable_dbus;
+    }
+  else
+    {
+      g_warning ("Policy for monitor configuration via D-Bus "
+                 "has already been set, ignoring policy from '%s'",
+                 g_file_peek_path (file));
+    }
+}
+
 static void
 handle_start_element (GMarkupParseContext  *context,
                       const char           *element_name,
@@ -1623,19 +1663,11 @@ handle_end_element (GMarkupParseContext  *context,
       {
         g_assert (g_str_equal (element_name, "stores"));
 
-        if (parser->config_store->has_stores_policy)
-          {
-            g_warning ("Ignoring stores policy from '%s', "
-                       "it has already been configured",
-                       g_file_peek_path (parser->file));
-            g_clear_pointer (&parser->stores, g_list_free);
-          }
-        else
-          {
-            parser->config_store->stores_policy =
-              g_steal_pointer (&parser->stores);
-            parser->config_store->has_stores_policy = TRUE;
-          }
+        parser->file_policy.has_stores = TRUE;
+        parser->file_policy.stores = g_list_copy (parser->stores);
+
+        set_stores_policy (parser->config_store, parser->file,
+                           g_steal_pointer (&parser->stores));
 
         parser->state = STATE_POLICY;
         return;
@@ -1643,18 +1675,13 @@ handle_end_element (GMarkupParseContext  *context,
 
     case STATE_DBUS:
       {
-        if (!parser->config_store->has_dbus_policy)
-          {
-            parser->config_store->has_dbus_policy = TRUE;
-            parser->config_store->policy.enable_dbus = parser->enable_dbus;
-            parser->enable_dbus_set = FALSE;
-          }
-        else
-          {
-            g_warning ("Policy for monitor configuration via D-Bus "
-                       "has already been set, ignoring policy from '%s'",
-                       g_file_get_path (parser->file));
-          }
+        parser->file_policy.has_dbus = TRUE;
+        parser->file_policy.enable_dbus = parser->enable_dbus;
+
+        set_dbus_policy (parser->config_store, parser->file,
+                         parser->enable_dbus);
+        parser->enable_dbus_set = FALSE;
+
         parser->state = STATE_POLICY;
 
         return;
@@ -2093,21 +2120,19 @@ static const GMarkupParser config_parser = {
 };
 
 static gboolean
-read_config_file (MetaMonitorConfigStore  *config_store,
-                  GFile                   *file,
-                  MetaMonitorsConfigFlag   extra_config_flags,
-                  GHashTable             **out_configs,
-                  gboolean                *should_update_file,
-                  GError                 **error)
+parse_config (MetaMonitorConfigStore       *config_store,
+              GFile                        *file,
+              const char                   *buffer,
+              gsize                         size,
+              MetaMonitorsConfigFlag        extra_config_flags,
+              GHashTable                  **out_configs,
+              MetaMonitorConfigFilePolicy  *out_policy,
+              gboolean                     *should_update_file,
+              GError                      **error)
 {
-  char *buffer;
-  gsize size;
   ConfigParser parser;
   GMarkupParseContext *parse_context;
 
-  if (!g_file_load_contents (file, NULL, &buffer, &size, NULL, error))
-    return FALSE;
-
   parser = (ConfigParser) {
     .state = STATE_INITIAL,
     .file = file,
@@ -2139,18 +2164,128 @@ read_config_file (MetaMonitorConfigStore  *config_store,
                        meta_logical_monitor_config_free);
       g_list_free (parser.stores);
       g_hash_table_unref (parser.pending_configs);
+      meta_monitor_config_file_policy_clear (&parser.file_policy);
+      g_markup_parse_context_free (parse_context);
       return FALSE;
     }
 
   *out_configs = g_steal_pointer (&parser.pending_configs);
+  *out_policy = parser.file_policy;
   *should_update_file = parser.should_update_file;
 
   g_markup_parse_context_free (parse_context);
-  g_free (buffer);
 
   return TRUE;
 }
 
+static gboolean
+read_config_file (MetaMonitorConfigStore  *config_store,
+                  GFile                   *file,
+                  MetaMonitorsConfigFlag   extra_config_flags,
+                  GHashTable             **out_configs,
+                  gboolean                *should_update_file,
+                  GError                 **error)
+{
+  g_autofree char *buffer = NULL;
+  MetaMonitorConfigFilePolicy policy = { 0 };
+  gsize size;
+
+  if (!g_file_load_contents (file, NULL, &buffer, &size, NULL, error))
+    return FALSE;
+
+  if (!parse_config (config_store, file, buffer, size, extra_config_flags,
+                     out_configs, &policy, should_update_file, error))
+    return FALSE;
+
+  meta_monitor_config_file_policy_clear (&policy);
+  return TRUE;
+}
+
+static gboolean
+verify_configs (MetaMonitorConfigStore *config_store,
+                GHashTable             *configs)
+{
+  GHashTableIter iter;
+  MetaMonitorsConfig *config;
+
+  g_hash_table_iter_init (&iter, configs);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &config))
+    {
+      if (!meta_verify_monitors_config (config, config_store->monitor_manager,
+                                        NULL))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Like read_config_file(), but reuses the result of an earlier parse of
+ * the same file if a snapshot of it is still valid, and saves a new
+ * snapshot otherwise. */
+static gboolean
+read_config_file_cached (MetaMonitorConfigStore  *config_store,
+                         GFile                   *file,
+                         MetaMonitorsConfigFlag   extra_config_flags,
+                         GHashTable             **out_configs,
+                         gboolean                *should_update_file,
+                         GError                 **error)
+{
+  g_autofree char *buffer = NULL;
+  g_autofree char *checksum = NULL;
+  g_autoptr (GHashTable) configs = NULL;
+  MetaMonitorConfigFilePolicy policy = { 0 };
+  gsize size;
+
+  if (!g_file_load_contents (file, NULL, &buffer, &size, NULL, error))
+    return FALSE;
+
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256,
+                                          (const guchar *) buffer, size);
+
+  if (meta_monitor_config_snapshot_load (file, checksum, extra_config_flags,
+                                         &configs, &policy))
+    {
+      /* What is valid depends on the monitor manager too, so check the
+       * configs the same way parsing them did */
+      if (verify_configs (config_store, configs))
+        {
+          if (policy.has_stores)
+            {
+              set_stores_policy (config_store, file,
+                                 g_steal_pointer (&policy.stores));
+            }
+          if (policy.has_dbus)
+            set_dbus_policy (config_store, file, policy.enable_dbus);
+
+          meta_monitor_config_file_policy_clear (&policy);
+
+          *out_configs = g_steal_pointer (&configs);
+          *should_update_file = FALSE;
+          return TRUE;
+        }
+
+      g_clear_pointer (&configs, g_hash_table_unref);
+      meta_monitor_config_file_policy_clear (&policy);
+    }
+
+  if (!parse_config (config_store, file, buffer, size, extra_config_flags,
+                     &configs, &policy, should_update_file, error))
+    return FALSE;
+
+  /* Configs that need migrating depend on the current monitor setup, so
+   * only snapshot files that are already up to date */
+  if (!*should_update_file)
+    {
+      meta_monitor_config_snapshot_save (file, checksum, extra_config_flags,
+                                         configs, &policy);
+    }
+
+  meta_monitor_config_file_policy_clear (&policy);
+
+  *out_configs = g_steal_pointer (&configs);
+  return TRUE;
+}
+
 MetaMonitorsConfig *
 meta_monitor_config_store_lookup (MetaMonitorConfigStore *config_store,
                                   MetaMonitorsConfigKey  *key)
@@ -2768,12 +2903,12 @@ meta_monitor_config_store_reset (MetaMonitorConfigStore *config_store)
           g_autoptr (GFile) system_file = NULL;
 
           system_file = g_file_new_for_path (system_file_path);
-          if (!read_config_file (config_store,
-                                 system_file,
-                                 META_MONITORS_CONFIG_FLAG_SYSTEM_CONFIG,
-                                 &system_configs,
-                                 &should_save_configs,
-                                 &error))
+          if (!read_config_file_cached (config_store,
+                                        system_file,
+                                        META_MONITORS_CONFIG_FLAG_SYSTEM_CONFIG,
+                                        &system_configs,
+                                        &should_save_configs,
+                                        &error))
             {
               g_warning ("Failed to read monitors config file '%s': %s",
                          system_file_path, error->message);
@@ -2798,12 +2933,12 @@ meta_monitor_config_store_reset (MetaMonitorConfigStore *config_store)
 
   if (g_file_test (user_file_path, G_FILE_TEST_EXISTS))
     {
-      if (!read_config_file (config_store,
-                             config_store->user_file,
-                             META_MONITORS_CONFIG_FLAG_NONE,
-                             &user_configs,
-                             &should_save_configs,
-                             &error))
+      if (!read_config_file_cached (config_store,
+                                    config_store->user_file,
+                                    META_MONITORS_CONFIG_FLAG_NONE,
+                                    &user_configs,
+                                    &should_save_configs,
+                                    &error))
         {
           g_warning ("Failed to read monitors config file '%s': %s",
                      user_file_path, error->message);
@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "backends/edid.h"
 #include "backends/meta-output.h"
 
@@ -47,6 +49,20 @@ enum
 
 static guint signals[N_SIGNALS];
 
+/* Monitors tend to be reprobed with unchanged EDIDs, e.g. when any
+ * connector on a dock changes, so keep the most recently parsed ones
+ * around, most recently used first. */
+#define EDID_CACHE_SIZE 8
+
+typedef struct _EdidCacheEntry
+{
+  GBytes *edid;
+  MetaEdidInfo *edid_info;
+  char *checksum_md5;
+} EdidCacheEntry;
+
+static EdidCacheEntry edid_cache[EDID_CACHE_SIZE];
+
 typedef struct _MetaOutputPrivate
 {
   uint64_t id;
@@ -362,27 +378,59 @@ set_output_details_from_edid (MetaOutputInfo *output_info,
     }
 }
 
+static EdidCacheEntry *
+lookup_cached_edid (GBytes *edid)
+{
+  EdidCacheEntry entry;
+  size_t size;
+  gconstpointer data;
+  int i;
+
+  for (i = 0; i < EDID_CACHE_SIZE && edid_cache[i].edid; i++)
+    {
+      if (!g_bytes_equal (edid_cache[i].edid, edid))
+        continue;
+
+      entry = edid_cache[i];
+      memmove (&edid_cache[1], &edid_cache[0], i * sizeof (EdidCacheEntry));
+      edid_cache[0] = entry;
+      return &edid_cache[0];
+    }
+
+  entry = edid_cache[EDID_CACHE_SIZE - 1];
+  g_clear_pointer (&entry.edid, g_bytes_unref);
+  g_clear_pointer (&entry.edid_info, meta_edid_info_free);
+  g_clear_pointer (&entry.checksum_md5, g_free);
+
+  data = g_bytes_get_data (edid, &size);
+  entry.edid = g_bytes_ref (edid);
+  entry.edid_info = meta_edid_info_new_parse (data, size);
+  entry.checksum_md5 = g_compute_checksum_for_data (G_CHECKSUM_MD5,
+                                                    data, size);
+
+  memmove (&edid_cache[1], &edid_cache[0],
+           (EDID_CACHE_SIZE - 1) * sizeof (EdidCacheEntry));
+  edid_cache[0] = entry;
+  return &edid_cache[0];
+}
+
 void
 meta_output_info_parse_edid (MetaOutputInfo *output_info,
                              GBytes         *edid)
 {
-  MetaEdidInfo *edid_info;
-  size_t size;
-  gconstpointer data;
+  EdidCacheEntry *entry;
 
   g_return_if_fail (!output_info->edid_info);
   g_return_if_fail (edid);
 
-  data = g_bytes_get_data (edid, &size);
-  edid_info = meta_edid_info_new_parse (data, size);
+  entry = lookup_cached_edid (edid);
 
-  output_info->edid_checksum_md5 = g_compute_checksum_for_data (G_CHECKSUM_MD5,
-                                                                data, size);
+  output_info->edid_checksum_md5 = g_strdup (entry->checksum_md5);
 
-  if (edid_info)
+  if (entry->edid_info)
     {
-      output_info->edid_info = edid_info;
-      set_output_details_from_edid (output_info, edid_info);
+      output_info->edid_info = meta_edid_info_copy (entry->edid_info);
+      set_output_details_from_edid (output_info, output_info->edid_info);
     }
 }
 
@@ -140,6 +140,10 @@ create_crtc_view (MetaLogicalMonitor *logical_monitor,
   MetaRendererView *view;
   g_autoptr (GError) error = NULL;
 
+  /* Outputs cloning each other share the CRTC, and thus its view */
+  if (meta_renderer_get_view_for_crtc (renderer, crtc))
+    return;
+
   view = meta_renderer_create_view (renderer,
                                     logical_monitor,
                                     monitor,
@@ -25,6 +25,7 @@
 #include "backends/meta-screen-cast-area-stream-src.h"
 
 #include <spa/buffer/meta.h>
+#include <spa/param/video/format-utils.h>
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-cursor-tracker-private.h"
@@ -56,6 +57,16 @@ struct _MetaScreenCastAreaStreamSrc
   gulong prepare_frame_handler_id;
 
   guint maybe_record_idle_id;
+
+  MetaScreenCastSharedCapture *shared_capture;
+
+  /* Negotiated size, possibly smaller than the area */
+  int stream_width;
+  int stream_height;
+
+  CoglOffscreen *downscale_offscreen;
+  CoglPipeline *downscale_pipeline;
+  CoglOffscreen *scaled_offscreen;
 };
 
 static void
@@ -81,16 +92,47 @@ get_stage (MetaScreenCastAreaStreamSrc *area_src)
   return meta_screen_cast_area_stream_get_stage (area_stream);
 }
 
-static MetaBackend *
-get_backend (MetaScreenCastAreaStreamSrc *area_src)
+static MetaScreenCast *
+get_screen_cast (MetaScreenCastAreaStreamSrc *area_src)
 {
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
   MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
   MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
-  MetaScreenCast *screen_cast =
-    meta_screen_cast_session_get_screen_cast (session);
 
-  return meta_screen_cast_get_backend (screen_cast);
+  return meta_screen_cast_session_get_screen_cast (session);
+}
+
+static MetaBackend *
+get_backend (MetaScreenCastAreaStreamSrc *area_src)
+{
+  return meta_screen_cast_get_backend (get_screen_cast (area_src));
+}
+
+static MetaScreenCastSharedCapture *
+ensure_shared_capture (MetaScreenCastAreaStreamSrc *area_src,
+                       const MtkRectangle          *rect,
+                       float                        scale,
+                       ClutterPaintFlag             paint_flags)
+{
+  MetaScreenCast *screen_cast = get_screen_cast (area_src);
+
+  if (area_src->shared_capture &&
+      !meta_screen_cast_shared_capture_matches (area_src->shared_capture,
+                                                rect, scale, paint_flags))
+    {
+      meta_screen_cast_release_shared_capture (screen_cast,
+                                               area_src->shared_capture);
+      area_src->shared_capture = NULL;
+    }
+
+  if (!area_src->shared_capture)
+    {
+      area_src->shared_capture =
+        meta_screen_cast_acquire_shared_capture (screen_cast,
+                                                 rect, scale, paint_flags);
+    }
+
+  return area_src->shared_capture;
 }
 
 static gboolean
@@ -114,6 +156,236 @@ meta_screen_cast_area_stream_src_get_specs (MetaScreenCastStreamSrc *src,
   return TRUE;
 }
 
+static gboolean
+meta_screen_cast_area_stream_src_supports_scaling (MetaScreenCastStreamSrc *src)
+{
+  return TRUE;
+}
+
+/* Scale from stage coordinates to stream coordinates */
+static float
+get_stream_scale (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
+  MtkRectangle *area;
+  float scale;
+
+  area = meta_screen_cast_area_stream_get_area (area_stream);
+  scale = meta_screen_cast_area_stream_get_scale (area_stream);
+
+  if (area_src->stream_width == 0 || area_src->stream_height == 0)
+    return scale;
+
+  return MIN (MIN ((float) area_src->stream_width / area->width,
+                   (float) area_src->stream_height / area->height),
+              scale);
+}
+
+/* Bilinear filtering only samples 2x2 texels, so when shrinking by more
+ * than half, the stage is painted at full size first, and then sampled
+ * through mipmaps */
+static gboolean
+needs_downscale_pass (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
+
+  return (get_stream_scale (area_src) * 2.0f <=
+          meta_screen_cast_area_stream_get_scale (area_stream));
+}
+
+static ClutterPaintFlag
+get_paint_flags (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+
+  switch (meta_screen_cast_stream_get_cursor_mode (stream))
+    {
+    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
+    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
+      paint_flags |= CLUTTER_PAINT_FLAG_NO_CURSORS;
+      break;
+    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
+      paint_flags |= CLUTTER_PAINT_FLAG_FORCE_CURSORS;
+      break;
+    }
+
+  return paint_flags;
+}
+
+static void
+clear_scaling_state (MetaScreenCastAreaStreamSrc *area_src)
+{
+  g_clear_object (&area_src->downscale_pipeline);
+  g_clear_object (&area_src->downscale_offscreen);
+  g_clear_object (&area_src->scaled_offscreen);
+}
+
+static CoglContext *
+get_cogl_context (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaBackend *backend = get_backend (area_src);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+
+  return clutter_backend_get_cogl_context (clutter_backend);
+}
+
+static gboolean
+ensure_offscreen (MetaScreenCastAreaStreamSrc  *area_src,
+                  CoglOffscreen               **offscreen,
+                  int                           width,
+                  int                           height,
+                  GError                      **error)
+{
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) new_offscreen = NULL;
+
+  if (*offscreen)
+    {
+      CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (*offscreen);
+
+      if (cogl_framebuffer_get_width (framebuffer) == width &&
+          cogl_framebuffer_get_height (framebuffer) == height)
+        return TRUE;
+
+      g_clear_object (offscreen);
+    }
+
+  texture = cogl_texture_2d_new_with_size (get_cogl_context (area_src),
+                                           width, height);
+  if (!texture)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to create %dx%d texture", width, height);
+      return FALSE;
+    }
+
+  new_offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (new_offscreen), error))
+    return FALSE;
+
+  *offscreen = g_steal_pointer (&new_offscreen);
+
+  return TRUE;
+}
+
+static gboolean
+paint_downscaled (MetaScreenCastAreaStreamSrc  *area_src,
+                  CoglFramebuffer              *framebuffer,
+                  ClutterPaintFlag              paint_flags,
+                  GError                      **error)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
+  ClutterStage *stage = get_stage (area_src);
+  CoglFramebuffer *downscale_framebuffer;
+  MtkRectangle *area;
+  float scale;
+  float stream_scale;
+
+  area = meta_screen_cast_area_stream_get_area (area_stream);
+  scale = meta_screen_cast_area_stream_get_scale (area_stream);
+  stream_scale = get_stream_scale (area_src);
+
+  if (!area_src->downscale_offscreen)
+    g_clear_object (&area_src->downscale_pipeline);
+
+  if (!ensure_offscreen (area_src,
+                         &area_src->downscale_offscreen,
+                         (int) roundf (area->width * scale),
+                         (int) roundf (area->height * scale),
+                         error))
+    return FALSE;
+
+  downscale_framebuffer = COGL_FRAMEBUFFER (area_src->downscale_offscreen);
+
+  if (!area_src->downscale_pipeline)
+    {
+      CoglPipeline *pipeline;
+
+      pipeline = cogl_pipeline_new (get_cogl_context (area_src));
+      cogl_pipeline_set_layer_texture (pipeline, 0,
+                                       cogl_offscreen_get_texture (area_src->downscale_offscreen));
+      cogl_pipeline_set_layer_filters (pipeline, 0,
+                                       COGL_PIPELINE_FILTER_LINEAR_MIPMAP_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+      cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+      area_src->downscale_pipeline = pipeline;
+    }
+
+  clutter_stage_paint_to_framebuffer (stage, downscale_framebuffer,
+                                      area, scale,
+                                      paint_flags);
+
+  if (paint_flags & CLUTTER_PAINT_FLAG_CLEAR)
+    {
+      CoglColor clear_color;
+
+      cogl_color_init_from_4f (&clear_color, 0.0, 0.0, 0.0, 0.0);
+      cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+    }
+
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (framebuffer),
+                                 cogl_framebuffer_get_height (framebuffer),
+                                 -1, 100);
+  cogl_framebuffer_draw_rectangle (framebuffer,
+                                   area_src->downscale_pipeline,
+                                   0, 0,
+                                   roundf (area->width * stream_scale),
+                                   roundf (area->height * stream_scale));
+
+  return TRUE;
+}
+
+static gboolean
+record_downscaled_to_buffer (MetaScreenCastAreaStreamSrc  *area_src,
+                             int                           width,
+                             int                           height,
+                             int                           stride,
+                             uint8_t                      *data,
+                             ClutterPaintFlag              paint_flags,
+                             GError                      **error)
+{
+  CoglFramebuffer *framebuffer;
+  g_autoptr (CoglBitmap) bitmap = NULL;
+
+  if (!ensure_offscreen (area_src, &area_src->scaled_offscreen,
+                         width, height,
+                         error))
+    return FALSE;
+
+  framebuffer = COGL_FRAMEBUFFER (area_src->scaled_offscreen);
+  if (!paint_downscaled (area_src, framebuffer, paint_flags, error))
+    return FALSE;
+
+  bitmap = cogl_bitmap_new_for_data (get_cogl_context (area_src),
+                                     width, height,
+                                     COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                     stride,
+                                     data);
+  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                 0, 0,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER,
+                                                 bitmap))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to read back downscaled frame");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 is_cursor_in_stream (MetaScreenCastAreaStreamSrc *area_src)
 {
@@ -456,6 +728,15 @@ meta_screen_cast_area_stream_src_disable (MetaScreenCastStreamSrc *src)
 
   g_clear_handle_id (&area_src->maybe_record_idle_id, g_source_remove);
 
+  if (area_src->shared_capture)
+    {
+      meta_screen_cast_release_shared_capture (get_screen_cast (area_src),
+                                               area_src->shared_capture);
+      area_src->shared_capture = NULL;
+    }
+
+  clear_scaling_state (area_src);
+
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
     {
     case META_SCREEN_CAST_CURSOR_MODE_METADATA:
@@ -482,22 +763,39 @@ meta_screen_cast_area_stream_src_record_to_buffer (MetaScreenCastStreamSrc   *sr
   MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
   ClutterStage *stage;
   MtkRectangle *area;
+  MetaScreenCastSharedCapture *shared_capture;
   float scale;
-  ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+  ClutterPaintFlag paint_flags;
 
   stage = get_stage (area_src);
   area = meta_screen_cast_area_stream_get_area (area_stream);
-  scale = meta_screen_cast_area_stream_get_scale (area_stream);
+  scale = get_stream_scale (area_src);
+  paint_flags = get_paint_flags (area_src);
 
-  switch (meta_screen_cast_stream_get_cursor_mode (stream))
+  if (needs_downscale_pass (area_src))
     {
-    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
-    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
-      paint_flags |= CLUTTER_PAINT_FLAG_NO_CURSORS;
-      break;
-    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
-      paint_flags |= CLUTTER_PAINT_FLAG_FORCE_CURSORS;
-      break;
+      return record_downscaled_to_buffer (area_src,
+                                          width, height, stride, data,
+                                          paint_flags,
+                                          error);
+    }
+
+  if ((int) roundf (area->width * scale) > width ||
+      (int) roundf (area->height * scale) > height)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Stream buffer too small for the area");
+      return FALSE;
+    }
+
+  shared_capture = ensure_shared_capture (area_src, area, scale, paint_flags);
+  if (meta_screen_cast_shared_capture_is_shared (shared_capture))
+    {
+      return meta_screen_cast_shared_capture_read_pixels (shared_capture,
+                                                          stride,
+                                                          COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                                          data,
+                                                          error);
     }
 
   if (!clutter_stage_paint_to_buffer (stage, area, scale,
@@ -524,27 +822,42 @@ meta_screen_cast_area_stream_src_record_to_framebuffer (MetaScreenCastStreamSrc
   MetaBackend *backend = get_backend (area_src);
   ClutterStage *stage;
   MtkRectangle *area;
+  MetaScreenCastSharedCapture *shared_capture;
   float scale;
-  ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+  ClutterPaintFlag paint_flags;
 
   stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
   area = meta_screen_cast_area_stream_get_area (area_stream);
-  scale = meta_screen_cast_area_stream_get_scale (area_stream);
+  scale = get_stream_scale (area_src);
+  paint_flags = get_paint_flags (area_src);
 
-  switch (meta_screen_cast_stream_get_cursor_mode (stream))
+  if (needs_downscale_pass (area_src))
     {
-    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
-    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
-      paint_flags |= CLUTTER_PAINT_FLAG_NO_CURSORS;
-      break;
-    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
-      paint_flags |= CLUTTER_PAINT_FLAG_FORCE_CURSORS;
-      break;
+      if (!paint_downscaled (area_src, framebuffer, paint_flags, error))
+        return FALSE;
+
+      goto out;
     }
+
+  shared_capture = ensure_shared_capture (area_src, area, scale, paint_flags);
+  if (meta_screen_cast_shared_capture_is_shared (shared_capture))
+    {
+      g_autoptr (GError) local_error = NULL;
+
+      if (meta_screen_cast_shared_capture_blit (shared_capture,
+                                                framebuffer,
+                                                &local_error))
+        goto out;
+
+      g_warning ("Error blitting shared capture to screencast framebuffer: %s",
+                 local_error->message);
+    }
+
   clutter_stage_paint_to_framebuffer (stage, framebuffer,
                                       area, scale,
                                       paint_flags);
 
+out:
   cogl_framebuffer_flush (framebuffer);
 
   return TRUE;
@@ -594,7 +907,7 @@ get_cursor_position (MetaScreenCastAreaStreamSrc *area_src,
   graphene_point_t cursor_position;
 
   area = meta_screen_cast_area_stream_get_area (area_stream);
-  scale = meta_screen_cast_area_stream_get_scale (area_stream);
+  scale = get_stream_scale (area_src);
 
   meta_cursor_tracker_get_pointer (cursor_tracker, &cursor_position, NULL);
   cursor_position.x -= area->x;
@@ -639,8 +952,6 @@ meta_screen_cast_area_stream_src_set_cursor_metadata (MetaScreenCastStreamSrc *s
 {
   MetaScreenCastAreaStreamSrc *area_src =
     META_SCREEN_CAST_AREA_STREAM_SRC (src);
-  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
-  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
   MetaBackend *backend = get_backend (area_src);
   MetaCursorRenderer *cursor_renderer =
     meta_backend_get_cursor_renderer (backend);
@@ -669,7 +980,7 @@ meta_screen_cast_area_stream_src_set_cursor_metadata (MetaScreenCastStreamSrc *s
         {
           float view_scale;
 
-          view_scale = meta_screen_cast_area_stream_get_scale (area_stream);
+          view_scale = get_stream_scale (area_src);
 
           meta_screen_cast_stream_src_set_cursor_sprite_metadata (src,
                                                                   spa_meta_cursor,
@@ -719,6 +1030,18 @@ meta_screen_cast_area_stream_src_new (MetaScreenCastAreaStream  *area_stream,
                          NULL);
 }
 
+static void
+meta_screen_cast_area_stream_src_notify_params_updated (MetaScreenCastStreamSrc   *src,
+                                                        struct spa_video_info_raw *video_format)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+
+  area_src->stream_width = video_format->size.width;
+  area_src->stream_height = video_format->size.height;
+  area_src->cursor_bitmap_invalid = TRUE;
+}
+
 static void
 meta_screen_cast_area_stream_src_init (MetaScreenCastAreaStreamSrc *area_src)
 {
@@ -732,6 +1055,8 @@ meta_screen_cast_area_stream_src_class_init (MetaScreenCastAreaStreamSrcClass *k
     META_SCREEN_CAST_STREAM_SRC_CLASS (klass);
 
   src_class->get_specs = meta_screen_cast_area_stream_src_get_specs;
+  src_class->supports_scaling =
+    meta_screen_cast_area_stream_src_supports_scaling;
   src_class->enable = meta_screen_cast_area_stream_src_enable;
   src_class->disable = meta_screen_cast_area_stream_src_disable;
   src_class->record_to_buffer =
@@ -744,6 +1069,8 @@ meta_screen_cast_area_stream_src_class_init (MetaScreenCastAreaStreamSrcClass *k
     meta_screen_cast_area_stream_src_is_cursor_metadata_valid;
   src_class->set_cursor_metadata =
     meta_screen_cast_area_stream_src_set_cursor_metadata;
+  src_class->notify_params_updated =
+    meta_screen_cast_area_stream_src_notify_params_updated;
 }
 
 #pragma GCC diagnostic pop
@@ -55,6 +55,8 @@ struct _MetaScreenCastMonitorStreamSrc
   gulong stage_prepare_frame_handler_id;
 
   guint maybe_record_idle_id;
+
+  MetaScreenCastSharedCapture *shared_capture;
 };
 
 static void
@@ -66,16 +68,47 @@ G_DEFINE_TYPE_WITH_CODE (MetaScreenCastMonitorStreamSrc,
                          G_IMPLEMENT_INTERFACE (META_TYPE_HW_CURSOR_INHIBITOR,
                                                 hw_cursor_inhibitor_iface_init))
 
-static MetaBackend *
-get_backend (MetaScreenCastMonitorStreamSrc *monitor_src)
+static MetaScreenCast *
+get_screen_cast (MetaScreenCastMonitorStreamSrc *monitor_src)
 {
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
   MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
   MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
-  MetaScreenCast *screen_cast =
-    meta_screen_cast_session_get_screen_cast (session);
 
-  return meta_screen_cast_get_backend (screen_cast);
+  return meta_screen_cast_session_get_screen_cast (session);
+}
+
+static MetaBackend *
+get_backend (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  return meta_screen_cast_get_backend (get_screen_cast (monitor_src));
+}
+
+static MetaScreenCastSharedCapture *
+ensure_shared_capture (MetaScreenCastMonitorStreamSrc *monitor_src,
+                       const MtkRectangle             *rect,
+                       float                           scale,
+                       ClutterPaintFlag                paint_flags)
+{
+  MetaScreenCast *screen_cast = get_screen_cast (monitor_src);
+
+  if (monitor_src->shared_capture &&
+      !meta_screen_cast_shared_capture_matches (monitor_src->shared_capture,
+                                                rect, scale, paint_flags))
+    {
+      meta_screen_cast_release_shared_capture (screen_cast,
+                                               monitor_src->shared_capture);
+      monitor_src->shared_capture = NULL;
+    }
+
+  if (!monitor_src->shared_capture)
+    {
+      monitor_src->shared_capture =
+        meta_screen_cast_acquire_shared_capture (screen_cast,
+                                                 rect, scale, paint_flags);
+    }
+
+  return monitor_src->shared_capture;
 }
 
 static ClutterStage *
@@ -534,6 +567,13 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
 
   g_clear_handle_id (&monitor_src->maybe_record_idle_id, g_source_remove);
 
+  if (monitor_src->shared_capture)
+    {
+      meta_screen_cast_release_shared_capture (get_screen_cast (monitor_src),
+                                               monitor_src->shared_capture);
+      monitor_src->shared_capture = NULL;
+    }
+
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
     {
     case META_SCREEN_CAST_CURSOR_MODE_METADATA:
@@ -545,6 +585,64 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
     }
 }
 
+static gboolean
+read_view_pixels (MetaScreenCastMonitorStreamSrc  *monitor_src,
+                  int                              width,
+                  int                              height,
+                  int                              stride,
+                  uint8_t                         *data)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  MtkRectangle logical_monitor_layout;
+  MetaRendererView *renderer_view;
+  CoglFramebuffer *view_framebuffer;
+  MtkRectangle view_layout;
+  MetaCrtc *crtc;
+  GList *outputs;
+  g_autoptr (CoglBitmap) bitmap = NULL;
+
+  monitor = get_monitor (monitor_src);
+  outputs = meta_monitor_get_outputs (monitor);
+  if (outputs->next)
+    return FALSE;
+
+  crtc = meta_output_get_assigned_crtc (outputs->data);
+  renderer_view = meta_renderer_get_view_for_crtc (renderer, crtc);
+  if (!renderer_view)
+    return FALSE;
+
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
+  clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (renderer_view),
+                                 &view_layout);
+  if (view_layout.x != logical_monitor_layout.x ||
+      view_layout.y != logical_monitor_layout.y)
+    return FALSE;
+
+  view_framebuffer =
+    clutter_stage_view_get_framebuffer (CLUTTER_STAGE_VIEW (renderer_view));
+  if (cogl_framebuffer_get_width (view_framebuffer) != width ||
+      cogl_framebuffer_get_height (view_framebuffer) != height)
+    return FALSE;
+
+  bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                     width, height,
+                                     COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                     stride,
+                                     data);
+
+  return cogl_framebuffer_read_pixels_into_bitmap (view_framebuffer,
+                                                   0, 0,
+                                                   COGL_READ_PIXELS_COLOR_BUFFER,
+                                                   bitmap);
+}
+
 static gboolean
 meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc   *src,
                                                       MetaScreenCastPaintPhase   paint_phase,
@@ -561,6 +659,7 @@ meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc
   ClutterStage *stage;
   MetaMonitor *monitor;
   MetaLogicalMonitor *logical_monitor;
+  MetaScreenCastSharedCapture *shared_capture;
   float scale;
   ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
 
@@ -584,6 +683,26 @@ meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc
       break;
     }
 
+  shared_capture = ensure_shared_capture (monitor_src,
+                                          &logical_monitor->rect,
+                                          scale,
+                                          paint_flags);
+  if (meta_screen_cast_shared_capture_is_shared (shared_capture))
+    {
+      return meta_screen_cast_shared_capture_read_pixels (shared_capture,
+                                                          stride,
+                                                          COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                                          data,
+                                                          error);
+    }
+
+  /* The view was just painted for this frame; reading it back avoids
+   * painting the whole stage again, which is what dominates the cost of
+   * screen casting when rendering without a GPU. */
+  if (paint_phase == META_SCREEN_CAST_PAINT_PHASE_PRE_SWAP_BUFFER &&
+      read_view_pixels (monitor_src, width, height, stride, data))
+    return TRUE;
+
   if (!clutter_stage_paint_to_buffer (stage, &logical_monitor->rect, scale,
                                       data,
                                       stride,
@@ -694,6 +813,7 @@ stage_paint:
   if (do_stage_paint)
     {
       ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+      MetaScreenCastSharedCapture *shared_capture;
 
       switch (meta_screen_cast_stream_get_cursor_mode (stream))
         {
@@ -707,6 +827,22 @@ stage_paint:
           break;
         }
 
+      shared_capture = ensure_shared_capture (monitor_src,
+                                              &logical_monitor_layout,
+                                              view_scale,
+                                              paint_flags);
+      if (meta_screen_cast_shared_capture_is_shared (shared_capture))
+        {
+          g_clear_error (&local_error);
+          if (meta_screen_cast_shared_capture_blit (shared_capture,
+                                                    framebuffer,
+                                                    &local_error))
+            goto out;
+
+          g_warning ("Error blitting shared capture to screencast "
+                     "framebuffer: %s", local_error->message);
+        }
+
       clutter_stage_paint_to_framebuffer (stage,
                                           framebuffer,
                                           &logical_monitor_layout,
@@ -714,6 +850,7 @@ stage_paint:
                                           paint_flags);
     }
 
+out:
   cogl_framebuffer_flush (framebuffer);
 
   return TRUE;
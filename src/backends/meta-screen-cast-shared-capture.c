@@ -0,0 +1,246 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * When the same part of the stage is cast to several consumers at once,
+ * e.g. a recording, a meeting and a remote support session of the same
+ * monitor, each stream would otherwise paint the stage on its own every
+ * time it records a frame. Streams capturing the same area with the same
+ * scale and paint flags instead share one capture: the stage is painted
+ * once per stage frame into an offscreen framebuffer, and each stream
+ * only copies the result into its own buffers.
+ *
+ * The capture is considered up to date until the stage presents a new
+ * frame, as nothing visible can change in between without a new frame
+ * being painted.
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-shared-capture.h"
+
+#include <float.h>
+#include <gio/gio.h>
+#include <math.h>
+
+#include "backends/meta-backend-private.h"
+#include "clutter/clutter-mutter.h"
+
+struct _MetaScreenCastSharedCapture
+{
+  MetaBackend *backend;
+
+  MtkRectangle rect;
+  float scale;
+  ClutterPaintFlag paint_flags;
+
+  int n_users;
+
+  CoglOffscreen *offscreen;
+  gboolean is_painted;
+  int64_t frame_counter;
+};
+
+MetaScreenCastSharedCapture *
+meta_screen_cast_shared_capture_new (MetaBackend        *backend,
+                                     const MtkRectangle *rect,
+                                     float               scale,
+                                     ClutterPaintFlag    paint_flags)
+{
+  MetaScreenCastSharedCapture *capture;
+
+  capture = g_new0 (MetaScreenCastSharedCapture, 1);
+  capture->backend = backend;
+  capture->rect = *rect;
+  capture->scale = scale;
+  capture->paint_flags = paint_flags;
+
+  return capture;
+}
+
+void
+meta_screen_cast_shared_capture_free (MetaScreenCastSharedCapture *capture)
+{
+  g_clear_object (&capture->offscreen);
+  g_free (capture);
+}
+
+gboolean
+meta_screen_cast_shared_capture_matches (MetaScreenCastSharedCapture *capture,
+                                         const MtkRectangle          *rect,
+                                         float                        scale,
+                                         ClutterPaintFlag             paint_flags)
+{
+  return (mtk_rectangle_equal (&capture->rect, rect) &&
+          G_APPROX_VALUE (capture->scale, scale, FLT_EPSILON) &&
+          capture->paint_flags == paint_flags);
+}
+
+void
+meta_screen_cast_shared_capture_add_user (MetaScreenCastSharedCapture *capture)
+{
+  capture->n_users++;
+}
+
+/* Returns TRUE when the capture isn't used anymore */
+gboolean
+meta_screen_cast_shared_capture_remove_user (MetaScreenCastSharedCapture *capture)
+{
+  g_return_val_if_fail (capture->n_users > 0, TRUE);
+
+  capture->n_users--;
+
+  if (capture->n_users == 1)
+    {
+      g_clear_object (&capture->offscreen);
+      capture->is_painted = FALSE;
+    }
+
+  return capture->n_users == 0;
+}
+
+gboolean
+meta_screen_cast_shared_capture_is_shared (MetaScreenCastSharedCapture *capture)
+{
+  return capture->n_users > 1;
+}
+
+static gboolean
+ensure_offscreen (MetaScreenCastSharedCapture  *capture,
+                  GError                      **error)
+{
+  ClutterBackend *clutter_backend =
+    meta_backend_get_clutter_backend (capture->backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  int width, height;
+
+  if (capture->offscreen)
+    return TRUE;
+
+  width = (int) roundf (capture->rect.width * capture->scale);
+  height = (int) roundf (capture->rect.height * capture->scale);
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  if (!texture)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to create %dx%d texture", width, height);
+      return FALSE;
+    }
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return FALSE;
+
+  capture->offscreen = g_steal_pointer (&offscreen);
+  capture->is_painted = FALSE;
+
+  return TRUE;
+}
+
+static CoglFramebuffer *
+ensure_painted (MetaScreenCastSharedCapture  *capture,
+                GError                      **error)
+{
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (capture->backend));
+  CoglFramebuffer *framebuffer;
+  int64_t frame_counter;
+
+  if (!ensure_offscreen (capture, error))
+    return NULL;
+
+  framebuffer = COGL_FRAMEBUFFER (capture->offscreen);
+  frame_counter = clutter_stage_get_frame_counter (stage);
+
+  if (capture->is_painted && capture->frame_counter == frame_counter)
+    return framebuffer;
+
+  clutter_stage_paint_to_framebuffer (stage, framebuffer,
+                                      &capture->rect,
+                                      capture->scale,
+                                      capture->paint_flags);
+
+  capture->is_painted = TRUE;
+  capture->frame_counter = frame_counter;
+
+  return framebuffer;
+}
+
+gboolean
+meta_screen_cast_shared_capture_read_pixels (MetaScreenCastSharedCapture  *capture,
+                                             int                           stride,
+                                             CoglPixelFormat               format,
+                                             uint8_t                      *data,
+                                             GError                      **error)
+{
+  ClutterBackend *clutter_backend =
+    meta_backend_get_clutter_backend (capture->backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  CoglFramebuffer *framebuffer;
+  g_autoptr (CoglBitmap) bitmap = NULL;
+
+  framebuffer = ensure_painted (capture, error);
+  if (!framebuffer)
+    return FALSE;
+
+  bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                     cogl_framebuffer_get_width (framebuffer),
+                                     cogl_framebuffer_get_height (framebuffer),
+                                     format,
+                                     stride,
+                                     data);
+
+  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                 0, 0,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER,
+                                                 bitmap))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to read pixels of shared capture");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+gboolean
+meta_screen_cast_shared_capture_blit (MetaScreenCastSharedCapture  *capture,
+                                      CoglFramebuffer              *framebuffer,
+                                      GError                      **error)
+{
+  CoglFramebuffer *capture_framebuffer;
+
+  capture_framebuffer = ensure_painted (capture, error);
+  if (!capture_framebuffer)
+    return FALSE;
+
+  return cogl_framebuffer_blit (capture_framebuffer,
+                                framebuffer,
+                                0, 0,
+                                0, 0,
+                                MIN (cogl_framebuffer_get_width (capture_framebuffer),
+                                     cogl_framebuffer_get_width (framebuffer)),
+                                MIN (cogl_framebuffer_get_height (capture_framebuffer),
+                                     cogl_framebuffer_get_height (framebuffer)),
+                                error);
+}
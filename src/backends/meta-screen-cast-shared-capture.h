@@ -0,0 +1,56 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "backends/meta-backend-types.h"
+#include "clutter/clutter.h"
+#include "cogl/cogl.h"
+#include "mtk/mtk.h"
+
+typedef struct _MetaScreenCastSharedCapture MetaScreenCastSharedCapture;
+
+MetaScreenCastSharedCapture * meta_screen_cast_shared_capture_new (MetaBackend        *backend,
+                                                                   const MtkRectangle *rect,
+                                                                   float               scale,
+                                                                   ClutterPaintFlag    paint_flags);
+
+void meta_screen_cast_shared_capture_free (MetaScreenCastSharedCapture *capture);
+
+gboolean meta_screen_cast_shared_capture_matches (MetaScreenCastSharedCapture *capture,
+                                                  const MtkRectangle          *rect,
+                                                  float                        scale,
+                                                  ClutterPaintFlag             paint_flags);
+
+void meta_screen_cast_shared_capture_add_user (MetaScreenCastSharedCapture *capture);
+
+gboolean meta_screen_cast_shared_capture_remove_user (MetaScreenCastSharedCapture *capture);
+
+gboolean meta_screen_cast_shared_capture_is_shared (MetaScreenCastSharedCapture *capture);
+
+gboolean meta_screen_cast_shared_capture_read_pixels (MetaScreenCastSharedCapture  *capture,
+                                                      int                           stride,
+                                                      CoglPixelFormat               format,
+                                                      uint8_t                      *data,
+                                                      GError                      **error);
+
+gboolean meta_screen_cast_shared_capture_blit (MetaScreenCastSharedCapture  *capture,
+                                               CoglFramebuffer              *framebuffer,
+                                               GError                      **error);
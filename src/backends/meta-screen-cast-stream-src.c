@@ -46,6 +46,7 @@
 
 #include "backends/meta-screen-cast-session.h"
 #include "backends/meta-screen-cast-stream.h"
+#include "compositor/meta-multi-texture-format-private.h"
 #include "core/meta-fraction.h"
 
 #ifdef HAVE_NATIVE_BACKEND
@@ -74,6 +75,12 @@
 
 #define DEFAULT_COGL_PIXEL_FORMAT COGL_PIXEL_FORMAT_BGRX_8888
 
+/* Bounds of the frame interval used when the consumer can't keep up, and
+ * how long it must keep up before the interval is shortened again */
+#define MAX_PACED_FRAME_INTERVAL_US (G_USEC_PER_SEC / 5)
+#define PACING_RECOVERY_DELAY_US (G_USEC_PER_SEC)
+#define NOMINAL_FRAME_INTERVAL_US (G_USEC_PER_SEC / 60)
+
 enum
 {
   PROP_0,
@@ -124,6 +131,15 @@ typedef struct _MetaScreenCastStreamSrcPrivate
   int64_t last_frame_timestamp_us;
   guint follow_up_frame_source_id;
 
+  /* Frame interval imposed on top of the negotiated framerate while the
+   * consumer returns buffers too slowly, or 0 */
+  int64_t paced_frame_interval_us;
+  int64_t last_backpressure_us;
+
+  uint64_t n_frames_recorded;
+  uint64_t n_frames_dropped;
+  int64_t total_record_time_us;
+
   uint64_t buffer_sequence_counter;
 
   int buffer_count;
@@ -132,6 +148,14 @@ typedef struct _MetaScreenCastStreamSrcPrivate
   gboolean uses_dma_bufs;
   GHashTable *dmabuf_handles;
 
+  /* Frames of YUV streams are recorded into an RGB framebuffer first, and
+   * then converted into the planes of the buffer on the GPU */
+  MetaMultiTextureFormat yuv_format;
+  CoglTexture *yuv_source_texture;
+  CoglFramebuffer *yuv_source_framebuffer;
+  CoglPipeline *yuv_plane_pipelines[COGL_PIXEL_FORMAT_MAX_PLANES];
+  gboolean yuv_formats_disabled;
+
   /* Keys: File descriptors
    * Values: MetaDrmTimeline object pointers
    *
@@ -147,11 +171,35 @@ typedef struct _MetaScreenCastStreamSrcPrivate
 
   MtkRegion *redraw_clip;
 
+  /* Keys: pw_buffer pointers of CPU memory buffers
+   * Values: MtkRegion of the area that changed since the buffer was last
+   * written to, so that only that area needs to be read back
+   */
+  GHashTable *buffer_damage;
+
+  /* Frames of CPU memory buffers are recorded into this framebuffer when
+   * possible, and read back without waiting for the GPU. The buffers are
+   * only queued once their pending readback finished */
+  CoglTexture *readback_texture;
+  CoglFramebuffer *readback_framebuffer;
+  GList *pending_readbacks;
+
   GHashTable *modifiers;
 } MetaScreenCastStreamSrcPrivate;
 
+typedef struct _PendingReadback
+{
+  MetaScreenCastStreamSrc *src;
+  struct pw_buffer *buffer;
+  MtkRectangle area;
+  GCancellable *cancellable;
+} PendingReadback;
+
 static void meta_screen_cast_stream_src_init_initable_iface (GInitableIface *iface);
 
+static void invalidate_buffer_damage (MetaScreenCastStreamSrc *src,
+                                      struct pw_buffer        *buffer);
+
 G_DEFINE_TYPE_WITH_CODE (MetaScreenCastStreamSrc,
                          meta_screen_cast_stream_src,
                          G_TYPE_OBJECT,
@@ -167,6 +215,16 @@ static const struct {
   { COGL_PIXEL_FORMAT_BGRA_8888_PRE, SPA_VIDEO_FORMAT_BGRA },
 };
 
+/* Only offered as linear DMA buffers, with each plane in its own buffer */
+static const struct {
+  MetaMultiTextureFormat multi_format;
+  enum spa_video_format spa_video_format;
+} supported_yuv_formats[] = {
+  { META_MULTI_TEXTURE_FORMAT_NV12, SPA_VIDEO_FORMAT_NV12 },
+  { META_MULTI_TEXTURE_FORMAT_YUV420, SPA_VIDEO_FORMAT_I420 },
+  { META_MULTI_TEXTURE_FORMAT_P010, SPA_VIDEO_FORMAT_P010_10LE },
+};
+
 
 #ifdef HAVE_NATIVE_BACKEND
 
@@ -226,6 +284,52 @@ cogl_pixel_format_from_spa_video_format (enum spa_video_format  spa_format,
   return FALSE;
 }
 
+static gboolean
+multi_texture_format_from_spa_video_format (enum spa_video_format   spa_format,
+                                            MetaMultiTextureFormat *out_multi_format)
+{
+  size_t i;
+
+  for (i = 0; i < G_N_ELEMENTS (supported_yuv_formats); i++)
+    {
+      if (supported_yuv_formats[i].spa_video_format == spa_format)
+        {
+          if (out_multi_format)
+            *out_multi_format = supported_yuv_formats[i].multi_format;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static int
+get_n_video_planes (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaMultiTextureFormat multi_format;
+
+  if (!multi_texture_format_from_spa_video_format (priv->video_format.format,
+                                                   &multi_format))
+    return 1;
+
+  return meta_multi_texture_format_get_info (multi_format)->n_planes;
+}
+
+static CoglContext *
+get_cogl_context (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
+  MetaBackend *backend = meta_screen_cast_get_backend (screen_cast);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+
+  return clutter_backend_get_cogl_context (clutter_backend);
+}
+
 static struct spa_pod *
 push_format_object (enum spa_video_format  format,
                     uint64_t              *modifiers,
@@ -331,6 +435,51 @@ meta_screen_cast_stream_src_record_to_buffer (MetaScreenCastStreamSrc   *src,
                                   width, height, stride, data, error);
 }
 
+static gboolean
+meta_screen_cast_stream_src_record_to_buffer_region (MetaScreenCastStreamSrc   *src,
+                                                     MetaScreenCastPaintPhase   paint_phase,
+                                                     const MtkRegion           *region,
+                                                     int                        width,
+                                                     int                        height,
+                                                     int                        stride,
+                                                     uint8_t                   *data,
+                                                     GError                   **error)
+{
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+  MtkRectangle stream_rect = { 0, 0, width, height };
+  int n_rectangles;
+  int i;
+
+  if (!klass->record_to_buffer_area ||
+      mtk_region_contains_rectangle (region, &stream_rect) ==
+      MTK_REGION_OVERLAP_IN)
+    {
+      return klass->record_to_buffer (src, paint_phase,
+                                      width, height, stride, data, error);
+    }
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  if (n_rectangles > NUM_DAMAGED_RECTS)
+    {
+      MtkRectangle extents = mtk_region_get_extents (region);
+
+      return klass->record_to_buffer_area (src, paint_phase, &extents,
+                                           stride, data, error);
+    }
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+
+      if (!klass->record_to_buffer_area (src, paint_phase, &rect,
+                                         stride, data, error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 meta_screen_cast_stream_src_record_to_framebuffer (MetaScreenCastStreamSrc   *src,
                                                    MetaScreenCastPaintPhase   paint_phase,
@@ -343,6 +492,52 @@ meta_screen_cast_stream_src_record_to_framebuffer (MetaScreenCastStreamSrc   *sr
   return klass->record_to_framebuffer (src, paint_phase, framebuffer, error);
 }
 
+static gboolean
+meta_screen_cast_stream_src_record_to_framebuffer_region (MetaScreenCastStreamSrc   *src,
+                                                          MetaScreenCastPaintPhase   paint_phase,
+                                                          const MtkRegion           *region,
+                                                          CoglFramebuffer           *framebuffer,
+                                                          GError                   **error)
+{
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+  MtkRectangle stream_rect = {
+    .width = cogl_framebuffer_get_width (framebuffer),
+    .height = cogl_framebuffer_get_height (framebuffer),
+  };
+  int n_rectangles;
+  int i;
+
+  if (!klass->record_to_framebuffer_area ||
+      mtk_region_contains_rectangle (region, &stream_rect) ==
+      MTK_REGION_OVERLAP_IN)
+    return klass->record_to_framebuffer (src, paint_phase, framebuffer, error);
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  if (n_rectangles > NUM_DAMAGED_RECTS)
+    {
+      MtkRectangle extents = mtk_region_get_extents (region);
+
+      if (!klass->record_to_framebuffer_area (src, paint_phase, &extents,
+                                              framebuffer, error))
+        return FALSE;
+    }
+  else
+    {
+      for (i = 0; i < n_rectangles; i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (region, i);
+
+          if (!klass->record_to_framebuffer_area (src, paint_phase, &rect,
+                                                  framebuffer, error))
+            return FALSE;
+        }
+    }
+
+  cogl_framebuffer_flush (framebuffer);
+  return TRUE;
+}
+
 static void
 meta_screen_cast_stream_src_record_follow_up (MetaScreenCastStreamSrc *src)
 {
@@ -755,16 +950,402 @@ maybe_set_sync_points (MetaScreenCastStreamSrc *src,
 #endif /* HAVE_NATIVE_BACKEND */
 }
 
+static void
+clear_yuv_conversion (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (priv->yuv_plane_pipelines); i++)
+    g_clear_object (&priv->yuv_plane_pipelines[i]);
+  g_clear_object (&priv->yuv_source_framebuffer);
+  g_clear_object (&priv->yuv_source_texture);
+}
+
+static gboolean
+ensure_yuv_conversion (MetaScreenCastStreamSrc  *src,
+                       MetaMultiTextureFormat    multi_format,
+                       GError                  **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  CoglContext *cogl_context = get_cogl_context (src);
+  const MetaMultiTextureFormatInfo *info =
+    meta_multi_texture_format_get_info (multi_format);
+  int width = priv->video_format.size.width;
+  int height = priv->video_format.size.height;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  int i;
+
+  if (priv->yuv_source_texture &&
+      priv->yuv_format == multi_format &&
+      cogl_texture_get_width (priv->yuv_source_texture) == width &&
+      cogl_texture_get_height (priv->yuv_source_texture) == height)
+    return TRUE;
+
+  clear_yuv_conversion (src);
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  cogl_texture_set_components (texture, COGL_TEXTURE_COMPONENTS_RGB);
+  if (!cogl_texture_allocate (texture, error))
+    return FALSE;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return FALSE;
+
+  for (i = 0; i < info->n_planes; i++)
+    {
+      g_autoptr (CoglSnippet) globals_snippet = NULL;
+      g_autoptr (CoglSnippet) plane_snippet = NULL;
+      CoglPipeline *pipeline;
+
+      if (!meta_multi_texture_format_get_plane_snippets (multi_format, i,
+                                                         &globals_snippet,
+                                                         &plane_snippet))
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       "Can't convert to plane %d of %s", i,
+                       meta_multi_texture_format_to_string (multi_format));
+          return FALSE;
+        }
+
+      pipeline = cogl_pipeline_new (cogl_context);
+      cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+      cogl_pipeline_set_layer_filters (pipeline, 0,
+                                       COGL_PIPELINE_FILTER_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+      cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      cogl_pipeline_add_snippet (pipeline, globals_snippet);
+      cogl_pipeline_add_snippet (pipeline, plane_snippet);
+      cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+      priv->yuv_plane_pipelines[i] = pipeline;
+    }
+
+  priv->yuv_format = multi_format;
+  priv->yuv_source_texture = g_steal_pointer (&texture);
+  priv->yuv_source_framebuffer =
+    COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+
+  return TRUE;
+}
+
+static gboolean
+record_to_yuv_planes (MetaScreenCastStreamSrc   *src,
+                      MetaScreenCastPaintPhase   paint_phase,
+                      MetaMultiTextureFormat     multi_format,
+                      struct spa_buffer         *spa_buffer,
+                      GError                   **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  const MetaMultiTextureFormatInfo *info =
+    meta_multi_texture_format_get_info (multi_format);
+  int i;
+
+  if (!ensure_yuv_conversion (src, multi_format, error))
+    return FALSE;
+
+  if (!meta_screen_cast_stream_src_record_to_framebuffer (src,
+                                                          paint_phase,
+                                                          priv->yuv_source_framebuffer,
+                                                          error))
+    return FALSE;
+
+  for (i = 0; i < info->n_planes; i++)
+    {
+      struct spa_data *spa_data = &spa_buffer->datas[i];
+      CoglDmaBufHandle *dmabuf_handle;
+      CoglFramebuffer *plane_fbo;
+      int plane_width;
+      int plane_height;
+
+      dmabuf_handle = g_hash_table_lookup (priv->dmabuf_handles,
+                                           GINT_TO_POINTER (spa_data->fd));
+      g_assert (dmabuf_handle != NULL);
+
+      plane_fbo = cogl_dma_buf_handle_get_framebuffer (dmabuf_handle);
+      plane_width = cogl_framebuffer_get_width (plane_fbo);
+      plane_height = cogl_framebuffer_get_height (plane_fbo);
+
+      cogl_framebuffer_orthographic (plane_fbo,
+                                     0, 0, plane_width, plane_height,
+                                     0, 1.0);
+      cogl_framebuffer_draw_textured_rectangle (plane_fbo,
+                                                priv->yuv_plane_pipelines[i],
+                                                0, 0,
+                                                plane_width, plane_height,
+                                                0, 0, 1, 1);
+      cogl_framebuffer_flush (plane_fbo);
+    }
+
+  return TRUE;
+}
+
+static void
+update_buffer_chunks (MetaScreenCastStreamSrc *src,
+                      struct spa_buffer       *spa_buffer,
+                      gboolean                 is_valid)
+{
+  int n_planes = get_n_video_planes (src);
+  int i;
+
+  for (i = 0; i < n_planes && i < spa_buffer->n_datas; i++)
+    {
+      struct spa_data *spa_data = &spa_buffer->datas[i];
+
+      if (is_valid)
+        {
+          spa_data->chunk->size = spa_data->maxsize;
+          spa_data->chunk->flags = SPA_CHUNK_FLAG_NONE;
+        }
+      else
+        {
+          spa_data->chunk->size = 0;
+          spa_data->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
+        }
+    }
+}
+
+static void
+pending_readback_free (PendingReadback *readback)
+{
+  g_object_unref (readback->cancellable);
+  g_free (readback);
+}
+
+static PendingReadback *
+find_pending_readback (MetaScreenCastStreamSrc *src,
+                       struct pw_buffer        *buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  GList *l;
+
+  for (l = priv->pending_readbacks; l; l = l->next)
+    {
+      PendingReadback *readback = l->data;
+
+      if (readback->buffer == buffer)
+        return readback;
+    }
+
+  return NULL;
+}
+
+/* The readback owns itself until its callback runs */
+static void
+cancel_pending_readback (MetaScreenCastStreamSrc *src,
+                         PendingReadback         *readback)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  priv->pending_readbacks = g_list_remove (priv->pending_readbacks,
+                                           readback);
+  readback->src = NULL;
+  readback->buffer = NULL;
+  g_cancellable_cancel (readback->cancellable);
+}
+
+static void
+cancel_pending_readbacks (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  while (priv->pending_readbacks)
+    cancel_pending_readback (src, priv->pending_readbacks->data);
+}
+
+static void
+clear_readback_framebuffer (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  g_clear_object (&priv->readback_framebuffer);
+  g_clear_object (&priv->readback_texture);
+}
+
+static gboolean
+can_record_to_buffer_async (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+  CoglContext *cogl_context = get_cogl_context (src);
+
+  /* Without fences, mapping the pixel buffer would wait for the GPU just
+   * like a synchronous read */
+  return (klass->record_to_framebuffer &&
+          cogl_context_has_feature (cogl_context,
+                                    COGL_FEATURE_ID_MAP_BUFFER_FOR_READ) &&
+          cogl_context_has_feature (cogl_context, COGL_FEATURE_ID_FENCE));
+}
+
+static gboolean
+ensure_readback_framebuffer (MetaScreenCastStreamSrc  *src,
+                             int                       width,
+                             int                       height,
+                             GError                  **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  CoglContext *cogl_context = get_cogl_context (src);
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+
+  if (priv->readback_texture &&
+      cogl_texture_get_width (priv->readback_texture) == width &&
+      cogl_texture_get_height (priv->readback_texture) == height)
+    return TRUE;
+
+  clear_readback_framebuffer (src);
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  if (!cogl_texture_allocate (texture, error))
+    return FALSE;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return FALSE;
+
+  priv->readback_texture = g_steal_pointer (&texture);
+  priv->readback_framebuffer = COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+
+  return TRUE;
+}
+
+static void
+on_buffer_read_back (GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  PendingReadback *readback = user_data;
+  MetaScreenCastStreamSrc *src = readback->src;
+  MetaScreenCastStreamSrcPrivate *priv;
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (source_object);
+  struct spa_buffer *spa_buffer;
+  struct spa_data *spa_data;
+  CoglPixelFormat cogl_format;
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  g_autoptr (GError) error = NULL;
+  int stride;
+  int bpp;
+
+  if (g_cancellable_is_cancelled (readback->cancellable))
+    {
+      pending_readback_free (readback);
+      return;
+    }
+
+  priv = meta_screen_cast_stream_src_get_instance_private (src);
+  priv->pending_readbacks = g_list_remove (priv->pending_readbacks, readback);
+
+  spa_buffer = readback->buffer->buffer;
+  spa_data = &spa_buffer->datas[0];
+
+  cogl_pixel_format_from_spa_video_format (priv->video_format.format,
+                                           &cogl_format);
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
+  stride = meta_screen_cast_stream_src_calculate_stride (src, spa_data);
+
+  bitmap = cogl_bitmap_new_for_data (get_cogl_context (src),
+                                     readback->area.width,
+                                     readback->area.height,
+                                     cogl_format,
+                                     stride,
+                                     ((uint8_t *) spa_data->data +
+                                      readback->area.y * stride +
+                                      readback->area.x * bpp));
+
+  if (!cogl_framebuffer_read_pixels_finish (framebuffer, result,
+                                            bitmap, &error))
+    {
+      g_warning ("Failed to read back screen cast frame: %s", error->message);
+      invalidate_buffer_damage (src, readback->buffer);
+      update_buffer_chunks (src, spa_buffer, FALSE);
+    }
+
+  queue_pw_buffer (src, readback->buffer);
+  pending_readback_free (readback);
+}
+
+static gboolean
+record_to_buffer_async (MetaScreenCastStreamSrc   *src,
+                        MetaScreenCastPaintPhase   paint_phase,
+                        struct pw_buffer          *buffer,
+                        const MtkRegion           *buffer_damage,
+                        GError                   **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int width = priv->video_format.size.width;
+  int height = priv->video_format.size.height;
+  CoglPixelFormat cogl_format;
+  PendingReadback *readback;
+  MtkRectangle area;
+
+  if (!cogl_pixel_format_from_spa_video_format (priv->video_format.format,
+                                                &cogl_format))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Unsupported stream format");
+      return FALSE;
+    }
+
+  if (!ensure_readback_framebuffer (src, width, height, error))
+    return FALSE;
+
+  if (!meta_screen_cast_stream_src_record_to_framebuffer (src,
+                                                          paint_phase,
+                                                          priv->readback_framebuffer,
+                                                          error))
+    return FALSE;
+
+  /* The whole frame is recorded on the GPU, but only the area that changed
+   * since the buffer was last written to needs to be read back */
+  if (buffer_damage)
+    area = mtk_region_get_extents (buffer_damage);
+  else
+    area = (MtkRectangle) { .width = width, .height = height };
+
+  readback = g_new0 (PendingReadback, 1);
+  readback->src = src;
+  readback->buffer = buffer;
+  readback->area = area;
+  readback->cancellable = g_cancellable_new ();
+  priv->pending_readbacks = g_list_append (priv->pending_readbacks, readback);
+
+  cogl_framebuffer_read_pixels_async (priv->readback_framebuffer,
+                                      area.x, area.y,
+                                      area.width, area.height,
+                                      COGL_READ_PIXELS_COLOR_BUFFER,
+                                      cogl_format,
+                                      readback->cancellable,
+                                      on_buffer_read_back,
+                                      readback);
+
+  return TRUE;
+}
+
 static gboolean
 do_record_frame (MetaScreenCastStreamSrc   *src,
                  MetaScreenCastRecordFlag   flags,
                  MetaScreenCastPaintPhase   paint_phase,
-                 struct spa_buffer         *spa_buffer,
+                 struct pw_buffer          *buffer,
+                 const MtkRegion           *buffer_damage,
                  GError                   **error)
 {
   MetaScreenCastStreamSrcPrivate *priv =
     meta_screen_cast_stream_src_get_instance_private (src);
+  struct spa_buffer *spa_buffer = buffer->buffer;
   struct spa_data *spa_data = &spa_buffer->datas[0];
+  MetaMultiTextureFormat multi_format;
 
   if (spa_data->data || spa_data->type == SPA_DATA_MemFd)
     {
@@ -775,6 +1356,27 @@ do_record_frame (MetaScreenCastStreamSrc   *src,
       COGL_TRACE_BEGIN_SCOPED (RecordToBuffer,
                                "Meta::ScreenCastStreamSrc::record_to_buffer()");
 
+      if (buffer_damage && mtk_region_is_empty (buffer_damage))
+        return TRUE;
+
+      if (can_record_to_buffer_async (src))
+        {
+          return record_to_buffer_async (src, paint_phase, buffer,
+                                         buffer_damage, error);
+        }
+
+      if (buffer_damage)
+        {
+          return meta_screen_cast_stream_src_record_to_buffer_region (src,
+                                                                      paint_phase,
+                                                                      buffer_damage,
+                                                                      width,
+                                                                      height,
+                                                                      stride,
+                                                                      spa_data->data,
+                                                                      error);
+        }
+
       return meta_screen_cast_stream_src_record_to_buffer (src,
                                                            paint_phase,
                                                            width,
@@ -783,6 +1385,23 @@ do_record_frame (MetaScreenCastStreamSrc   *src,
                                                            spa_data->data,
                                                            error);
     }
+  else if (spa_data->type == SPA_DATA_DmaBuf &&
+           multi_texture_format_from_spa_video_format (priv->video_format.format,
+                                                       &multi_format))
+    {
+      gboolean result;
+
+      COGL_TRACE_BEGIN_SCOPED (RecordToYuvPlanes,
+                               "Meta::ScreenCastStreamSrc::record_to_yuv_planes()");
+
+      result = record_to_yuv_planes (src, paint_phase, multi_format,
+                                     spa_buffer, error);
+
+      if (result)
+        maybe_set_sync_points (src, spa_buffer);
+
+      return result;
+    }
   else if (spa_data->type == SPA_DATA_DmaBuf)
     {
       CoglDmaBufHandle *dmabuf_handle =
@@ -795,10 +1414,19 @@ do_record_frame (MetaScreenCastStreamSrc   *src,
       COGL_TRACE_BEGIN_SCOPED (RecordToFramebuffer,
                                "Meta::ScreenCastStreamSrc::record_to_framebuffer()");
 
-      result = meta_screen_cast_stream_src_record_to_framebuffer (src,
-                                                                  paint_phase,
-                                                                  dmabuf_fbo,
-                                                                  error);
+      if (buffer_damage && mtk_region_is_empty (buffer_damage))
+        result = TRUE;
+      else if (buffer_damage)
+        result = meta_screen_cast_stream_src_record_to_framebuffer_region (src,
+                                                                           paint_phase,
+                                                                           buffer_damage,
+                                                                           dmabuf_fbo,
+                                                                           error);
+      else
+        result = meta_screen_cast_stream_src_record_to_framebuffer (src,
+                                                                    paint_phase,
+                                                                    dmabuf_fbo,
+                                                                    error);
 
       if (result)
         maybe_set_sync_points (src, spa_buffer);
@@ -846,6 +1474,65 @@ maybe_schedule_follow_up_frame (MetaScreenCastStreamSrc *src,
                                                         src);
 }
 
+static MtkRegion *
+create_stream_region (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MtkRectangle stream_rect = {
+    .width = priv->video_format.size.width,
+    .height = priv->video_format.size.height,
+  };
+
+  return mtk_region_create_rectangle (&stream_rect);
+}
+
+/* Adds the damage of the frame about to be recorded to every buffer whose
+ * content is tracked, and returns the area that must be written into @buffer to bring
+ * it up to date, or NULL if its content isn't tracked */
+static MtkRegion *
+take_buffer_damage (MetaScreenCastStreamSrc *src,
+                    struct pw_buffer        *buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  g_autoptr (MtkRegion) frame_damage = NULL;
+  MtkRegion *buffer_damage;
+  GHashTableIter iter;
+  gpointer value;
+
+  buffer_damage = g_hash_table_lookup (priv->buffer_damage, buffer);
+  if (!buffer_damage)
+    return NULL;
+
+  frame_damage = create_stream_region (src);
+  if (priv->redraw_clip)
+    mtk_region_intersect (frame_damage, priv->redraw_clip);
+
+  g_hash_table_iter_init (&iter, priv->buffer_damage);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    mtk_region_union (value, frame_damage);
+
+  buffer_damage = mtk_region_ref (buffer_damage);
+  g_hash_table_insert (priv->buffer_damage, buffer, mtk_region_create ());
+
+  return buffer_damage;
+}
+
+static void
+invalidate_buffer_damage (MetaScreenCastStreamSrc *src,
+                          struct pw_buffer        *buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (!g_hash_table_contains (priv->buffer_damage, buffer))
+    return;
+
+  g_hash_table_insert (priv->buffer_damage, buffer,
+                       create_stream_region (src));
+}
+
 static void
 maybe_add_damaged_regions_metadata (MetaScreenCastStreamSrc *src,
                                     struct spa_buffer       *spa_buffer)
@@ -1036,6 +1723,158 @@ dequeue_pw_buffer (MetaScreenCastStreamSrc  *src,
   return buffer;
 }
 
+static int64_t
+get_negotiated_frame_interval_us (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (priv->video_format.max_framerate.num <= 0)
+    return 0;
+
+  return ((G_USEC_PER_SEC * ((int64_t) priv->video_format.max_framerate.denom)) /
+          ((int64_t) priv->video_format.max_framerate.num));
+}
+
+static int64_t
+get_min_frame_interval_us (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  return MAX (get_negotiated_frame_interval_us (src),
+              priv->paced_frame_interval_us);
+}
+
+static void
+slow_down_pacing (MetaScreenCastStreamSrc *src,
+                  int64_t                  frame_interval_us,
+                  int64_t                  now_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t paced_frame_interval_us;
+
+  paced_frame_interval_us = MIN (frame_interval_us,
+                                 MAX_PACED_FRAME_INTERVAL_US);
+  if (paced_frame_interval_us <= priv->paced_frame_interval_us)
+    return;
+
+  priv->paced_frame_interval_us = paced_frame_interval_us;
+  priv->last_backpressure_us = now_us;
+
+  meta_topic (META_DEBUG_SCREEN_CAST,
+              "Consumer of stream %u falling behind, limiting to one frame "
+              "every %" G_GINT64_FORMAT " us",
+              priv->node_id, priv->paced_frame_interval_us);
+}
+
+/* Called when no buffer could be dequeued, i.e. all of them are still held
+ * by the consumer */
+static void
+handle_backpressure (MetaScreenCastStreamSrc *src,
+                     int64_t                  now_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t frame_interval_us;
+
+  frame_interval_us = get_min_frame_interval_us (src);
+  if (frame_interval_us == 0)
+    frame_interval_us = NOMINAL_FRAME_INTERVAL_US;
+
+  priv->n_frames_dropped++;
+  slow_down_pacing (src, frame_interval_us * 3 / 2, now_us);
+}
+
+/* Buffers are dequeued in the order they were returned, so when recording
+ * continuously, each of them takes about as many frame intervals to come
+ * back as there are buffers, unless the consumer holds on to them for
+ * longer than that */
+static void
+update_pacing (MetaScreenCastStreamSrc *src,
+               struct pw_buffer        *buffer,
+               int64_t                  now_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t *queued_us = buffer->user_data;
+  int64_t min_frame_interval_us;
+  int64_t negotiated_frame_interval_us;
+
+  min_frame_interval_us = get_min_frame_interval_us (src);
+
+  if (*queued_us != 0 &&
+      min_frame_interval_us != 0 &&
+      now_us - priv->last_frame_timestamp_us < 2 * min_frame_interval_us)
+    {
+      int64_t consumer_frame_interval_us;
+
+      consumer_frame_interval_us =
+        (now_us - *queued_us) / MAX (priv->buffer_count, 1);
+      if (consumer_frame_interval_us > 2 * min_frame_interval_us)
+        slow_down_pacing (src, consumer_frame_interval_us, now_us);
+    }
+
+  if (priv->paced_frame_interval_us == 0 ||
+      now_us - priv->last_backpressure_us < PACING_RECOVERY_DELAY_US)
+    return;
+
+  negotiated_frame_interval_us = get_negotiated_frame_interval_us (src);
+  priv->paced_frame_interval_us = priv->paced_frame_interval_us * 7 / 8;
+
+  if (priv->paced_frame_interval_us <= negotiated_frame_interval_us ||
+      priv->paced_frame_interval_us < NOMINAL_FRAME_INTERVAL_US)
+    {
+      priv->paced_frame_interval_us = 0;
+      meta_topic (META_DEBUG_SCREEN_CAST,
+                  "Consumer of stream %u caught up, no longer limiting the "
+                  "framerate", priv->node_id);
+    }
+}
+
+static void
+queue_pw_buffer (MetaScreenCastStreamSrc *src,
+                 struct pw_buffer        *buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t *queued_us = buffer->user_data;
+
+  *queued_us = g_get_monotonic_time ();
+  pw_stream_queue_buffer (priv->pipewire_stream, buffer);
+}
+
+void
+meta_screen_cast_stream_src_append_statistics (MetaScreenCastStreamSrc *src,
+                                               GVariantBuilder         *builder)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  uint64_t average_record_time_us = 0;
+  int64_t min_frame_interval_us;
+  double framerate = 0.0;
+
+  if (priv->n_frames_recorded > 0)
+    {
+      average_record_time_us =
+        priv->total_record_time_us / priv->n_frames_recorded;
+    }
+
+  min_frame_interval_us = get_min_frame_interval_us (src);
+  if (min_frame_interval_us > 0)
+    framerate = (double) G_USEC_PER_SEC / min_frame_interval_us;
+
+  g_variant_builder_add (builder, "{sv}", "frames-recorded",
+                         g_variant_new_uint64 (priv->n_frames_recorded));
+  g_variant_builder_add (builder, "{sv}", "frames-dropped",
+                         g_variant_new_uint64 (priv->n_frames_dropped));
+  g_variant_builder_add (builder, "{sv}", "average-record-time",
+                         g_variant_new_uint64 (average_record_time_us));
+  g_variant_builder_add (builder, "{sv}", "framerate",
+                         g_variant_new_double (framerate));
+}
+
 MetaScreenCastRecordResult
 meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStreamSrc  *src,
                                                                MetaScreenCastRecordFlag  flags,
@@ -1054,7 +1893,10 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
   struct spa_buffer *spa_buffer;
   struct spa_meta_header *header;
   struct spa_data *spa_data;
+  g_autoptr (MtkRegion) buffer_damage = NULL;
   g_autoptr (GError) error = NULL;
+  int64_t min_interval_us;
+  int64_t record_start_us;
 
   COGL_TRACE_BEGIN_SCOPED (MaybeRecordFrame,
                            "Meta::ScreenCastStreamSrc::maybe_record_frame_with_timestamp()");
@@ -1090,16 +1932,12 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
       return record_result;
     }
 
-  if (priv->video_format.max_framerate.num > 0 &&
+  min_interval_us = get_min_frame_interval_us (src);
+  if (min_interval_us > 0 &&
       priv->last_frame_timestamp_us != 0)
     {
-      int64_t min_interval_us;
       int64_t time_since_last_frame_us;
 
-      min_interval_us =
-        ((G_USEC_PER_SEC * ((int64_t) priv->video_format.max_framerate.denom)) /
-         ((int64_t) priv->video_format.max_framerate.num));
-
       time_since_last_frame_us = frame_timestamp_us - priv->last_frame_timestamp_us;
       if (time_since_last_frame_us < min_interval_us)
         {
@@ -1128,9 +1966,12 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
       meta_topic (META_DEBUG_SCREEN_CAST,
                   "Couldn't dequeue a buffer from pipewire stream: %s",
                   error->message);
+      handle_backpressure (src, g_get_monotonic_time ());
       return record_result;
     }
 
+  update_pacing (src, buffer, g_get_monotonic_time ());
+
   spa_buffer = buffer->buffer;
   spa_data = &spa_buffer->datas[0];
 
@@ -1144,20 +1985,26 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
       if (header)
         header->flags = SPA_META_HEADER_FLAG_CORRUPTED;
 
-      pw_stream_queue_buffer (priv->pipewire_stream, buffer);
+      queue_pw_buffer (src, buffer);
       return record_result;
     }
 
   if (!(flags & META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY))
     {
       g_clear_handle_id (&priv->follow_up_frame_source_id, g_source_remove);
-      if (do_record_frame (src, flags, paint_phase, spa_buffer, &error))
+      buffer_damage = take_buffer_damage (src, buffer);
+      record_start_us = g_get_monotonic_time ();
+      if (do_record_frame (src, flags, paint_phase, buffer,
+                           buffer_damage, &error))
         {
+          priv->n_frames_recorded++;
+          priv->total_record_time_us +=
+            g_get_monotonic_time () - record_start_us;
+
           maybe_add_damaged_regions_metadata (src, spa_buffer);
           struct spa_meta_region *spa_meta_video_crop;
 
-          spa_data->chunk->size = spa_data->maxsize;
-          spa_data->chunk->flags = SPA_CHUNK_FLAG_NONE;
+          update_buffer_chunks (src, spa_buffer, TRUE);
 
           /* Update VideoCrop if needed */
           spa_meta_video_crop =
@@ -1189,14 +2036,14 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
         {
           if (error)
             g_warning ("Failed to record screen cast frame: %s", error->message);
-          spa_data->chunk->size = 0;
-          spa_data->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
+          priv->n_frames_dropped++;
+          invalidate_buffer_damage (src, buffer);
+          update_buffer_chunks (src, spa_buffer, FALSE);
         }
     }
   else
     {
-      spa_data->chunk->size = 0;
-      spa_data->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
+      update_buffer_chunks (src, spa_buffer, FALSE);
     }
 
   record_result |= maybe_record_cursor (src, spa_buffer);
@@ -1218,7 +2065,9 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
       meta_topic (META_DEBUG_SCREEN_CAST, "Queuing unsequenced PipeWire buffer");
     }
 
-  pw_stream_queue_buffer (priv->pipewire_stream, buffer);
+  /* Buffers being read back are queued once the pixels arrived */
+  if (!find_pending_readback (src, buffer))
+    queue_pw_buffer (src, buffer);
 
   return record_result;
 }
@@ -1267,6 +2116,68 @@ meta_screen_cast_stream_src_close (MetaScreenCastStreamSrc *src)
   priv->emit_closed_after_dispatch = TRUE;
 }
 
+#ifdef HAVE_NATIVE_BACKEND
+static GArray *
+ensure_modifiers (MetaScreenCastStreamSrc *src,
+                  CoglPixelFormat          cogl_format)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
+  GArray *modifiers;
+
+  modifiers = g_hash_table_lookup (priv->modifiers,
+                                   GINT_TO_POINTER (cogl_format));
+  if (!modifiers)
+    {
+      modifiers = meta_screen_cast_query_modifiers (screen_cast, cogl_format);
+      g_hash_table_insert (priv->modifiers,
+                           GINT_TO_POINTER (cogl_format),
+                           modifiers);
+    }
+
+  return modifiers;
+}
+
+static gboolean
+is_yuv_format_supported (MetaScreenCastStreamSrc *src,
+                         MetaMultiTextureFormat   multi_format)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  const MetaMultiTextureFormatInfo *info =
+    meta_multi_texture_format_get_info (multi_format);
+  int i;
+
+  if (priv->yuv_formats_disabled)
+    return FALSE;
+
+  for (i = 0; i < info->n_planes; i++)
+    {
+      GArray *modifiers = ensure_modifiers (src, info->subformats[i]);
+      gboolean found = FALSE;
+      int j;
+
+      for (j = 0; j < modifiers->len; j++)
+        {
+          if (g_array_index (modifiers, uint64_t, j) == DRM_FORMAT_MOD_LINEAR)
+            {
+              found = TRUE;
+              break;
+            }
+        }
+
+      if (!found)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+#endif /* HAVE_NATIVE_BACKEND */
+
 static void
 build_format_params (MetaScreenCastStreamSrc *src,
                      GPtrArray               *params)
@@ -1277,6 +2188,8 @@ build_format_params (MetaScreenCastStreamSrc *src,
     meta_screen_cast_stream_get_session (stream);
   MetaScreenCastStreamSrcPrivate *priv =
     meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
   MetaScreenCast *screen_cast =
     meta_screen_cast_session_get_screen_cast (session);
   GArray *modifiers;
@@ -1306,7 +2219,12 @@ build_format_params (MetaScreenCastStreamSrc *src,
       max_framerate = SPA_FRACTION (frame_rate_fraction.num,
                                     frame_rate_fraction.denom);
       default_framerate = max_framerate;
-      min_size = max_size = default_size = SPA_RECTANGLE (width, height);
+      max_size = default_size = SPA_RECTANGLE (width, height);
+
+      /* Sources that can render at a lower resolution let the consumer
+       * pick any size up to the one of the source */
+      if (!klass->supports_scaling || !klass->supports_scaling (src))
+        min_size = max_size;
     }
 
   preferred_cogl_format = meta_screen_cast_stream_src_get_preferred_format (src);
@@ -1354,6 +2272,28 @@ build_format_params (MetaScreenCastStreamSrc *src,
         0);
       g_ptr_array_add (params, g_steal_pointer (&pod));
     }
+#ifdef HAVE_NATIVE_BACKEND
+  for (i = 0; i < G_N_ELEMENTS (supported_yuv_formats); i++)
+    {
+      uint64_t linear_modifier = DRM_FORMAT_MOD_LINEAR;
+
+      if (!is_yuv_format_supported (src, supported_yuv_formats[i].multi_format))
+        continue;
+
+      pod = push_format_object (
+        supported_yuv_formats[i].spa_video_format, &linear_modifier, 1, TRUE,
+        SPA_FORMAT_VIDEO_size, SPA_POD_CHOICE_RANGE_Rectangle (&default_size,
+                                                               &min_size,
+                                                               &max_size),
+        SPA_FORMAT_VIDEO_framerate, SPA_POD_Fraction (&SPA_FRACTION (0, 1)),
+        SPA_FORMAT_VIDEO_maxFramerate,
+        SPA_POD_CHOICE_RANGE_Fraction (&default_framerate,
+                                       &min_framerate,
+                                       &max_framerate),
+        0);
+      g_ptr_array_add (params, g_steal_pointer (&pod));
+    }
+#endif /* HAVE_NATIVE_BACKEND */
   for (i = 0; i < n_spa_video_formats; i++)
     {
       pod = push_format_object (
@@ -1462,6 +2402,7 @@ on_stream_param_changed (void                 *data,
   struct spa_pod_frame pod_frame;
   g_autoptr (GPtrArray) params = NULL;
   int buffer_types;
+  int n_planes;
   const struct spa_pod_prop *prop_modifier;
 
   if (!format || id != SPA_PARAM_Format)
@@ -1473,6 +2414,7 @@ on_stream_param_changed (void                 *data,
                               &priv->video_format);
 
   prop_modifier = spa_pod_find_prop (format, NULL, SPA_FORMAT_VIDEO_modifier);
+  n_planes = get_n_video_planes (src);
 
   if (prop_modifier)
     buffer_types = 1 << SPA_DATA_DmaBuf;
@@ -1558,7 +2500,7 @@ on_stream_param_changed (void                 *data,
   spa_pod_builder_add (
     &pod_builder.b,
     SPA_PARAM_BUFFERS_buffers, SPA_POD_CHOICE_RANGE_Int (16, 2, 16),
-    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (3),
+    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (n_planes + 2),
     SPA_PARAM_BUFFERS_align, SPA_POD_Int (16),
     SPA_PARAM_BUFFERS_dataType, SPA_POD_CHOICE_FLAGS_Int (buffer_types),
     0);
@@ -1573,7 +2515,7 @@ on_stream_param_changed (void                 *data,
     &pod_builder.b,
     SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers,
     SPA_PARAM_BUFFERS_buffers, SPA_POD_CHOICE_RANGE_Int (16, 2, 16),
-    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (1),
+    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (n_planes),
     SPA_PARAM_BUFFERS_align, SPA_POD_Int (16),
     SPA_PARAM_BUFFERS_dataType, SPA_POD_CHOICE_FLAGS_Int (buffer_types));
   g_ptr_array_add (params, g_steal_pointer (&pod));
@@ -1691,6 +2633,89 @@ maybe_create_syncobj (MetaScreenCastStreamSrc *src,
 #endif /* HAVE_NATIVE_BACKEND */
 }
 
+static void
+free_yuv_planes (MetaScreenCastStreamSrc *src,
+                 struct spa_buffer       *spa_buffer,
+                 int                      n_planes)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int i;
+
+  for (i = 0; i < n_planes; i++)
+    {
+      struct spa_data *spa_data = &spa_buffer->datas[i];
+
+      g_hash_table_remove (priv->dmabuf_handles,
+                           GINT_TO_POINTER (spa_data->fd));
+      spa_data->type = SPA_DATA_Invalid;
+      spa_data->fd = -1;
+    }
+}
+
+static gboolean
+allocate_yuv_planes (MetaScreenCastStreamSrc *src,
+                     struct spa_buffer       *spa_buffer,
+                     MetaMultiTextureFormat   multi_format)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
+  const MetaMultiTextureFormatInfo *info =
+    meta_multi_texture_format_get_info (multi_format);
+  int width = priv->video_format.size.width;
+  int height = priv->video_format.size.height;
+  int i;
+
+  if (spa_buffer->n_datas < info->n_planes)
+    {
+      g_critical ("Not enough data blocks for a %s buffer",
+                  meta_multi_texture_format_to_string (multi_format));
+      return FALSE;
+    }
+
+  for (i = 0; i < info->n_planes; i++)
+    {
+      struct spa_data *spa_data = &spa_buffer->datas[i];
+      int plane_width = (width + info->hsub[i] - 1) / info->hsub[i];
+      int plane_height = (height + info->vsub[i] - 1) / info->vsub[i];
+      CoglDmaBufHandle *dmabuf_handle;
+      int stride;
+
+      dmabuf_handle =
+        meta_screen_cast_create_dma_buf_handle (screen_cast,
+                                                info->subformats[i],
+                                                priv->video_format.modifier,
+                                                plane_width,
+                                                plane_height);
+      if (!dmabuf_handle)
+        {
+          free_yuv_planes (src, spa_buffer, i);
+          return FALSE;
+        }
+
+      spa_data->type = SPA_DATA_DmaBuf;
+      spa_data->flags = SPA_DATA_FLAG_READWRITE;
+      spa_data->fd = cogl_dma_buf_handle_get_fd (dmabuf_handle, 0);
+      spa_data->mapoffset = 0;
+      spa_data->data = NULL;
+
+      stride = cogl_dma_buf_handle_get_stride (dmabuf_handle, 0);
+      spa_data->maxsize = stride * plane_height;
+      spa_data->chunk->offset = 0;
+      spa_data->chunk->stride = stride;
+
+      g_hash_table_insert (priv->dmabuf_handles,
+                           GINT_TO_POINTER (spa_data->fd),
+                           dmabuf_handle);
+    }
+
+  return TRUE;
+}
+
 static void
 on_stream_add_buffer (void             *data,
                       struct pw_buffer *buffer)
@@ -1701,14 +2726,46 @@ on_stream_add_buffer (void             *data,
   CoglDmaBufHandle *dmabuf_handle;
   struct spa_buffer *spa_buffer = buffer->buffer;
   struct spa_data *spa_data = &spa_buffer->datas[0];
+  MetaMultiTextureFormat multi_format;
   int stride;
 
   priv->buffer_count++;
 
+  /* When the buffer was last queued */
+  buffer->user_data = g_new0 (int64_t, 1);
+
   spa_data->mapoffset = 0;
   spa_data->data = NULL;
 
-  if (spa_data->type & (1 << SPA_DATA_DmaBuf))
+  if (spa_data->type & (1 << SPA_DATA_DmaBuf) &&
+      multi_texture_format_from_spa_video_format (priv->video_format.format,
+                                                  &multi_format))
+    {
+      if (!allocate_yuv_planes (src, spa_buffer, multi_format))
+        {
+          meta_topic (META_DEBUG_SCREEN_CAST,
+                      "Failed to allocate %s DMA buffers for pw_stream %u, "
+                      "falling back to RGB formats",
+                      meta_multi_texture_format_to_string (multi_format),
+                      pw_stream_get_node_id (priv->pipewire_stream));
+
+          priv->yuv_formats_disabled = TRUE;
+          renegotiate_pipewire_stream (src);
+          return;
+        }
+
+      priv->uses_dma_bufs = TRUE;
+
+      meta_topic (META_DEBUG_SCREEN_CAST,
+                  "Allocating %s DMA buffers for pw_stream %u",
+                  meta_multi_texture_format_to_string (multi_format),
+                  pw_stream_get_node_id (priv->pipewire_stream));
+
+      stride = spa_data->chunk->stride;
+
+      maybe_create_syncobj (src, spa_buffer);
+    }
+  else if (spa_data->type & (1 << SPA_DATA_DmaBuf))
     {
       MetaScreenCastStream *stream =
         meta_screen_cast_stream_src_get_stream (src);
@@ -1762,6 +2819,14 @@ on_stream_add_buffer (void             *data,
                            GINT_TO_POINTER (spa_data->fd),
                            dmabuf_handle);
 
+      /* Sources that can record parts of a frame only need to update what
+       * changed since the buffer was last handed out */
+      if (META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src)->record_to_framebuffer_area)
+        {
+          g_hash_table_insert (priv->buffer_damage, buffer,
+                               create_stream_region (src));
+        }
+
       stride = meta_screen_cast_stream_src_calculate_stride (src, spa_data);
       spa_data->maxsize = stride * priv->video_format.size.height;
 
@@ -1806,6 +2871,9 @@ on_stream_add_buffer (void             *data,
           return;
         }
 
+      g_hash_table_insert (priv->buffer_damage, buffer,
+                           create_stream_region (src));
+
       seals = F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_SEAL;
       if (fcntl (spa_data->fd, F_ADD_SEALS, seals) == -1)
         g_warning ("Failed to add seals: %m");
@@ -1873,15 +2941,38 @@ on_stream_remove_buffer (void             *data,
 
   priv->buffer_count--;
 
+  g_clear_pointer (&buffer->user_data, g_free);
+
   if (spa_data->type == SPA_DATA_DmaBuf)
     {
+      int i;
+
       maybe_remove_syncobj (src, buffer);
+      g_hash_table_remove (priv->buffer_damage, buffer);
+
+      /* YUV buffers have one DMA buffer per plane */
+      for (i = 0; i < spa_buffer->n_datas; i++)
+        {
+          struct spa_data *plane_data = &spa_buffer->datas[i];
 
-      if (!g_hash_table_remove (priv->dmabuf_handles, GINT_TO_POINTER (spa_data->fd)))
-        g_critical ("Failed to remove non-exported DMA buffer");
+          if (plane_data->type != SPA_DATA_DmaBuf)
+            continue;
+
+          if (!g_hash_table_remove (priv->dmabuf_handles,
+                                    GINT_TO_POINTER (plane_data->fd)))
+            g_critical ("Failed to remove non-exported DMA buffer");
+        }
     }
   else if (spa_data->type == SPA_DATA_MemFd)
     {
+      PendingReadback *readback;
+
+      readback = find_pending_readback (src, buffer);
+      if (readback)
+        cancel_pending_readback (src, readback);
+
+      g_hash_table_remove (priv->buffer_damage, buffer);
+
       g_warn_if_fail (spa_data->fd > 0 || !spa_data->data);
 
       if (spa_data->fd > 0)
@@ -2134,13 +3225,17 @@ meta_screen_cast_stream_src_dispose (GObject *object)
     g_array_free (value, TRUE);
 
   g_clear_pointer (&priv->modifiers, g_hash_table_destroy);
+  cancel_pending_readbacks (src);
   g_clear_pointer (&priv->pipewire_stream, pw_stream_destroy);
   g_clear_pointer (&priv->timelines, g_hash_table_destroy);
   g_clear_pointer (&priv->dmabuf_handles, g_hash_table_destroy);
+  clear_yuv_conversion (src);
+  clear_readback_framebuffer (src);
   g_clear_pointer (&priv->pipewire_core, pw_core_disconnect);
   g_clear_pointer (&priv->pipewire_context, pw_context_destroy);
   g_clear_pointer (&priv->pipewire_source, g_source_destroy);
   g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+  g_clear_pointer (&priv->buffer_damage, g_hash_table_destroy);
 
   g_warn_if_fail (!priv->dequeued_buffers);
 
@@ -2209,6 +3304,10 @@ meta_screen_cast_stream_src_init (MetaScreenCastStreamSrc *src)
     g_hash_table_new_full (NULL, NULL, close_fd, g_object_unref);
 
   priv->modifiers = g_hash_table_new (NULL, NULL);
+
+  priv->buffer_damage =
+    g_hash_table_new_full (NULL, NULL, NULL,
+                           (GDestroyNotify) mtk_region_unref);
 }
 
 static void
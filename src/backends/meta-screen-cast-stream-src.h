@@ -70,6 +70,9 @@ struct _MetaScreenCastStreamSrcClass
                           int                     *width,
                           int                     *height,
                           float                   *frame_rate);
+  /* Optional; whether frames can be recorded at any size up to the one
+   * returned by get_specs() */
+  gboolean (* supports_scaling) (MetaScreenCastStreamSrc *src);
   void (* enable) (MetaScreenCastStreamSrc *src);
   void (* disable) (MetaScreenCastStreamSrc *src);
   gboolean (* record_to_buffer) (MetaScreenCastStreamSrc  *src,
@@ -79,10 +82,25 @@ struct _MetaScreenCastStreamSrcClass
                                  int                       stride,
                                  uint8_t                  *data,
                                  GError                  **error);
+  /* Optional; paints only @area, in stream coordinates, of the buffer
+   * starting at @data, leaving the rest of it untouched */
+  gboolean (* record_to_buffer_area) (MetaScreenCastStreamSrc  *src,
+                                      MetaScreenCastPaintPhase  paint_phase,
+                                      const MtkRectangle       *area,
+                                      int                       stride,
+                                      uint8_t                  *data,
+                                      GError                  **error);
   gboolean (* record_to_framebuffer) (MetaScreenCastStreamSrc   *src,
                                       MetaScreenCastPaintPhase   paint_phase,
                                       CoglFramebuffer           *framebuffer,
                                       GError                   **error);
+  /* Optional; records only @area, in stream coordinates, into
+   * @framebuffer, leaving the rest of it untouched */
+  gboolean (* record_to_framebuffer_area) (MetaScreenCastStreamSrc   *src,
+                                           MetaScreenCastPaintPhase   paint_phase,
+                                           const MtkRectangle        *area,
+                                           CoglFramebuffer           *framebuffer,
+                                           GError                   **error);
   void (* record_follow_up) (MetaScreenCastStreamSrc *src);
 
   gboolean (* get_videocrop) (MetaScreenCastStreamSrc *src,
@@ -148,3 +166,6 @@ gboolean meta_screen_cast_stream_src_uses_dma_bufs (MetaScreenCastStreamSrc *src
 
 CoglPixelFormat
 meta_screen_cast_stream_src_get_preferred_format (MetaScreenCastStreamSrc *src);
+
+void meta_screen_cast_stream_src_append_statistics (MetaScreenCastStreamSrc *src,
+                                                    GVariantBuilder         *builder);
@@ -420,11 +420,47 @@ handle_stop (MetaDBusScreenCastStream *skeleton,
   return G_DBUS_METHOD_INVOCATION_HANDLED;
 }
 
+static gboolean
+handle_get_statistics (MetaDBusScreenCastStream *skeleton,
+                       GDBusMethodInvocation    *invocation)
+{
+  MetaScreenCastStream *stream = META_SCREEN_CAST_STREAM (skeleton);
+  MetaScreenCastStreamPrivate *priv =
+    meta_screen_cast_stream_get_instance_private (stream);
+  GVariantBuilder statistics_builder;
+
+  if (!check_permission (stream, invocation))
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_ACCESS_DENIED,
+                                             "Permission denied");
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  if (!priv->src)
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Stream not started");
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  g_variant_builder_init (&statistics_builder, G_VARIANT_TYPE_VARDICT);
+  meta_screen_cast_stream_src_append_statistics (priv->src,
+                                                 &statistics_builder);
+
+  meta_dbus_screen_cast_stream_complete_get_statistics (
+    skeleton, invocation, g_variant_builder_end (&statistics_builder));
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
 static void
 meta_screen_cast_stream_init_iface (MetaDBusScreenCastStreamIface *iface)
 {
   iface->handle_start = handle_start;
   iface->handle_stop = handle_stop;
+  iface->handle_get_statistics = handle_get_statistics;
 }
 
 static gboolean
@@ -184,12 +184,36 @@ on_after_paint (MetaStage        *stage,
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (user_data);
   MetaScreenCastPaintPhase paint_phase;
   MetaScreenCastRecordFlag flags;
+  g_autoptr (MtkRegion) stream_damage = NULL;
+
+  /* The redraw clip is in stage coordinates, while the damage of the stream
+   * is in the coordinates of its buffers */
+  if (redraw_clip)
+    {
+      MtkRectangle view_rect;
+      float scale;
+      int int_scale;
+
+      clutter_stage_view_get_layout (view, &view_rect);
+      scale = clutter_stage_view_get_scale (view);
+      int_scale = (int) scale;
+
+      if ((float) int_scale == scale)
+        {
+          g_autoptr (MtkRegion) view_damage = NULL;
+
+          view_damage = mtk_region_copy (redraw_clip);
+          mtk_region_intersect_rectangle (view_damage, &view_rect);
+          mtk_region_translate (view_damage, -view_rect.x, -view_rect.y);
+          stream_damage = mtk_region_scale (view_damage, int_scale);
+        }
+    }
 
   flags = META_SCREEN_CAST_RECORD_FLAG_NONE;
   paint_phase = META_SCREEN_CAST_PAINT_PHASE_PRE_SWAP_BUFFER;
   meta_screen_cast_stream_src_maybe_record_frame (src, flags,
                                                   paint_phase,
-                                                  redraw_clip);
+                                                  stream_damage);
 }
 
 static void
@@ -342,24 +366,17 @@ meta_screen_cast_virtual_stream_src_disable (MetaScreenCastStreamSrc *src)
 }
 
 static gboolean
-meta_screen_cast_virtual_stream_src_record_to_buffer (MetaScreenCastStreamSrc   *src,
-                                                      MetaScreenCastPaintPhase   paint_phase,
-                                                      int                        width,
-                                                      int                        height,
-                                                      int                        stride,
-                                                      uint8_t                   *data,
-                                                      GError                   **error)
+paint_stage_to_buffer (MetaScreenCastStreamSrc  *src,
+                       const MtkRectangle       *rect,
+                       float                     scale,
+                       int                       stride,
+                       uint8_t                  *data,
+                       GError                  **error)
 {
   MetaScreenCastStream *stream;
   ClutterPaintFlag paint_flags;
-  ClutterStageView *view;
-  MtkRectangle view_rect;
-  float scale;
 
   stream = meta_screen_cast_stream_src_get_stream (src);
-  view = view_from_src (src);
-  scale = clutter_stage_view_get_scale (view);
-  clutter_stage_view_get_layout (view, &view_rect);
 
   paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
@@ -373,17 +390,76 @@ meta_screen_cast_virtual_stream_src_record_to_buffer (MetaScreenCastStreamSrc
       break;
     }
 
-  if (!clutter_stage_paint_to_buffer (stage_from_src (src),
-                                      &view_rect,
-                                      scale,
-                                      data,
-                                      stride,
-                                      COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
-                                      paint_flags,
-                                      error))
-    return FALSE;
+  return clutter_stage_paint_to_buffer (stage_from_src (src),
+                                        rect,
+                                        scale,
+                                        data,
+                                        stride,
+                                        COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                        paint_flags,
+                                        error);
+}
 
-  return TRUE;
+static gboolean
+meta_screen_cast_virtual_stream_src_record_to_buffer (MetaScreenCastStreamSrc   *src,
+                                                      MetaScreenCastPaintPhase   paint_phase,
+                                                      int                        width,
+                                                      int                        height,
+                                                      int                        stride,
+                                                      uint8_t                   *data,
+                                                      GError                   **error)
+{
+  ClutterStageView *view;
+  MtkRectangle view_rect;
+  float scale;
+
+  view = view_from_src (src);
+  scale = clutter_stage_view_get_scale (view);
+  clutter_stage_view_get_layout (view, &view_rect);
+
+  return paint_stage_to_buffer (src, &view_rect, scale, stride, data, error);
+}
+
+static gboolean
+meta_screen_cast_virtual_stream_src_record_to_buffer_area (MetaScreenCastStreamSrc   *src,
+                                                           MetaScreenCastPaintPhase   paint_phase,
+                                                           const MtkRectangle        *area,
+                                                           int                        stride,
+                                                           uint8_t                   *data,
+                                                           GError                   **error)
+{
+  ClutterStageView *view;
+  MtkRectangle view_rect;
+  MtkRectangle stage_rect;
+  float scale;
+  int int_scale;
+  int x1, y1, x2, y2;
+  size_t offset;
+
+  view = view_from_src (src);
+  scale = clutter_stage_view_get_scale (view);
+  clutter_stage_view_get_layout (view, &view_rect);
+
+  /* Only whole stage pixels can be painted */
+  int_scale = (int) scale;
+  if ((float) int_scale != scale)
+    return paint_stage_to_buffer (src, &view_rect, scale, stride, data, error);
+
+  x1 = area->x / int_scale;
+  y1 = area->y / int_scale;
+  x2 = (area->x + area->width + int_scale - 1) / int_scale;
+  y2 = (area->y + area->height + int_scale - 1) / int_scale;
+
+  stage_rect = (MtkRectangle) {
+    .x = view_rect.x + x1,
+    .y = view_rect.y + y1,
+    .width = x2 - x1,
+    .height = y2 - y1,
+  };
+  offset = (size_t) (y1 * int_scale) * stride + (size_t) (x1 * int_scale) * 4;
+
+  return paint_stage_to_buffer (src, &stage_rect, scale,
+                                stride, data + offset, error);
 }
 
 static gboolean
@@ -410,6 +486,27 @@ meta_screen_cast_virtual_stream_src_record_to_framebuffer (MetaScreenCastStreamS
   return TRUE;
 }
 
+static gboolean
+meta_screen_cast_virtual_stream_src_record_to_framebuffer_area (MetaScreenCastStreamSrc   *src,
+                                                                MetaScreenCastPaintPhase   paint_phase,
+                                                                const MtkRectangle        *area,
+                                                                CoglFramebuffer           *framebuffer,
+                                                                GError                   **error)
+{
+  ClutterStageView *view;
+  CoglFramebuffer *view_framebuffer;
+
+  view = view_from_src (src);
+  view_framebuffer = clutter_stage_view_get_framebuffer (view);
+
+  return cogl_framebuffer_blit (view_framebuffer,
+                                framebuffer,
+                                area->x, area->y,
+                                area->x, area->y,
+                                area->width, area->height,
+                                error);
+}
+
 static void
 meta_screen_cast_virtual_stream_record_follow_up (MetaScreenCastStreamSrc *src)
 {
@@ -717,8 +814,12 @@ meta_screen_cast_virtual_stream_src_class_init (MetaScreenCastVirtualStreamSrcCl
   src_class->disable = meta_screen_cast_virtual_stream_src_disable;
   src_class->record_to_buffer =
     meta_screen_cast_virtual_stream_src_record_to_buffer;
+  src_class->record_to_buffer_area =
+    meta_screen_cast_virtual_stream_src_record_to_buffer_area;
   src_class->record_to_framebuffer =
     meta_screen_cast_virtual_stream_src_record_to_framebuffer;
+  src_class->record_to_framebuffer_area =
+    meta_screen_cast_virtual_stream_src_record_to_framebuffer_area;
   src_class->record_follow_up =
     meta_screen_cast_virtual_stream_record_follow_up;
   src_class->is_cursor_metadata_valid =
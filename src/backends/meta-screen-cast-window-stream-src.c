@@ -20,6 +20,8 @@
 
 #include "backends/meta-screen-cast-window-stream-src.h"
 
+#include <string.h>
+
 #include "backends/meta-backend-private.h"
 #include "backends/meta-cursor-tracker-private.h"
 #include "backends/meta-screen-cast-session.h"
@@ -46,6 +48,17 @@ struct _MetaScreenCastWindowStreamSrc
     int x;
     int y;
   } last_cursor_matadata;
+
+  struct {
+    gboolean set;
+    MtkRectangle rect;
+  } embedded_cursor;
+
+  struct {
+    uint8_t *data;
+    int width;
+    int height;
+  } clean_frame;
 };
 
 G_DEFINE_TYPE (MetaScreenCastWindowStreamSrc,
@@ -112,12 +125,10 @@ get_stream_height (MetaScreenCastWindowStreamSrc *window_src)
   return meta_screen_cast_window_stream_get_height (window_stream);
 }
 
-static void
-maybe_draw_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
-                          uint8_t                       *data,
-                          MtkRectangle                  *stream_rect)
+static MetaCursorSprite *
+calculate_cursor_sprite_rect (MetaScreenCastWindowStreamSrc *window_src,
+                              graphene_rect_t               *out_rect)
 {
-  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
   MetaBackend *backend = get_backend (window_src);
   MetaCursorRenderer *cursor_renderer =
     meta_backend_get_cursor_renderer (backend);
@@ -125,38 +136,30 @@ maybe_draw_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
     meta_backend_get_cursor_tracker (backend);
   MetaCursorSprite *cursor_sprite;
   CoglTexture *cursor_texture;
-  MetaScreenCastWindow *screen_cast_window;
   graphene_point_t cursor_position;
   graphene_point_t relative_cursor_position;
-  cairo_surface_t *cursor_surface;
-  uint8_t *cursor_surface_data;
-  GError *error = NULL;
-  cairo_surface_t *stream_surface;
   int width, height;
   int texture_width, texture_height;
   float scale, view_scale, cursor_scale;
   MtkMonitorTransform cursor_transform;
   const graphene_rect_t *src_rect;
-  graphene_matrix_t matrix;
   int hotspot_x, hotspot_y;
-  cairo_t *cr;
 
   cursor_sprite = meta_cursor_renderer_get_cursor (cursor_renderer);
   if (!cursor_sprite)
-    return;
+    return NULL;
 
   cursor_texture = meta_cursor_sprite_get_cogl_texture (cursor_sprite);
   if (!cursor_texture)
-    return;
+    return NULL;
 
-  screen_cast_window = window_src->screen_cast_window;
   meta_cursor_tracker_get_pointer (cursor_tracker, &cursor_position, NULL);
-  if (!meta_screen_cast_window_transform_cursor_position (screen_cast_window,
+  if (!meta_screen_cast_window_transform_cursor_position (window_src->screen_cast_window,
                                                           cursor_sprite,
                                                           &cursor_position,
                                                           &relative_cursor_position,
                                                           &view_scale))
-    return;
+    return NULL;
 
   meta_cursor_sprite_get_hotspot (cursor_sprite, &hotspot_x, &hotspot_y);
   cursor_scale = meta_cursor_sprite_get_texture_scale (cursor_sprite);
@@ -193,21 +196,72 @@ maybe_draw_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
         }
     }
 
-  graphene_matrix_init_identity (&matrix);
-  mtk_compute_viewport_matrix (&matrix,
-                               texture_width,
-                               texture_height,
-                               cursor_scale,
-                               cursor_transform,
-                               src_rect);
+  *out_rect = GRAPHENE_RECT_INIT (relative_cursor_position.x - hotspot_x * scale,
+                                  relative_cursor_position.y - hotspot_y * scale,
+                                  width, height);
+  return cursor_sprite;
+}
+
+static void
+calculate_cursor_sprite_matrix (MetaCursorSprite  *cursor_sprite,
+                                graphene_matrix_t *matrix)
+{
+  CoglTexture *cursor_texture = meta_cursor_sprite_get_cogl_texture (cursor_sprite);
+
+  graphene_matrix_init_identity (matrix);
+  mtk_compute_viewport_matrix (matrix,
+                               cogl_texture_get_width (cursor_texture),
+                               cogl_texture_get_height (cursor_texture),
+                               meta_cursor_sprite_get_texture_scale (cursor_sprite),
+                               meta_cursor_sprite_get_texture_transform (cursor_sprite),
+                               meta_cursor_sprite_get_viewport_src_rect (cursor_sprite));
+}
 
+static void
+update_embedded_cursor_rect (MetaScreenCastWindowStreamSrc *window_src,
+                             const graphene_rect_t         *cursor_rect)
+{
+  window_src->embedded_cursor.set = cursor_rect != NULL;
+  if (cursor_rect)
+    {
+      mtk_rectangle_from_graphene_rect (cursor_rect,
+                                        MTK_ROUNDING_STRATEGY_GROW,
+                                        &window_src->embedded_cursor.rect);
+    }
+}
+
+static void
+maybe_draw_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
+                          uint8_t                       *data,
+                          MtkRectangle                  *stream_rect,
+                          const MtkRectangle            *clip)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  MetaCursorSprite *cursor_sprite;
+  graphene_rect_t cursor_rect;
+  cairo_surface_t *cursor_surface;
+  uint8_t *cursor_surface_data;
+  GError *error = NULL;
+  cairo_surface_t *stream_surface;
+  int width, height;
+  graphene_matrix_t matrix;
+  cairo_t *cr;
+
+  cursor_sprite = calculate_cursor_sprite_rect (window_src, &cursor_rect);
+  update_embedded_cursor_rect (window_src, cursor_sprite ? &cursor_rect : NULL);
+  if (!cursor_sprite)
+    return;
+
+  width = (int) cursor_rect.size.width;
+  height = (int) cursor_rect.size.height;
+  calculate_cursor_sprite_matrix (cursor_sprite, &matrix);
 
   cursor_surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
                                                width, height);
 
   cursor_surface_data = cairo_image_surface_get_data (cursor_surface);
   if (!meta_screen_cast_stream_src_draw_cursor_into (src,
-                                                     cursor_texture,
+                                                     meta_cursor_sprite_get_cogl_texture (cursor_sprite),
                                                      width,
                                                      height,
                                                      &matrix,
@@ -227,11 +281,16 @@ maybe_draw_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
                                          stream_rect->width * 4);
 
   cr = cairo_create (stream_surface);
+  if (clip)
+    {
+      cairo_rectangle (cr, clip->x, clip->y, clip->width, clip->height);
+      cairo_clip (cr);
+    }
   cairo_surface_mark_dirty (cursor_surface);
   cairo_surface_flush (cursor_surface);
   cairo_set_source_surface (cr, cursor_surface,
-                            relative_cursor_position.x - hotspot_x * scale,
-                            relative_cursor_position.y - hotspot_y * scale);
+                            cursor_rect.origin.x,
+                            cursor_rect.origin.y);
   cairo_paint (cr);
   cairo_destroy (cr);
   cairo_surface_destroy (stream_surface);
@@ -248,85 +307,55 @@ maybe_blit_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
     meta_backend_get_clutter_backend (backend);
   CoglContext *cogl_context =
     clutter_backend_get_cogl_context (clutter_backend);
-  MetaCursorRenderer *cursor_renderer =
-    meta_backend_get_cursor_renderer (backend);
-  MetaCursorTracker *cursor_tracker =
-    meta_backend_get_cursor_tracker (backend);
-  MetaScreenCastWindow *screen_cast_window;
   MetaCursorSprite *cursor_sprite;
-  graphene_point_t relative_cursor_position;
-  graphene_point_t cursor_position;
-  CoglTexture *cursor_texture;
+  graphene_rect_t cursor_rect;
   CoglPipeline *pipeline;
-  int width, height;
-  float scale, view_scale, cursor_scale;
-  MtkMonitorTransform cursor_transform;
-  const graphene_rect_t *src_rect;
   graphene_matrix_t matrix;
-  int hotspot_x, hotspot_y;
-  float x, y;
 
-  cursor_sprite = meta_cursor_renderer_get_cursor (cursor_renderer);
+  cursor_sprite = calculate_cursor_sprite_rect (window_src, &cursor_rect);
+  update_embedded_cursor_rect (window_src, cursor_sprite ? &cursor_rect : NULL);
   if (!cursor_sprite)
     return;
 
-  cursor_texture = meta_cursor_sprite_get_cogl_texture (cursor_sprite);
-  if (!cursor_texture)
-    return;
-
-  screen_cast_window = window_src->screen_cast_window;
-  meta_cursor_tracker_get_pointer (cursor_tracker, &cursor_position, NULL);
-  if (!meta_screen_cast_window_transform_cursor_position (screen_cast_window,
-                                                          cursor_sprite,
-                                                          &cursor_position,
-                                                          &relative_cursor_position,
-                                                          &view_scale))
-    return;
-
-  meta_cursor_sprite_get_hotspot (cursor_sprite, &hotspot_x, &hotspot_y);
-  cursor_scale = meta_cursor_sprite_get_texture_scale (cursor_sprite);
-  scale = cursor_scale * view_scale;
-  cursor_transform = meta_cursor_sprite_get_texture_transform (cursor_sprite);
-  src_rect = meta_cursor_sprite_get_viewport_src_rect (cursor_sprite);
-
-  x = (relative_cursor_position.x - hotspot_x) * scale;
-  y = (relative_cursor_position.y - hotspot_y) * scale;
-  width = cogl_texture_get_width (cursor_texture);
-  height = cogl_texture_get_height (cursor_texture);
+  calculate_cursor_sprite_matrix (cursor_sprite, &matrix);
 
   pipeline = cogl_pipeline_new (cogl_context);
-  cogl_pipeline_set_layer_texture (pipeline, 0, cursor_texture);
+  cogl_pipeline_set_layer_texture (pipeline, 0,
+                                   meta_cursor_sprite_get_cogl_texture (cursor_sprite));
   cogl_pipeline_set_layer_filters (pipeline, 0,
                                    COGL_PIPELINE_FILTER_LINEAR,
                                    COGL_PIPELINE_FILTER_LINEAR);
-
-  graphene_matrix_init_identity (&matrix);
-  mtk_compute_viewport_matrix (&matrix,
-                               width,
-                               height,
-                               cursor_scale,
-                               cursor_transform,
-                               src_rect);
   cogl_pipeline_set_layer_matrix (pipeline, 0, &matrix);
 
   cogl_framebuffer_draw_rectangle (framebuffer,
                                    pipeline,
-                                   x, y,
-                                   x + width, y + height);
+                                   cursor_rect.origin.x,
+                                   cursor_rect.origin.y,
+                                   cursor_rect.origin.x + cursor_rect.size.width,
+                                   cursor_rect.origin.y + cursor_rect.size.height);
 
   g_object_unref (pipeline);
 }
 
 static gboolean
+is_cursor_embedded (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+
+  return (meta_screen_cast_stream_get_cursor_mode (stream) ==
+          META_SCREEN_CAST_CURSOR_MODE_EMBEDDED);
+}
+
+static void
 capture_into (MetaScreenCastWindowStreamSrc *window_src,
               int                            width,
               int                            height,
               int                            stride,
               uint8_t                       *data)
 {
-  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
   MtkRectangle stream_rect;
-  MetaScreenCastStream *stream;
+  size_t size;
 
   stream_rect = (MtkRectangle) {
     .width = width,
@@ -336,18 +365,31 @@ capture_into (MetaScreenCastWindowStreamSrc *window_src,
   meta_screen_cast_window_capture_into (window_src->screen_cast_window,
                                         &stream_rect, data);
 
-  stream = meta_screen_cast_stream_src_get_stream (src);
-  switch (meta_screen_cast_stream_get_cursor_mode (stream))
+  if (!is_cursor_embedded (window_src))
+    return;
+
+  /* Keep the window content without the cursor around, so that moving
+   * the cursor only needs to restore the area it covered */
+  size = (size_t) width * height * 4;
+  if (window_src->clean_frame.width != width ||
+      window_src->clean_frame.height != height)
     {
-    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
-      maybe_draw_cursor_sprite (window_src, data, &stream_rect);
-      break;
-    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
-    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
-      break;
+      g_free (window_src->clean_frame.data);
+      window_src->clean_frame.data = g_malloc (size);
+      window_src->clean_frame.width = width;
+      window_src->clean_frame.height = height;
     }
+  memcpy (window_src->clean_frame.data, data, size);
 
-  return TRUE;
+  maybe_draw_cursor_sprite (window_src, data, &stream_rect, NULL);
+}
+
+static void
+clear_clean_frame (MetaScreenCastWindowStreamSrc *window_src)
+{
+  g_clear_pointer (&window_src->clean_frame.data, g_free);
+  window_src->clean_frame.width = 0;
+  window_src->clean_frame.height = 0;
 }
 
 static gboolean
@@ -411,6 +453,9 @@ meta_screen_cast_window_stream_src_stop (MetaScreenCastWindowStreamSrc *window_s
   g_clear_signal_handler (&window_src->prepare_frame_handler_id,
                           stage);
 
+  clear_clean_frame (window_src);
+  window_src->embedded_cursor.set = FALSE;
+
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
     {
     case META_SCREEN_CAST_CURSOR_MODE_METADATA:
@@ -445,6 +490,58 @@ screen_cast_window_destroyed (MetaWindowActor               *actor,
   window_src->screen_cast_window = NULL;
 }
 
+/* Re-composites only the areas the embedded cursor left and entered on
+ * top of the last captured window content */
+static void
+maybe_record_embedded_cursor (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  g_autoptr (MtkRegion) damage = NULL;
+  graphene_rect_t cursor_rect;
+  MtkRectangle new_rect;
+  MtkRectangle stream_rect;
+  gboolean has_new_rect;
+
+  has_new_rect = !!calculate_cursor_sprite_rect (window_src, &cursor_rect);
+  if (has_new_rect)
+    {
+      mtk_rectangle_from_graphene_rect (&cursor_rect,
+                                        MTK_ROUNDING_STRATEGY_GROW,
+                                        &new_rect);
+    }
+
+  if (!window_src->cursor_bitmap_invalid &&
+      has_new_rect == window_src->embedded_cursor.set &&
+      (!has_new_rect ||
+       mtk_rectangle_equal (&new_rect, &window_src->embedded_cursor.rect)))
+    return;
+
+  window_src->cursor_bitmap_invalid = FALSE;
+
+  damage = mtk_region_create ();
+  if (window_src->embedded_cursor.set)
+    mtk_region_union_rectangle (damage, &window_src->embedded_cursor.rect);
+  if (has_new_rect)
+    mtk_region_union_rectangle (damage, &new_rect);
+
+  stream_rect = (MtkRectangle) {
+    .width = get_stream_width (window_src),
+    .height = get_stream_height (window_src),
+  };
+  mtk_region_intersect_rectangle (damage, &stream_rect);
+  if (mtk_region_is_empty (damage))
+    {
+      update_embedded_cursor_rect (window_src,
+                                   has_new_rect ? &cursor_rect : NULL);
+      return;
+    }
+
+  meta_screen_cast_stream_src_maybe_record_frame (src,
+                                                  META_SCREEN_CAST_RECORD_FLAG_NONE,
+                                                  META_SCREEN_CAST_PAINT_PHASE_DETACHED,
+                                                  damage);
+}
+
 static void
 sync_cursor_state (MetaScreenCastWindowStreamSrc *window_src)
 {
@@ -455,6 +552,12 @@ sync_cursor_state (MetaScreenCastWindowStreamSrc *window_src)
   if (meta_screen_cast_window_has_damage (window_src->screen_cast_window))
     return;
 
+  if (is_cursor_embedded (window_src))
+    {
+      maybe_record_embedded_cursor (window_src);
+      return;
+    }
+
   flags = META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY;
   paint_phase = META_SCREEN_CAST_PAINT_PHASE_DETACHED;
   meta_screen_cast_stream_src_maybe_record_frame (src, flags,
@@ -575,6 +678,50 @@ meta_screen_cast_window_stream_src_record_to_buffer (MetaScreenCastStreamSrc   *
   return TRUE;
 }
 
+static gboolean
+meta_screen_cast_window_stream_src_record_to_buffer_area (MetaScreenCastStreamSrc   *src,
+                                                          MetaScreenCastPaintPhase   paint_phase,
+                                                          const MtkRectangle        *area,
+                                                          int                        stride,
+                                                          uint8_t                   *data,
+                                                          GError                   **error)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
+  int width = get_stream_width (window_src);
+  int height = get_stream_height (window_src);
+  MtkRectangle stream_rect;
+  int y;
+
+  /* Only cursor movement is recorded partially, everything else changes
+   * the window content and needs a full capture */
+  if (!is_cursor_embedded (window_src) ||
+      !window_src->clean_frame.data ||
+      window_src->clean_frame.width != width ||
+      window_src->clean_frame.height != height)
+    {
+      capture_into (window_src, width, height, stride, data);
+      return TRUE;
+    }
+
+  for (y = area->y; y < area->y + area->height; y++)
+    {
+      size_t offset = ((size_t) y * width + area->x) * 4;
+
+      memcpy (data + offset,
+              window_src->clean_frame.data + offset,
+              (size_t) area->width * 4);
+    }
+
+  stream_rect = (MtkRectangle) {
+    .width = width,
+    .height = height,
+  };
+  maybe_draw_cursor_sprite (window_src, data, &stream_rect, area);
+
+  return TRUE;
+}
+
 static gboolean
 meta_screen_cast_window_stream_src_record_to_framebuffer (MetaScreenCastStreamSrc   *src,
                                                           MetaScreenCastPaintPhase   paint_phase,
@@ -756,6 +903,17 @@ meta_screen_cast_window_stream_src_new (MetaScreenCastWindowStream  *window_stre
                          NULL);
 }
 
+static void
+meta_screen_cast_window_stream_src_finalize (GObject *object)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (object);
+
+  clear_clean_frame (window_src);
+
+  G_OBJECT_CLASS (meta_screen_cast_window_stream_src_parent_class)->finalize (object);
+}
+
 static void
 meta_screen_cast_window_stream_src_init (MetaScreenCastWindowStreamSrc *window_src)
 {
@@ -765,14 +923,19 @@ meta_screen_cast_window_stream_src_init (MetaScreenCastWindowStreamSrc *window_s
 static void
 meta_screen_cast_window_stream_src_class_init (MetaScreenCastWindowStreamSrcClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   MetaScreenCastStreamSrcClass *src_class =
     META_SCREEN_CAST_STREAM_SRC_CLASS (klass);
 
+  object_class->finalize = meta_screen_cast_window_stream_src_finalize;
+
   src_class->get_specs = meta_screen_cast_window_stream_src_get_specs;
   src_class->enable = meta_screen_cast_window_stream_src_enable;
   src_class->disable = meta_screen_cast_window_stream_src_disable;
   src_class->record_to_buffer =
     meta_screen_cast_window_stream_src_record_to_buffer;
+  src_class->record_to_buffer_area =
+    meta_screen_cast_window_stream_src_record_to_buffer_area;
   src_class->record_to_framebuffer =
     meta_screen_cast_window_stream_src_record_to_framebuffer;
   src_class->record_follow_up =
@@ -43,6 +43,8 @@
 struct _MetaScreenCast
 {
   MetaDbusSessionManager parent;
+
+  GList *shared_captures;
 };
 
 G_DEFINE_TYPE (MetaScreenCast, meta_screen_cast,
@@ -332,6 +334,49 @@ handle_create_session (MetaDBusScreenCast    *skeleton,
   return G_DBUS_METHOD_INVOCATION_HANDLED;
 }
 
+MetaScreenCastSharedCapture *
+meta_screen_cast_acquire_shared_capture (MetaScreenCast     *screen_cast,
+                                         const MtkRectangle *rect,
+                                         float               scale,
+                                         ClutterPaintFlag    paint_flags)
+{
+  MetaScreenCastSharedCapture *capture;
+  GList *l;
+
+  for (l = screen_cast->shared_captures; l; l = l->next)
+    {
+      capture = l->data;
+
+      if (meta_screen_cast_shared_capture_matches (capture, rect, scale,
+                                                   paint_flags))
+        {
+          meta_screen_cast_shared_capture_add_user (capture);
+          return capture;
+        }
+    }
+
+  capture =
+    meta_screen_cast_shared_capture_new (meta_screen_cast_get_backend (screen_cast),
+                                         rect, scale, paint_flags);
+  meta_screen_cast_shared_capture_add_user (capture);
+  screen_cast->shared_captures = g_list_prepend (screen_cast->shared_captures,
+                                                 capture);
+
+  return capture;
+}
+
+void
+meta_screen_cast_release_shared_capture (MetaScreenCast              *screen_cast,
+                                         MetaScreenCastSharedCapture *capture)
+{
+  if (!meta_screen_cast_shared_capture_remove_user (capture))
+    return;
+
+  screen_cast->shared_captures = g_list_remove (screen_cast->shared_captures,
+                                                capture);
+  meta_screen_cast_shared_capture_free (capture);
+}
+
 static void
 meta_screen_cast_constructed (GObject *object)
 {
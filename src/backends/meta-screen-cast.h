@@ -25,6 +25,7 @@
 #include "backends/meta-backend-private.h"
 #include "backends/meta-dbus-session-manager.h"
 #include "backends/meta-dbus-session-watcher.h"
+#include "backends/meta-screen-cast-shared-capture.h"
 
 #include "meta-dbus-screen-cast.h"
 
@@ -65,4 +66,12 @@ CoglDmaBufHandle * meta_screen_cast_create_dma_buf_handle (MetaScreenCast  *scre
                                                            int              width,
                                                            int              height);
 
+MetaScreenCastSharedCapture * meta_screen_cast_acquire_shared_capture (MetaScreenCast     *screen_cast,
+                                                                       const MtkRectangle *rect,
+                                                                       float               scale,
+                                                                       ClutterPaintFlag    paint_flags);
+
+void meta_screen_cast_release_shared_capture (MetaScreenCast              *screen_cast,
+                                              MetaScreenCastSharedCapture *capture);
+
 MetaScreenCast * meta_screen_cast_new (MetaBackend *backend);
@@ -794,6 +794,7 @@ meta_stage_impl_redraw_view (ClutterStageWindow *stage_window,
                                         frame,
                                         &error))
         {
+          clutter_frame_set_kind (frame, CLUTTER_FRAME_KIND_DIRECT_SCANOUT);
           clutter_stage_view_accumulate_redraw_clip (stage_view);
           return;
         }
@@ -41,6 +41,26 @@ typedef struct _MetaStageViewPrivate
 G_DEFINE_TYPE_WITH_PRIVATE (MetaStageView, meta_stage_view,
                             CLUTTER_TYPE_STAGE_VIEW)
 
+static int64_t
+get_hitch_budget_us (void)
+{
+  static int64_t hitch_budget_us = -1;
+
+  if (hitch_budget_us == -1)
+    {
+      const char *hitch_budget_ms_str;
+      double hitch_budget_ms = 0.0;
+
+      hitch_budget_ms_str = g_getenv ("MUTTER_DEBUG_HITCH_BUDGET_MS");
+      if (hitch_budget_ms_str)
+        hitch_budget_ms = g_ascii_strtod (hitch_budget_ms_str, NULL);
+
+      hitch_budget_us = (int64_t) (MAX (hitch_budget_ms, 0.0) * 1000.0);
+    }
+
+  return hitch_budget_us;
+}
+
 static void
 frame_cb (CoglOnscreen  *onscreen,
           CoglFrameEvent frame_event,
@@ -60,6 +80,9 @@ frame_cb (CoglOnscreen  *onscreen,
     {
       ClutterFrameInfo clutter_frame_info;
       ClutterFrameInfoFlag flags = CLUTTER_FRAME_INFO_FLAG_NONE;
+      g_autofree ClutterFrameGpuPhase *gpu_phases = NULL;
+      unsigned int n_gpu_phases, i;
+      int n_valid_gpu_phases = 0;
 
       if (cogl_frame_info_is_hw_clock (frame_info))
         flags |= CLUTTER_FRAME_INFO_FLAG_HW_CLOCK;
@@ -70,6 +93,23 @@ frame_cb (CoglOnscreen  *onscreen,
       if (cogl_frame_info_is_vsync (frame_info))
         flags |= CLUTTER_FRAME_INFO_FLAG_VSYNC;
 
+      if (cogl_frame_info_is_async (frame_info))
+        flags |= CLUTTER_FRAME_INFO_FLAG_ASYNC;
+
+      n_gpu_phases = cogl_frame_info_get_n_gpu_phases (frame_info);
+      if (n_gpu_phases > 0)
+        gpu_phases = g_new0 (ClutterFrameGpuPhase, n_gpu_phases);
+
+      for (i = 0; i < n_gpu_phases; i++)
+        {
+          ClutterFrameGpuPhase *gpu_phase = &gpu_phases[n_valid_gpu_phases];
+
+          if (cogl_frame_info_get_gpu_phase (frame_info, i,
+                                             &gpu_phase->name,
+                                             &gpu_phase->duration_ns))
+            n_valid_gpu_phases++;
+        }
+
       clutter_frame_info = (ClutterFrameInfo) {
         .frame_counter = cogl_frame_info_get_global_frame_counter (frame_info),
         .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
@@ -83,6 +123,8 @@ frame_cb (CoglOnscreen  *onscreen,
           cogl_frame_info_get_rendering_duration_ns (frame_info),
         .cpu_time_before_buffer_swap_us =
           cogl_frame_info_get_time_before_buffer_swap_us (frame_info),
+        .gpu_phases = gpu_phases,
+        .n_gpu_phases = n_valid_gpu_phases,
       };
       clutter_stage_view_notify_presented (view, &clutter_frame_info);
     }
@@ -132,6 +174,9 @@ meta_stage_view_constructed (GObject *object)
     }
 
   G_OBJECT_CLASS (meta_stage_view_parent_class)->constructed (object);
+
+  clutter_frame_clock_set_hitch_budget (clutter_stage_view_get_frame_clock (stage_view),
+                                        get_hitch_budget_us ());
 }
 
 static ClutterPaintFlag
@@ -409,66 +409,157 @@ meta_backend_native_update_stage (MetaBackend *backend)
   clutter_actor_set_size (stage, width, height);
 }
 
-static MetaRenderDevice *
-create_render_device (MetaBackendNative  *backend_native,
-                      const char         *device_path,
-                      GError            **error)
+typedef struct _GpuProbe
+{
+  MetaBackend *backend;
+  GUdevDevice *device;
+
+  MetaDeviceFile *device_file;
+  GError *error;
+
+  MetaRenderDeviceGbm *render_device_gbm;
+  GError *gbm_error;
+
+  GThread *thread;
+} GpuProbe;
+
+static GpuProbe *
+gpu_probe_new (MetaBackendNative *backend_native,
+               GUdevDevice       *device)
 {
   MetaBackend *backend = META_BACKEND (backend_native);
   MetaDevicePool *device_pool =
     meta_backend_native_get_device_pool (backend_native);
-  g_autoptr (MetaDeviceFile) device_file = NULL;
   MetaDeviceFileFlags device_file_flags;
-  g_autoptr (MetaRenderDeviceGbm) render_device_gbm = NULL;
-  g_autoptr (GError) gbm_error = NULL;
-#ifdef HAVE_EGL_DEVICE
-  MetaBackendNativePrivate *priv =
-    meta_backend_native_get_instance_private (backend_native);
-  g_autoptr (GError) egl_stream_error = NULL;
-#endif
+  GpuProbe *probe;
+
+  probe = g_new0 (GpuProbe, 1);
+  probe->backend = backend;
+  probe->device = g_object_ref (device);
 
   if (meta_backend_is_headless (backend))
     device_file_flags = META_DEVICE_FILE_FLAG_NONE;
   else
     device_file_flags = META_DEVICE_FILE_FLAG_TAKE_CONTROL;
 
-  device_file = meta_device_pool_open (device_pool,
-                                       device_path,
-                                       device_file_flags,
-                                       error);
-  if (!device_file)
-    return NULL;
+  /* Taking control of the device may go via logind, so always open the
+   * device file on the main thread. */
+  probe->device_file =
+    meta_device_pool_open (device_pool,
+                           g_udev_device_get_device_file (device),
+                           device_file_flags,
+                           &probe->error);
 
-#ifdef HAVE_EGL_DEVICE
-  if (g_strcmp0 (getenv ("MUTTER_DEBUG_FORCE_EGL_STREAM"), "1") != 0)
-#endif
-    {
-      render_device_gbm = meta_render_device_gbm_new (backend, device_file,
-                                                      &gbm_error);
-      if (render_device_gbm)
-        {
-          MetaRenderDevice *render_device =
-            META_RENDER_DEVICE (render_device_gbm);
+  return probe;
+}
+
+static void
+gpu_probe_free (GpuProbe *probe)
+{
+  g_assert (!probe->thread);
+
+  g_clear_object (&probe->render_device_gbm);
+  g_clear_error (&probe->gbm_error);
+  g_clear_pointer (&probe->device_file, meta_device_file_release);
+  g_clear_error (&probe->error);
+  g_object_unref (probe->device);
+  g_free (probe);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GpuProbe, gpu_probe_free)
+
+/*
+ * Creates the GBM render device, which includes initializing EGL for it,
+ * and is the part of adding a GPU that takes the most time. It only deals
+ * with the already opened device file and EGL, thus it may run in a
+ * thread of its own.
+ */
+static void
+gpu_probe_run (GpuProbe *probe)
+{
+  COGL_TRACE_BEGIN_SCOPED (ProbeGpu, "Meta::BackendNative::probe_gpu()");
+
+  if (!probe->device_file)
+    return;
 
-          if (meta_render_device_is_hardware_accelerated (render_device))
-            return META_RENDER_DEVICE (g_steal_pointer (&render_device_gbm));
-        }
-    }
 #ifdef HAVE_EGL_DEVICE
-  else
+  if (g_strcmp0 (getenv ("MUTTER_DEBUG_FORCE_EGL_STREAM"), "1") == 0)
     {
-      g_set_error (&gbm_error, G_IO_ERROR, G_IO_ERROR_FAILED,
+      g_set_error (&probe->gbm_error, G_IO_ERROR, G_IO_ERROR_FAILED,
                    "GBM backend was disabled using env var");
+      return;
     }
 #endif
 
+  probe->render_device_gbm = meta_render_device_gbm_new (probe->backend,
+                                                         probe->device_file,
+                                                         &probe->gbm_error);
+}
+
+static gpointer
+gpu_probe_thread_func (gpointer user_data)
+{
+  GpuProbe *probe = user_data;
+
+  gpu_probe_run (probe);
+
+  return NULL;
+}
+
+static void
+gpu_probe_start (GpuProbe *probe)
+{
+  g_assert (!probe->thread);
+
+  probe->thread = g_thread_new ("[mutter] GPU probe",
+                                gpu_probe_thread_func,
+                                probe);
+}
+
+static void
+gpu_probe_join (GpuProbe *probe)
+{
+  g_assert (probe->thread);
+
+  g_thread_join (probe->thread);
+  probe->thread = NULL;
+}
+
+static MetaRenderDevice *
+create_render_device (MetaBackendNative  *backend_native,
+                      GpuProbe           *probe,
+                      GError            **error)
+{
+  const char *device_path = g_udev_device_get_device_file (probe->device);
+#ifdef HAVE_EGL_DEVICE
+  MetaBackend *backend = META_BACKEND (backend_native);
+  MetaBackendNativePrivate *priv =
+    meta_backend_native_get_instance_private (backend_native);
+  g_autoptr (GError) egl_stream_error = NULL;
+#endif
+
+  if (!probe->device_file)
+    {
+      g_propagate_error (error, g_steal_pointer (&probe->error));
+      return NULL;
+    }
+
+  if (probe->render_device_gbm)
+    {
+      MetaRenderDevice *render_device =
+        META_RENDER_DEVICE (probe->render_device_gbm);
+
+      if (meta_render_device_is_hardware_accelerated (render_device))
+        return META_RENDER_DEVICE (g_steal_pointer (&probe->render_device_gbm));
+    }
+
 #ifdef HAVE_EGL_DEVICE
   if (!priv->render_device_egl_stream)
     {
       MetaRenderDeviceEglStream *device;
 
       device = meta_render_device_egl_stream_new (backend,
-                                                  device_file,
+                                                  probe->device_file,
                                                   &egl_stream_error);
       if (device)
         {
@@ -477,7 +568,7 @@ create_render_device (MetaBackendNative  *backend_native,
           return META_RENDER_DEVICE (device);
         }
     }
-  else if (!render_device_gbm)
+  else if (!probe->render_device_gbm)
     {
       g_set_error (&egl_stream_error,
                    G_IO_ERROR,
@@ -486,8 +577,8 @@ create_render_device (MetaBackendNative  *backend_native,
     }
 #endif
 
-  if (render_device_gbm)
-    return META_RENDER_DEVICE (g_steal_pointer (&render_device_gbm));
+  if (probe->render_device_gbm)
+    return META_RENDER_DEVICE (g_steal_pointer (&probe->render_device_gbm));
 
   g_set_error (error, G_IO_ERROR,
                G_IO_ERROR_FAILED,
@@ -497,7 +588,7 @@ create_render_device (MetaBackendNative  *backend_native,
                ", %s"
 #endif
                , device_path
-               , gbm_error->message
+               , probe->gbm_error->message
 #ifdef HAVE_EGL_DEVICE
                , egl_stream_error->message
 #endif
@@ -508,11 +599,12 @@ create_render_device (MetaBackendNative  *backend_native,
 
 static gboolean
 add_drm_device (MetaBackendNative  *backend_native,
-                GUdevDevice        *device,
+                GpuProbe           *probe,
                 GError            **error)
 {
   MetaBackendNativePrivate *priv =
     meta_backend_native_get_instance_private (backend_native);
+  GUdevDevice *device = probe->device;
   MetaKmsDeviceFlag flags = META_KMS_DEVICE_FLAG_NONE;
   const char *device_path;
   g_autoptr (MetaRenderDevice) render_device = NULL;
@@ -536,7 +628,7 @@ add_drm_device (MetaBackendNative  *backend_native,
 
   device_path = g_udev_device_get_device_file (device);
 
-  render_device = create_render_device (backend_native, device_path, error);
+  render_device = create_render_device (backend_native, probe, error);
   if (!render_device)
     return FALSE;
 
@@ -588,6 +680,7 @@ on_udev_device_added (MetaUdev          *udev,
                       MetaBackendNative *native)
 {
   MetaBackend *backend = META_BACKEND (native);
+  g_autoptr (GpuProbe) probe = NULL;
   g_autoptr (GError) error = NULL;
   const char *device_path;
   GList *gpus, *l;
@@ -616,7 +709,10 @@ on_udev_device_added (MetaUdev          *udev,
       return;
     }
 
-  if (!add_drm_device (native, device, &error))
+  probe = gpu_probe_new (native, device);
+  gpu_probe_run (probe);
+
+  if (!add_drm_device (native, probe, &error))
     {
       if (meta_backend_is_headless (backend) &&
           g_error_matches (error, G_IO_ERROR,
@@ -645,8 +741,10 @@ init_gpus (MetaBackendNative  *native,
   MetaKms *kms = meta_backend_native_get_kms (native);
   g_autoptr (GError) local_error = NULL;
   MetaUdevDeviceType device_type = 0;
+  g_autoptr (GPtrArray) probes = NULL;
   GList *devices;
   GList *l;
+  unsigned int i;
 
   switch (priv->mode)
     {
@@ -667,10 +765,11 @@ init_gpus (MetaBackendNative  *native,
       return FALSE;
     }
 
+  probes = g_ptr_array_new_with_free_func ((GDestroyNotify) gpu_probe_free);
+
   for (l = devices; l; l = l->next)
     {
       GUdevDevice *device = l->data;
-      GError *device_error = NULL;
 
       if (should_ignore_device (native, device))
         {
@@ -679,7 +778,34 @@ init_gpus (MetaBackendNative  *native,
           continue;
         }
 
-      if (!add_drm_device (native, device, &device_error))
+      g_ptr_array_add (probes, gpu_probe_new (native, device));
+    }
+
+  g_list_free_full (devices, g_object_unref);
+
+  /* Initializing EGL for a GPU can take a while, so when there are multiple
+   * GPUs, probe them in parallel. They are still added in the order udev
+   * listed them, so that primary GPU selection doesn't depend on which
+   * probe happens to finish first. */
+  if (probes->len > 1)
+    {
+      for (i = 0; i < probes->len; i++)
+        gpu_probe_start (g_ptr_array_index (probes, i));
+      for (i = 0; i < probes->len; i++)
+        gpu_probe_join (g_ptr_array_index (probes, i));
+    }
+  else if (probes->len == 1)
+    {
+      gpu_probe_run (g_ptr_array_index (probes, 0));
+    }
+
+  for (i = 0; i < probes->len; i++)
+    {
+      GpuProbe *probe = g_ptr_array_index (probes, i);
+      GUdevDevice *device = probe->device;
+      GError *device_error = NULL;
+
+      if (!add_drm_device (native, probe, &device_error))
         {
           if (meta_backend_is_headless (backend) &&
               (g_error_matches (device_error, G_IO_ERROR,
@@ -705,8 +831,6 @@ init_gpus (MetaBackendNative  *native,
         }
     }
 
-  g_list_free_full (devices, g_object_unref);
-
   meta_kms_notify_probed (kms);
 
   if (!meta_backend_is_headless (backend) &&
@@ -796,6 +920,13 @@ meta_backend_native_init_basic (MetaBackend  *backend,
   MetaBackendNativePrivate *priv =
     meta_backend_native_get_instance_private (native);
   MetaKmsFlags kms_flags;
+  const char *cpu_affinity;
+
+  /* Set before any thread is created, so that they inherit it, unless
+   * they have an affinity of their own. */
+  cpu_affinity = g_getenv ("MUTTER_DEBUG_MAIN_THREAD_CPUS");
+  if (cpu_affinity)
+    meta_set_thread_cpu_affinity ("main", cpu_affinity);
 
   priv->startup_render_devices =
     g_hash_table_new_full (g_str_hash, g_str_equal,
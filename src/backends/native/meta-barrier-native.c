@@ -43,6 +43,10 @@ struct _MetaBarrierManagerNative
   GHashTable *barriers;
   GMutex mutex;
   MetaBarrierImplNative *pointer_trap;
+
+  /* Number of barriers not in the active state, i.e. that need to be
+   * looked at on every motion to be released or to emit events. */
+  int n_engaged_barriers;
 };
 
 typedef enum
@@ -78,6 +82,9 @@ struct _MetaBarrierImplNative
   guint32                   last_event_time;
   MetaBarrierDirection      blocked_dir;
   GMainContext             *main_context;
+
+  /* Bounding box of the barrier, with a as the top left corner */
+  MetaLine2                 extents;
 };
 
 G_DEFINE_TYPE (MetaBarrierImplNative,
@@ -117,10 +124,23 @@ is_barrier_blocking_directions (MetaBarrier         *barrier,
   return meta_border_is_blocking_directions (border, border_motion_directions);
 }
 
+static void
+set_barrier_state (MetaBarrierImplNative *self,
+                   MetaBarrierState       state)
+{
+  gboolean was_engaged = self->state != META_BARRIER_STATE_ACTIVE;
+  gboolean is_engaged = state != META_BARRIER_STATE_ACTIVE;
+
+  if (was_engaged != is_engaged)
+    self->manager->n_engaged_barriers += is_engaged ? 1 : -1;
+
+  self->state = state;
+}
+
 static void
 dismiss_pointer (MetaBarrierImplNative *self)
 {
-  self->state = META_BARRIER_STATE_LEFT;
+  set_barrier_state (self, META_BARRIER_STATE_LEFT);
 }
 
 /*
@@ -259,6 +279,13 @@ update_closest_barrier (gpointer key,
   float dx, dy;
   float distance_2;
 
+  /* Ignore if the motion doesn't get anywhere near the barrier. */
+  if (MAX (data->in.motion.a.x, data->in.motion.b.x) < self->extents.a.x ||
+      MIN (data->in.motion.a.x, data->in.motion.b.x) > self->extents.b.x ||
+      MAX (data->in.motion.a.y, data->in.motion.b.y) < self->extents.a.y ||
+      MIN (data->in.motion.a.y, data->in.motion.b.y) > self->extents.b.y)
+    return;
+
   /* Ignore if the barrier is not blocking in any of the motions directions. */
   if (!is_barrier_blocking_directions (barrier, data->in.directions))
     return;
@@ -404,14 +431,14 @@ emit_barrier_event (MetaBarrierImplNative *self,
   switch (self->state)
     {
     case META_BARRIER_STATE_HIT:
-      self->state = META_BARRIER_STATE_HELD;
+      set_barrier_state (self, META_BARRIER_STATE_HELD);
       self->trigger_serial = next_serial ();
       event->dt = 0;
 
       break;
     case META_BARRIER_STATE_RELEASE:
     case META_BARRIER_STATE_LEFT:
-      self->state = META_BARRIER_STATE_ACTIVE;
+      set_barrier_state (self, META_BARRIER_STATE_ACTIVE);
 
       G_GNUC_FALLTHROUGH;
     case META_BARRIER_STATE_HELD:
@@ -500,7 +527,7 @@ clamp_to_barrier (MetaBarrierImplNative *self,
                        META_BARRIER_DIRECTION_NEGATIVE_X);
     }
 
-  self->state = META_BARRIER_STATE_HIT;
+  set_barrier_state (self, META_BARRIER_STATE_HIT);
 }
 
 static gboolean
@@ -525,7 +552,7 @@ stick_to_barrier (MetaBarrierImplNative *self,
       *y = intersection.y;
 
       self->blocked_dir = motion_dir;
-      self->state = META_BARRIER_STATE_HIT;
+      set_barrier_state (self, META_BARRIER_STATE_HIT);
       self->manager->pointer_trap = self;
       return TRUE;
     }
@@ -602,6 +629,10 @@ meta_barrier_manager_native_process_in_impl (MetaBarrierManagerNative *manager,
         break;
     }
 
+  /* Nothing else to do if no barrier was hit or is held. */
+  if (manager->n_engaged_barriers == 0)
+    goto out;
+
   /* Potentially release active barrier movements. */
   maybe_release_barriers (manager, prev_x, prev_y, *x, *y);
 
@@ -620,6 +651,7 @@ meta_barrier_manager_native_process_in_impl (MetaBarrierManagerNative *manager,
                         maybe_emit_barrier_event,
                         &barrier_event_data);
 
+ out:
   g_mutex_unlock (&manager->mutex);
 }
 
@@ -637,12 +669,14 @@ meta_barrier_impl_native_release (MetaBarrierImpl  *impl,
 {
   MetaBarrierImplNative *self = META_BARRIER_IMPL_NATIVE (impl);
 
+  g_mutex_lock (&self->manager->mutex);
   if (self->state == META_BARRIER_STATE_HELD &&
       (!event || event->event_id == self->trigger_serial))
     {
-      self->state = META_BARRIER_STATE_RELEASE;
+      set_barrier_state (self, META_BARRIER_STATE_RELEASE);
       self->manager->pointer_trap = NULL;
     }
+  g_mutex_unlock (&self->manager->mutex);
 }
 
 static void
@@ -653,6 +687,7 @@ meta_barrier_impl_native_destroy (MetaBarrierImpl *impl)
   g_mutex_lock (&self->manager->mutex);
   if (self->manager->pointer_trap == self)
     self->manager->pointer_trap = NULL;
+  set_barrier_state (self, META_BARRIER_STATE_ACTIVE);
   g_hash_table_remove (self->manager->barriers, self);
   g_mutex_unlock (&self->manager->mutex);
   g_main_context_unref (self->main_context);
@@ -664,6 +699,7 @@ meta_barrier_impl_native_new (MetaBarrier *barrier)
 {
   MetaBackend *backend = meta_barrier_get_backend (barrier);
   ClutterSeat *seat = meta_backend_get_default_seat (backend);
+  MetaBorder *border = meta_barrier_get_border (barrier);
   MetaBarrierImplNative *self;
   MetaBarrierManagerNative *manager;
 
@@ -672,6 +708,16 @@ meta_barrier_impl_native_new (MetaBarrier *barrier)
   self->barrier = barrier;
   self->is_active = TRUE;
   self->main_context = g_main_context_ref_thread_default ();
+  self->extents = (MetaLine2) {
+    .a = {
+      .x = MIN (border->line.a.x, border->line.b.x),
+      .y = MIN (border->line.a.y, border->line.b.y),
+    },
+    .b = {
+      .x = MAX (border->line.a.x, border->line.b.x),
+      .y = MAX (border->line.a.y, border->line.b.y),
+    },
+  };
 
   manager = meta_seat_native_get_barrier_manager (META_SEAT_NATIVE (seat));
   self->manager = manager;
@@ -53,6 +53,7 @@ struct _MetaCrtcKms
 
   MetaKmsPlane *assigned_primary_plane;
   MetaKmsPlane *assigned_cursor_plane;
+  MetaKmsPlane *assigned_overlay_plane;
 };
 
 static GQuark kms_crtc_crtc_kms_quark;
@@ -223,6 +224,7 @@ typedef struct _CrtcKmsAssignment
 {
   MetaKmsPlane *primary_plane;
   MetaKmsPlane *cursor_plane;
+  MetaKmsPlane *overlay_plane;
 } CrtcKmsAssignment;
 
 static gboolean
@@ -253,7 +255,9 @@ is_plane_assigned (MetaKmsPlane     *plane,
             return TRUE;
           break;
         case META_KMS_PLANE_TYPE_OVERLAY:
-          g_assert_not_reached ();
+          if (kms_assignment->overlay_plane == plane)
+            return TRUE;
+          break;
         }
     }
 
@@ -320,6 +324,7 @@ meta_crtc_kms_assign_extra (MetaCrtc            *crtc,
   MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
   MetaKmsPlane *primary_plane;
   MetaKmsPlane *cursor_plane;
+  MetaKmsPlane *overlay_plane;
   CrtcKmsAssignment *kms_assignment;
 
   primary_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_PRIMARY,
@@ -339,9 +344,15 @@ meta_crtc_kms_assign_extra (MetaCrtc            *crtc,
   cursor_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_CURSOR,
                                         crtc_assignments);
 
+  /* Optional; lets a single non-fullscreen client buffer be scanned out
+   * on top of the composited primary plane. */
+  overlay_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_OVERLAY,
+                                         crtc_assignments);
+
   kms_assignment = g_new0 (CrtcKmsAssignment, 1);
   kms_assignment->primary_plane = primary_plane;
   kms_assignment->cursor_plane = cursor_plane;
+  kms_assignment->overlay_plane = overlay_plane;
 
   crtc_assignment->backend_private = kms_assignment;
   crtc_assignment->backend_private_destroy = g_free;
@@ -359,6 +370,7 @@ meta_crtc_kms_set_config (MetaCrtc             *crtc,
 
   crtc_kms->assigned_primary_plane = kms_assignment->primary_plane;
   crtc_kms->assigned_cursor_plane = kms_assignment->cursor_plane;
+  crtc_kms->assigned_overlay_plane = kms_assignment->overlay_plane;
 }
 
 void
@@ -368,6 +380,7 @@ meta_crtc_kms_assign_planes (MetaCrtcKms  *crtc_kms,
 {
   crtc_kms->assigned_primary_plane = primary_plane;
   crtc_kms->assigned_cursor_plane = cursor_plane;
+  crtc_kms->assigned_overlay_plane = NULL;
 }
 
 static void
@@ -380,6 +393,7 @@ meta_crtc_kms_unset_config (MetaCrtc *crtc)
 
   crtc_kms->assigned_primary_plane = NULL;
   crtc_kms->assigned_cursor_plane = NULL;
+  crtc_kms->assigned_overlay_plane = NULL;
 }
 
 static gboolean
@@ -425,6 +439,12 @@ meta_crtc_kms_get_assigned_primary_plane (MetaCrtcKms *crtc_kms)
   return crtc_kms->assigned_primary_plane;
 }
 
+MetaKmsPlane *
+meta_crtc_kms_get_assigned_overlay_plane (MetaCrtcKms *crtc_kms)
+{
+  return crtc_kms->assigned_overlay_plane;
+}
+
 static GList *
 generate_crtc_connector_list (MetaGpu  *gpu,
                               MetaCrtc *crtc)
@@ -25,6 +25,7 @@
 
 #include "backends/native/meta-cursor-renderer-native.h"
 
+#include <float.h>
 #include <string.h>
 #include <gbm.h>
 #include <xf86drm.h>
@@ -54,6 +55,7 @@
 #include "core/boxes-private.h"
 #include "meta/boxes.h"
 #include "meta/meta-backend.h"
+#include "meta/prefs.h"
 #include "meta/util.h"
 
 #ifdef HAVE_WAYLAND
@@ -61,8 +63,18 @@
 #include "wayland/meta-wayland-buffer.h"
 #endif
 
+#define MAX_CACHED_CURSOR_BUFFERS 64
+
 static GQuark quark_cursor_sprite = 0;
 
+static const MetaCursor prewarm_cursors[] = {
+  META_CURSOR_DEFAULT,
+  META_CURSOR_POINTING_HAND,
+  META_CURSOR_IBEAM,
+  META_CURSOR_MOVE_OR_RESIZE_WINDOW,
+  META_CURSOR_BUSY,
+};
+
 typedef struct _CursorStageView
 {
   gboolean needs_emit_painted;
@@ -85,6 +97,10 @@ struct _MetaCursorRendererNativePrivate
 
   guint animation_timeout_id;
 
+  GHashTable *cursor_buffers;
+  gboolean hw_cursors_enabled;
+  guint prewarm_idle_id;
+
   gulong pointer_position_changed_in_impl_handler_id;
   gboolean input_disconnected;
   GMutex input_mutex;
@@ -111,6 +127,29 @@ typedef struct _MetaCursorNativePrivate
   } preprocess_state;
 } MetaCursorNativePrivate;
 
+typedef struct _CursorBufferKey
+{
+  MetaGpuKms *gpu_kms;
+  MetaCursor cursor;
+  char *theme;
+  int theme_size;
+  int theme_scale;
+  int frame;
+  float cursor_scale;
+  MtkMonitorTransform relative_transform;
+  int width;
+  int height;
+  ClutterColorState *color_state;
+} CursorBufferKey;
+
+typedef struct _CachedCursorBuffer
+{
+  CursorBufferKey key;
+  MetaDrmBuffer *buffer;
+  MtkMonitorTransform transform;
+  graphene_point_t hotspot;
+} CachedCursorBuffer;
+
 static GQuark quark_cursor_renderer_native_gpu_data = 0;
 static GQuark quark_cursor_stage_view = 0;
 
@@ -152,6 +191,51 @@ ensure_cursor_stage_view (MetaStageView *view)
   return cursor_stage_view;
 }
 
+static guint
+cursor_buffer_key_hash (gconstpointer data)
+{
+  const CursorBufferKey *key = data;
+
+  return (g_direct_hash (key->gpu_kms) ^
+          (key->theme ? g_str_hash (key->theme) : 0) ^
+          (key->cursor << 24) ^
+          (key->frame << 16) ^
+          (key->theme_scale << 12) ^
+          (key->relative_transform << 8) ^
+          (key->width * 31 + key->height));
+}
+
+static gboolean
+cursor_buffer_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const CursorBufferKey *key_a = a;
+  const CursorBufferKey *key_b = b;
+
+  return (key_a->gpu_kms == key_b->gpu_kms &&
+          key_a->cursor == key_b->cursor &&
+          key_a->theme_size == key_b->theme_size &&
+          key_a->theme_scale == key_b->theme_scale &&
+          key_a->frame == key_b->frame &&
+          G_APPROX_VALUE (key_a->cursor_scale, key_b->cursor_scale,
+                          FLT_EPSILON) &&
+          key_a->relative_transform == key_b->relative_transform &&
+          key_a->width == key_b->width &&
+          key_a->height == key_b->height &&
+          g_strcmp0 (key_a->theme, key_b->theme) == 0 &&
+          clutter_color_state_equals (key_a->color_state,
+                                      key_b->color_state));
+}
+
+static void
+cached_cursor_buffer_free (CachedCursorBuffer *cached_buffer)
+{
+  g_free (cached_buffer->key.theme);
+  g_clear_object (&cached_buffer->key.color_state);
+  g_clear_object (&cached_buffer->buffer);
+  g_free (cached_buffer);
+}
+
 static MetaCursorRendererNativeGpuData *
 meta_cursor_renderer_native_gpu_data_from_gpu (MetaGpuKms *gpu_kms)
 {
@@ -184,6 +268,8 @@ meta_cursor_renderer_native_finalize (GObject *object)
                           priv->current_cursor);
   g_clear_object (&priv->current_cursor);
   g_clear_handle_id (&priv->animation_timeout_id, g_source_remove);
+  g_clear_handle_id (&priv->prewarm_idle_id, g_source_remove);
+  g_clear_pointer (&priv->cursor_buffers, g_hash_table_unref);
 
   G_OBJECT_CLASS (meta_cursor_renderer_native_parent_class)->finalize (object);
 }
@@ -654,30 +740,24 @@ supports_exact_cursor_size (MetaCrtcKms *crtc_kms,
   return FALSE;
 }
 
-static gboolean
-load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
-                                        MetaCrtcKms              *crtc_kms,
-                                        MetaCursorSprite         *cursor_sprite,
-                                        uint8_t                  *pixels,
-                                        uint                      width,
-                                        uint                      height,
-                                        int                       rowstride,
-                                        graphene_point_t         *hotspot,
-                                        MtkMonitorTransform       transform,
-                                        uint32_t                  gbm_format)
+static MetaDrmBuffer *
+create_cursor_sprite_buffer_for_crtc (MetaCursorRendererNative *native,
+                                      MetaCrtcKms              *crtc_kms,
+                                      uint8_t                  *pixels,
+                                      uint                      width,
+                                      uint                      height,
+                                      int                       rowstride,
+                                      uint32_t                  gbm_format)
 {
   MetaCursorRendererNativePrivate *priv =
     meta_cursor_renderer_native_get_instance_private (native);
   MetaBackendNative *backend_native = META_BACKEND_NATIVE (priv->backend);
-  MetaKms *kms = meta_backend_native_get_kms (backend_native);
-  MetaKmsCursorManager *kms_cursor_manager = meta_kms_get_cursor_manager (kms);
   MetaDevicePool *device_pool =
     meta_backend_native_get_device_pool (backend_native);
   MetaGpu *gpu = meta_crtc_get_gpu (META_CRTC (crtc_kms));
   MetaGpuKms *gpu_kms = META_GPU_KMS (gpu);
-  MetaKmsCrtc *kms_crtc;
   uint64_t cursor_width, cursor_height;
-  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  MetaDrmBuffer *buffer;
   g_autoptr (MetaDeviceFile) device_file = NULL;
   g_autoptr (GError) error = NULL;
 
@@ -686,7 +766,7 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
                                 &cursor_width, &cursor_height))
     {
       g_warning_once ("Can't handle cursor size %ux%u", width, height);
-      return FALSE;
+      return NULL;
     }
 
   device_file = meta_device_pool_open (device_pool,
@@ -699,7 +779,7 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
                  meta_gpu_kms_get_file_path (gpu_kms),
                  error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return FALSE;
+      return NULL;
     }
 
   buffer = create_cursor_drm_buffer (gpu_kms, device_file,
@@ -713,16 +793,31 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
     {
       g_warning ("Realizing HW cursor failed: %s", error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return FALSE;
+      return NULL;
     }
 
-  kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  return buffer;
+}
+
+static void
+assign_cursor_buffer_to_crtc (MetaCursorRendererNative *native,
+                              MetaCrtcKms              *crtc_kms,
+                              MetaDrmBuffer            *buffer,
+                              MtkMonitorTransform       transform,
+                              const graphene_point_t   *hotspot)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (priv->backend);
+  MetaKms *kms = meta_backend_native_get_kms (backend_native);
+  MetaKmsCursorManager *kms_cursor_manager = meta_kms_get_cursor_manager (kms);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+
   meta_kms_cursor_manager_update_sprite (kms_cursor_manager,
                                          kms_crtc,
                                          buffer,
                                          transform,
                                          hotspot);
-  return TRUE;
 }
 
 static CoglTexture *
@@ -790,16 +885,45 @@ scale_and_transform_cursor_sprite_cpu (MetaCursorRendererNative *cursor_renderer
   return COGL_TEXTURE (g_steal_pointer (&dst_texture));
 }
 
-static gboolean
-load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
-                                           MetaCrtcKms              *crtc_kms,
-                                           ClutterColorState        *target_color_state,
-                                           MetaCursorSprite         *cursor_sprite,
-                                           uint8_t                  *data,
-                                           int                       width,
-                                           int                       height,
-                                           int                       rowstride,
-                                           uint32_t                  gbm_format)
+static void
+cache_cursor_buffer (MetaCursorRendererNative *native,
+                     const CursorBufferKey    *key,
+                     MetaDrmBuffer            *buffer,
+                     MtkMonitorTransform       transform,
+                     const graphene_point_t   *hotspot)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  CachedCursorBuffer *cached_buffer;
+
+  if (g_hash_table_size (priv->cursor_buffers) >= MAX_CACHED_CURSOR_BUFFERS)
+    g_hash_table_remove_all (priv->cursor_buffers);
+
+  cached_buffer = g_new0 (CachedCursorBuffer, 1);
+  cached_buffer->key = *key;
+  cached_buffer->key.theme = g_strdup (key->theme);
+  g_object_ref (cached_buffer->key.color_state);
+  cached_buffer->buffer = g_object_ref (buffer);
+  cached_buffer->transform = transform;
+  cached_buffer->hotspot = *hotspot;
+
+  g_hash_table_replace (priv->cursor_buffers,
+                        &cached_buffer->key, cached_buffer);
+}
+
+static MetaDrmBuffer *
+create_scaled_and_transformed_cursor_buffer (MetaCursorRendererNative *native,
+                                             MetaCrtcKms              *crtc_kms,
+                                             ClutterColorState        *target_color_state,
+                                             MetaCursorSprite         *cursor_sprite,
+                                             uint8_t                  *data,
+                                             int                       width,
+                                             int                       height,
+                                             int                       rowstride,
+                                             uint32_t                  gbm_format,
+                                             CursorBufferKey          *cache_key,
+                                             MtkMonitorTransform      *out_transform,
+                                             graphene_point_t         *out_hotspot)
 {
   MetaCursorRendererNativePrivate *priv =
     meta_cursor_renderer_native_get_instance_private (native);
@@ -823,7 +947,7 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
   int crtc_dst_width;
   int crtc_dst_height;
   ClutterColorState *cursor_color_state;
-  gboolean retval = FALSE;
+  MetaDrmBuffer *buffer;
   graphene_point_t hotspot;
   int hot_x, hot_y;
 
@@ -906,6 +1030,26 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                                          &hot_x, &hot_y);
   hotspot = GRAPHENE_POINT_INIT (hot_x, hot_y);
 
+  if (cache_key)
+    {
+      CachedCursorBuffer *cached_buffer;
+
+      cache_key->gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
+      cache_key->cursor_scale = cursor_scale;
+      cache_key->relative_transform = relative_transform;
+      cache_key->width = crtc_dst_width;
+      cache_key->height = crtc_dst_height;
+      cache_key->color_state = target_color_state;
+
+      cached_buffer = g_hash_table_lookup (priv->cursor_buffers, cache_key);
+      if (cached_buffer)
+        {
+          *out_transform = cached_buffer->transform;
+          *out_hotspot = cached_buffer->hotspot;
+          return g_object_ref (cached_buffer->buffer);
+        }
+    }
+
   if (width != crtc_dst_width || height != crtc_dst_height ||
       !graphene_matrix_is_identity (&matrix) ||
       gbm_format != GBM_FORMAT_ARGB8888 ||
@@ -920,7 +1064,7 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
 
       format_info = meta_format_info_from_drm_format (gbm_format);
       if (!format_info)
-        return FALSE;
+        return NULL;
 
       texture = scale_and_transform_cursor_sprite_cpu (native,
                                                        target_color_state,
@@ -938,7 +1082,7 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
         {
           g_warning ("Failed to preprocess cursor sprite: %s",
                      error->message);
-          return FALSE;
+          return NULL;
         }
 
       bpp =
@@ -950,33 +1094,70 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                              cursor_rowstride,
                              cursor_data);
 
-      retval =
-        load_cursor_sprite_gbm_buffer_for_crtc (native,
-                                                crtc_kms,
-                                                cursor_sprite,
-                                                cursor_data,
-                                                crtc_dst_width,
-                                                crtc_dst_height,
-                                                cursor_rowstride,
-                                                &hotspot,
-                                                relative_transform,
-                                                GBM_FORMAT_ARGB8888);
+      buffer = create_cursor_sprite_buffer_for_crtc (native,
+                                                     crtc_kms,
+                                                     cursor_data,
+                                                     crtc_dst_width,
+                                                     crtc_dst_height,
+                                                     cursor_rowstride,
+                                                     GBM_FORMAT_ARGB8888);
+      *out_transform = relative_transform;
     }
   else
     {
-      retval = load_cursor_sprite_gbm_buffer_for_crtc (native,
-                                                       crtc_kms,
-                                                       cursor_sprite,
-                                                       data,
-                                                       width,
-                                                       height,
-                                                       rowstride,
-                                                       &hotspot,
-                                                       MTK_MONITOR_TRANSFORM_NORMAL,
-                                                       GBM_FORMAT_ARGB8888);
+      buffer = create_cursor_sprite_buffer_for_crtc (native,
+                                                     crtc_kms,
+                                                     data,
+                                                     width,
+                                                     height,
+                                                     rowstride,
+                                                     GBM_FORMAT_ARGB8888);
+      *out_transform = MTK_MONITOR_TRANSFORM_NORMAL;
     }
 
-  return retval;
+  if (!buffer)
+    return NULL;
+
+  *out_hotspot = hotspot;
+
+  if (cache_key)
+    cache_cursor_buffer (native, cache_key, buffer, *out_transform, &hotspot);
+
+  return buffer;
+}
+
+static gboolean
+load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
+                                           MetaCrtcKms              *crtc_kms,
+                                           ClutterColorState        *target_color_state,
+                                           MetaCursorSprite         *cursor_sprite,
+                                           uint8_t                  *data,
+                                           int                       width,
+                                           int                       height,
+                                           int                       rowstride,
+                                           uint32_t                  gbm_format)
+{
+  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  MtkMonitorTransform transform;
+  graphene_point_t hotspot;
+
+  buffer = create_scaled_and_transformed_cursor_buffer (native,
+                                                        crtc_kms,
+                                                        target_color_state,
+                                                        cursor_sprite,
+                                                        data,
+                                                        width,
+                                                        height,
+                                                        rowstride,
+                                                        gbm_format,
+                                                        NULL,
+                                                        &transform,
+                                                        &hotspot);
+  if (!buffer)
+    return FALSE;
+
+  assign_cursor_buffer_to_crtc (native, crtc_kms, buffer, transform, &hotspot);
+  return TRUE;
 }
 
 #ifdef HAVE_WAYLAND
@@ -1135,6 +1316,47 @@ realize_cursor_sprite_from_wl_buffer_for_crtc (MetaCursorRenderer      *renderer
 }
 #endif /* HAVE_WAYLAND */
 
+/*
+ * Xcursor sprites are recreated on every cursor change, but always render to
+ * the same buffer given the theme image and the scale, transform and color
+ * state of the CRTC, so these buffers are cached and reused.
+ */
+static MetaDrmBuffer *
+ensure_xcursor_buffer_for_crtc (MetaCursorRendererNative *native,
+                                MetaCrtcKms              *crtc_kms,
+                                ClutterColorState        *target_color_state,
+                                MetaCursorSpriteXcursor  *sprite_xcursor,
+                                MtkMonitorTransform      *out_transform,
+                                graphene_point_t         *out_hotspot)
+{
+  MetaCursorSprite *cursor_sprite = META_CURSOR_SPRITE (sprite_xcursor);
+  XcursorImage *xc_image;
+  CursorBufferKey cache_key;
+
+  xc_image = meta_cursor_sprite_xcursor_get_current_image (sprite_xcursor);
+
+  cache_key = (CursorBufferKey) {
+    .cursor = meta_cursor_sprite_xcursor_get_cursor (sprite_xcursor),
+    .theme = (char *) meta_prefs_get_cursor_theme (),
+    .theme_size = meta_prefs_get_cursor_size (),
+    .theme_scale = meta_cursor_sprite_xcursor_get_theme_scale (sprite_xcursor),
+    .frame = meta_cursor_sprite_xcursor_get_current_frame (sprite_xcursor),
+  };
+
+  return create_scaled_and_transformed_cursor_buffer (native,
+                                                      crtc_kms,
+                                                      target_color_state,
+                                                      cursor_sprite,
+                                                      (uint8_t *) xc_image->pixels,
+                                                      xc_image->width,
+                                                      xc_image->height,
+                                                      xc_image->width * 4,
+                                                      GBM_FORMAT_ARGB8888,
+                                                      &cache_key,
+                                                      out_transform,
+                                                      out_hotspot);
+}
+
 static gboolean
 realize_cursor_sprite_from_xcursor_for_crtc (MetaCursorRenderer      *renderer,
                                              MetaCrtcKms             *crtc_kms,
@@ -1142,20 +1364,21 @@ realize_cursor_sprite_from_xcursor_for_crtc (MetaCursorRenderer      *renderer,
                                              MetaCursorSpriteXcursor *sprite_xcursor)
 {
   MetaCursorRendererNative *native = META_CURSOR_RENDERER_NATIVE (renderer);
-  MetaCursorSprite *cursor_sprite = META_CURSOR_SPRITE (sprite_xcursor);
-  XcursorImage *xc_image;
+  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  MtkMonitorTransform transform;
+  graphene_point_t hotspot;
 
-  xc_image = meta_cursor_sprite_xcursor_get_current_image (sprite_xcursor);
+  buffer = ensure_xcursor_buffer_for_crtc (native,
+                                           crtc_kms,
+                                           target_color_state,
+                                           sprite_xcursor,
+                                           &transform,
+                                           &hotspot);
+  if (!buffer)
+    return FALSE;
 
-  return load_scaled_and_transformed_cursor_sprite (native,
-                                                    crtc_kms,
-                                                    target_color_state,
-                                                    cursor_sprite,
-                                                    (uint8_t *) xc_image->pixels,
-                                                    xc_image->width,
-                                                    xc_image->height,
-                                                    xc_image->width * 4,
-                                                    GBM_FORMAT_ARGB8888);
+  assign_cursor_buffer_to_crtc (native, crtc_kms, buffer, transform, &hotspot);
+  return TRUE;
 }
 
 static gboolean
@@ -1218,13 +1441,159 @@ meta_cursor_renderer_native_class_init (MetaCursorRendererNativeClass *klass)
     g_quark_from_static_string ("-meta-cursor-stage-view-native");
 }
 
+static void
+prepare_prewarm_sprite (MetaCursorRendererNative *native,
+                        MetaCursorSpriteXcursor  *sprite_xcursor,
+                        MetaLogicalMonitor       *logical_monitor)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  MetaCursorSprite *cursor_sprite = META_CURSOR_SPRITE (sprite_xcursor);
+  float scale = meta_logical_monitor_get_scale (logical_monitor);
+
+  /* Scale like the root cursor is when on this monitor, see
+   * root_cursor_prepare_at() */
+  if (meta_backend_is_stage_views_scaled (priv->backend))
+    {
+      int cursor_width, cursor_height;
+
+      meta_cursor_sprite_xcursor_set_theme_scale (sprite_xcursor,
+                                                  (int) ceilf (scale));
+      meta_cursor_sprite_realize_texture (cursor_sprite);
+      meta_cursor_sprite_xcursor_get_scaled_image_size (sprite_xcursor,
+                                                        &cursor_width,
+                                                        &cursor_height);
+      meta_cursor_sprite_set_viewport_dst_size (cursor_sprite,
+                                                cursor_width,
+                                                cursor_height);
+    }
+  else
+    {
+      meta_cursor_sprite_xcursor_set_theme_scale (sprite_xcursor, (int) scale);
+      meta_cursor_sprite_set_texture_scale (cursor_sprite, 1.0f);
+    }
+
+  meta_cursor_sprite_realize_texture (cursor_sprite);
+}
+
+static void
+prewarm_cursor_buffers_for_sprite (MetaCursorRendererNative *native,
+                                   MetaCursorSpriteXcursor  *sprite_xcursor)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  MetaRenderer *renderer = meta_backend_get_renderer (priv->backend);
+  GList *l;
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      MetaCrtc *crtc = meta_renderer_view_get_crtc (META_RENDERER_VIEW (view));
+      ClutterColorState *target_color_state =
+        clutter_stage_view_get_output_color_state (view);
+      g_autoptr (MetaDrmBuffer) buffer = NULL;
+      MtkMonitorTransform transform;
+      graphene_point_t hotspot;
+
+      if (!META_IS_CRTC_KMS (crtc) ||
+          !meta_crtc_native_is_hw_cursor_supported (META_CRTC_NATIVE (crtc)))
+        continue;
+
+      buffer = ensure_xcursor_buffer_for_crtc (native,
+                                               META_CRTC_KMS (crtc),
+                                               target_color_state,
+                                               sprite_xcursor,
+                                               &transform,
+                                               &hotspot);
+    }
+}
+
+static gboolean
+prewarm_cursor_buffers (gpointer user_data)
+{
+  MetaCursorRendererNative *native = META_CURSOR_RENDERER_NATIVE (user_data);
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  MetaBackend *backend = priv->backend;
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaCursorTracker *cursor_tracker = meta_backend_get_cursor_tracker (backend);
+  GList *l;
+
+  priv->prewarm_idle_id = 0;
+
+  if (meta_backend_is_hw_cursors_inhibited (backend))
+    return G_SOURCE_REMOVE;
+
+  COGL_TRACE_BEGIN_SCOPED (CursorRendererNativePrewarm,
+                           "Meta::CursorRendererNative::prewarm_cursor_buffers()");
+
+  for (l = meta_monitor_manager_get_logical_monitors (monitor_manager);
+       l;
+       l = l->next)
+    {
+      MetaLogicalMonitor *logical_monitor = l->data;
+      size_t i;
+
+      for (i = 0; i < G_N_ELEMENTS (prewarm_cursors); i++)
+        {
+          g_autoptr (MetaCursorSpriteXcursor) sprite_xcursor = NULL;
+
+          sprite_xcursor = meta_cursor_sprite_xcursor_new (prewarm_cursors[i],
+                                                           cursor_tracker);
+          prepare_prewarm_sprite (native, sprite_xcursor, logical_monitor);
+
+          if (!meta_cursor_sprite_get_cogl_texture (META_CURSOR_SPRITE (sprite_xcursor)))
+            continue;
+
+          prewarm_cursor_buffers_for_sprite (native, sprite_xcursor);
+        }
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+maybe_schedule_prewarm_cursor_buffers (MetaCursorRendererNative *native)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+
+  if (!priv->hw_cursors_enabled || priv->prewarm_idle_id)
+    return;
+
+  priv->prewarm_idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                           prewarm_cursor_buffers,
+                                           native,
+                                           NULL);
+}
+
+static gboolean
+is_cached_cursor_buffer_stale (gpointer key,
+                               gpointer value,
+                               gpointer user_data)
+{
+  CachedCursorBuffer *cached_buffer = value;
+  GList *gpus = user_data;
+
+  return !g_list_find (gpus, cached_buffer->key.gpu_kms);
+}
+
 static void
 on_monitors_changed (MetaMonitorManager       *monitors,
                      MetaCursorRendererNative *native)
 {
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
   MetaCursorRenderer *renderer = META_CURSOR_RENDERER (native);
 
+  g_hash_table_foreach_remove (priv->cursor_buffers,
+                               is_cached_cursor_buffer_stale,
+                               meta_backend_get_gpus (priv->backend));
+
   meta_cursor_renderer_force_update (renderer);
+
+  maybe_schedule_prewarm_cursor_buffers (native);
 }
 
 static void
@@ -1377,6 +1746,9 @@ init_hw_cursor_support (MetaCursorRendererNative *cursor_renderer_native)
   meta_kms_cursor_manager_set_query_func (kms_cursor_manager,
                                           query_cursor_position_in_kms_impl,
                                           seat);
+
+  priv->hw_cursors_enabled = TRUE;
+  maybe_schedule_prewarm_cursor_buffers (cursor_renderer_native);
 }
 
 static void
@@ -1459,4 +1831,12 @@ meta_cursor_renderer_native_new (MetaBackend        *backend,
 static void
 meta_cursor_renderer_native_init (MetaCursorRendererNative *native)
 {
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+
+  priv->cursor_buffers =
+    g_hash_table_new_full (cursor_buffer_key_hash,
+                           cursor_buffer_key_equal,
+                           NULL,
+                           (GDestroyNotify) cached_cursor_buffer_free);
 }
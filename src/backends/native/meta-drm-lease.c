@@ -84,6 +84,10 @@ struct _MetaDrmLeaseManager
    * Value: MetaDrmLease *lease
    */
   GHashTable *leased_connectors;
+  /* Key:   MetaKmsConnector *kms_connector
+   * Value: LeasingKmsAssignment *assignment
+   */
+  GHashTable *reserved_assignments;
 };
 
 G_DEFINE_TYPE (MetaDrmLeaseManager, meta_drm_lease_manager, G_TYPE_OBJECT)
@@ -208,6 +212,114 @@ is_connector_for_lease (MetaKmsConnector *connector)
          is_connector_configured_for_lease (connector);
 }
 
+static gboolean
+has_crtcs_to_spare (MetaKmsDevice *kms_device)
+{
+  GList *crtcs = meta_kms_device_get_crtcs (kms_device);
+  GList *l;
+  unsigned int n_connected = 0;
+
+  for (l = meta_kms_device_get_connectors (kms_device); l; l = l->next)
+    {
+      if (meta_kms_connector_get_current_state (l->data))
+        n_connected++;
+    }
+
+  return n_connected <= g_list_length (crtcs);
+}
+
+/* Non-desktop connectors (i.e. VR headsets) are only ever driven through a
+ * lease, so keep a CRTC and planes set aside for them while they are
+ * available, making leasing them a single ioctl. This is only done while
+ * every connected connector could still get a CRTC of its own, so that the
+ * reservation never takes anything away from the desktop.
+ */
+static void
+reserve_resources_for_connector (MetaDrmLeaseManager *lease_manager,
+                                 MetaKmsConnector    *kms_connector)
+{
+  MetaKmsDevice *kms_device = meta_kms_connector_get_device (kms_connector);
+  LeasingKmsAssignment *assignment;
+  MetaKmsCrtc *crtc;
+  MetaKmsPlane *primary_plane;
+  MetaCrtcKms *crtc_kms;
+
+  if (!meta_kms_connector_is_non_desktop (kms_connector))
+    return;
+
+  if (g_hash_table_contains (lease_manager->reserved_assignments,
+                             kms_connector))
+    return;
+
+  if (!has_crtcs_to_spare (kms_device))
+    return;
+
+  crtc = find_crtc_to_lease (kms_connector);
+  if (!crtc)
+    return;
+
+  primary_plane = find_plane_to_lease (crtc, META_KMS_PLANE_TYPE_PRIMARY);
+  if (!primary_plane)
+    return;
+
+  assignment = g_new0 (LeasingKmsAssignment, 1);
+  assignment->connector = kms_connector;
+  assignment->crtc = crtc;
+  assignment->primary_plane = primary_plane;
+  assignment->cursor_plane = find_plane_to_lease (crtc,
+                                                  META_KMS_PLANE_TYPE_CURSOR);
+
+  crtc_kms = meta_crtc_kms_from_kms_crtc (crtc);
+  meta_kms_crtc_set_is_leased (crtc, TRUE);
+  meta_crtc_kms_assign_planes (crtc_kms,
+                               assignment->primary_plane,
+                               assignment->cursor_plane);
+
+  g_hash_table_insert (lease_manager->reserved_assignments,
+                       kms_connector, assignment);
+}
+
+static void
+release_reserved_resources (MetaDrmLeaseManager *lease_manager,
+                            MetaKmsConnector    *kms_connector)
+{
+  LeasingKmsAssignment *assignment = NULL;
+  MetaCrtcKms *crtc_kms;
+
+  if (!g_hash_table_steal_extended (lease_manager->reserved_assignments,
+                                    kms_connector,
+                                    NULL, (gpointer *) &assignment))
+    return;
+
+  crtc_kms = meta_crtc_kms_from_kms_crtc (assignment->crtc);
+  meta_kms_crtc_set_is_leased (assignment->crtc, FALSE);
+  meta_crtc_kms_assign_planes (crtc_kms, NULL, NULL);
+
+  g_free (assignment);
+}
+
+static void
+update_reservations (MetaDrmLeaseManager *lease_manager)
+{
+  g_autoptr (GList) reserved_connectors = NULL;
+  GList *l;
+
+  reserved_connectors =
+    g_hash_table_get_keys (lease_manager->reserved_assignments);
+  for (l = reserved_connectors; l; l = l->next)
+    {
+      MetaKmsConnector *kms_connector = l->data;
+      MetaKmsDevice *kms_device = meta_kms_connector_get_device (kms_connector);
+
+      if (!g_list_find (lease_manager->connectors, kms_connector) ||
+          !has_crtcs_to_spare (kms_device))
+        release_reserved_resources (lease_manager, kms_connector);
+    }
+
+  for (l = lease_manager->connectors; l; l = l->next)
+    reserve_resources_for_connector (lease_manager, l->data);
+}
+
 static gboolean
 find_resources_to_lease (MetaDrmLeaseManager  *lease_manager,
                          MetaKmsDevice        *kms_device,
@@ -281,6 +393,21 @@ find_resources_to_lease (MetaDrmLeaseManager  *lease_manager,
       MetaKmsCrtc *crtc;
       MetaKmsPlane *primary_plane;
       MetaKmsPlane *cursor_plane;
+      LeasingKmsAssignment *reserved_assignment;
+
+      reserved_assignment =
+        g_hash_table_lookup (lease_manager->reserved_assignments, connector);
+      if (reserved_assignment)
+        {
+          assignment = g_memdup2 (reserved_assignment,
+                                  sizeof (LeasingKmsAssignment));
+          assignments = g_list_append (assignments, assignment);
+          crtcs = g_list_append (crtcs, assignment->crtc);
+          planes = g_list_append (planes, assignment->primary_plane);
+          if (assignment->cursor_plane)
+            planes = g_list_append (planes, assignment->cursor_plane);
+          continue;
+        }
 
       crtc = find_crtc_to_lease (connector);
       if (!crtc)
@@ -520,6 +647,8 @@ set_connectors_as_available (MetaDrmLeaseManager *lease_manager,
       MetaKmsConnector *kms_connector = l->data;
       gboolean is_last_connector_update = (l->next == NULL);
 
+      reserve_resources_for_connector (lease_manager, kms_connector);
+
       g_signal_emit (lease_manager, signals_manager[MANAGER_CONNECTOR_ADDED],
                      0, kms_connector, is_last_connector_update);
     }
@@ -551,6 +680,7 @@ meta_drm_lease_manager_lease_connectors (MetaDrmLeaseManager  *lease_manager,
   g_autoptr (GList) planes = NULL;
   int fd;
   uint32_t lessee_id;
+  GList *l;
 
   if (!find_resources_to_lease (lease_manager,
                                 kms_device, connectors,
@@ -570,6 +700,14 @@ meta_drm_lease_manager_lease_connectors (MetaDrmLeaseManager  *lease_manager,
   lease->kms_device = g_object_ref (kms_device);
   lease->assignments = g_steal_pointer (&assignments);
 
+  for (l = lease->assignments; l; l = l->next)
+    {
+      LeasingKmsAssignment *assignment = l->data;
+
+      g_hash_table_remove (lease_manager->reserved_assignments,
+                           assignment->connector);
+    }
+
   meta_drm_lease_assign (lease);
 
   g_signal_connect_after (lease, "revoked", G_CALLBACK (on_lease_revoked),
@@ -737,6 +875,7 @@ update_resources (MetaDrmLeaseManager *lease_manager)
   update_devices (lease_manager, &added_devices, &removed_devices);
   update_connectors (lease_manager, &added_connectors, &removed_connectors,
                      &leases_to_revoke);
+  update_reservations (lease_manager);
 
   for (l = added_devices; l; l = l->next)
     {
@@ -896,6 +1035,8 @@ meta_drm_lease_manager_constructed (GObject *object)
                            NULL,
                            (GDestroyNotify) g_object_unref);
   lease_manager->leased_connectors = g_hash_table_new (NULL, NULL);
+  lease_manager->reserved_assignments =
+    g_hash_table_new_full (NULL, NULL, NULL, g_free);
 
   update_resources (lease_manager);
 
@@ -950,6 +1091,19 @@ meta_drm_lease_manager_dispose (GObject *object)
   g_clear_signal_handler (&lease_manager->monitors_changed_handler_id,
                           monitor_manager);
 
+  if (lease_manager->reserved_assignments)
+    {
+      g_autoptr (GList) reserved_connectors = NULL;
+      GList *l;
+
+      reserved_connectors =
+        g_hash_table_get_keys (lease_manager->reserved_assignments);
+      for (l = reserved_connectors; l; l = l->next)
+        release_reserved_resources (lease_manager, l->data);
+      g_clear_pointer (&lease_manager->reserved_assignments,
+                       g_hash_table_unref);
+    }
+
   g_list_free_full (g_steal_pointer (&lease_manager->devices), g_object_unref);
   g_list_free_full (g_steal_pointer (&lease_manager->connectors),
                     g_object_unref);
@@ -27,7 +27,9 @@ struct _MetaInputDeviceToolNative
   struct libinput_tablet_tool *tool;
   GHashTable *button_map;
   graphene_point_t pressure_curve[2];
-  MetaBezier *bezier;
+
+  /* The translated pressure, sampled at N_PRESSURECURVE_POINTS intervals */
+  float pressure_map[N_PRESSURECURVE_POINTS + 1];
 };
 
 G_DEFINE_FINAL_TYPE (MetaInputDeviceToolNative, meta_input_device_tool_native,
@@ -40,7 +42,6 @@ meta_input_device_tool_native_finalize (GObject *object)
 
   g_hash_table_unref (tool->button_map);
   libinput_tablet_tool_unref (tool->tool);
-  meta_bezier_free (tool->bezier);
 
   G_OBJECT_CLASS (meta_input_device_tool_native_parent_class)->finalize (object);
 }
@@ -62,15 +63,25 @@ meta_input_device_tool_native_init (MetaInputDeviceToolNative *tool)
 static void
 init_pressurecurve (MetaInputDeviceToolNative *tool)
 {
-  MetaBezier *bezier = meta_bezier_new (N_PRESSURECURVE_POINTS);
+  g_autoptr (MetaBezier) bezier = meta_bezier_new (N_PRESSURECURVE_POINTS);
+  int i;
 
-  g_clear_pointer (&tool->bezier, meta_bezier_free);
   meta_bezier_init (bezier,
                     tool->pressure_curve[0].x,
                     tool->pressure_curve[0].y,
                     tool->pressure_curve[1].x,
                     tool->pressure_curve[1].y);
-  tool->bezier = bezier;
+
+  /* Bake the whole translation into a table, so translating the pressure
+   * of each tool event is a single interpolation between two samples.
+   */
+  for (i = 0; i <= N_PRESSURECURVE_POINTS; i++)
+    {
+      double pressure = (double) i / N_PRESSURECURVE_POINTS;
+
+      tool->pressure_map[i] =
+        (float) (pressure * meta_bezier_lookup (bezier, pressure));
+    }
 }
 
 static ClutterInputAxisFlags
@@ -173,16 +184,19 @@ meta_input_device_tool_native_translate_pressure_in_impl (ClutterInputDeviceTool
                                                           double                  pressure)
 {
   MetaInputDeviceToolNative *evdev_tool;
-  double factor;
+  double pos;
+  int idx;
 
   g_return_val_if_fail (META_IS_INPUT_DEVICE_TOOL_NATIVE (tool), pressure);
 
   evdev_tool = META_INPUT_DEVICE_TOOL_NATIVE (tool);
 
-  pressure = CLAMP (pressure, 0.0, 1.0);
-  factor = meta_bezier_lookup (evdev_tool->bezier, pressure);
+  pos = CLAMP (pressure, 0.0, 1.0) * N_PRESSURECURVE_POINTS;
+  idx = MIN ((int) pos, N_PRESSURECURVE_POINTS - 1);
 
-  return pressure * factor;
+  return (evdev_tool->pressure_map[idx] +
+          (evdev_tool->pressure_map[idx + 1] - evdev_tool->pressure_map[idx]) *
+          (pos - idx));
 }
 
 GDesktopStylusButtonAction
@@ -879,25 +879,20 @@ kms_modes_equal (GList *modes,
                  GList *other_modes)
 {
   GList *l;
+  GList *k;
 
-  if (g_list_length (modes) != g_list_length (other_modes))
-    return FALSE;
-
-  for (l = modes; l; l = l->next)
+  /* The kernel lists the modes of an unchanged connector in the same
+   * order, so comparing them pairwise is enough. */
+  for (l = modes, k = other_modes; l && k; l = l->next, k = k->next)
     {
-      GList *k;
       MetaKmsMode *mode = l->data;
+      MetaKmsMode *other_mode = k->data;
 
-      for (k = other_modes; k; k = k->next)
-        {
-          MetaKmsMode *other_mode = k->data;
-
-          if (!meta_kms_mode_equal (mode, other_mode))
-            return FALSE;
-        }
+      if (!meta_kms_mode_equal (mode, other_mode))
+        return FALSE;
     }
 
-  return TRUE;
+  return !l && !k;
 }
 
 static MetaKmsResourceChanges
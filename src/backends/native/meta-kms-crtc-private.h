@@ -28,6 +28,9 @@ typedef enum _MetaKmsCrtcProp
   META_KMS_CRTC_PROP_ACTIVE,
   META_KMS_CRTC_PROP_GAMMA_LUT,
   META_KMS_CRTC_PROP_GAMMA_LUT_SIZE,
+  META_KMS_CRTC_PROP_DEGAMMA_LUT,
+  META_KMS_CRTC_PROP_DEGAMMA_LUT_SIZE,
+  META_KMS_CRTC_PROP_CTM,
   META_KMS_CRTC_PROP_VRR_ENABLED,
   META_KMS_CRTC_N_PROPS
 } MetaKmsCrtcProp;
@@ -37,6 +37,13 @@ typedef struct _MetaKmsCrtcPropTable
   MetaKmsProp props[META_KMS_CRTC_N_PROPS];
 } MetaKmsCrtcPropTable;
 
+typedef struct _MetaKmsDeadlineEstimate
+{
+  int64_t shortterm_max_duration_us;
+  int64_t evasion_us;
+  int64_t evasion_update_time_us;
+} MetaKmsDeadlineEstimate;
+
 struct _MetaKmsCrtc
 {
   GObject parent;
@@ -52,9 +59,10 @@ struct _MetaKmsCrtc
 
   gboolean is_leased;
 
-  int64_t shortterm_max_dispatch_duration_us;
-  int64_t deadline_evasion_us;
-  int64_t deadline_evasion_update_time_us;
+  /* Updates dispatched by the deadline timer, mostly cursor updates */
+  MetaKmsDeadlineEstimate dispatch_estimate;
+  /* Updates committed as soon as they are ready, i.e. composited frames */
+  MetaKmsDeadlineEstimate commit_estimate;
 };
 
 G_DEFINE_TYPE (MetaKmsCrtc, meta_kms_crtc, G_TYPE_OBJECT)
@@ -222,6 +230,37 @@ read_gamma_state (MetaKmsCrtc       *crtc,
     read_crtc_legacy_gamma (crtc, crtc_state, impl_device, drm_crtc);
 }
 
+static void
+read_color_pipeline_state (MetaKmsCrtc       *crtc,
+                           MetaKmsCrtcState  *crtc_state,
+                           MetaKmsImplDevice *impl_device)
+{
+  MetaKmsProp *prop_degamma_lut;
+  MetaKmsProp *prop_degamma_size;
+  MetaKmsProp *prop_ctm;
+
+  crtc_state->degamma.size = 0;
+  crtc_state->degamma.supported = FALSE;
+  crtc_state->ctm.supported = FALSE;
+
+  if (!META_IS_KMS_IMPL_DEVICE_ATOMIC (impl_device))
+    return;
+
+  prop_degamma_lut = &crtc->prop_table.props[META_KMS_CRTC_PROP_DEGAMMA_LUT];
+  prop_degamma_size =
+    &crtc->prop_table.props[META_KMS_CRTC_PROP_DEGAMMA_LUT_SIZE];
+  prop_ctm = &crtc->prop_table.props[META_KMS_CRTC_PROP_CTM];
+
+  if (prop_degamma_lut->prop_id && prop_degamma_size->prop_id &&
+      prop_degamma_size->value > 0)
+    {
+      crtc_state->degamma.size = (int) prop_degamma_size->value;
+      crtc_state->degamma.supported = TRUE;
+    }
+
+  crtc_state->ctm.supported = prop_ctm->prop_id != 0;
+}
+
 static gboolean
 gamma_equal (MetaKmsCrtcState *state,
              MetaKmsCrtcState *other_state)
@@ -250,6 +289,11 @@ meta_kms_crtc_state_changes (MetaKmsCrtcState *state,
   if (state->vrr.enabled != other_state->vrr.enabled)
     return META_KMS_RESOURCE_CHANGE_FULL;
 
+  if (state->degamma.supported != other_state->degamma.supported ||
+      state->degamma.size != other_state->degamma.size ||
+      state->ctm.supported != other_state->ctm.supported)
+    return META_KMS_RESOURCE_CHANGE_FULL;
+
   if (!gamma_equal (state, other_state))
     return META_KMS_RESOURCE_CHANGE_GAMMA;
 
@@ -298,6 +342,7 @@ meta_kms_crtc_read_state (MetaKmsCrtc             *crtc,
     }
 
   read_gamma_state (crtc, &crtc_state, impl_device, drm_crtc);
+  read_color_pipeline_state (crtc, &crtc_state, impl_device);
 
   if (!crtc_state.is_active)
     {
@@ -475,6 +520,21 @@ init_properties (MetaKmsCrtc       *crtc,
           .name = "GAMMA_LUT_SIZE",
           .type = DRM_MODE_PROP_RANGE,
         },
+      [META_KMS_CRTC_PROP_DEGAMMA_LUT] =
+        {
+          .name = "DEGAMMA_LUT",
+          .type = DRM_MODE_PROP_BLOB,
+        },
+      [META_KMS_CRTC_PROP_DEGAMMA_LUT_SIZE] =
+        {
+          .name = "DEGAMMA_LUT_SIZE",
+          .type = DRM_MODE_PROP_RANGE,
+        },
+      [META_KMS_CRTC_PROP_CTM] =
+        {
+          .name = "CTM",
+          .type = DRM_MODE_PROP_BLOB,
+        },
       [META_KMS_CRTC_PROP_VRR_ENABLED] =
         {
           .name = "VRR_ENABLED",
@@ -567,30 +627,59 @@ get_crtc_type_bitmask (MetaKmsCrtc *crtc)
 }
 
 static void
-maybe_update_deadline_evasion (MetaKmsCrtc *crtc,
-                               int64_t      next_presentation_time_us)
+maybe_update_estimate (MetaKmsDeadlineEstimate *estimate,
+                       int64_t                  next_presentation_time_us)
 {
   /* Do not update long-term max if there has been no measurement */
-  if (!crtc->shortterm_max_dispatch_duration_us)
+  if (!estimate->shortterm_max_duration_us)
     return;
 
-  if (next_presentation_time_us - crtc->deadline_evasion_update_time_us <
+  if (next_presentation_time_us - estimate->evasion_update_time_us <
       G_USEC_PER_SEC)
     return;
 
-  if (crtc->deadline_evasion_us > crtc->shortterm_max_dispatch_duration_us)
+  if (estimate->evasion_us > estimate->shortterm_max_duration_us)
     {
       /* Exponential drop-off toward the clamped short-term max */
-      crtc->deadline_evasion_us -=
-        (crtc->deadline_evasion_us - crtc->shortterm_max_dispatch_duration_us) / 2;
+      estimate->evasion_us -=
+        (estimate->evasion_us - estimate->shortterm_max_duration_us) / 2;
     }
   else
     {
-      crtc->deadline_evasion_us = crtc->shortterm_max_dispatch_duration_us;
+      estimate->evasion_us = estimate->shortterm_max_duration_us;
     }
 
-  crtc->shortterm_max_dispatch_duration_us = 0;
-  crtc->deadline_evasion_update_time_us = next_presentation_time_us;
+  estimate->shortterm_max_duration_us = 0;
+  estimate->evasion_update_time_us = next_presentation_time_us;
+}
+
+static int64_t
+get_estimated_evasion (MetaKmsDeadlineEstimate *estimate)
+{
+  return MAX (estimate->shortterm_max_duration_us, estimate->evasion_us);
+}
+
+static void
+update_shortterm_max_duration (MetaKmsCrtc             *crtc,
+                               MetaKmsDeadlineEstimate *estimate,
+                               int64_t                  duration_us)
+{
+  int64_t refresh_interval_us;
+
+  g_return_if_fail (crtc->current_state.is_drm_mode_valid);
+
+  /* meta_kms_crtc_determine_deadline doesn't use deadline evasion with VRR */
+  if (crtc->current_state.vrr.enabled)
+    return;
+
+  if (duration_us <= estimate->shortterm_max_duration_us)
+    return;
+
+  refresh_interval_us =
+    (int64_t) (0.5 + G_USEC_PER_SEC /
+               meta_calculate_drm_mode_refresh_rate (&crtc->current_state.drm_mode));
+
+  estimate->shortterm_max_duration_us = MIN (duration_us, refresh_interval_us);
 }
 
 gboolean
@@ -664,8 +753,15 @@ meta_kms_crtc_determine_deadline (MetaKmsCrtc  *crtc,
        *
        */
 
-      deadline_evasion_us = meta_kms_crtc_get_deadline_evasion (crtc);
-      maybe_update_deadline_evasion (crtc, next_presentation_us);
+      /* The deadline timer only has to leave room for what it dispatches
+       * itself; composited frames are committed as soon as they are ready,
+       * and are accounted for by the frame clock deadline instead. */
+      deadline_evasion_us = get_estimated_evasion (&crtc->dispatch_estimate);
+      if (deadline_evasion_us)
+        deadline_evasion_us += DEADLINE_EVASION_CONSTANT_US;
+
+      maybe_update_estimate (&crtc->dispatch_estimate, next_presentation_us);
+      maybe_update_estimate (&crtc->commit_estimate, next_presentation_us);
 
       vblank_duration_us = meta_calculate_drm_mode_vblank_duration_us (drm_mode);
       next_deadline_us = next_presentation_us - (vblank_duration_us +
@@ -698,22 +794,14 @@ void
 meta_kms_crtc_update_shortterm_max_dispatch_duration (MetaKmsCrtc *crtc,
                                                       int64_t      duration_us)
 {
-  int64_t refresh_interval_us;
-
-  g_return_if_fail (crtc->current_state.is_drm_mode_valid);
-
-  /* meta_kms_crtc_determine_deadline doesn't use deadline evasion with VRR */
-  if (crtc->current_state.vrr.enabled)
-    return;
-
-  if (duration_us <= crtc->shortterm_max_dispatch_duration_us)
-    return;
-
-  refresh_interval_us =
-    (int64_t) (0.5 + G_USEC_PER_SEC /
-               meta_calculate_drm_mode_refresh_rate (&crtc->current_state.drm_mode));
+  update_shortterm_max_duration (crtc, &crtc->dispatch_estimate, duration_us);
+}
 
-  crtc->shortterm_max_dispatch_duration_us = MIN (duration_us, refresh_interval_us);
+void
+meta_kms_crtc_update_shortterm_max_commit_duration (MetaKmsCrtc *crtc,
+                                                    int64_t      duration_us)
+{
+  update_shortterm_max_duration (crtc, &crtc->commit_estimate, duration_us);
 }
 
 int64_t
@@ -722,7 +810,8 @@ meta_kms_crtc_get_deadline_evasion (MetaKmsCrtc *crtc)
   int64_t deadline_evasion_us;
 
   deadline_evasion_us =
-    MAX (crtc->shortterm_max_dispatch_duration_us, crtc->deadline_evasion_us);
+    MAX (get_estimated_evasion (&crtc->dispatch_estimate),
+         get_estimated_evasion (&crtc->commit_estimate));
 
   if (!deadline_evasion_us)
     return 0;
@@ -44,6 +44,15 @@ typedef struct _MetaKmsCrtcState
     int size;
     gboolean supported;
   } gamma;
+
+  struct {
+    int size;
+    gboolean supported;
+  } degamma;
+
+  struct {
+    gboolean supported;
+  } ctm;
 } MetaKmsCrtcState;
 
 #define META_TYPE_KMS_CRTC (meta_kms_crtc_get_type ())
@@ -71,4 +80,7 @@ gboolean meta_kms_crtc_is_leased (MetaKmsCrtc *crtc);
 void meta_kms_crtc_update_shortterm_max_dispatch_duration (MetaKmsCrtc *crtc,
                                                            int64_t      duration_us);
 
+void meta_kms_crtc_update_shortterm_max_commit_duration (MetaKmsCrtc *crtc,
+                                                        int64_t      duration_us);
+
 int64_t meta_kms_crtc_get_deadline_evasion (MetaKmsCrtc *crtc);
@@ -175,11 +175,12 @@ crtc_state_impl_notify_presented (CrtcStateImpl *crtc_state_impl)
 }
 
 static void
-cursor_page_flip_feedback_flipped (MetaKmsCrtc  *crtc,
-                                   unsigned int  sequence,
-                                   unsigned int  tv_sec,
-                                   unsigned int  tv_usec,
-                                   gpointer      user_data)
+cursor_page_flip_feedback_flipped (MetaKmsCrtc         *crtc,
+                                   unsigned int         sequence,
+                                   unsigned int         tv_sec,
+                                   unsigned int         tv_usec,
+                                   MetaKmsPageFlipFlag  flags,
+                                   gpointer             user_data)
 {
   CrtcStateImpl *crtc_state_impl = user_data;
 
@@ -873,3 +873,20 @@ meta_kms_device_has_connected_builtin_panel (MetaKmsDevice *device)
 
   return FALSE;
 }
+
+int
+meta_kms_device_get_n_connected_connectors (MetaKmsDevice *device)
+{
+  GList *l;
+  int n_connected = 0;
+
+  for (l = device->connectors; l; l = l->next)
+    {
+      MetaKmsConnector *connector = META_KMS_CONNECTOR (l->data);
+
+      if (meta_kms_connector_get_current_state (connector))
+        n_connected++;
+    }
+
+  return n_connected;
+}
@@ -109,3 +109,5 @@ MetaKmsDevice * meta_kms_device_new (MetaKms            *kms,
                                      GError            **error);
 
 gboolean meta_kms_device_has_connected_builtin_panel (MetaKmsDevice *device);
+
+int meta_kms_device_get_n_connected_connectors (MetaKmsDevice *device);
@@ -19,6 +19,8 @@
 
 #include "backends/native/meta-kms-impl-device-atomic.h"
 
+#include <math.h>
+
 #include "backends/native/meta-backend-native-private.h"
 #include "backends/native/meta-kms-connector-private.h"
 #include "backends/native/meta-kms-crtc-private.h"
@@ -41,8 +43,27 @@ struct _MetaKmsImplDeviceAtomic
   MetaKmsImplDevice parent;
 
   GHashTable *page_flip_datas;
+
+  /* MetaKmsPlane -> PlaneState, as last committed */
+  GHashTable *plane_states;
 };
 
+/*
+ * Shadow copy of plane properties that are known to be set in the kernel,
+ * used to leave properties that didn't change out of atomic requests. Only
+ * properties describing the plane geometry are tracked; the framebuffer
+ * and CRTC are always set, so that every request references the CRTC it
+ * flips.
+ */
+typedef struct _PlaneState
+{
+  uint32_t valid_props;
+  uint64_t values[META_KMS_PLANE_N_PROPS];
+
+  /* Only used for pending state, when the plane is disabled */
+  gboolean forget;
+} PlaneState;
+
 static GInitableIface *initable_parent_iface;
 
 static void
@@ -160,6 +181,8 @@ process_connector_update (MetaKmsImplDevice  *impl_device,
 {
   MetaKmsConnectorUpdate *connector_update = update_entry;
   MetaKmsConnector *connector = connector_update->connector;
+  const MetaKmsConnectorState *connector_state =
+    meta_kms_connector_get_current_state (connector);
 
   if (connector_update->underscanning.has_update &&
       connector_update->underscanning.is_active)
@@ -242,7 +265,21 @@ process_connector_update (MetaKmsImplDevice  *impl_device,
         return FALSE;
     }
 
-  if (connector_update->colorspace.has_update)
+  /* Reconfiguring monitors pushes the color space, HDR metadata and RGB
+   * range of all outputs again. Writing a value the connector already has
+   * would at best be a no-op, and for the HDR metadata blob it can make
+   * drivers do a full mode set, so leave those properties alone. */
+  if (connector_update->colorspace.has_update &&
+      connector_state &&
+      connector_state->colorspace.value == connector_update->colorspace.value)
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "[atomic] Keeping colorspace %u on connector %u (%s)",
+                  connector_update->colorspace.value,
+                  meta_kms_connector_get_id (connector),
+                  meta_kms_impl_device_get_path (impl_device));
+    }
+  else if (connector_update->colorspace.has_update)
     {
       meta_topic (META_DEBUG_KMS,
                   "[atomic] Setting colorspace to %u on connector %u (%s)",
@@ -259,7 +296,18 @@ process_connector_update (MetaKmsImplDevice  *impl_device,
         return FALSE;
     }
 
-  if (connector_update->hdr.has_update)
+  if (connector_update->hdr.has_update &&
+      connector_state &&
+      !connector_state->hdr.unknown &&
+      meta_output_hdr_metadata_equal ((MetaOutputHdrMetadata *) &connector_state->hdr.value,
+                                      &connector_update->hdr.value))
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "[atomic] Keeping HDR metadata on connector %u (%s)",
+                  meta_kms_connector_get_id (connector),
+                  meta_kms_impl_device_get_path (impl_device));
+    }
+  else if (connector_update->hdr.has_update)
     {
       uint32_t hdr_blob_id;
 
@@ -292,7 +340,18 @@ process_connector_update (MetaKmsImplDevice  *impl_device,
         return FALSE;
     }
 
-  if (connector_update->broadcast_rgb.has_update)
+  if (connector_update->broadcast_rgb.has_update &&
+      connector_state &&
+      connector_state->broadcast_rgb.value ==
+      connector_update->broadcast_rgb.value)
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "[atomic] Keeping Broadcast RGB %u on connector %u (%s)",
+                  connector_update->broadcast_rgb.value,
+                  meta_kms_connector_get_id (connector),
+                  meta_kms_impl_device_get_path (impl_device));
+    }
+  else if (connector_update->broadcast_rgb.has_update)
     {
       MetaOutputRGBRange rgb_range = connector_update->broadcast_rgb.value;
       uint64_t value = meta_output_rgb_range_to_drm_broadcast_rgb (rgb_range);
@@ -387,6 +446,18 @@ process_crtc_update (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+static gboolean
+is_current_mode (MetaKmsCrtc *crtc,
+                 MetaKmsMode *mode)
+{
+  const MetaKmsCrtcState *crtc_state = meta_kms_crtc_get_current_state (crtc);
+
+  return crtc_state->is_active &&
+         crtc_state->is_drm_mode_valid &&
+         meta_drm_mode_equal (&crtc_state->drm_mode,
+                              meta_kms_mode_get_drm_mode (mode));
+}
+
 static gboolean
 process_mode_set (MetaKmsImplDevice  *impl_device,
                   MetaKmsUpdate      *update,
@@ -403,27 +474,43 @@ process_mode_set (MetaKmsImplDevice  *impl_device,
   mode = (MetaKmsMode *) mode_set->mode;
   if (mode)
     {
-      uint32_t mode_id;
       GList *l;
 
-      mode_id = meta_kms_mode_create_blob_id (mode, error);
-      if (mode_id == 0)
-        return FALSE;
+      /* A new mode blob makes the kernel do a full mode set even when the
+       * mode itself is unchanged, so leave MODE_ID alone in that case. The
+       * connector routing below will still cause a mode set if it changed.
+       */
+      if (is_current_mode (crtc, mode))
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Keeping mode %s of CRTC %u (%s)",
+                      meta_kms_mode_get_name (mode),
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+      else
+        {
+          uint32_t mode_id;
 
-      g_array_append_val (blob_ids, mode_id);
+          mode_id = meta_kms_mode_create_blob_id (mode, error);
+          if (mode_id == 0)
+            return FALSE;
 
-      meta_topic (META_DEBUG_KMS,
-                  "[atomic] Setting mode of CRTC %u (%s) to %s",
-                  meta_kms_crtc_get_id (crtc),
-                  meta_kms_impl_device_get_path (impl_device),
-                  meta_kms_mode_get_name (mode));
+          g_array_append_val (blob_ids, mode_id);
 
-      if (!add_crtc_property (impl_device,
-                              crtc, req,
-                              META_KMS_CRTC_PROP_MODE_ID,
-                              mode_id,
-                              error))
-        return FALSE;
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting mode of CRTC %u (%s) to %s",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device),
+                      meta_kms_mode_get_name (mode));
+
+          if (!add_crtc_property (impl_device,
+                                  crtc, req,
+                                  META_KMS_CRTC_PROP_MODE_ID,
+                                  mode_id,
+                                  error))
+            return FALSE;
+        }
 
       if (!add_crtc_property (impl_device,
                               crtc, req,
@@ -532,6 +619,138 @@ add_plane_property (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+static gboolean
+is_plane_prop_tracked (MetaKmsPlaneProp prop)
+{
+  switch (prop)
+    {
+    case META_KMS_PLANE_PROP_ROTATION:
+    case META_KMS_PLANE_PROP_SRC_X:
+    case META_KMS_PLANE_PROP_SRC_Y:
+    case META_KMS_PLANE_PROP_SRC_W:
+    case META_KMS_PLANE_PROP_SRC_H:
+    case META_KMS_PLANE_PROP_CRTC_X:
+    case META_KMS_PLANE_PROP_CRTC_Y:
+    case META_KMS_PLANE_PROP_CRTC_W:
+    case META_KMS_PLANE_PROP_CRTC_H:
+    case META_KMS_PLANE_PROP_HOTSPOT_X:
+    case META_KMS_PLANE_PROP_HOTSPOT_Y:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static PlaneState *
+ensure_pending_plane_state (GHashTable   *pending_plane_states,
+                            MetaKmsPlane *plane)
+{
+  PlaneState *plane_state;
+
+  plane_state = g_hash_table_lookup (pending_plane_states, plane);
+  if (!plane_state)
+    {
+      plane_state = g_new0 (PlaneState, 1);
+      g_hash_table_insert (pending_plane_states, plane, plane_state);
+    }
+
+  return plane_state;
+}
+
+static gboolean
+add_tracked_plane_property (MetaKmsImplDevice  *impl_device,
+                            MetaKmsUpdate      *update,
+                            MetaKmsPlane       *plane,
+                            drmModeAtomicReq   *req,
+                            GHashTable         *pending_plane_states,
+                            MetaKmsPlaneProp    prop,
+                            uint64_t            value,
+                            GError            **error)
+{
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
+  PlaneState *plane_state;
+
+  if (!is_plane_prop_tracked (prop))
+    return add_plane_property (impl_device, plane, req, prop, value, error);
+
+  /* Mode sets start over from disabled planes, so set everything */
+  if (!meta_kms_update_get_mode_sets (update))
+    {
+      plane_state = g_hash_table_lookup (impl_device_atomic->plane_states,
+                                         plane);
+      if (plane_state &&
+          plane_state->valid_props & (1u << prop) &&
+          plane_state->values[prop] == value)
+        return TRUE;
+    }
+
+  if (!add_plane_property (impl_device, plane, req, prop, value, error))
+    return FALSE;
+
+  plane_state = ensure_pending_plane_state (pending_plane_states, plane);
+  plane_state->valid_props |= 1u << prop;
+  plane_state->values[prop] = value;
+
+  return TRUE;
+}
+
+static void
+commit_plane_states (MetaKmsImplDeviceAtomic *impl_device_atomic,
+                     MetaKmsUpdate           *update,
+                     GHashTable              *pending_plane_states)
+{
+  GHashTableIter iter;
+  MetaKmsPlane *plane;
+  PlaneState *pending_state;
+
+  if (meta_kms_update_get_mode_sets (update))
+    g_hash_table_remove_all (impl_device_atomic->plane_states);
+
+  g_hash_table_iter_init (&iter, pending_plane_states);
+  while (g_hash_table_iter_next (&iter,
+                                 (gpointer *) &plane,
+                                 (gpointer *) &pending_state))
+    {
+      PlaneState *plane_state;
+      int prop;
+
+      if (pending_state->forget)
+        {
+          g_hash_table_remove (impl_device_atomic->plane_states, plane);
+          continue;
+        }
+
+      plane_state = g_hash_table_lookup (impl_device_atomic->plane_states,
+                                         plane);
+      if (!plane_state)
+        {
+          g_hash_table_iter_steal (&iter);
+          g_hash_table_insert (impl_device_atomic->plane_states,
+                               plane, pending_state);
+          continue;
+        }
+
+      for (prop = 0; prop < META_KMS_PLANE_N_PROPS; prop++)
+        {
+          if (!(pending_state->valid_props & (1u << prop)))
+            continue;
+
+          plane_state->values[prop] = pending_state->values[prop];
+        }
+      plane_state->valid_props |= pending_state->valid_props;
+    }
+}
+
+static void
+meta_kms_impl_device_atomic_invalidate_state (MetaKmsImplDevice *impl_device)
+{
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
+
+  g_hash_table_remove_all (impl_device_atomic->plane_states);
+}
+
 static const char *
 get_plane_type_string (MetaKmsPlane *plane)
 {
@@ -548,6 +767,7 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
                           GError            **error)
 {
   MetaKmsPlaneAssignment *plane_assignment = update_entry;
+  GHashTable *pending_plane_states = user_data;
   MetaKmsPlane *plane = plane_assignment->plane;
   MetaDrmBuffer *buffer;
   MetaKmsFbDamage *fb_damage;
@@ -625,30 +845,35 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
 
       for (i = 0; i < G_N_ELEMENTS (props); i++)
         {
-          if (!add_plane_property (impl_device,
-                                   plane, req,
-                                   props[i].prop,
-                                   props[i].value,
-                                   error))
+          if (!add_tracked_plane_property (impl_device, update,
+                                           plane, req,
+                                           pending_plane_states,
+                                           props[i].prop,
+                                           props[i].value,
+                                           error))
             return FALSE;
         }
 
       if (plane_assignment->flags & META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC &&
           !meta_kms_update_get_mode_sets (update))
         {
-          int signaled_sync_file;
+          int in_fence_fd;
 
-          signaled_sync_file =
-            meta_kms_impl_device_get_signaled_sync_file (impl_device);
+          in_fence_fd = plane_assignment->in_fence_fd;
+          if (in_fence_fd < 0)
+            {
+              in_fence_fd =
+                meta_kms_impl_device_get_signaled_sync_file (impl_device);
+            }
 
-          if (signaled_sync_file >= 0)
+          if (in_fence_fd >= 0)
             {
               g_autoptr (GError) local_error = NULL;
 
               if (!add_plane_property (impl_device,
                                        plane, req,
                                        META_KMS_PLANE_PROP_IN_FENCE_FD,
-                                       signaled_sync_file,
+                                       in_fence_fd,
                                        &local_error))
                 {
                   meta_topic (META_DEBUG_KMS,
@@ -680,11 +905,12 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
 
           for (i = 0; i < G_N_ELEMENTS (cursor_props); i++)
             {
-              if (!add_plane_property (impl_device,
-                                       plane, req,
-                                       cursor_props[i].prop,
-                                       cursor_props[i].value,
-                                       error))
+              if (!add_tracked_plane_property (impl_device, update,
+                                               plane, req,
+                                               pending_plane_states,
+                                               cursor_props[i].prop,
+                                               cursor_props[i].value,
+                                               error))
                 return FALSE;
             }
         }
@@ -715,6 +941,9 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
                                    error))
             return FALSE;
         }
+
+      /* Not all ways of disabling a plane preserve its geometry */
+      ensure_pending_plane_state (pending_plane_states, plane)->forget = TRUE;
     }
 
   if (plane_assignment->rotation)
@@ -725,9 +954,10 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
                   meta_kms_impl_device_get_path (impl_device),
                   plane_assignment->rotation);
 
-      if (!add_plane_property (impl_device, plane, req,
-                               META_KMS_PLANE_PROP_ROTATION,
-                               plane_assignment->rotation, error))
+      if (!add_tracked_plane_property (impl_device, update, plane, req,
+                                       pending_plane_states,
+                                       META_KMS_PLANE_PROP_ROTATION,
+                                       plane_assignment->rotation, error))
         return FALSE;
     }
 
@@ -760,6 +990,48 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+static uint32_t
+store_color_lut_blob (MetaKmsImplDevice   *impl_device,
+                      GArray              *blob_ids,
+                      const MetaGammaLut  *lut,
+                      GError             **error)
+{
+  g_autofree struct drm_color_lut *drm_color_lut = NULL;
+  size_t color_lut_size;
+  int i;
+
+  color_lut_size = sizeof (struct drm_color_lut) * lut->size;
+  drm_color_lut = g_malloc (color_lut_size);
+
+  for (i = 0; i < lut->size; i++)
+    {
+      drm_color_lut[i].red = lut->red[i];
+      drm_color_lut[i].green = lut->green[i];
+      drm_color_lut[i].blue = lut->blue[i];
+    }
+
+  return store_new_blob (impl_device,
+                         blob_ids,
+                         drm_color_lut,
+                         color_lut_size,
+                         error);
+}
+
+/* The CTM coefficients are in S31.32 sign-magnitude fixed point */
+static uint64_t
+ctm_coefficient_to_drm (double coefficient)
+{
+  uint64_t magnitude;
+
+  magnitude = (uint64_t) llround (fabs (coefficient) * (double) (1ULL << 32));
+  magnitude &= ~(1ULL << 63);
+
+  if (coefficient < 0.0)
+    return magnitude | (1ULL << 63);
+  else
+    return magnitude;
+}
+
 static gboolean
 process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
                             MetaKmsUpdate      *update,
@@ -779,25 +1051,12 @@ process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
 
       if (gamma && gamma->size > 0)
         {
-          g_autofree struct drm_color_lut *drm_color_lut = NULL;
-          size_t color_lut_size;
-          int i;
-
-          color_lut_size = sizeof(struct drm_color_lut) * gamma->size;
-          drm_color_lut = g_malloc (color_lut_size);
-
-          for (i = 0; i < gamma->size; i++)
-            {
-              drm_color_lut[i].red = gamma->red[i];
-              drm_color_lut[i].green = gamma->green[i];
-              drm_color_lut[i].blue = gamma->blue[i];
-            }
-
-          color_lut_blob_id = store_new_blob (impl_device,
-                                              blob_ids,
-                                              drm_color_lut,
-                                              color_lut_size,
-                                              error);
+          color_lut_blob_id = store_color_lut_blob (impl_device,
+                                                    blob_ids,
+                                                    gamma,
+                                                    error);
+          if (!color_lut_blob_id)
+            return FALSE;
 
           meta_topic (META_DEBUG_KMS,
                       "[atomic] Setting CRTC (%u, %s) gamma, size: %zu",
@@ -821,6 +1080,84 @@ process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
         return FALSE;
     }
 
+  if (color_update->degamma.has_update)
+    {
+      MetaGammaLut *degamma = color_update->degamma.state;
+      uint32_t degamma_lut_blob_id = 0;
+
+      if (degamma && degamma->size > 0)
+        {
+          degamma_lut_blob_id = store_color_lut_blob (impl_device,
+                                                      blob_ids,
+                                                      degamma,
+                                                      error);
+          if (!degamma_lut_blob_id)
+            return FALSE;
+
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) degamma, size: %zu",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device),
+                      degamma->size);
+        }
+      else
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) degamma to bypass",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+
+      if (!add_crtc_property (impl_device,
+                              crtc, req,
+                              META_KMS_CRTC_PROP_DEGAMMA_LUT,
+                              degamma_lut_blob_id,
+                              error))
+        return FALSE;
+    }
+
+  if (color_update->ctm.has_update)
+    {
+      MetaKmsCrtcCtm *ctm = color_update->ctm.state;
+      uint32_t ctm_blob_id = 0;
+
+      if (ctm)
+        {
+          struct drm_color_ctm drm_ctm;
+          size_t i;
+
+          for (i = 0; i < G_N_ELEMENTS (drm_ctm.matrix); i++)
+            drm_ctm.matrix[i] = ctm_coefficient_to_drm (ctm->matrix[i]);
+
+          ctm_blob_id = store_new_blob (impl_device,
+                                        blob_ids,
+                                        &drm_ctm,
+                                        sizeof (drm_ctm),
+                                        error);
+          if (!ctm_blob_id)
+            return FALSE;
+
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) CTM",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+      else
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) CTM to bypass",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+
+      if (!add_crtc_property (impl_device,
+                              crtc, req,
+                              META_KMS_CRTC_PROP_CTM,
+                              ctm_blob_id,
+                              error))
+        return FALSE;
+    }
+
   return TRUE;
 }
 
@@ -836,6 +1173,7 @@ process_page_flip_listener (MetaKmsImplDevice  *impl_device,
   MetaKmsImplDeviceAtomic *impl_device_atomic =
     META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
   MetaKmsPageFlipListener *listener = update_entry;
+  gboolean is_async = GPOINTER_TO_INT (user_data);
   MetaKmsPageFlipData *page_flip_data;
   uint32_t crtc_id;
   gpointer listener_user_data;
@@ -861,6 +1199,8 @@ process_page_flip_listener (MetaKmsImplDevice  *impl_device,
                   page_flip_data);
     }
 
+  meta_kms_page_flip_data_set_async_in_impl (page_flip_data, is_async);
+
   listener_user_data = g_steal_pointer (&listener->user_data);
   listener_destroy_notify = g_steal_pointer (&listener->destroy_notify);
   meta_kms_page_flip_data_add_listener (page_flip_data,
@@ -947,7 +1287,7 @@ static const char *
 commit_flags_string (uint32_t commit_flags)
 {
   static char static_commit_flags_string[255];
-  const char *commit_flag_strings[4] = { NULL };
+  const char *commit_flag_strings[6] = { NULL };
   int i = 0;
   g_autofree char *commit_flags_string = NULL;
 
@@ -959,6 +1299,8 @@ commit_flags_string (uint32_t commit_flags)
     commit_flag_strings[i++] = "PAGE_FLIP_EVENT";
   if (commit_flags & DRM_MODE_ATOMIC_TEST_ONLY)
     commit_flag_strings[i++] = "TEST_ONLY";
+  if (commit_flags & DRM_MODE_PAGE_FLIP_ASYNC)
+    commit_flag_strings[i++] = "PAGE_FLIP_ASYNC";
 
   commit_flags_string = g_strjoinv ("|", (char **) commit_flag_strings);
   strncpy (static_commit_flags_string, commit_flags_string,
@@ -967,6 +1309,67 @@ commit_flags_string (uint32_t commit_flags)
   return static_commit_flags_string;
 }
 
+/* Asynchronous atomic commits may only flip the primary plane */
+static gboolean
+can_flip_async (MetaKmsImplDevice *impl_device,
+                MetaKmsUpdate     *update)
+{
+  const MetaKmsDeviceCaps *caps = meta_kms_impl_device_get_caps (impl_device);
+  GList *l;
+
+  if (!meta_kms_update_get_allow_tearing (update))
+    return FALSE;
+
+  if (!caps->supports_atomic_async_page_flip)
+    return FALSE;
+
+  if (meta_kms_update_get_needs_modeset (update) ||
+      meta_kms_update_get_connector_updates (update) ||
+      meta_kms_update_get_crtc_updates (update) ||
+      meta_kms_update_get_crtc_color_updates (update))
+    return FALSE;
+
+  for (l = meta_kms_update_get_plane_assignments (update); l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+
+      if (meta_kms_plane_get_plane_type (plane_assignment->plane) !=
+          META_KMS_PLANE_TYPE_PRIMARY)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static GList *
+generate_failed_overlay_planes (MetaKmsUpdate *update,
+                                const GError  *error)
+{
+  GList *failed_planes = NULL;
+  GList *l;
+
+  for (l = meta_kms_update_get_plane_assignments (update); l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+      MetaKmsPlaneFeedback *plane_feedback;
+
+      if (meta_kms_plane_get_plane_type (plane_assignment->plane) !=
+          META_KMS_PLANE_TYPE_OVERLAY)
+        continue;
+
+      if (!plane_assignment->buffer)
+        continue;
+
+      plane_feedback =
+        meta_kms_plane_feedback_new_failed (plane_assignment->plane,
+                                            plane_assignment->crtc,
+                                            error->message);
+      failed_planes = g_list_prepend (failed_planes, plane_feedback);
+    }
+
+  return failed_planes;
+}
+
 static gboolean
 disable_connectors (MetaKmsImplDevice  *impl_device,
                     drmModeAtomicReq   *req,
@@ -1069,11 +1472,13 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
   GList *failed_planes = NULL;
   drmModeAtomicReq *req;
   g_autoptr (GArray) blob_ids = NULL;
+  g_autoptr (GHashTable) pending_plane_states = NULL;
   int fd;
   uint32_t commit_flags = 0;
   int ret;
 
   blob_ids = g_array_new (FALSE, TRUE, sizeof (uint32_t));
+  pending_plane_states = g_hash_table_new_full (NULL, NULL, NULL, g_free);
 
   meta_topic (META_DEBUG_KMS, "[atomic] Processing update");
 
@@ -1127,7 +1532,7 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
                         req,
                         blob_ids,
                         meta_kms_update_get_plane_assignments (update),
-                        NULL,
+                        pending_plane_states,
                         process_plane_assignment,
                         &error))
     goto err;
@@ -1152,6 +1557,8 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
 
   if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
     commit_flags |= DRM_MODE_ATOMIC_TEST_ONLY;
+  else if (can_flip_async (impl_device, update))
+    commit_flags |= DRM_MODE_PAGE_FLIP_ASYNC;
 
   meta_topic (META_DEBUG_KMS,
               "[atomic] Committing update flags: %s",
@@ -1159,6 +1566,22 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
 
   fd = meta_kms_impl_device_get_fd (impl_device);
   ret = drmModeAtomicCommit (fd, req, commit_flags, impl_device);
+
+  /* Drivers may refuse asynchronous flips that change more than the
+   * framebuffer, e.g. when the buffer modifier changes; flip on the next
+   * vertical blank instead */
+  if (ret == -EINVAL && (commit_flags & DRM_MODE_PAGE_FLIP_ASYNC))
+    {
+      commit_flags &= ~DRM_MODE_PAGE_FLIP_ASYNC;
+
+      meta_topic (META_DEBUG_KMS,
+                  "[atomic] Asynchronous flip refused, committing update "
+                  "flags: %s",
+                  commit_flags_string (commit_flags));
+
+      ret = drmModeAtomicCommit (fd, req, commit_flags, impl_device);
+    }
+
   if (ret < 0)
     {
       g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (-ret),
@@ -1168,12 +1591,19 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
 
   drmModeAtomicFree (req);
 
+  if (!(flags & META_KMS_UPDATE_FLAG_TEST_ONLY))
+    {
+      commit_plane_states (META_KMS_IMPL_DEVICE_ATOMIC (impl_device),
+                           update,
+                           pending_plane_states);
+    }
+
   process_entries (impl_device,
                    update,
                    req,
                    blob_ids,
                    meta_kms_update_get_page_flip_listeners (update),
-                   NULL,
+                   GINT_TO_POINTER (!!(commit_flags & DRM_MODE_PAGE_FLIP_ASYNC)),
                    process_page_flip_listener,
                    NULL);
 
@@ -1189,6 +1619,13 @@ err:
 
   release_blob_ids (impl_device, blob_ids);
 
+  /* The kernel doesn't tell which plane made a commit fail, but overlay
+   * planes are the optional part of an update, so blame them, letting the
+   * caller retry the same update without them.
+   */
+  if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
+    failed_planes = generate_failed_overlay_planes (update, error);
+
   return meta_kms_feedback_new_failed (failed_planes, error);
 }
 
@@ -1203,6 +1640,8 @@ meta_kms_impl_device_atomic_disable (MetaKmsImplDevice *impl_device)
   meta_topic (META_DEBUG_KMS, "[atomic] Disabling '%s'",
               meta_kms_impl_device_get_path (impl_device));
 
+  meta_kms_impl_device_atomic_invalidate_state (impl_device);
+
   req = drmModeAtomicAlloc ();
   if (!req)
     {
@@ -1285,6 +1724,7 @@ meta_kms_impl_device_atomic_finalize (GObject *object)
   g_assert (g_hash_table_size (impl_device_atomic->page_flip_datas) == 0);
 
   g_hash_table_unref (impl_device_atomic->page_flip_datas);
+  g_hash_table_unref (impl_device_atomic->plane_states);
 
   G_OBJECT_CLASS (meta_kms_impl_device_atomic_parent_class)->finalize (object);
 }
@@ -1438,6 +1878,8 @@ static void
 meta_kms_impl_device_atomic_init (MetaKmsImplDeviceAtomic *impl_device_atomic)
 {
   impl_device_atomic->page_flip_datas = g_hash_table_new (NULL, NULL);
+  impl_device_atomic->plane_states =
+    g_hash_table_new_full (NULL, NULL, NULL, g_free);
 }
 
 static void
@@ -1471,4 +1913,8 @@ meta_kms_impl_device_atomic_class_init (MetaKmsImplDeviceAtomicClass *klass)
     meta_kms_impl_device_atomic_discard_pending_page_flips;
   impl_device_class->prepare_shutdown =
     meta_kms_impl_device_atomic_prepare_shutdown;
+  impl_device_class->invalidate_state =
+    meta_kms_impl_device_atomic_invalidate_state;
+  impl_device_class->supports_multi_crtc_updates = TRUE;
+  impl_device_class->supports_in_fences = TRUE;
 }
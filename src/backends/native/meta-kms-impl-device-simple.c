@@ -624,6 +624,15 @@ process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
         }
     }
 
+  if ((color_update->degamma.has_update && color_update->degamma.state) ||
+      (color_update->ctm.has_update && color_update->ctm.state))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Degamma and CTM not supported on CRTC %u",
+                   meta_kms_crtc_get_id (crtc));
+      return FALSE;
+    }
+
   return TRUE;
 }
 
@@ -1058,22 +1067,45 @@ dispatch_page_flip (MetaKmsImplDevice    *impl_device,
     }
   else
     {
+      const MetaKmsDeviceCaps *caps =
+        meta_kms_impl_device_get_caps (impl_device);
+      uint32_t page_flip_flags = DRM_MODE_PAGE_FLIP_EVENT;
       uint32_t fb_id;
 
       fb_id = meta_drm_buffer_get_fb_id (plane_assignment->buffer);
 
+      if (meta_kms_update_get_allow_tearing (update) &&
+          caps->supports_async_page_flip)
+        page_flip_flags |= DRM_MODE_PAGE_FLIP_ASYNC;
+
       meta_topic (META_DEBUG_KMS,
-                  "[simple] Page flipping CRTC %u (%s) with %u, data: %p",
+                  "[simple] Page flipping CRTC %u (%s) with %u%s, data: %p",
                   meta_kms_crtc_get_id (crtc),
                   meta_kms_impl_device_get_path (impl_device),
                   fb_id,
+                  (page_flip_flags & DRM_MODE_PAGE_FLIP_ASYNC) ?
+                  " asynchronously" : "",
                   page_flip_data);
 
       ret = drmModePageFlip (fd,
                              meta_kms_crtc_get_id (crtc),
                              fb_id,
-                             DRM_MODE_PAGE_FLIP_EVENT,
+                             page_flip_flags,
                              page_flip_data);
+
+      if (ret == -EINVAL && (page_flip_flags & DRM_MODE_PAGE_FLIP_ASYNC))
+        {
+          page_flip_flags &= ~DRM_MODE_PAGE_FLIP_ASYNC;
+          ret = drmModePageFlip (fd,
+                                 meta_kms_crtc_get_id (crtc),
+                                 fb_id,
+                                 page_flip_flags,
+                                 page_flip_data);
+        }
+
+      meta_kms_page_flip_data_set_async_in_impl (page_flip_data,
+                                                 !!(page_flip_flags &
+                                                    DRM_MODE_PAGE_FLIP_ASYNC));
     }
 
   if (ret == -EBUSY)
@@ -1521,6 +1553,17 @@ perform_update_test (MetaKmsImplDevice *impl_device,
           !plane_assignment->buffer)
         continue;
 
+      if (meta_kms_plane_get_plane_type (plane) == META_KMS_PLANE_TYPE_OVERLAY)
+        {
+          MetaKmsPlaneFeedback *plane_feedback;
+
+          plane_feedback =
+            meta_kms_plane_feedback_new_failed (plane, crtc,
+                                                "Overlay planes cannot be assigned");
+          failed_planes = g_list_append (failed_planes, plane_feedback);
+          continue;
+        }
+
       cached_mode_set = get_cached_mode_set (impl_device_simple,
                                              plane_assignment->crtc);
       if (!cached_mode_set)
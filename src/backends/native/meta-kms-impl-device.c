@@ -61,6 +61,10 @@ enum
 
 static GParamSpec *obj_props[N_PROPS];
 
+#define FLUSH_TIMEOUT_FRAMES 2
+
+#define MERGE_UPDATES_WINDOW_US 1000
+
 typedef struct _CrtcDeadline
 {
   MetaKmsImplDevice *impl_device;
@@ -85,6 +89,8 @@ typedef struct _CrtcDeadline
     MetaKmsCrtc *latch_crtc;
     GSource *source;
   } submitted_update;
+
+  GSource *flush_timeout_source;
 } CrtcFrame;
 
 typedef enum _MetaDeadlineTimerState
@@ -558,6 +564,7 @@ init_caps (MetaKmsImplDevice *impl_device)
   uint64_t prefer_shadow;
   uint64_t uses_monotonic_clock;
   uint64_t addfb2_modifiers;
+  uint64_t async_page_flip;
 
   fd = meta_device_file_get_fd (priv->device_file);
   if (drmGetCap (fd, DRM_CAP_CURSOR_WIDTH, &cursor_width) == 0 &&
@@ -585,6 +592,18 @@ init_caps (MetaKmsImplDevice *impl_device)
     {
       priv->caps.addfb2_modifiers = (addfb2_modifiers != 0);
     }
+
+  if (drmGetCap (fd, DRM_CAP_ASYNC_PAGE_FLIP, &async_page_flip) == 0)
+    {
+      priv->caps.supports_async_page_flip = (async_page_flip != 0);
+    }
+
+#ifdef DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP
+  if (drmGetCap (fd, DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP, &async_page_flip) == 0)
+    {
+      priv->caps.supports_atomic_async_page_flip = (async_page_flip != 0);
+    }
+#endif
 }
 
 static void
@@ -1377,11 +1396,12 @@ notify_crtc_frame_ready (CrtcFrame *crtc_frame)
 }
 
 static void
-crtc_page_flip_feedback_flipped (MetaKmsCrtc  *crtc,
-                                 unsigned int  sequence,
-                                 unsigned int  tv_sec,
-                                 unsigned int  tv_usec,
-                                 gpointer      user_data)
+crtc_page_flip_feedback_flipped (MetaKmsCrtc         *crtc,
+                                 unsigned int         sequence,
+                                 unsigned int         tv_sec,
+                                 unsigned int         tv_usec,
+                                 MetaKmsPageFlipFlag  flags,
+                                 gpointer             user_data)
 {
   CrtcFrame *crtc_frame = user_data;
 
@@ -1556,6 +1576,17 @@ do_process (MetaKmsImplDevice *impl_device,
       crtc_frame)
     crtc_frame->pending_page_flip = FALSE;
 
+  if (meta_kms_feedback_get_result (feedback) != META_KMS_FEEDBACK_PASSED &&
+      !(flags & META_KMS_UPDATE_FLAG_TEST_ONLY))
+    {
+      const GError *error = meta_kms_feedback_get_error (feedback);
+
+      COGL_TRACE_MESSAGE ("Meta::KmsImplDevice::process_update()",
+                          "Update on %s failed: %s",
+                          meta_kms_impl_device_get_path (impl_device),
+                          error ? error->message : "unknown error");
+    }
+
   if (!(flags & META_KMS_UPDATE_FLAG_TEST_ONLY))
     changes = meta_kms_impl_device_predict_states (impl_device, update);
 
@@ -1573,6 +1604,97 @@ do_process (MetaKmsImplDevice *impl_device,
   return feedback;
 }
 
+static gboolean
+is_vrr_enabled (MetaKmsCrtc *crtc)
+{
+  return meta_kms_crtc_get_current_state (crtc)->vrr.enabled;
+}
+
+/*
+ * Pending updates of other CRTCs on the same device with a deadline shortly
+ * after the one that just passed are committed together with it, so that
+ * monitors refreshing in sync only cost one atomic commit per refresh.
+ */
+static MetaKmsUpdate *
+merge_simultaneous_updates (MetaKmsImplDevice  *impl_device,
+                            CrtcFrame          *crtc_frame,
+                            MetaKmsUpdate      *update,
+                            GList             **merged_crtc_frames)
+{
+  MetaKmsImplDevicePrivate *priv =
+    meta_kms_impl_device_get_instance_private (impl_device);
+  MetaKmsImplDeviceClass *klass = META_KMS_IMPL_DEVICE_GET_CLASS (impl_device);
+  MetaKmsImpl *impl = meta_kms_impl_device_get_impl (impl_device);
+  MetaThreadImpl *thread_impl = META_THREAD_IMPL (impl);
+  GMainContext *thread_context = meta_thread_impl_get_main_context (thread_impl);
+  GHashTableIter iter;
+  CrtcFrame *other_crtc_frame;
+
+  if (!klass->supports_multi_crtc_updates)
+    return update;
+
+  if (meta_kms_update_get_mode_sets (update) ||
+      is_vrr_enabled (crtc_frame->crtc))
+    return update;
+
+  g_hash_table_iter_init (&iter, priv->crtc_frames);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &other_crtc_frame))
+    {
+      MetaKmsUpdate *other_update;
+      int64_t deadline_delta_us;
+
+      if (other_crtc_frame == crtc_frame ||
+          !other_crtc_frame->pending_update ||
+          !other_crtc_frame->deadline.armed ||
+          other_crtc_frame->pending_page_flip ||
+          other_crtc_frame->await_flush)
+        continue;
+
+      if (meta_kms_update_get_mode_sets (other_crtc_frame->pending_update) ||
+          is_vrr_enabled (other_crtc_frame->crtc))
+        continue;
+
+      deadline_delta_us =
+        other_crtc_frame->deadline.expected_deadline_time_us -
+        crtc_frame->deadline.expected_deadline_time_us;
+      if (deadline_delta_us < 0 ||
+          deadline_delta_us > MERGE_UPDATES_WINDOW_US)
+        continue;
+
+      meta_topic (META_DEBUG_KMS,
+                  "Merging update of CRTC %u into update of CRTC %u (%s), "
+                  "deadline %" G_GINT64_FORMAT " us later",
+                  meta_kms_crtc_get_id (other_crtc_frame->crtc),
+                  meta_kms_crtc_get_id (crtc_frame->crtc),
+                  priv->path,
+                  deadline_delta_us);
+
+      other_update = g_steal_pointer (&other_crtc_frame->pending_update);
+      other_update = meta_kms_impl_filter_update (impl,
+                                                  other_crtc_frame->crtc,
+                                                  other_update,
+                                                  META_KMS_UPDATE_FLAG_NONE);
+      if (other_update)
+        {
+          meta_kms_update_merge_from (update, other_update);
+          meta_kms_update_free (other_update);
+        }
+
+      meta_kms_update_add_page_flip_listener (update,
+                                              other_crtc_frame->crtc,
+                                              &crtc_page_flip_listener_vtable,
+                                              thread_context,
+                                              other_crtc_frame, NULL);
+      other_crtc_frame->pending_page_flip = TRUE;
+      disarm_crtc_frame_deadline_timer (other_crtc_frame);
+
+      *merged_crtc_frames = g_list_prepend (*merged_crtc_frames,
+                                            other_crtc_frame);
+    }
+
+  return update;
+}
+
 static gpointer
 crtc_frame_deadline_dispatch (MetaThreadImpl  *thread_impl,
                               gpointer         user_data,
@@ -1583,9 +1705,12 @@ crtc_frame_deadline_dispatch (MetaThreadImpl  *thread_impl,
   MetaKmsDevice *device = meta_kms_crtc_get_device (crtc);
   MetaKmsImplDevice *impl_device = meta_kms_device_get_impl_device (device);
   g_autoptr (MetaKmsFeedback) feedback = NULL;
+  g_autoptr (GList) merged_crtc_frames = NULL;
+  MetaKmsUpdate *update;
   uint64_t timer_value;
   ssize_t ret;
   int64_t dispatch_time_us = 0, update_done_time_us, interval_us;
+  GList *l;
 
   if (meta_is_topic_enabled (META_DEBUG_KMS_DEADLINE))
     dispatch_time_us = g_get_monotonic_time ();
@@ -1606,11 +1731,28 @@ crtc_frame_deadline_dispatch (MetaThreadImpl  *thread_impl,
       return GINT_TO_POINTER (FALSE);
     }
 
+  update = g_steal_pointer (&crtc_frame->pending_update);
+  if (update)
+    {
+      update = merge_simultaneous_updates (impl_device, crtc_frame, update,
+                                           &merged_crtc_frames);
+    }
+
   feedback = do_process (impl_device,
                          crtc_frame->crtc,
-                         g_steal_pointer (&crtc_frame->pending_update),
+                         update,
                          META_KMS_UPDATE_FLAG_NONE);
 
+  for (l = merged_crtc_frames; l; l = l->next)
+    {
+      CrtcFrame *merged_crtc_frame = l->data;
+
+      if (meta_kms_feedback_did_pass (feedback))
+        merged_crtc_frame->deadline.is_deadline_page_flip = TRUE;
+      else
+        merged_crtc_frame->pending_page_flip = FALSE;
+    }
+
   update_done_time_us = g_get_monotonic_time ();
   /* Calculate how long after the planned start of deadline dispatch it finished */
   interval_us = update_done_time_us - crtc_frame->deadline.expected_deadline_time_us;
@@ -1661,9 +1803,20 @@ crtc_frame_deadline_dispatch (MetaThreadImpl  *thread_impl,
   return GINT_TO_POINTER (TRUE);
 }
 
+static void
+disarm_crtc_frame_flush_timeout (CrtcFrame *crtc_frame)
+{
+  if (!crtc_frame->flush_timeout_source)
+    return;
+
+  g_source_destroy (crtc_frame->flush_timeout_source);
+  g_clear_pointer (&crtc_frame->flush_timeout_source, g_source_unref);
+}
+
 static void
 crtc_frame_free (CrtcFrame *crtc_frame)
 {
+  disarm_crtc_frame_flush_timeout (crtc_frame);
   g_clear_fd (&crtc_frame->deadline.timer_fd, NULL);
   g_clear_pointer (&crtc_frame->deadline.source, g_source_destroy);
   g_clear_pointer (&crtc_frame->pending_update, meta_kms_update_free);
@@ -1799,6 +1952,8 @@ meta_kms_impl_device_update_ready (MetaThreadImpl  *impl,
   MetaKmsUpdate *update;
   MetaKmsCrtc *latch_crtc;
   MetaKmsFeedback *feedback;
+  gboolean measure_commit;
+  int64_t commit_start_time_us = 0;
 
   meta_assert_in_kms_impl (meta_kms_impl_get_kms (priv->impl));
 
@@ -1832,9 +1987,26 @@ meta_kms_impl_device_update_ready (MetaThreadImpl  *impl,
     }
 
   meta_kms_device_handle_flush (priv->device, latch_crtc);
+  disarm_crtc_frame_flush_timeout (crtc_frame);
+
+  /* Mode sets take much longer than regular commits, and would throw off
+   * the estimate used for the frame clock deadline */
+  measure_commit = (latch_crtc &&
+                    is_using_deadline_timer (impl_device) &&
+                    !meta_kms_update_get_mode_sets (update));
+  if (measure_commit)
+    commit_start_time_us = g_get_monotonic_time ();
 
   feedback = do_process (impl_device, latch_crtc, update, crtc_frame->submitted_update.flags);
 
+  if (measure_commit &&
+      meta_kms_feedback_did_pass (feedback) &&
+      meta_kms_crtc_get_current_state (latch_crtc)->is_drm_mode_valid)
+    {
+      meta_kms_crtc_update_shortterm_max_commit_duration (
+        latch_crtc, g_get_monotonic_time () - commit_start_time_us);
+    }
+
   if (meta_kms_feedback_did_pass (feedback) &&
       crtc_frame->deadline.armed)
     disarm_crtc_frame_deadline_timer (crtc_frame);
@@ -1866,6 +2038,7 @@ meta_kms_impl_device_handle_update (MetaKmsImplDevice *impl_device,
 {
   MetaKmsImplDevicePrivate *priv =
     meta_kms_impl_device_get_instance_private (impl_device);
+  MetaKmsImplDeviceClass *klass = META_KMS_IMPL_DEVICE_GET_CLASS (impl_device);
   MetaKmsImpl *kms_impl = meta_kms_impl_device_get_impl (impl_device);
   MetaThreadImpl *thread_impl = META_THREAD_IMPL (kms_impl);
   g_autoptr (GError) error = NULL;
@@ -1910,7 +2083,36 @@ meta_kms_impl_device_handle_update (MetaKmsImplDevice *impl_device,
   crtc_frame->submitted_update.latch_crtc = latch_crtc;
 
   if (is_using_deadline_timer (impl_device))
-    sync_fd = meta_kms_update_get_sync_fd (update);
+    {
+      sync_fd = meta_kms_update_get_sync_fd (update);
+    }
+  else if (klass->supports_in_fences &&
+           meta_kms_update_get_sync_fd (update) >= 0 &&
+           !meta_kms_update_get_mode_sets (update))
+    {
+      GList *l;
+
+      /* Without a deadline timer, nothing waits for rendering to finish
+       * before committing, so hand the fence to the kernel as IN_FENCE_FD
+       * instead of relying on implicit synchronization, which some drivers
+       * serialize with other work on the buffer. The fence is kept with
+       * each plane assignment, so that it survives merging updates of
+       * other CRTCs into this one. */
+      for (l = meta_kms_update_get_plane_assignments (update); l; l = l->next)
+        {
+          MetaKmsPlaneAssignment *assignment = l->data;
+
+          if (!assignment->buffer || assignment->in_fence_fd >= 0)
+            continue;
+
+          assignment->in_fence_fd =
+            fcntl (meta_kms_update_get_sync_fd (update), F_DUPFD_CLOEXEC, 0);
+          if (assignment->in_fence_fd < 0)
+            continue;
+
+          assignment->flags |= META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC;
+        }
+    }
 
   if (sync_fd >= 0)
     {
@@ -1999,6 +2201,85 @@ ensure_deadline_timer_armed (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+static int64_t
+calculate_flush_timeout_us (MetaKmsCrtc *crtc)
+{
+  const MetaKmsCrtcState *crtc_state = meta_kms_crtc_get_current_state (crtc);
+  float refresh_rate = 0.0f;
+
+  if (crtc_state->is_drm_mode_valid)
+    refresh_rate = meta_calculate_drm_mode_refresh_rate (&crtc_state->drm_mode);
+
+  if (refresh_rate <= 0.0f)
+    refresh_rate = 60.0f;
+
+  return (int64_t) (FLUSH_TIMEOUT_FRAMES * G_USEC_PER_SEC / refresh_rate);
+}
+
+static gboolean
+crtc_frame_flush_timeout (gpointer user_data)
+{
+  CrtcFrame *crtc_frame = user_data;
+  MetaKmsCrtc *crtc = crtc_frame->crtc;
+  MetaKmsImplDevice *impl_device = crtc_frame->impl_device;
+  MetaKmsImplDevicePrivate *priv =
+    meta_kms_impl_device_get_instance_private (impl_device);
+  g_autoptr (MetaKmsFeedback) feedback = NULL;
+
+  if (crtc_frame->pending_page_flip ||
+      crtc_frame->submitted_update.kms_update)
+    {
+      g_source_set_ready_time (crtc_frame->flush_timeout_source,
+                               g_get_monotonic_time () +
+                               calculate_flush_timeout_us (crtc));
+      return G_SOURCE_CONTINUE;
+    }
+
+  g_clear_pointer (&crtc_frame->flush_timeout_source, g_source_unref);
+
+  if (crtc_frame->await_flush)
+    return G_SOURCE_REMOVE;
+
+  if (!meta_kms_device_handle_flush (priv->device, crtc))
+    return G_SOURCE_REMOVE;
+
+  meta_topic (META_DEBUG_KMS,
+              "No flush on CRTC %u (%s) in time, processing without it",
+              meta_kms_crtc_get_id (crtc),
+              priv->path);
+
+  feedback = do_process (impl_device, crtc, NULL, META_KMS_UPDATE_FLAG_NONE);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Without a deadline timer, updates coming from the impl side itself, such
+ * as cursor movements, are flushed by the main thread together with its
+ * next frame. Make sure they are still processed if the main thread is too
+ * busy to do so in time, so that e.g. the hardware cursor keeps moving.
+ */
+static void
+ensure_flush_timeout (MetaKmsImplDevice *impl_device,
+                      CrtcFrame         *crtc_frame)
+{
+  MetaKmsImpl *impl = meta_kms_impl_device_get_impl (impl_device);
+  MetaThreadImpl *thread_impl = META_THREAD_IMPL (impl);
+  GSource *source;
+
+  if (crtc_frame->flush_timeout_source)
+    return;
+
+  source = meta_thread_impl_add_source (thread_impl,
+                                        crtc_frame_flush_timeout,
+                                        crtc_frame, NULL);
+  g_source_set_ready_time (source,
+                           g_get_monotonic_time () +
+                           calculate_flush_timeout_us (crtc_frame->crtc));
+
+  crtc_frame->flush_timeout_source = source;
+}
+
 void
 meta_kms_impl_device_schedule_process (MetaKmsImplDevice *impl_device,
                                        MetaKmsCrtc       *crtc)
@@ -2040,6 +2321,7 @@ meta_kms_impl_device_schedule_process (MetaKmsImplDevice *impl_device,
 
 needs_flush:
   meta_kms_device_set_needs_flush (meta_kms_crtc_get_device (crtc), crtc);
+  ensure_flush_timeout (impl_device, crtc_frame);
 }
 
 static void
@@ -2060,6 +2342,7 @@ disarm_all_frame_sources (MetaKmsImplDevice *impl_device)
       crtc_frame->pending_page_flip = FALSE;
       g_clear_pointer (&crtc_frame->pending_update, meta_kms_update_free);
       disarm_crtc_frame_deadline_timer (crtc_frame);
+      disarm_crtc_frame_flush_timeout (crtc_frame);
 
       submitted_update =
         g_steal_pointer (&crtc_frame->submitted_update.kms_update);
@@ -2227,8 +2510,14 @@ meta_kms_impl_device_unhold_fd (MetaKmsImplDevice *impl_device)
   priv->fd_hold_count--;
   if (priv->fd_hold_count == 0)
     {
+      MetaKmsImplDeviceClass *klass =
+        META_KMS_IMPL_DEVICE_GET_CLASS (impl_device);
+
       g_clear_pointer (&priv->device_file, meta_device_file_release);
       clear_fd_source (impl_device);
+
+      if (klass->invalidate_state)
+        klass->invalidate_state (impl_device);
     }
 }
 
@@ -2374,9 +2663,14 @@ meta_kms_impl_device_resume (MetaKmsImplDevice *impl_device)
 {
   MetaKmsImplDevicePrivate *priv =
     meta_kms_impl_device_get_instance_private (impl_device);
+  MetaKmsImplDeviceClass *klass = META_KMS_IMPL_DEVICE_GET_CLASS (impl_device);
 
   if (priv->deadline_timer_state == META_DEADLINE_TIMER_STATE_INHIBITED)
     priv->deadline_timer_state = META_DEADLINE_TIMER_STATE_ENABLED;
+
+  /* Someone else may have changed the state while we were away */
+  if (klass->invalidate_state)
+    klass->invalidate_state (impl_device);
 }
 
 void
@@ -38,6 +38,8 @@ typedef struct _MetaKmsDeviceCaps
   gboolean prefers_shadow_buffer;
   gboolean uses_monotonic_clock;
   gboolean addfb2_modifiers;
+  gboolean supports_async_page_flip;
+  gboolean supports_atomic_async_page_flip;
 } MetaKmsDeviceCaps;
 
 
@@ -95,6 +97,10 @@ struct _MetaKmsImplDeviceClass
                                       MetaKmsPageFlipData *page_flip_data);
   void (* discard_pending_page_flips) (MetaKmsImplDevice *impl_device);
   void (* prepare_shutdown) (MetaKmsImplDevice *impl_device);
+  void (* invalidate_state) (MetaKmsImplDevice *impl_device);
+
+  gboolean supports_multi_crtc_updates;
+  gboolean supports_in_fences;
 };
 
 enum
@@ -47,6 +47,7 @@ struct _MetaKmsPageFlipData
   unsigned int sec;
   unsigned int usec;
 
+  gboolean is_async;
   gboolean is_symbolic;
 
   GError *error;
@@ -167,10 +168,16 @@ invoke_page_flip_closure_flipped (MetaThread *thread,
     }
   else
     {
+      MetaKmsPageFlipFlag flags = META_KMS_PAGE_FLIP_FLAG_NONE;
+
+      if (page_flip_data->is_async)
+        flags |= META_KMS_PAGE_FLIP_FLAG_ASYNC;
+
       closure->vtable->flipped (page_flip_data->crtc,
                                 page_flip_data->sequence,
                                 page_flip_data->sec,
                                 page_flip_data->usec,
+                                flags,
                                 closure->user_data);
     }
 }
@@ -210,6 +217,17 @@ meta_kms_page_flip_data_make_symbolic (MetaKmsPageFlipData *page_flip_data)
   page_flip_data->is_symbolic = TRUE;
 }
 
+void
+meta_kms_page_flip_data_set_async_in_impl (MetaKmsPageFlipData *page_flip_data,
+                                           gboolean             is_async)
+{
+  MetaKms *kms = meta_kms_from_impl_device (page_flip_data->impl_device);
+
+  meta_assert_in_kms_impl (kms);
+
+  page_flip_data->is_async = is_async;
+}
+
 void
 meta_kms_page_flip_data_flipped_in_impl (MetaKmsPageFlipData *page_flip_data)
 {
@@ -35,6 +35,16 @@ typedef struct _MetaKmsCrtcColorUpdate
     gboolean has_update;
     MetaGammaLut *state;
   } gamma;
+
+  struct {
+    gboolean has_update;
+    MetaGammaLut *state;
+  } degamma;
+
+  struct {
+    gboolean has_update;
+    MetaKmsCrtcCtm *state;
+  } ctm;
 } MetaKmsCrtcColorUpdate;
 
 typedef struct _MetaKmsFeedback
@@ -64,6 +74,7 @@ typedef struct _MetaKmsPlaneAssignment
   MetaKmsAssignPlaneFlag flags;
   MetaKmsFbDamage *fb_damage;
   MetaKmsPlaneRotation rotation;
+  int in_fence_fd;
 
   struct {
     gboolean has_update;
@@ -225,6 +236,8 @@ void meta_kms_page_flip_listener_unref (MetaKmsPageFlipListener *listener);
 
 gboolean meta_kms_update_is_empty (MetaKmsUpdate *update);
 
+gboolean meta_kms_update_get_allow_tearing (MetaKmsUpdate *update);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaKmsPlaneFeedback,
                                meta_kms_plane_feedback_free)
 
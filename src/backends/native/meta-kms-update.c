@@ -52,6 +52,8 @@ struct _MetaKmsUpdate
 
   gboolean needs_modeset;
 
+  gboolean allow_tearing;
+
   MetaKmsImplDevice *impl_device;
 
   int sync_fd;
@@ -195,6 +197,7 @@ static void
 meta_kms_plane_assignment_free (MetaKmsPlaneAssignment *plane_assignment)
 {
   g_clear_pointer (&plane_assignment->fb_damage, meta_kms_fb_damage_free);
+  g_clear_fd (&plane_assignment->in_fence_fd, NULL);
   g_free (plane_assignment);
 }
 
@@ -301,6 +304,7 @@ meta_kms_update_assign_plane (MetaKmsUpdate          *update,
     .src_rect = src_rect,
     .dst_rect = dst_rect,
     .flags = flags,
+    .in_fence_fd = -1,
   };
 
   update->plane_assignments = g_list_prepend (update->plane_assignments,
@@ -329,6 +333,7 @@ meta_kms_update_unassign_plane (MetaKmsUpdate *update,
     .crtc = crtc,
     .plane = plane,
     .buffer = NULL,
+    .in_fence_fd = -1,
   };
 
   update->plane_assignments = g_list_prepend (update->plane_assignments,
@@ -571,11 +576,62 @@ meta_kms_update_set_crtc_gamma (MetaKmsUpdate      *update,
   update_latch_crtc (update, crtc);
 }
 
+void
+meta_kms_update_set_crtc_degamma (MetaKmsUpdate      *update,
+                                  MetaKmsCrtc        *crtc,
+                                  const MetaGammaLut *degamma)
+{
+  MetaKmsCrtcColorUpdate *color_update;
+  MetaGammaLut *degamma_update = NULL;
+  const MetaKmsCrtcState *crtc_state = meta_kms_crtc_get_current_state (crtc);
+
+  g_assert (meta_kms_crtc_get_device (crtc) == update->device);
+  g_return_if_fail (!degamma || crtc_state->degamma.supported);
+
+  if (degamma)
+    {
+      degamma_update = meta_gamma_lut_copy_to_size (degamma,
+                                                    crtc_state->degamma.size);
+    }
+
+  color_update = ensure_color_update (update, crtc);
+  if (color_update->degamma.has_update)
+    g_clear_pointer (&color_update->degamma.state, meta_gamma_lut_free);
+  color_update->degamma.state = degamma_update;
+  color_update->degamma.has_update = TRUE;
+
+  update_latch_crtc (update, crtc);
+}
+
+void
+meta_kms_update_set_crtc_ctm (MetaKmsUpdate        *update,
+                              MetaKmsCrtc          *crtc,
+                              const MetaKmsCrtcCtm *ctm)
+{
+  MetaKmsCrtcColorUpdate *color_update;
+  const MetaKmsCrtcState *crtc_state = meta_kms_crtc_get_current_state (crtc);
+
+  g_assert (meta_kms_crtc_get_device (crtc) == update->device);
+  g_return_if_fail (!ctm || crtc_state->ctm.supported);
+
+  color_update = ensure_color_update (update, crtc);
+  if (color_update->ctm.has_update)
+    g_clear_pointer (&color_update->ctm.state, g_free);
+  color_update->ctm.state = ctm ? g_memdup2 (ctm, sizeof (*ctm)) : NULL;
+  color_update->ctm.has_update = TRUE;
+
+  update_latch_crtc (update, crtc);
+}
+
 static void
 meta_kms_crtc_color_updates_free (MetaKmsCrtcColorUpdate *color_update)
 {
   if (color_update->gamma.has_update)
     g_clear_pointer (&color_update->gamma.state, meta_gamma_lut_free);
+  if (color_update->degamma.has_update)
+    g_clear_pointer (&color_update->degamma.state, meta_gamma_lut_free);
+  if (color_update->ctm.has_update)
+    g_clear_pointer (&color_update->ctm.state, g_free);
   g_free (color_update);
 }
 
@@ -958,11 +1014,36 @@ merge_crtc_color_updates_from (MetaKmsUpdate *update,
       el = find_color_update_link_for (update, crtc);
       if (el)
         {
-          meta_kms_crtc_color_updates_free (el->data);
-          update->crtc_color_updates =
-            g_list_insert_before_link (update->crtc_color_updates, el, l);
-          update->crtc_color_updates =
-            g_list_delete_link (update->crtc_color_updates, el);
+          MetaKmsCrtcColorUpdate *crtc_color_update = el->data;
+
+          if (other_crtc_color_update->gamma.has_update)
+            {
+              if (crtc_color_update->gamma.has_update)
+                g_clear_pointer (&crtc_color_update->gamma.state,
+                                 meta_gamma_lut_free);
+              crtc_color_update->gamma = other_crtc_color_update->gamma;
+              other_crtc_color_update->gamma.has_update = FALSE;
+            }
+
+          if (other_crtc_color_update->degamma.has_update)
+            {
+              if (crtc_color_update->degamma.has_update)
+                g_clear_pointer (&crtc_color_update->degamma.state,
+                                 meta_gamma_lut_free);
+              crtc_color_update->degamma = other_crtc_color_update->degamma;
+              other_crtc_color_update->degamma.has_update = FALSE;
+            }
+
+          if (other_crtc_color_update->ctm.has_update)
+            {
+              if (crtc_color_update->ctm.has_update)
+                g_clear_pointer (&crtc_color_update->ctm.state, g_free);
+              crtc_color_update->ctm = other_crtc_color_update->ctm;
+              other_crtc_color_update->ctm.has_update = FALSE;
+            }
+
+          meta_kms_crtc_color_updates_free (other_crtc_color_update);
+          g_list_free_1 (l);
         }
       else
         {
@@ -1143,6 +1224,10 @@ meta_kms_update_merge_from (MetaKmsUpdate *update,
   merge_page_flip_listeners_from (update, other_update);
   merge_result_listeners_from (update, other_update);
 
+  /* Only flip asynchronously if everything that ends up in the update
+   * was meant to be */
+  update->allow_tearing = update->allow_tearing && other_update->allow_tearing;
+
   meta_kms_update_set_sync_fd (update, g_steal_fd (&other_update->sync_fd));
 }
 
@@ -1227,6 +1312,19 @@ meta_kms_update_set_sync_fd (MetaKmsUpdate *update,
   update->sync_fd = sync_fd;
 }
 
+void
+meta_kms_update_set_allow_tearing (MetaKmsUpdate *update,
+                                   gboolean       allow_tearing)
+{
+  update->allow_tearing = allow_tearing;
+}
+
+gboolean
+meta_kms_update_get_allow_tearing (MetaKmsUpdate *update)
+{
+  return update->allow_tearing;
+}
+
 gboolean
 meta_kms_update_is_empty (MetaKmsUpdate *update)
 {
@@ -42,13 +42,20 @@ typedef enum _MetaKmsAssignPlaneFlag
   META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC = 1 << 2,
 } MetaKmsAssignPlaneFlag;
 
+typedef enum _MetaKmsPageFlipFlag
+{
+  META_KMS_PAGE_FLIP_FLAG_NONE = 0,
+  META_KMS_PAGE_FLIP_FLAG_ASYNC = 1 << 0,
+} MetaKmsPageFlipFlag;
+
 struct _MetaKmsPageFlipListenerVtable
 {
-  void (* flipped) (MetaKmsCrtc  *crtc,
-                    unsigned int  sequence,
-                    unsigned int  tv_sec,
-                    unsigned int  tv_usec,
-                    gpointer      user_data);
+  void (* flipped) (MetaKmsCrtc         *crtc,
+                    unsigned int         sequence,
+                    unsigned int         tv_sec,
+                    unsigned int         tv_usec,
+                    MetaKmsPageFlipFlag  flags,
+                    gpointer             user_data);
 
   void (* ready) (MetaKmsCrtc *crtc,
                   gpointer     user_data);
@@ -61,6 +68,12 @@ struct _MetaKmsPageFlipListenerVtable
                       const GError *error);
 };
 
+/* Row major 3x3 matrix, applied to linear RGB values */
+typedef struct _MetaKmsCrtcCtm
+{
+  double matrix[9];
+} MetaKmsCrtcCtm;
+
 typedef int (* MetaKmsCustomPageFlipFunc) (gpointer custom_page_flip_data,
                                            gpointer user_data);
 
@@ -157,6 +170,16 @@ void meta_kms_update_set_crtc_gamma (MetaKmsUpdate      *update,
                                      MetaKmsCrtc        *crtc,
                                      const MetaGammaLut *gamma);
 
+META_EXPORT_TEST
+void meta_kms_update_set_crtc_degamma (MetaKmsUpdate      *update,
+                                       MetaKmsCrtc        *crtc,
+                                       const MetaGammaLut *degamma);
+
+META_EXPORT_TEST
+void meta_kms_update_set_crtc_ctm (MetaKmsUpdate        *update,
+                                   MetaKmsCrtc          *crtc,
+                                   const MetaKmsCrtcCtm *ctm);
+
 int
 meta_kms_update_get_sync_fd (MetaKmsUpdate *update);
 
@@ -164,6 +187,11 @@ void
 meta_kms_update_set_sync_fd (MetaKmsUpdate *update,
                              int            sync_fd);
 
+/* Lets the update be applied without waiting for the next vertical
+ * blank if the device supports it, at the cost of tearing */
+void meta_kms_update_set_allow_tearing (MetaKmsUpdate *update,
+                                        gboolean       allow_tearing);
+
 void meta_kms_plane_assignment_set_fb_damage (MetaKmsPlaneAssignment *plane_assignment,
                                               const MtkRegion        *region);
 
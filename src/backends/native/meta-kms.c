@@ -428,6 +428,7 @@ meta_kms_new (MetaBackend   *backend,
                         "name", "KMS thread",
                         "thread-type", thread_type,
                         "preferred-scheduling-priority", preferred_scheduling_priority,
+                        "cpu-affinity", g_getenv ("MUTTER_DEBUG_KMS_THREAD_CPUS"),
                         NULL);
   kms->flags = flags;
 
@@ -50,6 +50,7 @@
 #include "backends/native/meta-render-device.h"
 #include "backends/native/meta-renderer-native-gles3.h"
 #include "backends/native/meta-renderer-native-private.h"
+#include "clutter/clutter-mutter.h"
 #include "cogl/cogl.h"
 #include "common/meta-cogl-drm-formats.h"
 #include "common/meta-drm-format-helpers.h"
@@ -78,8 +79,14 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
   struct {
     MetaDrmBufferDumb *current_dumb_fb;
     MetaDrmBufferDumb *dumb_fbs[2];
+    uint64_t dumb_fb_frame_counts[2];
   } cpu;
 
+  /* Damage of previous frames, used to limit copies to what changed since
+   * the destination buffer was last written to. */
+  ClutterDamageHistory *damage_history;
+  uint64_t frame_count;
+
   gboolean noted_primary_gpu_copy_ok;
   gboolean noted_primary_gpu_copy_failed;
   MetaSharedFramebufferImportStatus import_status;
@@ -121,6 +128,11 @@ struct _MetaOnscreenNative
   gboolean frame_sync_requested;
   gboolean frame_sync_enabled;
 
+  struct {
+    CoglScanout *scanout;
+    gboolean is_assigned;
+  } overlay;
+
   MetaRendererView *view;
 
   union {
@@ -245,17 +257,23 @@ notify_view_crtc_presented (MetaRendererView *view,
 }
 
 static void
-page_flip_feedback_flipped (MetaKmsCrtc  *kms_crtc,
-                            unsigned int  sequence,
-                            unsigned int  tv_sec,
-                            unsigned int  tv_usec,
-                            gpointer      user_data)
+page_flip_feedback_flipped (MetaKmsCrtc         *kms_crtc,
+                            unsigned int         sequence,
+                            unsigned int         tv_sec,
+                            unsigned int         tv_usec,
+                            MetaKmsPageFlipFlag  page_flip_flags,
+                            gpointer             user_data)
 {
   MetaRendererView *view = user_data;
   struct timeval page_flip_time;
   MetaKmsDevice *kms_device;
   int64_t presentation_time_us;
-  CoglFrameInfoFlag flags = COGL_FRAME_INFO_FLAG_VSYNC;
+  CoglFrameInfoFlag flags;
+
+  if (page_flip_flags & META_KMS_PAGE_FLIP_FLAG_ASYNC)
+    flags = COGL_FRAME_INFO_FLAG_ASYNC;
+  else
+    flags = COGL_FRAME_INFO_FLAG_VSYNC;
 
   page_flip_time = (struct timeval) {
     .tv_sec = tv_sec,
@@ -465,17 +483,17 @@ apply_transform (MetaCrtcKms            *crtc_kms,
 }
 
 static MetaKmsPlaneAssignment *
-assign_primary_plane (MetaCrtcKms            *crtc_kms,
-                      MetaDrmBuffer          *buffer,
-                      MetaKmsUpdate          *kms_update,
-                      MetaKmsAssignPlaneFlag  flags,
-                      const graphene_rect_t  *src_rect,
-                      const MtkRectangle     *dst_rect)
+assign_plane (MetaCrtcKms            *crtc_kms,
+              MetaKmsPlane           *kms_plane,
+              MetaDrmBuffer          *buffer,
+              MetaKmsUpdate          *kms_update,
+              MetaKmsAssignPlaneFlag  flags,
+              const graphene_rect_t  *src_rect,
+              const MtkRectangle     *dst_rect)
 {
   MetaCrtc *crtc = META_CRTC (crtc_kms);
   MetaFixed16Rectangle src_rect_fixed16;
   MetaKmsCrtc *kms_crtc;
-  MetaKmsPlane *primary_kms_plane;
   MetaKmsPlaneAssignment *plane_assignment;
 
   src_rect_fixed16 = (MetaFixed16Rectangle) {
@@ -486,27 +504,130 @@ assign_primary_plane (MetaCrtcKms            *crtc_kms,
   };
 
   meta_topic (META_DEBUG_KMS,
-              "Assigning buffer to primary plane update on CRTC "
+              "Assigning buffer to %s plane update on CRTC "
               "(%" G_GUINT64_FORMAT ") with src rect %f,%f %fx%f "
               "and dst rect %d,%d %dx%d",
+              meta_kms_plane_type_to_string (meta_kms_plane_get_plane_type (kms_plane)),
               meta_crtc_get_id (crtc), src_rect->origin.x, src_rect->origin.y,
               src_rect->size.width, src_rect->size.height,
               dst_rect->x, dst_rect->y, dst_rect->width, dst_rect->height);
 
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
-  primary_kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
   plane_assignment = meta_kms_update_assign_plane (kms_update,
                                                    kms_crtc,
-                                                   primary_kms_plane,
+                                                   kms_plane,
                                                    buffer,
                                                    src_rect_fixed16,
                                                    *dst_rect,
                                                    flags);
-  apply_transform (crtc_kms, plane_assignment, primary_kms_plane);
+  apply_transform (crtc_kms, plane_assignment, kms_plane);
 
   return plane_assignment;
 }
 
+static MetaKmsPlaneAssignment *
+assign_primary_plane (MetaCrtcKms            *crtc_kms,
+                      MetaDrmBuffer          *buffer,
+                      MetaKmsUpdate          *kms_update,
+                      MetaKmsAssignPlaneFlag  flags,
+                      const graphene_rect_t  *src_rect,
+                      const MtkRectangle     *dst_rect)
+{
+  MetaKmsPlane *primary_kms_plane;
+
+  primary_kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+
+  return assign_plane (crtc_kms, primary_kms_plane, buffer, kms_update,
+                       flags, src_rect, dst_rect);
+}
+
+static void
+assign_overlay_plane (MetaCrtcKms   *crtc_kms,
+                      MetaKmsPlane  *overlay_kms_plane,
+                      CoglScanout   *scanout,
+                      MetaKmsUpdate *kms_update)
+{
+  MetaDrmBuffer *buffer;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+
+  buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
+  cogl_scanout_get_src_rect (scanout, &src_rect);
+  cogl_scanout_get_dst_rect (scanout, &dst_rect);
+
+  assign_plane (crtc_kms, overlay_kms_plane, buffer, kms_update,
+                META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC,
+                &src_rect, &dst_rect);
+}
+
+static void
+update_overlay_plane (CoglOnscreen    *onscreen,
+                      MetaFrameNative *frame_native,
+                      MetaKmsUpdate   *kms_update)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  MetaKmsPlane *overlay_kms_plane;
+
+  overlay_kms_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  if (!overlay_kms_plane)
+    return;
+
+  if (onscreen_native->overlay.scanout)
+    {
+      assign_overlay_plane (crtc_kms,
+                            overlay_kms_plane,
+                            onscreen_native->overlay.scanout,
+                            kms_update);
+      meta_frame_native_set_overlay_scanout (frame_native,
+                                             onscreen_native->overlay.scanout);
+      onscreen_native->overlay.is_assigned = TRUE;
+    }
+  else if (onscreen_native->overlay.is_assigned)
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "Unassigning overlay plane %u on CRTC %u",
+                  meta_kms_plane_get_id (overlay_kms_plane),
+                  meta_kms_crtc_get_id (kms_crtc));
+
+      meta_kms_update_unassign_plane (kms_update, kms_crtc, overlay_kms_plane);
+      onscreen_native->overlay.is_assigned = FALSE;
+    }
+}
+
+static void
+maybe_drop_failed_overlay (MetaOnscreenNative *onscreen_native)
+{
+  CoglOnscreen *onscreen = COGL_ONSCREEN (onscreen_native);
+  ClutterFrame *next_frame = onscreen_native->next_frame;
+  MetaFrameNative *next_frame_native;
+  CoglScanout *overlay_scanout;
+
+  if (!next_frame)
+    return;
+
+  next_frame_native = meta_frame_native_from_frame (next_frame);
+  overlay_scanout = meta_frame_native_get_overlay_scanout (next_frame_native);
+  if (!overlay_scanout)
+    return;
+
+  /* Fall back to composition; the buffer will be tainted for this onscreen
+   * so the next frame won't try to promote it again. */
+  cogl_scanout_notify_failed (overlay_scanout, onscreen);
+  if (onscreen_native->overlay.scanout == overlay_scanout)
+    g_clear_object (&onscreen_native->overlay.scanout);
+  onscreen_native->overlay.is_assigned = FALSE;
+
+  if (onscreen_native->view)
+    {
+      ClutterStageView *view = CLUTTER_STAGE_VIEW (onscreen_native->view);
+
+      clutter_stage_view_add_redraw_clip (view, NULL);
+      clutter_stage_view_schedule_update_now (view);
+    }
+}
+
 static void
 meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
                                 MetaRendererView       *view,
@@ -578,6 +699,8 @@ meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
 
       if (region && !mtk_region_is_empty (region))
         meta_kms_plane_assignment_set_fb_damage (plane_assignment, region);
+
+      update_overlay_plane (onscreen, frame_native, kms_update);
       break;
     case META_RENDERER_NATIVE_MODE_SURFACELESS:
       g_assert_not_reached ();
@@ -788,6 +911,9 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
 
   secondary_gpu_release_dumb (secondary_gpu_state);
 
+  g_clear_pointer (&secondary_gpu_state->damage_history,
+                   clutter_damage_history_free);
+
   g_free (secondary_gpu_state);
 }
 
@@ -828,11 +954,82 @@ import_shared_framebuffer (CoglOnscreen                        *onscreen,
   return imported_buffer;
 }
 
+/*
+ * Returns the region that needs to be copied into a secondary GPU buffer
+ * that was last written to @buffer_age frames ago, or NULL if the whole
+ * buffer must be copied.
+ */
+static MtkRegion *
+get_secondary_gpu_copy_region (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                               const MtkRegion                     *region,
+                               int                                  buffer_age)
+{
+  ClutterDamageHistory *damage_history = secondary_gpu_state->damage_history;
+  MtkRegion *copy_region;
+  int age;
+
+  if (!region || mtk_region_is_empty (region))
+    return NULL;
+
+  if (buffer_age < 1)
+    return NULL;
+
+  if (buffer_age > 1 &&
+      !clutter_damage_history_is_age_valid (damage_history, buffer_age - 1))
+    return NULL;
+
+  copy_region = mtk_region_copy (region);
+  for (age = 1; age < buffer_age; age++)
+    {
+      const MtkRegion *old_damage;
+
+      old_damage = clutter_damage_history_lookup (damage_history, age);
+      mtk_region_union (copy_region, old_damage);
+    }
+
+  return copy_region;
+}
+
+static void
+record_secondary_gpu_damage (CoglOnscreen    *onscreen,
+                             const MtkRegion *region)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state =
+    onscreen_native->secondary_gpu_state;
+
+  if (!secondary_gpu_state)
+    return;
+
+  if (!region || mtk_region_is_empty (region))
+    {
+      CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+      MtkRectangle rect = {
+        .width = cogl_framebuffer_get_width (framebuffer),
+        .height = cogl_framebuffer_get_height (framebuffer),
+      };
+      g_autoptr (MtkRegion) full_region = NULL;
+
+      full_region = mtk_region_create_rectangle (&rect);
+      clutter_damage_history_record (secondary_gpu_state->damage_history,
+                                     full_region);
+    }
+  else
+    {
+      clutter_damage_history_record (secondary_gpu_state->damage_history,
+                                     region);
+    }
+
+  clutter_damage_history_step (secondary_gpu_state->damage_history);
+  secondary_gpu_state->frame_count++;
+}
+
 static MetaDrmBuffer *
 copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
                              MetaOnscreenNativeSecondaryGpuState  *secondary_gpu_state,
                              MetaRendererNativeGpuData            *renderer_gpu_data,
                              MetaDrmBuffer                        *primary_gpu_fb,
+                             const MtkRegion                      *region,
                              GError                              **error)
 {
   MetaRendererNative *renderer_native = renderer_gpu_data->renderer_native;
@@ -850,6 +1047,8 @@ copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
   struct gbm_bo *bo;
   EGLSync egl_sync = EGL_NO_SYNC;
   g_autofd int sync_fd = -1;
+  EGLint buffer_age = 0;
+  g_autoptr (MtkRegion) copy_region = NULL;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferSecondaryGpu,
                            "copy_shared_framebuffer_gpu()");
@@ -901,6 +1100,19 @@ copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
         }
     }
 
+  if (renderer_gpu_data->secondary.has_EGL_EXT_buffer_age &&
+      !meta_egl_query_surface (egl,
+                               egl_display,
+                               secondary_gpu_state->egl_surface,
+                               EGL_BUFFER_AGE_EXT,
+                               &buffer_age,
+                               NULL))
+    buffer_age = 0;
+
+  copy_region = get_secondary_gpu_copy_region (secondary_gpu_state,
+                                               region,
+                                               buffer_age);
+
   buffer_gbm = META_DRM_BUFFER_GBM (primary_gpu_fb);
   bo = meta_drm_buffer_gbm_get_bo (buffer_gbm);
   if (!meta_renderer_native_gles3_blit_shared_bo (egl,
@@ -909,6 +1121,7 @@ copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
                                                   renderer_gpu_data->secondary.egl_context,
                                                   secondary_gpu_state->egl_surface,
                                                   bo,
+                                                  copy_region,
                                                   error))
     {
       g_prefix_error (error, "Failed to blit shared framebuffer: ");
@@ -964,16 +1177,40 @@ done:
   return buffer_gbm ? META_DRM_BUFFER (buffer_gbm) : NULL;
 }
 
-static MetaDrmBufferDumb *
-secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+static int
+secondary_gpu_get_next_dumb_buffer_index (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
 {
   MetaDrmBufferDumb *current_dumb_fb;
 
   current_dumb_fb = secondary_gpu_state->cpu.current_dumb_fb;
   if (current_dumb_fb == secondary_gpu_state->cpu.dumb_fbs[0])
-    return secondary_gpu_state->cpu.dumb_fbs[1];
+    return 1;
   else
-    return secondary_gpu_state->cpu.dumb_fbs[0];
+    return 0;
+}
+
+static int
+secondary_gpu_get_dumb_buffer_age (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                   int                                  index)
+{
+  uint64_t written_frame_count;
+
+  written_frame_count = secondary_gpu_state->cpu.dumb_fb_frame_counts[index];
+  if (written_frame_count == 0)
+    return 0;
+
+  return (int) MIN (secondary_gpu_state->frame_count + 1 - written_frame_count,
+                    G_MAXINT);
+}
+
+static void
+secondary_gpu_set_current_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                       int                                  index)
+{
+  secondary_gpu_state->cpu.current_dumb_fb =
+    secondary_gpu_state->cpu.dumb_fbs[index];
+  secondary_gpu_state->cpu.dumb_fb_frame_counts[index] =
+    secondary_gpu_state->frame_count + 1;
 }
 
 static MetaDrmBuffer *
@@ -986,9 +1223,11 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   MetaRendererNative *renderer_native = onscreen_native->renderer_native;
   MetaGpuKms *primary_gpu;
   MetaRendererNativeGpuData *primary_gpu_data;
+  int dumb_index;
   MetaDrmBufferDumb *buffer_dumb;
   MetaDrmBuffer *buffer;
   int width, height;
+  g_autoptr (MtkRegion) copy_region = NULL;
   CoglFramebuffer *dmabuf_fb;
   int dmabuf_fd;
   g_autoptr (GError) error = NULL;
@@ -997,7 +1236,6 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   uint32_t offset;
   uint32_t drm_format;
   uint64_t modifier;
-  int n_rectangles;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferPrimaryGpu,
                            "copy_shared_framebuffer_primary_gpu()");
@@ -1011,7 +1249,8 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   if (!primary_gpu_data->secondary.has_EGL_EXT_image_dma_buf_import_modifiers)
     return NULL;
 
-  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
+  dumb_index = secondary_gpu_get_next_dumb_buffer_index (secondary_gpu_state);
+  buffer_dumb = secondary_gpu_state->cpu.dumb_fbs[dumb_index];
   buffer = META_DRM_BUFFER (buffer_dumb);
 
   width = meta_drm_buffer_get_width (buffer);
@@ -1055,11 +1294,28 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
                   error->message);
       return NULL;
     }
+
+  copy_region =
+    get_secondary_gpu_copy_region (secondary_gpu_state,
+                                   region,
+                                   secondary_gpu_get_dumb_buffer_age (secondary_gpu_state,
+                                                                      dumb_index));
+
   /* Limit the number of individual copies to 16 */
 #define MAX_RECTS 16
 
-  n_rectangles = mtk_region_num_rectangles (region);
-  if (n_rectangles == 0 || n_rectangles > MAX_RECTS)
+  if (copy_region && mtk_region_num_rectangles (copy_region) > MAX_RECTS)
+    {
+      MtkRectangle extents;
+
+      extents = mtk_region_get_extents (copy_region);
+      g_clear_pointer (&copy_region, mtk_region_unref);
+      copy_region = mtk_region_create_rectangle (&extents);
+    }
+
+  cogl_onscreen_begin_gpu_phase (onscreen, framebuffer, "secondary-gpu-copy");
+
+  if (!copy_region)
     {
       if (!cogl_framebuffer_blit (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
                                   0, 0, 0, 0,
@@ -1072,11 +1328,13 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
     }
   else
     {
+      int n_rectangles;
       int i;
 
+      n_rectangles = mtk_region_num_rectangles (copy_region);
       for (i = 0; i < n_rectangles; ++i)
         {
-          MtkRectangle rectangle = mtk_region_get_rectangle (region, i);
+          MtkRectangle rectangle = mtk_region_get_rectangle (copy_region, i);
 
           if (!cogl_framebuffer_blit (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
                                       rectangle.x, rectangle.y,
@@ -1095,31 +1353,64 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
                            g_steal_pointer (&dmabuf_fb),
                            g_object_unref);
 
-  secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
+  secondary_gpu_set_current_dumb_buffer (secondary_gpu_state, dumb_index);
 
   return g_object_ref (buffer);
 }
 
+static void
+read_pixels_into_dumb_buffer (CoglFramebuffer    *framebuffer,
+                              uint8_t            *buffer_data,
+                              int                 stride,
+                              CoglPixelFormat     cogl_format,
+                              const MtkRectangle *rect)
+{
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  int bpp;
+  CoglBitmap *dumb_bitmap;
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
+  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                          rect->width,
+                                          rect->height,
+                                          cogl_format,
+                                          stride,
+                                          buffer_data +
+                                          rect->y * stride +
+                                          rect->x * bpp);
+
+  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                 rect->x,
+                                                 rect->y,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER,
+                                                 dumb_bitmap))
+    g_warning ("Failed to CPU-copy to a secondary GPU output");
+
+  g_object_unref (dumb_bitmap);
+}
+
 static MetaDrmBuffer *
 copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
-                             MetaRendererNativeGpuData           *renderer_gpu_data)
+                             MetaRendererNativeGpuData           *renderer_gpu_data,
+                             const MtkRegion                     *region)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
-  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  int dumb_index;
   MetaDrmBufferDumb *buffer_dumb;
   MetaDrmBuffer *buffer;
   int width, height, stride;
   uint32_t drm_format;
-  void *buffer_data;
-  CoglBitmap *dumb_bitmap;
+  uint8_t *buffer_data;
   CoglPixelFormat cogl_format;
   const MetaFormatInfo *format_info;
+  g_autoptr (MtkRegion) copy_region = NULL;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpu,
                            "copy_shared_framebuffer_cpu()");
 
-  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
+  dumb_index = secondary_gpu_get_next_dumb_buffer_index (secondary_gpu_state);
+  buffer_dumb = secondary_gpu_state->cpu.dumb_fbs[dumb_index];
   buffer = META_DRM_BUFFER (buffer_dumb);
 
   width = meta_drm_buffer_get_width (buffer);
@@ -1135,23 +1426,36 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   g_assert (format_info);
   cogl_format = format_info->cogl_format;
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          width,
-                                          height,
-                                          cogl_format,
-                                          stride,
-                                          buffer_data);
+  copy_region =
+    get_secondary_gpu_copy_region (secondary_gpu_state,
+                                   region,
+                                   secondary_gpu_get_dumb_buffer_age (secondary_gpu_state,
+                                                                      dumb_index));
+  if (copy_region)
+    {
+      int n_rectangles;
+      int i;
 
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+      n_rectangles = mtk_region_num_rectangles (copy_region);
+      for (i = 0; i < n_rectangles; i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (copy_region, i);
 
-  g_object_unref (dumb_bitmap);
+          read_pixels_into_dumb_buffer (framebuffer,
+                                        buffer_data, stride, cogl_format,
+                                        &rect);
+        }
+    }
+  else
+    {
+      MtkRectangle rect = { .width = width, .height = height };
 
-  secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
+      read_pixels_into_dumb_buffer (framebuffer,
+                                    buffer_data, stride, cogl_format,
+                                    &rect);
+    }
+
+  secondary_gpu_set_current_dumb_buffer (secondary_gpu_state, dumb_index);
 
   return g_object_ref (buffer);
 }
@@ -1203,7 +1507,8 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen    *onscreen,
 
               copy = copy_shared_framebuffer_cpu (onscreen,
                                                   secondary_gpu_state,
-                                                  renderer_gpu_data);
+                                                  renderer_gpu_data,
+                                                  region);
             }
           else if (!secondary_gpu_state->noted_primary_gpu_copy_ok)
             {
@@ -1220,10 +1525,11 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen    *onscreen,
 }
 
 static MetaDrmBuffer *
-acquire_front_buffer (CoglOnscreen   *onscreen,
-                      MetaDrmBuffer  *primary_gpu_fb,
-                      MetaDrmBuffer  *secondary_gpu_fb,
-                      GError        **error)
+acquire_front_buffer (CoglOnscreen     *onscreen,
+                      MetaDrmBuffer    *primary_gpu_fb,
+                      MetaDrmBuffer    *secondary_gpu_fb,
+                      const MtkRegion  *region,
+                      GError          **error)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
   MetaRendererNative *renderer_native = onscreen_native->renderer_native;
@@ -1268,6 +1574,7 @@ acquire_front_buffer (CoglOnscreen   *onscreen,
                                           secondary_gpu_state,
                                           renderer_gpu_data,
                                           primary_gpu_fb,
+                                          region,
                                           error);
     }
 
@@ -1312,7 +1619,10 @@ swap_buffer_result_feedback (const MetaKmsFeedback *kms_feedback,
   if (!g_error_matches (error,
                         G_IO_ERROR,
                         G_IO_ERROR_PERMISSION_DENIED))
-    g_warning ("Page flip failed: %s", error->message);
+    {
+      g_warning ("Page flip failed: %s", error->message);
+      maybe_drop_failed_overlay (META_ONSCREEN_NATIVE (onscreen));
+    }
 
   frame_info = cogl_onscreen_peek_head_frame_info (onscreen);
   frame_info->flags |= COGL_FRAME_INFO_FLAG_SYMBOLIC;
@@ -1418,7 +1728,9 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen    *onscreen,
       buffer = acquire_front_buffer (onscreen,
                                      primary_gpu_fb,
                                      secondary_gpu_fb,
+                                     region,
                                      &error);
+      record_secondary_gpu_damage (onscreen, region);
       if (buffer == NULL)
         {
           g_warning ("Failed to acquire front buffer: %s", error->message);
@@ -1606,6 +1918,66 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
   return result == META_KMS_FEEDBACK_PASSED;
 }
 
+gboolean
+meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                   CoglScanout  *scanout)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaCrtc *crtc = onscreen_native->crtc;
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
+  MetaGpuKms *gpu_kms;
+  MetaKmsDevice *kms_device;
+  MetaKmsCrtc *kms_crtc;
+  MetaKmsPlane *overlay_kms_plane;
+  MetaKmsUpdate *test_update;
+  g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
+  MetaKmsFeedbackResult result;
+
+  if (onscreen_native->secondary_gpu_state)
+    return FALSE;
+
+  overlay_kms_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  if (!overlay_kms_plane)
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "No overlay plane assigned to CRTC %" G_GUINT64_FORMAT,
+                  meta_crtc_get_id (crtc));
+      return FALSE;
+    }
+
+  gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
+  kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
+  kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+
+  test_update = meta_kms_update_new (kms_device);
+  assign_overlay_plane (crtc_kms, overlay_kms_plane, scanout, test_update);
+
+  meta_topic (META_DEBUG_KMS,
+              "Posting overlay plane test update for CRTC %u (%s) synchronously",
+              meta_kms_crtc_get_id (kms_crtc),
+              meta_kms_device_get_path (kms_device));
+
+  kms_feedback =
+    meta_kms_device_process_update_sync (kms_device, test_update,
+                                         META_KMS_UPDATE_FLAG_TEST_ONLY);
+
+  result = meta_kms_feedback_get_result (kms_feedback);
+  return result == META_KMS_FEEDBACK_PASSED;
+}
+
+void
+meta_onscreen_native_set_overlay_scanout (MetaOnscreenNative *onscreen_native,
+                                          CoglScanout        *scanout)
+{
+  g_set_object (&onscreen_native->overlay.scanout, scanout);
+}
+
+gboolean
+meta_onscreen_native_has_overlay_scanout (MetaOnscreenNative *onscreen_native)
+{
+  return onscreen_native->overlay.scanout != NULL;
+}
+
 static void
 scanout_result_feedback (const MetaKmsFeedback *kms_feedback,
                          gpointer               user_data)
@@ -1714,6 +2086,9 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
   kms_device = meta_kms_crtc_get_device (kms_crtc);
   kms_update = meta_frame_native_ensure_kms_update (frame_native, kms_device);
 
+  if (cogl_scanout_get_allow_tearing (scanout))
+    meta_kms_update_set_allow_tearing (kms_update, TRUE);
+
   meta_kms_update_add_result_listener (kms_update,
                                        &scanout_result_listener_vtable,
                                        NULL,
@@ -2540,6 +2915,7 @@ init_secondary_gpu_state_gpu_copy_mode (MetaRendererNative         *renderer_nat
   secondary_gpu_state->renderer_gpu_data = renderer_gpu_data;
   secondary_gpu_state->gbm.surface = gbm_surface;
   secondary_gpu_state->egl_surface = egl_surface;
+  secondary_gpu_state->damage_history = clutter_damage_history_new ();
 
   onscreen_native->secondary_gpu_state = secondary_gpu_state;
 
@@ -2645,6 +3021,7 @@ init_secondary_gpu_state_cpu_copy_mode (MetaRendererNative         *renderer_nat
   secondary_gpu_state->renderer_gpu_data = renderer_gpu_data;
   secondary_gpu_state->gpu_kms = gpu_kms;
   secondary_gpu_state->egl_surface = EGL_NO_SURFACE;
+  secondary_gpu_state->damage_history = clutter_damage_history_new ();
 
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
     {
@@ -2880,6 +3257,7 @@ meta_onscreen_native_dispose (GObject *object)
 
   g_clear_pointer (&onscreen_native->next_frame, clutter_frame_unref);
   g_clear_pointer (&onscreen_native->presented_frame, clutter_frame_unref);
+  g_clear_object (&onscreen_native->overlay.scanout);
 
   renderer_gpu_data =
     meta_renderer_native_get_gpu_data (renderer_native,
@@ -48,6 +48,14 @@ void meta_onscreen_native_dummy_power_save_page_flip (CoglOnscreen *onscreen);
 gboolean meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
                                                             CoglScanout  *scanout);
 
+gboolean meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                            CoglScanout  *scanout);
+
+void meta_onscreen_native_set_overlay_scanout (MetaOnscreenNative *onscreen_native,
+                                               CoglScanout        *scanout);
+
+gboolean meta_onscreen_native_has_overlay_scanout (MetaOnscreenNative *onscreen_native);
+
 void meta_onscreen_native_set_view (CoglOnscreen     *onscreen,
                                     MetaRendererView *view);
 
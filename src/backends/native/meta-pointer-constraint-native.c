@@ -35,6 +35,15 @@ struct _MetaPointerConstraintImplNative
   MtkRegion *region;
   graphene_point_t origin;
   double min_edge_distance;
+
+  /*
+   * Borders of the confine region, generated once on construction, as the
+   * region never changes. The borders are defined to be the outer region of
+   * the allowed area. This means top/left borders are "within" the allowed
+   * area, while bottom/right borders are outside. This needs to be
+   * considered when clamping confined motion vectors.
+   */
+  GArray *borders;
 };
 
 G_DEFINE_TYPE (MetaPointerConstraintImplNative,
@@ -452,18 +461,14 @@ meta_pointer_constraint_impl_native_constrain (MetaPointerConstraintImpl *constr
                                                float                     *y_inout)
 {
   MetaPointerConstraintImplNative *constraint_impl_native;
-  g_autoptr (MtkRegion) region = NULL;
   float x, y;
-  g_autoptr (GArray) borders = NULL;
   MetaLine2 motion;
   MetaBorder *closest_border;
   uint32_t directions;
 
   constraint_impl_native = META_POINTER_CONSTRAINT_IMPL_NATIVE (constraint_impl);
 
-  region = mtk_region_ref (constraint_impl_native->region);
-
-  if (mtk_region_is_empty (region))
+  if (mtk_region_is_empty (constraint_impl_native->region))
     {
       *x_inout = constraint_impl_native->origin.x;
       *y_inout = constraint_impl_native->origin.y;
@@ -483,17 +488,6 @@ meta_pointer_constraint_impl_native_constrain (MetaPointerConstraintImpl *constr
   if (y > prev_y)
     y += (float) wl_fixed_to_double(1);
 
-  borders = g_array_new (FALSE, FALSE, sizeof (MetaBorder));
-
-  /*
-   * Generate borders given the confine region we are to use. The borders
-   * are defined to be the outer region of the allowed area. This means
-   * top/left borders are "within" the allowed area, while bottom/right
-   * borders are outside. This needs to be considered when clamping
-   * confined motion vectors.
-   */
-  region_to_outline (region, borders);
-
   motion = (MetaLine2) {
     .a = (MetaVector2) {
       .x = prev_x - constraint_impl_native->origin.x,
@@ -508,7 +502,7 @@ meta_pointer_constraint_impl_native_constrain (MetaPointerConstraintImpl *constr
 
   while (directions)
     {
-      closest_border = get_closest_border (borders,
+      closest_border = get_closest_border (constraint_impl_native->borders,
                                            &motion,
                                            directions);
       if (closest_border)
@@ -599,14 +593,16 @@ meta_pointer_constraint_impl_native_ensure_constrained (MetaPointerConstraintImp
   MetaPointerConstraintImplNative *constraint_impl_native;
   graphene_point_t point;
   ClutterSeat *seat;
-  g_autoptr (MtkRegion) region = NULL;
+  MtkRegion *region;
+  GArray *borders;
   float x;
   float y;
   float rel_x;
   float rel_y;
 
   constraint_impl_native = META_POINTER_CONSTRAINT_IMPL_NATIVE (constraint_impl);
-  region = mtk_region_ref (constraint_impl_native->region);
+  region = constraint_impl_native->region;
+  borders = constraint_impl_native->borders;
 
   seat = clutter_input_device_get_seat (device);
   clutter_seat_query_state (seat, device, NULL, &point, NULL);
@@ -627,15 +623,10 @@ meta_pointer_constraint_impl_native_ensure_constrained (MetaPointerConstraintImp
     }
   else if (!mtk_region_contains_point (region, (int) rel_x, (int) rel_y))
     {
-      g_autoptr (GArray) borders = NULL;
       float closest_distance_2 = FLT_MAX;
       MetaBorder *closest_border = NULL;
       unsigned int i;
 
-      borders = g_array_new (FALSE, FALSE, sizeof (MetaBorder));
-
-      region_to_outline (region, borders);
-
       for (i = 0; i < borders->len; i++)
         {
           MetaBorder *border = &g_array_index (borders, MetaBorder, i);
@@ -664,6 +655,7 @@ meta_pointer_constraint_impl_native_finalize (GObject *object)
 
   constraint_impl_native = META_POINTER_CONSTRAINT_IMPL_NATIVE (object);
   g_clear_pointer (&constraint_impl_native->region, mtk_region_unref);
+  g_clear_pointer (&constraint_impl_native->borders, g_array_unref);
 
   G_OBJECT_CLASS (meta_pointer_constraint_impl_native_parent_class)->finalize (object);
 }
@@ -700,6 +692,9 @@ meta_pointer_constraint_impl_native_new (MetaPointerConstraint *constraint,
                                   NULL);
   constraint_impl->constraint = constraint;
   constraint_impl->region = mtk_region_copy (region);
+  constraint_impl->borders = g_array_new (FALSE, FALSE, sizeof (MetaBorder));
+  if (!mtk_region_is_empty (constraint_impl->region))
+    region_to_outline (constraint_impl->region, constraint_impl->borders);
   constraint_impl->min_edge_distance = min_edge_distance;
   constraint_impl->origin = origin;
 
@@ -25,6 +25,15 @@
 #include "backends/native/meta-backend-native-types.h"
 #include "backends/native/meta-drm-buffer-dumb.h"
 
+/*
+ * Dumb buffers are kept around for a while after their last user let go
+ * of them, so that reconfiguring or hotplugging monitors, which tears down
+ * and recreates the onscreens, can pick up buffers of the same size and
+ * format again, including their mapping and framebuffer ID, instead of
+ * going through buffer creation, drmModeAddFB2() and mmap() again.
+ */
+#define DUMB_BUFFER_RELEASE_DELAY_US (G_USEC_PER_SEC * 3)
+
 enum
 {
   PROP_0,
@@ -47,8 +56,21 @@ typedef struct _MetaRenderDevicePrivate
   EGLConfig egl_config;
 
   gboolean is_hardware_rendering;
+
+  GMutex dumb_buffers_lock;
+  GPtrArray *dumb_buffers;
+  GSource *dumb_buffer_release_source;
 } MetaRenderDevicePrivate;
 
+typedef struct _PooledDumbBuffer
+{
+  MetaRenderDevice *render_device;
+  MetaDrmBuffer *buffer;
+
+  gboolean is_idle;
+  int64_t idle_since_us;
+} PooledDumbBuffer;
+
 static void
 initable_iface_init (GInitableIface *initable_iface);
 
@@ -215,6 +237,161 @@ meta_render_device_set_property (GObject      *object,
     }
 }
 
+static void
+on_dumb_buffer_toggle_notify (gpointer  user_data,
+                              GObject  *object,
+                              gboolean  is_last_ref);
+
+static void
+pooled_dumb_buffer_free (PooledDumbBuffer *pooled)
+{
+  g_object_remove_toggle_ref (G_OBJECT (pooled->buffer),
+                              on_dumb_buffer_toggle_notify,
+                              pooled);
+  g_free (pooled);
+}
+
+static void
+schedule_dumb_buffer_release (MetaRenderDevice *render_device)
+{
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+  int64_t ready_time = -1;
+  unsigned int i;
+
+  for (i = 0; i < priv->dumb_buffers->len; i++)
+    {
+      PooledDumbBuffer *pooled = g_ptr_array_index (priv->dumb_buffers, i);
+      int64_t release_time;
+
+      if (!pooled->is_idle)
+        continue;
+
+      release_time = pooled->idle_since_us + DUMB_BUFFER_RELEASE_DELAY_US;
+      if (ready_time == -1 || release_time < ready_time)
+        ready_time = release_time;
+    }
+
+  g_source_set_ready_time (priv->dumb_buffer_release_source, ready_time);
+}
+
+static void
+on_dumb_buffer_toggle_notify (gpointer  user_data,
+                              GObject  *object,
+                              gboolean  is_last_ref)
+{
+  PooledDumbBuffer *pooled = user_data;
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (pooled->render_device);
+
+  if (!is_last_ref)
+    return;
+
+  /* May be called from the KMS thread, when it drops its last reference */
+  g_mutex_lock (&priv->dumb_buffers_lock);
+  pooled->is_idle = TRUE;
+  pooled->idle_since_us = g_get_monotonic_time ();
+  schedule_dumb_buffer_release (pooled->render_device);
+  g_mutex_unlock (&priv->dumb_buffers_lock);
+}
+
+static gboolean
+release_dumb_buffers_dispatch (GSource     *source,
+                               GSourceFunc  callback,
+                               gpointer     user_data)
+{
+  MetaRenderDevice *render_device = user_data;
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+  g_autoptr (GPtrArray) expired = NULL;
+  int64_t now_us;
+  unsigned int i;
+
+  expired =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) pooled_dumb_buffer_free);
+  now_us = g_get_monotonic_time ();
+
+  g_mutex_lock (&priv->dumb_buffers_lock);
+  i = 0;
+  while (i < priv->dumb_buffers->len)
+    {
+      PooledDumbBuffer *pooled = g_ptr_array_index (priv->dumb_buffers, i);
+
+      if (pooled->is_idle &&
+          now_us - pooled->idle_since_us >= DUMB_BUFFER_RELEASE_DELAY_US)
+        g_ptr_array_add (expired,
+                         g_ptr_array_steal_index_fast (priv->dumb_buffers, i));
+      else
+        i++;
+    }
+  schedule_dumb_buffer_release (render_device);
+  g_mutex_unlock (&priv->dumb_buffers_lock);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs release_dumb_buffers_funcs = {
+  .dispatch = release_dumb_buffers_dispatch,
+};
+
+static MetaDrmBuffer *
+take_pooled_dumb_buffer (MetaRenderDevice *render_device,
+                         int               width,
+                         int               height,
+                         uint32_t          format)
+{
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+  MetaDrmBuffer *buffer = NULL;
+  unsigned int i;
+
+  g_mutex_lock (&priv->dumb_buffers_lock);
+  for (i = 0; i < priv->dumb_buffers->len; i++)
+    {
+      PooledDumbBuffer *pooled = g_ptr_array_index (priv->dumb_buffers, i);
+
+      if (!pooled->is_idle ||
+          meta_drm_buffer_get_width (pooled->buffer) != width ||
+          meta_drm_buffer_get_height (pooled->buffer) != height ||
+          meta_drm_buffer_get_format (pooled->buffer) != format)
+        continue;
+
+      pooled->is_idle = FALSE;
+      buffer = pooled->buffer;
+      schedule_dumb_buffer_release (render_device);
+      break;
+    }
+  g_mutex_unlock (&priv->dumb_buffers_lock);
+
+  /* Nothing but the pool can reach an idle buffer, so it can be referenced
+   * without holding the lock, which the toggle notification takes. */
+  if (buffer)
+    g_object_ref (buffer);
+
+  return buffer;
+}
+
+static void
+add_pooled_dumb_buffer (MetaRenderDevice *render_device,
+                        MetaDrmBuffer    *buffer)
+{
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+  PooledDumbBuffer *pooled;
+
+  pooled = g_new0 (PooledDumbBuffer, 1);
+  pooled->render_device = render_device;
+  pooled->buffer = buffer;
+
+  g_object_add_toggle_ref (G_OBJECT (buffer),
+                           on_dumb_buffer_toggle_notify,
+                           pooled);
+
+  g_mutex_lock (&priv->dumb_buffers_lock);
+  g_ptr_array_add (priv->dumb_buffers, pooled);
+  g_mutex_unlock (&priv->dumb_buffers_lock);
+}
+
 static void
 meta_render_device_dispose (GObject *object)
 {
@@ -223,6 +400,13 @@ meta_render_device_dispose (GObject *object)
     meta_render_device_get_instance_private (render_device);
   MetaEgl *egl = meta_backend_get_egl (priv->backend);
 
+  if (priv->dumb_buffer_release_source)
+    {
+      g_source_destroy (priv->dumb_buffer_release_source);
+      g_clear_pointer (&priv->dumb_buffer_release_source, g_source_unref);
+    }
+  g_clear_pointer (&priv->dumb_buffers, g_ptr_array_unref);
+
   if (priv->egl_display != EGL_NO_DISPLAY)
     {
       meta_egl_terminate (egl, priv->egl_display, NULL);
@@ -240,6 +424,7 @@ meta_render_device_finalize (GObject *object)
     meta_render_device_get_instance_private (render_device);
 
   g_clear_pointer (&priv->device_file, meta_device_file_release);
+  g_mutex_clear (&priv->dumb_buffers_lock);
 
   G_OBJECT_CLASS (meta_render_device_parent_class)->finalize (object);
 }
@@ -290,6 +475,18 @@ meta_render_device_init (MetaRenderDevice *render_device)
 
   priv->egl_display = EGL_NO_DISPLAY;
   priv->egl_config = EGL_NO_CONFIG_KHR;
+
+  g_mutex_init (&priv->dumb_buffers_lock);
+  priv->dumb_buffers =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) pooled_dumb_buffer_free);
+  priv->dumb_buffer_release_source =
+    g_source_new (&release_dumb_buffers_funcs, sizeof (GSource));
+  g_source_set_name (priv->dumb_buffer_release_source,
+                     "[mutter] Dumb buffer release");
+  g_source_set_callback (priv->dumb_buffer_release_source,
+                         NULL, render_device, NULL);
+  g_source_set_ready_time (priv->dumb_buffer_release_source, -1);
+  g_source_attach (priv->dumb_buffer_release_source, NULL);
 }
 
 MetaBackend *
@@ -418,6 +615,7 @@ meta_render_device_allocate_dumb_buf (MetaRenderDevice  *render_device,
   MetaRenderDevicePrivate *priv =
     meta_render_device_get_instance_private (render_device);
   MetaDrmBufferDumb *buffer_dumb;
+  MetaDrmBuffer *buffer;
 
   if (!priv->device_file)
     {
@@ -426,6 +624,10 @@ meta_render_device_allocate_dumb_buf (MetaRenderDevice  *render_device,
       return NULL;
     }
 
+  buffer = take_pooled_dumb_buffer (render_device, width, height, format);
+  if (buffer)
+    return buffer;
+
   buffer_dumb = meta_drm_buffer_dumb_new (priv->device_file,
                                           width, height,
                                           format,
@@ -433,5 +635,7 @@ meta_render_device_allocate_dumb_buf (MetaRenderDevice  *render_device,
   if (!buffer_dumb)
     return NULL;
 
+  add_pooled_dumb_buffer (render_device, META_DRM_BUFFER (buffer_dumb));
+
   return META_DRM_BUFFER (buffer_dumb);
 }
@@ -266,14 +266,45 @@ ensure_shader_program (ContextData *context_data,
          (texcoord_attrib, 2, GL_FLOAT, GL_FALSE, 4 * sizeof (GLfloat), box + 2));
 }
 
+static int
+get_scissor_rect_count (const MtkRegion *region)
+{
+  if (!region)
+    return 1;
+
+  return mtk_region_num_rectangles (region);
+}
+
+static void
+set_scissor_rect (MetaGles3       *gles3,
+                  const MtkRegion *region,
+                  int              index,
+                  int              height)
+{
+  MtkRectangle rect;
+
+  if (!region)
+    return;
+
+  /* The region is in framebuffer coordinates, while GL window coordinates
+   * have their origin in the bottom left corner. */
+  rect = mtk_region_get_rectangle (region, index);
+  GLBAS (gles3, glScissor, (rect.x,
+                            height - (rect.y + rect.height),
+                            rect.width,
+                            rect.height));
+}
+
 static void
-blit_egl_image (MetaGles3   *gles3,
-                EGLImageKHR  egl_image,
-                int          width,
-                int          height)
+blit_egl_image (MetaGles3       *gles3,
+                EGLImageKHR      egl_image,
+                int              width,
+                int              height,
+                const MtkRegion *region)
 {
   GLuint texture;
   GLuint framebuffer;
+  int n_rects, i;
 
   meta_gles3_clear_error (gles3);
 
@@ -301,23 +332,37 @@ blit_egl_image (MetaGles3   *gles3,
                                          GL_TEXTURE_2D, texture, 0));
 
   GLBAS (gles3, glBindFramebuffer, (GL_READ_FRAMEBUFFER, framebuffer));
-  GLBAS (gles3, glBlitFramebuffer, (0, height, width, 0,
-                                    0, 0, width, height,
-                                    GL_COLOR_BUFFER_BIT,
-                                    GL_NEAREST));
+
+  if (region)
+    GLBAS (gles3, glEnable, (GL_SCISSOR_TEST));
+
+  n_rects = get_scissor_rect_count (region);
+  for (i = 0; i < n_rects; i++)
+    {
+      set_scissor_rect (gles3, region, i, height);
+      GLBAS (gles3, glBlitFramebuffer, (0, height, width, 0,
+                                        0, 0, width, height,
+                                        GL_COLOR_BUFFER_BIT,
+                                        GL_NEAREST));
+    }
+
+  if (region)
+    GLBAS (gles3, glDisable, (GL_SCISSOR_TEST));
 
   GLBAS (gles3, glDeleteTextures, (1, &texture));
   GLBAS (gles3, glDeleteFramebuffers, (1, &framebuffer));
 }
 
 static void
-paint_egl_image (ContextData *context_data,
-                 MetaGles3   *gles3,
-                 EGLImageKHR  egl_image,
-                 int          width,
-                 int          height)
+paint_egl_image (ContextData     *context_data,
+                 MetaGles3       *gles3,
+                 EGLImageKHR      egl_image,
+                 int              width,
+                 int              height,
+                 const MtkRegion *region)
 {
   GLuint texture;
+  int n_rects, i;
 
   meta_gles3_clear_error (gles3);
   ensure_shader_program (context_data, gles3);
@@ -342,19 +387,31 @@ paint_egl_image (ContextData *context_data,
                                   GL_TEXTURE_WRAP_T,
                                   GL_CLAMP_TO_EDGE));
 
-  GLBAS (gles3, glDrawArrays, (GL_TRIANGLE_FAN, 0, 4));
+  if (region)
+    GLBAS (gles3, glEnable, (GL_SCISSOR_TEST));
+
+  n_rects = get_scissor_rect_count (region);
+  for (i = 0; i < n_rects; i++)
+    {
+      set_scissor_rect (gles3, region, i, height);
+      GLBAS (gles3, glDrawArrays, (GL_TRIANGLE_FAN, 0, 4));
+    }
+
+  if (region)
+    GLBAS (gles3, glDisable, (GL_SCISSOR_TEST));
 
   GLBAS (gles3, glDeleteTextures, (1, &texture));
 }
 
 gboolean
-meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
-                                           MetaGles3      *gles3,
-                                           EGLDisplay      egl_display,
-                                           EGLContext      egl_context,
-                                           EGLSurface      egl_surface,
-                                           struct gbm_bo  *shared_bo,
-                                           GError        **error)
+meta_renderer_native_gles3_blit_shared_bo (MetaEgl          *egl,
+                                           MetaGles3        *gles3,
+                                           EGLDisplay        egl_display,
+                                           EGLContext        egl_context,
+                                           EGLSurface        egl_surface,
+                                           struct gbm_bo    *shared_bo,
+                                           const MtkRegion  *region,
+                                           GError          **error)
 {
   int shared_bo_fd;
   unsigned int width;
@@ -435,9 +492,9 @@ meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
     return FALSE;
 
   if (can_blit)
-    blit_egl_image (gles3, egl_image, width, height);
+    blit_egl_image (gles3, egl_image, width, height, region);
   else
-    paint_egl_image (context_data, gles3, egl_image, width, height);
+    paint_egl_image (context_data, gles3, egl_image, width, height, region);
 
   meta_egl_destroy_image (egl, egl_display, egl_image, NULL);
 
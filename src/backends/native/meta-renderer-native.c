@@ -1959,6 +1959,10 @@ init_secondary_gpu_data_gpu (MetaRendererNativeGpuData *renderer_gpu_data,
     meta_egl_has_extensions (egl, egl_display, NULL,
                              "EGL_EXT_image_dma_buf_import_modifiers",
                              NULL);
+  renderer_gpu_data->secondary.has_EGL_EXT_buffer_age =
+    meta_egl_has_extensions (egl, egl_display, NULL,
+                             "EGL_EXT_buffer_age",
+                             NULL);
 
   egl_vendor = meta_egl_query_string (egl, egl_display, EGL_VENDOR);
   if (!g_strcmp0 (egl_vendor, "NVIDIA"))
@@ -2279,6 +2283,53 @@ meta_renderer_native_unset_modes (MetaRendererNative *renderer_native)
   post_mode_set_updates (renderer_native);
 }
 
+/*
+ * Returns the hardware rendering GPU that drives more monitors than any
+ * other GPU, if there is one. Compositing on it means that most views can
+ * be scanned out without copying them across GPUs.
+ */
+static MetaGpuKms *
+find_gpu_driving_most_monitors (MetaBackend        *backend,
+                                MetaRendererNative *renderer_native)
+{
+  GList *gpus = meta_backend_get_gpus (backend);
+  MetaGpuKms *best_gpu_kms = NULL;
+  int best_n_connected = 0;
+  gboolean is_tie = FALSE;
+  GList *l;
+
+  for (l = gpus; l; l = l->next)
+    {
+      MetaGpuKms *gpu_kms = META_GPU_KMS (l->data);
+      MetaKmsDevice *kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
+      int n_connected;
+
+      n_connected = meta_kms_device_get_n_connected_connectors (kms_device);
+      if (n_connected == 0)
+        continue;
+
+      if (n_connected > best_n_connected)
+        {
+          best_n_connected = n_connected;
+          is_tie = FALSE;
+
+          if (gpu_kms_is_hardware_rendering (renderer_native, gpu_kms))
+            best_gpu_kms = gpu_kms;
+          else
+            best_gpu_kms = NULL;
+        }
+      else if (n_connected == best_n_connected)
+        {
+          is_tie = TRUE;
+        }
+    }
+
+  if (is_tie)
+    return NULL;
+
+  return best_gpu_kms;
+}
+
 static MetaGpuKms *
 choose_primary_gpu_unchecked (MetaBackend        *backend,
                               MetaRendererNative *renderer_native)
@@ -2324,6 +2375,21 @@ choose_primary_gpu_unchecked (MetaBackend        *backend,
             }
         }
 
+      /* Then prefer the GPU that scans out most monitors, to avoid copying
+       * most of the views from another GPU. */
+      if (allow_sw == 0)
+        {
+          MetaGpuKms *gpu_kms;
+
+          gpu_kms = find_gpu_driving_most_monitors (backend, renderer_native);
+          if (gpu_kms)
+            {
+              g_message ("GPU %s selected primary from connected monitors",
+                         meta_gpu_kms_get_file_path (gpu_kms));
+              return gpu_kms;
+            }
+        }
+
       /* Prefer a platform device */
       for (l = gpus; l; l = l->next)
         {
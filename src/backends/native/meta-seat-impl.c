@@ -39,6 +39,7 @@
 #include "backends/native/meta-barrier-native.h"
 #include "backends/native/meta-device-pool.h"
 #include "backends/native/meta-input-thread.h"
+#include "backends/native/meta-thread.h"
 #include "backends/native/meta-virtual-input-device-native.h"
 #include "clutter/clutter-mutter.h"
 #include "core/bell.h"
@@ -64,6 +65,10 @@
 
 #define DISCRETE_SCROLL_STEP 10.0
 
+/* Upper bound on how long events processed in one libinput dispatch are held
+ * back before being passed on to the main thread. */
+#define MAX_EVENT_BATCH_DURATION_US (2 * G_TIME_SPAN_MILLISECOND)
+
 #ifndef BTN_STYLUS3
 #define BTN_STYLUS3 0x149 /* Linux 4.15 */
 #endif
@@ -112,7 +117,14 @@ G_DEFINE_TYPE_WITH_CODE (MetaSeatImpl, meta_seat_impl, G_TYPE_OBJECT,
                                                 meta_seat_impl_initable_iface_init)
                          G_ADD_PRIVATE (MetaSeatImpl))
 
+typedef struct _MetaQueuedInputTask
+{
+  GTask *task;
+  GSourceFunc dispatch_func;
+} MetaQueuedInputTask;
+
 static void process_events (MetaSeatImpl *seat_impl);
+static void flush_batched_events (MetaSeatImpl *seat_impl);
 void meta_seat_impl_constrain_pointer (MetaSeatImpl       *seat_impl,
                                        ClutterInputDevice *core_pointer,
                                        uint64_t            time_us,
@@ -135,6 +147,24 @@ meta_seat_impl_run_input_task (MetaSeatImpl *seat_impl,
 {
   GSource *source;
 
+  /* Keep events queued so far ahead of what is queued here */
+  flush_batched_events (seat_impl);
+
+  /* Don't overtake tasks still waiting in the queue */
+  g_mutex_lock (&seat_impl->queued_input_tasks_lock);
+  if (seat_impl->queued_input_tasks->len > 0)
+    {
+      MetaQueuedInputTask queued_task = {
+        .task = g_object_ref (task),
+        .dispatch_func = dispatch_func,
+      };
+
+      g_array_append_val (seat_impl->queued_input_tasks, queued_task);
+      g_mutex_unlock (&seat_impl->queued_input_tasks_lock);
+      return;
+    }
+  g_mutex_unlock (&seat_impl->queued_input_tasks_lock);
+
   source = g_idle_source_new ();
   g_source_set_priority (source, G_PRIORITY_HIGH);
   g_source_set_callback (source,
@@ -145,6 +175,79 @@ meta_seat_impl_run_input_task (MetaSeatImpl *seat_impl,
   g_source_unref (source);
 }
 
+static gboolean
+dispatch_queued_input_tasks (gpointer user_data)
+{
+  MetaSeatImpl *seat_impl = user_data;
+  g_autoptr (GArray) queued_input_tasks = NULL;
+  unsigned int i;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaSeatImplDispatchQueuedInputTasks,
+                           "Meta::SeatImpl::dispatch_queued_input_tasks()");
+
+  g_mutex_lock (&seat_impl->queued_input_tasks_lock);
+  queued_input_tasks = seat_impl->queued_input_tasks;
+  seat_impl->queued_input_tasks =
+    g_array_sized_new (FALSE, FALSE, sizeof (MetaQueuedInputTask),
+                       queued_input_tasks->len);
+  g_mutex_unlock (&seat_impl->queued_input_tasks_lock);
+
+  seat_impl->batching_events = TRUE;
+
+  for (i = 0; i < queued_input_tasks->len; i++)
+    {
+      MetaQueuedInputTask *queued_task =
+        &g_array_index (queued_input_tasks, MetaQueuedInputTask, i);
+
+      queued_task->dispatch_func (queued_task->task);
+      g_object_unref (queued_task->task);
+    }
+
+  seat_impl->batching_events = FALSE;
+  flush_batched_events (seat_impl);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * meta_seat_impl_queue_input_task:
+ *
+ * Similar to meta_seat_impl_run_input_task(), but meant for high rate input,
+ * e.g. from virtual input devices. Tasks queued before the input thread gets
+ * to them are dispatched in order from a single source, and the events they
+ * generate are passed on to the main thread in one batch.
+ */
+void
+meta_seat_impl_queue_input_task (MetaSeatImpl *seat_impl,
+                                 GTask        *task,
+                                 GSourceFunc   dispatch_func)
+{
+  MetaQueuedInputTask queued_task = {
+    .task = g_object_ref (task),
+    .dispatch_func = dispatch_func,
+  };
+  gboolean needs_dispatch;
+
+  g_mutex_lock (&seat_impl->queued_input_tasks_lock);
+  needs_dispatch = seat_impl->queued_input_tasks->len == 0;
+  g_array_append_val (seat_impl->queued_input_tasks, queued_task);
+  g_mutex_unlock (&seat_impl->queued_input_tasks_lock);
+
+  if (needs_dispatch)
+    {
+      GSource *source;
+
+      source = g_idle_source_new ();
+      g_source_set_priority (source, G_PRIORITY_HIGH);
+      g_source_set_callback (source,
+                             dispatch_queued_input_tasks,
+                             seat_impl,
+                             NULL);
+      g_source_attach (source, seat_impl->input_context);
+      g_source_unref (source);
+    }
+}
+
 void
 meta_seat_impl_sync_leds_in_impl (MetaSeatImpl *seat_impl)
 {
@@ -293,7 +396,20 @@ queue_event (MetaSeatImpl *seat_impl,
     }
 #endif
 
-  _clutter_event_push (event, FALSE);
+  if (seat_impl->batching_events)
+    g_ptr_array_add (seat_impl->batched_events, event);
+  else
+    _clutter_event_push (event, FALSE);
+}
+
+static void
+flush_batched_events (MetaSeatImpl *seat_impl)
+{
+  GPtrArray *batched_events = seat_impl->batched_events;
+
+  _clutter_event_push_batch ((ClutterEvent **) batched_events->pdata,
+                             batched_events->len);
+  g_ptr_array_set_size (batched_events, 0);
 }
 
 static int
@@ -436,6 +552,8 @@ meta_seat_impl_notify_key_in_impl (MetaSeatImpl       *seat_impl,
     {
       changed_state = xkb_state_update_key (seat_impl->xkb, keycode,
                                             state ? XKB_KEY_DOWN : XKB_KEY_UP);
+      if (changed_state & XKB_STATE_MODS_EFFECTIVE)
+        meta_seat_impl_update_modifiers_in_impl (seat_impl);
     }
 
   if (!meta_input_device_native_process_kbd_a11y_event_in_impl (seat_impl->core_keyboard,
@@ -645,6 +763,37 @@ constrain_coordinates (MetaSeatImpl       *seat_impl,
     *y_out = y;
 }
 
+static void
+begin_state_update_in_impl (MetaSeatImpl *seat_impl)
+{
+  g_atomic_int_inc (&seat_impl->state_seq);
+}
+
+static void
+end_state_update_in_impl (MetaSeatImpl *seat_impl)
+{
+  g_atomic_int_inc (&seat_impl->state_seq);
+}
+
+void
+meta_seat_impl_update_modifiers_in_impl (MetaSeatImpl *seat_impl)
+{
+  ClutterModifierType modifiers = 0;
+
+  if (seat_impl->xkb)
+    {
+      modifiers = meta_xkb_translate_modifiers (seat_impl->xkb,
+                                                seat_impl->button_state);
+    }
+
+  if (modifiers == seat_impl->modifiers)
+    return;
+
+  begin_state_update_in_impl (seat_impl);
+  seat_impl->modifiers = modifiers;
+  end_state_update_in_impl (seat_impl);
+}
+
 static void
 update_device_coords_in_impl (MetaSeatImpl       *seat_impl,
                               ClutterInputDevice *input_device,
@@ -661,8 +810,10 @@ update_device_coords_in_impl (MetaSeatImpl       *seat_impl,
   else
     {
       device_native = META_INPUT_DEVICE_NATIVE (seat_impl->core_pointer);
+      begin_state_update_in_impl (seat_impl);
       seat_impl->pointer_x = coords.x;
       seat_impl->pointer_y = coords.y;
+      end_state_update_in_impl (seat_impl);
     }
 
   meta_input_device_native_set_coords_in_impl (device_native,
@@ -867,6 +1018,8 @@ meta_seat_impl_notify_button_in_impl (MetaSeatImpl       *seat_impl,
         seat_impl->button_state |= maskmap[button_nr - 1];
       else
         seat_impl->button_state &= ~maskmap[button_nr - 1];
+
+      meta_seat_impl_update_modifiers_in_impl (seat_impl);
     }
 
   if (clutter_input_device_get_device_type (input_device) == CLUTTER_TABLET_DEVICE)
@@ -2690,15 +2843,34 @@ static void
 process_events (MetaSeatImpl *seat_impl)
 {
   struct libinput_event *event;
+  int64_t batch_start_us;
 
   COGL_TRACE_BEGIN_SCOPED (MetaSeatImplProcessEvents,
                            "Meta::SeatImpl::process_events()");
 
+  seat_impl->batching_events = TRUE;
+  batch_start_us = g_get_monotonic_time ();
+
   while ((event = libinput_get_event (seat_impl->libinput)))
     {
+      int64_t now_us;
+
       process_event (seat_impl, event);
       libinput_event_destroy (event);
+
+      /* Don't let a long run of events, or a slow handler for one device,
+       * hold back the events of every other device already processed. */
+      now_us = g_get_monotonic_time ();
+      if (seat_impl->batched_events->len > 0 &&
+          now_us - batch_start_us > MAX_EVENT_BATCH_DURATION_US)
+        {
+          flush_batched_events (seat_impl);
+          batch_start_us = now_us;
+        }
     }
+
+  seat_impl->batching_events = FALSE;
+  flush_batched_events (seat_impl);
 }
 
 static int
@@ -2799,6 +2971,7 @@ meta_seat_impl_set_keyboard_numlock_in_impl (MetaSeatImpl *seat_impl,
                          locked_mods,
                          0, 0,
                          group_mods);
+  meta_seat_impl_update_modifiers_in_impl (seat_impl);
 
   meta_seat_impl_sync_leds_in_impl (seat_impl);
   meta_keymap_native_update_in_impl (seat_impl->keymap,
@@ -2922,13 +3095,21 @@ input_thread (MetaSeatImpl *seat_impl)
   MetaProfiler *profiler = meta_context_get_profiler (context);
 #endif
   struct xkb_keymap *xkb_keymap;
+  g_autofree char *thread_name = NULL;
+  const char *cpu_affinity;
+
+  thread_name = g_strdup_printf ("Mutter Input Thread (%s)", seat_impl->seat_id);
+
+  cpu_affinity = g_getenv ("MUTTER_DEBUG_INPUT_THREAD_CPUS");
+  if (cpu_affinity)
+    meta_set_thread_cpu_affinity (thread_name, cpu_affinity);
 
   g_main_context_push_thread_default (seat_impl->input_context);
 
 #ifdef HAVE_PROFILER
   meta_profiler_register_thread (profiler,
                                  seat_impl->input_context,
-                                 "Mutter Input Thread");
+                                 thread_name);
 #endif
 
   init_core_devices (seat_impl);
@@ -3135,6 +3316,9 @@ meta_seat_impl_finalize (GObject *object)
   g_assert (!seat_impl->libinput_source);
 
   g_free (seat_impl->seat_id);
+  g_ptr_array_unref (seat_impl->batched_events);
+  g_array_unref (seat_impl->queued_input_tasks);
+  g_mutex_clear (&seat_impl->queued_input_tasks_lock);
 
   g_rw_lock_clear (&seat_impl->state_lock);
 
@@ -3208,8 +3392,10 @@ init_pointer_position_in_impl (GTask *task)
   MetaInputDeviceNative *core_pointer =
     META_INPUT_DEVICE_NATIVE (seat_impl->core_pointer);
 
+  begin_state_update_in_impl (seat_impl);
   seat_impl->pointer_x = data->position.x;
   seat_impl->pointer_y = data->position.y;
+  end_state_update_in_impl (seat_impl);
   core_pointer->pointer_x = data->position.x;
   core_pointer->pointer_y = data->position.y;
   g_task_return_boolean (task, TRUE);
@@ -3249,6 +3435,43 @@ meta_seat_impl_init_pointer_position (MetaSeatImpl *seat_impl,
   g_cond_clear (&data.cond);
 }
 
+static void
+query_core_pointer_state (MetaSeatImpl        *seat_impl,
+                          graphene_point_t    *coords,
+                          ClutterModifierType *modifiers)
+{
+  float x = 0.0f, y = 0.0f;
+  ClutterModifierType mods = 0;
+  int seq;
+
+  /* The input thread may update the state right while it is being read,
+   * in which case the sequence number is odd, or has changed once done
+   * reading, and the read is retried. The final check is an atomic
+   * read-modify-write so the reads above can't be reordered after it.
+   */
+  do
+    {
+      seq = g_atomic_int_get (&seat_impl->state_seq);
+      if (seq & 1)
+        continue;
+
+      x = seat_impl->pointer_x;
+      y = seat_impl->pointer_y;
+      mods = seat_impl->modifiers;
+    }
+  while ((seq & 1) ||
+         !g_atomic_int_compare_and_exchange (&seat_impl->state_seq, seq, seq));
+
+  if (coords)
+    {
+      coords->x = x;
+      coords->y = y;
+    }
+
+  if (modifiers)
+    *modifiers = mods;
+}
+
 gboolean
 meta_seat_impl_query_state (MetaSeatImpl         *seat_impl,
                             ClutterInputDevice   *device,
@@ -3260,6 +3483,12 @@ meta_seat_impl_query_state (MetaSeatImpl         *seat_impl,
   gboolean retval = FALSE;
   ClutterModifierType mods = 0;
 
+  if (!sequence && device == seat_impl->core_pointer)
+    {
+      query_core_pointer_state (seat_impl, coords, modifiers);
+      return TRUE;
+    }
+
   g_rw_lock_reader_lock (&seat_impl->state_lock);
 
   if (sequence)
@@ -3400,6 +3629,12 @@ meta_seat_impl_init (MetaSeatImpl *seat_impl)
   g_cond_init (&seat_impl->init_cond);
 
   seat_impl->barrier_manager = meta_barrier_manager_native_new ();
+
+  seat_impl->batched_events = g_ptr_array_sized_new (64);
+
+  g_mutex_init (&seat_impl->queued_input_tasks_lock);
+  seat_impl->queued_input_tasks =
+    g_array_new (FALSE, FALSE, sizeof (MetaQueuedInputTask));
 }
 
 void
@@ -3429,6 +3664,7 @@ meta_seat_impl_update_xkb_state_in_impl (MetaSeatImpl *seat_impl)
                          latched_mods,
                          locked_mods,
                          0, 0, seat_impl->layout_idx);
+  meta_seat_impl_update_modifiers_in_impl (seat_impl);
 
   seat_impl->caps_lock_led =
     xkb_keymap_led_get_index (xkb_keymap, XKB_LED_NAME_CAPS);
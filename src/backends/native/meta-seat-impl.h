@@ -112,13 +112,30 @@ struct _MetaSeatImpl
   ClutterInputDevice *repeat_device;
   GSource *repeat_source;
 
+  /* The core pointer position and the modifier state may be read from
+   * any thread without taking state_lock. Updates happen in the input
+   * thread only, and are bracketed by state_seq, which is odd while an
+   * update is in progress.
+   */
+  int state_seq;
   float pointer_x;
   float pointer_y;
+  ClutterModifierType modifiers;
 
   /* Emulation of discrete scroll events out of smooth ones */
   float accum_scroll_dx;
   float accum_scroll_dy;
 
+  /* Events generated while processing libinput events, queued to the main
+   * thread in one go once done.
+   */
+  gboolean batching_events;
+  GPtrArray *batched_events;
+
+  /* Input tasks queued from the main thread, dispatched in one go */
+  GMutex queued_input_tasks_lock;
+  GArray *queued_input_tasks;
+
   gboolean released;
 };
 
@@ -139,6 +156,10 @@ void meta_seat_impl_run_input_task (MetaSeatImpl *seat_impl,
                                     GTask        *task,
                                     GSourceFunc   dispatch_func);
 
+void meta_seat_impl_queue_input_task (MetaSeatImpl *seat_impl,
+                                      GTask        *task,
+                                      GSourceFunc   dispatch_func);
+
 void meta_seat_impl_notify_key_in_impl (MetaSeatImpl       *seat_impl,
                                         ClutterInputDevice *device,
                                         uint64_t            time_us,
@@ -202,6 +223,8 @@ void meta_seat_impl_release_touch_state_in_impl (MetaSeatImpl   *seat_impl,
 
 void meta_seat_impl_update_xkb_state_in_impl (MetaSeatImpl *seat_impl);
 
+void meta_seat_impl_update_modifiers_in_impl (MetaSeatImpl *seat_impl);
+
 void  meta_seat_impl_release_devices (MetaSeatImpl *seat_impl);
 void  meta_seat_impl_reclaim_devices (MetaSeatImpl *seat_impl);
 
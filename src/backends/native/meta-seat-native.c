@@ -28,6 +28,8 @@
 
 #include "backends/native/meta-seat-native.h"
 
+#include <stdlib.h>
+
 #include "backends/meta-cursor-tracker-private.h"
 #include "backends/meta-keymap-utils.h"
 #include "backends/native/meta-barrier-native.h"
@@ -53,6 +55,18 @@ enum
 
 static GParamSpec *props[N_PROPS] = { NULL };
 
+/* Number of compiled keymaps kept around, so that switching back and forth
+ * between a handful of input sources doesn't recompile the XKB rules.
+ */
+#define MAX_CACHED_KEYMAPS 8
+
+typedef struct _MetaKeymapCacheEntry
+{
+  char *rmlvo;
+  struct xkb_keymap *keymap;
+  char *keymap_string;
+} MetaKeymapCacheEntry;
+
 G_DEFINE_TYPE (MetaSeatNative, meta_seat_native, CLUTTER_TYPE_SEAT)
 
 static gboolean
@@ -215,12 +229,22 @@ meta_seat_native_get_property (GObject    *object,
     }
 }
 
+static void
+keymap_cache_entry_free (MetaKeymapCacheEntry *entry)
+{
+  g_free (entry->rmlvo);
+  xkb_keymap_unref (entry->keymap);
+  free (entry->keymap_string);
+  g_free (entry);
+}
+
 static void
 meta_seat_native_dispose (GObject *object)
 {
   MetaSeatNative *seat = META_SEAT_NATIVE (object);
 
   g_clear_pointer (&seat->xkb_keymap, xkb_keymap_unref);
+  g_clear_pointer (&seat->keymap_cache, g_ptr_array_unref);
   g_clear_object (&seat->core_pointer);
   g_clear_object (&seat->core_keyboard);
   g_clear_pointer (&seat->impl, meta_seat_impl_destroy);
@@ -417,6 +441,8 @@ static void
 meta_seat_native_init (MetaSeatNative *seat)
 {
   seat->reserved_virtual_slots = g_hash_table_new (NULL, NULL);
+  seat->keymap_cache =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) keymap_cache_entry_free);
 }
 
 void
@@ -500,6 +526,73 @@ create_keymap (const char *layouts,
   return keymap;
 }
 
+static struct xkb_keymap *
+create_keymap_from_string (const char *keymap_string)
+{
+  struct xkb_keymap *keymap;
+  struct xkb_context *context;
+
+  context = meta_create_xkb_context ();
+  keymap = xkb_keymap_new_from_string (context, keymap_string,
+                                       XKB_KEYMAP_FORMAT_TEXT_V1,
+                                       XKB_KEYMAP_COMPILE_NO_FLAGS);
+  xkb_context_unref (context);
+
+  return keymap;
+}
+
+static MetaKeymapCacheEntry *
+lookup_cached_keymap (MetaSeatNative *seat,
+                      const char     *rmlvo)
+{
+  unsigned int i;
+
+  for (i = 0; i < seat->keymap_cache->len; i++)
+    {
+      MetaKeymapCacheEntry *entry = g_ptr_array_index (seat->keymap_cache, i);
+
+      if (g_strcmp0 (entry->rmlvo, rmlvo) != 0)
+        continue;
+
+      /* Keep the most recently used keymap first */
+      if (i > 0)
+        {
+          g_ptr_array_steal_index (seat->keymap_cache, i);
+          g_ptr_array_insert (seat->keymap_cache, 0, entry);
+        }
+
+      return entry;
+    }
+
+  return NULL;
+}
+
+static MetaKeymapCacheEntry *
+cache_keymap (MetaSeatNative    *seat,
+              const char        *rmlvo,
+              struct xkb_keymap *keymap)
+{
+  MetaKeymapCacheEntry *entry;
+  char *keymap_string;
+
+  keymap_string = xkb_keymap_get_as_string (keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+  if (!keymap_string)
+    return NULL;
+
+  entry = g_new0 (MetaKeymapCacheEntry, 1);
+  entry->rmlvo = g_strdup (rmlvo);
+  entry->keymap = xkb_keymap_ref (keymap);
+  entry->keymap_string = keymap_string;
+
+  if (seat->keymap_cache->len >= MAX_CACHED_KEYMAPS)
+    g_ptr_array_remove_index (seat->keymap_cache,
+                              seat->keymap_cache->len - 1);
+
+  g_ptr_array_insert (seat->keymap_cache, 0, entry);
+
+  return entry;
+}
+
 /**
  * meta_seat_native_set_keyboard_map: (skip)
  * @seat: the #ClutterSeat created by the evdev backend
@@ -517,16 +610,49 @@ meta_seat_native_set_keyboard_map (MetaSeatNative *seat,
                                    const char     *options,
                                    const char     *model)
 {
+  g_autofree char *rmlvo = NULL;
+  MetaKeymapCacheEntry *entry;
   struct xkb_keymap *keymap, *impl_keymap;
 
-  keymap = create_keymap (layouts, variants, options, model);
-  impl_keymap = create_keymap (layouts, variants, options, model);
+  rmlvo = g_strdup_printf ("%s\x1f%s\x1f%s\x1f%s\x1f%s",
+                           DEFAULT_XKB_RULES_FILE,
+                           model ? model : "",
+                           layouts ? layouts : "",
+                           variants ? variants : "",
+                           options ? options : "");
+
+  entry = lookup_cached_keymap (seat, rmlvo);
+  if (entry)
+    {
+      keymap = xkb_keymap_ref (entry->keymap);
+    }
+  else
+    {
+      keymap = create_keymap (layouts, variants, options, model);
+      if (keymap == NULL)
+        {
+          g_warning ("Unable to load configured keymap: rules=%s, model=%s, layout=%s, variant=%s, options=%s",
+                     DEFAULT_XKB_RULES_FILE, model, layouts,
+                     variants, options);
+          return;
+        }
+
+      entry = cache_keymap (seat, rmlvo, keymap);
+    }
+
+  /* The input thread needs a keymap of its own, as xkbcommon reference
+   * counting isn't thread safe. Parsing the already resolved keymap is a
+   * lot cheaper than going through the rules and includes again.
+   */
+  if (entry)
+    impl_keymap = create_keymap_from_string (entry->keymap_string);
+  else
+    impl_keymap = create_keymap (layouts, variants, options, model);
 
-  if (keymap == NULL)
+  if (impl_keymap == NULL)
     {
-      g_warning ("Unable to load configured keymap: rules=%s, model=%s, layout=%s, variant=%s, options=%s",
-                 DEFAULT_XKB_RULES_FILE, model, layouts,
-                 variants, options);
+      g_warning ("Unable to create keymap for the input thread");
+      xkb_keymap_unref (keymap);
       return;
     }
 
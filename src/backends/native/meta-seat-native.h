@@ -50,6 +50,7 @@ struct _MetaSeatNative
   GList *devices;
   struct xkb_keymap *xkb_keymap;
   xkb_layout_index_t xkb_layout_index;
+  GPtrArray *keymap_cache;
 
   ClutterInputDevice *core_pointer;
   ClutterInputDevice *core_keyboard;
@@ -19,7 +19,9 @@
 
 #include "backends/native/meta-thread-private.h"
 
+#include <errno.h>
 #include <glib.h>
+#include <sched.h>
 #include <sys/resource.h>
 
 #include "backends/meta-backend-private.h"
@@ -37,12 +39,16 @@ enum
   PROP_NAME,
   PROP_THREAD_TYPE,
   PROP_PREFERED_SCHEDULING_PRIORITY,
+  PROP_CPU_AFFINITY,
 
   N_PROPS
 };
 
 static GParamSpec *obj_props[N_PROPS];
 
+/* Number of callbacks each callback queue has room for up front */
+#define N_PREALLOCATED_CALLBACKS 16
+
 typedef struct _MetaThreadCallbackData
 {
   MetaThreadCallback callback;
@@ -59,7 +65,13 @@ typedef struct _MetaThreadCallbackSource
 
   MetaThread *thread;
   GMainContext *main_context;
-  GList *callbacks;
+
+  /* Queued callbacks are stored inline, and the array of a dispatched
+   * batch is kept as a spare, so that queuing a callback usually doesn't
+   * need to allocate anything. */
+  GArray *callbacks;
+  GArray *spare_callbacks;
+
   gboolean needs_flush;
 } MetaThreadCallbackSource;
 
@@ -72,6 +84,7 @@ typedef struct _MetaThreadPrivate
 
   MetaThreadImpl *impl;
   MetaSchedulingPriority preferred_scheduling_priority;
+  char *cpu_affinity;
   gboolean waiting_for_impl_task;
   GSource *wrapper_source;
 
@@ -123,11 +136,53 @@ meta_scheduling_priority_to_string (MetaSchedulingPriority priority)
 }
 
 static void
-meta_thread_callback_data_free (MetaThreadCallbackData *callback_data)
+meta_thread_callback_data_clear (MetaThreadCallbackData *callback_data)
 {
   if (callback_data->user_data_destroy)
     callback_data->user_data_destroy (callback_data->user_data);
-  g_free (callback_data);
+}
+
+static GArray *
+create_callback_array (void)
+{
+  GArray *callbacks;
+
+  callbacks = g_array_sized_new (FALSE, FALSE,
+                                 sizeof (MetaThreadCallbackData),
+                                 N_PREALLOCATED_CALLBACKS);
+
+  return callbacks;
+}
+
+/* Must be called with the callbacks mutex held */
+static GArray *
+steal_pending_callbacks (MetaThreadCallbackSource *callback_source)
+{
+  GArray *pending_callbacks;
+
+  if (callback_source->callbacks->len == 0)
+    return NULL;
+
+  pending_callbacks = callback_source->callbacks;
+  if (callback_source->spare_callbacks)
+    callback_source->callbacks = g_steal_pointer (&callback_source->spare_callbacks);
+  else
+    callback_source->callbacks = create_callback_array ();
+
+  return pending_callbacks;
+}
+
+/* Must be called with the callbacks mutex held */
+static void
+recycle_callbacks (MetaThreadCallbackSource *callback_source,
+                   GArray                   *callbacks)
+{
+  g_assert (callbacks->len == 0);
+
+  if (!callback_source->spare_callbacks)
+    callback_source->spare_callbacks = callbacks;
+  else
+    g_array_unref (callbacks);
 }
 
 static void
@@ -153,6 +208,9 @@ meta_thread_get_property (GObject    *object,
     case PROP_PREFERED_SCHEDULING_PRIORITY:
       g_value_set_enum (value, priv->preferred_scheduling_priority);
       break;
+    case PROP_CPU_AFFINITY:
+      g_value_set_string (value, priv->cpu_affinity);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -182,6 +240,9 @@ meta_thread_set_property (GObject      *object,
     case PROP_PREFERED_SCHEDULING_PRIORITY:
       priv->preferred_scheduling_priority = g_value_get_enum (value);
       break;
+    case PROP_CPU_AFFINITY:
+      priv->cpu_affinity = g_value_dup_string (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -396,6 +457,79 @@ request_normal_scheduling (MetaThread  *thread,
   return TRUE;
 }
 
+static gboolean
+parse_cpu_list (const char  *cpu_list,
+                cpu_set_t   *cpu_set,
+                GError     **error)
+{
+  g_auto (GStrv) ranges = NULL;
+  int i;
+
+  CPU_ZERO (cpu_set);
+
+  ranges = g_strsplit (cpu_list, ",", -1);
+  for (i = 0; ranges[i]; i++)
+    {
+      g_auto (GStrv) bounds = NULL;
+      guint64 first, last;
+      guint64 cpu;
+
+      bounds = g_strsplit (g_strstrip (ranges[i]), "-", 2);
+      if (!bounds[0] ||
+          !g_ascii_string_to_unsigned (bounds[0], 10, 0, CPU_SETSIZE - 1,
+                                       &first, error))
+        return FALSE;
+
+      last = first;
+      if (bounds[1] &&
+          !g_ascii_string_to_unsigned (bounds[1], 10, first, CPU_SETSIZE - 1,
+                                       &last, error))
+        return FALSE;
+
+      for (cpu = first; cpu <= last; cpu++)
+        CPU_SET (cpu, cpu_set);
+    }
+
+  if (CPU_COUNT (cpu_set) == 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Empty CPU list");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * Restricts the calling thread to the CPUs in @cpu_list, given in the
+ * same format as the kernel uses for CPU lists, e.g. "0-3,8". Threads
+ * created afterwards by the calling thread inherit the affinity.
+ */
+void
+meta_set_thread_cpu_affinity (const char *thread_name,
+                              const char *cpu_list)
+{
+  g_autoptr (GError) error = NULL;
+  cpu_set_t cpu_set;
+
+  if (!parse_cpu_list (cpu_list, &cpu_set, &error))
+    {
+      g_warning ("Invalid CPU affinity '%s' for thread '%s': %s",
+                 cpu_list, thread_name, error->message);
+      return;
+    }
+
+  if (sched_setaffinity (0, sizeof (cpu_set), &cpu_set) != 0)
+    {
+      g_warning ("Failed to set CPU affinity of thread '%s': %s",
+                 thread_name, g_strerror (errno));
+      return;
+    }
+
+  meta_topic (META_DEBUG_BACKEND, "Thread '%s' restricted to CPUs %s",
+              thread_name, cpu_list);
+}
+
 static gboolean
 can_use_realtime_scheduling_in_impl (MetaThread *thread)
 {
@@ -543,6 +677,9 @@ thread_impl_func (gpointer user_data)
 
   sync_scheduling_priority_in_impl (thread);
 
+  if (priv->cpu_affinity)
+    meta_set_thread_cpu_affinity (priv->name, priv->cpu_affinity);
+
   effective_scheduling_priority = determine_effective_thread_priority (thread);
 
   g_message ("Thread '%s' will be using %s scheduling",
@@ -814,6 +951,7 @@ meta_thread_finalize (GObject *object)
 
   g_clear_object (&priv->impl);
   g_clear_pointer (&priv->name, g_free);
+  g_clear_pointer (&priv->cpu_affinity, g_free);
 
   g_warn_if_fail (g_hash_table_size (priv->callback_sources) == 0);
   g_clear_pointer (&priv->callback_sources, g_hash_table_unref);
@@ -861,6 +999,13 @@ meta_thread_class_init (MetaThreadClass *klass)
                        G_PARAM_CONSTRUCT_ONLY |
                        G_PARAM_STATIC_STRINGS);
 
+  obj_props[PROP_CPU_AFFINITY] =
+    g_param_spec_string ("cpu-affinity", NULL, NULL,
+                         NULL,
+                         G_PARAM_READWRITE |
+                         G_PARAM_CONSTRUCT_ONLY |
+                         G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (object_class, N_PROPS, obj_props);
 }
 
@@ -914,20 +1059,26 @@ meta_thread_reset_thread_type (MetaThread     *thread,
 
 static int
 dispatch_callbacks (MetaThread *thread,
-                    GList      *pending_callbacks)
+                    GArray     *pending_callbacks)
 {
-  int callback_count = 0;
-  GList *l;
+  int callback_count;
+  unsigned int i;
+
+  if (!pending_callbacks)
+    return 0;
 
-  for (l = pending_callbacks; l; l = l->next)
+  for (i = 0; i < pending_callbacks->len; i++)
     {
-      MetaThreadCallbackData *callback_data = l->data;
+      MetaThreadCallbackData *callback_data =
+        &g_array_index (pending_callbacks, MetaThreadCallbackData, i);
 
       callback_data->callback (thread, callback_data->user_data);
-      meta_thread_callback_data_free (callback_data);
-      callback_count++;
+      meta_thread_callback_data_clear (callback_data);
     }
 
+  callback_count = pending_callbacks->len;
+  g_array_set_size (pending_callbacks, 0);
+
   return callback_count;
 }
 
@@ -937,7 +1088,7 @@ meta_thread_dispatch_callbacks (MetaThread   *thread,
 {
   MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
   MetaThreadCallbackSource *callback_source;
-  g_autoptr (GList) pending_callbacks = NULL;
+  g_autoptr (GArray) pending_callbacks = NULL;
 
   if (!main_context)
     main_context = g_main_context_default ();
@@ -947,7 +1098,7 @@ meta_thread_dispatch_callbacks (MetaThread   *thread,
   g_assert (callback_source->main_context == main_context);
 
   g_mutex_lock (&priv->callbacks_mutex);
-  pending_callbacks = g_steal_pointer (&callback_source->callbacks);
+  pending_callbacks = steal_pending_callbacks (callback_source);
   g_mutex_unlock (&priv->callbacks_mutex);
 
   dispatch_callbacks (thread, pending_callbacks);
@@ -981,19 +1132,28 @@ meta_thread_flush_callbacks (MetaThread *thread)
 
   while (TRUE)
     {
-      g_autoptr (GList) pending_callbacks = NULL;
+      g_autoptr (GArray) pending_callbacks = NULL;
       gboolean needs_reflush = FALSE;
       int i;
 
+      pending_callbacks = create_callback_array ();
+
       g_mutex_lock (&priv->callbacks_mutex);
       for (i = 0; i < main_thread_sources->len; i++)
         {
           MetaThreadCallbackSource *callback_source =
             g_ptr_array_index (main_thread_sources, i);
+          GArray *source_callbacks;
 
-          pending_callbacks =
-            g_list_concat (pending_callbacks,
-                           g_steal_pointer (&callback_source->callbacks));
+          source_callbacks = steal_pending_callbacks (callback_source);
+          if (!source_callbacks)
+            continue;
+
+          g_array_append_vals (pending_callbacks,
+                               source_callbacks->data,
+                               source_callbacks->len);
+          g_array_set_size (source_callbacks, 0);
+          recycle_callbacks (callback_source, source_callbacks);
         }
 
       callback_sources = g_hash_table_get_values (priv->callback_sources);
@@ -1038,7 +1198,7 @@ callback_source_prepare (GSource *source,
   *timeout = -1;
 
   g_mutex_lock (&priv->callbacks_mutex);
-  retval = !!callback_source->callbacks;
+  retval = callback_source->callbacks->len > 0;
   g_mutex_unlock (&priv->callbacks_mutex);
 
   return retval;
@@ -1053,17 +1213,20 @@ callback_source_dispatch (GSource     *source,
     (MetaThreadCallbackSource *) source;
   MetaThread *thread = callback_source->thread;
   MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
-  g_autoptr (GList) pending_callbacks = NULL;
+  GArray *pending_callbacks;
 
   g_mutex_lock (&priv->callbacks_mutex);
-  pending_callbacks = g_steal_pointer (&callback_source->callbacks);
+  pending_callbacks = steal_pending_callbacks (callback_source);
   g_mutex_unlock (&priv->callbacks_mutex);
 
   dispatch_callbacks (thread, pending_callbacks);
 
   g_mutex_lock (&priv->callbacks_mutex);
 
-  if (callback_source->callbacks)
+  if (pending_callbacks)
+    recycle_callbacks (callback_source, pending_callbacks);
+
+  if (callback_source->callbacks->len > 0)
     {
       g_source_set_ready_time (source, 0);
     }
@@ -1087,9 +1250,17 @@ callback_source_finalize (GSource *source)
 {
   MetaThreadCallbackSource *callback_source =
     (MetaThreadCallbackSource *) source;
+  unsigned int i;
 
-  g_list_free_full (callback_source->callbacks,
-                    (GDestroyNotify) meta_thread_callback_data_free);
+  for (i = 0; i < callback_source->callbacks->len; i++)
+    {
+      meta_thread_callback_data_clear (&g_array_index (callback_source->callbacks,
+                                                       MetaThreadCallbackData,
+                                                       i));
+    }
+
+  g_clear_pointer (&callback_source->callbacks, g_array_unref);
+  g_clear_pointer (&callback_source->spare_callbacks, g_array_unref);
 
   g_cond_clear (&callback_source->cond);
   g_mutex_clear (&callback_source->mutex);
@@ -1120,6 +1291,7 @@ meta_thread_register_callback_context (MetaThread   *thread,
   g_cond_init (&callback_source->cond);
   callback_source->thread = thread;
   callback_source->main_context = main_context;
+  callback_source->callbacks = create_callback_array ();
 
   g_source_set_ready_time (&callback_source->base, -1);
   g_source_set_priority (source, G_PRIORITY_HIGH + 1);
@@ -1156,7 +1328,7 @@ meta_thread_queue_callback (MetaThread         *thread,
   MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
   g_autoptr (GMutexLocker) locker;
   MetaThreadCallbackSource *callback_source;
-  MetaThreadCallbackData *callback_data;
+  MetaThreadCallbackData callback_data;
 
   if (!main_context)
     main_context = g_main_context_default ();
@@ -1166,8 +1338,7 @@ meta_thread_queue_callback (MetaThread         *thread,
   callback_source = g_hash_table_lookup (priv->callback_sources, main_context);
   g_return_if_fail (callback_source);
 
-  callback_data = g_new0 (MetaThreadCallbackData, 1);
-  *callback_data = (MetaThreadCallbackData) {
+  callback_data = (MetaThreadCallbackData) {
     .callback = callback ? callback : no_op_callback,
     .user_data = user_data,
     .user_data_destroy = user_data_destroy,
@@ -1175,9 +1346,12 @@ meta_thread_queue_callback (MetaThread         *thread,
 
   g_mutex_lock (&callback_source->mutex);
   callback_source->needs_flush = TRUE;
-  callback_source->callbacks = g_list_append (callback_source->callbacks,
-                                              callback_data);
-  g_source_set_ready_time (&callback_source->base, 0);
+  g_array_append_val (callback_source->callbacks, callback_data);
+
+  /* Only the first callback of a batch needs to wake up the context, the
+   * rest are dispatched together with it. */
+  if (callback_source->callbacks->len == 1)
+    g_source_set_ready_time (&callback_source->base, 0);
   g_mutex_unlock (&callback_source->mutex);
 }
 
@@ -247,8 +247,8 @@ meta_virtual_input_device_native_notify_relative_motion (ClutterVirtualInputDevi
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_relative_motion_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_relative_motion_in_impl);
   g_object_unref (task);
 }
 
@@ -293,8 +293,8 @@ meta_virtual_input_device_native_notify_absolute_motion (ClutterVirtualInputDevi
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_absolute_motion_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_absolute_motion_in_impl);
   g_object_unref (task);
 }
 
@@ -367,8 +367,8 @@ meta_virtual_input_device_native_notify_button (ClutterVirtualInputDevice *virtu
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_button_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_button_in_impl);
   g_object_unref (task);
 }
 
@@ -437,8 +437,8 @@ meta_virtual_input_device_native_notify_key (ClutterVirtualInputDevice *virtual_
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_key_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_key_in_impl);
   g_object_unref (task);
 }
 
@@ -627,8 +627,8 @@ meta_virtual_input_device_native_notify_keyval (ClutterVirtualInputDevice *virtu
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_keyval_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_keyval_in_impl);
   g_object_unref (task);
 }
 
@@ -706,8 +706,8 @@ meta_virtual_input_device_native_notify_discrete_scroll (ClutterVirtualInputDevi
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_discrete_scroll_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_discrete_scroll_in_impl);
   g_object_unref (task);
 }
 
@@ -769,8 +769,8 @@ meta_virtual_input_device_native_notify_scroll_continuous (ClutterVirtualInputDe
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_scroll_continuous_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_scroll_continuous_in_impl);
   g_object_unref (task);
 }
 
@@ -829,8 +829,8 @@ meta_virtual_input_device_native_notify_touch_down (ClutterVirtualInputDevice *v
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_touch_down_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_touch_down_in_impl);
   g_object_unref (task);
 }
 
@@ -889,8 +889,8 @@ meta_virtual_input_device_native_notify_touch_motion (ClutterVirtualInputDevice
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_touch_motion_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_touch_motion_in_impl);
   g_object_unref (task);
 }
 
@@ -945,8 +945,8 @@ meta_virtual_input_device_native_notify_touch_up (ClutterVirtualInputDevice *vir
 
   task = g_task_new (virtual_device, NULL, NULL, NULL);
   g_task_set_task_data (task, event, g_free);
-  meta_seat_impl_run_input_task (virtual_native->seat->impl, task,
-                                 (GSourceFunc) notify_touch_up_in_impl);
+  meta_seat_impl_queue_input_task (virtual_native->seat->impl, task,
+                                   (GSourceFunc) notify_touch_up_in_impl);
   g_object_unref (task);
 }
 
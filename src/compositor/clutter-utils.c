@@ -23,6 +23,7 @@
 
 #include "compositor/clutter-utils.h"
 
+#include <float.h>
 #include <math.h>
 
 #define FIXED_SHIFT 8
@@ -190,3 +191,42 @@ meta_actor_painting_untransformed (CoglFramebuffer *fb,
                                                 out_transforms);
 }
 
+/**
+ * meta_matrix_get_planar_transform:
+ * @matrix: a transformation matrix
+ * @out_planar: (out): return location for the planar transformation
+ *
+ * Checks whether @matrix maps the z = 0 plane onto itself without any
+ * projective component, and if so, retrieves the 2D affine transformation
+ * it applies to that plane.
+ *
+ * Unlike graphene_matrix_is_2d(), this ignores how @matrix transforms the
+ * z axis itself, so e.g. a z scale doesn't prevent region computations on
+ * flat actors.
+ *
+ * Returns: %TRUE if @matrix is planar
+ */
+gboolean
+meta_matrix_get_planar_transform (const graphene_matrix_t *matrix,
+                                  graphene_matrix_t       *out_planar)
+{
+  float m[16];
+
+  graphene_matrix_to_float (matrix, m);
+
+  /* Points on the z = 0 plane must stay on it, and w must stay 1 */
+  if (!G_APPROX_VALUE (m[2], 0.f, FLT_EPSILON) ||
+      !G_APPROX_VALUE (m[6], 0.f, FLT_EPSILON) ||
+      !G_APPROX_VALUE (m[14], 0.f, FLT_EPSILON) ||
+      !G_APPROX_VALUE (m[3], 0.f, FLT_EPSILON) ||
+      !G_APPROX_VALUE (m[7], 0.f, FLT_EPSILON) ||
+      !G_APPROX_VALUE (m[15], 1.f, FLT_EPSILON))
+    return FALSE;
+
+  graphene_matrix_init_from_2d (out_planar,
+                                m[0], m[1],
+                                m[4], m[5],
+                                m[12], m[13]);
+
+  return TRUE;
+}
@@ -38,3 +38,6 @@ gboolean meta_actor_painting_untransformed (CoglFramebuffer *fb,
                                             int              sample_widthf,
                                             int              sample_heightf,
                                             MetaTransforms  *out_transforms);
+
+gboolean meta_matrix_get_planar_transform (const graphene_matrix_t *matrix,
+                                           graphene_matrix_t       *out_planar);
@@ -6,6 +6,7 @@
 
 #include "clutter/clutter-mutter.h"
 #include "clutter/clutter.h"
+#include "compositor/meta-cache-registry.h"
 #include "compositor/meta-compositor-view.h"
 #include "compositor/meta-plugin-manager.h"
 #include "compositor/meta-window-actor-private.h"
@@ -41,7 +42,8 @@ struct _MetaCompositorClass
 void meta_compositor_remove_window_actor (MetaCompositor  *compositor,
                                           MetaWindowActor *window_actor);
 
-void meta_compositor_window_actor_stage_views_changed (MetaCompositor *compositor);
+void meta_compositor_window_actor_stage_views_changed (MetaCompositor  *compositor,
+                                                       MetaWindowActor *window_actor);
 
 void meta_switch_workspace_completed (MetaCompositor *compositor);
 
@@ -64,6 +66,13 @@ void meta_compositor_locate_pointer (MetaCompositor *compositor);
 
 gboolean meta_compositor_is_unredirect_inhibited (MetaCompositor *compositor);
 
+GVariant * meta_compositor_get_bypass_decisions (MetaCompositor *compositor);
+
+GVariant * meta_compositor_get_cache_stats (MetaCompositor *compositor);
+
+void meta_compositor_trim_caches (MetaCompositor     *compositor,
+                                  MetaCacheTrimLevel  level);
+
 MetaDisplay * meta_compositor_get_display (MetaCompositor *compositor);
 
 MetaWindowActor * meta_compositor_get_top_window_actor (MetaCompositor *compositor);
@@ -86,6 +95,8 @@ void meta_compositor_grab_end (MetaCompositor *compositor);
 
 void meta_compositor_destroy (MetaCompositor *compositor);
 
+void meta_compositor_schedule_prewarm_pipelines (MetaCompositor *compositor);
+
 gboolean meta_compositor_manage (MetaCompositor  *compositor,
                                  GVariant        *plugin_options,
                                  GError         **error);
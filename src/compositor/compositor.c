@@ -56,8 +56,12 @@
 
 #include "clutter/clutter-mutter.h"
 #include "cogl/cogl.h"
+#include "backends/meta-backend-private.h"
+#include "compositor/meta-background-content-private.h"
+#include "compositor/meta-background-image-private.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-later-private.h"
+#include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-window-actor-private.h"
 #include "compositor/meta-window-group-private.h"
 #include "core/util-private.h"
@@ -99,6 +103,13 @@ enum
 
 static GParamSpec *obj_props[N_PROPS] = { NULL, };
 
+/* Default ceiling of the glyphs kept in the shared texture atlases */
+#define DEFAULT_GLYPH_CACHE_MAX_SIZE_MB 32
+
+/* The fraction of unused space past which a shared texture atlas that
+ * grew beyond its initial size is compacted */
+#define ATLAS_COMPACTION_MAX_WASTE 0.5f
+
 typedef struct _MetaCompositorPrivate
 {
   GObject parent;
@@ -122,6 +133,8 @@ typedef struct _MetaCompositorPrivate
   ClutterActor *feedback_group;
 
   GList *windows;
+  /* Position of each window actor in the windows list, bottom first */
+  GHashTable *window_stack_indices;
 
   CoglContext *context;
 
@@ -141,6 +154,21 @@ typedef struct _MetaCompositorPrivate
   MetaWindowDrag *current_drag;
 
   MetaLaters *laters;
+
+  guint prewarm_pipelines_idle_id;
+
+  size_t glyph_cache_max_size;
+  unsigned int trim_texture_caches_later_id;
+
+  MetaCacheRegistry *cache_registry;
+  GMemoryMonitor *memory_monitor;
+  gulong low_memory_warning_id;
+
+  struct {
+    int max_width;
+    int max_height;
+    size_t memory_budget;
+  } thumbnail_cache;
 } MetaCompositorPrivate;
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (MetaCompositor, meta_compositor,
@@ -252,6 +280,41 @@ meta_compositor_get_feedback_group (MetaCompositor *compositor)
   return priv->feedback_group;
 }
 
+/**
+ * meta_compositor_set_thumbnail_cache:
+ * @compositor: a #MetaCompositor
+ * @max_width: The maximum width of the cached thumbnails
+ * @max_height: The maximum height of the cached thumbnails
+ * @memory_budget: The memory, in bytes, the cached thumbnails may use
+ *
+ * Keeps thumbnails of the topmost windows up to date in the background,
+ * as many as fit in @memory_budget, to be handed out by
+ * meta_window_actor_create_thumbnail() when called with the same
+ * @max_width and @max_height. Window switchers and overviews then only
+ * need to paint existing thumbnails when opening. Cached thumbnails that
+ * are not being shown are only updated when the main loop is idle.
+ *
+ * A @memory_budget of 0 disables the cache.
+ */
+void
+meta_compositor_set_thumbnail_cache (MetaCompositor *compositor,
+                                     int             max_width,
+                                     int             max_height,
+                                     size_t          memory_budget)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  g_return_if_fail (META_IS_COMPOSITOR (compositor));
+  g_return_if_fail (max_width >= 0 && max_height >= 0);
+
+  priv->thumbnail_cache.max_width = max_width;
+  priv->thumbnail_cache.max_height = max_height;
+  priv->thumbnail_cache.memory_budget = memory_budget;
+
+  update_thumbnail_cache (compositor);
+}
+
 /**
  * meta_compositor_get_window_actors:
  * @compositor: a #MetaCompositor
@@ -408,6 +471,7 @@ meta_compositor_remove_window_actor (MetaCompositor  *compositor,
     meta_compositor_get_instance_private (compositor);
 
   priv->windows = g_list_remove (priv->windows, window_actor);
+  g_hash_table_remove (priv->window_stack_indices, window_actor);
 }
 
 void
@@ -462,16 +526,83 @@ invalidate_top_window_actor_for_views (MetaCompositor *compositor)
 {
   MetaCompositorPrivate *priv =
     meta_compositor_get_instance_private (compositor);
+  ClutterStage *stage;
+  GList *l;
 
   g_assert (!priv->frame_in_progress);
 
   priv->needs_update_top_window_actors = TRUE;
+
+  if (!priv->backend)
+    return;
+
+  stage = CLUTTER_STAGE (meta_backend_get_stage (priv->backend));
+  for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
+    {
+      MetaCompositorView *compositor_view;
+
+      compositor_view = g_object_get_qdata (G_OBJECT (l->data),
+                                            quark_compositor_view);
+      if (compositor_view)
+        meta_compositor_view_invalidate_top_window_actor (compositor_view);
+    }
+}
+
+static gboolean
+is_window_actor_stacked_above (MetaCompositor  *compositor,
+                               MetaWindowActor *window_actor,
+                               MetaWindowActor *other_window_actor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  gpointer index, other_index;
+
+  if (!g_hash_table_lookup_extended (priv->window_stack_indices,
+                                     window_actor, NULL, &index) ||
+      !g_hash_table_lookup_extended (priv->window_stack_indices,
+                                     other_window_actor, NULL, &other_index))
+    return TRUE;
+
+  return GPOINTER_TO_INT (index) > GPOINTER_TO_INT (other_index);
 }
 
 void
-meta_compositor_window_actor_stage_views_changed (MetaCompositor *compositor)
+meta_compositor_window_actor_stage_views_changed (MetaCompositor  *compositor,
+                                                  MetaWindowActor *window_actor)
 {
-  invalidate_top_window_actor_for_views (compositor);
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterStage *stage =
+    CLUTTER_STAGE (meta_backend_get_stage (priv->backend));
+  GList *l;
+
+  g_assert (!priv->frame_in_progress);
+
+  /* A window below the top window of a view can't become the top window of
+   * that view by moving, so only the views where the window is or may
+   * become the top window need to be looked at again. */
+  for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
+    {
+      MetaCompositorView *compositor_view;
+      MetaWindowActor *top_window_actor;
+
+      compositor_view = g_object_get_qdata (G_OBJECT (l->data),
+                                            quark_compositor_view);
+      if (!compositor_view)
+        continue;
+
+      top_window_actor =
+        meta_compositor_view_get_top_window_actor (compositor_view);
+      if (top_window_actor &&
+          top_window_actor != window_actor &&
+          !is_window_actor_stacked_above (compositor,
+                                          window_actor,
+                                          top_window_actor))
+        continue;
+
+      meta_compositor_view_invalidate_top_window_actor (compositor_view);
+      priv->needs_update_top_window_actors = TRUE;
+    }
 }
 
 gboolean
@@ -550,94 +681,235 @@ meta_compositor_switch_workspace (MetaCompositor     *compositor,
     }
 }
 
+/*
+ * Marks the elements of @values that are part of a longest increasing
+ * subsequence, by setting @in_subsequence at the index of their value.
+ * The values must be unique, and smaller than @n_values.
+ */
+static void
+mark_longest_increasing_subsequence (const int *values,
+                                     int        n_values,
+                                     gboolean  *in_subsequence)
+{
+  g_autofree int *tails = NULL;
+  g_autofree int *predecessors = NULL;
+  int length = 0;
+  int i;
+
+  /* tails[k] is the index, into @values, of the smallest value ending an
+   * increasing subsequence of length k + 1 */
+  tails = g_new (int, n_values);
+  predecessors = g_new (int, n_values);
+
+  for (i = 0; i < n_values; i++)
+    {
+      int low = 0;
+      int high = length;
+
+      while (low < high)
+        {
+          int middle = (low + high) / 2;
+
+          if (values[tails[middle]] < values[i])
+            low = middle + 1;
+          else
+            high = middle;
+        }
+
+      predecessors[i] = low > 0 ? tails[low - 1] : -1;
+      tails[low] = i;
+      if (low == length)
+        length++;
+    }
+
+  for (i = length > 0 ? tails[length - 1] : -1; i != -1; i = predecessors[i])
+    in_subsequence[values[i]] = TRUE;
+}
+
+/*
+ * Keeps thumbnails of the topmost windows that window switchers would
+ * show, within the memory budget, and drops the ones of all others.
+ */
+static void
+update_thumbnail_cache (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  size_t thumbnail_size;
+  size_t n_cached = 0;
+  size_t max_cached = 0;
+  GList *l;
+
+  thumbnail_size = ((size_t) priv->thumbnail_cache.max_width *
+                    (size_t) priv->thumbnail_cache.max_height * 4);
+  if (thumbnail_size > 0)
+    max_cached = priv->thumbnail_cache.memory_budget / thumbnail_size;
+
+  for (l = g_list_last (priv->windows); l; l = l->prev)
+    {
+      MetaWindowActor *window_actor = l->data;
+      MetaWindow *window = meta_window_actor_get_meta_window (window_actor);
+
+      if (n_cached < max_cached &&
+          window &&
+          !meta_window_is_override_redirect (window) &&
+          !meta_window_is_skip_taskbar (window))
+        {
+          meta_window_actor_set_cached_thumbnail_size (window_actor,
+                                                       priv->thumbnail_cache.max_width,
+                                                       priv->thumbnail_cache.max_height);
+          n_cached++;
+        }
+      else
+        {
+          meta_window_actor_set_cached_thumbnail_size (window_actor, 0, 0);
+        }
+    }
+}
+
 static void
 sync_actor_stacking (MetaCompositor *compositor)
 {
   MetaCompositorPrivate *priv =
     meta_compositor_get_instance_private (compositor);
-  GList *children;
-  GList *expected_window_node;
-  GList *tmp;
-  GList *old;
+  ClutterActor *window_group = priv->window_group;
+  g_autoptr (GHashTable) window_indices = NULL;
+  g_autofree ClutterActor **windows = NULL;
+  g_autofree int *current_order = NULL;
+  g_autofree gboolean *in_place = NULL;
+  ClutterActor *child;
   GList *backgrounds;
+  GList *l;
   gboolean has_windows;
-  gboolean reordered;
+  gboolean backgrounds_reordered;
+  int n_windows;
+  int n_current;
+  int first_in_place;
+  int i;
 
   /* NB: The first entries in the lists are stacked the lowest */
 
   /* Restacking will trigger full screen redraws, so it's worth a
-   * little effort to make sure we actually need to restack before
-   * we go ahead and do it */
-
-  children = clutter_actor_get_children (priv->window_group);
-  has_windows = FALSE;
-  reordered = FALSE;
+   * little effort to only move the actors that are out of place. The
+   * window actors that can stay are a longest subsequence of them that
+   * is already in the right order; all others are moved right above the
+   * window that is expected below them.
+   */
 
   /* We allow for actors in the window group other than the actors we
    * know about, but it's up to a plugin to try and keep them stacked correctly
    * (we really need extra API to make that reliable.)
    */
 
-  /* First we collect a list of all backgrounds, and check if they're at the
-   * bottom. Then we check if the window actors are in the correct sequence */
+  /* Window actors can be parented to other actors than the window group,
+   * to allow stacking to work with intermediate actors (e.g. during
+   * effects). Those are restacked within their parent by lowering them in
+   * turn to the bottom of the stack. */
+  for (l = g_list_last (priv->windows); l; l = l->prev)
+    {
+      ClutterActor *actor = l->data, *parent;
+
+      parent = clutter_actor_get_parent (actor);
+      if (parent && parent != window_group)
+        clutter_actor_set_child_below_sibling (parent, actor, NULL);
+    }
+
+  n_windows = 0;
+  windows = g_new (ClutterActor *, g_list_length (priv->windows));
+  window_indices = g_hash_table_new (NULL, NULL);
+  g_hash_table_remove_all (priv->window_stack_indices);
+  for (l = priv->windows, i = 0; l; l = l->next, i++)
+    {
+      ClutterActor *actor = l->data;
+
+      g_hash_table_insert (priv->window_stack_indices,
+                           actor, GINT_TO_POINTER (i));
+
+      if (clutter_actor_get_parent (actor) != window_group)
+        continue;
+
+      g_hash_table_insert (window_indices, actor, GINT_TO_POINTER (n_windows));
+      windows[n_windows++] = actor;
+    }
+
+  /* Collect the backgrounds, checking if they're at the bottom, and the
+   * expected position of each window actor in the current order */
   backgrounds = NULL;
-  expected_window_node = priv->windows;
-  for (old = children; old != NULL; old = old->next)
+  has_windows = FALSE;
+  backgrounds_reordered = FALSE;
+  n_current = 0;
+  current_order = g_new (int, n_windows);
+  for (child = clutter_actor_get_first_child (window_group);
+       child;
+       child = clutter_actor_get_next_sibling (child))
     {
-      ClutterActor *actor = old->data;
+      gpointer index;
 
-      if (META_IS_BACKGROUND_GROUP (actor) ||
-          META_IS_BACKGROUND_ACTOR (actor))
+      if (META_IS_BACKGROUND_GROUP (child) ||
+          META_IS_BACKGROUND_ACTOR (child))
         {
-          backgrounds = g_list_prepend (backgrounds, actor);
+          backgrounds = g_list_prepend (backgrounds, child);
 
           if (has_windows)
-            reordered = TRUE;
+            backgrounds_reordered = TRUE;
         }
-      else if (META_IS_WINDOW_ACTOR (actor) && !reordered)
+      else if (g_hash_table_lookup_extended (window_indices, child,
+                                             NULL, &index))
         {
           has_windows = TRUE;
-
-          if (expected_window_node != NULL && actor == expected_window_node->data)
-            expected_window_node = expected_window_node->next;
-          else
-            reordered = TRUE;
+          current_order[n_current++] = GPOINTER_TO_INT (index);
         }
     }
 
-  g_list_free (children);
+  g_assert (n_current == n_windows);
 
-  if (!reordered)
+  in_place = g_new0 (gboolean, n_windows);
+  mark_longest_increasing_subsequence (current_order, n_windows, in_place);
+
+  first_in_place = -1;
+  for (i = 0; i < n_windows; i++)
     {
-      g_list_free (backgrounds);
-      return;
+      if (in_place[i])
+        {
+          first_in_place = i;
+          break;
+        }
     }
 
-  /* reorder the actors by lowering them in turn to the bottom of the stack.
-   * windows first, then background.
-   *
-   * We reorder the actors even if they're not parented to the window group,
-   * to allow stacking to work with intermediate actors (eg during effects)
-   */
-  for (tmp = g_list_last (priv->windows); tmp != NULL; tmp = tmp->prev)
+  /* Windows expected below the lowest window that is in place go right
+   * below it, all others right above the window expected below them */
+  for (i = first_in_place - 1; i >= 0; i--)
     {
-      ClutterActor *actor = tmp->data, *parent;
+      clutter_actor_set_child_below_sibling (window_group,
+                                             windows[i],
+                                             windows[i + 1]);
+    }
 
-      parent = clutter_actor_get_parent (actor);
-      clutter_actor_set_child_below_sibling (parent, actor, NULL);
+  for (i = first_in_place + 1; i < n_windows; i++)
+    {
+      if (in_place[i])
+        continue;
+
+      clutter_actor_set_child_above_sibling (window_group,
+                                             windows[i],
+                                             windows[i - 1]);
     }
 
   /* we prepended the backgrounds above so the last actor in the list
    * should get lowered to the bottom last.
    */
-  for (tmp = backgrounds; tmp != NULL; tmp = tmp->next)
+  if (backgrounds_reordered)
     {
-      ClutterActor *actor = tmp->data, *parent;
+      for (l = backgrounds; l; l = l->next)
+        {
+          ClutterActor *actor = l->data;
 
-      parent = clutter_actor_get_parent (actor);
-      clutter_actor_set_child_below_sibling (parent, actor, NULL);
+          clutter_actor_set_child_below_sibling (window_group, actor, NULL);
+        }
     }
   g_list_free (backgrounds);
+
+  update_thumbnail_cache (compositor);
 }
 
 /*
@@ -819,6 +1091,7 @@ maybe_update_top_window_actor_for_views (MetaCompositor *compositor)
 {
   MetaCompositorPrivate *priv =
     meta_compositor_get_instance_private (compositor);
+  g_autoptr (GPtrArray) pending_views = NULL;
   ClutterStage *stage;
   GList *l;
 
@@ -832,6 +1105,7 @@ maybe_update_top_window_actor_for_views (MetaCompositor *compositor)
 
   stage = CLUTTER_STAGE (meta_backend_get_stage (priv->backend));
 
+  pending_views = g_ptr_array_new ();
   for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
     {
       ClutterStageView *stage_view = l->data;
@@ -842,8 +1116,56 @@ maybe_update_top_window_actor_for_views (MetaCompositor *compositor)
 
       g_assert (compositor_view != NULL);
 
-      meta_compositor_view_update_top_window_actor (compositor_view,
-                                                    priv->windows);
+      if (meta_compositor_view_needs_top_window_actor_update (compositor_view))
+        g_ptr_array_add (pending_views, compositor_view);
+    }
+
+  /* Walk down the stack once for all views, until each has found the
+   * topmost visible window overlapping it */
+  for (l = g_list_last (priv->windows);
+       l && pending_views->len > 0;
+       l = l->prev)
+    {
+      MetaWindowActor *window_actor = l->data;
+      MetaWindow *window = meta_window_actor_get_meta_window (window_actor);
+      MtkRectangle buffer_rect;
+      unsigned int i;
+
+      if (!window->visible_to_compositor)
+        continue;
+
+      meta_window_get_buffer_rect (window, &buffer_rect);
+
+      i = 0;
+      while (i < pending_views->len)
+        {
+          MetaCompositorView *compositor_view =
+            g_ptr_array_index (pending_views, i);
+          ClutterStageView *stage_view =
+            meta_compositor_view_get_stage_view (compositor_view);
+          MtkRectangle view_layout;
+
+          clutter_stage_view_get_layout (stage_view, &view_layout);
+
+          if (mtk_rectangle_overlap (&view_layout, &buffer_rect))
+            {
+              meta_compositor_view_set_top_window_actor (compositor_view,
+                                                         window_actor);
+              g_ptr_array_remove_index_fast (pending_views, i);
+            }
+          else
+            {
+              i++;
+            }
+        }
+    }
+
+  while (pending_views->len > 0)
+    {
+      MetaCompositorView *compositor_view =
+        g_ptr_array_steal_index_fast (pending_views, 0);
+
+      meta_compositor_view_set_top_window_actor (compositor_view, NULL);
     }
 }
 
@@ -869,6 +1191,7 @@ meta_compositor_ensure_compositor_views (MetaCompositor *compositor)
 
       compositor_view = meta_compositor_create_view (compositor,
                                                      stage_view);
+      priv->needs_update_top_window_actors = TRUE;
 
       g_object_set_qdata_full (G_OBJECT (stage_view),
                                quark_compositor_view,
@@ -956,6 +1279,57 @@ meta_compositor_before_paint (MetaCompositor     *compositor,
   META_COMPOSITOR_GET_CLASS (compositor)->before_paint (compositor, compositor_view);
 }
 
+static gboolean
+trim_texture_caches (gpointer user_data)
+{
+  MetaCompositor *compositor = user_data;
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+
+  COGL_TRACE_BEGIN_SCOPED (MetaCompositorTrimTextureCaches,
+                           "Meta::Compositor::trim_texture_caches()");
+
+  priv->trim_texture_caches_later_id = 0;
+
+  /* Evicting glyphs leaves holes in the atlases, so do it first */
+  clutter_context_trim_glyph_cache (clutter_context,
+                                    priv->glyph_cache_max_size);
+  cogl_atlas_texture_compact_atlases (priv->context,
+                                      ATLAS_COMPACTION_MAX_WASTE);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Texture atlases only ever grow while texts and icons come and go, so
+ * check after each frame whether they are worth trimming, and do so once
+ * idle to not delay the next frames.
+ */
+static void
+maybe_schedule_trim_texture_caches (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+
+  if (priv->trim_texture_caches_later_id)
+    return;
+
+  if (clutter_context_get_glyph_cache_size (clutter_context) <=
+      priv->glyph_cache_max_size &&
+      !cogl_atlas_texture_atlases_need_compaction (priv->context,
+                                                   ATLAS_COMPACTION_MAX_WASTE))
+    return;
+
+  priv->trim_texture_caches_later_id =
+    meta_laters_add (priv->laters, META_LATER_IDLE,
+                     trim_texture_caches,
+                     compositor, NULL);
+}
+
 static void
 meta_compositor_real_after_paint (MetaCompositor     *compositor,
                                   MetaCompositorView *compositor_view)
@@ -1002,6 +1376,9 @@ meta_compositor_real_after_paint (MetaCompositor     *compositor,
       if (g_list_find (actor_stage_views, stage_view))
         meta_window_actor_after_paint (META_WINDOW_ACTOR (actor), stage_view);
     }
+
+  maybe_schedule_trim_texture_caches (compositor);
+  meta_cache_registry_update_counters (priv->cache_registry);
 }
 
 static void
@@ -1117,9 +1494,205 @@ meta_compositor_get_property (GObject    *object,
 static void
 meta_compositor_init (MetaCompositor *compositor)
 {
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  priv->window_stack_indices = g_hash_table_new (NULL, NULL);
+
   invalidate_top_window_actor_for_views (compositor);
 }
 
+static size_t
+get_glyph_cache_max_size (void)
+{
+  const char *max_size_env;
+  uint64_t max_size_mb = DEFAULT_GLYPH_CACHE_MAX_SIZE_MB;
+
+  max_size_env = g_getenv ("MUTTER_DEBUG_GLYPH_CACHE_MAX_SIZE");
+  if (max_size_env)
+    {
+      g_autoptr (GError) error = NULL;
+
+      if (!g_ascii_string_to_unsigned (max_size_env, 10, 1, G_MAXSIZE >> 20,
+                                       &max_size_mb, &error))
+        {
+          g_warning ("Invalid MUTTER_DEBUG_GLYPH_CACHE_MAX_SIZE: %s",
+                     error->message);
+          max_size_mb = DEFAULT_GLYPH_CACHE_MAX_SIZE_MB;
+        }
+    }
+
+  return (size_t) max_size_mb << 20;
+}
+
+static void
+get_glyph_cache_stats (gpointer      user_data,
+                       size_t       *out_size,
+                       unsigned int *out_n_entries)
+{
+  MetaCompositorPrivate *priv = user_data;
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+
+  *out_size = clutter_context_get_glyph_cache_size (clutter_context);
+}
+
+static void
+trim_glyph_cache (MetaCacheTrimLevel  level,
+                  gpointer            user_data)
+{
+  MetaCompositorPrivate *priv = user_data;
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+  size_t max_size;
+
+  if (level == META_CACHE_TRIM_LEVEL_LOW)
+    max_size = priv->glyph_cache_max_size / 2;
+  else
+    max_size = 0;
+
+  clutter_context_trim_glyph_cache (clutter_context, max_size);
+}
+
+static void
+get_atlases_stats (gpointer      user_data,
+                   size_t       *out_size,
+                   unsigned int *out_n_entries)
+{
+  MetaCompositorPrivate *priv = user_data;
+
+  *out_size = cogl_atlas_texture_get_atlases_size (priv->context);
+}
+
+static void
+trim_atlases (MetaCacheTrimLevel  level,
+              gpointer            user_data)
+{
+  MetaCompositorPrivate *priv = user_data;
+
+  /* Evicted glyphs left holes in the atlases, shrink them to what is left */
+  cogl_atlas_texture_compact_atlases (priv->context,
+                                      level == META_CACHE_TRIM_LEVEL_CRITICAL ?
+                                      0.0f : ATLAS_COMPACTION_MAX_WASTE);
+}
+
+static void
+get_clutter_pipeline_cache_stats (gpointer      user_data,
+                                  size_t       *out_size,
+                                  unsigned int *out_n_entries)
+{
+  MetaCompositorPrivate *priv = user_data;
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+  ClutterPipelineCache *pipeline_cache =
+    clutter_context_get_pipeline_cache (clutter_context);
+
+  *out_n_entries = clutter_pipeline_cache_get_n_pipelines (pipeline_cache);
+}
+
+static void
+trim_clutter_pipeline_cache (MetaCacheTrimLevel  level,
+                             gpointer            user_data)
+{
+  MetaCompositorPrivate *priv = user_data;
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+  ClutterPipelineCache *pipeline_cache =
+    clutter_context_get_pipeline_cache (clutter_context);
+
+  clutter_pipeline_cache_clear (pipeline_cache);
+}
+
+static void
+get_cogl_pipeline_cache_stats (gpointer      user_data,
+                               size_t       *out_size,
+                               unsigned int *out_n_entries)
+{
+  MetaCompositorPrivate *priv = user_data;
+
+  *out_n_entries = cogl_context_get_pipeline_cache_size (priv->context);
+}
+
+static void
+trim_cogl_pipeline_cache (MetaCacheTrimLevel  level,
+                          gpointer            user_data)
+{
+  MetaCompositorPrivate *priv = user_data;
+
+  cogl_context_trim_pipeline_cache (priv->context);
+}
+
+static void
+get_background_image_cache_stats (gpointer      user_data,
+                                  size_t       *out_size,
+                                  unsigned int *out_n_entries)
+{
+  MetaBackgroundImageCache *cache = meta_background_image_cache_get_default ();
+
+  *out_size = meta_background_image_cache_get_size (cache, out_n_entries);
+}
+
+/*
+ * Caches are trimmed from the cheapest to refill to the most expensive:
+ * glyphs are rasterized again in a few microseconds each, while dropping
+ * the Cogl pipeline cache means compiling and linking shaders again.
+ */
+static MetaCacheRegistry *
+create_cache_registry (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  MetaCacheRegistry *registry;
+
+  registry = meta_cache_registry_new ();
+  meta_cache_registry_add_cache (registry, "glyphs",
+                                 META_CACHE_TRIM_LEVEL_LOW,
+                                 get_glyph_cache_stats,
+                                 trim_glyph_cache,
+                                 priv);
+  meta_cache_registry_add_cache (registry, "atlases",
+                                 META_CACHE_TRIM_LEVEL_LOW,
+                                 get_atlases_stats,
+                                 trim_atlases,
+                                 priv);
+  meta_cache_registry_add_cache (registry, "clutter-pipelines",
+                                 META_CACHE_TRIM_LEVEL_MEDIUM,
+                                 get_clutter_pipeline_cache_stats,
+                                 trim_clutter_pipeline_cache,
+                                 priv);
+  meta_cache_registry_add_cache (registry, "cogl-pipelines",
+                                 META_CACHE_TRIM_LEVEL_CRITICAL,
+                                 get_cogl_pipeline_cache_stats,
+                                 trim_cogl_pipeline_cache,
+                                 priv);
+  meta_cache_registry_add_cache (registry, "background-images",
+                                 META_CACHE_TRIM_LEVEL_LOW,
+                                 get_background_image_cache_stats,
+                                 NULL,
+                                 priv);
+
+  return registry;
+}
+
+static void
+on_low_memory_warning (GMemoryMonitor             *memory_monitor,
+                       GMemoryMonitorWarningLevel  warning_level,
+                       MetaCompositor             *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  MetaCacheTrimLevel level;
+
+  if (warning_level >= G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL)
+    level = META_CACHE_TRIM_LEVEL_CRITICAL;
+  else if (warning_level >= G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM)
+    level = META_CACHE_TRIM_LEVEL_MEDIUM;
+  else
+    level = META_CACHE_TRIM_LEVEL_LOW;
+
+  meta_cache_registry_trim (priv->cache_registry, level);
+}
+
 static void
 meta_compositor_constructed (GObject *object)
 {
@@ -1158,12 +1731,130 @@ meta_compositor_constructed (GObject *object)
                       compositor);
 
   priv->laters = meta_laters_new (compositor);
+  priv->glyph_cache_max_size = get_glyph_cache_max_size ();
+
+  priv->cache_registry = create_cache_registry (compositor);
+  priv->memory_monitor = g_memory_monitor_dup_default ();
+  priv->low_memory_warning_id =
+    g_signal_connect (priv->memory_monitor,
+                      "low-memory-warning",
+                      G_CALLBACK (on_low_memory_warning),
+                      compositor);
 
   G_OBJECT_CLASS (meta_compositor_parent_class)->constructed (object);
 
   meta_compositor_ensure_compositor_views (compositor);
 }
 
+static GPtrArray *
+get_prewarm_target_color_states (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterActor *stage = meta_backend_get_stage (priv->backend);
+  GPtrArray *color_states;
+  GList *l;
+
+  color_states = g_ptr_array_new ();
+
+  for (l = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage)); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      ClutterColorState *color_state =
+        clutter_stage_view_get_color_state (view);
+
+      if (!g_ptr_array_find_with_equal_func (color_states, color_state,
+                                             (GEqualFunc) clutter_color_state_equals,
+                                             NULL))
+        g_ptr_array_add (color_states, color_state);
+    }
+
+  return color_states;
+}
+
+static gboolean
+prewarm_pipelines (gpointer user_data)
+{
+  MetaCompositor *compositor = user_data;
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+  ClutterColorManager *color_manager =
+    clutter_context_get_color_manager (clutter_context);
+  ClutterColorState *default_color_state =
+    clutter_color_manager_get_default_color_state (color_manager);
+  CoglContext *cogl_context = priv->context;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (GPtrArray) target_color_states = NULL;
+  g_autoptr (GError) error = NULL;
+  CoglFramebuffer *framebuffer;
+  unsigned int i;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaCompositorPrewarmPipelines,
+                           "Meta::Compositor::prewarm_pipelines()");
+
+  priv->prewarm_pipelines_idle_id = 0;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, 1, 1);
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  framebuffer = COGL_FRAMEBUFFER (offscreen);
+  if (!cogl_framebuffer_allocate (framebuffer, &error))
+    {
+      g_debug ("Failed to allocate framebuffer for pre-warming pipelines: %s",
+               error->message);
+      return G_SOURCE_REMOVE;
+    }
+
+  /* The color transformation snippets depend on the color state of the
+   * monitor the surface is painted on */
+  target_color_states = get_prewarm_target_color_states (compositor);
+  if (target_color_states->len == 0)
+    g_ptr_array_add (target_color_states, default_color_state);
+
+  for (i = 0; i < target_color_states->len; i++)
+    {
+      g_autoptr (ClutterPaintContext) paint_context = NULL;
+
+      paint_context =
+        clutter_paint_context_new_for_framebuffer (framebuffer, NULL,
+                                                   CLUTTER_PAINT_FLAG_NONE,
+                                                   target_color_states->pdata[i]);
+      meta_shaped_texture_prewarm_pipelines (clutter_context,
+                                             default_color_state,
+                                             paint_context);
+    }
+
+  meta_background_content_prewarm_pipelines (framebuffer);
+  clutter_blur_prewarm (cogl_context);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Builds the GLSL programs of the pipelines used to paint common surfaces,
+ * backgrounds and blurs from an idle callback, so that the first frames
+ * painted after startup don't have to wait for shader compilation.
+ */
+void
+meta_compositor_schedule_prewarm_pipelines (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  if (priv->prewarm_pipelines_idle_id)
+    return;
+
+  /* Use the default priority rather than an idle one, so that this runs
+   * before clients get a chance to map their first windows */
+  priv->prewarm_pipelines_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT,
+                                                     prewarm_pipelines,
+                                                     compositor, NULL);
+  g_source_set_name_by_id (priv->prewarm_pipelines_idle_id,
+                           "[mutter] prewarm_pipelines");
+}
+
 static void
 meta_compositor_dispose (GObject *object)
 {
@@ -1172,14 +1863,27 @@ meta_compositor_dispose (GObject *object)
     meta_compositor_get_instance_private (compositor);
   ClutterActor *stage = meta_backend_get_stage (priv->backend);
 
+  if (priv->trim_texture_caches_later_id)
+    {
+      meta_laters_remove (priv->laters, priv->trim_texture_caches_later_id);
+      priv->trim_texture_caches_later_id = 0;
+    }
+
   g_clear_object (&priv->laters);
 
+  g_clear_signal_handler (&priv->low_memory_warning_id, priv->memory_monitor);
+  g_clear_object (&priv->memory_monitor);
+  g_clear_pointer (&priv->cache_registry, meta_cache_registry_free);
+
+  g_clear_handle_id (&priv->prewarm_pipelines_idle_id, g_source_remove);
+
   g_clear_signal_handler (&priv->stage_presented_id, stage);
   g_clear_signal_handler (&priv->before_paint_handler_id, stage);
   g_clear_signal_handler (&priv->after_paint_handler_id, stage);
   g_clear_signal_handler (&priv->window_visibility_updated_id, priv->display);
 
   g_clear_pointer (&priv->windows, g_list_free);
+  g_clear_pointer (&priv->window_stack_indices, g_hash_table_unref);
 
   G_OBJECT_CLASS (meta_compositor_parent_class)->dispose (object);
 }
@@ -1268,6 +1972,65 @@ meta_compositor_is_unredirect_inhibited (MetaCompositor *compositor)
   return priv->disable_unredirect_count > 0;
 }
 
+/* Returns the bypass decision of each view, for debug-control */
+GVariant *
+meta_compositor_get_bypass_decisions (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterStage *stage =
+    CLUTTER_STAGE (meta_backend_get_stage (priv->backend));
+  GVariantBuilder builder;
+  GList *l;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(sbuu)}"));
+
+  for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
+    {
+      ClutterStageView *stage_view = l->data;
+      MetaCompositorView *compositor_view;
+      MetaBypassPolicy *bypass_policy;
+      const char *view_name;
+
+      compositor_view = g_object_get_qdata (G_OBJECT (stage_view),
+                                            quark_compositor_view);
+      if (!compositor_view)
+        continue;
+
+      bypass_policy = meta_compositor_view_get_bypass_policy (compositor_view);
+      view_name = clutter_stage_view_get_name (stage_view);
+      g_variant_builder_add (&builder, "{s(sbuu)}",
+                             view_name ? view_name : "",
+                             meta_bypass_decision_to_string (bypass_policy->decision),
+                             bypass_policy->is_bypassed,
+                             bypass_policy->n_transitions,
+                             bypass_policy->n_failures);
+    }
+
+  return g_variant_builder_end (&builder);
+}
+
+/* Returns the size and number of entries of each cache, for debug-control */
+GVariant *
+meta_compositor_get_cache_stats (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  return meta_cache_registry_get_stats (priv->cache_registry);
+}
+
+/* Trims the caches as if the system was low on memory, for debug-control */
+void
+meta_compositor_trim_caches (MetaCompositor     *compositor,
+                             MetaCacheTrimLevel  level)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  meta_cache_registry_trim (priv->cache_registry, level);
+}
+
 #define FLASH_TIME_MS 50
 
 static void
@@ -64,6 +64,13 @@ is_window_relevant_for_edges (MetaWindow *window)
     }
 }
 
+static inline int
+get_edge_position (const MetaEdge *edge,
+                   gboolean        horizontal)
+{
+  return horizontal ? edge->rect.x : edge->rect.y;
+}
+
 /* !WARNING!: this function can return invalid indices (namely, either -1 or
  * edges->len); this is by design, but you need to remember this.
  */
@@ -87,87 +94,35 @@ find_index_of_edge_near_position (const GArray *edges,
    *         316              FALSE               4
    *           2              FALSE              -1
    *        2000               TRUE               9
+   *
+   * Many edges can share the same position (e.g. the sides of maximized
+   * or tiled windows), so rather than finding any edge at the position
+   * and walking over its equals, bisect straight to the boundary of the
+   * range; that keeps this logarithmic in the number of edges.
    */
-  int low, high, mid;
-  int compare;
-  MetaEdge *edge;
+  int low, high;
 
-  /* Initialize mid, edge, & compare in the off change that the array only
-   * has one element.
+  /* Find the first edge past the position, or the first one at it if
+   * we want the minimum of the interval.
    */
-  mid  = 0;
-  edge = g_array_index (edges, MetaEdge*, mid);
-  compare = horizontal ? edge->rect.x : edge->rect.y;
-
-  /* Begin the search... */
   low  = 0;
-  high = edges->len - 1;
+  high = edges->len;
   while (low < high)
     {
-      mid = low + (high - low)/2;
-      edge = g_array_index (edges, MetaEdge*, mid);
-      compare = horizontal ? edge->rect.x : edge->rect.y;
+      int mid = low + (high - low) / 2;
+      MetaEdge *edge = g_array_index (edges, MetaEdge*, mid);
+      int compare = get_edge_position (edge, horizontal);
 
-      if (compare == position)
-        break;
-
-      if (compare > position)
-        high = mid - 1;
-      else
+      if (compare < position || (!want_interval_min && compare == position))
         low = mid + 1;
+      else
+        high = mid;
     }
 
-  /* mid should now be _really_ close to the index we want, so we start
-   * linearly searching.  However, note that we don't know if mid is less
-   * than or greater than what we need and it's possible that there are
-   * several equal values equal to what we were searching for and we ended
-   * up in the middle of them instead of at the end.  So we may need to
-   * move mid multiple locations over.
+  /* low is edges->len if no values in array are big enough, and the last
+   * value small enough is right before it, which might be -1.
    */
-  if (want_interval_min)
-    {
-      while (compare >= position && mid > 0)
-        {
-          mid--;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-      while (compare < position && mid < (int)edges->len - 1)
-        {
-          mid++;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-
-      /* Special case for no values in array big enough */
-      if (compare < position)
-        return edges->len;
-
-      /* Return the found value */
-      return mid;
-    }
-  else
-    {
-      while (compare <= position && mid < (int)edges->len - 1)
-        {
-          mid++;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-      while (compare > position && mid > 0)
-        {
-          mid--;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-
-      /* Special case for no values in array small enough */
-      if (compare > position)
-        return -1;
-
-      /* Return the found value */
-      return mid;
-    }
+  return want_interval_min ? low : low - 1;
 }
 
 static gboolean
@@ -11,3 +11,5 @@ void meta_background_content_cull_unobscured (MetaBackgroundContent *self,
 
 void meta_background_content_cull_redraw_clip (MetaBackgroundContent *self,
                                                MtkRegion             *clip_region);
+
+void meta_background_content_prewarm_pipelines (CoglFramebuffer *framebuffer);
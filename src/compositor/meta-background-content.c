@@ -232,6 +232,13 @@ struct _MetaBackgroundContent
   MtkRectangle texture_area;
   int texture_width, texture_height;
 
+  /* The background with the gradient and the vignette applied, drawn
+   * instead of evaluating these for every repaint once they stopped
+   * changing.
+   */
+  CoglTexture *baked_texture;
+  gboolean effects_settled;
+
   MtkRegion *clip_region;
   MtkRegion *unobscured_region;
 };
@@ -295,6 +302,12 @@ invalidate_pipeline (MetaBackgroundContent *self,
                      ChangedFlags           changed)
 {
   self->changed |= changed;
+
+  if (changed & (CHANGED_BACKGROUND |
+                 CHANGED_EFFECTS |
+                 CHANGED_VIGNETTE_PARAMETERS |
+                 CHANGED_GRADIENT_PARAMETERS))
+    self->effects_settled = FALSE;
 }
 
 static void
@@ -386,6 +399,37 @@ make_pipeline (CoglContext   *cogl_context,
   return cogl_pipeline_copy (*templatep);
 }
 
+static void
+set_vignette_uniforms (MetaBackgroundContent *self,
+                       CoglPipeline          *pipeline)
+{
+  cogl_pipeline_set_uniform_1f (pipeline,
+                                cogl_pipeline_get_uniform_location (pipeline,
+                                                                    "vignette_sharpness"),
+                                (float) self->vignette_sharpness);
+}
+
+static void
+set_gradient_uniforms (MetaBackgroundContent *self,
+                       CoglPipeline          *pipeline)
+{
+  MtkRectangle monitor_geometry;
+  float gradient_height_perc;
+
+  meta_display_get_monitor_geometry (self->display,
+                                     self->monitor, &monitor_geometry);
+  gradient_height_perc = MAX (0.0001f,
+                              self->gradient_height / (float) monitor_geometry.height);
+  cogl_pipeline_set_uniform_1f (pipeline,
+                                cogl_pipeline_get_uniform_location (pipeline,
+                                                                    "gradient_height_perc"),
+                                gradient_height_perc);
+  cogl_pipeline_set_uniform_1f (pipeline,
+                                cogl_pipeline_get_uniform_location (pipeline,
+                                                                    "gradient_max_darkness"),
+                                (float) self->gradient_max_darkness);
+}
+
 static void
 setup_pipeline (MetaBackgroundContent *self,
                 ClutterActor          *actor,
@@ -397,6 +441,7 @@ setup_pipeline (MetaBackgroundContent *self,
   ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
   CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
   PipelineFlags pipeline_flags = 0;
+  gboolean use_baked_texture = self->baked_texture != NULL;
   guint8 opacity;
   float color_component;
   CoglFramebuffer *fb;
@@ -406,9 +451,9 @@ setup_pipeline (MetaBackgroundContent *self,
   opacity = clutter_actor_get_paint_opacity (actor);
   if (opacity < 255)
     pipeline_flags |= PIPELINE_BLEND;
-  if (self->vignette)
+  if (self->vignette && !use_baked_texture)
     pipeline_flags |= PIPELINE_VIGNETTE;
-  if (self->gradient)
+  if (self->gradient && !use_baked_texture)
     pipeline_flags |= PIPELINE_GRADIENT;
   if (self->has_rounded_clip)
     pipeline_flags |= PIPELINE_ROUNDED_CLIP | PIPELINE_BLEND;
@@ -426,10 +471,24 @@ setup_pipeline (MetaBackgroundContent *self,
   if (self->changed & CHANGED_BACKGROUND)
     {
       CoglPipelineWrapMode wrap_mode;
-      CoglTexture *texture = meta_background_get_texture (self->background,
-                                                          self->monitor,
-                                                          &self->texture_area,
-                                                          &wrap_mode);
+      CoglTexture *texture;
+
+      if (use_baked_texture)
+        {
+          texture = self->baked_texture;
+          self->texture_area = (MtkRectangle) {
+            .width = actor_pixel_rect->width,
+            .height = actor_pixel_rect->height,
+          };
+          wrap_mode = COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE;
+        }
+      else
+        {
+          texture = meta_background_get_texture (self->background,
+                                                 self->monitor,
+                                                 &self->texture_area,
+                                                 &wrap_mode);
+        }
 
       if (texture)
         {
@@ -450,31 +509,14 @@ setup_pipeline (MetaBackgroundContent *self,
 
   if (self->changed & CHANGED_VIGNETTE_PARAMETERS)
     {
-      cogl_pipeline_set_uniform_1f (self->pipeline,
-                                    cogl_pipeline_get_uniform_location (self->pipeline,
-                                                                        "vignette_sharpness"),
-                                    (float) self->vignette_sharpness);
+      set_vignette_uniforms (self, self->pipeline);
 
       self->changed &= ~CHANGED_VIGNETTE_PARAMETERS;
     }
 
   if (self->changed & CHANGED_GRADIENT_PARAMETERS)
     {
-      MtkRectangle monitor_geometry;
-      float gradient_height_perc;
-
-      meta_display_get_monitor_geometry (self->display,
-                                         self->monitor, &monitor_geometry);
-      gradient_height_perc = MAX (0.0001f,
-                                  self->gradient_height / (float) monitor_geometry.height);
-      cogl_pipeline_set_uniform_1f (self->pipeline,
-                                    cogl_pipeline_get_uniform_location (self->pipeline,
-                                                                        "gradient_height_perc"),
-                                    gradient_height_perc);
-      cogl_pipeline_set_uniform_1f (self->pipeline,
-                                    cogl_pipeline_get_uniform_location (self->pipeline,
-                                                                        "gradient_max_darkness"),
-                                    (float) self->gradient_max_darkness);
+      set_gradient_uniforms (self, self->pipeline);
 
       self->changed &= ~CHANGED_GRADIENT_PARAMETERS;
     }
@@ -538,7 +580,7 @@ setup_pipeline (MetaBackgroundContent *self,
       self->changed &= ~CHANGED_ROUNDED_CLIP_PARAMETERS;
     }
 
-  if (self->vignette)
+  if (self->vignette && !use_baked_texture)
     color_component = (float) (self->vignette_brightness * opacity / 255.0);
   else
     color_component = opacity / 255.0f;
@@ -572,6 +614,8 @@ setup_pipeline (MetaBackgroundContent *self,
 
 static void
 set_glsl_parameters (MetaBackgroundContent *self,
+                     CoglPipeline          *pipeline,
+                     const MtkRectangle    *texture_area,
                      MtkRectangle          *actor_pixel_rect)
 {
   MetaContext *context = meta_display_get_context (self->display);
@@ -586,33 +630,33 @@ set_glsl_parameters (MetaBackgroundContent *self,
     : 1.0f;
 
   float pixel_step[] = {
-    1.0f / (self->texture_area.width * monitor_scale),
-    1.0f / (self->texture_area.height * monitor_scale),
+    1.0f / (texture_area->width * monitor_scale),
+    1.0f / (texture_area->height * monitor_scale),
   };
 
   pixel_step_uniform_location =
-    cogl_pipeline_get_uniform_location (self->pipeline,
+    cogl_pipeline_get_uniform_location (pipeline,
                                         "pixel_step");
 
   /* Compute a scale and offset for transforming texture coordinates to the
    * coordinate system from [-0.5 to 0.5] across the area of the actor
    */
-  scale[0] = self->texture_area.width / (float)actor_pixel_rect->width;
-  scale[1] = self->texture_area.height / (float)actor_pixel_rect->height;
-  offset[0] = self->texture_area.x / (float)actor_pixel_rect->width - 0.5f;
-  offset[1] = self->texture_area.y / (float)actor_pixel_rect->height - 0.5f;
+  scale[0] = texture_area->width / (float)actor_pixel_rect->width;
+  scale[1] = texture_area->height / (float)actor_pixel_rect->height;
+  offset[0] = texture_area->x / (float)actor_pixel_rect->width - 0.5f;
+  offset[1] = texture_area->y / (float)actor_pixel_rect->height - 0.5f;
 
-  cogl_pipeline_set_uniform_float (self->pipeline,
-                                   cogl_pipeline_get_uniform_location (self->pipeline,
+  cogl_pipeline_set_uniform_float (pipeline,
+                                   cogl_pipeline_get_uniform_location (pipeline,
                                                                        "scale"),
                                    2, 1, scale);
 
-  cogl_pipeline_set_uniform_float (self->pipeline,
-                                   cogl_pipeline_get_uniform_location (self->pipeline,
+  cogl_pipeline_set_uniform_float (pipeline,
+                                   cogl_pipeline_get_uniform_location (pipeline,
                                                                        "offset"),
                                    2, 1, offset);
 
-  cogl_pipeline_set_uniform_float (self->pipeline,
+  cogl_pipeline_set_uniform_float (pipeline,
                                    pixel_step_uniform_location,
                                    2, 1,
                                    pixel_step);
@@ -657,6 +701,152 @@ paint_clipped_rectangle (MetaBackgroundContent *self,
   clutter_paint_node_add_child (node, pipeline_node);
 }
 
+static void
+clear_baked_texture (MetaBackgroundContent *self)
+{
+  if (!self->baked_texture)
+    return;
+
+  /* Not through invalidate_pipeline(), the effects didn't change */
+  g_clear_object (&self->baked_texture);
+  self->changed |= CHANGED_BACKGROUND;
+}
+
+static gboolean
+ensure_baked_texture (MetaBackgroundContent *self,
+                      MtkRectangle          *actor_pixel_rect)
+{
+  MetaContext *context = meta_display_get_context (self->display);
+  MetaBackend *backend = meta_context_get_backend (context);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (CoglTexture) baked_texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  g_autoptr (GError) error = NULL;
+  CoglFramebuffer *fb;
+  CoglPipelineWrapMode wrap_mode;
+  CoglPipelineFilter min_filter, mag_filter;
+  CoglTexture *texture;
+  MtkRectangle texture_area;
+  PipelineFlags pipeline_flags = 0;
+  float monitor_scale;
+  float color_component;
+  int width, height;
+  CoglColor color;
+
+  if (!self->vignette && !self->gradient)
+    {
+      clear_baked_texture (self);
+      return FALSE;
+    }
+
+  /* Keep evaluating the effects while they are changing, e.g. when being
+   * animated, and bake them once they stayed the same for a repaint.
+   */
+  if (!self->effects_settled)
+    {
+      clear_baked_texture (self);
+      self->effects_settled = TRUE;
+      return FALSE;
+    }
+
+  monitor_scale = meta_backend_is_stage_views_scaled (backend)
+    ? meta_display_get_monitor_scale (self->display, self->monitor)
+    : 1.0f;
+  width = (int) ceilf (actor_pixel_rect->width * monitor_scale);
+  height = (int) ceilf (actor_pixel_rect->height * monitor_scale);
+
+  if (self->baked_texture &&
+      cogl_texture_get_width (self->baked_texture) == width &&
+      cogl_texture_get_height (self->baked_texture) == height)
+    return TRUE;
+
+  clear_baked_texture (self);
+
+  if (width <= 0 || height <= 0)
+    return FALSE;
+
+  texture = meta_background_get_texture (self->background,
+                                         self->monitor,
+                                         &texture_area,
+                                         &wrap_mode);
+  if (!texture)
+    return FALSE;
+
+  baked_texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  offscreen = cogl_offscreen_new_with_texture (baked_texture);
+  fb = COGL_FRAMEBUFFER (offscreen);
+  if (!cogl_framebuffer_allocate (fb, &error))
+    {
+      self->effects_settled = FALSE;
+      return FALSE;
+    }
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 actor_pixel_rect->width,
+                                 actor_pixel_rect->height,
+                                 -1.0f, 1.0f);
+
+  if (self->vignette)
+    pipeline_flags |= PIPELINE_VIGNETTE;
+  if (self->gradient)
+    pipeline_flags |= PIPELINE_GRADIENT;
+
+  pipeline = make_pipeline (cogl_context, pipeline_flags);
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0, wrap_mode);
+
+  if (cogl_texture_get_width (texture) == width &&
+      cogl_texture_get_height (texture) == height)
+    {
+      min_filter = COGL_PIPELINE_FILTER_NEAREST;
+      mag_filter = COGL_PIPELINE_FILTER_NEAREST;
+    }
+  else
+    {
+      min_filter = COGL_PIPELINE_FILTER_LINEAR_MIPMAP_NEAREST;
+      mag_filter = COGL_PIPELINE_FILTER_LINEAR;
+    }
+  cogl_pipeline_set_layer_filters (pipeline, 0, min_filter, mag_filter);
+
+  if (self->vignette)
+    {
+      set_vignette_uniforms (self, pipeline);
+      color_component = (float) self->vignette_brightness;
+    }
+  else
+    {
+      color_component = 1.0f;
+    }
+
+  if (self->gradient)
+    set_gradient_uniforms (self, pipeline);
+
+  set_glsl_parameters (self, pipeline, &texture_area, actor_pixel_rect);
+
+  cogl_color_init_from_4f (&color,
+                           color_component,
+                           color_component,
+                           color_component,
+                           1.0f);
+  cogl_pipeline_set_color (pipeline, &color);
+
+  cogl_framebuffer_draw_textured_rectangle (fb, pipeline,
+                                            0, 0,
+                                            actor_pixel_rect->width,
+                                            actor_pixel_rect->height,
+                                            -texture_area.x / (float) texture_area.width,
+                                            -texture_area.y / (float) texture_area.height,
+                                            1.0f - texture_area.x / (float) texture_area.width,
+                                            1.0f - texture_area.y / (float) texture_area.height);
+
+  self->baked_texture = g_steal_pointer (&baked_texture);
+  self->changed |= CHANGED_BACKGROUND;
+
+  return TRUE;
+}
+
 static void
 meta_background_content_paint_content (ClutterContent      *content,
                                        ClutterActor        *actor,
@@ -749,8 +939,10 @@ meta_background_content_paint_content (ClutterContent      *content,
   if (mtk_region_is_empty (region))
     return;
 
+  ensure_baked_texture (self, &rect_within_actor);
   setup_pipeline (self, actor, paint_context, &rect_within_actor);
-  set_glsl_parameters (self, &rect_within_actor);
+  set_glsl_parameters (self, self->pipeline, &self->texture_area,
+                       &rect_within_actor);
 
   /* Limit to how many separate rectangles we'll draw; beyond this just
    * fall back and draw the whole thing */
@@ -832,6 +1024,7 @@ meta_background_content_dispose (GObject *object)
   meta_background_content_set_background (self, NULL);
 
   g_clear_object (&self->pipeline);
+  g_clear_object (&self->baked_texture);
 
   G_OBJECT_CLASS (meta_background_content_parent_class)->dispose (object);
 }
@@ -1229,3 +1422,28 @@ meta_background_content_cull_redraw_clip (MetaBackgroundContent *self,
 {
   set_clip_region (self, clip_region);
 }
+
+void
+meta_background_content_prewarm_pipelines (CoglFramebuffer *framebuffer)
+{
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  /* Plain and faded backgrounds, and the vignetted and rounded ones
+   * typically used by shells for overviews and workspace thumbnails */
+  static const PipelineFlags prewarm_flags[] = {
+    0,
+    PIPELINE_BLEND,
+    PIPELINE_VIGNETTE,
+    PIPELINE_ROUNDED_CLIP | PIPELINE_BLEND,
+  };
+  size_t i;
+
+  for (i = 0; i < G_N_ELEMENTS (prewarm_flags); i++)
+    {
+      g_autoptr (CoglPipeline) pipeline = NULL;
+
+      pipeline = make_pipeline (cogl_context, prewarm_flags[i]);
+      cogl_framebuffer_draw_rectangle (framebuffer, pipeline, 0, 0, 1, 1);
+    }
+
+  cogl_framebuffer_flush (framebuffer);
+}
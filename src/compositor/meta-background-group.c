@@ -24,9 +24,26 @@ static void cullable_iface_init (MetaCullableInterface *iface);
 G_DEFINE_TYPE_WITH_CODE (MetaBackgroundGroup, meta_background_group, CLUTTER_TYPE_ACTOR,
                          G_IMPLEMENT_INTERFACE (META_TYPE_CULLABLE, cullable_iface_init));
 
+static void
+meta_background_group_paint (ClutterActor        *actor,
+                             ClutterPaintContext *paint_context)
+{
+  ClutterActorClass *parent_actor_class =
+    CLUTTER_ACTOR_CLASS (meta_background_group_parent_class);
+  const char *prev_gpu_phase;
+
+  prev_gpu_phase = clutter_paint_context_begin_gpu_phase (paint_context,
+                                                          "background");
+  parent_actor_class->paint (actor, paint_context);
+  clutter_paint_context_begin_gpu_phase (paint_context, prev_gpu_phase);
+}
+
 static void
 meta_background_group_class_init (MetaBackgroundGroupClass *klass)
 {
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint = meta_background_group_paint;
 }
 
 static void
@@ -60,9 +77,9 @@ meta_background_group_new (void)
 {
   MetaBackgroundGroup *background_group;
 
-  background_group = g_object_new (META_TYPE_BACKGROUND_GROUP,
-                                   "accessible-name", "Background group",
-                                   NULL);
+  background_group = g_object_new (META_TYPE_BACKGROUND_GROUP,
+                                   "accessible-name", "Background group",
+                                   NULL);
 
   return CLUTTER_ACTOR (background_group);
 }
@@ -18,7 +18,7 @@
 
 #include "config.h"
 
-#include "meta/meta-background-image.h"
+#include "compositor/meta-background-image-private.h"
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gio/gio.h>
@@ -27,6 +27,8 @@
 #include <malloc.h>
 #endif
 
+#include <math.h>
+
 #include "clutter/clutter.h"
 #include "compositor/cogl-utils.h"
 
@@ -38,6 +40,8 @@ enum
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+#define LOAD_BUFFER_SIZE (64 * 1024)
+
 /**
  * MetaBackgroundImageCache:
  *
@@ -51,6 +55,7 @@ struct _MetaBackgroundImageCache
   GObject parent_instance;
 
   GHashTable *images;
+  GHashTable *scaled_images;
 };
 
 /**
@@ -66,14 +71,28 @@ struct _MetaBackgroundImage
   gboolean in_cache;
   gboolean loaded;
   CoglTexture *texture;
+
+  /* If non-zero, the image may be downscaled as long as both its width
+   * and height stay at least this size.
+   */
+  int min_size;
+  gboolean downscaled;
 };
 
+typedef struct _LoadFileData
+{
+  int min_size;
+  gboolean downscaled;
+} LoadFileData;
+
 G_DEFINE_TYPE (MetaBackgroundImageCache, meta_background_image_cache, G_TYPE_OBJECT);
 
 static void
 meta_background_image_cache_init (MetaBackgroundImageCache *cache)
 {
   cache->images = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+  cache->scaled_images = g_hash_table_new (g_file_hash,
+                                           (GEqualFunc) g_file_equal);
 }
 
 static void
@@ -90,7 +109,15 @@ meta_background_image_cache_finalize (GObject *object)
       image->in_cache = FALSE;
     }
 
+  g_hash_table_iter_init (&iter, cache->scaled_images);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      MetaBackgroundImage *image = value;
+      image->in_cache = FALSE;
+    }
+
   g_hash_table_destroy (cache->images);
+  g_hash_table_destroy (cache->scaled_images);
 
   G_OBJECT_CLASS (meta_background_image_cache_parent_class)->finalize (object);
 }
@@ -119,10 +146,84 @@ meta_background_image_cache_get_default (void)
   return cache;
 }
 
+static void
+on_size_prepared (GdkPixbufLoader *loader,
+                  int              width,
+                  int              height,
+                  LoadFileData    *data)
+{
+  double scale;
+
+  /* Both dimensions are kept at least min_size, no matter the orientation
+   * the image ends up being rotated to.
+   */
+  scale = (double) data->min_size / MIN (width, height);
+  if (scale >= 1.0)
+    return;
+
+  gdk_pixbuf_loader_set_size (loader,
+                              MAX (1, (int) ceil (width * scale)),
+                              MAX (1, (int) ceil (height * scale)));
+  data->downscaled = TRUE;
+}
+
+static GdkPixbuf *
+load_pixbuf_scaled (GInputStream  *stream,
+                    LoadFileData  *data,
+                    GError       **error)
+{
+  g_autoptr (GdkPixbufLoader) loader = NULL;
+  g_autofree guchar *buffer = NULL;
+  GdkPixbuf *pixbuf;
+  gssize n_read;
+
+  /* Feed the loader in chunks, so that decoders supporting it, e.g. the
+   * JPEG one, can decode straight to the smaller size once it is known.
+   */
+  loader = gdk_pixbuf_loader_new ();
+  g_signal_connect (loader, "size-prepared",
+                    G_CALLBACK (on_size_prepared), data);
+
+  buffer = g_malloc (LOAD_BUFFER_SIZE);
+
+  while (TRUE)
+    {
+      n_read = g_input_stream_read (stream, buffer, LOAD_BUFFER_SIZE,
+                                    NULL, error);
+      if (n_read < 0)
+        {
+          gdk_pixbuf_loader_close (loader, NULL);
+          return NULL;
+        }
+
+      if (n_read == 0)
+        break;
+
+      if (!gdk_pixbuf_loader_write (loader, buffer, n_read, error))
+        {
+          gdk_pixbuf_loader_close (loader, NULL);
+          return NULL;
+        }
+    }
+
+  if (!gdk_pixbuf_loader_close (loader, error))
+    return NULL;
+
+  pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+  if (pixbuf == NULL)
+    {
+      g_set_error (error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_FAILED,
+                   "Image loader returned no image");
+      return NULL;
+    }
+
+  return g_object_ref (pixbuf);
+}
+
 static void
 load_file (GTask               *task,
            MetaBackgroundImage *image,
-           gpointer             task_data,
+           LoadFileData        *data,
            GCancellable        *cancellable)
 {
   GError *error = NULL;
@@ -136,7 +237,10 @@ load_file (GTask               *task,
       return;
     }
 
-  pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (stream), NULL, &error);
+  if (data->min_size > 0)
+    pixbuf = load_pixbuf_scaled (G_INPUT_STREAM (stream), data, &error);
+  else
+    pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (stream), NULL, &error);
   g_object_unref (stream);
 
 #ifdef HAVE_MALLOC_TRIM
@@ -169,6 +273,8 @@ file_loaded (GObject      *source_object,
 
   task = G_TASK (result);
   pixbuf = g_task_propagate_pointer (task, &error);
+  image->downscaled =
+    ((LoadFileData *) g_task_get_task_data (task))->downscaled;
 
   if (pixbuf == NULL)
     {
@@ -233,12 +339,47 @@ out:
  *
  * Return value: (transfer full): a #MetaBackgroundImage to dereference to get the loaded texture
  */
+static GHashTable *
+get_images_for_size (MetaBackgroundImageCache *cache,
+                     int                       min_size)
+{
+  return min_size > 0 ? cache->scaled_images : cache->images;
+}
+
+static MetaBackgroundImage *
+load_image (MetaBackgroundImageCache *cache,
+            GFile                    *file,
+            int                       min_size)
+{
+  MetaBackgroundImage *image;
+  LoadFileData *data;
+  GTask *task;
+
+  image = g_object_new (META_TYPE_BACKGROUND_IMAGE, NULL);
+  image->cache = cache;
+  image->in_cache = TRUE;
+  image->file = g_object_ref (file);
+  image->min_size = min_size;
+  g_hash_table_insert (get_images_for_size (cache, min_size),
+                       image->file, image);
+
+  data = g_new0 (LoadFileData, 1);
+  data->min_size = min_size;
+
+  task = g_task_new (image, NULL, file_loaded, NULL);
+  g_task_set_task_data (task, data, g_free);
+
+  g_task_run_in_thread (task, (GTaskThreadFunc) load_file);
+  g_object_unref (task);
+
+  return image;
+}
+
 MetaBackgroundImage *
 meta_background_image_cache_load (MetaBackgroundImageCache *cache,
                                   GFile                    *file)
 {
   MetaBackgroundImage *image;
-  GTask *task;
 
   g_return_val_if_fail (META_IS_BACKGROUND_IMAGE_CACHE (cache), NULL);
   g_return_val_if_fail (file != NULL, NULL);
@@ -247,18 +388,44 @@ meta_background_image_cache_load (MetaBackgroundImageCache *cache,
   if (image != NULL)
     return g_object_ref (image);
 
-  image = g_object_new (META_TYPE_BACKGROUND_IMAGE, NULL);
-  image->cache = cache;
-  image->in_cache = TRUE;
-  image->file = g_object_ref (file);
-  g_hash_table_insert (cache->images, image->file, image);
+  return load_image (cache, file, 0);
+}
 
-  task = g_task_new (image, NULL, file_loaded, NULL);
+/*
+ * Like meta_background_image_cache_load(), but allows the image to be
+ * downscaled while decoding, as long as its width and height both stay at
+ * least @min_size. This is meant for images that end up scaled to the size
+ * of a monitor anyway, and avoids keeping e.g. huge photos around in full
+ * resolution.
+ */
+MetaBackgroundImage *
+meta_background_image_cache_load_scaled (MetaBackgroundImageCache *cache,
+                                         GFile                    *file,
+                                         int                       min_size)
+{
+  MetaBackgroundImage *image;
 
-  g_task_run_in_thread (task, (GTaskThreadFunc) load_file);
-  g_object_unref (task);
+  g_return_val_if_fail (META_IS_BACKGROUND_IMAGE_CACHE (cache), NULL);
+  g_return_val_if_fail (file != NULL, NULL);
 
-  return image;
+  if (min_size <= 0)
+    return meta_background_image_cache_load (cache, file);
+
+  image = g_hash_table_lookup (cache->images, file);
+  if (image != NULL)
+    return g_object_ref (image);
+
+  image = g_hash_table_lookup (cache->scaled_images, file);
+  if (image != NULL)
+    {
+      if (meta_background_image_covers_size (image, min_size))
+        return g_object_ref (image);
+
+      g_hash_table_remove (cache->scaled_images, image->file);
+      image->in_cache = FALSE;
+    }
+
+  return load_image (cache, file, min_size);
 }
 
 /**
@@ -279,11 +446,56 @@ meta_background_image_cache_purge (MetaBackgroundImageCache *cache,
   g_return_if_fail (file != NULL);
 
   image = g_hash_table_lookup (cache->images, file);
-  if (image == NULL)
-    return;
+  if (image != NULL)
+    {
+      g_hash_table_remove (cache->images, image->file);
+      image->in_cache = FALSE;
+    }
+
+  image = g_hash_table_lookup (cache->scaled_images, file);
+  if (image != NULL)
+    {
+      g_hash_table_remove (cache->scaled_images, image->file);
+      image->in_cache = FALSE;
+    }
+}
 
-  g_hash_table_remove (cache->images, image->file);
-  image->in_cache = FALSE;
+static size_t
+get_images_size (GHashTable *images)
+{
+  GHashTableIter iter;
+  MetaBackgroundImage *image;
+  size_t size = 0;
+
+  g_hash_table_iter_init (&iter, images);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &image))
+    {
+      if (!image->texture)
+        continue;
+
+      size += ((size_t) cogl_texture_get_width (image->texture) *
+               cogl_texture_get_height (image->texture) * 4);
+    }
+
+  return size;
+}
+
+/*
+ * The cache only holds weak references to the images, that are kept alive
+ * by the backgrounds using them, so it can't be trimmed; this only accounts
+ * for the size of the textures of the loaded images.
+ */
+size_t
+meta_background_image_cache_get_size (MetaBackgroundImageCache *cache,
+                                      unsigned int             *out_n_images)
+{
+  if (out_n_images)
+    {
+      *out_n_images = (g_hash_table_size (cache->images) +
+                       g_hash_table_size (cache->scaled_images));
+    }
+
+  return get_images_size (cache->images) + get_images_size (cache->scaled_images);
 }
 
 G_DEFINE_TYPE (MetaBackgroundImage, meta_background_image, G_TYPE_OBJECT);
@@ -299,7 +511,10 @@ meta_background_image_finalize (GObject *object)
   MetaBackgroundImage *image = META_BACKGROUND_IMAGE (object);
 
   if (image->in_cache)
-    g_hash_table_remove (image->cache->images, image->file);
+    {
+      g_hash_table_remove (get_images_for_size (image->cache, image->min_size),
+                           image->file);
+    }
 
   if (image->texture)
     g_object_unref (image->texture);
@@ -371,3 +586,17 @@ meta_background_image_get_texture (MetaBackgroundImage *image)
 
   return image->texture;
 }
+
+gboolean
+meta_background_image_covers_size (MetaBackgroundImage *image,
+                                   int                  min_size)
+{
+  if (image->min_size == 0)
+    return TRUE;
+
+  /* Images that were small enough to begin with are loaded in full */
+  if (image->loaded && !image->downscaled)
+    return TRUE;
+
+  return min_size > 0 && image->min_size >= min_size;
+}
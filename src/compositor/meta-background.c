@@ -21,12 +21,13 @@
 
 #include "compositor/meta-background-private.h"
 
+#include <math.h>
 #include <string.h>
 
 #include "backends/meta-backend-private.h"
 #include "compositor/cogl-utils.h"
+#include "compositor/meta-background-image-private.h"
 #include "meta/display.h"
-#include "meta/meta-background-image.h"
 #include "meta/meta-background.h"
 #include "meta/meta-monitor-manager.h"
 #include "meta/util.h"
@@ -133,12 +134,6 @@ invalidate_monitor_backgrounds (MetaBackground *self)
     }
 }
 
-static void
-on_monitors_changed (MetaBackground *self)
-{
-  invalidate_monitor_backgrounds (self);
-}
-
 static void
 set_display (MetaBackground *self,
              MetaDisplay    *display)
@@ -233,6 +228,40 @@ file_equal0 (GFile *file1,
   return g_file_equal (file1, file2);
 }
 
+/* The smallest width and height images need to keep to be drawn at full
+ * quality, or 0 if they need to be kept at their original size
+ */
+static int
+get_min_image_size (MetaBackground *self)
+{
+  float max_scale = 1.0f;
+  int screen_width, screen_height;
+  int i;
+
+  switch (self->style)
+    {
+    case G_DESKTOP_BACKGROUND_STYLE_STRETCHED:
+    case G_DESKTOP_BACKGROUND_STYLE_SCALED:
+    case G_DESKTOP_BACKGROUND_STYLE_ZOOM:
+    case G_DESKTOP_BACKGROUND_STYLE_SPANNED:
+      break;
+    default:
+      /* Drawn at their original size */
+      return 0;
+    }
+
+  if (!self->display)
+    return 0;
+
+  for (i = 0; i < meta_display_get_n_monitors (self->display); i++)
+    max_scale = MAX (max_scale, meta_display_get_monitor_scale (self->display, i));
+
+  /* Never drawn larger than the whole screen in pixels */
+  meta_display_get_size (self->display, &screen_width, &screen_height);
+
+  return (int) ceilf (MAX (screen_width, screen_height) * max_scale);
+}
+
 static void
 set_file (MetaBackground       *self,
           GFile               **filep,
@@ -240,7 +269,11 @@ set_file (MetaBackground       *self,
           GFile                *file,
           gboolean              force_reload)
 {
-  if (force_reload || !file_equal0 (*filep, file))
+  int min_size = file ? get_min_image_size (self) : 0;
+
+  if (force_reload ||
+      !file_equal0 (*filep, file) ||
+      (*imagep && !meta_background_image_covers_size (*imagep, min_size)))
     {
       if (*imagep)
         {
@@ -256,13 +289,24 @@ set_file (MetaBackground       *self,
         {
           MetaBackgroundImageCache *cache = meta_background_image_cache_get_default ();
 
-          *imagep = meta_background_image_cache_load (cache, file);
+          *imagep = meta_background_image_cache_load_scaled (cache, file,
+                                                             min_size);
           g_signal_connect (*imagep, "loaded",
                             G_CALLBACK (on_background_loaded), self);
         }
     }
 }
 
+static void
+on_monitors_changed (MetaBackground *self)
+{
+  invalidate_monitor_backgrounds (self);
+
+  /* Reload downscaled images that became too small for the new screen */
+  set_file (self, &self->file1, &self->background_image1, self->file1, FALSE);
+  set_file (self, &self->file2, &self->background_image2, self->file2, FALSE);
+}
+
 static void
 on_gl_video_memory_purged (MetaBackground *self)
 {
@@ -754,6 +798,54 @@ get_best_mipmap_level (CoglTexture *texture,
   return MAX (0, halves - 1);
 }
 
+/*
+ * Unless the monitor position affects how the background is drawn, monitors
+ * with the same size and scale end up with identical textures. Let such a
+ * monitor use the texture already drawn for another one, so that there is
+ * only one copy of it.
+ */
+static gboolean
+share_monitor_texture (MetaBackground *self,
+                       int             monitor_index,
+                       int             texture_width,
+                       int             texture_height)
+{
+  MetaBackgroundMonitor *monitor = &self->monitors[monitor_index];
+  float monitor_scale;
+  int i;
+
+  if (self->style == G_DESKTOP_BACKGROUND_STYLE_WALLPAPER ||
+      self->style == G_DESKTOP_BACKGROUND_STYLE_SPANNED)
+    return FALSE;
+
+  monitor_scale = meta_display_get_monitor_scale (self->display,
+                                                  monitor_index);
+
+  for (i = 0; i < self->n_monitors; i++)
+    {
+      MetaBackgroundMonitor *other = &self->monitors[i];
+
+      if (i == monitor_index || other->dirty || !other->texture)
+        continue;
+
+      if (cogl_texture_get_width (other->texture) != texture_width ||
+          cogl_texture_get_height (other->texture) != texture_height ||
+          meta_display_get_monitor_scale (self->display, i) != monitor_scale)
+        continue;
+
+      if (monitor->texture != other->texture)
+        {
+          g_set_object (&monitor->texture, other->texture);
+          g_set_object (&monitor->fbo, other->fbo);
+        }
+
+      monitor->dirty = FALSE;
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
 CoglTexture *
 meta_background_get_texture (MetaBackground       *self,
                              int                   monitor_index,
@@ -824,6 +916,10 @@ meta_background_get_texture (MetaBackground       *self,
           texture_height = monitor_area.height;
         }
 
+      if (share_monitor_texture (self, monitor_index,
+                                 texture_width, texture_height))
+        goto out;
+
       if (monitor->texture == NULL)
         {
           CoglOffscreen *offscreen;
@@ -937,6 +1033,7 @@ meta_background_get_texture (MetaBackground       *self,
       monitor->dirty = FALSE;
     }
 
+out:
   if (texture_area)
     set_texture_area_from_monitor_area (&geometry, texture_area);
 
@@ -1014,11 +1111,12 @@ meta_background_set_blend (MetaBackground          *self,
   g_return_if_fail (META_IS_BACKGROUND (self));
   g_return_if_fail (blend_factor >= 0.0 && blend_factor <= 1.0);
 
+  self->style = style;
+
   set_file (self, &self->file1, &self->background_image1, file1, FALSE);
   set_file (self, &self->file2, &self->background_image2, file2, FALSE);
 
   self->blend_factor = (float) blend_factor;
-  self->style = style;
 
   free_wallpaper_texture (self);
   mark_changed (self);
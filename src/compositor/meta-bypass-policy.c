@@ -0,0 +1,163 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Switching between compositing and bypassing it is expensive: the first
+ * composited frame after scanout needs a new buffer to be rendered in full,
+ * and unredirecting an X11 window makes the X server reallocate its
+ * pixmap. When something briefly overlaps a fullscreen window, such as a
+ * notification, or when scanout keeps failing, switching back and forth
+ * every few frames costs more than compositing would, and may flicker.
+ *
+ * Bypassing is always stopped as soon as it isn't possible anymore, but
+ * after having stopped, it is only started again once it has been possible
+ * for a while. After a failed scanout, it is not tried again for a time
+ * that doubles with each failure, until bypassing has worked for a while.
+ */
+
+#include "config.h"
+
+#include "compositor/meta-bypass-policy.h"
+
+#define FLAP_WINDOW_US (G_USEC_PER_SEC * 2)
+#define REENTER_HOLD_US (G_USEC_PER_SEC / 4)
+#define FAILURE_RESET_US (G_USEC_PER_SEC)
+#define MIN_BACKOFF_US (G_USEC_PER_SEC / 10)
+#define MAX_BACKOFF_US (G_USEC_PER_SEC * 2)
+
+void
+meta_bypass_policy_init (MetaBypassPolicy *policy)
+{
+  *policy = (MetaBypassPolicy) {
+    .decision = META_BYPASS_DECISION_COMPOSITED,
+  };
+}
+
+/* Returns whether bypassing should be attempted, which isn't the case if
+ * it isn't possible, or if it stopped recently */
+gboolean
+meta_bypass_policy_should_bypass (MetaBypassPolicy *policy,
+                                  gboolean          is_eligible,
+                                  int64_t           now_us)
+{
+  if (!is_eligible)
+    {
+      policy->eligible_since_us = 0;
+      policy->decision = META_BYPASS_DECISION_COMPOSITED;
+      return FALSE;
+    }
+
+  if (policy->eligible_since_us == 0)
+    policy->eligible_since_us = now_us;
+
+  if (policy->is_bypassed)
+    return TRUE;
+
+  if (now_us < policy->retry_after_us)
+    {
+      policy->decision = META_BYPASS_DECISION_BACKING_OFF;
+      return FALSE;
+    }
+
+  if (policy->last_exit_us != 0 &&
+      now_us - policy->last_exit_us < FLAP_WINDOW_US &&
+      now_us - policy->eligible_since_us < REENTER_HOLD_US)
+    {
+      policy->decision = META_BYPASS_DECISION_HOLDING_OFF;
+      return FALSE;
+    }
+
+  policy->decision = META_BYPASS_DECISION_COMPOSITED;
+  return TRUE;
+}
+
+/* Records whether compositing was actually bypassed for the frame */
+void
+meta_bypass_policy_set_bypassed (MetaBypassPolicy *policy,
+                                 gboolean          is_bypassed,
+                                 int64_t           now_us)
+{
+  if (is_bypassed)
+    {
+      if (!policy->is_bypassed)
+        {
+          policy->bypassed_since_us = now_us;
+          policy->n_transitions++;
+        }
+      else if (now_us - policy->bypassed_since_us >= FAILURE_RESET_US)
+        {
+          policy->n_failures = 0;
+        }
+
+      policy->decision = META_BYPASS_DECISION_BYPASSED;
+    }
+  else
+    {
+      if (policy->is_bypassed)
+        {
+          policy->last_exit_us = now_us;
+          policy->n_transitions++;
+        }
+
+      if (policy->decision == META_BYPASS_DECISION_BYPASSED)
+        policy->decision = META_BYPASS_DECISION_COMPOSITED;
+    }
+
+  policy->is_bypassed = is_bypassed;
+}
+
+void
+meta_bypass_policy_notify_failed (MetaBypassPolicy *policy,
+                                  int64_t           now_us)
+{
+  int64_t backoff_us;
+
+  policy->n_failures++;
+
+  backoff_us = MIN_BACKOFF_US << MIN (policy->n_failures - 1, 5);
+  policy->retry_after_us = now_us + MIN (backoff_us, MAX_BACKOFF_US);
+
+  /* Not counted as the last exit, as it is the backoff that decides when
+   * to try again */
+  if (policy->is_bypassed)
+    {
+      policy->is_bypassed = FALSE;
+      policy->n_transitions++;
+    }
+
+  policy->decision = META_BYPASS_DECISION_BACKING_OFF;
+}
+
+const char *
+meta_bypass_decision_to_string (MetaBypassDecision decision)
+{
+  switch (decision)
+    {
+    case META_BYPASS_DECISION_COMPOSITED:
+      return "composited";
+    case META_BYPASS_DECISION_HOLDING_OFF:
+      return "holding-off";
+    case META_BYPASS_DECISION_BACKING_OFF:
+      return "backing-off";
+    case META_BYPASS_DECISION_BYPASSED:
+      return "bypassed";
+    }
+
+  g_assert_not_reached ();
+}
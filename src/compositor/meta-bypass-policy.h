@@ -0,0 +1,65 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <stdint.h>
+
+typedef enum _MetaBypassDecision
+{
+  META_BYPASS_DECISION_COMPOSITED,
+  META_BYPASS_DECISION_HOLDING_OFF,
+  META_BYPASS_DECISION_BACKING_OFF,
+  META_BYPASS_DECISION_BYPASSED,
+} MetaBypassDecision;
+
+/*
+ * Decides whether a view bypasses compositing, i.e. scans out or
+ * unredirects the top window, from whether that is currently possible and
+ * what happened recently.
+ */
+typedef struct _MetaBypassPolicy
+{
+  MetaBypassDecision decision;
+  gboolean is_bypassed;
+
+  int64_t eligible_since_us;
+  int64_t bypassed_since_us;
+  int64_t last_exit_us;
+  int64_t retry_after_us;
+
+  unsigned int n_failures;
+  unsigned int n_transitions;
+} MetaBypassPolicy;
+
+void meta_bypass_policy_init (MetaBypassPolicy *policy);
+
+gboolean meta_bypass_policy_should_bypass (MetaBypassPolicy *policy,
+                                           gboolean          is_eligible,
+                                           int64_t           now_us);
+
+void meta_bypass_policy_set_bypassed (MetaBypassPolicy *policy,
+                                      gboolean          is_bypassed,
+                                      int64_t           now_us);
+
+void meta_bypass_policy_notify_failed (MetaBypassPolicy *policy,
+                                       int64_t           now_us);
+
+const char * meta_bypass_decision_to_string (MetaBypassDecision decision);
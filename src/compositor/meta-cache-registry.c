@@ -0,0 +1,214 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * The compositor keeps a number of caches, of glyphs, textures and
+ * pipelines, that are each bounded on their own, but that can together
+ * still make up a large part of its memory use in long running sessions.
+ * The registry knows about all of them, to report their sizes, and to
+ * trim them when the system runs low on memory.
+ *
+ * Caches are trimmed in the order they were added to the registry, which
+ * should be from the cheapest to refill to the most expensive, and only
+ * from the trim level they were added with on.
+ */
+
+#include "config.h"
+
+#include "compositor/meta-cache-registry.h"
+
+#ifdef HAVE_MALLOC_TRIM
+#include <malloc.h>
+#endif
+
+#include "cogl/cogl.h"
+#include "core/util-private.h"
+
+typedef struct _MetaCacheEntry
+{
+  char *name;
+  MetaCacheTrimLevel min_level;
+  MetaCacheGetStatsFunc get_stats;
+  MetaCacheTrimFunc trim;
+  gpointer user_data;
+} MetaCacheEntry;
+
+struct _MetaCacheRegistry
+{
+  GArray *caches;
+};
+
+static void
+meta_cache_entry_clear (MetaCacheEntry *entry)
+{
+  g_clear_pointer (&entry->name, g_free);
+}
+
+MetaCacheRegistry *
+meta_cache_registry_new (void)
+{
+  MetaCacheRegistry *registry;
+
+  registry = g_new0 (MetaCacheRegistry, 1);
+  registry->caches = g_array_new (FALSE, TRUE, sizeof (MetaCacheEntry));
+  g_array_set_clear_func (registry->caches,
+                          (GDestroyNotify) meta_cache_entry_clear);
+
+  return registry;
+}
+
+void
+meta_cache_registry_free (MetaCacheRegistry *registry)
+{
+  g_array_unref (registry->caches);
+  g_free (registry);
+}
+
+/*
+ * @trim may be NULL for caches that can't be trimmed, e.g. because they
+ * don't own what they cache, but whose size is still worth reporting.
+ */
+void
+meta_cache_registry_add_cache (MetaCacheRegistry     *registry,
+                               const char            *name,
+                               MetaCacheTrimLevel     min_level,
+                               MetaCacheGetStatsFunc  get_stats,
+                               MetaCacheTrimFunc      trim,
+                               gpointer               user_data)
+{
+  MetaCacheEntry entry = {
+    .name = g_strdup (name),
+    .min_level = min_level,
+    .get_stats = get_stats,
+    .trim = trim,
+    .user_data = user_data,
+  };
+
+  g_array_append_val (registry->caches, entry);
+}
+
+void
+meta_cache_registry_trim (MetaCacheRegistry  *registry,
+                          MetaCacheTrimLevel  level)
+{
+  unsigned int i;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaCacheRegistryTrim,
+                           "Meta::CacheRegistry::trim()");
+
+  meta_topic (META_DEBUG_RENDER, "Trimming caches at %s memory pressure",
+              meta_cache_trim_level_to_string (level));
+
+  for (i = 0; i < registry->caches->len; i++)
+    {
+      MetaCacheEntry *entry =
+        &g_array_index (registry->caches, MetaCacheEntry, i);
+
+      if (!entry->trim || level < entry->min_level)
+        continue;
+
+      meta_topic (META_DEBUG_RENDER, "Trimming %s cache", entry->name);
+      entry->trim (level, entry->user_data);
+    }
+
+#ifdef HAVE_MALLOC_TRIM
+  /* Give the memory freed by the caches back to the system */
+  if (level == META_CACHE_TRIM_LEVEL_CRITICAL)
+    malloc_trim (0);
+#endif
+
+  meta_cache_registry_update_counters (registry);
+}
+
+size_t
+meta_cache_registry_get_total_size (MetaCacheRegistry *registry)
+{
+  size_t total_size = 0;
+  unsigned int i;
+
+  for (i = 0; i < registry->caches->len; i++)
+    {
+      MetaCacheEntry *entry =
+        &g_array_index (registry->caches, MetaCacheEntry, i);
+      size_t size = 0;
+      unsigned int n_entries = 0;
+
+      entry->get_stats (entry->user_data, &size, &n_entries);
+      total_size += size;
+    }
+
+  return total_size;
+}
+
+/* Returns the size in bytes and the number of entries of each cache */
+GVariant *
+meta_cache_registry_get_stats (MetaCacheRegistry *registry)
+{
+  GVariantBuilder builder;
+  unsigned int i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(tu)}"));
+
+  for (i = 0; i < registry->caches->len; i++)
+    {
+      MetaCacheEntry *entry =
+        &g_array_index (registry->caches, MetaCacheEntry, i);
+      size_t size = 0;
+      unsigned int n_entries = 0;
+
+      entry->get_stats (entry->user_data, &size, &n_entries);
+      g_variant_builder_add (&builder, "{s(tu)}",
+                             entry->name, (uint64_t) size, n_entries);
+    }
+
+  return g_variant_builder_end (&builder);
+}
+
+void
+meta_cache_registry_update_counters (MetaCacheRegistry *registry)
+{
+#ifdef HAVE_PROFILER
+  COGL_TRACE_DEFINE_COUNTER_INT (MetaCacheRegistryTotalSize,
+                                 "CacheSize",
+                                 "the number of bytes used by all caches");
+
+  if (!cogl_is_capturing_traces ())
+    return;
+
+  COGL_TRACE_SET_COUNTER_INT (MetaCacheRegistryTotalSize,
+                              meta_cache_registry_get_total_size (registry));
+#endif
+}
+
+const char *
+meta_cache_trim_level_to_string (MetaCacheTrimLevel level)
+{
+  switch (level)
+    {
+    case META_CACHE_TRIM_LEVEL_LOW:
+      return "low";
+    case META_CACHE_TRIM_LEVEL_MEDIUM:
+      return "medium";
+    case META_CACHE_TRIM_LEVEL_CRITICAL:
+      return "critical";
+    }
+
+  g_assert_not_reached ();
+}
@@ -0,0 +1,62 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <glib.h>
+
+/* How much memory is to be given back, by increasing cost of the trim */
+typedef enum _MetaCacheTrimLevel
+{
+  META_CACHE_TRIM_LEVEL_LOW,
+  META_CACHE_TRIM_LEVEL_MEDIUM,
+  META_CACHE_TRIM_LEVEL_CRITICAL,
+} MetaCacheTrimLevel;
+
+typedef struct _MetaCacheRegistry MetaCacheRegistry;
+
+typedef void (* MetaCacheGetStatsFunc) (gpointer      user_data,
+                                        size_t       *out_size,
+                                        unsigned int *out_n_entries);
+
+typedef void (* MetaCacheTrimFunc) (MetaCacheTrimLevel level,
+                                    gpointer           user_data);
+
+MetaCacheRegistry * meta_cache_registry_new (void);
+
+void meta_cache_registry_free (MetaCacheRegistry *registry);
+
+void meta_cache_registry_add_cache (MetaCacheRegistry     *registry,
+                                    const char            *name,
+                                    MetaCacheTrimLevel     min_level,
+                                    MetaCacheGetStatsFunc  get_stats,
+                                    MetaCacheTrimFunc      trim,
+                                    gpointer               user_data);
+
+void meta_cache_registry_trim (MetaCacheRegistry  *registry,
+                               MetaCacheTrimLevel  level);
+
+size_t meta_cache_registry_get_total_size (MetaCacheRegistry *registry);
+
+GVariant * meta_cache_registry_get_stats (MetaCacheRegistry *registry);
+
+void meta_cache_registry_update_counters (MetaCacheRegistry *registry);
+
+const char * meta_cache_trim_level_to_string (MetaCacheTrimLevel level);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaCacheRegistry, meta_cache_registry_free)
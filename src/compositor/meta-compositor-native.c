@@ -20,11 +20,18 @@
 
 #include "compositor/meta-compositor-native.h"
 
+#include "backends/meta-idle-manager.h"
 #include "compositor/meta-compositor-view-native.h"
+#include "meta/meta-idle-monitor.h"
+#include "meta/prefs.h"
 
 struct _MetaCompositorNative
 {
   MetaCompositorServer parent;
+
+  gboolean is_idle;
+  guint idle_watch_id;
+  guint user_active_watch_id;
 };
 
 G_DEFINE_TYPE (MetaCompositorNative, meta_compositor_native,
@@ -34,6 +41,7 @@ static void
 meta_compositor_native_before_paint (MetaCompositor     *compositor,
                                      MetaCompositorView *compositor_view)
 {
+  MetaCompositorNative *compositor_native = META_COMPOSITOR_NATIVE (compositor);
   MetaCompositorViewNative *compositor_view_native =
     META_COMPOSITOR_VIEW_NATIVE (compositor_view);
   MetaCompositorClass *parent_class;
@@ -44,7 +52,8 @@ meta_compositor_native_before_paint (MetaCompositor     *compositor,
 #endif
 
   meta_compositor_view_native_maybe_update_frame_sync_surface (compositor_view_native,
-                                                               compositor);
+                                                               compositor,
+                                                               compositor_native->is_idle);
 
   parent_class = META_COMPOSITOR_CLASS (meta_compositor_native_parent_class);
   parent_class->before_paint (compositor, compositor_view);
@@ -61,6 +70,105 @@ meta_compositor_native_create_view (MetaCompositor   *compositor,
   return META_COMPOSITOR_VIEW (compositor_view_native);
 }
 
+static MetaIdleMonitor *
+get_core_idle_monitor (MetaCompositorNative *compositor_native)
+{
+  MetaCompositor *compositor = META_COMPOSITOR (compositor_native);
+  MetaBackend *backend = meta_compositor_get_backend (compositor);
+  MetaIdleManager *idle_manager = meta_backend_get_idle_manager (backend);
+
+  return meta_idle_manager_get_core_monitor (idle_manager);
+}
+
+static void
+on_user_active (MetaIdleMonitor *monitor,
+                guint            watch_id,
+                gpointer         user_data)
+{
+  MetaCompositorNative *compositor_native = user_data;
+  MetaCompositor *compositor = META_COMPOSITOR (compositor_native);
+  ClutterStage *stage = meta_compositor_get_stage (compositor);
+  GList *l;
+
+  compositor_native->user_active_watch_id = 0;
+  compositor_native->is_idle = FALSE;
+
+  /* Don't let the first frame after the user became active wait for the
+   * lowered refresh rate. */
+  for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
+    clutter_stage_view_schedule_update_now (l->data);
+}
+
+static void
+on_idle (MetaIdleMonitor *monitor,
+         guint            watch_id,
+         gpointer         user_data)
+{
+  MetaCompositorNative *compositor_native = user_data;
+
+  compositor_native->is_idle = TRUE;
+
+  if (!compositor_native->user_active_watch_id)
+    {
+      compositor_native->user_active_watch_id =
+        meta_idle_monitor_add_user_active_watch (monitor,
+                                                 on_user_active,
+                                                 compositor_native,
+                                                 NULL);
+    }
+}
+
+static void
+clear_idle_watches (MetaCompositorNative *compositor_native)
+{
+  MetaIdleMonitor *monitor = get_core_idle_monitor (compositor_native);
+
+  if (compositor_native->idle_watch_id)
+    {
+      meta_idle_monitor_remove_watch (monitor,
+                                      compositor_native->idle_watch_id);
+      compositor_native->idle_watch_id = 0;
+    }
+
+  if (compositor_native->user_active_watch_id)
+    {
+      meta_idle_monitor_remove_watch (monitor,
+                                      compositor_native->user_active_watch_id);
+      compositor_native->user_active_watch_id = 0;
+    }
+
+  compositor_native->is_idle = FALSE;
+}
+
+static void
+update_idle_watch (MetaCompositorNative *compositor_native)
+{
+  unsigned int timeout_ms;
+
+  clear_idle_watches (compositor_native);
+
+  timeout_ms = meta_prefs_get_idle_refresh_rate_timeout ();
+  if (timeout_ms == 0)
+    return;
+
+  compositor_native->idle_watch_id =
+    meta_idle_monitor_add_idle_watch (get_core_idle_monitor (compositor_native),
+                                      timeout_ms,
+                                      on_idle,
+                                      compositor_native,
+                                      NULL);
+}
+
+static void
+prefs_changed_callback (MetaPreference pref,
+                        gpointer       user_data)
+{
+  MetaCompositorNative *compositor_native = user_data;
+
+  if (pref == META_PREF_IDLE_REFRESH_RATE_TIMEOUT)
+    update_idle_watch (compositor_native);
+}
+
 MetaCompositorNative *
 meta_compositor_native_new (MetaDisplay *display,
                             MetaBackend *backend)
@@ -71,6 +179,29 @@ meta_compositor_native_new (MetaDisplay *display,
                        NULL);
 }
 
+static void
+meta_compositor_native_constructed (GObject *object)
+{
+  MetaCompositorNative *compositor_native = META_COMPOSITOR_NATIVE (object);
+
+  G_OBJECT_CLASS (meta_compositor_native_parent_class)->constructed (object);
+
+  meta_prefs_add_listener (prefs_changed_callback, compositor_native);
+  update_idle_watch (compositor_native);
+}
+
+static void
+meta_compositor_native_dispose (GObject *object)
+{
+  MetaCompositorNative *compositor_native = META_COMPOSITOR_NATIVE (object);
+
+  clear_idle_watches (compositor_native);
+
+  meta_prefs_remove_listener (prefs_changed_callback, compositor_native);
+
+  G_OBJECT_CLASS (meta_compositor_native_parent_class)->dispose (object);
+}
+
 static void
 meta_compositor_native_init (MetaCompositorNative *compositor_native)
 {
@@ -79,8 +210,12 @@ meta_compositor_native_init (MetaCompositorNative *compositor_native)
 static void
 meta_compositor_native_class_init (MetaCompositorNativeClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   MetaCompositorClass *compositor_class = META_COMPOSITOR_CLASS (klass);
 
+  object_class->constructed = meta_compositor_native_constructed;
+  object_class->dispose = meta_compositor_native_dispose;
+
   compositor_class->before_paint = meta_compositor_native_before_paint;
   compositor_class->create_view = meta_compositor_native_create_view;
 }
@@ -39,7 +39,8 @@
 #endif /* HAVE_WAYLAND */
 
 static void update_frame_sync_surface (MetaCompositorViewNative *view_native,
-                                       MetaSurfaceActor         *surface_actor);
+                                       MetaSurfaceActor         *surface_actor,
+                                       gboolean                  is_windowed);
 
 struct _MetaCompositorViewNative
 {
@@ -47,9 +48,12 @@ struct _MetaCompositorViewNative
 
 #ifdef HAVE_WAYLAND
   MetaWaylandSurface *scanout_candidate;
+  MetaWaylandSurface *overlay_surface;
 #endif /* HAVE_WAYLAND */
 
   MetaSurfaceActor *frame_sync_surface;
+  gboolean is_frame_sync_surface_windowed;
+  gboolean is_idle;
 
   gulong frame_sync_surface_repaint_scheduled_id;
   gulong frame_sync_surface_update_scheduled_id;
@@ -105,73 +109,77 @@ on_frame_sync_surface_is_frozen_changed (MetaSurfaceActor         *surface_actor
                                          MetaCompositorViewNative *view_native)
 {
   if (meta_surface_actor_is_frozen (surface_actor))
-    update_frame_sync_surface (view_native, NULL);
+    update_frame_sync_surface (view_native, NULL, FALSE);
 }
 
 static void
 on_frame_sync_surface_destroyed (MetaSurfaceActor         *surface_actor,
                                  MetaCompositorViewNative *view_native)
 {
-  update_frame_sync_surface (view_native, NULL);
+  update_frame_sync_surface (view_native, NULL, FALSE);
 }
 
 #ifdef HAVE_WAYLAND
 static void
-update_scanout_candidate (MetaCompositorViewNative *view_native,
-                          MetaWaylandSurface       *surface,
-                          MetaCrtc                 *crtc)
+update_scanout_candidate (MetaCompositorViewNative      *view_native,
+                          MetaWaylandSurface            *surface,
+                          MetaCrtc                      *crtc,
+                          MetaWaylandBufferScanoutFlags  flags)
 {
   if (view_native->scanout_candidate &&
       view_native->scanout_candidate != surface)
     {
       meta_wayland_surface_set_scanout_candidate (view_native->scanout_candidate,
-                                                  NULL);
+                                                  NULL,
+                                                  META_WAYLAND_BUFFER_SCANOUT_FLAG_NONE);
       g_clear_weak_pointer (&view_native->scanout_candidate);
     }
 
   if (surface)
     {
-      meta_wayland_surface_set_scanout_candidate (surface, crtc);
+      meta_wayland_surface_set_scanout_candidate (surface, crtc, flags);
       g_set_weak_pointer (&view_native->scanout_candidate,
                           surface);
     }
 }
 
+static void
+update_overlay_surface (MetaCompositorViewNative *view_native,
+                        MetaWaylandSurface       *surface)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+
+  if (view_native->overlay_surface == surface)
+    return;
+
+  if (view_native->overlay_surface)
+    {
+      meta_wayland_surface_set_overlay_scanout_view (view_native->overlay_surface,
+                                                     NULL);
+      g_clear_weak_pointer (&view_native->overlay_surface);
+    }
+
+  if (surface)
+    {
+      meta_wayland_surface_set_overlay_scanout_view (surface, stage_view);
+      g_set_weak_pointer (&view_native->overlay_surface, surface);
+    }
+}
+
 static gboolean
-find_scanout_candidate (MetaCompositorView  *compositor_view,
-                        MetaCompositor      *compositor,
-                        MetaCrtc           **crtc_out,
-                        CoglOnscreen       **onscreen_out,
-                        MetaWaylandSurface **surface_out)
+is_software_cursor_in_view (MetaCompositorView *compositor_view,
+                            MetaCompositor     *compositor)
 {
   ClutterStageView *stage_view =
     meta_compositor_view_get_stage_view (compositor_view);
   MetaStageView *view = META_STAGE_VIEW (stage_view);
-  MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
   MetaBackend *backend = meta_compositor_get_backend (compositor);
   MetaCursorTracker *cursor_tracker =
     meta_backend_get_cursor_tracker (backend);
   CoglTexture *cursor_sprite;
-  MetaCrtc *crtc;
-  CoglFramebuffer *framebuffer;
-  MetaWindowActor *window_actor;
   MtkRectangle view_rect;
-  ClutterActorBox actor_box;
-  MetaSurfaceActor *surface_actor;
-  MetaSurfaceActorWayland *surface_actor_wayland;
-  ClutterColorState *view_color_state;
-  ClutterColorState *surface_color_state;
-  MetaWaylandSurface *surface;
-
-  if (meta_get_debug_paint_flags () & META_DEBUG_PAINT_DISABLE_DIRECT_SCANOUT)
-    return FALSE;
-
-  if (meta_compositor_is_unredirect_inhibited (compositor))
-    {
-      meta_topic (META_DEBUG_RENDER,
-                  "No direct scanout candidate: unredirect inhibited");
-      return FALSE;
-    }
 
   clutter_stage_view_get_layout (stage_view, &view_rect);
 
@@ -203,11 +211,76 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
       if (graphene_rect_intersection (&graphene_view_rect,
                                       &cursor_rect,
                                       NULL))
-        {
-          meta_topic (META_DEBUG_RENDER,
-                      "No direct scanout candidate: using software cursor");
-          return FALSE;
-        }
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+can_present_color_state_directly (ClutterColorState *view_color_state,
+                                  ClutterColorState *surface_color_state)
+{
+  if (clutter_color_state_equals (view_color_state, surface_color_state))
+    return TRUE;
+
+  /* HDR clients often describe their content with luminance levels that
+   * differ from the output's, which, for e.g. PQ, doesn't necessarily mean
+   * the content needs to be touched before hitting the display. */
+  if (CLUTTER_IS_COLOR_STATE_PARAMS (view_color_state) &&
+      CLUTTER_IS_COLOR_STATE_PARAMS (surface_color_state))
+    {
+      ClutterColorStateParams *view_params =
+        CLUTTER_COLOR_STATE_PARAMS (view_color_state);
+      ClutterColorStateParams *surface_params =
+        CLUTTER_COLOR_STATE_PARAMS (surface_color_state);
+
+      return clutter_color_state_params_is_passthrough (surface_params,
+                                                        view_params);
+    }
+
+  return FALSE;
+}
+
+static gboolean
+find_scanout_candidate (MetaCompositorView  *compositor_view,
+                        MetaCompositor      *compositor,
+                        MetaCrtc           **crtc_out,
+                        CoglOnscreen       **onscreen_out,
+                        MetaWaylandSurface **surface_out)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaStageView *view = META_STAGE_VIEW (stage_view);
+  MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
+  MetaCrtc *crtc;
+  CoglFramebuffer *framebuffer;
+  MetaWindowActor *window_actor;
+  MtkRectangle view_rect;
+  ClutterActorBox actor_box;
+  MetaSurfaceActor *surface_actor;
+  MetaSurfaceActorWayland *surface_actor_wayland;
+  ClutterColorState *view_color_state;
+  ClutterColorState *surface_color_state;
+  MetaWaylandSurface *surface;
+
+  if (meta_get_debug_paint_flags () & META_DEBUG_PAINT_DISABLE_DIRECT_SCANOUT)
+    return FALSE;
+
+  if (meta_compositor_is_unredirect_inhibited (compositor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No direct scanout candidate: unredirect inhibited");
+      return FALSE;
+    }
+
+  clutter_stage_view_get_layout (stage_view, &view_rect);
+
+  if (is_software_cursor_in_view (compositor_view, compositor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No direct scanout candidate: using software cursor");
+      return FALSE;
     }
 
   crtc = meta_renderer_view_get_crtc (renderer_view);
@@ -294,7 +367,8 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
     clutter_stage_view_get_color_state (CLUTTER_STAGE_VIEW (view));
   surface_color_state =
     clutter_actor_get_color_state (CLUTTER_ACTOR (surface_actor));
-  if (!clutter_color_state_equals (view_color_state, surface_color_state))
+  if (!can_present_color_state_directly (view_color_state,
+                                         surface_color_state))
     {
       meta_topic (META_DEBUG_RENDER,
                   "No direct scanout candidate: "
@@ -326,6 +400,19 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
 }
 
 static void
+on_scanout_failed (CoglScanout        *scanout,
+                   CoglOnscreen       *onscreen,
+                   MetaCompositorView *compositor_view)
+{
+  MetaBypassPolicy *bypass_policy =
+    meta_compositor_view_get_bypass_policy (compositor_view);
+
+  meta_topic (META_DEBUG_RENDER, "Direct scanout failed, backing off");
+
+  meta_bypass_policy_notify_failed (bypass_policy, g_get_monotonic_time ());
+}
+
+static gboolean
 try_assign_next_scanout (MetaCompositorView *compositor_view,
                          CoglOnscreen       *onscreen,
                          MetaWaylandSurface *surface)
@@ -336,15 +423,176 @@ try_assign_next_scanout (MetaCompositorView *compositor_view,
   stage_view = meta_compositor_view_get_stage_view (compositor_view);
   scanout = meta_wayland_surface_try_acquire_scanout (surface,
                                                       onscreen,
-                                                      stage_view);
+                                                      stage_view,
+                                                      META_WAYLAND_BUFFER_SCANOUT_FLAG_NONE);
   if (!scanout)
     {
       meta_topic (META_DEBUG_RENDER,
                   "Could not acquire scanout");
-      return;
+      return FALSE;
     }
 
+  /* Only a directly scanned out surface can be presented with tearing
+   * without affecting anything else on the screen */
+  cogl_scanout_set_allow_tearing (scanout,
+                                  meta_wayland_surface_get_allow_tearing (surface));
+
+  g_signal_connect_object (scanout, "scanout-failed",
+                           G_CALLBACK (on_scanout_failed), compositor_view, 0);
+
   clutter_stage_view_assign_next_scanout (stage_view, scanout);
+  return TRUE;
+}
+
+static MetaWaylandSurface *
+find_overlay_candidate (MetaCompositorView *compositor_view,
+                        MetaCompositor     *compositor)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaWindowActor *window_actor;
+  MetaSurfaceActor *surface_actor;
+  MtkRectangle view_rect;
+  ClutterActorBox actor_box;
+  ClutterColorState *view_color_state;
+  ClutterColorState *surface_color_state;
+
+  if (meta_get_debug_paint_flags () & META_DEBUG_PAINT_DISABLE_DIRECT_SCANOUT)
+    return NULL;
+
+  if (meta_compositor_is_unredirect_inhibited (compositor))
+    return NULL;
+
+  if (clutter_stage_view_has_shadowfb (stage_view))
+    return NULL;
+
+  /* A software cursor painted on the primary plane would end up below the
+   * overlay plane. */
+  if (is_software_cursor_in_view (compositor_view, compositor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: using software cursor");
+      return NULL;
+    }
+
+  window_actor = meta_compositor_view_get_top_window_actor (compositor_view);
+  if (!window_actor)
+    return NULL;
+
+  if (meta_window_actor_effect_in_progress (window_actor) ||
+      clutter_actor_has_transitions (CLUTTER_ACTOR (window_actor)))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: window-actor is animating");
+      return NULL;
+    }
+
+  surface_actor = meta_window_actor_get_scanout_candidate (window_actor);
+  if (!surface_actor)
+    return NULL;
+
+  if (!meta_surface_actor_is_opaque (surface_actor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: surface-actor is not opaque");
+      return NULL;
+    }
+
+  if (clutter_actor_get_paint_opacity (CLUTTER_ACTOR (surface_actor)) != 255)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: surface-actor is translucent");
+      return NULL;
+    }
+
+  if (meta_surface_actor_is_effectively_obscured (surface_actor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: surface-actor is obscured");
+      return NULL;
+    }
+
+  if (!clutter_actor_get_paint_box (CLUTTER_ACTOR (surface_actor),
+                                    &actor_box))
+    return NULL;
+
+  clutter_stage_view_get_layout (stage_view, &view_rect);
+  if (actor_box.x1 < view_rect.x ||
+      actor_box.y1 < view_rect.y ||
+      actor_box.x2 > view_rect.x + view_rect.width ||
+      actor_box.y2 > view_rect.y + view_rect.height)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: surface-actor not contained in "
+                  "stage-view");
+      return NULL;
+    }
+
+  view_color_state = clutter_stage_view_get_color_state (stage_view);
+  surface_color_state =
+    clutter_actor_get_color_state (CLUTTER_ACTOR (surface_actor));
+  if (!can_present_color_state_directly (view_color_state,
+                                         surface_color_state))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: "
+                  "surface color state doesn't match the outputs");
+      return NULL;
+    }
+
+  return meta_surface_actor_wayland_get_surface (META_SURFACE_ACTOR_WAYLAND (surface_actor));
+}
+
+/* Returns the surface that was considered for the overlay plane, if any,
+ * so that it can be told about the formats the plane supports */
+static MetaWaylandSurface *
+maybe_assign_overlay (MetaCompositorView  *compositor_view,
+                      MetaCompositor      *compositor,
+                      MetaCrtc           **crtc_out)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  CoglFramebuffer *framebuffer;
+  MetaOnscreenNative *onscreen_native;
+  MetaCrtc *crtc;
+  MetaWaylandSurface *surface;
+  g_autoptr (CoglScanout) scanout = NULL;
+
+  framebuffer = clutter_stage_view_get_onscreen (stage_view);
+  if (!META_IS_ONSCREEN_NATIVE (framebuffer))
+    return NULL;
+
+  onscreen_native = META_ONSCREEN_NATIVE (framebuffer);
+
+  surface = find_overlay_candidate (compositor_view, compositor);
+  if (surface)
+    {
+      scanout =
+        meta_wayland_surface_try_acquire_scanout (surface,
+                                                  COGL_ONSCREEN (framebuffer),
+                                                  stage_view,
+                                                  META_WAYLAND_BUFFER_SCANOUT_FLAG_OVERLAY);
+      if (!scanout)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "Could not acquire overlay scanout");
+        }
+    }
+
+  meta_onscreen_native_set_overlay_scanout (onscreen_native, scanout);
+  update_overlay_surface (META_COMPOSITOR_VIEW_NATIVE (compositor_view),
+                          scanout ? surface : NULL);
+
+  if (!surface)
+    return NULL;
+
+  crtc = meta_renderer_view_get_crtc (META_RENDERER_VIEW (stage_view));
+  if (!META_IS_CRTC_KMS (crtc) ||
+      !meta_crtc_kms_get_assigned_overlay_plane (META_CRTC_KMS (crtc)))
+    return NULL;
+
+  *crtc_out = crtc;
+  return surface;
 }
 
 void
@@ -355,27 +603,145 @@ meta_compositor_view_native_maybe_assign_scanout (MetaCompositorViewNative *view
   MetaCrtc *crtc = NULL;
   CoglOnscreen *onscreen = NULL;
   MetaWaylandSurface *surface = NULL;
+  MetaWaylandBufferScanoutFlags flags = META_WAYLAND_BUFFER_SCANOUT_FLAG_NONE;
+  MetaBypassPolicy *bypass_policy =
+    meta_compositor_view_get_bypass_policy (compositor_view);
+  int64_t now_us = g_get_monotonic_time ();
   gboolean candidate_found;
+  gboolean should_bypass;
+  gboolean is_bypassed;
 
   candidate_found = find_scanout_candidate (compositor_view,
                                             compositor,
                                             &crtc,
                                             &onscreen,
                                             &surface);
-  if (candidate_found)
+
+  should_bypass = meta_bypass_policy_should_bypass (bypass_policy,
+                                                    candidate_found,
+                                                    now_us);
+  is_bypassed =
+    should_bypass &&
+    try_assign_next_scanout (compositor_view, onscreen, surface);
+  meta_bypass_policy_set_bypassed (bypass_policy, is_bypassed, now_us);
+
+  if (!should_bypass && candidate_found)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Not using direct scanout candidate: %s",
+                  meta_bypass_decision_to_string (bypass_policy->decision));
+    }
+
+  /* While holding off or backing off, the candidate isn't moved to the
+   * overlay plane either, as that would just be another transition */
+  if (!is_bypassed && (!candidate_found || should_bypass))
+    {
+      MetaWaylandSurface *overlay_surface;
+      MetaCrtc *overlay_crtc = NULL;
+
+      overlay_surface = maybe_assign_overlay (compositor_view, compositor,
+                                              &overlay_crtc);
+
+      /* A surface that could go on the primary plane is preferred, even
+       * if it currently can't, as that is what its feedback will fix */
+      if (!candidate_found && overlay_surface)
+        {
+          surface = overlay_surface;
+          crtc = overlay_crtc;
+          flags = META_WAYLAND_BUFFER_SCANOUT_FLAG_OVERLAY;
+        }
+    }
+  else if (META_IS_ONSCREEN_NATIVE (onscreen))
     {
-      try_assign_next_scanout (compositor_view,
-                               onscreen,
-                               surface);
+      meta_onscreen_native_set_overlay_scanout (META_ONSCREEN_NATIVE (onscreen),
+                                                NULL);
+      update_overlay_surface (view_native, NULL);
     }
 
-  update_scanout_candidate (view_native, surface, crtc);
+  update_scanout_candidate (view_native, surface, crtc, flags);
 }
 #endif /* HAVE_WAYLAND */
 
+static void
+find_largest_surface_actor (ClutterActor      *actor,
+                            MetaSurfaceActor **largest_surface_actor,
+                            float             *largest_area)
+{
+  ClutterActorIter iter;
+  ClutterActor *child;
+
+  clutter_actor_iter_init (&iter, actor);
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      MetaSurfaceActor *surface_actor;
+      float width, height;
+
+      if (!clutter_actor_is_mapped (child))
+        continue;
+
+      if (!META_IS_SURFACE_ACTOR (child))
+        {
+          find_largest_surface_actor (child,
+                                      largest_surface_actor,
+                                      largest_area);
+          continue;
+        }
+
+      surface_actor = META_SURFACE_ACTOR (child);
+      if (meta_surface_actor_is_obscured (surface_actor))
+        continue;
+
+      clutter_actor_get_transformed_size (child, &width, &height);
+      if (width * height > *largest_area)
+        {
+          *largest_surface_actor = surface_actor;
+          *largest_area = width * height;
+        }
+    }
+}
+
+/*
+ * When the focused window doesn't cover the view, let its largest visible
+ * surface, e.g. the one a video is played back in, drive the refresh rate.
+ */
+static MetaSurfaceActor *
+find_windowed_frame_sync_candidate (MetaWindowActor *window_actor)
+{
+  MetaWindow *window = meta_window_actor_get_meta_window (window_actor);
+  MetaSurfaceActor *surface_actor = NULL;
+  float area = 0.0f;
+
+  if (!meta_window_has_focus (window))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No windowed frame sync candidate: meta-window not focused");
+      return NULL;
+    }
+
+  find_largest_surface_actor (CLUTTER_ACTOR (window_actor),
+                              &surface_actor,
+                              &area);
+  if (!surface_actor)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No windowed frame sync candidate: no visible surface-actor");
+      return NULL;
+    }
+
+  if (meta_surface_actor_is_frozen (surface_actor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No windowed frame sync candidate: surface-actor is frozen");
+      return NULL;
+    }
+
+  return surface_actor;
+}
+
 static MetaSurfaceActor *
 find_frame_sync_candidate (MetaCompositorView *compositor_view,
-                           MetaCompositor     *compositor)
+                           MetaCompositor     *compositor,
+                           gboolean           *out_is_windowed)
 {
   MetaWindowActor *window_actor;
   MetaWindow *window;
@@ -434,10 +800,9 @@ find_frame_sync_candidate (MetaCompositorView *compositor_view,
 
   if (!meta_window_geometry_contains_rect (window, &view_layout))
     {
-      meta_topic (META_DEBUG_RENDER,
-                  "No frame sync candidate: stage-view layout not covered "
-                  "by meta-window frame");
-      return NULL;
+      surface_actor = find_windowed_frame_sync_candidate (window_actor);
+      *out_is_windowed = surface_actor != NULL;
+      return surface_actor;
     }
 
   surface_actor = meta_window_actor_get_scanout_candidate (window_actor);
@@ -464,16 +829,19 @@ find_frame_sync_candidate (MetaCompositorView *compositor_view,
       return NULL;
     }
 
+  *out_is_windowed = FALSE;
   return surface_actor;
 }
 
 static void
 update_frame_sync_surface (MetaCompositorViewNative *view_native,
-                           MetaSurfaceActor         *surface_actor)
+                           MetaSurfaceActor         *surface_actor,
+                           gboolean                  is_windowed)
 {
   MetaCompositorView *compositor_view =
     META_COMPOSITOR_VIEW (view_native);
   ClutterStageView *stage_view;
+  ClutterFrameClock *frame_clock;
   CoglFramebuffer *framebuffer;
 
   g_clear_signal_handler (&view_native->frame_sync_surface_repaint_scheduled_id,
@@ -507,32 +875,52 @@ update_frame_sync_surface (MetaCompositorViewNative *view_native,
     }
 
   view_native->frame_sync_surface = surface_actor;
+  view_native->is_frame_sync_surface_windowed = is_windowed;
 
   stage_view = meta_compositor_view_get_stage_view (compositor_view);
 
+  /* Other content is visible next to a windowed frame sync surface, and
+   * must still be updated in time. */
+  frame_clock = clutter_stage_view_get_frame_clock (stage_view);
+  if (frame_clock)
+    clutter_frame_clock_set_throttle_variable_updates (frame_clock,
+                                                       !is_windowed);
+
   framebuffer = clutter_stage_view_get_onscreen (stage_view);
   if (!META_IS_ONSCREEN_NATIVE (framebuffer))
     return;
 
+  /* While the user is idle, only refresh as often as the content changes,
+   * even without a frame sync surface, to not keep the refresh rate high
+   * for e.g. a blinking text cursor. */
   meta_onscreen_native_request_frame_sync (META_ONSCREEN_NATIVE (framebuffer),
-                                           surface_actor != NULL);
+                                           surface_actor != NULL ||
+                                           view_native->is_idle);
 }
 
 void
 meta_compositor_view_native_maybe_update_frame_sync_surface (MetaCompositorViewNative *view_native,
-                                                             MetaCompositor           *compositor)
+                                                             MetaCompositor           *compositor,
+                                                             gboolean                  is_idle)
 {
   MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
   MetaSurfaceActor *surface_actor;
+  gboolean is_windowed = FALSE;
 
   surface_actor = find_frame_sync_candidate (compositor_view,
-                                             compositor);
+                                             compositor,
+                                             &is_windowed);
 
-  if (G_LIKELY (surface_actor == view_native->frame_sync_surface))
+  if (G_LIKELY (surface_actor == view_native->frame_sync_surface &&
+                is_windowed == view_native->is_frame_sync_surface_windowed &&
+                is_idle == view_native->is_idle))
     return;
 
+  view_native->is_idle = is_idle;
+
   update_frame_sync_surface (view_native,
-                             surface_actor);
+                             surface_actor,
+                             is_windowed);
 }
 
 MetaCompositorViewNative *
@@ -570,6 +958,7 @@ meta_compositor_view_native_finalize (GObject *object)
   MetaCompositorViewNative *view_native = META_COMPOSITOR_VIEW_NATIVE (object);
 
   g_clear_weak_pointer (&view_native->scanout_candidate);
+  g_clear_weak_pointer (&view_native->overlay_surface);
 #endif /* HAVE_WAYLAND */
 
   G_OBJECT_CLASS (meta_compositor_view_native_parent_class)->finalize (object);
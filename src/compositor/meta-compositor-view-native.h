@@ -38,4 +38,5 @@ void meta_compositor_view_native_maybe_assign_scanout (MetaCompositorViewNative
 #endif /* HAVE_WAYLAND */
 
 void meta_compositor_view_native_maybe_update_frame_sync_surface (MetaCompositorViewNative *view_native,
-                                                                  MetaCompositor           *compositor);
+                                                                  MetaCompositor           *compositor,
+                                                                  gboolean                  is_idle);
@@ -24,10 +24,6 @@
 
 #include "compositor/meta-compositor-view.h"
 
-#include "core/window-private.h"
-#include "meta/boxes.h"
-#include "meta/window.h"
-
 enum
 {
   PROP_0,
@@ -44,6 +40,9 @@ typedef struct _MetaCompositorViewPrivate
   ClutterStageView *stage_view;
 
   MetaWindowActor *top_window_actor;
+  gboolean needs_top_window_actor_update;
+
+  MetaBypassPolicy bypass_policy;
 } MetaCompositorViewPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaCompositorView, meta_compositor_view,
@@ -59,47 +58,33 @@ meta_compositor_view_new (ClutterStageView *stage_view)
                        NULL);
 }
 
-static MetaWindowActor *
-find_top_window_actor_on_view (ClutterStageView *stage_view,
-                               GList            *window_actors)
+void
+meta_compositor_view_set_top_window_actor (MetaCompositorView *compositor_view,
+                                           MetaWindowActor    *window_actor)
 {
-  GList *l;
-
-  for (l = g_list_last (window_actors); l; l = l->prev)
-    {
-      MetaWindowActor *window_actor = l->data;
-      MetaWindow *window =
-        meta_window_actor_get_meta_window (window_actor);
-      MtkRectangle buffer_rect;
-      MtkRectangle view_layout;
-
-      if (!window->visible_to_compositor)
-        continue;
-
-      meta_window_get_buffer_rect (window, &buffer_rect);
-      clutter_stage_view_get_layout (stage_view,
-                                     &view_layout);
-
-      if (mtk_rectangle_overlap (&view_layout, &buffer_rect))
-        return window_actor;
-    }
+  MetaCompositorViewPrivate *priv =
+    meta_compositor_view_get_instance_private (compositor_view);
 
-  return NULL;
+  g_set_weak_pointer (&priv->top_window_actor, window_actor);
+  priv->needs_top_window_actor_update = FALSE;
 }
 
 void
-meta_compositor_view_update_top_window_actor (MetaCompositorView *compositor_view,
-                                              GList              *window_actors)
+meta_compositor_view_invalidate_top_window_actor (MetaCompositorView *compositor_view)
 {
   MetaCompositorViewPrivate *priv =
     meta_compositor_view_get_instance_private (compositor_view);
-  MetaWindowActor *top_window_actor;
 
-  top_window_actor = find_top_window_actor_on_view (priv->stage_view,
-                                                    window_actors);
+  priv->needs_top_window_actor_update = TRUE;
+}
+
+gboolean
+meta_compositor_view_needs_top_window_actor_update (MetaCompositorView *compositor_view)
+{
+  MetaCompositorViewPrivate *priv =
+    meta_compositor_view_get_instance_private (compositor_view);
 
-  g_set_weak_pointer (&priv->top_window_actor,
-                      top_window_actor);
+  return priv->needs_top_window_actor_update;
 }
 
 MetaWindowActor *
@@ -120,6 +105,15 @@ meta_compositor_view_get_stage_view (MetaCompositorView *compositor_view)
   return priv->stage_view;
 }
 
+MetaBypassPolicy *
+meta_compositor_view_get_bypass_policy (MetaCompositorView *compositor_view)
+{
+  MetaCompositorViewPrivate *priv =
+    meta_compositor_view_get_instance_private (compositor_view);
+
+  return &priv->bypass_policy;
+}
+
 static void
 meta_compositor_view_set_property (GObject      *object,
                                    guint         prop_id,
@@ -193,4 +187,9 @@ meta_compositor_view_class_init (MetaCompositorViewClass *klass)
 static void
 meta_compositor_view_init (MetaCompositorView *compositor_view)
 {
+  MetaCompositorViewPrivate *priv =
+    meta_compositor_view_get_instance_private (compositor_view);
+
+  priv->needs_top_window_actor_update = TRUE;
+  meta_bypass_policy_init (&priv->bypass_policy);
 }
@@ -25,6 +25,7 @@
 #include <glib-object.h>
 
 #include "clutter/clutter-mutter.h"
+#include "compositor/meta-bypass-policy.h"
 #include "meta/meta-window-actor.h"
 
 struct _MetaCompositorViewClass
@@ -38,9 +39,15 @@ G_DECLARE_DERIVABLE_TYPE (MetaCompositorView, meta_compositor_view,
 
 MetaCompositorView *meta_compositor_view_new (ClutterStageView *stage_view);
 
-void meta_compositor_view_update_top_window_actor (MetaCompositorView *compositor_view,
-                                                   GList              *window_actors);
+void meta_compositor_view_set_top_window_actor (MetaCompositorView *compositor_view,
+                                                MetaWindowActor    *window_actor);
+
+void meta_compositor_view_invalidate_top_window_actor (MetaCompositorView *compositor_view);
+
+gboolean meta_compositor_view_needs_top_window_actor_update (MetaCompositorView *compositor_view);
 
 MetaWindowActor *meta_compositor_view_get_top_window_actor (MetaCompositorView *compositor_view);
 
 ClutterStageView *meta_compositor_view_get_stage_view (MetaCompositorView *compositor_view);
+
+MetaBypassPolicy *meta_compositor_view_get_bypass_policy (MetaCompositorView *compositor_view);
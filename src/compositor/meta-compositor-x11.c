@@ -304,9 +304,14 @@ set_unredirected_window (MetaCompositorX11 *compositor_x11,
 }
 
 static void
-maybe_unredirect_top_window (MetaCompositorX11 *compositor_x11)
+maybe_unredirect_top_window (MetaCompositorX11  *compositor_x11,
+                             MetaCompositorView *compositor_view)
 {
   MetaCompositor *compositor = META_COMPOSITOR (compositor_x11);
+  MetaBypassPolicy *bypass_policy =
+    meta_compositor_view_get_bypass_policy (compositor_view);
+  int64_t now_us = g_get_monotonic_time ();
+  MetaWindow *candidate_window = NULL;
   MetaWindow *window_to_unredirect = NULL;
   MetaWindowActor *window_actor;
   MetaWindowActorX11 *window_actor_x11;
@@ -322,10 +327,18 @@ maybe_unredirect_top_window (MetaCompositorX11 *compositor_x11)
   if (!meta_window_actor_x11_should_unredirect (window_actor_x11))
     goto out;
 
-  window_to_unredirect = meta_window_actor_get_meta_window (window_actor);
+  candidate_window = meta_window_actor_get_meta_window (window_actor);
 
 out:
+  if (meta_bypass_policy_should_bypass (bypass_policy,
+                                        candidate_window != NULL,
+                                        now_us))
+    window_to_unredirect = candidate_window;
+
   set_unredirected_window (compositor_x11, window_to_unredirect);
+  meta_bypass_policy_set_bypassed (bypass_policy,
+                                   window_to_unredirect != NULL,
+                                   now_us);
 }
 
 static void
@@ -404,7 +417,7 @@ meta_compositor_x11_before_paint (MetaCompositor     *compositor,
   MetaCompositorX11 *compositor_x11 = META_COMPOSITOR_X11 (compositor);
   MetaCompositorClass *parent_class;
 
-  maybe_unredirect_top_window (compositor_x11);
+  maybe_unredirect_top_window (compositor_x11, compositor_view);
 
   parent_class = META_COMPOSITOR_CLASS (meta_compositor_x11_parent_class);
   parent_class->before_paint (compositor, compositor_view);
@@ -30,19 +30,33 @@
 G_DEFINE_INTERFACE (MetaCullable, meta_cullable, CLUTTER_TYPE_ACTOR);
 
 static gboolean
-has_active_effects (ClutterActor *actor)
+has_active_effects (ClutterActor *actor,
+                    gboolean     *out_shape_preserving)
 {
   g_autoptr (GList) effects = NULL;
+  gboolean has_effects = FALSE;
+  gboolean shape_preserving = TRUE;
   GList *l;
 
   effects = clutter_actor_get_effects (actor);
   for (l = effects; l != NULL; l = l->next)
     {
-      if (clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (l->data)))
-        return TRUE;
+      ClutterEffect *effect = CLUTTER_EFFECT (l->data);
+
+      if (!clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (effect)))
+        continue;
+
+      has_effects = TRUE;
+
+      if (!clutter_effect_is_shape_preserving (effect))
+        {
+          shape_preserving = FALSE;
+          break;
+        }
     }
 
-  return FALSE;
+  *out_shape_preserving = shape_preserving;
+  return has_effects;
 }
 
 static MtkRegion *
@@ -80,7 +94,8 @@ typedef void (* ChildCullMethod) (MetaCullable *cullable,
 static void
 cull_out_children_common (MetaCullable    *cullable,
                           MtkRegion       *region,
-                          ChildCullMethod  method)
+                          ChildCullMethod  method,
+                          gboolean         clips_painting)
 {
   ClutterActor *actor = CLUTTER_ACTOR (cullable);
   ClutterActor *child;
@@ -90,6 +105,8 @@ cull_out_children_common (MetaCullable    *cullable,
   while (clutter_actor_iter_prev (&iter, &child))
     {
       gboolean needs_culling;
+      gboolean has_effects = FALSE;
+      gboolean shape_preserving;
 
       if (!META_IS_CULLABLE (child))
         continue;
@@ -102,27 +119,22 @@ cull_out_children_common (MetaCullable    *cullable,
       /* If an actor has effects applied, then that can change the area
        * it paints and the opacity, so we no longer can figure out what
        * portion of the actor is obscured and what portion of the screen
-       * it obscures, so we skip the actor.
-       *
-       * This has a secondary beneficial effect: if a ClutterOffscreenEffect
-       * is applied to an actor, then our clipped redraws interfere with the
-       * caching of the FBO - even if we only need to draw a small portion
-       * of the window right now, ClutterOffscreenEffect may use other portions
-       * of the FBO later. So, skipping actors with effects applied also
-       * prevents these bugs.
-       *
-       * Theoretically, we should check clutter_actor_get_offscreen_redirect()
-       * as well for the same reason, but omitted for simplicity in the
-       * hopes that no-one will do that.
+       * it obscures, so we skip the actor, unless all of the effects
+       * declare that they preserve the shape of the actor.
        */
-      if (needs_culling && has_active_effects (child))
-        needs_culling = FALSE;
+      if (needs_culling)
+        {
+          has_effects = has_active_effects (child, &shape_preserving);
+          if (has_effects && !shape_preserving)
+            needs_culling = FALSE;
+        }
 
       if (needs_culling)
         {
           g_autoptr (MtkRegion) actor_region = NULL;
           g_autoptr (MtkRegion) reduced_region = NULL;
-          graphene_matrix_t actor_transform, inverted_actor_transform;
+          graphene_matrix_t actor_transform;
+          graphene_matrix_t planar_transform, inverted_planar_transform;
 
           clutter_actor_get_transform (child, &actor_transform);
 
@@ -130,32 +142,45 @@ cull_out_children_common (MetaCullable    *cullable,
             {
               /* No transformation needed, simply pass through to child */
               method (META_CULLABLE (child), region);
-              continue;
             }
-
-          if (!graphene_matrix_inverse (&actor_transform,
-                                        &inverted_actor_transform) ||
-              !graphene_matrix_is_2d (&actor_transform))
+          else if (meta_matrix_get_planar_transform (&actor_transform,
+                                                     &planar_transform) &&
+                   graphene_matrix_inverse (&planar_transform,
+                                            &inverted_planar_transform))
             {
-              method (META_CULLABLE (child), NULL);
-              continue;
-            }
+              actor_region =
+                region_apply_transform_expand_maybe_ref (region,
+                                                         &inverted_planar_transform);
 
-          actor_region =
-            region_apply_transform_expand_maybe_ref (region,
-                                                     &inverted_actor_transform);
+              g_assert (actor_region);
 
-          g_assert (actor_region);
+              method (META_CULLABLE (child), actor_region);
 
-          method (META_CULLABLE (child), actor_region);
+              reduced_region =
+                region_apply_transform_expand_maybe_ref (actor_region,
+                                                         &planar_transform);
 
-          reduced_region =
-            region_apply_transform_expand_maybe_ref (actor_region,
-                                                     &actor_transform);
+              g_assert (reduced_region);
 
-          g_assert (reduced_region);
+              mtk_region_intersect (region, reduced_region);
+            }
+          else
+            {
+              method (META_CULLABLE (child), NULL);
+              continue;
+            }
 
-          mtk_region_intersect (region, reduced_region);
+          /* ClutterOffscreenEffect and friends cache what the actor painted
+           * and reuse it when only what's above the actor changed, so the
+           * actor must paint all of itself, even though what it obscures
+           * can still be culled out.
+           *
+           * This also avoids clipped redraws interfering with the caching
+           * of the FBO, which may use other portions of it in later
+           * frames.
+           */
+          if (has_effects && clips_painting)
+            method (META_CULLABLE (child), NULL);
         }
       else
         {
@@ -180,7 +205,8 @@ meta_cullable_cull_unobscured_children (MetaCullable *cullable,
 {
   cull_out_children_common (cullable,
                             unobscured_region,
-                            meta_cullable_cull_unobscured);
+                            meta_cullable_cull_unobscured,
+                            FALSE);
 }
 
 /**
@@ -199,7 +225,8 @@ meta_cullable_cull_redraw_clip_children (MetaCullable *cullable,
 {
   cull_out_children_common (cullable,
                             clip_region,
-                            meta_cullable_cull_redraw_clip);
+                            meta_cullable_cull_redraw_clip,
+                            TRUE);
 }
 
 static void
@@ -29,10 +29,12 @@
 typedef struct _MetaLater
 {
   MetaLaters *laters;
+  GList link;
 
   unsigned int id;
   unsigned int ref_count;
   MetaLaterType when;
+  MetaLaterFlags flags;
 
   GSourceFunc func;
   gpointer user_data;
@@ -52,7 +54,11 @@ struct _MetaLaters
 
   unsigned int last_later_id;
 
-  GSList *laters[META_LATER_N_TYPES];
+  /* Most recently added first */
+  GQueue laters[META_LATER_N_TYPES];
+  GHashTable *laters_by_id;
+
+  int64_t frame_budget_us;
 
   gulong before_update_handler_id;
 };
@@ -117,56 +123,94 @@ static gboolean
 meta_later_invoke (MetaLater *later)
 {
   COGL_TRACE_BEGIN_SCOPED (later, "Meta::Later::invoke()");
-  COGL_TRACE_DESCRIBE (later, later_type_to_string (later->when));
+
+#ifdef HAVE_PROFILER
+  if (G_UNLIKELY (cogl_is_tracing_enabled ()))
+    {
+      g_autofree char *description = NULL;
+
+      /* The callback address can be resolved to a symbol, telling which
+       * later it is that is expensive */
+      description = g_strdup_printf ("%s, id %u, callback %p",
+                                     later_type_to_string (later->when),
+                                     later->id,
+                                     later->func);
+      COGL_TRACE_DESCRIBE (later, description);
+    }
+#endif
 
   return later->func (later->user_data);
 }
 
 static gboolean
-remove_later_from_list (unsigned int   later_id,
-                        GSList       **laters_list)
+remove_later (MetaLaters   *laters,
+              unsigned int  later_id)
 {
-  GSList *l;
+  MetaLater *later;
 
-  for (l = *laters_list; l; l = l->next)
-    {
-      MetaLater *later = l->data;
+  later = g_hash_table_lookup (laters->laters_by_id,
+                               GUINT_TO_POINTER (later_id));
+  if (!later)
+    return FALSE;
 
-      if (later->id == later_id)
-        {
-          *laters_list = g_slist_delete_link (*laters_list, l);
-          meta_later_destroy (later);
-          return TRUE;
-        }
-    }
+  g_hash_table_remove (laters->laters_by_id, GUINT_TO_POINTER (later_id));
+  g_queue_unlink (&laters->laters[later->when], &later->link);
+  meta_later_destroy (later);
+
+  return TRUE;
+}
+
+static gboolean
+is_over_budget (MetaLaters *laters,
+                int64_t     start_time_us)
+{
+  if (laters->frame_budget_us <= 0)
+    return FALSE;
 
-  return FALSE;
+  return g_get_monotonic_time () - start_time_us > laters->frame_budget_us;
 }
 
 static void
-run_repaint_laters (GSList **laters_list)
+run_repaint_laters (MetaLaters *laters,
+                    GQueue     *laters_queue,
+                    int64_t     start_time_us)
 {
-  g_autoptr (GSList) laters_copy = NULL;
-  GSList *l;
+  g_autoptr (GPtrArray) laters_copy = NULL;
+  GList *l;
+  unsigned int i;
 
-  for (l = *laters_list; l; l = l->next)
+  laters_copy = g_ptr_array_new ();
+
+  for (l = laters_queue->head; l; l = l->next)
     {
       MetaLater *later = l->data;
 
       if (!later->source_id ||
           (later->when <= META_LATER_BEFORE_REDRAW && !later->run_once))
-        laters_copy = g_slist_prepend (laters_copy, meta_later_ref (later));
+        g_ptr_array_add (laters_copy, meta_later_ref (later));
     }
-  laters_copy = g_slist_reverse (laters_copy);
 
-  for (l = laters_copy; l; l = l->next)
+  for (i = 0; i < laters_copy->len; i++)
     {
-      MetaLater *later = l->data;
+      MetaLater *later = g_ptr_array_index (laters_copy, i);
 
       if (!later->func)
-        remove_later_from_list (later->id, laters_list);
+        {
+          remove_later (laters, later->id);
+        }
+      else if (later->flags & META_LATER_FLAG_DEFERRABLE &&
+               is_over_budget (laters, start_time_us))
+        {
+          /* Spills over to the next frame */
+          COGL_TRACE_MESSAGE ("Meta::Later::deferred()",
+                              "Deferred %s later %u",
+                              later_type_to_string (later->when),
+                              later->id);
+        }
       else if (!meta_later_invoke (later))
-        remove_later_from_list (later->id, laters_list);
+        {
+          remove_later (laters, later->id);
+        }
 
       meta_later_unref (later);
     }
@@ -178,16 +222,19 @@ on_before_update (ClutterStage     *stage,
                   ClutterFrame     *frame,
                   MetaLaters       *laters)
 {
+  int64_t start_time_us;
   unsigned int i;
-  GSList *l;
+  GList *l;
   gboolean needs_schedule_update = FALSE;
 
+  start_time_us = g_get_monotonic_time ();
+
   for (i = 0; i < G_N_ELEMENTS (laters->laters); i++)
-    run_repaint_laters (&laters->laters[i]);
+    run_repaint_laters (laters, &laters->laters[i], start_time_us);
 
   for (i = 0; i < G_N_ELEMENTS (laters->laters); i++)
     {
-      for (l = laters->laters[i]; l; l = l->next)
+      for (l = laters->laters[i].head; l; l = l->next)
         {
           MetaLater *later = l->data;
 
@@ -226,7 +273,16 @@ meta_laters_finalize (GObject *object)
   unsigned int i;
 
   for (i = 0; i < G_N_ELEMENTS (laters->laters); i++)
-    g_slist_free_full (laters->laters[i], (GDestroyNotify) meta_later_unref);
+    {
+      MetaLater *later;
+
+      while ((later = g_queue_peek_head (&laters->laters[i])))
+        {
+          g_queue_unlink (&laters->laters[i], &later->link);
+          meta_later_unref (later);
+        }
+    }
+  g_clear_pointer (&laters->laters_by_id, g_hash_table_unref);
 
   g_clear_signal_handler (&laters->before_update_handler_id, stage);
 
@@ -244,6 +300,11 @@ meta_laters_class_init (MetaLatersClass *klass)
 static void
 meta_laters_init (MetaLaters *laters)
 {
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (laters->laters); i++)
+    g_queue_init (&laters->laters[i]);
+  laters->laters_by_id = g_hash_table_new (NULL, NULL);
 }
 
 /**
@@ -270,19 +331,52 @@ meta_laters_add (MetaLaters     *laters,
                  GSourceFunc     func,
                  gpointer        user_data,
                  GDestroyNotify  notify)
+{
+  return meta_laters_add_full (laters, when, META_LATER_FLAG_NONE,
+                               func, user_data, notify);
+}
+
+/**
+ * meta_laters_add_full:
+ * @laters: a #MetaLaters
+ * @when: enumeration value determining the phase at which to run the callback
+ * @flags: flags affecting when the callback may run
+ * @func: callback to run later
+ * @user_data: data to pass to the callback
+ * @notify: function to call to destroy @data when it is no longer in use, or %NULL
+ *
+ * Like meta_laters_add(), but with @flags. A later added with
+ * %META_LATER_FLAG_DEFERRABLE is postponed to the next frame, instead of
+ * being run before the redraw, when the frame budget set with
+ * meta_laters_set_frame_budget() has already been spent by other laters.
+ *
+ * Return value: an integer ID (guaranteed to be non-zero) that can be used
+ *  to cancel the callback and prevent it from being run.
+ */
+unsigned int
+meta_laters_add_full (MetaLaters     *laters,
+                      MetaLaterType   when,
+                      MetaLaterFlags  flags,
+                      GSourceFunc     func,
+                      gpointer        user_data,
+                      GDestroyNotify  notify)
 {
   ClutterStage *stage = meta_compositor_get_stage (laters->compositor);
   MetaLater *later = g_new0 (MetaLater, 1);
 
   later->id = ++laters->last_later_id;
   later->laters = laters;
+  later->link.data = later;
   later->ref_count = 1;
   later->when = when;
+  later->flags = flags;
   later->func = func;
   later->user_data = user_data;
   later->destroy_notify = notify;
 
-  laters->laters[when] = g_slist_prepend (laters->laters[when], later);
+  g_queue_push_head_link (&laters->laters[when], &later->link);
+  g_hash_table_insert (laters->laters_by_id,
+                       GUINT_TO_POINTER (later->id), later);
 
   switch (when)
     {
@@ -321,13 +415,23 @@ void
 meta_laters_remove (MetaLaters   *laters,
                     unsigned int  later_id)
 {
-  unsigned int i;
+  remove_later (laters, later_id);
+}
 
-  for (i = 0; i < G_N_ELEMENTS (laters->laters); i++)
-    {
-      if (remove_later_from_list (later_id, &laters->laters[i]))
-        return;
-    }
+/**
+ * meta_laters_set_frame_budget:
+ * @laters: a #MetaLaters
+ * @budget_us: time in microseconds, or 0 for no budget
+ *
+ * Sets how much time laters may take before a redraw, before the ones
+ * added with %META_LATER_FLAG_DEFERRABLE are postponed to the next frame.
+ * Other laters always run.
+ */
+void
+meta_laters_set_frame_budget (MetaLaters *laters,
+                              int64_t     budget_us)
+{
+  laters->frame_budget_us = budget_us;
 }
 
 MetaLaters *
@@ -43,4 +43,9 @@ gboolean meta_multi_texture_format_get_snippets (MetaMultiTextureFormat   format
                                                  CoglSnippet            **fragment_globals_snippet,
                                                  CoglSnippet            **fragment_snippet);
 
+gboolean meta_multi_texture_format_get_plane_snippets (MetaMultiTextureFormat   format,
+                                                       int                      plane,
+                                                       CoglSnippet            **fragment_globals_snippet,
+                                                       CoglSnippet            **fragment_snippet);
+
 G_END_DECLS
@@ -40,6 +40,18 @@ static const char *shader_global_conversions =
   "  return res;                                                            \n"
   "}                                                                        \n";
 
+static const char *shader_global_plane_conversions =
+  "vec4 rgb_to_yuv(vec4 rgba)                                               \n"
+  "{                                                                        \n"
+  "  vec4 res;                                                              \n"
+  "  float Y = 0.299 * rgba.r + 0.587 * rgba.g + 0.114 * rgba.b;            \n"
+  "  res.x = 16.0/255.0 + 219.0/255.0 * Y;                                  \n"
+  "  res.y = 128.0/255.0 + 224.0/255.0 * 0.56433408 * (rgba.b - Y);         \n"
+  "  res.z = 128.0/255.0 + 224.0/255.0 * 0.71326676 * (rgba.r - Y);         \n"
+  "  res.w = rgba.a;                                                        \n"
+  "  return res;                                                            \n"
+  "}                                                                        \n";
+
 static const char rgba_shader[] =
   "cogl_color_out =                                                         \n"
   "  texture2D(cogl_sampler0, cogl_tex_coord0_in.st) * cogl_color_in.a;     \n";
@@ -66,6 +78,24 @@ static const char y_u_v_shader[] =
   "yuva.z = texture2D(cogl_sampler2, cogl_tex_coord0_in.st).x;              \n"
   "cogl_color_out = yuv_to_rgb(yuva);                                       \n";
 
+/* Shaders writing a single plane from RGB, sampling in the middle of the
+ * subsampled pixels blends the covered RGB pixels together */
+static const char y_plane_shader[] =
+  "vec4 yuva = rgb_to_yuv(texture2D(cogl_sampler0, cogl_tex_coord0_in.st)); \n"
+  "cogl_color_out = vec4(yuva.x, 0.0, 0.0, 1.0);                            \n";
+
+static const char uv_plane_shader[] =
+  "vec4 yuva = rgb_to_yuv(texture2D(cogl_sampler0, cogl_tex_coord0_in.st)); \n"
+  "cogl_color_out = vec4(yuva.y, yuva.z, 0.0, 1.0);                         \n";
+
+static const char u_plane_shader[] =
+  "vec4 yuva = rgb_to_yuv(texture2D(cogl_sampler0, cogl_tex_coord0_in.st)); \n"
+  "cogl_color_out = vec4(yuva.y, 0.0, 0.0, 1.0);                            \n";
+
+static const char v_plane_shader[] =
+  "vec4 yuva = rgb_to_yuv(texture2D(cogl_sampler0, cogl_tex_coord0_in.st)); \n"
+  "cogl_color_out = vec4(yuva.z, 0.0, 0.0, 1.0);                            \n";
+
 typedef struct _MetaMultiTextureFormatFullInfo
 {
   MetaMultiTextureFormatInfo info;
@@ -76,6 +106,10 @@ typedef struct _MetaMultiTextureFormatFullInfo
   const char *rgb_shader;
   /* Cached snippet */
   GOnce snippet_once;
+  /* Shaders to convert from RGBA to each plane (or NULL) */
+  const char *plane_shaders[COGL_PIXEL_FORMAT_MAX_PLANES];
+  /* Cached plane snippets */
+  GOnce plane_snippet_once[COGL_PIXEL_FORMAT_MAX_PLANES];
 } MetaMultiTextureFormatFullInfo;
 
 /* NOTE: The actual enum values are used as the index, so you don't need to
@@ -114,6 +148,7 @@ static MetaMultiTextureFormatFullInfo multi_format_table[] = {
     .name = "NV12",
     .rgb_shader = y_uv_shader,
     .snippet_once = G_ONCE_INIT,
+    .plane_shaders = { y_plane_shader, uv_plane_shader },
     .info = {
       .n_planes = 2,
       .subformats = { COGL_PIXEL_FORMAT_R_8, COGL_PIXEL_FORMAT_RG_88 },
@@ -126,6 +161,7 @@ static MetaMultiTextureFormatFullInfo multi_format_table[] = {
     .name = "P010",
     .rgb_shader = y_uv_shader,
     .snippet_once = G_ONCE_INIT,
+    .plane_shaders = { y_plane_shader, uv_plane_shader },
     .info = {
       .n_planes = 2,
       .subformats = { COGL_PIXEL_FORMAT_R_16, COGL_PIXEL_FORMAT_RG_1616 },
@@ -139,6 +175,7 @@ static MetaMultiTextureFormatFullInfo multi_format_table[] = {
     .name = "YUV420",
     .rgb_shader = y_u_v_shader,
     .snippet_once = G_ONCE_INIT,
+    .plane_shaders = { y_plane_shader, u_plane_shader, v_plane_shader },
     .info = {
       .n_planes = 3,
       .subformats = { COGL_PIXEL_FORMAT_R_8, COGL_PIXEL_FORMAT_R_8, COGL_PIXEL_FORMAT_R_8 },
@@ -215,3 +252,66 @@ meta_multi_texture_format_get_snippets (MetaMultiTextureFormat   format,
 
   return TRUE;
 }
+
+static gpointer
+create_plane_globals_snippet (gpointer data)
+{
+  return cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT_GLOBALS,
+                           shader_global_plane_conversions,
+                           NULL);
+}
+
+static gpointer
+create_plane_snippet (gpointer data)
+{
+  int index = GPOINTER_TO_INT (data);
+  MetaMultiTextureFormat format = index / COGL_PIXEL_FORMAT_MAX_PLANES;
+  int plane = index % COGL_PIXEL_FORMAT_MAX_PLANES;
+
+  return cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                           NULL,
+                           multi_format_table[format].plane_shaders[plane]);
+}
+
+/* Returns the snippets that output the contents of @plane of @format when
+ * used to paint the RGB texture bound to the first layer */
+gboolean
+meta_multi_texture_format_get_plane_snippets (MetaMultiTextureFormat   format,
+                                              int                      plane,
+                                              CoglSnippet            **fragment_globals_snippet,
+                                              CoglSnippet            **fragment_snippet)
+{
+  MetaMultiTextureFormatFullInfo *full_info;
+
+  g_return_val_if_fail (format < G_N_ELEMENTS (multi_format_table), FALSE);
+  g_return_val_if_fail (plane >= 0 && plane < COGL_PIXEL_FORMAT_MAX_PLANES,
+                        FALSE);
+
+  full_info = &multi_format_table[format];
+  if (full_info->plane_shaders[plane] == NULL)
+    return FALSE;
+
+  if (fragment_globals_snippet)
+    {
+      static GOnce globals_once = G_ONCE_INIT;
+      CoglSnippet *globals_snippet;
+
+      globals_snippet = g_once (&globals_once,
+                                create_plane_globals_snippet,
+                                NULL);
+      *fragment_globals_snippet = g_object_ref (globals_snippet);
+    }
+
+  if (fragment_snippet)
+    {
+      CoglSnippet *plane_snippet;
+      int index = format * COGL_PIXEL_FORMAT_MAX_PLANES + plane;
+
+      plane_snippet = g_once (&full_info->plane_snippet_once[plane],
+                              create_plane_snippet,
+                              GINT_TO_POINTER (index));
+      *fragment_snippet = g_object_ref (plane_snippet);
+    }
+
+  return TRUE;
+}
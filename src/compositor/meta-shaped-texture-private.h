@@ -73,3 +73,10 @@ void meta_shaped_texture_set_opaque_region (MetaShapedTexture *stex,
 void meta_shaped_texture_ensure_size_valid (MetaShapedTexture *stex);
 
 gboolean meta_shaped_texture_should_get_via_offscreen (MetaShapedTexture *stex);
+
+CoglTexture * meta_shaped_texture_get_passthrough_texture (MetaShapedTexture *stex,
+                                                           ClutterColorState *target_color_state);
+
+void meta_shaped_texture_prewarm_pipelines (ClutterContext      *clutter_context,
+                                            ClutterColorState   *color_state,
+                                            ClutterPaintContext *paint_context);
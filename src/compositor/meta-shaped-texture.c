@@ -355,6 +355,39 @@ cogl_context_from_paint_context (ClutterPaintContext *paint_context)
   return cogl_framebuffer_get_context (framebuffer);
 }
 
+/* All base pipelines are copies of a template per number of planes, so
+ * that windows ending up with the same snippets and color transform share
+ * pipeline ancestry, which lets Cogl find the shader state more quickly
+ * than by going through its program cache. */
+static CoglPipeline *
+get_template_pipeline (CoglContext *cogl_context,
+                       int          n_planes)
+{
+  static CoglPipeline *templates[COGL_PIXEL_FORMAT_MAX_PLANES + 1];
+  CoglPipeline **templatep;
+  int i;
+
+  g_assert (n_planes > 0 && n_planes < G_N_ELEMENTS (templates));
+
+  templatep = &templates[n_planes];
+  if (*templatep)
+    return *templatep;
+
+  *templatep = cogl_pipeline_new (cogl_context);
+
+  /* We'll add as many layers as there are planes in the multi texture,
+   * plus an extra one for the mask */
+  for (i = 0; i < (n_planes + 1); i++)
+    {
+      cogl_pipeline_set_layer_wrap_mode_s (*templatep, i,
+                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      cogl_pipeline_set_layer_wrap_mode_t (*templatep, i,
+                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+    }
+
+  return *templatep;
+}
+
 static CoglPipeline *
 get_base_pipeline (MetaShapedTexture   *stex,
                    ClutterPaintContext *paint_context)
@@ -368,18 +401,8 @@ get_base_pipeline (MetaShapedTexture   *stex,
   if (stex->base_pipeline)
     return stex->base_pipeline;
 
-  pipeline = cogl_pipeline_new (cogl_context);
-
-  /* We'll add as many layers as there are planes in the multi texture,
-   * plus an extra one for the mask */
   n_planes = meta_multi_texture_get_n_planes (stex->texture);
-  for (i = 0; i < (n_planes + 1); i++)
-    {
-      cogl_pipeline_set_layer_wrap_mode_s (pipeline, i,
-                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
-      cogl_pipeline_set_layer_wrap_mode_t (pipeline, i,
-                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
-    }
+  pipeline = cogl_pipeline_copy (get_template_pipeline (cogl_context, n_planes));
 
   graphene_matrix_init_identity (&matrix);
 
@@ -1291,7 +1314,7 @@ meta_shaped_texture_update_area (MetaShapedTexture  *stex,
                                     clip);
     }
 
-  meta_texture_mipmap_invalidate (stex->texture_mipmap);
+  meta_texture_mipmap_invalidate_area (stex->texture_mipmap, area);
 
   return TRUE;
 }
@@ -1595,6 +1618,42 @@ meta_shaped_texture_should_get_via_offscreen (MetaShapedTexture *stex)
   return FALSE;
 }
 
+/*
+ * Returns the texture of the buffer if painting the shaped texture into a
+ * framebuffer with the target color state would produce the very same
+ * pixels, i.e. when it can be copied as is instead of being painted.
+ */
+CoglTexture *
+meta_shaped_texture_get_passthrough_texture (MetaShapedTexture *stex,
+                                             ClutterColorState *target_color_state)
+{
+  if (!stex->texture)
+    return NULL;
+
+  if (stex->mask_texture || stex->snippet)
+    return NULL;
+
+  if (!meta_multi_texture_is_simple (stex->texture))
+    return NULL;
+
+  if (!stex->is_y_inverted)
+    return NULL;
+
+  if (stex->has_viewport_src_rect || stex->has_viewport_dst_size)
+    return NULL;
+
+  if (stex->transform != MTK_MONITOR_TRANSFORM_NORMAL)
+    return NULL;
+
+  if (!meta_shaped_texture_is_opaque (stex))
+    return NULL;
+
+  if (!clutter_color_state_equals (stex->color_state, target_color_state))
+    return NULL;
+
+  return meta_multi_texture_get_plane (stex->texture, 0);
+}
+
 /**
  * meta_shaped_texture_get_image:
  * @stex: A #MetaShapedTexture
@@ -1826,3 +1885,67 @@ meta_shaped_texture_get_unscaled_height (MetaShapedTexture *stex)
 
   return unscaled_size.height;
 }
+
+static void
+prewarm_pipeline (CoglFramebuffer  *framebuffer,
+                  CoglPipeline     *pipeline,
+                  MetaMultiTexture *texture,
+                  CoglTexture      *mask_texture)
+{
+  int i, n_planes;
+
+  n_planes = meta_multi_texture_get_n_planes (texture);
+  for (i = 0; i < n_planes; i++)
+    {
+      cogl_pipeline_set_layer_texture (pipeline, i,
+                                       meta_multi_texture_get_plane (texture, i));
+    }
+
+  if (mask_texture)
+    cogl_pipeline_set_layer_texture (pipeline, n_planes, mask_texture);
+
+  cogl_framebuffer_draw_rectangle (framebuffer, pipeline, 0, 0, 1, 1);
+}
+
+/*
+ * Draws with the unblended, unmasked and masked pipelines a typical single
+ * plane surface in @color_state would use when painted with @paint_context,
+ * so that their GLSL programs are already built when the first window is
+ * painted.
+ */
+void
+meta_shaped_texture_prewarm_pipelines (ClutterContext      *clutter_context,
+                                       ClutterColorState   *color_state,
+                                       ClutterPaintContext *paint_context)
+{
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (MetaShapedTexture) stex = NULL;
+  g_autoptr (MetaMultiTexture) texture = NULL;
+  g_autoptr (CoglTexture) plane = NULL;
+  g_autoptr (CoglPipeline) pipeline = NULL;
+
+  plane = cogl_texture_2d_new_with_size (cogl_context, 1, 1);
+  if (!cogl_texture_allocate (plane, NULL))
+    return;
+
+  texture = meta_multi_texture_new_simple (g_object_ref (plane));
+
+  stex = meta_shaped_texture_new (clutter_context, color_state);
+  meta_shaped_texture_set_texture (stex, texture);
+
+  pipeline = get_unblended_pipeline (stex, paint_context, texture);
+  prewarm_pipeline (framebuffer, pipeline, texture, NULL);
+  g_clear_object (&pipeline);
+
+  pipeline = get_unmasked_pipeline (stex, paint_context, texture);
+  prewarm_pipeline (framebuffer, pipeline, texture, NULL);
+  g_clear_object (&pipeline);
+
+  pipeline = get_masked_pipeline (stex, paint_context, texture);
+  prewarm_pipeline (framebuffer, pipeline, texture, plane);
+  g_clear_object (&pipeline);
+
+  cogl_framebuffer_flush (framebuffer);
+}
@@ -28,6 +28,7 @@
 #include <X11/extensions/Xcomposite.h>
 
 #include "cogl/winsys/cogl-texture-pixmap-x11.h"
+#include "compositor/compositor-private.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-window-actor-private.h"
@@ -36,6 +37,10 @@
 #include "x11/meta-x11-display-private.h"
 #include "x11/window-x11.h"
 
+/* Past this many rectangles, updating the bounding box of the pending
+ * damage is cheaper than tracking each of them */
+#define MAX_PENDING_DAMAGE_RECTS 16
+
 struct _MetaSurfaceActorX11
 {
   MetaSurfaceActor parent;
@@ -48,6 +53,10 @@ struct _MetaSurfaceActorX11
   Pixmap pixmap;
   Damage damage;
 
+  /* Damage received since the last stage update */
+  MtkRegion *pending_damage;
+  gulong before_update_handler_id;
+
   int last_width;
   int last_height;
 
@@ -192,12 +201,93 @@ meta_surface_actor_x11_is_visible (MetaSurfaceActorX11 *self)
   return (self->pixmap != None) && !self->unredirected;
 }
 
+static ClutterStage *
+get_stage (MetaSurfaceActorX11 *self)
+{
+  return meta_compositor_get_stage (self->display->compositor);
+}
+
+static void
+flush_damage (MetaSurfaceActorX11 *self)
+{
+  MetaSurfaceActor *actor = META_SURFACE_ACTOR (self);
+  g_autoptr (MtkRegion) damage = NULL;
+  CoglTexturePixmapX11 *pixmap;
+  MtkRectangle extents;
+  int i, n_rects;
+
+  g_clear_signal_handler (&self->before_update_handler_id, get_stage (self));
+
+  damage = g_steal_pointer (&self->pending_damage);
+  if (!damage)
+    return;
+
+  if (!meta_surface_actor_x11_is_visible (self))
+    return;
+
+  /* We don't support multi-plane or YUV based formats in X */
+  if (!meta_multi_texture_is_simple (self->texture))
+    return;
+
+  extents = mtk_region_get_extents (damage);
+  pixmap = COGL_TEXTURE_PIXMAP_X11 (meta_multi_texture_get_plane (self->texture, 0));
+  cogl_texture_pixmap_x11_update_area (pixmap, &extents);
+
+  n_rects = mtk_region_num_rectangles (damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (damage, i);
+
+      meta_surface_actor_update_area (actor, &rect);
+    }
+}
+
+static void
+on_before_update (ClutterStage        *stage,
+                  ClutterStageView    *stage_view,
+                  ClutterFrame        *frame,
+                  MetaSurfaceActorX11 *self)
+{
+  flush_damage (self);
+}
+
+static void
+queue_damage (MetaSurfaceActorX11 *self,
+              const MtkRectangle  *area)
+{
+  ClutterStage *stage;
+
+  if (!self->pending_damage)
+    self->pending_damage = mtk_region_create_rectangle (area);
+  else
+    mtk_region_union_rectangle (self->pending_damage, area);
+
+  if (mtk_region_num_rectangles (self->pending_damage) > MAX_PENDING_DAMAGE_RECTS)
+    {
+      MtkRectangle extents = mtk_region_get_extents (self->pending_damage);
+
+      g_clear_pointer (&self->pending_damage, mtk_region_unref);
+      self->pending_damage = mtk_region_create_rectangle (&extents);
+    }
+
+  if (self->before_update_handler_id)
+    return;
+
+  /* Apply the damage once right before the next stage update, so that
+   * clients sending lots of small damage only cause one texture update
+   * and set of redraw clips per frame */
+  stage = get_stage (self);
+  self->before_update_handler_id =
+    g_signal_connect (stage, "before-update",
+                      G_CALLBACK (on_before_update), self);
+  clutter_stage_schedule_update (stage);
+}
+
 static void
 meta_surface_actor_x11_process_damage (MetaSurfaceActor   *actor,
                                        const MtkRectangle *area)
 {
   MetaSurfaceActorX11 *self = META_SURFACE_ACTOR_X11 (actor);
-  CoglTexturePixmapX11 *pixmap;
 
   self->received_damage = TRUE;
 
@@ -218,16 +308,7 @@ meta_surface_actor_x11_process_damage (MetaSurfaceActor   *actor,
         self->does_full_damage = TRUE;
     }
 
-  if (!meta_surface_actor_x11_is_visible (self))
-    return;
-
-  /* We don't support multi-plane or YUV based formats in X */
-  if (!meta_multi_texture_is_simple (self->texture))
-    return;
-
-  pixmap = COGL_TEXTURE_PIXMAP_X11 (meta_multi_texture_get_plane (self->texture, 0));
-  cogl_texture_pixmap_x11_update_area (pixmap, area);
-  meta_surface_actor_update_area (actor, area);
+  queue_damage (self, area);
 }
 
 void
@@ -320,6 +401,9 @@ release_x11_resources (MetaSurfaceActorX11 *self)
 {
   MetaX11Display *x11_display = meta_display_get_x11_display (self->display);
 
+  g_clear_signal_handler (&self->before_update_handler_id, get_stage (self));
+  g_clear_pointer (&self->pending_damage, mtk_region_unref);
+
   mtk_x11_error_trap_push (x11_display->xdisplay);
   detach_pixmap (self);
   free_damage (self);
@@ -20,6 +20,7 @@
 #include "compositor/meta-surface-actor.h"
 
 #include "clutter/clutter.h"
+#include "clutter/clutter-mutter.h"
 #include "compositor/clutter-utils.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-shaped-texture-private.h"
@@ -599,6 +600,8 @@ meta_surface_actor_set_input_region (MetaSurfaceActor *self,
     priv->input_region = mtk_region_ref (region);
   else
     priv->input_region = NULL;
+
+  clutter_actor_invalidate_pick (CLUTTER_ACTOR (self));
 }
 
 void
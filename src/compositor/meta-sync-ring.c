@@ -32,7 +32,11 @@
 
 #include "compositor/meta-sync-ring.h"
 
+#include <errno.h>
+#include <glib-unix.h>
+#include <poll.h>
 #include <string.h>
+#include <unistd.h>
 #include <GL/gl.h>
 #include <GL/glx.h>
 #include <X11/extensions/sync.h>
@@ -54,6 +58,11 @@
  *
  * glClientWaitSync() and XAlarms are used in steps 2 and 4,
  * respectively, to double-check the expectections.
+ *
+ * When sync fds are available, the completion in step 2 is tracked by
+ * polling a sync fd from the main loop instead of querying a GL fence
+ * every frame, so in the common case the fence is already known to be
+ * done by the time it's due to be reset.
  */
 
 #define NUM_SYNCS 10
@@ -76,6 +85,9 @@ typedef struct
   GLsync gl_x11_sync;
   GLsync gpu_fence;
 
+  int gpu_fence_fd;
+  guint gpu_fence_fd_source_id;
+
   XSyncCounter xcounter;
   XSyncAlarm xalarm;
   XSyncValue next_counter_value;
@@ -89,6 +101,8 @@ typedef struct
   int xsync_event_base;
   int xsync_error_base;
 
+  gboolean use_sync_fds;
+
   GHashTable *alarm_to_sync;
 
   MetaSync *syncs_array[NUM_SYNCS];
@@ -226,7 +240,40 @@ load_required_symbols (CoglContext *ctx)
 }
 
 static void
-meta_sync_insert (MetaSync *self)
+meta_sync_clear_gpu_fence (MetaSync *self)
+{
+  if (self->gpu_fence_fd >= 0)
+    {
+      g_clear_handle_id (&self->gpu_fence_fd_source_id, g_source_remove);
+      g_clear_fd (&self->gpu_fence_fd, NULL);
+    }
+  else if (self->gpu_fence)
+    {
+      meta_gl_delete_sync (self->gpu_fence);
+      self->gpu_fence = 0;
+    }
+}
+
+static gboolean
+on_gpu_fence_fd_ready (int          fd,
+                       GIOCondition condition,
+                       gpointer     user_data)
+{
+  MetaSync *self = user_data;
+
+  g_warn_if_fail (self->state == META_SYNC_STATE_WAITING);
+
+  self->gpu_fence_fd_source_id = 0;
+  g_clear_fd (&self->gpu_fence_fd, NULL);
+  self->state = META_SYNC_STATE_DONE;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+meta_sync_insert (MetaSync    *self,
+                  CoglContext *cogl_context,
+                  gboolean     use_sync_fd)
 {
   g_return_if_fail (self->state == META_SYNC_STATE_READY);
 
@@ -234,11 +281,50 @@ meta_sync_insert (MetaSync *self)
   XFlush (self->xdisplay);
 
   meta_gl_wait_sync (self->gl_x11_sync, 0, GL_TIMEOUT_IGNORED);
-  self->gpu_fence = meta_gl_fence_sync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  if (use_sync_fd)
+    self->gpu_fence_fd = cogl_context_create_sync_fd (cogl_context);
+
+  if (self->gpu_fence_fd >= 0)
+    {
+      self->gpu_fence_fd_source_id = g_unix_fd_add (self->gpu_fence_fd,
+                                                    G_IO_IN,
+                                                    on_gpu_fence_fd_ready,
+                                                    self);
+    }
+  else
+    {
+      self->gpu_fence = meta_gl_fence_sync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
 
   self->state = META_SYNC_STATE_WAITING;
 }
 
+static GLenum
+meta_sync_poll_gpu_fence_fd (MetaSync *self,
+                             GLuint64  timeout)
+{
+  struct pollfd pollfd = {
+    .fd = self->gpu_fence_fd,
+    .events = POLLIN,
+  };
+  int timeout_ms;
+  int ret;
+
+  timeout_ms = (int) (timeout / (1000 * 1000));
+
+  do
+    ret = poll (&pollfd, 1, timeout_ms);
+  while (ret == -1 && errno == EINTR);
+
+  if (ret < 0)
+    return GL_WAIT_FAILED;
+  else if (ret == 0)
+    return GL_TIMEOUT_EXPIRED;
+  else
+    return GL_CONDITION_SATISFIED;
+}
+
 static GLenum
 meta_sync_check_update_finished (MetaSync *self,
                                  GLuint64  timeout)
@@ -251,12 +337,17 @@ meta_sync_check_update_finished (MetaSync *self,
       status = GL_ALREADY_SIGNALED;
       break;
     case META_SYNC_STATE_WAITING:
-      status = meta_gl_client_wait_sync (self->gpu_fence, 0, timeout);
+      /* With a sync fd this is only reached if the main loop hasn't
+       * dispatched its source yet */
+      if (self->gpu_fence_fd >= 0)
+        status = meta_sync_poll_gpu_fence_fd (self, timeout);
+      else
+        status = meta_gl_client_wait_sync (self->gpu_fence, 0, timeout);
+
       if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
         {
           self->state = META_SYNC_STATE_DONE;
-          meta_gl_delete_sync (self->gpu_fence);
-          self->gpu_fence = 0;
+          meta_sync_clear_gpu_fence (self);
         }
       break;
     default:
@@ -314,6 +405,7 @@ meta_sync_new (Display *xdisplay)
   self->xfence = XSyncCreateFence (xdisplay, DefaultRootWindow (xdisplay), FALSE);
   self->gl_x11_sync = 0;
   self->gpu_fence = 0;
+  self->gpu_fence_fd = -1;
 
   self->xcounter = XSyncCreateCounter (xdisplay, SYNC_VALUE_ZERO);
 
@@ -373,7 +465,7 @@ meta_sync_free (MetaSync *self)
   switch (self->state)
     {
     case META_SYNC_STATE_WAITING:
-      meta_gl_delete_sync (self->gpu_fence);
+      meta_sync_clear_gpu_fence (self);
       break;
     case META_SYNC_STATE_DONE:
       /* nothing to do */
@@ -426,6 +518,7 @@ meta_sync_ring_init (CoglContext *ctx,
   XSyncIntToValue (&SYNC_VALUE_ONE, 1);
 
   ring->xdisplay = xdisplay;
+  ring->use_sync_fds = cogl_context_has_feature (ctx, COGL_FEATURE_ID_SYNC_FD);
 
   ring->alarm_to_sync = g_hash_table_new (NULL, NULL);
 
@@ -472,6 +565,7 @@ meta_sync_ring_destroy (void)
   ring->xsync_event_base = 0;
   ring->xsync_error_base = 0;
   ring->xdisplay = NULL;
+  ring->use_sync_fds = FALSE;
 }
 
 static gboolean
@@ -554,8 +648,7 @@ meta_sync_ring_insert_wait (CoglContext *ctx)
 
   if (sync->state == META_SYNC_STATE_WAITING)
     {
-      meta_gl_delete_sync (sync->gpu_fence);
-      sync->gpu_fence = 0;
+      meta_sync_clear_gpu_fence (sync);
       sync->state = META_SYNC_STATE_READY;
     }
   else if (sync->state != META_SYNC_STATE_READY)
@@ -565,7 +658,7 @@ meta_sync_ring_insert_wait (CoglContext *ctx)
         return FALSE;
     }
 
-  meta_sync_insert (sync);
+  meta_sync_insert (sync, ctx, ring->use_sync_fds);
 
   return TRUE;
 }
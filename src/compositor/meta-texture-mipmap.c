@@ -28,8 +28,25 @@
 #include "compositor/meta-multi-texture-format-private.h"
 
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
+/*
+ * Scaled down textures are only used while windows are painted scaled,
+ * e.g. in an overview, but stay allocated afterwards. Keep track of the
+ * allocated ones, least recently used last, and free them when they go
+ * unused for a while or when their total size exceeds a budget. They are
+ * recreated from the base texture the next time they are needed.
+ */
+#define DEFAULT_RESIDENT_BUDGET_MB 128
+#define RESIDENT_EXPIRY_US (10 * G_USEC_PER_SEC)
+#define RESIDENT_EXPIRY_CHECK_INTERVAL_S 5
+
+static GQueue resident_mipmaps = G_QUEUE_INIT;
+static size_t resident_size;
+static size_t resident_budget;
+static guint resident_expiry_id;
+
 struct _MetaTextureMipmap
 {
   MetaMultiTexture *base_texture;
@@ -38,8 +55,31 @@ struct _MetaTextureMipmap
   CoglFramebuffer *fb;
   CoglContext *cogl_context;
   gboolean invalid;
+
+  /* Damaged area of the base texture, when not entirely invalid */
+  MtkRegion *invalid_region;
+
+  GList resident_link;
+  size_t resident_size;
+  int64_t last_used_us;
 };
 
+static void free_mipmaps (MetaTextureMipmap *mipmap);
+
+static size_t
+get_resident_budget (void)
+{
+  const char *budget_str;
+  guint64 budget_mb;
+
+  budget_str = getenv ("MUTTER_DEBUG_MIPMAP_BUDGET_MB");
+  if (!budget_str ||
+      !g_ascii_string_to_unsigned (budget_str, 10, 1, 65536, &budget_mb, NULL))
+    budget_mb = DEFAULT_RESIDENT_BUDGET_MB;
+
+  return (size_t) budget_mb * 1024 * 1024;
+}
+
 /**
  * meta_texture_mipmap_new:
  *
@@ -55,6 +95,10 @@ meta_texture_mipmap_new (CoglContext *cogl_context)
 
   mipmap = g_new0 (MetaTextureMipmap, 1);
   mipmap->cogl_context = cogl_context;
+  mipmap->resident_link.data = mipmap;
+
+  if (!resident_budget)
+    resident_budget = get_resident_budget ();
 
   return mipmap;
 }
@@ -70,10 +114,10 @@ meta_texture_mipmap_free (MetaTextureMipmap *mipmap)
 {
   g_return_if_fail (mipmap != NULL);
 
+  free_mipmaps (mipmap);
   g_clear_object (&mipmap->pipeline);
   g_clear_object (&mipmap->base_texture);
-  g_clear_object (&mipmap->mipmap_texture);
-  g_clear_object (&mipmap->fb);
+  g_clear_pointer (&mipmap->invalid_region, mtk_region_unref);
 
   g_free (mipmap);
 }
@@ -104,7 +148,7 @@ meta_texture_mipmap_set_base_texture (MetaTextureMipmap *mipmap,
   if (mipmap->base_texture != NULL)
     {
       g_object_ref (mipmap->base_texture);
-      mipmap->invalid = TRUE;
+      meta_texture_mipmap_invalidate (mipmap);
     }
 }
 
@@ -114,6 +158,36 @@ meta_texture_mipmap_invalidate (MetaTextureMipmap *mipmap)
   g_return_if_fail (mipmap != NULL);
 
   mipmap->invalid = TRUE;
+  g_clear_pointer (&mipmap->invalid_region, mtk_region_unref);
+}
+
+/**
+ * meta_texture_mipmap_invalidate_area:
+ * @mipmap: a #MetaTextureMipmap
+ * @area: the updated area of the base texture
+ *
+ * Marks a part of the base texture as changed, so that only the matching
+ * part of the scaled down texture is redrawn the next time it is used.
+ */
+void
+meta_texture_mipmap_invalidate_area (MetaTextureMipmap  *mipmap,
+                                     const MtkRectangle *area)
+{
+  g_return_if_fail (mipmap != NULL);
+
+  if (mipmap->invalid)
+    return;
+
+  if (!mipmap->invalid_region)
+    mipmap->invalid_region = mtk_region_create ();
+
+  mtk_region_union_rectangle (mipmap->invalid_region, area);
+}
+
+static gboolean
+is_resident (MetaTextureMipmap *mipmap)
+{
+  return mipmap->resident_size > 0;
 }
 
 static void
@@ -121,6 +195,84 @@ free_mipmaps (MetaTextureMipmap *mipmap)
 {
   g_clear_object (&mipmap->fb);
   g_clear_object (&mipmap->mipmap_texture);
+
+  if (is_resident (mipmap))
+    {
+      g_queue_unlink (&resident_mipmaps, &mipmap->resident_link);
+      resident_size -= mipmap->resident_size;
+      mipmap->resident_size = 0;
+    }
+
+  if (g_queue_is_empty (&resident_mipmaps))
+    g_clear_handle_id (&resident_expiry_id, g_source_remove);
+}
+
+static gboolean
+expire_resident_mipmaps (gpointer user_data)
+{
+  int64_t now_us = g_get_monotonic_time ();
+  GList *l;
+
+  while ((l = g_queue_peek_tail_link (&resident_mipmaps)))
+    {
+      MetaTextureMipmap *mipmap = l->data;
+
+      if (now_us - mipmap->last_used_us < RESIDENT_EXPIRY_US)
+        break;
+
+      free_mipmaps (mipmap);
+    }
+
+  if (g_queue_is_empty (&resident_mipmaps))
+    {
+      resident_expiry_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+mark_used (MetaTextureMipmap *mipmap)
+{
+  int width, height;
+
+  mipmap->last_used_us = g_get_monotonic_time ();
+
+  if (is_resident (mipmap))
+    {
+      g_queue_unlink (&resident_mipmaps, &mipmap->resident_link);
+      g_queue_push_head_link (&resident_mipmaps, &mipmap->resident_link);
+      return;
+    }
+
+  /* Account for the mipmap levels generated from the texture as well */
+  width = meta_multi_texture_get_width (mipmap->mipmap_texture);
+  height = meta_multi_texture_get_height (mipmap->mipmap_texture);
+  mipmap->resident_size = (size_t) width * height * 4 * 4 / 3;
+
+  g_queue_push_head_link (&resident_mipmaps, &mipmap->resident_link);
+  resident_size += mipmap->resident_size;
+
+  while (resident_size > resident_budget)
+    {
+      MetaTextureMipmap *lru_mipmap = g_queue_peek_tail (&resident_mipmaps);
+
+      if (lru_mipmap == mipmap)
+        break;
+
+      free_mipmaps (lru_mipmap);
+    }
+
+  if (!resident_expiry_id)
+    {
+      resident_expiry_id =
+        g_timeout_add_seconds (RESIDENT_EXPIRY_CHECK_INTERVAL_S,
+                               expire_resident_mipmaps,
+                               NULL);
+      g_source_set_name_by_id (resident_expiry_id,
+                               "[mutter] expire_resident_mipmaps");
+    }
 }
 
 void
@@ -131,6 +283,98 @@ meta_texture_mipmap_clear (MetaTextureMipmap *mipmap)
   free_mipmaps (mipmap);
 }
 
+static void
+ensure_pipeline (MetaTextureMipmap *mipmap)
+{
+  int n_planes, i;
+
+  n_planes = meta_multi_texture_get_n_planes (mipmap->base_texture);
+
+  if (!mipmap->pipeline)
+    {
+      MetaMultiTextureFormat format =
+        meta_multi_texture_get_format (mipmap->base_texture);
+      CoglSnippet *fragment_globals_snippet;
+      CoglSnippet *fragment_snippet;
+
+      mipmap->pipeline = cogl_pipeline_new (mipmap->cogl_context);
+      cogl_pipeline_set_blend (mipmap->pipeline,
+                               "RGBA = ADD (SRC_COLOR, 0)",
+                               NULL);
+
+      for (i = 0; i < n_planes; i++)
+        {
+          cogl_pipeline_set_layer_filters (mipmap->pipeline, i,
+                                           COGL_PIPELINE_FILTER_LINEAR,
+                                           COGL_PIPELINE_FILTER_LINEAR);
+          cogl_pipeline_set_layer_combine (mipmap->pipeline, i,
+                                           "RGBA = REPLACE(TEXTURE)",
+                                           NULL);
+        }
+
+      meta_multi_texture_format_get_snippets (format,
+                                              &fragment_globals_snippet,
+                                              &fragment_snippet);
+      cogl_pipeline_add_snippet (mipmap->pipeline, fragment_globals_snippet);
+      cogl_pipeline_add_snippet (mipmap->pipeline, fragment_snippet);
+
+      g_clear_object (&fragment_globals_snippet);
+      g_clear_object (&fragment_snippet);
+    }
+
+  for (i = 0; i < n_planes; i++)
+    {
+      CoglTexture *plane = meta_multi_texture_get_plane (mipmap->base_texture, i);
+
+      cogl_pipeline_set_layer_texture (mipmap->pipeline, i, plane);
+    }
+}
+
+/* Redraws the parts of the scaled down texture covering the damaged area
+ * of the base texture, grown by a texel to account for the linear
+ * filtering of the neighbouring texels */
+static void
+redraw_region (MetaTextureMipmap *mipmap,
+               int                width,
+               int                height)
+{
+  g_autofree float *coordinates = NULL;
+  int n_rectangles, i;
+
+  n_rectangles = mtk_region_num_rectangles (mipmap->invalid_region);
+  if (n_rectangles == 0)
+    return;
+
+  coordinates = g_new (float, 8 * n_rectangles);
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect;
+      int x1, y1, x2, y2;
+
+      rect = mtk_region_get_rectangle (mipmap->invalid_region, i);
+
+      x1 = CLAMP (rect.x / 2 - 1, 0, width);
+      y1 = CLAMP (rect.y / 2 - 1, 0, height);
+      x2 = CLAMP ((rect.x + rect.width + 1) / 2 + 1, 0, width);
+      y2 = CLAMP ((rect.y + rect.height + 1) / 2 + 1, 0, height);
+
+      coordinates[8 * i] = (float) x1;
+      coordinates[8 * i + 1] = (float) y1;
+      coordinates[8 * i + 2] = (float) x2;
+      coordinates[8 * i + 3] = (float) y2;
+      coordinates[8 * i + 4] = (float) x1 / width;
+      coordinates[8 * i + 5] = (float) y1 / height;
+      coordinates[8 * i + 6] = (float) x2 / width;
+      coordinates[8 * i + 7] = (float) y2 / height;
+    }
+
+  cogl_framebuffer_draw_textured_rectangles (mipmap->fb,
+                                             mipmap->pipeline,
+                                             coordinates,
+                                             n_rectangles);
+}
+
 static void
 ensure_mipmap_texture (MetaTextureMipmap *mipmap)
 {
@@ -201,55 +445,21 @@ ensure_mipmap_texture (MetaTextureMipmap *mipmap)
 
   if (mipmap->invalid)
     {
-      int n_planes, i;
-
-      n_planes = meta_multi_texture_get_n_planes (mipmap->base_texture);
-
-      if (!mipmap->pipeline)
-        {
-          MetaMultiTextureFormat format =
-            meta_multi_texture_get_format (mipmap->base_texture);
-          CoglSnippet *fragment_globals_snippet;
-          CoglSnippet *fragment_snippet;
-
-          mipmap->pipeline = cogl_pipeline_new (mipmap->cogl_context);
-          cogl_pipeline_set_blend (mipmap->pipeline,
-                                   "RGBA = ADD (SRC_COLOR, 0)",
-                                   NULL);
-
-          for (i = 0; i < n_planes; i++)
-            {
-              cogl_pipeline_set_layer_filters (mipmap->pipeline, i,
-                                               COGL_PIPELINE_FILTER_LINEAR,
-                                               COGL_PIPELINE_FILTER_LINEAR);
-              cogl_pipeline_set_layer_combine (mipmap->pipeline, i,
-                                               "RGBA = REPLACE(TEXTURE)",
-                                               NULL);
-            }
-
-          meta_multi_texture_format_get_snippets (format,
-                                                  &fragment_globals_snippet,
-                                                  &fragment_snippet);
-          cogl_pipeline_add_snippet (mipmap->pipeline, fragment_globals_snippet);
-          cogl_pipeline_add_snippet (mipmap->pipeline, fragment_snippet);
-
-          g_clear_object (&fragment_globals_snippet);
-          g_clear_object (&fragment_snippet);
-        }
-
-      for (i = 0; i < n_planes; i++)
-        {
-          CoglTexture *plane = meta_multi_texture_get_plane (mipmap->base_texture, i);
-
-          cogl_pipeline_set_layer_texture (mipmap->pipeline, i, plane);
-        }
-
+      ensure_pipeline (mipmap);
       cogl_framebuffer_draw_textured_rectangle (mipmap->fb,
                                                 mipmap->pipeline,
                                                 0, 0, width, height,
                                                 0.0, 0.0, 1.0, 1.0);
 
       mipmap->invalid = FALSE;
+      g_clear_pointer (&mipmap->invalid_region, mtk_region_unref);
+    }
+  else if (mipmap->invalid_region)
+    {
+      ensure_pipeline (mipmap);
+      redraw_region (mipmap, width, height);
+
+      g_clear_pointer (&mipmap->invalid_region, mtk_region_unref);
     }
 }
 
@@ -273,5 +483,8 @@ meta_texture_mipmap_get_paint_texture (MetaTextureMipmap *mipmap)
 
   ensure_mipmap_texture (mipmap);
 
+  if (mipmap->mipmap_texture)
+    mark_used (mipmap);
+
   return mipmap->mipmap_texture;
 }
@@ -48,6 +48,9 @@ MetaMultiTexture *meta_texture_mipmap_get_paint_texture (MetaTextureMipmap *mipm
 
 void meta_texture_mipmap_invalidate (MetaTextureMipmap *mipmap);
 
+void meta_texture_mipmap_invalidate_area (MetaTextureMipmap  *mipmap,
+                                          const MtkRectangle *area);
+
 void meta_texture_mipmap_clear (MetaTextureMipmap *mipmap);
 
 G_END_DECLS
@@ -34,6 +34,8 @@ struct _MetaWindowActorClass
 
   void (*sync_geometry) (MetaWindowActor *actor);
   gboolean (*is_single_surface_actor) (MetaWindowActor *actor);
+
+  void (*prefetch) (MetaWindowActor *actor);
 };
 
 typedef enum
@@ -88,6 +90,8 @@ void meta_window_actor_assign_surface_actor (MetaWindowActor  *self,
 META_EXPORT_TEST
 MetaWindowActor *meta_window_actor_from_window (MetaWindow *window);
 
+void meta_window_actor_prefetch (MetaWindowActor *self);
+
 META_EXPORT_TEST
 MetaWindowActor *meta_window_actor_from_actor (ClutterActor *actor);
 
@@ -118,3 +122,7 @@ void meta_window_actor_set_tied_to_drag (MetaWindowActor *window_actor,
                                          gboolean         tied_to_drag);
 
 gboolean meta_window_actor_is_tied_to_drag (MetaWindowActor *window_actor);
+
+void meta_window_actor_set_cached_thumbnail_size (MetaWindowActor *self,
+                                                  int              max_width,
+                                                  int              max_height);
@@ -483,6 +483,34 @@ meta_window_actor_wayland_queue_destroy (MetaWindowActor *actor)
 {
 }
 
+static void
+meta_window_actor_wayland_prefetch (MetaWindowActor *actor)
+{
+  MetaWindowActorWayland *self = META_WINDOW_ACTOR_WAYLAND (actor);
+  int64_t now_us = g_get_monotonic_time ();
+  ClutterActor *child;
+  ClutterActorIter iter;
+
+  /* Hidden surfaces only get frame callbacks at a low rate; let clients
+   * draw an up to date frame before the window is shown again. */
+  clutter_actor_iter_init (&iter, CLUTTER_ACTOR (self->surface_container));
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      MetaSurfaceActorWayland *surface_actor =
+        META_SURFACE_ACTOR_WAYLAND (child);
+      MetaWaylandSurface *surface;
+
+      surface = meta_surface_actor_wayland_get_surface (surface_actor);
+      if (!surface || !META_IS_WAYLAND_ACTOR_SURFACE (surface->role))
+        continue;
+
+      meta_wayland_actor_surface_emit_frame_callbacks (META_WAYLAND_ACTOR_SURFACE (surface->role),
+                                                       now_us / 1000);
+      meta_wayland_compositor_remove_frame_callback_surface (surface->compositor,
+                                                             surface);
+    }
+}
+
 static void
 meta_window_actor_wayland_set_frozen (MetaWindowActor *actor,
                                       gboolean         frozen)
@@ -717,6 +745,7 @@ meta_window_actor_wayland_class_init (MetaWindowActorWaylandClass *klass)
   window_actor_class->can_freeze_commits = meta_window_actor_wayland_can_freeze_commits;
   window_actor_class->sync_geometry = meta_window_actor_wayland_sync_geometry;
   window_actor_class->is_single_surface_actor = meta_window_actor_wayland_is_single_surface_actor;
+  window_actor_class->prefetch = meta_window_actor_wayland_prefetch;
 
   clutter_actor_class->map = meta_window_actor_wayland_map;
 
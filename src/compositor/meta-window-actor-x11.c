@@ -1418,6 +1418,14 @@ meta_window_actor_x11_update_regions (MetaWindowActor *actor)
   update_regions (META_WINDOW_ACTOR_X11 (actor));
 }
 
+static void
+meta_window_actor_x11_prefetch (MetaWindowActor *actor)
+{
+  /* Repair the pixmap and build the shape and shadow now rather than in
+   * the first frame showing the window. */
+  handle_updates (META_WINDOW_ACTOR_X11 (actor));
+}
+
 static gboolean
 meta_window_actor_x11_can_freeze_commits (MetaWindowActor *actor)
 {
@@ -1538,6 +1546,7 @@ meta_window_actor_x11_class_init (MetaWindowActorX11Class *klass)
   window_actor_class->can_freeze_commits = meta_window_actor_x11_can_freeze_commits;
   window_actor_class->sync_geometry = meta_window_actor_x11_sync_geometry;
   window_actor_class->is_single_surface_actor = meta_window_actor_x11_is_single_surface_actor;
+  window_actor_class->prefetch = meta_window_actor_x11_prefetch;
 
   actor_class->paint = meta_window_actor_x11_paint;
   actor_class->get_paint_volume = meta_window_actor_x11_get_paint_volume;
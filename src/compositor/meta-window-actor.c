@@ -28,6 +28,7 @@
 #include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-surface-actor.h"
 #include "compositor/meta-window-actor-private.h"
+#include "compositor/meta-window-thumbnail.h"
 #include "core/boxes-private.h"
 #include "core/window-private.h"
 #include "meta/window.h"
@@ -61,6 +62,12 @@ typedef struct _MetaWindowActorPrivate
 
   int geometry_scale;
 
+  /* Thumbnail kept warm by the compositor, see
+   * meta_compositor_set_thumbnail_cache() */
+  MetaWindowThumbnail *cached_thumbnail;
+  int cached_thumbnail_max_width;
+  int cached_thumbnail_max_height;
+
   /*
    * These need to be counters rather than flags, since more plugins
    * can implement same effect; the practicality of stacking effects
@@ -123,6 +130,8 @@ static void meta_window_actor_get_property (GObject      *object,
 
 static MetaSurfaceActor * meta_window_actor_real_get_scanout_candidate (MetaWindowActor *self);
 
+static gboolean meta_window_actor_is_single_surface_actor (MetaWindowActor *self);
+
 static void meta_window_actor_real_assign_surface_actor (MetaWindowActor  *self,
                                                          MetaSurfaceActor *surface_actor);
 
@@ -523,7 +532,7 @@ on_stage_views_changed (MetaWindowActor *self)
   MetaWindowActorPrivate *priv =
     meta_window_actor_get_instance_private (self);
 
-  meta_compositor_window_actor_stage_views_changed (priv->compositor);
+  meta_compositor_window_actor_stage_views_changed (priv->compositor, self);
 }
 
 static void
@@ -581,6 +590,8 @@ meta_window_actor_dispose (GObject *object)
   g_clear_pointer (&priv->surface_actors, g_ptr_array_unref);
   g_clear_signal_handler (&priv->stage_views_changed_id, self);
 
+  meta_window_actor_set_cached_thumbnail_size (self, 0, 0);
+
   meta_compositor_remove_window_actor (compositor, self);
 
   g_clear_object (&priv->window);
@@ -1128,6 +1139,19 @@ meta_window_actor_before_paint (MetaWindowActor  *self,
   META_WINDOW_ACTOR_GET_CLASS (self)->before_paint (self, stage_view);
 }
 
+/* Gets the window ready to be shown, ahead of it becoming visible */
+void
+meta_window_actor_prefetch (MetaWindowActor *self)
+{
+  MetaWindowActorClass *klass = META_WINDOW_ACTOR_GET_CLASS (self);
+
+  if (meta_window_actor_is_destroyed (self))
+    return;
+
+  if (klass->prefetch)
+    klass->prefetch (self);
+}
+
 void
 meta_window_actor_after_paint (MetaWindowActor  *self,
                                ClutterStageView *stage_view)
@@ -1396,6 +1420,56 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
   cairo_surface_destroy (image);
 }
 
+/* Copies the buffer of a single opaque surface as is, bypassing painting
+ * the actor tree, when that gives the same result */
+static gboolean
+try_blit_passthrough (MetaWindowActor   *window_actor,
+                      MetaShapedTexture *stex,
+                      MtkRectangle      *bounds,
+                      CoglFramebuffer   *framebuffer)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (window_actor);
+  CoglContext *cogl_context;
+  CoglTexture *texture;
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  int width, height;
+
+  if (!meta_window_actor_is_single_surface_actor (window_actor))
+    return FALSE;
+
+  if (clutter_actor_has_effects (actor) ||
+      clutter_actor_get_opacity (actor) != 255)
+    return FALSE;
+
+  texture = meta_shaped_texture_get_passthrough_texture (stex,
+                                                         clutter_actor_get_color_state (actor));
+  if (!texture)
+    return FALSE;
+
+  width = cogl_framebuffer_get_width (framebuffer);
+  height = cogl_framebuffer_get_height (framebuffer);
+  if (bounds->x != 0 || bounds->y != 0 ||
+      bounds->width != width || bounds->height != height ||
+      cogl_texture_get_width (texture) != width ||
+      cogl_texture_get_height (texture) != height)
+    return FALSE;
+
+  cogl_context = cogl_framebuffer_get_context (framebuffer);
+  pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+  cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+  cogl_framebuffer_orthographic (framebuffer, 0, 0, width, height, 0, 1.0);
+  cogl_framebuffer_set_viewport (framebuffer, 0, 0, width, height);
+  cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
+                                   0, 0, width, height);
+
+  return TRUE;
+}
+
 static gboolean
 meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
                                        MtkRectangle         *bounds,
@@ -1427,6 +1501,9 @@ meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
   if (width == 0 || height == 0)
     return FALSE;
 
+  if (try_blit_passthrough (window_actor, stex, bounds, framebuffer))
+    return TRUE;
+
   clutter_actor_get_relative_transformation_matrix (CLUTTER_ACTOR (priv->surface),
                                                     clutter_actor_get_stage (actor),
                                                     &transform);
@@ -1620,6 +1697,48 @@ meta_window_actor_is_single_surface_actor (MetaWindowActor *self)
   return META_WINDOW_ACTOR_GET_CLASS (self)->is_single_surface_actor (self);
 }
 
+static gboolean
+get_image_framebuffer_clip (MetaWindowActor *self,
+                            MtkRectangle    *clip,
+                            MtkRectangle    *out_framebuffer_clip)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  MtkRectangle framebuffer_clip;
+  float x, y, width, height;
+
+  clutter_actor_get_position (actor, &x, &y);
+  clutter_actor_get_size (actor, &width, &height);
+
+  if (width == 0 || height == 0)
+    return FALSE;
+
+  framebuffer_clip = (MtkRectangle) {
+    .x = (int) floorf (x),
+    .y = (int) floorf (y),
+    .width = (int) ceilf (width),
+    .height = (int) ceilf (height),
+  };
+
+  if (clip)
+    {
+      MtkRectangle tmp_clip;
+      MtkRectangle intersected_clip;
+
+      tmp_clip = *clip;
+      tmp_clip.x += (int) floorf (x);
+      tmp_clip.y += (int) floorf (y);
+      if (!mtk_rectangle_intersect (&framebuffer_clip,
+                                    &tmp_clip,
+                                    &intersected_clip))
+        return FALSE;
+
+      framebuffer_clip = intersected_clip;
+    }
+
+  *out_framebuffer_clip = framebuffer_clip;
+  return TRUE;
+}
+
 /**
  * meta_window_actor_get_image:
  * @self: A #MetaWindowActor
@@ -1644,7 +1763,6 @@ meta_window_actor_get_image (MetaWindowActor *self,
   CoglFramebuffer *framebuffer;
   MtkRectangle framebuffer_clip;
   float resource_scale;
-  float x, y, width, height;
 
   if (!priv->surface)
     return NULL;
@@ -1675,35 +1793,9 @@ meta_window_actor_get_image (MetaWindowActor *self,
       goto out;
     }
 
-  clutter_actor_get_position (actor, &x, &y);
-  clutter_actor_get_size (actor, &width, &height);
-
-  if (width == 0 || height == 0)
+  if (!get_image_framebuffer_clip (self, clip, &framebuffer_clip))
     goto out;
 
-  framebuffer_clip = (MtkRectangle) {
-    .x = (int) floorf (x),
-    .y = (int) floorf (y),
-    .width = (int) ceilf (width),
-    .height = (int) ceilf (height),
-  };
-
-  if (clip)
-    {
-      MtkRectangle tmp_clip;
-      MtkRectangle intersected_clip;
-
-      tmp_clip = *clip;
-      tmp_clip.x += (int) floorf (x);
-      tmp_clip.y += (int) floorf (y);
-      if (!mtk_rectangle_intersect (&framebuffer_clip,
-                                    &tmp_clip,
-                                    &intersected_clip))
-        goto out;
-
-      framebuffer_clip = intersected_clip;
-    }
-
   framebuffer = create_framebuffer_from_window_actor (self,
                                                       &framebuffer_clip,
                                                       NULL);
@@ -1732,6 +1824,137 @@ out:
   return surface;
 }
 
+static void
+on_image_read_back (GObject      *source_object,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (source_object);
+  g_autoptr (GTask) task = G_TASK (user_data);
+  cairo_surface_t *surface = g_task_get_task_data (task);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  GError *error = NULL;
+
+  bitmap =
+    cogl_bitmap_new_for_data (cogl_context,
+                              cairo_image_surface_get_width (surface),
+                              cairo_image_surface_get_height (surface),
+                              COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                              cairo_image_surface_get_stride (surface),
+                              cairo_image_surface_get_data (surface));
+
+  if (!cogl_framebuffer_read_pixels_finish (framebuffer, result,
+                                            bitmap, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  cairo_surface_mark_dirty (surface);
+  g_task_return_pointer (task,
+                         cairo_surface_reference (surface),
+                         (GDestroyNotify) cairo_surface_destroy);
+}
+
+/**
+ * meta_window_actor_get_image_async:
+ * @self: A #MetaWindowActor
+ * @clip: (nullable): A clipping rectangle, to help prevent extra processing.
+ * In the case that the clipping rectangle is partially or fully
+ * outside the bounds of the actor, the rectangle will be clipped.
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: The callback to call once the image is available
+ * @user_data: The data to pass to @callback
+ *
+ * Like meta_window_actor_get_image(), but without waiting for the GPU to
+ * finish painting the window. The window is painted offscreen right away,
+ * and @callback is called once the pixels have been read back, at which
+ * point meta_window_actor_get_image_finish() must be called.
+ */
+void
+meta_window_actor_get_image_async (MetaWindowActor     *self,
+                                   MtkRectangle        *clip,
+                                   GCancellable        *cancellable,
+                                   GAsyncReadyCallback  callback,
+                                   gpointer             user_data)
+{
+  MetaWindowActorPrivate *priv = meta_window_actor_get_instance_private (self);
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  g_autoptr (GTask) task = NULL;
+  g_autoptr (GError) error = NULL;
+  CoglFramebuffer *framebuffer;
+  MtkRectangle framebuffer_clip;
+  cairo_surface_t *surface;
+  float resource_scale;
+  int width, height;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, meta_window_actor_get_image_async);
+
+  if (!priv->surface ||
+      !get_image_framebuffer_clip (self, clip, &framebuffer_clip))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                               "Window has no content to capture");
+      return;
+    }
+
+  clutter_actor_inhibit_culling (actor);
+  framebuffer = create_framebuffer_from_window_actor (self,
+                                                      &framebuffer_clip,
+                                                      &error);
+  clutter_actor_uninhibit_culling (actor);
+
+  if (!framebuffer)
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  resource_scale = clutter_actor_get_resource_scale (actor);
+  width = (int) (framebuffer_clip.width * resource_scale);
+  height = (int) (framebuffer_clip.height * resource_scale);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  g_task_set_task_data (task, surface,
+                        (GDestroyNotify) cairo_surface_destroy);
+
+  cogl_framebuffer_read_pixels_async (framebuffer,
+                                      0, 0,
+                                      width, height,
+                                      COGL_READ_PIXELS_COLOR_BUFFER,
+                                      COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                      cancellable,
+                                      on_image_read_back,
+                                      g_steal_pointer (&task));
+
+  g_object_unref (framebuffer);
+}
+
+/**
+ * meta_window_actor_get_image_finish:
+ * @self: A #MetaWindowActor
+ * @result: The #GAsyncResult passed to the callback
+ * @error: Return location for a #GError
+ *
+ * Finishes a capture started with meta_window_actor_get_image_async().
+ *
+ * Returns: (transfer full): a new cairo surface to be freed with
+ * cairo_surface_destroy(), or %NULL on error.
+ */
+cairo_surface_t *
+meta_window_actor_get_image_finish (MetaWindowActor  *self,
+                                    GAsyncResult     *result,
+                                    GError          **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                        meta_window_actor_get_image_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 /**
  * meta_window_actor_paint_to_content:
  * @self: A #MetaWindowActor
@@ -1800,6 +2023,95 @@ out:
   return content;
 }
 
+/**
+ * meta_window_actor_create_thumbnail:
+ * @self: A #MetaWindowActor
+ * @max_width: The maximum width of the thumbnail
+ * @max_height: The maximum height of the thumbnail
+ *
+ * Creates a content showing a downscaled copy of @self, fitting within
+ * @max_width x @max_height. Contrary to meta_window_actor_paint_to_content(),
+ * the content is kept up to date, and is only painted again when the window
+ * is damaged. When the window actor is destroyed, the content keeps showing
+ * its last state.
+ *
+ * If the compositor keeps a thumbnail of @self of the same size warm, see
+ * meta_compositor_set_thumbnail_cache(), that one is returned.
+ *
+ * Returns: (transfer full): a #ClutterContent
+ */
+ClutterContent *
+meta_window_actor_create_thumbnail (MetaWindowActor *self,
+                                    int              max_width,
+                                    int              max_height)
+{
+  MetaWindowActorPrivate *priv = meta_window_actor_get_instance_private (self);
+
+  g_return_val_if_fail (META_IS_WINDOW_ACTOR (self), NULL);
+  g_return_val_if_fail (max_width > 0 && max_height > 0, NULL);
+
+  /* Hand out the thumbnail kept warm by the compositor, so that switchers
+   * opening don't have to paint every window first */
+  if (priv->cached_thumbnail &&
+      priv->cached_thumbnail_max_width == max_width &&
+      priv->cached_thumbnail_max_height == max_height)
+    return CLUTTER_CONTENT (g_object_ref (priv->cached_thumbnail));
+
+  return CLUTTER_CONTENT (meta_window_thumbnail_new (self,
+                                                     max_width,
+                                                     max_height));
+}
+
+static void
+on_cached_thumbnail_toggled (gpointer  user_data,
+                             GObject  *object,
+                             gboolean  is_last_ref)
+{
+  MetaWindowThumbnail *thumbnail = META_WINDOW_THUMBNAIL (object);
+
+  /* Only keep it updated promptly while somebody else is showing it */
+  meta_window_thumbnail_set_low_priority (thumbnail, is_last_ref);
+}
+
+void
+meta_window_actor_set_cached_thumbnail_size (MetaWindowActor *self,
+                                             int              max_width,
+                                             int              max_height)
+{
+  MetaWindowActorPrivate *priv = meta_window_actor_get_instance_private (self);
+  MetaWindowThumbnail *thumbnail;
+
+  if (priv->cached_thumbnail &&
+      priv->cached_thumbnail_max_width == max_width &&
+      priv->cached_thumbnail_max_height == max_height)
+    return;
+
+  if (priv->cached_thumbnail)
+    {
+      g_object_remove_toggle_ref (G_OBJECT (priv->cached_thumbnail),
+                                  on_cached_thumbnail_toggled,
+                                  self);
+      priv->cached_thumbnail = NULL;
+    }
+
+  priv->cached_thumbnail_max_width = 0;
+  priv->cached_thumbnail_max_height = 0;
+
+  if (max_width <= 0 || max_height <= 0)
+    return;
+
+  thumbnail = meta_window_thumbnail_new (self, max_width, max_height);
+  meta_window_thumbnail_set_low_priority (thumbnail, TRUE);
+  g_object_add_toggle_ref (G_OBJECT (thumbnail),
+                           on_cached_thumbnail_toggled,
+                           self);
+  g_object_unref (thumbnail);
+
+  priv->cached_thumbnail = thumbnail;
+  priv->cached_thumbnail_max_width = max_width;
+  priv->cached_thumbnail_max_height = max_height;
+}
+
 void
 meta_window_actor_set_tied_to_drag (MetaWindowActor *window_actor,
                                     gboolean         tied_to_drag)
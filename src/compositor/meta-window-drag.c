@@ -84,6 +84,11 @@ struct _MetaWindowDrag {
   guint tile_preview_timeout_id;
   guint preview_tile_mode : 2;
   guint pos_hint_set : 1;
+  guint tile_preview_shown : 1;
+
+  /* The tile preview as last shown */
+  MtkRectangle shown_tile_preview_rect;
+  int shown_tile_preview_monitor;
 };
 
 G_DEFINE_FINAL_TYPE (MetaWindowDrag, meta_window_drag, G_TYPE_OBJECT)
@@ -126,12 +131,26 @@ update_tile_preview_timeout (MetaWindowDrag *window_drag)
       monitor = meta_window_get_current_tile_monitor_number (window);
       meta_window_get_tile_area (window, window_drag->preview_tile_mode,
                                  &tile_rect);
+
+      /* This runs for every pointer motion; only bother the compositor
+       * plugin when the snap target actually changed */
+      if (window_drag->tile_preview_shown &&
+          window_drag->shown_tile_preview_monitor == monitor &&
+          mtk_rectangle_equal (&window_drag->shown_tile_preview_rect,
+                               &tile_rect))
+        return FALSE;
+
       meta_compositor_show_tile_preview (display->compositor,
                                          window, &tile_rect, monitor);
+
+      window_drag->tile_preview_shown = TRUE;
+      window_drag->shown_tile_preview_rect = tile_rect;
+      window_drag->shown_tile_preview_monitor = monitor;
     }
-  else
+  else if (window_drag->tile_preview_shown)
     {
       meta_compositor_hide_tile_preview (display->compositor);
+      window_drag->tile_preview_shown = FALSE;
     }
 
   return FALSE;
@@ -171,6 +190,7 @@ hide_tile_preview (MetaWindowDrag *window_drag)
   g_clear_handle_id (&window_drag->tile_preview_timeout_id, g_source_remove);
 
   window_drag->preview_tile_mode = META_TILE_NONE;
+  window_drag->tile_preview_shown = FALSE;
   window = meta_window_drag_get_window (window_drag);
   if (window)
     meta_compositor_hide_tile_preview (window->display->compositor);
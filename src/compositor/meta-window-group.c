@@ -61,6 +61,11 @@ meta_window_group_paint (ClutterActor        *actor,
   const MtkRegion *redraw_clip;
   g_autoptr (MtkRegion) clip_region = NULL;
   graphene_matrix_t stage_to_actor;
+  graphene_matrix_t planar_stage_to_actor;
+  const char *prev_gpu_phase;
+
+  prev_gpu_phase = clutter_paint_context_begin_gpu_phase (paint_context,
+                                                          "windows");
 
   redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
   if (!redraw_clip)
@@ -111,7 +116,8 @@ meta_window_group_paint (ClutterActor        *actor,
         goto fail;
     }
 
-  if (!graphene_matrix_is_2d (&stage_to_actor))
+  if (!meta_matrix_get_planar_transform (&stage_to_actor,
+                                         &planar_stage_to_actor))
     goto fail;
 
   /* Get the clipped redraw bounds so that we can avoid painting shadows on
@@ -120,7 +126,7 @@ meta_window_group_paint (ClutterActor        *actor,
    * with an accurate union of the monitors to avoid painting shadows that are
    * visible only in the holes. */
   clip_region = mtk_region_apply_matrix_transform_expand (redraw_clip,
-                                                          &stage_to_actor);
+                                                          &planar_stage_to_actor);
 
   meta_cullable_cull_redraw_clip (META_CULLABLE (window_group), clip_region);
 
@@ -128,10 +134,12 @@ meta_window_group_paint (ClutterActor        *actor,
 
   meta_cullable_cull_redraw_clip (META_CULLABLE (window_group), NULL);
 
+  clutter_paint_context_begin_gpu_phase (paint_context, prev_gpu_phase);
   return;
 
 fail:
   parent_actor_class->paint (actor, paint_context);
+  clutter_paint_context_begin_gpu_phase (paint_context, prev_gpu_phase);
 }
 
 /* Adapted from clutter_actor_update_default_paint_volume() */
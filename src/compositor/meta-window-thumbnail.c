@@ -0,0 +1,552 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A window thumbnail is a content showing a downscaled copy of a window
+ * actor, that is kept up to date for as long as it is referenced. Unlike
+ * meta_window_actor_paint_to_content(), which paints the window into a new
+ * framebuffer each time it is called, the thumbnail is only painted again
+ * when the window got damaged, right before the next stage update.
+ *
+ * Small thumbnails, as used by window switchers and task bars, don't get a
+ * texture of their own but a cell in a texture shared with other small
+ * thumbnails, saving on allocations and framebuffer switches.
+ *
+ * Thumbnails nobody is looking at yet, e.g. the ones the compositor keeps
+ * warm for window switchers, can be made low priority, in which case they
+ * are only painted again when the main loop is idle.
+ */
+
+#include "config.h"
+
+#include "compositor/meta-window-thumbnail.h"
+
+#include <math.h>
+
+#include "meta/compositor.h"
+#include "meta/display.h"
+#include "meta/meta-later.h"
+#include "meta/window.h"
+
+#define THUMBNAIL_ATLAS_SIZE 1024
+#define THUMBNAIL_ATLAS_CELL_SIZE 128
+#define THUMBNAIL_ATLAS_N_CELLS \
+  ((THUMBNAIL_ATLAS_SIZE / THUMBNAIL_ATLAS_CELL_SIZE) * \
+   (THUMBNAIL_ATLAS_SIZE / THUMBNAIL_ATLAS_CELL_SIZE))
+
+typedef struct _MetaThumbnailAtlas
+{
+  CoglOffscreen *offscreen;
+  gboolean used_cells[THUMBNAIL_ATLAS_N_CELLS];
+  int n_used_cells;
+} MetaThumbnailAtlas;
+
+struct _MetaWindowThumbnail
+{
+  GObject parent;
+
+  MetaWindowActor *window_actor;
+  gulong damaged_handler_id;
+  gulong destroy_handler_id;
+
+  MetaLaters *laters;
+  unsigned int update_later_id;
+  gboolean low_priority;
+
+  int max_width;
+  int max_height;
+
+  int width;
+  int height;
+
+  /* Either a cell of a shared atlas, or a framebuffer of its own */
+  MetaThumbnailAtlas *atlas;
+  int cell;
+  CoglOffscreen *offscreen;
+
+  CoglTexture *texture;
+};
+
+static void clutter_content_iface_init (ClutterContentInterface *iface);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE (MetaWindowThumbnail, meta_window_thumbnail,
+                               G_TYPE_OBJECT,
+                               G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                      clutter_content_iface_init))
+
+/* Atlases with free cells, shared by all thumbnails */
+static GList *thumbnail_atlases;
+
+static MetaThumbnailAtlas *
+meta_thumbnail_atlas_new (CoglContext  *cogl_context,
+                          GError      **error)
+{
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  MetaThumbnailAtlas *atlas;
+  CoglColor clear_color;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context,
+                                           THUMBNAIL_ATLAS_SIZE,
+                                           THUMBNAIL_ATLAS_SIZE);
+  if (!texture)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to create thumbnail atlas texture");
+      return NULL;
+    }
+
+  cogl_texture_set_auto_mipmap (texture, FALSE);
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return NULL;
+
+  cogl_color_init_from_4f (&clear_color, 0.0, 0.0, 0.0, 0.0);
+  cogl_framebuffer_clear (COGL_FRAMEBUFFER (offscreen),
+                          COGL_BUFFER_BIT_COLOR,
+                          &clear_color);
+
+  atlas = g_new0 (MetaThumbnailAtlas, 1);
+  atlas->offscreen = g_steal_pointer (&offscreen);
+
+  return atlas;
+}
+
+static void
+meta_thumbnail_atlas_free (MetaThumbnailAtlas *atlas)
+{
+  g_clear_object (&atlas->offscreen);
+  g_free (atlas);
+}
+
+static void
+get_cell_rect (int           cell,
+               MtkRectangle *rect)
+{
+  int n_columns = THUMBNAIL_ATLAS_SIZE / THUMBNAIL_ATLAS_CELL_SIZE;
+
+  *rect = (MtkRectangle) {
+    .x = (cell % n_columns) * THUMBNAIL_ATLAS_CELL_SIZE,
+    .y = (cell / n_columns) * THUMBNAIL_ATLAS_CELL_SIZE,
+    .width = THUMBNAIL_ATLAS_CELL_SIZE,
+    .height = THUMBNAIL_ATLAS_CELL_SIZE,
+  };
+}
+
+static gboolean
+allocate_atlas_cell (CoglContext         *cogl_context,
+                     MetaThumbnailAtlas **out_atlas,
+                     int                 *out_cell,
+                     GError             **error)
+{
+  MetaThumbnailAtlas *atlas = NULL;
+  int cell;
+
+  if (thumbnail_atlases)
+    {
+      atlas = thumbnail_atlases->data;
+    }
+  else
+    {
+      atlas = meta_thumbnail_atlas_new (cogl_context, error);
+      if (!atlas)
+        return FALSE;
+
+      thumbnail_atlases = g_list_prepend (thumbnail_atlases, atlas);
+    }
+
+  for (cell = 0; cell < THUMBNAIL_ATLAS_N_CELLS; cell++)
+    {
+      if (!atlas->used_cells[cell])
+        break;
+    }
+
+  g_assert (cell < THUMBNAIL_ATLAS_N_CELLS);
+
+  atlas->used_cells[cell] = TRUE;
+  atlas->n_used_cells++;
+
+  /* Only keep atlases with free cells around for allocation */
+  if (atlas->n_used_cells == THUMBNAIL_ATLAS_N_CELLS)
+    thumbnail_atlases = g_list_remove (thumbnail_atlases, atlas);
+
+  *out_atlas = atlas;
+  *out_cell = cell;
+
+  return TRUE;
+}
+
+static void
+release_atlas_cell (MetaThumbnailAtlas *atlas,
+                    int                 cell)
+{
+  g_assert (atlas->used_cells[cell]);
+
+  if (atlas->n_used_cells == THUMBNAIL_ATLAS_N_CELLS)
+    thumbnail_atlases = g_list_prepend (thumbnail_atlases, atlas);
+
+  atlas->used_cells[cell] = FALSE;
+  atlas->n_used_cells--;
+
+  if (atlas->n_used_cells == 0)
+    {
+      thumbnail_atlases = g_list_remove (thumbnail_atlases, atlas);
+      meta_thumbnail_atlas_free (atlas);
+    }
+}
+
+static void
+release_storage (MetaWindowThumbnail *thumbnail)
+{
+  if (thumbnail->atlas)
+    {
+      release_atlas_cell (thumbnail->atlas, thumbnail->cell);
+      thumbnail->atlas = NULL;
+    }
+
+  g_clear_object (&thumbnail->offscreen);
+  g_clear_object (&thumbnail->texture);
+}
+
+static CoglContext *
+get_cogl_context (MetaWindowThumbnail *thumbnail)
+{
+  ClutterContext *clutter_context =
+    clutter_actor_get_context (CLUTTER_ACTOR (thumbnail->window_actor));
+  ClutterBackend *clutter_backend =
+    clutter_context_get_backend (clutter_context);
+
+  return clutter_backend_get_cogl_context (clutter_backend);
+}
+
+static gboolean
+ensure_storage (MetaWindowThumbnail  *thumbnail,
+                int                   width,
+                int                   height,
+                GError              **error)
+{
+  CoglContext *cogl_context = get_cogl_context (thumbnail);
+
+  if (thumbnail->texture &&
+      thumbnail->width == width &&
+      thumbnail->height == height)
+    return TRUE;
+
+  release_storage (thumbnail);
+
+  if (width <= THUMBNAIL_ATLAS_CELL_SIZE &&
+      height <= THUMBNAIL_ATLAS_CELL_SIZE)
+    {
+      MtkRectangle cell_rect;
+
+      if (!allocate_atlas_cell (cogl_context,
+                                &thumbnail->atlas, &thumbnail->cell,
+                                error))
+        return FALSE;
+
+      get_cell_rect (thumbnail->cell, &cell_rect);
+      thumbnail->texture =
+        cogl_sub_texture_new (cogl_context,
+                              cogl_offscreen_get_texture (thumbnail->atlas->offscreen),
+                              cell_rect.x, cell_rect.y,
+                              width, height);
+    }
+  else
+    {
+      g_autoptr (CoglTexture) texture = NULL;
+      g_autoptr (CoglOffscreen) offscreen = NULL;
+
+      texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+      if (!texture)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "Failed to create %dx%d thumbnail texture",
+                       width, height);
+          return FALSE;
+        }
+
+      cogl_texture_set_auto_mipmap (texture, FALSE);
+
+      offscreen = cogl_offscreen_new_with_texture (texture);
+      if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+        return FALSE;
+
+      thumbnail->offscreen = g_steal_pointer (&offscreen);
+      thumbnail->texture = g_steal_pointer (&texture);
+    }
+
+  thumbnail->width = width;
+  thumbnail->height = height;
+
+  return TRUE;
+}
+
+static void
+paint_thumbnail (MetaWindowThumbnail *thumbnail)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (thumbnail->window_actor);
+  g_autoptr (GError) error = NULL;
+  CoglFramebuffer *framebuffer;
+  ClutterPaintContext *paint_context;
+  MtkRectangle rect;
+  CoglColor clear_color;
+  float x, y, width, height;
+  float scale;
+
+  clutter_actor_get_position (actor, &x, &y);
+  clutter_actor_get_size (actor, &width, &height);
+  if (width == 0 || height == 0)
+    return;
+
+  scale = MIN (1.0f, MIN (thumbnail->max_width / width,
+                          thumbnail->max_height / height));
+
+  if (!ensure_storage (thumbnail,
+                       MAX (1, (int) ceilf (width * scale)),
+                       MAX (1, (int) ceilf (height * scale)),
+                       &error))
+    {
+      g_warning ("Failed to create window thumbnail: %s", error->message);
+      return;
+    }
+
+  if (thumbnail->atlas)
+    {
+      framebuffer = COGL_FRAMEBUFFER (thumbnail->atlas->offscreen);
+      get_cell_rect (thumbnail->cell, &rect);
+    }
+  else
+    {
+      framebuffer = COGL_FRAMEBUFFER (thumbnail->offscreen);
+      rect = (MtkRectangle) {
+        .width = thumbnail->width,
+        .height = thumbnail->height,
+      };
+    }
+
+  cogl_framebuffer_push_matrix (framebuffer);
+
+  /* Clear the whole region, so that nothing of a previous, larger
+   * thumbnail in the same atlas cell bleeds into this one */
+  cogl_framebuffer_set_viewport (framebuffer,
+                                 rect.x, rect.y, rect.width, rect.height);
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0, rect.width, rect.height,
+                                 0, 1.0);
+  cogl_framebuffer_identity_matrix (framebuffer);
+  cogl_framebuffer_push_rectangle_clip (framebuffer,
+                                        0, 0, rect.width, rect.height);
+  cogl_color_init_from_4f (&clear_color, 0.0, 0.0, 0.0, 0.0);
+  cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+  cogl_framebuffer_pop_clip (framebuffer);
+
+  cogl_framebuffer_set_viewport (framebuffer,
+                                 rect.x, rect.y,
+                                 thumbnail->width, thumbnail->height);
+  cogl_framebuffer_orthographic (framebuffer, 0, 0, width, height, 0, 1.0);
+  cogl_framebuffer_translate (framebuffer, -x, -y, 0);
+
+  clutter_actor_inhibit_culling (actor);
+  paint_context =
+    clutter_paint_context_new_for_framebuffer (framebuffer, NULL,
+                                               CLUTTER_PAINT_FLAG_NONE,
+                                               clutter_actor_get_color_state (actor));
+  clutter_actor_paint (actor, paint_context);
+  clutter_paint_context_destroy (paint_context);
+  clutter_actor_uninhibit_culling (actor);
+
+  cogl_framebuffer_pop_matrix (framebuffer);
+}
+
+static gboolean
+update_thumbnail_later (gpointer user_data)
+{
+  MetaWindowThumbnail *thumbnail = META_WINDOW_THUMBNAIL (user_data);
+  int old_width = thumbnail->width;
+  int old_height = thumbnail->height;
+
+  thumbnail->update_later_id = 0;
+
+  if (!thumbnail->window_actor)
+    return G_SOURCE_REMOVE;
+
+  paint_thumbnail (thumbnail);
+
+  if (thumbnail->width != old_width || thumbnail->height != old_height)
+    clutter_content_invalidate_size (CLUTTER_CONTENT (thumbnail));
+  clutter_content_invalidate (CLUTTER_CONTENT (thumbnail));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_update (MetaWindowThumbnail *thumbnail)
+{
+  if (thumbnail->update_later_id)
+    return;
+
+  thumbnail->update_later_id =
+    meta_laters_add (thumbnail->laters,
+                     thumbnail->low_priority ? META_LATER_IDLE
+                                             : META_LATER_BEFORE_REDRAW,
+                     update_thumbnail_later,
+                     thumbnail,
+                     NULL);
+}
+
+static void
+on_window_actor_damaged (MetaWindowActor     *window_actor,
+                         MetaWindowThumbnail *thumbnail)
+{
+  queue_update (thumbnail);
+}
+
+static void
+on_window_actor_destroy (MetaWindowActor     *window_actor,
+                         MetaWindowThumbnail *thumbnail)
+{
+  /* Keep showing the last image of the window */
+  g_clear_signal_handler (&thumbnail->damaged_handler_id,
+                          thumbnail->window_actor);
+  g_clear_signal_handler (&thumbnail->destroy_handler_id,
+                          thumbnail->window_actor);
+  thumbnail->window_actor = NULL;
+}
+
+static void
+meta_window_thumbnail_paint_content (ClutterContent      *content,
+                                     ClutterActor        *actor,
+                                     ClutterPaintNode    *root,
+                                     ClutterPaintContext *paint_context)
+{
+  MetaWindowThumbnail *thumbnail = META_WINDOW_THUMBNAIL (content);
+  ClutterPaintNode *node;
+
+  if (!thumbnail->texture)
+    return;
+
+  node = clutter_actor_create_texture_paint_node (actor, thumbnail->texture);
+  clutter_paint_node_set_static_name (node, "Window Thumbnail");
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+}
+
+static gboolean
+meta_window_thumbnail_get_preferred_size (ClutterContent *content,
+                                          float          *width,
+                                          float          *height)
+{
+  MetaWindowThumbnail *thumbnail = META_WINDOW_THUMBNAIL (content);
+
+  if (!thumbnail->texture)
+    return FALSE;
+
+  if (width)
+    *width = (float) thumbnail->width;
+  if (height)
+    *height = (float) thumbnail->height;
+
+  return TRUE;
+}
+
+static void
+clutter_content_iface_init (ClutterContentInterface *iface)
+{
+  iface->paint_content = meta_window_thumbnail_paint_content;
+  iface->get_preferred_size = meta_window_thumbnail_get_preferred_size;
+}
+
+static void
+meta_window_thumbnail_dispose (GObject *object)
+{
+  MetaWindowThumbnail *thumbnail = META_WINDOW_THUMBNAIL (object);
+
+  if (thumbnail->update_later_id)
+    {
+      meta_laters_remove (thumbnail->laters, thumbnail->update_later_id);
+      thumbnail->update_later_id = 0;
+    }
+
+  if (thumbnail->window_actor)
+    on_window_actor_destroy (thumbnail->window_actor, thumbnail);
+
+  release_storage (thumbnail);
+
+  G_OBJECT_CLASS (meta_window_thumbnail_parent_class)->dispose (object);
+}
+
+static void
+meta_window_thumbnail_class_init (MetaWindowThumbnailClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = meta_window_thumbnail_dispose;
+}
+
+static void
+meta_window_thumbnail_init (MetaWindowThumbnail *thumbnail)
+{
+}
+
+void
+meta_window_thumbnail_set_low_priority (MetaWindowThumbnail *thumbnail,
+                                        gboolean             low_priority)
+{
+  if (thumbnail->low_priority == low_priority)
+    return;
+
+  thumbnail->low_priority = low_priority;
+
+  /* Move a pending update to the new priority */
+  if (thumbnail->update_later_id)
+    {
+      meta_laters_remove (thumbnail->laters, thumbnail->update_later_id);
+      thumbnail->update_later_id = 0;
+      queue_update (thumbnail);
+    }
+}
+
+MetaWindowThumbnail *
+meta_window_thumbnail_new (MetaWindowActor *window_actor,
+                           int              max_width,
+                           int              max_height)
+{
+  MetaWindow *window = meta_window_actor_get_meta_window (window_actor);
+  MetaDisplay *display = meta_window_get_display (window);
+  MetaCompositor *compositor = meta_display_get_compositor (display);
+  MetaWindowThumbnail *thumbnail;
+
+  thumbnail = g_object_new (META_TYPE_WINDOW_THUMBNAIL, NULL);
+  thumbnail->window_actor = window_actor;
+  thumbnail->laters = meta_compositor_get_laters (compositor);
+  thumbnail->max_width = max_width;
+  thumbnail->max_height = max_height;
+
+  thumbnail->damaged_handler_id =
+    g_signal_connect (window_actor, "damaged",
+                      G_CALLBACK (on_window_actor_damaged), thumbnail);
+  thumbnail->destroy_handler_id =
+    g_signal_connect (window_actor, "destroy",
+                      G_CALLBACK (on_window_actor_destroy), thumbnail);
+
+  queue_update (thumbnail);
+
+  return thumbnail;
+}
@@ -0,0 +1,34 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "clutter/clutter.h"
+#include "meta/meta-window-actor.h"
+
+#define META_TYPE_WINDOW_THUMBNAIL (meta_window_thumbnail_get_type ())
+G_DECLARE_FINAL_TYPE (MetaWindowThumbnail, meta_window_thumbnail,
+                      META, WINDOW_THUMBNAIL, GObject)
+
+MetaWindowThumbnail * meta_window_thumbnail_new (MetaWindowActor *window_actor,
+                                                 int              max_width,
+                                                 int              max_height);
+
+void meta_window_thumbnail_set_low_priority (MetaWindowThumbnail *thumbnail,
+                                             gboolean             low_priority);
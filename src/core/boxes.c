@@ -210,114 +210,142 @@ meta_rectangle_resize_with_gravity (const MtkRectangle *old_rect,
   rect->height = new_height;
 }
 
+/* Rectangles merged away by merge_spanning_rects_in_region() are only
+ * marked as such, by clearing their width, so that the array doesn't need
+ * to be shuffled around while iterating over it; this finds the next one
+ * that is still part of the region.
+ */
+static inline unsigned int
+next_spanning_rect (GArray       *region,
+                    unsigned int  rect_index)
+{
+  for (rect_index++; rect_index < region->len; rect_index++)
+    {
+      if (g_array_index (region, MtkRectangle, rect_index).width > 0)
+        break;
+    }
+
+  return rect_index;
+}
+
+/* Whether a and b overlap or are adjacent; if not, they can't be merged and
+ * neither can contain the other.
+ */
+static inline gboolean
+spanning_rects_touch (const MtkRectangle *a,
+                      const MtkRectangle *b)
+{
+  return BOX_LEFT (*b) <= BOX_RIGHT (*a) &&
+         BOX_LEFT (*a) <= BOX_RIGHT (*b) &&
+         BOX_TOP (*b)  <= BOX_BOTTOM (*a) &&
+         BOX_TOP (*a)  <= BOX_BOTTOM (*b);
+}
+
 /* Not so simple helper function for get_minimal_spanning_set_for_region() */
 static GList*
-merge_spanning_rects_in_region (GList *region)
+merge_spanning_rects_in_region (GArray *region)
 {
   /* NOTE FOR ANY OPTIMIZATION PEOPLE OUT THERE: Please see the
    * documentation of get_minimal_spanning_set_for_region() for performance
    * considerations that also apply to this function.
    */
 
-  GList *compare;
-  compare = region;
+  GList *ret = NULL;
+  unsigned int compare;
+  int i;
 
-  if (region == NULL)
+  if (region->len == 0)
     {
       g_warning ("Region to merge was empty! Either you have some "
                  "pathological STRUT list or there's a bug somewhere!");
       return NULL;
     }
 
-  while (compare && compare->next)
+  compare = 0;
+  while (compare < region->len &&
+         next_spanning_rect (region, compare) < region->len)
     {
-      MtkRectangle *a = compare->data;
-      GList *other = compare->next;
+      MtkRectangle *a = &g_array_index (region, MtkRectangle, compare);
+      unsigned int other = next_spanning_rect (region, compare);
 
       g_assert (a->width > 0 && a->height > 0);
 
-      while (other)
+      while (other < region->len)
         {
-          MtkRectangle *b = other->data;
-          GList *delete_me = NULL;
+          MtkRectangle *b = &g_array_index (region, MtkRectangle, other);
+          MtkRectangle *delete_me = NULL;
 
           g_assert (b->width > 0 && b->height > 0);
 
+          if (!spanning_rects_touch (a, b))
+            {
+              other = next_spanning_rect (region, other);
+              continue;
+            }
+
           /* If a contains b, just remove b */
           if (mtk_rectangle_contains_rect (a, b))
             {
-              delete_me = other;
+              delete_me = b;
             }
           /* If b contains a, just remove a */
           else if (mtk_rectangle_contains_rect (b, a))
             {
-              delete_me = compare;
+              delete_me = a;
             }
-          /* If a and b might be mergeable horizontally */
+          /* If a and b might be mergeable horizontally; as they touch, they
+           * either overlap or are adjacent
+           */
           else if (a->y == b->y && a->height == b->height)
             {
-              /* If a and b overlap */
-              if (mtk_rectangle_overlap (a, b))
-                {
-                  int new_x = MIN (a->x, b->x);
-                  a->width = MAX (a->x + a->width, b->x + b->width) - new_x;
-                  a->x = new_x;
-                  delete_me = other;
-                }
-              /* If a and b are adjacent */
-              else if (a->x + a->width == b->x || a->x == b->x + b->width)
-                {
-                  int new_x = MIN (a->x, b->x);
-                  a->width = MAX (a->x + a->width, b->x + b->width) - new_x;
-                  a->x = new_x;
-                  delete_me = other;
-                }
+              int new_x = MIN (a->x, b->x);
+              a->width = MAX (a->x + a->width, b->x + b->width) - new_x;
+              a->x = new_x;
+              delete_me = b;
             }
           /* If a and b might be mergeable vertically */
           else if (a->x == b->x && a->width == b->width)
             {
-              /* If a and b overlap */
-              if (mtk_rectangle_overlap (a, b))
-                {
-                  int new_y = MIN (a->y, b->y);
-                  a->height = MAX (a->y + a->height, b->y + b->height) - new_y;
-                  a->y = new_y;
-                  delete_me = other;
-                }
-              /* If a and b are adjacent */
-              else if (a->y + a->height == b->y || a->y == b->y + b->height)
-                {
-                  int new_y = MIN (a->y, b->y);
-                  a->height = MAX (a->y + a->height, b->y + b->height) - new_y;
-                  a->y = new_y;
-                  delete_me = other;
-                }
+              int new_y = MIN (a->y, b->y);
+              a->height = MAX (a->y + a->height, b->y + b->height) - new_y;
+              a->y = new_y;
+              delete_me = b;
             }
 
-          other = other->next;
+          other = next_spanning_rect (region, other);
 
           /* Delete any rectangle in the list that is no longer wanted */
           if (delete_me != NULL)
             {
               /* Deleting the rect we compare others to is a little tricker */
-              if (compare == delete_me)
+              if (delete_me == a)
                 {
-                  compare = compare->next;
-                  other = compare->next;
-                  a = compare->data;
+                  compare = next_spanning_rect (region, compare);
+                  other = next_spanning_rect (region, compare);
+                  a = &g_array_index (region, MtkRectangle, compare);
                 }
 
-              /* Okay, we can free it now */
-              g_free (delete_me->data);
-              region = g_list_delete_link (region, delete_me);
+              delete_me->width = 0;
             }
-
         }
 
-      compare = compare->next;
+      compare = next_spanning_rect (region, compare);
     }
 
-  return region;
+  for (i = (int) region->len - 1; i >= 0; i--)
+    {
+      MtkRectangle *rect = &g_array_index (region, MtkRectangle, i);
+      MtkRectangle *temp_rect;
+
+      if (rect->width == 0)
+        continue;
+
+      temp_rect = g_new (MtkRectangle, 1);
+      *temp_rect = *rect;
+      ret = g_list_prepend (ret, temp_rect);
+    }
+
+  return ret;
 }
 
 /* Simple helper function for get_minimal_spanning_set_for_region()... */
@@ -382,8 +410,8 @@ meta_rectangle_get_minimal_spanning_set_for_region (
   /* NOTE FOR OPTIMIZERS: This function *might* be somewhat slow,
    * especially due to the call to merge_spanning_rects_in_region() (which
    * is O(n^2) where n is the size of the list generated in this function).
-   * This is made more onerous due to the fact that it involves a fair
-   * number of memory allocation and deallocation calls.  However, n is 1
+   * The splitting and merging at least work on plain arrays, and pairs of
+   * rectangles that don't touch are rejected early.  However, n is 1
    * for default installations of Gnome (because partial struts aren't used
    * by default and only partial struts increase the size of the spanning
    * set generated).  With one partial strut, n will be 2 or 3.  With 2
@@ -415,10 +443,9 @@ meta_rectangle_get_minimal_spanning_set_for_region (
    *     URL splitting.)
    */
 
-  GList         *ret;
-  GList         *tmp_list;
-  const GSList  *strut_iter;
-  MtkRectangle *temp_rect;
+  g_autoptr (GArray) rects = NULL;
+  g_autoptr (GArray) split_rects = NULL;
+  const GSList *strut_iter;
 
   /* The algorithm is basically as follows:
    *   Initialize rectangle_set to basic_rect
@@ -429,82 +456,82 @@ meta_rectangle_get_minimal_spanning_set_for_region (
    *       - Remove the old (pre-split) rectangle from the rectangle_set,
    *         and replace it with the new rectangles generated from the
    *         splitting
+   *
+   * The rectangle sets are kept in plain arrays that are reused for every
+   * strut, as the splitting would otherwise be dominated by allocating and
+   * freeing a list element and a rectangle for every piece. Each pass walks
+   * the set backwards, and emits the pieces of a rectangle in reverse, so
+   * that the resulting order (which the merging below depends on) is what
+   * repeatedly prepending to a list would give.
    */
 
-  temp_rect = g_new (MtkRectangle, 1);
-  *temp_rect = *basic_rect;
-  ret = g_list_prepend (NULL, temp_rect);
+  rects = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+  split_rects = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+  g_array_append_val (rects, *basic_rect);
 
   for (strut_iter = all_struts; strut_iter; strut_iter = strut_iter->next)
     {
-      GList *rect_iter;
       MetaStrut *strut = (MetaStrut*)strut_iter->data;
       MtkRectangle *strut_rect = &strut->rect;
+      gboolean strut_aligns = check_strut_align (strut, basic_rect);
+      GArray *tmp_rects;
+      int i;
+
+      g_array_set_size (split_rects, 0);
 
-      tmp_list = ret;
-      ret = NULL;
-      rect_iter = tmp_list;
-      while (rect_iter)
+      for (i = (int) rects->len - 1; i >= 0; i--)
         {
-          MtkRectangle *rect = (MtkRectangle*) rect_iter->data;
+          MtkRectangle rect = g_array_index (rects, MtkRectangle, i);
+          MtkRectangle temp_rect;
 
-          if (!mtk_rectangle_overlap (strut_rect, rect) ||
-              !check_strut_align (strut, basic_rect))
-            ret = g_list_prepend (ret, rect);
-          else
+          if (!strut_aligns || !mtk_rectangle_overlap (strut_rect, &rect))
             {
-              /* If there is area in rect left of strut */
-              if (BOX_LEFT (*rect) < BOX_LEFT (*strut_rect))
-                {
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  temp_rect->width = BOX_LEFT (*strut_rect) - BOX_LEFT (*rect);
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              /* If there is area in rect right of strut */
-              if (BOX_RIGHT (*rect) > BOX_RIGHT (*strut_rect))
-                {
-                  int new_x;
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  new_x = BOX_RIGHT (*strut_rect);
-                  temp_rect->width = BOX_RIGHT (*rect) - new_x;
-                  temp_rect->x = new_x;
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              /* If there is area in rect above strut */
-              if (BOX_TOP (*rect) < BOX_TOP (*strut_rect))
-                {
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  temp_rect->height = BOX_TOP (*strut_rect) - BOX_TOP (*rect);
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              /* If there is area in rect below strut */
-              if (BOX_BOTTOM (*rect) > BOX_BOTTOM (*strut_rect))
-                {
-                  int new_y;
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  new_y = BOX_BOTTOM (*strut_rect);
-                  temp_rect->height = BOX_BOTTOM (*rect) - new_y;
-                  temp_rect->y = new_y;
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              g_free (rect);
+              g_array_append_val (split_rects, rect);
+              continue;
+            }
+
+          /* If there is area in rect below strut */
+          if (BOX_BOTTOM (rect) > BOX_BOTTOM (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.y = BOX_BOTTOM (*strut_rect);
+              temp_rect.height = BOX_BOTTOM (rect) - temp_rect.y;
+              g_array_append_val (split_rects, temp_rect);
+            }
+          /* If there is area in rect above strut */
+          if (BOX_TOP (rect) < BOX_TOP (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.height = BOX_TOP (*strut_rect) - BOX_TOP (rect);
+              g_array_append_val (split_rects, temp_rect);
+            }
+          /* If there is area in rect right of strut */
+          if (BOX_RIGHT (rect) > BOX_RIGHT (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.x = BOX_RIGHT (*strut_rect);
+              temp_rect.width = BOX_RIGHT (rect) - temp_rect.x;
+              g_array_append_val (split_rects, temp_rect);
+            }
+          /* If there is area in rect left of strut */
+          if (BOX_LEFT (rect) < BOX_LEFT (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.width = BOX_LEFT (*strut_rect) - BOX_LEFT (rect);
+              g_array_append_val (split_rects, temp_rect);
             }
-          rect_iter = rect_iter->next;
         }
-      g_list_free (tmp_list);
+
+      tmp_rects = rects;
+      rects = split_rects;
+      split_rects = tmp_rects;
     }
 
   /* Sort by maximal area, just because I feel like it... */
-  ret = g_list_sort (ret, compare_rect_areas);
+  g_array_sort (rects, compare_rect_areas);
 
   /* Merge rectangles if possible so that the list really is minimal */
-  ret = merge_spanning_rects_in_region (ret);
-
-  return ret;
+  return merge_spanning_rects_in_region (rects);
 }
 
 /**
@@ -124,6 +124,20 @@ typedef enum
   ACTION_MOVE_AND_RESIZE
 } ActionType;
 
+/* A copy of usable_screen_region with every rectangle expanded by the
+ * given amounts, see meta_rectangle_expand_region_conditionally()
+ */
+typedef struct
+{
+  GList *region;
+  int left_expand;
+  int right_expand;
+  int top_expand;
+  int bottom_expand;
+  int min_x;
+  int min_y;
+} ExpandedRegion;
+
 typedef struct
 {
   MetaBackend *backend;
@@ -157,6 +171,20 @@ typedef struct
   GList  *usable_monitor_region;
 
   MetaMoveResizeFlags  flags;
+
+  /* Derived from the window and its monitor, which don't change while
+   * constraining, but would otherwise be recomputed by every constraint
+   * for every priority in both the enforcing and the checking pass.
+   * The tile area and the expanded regions are set up on first use.
+   */
+  MtkRectangle         min_size;
+  MtkRectangle         max_size;
+
+  gboolean             has_tile_area;
+  MtkRectangle         tile_area;
+
+  ExpandedRegion       titlebar_region;
+  ExpandedRegion       partially_onscreen_region;
 } ConstraintInfo;
 
 static gboolean do_screen_and_monitor_relative_constraints (MetaWindow     *window,
@@ -222,6 +250,7 @@ static void setup_constraint_info        (MetaBackend         *backend,
 static void place_window_if_needed       (MetaWindow     *window,
                                           MetaPlaceFlag   place_flags,
                                           ConstraintInfo *info);
+static void clear_constraint_info        (ConstraintInfo *info);
 static void update_onscreen_requirements (MetaWindow     *window,
                                           ConstraintInfo *info);
 
@@ -251,6 +280,24 @@ static const Constraint all_constraints[] = {
   {NULL,                         NULL}
 };
 
+static inline void
+get_size_limits (MetaWindow   *window,
+                 MtkRectangle *min_size,
+                 MtkRectangle *max_size)
+{
+  /* We pack the results into MtkRectangle structs just for convenience; we
+   * don't actually use the position of those rects.
+   */
+  min_size->x = min_size->y = max_size->x = max_size->y = 0;
+  min_size->width  = window->size_hints.min_width;
+  min_size->height = window->size_hints.min_height;
+  max_size->width  = window->size_hints.max_width;
+  max_size->height = window->size_hints.max_height;
+
+  meta_window_client_rect_to_frame_rect (window, min_size, min_size);
+  meta_window_client_rect_to_frame_rect (window, max_size, max_size);
+}
+
 static gboolean
 do_all_constraints (MetaWindow         *window,
                     ConstraintInfo     *info,
@@ -323,6 +370,9 @@ meta_window_constrain (MetaWindow          *window,
                          new);
   place_window_if_needed (window, place_flags, &info);
 
+  /* Placing may have maximized the window, changing its frame borders */
+  get_size_limits (window, &info.min_size, &info.max_size);
+
   while (!satisfied && priority <= PRIORITY_MAXIMUM) {
     gboolean check_only = TRUE;
 
@@ -349,6 +399,8 @@ meta_window_constrain (MetaWindow          *window,
    * if this was a user move or user move-and-resize operation.
    */
   update_onscreen_requirements (window, &info);
+
+  clear_constraint_info (&info);
 }
 
 static void
@@ -394,6 +446,10 @@ setup_constraint_info (MetaBackend         *backend,
 
   info->resize_gravity = resize_gravity;
 
+  info->has_tile_area = FALSE;
+  info->titlebar_region = (ExpandedRegion) { 0 };
+  info->partially_onscreen_region = (ExpandedRegion) { 0 };
+
   /* FIXME: fixed_directions might be more sane if we (a) made it
    * depend on the grab_op type instead of current amount of movement
    * (thus implying that it only has effect when user_action is true,
@@ -524,6 +580,70 @@ setup_constraint_info (MetaBackend         *backend,
                 info->entire_monitor.width, info->entire_monitor.height);
 }
 
+static void
+clear_constraint_info (ConstraintInfo *info)
+{
+  g_clear_list (&info->titlebar_region.region, g_free);
+  g_clear_list (&info->partially_onscreen_region.region, g_free);
+}
+
+static gpointer
+copy_rectangle (gconstpointer src,
+                gpointer      data)
+{
+  return g_memdup2 (src, sizeof (MtkRectangle));
+}
+
+static GList *
+ensure_expanded_region (ExpandedRegion *expanded,
+                        GList          *region,
+                        int             left_expand,
+                        int             right_expand,
+                        int             top_expand,
+                        int             bottom_expand,
+                        int             min_x,
+                        int             min_y)
+{
+  if (expanded->region &&
+      expanded->left_expand == left_expand &&
+      expanded->right_expand == right_expand &&
+      expanded->top_expand == top_expand &&
+      expanded->bottom_expand == bottom_expand &&
+      expanded->min_x == min_x &&
+      expanded->min_y == min_y)
+    return expanded->region;
+
+  g_clear_list (&expanded->region, g_free);
+  expanded->region = g_list_copy_deep (region, copy_rectangle, NULL);
+  expanded->left_expand = left_expand;
+  expanded->right_expand = right_expand;
+  expanded->top_expand = top_expand;
+  expanded->bottom_expand = bottom_expand;
+  expanded->min_x = min_x;
+  expanded->min_y = min_y;
+
+  return meta_rectangle_expand_region_conditionally (expanded->region,
+                                                     left_expand,
+                                                     right_expand,
+                                                     top_expand,
+                                                     bottom_expand,
+                                                     min_x,
+                                                     min_y);
+}
+
+static const MtkRectangle *
+get_tile_area (MetaWindow     *window,
+               ConstraintInfo *info)
+{
+  if (!info->has_tile_area)
+    {
+      meta_window_get_tile_area (window, window->tile_mode, &info->tile_area);
+      info->has_tile_area = TRUE;
+    }
+
+  return &info->tile_area;
+}
+
 static MtkRectangle *
 get_start_rect_for_resize (MetaWindow     *window,
                            ConstraintInfo *info)
@@ -746,24 +866,6 @@ update_onscreen_requirements (MetaWindow     *window,
 #endif
 }
 
-static inline void
-get_size_limits (MetaWindow   *window,
-                 MtkRectangle *min_size,
-                 MtkRectangle *max_size)
-{
-  /* We pack the results into MtkRectangle structs just for convenience; we
-   * don't actually use the position of those rects.
-   */
-  min_size->x = min_size->y = max_size->x = max_size->y = 0;
-  min_size->width  = window->size_hints.min_width;
-  min_size->height = window->size_hints.min_height;
-  max_size->width  = window->size_hints.max_width;
-  max_size->height = window->size_hints.max_height;
-
-  meta_window_client_rect_to_frame_rect (window, min_size, min_size);
-  meta_window_client_rect_to_frame_rect (window, max_size, max_size);
-}
-
 static void
 placement_rule_flip_horizontally (MetaPlacementRule *placement_rule)
 {
@@ -1212,7 +1314,6 @@ constrain_maximization (MetaWindow         *window,
 {
   MetaWorkspaceManager *workspace_manager = window->display->workspace_manager;
   MtkRectangle target_size;
-  MtkRectangle min_size, max_size;
   gboolean hminbad, vminbad;
   gboolean horiz_equal, vert_equal;
   gboolean constraint_already_satisfied;
@@ -1229,7 +1330,7 @@ constrain_maximization (MetaWindow         *window,
   if (meta_window_is_maximized (window) &&
       window->tile_mode == META_TILE_MAXIMIZED)
     {
-      meta_window_get_tile_area (window, window->tile_mode, &target_size);
+      target_size = *get_tile_area (window, info);
     }
   else if (meta_window_is_maximized (window))
     {
@@ -1263,9 +1364,10 @@ constrain_maximization (MetaWindow         *window,
   /* Check min size constraints; max size constraints are ignored for maximized
    * windows, as per bug 327543.
    */
-  get_size_limits (window, &min_size, &max_size);
-  hminbad = target_size.width < min_size.width && window->maximized_horizontally;
-  vminbad = target_size.height < min_size.height && window->maximized_vertically;
+  hminbad = target_size.width < info->min_size.width &&
+            window->maximized_horizontally;
+  vminbad = target_size.height < info->min_size.height &&
+            window->maximized_vertically;
   if (hminbad || vminbad)
     return TRUE;
 
@@ -1301,7 +1403,6 @@ constrain_tiling (MetaWindow         *window,
                   gboolean            check_only)
 {
   MtkRectangle target_size;
-  MtkRectangle min_size, max_size;
   gboolean hminbad, vminbad;
   gboolean horiz_equal, vert_equal;
   gboolean constraint_already_satisfied;
@@ -1316,14 +1417,13 @@ constrain_tiling (MetaWindow         *window,
   /* Calculate target_size - as the tile previews need this as well, we
    * use an external function for the actual calculation
    */
-  meta_window_get_tile_area (window, window->tile_mode, &target_size);
+  target_size = *get_tile_area (window, info);
 
   /* Check min size constraints; max size constraints are ignored as for
    * maximized windows.
    */
-  get_size_limits (window, &min_size, &max_size);
-  hminbad = target_size.width < min_size.width;
-  vminbad = target_size.height < min_size.height;
+  hminbad = target_size.width < info->min_size.width;
+  vminbad = target_size.height < info->min_size.height;
   if (hminbad || vminbad)
     return TRUE;
 
@@ -1352,7 +1452,7 @@ constrain_fullscreen (MetaWindow         *window,
                       ConstraintPriority  priority,
                       gboolean            check_only)
 {
-  MtkRectangle min_size, max_size, monitor;
+  MtkRectangle monitor;
   gboolean too_big, too_small, constraint_already_satisfied;
 
   if (priority > PRIORITY_FULLSCREEN)
@@ -1364,9 +1464,8 @@ constrain_fullscreen (MetaWindow         *window,
 
   monitor = info->entire_monitor;
 
-  get_size_limits (window, &min_size, &max_size);
-  too_big = !mtk_rectangle_could_fit_rect (&monitor, &min_size);
-  too_small = !mtk_rectangle_could_fit_rect (&max_size, &monitor);
+  too_big = !mtk_rectangle_could_fit_rect (&monitor, &info->min_size);
+  too_small = !mtk_rectangle_could_fit_rect (&info->max_size, &monitor);
   if (too_big || too_small)
     return TRUE;
 
@@ -1479,7 +1578,8 @@ constrain_size_limits (MetaWindow         *window,
     return TRUE;
 
   /* Determine whether constraint is already satisfied; exit if it is */
-  get_size_limits (window, &min_size, &max_size);
+  min_size = info->min_size;
+  max_size = info->max_size;
   /* We ignore max-size limits for maximized windows; see #327543 */
   if (window->maximized_horizontally)
     max_size.width = MAX (max_size.width, info->current.width);
@@ -1654,7 +1754,7 @@ do_screen_and_monitor_relative_constraints (
   gboolean        check_only)
 {
   gboolean exit_early = FALSE, constraint_satisfied;
-  MtkRectangle how_far_it_can_be_smushed, min_size, max_size;
+  MtkRectangle how_far_it_can_be_smushed, min_size;
 
 #ifdef WITH_VERBOSE_MODE
   if (meta_is_verbose ())
@@ -1671,7 +1771,7 @@ do_screen_and_monitor_relative_constraints (
 
   /* Determine whether constraint applies; exit if it doesn't */
   how_far_it_can_be_smushed = info->current;
-  get_size_limits (window, &min_size, &max_size);
+  min_size = info->min_size;
 
   if (info->action_type != ACTION_MOVE)
     {
@@ -1793,7 +1893,7 @@ constrain_titlebar_visible (MetaWindow         *window,
 {
   gboolean unconstrained_user_action;
   gboolean user_nonnorthern_resize;
-  gboolean retval;
+  GList *region;
   int bottom_amount;
   int horiz_amount_offscreen, vert_amount_offscreen;
   int horiz_amount_onscreen,  vert_amount_onscreen;
@@ -1870,30 +1970,23 @@ constrain_titlebar_visible (MetaWindow         *window,
     }
 #endif
 
-  /* Extend the region, have a helper function handle the constraint,
-   * then return the region to its original size.
+  /* Extend the region and have a helper function handle the constraint.
+   * The extended region is kept around, as it is usually the same for the
+   * following priorities and passes.
    */
-  meta_rectangle_expand_region_conditionally (info->usable_screen_region,
-                                              horiz_amount_offscreen,
-                                              horiz_amount_offscreen,
-                                              0, /* Don't let titlebar off */
-                                              bottom_amount,
-                                              horiz_amount_onscreen,
-                                              vert_amount_onscreen);
-  retval =
-    do_screen_and_monitor_relative_constraints (window,
-                                                info->usable_screen_region,
-                                                info,
-                                                check_only);
-  meta_rectangle_expand_region_conditionally (info->usable_screen_region,
-                                              -horiz_amount_offscreen,
-                                              -horiz_amount_offscreen,
-                                              0, /* Don't let titlebar off */
-                                              -bottom_amount,
-                                              horiz_amount_onscreen,
-                                              vert_amount_onscreen);
-
-  return retval;
+  region = ensure_expanded_region (&info->titlebar_region,
+                                   info->usable_screen_region,
+                                   horiz_amount_offscreen,
+                                   horiz_amount_offscreen,
+                                   0, /* Don't let titlebar off */
+                                   bottom_amount,
+                                   horiz_amount_onscreen,
+                                   vert_amount_onscreen);
+
+  return do_screen_and_monitor_relative_constraints (window,
+                                                     region,
+                                                     info,
+                                                     check_only);
 }
 
 static gboolean
@@ -1902,7 +1995,7 @@ constrain_partially_onscreen (MetaWindow         *window,
                               ConstraintPriority  priority,
                               gboolean            check_only)
 {
-  gboolean retval;
+  GList *region;
   int top_amount, bottom_amount;
   int horiz_amount_offscreen, vert_amount_offscreen;
   int horiz_amount_onscreen,  vert_amount_onscreen;
@@ -1951,28 +2044,18 @@ constrain_partially_onscreen (MetaWindow         *window,
     }
 #endif
 
-  /* Extend the region, have a helper function handle the constraint,
-   * then return the region to its original size.
-   */
-  meta_rectangle_expand_region_conditionally (info->usable_screen_region,
-                                              horiz_amount_offscreen,
-                                              horiz_amount_offscreen,
-                                              top_amount,
-                                              bottom_amount,
-                                              horiz_amount_onscreen,
-                                              vert_amount_onscreen);
-  retval =
-    do_screen_and_monitor_relative_constraints (window,
-                                                info->usable_screen_region,
-                                                info,
-                                                check_only);
-  meta_rectangle_expand_region_conditionally (info->usable_screen_region,
-                                              -horiz_amount_offscreen,
-                                              -horiz_amount_offscreen,
-                                              -top_amount,
-                                              -bottom_amount,
-                                              horiz_amount_onscreen,
-                                              vert_amount_onscreen);
-
-  return retval;
+  /* Extend the region and have a helper function handle the constraint */
+  region = ensure_expanded_region (&info->partially_onscreen_region,
+                                   info->usable_screen_region,
+                                   horiz_amount_offscreen,
+                                   horiz_amount_offscreen,
+                                   top_amount,
+                                   bottom_amount,
+                                   horiz_amount_onscreen,
+                                   vert_amount_onscreen);
+
+  return do_screen_and_monitor_relative_constraints (window,
+                                                     region,
+                                                     info,
+                                                     check_only);
 }
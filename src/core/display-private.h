@@ -156,6 +156,11 @@ struct _MetaDisplay
   guint work_area_later;
   guint check_fullscreen_later;
 
+  /* Windows with property notifications held back by a batch */
+  int window_notify_freeze_count;
+  GPtrArray *notify_frozen_windows;
+  guint window_notify_thaw_later;
+
   MetaBell *bell;
   MetaWorkspaceManager *workspace_manager;
 
@@ -310,6 +315,12 @@ gboolean meta_display_apply_startup_properties (MetaDisplay *display,
 void meta_display_queue_workarea_recalc  (MetaDisplay *display);
 void meta_display_queue_check_fullscreen (MetaDisplay *display);
 
+void meta_display_freeze_window_notifications (MetaDisplay *display);
+
+void meta_display_thaw_window_notifications (MetaDisplay *display);
+
+void meta_display_batch_window_notifications_until_redraw (MetaDisplay *display);
+
 MetaWindow *meta_display_get_window_from_id (MetaDisplay *display,
                                              uint64_t     window_id);
 uint64_t    meta_display_generate_window_id (MetaDisplay *display);
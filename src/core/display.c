@@ -202,6 +202,10 @@ static void on_monitors_changed_internal (MetaMonitorManager *monitor_manager,
 static void    prefs_changed_callback    (MetaPreference pref,
                                           void          *data);
 
+static void    prefs_batch_changed_callback (const MetaPreference *prefs,
+                                             size_t                n_prefs,
+                                             gpointer              data);
+
 static int mru_cmp (gconstpointer a,
                     gconstpointer b);
 
@@ -977,6 +981,7 @@ meta_display_new (MetaContext  *context,
   meta_display_init_keys (display);
 
   meta_prefs_add_listener (prefs_changed_callback, display);
+  meta_prefs_add_batch_listener (prefs_batch_changed_callback, display);
 
   /* Get events */
   meta_display_init_events (display);
@@ -1222,10 +1227,20 @@ meta_display_close (MetaDisplay *display,
 
   g_signal_emit (display, display_signals[CLOSING], 0);
 
+  if (display->window_notify_thaw_later)
+    {
+      meta_laters_remove (meta_compositor_get_laters (display->compositor),
+                          display->window_notify_thaw_later);
+      display->window_notify_thaw_later = 0;
+      meta_display_thaw_window_notifications (display);
+    }
+  g_warn_if_fail (display->window_notify_freeze_count == 0);
+
   meta_display_unmanage_windows (display, timestamp);
   meta_compositor_unmanage (display->compositor);
 
   meta_prefs_remove_listener (prefs_changed_callback, display);
+  meta_prefs_remove_batch_listener (prefs_batch_changed_callback, display);
 
   meta_display_remove_autoraise_callback (display);
 
@@ -2328,25 +2343,27 @@ meta_resize_gravity_from_grab_op (MetaGrabOp op)
 void
 meta_display_manage_all_xwindows (MetaDisplay *display)
 {
-  guint64 *_children;
   guint64 *children;
-  int n_children, i;
+  g_autofree Window *xwindows = NULL;
+  int n_children, n_xwindows, i;
 
   meta_stack_freeze (display->stack);
-  meta_stack_tracker_get_stack (display->stack_tracker, &_children, &n_children);
+  meta_stack_tracker_get_stack (display->stack_tracker, &children, &n_children);
 
-  /* Copy the stack as it will be modified as part of the loop */
-  children = g_memdup2 (_children, sizeof (uint64_t) * n_children);
+  /* Copy the stack as it will be modified while managing the windows */
+  xwindows = g_new0 (Window, n_children);
+  n_xwindows = 0;
 
   for (i = 0; i < n_children; ++i)
     {
       if (!META_STACK_ID_IS_X11 (children[i]))
         continue;
-      meta_window_x11_new (display, children[i], TRUE,
-                           META_COMP_EFFECT_NONE);
+      xwindows[n_xwindows++] = (Window) children[i];
     }
 
-  g_free (children);
+  meta_window_x11_new_many (display, xwindows, n_xwindows, TRUE,
+                            META_COMP_EFFECT_NONE);
+
   meta_stack_thaw (display->stack);
 }
 #endif
@@ -2440,6 +2457,55 @@ prefs_changed_callback (MetaPreference pref,
     }
 }
 
+static gboolean
+is_window_preference (MetaPreference pref)
+{
+  switch (pref)
+    {
+    case META_PREF_WORKSPACES_ONLY_ON_PRIMARY:
+    case META_PREF_ATTACH_MODAL_DIALOGS:
+    case META_PREF_FOCUS_MODE:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static void
+prefs_batch_changed_callback (const MetaPreference *prefs,
+                              size_t                n_prefs,
+                              gpointer              data)
+{
+  MetaDisplay *display = data;
+  g_autoptr (GSList) windows = NULL;
+  GSList *l;
+  size_t i;
+
+  for (i = 0; i < n_prefs; i++)
+    {
+      if (is_window_preference (prefs[i]))
+        break;
+    }
+
+  if (i == n_prefs)
+    return;
+
+  /* Walk the windows once per batch, rather than every window listening
+   * for every preference change on its own */
+  windows = meta_display_list_windows (display,
+                                       META_LIST_INCLUDE_OVERRIDE_REDIRECT);
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *window = l->data;
+
+      for (i = 0; i < n_prefs; i++)
+        {
+          if (is_window_preference (prefs[i]))
+            meta_window_prefs_changed (window, prefs[i]);
+        }
+    }
+}
+
 void
 meta_display_sanity_check_timestamps (MetaDisplay *display,
                                       guint32      timestamp)
@@ -2938,6 +3004,10 @@ static void
 on_monitors_changed_internal (MetaMonitorManager *monitor_manager,
                               MetaDisplay        *display)
 {
+  /* Most windows will change monitor, work area and size, partly only when
+   * the queued resizes are processed */
+  meta_display_batch_window_notifications_until_redraw (display);
+
   meta_workspace_manager_reload_work_areas (display->workspace_manager);
 
   /* Fix up monitor for all windows on this display */
@@ -3247,6 +3317,93 @@ meta_display_queue_check_fullscreen (MetaDisplay *display)
                                                      display, NULL);
 }
 
+/**
+ * meta_display_freeze_window_notifications:
+ * @display: a #MetaDisplay
+ *
+ * Holds back property change notifications of all windows on @display
+ * until the matching meta_display_thaw_window_notifications(), when each
+ * changed property is notified once per window. This keeps bulk
+ * operations touching many windows from triggering a cascade of updates
+ * in whatever listens to these notifications.
+ *
+ * Windows created while notifications are frozen are not affected.
+ */
+void
+meta_display_freeze_window_notifications (MetaDisplay *display)
+{
+  g_autoptr (GSList) windows = NULL;
+  GSList *l;
+
+  if (display->window_notify_freeze_count++ > 0)
+    return;
+
+  g_assert (!display->notify_frozen_windows);
+  display->notify_frozen_windows = g_ptr_array_new_with_free_func (g_object_unref);
+
+  windows = meta_display_list_windows (display,
+                                       META_LIST_INCLUDE_OVERRIDE_REDIRECT);
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *window = l->data;
+
+      g_object_freeze_notify (G_OBJECT (window));
+      g_ptr_array_add (display->notify_frozen_windows, g_object_ref (window));
+    }
+}
+
+void
+meta_display_thaw_window_notifications (MetaDisplay *display)
+{
+  g_autoptr (GPtrArray) windows = NULL;
+  unsigned int i;
+
+  g_return_if_fail (display->window_notify_freeze_count > 0);
+
+  if (--display->window_notify_freeze_count > 0)
+    return;
+
+  windows = g_steal_pointer (&display->notify_frozen_windows);
+  for (i = 0; i < windows->len; i++)
+    g_object_thaw_notify (g_ptr_array_index (windows, i));
+}
+
+static gboolean
+thaw_window_notifications_func (gpointer user_data)
+{
+  MetaDisplay *display = user_data;
+
+  display->window_notify_thaw_later = 0;
+  meta_display_thaw_window_notifications (display);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * meta_display_batch_window_notifications_until_redraw:
+ * @display: a #MetaDisplay
+ *
+ * Like meta_display_freeze_window_notifications(), but thaws automatically
+ * right before the next redraw, after queued window updates, such as
+ * resizes and showing or hiding windows, have been processed.
+ */
+void
+meta_display_batch_window_notifications_until_redraw (MetaDisplay *display)
+{
+  MetaLaters *laters;
+
+  if (display->window_notify_thaw_later)
+    return;
+
+  meta_display_freeze_window_notifications (display);
+
+  laters = meta_compositor_get_laters (display->compositor);
+  display->window_notify_thaw_later =
+    meta_laters_add (laters, META_LATER_BEFORE_REDRAW,
+                     thaw_window_notifications_func,
+                     display, NULL);
+}
+
 int
 meta_display_get_monitor_index_for_rect (MetaDisplay  *display,
                                          MtkRectangle *rect)
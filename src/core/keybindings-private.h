@@ -94,6 +94,9 @@ typedef struct
   gboolean      builtin:1;
 } MetaKeyPref;
 
+/* Keycodes are below this in practice, see key_combo_key() */
+#define META_N_DIRECT_INDEXED_KEYCODES 256
+
 typedef struct _MetaKeyBindingKeyboardLayout
 {
   struct xkb_keymap *keymap;
@@ -107,6 +110,9 @@ typedef struct
 
   GHashTable *key_bindings;
   GHashTable *key_bindings_index;
+  /* Number of entries in key_bindings_index per keycode, used to skip the
+   * index lookup for keys without any binding, i.e. most typing */
+  uint16_t n_indexed_keycode_bindings[META_N_DIRECT_INDEXED_KEYCODES];
   xkb_mod_mask_t ignored_modifier_mask;
   xkb_mod_mask_t hyper_mask;
   xkb_mod_mask_t virtual_hyper_mask;
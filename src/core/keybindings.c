@@ -29,6 +29,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "backends/meta-backend-private.h"
 #include "backends/meta-keymap-utils.h"
 #include "backends/meta-logical-monitor.h"
@@ -242,6 +244,35 @@ key_combo_key (MetaResolvedKeyCombo *resolved_combo,
   return (key << 16) | (resolved_combo->mask & 0xffff);
 }
 
+static void
+add_indexed_keycode (MetaKeyBindingManager *keys,
+                     xkb_keycode_t          keycode)
+{
+  if (keycode < META_N_DIRECT_INDEXED_KEYCODES)
+    keys->n_indexed_keycode_bindings[keycode]++;
+}
+
+static void
+remove_indexed_keycode (MetaKeyBindingManager *keys,
+                        xkb_keycode_t          keycode)
+{
+  if (keycode < META_N_DIRECT_INDEXED_KEYCODES)
+    {
+      g_return_if_fail (keys->n_indexed_keycode_bindings[keycode] > 0);
+      keys->n_indexed_keycode_bindings[keycode]--;
+    }
+}
+
+static gboolean
+has_indexed_keycode (MetaKeyBindingManager *keys,
+                     xkb_keycode_t          keycode)
+{
+  if (keycode >= META_N_DIRECT_INDEXED_KEYCODES)
+    return TRUE;
+
+  return keys->n_indexed_keycode_bindings[keycode] > 0;
+}
+
 static void
 reload_modmap (MetaKeyBindingManager *keys)
 {
@@ -597,6 +628,10 @@ index_binding (MetaKeyBindingManager *keys,
                         existing->combo.keysym,
                         binding->resolved_combo.keycodes[i]);
         }
+      else
+        {
+          add_indexed_keycode (keys, binding->resolved_combo.keycodes[i]);
+        }
 
       g_hash_table_replace (keys->key_bindings_index,
                             GINT_TO_POINTER (index_key), binding);
@@ -786,6 +821,8 @@ static void
 reload_combos (MetaKeyBindingManager *keys)
 {
   g_hash_table_remove_all (keys->key_bindings_index);
+  memset (keys->n_indexed_keycode_bindings, 0,
+          sizeof (keys->n_indexed_keycode_bindings));
 
   reload_active_keyboard_layouts (keys);
 
@@ -904,6 +941,9 @@ get_keybinding (MetaKeyBindingManager *keys,
     {
       guint32 key;
 
+      if (!has_indexed_keycode (keys, resolved_combo->keycodes[i]))
+        continue;
+
       key = key_combo_key (resolved_combo, i);
       binding = g_hash_table_lookup (keys->key_bindings_index,
                                      GINT_TO_POINTER (key));
@@ -1340,7 +1380,10 @@ meta_display_ungrab_accelerator (MetaDisplay *display,
       for (i = 0; i < binding->resolved_combo.len; i++)
         {
           guint32 index_key = key_combo_key (&binding->resolved_combo, i);
-          g_hash_table_remove (keys->key_bindings_index, GINT_TO_POINTER (index_key));
+
+          if (g_hash_table_remove (keys->key_bindings_index,
+                                   GINT_TO_POINTER (index_key)))
+            remove_indexed_keycode (keys, binding->resolved_combo.keycodes[i]);
         }
 
       g_hash_table_remove (keys->key_bindings, binding);
@@ -27,10 +27,18 @@
 
 struct _MetaAnonymousFile
 {
+  int ref_count;
+  char *checksum;
+
   int fd;
   size_t size;
 };
 
+/* Files with identical content share the same read-only file, keyed by
+ * content checksum */
+G_LOCK_DEFINE_STATIC (anonymous_files);
+static GHashTable *anonymous_files;
+
 #define READONLY_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE)
 
 static int
@@ -180,6 +188,9 @@ create_anonymous_file (off_t size)
  *
  * When done, free the data using meta_anonymous_file_free().
  *
+ * Files are content-addressed: if a file with identical content already
+ * exists, it is shared instead of creating another one.
+ *
  * If this function fails errno is set.
  *
  * Returns: The newly created #MetaAnonymousFile, or NULL on failure. Use
@@ -190,14 +201,32 @@ meta_anonymous_file_new (size_t         size,
                          const uint8_t *data)
 {
   MetaAnonymousFile *file;
+  g_autofree char *checksum = NULL;
+
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, data, size);
+
+  G_LOCK (anonymous_files);
+
+  if (!anonymous_files)
+    anonymous_files = g_hash_table_new (g_str_hash, g_str_equal);
+
+  file = g_hash_table_lookup (anonymous_files, checksum);
+  if (file && file->size == size)
+    {
+      file->ref_count++;
+      G_UNLOCK (anonymous_files);
+      return file;
+    }
 
   file = g_malloc0 (sizeof *file);
   if (!file)
     {
+      G_UNLOCK (anonymous_files);
       errno = ENOMEM;
       return NULL;
     }
 
+  file->ref_count = 1;
   file->size = size;
   file->fd = create_anonymous_file (size);
   if (file->fd == -1)
@@ -225,11 +254,20 @@ meta_anonymous_file_new (size_t         size,
   fcntl (file->fd, F_ADD_SEALS, READONLY_SEALS);
 #endif
 
+  if (!g_hash_table_contains (anonymous_files, checksum))
+    {
+      file->checksum = g_steal_pointer (&checksum);
+      g_hash_table_insert (anonymous_files, file->checksum, file);
+    }
+
+  G_UNLOCK (anonymous_files);
+
   return file;
 
 err_close:
   close (file->fd);
 err_free:
+  G_UNLOCK (anonymous_files);
   g_free (file);
   return NULL;
 }
@@ -239,12 +277,27 @@ err_free:
  * meta_anonymous_file_free: (skip)
  * @file: the #MetaAnonymousFile
  *
- * Free the resources used by an anonymous read-only file.
+ * Free the resources used by an anonymous read-only file, once every
+ * user sharing the same content has freed it.
  */
 void
 meta_anonymous_file_free (MetaAnonymousFile *file)
 {
+  G_LOCK (anonymous_files);
+
+  if (--file->ref_count > 0)
+    {
+      G_UNLOCK (anonymous_files);
+      return;
+    }
+
+  if (file->checksum)
+    g_hash_table_remove (anonymous_files, file->checksum);
+
+  G_UNLOCK (anonymous_files);
+
   close (file->fd);
+  g_free (file->checksum);
   g_free (file);
 }
 
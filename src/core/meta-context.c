@@ -24,6 +24,7 @@
 #include <sys/resource.h>
 
 #include "backends/meta-backend-private.h"
+#include "compositor/compositor-private.h"
 #include "compositor/meta-plugin-manager.h"
 #include "core/display-private.h"
 #include "core/meta-service-channel.h"
@@ -95,6 +96,9 @@ typedef struct _MetaContextPrivate
 
   GMainLoop *main_loop;
   GError *termination_error;
+
+  int64_t setup_time_us;
+  gulong first_frame_handler_id;
 #ifdef RLIMIT_NOFILE
   struct rlimit saved_rlimit_nofile;
 #endif
@@ -483,6 +487,11 @@ meta_context_setup (MetaContext  *context,
 
   g_warn_if_fail (priv->state == META_CONTEXT_STATE_CONFIGURED);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextSetup,
+                           "Meta::Context::setup()");
+
+  priv->setup_time_us = g_get_monotonic_time ();
+
   if (!priv->plugin_name && priv->plugin_gtype == G_TYPE_NONE)
     {
       priv->state = META_CONTEXT_STATE_TERMINATED;
@@ -498,6 +507,9 @@ meta_context_setup (MetaContext  *context,
              priv->name, VERSION,
              compositor_type_to_description (compositor_type));
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextLoadPlugin,
+                           "Meta::Context::setup#load_plugin()");
+
   if (priv->plugin_name)
     meta_plugin_manager_load (priv->plugin_name);
   else
@@ -505,6 +517,8 @@ meta_context_setup (MetaContext  *context,
 
   init_introspection (context);
 
+  COGL_TRACE_END (MetaContextLoadPlugin);
+
   if (!META_CONTEXT_GET_CLASS (context)->setup (context, error))
     {
       priv->state = META_CONTEXT_STATE_TERMINATED;
@@ -515,25 +529,54 @@ meta_context_setup (MetaContext  *context,
   return TRUE;
 }
 
+static void
+on_first_frame_presented (ClutterStage     *stage,
+                          ClutterStageView *stage_view,
+                          ClutterFrameInfo *frame_info,
+                          MetaContext      *context)
+{
+  MetaContextPrivate *priv = meta_context_get_instance_private (context);
+
+  COGL_TRACE_MESSAGE ("Meta::Context::first_frame()",
+                      "First frame presented %" G_GINT64_FORMAT " ms "
+                      "after setup",
+                      (g_get_monotonic_time () - priv->setup_time_us) / 1000);
+
+  g_clear_signal_handler (&priv->first_frame_handler_id, stage);
+}
+
 gboolean
 meta_context_start (MetaContext  *context,
                     GError      **error)
 {
   MetaContextPrivate *priv = meta_context_get_instance_private (context);
   g_autoptr (GVariant) plugin_options = NULL;
+  MetaCompositor *compositor;
+  ClutterActor *stage;
 
   g_return_val_if_fail (META_IS_CONTEXT (context), FALSE);
 
   g_warn_if_fail (priv->state == META_CONTEXT_STATE_SETUP);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextStart,
+                           "Meta::Context::start()");
+
   meta_prefs_init ();
 
 #ifdef HAVE_WAYLAND
   if (meta_context_get_compositor_type (context) ==
       META_COMPOSITOR_TYPE_WAYLAND)
-    priv->wayland_compositor = meta_wayland_compositor_new (context);
+    {
+      COGL_TRACE_BEGIN_SCOPED (MetaContextStartWayland,
+                               "Meta::Context::start#wayland()");
+
+      priv->wayland_compositor = meta_wayland_compositor_new (context);
+    }
 #endif
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextStartDisplay,
+                           "Meta::Context::start#display()");
+
   plugin_options = g_steal_pointer (&priv->plugin_options),
   priv->display = meta_display_new (context, plugin_options, error);
   if (!priv->display)
@@ -542,6 +585,17 @@ meta_context_start (MetaContext  *context,
       return FALSE;
     }
 
+  COGL_TRACE_END (MetaContextStartDisplay);
+
+  stage = meta_backend_get_stage (priv->backend);
+  priv->first_frame_handler_id =
+    g_signal_connect (stage, "presented",
+                      G_CALLBACK (on_first_frame_presented),
+                      context);
+
+  compositor = meta_display_get_compositor (priv->display);
+  meta_compositor_schedule_prewarm_pipelines (compositor);
+
 #ifdef HAVE_WAYLAND
   priv->service_channel = meta_service_channel_new (context);
 #endif
@@ -865,6 +919,13 @@ meta_context_dispose (GObject *object)
     meta_wayland_compositor_prepare_shutdown (priv->wayland_compositor);
 #endif
 
+  if (priv->backend)
+    {
+      ClutterActor *stage = meta_backend_get_stage (priv->backend);
+
+      g_clear_signal_handler (&priv->first_frame_handler_id, stage);
+    }
+
   if (priv->display)
     meta_display_close (priv->display, META_CURRENT_TIME);
   g_clear_object (&priv->display);
@@ -33,3 +33,5 @@ unsigned int meta_debug_control_get_luminance_percentage (MetaDebugControl *debu
 gboolean meta_debug_control_is_session_management_protocol_enabled (MetaDebugControl *debug_control);
 
 gboolean meta_debug_control_is_hw_cursor_inhibited (MetaDebugControl *debug_control);
+
+gboolean meta_debug_control_is_client_stats_enabled (MetaDebugControl *debug_control);
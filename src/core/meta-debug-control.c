@@ -20,10 +20,22 @@
 
 #include "core/meta-debug-control-private.h"
 
+#include <gio/gunixfdlist.h>
+#include <unistd.h>
+
+#include "backends/meta-backend-private.h"
+#include "backends/meta-renderer.h"
+#include "clutter/clutter-mutter.h"
+#include "compositor/compositor-private.h"
 #include "core/util-private.h"
 #include "meta/meta-backend.h"
 #include "meta/meta-context.h"
 
+#ifdef HAVE_WAYLAND
+#include "wayland/meta-wayland-client-stats.h"
+#include "wayland/meta-wayland-private.h"
+#endif
+
 enum
 {
   PROP_0,
@@ -47,6 +59,8 @@ struct _MetaDebugControl
   gboolean exported;
 
   guint dbus_name_id;
+
+  unsigned int client_stats_annotation_id;
 };
 
 static void meta_dbus_debug_control_iface_init (MetaDBusDebugControlIface *iface);
@@ -57,9 +71,248 @@ G_DEFINE_TYPE_WITH_CODE (MetaDebugControl,
                          G_IMPLEMENT_INTERFACE (META_DBUS_TYPE_DEBUG_CONTROL,
                                                 meta_dbus_debug_control_iface_init))
 
+static gboolean
+handle_get_frame_records (MetaDBusDebugControl  *dbus_debug_control,
+                          GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  GVariantBuilder views_builder;
+  GList *l;
+
+  g_variant_builder_init (&views_builder,
+                          G_VARIANT_TYPE ("a{sa(xxxxxbu)}"));
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      ClutterStageView *view = CLUTTER_STAGE_VIEW (l->data);
+      ClutterFrameClock *frame_clock =
+        clutter_stage_view_get_frame_clock (view);
+      g_autoptr (GArray) records = NULL;
+      GVariantBuilder records_builder;
+      const char *view_name;
+      unsigned int i;
+
+      records = clutter_frame_clock_get_frame_records (frame_clock);
+
+      g_variant_builder_init (&records_builder,
+                              G_VARIANT_TYPE ("a(xxxxxbu)"));
+      for (i = 0; i < records->len; i++)
+        {
+          ClutterFrameRecord *record =
+            &g_array_index (records, ClutterFrameRecord, i);
+
+          g_variant_builder_add (&records_builder, "(xxxxxbu)",
+                                 record->frame_count,
+                                 record->dispatch_time_us,
+                                 record->cpu_duration_us,
+                                 record->gpu_duration_us,
+                                 record->presentation_time_us,
+                                 record->missed_vblank,
+                                 record->kind);
+        }
+
+      view_name = clutter_stage_view_get_name (view);
+      g_variant_builder_add (&views_builder, "{sa(xxxxxbu)}",
+                             view_name ? view_name : "",
+                             &records_builder);
+    }
+
+  meta_dbus_debug_control_complete_get_frame_records (dbus_debug_control,
+                                                      invocation,
+                                                      g_variant_builder_end (&views_builder));
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_get_client_stats (MetaDBusDebugControl  *dbus_debug_control,
+                         GDBusMethodInvocation *invocation)
+{
+  GVariant *client_stats = NULL;
+#ifdef HAVE_WAYLAND
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (debug_control->context);
+
+  if (compositor)
+    client_stats = meta_wayland_compositor_get_client_stats (compositor);
+#endif
+
+  if (!client_stats)
+    client_stats = g_variant_new_array (G_VARIANT_TYPE ("(ittu)"), NULL, 0);
+
+  meta_dbus_debug_control_complete_get_client_stats (dbus_debug_control,
+                                                     invocation,
+                                                     client_stats);
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_get_bypass_decisions (MetaDBusDebugControl  *dbus_debug_control,
+                             GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaDisplay *display = meta_context_get_display (debug_control->context);
+  GVariant *decisions = NULL;
+
+  if (display && meta_display_get_compositor (display))
+    {
+      MetaCompositor *compositor = meta_display_get_compositor (display);
+
+      decisions = meta_compositor_get_bypass_decisions (compositor);
+    }
+
+  if (!decisions)
+    decisions = g_variant_new_array (G_VARIANT_TYPE ("{s(sbuu)}"), NULL, 0);
+
+  meta_dbus_debug_control_complete_get_bypass_decisions (dbus_debug_control,
+                                                         invocation,
+                                                         decisions);
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_get_cache_stats (MetaDBusDebugControl  *dbus_debug_control,
+                        GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaDisplay *display = meta_context_get_display (debug_control->context);
+  GVariant *stats = NULL;
+
+  if (display && meta_display_get_compositor (display))
+    {
+      MetaCompositor *compositor = meta_display_get_compositor (display);
+
+      stats = meta_compositor_get_cache_stats (compositor);
+    }
+
+  if (!stats)
+    stats = g_variant_new_array (G_VARIANT_TYPE ("{s(tu)}"), NULL, 0);
+
+  meta_dbus_debug_control_complete_get_cache_stats (dbus_debug_control,
+                                                    invocation,
+                                                    stats);
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_trim_caches (MetaDBusDebugControl  *dbus_debug_control,
+                    GDBusMethodInvocation *invocation,
+                    const char            *level_string)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaDisplay *display = meta_context_get_display (debug_control->context);
+  MetaCacheTrimLevel level;
+
+  if (g_strcmp0 (level_string, "low") == 0)
+    level = META_CACHE_TRIM_LEVEL_LOW;
+  else if (g_strcmp0 (level_string, "medium") == 0)
+    level = META_CACHE_TRIM_LEVEL_MEDIUM;
+  else if (g_strcmp0 (level_string, "critical") == 0)
+    level = META_CACHE_TRIM_LEVEL_CRITICAL;
+  else
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "Unknown trim level '%s'",
+                                             level_string);
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  if (display && meta_display_get_compositor (display))
+    meta_compositor_trim_caches (meta_display_get_compositor (display), level);
+
+  meta_dbus_debug_control_complete_trim_caches (dbus_debug_control,
+                                                invocation);
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static char *
+annotate_client_stats (gpointer user_data)
+{
+#ifdef HAVE_WAYLAND
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (user_data);
+  MetaWaylandCompositor *compositor;
+  GVariant *client_stats;
+  char *text;
+
+  if (!debug_control->context)
+    return NULL;
+
+  compositor = meta_context_get_wayland_compositor (debug_control->context);
+  if (!compositor)
+    return NULL;
+
+  client_stats = meta_wayland_compositor_get_client_stats (compositor);
+  if (!client_stats)
+    return NULL;
+
+  g_variant_ref_sink (client_stats);
+  text = g_variant_print (client_stats, FALSE);
+  g_variant_unref (client_stats);
+
+  return text;
+#else
+  return NULL;
+#endif
+}
+
+static gboolean
+handle_dump_flight_recorder (MetaDBusDebugControl  *dbus_debug_control,
+                             GDBusMethodInvocation *invocation,
+                             GUnixFDList           *fd_list,
+                             GVariant              *fd_variant)
+{
+  g_autoptr (GError) error = NULL;
+  int fd_index;
+  int fd;
+
+  g_variant_get (fd_variant, "h", &fd_index);
+
+  if (!fd_list || fd_index >= g_unix_fd_list_get_length (fd_list))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "Missing file descriptor");
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  fd = g_unix_fd_list_get (fd_list, fd_index, &error);
+  if (fd == -1)
+    {
+      g_dbus_method_invocation_return_gerror (invocation, error);
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  if (!cogl_dump_flight_recorder_to_fd (fd, "Requested over D-Bus", &error))
+    {
+      close (fd);
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Failed to dump flight recorder: %s",
+                                             error->message);
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  meta_dbus_debug_control_complete_dump_flight_recorder (dbus_debug_control,
+                                                         invocation,
+                                                         NULL);
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
 static void
 meta_dbus_debug_control_iface_init (MetaDBusDebugControlIface *iface)
 {
+  iface->handle_get_frame_records = handle_get_frame_records;
+  iface->handle_get_client_stats = handle_get_client_stats;
+  iface->handle_get_bypass_decisions = handle_get_bypass_decisions;
+  iface->handle_get_cache_stats = handle_get_cache_stats;
+  iface->handle_trim_caches = handle_trim_caches;
+  iface->handle_dump_flight_recorder = handle_dump_flight_recorder;
 }
 
 static void
@@ -92,6 +345,8 @@ meta_debug_control_dispose (GObject *object)
   MetaDebugControl *debug_control = META_DEBUG_CONTROL (object);
 
   g_clear_handle_id (&debug_control->dbus_name_id, g_bus_unown_name);
+  g_clear_handle_id (&debug_control->client_stats_annotation_id,
+                     cogl_remove_flight_recorder_annotation);
 
   G_OBJECT_CLASS (meta_debug_control_parent_class)->dispose (object);
 }
@@ -172,6 +427,7 @@ meta_debug_control_init (MetaDebugControl *debug_control)
            color_management_protocol;
   gboolean session_management_protocol;
   gboolean inhibit_hw_cursor;
+  gboolean client_stats;
 
   color_management_protocol =
     g_strcmp0 (getenv ("MUTTER_DEBUG_COLOR_MANAGEMENT_PROTOCOL"), "1") == 0;
@@ -200,6 +456,14 @@ meta_debug_control_init (MetaDebugControl *debug_control)
     g_strcmp0 (getenv ("MUTTER_DEBUG_INHIBIT_HW_CURSOR"), "1") == 0;
   meta_dbus_debug_control_set_inhibit_hw_cursor (dbus_debug_control,
                                                  inhibit_hw_cursor);
+
+  client_stats = g_strcmp0 (getenv ("MUTTER_DEBUG_CLIENT_STATS"), "1") == 0;
+  meta_dbus_debug_control_set_client_stats (dbus_debug_control, client_stats);
+
+  debug_control->client_stats_annotation_id =
+    cogl_add_flight_recorder_annotation ("Meta::DebugControl::client_stats",
+                                         annotate_client_stats,
+                                         debug_control);
 }
 
 gboolean
@@ -293,3 +557,12 @@ meta_debug_control_is_hw_cursor_inhibited (MetaDebugControl *debug_control)
 
   return meta_dbus_debug_control_get_inhibit_hw_cursor (dbus_debug_control);
 }
+
+gboolean
+meta_debug_control_is_client_stats_enabled (MetaDebugControl *debug_control)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+
+  return meta_dbus_debug_control_get_client_stats (dbus_debug_control);
+}
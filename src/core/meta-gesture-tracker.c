@@ -40,10 +40,9 @@ typedef struct _MetaSequenceInfo MetaSequenceInfo;
 
 struct _MetaSequenceInfo
 {
-  MetaGestureTracker *tracker;
   ClutterEventSequence *sequence;
   MetaSequenceState state;
-  guint autodeny_timeout_id;
+  int64_t autodeny_time_us; /* 0 once the sequence was accepted/denied */
   gfloat start_x;
   gfloat start_y;
 };
@@ -59,7 +58,11 @@ struct _GestureActionData
 
 struct _MetaGestureTrackerPrivate
 {
-  GHashTable *sequences; /* Hashtable of ClutterEventSequence->MetaSequenceInfo */
+  /* Array of MetaSequenceInfo. There are only ever a few touches at the
+   * same time, so looking through them is cheaper than hashing.
+   */
+  GArray *sequences;
+  GSource *autodeny_source;
 
   MetaSequenceState stage_state;
   GArray *stage_gestures; /* Array of GestureActionData */
@@ -97,7 +100,9 @@ meta_gesture_tracker_finalize (GObject *object)
 
   priv = meta_gesture_tracker_get_instance_private (META_GESTURE_TRACKER (object));
 
-  g_hash_table_destroy (priv->sequences);
+  g_array_free (priv->sequences, TRUE);
+  g_source_destroy (priv->autodeny_source);
+  g_source_unref (priv->autodeny_source);
   g_array_free (priv->stage_gestures, TRUE);
   g_list_free (priv->listeners);
 
@@ -172,50 +177,137 @@ meta_gesture_tracker_class_init (MetaGestureTrackerClass *klass)
                   G_TYPE_NONE, 2, G_TYPE_POINTER, G_TYPE_UINT);
 }
 
-static void
-autodeny_sequence (gpointer user_data)
+static int
+find_sequence_index (MetaGestureTrackerPrivate *priv,
+                     ClutterEventSequence      *sequence)
 {
-  MetaSequenceInfo *info = user_data;
+  unsigned int i;
+
+  for (i = 0; i < priv->sequences->len; i++)
+    {
+      MetaSequenceInfo *info = &g_array_index (priv->sequences,
+                                               MetaSequenceInfo, i);
 
-  /* Deny the sequence automatically after the given timeout */
-  if (info->state == META_SEQUENCE_NONE)
-    meta_gesture_tracker_set_sequence_state (info->tracker, info->sequence,
-                                             META_SEQUENCE_REJECTED);
+      if (info->sequence == sequence)
+        return (int) i;
+    }
 
-  info->autodeny_timeout_id = 0;
+  return -1;
 }
 
 static MetaSequenceInfo *
-meta_sequence_info_new (MetaGestureTracker *tracker,
-                        const ClutterEvent *event)
+find_sequence_info (MetaGestureTrackerPrivate *priv,
+                    ClutterEventSequence      *sequence)
 {
-  MetaGestureTrackerPrivate *priv;
-  MetaSequenceInfo *info;
-  guint ms;
+  int index;
 
-  priv = meta_gesture_tracker_get_instance_private (tracker);
-  ms = priv->autodeny_timeout;
+  index = find_sequence_index (priv, sequence);
+  if (index < 0)
+    return NULL;
+
+  return &g_array_index (priv->sequences, MetaSequenceInfo, index);
+}
+
+static void
+update_autodeny_timeout (MetaGestureTracker *tracker)
+{
+  MetaGestureTrackerPrivate *priv =
+    meta_gesture_tracker_get_instance_private (tracker);
+  int64_t ready_time_us = -1;
+  unsigned int i;
+
+  for (i = 0; i < priv->sequences->len; i++)
+    {
+      MetaSequenceInfo *info = &g_array_index (priv->sequences,
+                                               MetaSequenceInfo, i);
+
+      if (info->autodeny_time_us == 0)
+        continue;
+
+      if (ready_time_us < 0 || info->autodeny_time_us < ready_time_us)
+        ready_time_us = info->autodeny_time_us;
+    }
+
+  g_source_set_ready_time (priv->autodeny_source, ready_time_us);
+}
+
+static gboolean
+autodeny_sequences (gpointer user_data)
+{
+  MetaGestureTracker *tracker = user_data;
+  MetaGestureTrackerPrivate *priv =
+    meta_gesture_tracker_get_instance_private (tracker);
+  ClutterEventSequence *expired[16];
+  int64_t now_us;
+  unsigned int n_expired = 0;
+  unsigned int i;
+
+  now_us = g_get_monotonic_time ();
+
+  /* Collect the sequences first, as denying them emits signals */
+  for (i = 0; i < priv->sequences->len && n_expired < G_N_ELEMENTS (expired); i++)
+    {
+      MetaSequenceInfo *info = &g_array_index (priv->sequences,
+                                               MetaSequenceInfo, i);
+
+      if (info->autodeny_time_us != 0 && info->autodeny_time_us <= now_us)
+        expired[n_expired++] = info->sequence;
+    }
+
+  /* Deny the sequences automatically after the given timeout */
+  for (i = 0; i < n_expired; i++)
+    {
+      MetaSequenceInfo *info = find_sequence_info (priv, expired[i]);
+
+      if (info && info->state == META_SEQUENCE_NONE)
+        meta_gesture_tracker_set_sequence_state (tracker, expired[i],
+                                                 META_SEQUENCE_REJECTED);
+    }
 
-  info = g_new0 (MetaSequenceInfo, 1);
-  info->tracker = tracker;
-  info->sequence = clutter_event_get_event_sequence (event);
-  info->state = META_SEQUENCE_NONE;
-  info->autodeny_timeout_id = g_timeout_add_once (ms, autodeny_sequence, info);
+  update_autodeny_timeout (tracker);
+
+  return G_SOURCE_CONTINUE;
+}
 
-  clutter_event_get_coords (event, &info->start_x, &info->start_y);
+static gboolean
+autodeny_source_dispatch (GSource     *source,
+                          GSourceFunc  callback,
+                          gpointer     user_data)
+{
+  g_source_set_ready_time (source, -1);
 
-  return info;
+  return callback (user_data);
 }
 
+static GSourceFuncs autodeny_source_funcs = {
+  .prepare = NULL,
+  .check = NULL,
+  .dispatch = autodeny_source_dispatch,
+  .finalize = NULL,
+};
+
 static void
-meta_sequence_info_free (MetaSequenceInfo *info)
+add_sequence (MetaGestureTracker *tracker,
+              const ClutterEvent *event)
 {
-  g_clear_handle_id (&info->autodeny_timeout_id, g_source_remove);
+  MetaGestureTrackerPrivate *priv =
+    meta_gesture_tracker_get_instance_private (tracker);
+  MetaSequenceInfo info = { 0 };
 
-  if (info->state == META_SEQUENCE_NONE)
-    meta_gesture_tracker_set_sequence_state (info->tracker, info->sequence,
-                                             META_SEQUENCE_REJECTED);
-  g_free (info);
+  info.sequence = clutter_event_get_event_sequence (event);
+  info.state = META_SEQUENCE_NONE;
+  info.autodeny_time_us =
+    g_get_monotonic_time () + priv->autodeny_timeout * G_TIME_SPAN_MILLISECOND;
+
+  clutter_event_get_coords (event, &info.start_x, &info.start_y);
+
+  g_array_append_val (priv->sequences, info);
+
+  /* Sequences added later time out later, so only an idle timeout needs
+   * to be updated.
+   */
+  if (g_source_get_ready_time (priv->autodeny_source) < 0)
+    g_source_set_ready_time (priv->autodeny_source, info.autodeny_time_us);
 }
 
 static gboolean
@@ -261,8 +353,7 @@ meta_gesture_tracker_set_state (MetaGestureTracker *tracker,
                                 MetaSequenceState   state)
 {
   MetaGestureTrackerPrivate *priv;
-  ClutterEventSequence *sequence;
-  GHashTableIter iter;
+  unsigned int i;
 
   priv = meta_gesture_tracker_get_instance_private (tracker);
 
@@ -270,11 +361,15 @@ meta_gesture_tracker_set_state (MetaGestureTracker *tracker,
       !state_is_applicable (priv->stage_state, state))
     return FALSE;
 
-  g_hash_table_iter_init (&iter, priv->sequences);
   priv->stage_state = state;
 
-  while (g_hash_table_iter_next (&iter, (gpointer*) &sequence, NULL))
-    meta_gesture_tracker_set_sequence_state (tracker, sequence, state);
+  for (i = 0; i < priv->sequences->len; i++)
+    {
+      MetaSequenceInfo *info = &g_array_index (priv->sequences,
+                                               MetaSequenceInfo, i);
+
+      meta_gesture_tracker_set_sequence_state (tracker, info->sequence, state);
+    }
 
   return TRUE;
 }
@@ -351,8 +446,14 @@ meta_gesture_tracker_init (MetaGestureTracker *tracker)
   MetaGestureTrackerPrivate *priv;
 
   priv = meta_gesture_tracker_get_instance_private (tracker);
-  priv->sequences = g_hash_table_new_full (NULL, NULL, NULL,
-                                           (GDestroyNotify) meta_sequence_info_free);
+  priv->sequences = g_array_new (FALSE, FALSE, sizeof (MetaSequenceInfo));
+
+  priv->autodeny_source = g_source_new (&autodeny_source_funcs,
+                                        sizeof (GSource));
+  g_source_set_name (priv->autodeny_source, "[mutter] Gesture autodeny");
+  g_source_set_callback (priv->autodeny_source, autodeny_sequences,
+                         tracker, NULL);
+  g_source_attach (priv->autodeny_source, NULL);
   priv->stage_gestures = g_array_new (FALSE, FALSE, sizeof (GestureActionData));
   g_array_set_clear_func (priv->stage_gestures, (GDestroyNotify) clear_gesture_data);
 }
@@ -406,7 +507,8 @@ meta_gesture_tracker_untrack_stage (MetaGestureTracker *tracker)
   priv = meta_gesture_tracker_get_instance_private (tracker);
   priv->stage_state = META_SEQUENCE_NONE;
 
-  g_hash_table_remove_all (priv->sequences);
+  g_array_set_size (priv->sequences, 0);
+  g_source_set_ready_time (priv->autodeny_source, -1);
 
   if (priv->stage_gestures->len > 0)
     g_array_remove_range (priv->stage_gestures, 0, priv->stage_gestures->len);
@@ -424,6 +526,7 @@ meta_gesture_tracker_handle_event (MetaGestureTracker *tracker,
   ClutterEventSequence *sequence;
   MetaSequenceState state;
   MetaSequenceInfo *info;
+  int index;
   gfloat x, y;
 
   sequence = clutter_event_get_event_sequence (event);
@@ -436,11 +539,10 @@ meta_gesture_tracker_handle_event (MetaGestureTracker *tracker,
   switch (clutter_event_type (event))
     {
     case CLUTTER_TOUCH_BEGIN:
-      if (g_hash_table_size (priv->sequences) == 0)
+      if (priv->sequences->len == 0)
         meta_gesture_tracker_track_stage (tracker, CLUTTER_ACTOR (stage));
 
-      info = meta_sequence_info_new (tracker, event);
-      g_hash_table_insert (priv->sequences, sequence, info);
+      add_sequence (tracker, event);
 
       if (priv->stage_gestures->len == 0)
         {
@@ -454,10 +556,12 @@ meta_gesture_tracker_handle_event (MetaGestureTracker *tracker,
           meta_gesture_tracker_set_sequence_state (tracker, sequence,
                                                    priv->stage_state);
         }
-      state = info->state;
+
+      info = find_sequence_info (priv, sequence);
+      state = info ? info->state : META_SEQUENCE_NONE;
       break;
     case CLUTTER_TOUCH_END:
-      info = g_hash_table_lookup (priv->sequences, sequence);
+      info = find_sequence_info (priv, sequence);
 
       if (!info)
         return FALSE;
@@ -469,14 +573,19 @@ meta_gesture_tracker_handle_event (MetaGestureTracker *tracker,
         meta_gesture_tracker_set_sequence_state (tracker, sequence,
                                                  META_SEQUENCE_REJECTED);
 
+      index = find_sequence_index (priv, sequence);
+      if (index < 0)
+        return FALSE;
+
+      info = &g_array_index (priv->sequences, MetaSequenceInfo, index);
       state = info->state;
-      g_hash_table_remove (priv->sequences, sequence);
+      g_array_remove_index_fast (priv->sequences, index);
 
-      if (g_hash_table_size (priv->sequences) == 0)
+      if (priv->sequences->len == 0)
         meta_gesture_tracker_untrack_stage (tracker);
       break;
     case CLUTTER_TOUCH_UPDATE:
-      info = g_hash_table_lookup (priv->sequences, sequence);
+      info = find_sequence_info (priv, sequence);
 
       if (!info)
         return FALSE;
@@ -486,9 +595,13 @@ meta_gesture_tracker_handle_event (MetaGestureTracker *tracker,
       if (info->state == META_SEQUENCE_NONE &&
           (ABS (info->start_x - x) > DISTANCE_THRESHOLD ||
            ABS (info->start_y - y) > DISTANCE_THRESHOLD))
-        meta_gesture_tracker_set_sequence_state (tracker, sequence,
-                                                 META_SEQUENCE_REJECTED);
-      state = info->state;
+        {
+          meta_gesture_tracker_set_sequence_state (tracker, sequence,
+                                                   META_SEQUENCE_REJECTED);
+          info = find_sequence_info (priv, sequence);
+        }
+
+      state = info ? info->state : META_SEQUENCE_NONE;
       break;
     default:
       return FALSE;
@@ -512,7 +625,7 @@ meta_gesture_tracker_set_sequence_state (MetaGestureTracker   *tracker,
   g_return_val_if_fail (META_IS_GESTURE_TRACKER (tracker), FALSE);
 
   priv = meta_gesture_tracker_get_instance_private (tracker);
-  info = g_hash_table_lookup (priv->sequences, sequence);
+  info = find_sequence_info (priv, sequence);
 
   if (!info)
     return FALSE;
@@ -522,17 +635,25 @@ meta_gesture_tracker_set_sequence_state (MetaGestureTracker   *tracker,
   if (!state_is_applicable (info->state, state))
     return FALSE;
 
-  /* Unset autodeny timeout */
-  g_clear_handle_id (&info->autodeny_timeout_id, g_source_remove);
+  /* Unset autodeny timeout. The timeout source is left as is, and finds
+   * nothing to do if this was the next sequence to time out.
+   */
+  info->autodeny_time_us = 0;
 
   info->state = state;
-  g_signal_emit (tracker, signals[STATE_CHANGED], 0, sequence, info->state);
+  g_signal_emit (tracker, signals[STATE_CHANGED], 0, sequence, state);
 
   /* If the sequence was denied, set immediately to PENDING_END after emission */
   if (state == META_SEQUENCE_REJECTED)
     {
-      info->state = META_SEQUENCE_PENDING_END;
-      g_signal_emit (tracker, signals[STATE_CHANGED], 0, sequence, info->state);
+      /* The array may have changed during emission */
+      info = find_sequence_info (priv, sequence);
+      if (info)
+        {
+          info->state = META_SEQUENCE_PENDING_END;
+          g_signal_emit (tracker, signals[STATE_CHANGED], 0,
+                         sequence, info->state);
+        }
     }
 
   return TRUE;
@@ -546,5 +667,5 @@ meta_gesture_tracker_get_n_current_touches (MetaGestureTracker *tracker)
   g_return_val_if_fail (META_IS_GESTURE_TRACKER (tracker), 0);
 
   priv = meta_gesture_tracker_get_instance_private (tracker);
-  return g_hash_table_size (priv->sequences);
+  return (int) priv->sequences->len;
 }
@@ -19,6 +19,7 @@
 
 #include "src/core/meta-profiler.h"
 
+#include <errno.h>
 #include <glib-unix.h>
 #include <glib/gi18n.h>
 #include <gio/gunixfdlist.h>
@@ -27,6 +28,8 @@
 
 #define META_SYSPROF_PROFILER_DBUS_PATH "/org/gnome/Sysprof3/Profiler"
 
+#define FLIGHT_RECORDER_DURATION_US (G_USEC_PER_SEC * 10)
+
 typedef struct
 {
   GMainContext *main_context;
@@ -42,6 +45,7 @@ struct _MetaProfiler
 
   gboolean persistent;
   gboolean running;
+  gboolean flight_recorder_running;
 
   GMutex mutex;
   GList *threads;
@@ -252,6 +256,12 @@ meta_profiler_finalize (GObject *object)
   if (self->persistent)
     cogl_stop_tracing ();
 
+  if (self->flight_recorder_running)
+    {
+      cogl_set_flight_recorder_disabled_on_thread (g_main_context_default ());
+      cogl_stop_flight_recorder ();
+    }
+
   g_cancellable_cancel (self->cancellable);
 
   g_clear_object (&self->cancellable);
@@ -282,6 +292,44 @@ meta_profiler_init (MetaProfiler *self)
              self);
 }
 
+static void
+maybe_start_flight_recorder (MetaProfiler *profiler)
+{
+  const char *dump_dir;
+  g_autofree char *default_dump_dir = NULL;
+
+  /* Unlike a capture started by sysprof, the flight recorder is meant to be
+   * left running, and dumps the last seconds of trace points whenever a
+   * frame misses its deadline or hitches, or when asked to over D-Bus. */
+  dump_dir = g_getenv ("MUTTER_DEBUG_FLIGHT_RECORDER");
+  if (!dump_dir)
+    {
+      /* Catching hitches is pointless without anywhere to put them */
+      if (!g_getenv ("MUTTER_DEBUG_HITCH_BUDGET_MS"))
+        return;
+
+      default_dump_dir = g_build_filename (g_get_user_runtime_dir (),
+                                           "mutter", NULL);
+      if (g_mkdir_with_parents (default_dump_dir, 0700) == -1)
+        {
+          g_warning ("Failed to create flight recorder directory '%s': %s",
+                     default_dump_dir, g_strerror (errno));
+          return;
+        }
+
+      dump_dir = default_dump_dir;
+    }
+
+  if (!*dump_dir)
+    dump_dir = NULL;
+
+  cogl_start_flight_recorder (dump_dir, FLIGHT_RECORDER_DURATION_US);
+  /* Translators: this string will appear in Sysprof */
+  cogl_set_flight_recorder_enabled_on_thread (g_main_context_default (),
+                                              _("Compositor"));
+  profiler->flight_recorder_running = TRUE;
+}
+
 MetaProfiler *
 meta_profiler_new (const char *trace_file)
 {
@@ -289,6 +337,8 @@ meta_profiler_new (const char *trace_file)
 
   profiler = g_object_new (META_TYPE_PROFILER, NULL);
 
+  maybe_start_flight_recorder (profiler);
+
   if (trace_file)
     {
       GMainContext *main_context = g_main_context_default ();
@@ -325,6 +375,8 @@ meta_profiler_register_thread (MetaProfiler *profiler,
                                       thread_info_new (main_context, name));
   if (profiler->running)
     cogl_set_tracing_enabled_on_thread (main_context, name);
+  if (profiler->flight_recorder_running)
+    cogl_set_flight_recorder_enabled_on_thread (main_context, name);
   g_mutex_unlock (&profiler->mutex);
 }
 
@@ -349,6 +401,8 @@ meta_profiler_unregister_thread (MetaProfiler *profiler,
 
   if (profiler->running)
     cogl_set_tracing_disabled_on_thread (main_context);
+  if (profiler->flight_recorder_running)
+    cogl_set_flight_recorder_disabled_on_thread (main_context);
 
   g_mutex_unlock (&profiler->mutex);
 }
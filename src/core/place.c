@@ -430,48 +430,127 @@ avoid_being_obscured_as_second_modal_dialog (MetaWindow    *window,
     }
 }
 
+/* The frame rects of the windows a new window should preferably not
+ * overlap, sorted by their top edge. Looking up overlaps then only needs
+ * to visit the rects whose vertical extent can reach the tested one,
+ * rather than every window, as each candidate position is tested.
+ */
+typedef struct _PlacementObstacles
+{
+  GArray *rects;
+  int max_height;
+} PlacementObstacles;
+
 static gboolean
-rectangle_overlaps_some_window (MtkRectangle *rect,
-                                GList        *windows)
+window_is_placement_obstacle (MetaWindow *window)
 {
-  GList *tmp;
-  MtkRectangle dest;
+  switch (window->type)
+    {
+    case META_WINDOW_DOCK:
+    case META_WINDOW_SPLASHSCREEN:
+    case META_WINDOW_DESKTOP:
+    case META_WINDOW_DIALOG:
+    case META_WINDOW_MODAL_DIALOG:
+    /* override redirect window types: */
+    case META_WINDOW_DROPDOWN_MENU:
+    case META_WINDOW_POPUP_MENU:
+    case META_WINDOW_TOOLTIP:
+    case META_WINDOW_NOTIFICATION:
+    case META_WINDOW_COMBO:
+    case META_WINDOW_DND:
+    case META_WINDOW_OVERRIDE_OTHER:
+      return FALSE;
 
-  tmp = windows;
-  while (tmp != NULL)
+    case META_WINDOW_NORMAL:
+    case META_WINDOW_UTILITY:
+    case META_WINDOW_TOOLBAR:
+    case META_WINDOW_MENU:
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static int
+compare_rect_top (gconstpointer a,
+                  gconstpointer b)
+{
+  const MtkRectangle *rect_a = a;
+  const MtkRectangle *rect_b = b;
+
+  if (rect_a->y < rect_b->y)
+    return -1;
+  else if (rect_a->y > rect_b->y)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+placement_obstacles_init (PlacementObstacles *obstacles,
+                          GList              *windows)
+{
+  GList *l;
+
+  obstacles->rects = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+  obstacles->max_height = 0;
+
+  for (l = windows; l; l = l->next)
     {
-      MetaWindow *other = tmp->data;
+      MetaWindow *other = l->data;
       MtkRectangle other_rect;
 
-      switch (other->type)
-        {
-        case META_WINDOW_DOCK:
-        case META_WINDOW_SPLASHSCREEN:
-        case META_WINDOW_DESKTOP:
-        case META_WINDOW_DIALOG:
-        case META_WINDOW_MODAL_DIALOG:
-	/* override redirect window types: */
-	case META_WINDOW_DROPDOWN_MENU:
-	case META_WINDOW_POPUP_MENU:
-	case META_WINDOW_TOOLTIP:
-	case META_WINDOW_NOTIFICATION:
-	case META_WINDOW_COMBO:
-	case META_WINDOW_DND:
-	case META_WINDOW_OVERRIDE_OTHER:
-          break;
+      if (!window_is_placement_obstacle (other))
+        continue;
 
-        case META_WINDOW_NORMAL:
-        case META_WINDOW_UTILITY:
-        case META_WINDOW_TOOLBAR:
-        case META_WINDOW_MENU:
-          meta_window_get_frame_rect (other, &other_rect);
+      meta_window_get_frame_rect (other, &other_rect);
+      g_array_append_val (obstacles->rects, other_rect);
+      obstacles->max_height = MAX (obstacles->max_height, other_rect.height);
+    }
 
-          if (mtk_rectangle_intersect (rect, &other_rect, &dest))
-            return TRUE;
-          break;
-        }
+  g_array_sort (obstacles->rects, compare_rect_top);
+}
 
-      tmp = tmp->next;
+static void
+placement_obstacles_clear (PlacementObstacles *obstacles)
+{
+  g_clear_pointer (&obstacles->rects, g_array_unref);
+}
+
+static gboolean
+rectangle_overlaps_some_obstacle (MtkRectangle       *rect,
+                                  PlacementObstacles *obstacles)
+{
+  GArray *rects = obstacles->rects;
+  int low, high;
+  int i;
+
+  /* Skip the rects ending above the tested one; none of them can start
+   * more than max_height above it.
+   */
+  low = 0;
+  high = rects->len;
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+      MtkRectangle *other_rect = &g_array_index (rects, MtkRectangle, mid);
+
+      if (other_rect->y + obstacles->max_height <= rect->y)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  for (i = low; i < (int) rects->len; i++)
+    {
+      MtkRectangle *other_rect = &g_array_index (rects, MtkRectangle, i);
+      MtkRectangle dest;
+
+      if (other_rect->y >= rect->y + rect->height)
+        break;
+
+      if (mtk_rectangle_intersect (rect, other_rect, &dest))
+        return TRUE;
     }
 
   return FALSE;
@@ -578,12 +657,15 @@ find_first_fit (MetaWindow         *window,
   GList *below_sorted;
   GList *end_sorted;
   GList *tmp;
+  PlacementObstacles obstacles;
   MtkRectangle rect;
   MtkRectangle work_area;
   gboolean ltr = clutter_get_text_direction () == CLUTTER_TEXT_DIRECTION_LTR;
 
   retval = FALSE;
 
+  placement_obstacles_init (&obstacles, windows);
+
   /* Below each window */
   below_sorted = g_list_copy (windows);
   below_sorted = g_list_sort (below_sorted, ltr ? leftmost_cmp : rightmost_cmp);
@@ -615,7 +697,7 @@ find_first_fit (MetaWindow         *window,
   center_tile_rect_in_area (&rect, &work_area);
 
   if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-      !rectangle_overlaps_some_window (&rect, windows))
+      !rectangle_overlaps_some_obstacle (&rect, &obstacles))
     {
       *new_x = rect.x;
       *new_y = rect.y;
@@ -638,7 +720,7 @@ find_first_fit (MetaWindow         *window,
       rect.y = frame_rect.y + frame_rect.height;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, below_sorted))
+          !rectangle_overlaps_some_obstacle (&rect, &obstacles))
         {
           *new_x = rect.x;
           *new_y = rect.y;
@@ -667,7 +749,7 @@ find_first_fit (MetaWindow         *window,
       rect.y = frame_rect.y;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, end_sorted))
+          !rectangle_overlaps_some_obstacle (&rect, &obstacles))
         {
           *new_x = rect.x;
           *new_y = rect.y;
@@ -681,6 +763,7 @@ find_first_fit (MetaWindow         *window,
     }
 
 out:
+  placement_obstacles_clear (&obstacles);
   g_list_free (below_sorted);
   g_list_free (end_sorted);
   return retval;
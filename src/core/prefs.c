@@ -74,6 +74,7 @@
 static GList *changes = NULL;
 static guint changed_idle;
 static GList *listeners = NULL;
+static GList *batch_listeners = NULL;
 static GHashTable *settings_schemas;
 
 static ClutterModifierType mouse_button_mods = CLUTTER_MOD1_MASK;
@@ -99,6 +100,7 @@ static gboolean gnome_accessibility = FALSE;
 static gboolean gnome_animations = TRUE;
 static gboolean locate_pointer_is_enabled = FALSE;
 static unsigned int check_alive_timeout = 5000;
+static unsigned int idle_refresh_rate_timeout = 10000;
 static char *cursor_theme = NULL;
 /* cursor_size will, when running as an X11 compositing window manager, be the
  * actual cursor size, multiplied with the global window scaling factor. On
@@ -156,6 +158,12 @@ typedef struct
   gpointer data;
 } MetaPrefsListener;
 
+typedef struct
+{
+  MetaPrefsBatchChangedFunc func;
+  gpointer data;
+} MetaPrefsBatchListener;
+
 typedef struct
 {
   const char *key;
@@ -507,6 +515,13 @@ static MetaUintPreference preferences_uint[] =
       },
       &check_alive_timeout,
     },
+    {
+      { "idle-refresh-rate-timeout",
+        SCHEMA_MUTTER,
+        META_PREF_IDLE_REFRESH_RATE_TIMEOUT,
+      },
+      &idle_refresh_rate_timeout,
+    },
     { { NULL, 0, 0 }, NULL },
   };
 
@@ -898,6 +913,69 @@ meta_prefs_remove_listener (MetaPrefsChangedFunc func,
     }
 }
 
+/**
+ * meta_prefs_add_batch_listener: (skip)
+ * @func: a #MetaPrefsBatchChangedFunc
+ * @user_data: data passed to the function
+ *
+ */
+void
+meta_prefs_add_batch_listener (MetaPrefsBatchChangedFunc func,
+                               gpointer                  user_data)
+{
+  MetaPrefsBatchListener *l;
+
+  l = g_new (MetaPrefsBatchListener, 1);
+  l->func = func;
+  l->data = user_data;
+
+  batch_listeners = g_list_prepend (batch_listeners, l);
+}
+
+/**
+ * meta_prefs_remove_batch_listener: (skip)
+ * @func: a #MetaPrefsBatchChangedFunc
+ * @user_data: data passed to the function
+ *
+ */
+void
+meta_prefs_remove_batch_listener (MetaPrefsBatchChangedFunc func,
+                                  gpointer                  user_data)
+{
+  GList *tmp;
+
+  for (tmp = batch_listeners; tmp; tmp = tmp->next)
+    {
+      MetaPrefsBatchListener *l = tmp->data;
+
+      if (l->func == func &&
+          l->data == user_data)
+        {
+          g_free (l);
+          batch_listeners = g_list_delete_link (batch_listeners, tmp);
+
+          return;
+        }
+    }
+}
+
+static void
+emit_batch_changed (const MetaPreference *prefs,
+                    size_t                n_prefs)
+{
+  g_autoptr (GList) copy = NULL;
+  GList *tmp;
+
+  copy = g_list_copy (batch_listeners);
+
+  for (tmp = copy; tmp; tmp = tmp->next)
+    {
+      MetaPrefsBatchListener *l = tmp->data;
+
+      l->func (prefs, n_prefs, l->data);
+    }
+}
+
 static void
 emit_changed (MetaPreference pref)
 {
@@ -929,6 +1007,8 @@ changed_idle_handler (gpointer data)
   GList *tmp;
   GList *copy;
 
+  g_autoptr (GArray) prefs = NULL;
+
   changed_idle = 0;
 
   copy = g_list_copy (changes); /* reentrancy paranoia */
@@ -936,18 +1016,23 @@ changed_idle_handler (gpointer data)
   g_list_free (changes);
   changes = NULL;
 
+  prefs = g_array_new (FALSE, FALSE, sizeof (MetaPreference));
+
   tmp = copy;
   while (tmp != NULL)
     {
       MetaPreference pref = GPOINTER_TO_INT (tmp->data);
 
       emit_changed (pref);
+      g_array_append_val (prefs, pref);
 
       tmp = tmp->next;
     }
 
   g_list_free (copy);
 
+  emit_batch_changed ((const MetaPreference *) prefs->data, prefs->len);
+
   return FALSE;
 }
 
@@ -1688,6 +1773,9 @@ meta_preference_to_string (MetaPreference pref)
 
     case META_PREF_CHECK_ALIVE_TIMEOUT:
       return "CHECK_ALIVE_TIMEOUT";
+
+    case META_PREF_IDLE_REFRESH_RATE_TIMEOUT:
+      return "IDLE_REFRESH_RATE_TIMEOUT";
     }
 
   return "(unknown)";
@@ -2040,6 +2128,12 @@ meta_prefs_get_check_alive_timeout (void)
   return check_alive_timeout;
 }
 
+unsigned int
+meta_prefs_get_idle_refresh_rate_timeout (void)
+{
+  return idle_refresh_rate_timeout;
+}
+
 const char *
 meta_prefs_get_iso_next_group_option (void)
 {
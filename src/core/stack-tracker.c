@@ -79,11 +79,13 @@
  * no longer pending b) if necessary, drop the predicted stacking
  * order to recompute it at the next opportunity.
  *
+ * The stacks are kept as an array along with a reverse-mapping hash
+ * table, so that applying an operation doesn't need to search the
+ * stack for the windows involved.
+ *
  * Possible optimizations:
- *  Keep the stacks as an array + reverse-mapping hash table to avoid
- *    linear lookups.
- *  Keep the stacks as a GList + reverse-mapping hash table to avoid
- *    linear lookups and to make restacking constant-time.
+ *  Keep the stacks as a GList + reverse-mapping hash table to make
+ *    restacking constant-time.
  */
 
 typedef union _MetaStackOp MetaStackOp;
@@ -148,6 +150,22 @@ union _MetaStackOp
   } lower_below;
 };
 
+typedef struct _MetaStackEntry
+{
+  guint64 window;
+  int position;
+} MetaStackEntry;
+
+/* A stack of windows from bottom to top. The positions table maps
+ * windows to their MetaStackEntry; it is only built once a window is
+ * looked up, and then kept up to date as the stack is changed.
+ */
+typedef struct _MetaIndexedStack
+{
+  GArray *windows;
+  GHashTable *positions;
+} MetaIndexedStack;
+
 struct _MetaStackTracker
 {
   MetaDisplay *display;
@@ -160,7 +178,7 @@ struct _MetaStackTracker
 
   /* A combined stack containing X and Wayland windows but without
    * any unverified operations applied. */
-  GArray *verified_stack;
+  MetaIndexedStack *verified_stack;
 
   /* This is a queue of requests we've made to change the stacking order,
    * where we haven't yet gotten a reply back from the server.
@@ -171,7 +189,7 @@ struct _MetaStackTracker
    * on the unverified_predictions we've made subsequent to
    * verified_stack.
    */
-  GArray *predicted_stack;
+  MetaIndexedStack *predicted_stack;
 
   /* Idle function used to sync the compositor's view of the window
    * stack up with our best guess before a frame is drawn.
@@ -256,7 +274,7 @@ meta_stack_tracker_dump (MetaStackTracker *tracker)
   meta_topic (META_DEBUG_STACK, "MetaStackTracker state");
   meta_topic (META_DEBUG_STACK, "  xserver_serial: %ld", tracker->xserver_serial);
   meta_topic (META_DEBUG_STACK, "  verified_stack: ");
-  stack_dump (tracker, tracker->verified_stack);
+  stack_dump (tracker, tracker->verified_stack->windows);
   meta_topic (META_DEBUG_STACK, "  unverified_predictions: [");
   for (l = tracker->unverified_predictions->head; l; l = l->next)
     {
@@ -267,7 +285,7 @@ meta_stack_tracker_dump (MetaStackTracker *tracker)
   if (tracker->predicted_stack)
     {
       meta_topic (META_DEBUG_STACK, "  predicted_stack: ");
-      stack_dump (tracker, tracker->predicted_stack);
+      stack_dump (tracker, tracker->predicted_stack->windows);
     }
 #endif /* WITH_VERBOSE_MODE */
 }
@@ -278,30 +296,150 @@ meta_stack_op_free (MetaStackOp *op)
   g_free (op);
 }
 
-static int
-find_window (GArray  *window_stack,
-             guint64  window)
+static MetaIndexedStack *
+indexed_stack_new (void)
+{
+  MetaIndexedStack *stack;
+
+  stack = g_new0 (MetaIndexedStack, 1);
+  stack->windows = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  return stack;
+}
+
+static MetaIndexedStack *
+indexed_stack_copy (MetaIndexedStack *stack)
+{
+  MetaIndexedStack *copy;
+  guint len = stack->windows->len;
+
+  copy = g_new0 (MetaIndexedStack, 1);
+  copy->windows = g_array_sized_new (FALSE, FALSE, sizeof (guint64), len);
+  g_array_set_size (copy->windows, len);
+  memcpy (copy->windows->data, stack->windows->data, sizeof (guint64) * len);
+
+  return copy;
+}
+
+static void
+indexed_stack_free (MetaIndexedStack *stack)
+{
+  g_clear_pointer (&stack->positions, g_hash_table_unref);
+  g_array_free (stack->windows, TRUE);
+  g_free (stack);
+}
+
+static void
+invalidate_positions (MetaIndexedStack *stack)
+{
+  g_clear_pointer (&stack->positions, g_hash_table_unref);
+}
+
+static void
+insert_position (MetaIndexedStack *stack,
+                 guint64           window,
+                 int               position)
+{
+  MetaStackEntry *entry;
+
+  /* Stack ids are expected to be unique, but keep the bottom-most
+   * position if they aren't, as a linear search would find it */
+  if (g_hash_table_contains (stack->positions, &window))
+    return;
+
+  entry = g_new0 (MetaStackEntry, 1);
+  entry->window = window;
+  entry->position = position;
+  g_hash_table_insert (stack->positions, &entry->window, entry);
+}
+
+static void
+ensure_positions (MetaIndexedStack *stack)
 {
   guint i;
 
-  for (i = 0; i < window_stack->len; i++)
+  if (stack->positions)
+    return;
+
+  stack->positions = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                            NULL, g_free);
+
+  for (i = 0; i < stack->windows->len; i++)
+    insert_position (stack, g_array_index (stack->windows, guint64, i), i);
+}
+
+/* Updates the positions of the windows from first to last, after they
+ * have been moved around in the stack */
+static void
+update_positions (MetaIndexedStack *stack,
+                  int               first,
+                  int               last)
+{
+  int i;
+
+  if (!stack->positions)
+    return;
+
+  for (i = first; i <= last; i++)
     {
-      guint64 current = g_array_index (window_stack, guint64, i);
-      if (current == window)
-        return i;
+      guint64 window = g_array_index (stack->windows, guint64, i);
+      MetaStackEntry *entry;
+
+      entry = g_hash_table_lookup (stack->positions, &window);
+      if (entry)
+        entry->position = i;
     }
+}
+
+static void
+append_window (MetaIndexedStack *stack,
+               guint64           window)
+{
+  g_array_append_val (stack->windows, window);
 
-  return -1;
+  if (stack->positions)
+    insert_position (stack, window, stack->windows->len - 1);
+}
+
+static void
+remove_window (MetaIndexedStack *stack,
+               int               position)
+{
+  if (stack->positions)
+    {
+      guint64 window = g_array_index (stack->windows, guint64, position);
+
+      g_hash_table_remove (stack->positions, &window);
+    }
+
+  g_array_remove_index (stack->windows, position);
+  update_positions (stack, position, stack->windows->len - 1);
+}
+
+static int
+find_window (MetaIndexedStack *stack,
+             guint64           window)
+{
+  MetaStackEntry *entry;
+
+  ensure_positions (stack);
+
+  entry = g_hash_table_lookup (stack->positions, &window);
+  if (!entry)
+    return -1;
+
+  return entry->position;
 }
 
 /* Returns TRUE if stack was changed */
 static gboolean
-move_window_above (GArray    *stack,
-                   guint64    window,
-                   int        old_pos,
-                   int        above_pos,
-                   ApplyFlags apply_flags)
+move_window_above (MetaIndexedStack *indexed_stack,
+                   guint64           window,
+                   int               old_pos,
+                   int               above_pos,
+                   ApplyFlags        apply_flags)
 {
+  GArray *stack = indexed_stack->windows;
   int i;
   gboolean can_restack_this_window =
     (apply_flags & NO_RESTACK_X_WINDOWS) == 0  || !META_STACK_ID_IS_X11 (window);
@@ -330,6 +468,7 @@ move_window_above (GArray    *stack,
         }
 
       g_array_index (stack, guint64, i) = window;
+      update_positions (indexed_stack, old_pos, i);
 
       return i != old_pos;
     }
@@ -357,6 +496,7 @@ move_window_above (GArray    *stack,
         }
 
       g_array_index (stack, guint64, i) = window;
+      update_positions (indexed_stack, i, old_pos);
 
       return i != old_pos;
     }
@@ -368,7 +508,7 @@ move_window_above (GArray    *stack,
 static gboolean
 meta_stack_op_apply (MetaStackTracker *tracker,
                      MetaStackOp      *op,
-                     GArray           *stack,
+                     MetaIndexedStack *stack,
                      ApplyFlags        apply_flags)
 {
   switch (op->any.type)
@@ -395,7 +535,7 @@ meta_stack_op_apply (MetaStackTracker *tracker,
             return FALSE;
           }
 
-        g_array_append_val (stack, op->add.window);
+        append_window (stack, op->add.window);
         return TRUE;
       }
     case STACK_OP_REMOVE:
@@ -420,7 +560,7 @@ meta_stack_op_apply (MetaStackTracker *tracker,
             return FALSE;
           }
 
-        g_array_remove_index (stack, old_pos);
+        remove_window (stack, old_pos);
         return TRUE;
       }
     case STACK_OP_RAISE_ABOVE:
@@ -487,7 +627,7 @@ meta_stack_op_apply (MetaStackTracker *tracker,
           }
         else
           {
-            above_pos = stack->len - 1;
+            above_pos = stack->windows->len - 1;
           }
 
         return move_window_above (stack, op->lower_below.window, old_pos, above_pos,
@@ -499,18 +639,6 @@ meta_stack_op_apply (MetaStackTracker *tracker,
   return FALSE;
 }
 
-static GArray *
-copy_stack (GArray *stack)
-{
-  GArray *copy = g_array_sized_new (FALSE, FALSE, sizeof (guint64), stack->len);
-
-  g_array_set_size (copy, stack->len);
-
-  memcpy (copy->data, stack->data, sizeof (guint64) * stack->len);
-
-  return copy;
-}
-
 #ifdef HAVE_X11_CLIENT
 static void
 query_xserver_stack (MetaDisplay      *display,
@@ -528,12 +656,14 @@ query_xserver_stack (MetaDisplay      *display,
               x11_display->xroot,
               &ignored1, &ignored2, &children, &n_children);
 
-  old_len = tracker->verified_stack->len;
+  old_len = tracker->verified_stack->windows->len;
 
-  g_array_set_size (tracker->verified_stack, old_len + n_children);
+  g_array_set_size (tracker->verified_stack->windows, old_len + n_children);
 
   for (i = 0; i < n_children; i++)
-    g_array_index (tracker->verified_stack, guint64, old_len + i) = children[i];
+    g_array_index (tracker->verified_stack->windows, guint64, old_len + i) = children[i];
+
+  invalidate_positions (tracker->verified_stack);
 
   XFree (children);
 }
@@ -542,23 +672,23 @@ static void
 drop_x11_windows (MetaDisplay      *display,
                   MetaStackTracker *tracker)
 {
-  GArray *new_stack;
+  MetaIndexedStack *new_stack;
   GList *l;
   int i;
 
   tracker->xserver_serial = 0;
 
-  new_stack = g_array_new (FALSE, FALSE, sizeof (guint64));
+  new_stack = indexed_stack_new ();
 
-  for (i = 0; i < tracker->verified_stack->len; i++)
+  for (i = 0; i < tracker->verified_stack->windows->len; i++)
     {
-      guint64 window = g_array_index (tracker->verified_stack, guint64, i);
+      guint64 window = g_array_index (tracker->verified_stack->windows, guint64, i);
 
       if (!META_STACK_ID_IS_X11 (window))
-        g_array_append_val (new_stack, window);
+        append_window (new_stack, window);
     }
 
-  g_array_unref (tracker->verified_stack);
+  indexed_stack_free (tracker->verified_stack);
   tracker->verified_stack = new_stack;
   l = tracker->unverified_predictions->head;
 
@@ -670,7 +800,7 @@ meta_stack_tracker_new (MetaStack *stack)
   tracker->display = stack->display;
   tracker->stack = stack;
 
-  tracker->verified_stack = g_array_new (FALSE, FALSE, sizeof (guint64));
+  tracker->verified_stack = indexed_stack_new ();
   tracker->unverified_predictions = g_queue_new ();
 
 #ifdef HAVE_X11_CLIENT
@@ -704,9 +834,8 @@ meta_stack_tracker_free (MetaStackTracker *tracker)
       meta_laters_remove (laters, tracker->sync_stack_later);
     }
 
-  g_array_free (tracker->verified_stack, TRUE);
-  if (tracker->predicted_stack)
-    g_array_free (tracker->predicted_stack, TRUE);
+  indexed_stack_free (tracker->verified_stack);
+  g_clear_pointer (&tracker->predicted_stack, indexed_stack_free);
 
   g_queue_foreach (tracker->unverified_predictions, (GFunc)meta_stack_op_free, NULL);
   g_queue_free (tracker->unverified_predictions);
@@ -885,11 +1014,7 @@ stack_tracker_event_received (MetaStackTracker *tracker,
 
   if (need_sync)
     {
-      if (tracker->predicted_stack)
-        {
-          g_array_free (tracker->predicted_stack, TRUE);
-          tracker->predicted_stack = NULL;
-        }
+      g_clear_pointer (&tracker->predicted_stack, indexed_stack_free);
 
       meta_stack_tracker_queue_sync_stack (tracker);
     }
@@ -980,6 +1105,27 @@ meta_stack_tracker_is_guard_window (MetaStackTracker *tracker,
 #endif
 }
 
+static MetaIndexedStack *
+get_current_stack (MetaStackTracker *tracker)
+{
+  if (tracker->unverified_predictions->length == 0)
+    return tracker->verified_stack;
+
+  if (tracker->predicted_stack == NULL)
+    {
+      GList *l;
+
+      tracker->predicted_stack = indexed_stack_copy (tracker->verified_stack);
+      for (l = tracker->unverified_predictions->head; l; l = l->next)
+        {
+          MetaStackOp *op = l->data;
+          meta_stack_op_apply (tracker, op, tracker->predicted_stack, APPLY_DEFAULT);
+        }
+    }
+
+  return tracker->predicted_stack;
+}
+
 /**
  * meta_stack_tracker_get_stack:
  * @tracker: a #MetaStackTracker
@@ -1002,33 +1148,14 @@ meta_stack_tracker_get_stack (MetaStackTracker *tracker,
                               guint64         **windows,
 			      int              *n_windows)
 {
-  GArray *stack;
+  MetaIndexedStack *stack;
 
-  if (tracker->unverified_predictions->length == 0)
-    {
-      stack = tracker->verified_stack;
-    }
-  else
-    {
-      if (tracker->predicted_stack == NULL)
-        {
-          GList *l;
-
-          tracker->predicted_stack = copy_stack (tracker->verified_stack);
-          for (l = tracker->unverified_predictions->head; l; l = l->next)
-            {
-              MetaStackOp *op = l->data;
-              meta_stack_op_apply (tracker, op, tracker->predicted_stack, APPLY_DEFAULT);
-            }
-        }
-
-      stack = tracker->predicted_stack;
-    }
+  stack = get_current_stack (tracker);
 
   if (windows)
-    *windows = (guint64 *)stack->data;
+    *windows = (guint64 *)stack->windows->data;
   if (n_windows)
-    *n_windows = stack->len;
+    *n_windows = stack->windows->len;
 }
 
 /**
@@ -1155,23 +1282,21 @@ static Window
 find_x11_sibling_downwards (MetaStackTracker *tracker,
                             guint64           sibling)
 {
+  MetaIndexedStack *stack;
   guint64 *windows;
-  int n_windows;
   int i;
 
   if (META_STACK_ID_IS_X11 (sibling))
     return (Window)sibling;
 
-  meta_stack_tracker_get_stack (tracker,
-                                &windows, &n_windows);
+  stack = get_current_stack (tracker);
+  windows = (guint64 *) stack->windows->data;
 
   /* NB: Children are in order from bottom to top and we
    * want to search downwards for the nearest X window.
    */
 
-  for (i = n_windows - 1; i >= 0; i--)
-    if (windows[i] == sibling)
-      break;
+  i = find_window (stack, sibling);
 
   for (; i >= 0; i--)
     {
@@ -1186,6 +1311,7 @@ static Window
 find_x11_sibling_upwards (MetaStackTracker *tracker,
                           guint64           sibling)
 {
+  MetaIndexedStack *stack;
   guint64 *windows;
   int n_windows;
   int i;
@@ -1193,12 +1319,13 @@ find_x11_sibling_upwards (MetaStackTracker *tracker,
   if (META_STACK_ID_IS_X11 (sibling))
     return (Window)sibling;
 
-  meta_stack_tracker_get_stack (tracker,
-                                &windows, &n_windows);
+  stack = get_current_stack (tracker);
+  windows = (guint64 *) stack->windows->data;
+  n_windows = stack->windows->len;
 
-  for (i = 0; i < n_windows; i++)
-    if (windows[i] == sibling)
-      break;
+  i = find_window (stack, sibling);
+  if (i < 0)
+    return None;
 
   for (; i < n_windows; i++)
     {
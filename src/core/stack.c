@@ -77,6 +77,7 @@ G_DEFINE_TYPE (MetaStack, meta_stack, G_TYPE_OBJECT)
 static void
 meta_stack_init (MetaStack *stack)
 {
+  stack->links = g_hash_table_new (NULL, NULL);
 }
 
 static void
@@ -85,6 +86,7 @@ meta_stack_finalize (GObject *object)
   MetaStack *stack = META_STACK (object);
 
   g_list_free (stack->sorted);
+  g_hash_table_destroy (stack->links);
 
   G_OBJECT_CLASS (meta_stack_parent_class)->finalize (object);
 }
@@ -201,6 +203,7 @@ meta_stack_add (MetaStack  *stack,
     meta_bug ("Window %s had stack position already", window->desc);
 
   stack->sorted = g_list_prepend (stack->sorted, window);
+  g_hash_table_insert (stack->links, window, stack->sorted);
   stack->need_resort = TRUE; /* may not be needed as we add to top */
   stack->need_constrain = TRUE;
   stack->need_relayer = TRUE;
@@ -222,6 +225,7 @@ meta_stack_remove (MetaStack  *stack,
                    MetaWindow *window)
 {
   MetaWorkspaceManager *workspace_manager = window->display->workspace_manager;
+  GList *link;
 
   COGL_TRACE_BEGIN_SCOPED (MetaStackRemove,
                            "Meta::Stack::remove()");
@@ -236,7 +240,12 @@ meta_stack_remove (MetaStack  *stack,
   window->stack_position = -1;
   stack->n_positions -= 1;
 
-  stack->sorted = g_list_remove (stack->sorted, window);
+  link = g_hash_table_lookup (stack->links, window);
+  if (link)
+    {
+      g_hash_table_remove (stack->links, window);
+      stack->sorted = g_list_delete_link (stack->sorted, link);
+    }
 
   g_signal_emit (stack, signals[WINDOW_REMOVED], 0, window);
 
@@ -347,20 +356,23 @@ void
 meta_stack_update_window_tile_matches (MetaStack     *stack,
                                        MetaWorkspace *workspace)
 {
-  GList *windows, *tmp;
+  GList *l;
 
   if (stack->freeze_count > 0)
     return;
 
-  windows = meta_stack_list_windows (stack, workspace);
-  tmp = windows;
-  while (tmp)
+  stack_ensure_sorted (stack);
+
+  /* Computing tile matches only looks at the stack, so there is no need
+   * for a copy of it.
+   */
+  for (l = stack->sorted; l; l = l->next)
     {
-      meta_window_compute_tile_match ((MetaWindow *) tmp->data);
-      tmp = tmp->next;
-    }
+      MetaWindow *window = l->data;
 
-  g_list_free (windows);
+      if (workspace == NULL || meta_window_located_on_workspace (window, workspace))
+        meta_window_compute_tile_match (window);
+    }
 }
 
 /* Front of the layer list is the topmost window,
@@ -876,7 +888,7 @@ meta_stack_get_above (MetaStack  *stack,
 
   stack_ensure_sorted (stack);
 
-  link = g_list_find (stack->sorted, window);
+  link = g_hash_table_lookup (stack->links, window);
   if (link == NULL)
     return NULL;
   if (link->prev == NULL)
@@ -901,7 +913,7 @@ meta_stack_get_below (MetaStack  *stack,
 
   stack_ensure_sorted (stack);
 
-  link = g_list_find (stack->sorted, window);
+  link = g_hash_table_lookup (stack->links, window);
 
   if (link == NULL)
     return NULL;
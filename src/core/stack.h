@@ -59,6 +59,13 @@ struct _MetaStack
   /** The MetaWindows of the windows we manage, sorted in order. */
   GList *sorted;
 
+  /**
+   * The link of each window in the sorted list, to find the windows
+   * next to it without searching the list. Sorting only reorders the
+   * links, so these stay valid until the window is removed.
+   */
+  GHashTable *links;
+
   /**
    * If this is zero, the local stack oughtn't to be brought up to date with
    * the X server's stack, because it is in the middle of being updated.
@@ -37,6 +37,7 @@
 #include "meta/meta-window-config.h"
 #include "meta/compositor.h"
 #include "meta/meta-close-dialog.h"
+#include "meta/prefs.h"
 #include "meta/util.h"
 #include "meta/window.h"
 #include "meta/meta-window-config.h"
@@ -686,6 +687,9 @@ void     meta_window_set_focused_internal (MetaWindow *window,
 
 gboolean meta_window_is_focusable (MetaWindow *window);
 
+void meta_window_prefs_changed (MetaWindow     *window,
+                                MetaPreference  pref);
+
 gboolean meta_window_can_ping (MetaWindow *window);
 
 MetaStackLayer meta_window_calculate_layer (MetaWindow *window);
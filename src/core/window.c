@@ -258,12 +258,10 @@ backend_from_window (MetaWindow *window)
   return meta_context_get_backend (context);
 }
 
-static void
-prefs_changed_callback (MetaPreference pref,
-                        gpointer       data)
+void
+meta_window_prefs_changed (MetaWindow     *window,
+                           MetaPreference  pref)
 {
-  MetaWindow *window = data;
-
   if (pref == META_PREF_WORKSPACES_ONLY_ON_PRIMARY)
     {
       meta_window_on_all_workspaces_changed (window);
@@ -758,7 +756,6 @@ meta_window_init (MetaWindow *window)
 
   priv->suspend_state = META_WINDOW_SUSPEND_STATE_ACTIVE;
   window->stamp = next_window_stamp++;
-  meta_prefs_add_listener (prefs_changed_callback, window);
   window->is_alive = TRUE;
 }
 
@@ -1591,7 +1588,6 @@ meta_window_unmanage (MetaWindow  *window,
 
   META_WINDOW_GET_CLASS (window)->unmanage (window);
 
-  meta_prefs_remove_listener (prefs_changed_callback, window);
   meta_display_queue_check_fullscreen (window->display);
 
   g_signal_emit (window, window_signals[UNMANAGED], 0);
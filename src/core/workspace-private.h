@@ -56,6 +56,12 @@ struct _MetaWorkspace
 
   GHashTable *logical_monitor_data;
 
+  /* Work areas from before they were last invalidated, kept until the
+   * windows affected by the change have been constrained again */
+  GHashTable *old_logical_monitor_data;
+  GList *old_screen_region;
+  unsigned int reconstrain_later_id;
+
   MtkRectangle work_area_screen;
   GList  *screen_region;
   GList  *screen_edges;
@@ -42,6 +42,7 @@
 #include "backends/meta-logical-monitor.h"
 #include "cogl/cogl.h"
 #include "compositor/compositor-private.h"
+#include "compositor/meta-window-actor-private.h"
 #include "core/boxes-private.h"
 #include "core/meta-workspace-manager-private.h"
 #include "core/workspace-private.h"
@@ -53,6 +54,7 @@ static void focus_ancestor_or_mru_window (MetaWorkspace *workspace,
                                           guint32        timestamp);
 static MetaWindow * get_pointer_window (MetaWorkspace *workspace,
                                         MetaWindow    *not_this_one);
+static void ensure_work_areas_validated (MetaWorkspace *workspace);
 
 G_DEFINE_TYPE (MetaWorkspace, meta_workspace, G_TYPE_OBJECT);
 
@@ -81,6 +83,9 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 typedef struct _MetaWorkspaceLogicalMonitorData
 {
+  /* The logical monitor may be gone by the time its old data is looked
+   * at again, so its layout is recorded here too */
+  MtkRectangle logical_monitor_rect;
   GList *logical_monitor_region;
   MtkRectangle logical_monitor_work_area;
 } MetaWorkspaceLogicalMonitorData;
@@ -128,6 +133,7 @@ meta_workspace_ensure_logical_monitor_data (MetaWorkspace      *workspace,
     }
 
   data = g_new0 (MetaWorkspaceLogicalMonitorData, 1);
+  data->logical_monitor_rect = logical_monitor->rect;
   g_hash_table_insert (workspace->logical_monitor_data, logical_monitor, data);
 
   return data;
@@ -139,6 +145,14 @@ meta_workspace_clear_logical_monitor_data (MetaWorkspace *workspace)
   g_clear_pointer (&workspace->logical_monitor_data, g_hash_table_destroy);
 }
 
+static void
+meta_workspace_clear_old_work_areas (MetaWorkspace *workspace)
+{
+  g_clear_pointer (&workspace->old_logical_monitor_data, g_hash_table_destroy);
+  g_clear_pointer (&workspace->old_screen_region,
+                   meta_rectangle_free_list_and_elements);
+}
+
 static void
 meta_workspace_get_property (GObject      *object,
                              guint         prop_id,
@@ -307,6 +321,16 @@ meta_workspace_remove (MetaWorkspace *workspace)
 
   meta_workspace_clear_logical_monitor_data (workspace);
 
+  if (workspace->reconstrain_later_id)
+    {
+      MetaLaters *laters =
+        meta_compositor_get_laters (workspace->display->compositor);
+
+      meta_laters_remove (laters, workspace->reconstrain_later_id);
+      workspace->reconstrain_later_id = 0;
+    }
+  meta_workspace_clear_old_work_areas (workspace);
+
   g_list_free (workspace->mru_list);
   g_list_free (workspace->list_containing_self);
 
@@ -512,6 +536,42 @@ workspace_switch_sound (MetaWorkspace *from,
   meta_workspace_manager_free_workspace_layout (&layout);
 }
 
+/**
+ * meta_workspace_prefetch:
+ * @workspace: a #MetaWorkspace
+ *
+ * Gets the windows of @workspace ready to be shown, for when switching to
+ * it becomes likely, e.g. when a workspace switch gesture or keybinding
+ * starts. X11 windows have their contents, shape and shadow brought up to
+ * date, and Wayland clients are asked to draw a new frame, so the first
+ * frames of the transition don't have to wait for them.
+ */
+void
+meta_workspace_prefetch (MetaWorkspace *workspace)
+{
+  g_autoptr (GList) windows = NULL;
+  GList *l;
+
+  g_return_if_fail (META_IS_WORKSPACE (workspace));
+
+  if (workspace == workspace->manager->active_workspace)
+    return;
+
+  windows = meta_workspace_list_windows (workspace);
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *window = l->data;
+      MetaWindowActor *window_actor;
+
+      if (window->minimized)
+        continue;
+
+      window_actor = meta_window_actor_from_window (window);
+      if (window_actor)
+        meta_window_actor_prefetch (window_actor);
+    }
+}
+
 /**
  * meta_workspace_activate_with_focus:
  * @workspace: a #MetaWorkspace
@@ -566,7 +626,12 @@ meta_workspace_activate_with_focus (MetaWorkspace *workspace,
     meta_window_drag_update_edges (window_drag);
 
   if (workspace->manager->active_workspace)
-    workspace_switch_sound (workspace->manager->active_workspace, workspace);
+    {
+      workspace_switch_sound (workspace->manager->active_workspace, workspace);
+
+      /* Windows of both workspaces get shown or hidden, and focus moves */
+      meta_display_batch_window_notifications_until_redraw (workspace->display);
+    }
 
   /* Note that old can be NULL; e.g. when starting up */
   old = workspace->manager->active_workspace;
@@ -756,11 +821,167 @@ meta_workspace_list_windows (MetaWorkspace *workspace)
   return workspace_windows;
 }
 
+static gboolean
+regions_equal (GList *region,
+               GList *other_region)
+{
+  for (; region && other_region;
+       region = region->next, other_region = other_region->next)
+    {
+      if (!mtk_rectangle_equal (region->data, other_region->data))
+        return FALSE;
+    }
+
+  return region == NULL && other_region == NULL;
+}
+
+static gboolean
+logical_monitor_data_equal (MetaWorkspaceLogicalMonitorData *data,
+                            MetaWorkspaceLogicalMonitorData *other_data)
+{
+  return (mtk_rectangle_equal (&data->logical_monitor_rect,
+                               &other_data->logical_monitor_rect) &&
+          mtk_rectangle_equal (&data->logical_monitor_work_area,
+                               &other_data->logical_monitor_work_area) &&
+          regions_equal (data->logical_monitor_region,
+                         other_data->logical_monitor_region));
+}
+
+static MetaWorkspaceLogicalMonitorData *
+find_logical_monitor_data (GHashTable         *logical_monitor_data,
+                           const MtkRectangle *logical_monitor_rect)
+{
+  GHashTableIter iter;
+  MetaWorkspaceLogicalMonitorData *data;
+
+  if (!logical_monitor_data)
+    return NULL;
+
+  g_hash_table_iter_init (&iter, logical_monitor_data);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &data))
+    {
+      if (mtk_rectangle_equal (&data->logical_monitor_rect,
+                               logical_monitor_rect))
+        return data;
+    }
+
+  return NULL;
+}
+
+/* Collects the layouts of monitors, past and present, whose work area or
+ * usable region differs from before the work areas were invalidated.
+ */
+static GList *
+find_changed_monitor_rects (GHashTable *logical_monitor_data,
+                            GHashTable *other_logical_monitor_data)
+{
+  GHashTableIter iter;
+  MetaWorkspaceLogicalMonitorData *data;
+  GList *changed = NULL;
+
+  if (!logical_monitor_data)
+    return NULL;
+
+  g_hash_table_iter_init (&iter, logical_monitor_data);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &data))
+    {
+      MetaWorkspaceLogicalMonitorData *other_data;
+
+      other_data = find_logical_monitor_data (other_logical_monitor_data,
+                                              &data->logical_monitor_rect);
+      if (!other_data || !logical_monitor_data_equal (data, other_data))
+        changed = g_list_prepend (changed, &data->logical_monitor_rect);
+    }
+
+  return changed;
+}
+
+static gboolean
+is_window_affected (MetaWindow *window,
+                    GList      *changed_monitor_rects)
+{
+  MtkRectangle frame_rect;
+  GList *l;
+
+  frame_rect = meta_window_config_get_rect (window->config);
+
+  for (l = changed_monitor_rects; l; l = l->next)
+    {
+      MtkRectangle *monitor_rect = l->data;
+
+      if (mtk_rectangle_overlap (&frame_rect, monitor_rect))
+        return TRUE;
+
+      if (window->monitor &&
+          mtk_rectangle_equal (&window->monitor->rect, monitor_rect))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+reconstrain_windows_later_func (gpointer user_data)
+{
+  MetaWorkspace *workspace = user_data;
+  GList *changed_monitor_rects;
+  gboolean screen_region_changed;
+  GList *windows, *l;
+
+  workspace->reconstrain_later_id = 0;
+
+  ensure_work_areas_validated (workspace);
+
+  changed_monitor_rects =
+    g_list_concat (find_changed_monitor_rects (workspace->logical_monitor_data,
+                                               workspace->old_logical_monitor_data),
+                   find_changed_monitor_rects (workspace->old_logical_monitor_data,
+                                               workspace->logical_monitor_data));
+  screen_region_changed = !regions_equal (workspace->screen_region,
+                                          workspace->old_screen_region);
+
+  meta_topic (META_DEBUG_WORKAREA,
+              "Work area of workspace %d changed on %u monitor(s)%s",
+              meta_workspace_index (workspace),
+              g_list_length (changed_monitor_rects),
+              screen_region_changed ? ", screen region changed" : "");
+
+  /* Redo the size/position constraints of the windows whose work area
+   * may have changed. The screen region only changes without any of
+   * the monitors changing if the monitor layout changed, and then we
+   * can't tell which windows are affected.
+   */
+  if (changed_monitor_rects || screen_region_changed)
+    {
+      windows = meta_workspace_list_windows (workspace);
+
+      for (l = windows; l != NULL; l = l->next)
+        {
+          MetaWindow *w = l->data;
+
+          if (w->unmanaging)
+            continue;
+
+          if (!changed_monitor_rects ||
+              is_window_affected (w, changed_monitor_rects))
+            meta_window_update_layout (w);
+        }
+
+      g_list_free (windows);
+    }
+
+  /* Some of the monitor rects in the list belong to the old data */
+  g_list_free (changed_monitor_rects);
+  meta_workspace_clear_old_work_areas (workspace);
+
+  return G_SOURCE_REMOVE;
+}
+
 void
 meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
 {
+  MetaLaters *laters;
   MetaWindowDrag *window_drag;
-  GList *windows, *l;
 
   if (workspace->work_areas_invalid)
     {
@@ -783,6 +1004,19 @@ meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
       workspace == workspace->manager->active_workspace)
     meta_window_drag_update_edges (window_drag);
 
+  /* Keep the work areas the windows were last constrained to, to find
+   * out which of them need to be constrained again once the new ones
+   * are known.
+   */
+  if (workspace->reconstrain_later_id == 0)
+    {
+      meta_workspace_clear_old_work_areas (workspace);
+      workspace->old_logical_monitor_data =
+        g_steal_pointer (&workspace->logical_monitor_data);
+      workspace->old_screen_region =
+        g_steal_pointer (&workspace->screen_region);
+    }
+
   meta_workspace_clear_logical_monitor_data (workspace);
 
   workspace_free_all_struts (workspace);
@@ -796,17 +1030,15 @@ meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
 
   workspace->work_areas_invalid = TRUE;
 
-  /* redo the size/position constraints on all windows */
-  windows = meta_workspace_list_windows (workspace);
-
-  for (l = windows; l != NULL; l = l->next)
+  if (workspace->reconstrain_later_id == 0)
     {
-      MetaWindow *w = l->data;
-      meta_window_queue (w, META_QUEUE_MOVE_RESIZE);
+      laters = meta_compositor_get_laters (workspace->display->compositor);
+      workspace->reconstrain_later_id =
+        meta_laters_add (laters, META_LATER_RESIZE,
+                         reconstrain_windows_later_func,
+                         workspace, NULL);
     }
 
-  g_list_free (windows);
-
   meta_display_queue_workarea_recalc (workspace->display);
 }
 
@@ -21,19 +21,148 @@
 
 #include "meta-frame-header.h"
 
+/* Time for CSS transitions triggered by state changes to finish, before a
+ * snapshot is considered representative of the state */
+#define STATE_SETTLE_TIMEOUT_MS 500
+
+typedef struct _MetaFrameHeaderRenderKey
+{
+  int width;
+  int height;
+  int scale;
+  GtkStateFlags state_flags;
+  char *title;
+  gboolean deletable;
+  gboolean resizable;
+  gboolean maximized;
+  gboolean fullscreen;
+} MetaFrameHeaderRenderKey;
+
+typedef struct _MetaFrameHeaderRenderCache
+{
+  MetaFrameHeaderRenderKey key;
+  GskRenderNode *node;
+} MetaFrameHeaderRenderCache;
+
+enum
+{
+  RENDER_CACHE_FOCUSED,
+  RENDER_CACHE_BACKDROP,
+
+  N_RENDER_CACHES
+};
+
 struct _MetaFrameHeader
 {
   GtkWidget parent_instance;
+
+  /* The header as last rendered in focused and backdrop state, so that
+   * toggling between the two, as focus changes do for frames of all but
+   * the focused window, can reuse the previous rendering instead of
+   * snapshotting the whole header bar again. */
+  MetaFrameHeaderRenderCache render_caches[N_RENDER_CACHES];
+
+  int64_t last_state_change_us;
+  guint settle_timeout_id;
+
+  GtkSettings *settings;
+  gulong settings_notify_id;
 };
 
 G_DEFINE_TYPE (MetaFrameHeader, meta_frame_header, GTK_TYPE_WIDGET)
 
+static void
+render_cache_clear (MetaFrameHeaderRenderCache *cache)
+{
+  g_clear_pointer (&cache->node, gsk_render_node_unref);
+  g_clear_pointer (&cache->key.title, g_free);
+}
+
+static void
+meta_frame_header_clear_render_caches (MetaFrameHeader *header)
+{
+  int i;
+
+  for (i = 0; i < N_RENDER_CACHES; i++)
+    render_cache_clear (&header->render_caches[i]);
+}
+
+static void
+get_render_key (MetaFrameHeader          *header,
+                MetaFrameHeaderRenderKey *key)
+{
+  GtkWidget *widget = GTK_WIDGET (header);
+  GtkRoot *root = gtk_widget_get_root (widget);
+
+  *key = (MetaFrameHeaderRenderKey) {
+    .width = gtk_widget_get_width (widget),
+    .height = gtk_widget_get_height (widget),
+    .scale = gtk_widget_get_scale_factor (widget),
+    .state_flags = (gtk_widget_get_state_flags (widget) &
+                    ~GTK_STATE_FLAG_BACKDROP),
+  };
+
+  if (GTK_IS_WINDOW (root))
+    {
+      GtkWindow *window = GTK_WINDOW (root);
+
+      key->title = (char *) gtk_window_get_title (window);
+      key->deletable = gtk_window_get_deletable (window);
+      key->resizable = gtk_window_get_resizable (window);
+      key->maximized = gtk_window_is_maximized (window);
+      key->fullscreen = gtk_window_is_fullscreen (window);
+    }
+}
+
+static gboolean
+render_key_equal (const MetaFrameHeaderRenderKey *key,
+                  const MetaFrameHeaderRenderKey *other)
+{
+  return (key->width == other->width &&
+          key->height == other->height &&
+          key->scale == other->scale &&
+          key->state_flags == other->state_flags &&
+          g_strcmp0 (key->title, other->title) == 0 &&
+          key->deletable == other->deletable &&
+          key->resizable == other->resizable &&
+          key->maximized == other->maximized &&
+          key->fullscreen == other->fullscreen);
+}
+
+static gboolean
+is_state_settled (MetaFrameHeader *header,
+                  GtkStateFlags    state_flags)
+{
+  int64_t settle_time_us;
+
+  /* Hovered and pressed buttons change without the header state changing */
+  if (state_flags & (GTK_STATE_FLAG_PRELIGHT | GTK_STATE_FLAG_ACTIVE))
+    return FALSE;
+
+  settle_time_us = header->last_state_change_us +
+                   STATE_SETTLE_TIMEOUT_MS * G_TIME_SPAN_MILLISECOND;
+
+  return g_get_monotonic_time () >= settle_time_us;
+}
+
+static void
+on_settings_notify (GtkSettings     *settings,
+                    GParamSpec      *pspec,
+                    MetaFrameHeader *header)
+{
+  meta_frame_header_clear_render_caches (header);
+}
+
 static void
 meta_frame_header_dispose (GObject *object)
 {
+  MetaFrameHeader *header = META_FRAME_HEADER (object);
   GtkWidget *widget = GTK_WIDGET (object);
   GtkWidget *child;
 
+  g_clear_handle_id (&header->settle_timeout_id, g_source_remove);
+  meta_frame_header_clear_render_caches (header);
+
   child = gtk_widget_get_first_child (widget);
   if (child)
     gtk_widget_unparent (child);
@@ -97,6 +226,111 @@ meta_frame_header_size_allocate (GtkWidget *widget,
   gtk_widget_size_allocate (child, &child_allocation, baseline);
 }
 
+static void
+meta_frame_header_snapshot (GtkWidget   *widget,
+                            GtkSnapshot *snapshot)
+{
+  MetaFrameHeader *header = META_FRAME_HEADER (widget);
+  MetaFrameHeaderRenderCache *cache;
+  MetaFrameHeaderRenderKey key;
+  GtkSnapshot *child_snapshot;
+  GskRenderNode *node;
+  GtkWidget *child;
+
+  child = gtk_widget_get_first_child (widget);
+  if (!child)
+    return;
+
+  get_render_key (header, &key);
+
+  if (gtk_widget_get_state_flags (widget) & GTK_STATE_FLAG_BACKDROP)
+    cache = &header->render_caches[RENDER_CACHE_BACKDROP];
+  else
+    cache = &header->render_caches[RENDER_CACHE_FOCUSED];
+
+  if (cache->node && render_key_equal (&cache->key, &key))
+    {
+      gtk_snapshot_append_node (snapshot, cache->node);
+      return;
+    }
+
+  if (!is_state_settled (header, key.state_flags))
+    {
+      gtk_widget_snapshot_child (widget, child, snapshot);
+      return;
+    }
+
+  child_snapshot = gtk_snapshot_new ();
+  gtk_widget_snapshot_child (widget, child, child_snapshot);
+  node = gtk_snapshot_free_to_node (child_snapshot);
+  if (!node)
+    return;
+
+  render_cache_clear (cache);
+  cache->key = key;
+  cache->key.title = g_strdup (key.title);
+  cache->node = gsk_render_node_ref (node);
+
+  gtk_snapshot_append_node (snapshot, node);
+  gsk_render_node_unref (node);
+}
+
+static gboolean
+on_state_settled (gpointer user_data)
+{
+  MetaFrameHeader *header = META_FRAME_HEADER (user_data);
+
+  header->settle_timeout_id = 0;
+
+  /* Snapshot again, now that transitions are over, to fill the cache */
+  gtk_widget_queue_draw (GTK_WIDGET (header));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+meta_frame_header_state_flags_changed (GtkWidget     *widget,
+                                       GtkStateFlags  previous_state_flags)
+{
+  MetaFrameHeader *header = META_FRAME_HEADER (widget);
+
+  header->last_state_change_us = g_get_monotonic_time ();
+
+  g_clear_handle_id (&header->settle_timeout_id, g_source_remove);
+  header->settle_timeout_id = g_timeout_add (STATE_SETTLE_TIMEOUT_MS,
+                                             on_state_settled,
+                                             header);
+
+  GTK_WIDGET_CLASS (meta_frame_header_parent_class)->state_flags_changed (widget,
+                                                                          previous_state_flags);
+}
+
+static void
+meta_frame_header_root (GtkWidget *widget)
+{
+  MetaFrameHeader *header = META_FRAME_HEADER (widget);
+
+  GTK_WIDGET_CLASS (meta_frame_header_parent_class)->root (widget);
+
+  /* Theme, color scheme and button layout changes all come through here */
+  header->settings = gtk_widget_get_settings (widget);
+  header->settings_notify_id =
+    g_signal_connect (header->settings, "notify",
+                      G_CALLBACK (on_settings_notify), header);
+}
+
+static void
+meta_frame_header_unroot (GtkWidget *widget)
+{
+  MetaFrameHeader *header = META_FRAME_HEADER (widget);
+
+  g_clear_signal_handler (&header->settings_notify_id, header->settings);
+  header->settings = NULL;
+  meta_frame_header_clear_render_caches (header);
+
+  GTK_WIDGET_CLASS (meta_frame_header_parent_class)->unroot (widget);
+}
+
 static void
 meta_frame_header_class_init (MetaFrameHeaderClass *klass)
 {
@@ -107,6 +341,10 @@ meta_frame_header_class_init (MetaFrameHeaderClass *klass)
 
   widget_class->measure = meta_frame_header_measure;
   widget_class->size_allocate = meta_frame_header_size_allocate;
+  widget_class->snapshot = meta_frame_header_snapshot;
+  widget_class->state_flags_changed = meta_frame_header_state_flags_changed;
+  widget_class->root = meta_frame_header_root;
+  widget_class->unroot = meta_frame_header_unroot;
 }
 
 static void
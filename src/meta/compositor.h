@@ -84,6 +84,12 @@ ClutterActor * meta_compositor_get_window_group (MetaCompositor *compositor);
 META_EXPORT
 GList * meta_compositor_get_window_actors (MetaCompositor *compositor);
 
+META_EXPORT
+void meta_compositor_set_thumbnail_cache (MetaCompositor *compositor,
+                                          int             max_width,
+                                          int             max_height,
+                                          size_t          memory_budget);
+
 META_EXPORT
 ClutterActor * meta_compositor_get_top_window_group (MetaCompositor *compositor);
 
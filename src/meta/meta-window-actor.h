@@ -50,11 +50,28 @@ META_EXPORT
 cairo_surface_t * meta_window_actor_get_image (MetaWindowActor *self,
                                                MtkRectangle    *clip);
 
+META_EXPORT
+void meta_window_actor_get_image_async (MetaWindowActor     *self,
+                                        MtkRectangle        *clip,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data);
+
+META_EXPORT
+cairo_surface_t * meta_window_actor_get_image_finish (MetaWindowActor  *self,
+                                                      GAsyncResult     *result,
+                                                      GError          **error);
+
 META_EXPORT
 ClutterContent * meta_window_actor_paint_to_content (MetaWindowActor  *self,
                                                      MtkRectangle     *clip,
                                                      GError          **error);
 
+META_EXPORT
+ClutterContent * meta_window_actor_create_thumbnail (MetaWindowActor *self,
+                                                     int              max_width,
+                                                     int              max_height);
+
 META_EXPORT
 void meta_window_actor_freeze (MetaWindowActor *self);
 
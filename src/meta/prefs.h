@@ -64,6 +64,8 @@
  * @META_PREF_CENTER_NEW_WINDOWS: center new windows
  * @META_PREF_DRAG_THRESHOLD: drag threshold
  * @META_PREF_LOCATE_POINTER: show pointer location
+ * @META_PREF_CHECK_ALIVE_TIMEOUT: check alive timeout
+ * @META_PREF_IDLE_REFRESH_RATE_TIMEOUT: idle refresh rate timeout
  */
 
 /* Keep in sync with GSettings schemas! */
@@ -103,6 +105,7 @@ typedef enum
   META_PREF_DRAG_THRESHOLD,
   META_PREF_LOCATE_POINTER,
   META_PREF_CHECK_ALIVE_TIMEOUT,
+  META_PREF_IDLE_REFRESH_RATE_TIMEOUT,
 } MetaPreference;
 
 typedef void (* MetaPrefsChangedFunc) (MetaPreference pref,
@@ -116,6 +119,27 @@ META_EXPORT
 void meta_prefs_remove_listener (MetaPrefsChangedFunc func,
                                  gpointer             user_data);
 
+/**
+ * MetaPrefsBatchChangedFunc:
+ * @prefs: (array length=n_prefs): the preferences that changed
+ * @n_prefs: the number of preferences in @prefs
+ * @user_data: data passed to meta_prefs_add_batch_listener()
+ *
+ * Called once for all preferences changed during the same main loop
+ * iteration, after the listeners of the individual preferences.
+ */
+typedef void (* MetaPrefsBatchChangedFunc) (const MetaPreference *prefs,
+                                            size_t                n_prefs,
+                                            gpointer              user_data);
+
+META_EXPORT
+void meta_prefs_add_batch_listener    (MetaPrefsBatchChangedFunc func,
+                                       gpointer                  user_data);
+
+META_EXPORT
+void meta_prefs_remove_batch_listener (MetaPrefsBatchChangedFunc func,
+                                       gpointer                  user_data);
+
 META_EXPORT
 const char* meta_preference_to_string (MetaPreference pref);
 
@@ -480,3 +504,6 @@ GDesktopVisualBellType meta_prefs_get_visual_bell_type (void);
 
 META_EXPORT
 unsigned int meta_prefs_get_check_alive_timeout (void);
+
+META_EXPORT
+unsigned int meta_prefs_get_idle_refresh_rate_timeout (void);
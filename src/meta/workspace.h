@@ -56,6 +56,9 @@ void meta_workspace_get_work_area_all_monitors (MetaWorkspace *workspace,
 META_EXPORT
 void meta_workspace_activate (MetaWorkspace *workspace, guint32 timestamp);
 
+META_EXPORT
+void meta_workspace_prefetch (MetaWorkspace *workspace);
+
 META_EXPORT
 void meta_workspace_activate_with_focus (MetaWorkspace *workspace,
                                          MetaWindow    *focus_this,
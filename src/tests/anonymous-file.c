@@ -123,6 +123,7 @@ main (int    argc,
       char **argv)
 {
   MetaAnonymousFile *file;
+  MetaAnonymousFile *other_file = NULL;
   int fd = -1, other_fd = -1;
   g_autofree char *fd_path = NULL;
 
@@ -145,6 +146,18 @@ main (int    argc,
   if (other_fd != fd)
     goto fail;
 
+  /* Files with identical content should share the same fd, and stay valid
+   * after one of them is freed. */
+  other_file = meta_anonymous_file_new (strlen (teststring) + 1,
+                                        (const uint8_t *) teststring);
+  g_assert_nonnull (other_file);
+  other_fd = meta_anonymous_file_open_fd (other_file,
+                                          META_ANONYMOUS_FILE_MAPMODE_PRIVATE);
+  if (other_fd != fd)
+    goto fail;
+  meta_anonymous_file_close_fd (other_fd);
+  g_clear_pointer (&other_file, meta_anonymous_file_free);
+
   /* If memfd_create was used and we request a MAPMODE_PRIVATE file, all the
    * readonly seals should be set. */
   if (!test_readonly_seals (fd))
@@ -277,6 +290,7 @@ main (int    argc,
       meta_anonymous_file_close_fd (fd);
     if (other_fd > 0)
       meta_anonymous_file_close_fd (other_fd);
+    g_clear_pointer (&other_file, meta_anonymous_file_free);
     meta_anonymous_file_free (file);
     return EXIT_FAILURE;
 }
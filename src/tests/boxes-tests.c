@@ -525,6 +525,94 @@ test_regions_okay (void)
    */
 }
 
+static void
+test_regions_many_struts (void)
+{
+  g_autoslist (MetaStrut) struts = NULL;
+  MtkRectangle basic_rect;
+  GList *region;
+  GList *l;
+  int i, x, y;
+
+  /* Lots of partial struts, like docks of different sizes along the top and
+   * bottom edges, and some along the sides.
+   */
+  basic_rect = MTK_RECTANGLE_INIT (0, 0, 1600, 1200);
+  for (i = 0; i < 16; i++)
+    {
+      struts = g_slist_prepend (struts,
+                                new_meta_strut (i * 100, 0,
+                                                50, 10 + (i % 4) * 10,
+                                                META_SIDE_TOP));
+      struts = g_slist_prepend (struts,
+                                new_meta_strut (i * 100 + 25,
+                                                1200 - 20 - (i % 3) * 20,
+                                                60, 20 + (i % 3) * 20,
+                                                META_SIDE_BOTTOM));
+    }
+  for (i = 0; i < 6; i++)
+    {
+      struts = g_slist_prepend (struts,
+                                new_meta_strut (0, 100 + i * 180,
+                                                30 + (i % 2) * 30, 90,
+                                                META_SIDE_LEFT));
+      struts = g_slist_prepend (struts,
+                                new_meta_strut (1570, 150 + i * 180,
+                                                30, 60,
+                                                META_SIDE_RIGHT));
+    }
+
+  region = meta_rectangle_get_minimal_spanning_set_for_region (&basic_rect,
+                                                               struts);
+  g_assert_nonnull (region);
+
+  for (l = region; l; l = l->next)
+    {
+      MtkRectangle *rect = l->data;
+      GSList *sl;
+      GList *other;
+
+      g_assert_true (mtk_rectangle_contains_rect (&basic_rect, rect));
+
+      for (sl = struts; sl; sl = sl->next)
+        {
+          MetaStrut *strut = sl->data;
+
+          g_assert_false (mtk_rectangle_overlap (&strut->rect, rect));
+        }
+
+      for (other = region; other; other = other->next)
+        {
+          if (other != l)
+            g_assert_false (mtk_rectangle_contains_rect (rect, other->data));
+        }
+    }
+
+  /* Every pixel not covered by a strut must be part of the region */
+  for (y = 0; y < 1200; y += 5)
+    {
+      for (x = 0; x < 1600; x += 5)
+        {
+          MtkRectangle pixel = MTK_RECTANGLE_INIT (x, y, 1, 1);
+          gboolean in_strut = FALSE;
+          GSList *sl;
+
+          for (sl = struts; sl; sl = sl->next)
+            {
+              MetaStrut *strut = sl->data;
+
+              if (mtk_rectangle_overlap (&strut->rect, &pixel))
+                in_strut = TRUE;
+            }
+
+          g_assert_true (in_strut ||
+                         meta_rectangle_contained_in_region (region, &pixel));
+        }
+    }
+
+  meta_rectangle_free_list_and_elements (region);
+}
+
 static void
 test_region_fitting (void)
 {
@@ -1237,6 +1325,8 @@ init_boxes_tests (void)
   init_random_ness ();
 
   g_test_add_func ("/util/boxes/regions-ok", test_regions_okay);
+  g_test_add_func ("/util/boxes/regions-many-struts",
+                   test_regions_many_struts);
   g_test_add_func ("/util/boxes/regions-fitting", test_region_fitting);
 
   g_test_add_func ("/util/boxes/clamp-to-region", test_clamping_to_region);
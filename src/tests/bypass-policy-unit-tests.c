@@ -0,0 +1,134 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "tests/bypass-policy-unit-tests.h"
+
+#include "compositor/meta-bypass-policy.h"
+
+#define MS(ms) ((int64_t) (ms) * 1000)
+
+static gboolean
+update_policy (MetaBypassPolicy *policy,
+               gboolean          is_eligible,
+               int64_t           now_us)
+{
+  gboolean is_bypassed;
+
+  is_bypassed = meta_bypass_policy_should_bypass (policy, is_eligible, now_us);
+  meta_bypass_policy_set_bypassed (policy, is_bypassed, now_us);
+
+  return is_bypassed;
+}
+
+static void
+meta_test_bypass_policy_enter_leave (void)
+{
+  MetaBypassPolicy policy;
+
+  meta_bypass_policy_init (&policy);
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_COMPOSITED);
+
+  g_assert_false (update_policy (&policy, FALSE, MS (1000)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_COMPOSITED);
+
+  /* Nothing stopped bypassing recently, so it starts right away */
+  g_assert_true (update_policy (&policy, TRUE, MS (1016)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_BYPASSED);
+  g_assert_true (update_policy (&policy, TRUE, MS (1032)));
+  g_assert_cmpuint (policy.n_transitions, ==, 1);
+
+  /* And it always stops right away */
+  g_assert_false (update_policy (&policy, FALSE, MS (1048)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_COMPOSITED);
+  g_assert_false (policy.is_bypassed);
+  g_assert_cmpuint (policy.n_transitions, ==, 2);
+}
+
+static void
+meta_test_bypass_policy_hold_off (void)
+{
+  MetaBypassPolicy policy;
+
+  meta_bypass_policy_init (&policy);
+
+  g_assert_true (update_policy (&policy, TRUE, MS (1000)));
+  g_assert_false (update_policy (&policy, FALSE, MS (1100)));
+
+  /* Possible again shortly after stopping, e.g. a notification went away */
+  g_assert_false (update_policy (&policy, TRUE, MS (1200)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_HOLDING_OFF);
+  g_assert_false (update_policy (&policy, TRUE, MS (1400)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_HOLDING_OFF);
+
+  /* Becoming impossible again restarts the hold off period */
+  g_assert_false (update_policy (&policy, FALSE, MS (1420)));
+  g_assert_false (update_policy (&policy, TRUE, MS (1440)));
+  g_assert_false (update_policy (&policy, TRUE, MS (1680)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_HOLDING_OFF);
+
+  g_assert_true (update_policy (&policy, TRUE, MS (1690)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_BYPASSED);
+  g_assert_cmpuint (policy.n_transitions, ==, 3);
+
+  /* Long after stopping, there is nothing to hold off */
+  g_assert_false (update_policy (&policy, FALSE, MS (2000)));
+  g_assert_false (update_policy (&policy, FALSE, MS (5000)));
+  g_assert_true (update_policy (&policy, TRUE, MS (5016)));
+}
+
+static void
+meta_test_bypass_policy_back_off (void)
+{
+  MetaBypassPolicy policy;
+
+  meta_bypass_policy_init (&policy);
+
+  g_assert_true (update_policy (&policy, TRUE, MS (1000)));
+  meta_bypass_policy_notify_failed (&policy, MS (1010));
+  g_assert_false (policy.is_bypassed);
+  g_assert_cmpuint (policy.n_failures, ==, 1);
+
+  g_assert_false (update_policy (&policy, TRUE, MS (1016)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_BACKING_OFF);
+  g_assert_false (update_policy (&policy, TRUE, MS (1100)));
+  g_assert_true (update_policy (&policy, TRUE, MS (1110)));
+
+  /* The time to wait doubles with every failure */
+  meta_bypass_policy_notify_failed (&policy, MS (1120));
+  g_assert_false (update_policy (&policy, TRUE, MS (1300)));
+  g_assert_cmpint (policy.decision, ==, META_BYPASS_DECISION_BACKING_OFF);
+  g_assert_true (update_policy (&policy, TRUE, MS (1320)));
+  g_assert_cmpuint (policy.n_failures, ==, 2);
+
+  /* Until bypassing has worked for a while */
+  g_assert_true (update_policy (&policy, TRUE, MS (2320)));
+  g_assert_cmpuint (policy.n_failures, ==, 0);
+}
+
+void
+init_bypass_policy_tests (void)
+{
+  g_test_add_func ("/compositor/bypass-policy/enter-leave",
+                   meta_test_bypass_policy_enter_leave);
+  g_test_add_func ("/compositor/bypass-policy/hold-off",
+                   meta_test_bypass_policy_hold_off);
+  g_test_add_func ("/compositor/bypass-policy/back-off",
+                   meta_test_bypass_policy_back_off);
+}
@@ -0,0 +1,143 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "tests/cache-registry-unit-tests.h"
+
+#include "compositor/meta-cache-registry.h"
+
+typedef struct _TestCache
+{
+  size_t size;
+  unsigned int n_entries;
+  GString *trim_log;
+  char tag;
+} TestCache;
+
+static void
+get_test_cache_stats (gpointer      user_data,
+                      size_t       *out_size,
+                      unsigned int *out_n_entries)
+{
+  TestCache *cache = user_data;
+
+  *out_size = cache->size;
+  *out_n_entries = cache->n_entries;
+}
+
+static void
+trim_test_cache (MetaCacheTrimLevel level,
+                 gpointer           user_data)
+{
+  TestCache *cache = user_data;
+
+  g_string_append_c (cache->trim_log, cache->tag);
+
+  if (level == META_CACHE_TRIM_LEVEL_LOW)
+    cache->size /= 2;
+  else
+    cache->size = 0;
+}
+
+static void
+meta_test_cache_registry_trim (void)
+{
+  g_autoptr (MetaCacheRegistry) registry = NULL;
+  g_autoptr (GString) trim_log = NULL;
+  TestCache cheap = { 0 };
+  TestCache costly = { 0 };
+  TestCache untrimmable = { 0 };
+
+  trim_log = g_string_new (NULL);
+  cheap = (TestCache) { .size = 1000, .trim_log = trim_log, .tag = 'a' };
+  costly = (TestCache) { .size = 100, .trim_log = trim_log, .tag = 'b' };
+  untrimmable = (TestCache) { .size = 10, .trim_log = trim_log, .tag = 'c' };
+
+  registry = meta_cache_registry_new ();
+  meta_cache_registry_add_cache (registry, "cheap",
+                                 META_CACHE_TRIM_LEVEL_LOW,
+                                 get_test_cache_stats, trim_test_cache,
+                                 &cheap);
+  meta_cache_registry_add_cache (registry, "costly",
+                                 META_CACHE_TRIM_LEVEL_CRITICAL,
+                                 get_test_cache_stats, trim_test_cache,
+                                 &costly);
+  meta_cache_registry_add_cache (registry, "untrimmable",
+                                 META_CACHE_TRIM_LEVEL_LOW,
+                                 get_test_cache_stats, NULL,
+                                 &untrimmable);
+  g_assert_cmpuint (meta_cache_registry_get_total_size (registry), ==, 1110);
+
+  /* Only caches added for the level or a lower one are trimmed */
+  meta_cache_registry_trim (registry, META_CACHE_TRIM_LEVEL_LOW);
+  g_assert_cmpstr (trim_log->str, ==, "a");
+  g_assert_cmpuint (meta_cache_registry_get_total_size (registry), ==, 610);
+
+  meta_cache_registry_trim (registry, META_CACHE_TRIM_LEVEL_MEDIUM);
+  g_assert_cmpstr (trim_log->str, ==, "aa");
+  g_assert_cmpuint (meta_cache_registry_get_total_size (registry), ==, 110);
+
+  /* In the order they were added */
+  meta_cache_registry_trim (registry, META_CACHE_TRIM_LEVEL_CRITICAL);
+  g_assert_cmpstr (trim_log->str, ==, "aaab");
+  g_assert_cmpuint (meta_cache_registry_get_total_size (registry), ==, 10);
+}
+
+static void
+meta_test_cache_registry_stats (void)
+{
+  g_autoptr (MetaCacheRegistry) registry = NULL;
+  g_autoptr (GVariant) stats = NULL;
+  TestCache glyphs = { .size = 4096, .n_entries = 12 };
+  TestCache pipelines = { .n_entries = 3 };
+  uint64_t size;
+  unsigned int n_entries;
+
+  registry = meta_cache_registry_new ();
+  meta_cache_registry_add_cache (registry, "glyphs",
+                                 META_CACHE_TRIM_LEVEL_LOW,
+                                 get_test_cache_stats, NULL,
+                                 &glyphs);
+  meta_cache_registry_add_cache (registry, "pipelines",
+                                 META_CACHE_TRIM_LEVEL_LOW,
+                                 get_test_cache_stats, NULL,
+                                 &pipelines);
+
+  stats = g_variant_ref_sink (meta_cache_registry_get_stats (registry));
+  g_assert_cmpuint (g_variant_n_children (stats), ==, 2);
+
+  g_assert_true (g_variant_lookup (stats, "glyphs", "(tu)",
+                                   &size, &n_entries));
+  g_assert_cmpuint (size, ==, 4096);
+  g_assert_cmpuint (n_entries, ==, 12);
+
+  g_assert_true (g_variant_lookup (stats, "pipelines", "(tu)",
+                                   &size, &n_entries));
+  g_assert_cmpuint (size, ==, 0);
+  g_assert_cmpuint (n_entries, ==, 3);
+}
+
+void
+init_cache_registry_tests (void)
+{
+  g_test_add_func ("/compositor/cache-registry/trim",
+                   meta_test_cache_registry_trim);
+  g_test_add_func ("/compositor/cache-registry/stats",
+                   meta_test_cache_registry_stats);
+}
@@ -93,6 +93,12 @@ clutter_test_get_context (void)
   return meta_backend_get_clutter_context (backend);
 }
 
+MetaContext *
+clutter_test_get_meta_context (void)
+{
+  return test_environ->context;
+}
+
 ClutterBackend *
 clutter_test_get_backend (void)
 {
@@ -124,6 +124,9 @@ ClutterActor *  clutter_test_get_stage          (void);
 CLUTTER_EXPORT
 ClutterContext * clutter_test_get_context       (void);
 
+CLUTTER_EXPORT
+MetaContext    * clutter_test_get_meta_context  (void);
+
 CLUTTER_EXPORT
 ClutterBackend * clutter_test_get_backend       (void);
 
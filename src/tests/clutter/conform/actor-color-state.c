@@ -147,9 +147,47 @@ actor_unset_color_state (void)
   clutter_actor_destroy (actor);
 }
 
+/* color states with identical parameters are shared */
+static void
+actor_shared_color_state (void)
+{
+  ClutterContext *context = clutter_test_get_context ();
+  g_autoptr (ClutterColorState) color_state = NULL;
+  g_autoptr (ClutterColorState) same_color_state = NULL;
+  g_autoptr (ClutterColorState) other_color_state = NULL;
+  ClutterActor *actor;
+  ClutterActor *other_actor;
+
+  color_state = clutter_color_state_params_new (context,
+                                                CLUTTER_COLORSPACE_BT2020,
+                                                CLUTTER_TRANSFER_FUNCTION_PQ);
+  same_color_state = clutter_color_state_params_new (context,
+                                                     CLUTTER_COLORSPACE_BT2020,
+                                                     CLUTTER_TRANSFER_FUNCTION_PQ);
+  other_color_state = clutter_color_state_params_new (context,
+                                                      CLUTTER_COLORSPACE_BT2020,
+                                                      CLUTTER_TRANSFER_FUNCTION_LINEAR);
+
+  g_assert_true (color_state == same_color_state);
+  g_assert_true (color_state != other_color_state);
+
+  actor = clutter_actor_new ();
+  other_actor = clutter_actor_new ();
+
+  clutter_actor_set_color_state (actor, color_state);
+  clutter_actor_set_color_state (other_actor, same_color_state);
+
+  g_assert_true (clutter_actor_get_color_state (actor) ==
+                 clutter_actor_get_color_state (other_actor));
+
+  clutter_actor_destroy (other_actor);
+  clutter_actor_destroy (actor);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/color-state-default", actor_color_state_default)
   CLUTTER_TEST_UNIT ("/actor/color-state-passed", actor_color_state_passed)
   CLUTTER_TEST_UNIT ("/actor/change-color-state", actor_change_color_state)
   CLUTTER_TEST_UNIT ("/actor/unset-color-state", actor_unset_color_state)
+  CLUTTER_TEST_UNIT ("/actor/shared-color-state", actor_shared_color_state)
 )
@@ -192,6 +192,8 @@ static gboolean
 verify_redraws (gpointer user_data)
 {
   Data *data = user_data;
+  ClutterActor *clones[3];
+  unsigned int i;
 
   clutter_actor_set_offscreen_redirect (data->container,
                                         CLUTTER_OFFSCREEN_REDIRECT_ALWAYS);
@@ -210,10 +212,42 @@ verify_redraws (gpointer user_data)
   clutter_actor_set_translation (data->parent_container, 0.f, -1.f, 0.f);
   verify_redraw (data, 0);
 
+  /* Neither should modifying the transformation of the actor itself */
+  clutter_actor_set_translation (data->container, 1.f, 0.f, 0.f);
+  verify_redraw (data, 0);
+
+  clutter_actor_set_scale (data->container, 0.5, 0.5);
+  verify_redraw (data, 0);
+
   /* Redrawing an unrelated actor shouldn't cause a redraw */
   clutter_actor_set_position (data->unrelated_actor, 0, 1);
   verify_redraw (data, 0);
 
+  /* Without clones, an actor redirected for clones is painted directly */
+  clutter_actor_set_offscreen_redirect (data->container,
+                                        CLUTTER_OFFSCREEN_REDIRECT_FOR_CLONES);
+  verify_redraw (data, 1);
+  verify_redraw (data, 1);
+
+  /* With clones, it is painted once and the clones reuse the image */
+  for (i = 0; i < G_N_ELEMENTS (clones); i++)
+    {
+      clones[i] = clutter_clone_new (data->container);
+      clutter_actor_set_position (clones[i], 100 * (i + 1), 0);
+      clutter_actor_add_child (data->stage, clones[i]);
+    }
+  verify_redraw (data, 1);
+  verify_redraw (data, 0);
+
+  /* Until its contents change */
+  clutter_actor_queue_redraw (data->child);
+  verify_redraw (data, 1);
+
+  for (i = 0; i < G_N_ELEMENTS (clones); i++)
+    clutter_actor_destroy (clones[i]);
+  verify_redraw (data, 1);
+  verify_redraw (data, 1);
+
   data->was_painted = TRUE;
 
   return G_SOURCE_REMOVE;
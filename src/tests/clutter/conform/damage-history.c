@@ -0,0 +1,93 @@
+#include <clutter/clutter.h>
+#include <clutter/clutter-mutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+static void
+damage_history_lookup (void)
+{
+  ClutterDamageHistory *history;
+  MtkRectangle rect = { 0, 0, 10, 10 };
+  int i;
+
+  history = clutter_damage_history_new ();
+
+  g_assert_false (clutter_damage_history_is_age_valid (history, 1));
+
+  for (i = 0; i < 4; i++)
+    {
+      g_autoptr (MtkRegion) region = NULL;
+
+      rect.x = i * 20;
+      region = mtk_region_create_rectangle (&rect);
+      clutter_damage_history_record (history, region);
+      clutter_damage_history_step (history);
+    }
+
+  for (i = 1; i <= 4; i++)
+    {
+      const MtkRegion *damage;
+      MtkRectangle extents;
+
+      g_assert_true (clutter_damage_history_is_age_valid (history, i));
+
+      damage = clutter_damage_history_lookup (history, i);
+      extents = mtk_region_get_extents (damage);
+      g_assert_cmpint (extents.x, ==, (4 - i) * 20);
+      g_assert_cmpint (mtk_region_num_rectangles (damage), ==, 1);
+    }
+
+  g_assert_false (clutter_damage_history_is_age_valid (history, 5));
+
+  clutter_damage_history_free (history);
+}
+
+static void
+damage_history_simplify (void)
+{
+  ClutterDamageHistory *history;
+  g_autoptr (MtkRegion) region = NULL;
+  const MtkRegion *damage;
+  int x, y;
+
+  history = clutter_damage_history_new ();
+
+  /* A checkerboard of small, non-adjacent damaged rectangles */
+  region = mtk_region_create ();
+  for (y = 0; y < 16; y++)
+    {
+      for (x = 0; x < 16; x++)
+        {
+          MtkRectangle rect = { x * 20, y * 20, 10, 10 };
+
+          mtk_region_union_rectangle (region, &rect);
+        }
+    }
+  g_assert_cmpint (mtk_region_num_rectangles (region), ==, 256);
+
+  clutter_damage_history_record (history, region);
+  clutter_damage_history_step (history);
+
+  damage = clutter_damage_history_lookup (history, 1);
+  g_assert_cmpint (mtk_region_num_rectangles (damage), <=, 32);
+
+  /* The simplified damage must still cover everything that was damaged */
+  for (y = 0; y < 16; y++)
+    {
+      for (x = 0; x < 16; x++)
+        {
+          MtkRectangle rect = { x * 20, y * 20, 10, 10 };
+
+          g_assert_cmpint (mtk_region_contains_rectangle (damage, &rect),
+                           ==,
+                           MTK_REGION_OVERLAP_IN);
+        }
+    }
+
+  clutter_damage_history_free (history);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/damage-history/lookup", damage_history_lookup)
+  CLUTTER_TEST_UNIT ("/damage-history/simplify", damage_history_simplify)
+)
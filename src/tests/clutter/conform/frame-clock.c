@@ -255,6 +255,73 @@ frame_clock_immediate_present (void)
   clutter_frame_clock_destroy (frame_clock);
 }
 
+static ClutterFrameResult
+async_frame_clock_frame (ClutterFrameClock *frame_clock,
+                         ClutterFrame      *frame,
+                         gpointer           user_data)
+{
+  GMainLoop *main_loop = user_data;
+  ClutterFrameInfo frame_info;
+
+  g_assert_cmpint (clutter_frame_get_count (frame), ==, expected_frame_count);
+
+  expected_frame_count++;
+
+  if (test_frame_count == 0)
+    {
+      g_main_loop_quit (main_loop);
+      return CLUTTER_FRAME_RESULT_IDLE;
+    }
+
+  test_frame_count--;
+
+  init_frame_info (&frame_info, g_get_monotonic_time ());
+  frame_info.flags = CLUTTER_FRAME_INFO_FLAG_ASYNC;
+  clutter_frame_clock_notify_presented (frame_clock, &frame_info);
+  g_idle_add (schedule_update_idle, frame_clock);
+
+  return CLUTTER_FRAME_RESULT_PENDING_PRESENTED;
+}
+
+static const ClutterFrameListenerIface async_frame_listener_iface = {
+  .frame = async_frame_clock_frame,
+};
+
+static void
+frame_clock_async_present (void)
+{
+  GMainLoop *main_loop;
+  ClutterFrameClock *frame_clock;
+  int64_t before_us;
+  int64_t after_us;
+
+  test_frame_count = 10;
+  expected_frame_count = 0;
+
+  main_loop = g_main_loop_new (NULL, FALSE);
+  frame_clock = clutter_frame_clock_new (refresh_rate,
+                                         0,
+                                         NULL,
+                                         &async_frame_listener_iface,
+                                         main_loop);
+
+  before_us = g_get_monotonic_time ();
+
+  clutter_frame_clock_schedule_update (frame_clock);
+  g_main_loop_run (main_loop);
+
+  after_us = g_get_monotonic_time ();
+
+  /* Frames presented asynchronously aren't aligned to the refresh cycle,
+   * so they should all be dispatched well within the time it takes to
+   * present ten synchronized ones.
+   */
+  g_assert_cmpint (after_us - before_us, <, 5 * refresh_interval_us);
+
+  g_main_loop_unref (main_loop);
+  clutter_frame_clock_destroy (frame_clock);
+}
+
 static gboolean
 schedule_update_timeout (gpointer user_data)
 {
@@ -838,9 +905,86 @@ frame_clock_notify_ready (void)
   clutter_frame_clock_destroy (frame_clock);
 }
 
+typedef struct _DispatchOrderTest
+{
+  GMainLoop *main_loop;
+  ClutterFrameClock *frame_clocks[2];
+  ClutterFrameClock *dispatched[2];
+  int n_dispatched;
+} DispatchOrderTest;
+
+static ClutterFrameResult
+dispatch_order_frame (ClutterFrameClock *frame_clock,
+                      ClutterFrame      *frame,
+                      gpointer           user_data)
+{
+  DispatchOrderTest *test = user_data;
+
+  g_assert_cmpint (test->n_dispatched, <, G_N_ELEMENTS (test->dispatched));
+  test->dispatched[test->n_dispatched++] = frame_clock;
+
+  if (test->n_dispatched == G_N_ELEMENTS (test->dispatched))
+    g_main_loop_quit (test->main_loop);
+
+  return CLUTTER_FRAME_RESULT_PENDING_PRESENTED;
+}
+
+static const ClutterFrameListenerIface dispatch_order_listener_iface = {
+  .frame = dispatch_order_frame,
+};
+
+static void
+frame_clock_dispatch_order (void)
+{
+  DispatchOrderTest test = { 0 };
+  ClutterFrameInfo frame_info;
+  int64_t now_us;
+  int i;
+
+  test.main_loop = g_main_loop_new (NULL, FALSE);
+  for (i = 0; i < G_N_ELEMENTS (test.frame_clocks); i++)
+    {
+      test.frame_clocks[i] =
+        clutter_frame_clock_new (refresh_rate,
+                                 0,
+                                 NULL,
+                                 &dispatch_order_listener_iface,
+                                 &test);
+      clutter_frame_clock_schedule_update (test.frame_clocks[i]);
+    }
+
+  g_main_loop_run (test.main_loop);
+
+  /* Make the second frame clock's refresh cycle lead the first one's by a
+   * quarter of a refresh interval, giving it the earlier deadline.
+   */
+  now_us = g_get_monotonic_time ();
+  init_frame_info (&frame_info, now_us);
+  clutter_frame_clock_notify_presented (test.frame_clocks[0], &frame_info);
+  init_frame_info (&frame_info, now_us - refresh_interval_us / 4);
+  clutter_frame_clock_notify_presented (test.frame_clocks[1], &frame_info);
+
+  for (i = 0; i < G_N_ELEMENTS (test.frame_clocks); i++)
+    clutter_frame_clock_schedule_update (test.frame_clocks[i]);
+
+  /* Let both become ready before the main loop gets to run again */
+  g_usleep (2 * refresh_interval_us);
+
+  test.n_dispatched = 0;
+  g_main_loop_run (test.main_loop);
+
+  g_assert_true (test.dispatched[0] == test.frame_clocks[1]);
+  g_assert_true (test.dispatched[1] == test.frame_clocks[0]);
+
+  for (i = 0; i < G_N_ELEMENTS (test.frame_clocks); i++)
+    clutter_frame_clock_destroy (test.frame_clocks[i]);
+  g_main_loop_unref (test.main_loop);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/frame-clock/schedule-update", frame_clock_schedule_update)
   CLUTTER_TEST_UNIT ("/frame-clock/immediate-present", frame_clock_immediate_present)
+  CLUTTER_TEST_UNIT ("/frame-clock/async-present", frame_clock_async_present)
   CLUTTER_TEST_UNIT ("/frame-clock/delayed-damage", frame_clock_delayed_damage)
   CLUTTER_TEST_UNIT ("/frame-clock/no-damage", frame_clock_no_damage)
   CLUTTER_TEST_UNIT ("/frame-clock/schedule-update-now", frame_clock_schedule_update_now)
@@ -849,4 +993,5 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/frame-clock/reschedule-on-idle", frame_clock_reschedule_on_idle)
   CLUTTER_TEST_UNIT ("/frame-clock/destroy-signal", frame_clock_destroy_signal)
   CLUTTER_TEST_UNIT ("/frame-clock/notify-ready", frame_clock_notify_ready)
+  CLUTTER_TEST_UNIT ("/frame-clock/dispatch-order", frame_clock_dispatch_order)
 )
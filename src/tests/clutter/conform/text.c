@@ -548,6 +548,44 @@ text_idempotent_use_markup (void)
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
+static void
+text_shared_layout (void)
+{
+  ClutterText *text1, *text2, *text3;
+
+  text1 = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 12px", "Files"));
+  g_object_ref_sink (text1);
+  text2 = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 12px", "Files"));
+  g_object_ref_sink (text2);
+  text3 = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 12px", "Files"));
+  g_object_ref_sink (text3);
+
+  /* Identical labels share their layout */
+  g_assert_true (clutter_text_get_layout (text1) ==
+                 clutter_text_get_layout (text2));
+
+  /* Until one of them changes */
+  clutter_text_set_text (text2, "Settings");
+  g_assert_true (clutter_text_get_layout (text1) !=
+                 clutter_text_get_layout (text2));
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text2)),
+                   ==, "Settings");
+
+  clutter_text_set_font_name (text3, "Sans Bold 12px");
+  g_assert_true (clutter_text_get_layout (text1) !=
+                 clutter_text_get_layout (text3));
+
+  /* Editable text always has its own layouts */
+  clutter_text_set_font_name (text3, "Sans 12px");
+  clutter_text_set_editable (text3, TRUE);
+  g_assert_true (clutter_text_get_layout (text1) !=
+                 clutter_text_get_layout (text3));
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text1));
+  clutter_actor_destroy (CLUTTER_ACTOR (text2));
+  clutter_actor_destroy (CLUTTER_ACTOR (text3));
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -562,4 +600,5 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/shared-layout", text_shared_layout)
 )
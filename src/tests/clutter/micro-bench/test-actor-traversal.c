@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define N_GROUPS 100
+#define N_ACTORS_PER_GROUP 100
+#define N_ACTORS (N_GROUPS * (N_ACTORS_PER_GROUP + 1))
+#define N_FRAMES 200
+#define N_PICKS_PER_FRAME 10
+
+#define STAGE_WIDTH 800
+#define STAGE_HEIGHT 600
+
+typedef struct _TestState
+{
+  ClutterActor *stage;
+  int n_frames;
+  int64_t start_us;
+} TestState;
+
+static size_t
+get_resident_size (void)
+{
+  FILE *file;
+  unsigned long size, resident;
+  int n_read;
+
+  file = fopen ("/proc/self/statm", "r");
+  if (!file)
+    return 0;
+
+  n_read = fscanf (file, "%lu %lu", &size, &resident);
+  fclose (file);
+
+  if (n_read != 2)
+    return 0;
+
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+static ClutterActor *
+create_tree (void)
+{
+  ClutterActor *root;
+  int i, j;
+
+  root = clutter_actor_new ();
+
+  for (i = 0; i < N_GROUPS; i++)
+    {
+      ClutterActor *group;
+
+      group = clutter_actor_new ();
+      clutter_actor_set_position (group,
+                                  (float) ((i % 10) * STAGE_WIDTH / 10),
+                                  (float) ((i / 10) * STAGE_HEIGHT / 10));
+      clutter_actor_add_child (root, group);
+
+      for (j = 0; j < N_ACTORS_PER_GROUP; j++)
+        {
+          ClutterActor *actor;
+          CoglColor color;
+
+          cogl_color_init_from_4f (&color,
+                                   (float) i / N_GROUPS,
+                                   (float) j / N_ACTORS_PER_GROUP,
+                                   0.5f,
+                                   1.0f);
+
+          actor = clutter_actor_new ();
+          clutter_actor_set_background_color (actor, &color);
+          clutter_actor_set_size (actor, 8, 6);
+          clutter_actor_set_position (actor,
+                                      (float) ((j % 10) * 8),
+                                      (float) ((j / 10) * 6));
+          clutter_actor_set_reactive (actor, TRUE);
+          clutter_actor_add_child (group, actor);
+        }
+    }
+
+  return root;
+}
+
+static void
+on_after_paint (ClutterActor     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame,
+                TestState        *state)
+{
+  int i;
+
+  for (i = 0; i < N_PICKS_PER_FRAME; i++)
+    {
+      clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                      CLUTTER_PICK_REACTIVE,
+                                      (float) ((state->n_frames * 7 + i * 13) %
+                                               STAGE_WIDTH),
+                                      (float) ((state->n_frames * 5 + i * 11) %
+                                               STAGE_HEIGHT));
+    }
+
+  if (state->n_frames == 0)
+    state->start_us = g_get_monotonic_time ();
+
+  state->n_frames++;
+
+  if (state->n_frames > N_FRAMES)
+    {
+      int64_t elapsed_us = g_get_monotonic_time () - state->start_us;
+
+      printf ("%d frames in %" G_GINT64_FORMAT " us, %.2f us per frame\n",
+              N_FRAMES,
+              elapsed_us,
+              (double) elapsed_us / N_FRAMES);
+      clutter_test_quit ();
+      return;
+    }
+
+  clutter_actor_queue_redraw (stage);
+}
+
+int
+main (int argc, char **argv)
+{
+  TestState state = { 0 };
+  ClutterActor *tree;
+  size_t rss_before, rss_after;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  clutter_test_init (&argc, &argv);
+
+  state.stage = clutter_test_get_stage ();
+  clutter_actor_set_size (state.stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  printf ("Actor traversal test with %d actors, painted and picked "
+          "%d times per frame\n",
+          N_ACTORS,
+          N_PICKS_PER_FRAME);
+
+  rss_before = get_resident_size ();
+  tree = create_tree ();
+  rss_after = get_resident_size ();
+
+  if (rss_before > 0 && rss_after > rss_before)
+    printf ("%.1f bytes resident per actor\n",
+            (double) (rss_after - rss_before) / N_ACTORS);
+
+  clutter_actor_add_child (state.stage, tree);
+
+  g_signal_connect (state.stage, "after-paint",
+                    G_CALLBACK (on_after_paint), &state);
+
+  clutter_actor_show (state.stage);
+
+  clutter_test_main ();
+
+  clutter_actor_destroy (tree);
+
+  return EXIT_SUCCESS;
+}
@@ -3,147 +3,153 @@
 #include <clutter/clutter.h>
 #include <clutter/clutter-mutter.h>
 
+#include "backends/meta-virtual-monitor.h"
 #include "tests/clutter-test-utils.h"
+#include "tests/meta-test-utils.h"
+#include "tests/perf-report.h"
+
+/*
+ * Performance tests run headless on a virtual monitor. Each test measures
+ * some work per frame, either the painting of the stage, or something it
+ * brackets with clutter_perf_begin_sample() and clutter_perf_end_sample().
+ * After CLUTTER_PERF_WARMUP_FRAMES frames that are not measured, the mean
+ * time per frame is taken over CLUTTER_PERF_RUNS runs of CLUTTER_PERF_FRAMES
+ * frames each, and reported through a PerfReport.
+ */
+
+#define CLUTTER_PERF_DEFAULT_WARMUP_FRAMES 30
+#define CLUTTER_PERF_DEFAULT_RUNS 7
+#define CLUTTER_PERF_DEFAULT_FRAMES 60
+
+typedef struct _ClutterPerfTest
+{
+  PerfReport *report;
+  MetaVirtualMonitor *virtual_monitor;
 
-static GTimer *testtimer = NULL;
-static gint testframes = 0;
-static float testmaxtime = 1.0;
+  int warmup_frames;
+  int n_runs;
+  int frames_per_run;
 
-/* initialize environment to be suitable for fps testing */
-static inline void
-clutter_perf_fps_init (void)
-{
-  /* Force not syncing to vblank, we want free-running maximum FPS */
-  g_setenv ("vblank_mode", "0", FALSE);
-  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  gboolean measure_paint;
+  int n_frames;
+  int64_t sample_start_us;
+  int64_t run_time_us;
+} ClutterPerfTest;
 
-  /* also override internal default FPS */
-  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+static ClutterPerfTest perf_test;
 
-  if (g_getenv ("CLUTTER_PERFORMANCE_TEST_DURATION"))
-    testmaxtime = (float) atof (g_getenv("CLUTTER_PERFORMANCE_TEST_DURATION"));
-  else
-    testmaxtime = 10.0;
+/* Called before clutter_test_init() */
+static inline void
+clutter_perf_init (void)
+{
+  perf_test.warmup_frames =
+    perf_report_get_env_int ("CLUTTER_PERF_WARMUP_FRAMES",
+                             CLUTTER_PERF_DEFAULT_WARMUP_FRAMES);
+  perf_test.n_runs =
+    perf_report_get_env_int ("CLUTTER_PERF_RUNS",
+                             CLUTTER_PERF_DEFAULT_RUNS);
+  perf_test.frames_per_run =
+    perf_report_get_env_int ("CLUTTER_PERF_FRAMES",
+                             CLUTTER_PERF_DEFAULT_FRAMES);
 
   g_random_set_seed (12345678);
 }
 
-static void perf_stage_after_paint_cb (ClutterStage     *stage,
-                                       ClutterStageView *view,
-                                       ClutterFrame     *frame,
-                                       gpointer         *data);
-static gboolean perf_fake_mouse_cb (gpointer stage);
-
 static inline void
-clutter_perf_fps_start (ClutterStage *stage)
+clutter_perf_begin_sample (void)
 {
-  g_signal_connect (stage, "after-paint", G_CALLBACK (perf_stage_after_paint_cb), NULL);
+  perf_test.sample_start_us = g_get_monotonic_time ();
 }
 
 static inline void
-clutter_perf_fake_mouse (ClutterStage *stage)
+clutter_perf_end_sample (void)
 {
-  g_timeout_add (1000/60, perf_fake_mouse_cb, stage);
+  perf_test.run_time_us += g_get_monotonic_time () - perf_test.sample_start_us;
 }
 
-static inline void
-clutter_perf_fps_report (const gchar *id)
+static void
+perf_stage_before_paint_cb (ClutterStage     *stage,
+                            ClutterStageView *view,
+                            ClutterFrame     *frame,
+                            gpointer          user_data)
 {
-  g_print ("\n@ %s: %.2f fps \n",
-       id, testframes / g_timer_elapsed (testtimer, NULL));
+  if (perf_test.measure_paint)
+    clutter_perf_begin_sample ();
 }
 
 static void
 perf_stage_after_paint_cb (ClutterStage     *stage,
                            ClutterStageView *view,
                            ClutterFrame     *frame,
-                           gpointer         *data)
+                           gpointer          user_data)
 {
-  if (!testtimer)
-    testtimer = g_timer_new ();
-  testframes ++;
-  if (g_timer_elapsed (testtimer, NULL) > testmaxtime)
+  int measured_frames;
+
+  if (perf_test.measure_paint)
+    clutter_perf_end_sample ();
+
+  perf_test.n_frames++;
+
+  if (perf_test.n_frames <= perf_test.warmup_frames)
     {
-      clutter_test_quit ();
+      perf_test.run_time_us = 0;
+      return;
     }
+
+  measured_frames = perf_test.n_frames - perf_test.warmup_frames;
+  if (measured_frames % perf_test.frames_per_run != 0)
+    return;
+
+  perf_report_add_run (perf_test.report,
+                       perf_test.run_time_us /
+                       (double) perf_test.frames_per_run);
+  perf_test.run_time_us = 0;
+
+  if (measured_frames / perf_test.frames_per_run == perf_test.n_runs)
+    clutter_test_quit ();
 }
 
-static void wrap (gfloat *value, gfloat min, gfloat max)
+static gboolean
+perf_queue_redraw_cb (gpointer user_data)
 {
-  if (*value > max)
-    *value = min;
-  else if (*value < min)
-    *value = max;
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (user_data));
+
+  return G_SOURCE_CONTINUE;
 }
 
-static gboolean perf_fake_mouse_cb (gpointer stage)
+/* Called after clutter_test_init(), returns the report to add parameters to */
+static inline PerfReport *
+clutter_perf_start (ClutterStage *stage,
+                    const char   *name,
+                    gboolean      measure_paint)
 {
-  static ClutterInputDevice *device = NULL;
-  int i;
-  static float x = 0.0;
-  static float y = 0.0;
-  static float xd = 0.0;
-  static float yd = 0.0;
-  static gboolean inited = FALSE;
-
-  gfloat w, h;
-
-  if (!inited) /* XXX:
-                  force clutter to do handle our motion events,
-                  by forcibly updating the input device's state
-                  this should be possible to do in a better
-                  manner in the future, a versioning check
-                  will have to be added when this is possible
-                  without a hack... and the means to do the
-                  hack is deprecated
-                */
-    {
-      ClutterEvent *event;
-      ClutterBackend *backend = clutter_test_get_backend ();
-      ClutterSeat *seat = clutter_backend_get_default_seat (backend);
-
-      device = clutter_seat_get_pointer (seat);
-
-      event = clutter_event_crossing_new (CLUTTER_ENTER,
-                                          CLUTTER_EVENT_NONE,
-                                          CLUTTER_CURRENT_TIME,
-                                          device, NULL,
-                                          GRAPHENE_POINT_INIT (10, 10),
-                                          stage,
-                                          NULL);
-      clutter_event_put (event);
-      clutter_event_free (event);
-      inited = TRUE;
-    }
+  float width, height;
+
+  clutter_actor_get_size (CLUTTER_ACTOR (stage), &width, &height);
+  perf_test.virtual_monitor =
+    meta_create_test_monitor (clutter_test_get_meta_context (),
+                              (int) width, (int) height,
+                              60.0f);
+
+  perf_test.report = perf_report_new (name, "us/frame",
+                                      perf_test.warmup_frames,
+                                      perf_test.frames_per_run);
+  perf_test.measure_paint = measure_paint;
+
+  g_signal_connect (stage, "before-paint",
+                    G_CALLBACK (perf_stage_before_paint_cb), NULL);
+  g_signal_connect (stage, "after-paint",
+                    G_CALLBACK (perf_stage_after_paint_cb), NULL);
+  g_idle_add (perf_queue_redraw_cb, stage);
+
+  return perf_test.report;
+}
 
-  clutter_actor_get_size (stage, &w, &h);
+static inline void
+clutter_perf_report (void)
+{
+  perf_report_print (perf_test.report);
 
-  /* called about every 60fps, and do 10 picks per stage */
-  for (i = 0; i < 10; i++)
-    {
-      ClutterEvent *event;
-
-      event = clutter_event_motion_new (CLUTTER_EVENT_NONE,
-                                        CLUTTER_CURRENT_TIME,
-                                        device, NULL, 0,
-                                        GRAPHENE_POINT_INIT (x, y),
-                                        GRAPHENE_POINT_INIT (0, 0),
-                                        GRAPHENE_POINT_INIT (0, 0),
-                                        GRAPHENE_POINT_INIT (0, 0),
-                                        NULL);
-      clutter_event_put (event);
-      clutter_event_free (event);
-
-      x += xd;
-      y += yd;
-      xd += (float) g_random_double_range (-0.1, 0.1);
-      yd += (float) g_random_double_range (-0.1, 0.1);
-
-      wrap (&x, 0, w);
-      wrap (&y, 0, h);
-
-      xd = CLAMP(xd, -1.3f, 1.3f);
-      yd = CLAMP(yd, -1.3f, 1.3f);
-    }
-  return G_SOURCE_CONTINUE;
+  g_clear_pointer (&perf_test.report, perf_report_free);
+  g_clear_object (&perf_test.virtual_monitor);
 }
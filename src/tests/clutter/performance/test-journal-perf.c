@@ -0,0 +1,102 @@
+#include <clutter/clutter.h>
+#include <cogl/cogl.h>
+
+#include "test-common.h"
+
+#define STAGE_WIDTH 800
+#define STAGE_HEIGHT 600
+
+#define RECT_WIDTH 5
+#define RECT_HEIGHT 5
+
+/*
+ * Draws a grid of small rectangles with a transform and a color change
+ * each, which all go through the Cogl journal, first all opaque and rotated,
+ * then translated only and blended.
+ */
+static void
+on_paint (ClutterActor        *actor,
+          ClutterPaintContext *paint_context,
+          gpointer             user_data)
+{
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  CoglColor color;
+  int x, y;
+
+  pipeline = cogl_pipeline_new (ctx);
+
+  for (y = 0; y < STAGE_HEIGHT; y += RECT_HEIGHT)
+    {
+      for (x = 0; x < STAGE_WIDTH; x += RECT_WIDTH)
+        {
+          cogl_color_init_from_4f (&color,
+                                   1,
+                                   (1.0f / STAGE_WIDTH) * y,
+                                   (1.0f / STAGE_HEIGHT) * x,
+                                   1);
+
+          cogl_framebuffer_push_matrix (framebuffer);
+          cogl_framebuffer_translate (framebuffer, x, y, 0);
+          cogl_framebuffer_rotate (framebuffer, 45, 0, 0, 1);
+          cogl_pipeline_set_color (pipeline, &color);
+          cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
+                                           0, 0, RECT_WIDTH, RECT_HEIGHT);
+          cogl_framebuffer_pop_matrix (framebuffer);
+        }
+    }
+
+  for (y = 0; y < STAGE_HEIGHT; y += RECT_HEIGHT)
+    {
+      for (x = 0; x < STAGE_WIDTH; x += RECT_WIDTH)
+        {
+          cogl_framebuffer_push_matrix (framebuffer);
+          cogl_framebuffer_translate (framebuffer, x, y, 0);
+          cogl_color_init_from_4f (&color,
+                                   1,
+                                   (1.0f / STAGE_WIDTH) * x,
+                                   (1.0f / STAGE_HEIGHT) * y,
+                                   (1.0f / STAGE_WIDTH) * x);
+          cogl_pipeline_set_color (pipeline, &color);
+          cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
+                                           0, 0, RECT_WIDTH, RECT_HEIGHT);
+          cogl_framebuffer_pop_matrix (framebuffer);
+        }
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterActor *stage;
+  ClutterActor *actor;
+  PerfReport *report;
+
+  clutter_perf_init ();
+
+  clutter_test_init (&argc, &argv);
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_actor_set_background_color (CLUTTER_ACTOR (stage),
+                                      &COGL_COLOR_INIT (255, 255, 255, 255));
+  g_signal_connect (stage, "destroy", G_CALLBACK (clutter_test_quit), NULL);
+
+  actor = g_object_new (CLUTTER_TYPE_TEST_ACTOR, NULL);
+  clutter_actor_add_child (stage, actor);
+  g_signal_connect (actor, "paint", G_CALLBACK (on_paint), NULL);
+
+  clutter_actor_show (stage);
+
+  report = clutter_perf_start (CLUTTER_STAGE (stage), "journal", TRUE);
+  perf_report_add_parameter (report, "rectangles",
+                             2 * (STAGE_WIDTH / RECT_WIDTH) *
+                             (STAGE_HEIGHT / RECT_HEIGHT));
+
+  clutter_test_main ();
+  clutter_perf_report ();
+
+  return 0;
+}
@@ -38,12 +38,15 @@ do_events (ClutterActor *stage)
     }
 }
 
-static gboolean queue_redraw (gpointer data)
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame,
+                gpointer          user_data)
 {
-  ClutterActor *stage = CLUTTER_ACTOR (data);
-  clutter_actor_queue_redraw (stage);
-  do_events (stage);
-  return TRUE;
+  clutter_perf_begin_sample ();
+  do_events (CLUTTER_ACTOR (stage));
+  clutter_perf_end_sample ();
 }
 
 int
@@ -53,8 +56,9 @@ main (int argc, char **argv)
   gdouble angle;
   CoglColor color = { 0x00, 0x00, 0x00, 0xff };
   ClutterActor *stage, *rect;
+  PerfReport *report;
 
-  clutter_perf_fps_init ();
+  clutter_perf_init ();
 
   clutter_test_init (&argc, &argv);
 
@@ -64,11 +68,6 @@ main (int argc, char **argv)
                                       &COGL_COLOR_INIT (0, 0, 0, 255));
   g_signal_connect (stage, "destroy", G_CALLBACK (clutter_test_quit), NULL);
 
-  printf ("Picking performance test with "
-          "%d actors and %d events per frame\n",
-          n_actors,
-          n_events);
-
   for (i = n_actors - 1; i >= 0; i--)
     {
       angle = ((2.0 * G_PI) / (gdouble) n_actors) * i;
@@ -101,10 +100,14 @@ main (int argc, char **argv)
 
   clutter_actor_show (stage);
 
-  clutter_perf_fps_start (CLUTTER_STAGE (stage));
-  g_idle_add (queue_redraw, stage);
+  g_signal_connect (stage, "after-paint", G_CALLBACK (on_after_paint), NULL);
+
+  report = clutter_perf_start (CLUTTER_STAGE (stage), "picking", FALSE);
+  perf_report_add_parameter (report, "actors", n_actors);
+  perf_report_add_parameter (report, "picks_per_frame", n_events);
+
   clutter_test_main ();
-  clutter_perf_fps_report ("test-picking");
+  clutter_perf_report ();
 
   return 0;
 }
@@ -10,14 +10,7 @@
 static int font_size;
 static int n_chars;
 static int rows, cols;
-
-static gboolean
-queue_redraw (gpointer stage)
-{
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
-
-  return G_SOURCE_CONTINUE;
-}
+static gboolean uncached;
 
 static gunichar
 get_character (int ch)
@@ -77,6 +70,20 @@ create_label (void)
   return label;
 }
 
+/*
+ * Evicts all glyphs before every frame, so that they have to be rasterized
+ * and uploaded again, like when all text is shown at a new scale after
+ * moving to a different monitor.
+ */
+static void
+on_before_paint (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 ClutterFrame     *frame,
+                 gpointer          user_data)
+{
+  clutter_context_trim_glyph_cache (clutter_test_get_context (), 0);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -86,8 +93,15 @@ main (int argc, char *argv[])
   int              w, h;
   int              row, col;
   float            scale = 1.0f;
+  PerfReport      *report;
+
+  clutter_perf_init ();
 
-  clutter_perf_fps_init ();
+  if (argc > 1 && g_str_equal (argv[argc - 1], "--uncached"))
+    {
+      uncached = TRUE;
+      argv[--argc] = NULL;
+    }
 
   clutter_test_init (&argc, &argv);
 
@@ -104,8 +118,6 @@ main (int argc, char *argv[])
       n_chars = atoi (argv[2]);
     }
 
-  g_print ("Monospace %dpx, string length = %d\n", font_size, n_chars);
-
   stage = clutter_test_get_stage ();
   clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
   clutter_actor_set_background_color (CLUTTER_ACTOR (stage), &stage_color);
@@ -134,8 +146,6 @@ main (int argc, char *argv[])
           cols = (int) (STAGE_WIDTH / (w * scale));
           rows = 1;
         }
-
-      g_print ("Text scaled by %f to fit on the stage\n", scale);
     }
   else
     {
@@ -156,10 +166,22 @@ main (int argc, char *argv[])
 
   clutter_actor_show (stage);
 
-  clutter_perf_fps_start (CLUTTER_STAGE (stage));
-  g_idle_add (queue_redraw, stage);
+  /* Connected first, to run outside of the measured paint */
+  if (uncached)
+    {
+      g_signal_connect (stage, "before-paint",
+                        G_CALLBACK (on_before_paint), NULL);
+    }
+
+  report = clutter_perf_start (CLUTTER_STAGE (stage),
+                               uncached ? "text-uncached" : "text",
+                               TRUE);
+  perf_report_add_parameter (report, "font_size", font_size);
+  perf_report_add_parameter (report, "chars", n_chars);
+  perf_report_add_parameter (report, "labels", rows * cols);
+
   clutter_test_main ();
-  clutter_perf_fps_report ("test-text-perf");
+  clutter_perf_report ();
 
   return 0;
 }
@@ -144,6 +144,37 @@ test_atlas_migration (void)
     g_print ("OK\n");
 }
 
+static void
+test_atlas_compaction (void)
+{
+  CoglTexture *textures[N_TEXTURES];
+  int tex_num;
+
+  for (tex_num = 0; tex_num < N_TEXTURES; tex_num++)
+    textures[tex_num] = create_texture (tex_num + 1);
+
+  /* Only keep the smallest textures, which leaves the atlas mostly empty */
+  for (tex_num = 8; tex_num < N_TEXTURES; tex_num++)
+    g_clear_object (&textures[tex_num]);
+
+  g_assert_true (cogl_atlas_texture_atlases_need_compaction (test_ctx, 0.5f));
+
+  cogl_atlas_texture_compact_atlases (test_ctx, 0.5f);
+
+  g_assert_false (cogl_atlas_texture_atlases_need_compaction (test_ctx, 0.5f));
+
+  /* The remaining textures must have been moved along with their data */
+  for (tex_num = 0; tex_num < 8; tex_num++)
+    verify_texture (textures[tex_num], tex_num + 1);
+
+  for (tex_num = 0; tex_num < 8; tex_num++)
+    g_object_unref (textures[tex_num]);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
+
 COGL_TEST_SUITE (
   g_test_add_func ("/atlas-migration", test_atlas_migration);
+  g_test_add_func ("/atlas-migration/compaction", test_atlas_compaction);
 )
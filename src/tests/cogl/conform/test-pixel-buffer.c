@@ -268,8 +268,84 @@ test_pixel_buffer_sub_region (void)
     g_print ("OK\n");
 }
 
+static CoglTexture *
+upload_texture_from_range (CoglPixelBuffer *buffer,
+                           size_t           offset)
+{
+  CoglTexture *texture;
+  g_autoptr (CoglBitmap) bitmap = NULL;
+
+  texture = create_white_texture ();
+  bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (buffer),
+                                        COGL_PIXEL_FORMAT_RGBA_8888,
+                                        BITMAP_SIZE,
+                                        BITMAP_SIZE,
+                                        BITMAP_SIZE * 4, /* rowstride */
+                                        (int) offset);
+  g_assert_true (cogl_texture_set_region_from_bitmap (texture,
+                                                      0, 0, /* src_x/y */
+                                                      0, 0, /* dst_x/y */
+                                                      BITMAP_SIZE,
+                                                      BITMAP_SIZE,
+                                                      bitmap));
+
+  return texture;
+}
+
+static void
+test_pixel_buffer_upload_range (void)
+{
+  size_t size = BITMAP_SIZE * BITMAP_SIZE * 4;
+  g_autoptr (CoglPixelBuffer) buffer = NULL;
+  g_autoptr (CoglPixelBuffer) next_buffer = NULL;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  size_t offset, next_offset;
+  void *data;
+
+  if (!cogl_context_has_feature (test_ctx, COGL_FEATURE_ID_MAP_BUFFER_FOR_WRITE))
+    {
+      g_test_skip ("Missing map buffer for write capability");
+      return;
+    }
+
+  buffer = cogl_context_map_upload_range (test_ctx, size,
+                                          &offset, &data,
+                                          NULL);
+  g_assert_nonnull (buffer);
+  generate_bitmap_data (data, BITMAP_SIZE * 4);
+  cogl_buffer_unmap (COGL_BUFFER (buffer));
+
+  texture = upload_texture_from_range (buffer, offset);
+
+  /* The next range must not overlap with the one still being uploaded */
+  next_buffer = cogl_context_map_upload_range (test_ctx, size,
+                                               &next_offset, &data,
+                                               NULL);
+  g_assert_nonnull (next_buffer);
+  if (next_buffer == buffer)
+    g_assert_cmpuint (next_offset, >=, offset + size);
+  memset (data, 0, size);
+  cogl_buffer_unmap (COGL_BUFFER (next_buffer));
+
+  pipeline = create_pipeline_from_texture (texture);
+  cogl_framebuffer_draw_rectangle (test_fb,
+                                   pipeline,
+                                   -1.0f, 1.0f,
+                                   1.0f, -1.0f);
+
+  check_colours (0x0000ffff,
+                 0x00ff00ff,
+                 0x00ffffff,
+                 0xff0000ff);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
+
 COGL_TEST_SUITE (
   g_test_add_func ("/pixel-buffer/map", test_pixel_buffer_map);
   g_test_add_func ("/pixel-buffer/set-data", test_pixel_buffer_set_data);
   g_test_add_func ("/pixel-buffer/sub-region", test_pixel_buffer_sub_region);
+  g_test_add_func ("/pixel-buffer/upload-range", test_pixel_buffer_upload_range);
 )
@@ -0,0 +1,192 @@
+#include <string.h>
+
+#include <cogl/cogl.h>
+
+#include "tests/cogl-test-utils.h"
+
+#define FB_WIDTH 64
+#define FB_HEIGHT 32
+
+typedef struct _TestState
+{
+  CoglBitmap *bitmap;
+  gboolean done;
+  gboolean succeeded;
+} TestState;
+
+static void
+on_read_pixels_finished (GObject      *source_object,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+  TestState *state = user_data;
+  g_autoptr (GError) error = NULL;
+
+  state->succeeded =
+    cogl_framebuffer_read_pixels_finish (COGL_FRAMEBUFFER (source_object),
+                                         result,
+                                         state->bitmap,
+                                         &error);
+  g_assert_no_error (error);
+  state->done = TRUE;
+}
+
+static void
+paint_halves (CoglFramebuffer *framebuffer)
+{
+  CoglPipeline *pipeline;
+
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0, FB_WIDTH, FB_HEIGHT,
+                                 -1, 100);
+
+  pipeline = cogl_pipeline_new (test_ctx);
+
+  /* Red at the top, blue at the bottom */
+  cogl_pipeline_set_color4ub (pipeline, 0xff, 0x00, 0x00, 0xff);
+  cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
+                                   0, 0, FB_WIDTH, FB_HEIGHT / 2);
+  cogl_pipeline_set_color4ub (pipeline, 0x00, 0x00, 0xff, 0xff);
+  cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
+                                   0, FB_HEIGHT / 2, FB_WIDTH, FB_HEIGHT);
+
+  g_object_unref (pipeline);
+}
+
+static void
+check_halves (uint8_t *pixels,
+              int      rowstride,
+              int      width,
+              int      height)
+{
+  int y;
+
+  for (y = 0; y < height; y++)
+    {
+      uint8_t *row = pixels + y * rowstride;
+      uint32_t expected = y < height / 2 ? 0xff0000ff : 0x0000ffff;
+      int x;
+
+      for (x = 0; x < width; x++)
+        {
+          uint8_t *pixel = row + x * 4;
+          uint32_t rgba;
+
+          rgba = (pixel[0] << 24) | (pixel[1] << 16) | (pixel[2] << 8) | pixel[3];
+          g_assert_cmphex (rgba, ==, expected);
+        }
+    }
+}
+
+static void
+read_pixels_async (CoglFramebuffer *framebuffer,
+                   int              x,
+                   int              y,
+                   int              width,
+                   int              height,
+                   uint8_t         *pixels)
+{
+  TestState state = { 0 };
+
+  state.bitmap = cogl_bitmap_new_for_data (test_ctx,
+                                           width, height,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                           width * 4,
+                                           pixels);
+
+  cogl_framebuffer_read_pixels_async (framebuffer,
+                                      x, y, width, height,
+                                      COGL_READ_PIXELS_COLOR_BUFFER,
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                      NULL,
+                                      on_read_pixels_finished,
+                                      &state);
+
+  /* The result is never delivered synchronously */
+  g_assert_false (state.done);
+
+  while (!state.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_true (state.succeeded);
+  g_object_unref (state.bitmap);
+}
+
+static void
+test_read_pixels_async (void)
+{
+  CoglTexture *tex;
+  CoglOffscreen *offscreen;
+  CoglFramebuffer *framebuffer;
+  g_autofree uint8_t *pixels = NULL;
+
+  tex = cogl_texture_2d_new_with_size (test_ctx, FB_WIDTH, FB_HEIGHT);
+  offscreen = cogl_offscreen_new_with_texture (tex);
+  framebuffer = COGL_FRAMEBUFFER (offscreen);
+
+  paint_halves (framebuffer);
+
+  pixels = g_malloc0 (FB_WIDTH * FB_HEIGHT * 4);
+  read_pixels_async (framebuffer, 0, 0, FB_WIDTH, FB_HEIGHT, pixels);
+  check_halves (pixels, FB_WIDTH * 4, FB_WIDTH, FB_HEIGHT);
+
+  /* A sub region spanning both halves */
+  memset (pixels, 0, FB_WIDTH * FB_HEIGHT * 4);
+  read_pixels_async (framebuffer,
+                     8, FB_HEIGHT / 4,
+                     FB_WIDTH / 2, FB_HEIGHT / 2,
+                     pixels);
+  check_halves (pixels, FB_WIDTH / 2 * 4, FB_WIDTH / 2, FB_HEIGHT / 2);
+
+  g_object_unref (offscreen);
+  g_object_unref (tex);
+}
+
+static void
+on_read_pixels_cancelled (GObject      *source_object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  TestState *state = user_data;
+  g_autoptr (GError) error = NULL;
+
+  state->succeeded =
+    cogl_framebuffer_read_pixels_finish (COGL_FRAMEBUFFER (source_object),
+                                         result,
+                                         state->bitmap,
+                                         &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  state->done = TRUE;
+}
+
+static void
+test_read_pixels_async_cancel (void)
+{
+  g_autoptr (GCancellable) cancellable = NULL;
+  TestState state = { 0 };
+
+  state.bitmap = cogl_bitmap_new_with_size (test_ctx,
+                                            FB_WIDTH, FB_HEIGHT,
+                                            COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+
+  cancellable = g_cancellable_new ();
+  cogl_framebuffer_read_pixels_async (test_fb,
+                                      0, 0, FB_WIDTH, FB_HEIGHT,
+                                      COGL_READ_PIXELS_COLOR_BUFFER,
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                      cancellable,
+                                      on_read_pixels_cancelled,
+                                      &state);
+  g_cancellable_cancel (cancellable);
+
+  while (!state.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_false (state.succeeded);
+  g_object_unref (state.bitmap);
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/read-pixels/async", test_read_pixels_async);
+  g_test_add_func ("/read-pixels/async-cancel", test_read_pixels_async_cancel);
+)
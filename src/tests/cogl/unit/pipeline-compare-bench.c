@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays the pipeline comparisons and hashing done when batching the
+ * journal entries of a text heavy scene, where most entries use copies of
+ * a few glyph cache and texture pipelines that only differ in their color,
+ * and reports the time spent per operation.
+ */
+
+#include "config.h"
+
+#include "cogl/cogl.h"
+#include "cogl/cogl-pipeline-private.h"
+#include "tests/cogl-test-utils.h"
+
+#define N_TEXTURES 4
+#define N_PIPELINES 256
+#define N_ENTRIES 4096
+#define N_FRAMES 200
+
+/* What the journal checks when batching entries */
+#define JOURNAL_STATE_GROUPS \
+  (COGL_PIPELINE_STATE_ALL & ~COGL_PIPELINE_STATE_COLOR)
+
+static CoglPipeline *
+create_glyph_pipeline (CoglPipeline *template,
+                       int           index)
+{
+  CoglPipeline *pipeline;
+
+  pipeline = cogl_pipeline_copy (template);
+  cogl_pipeline_set_color4ub (pipeline,
+                              index % 256,
+                              (index * 7) % 256,
+                              (index * 13) % 256,
+                              255);
+
+  return pipeline;
+}
+
+static void
+bench_pipeline_compare (void)
+{
+  CoglPipeline *templates[N_TEXTURES];
+  CoglPipeline *pipelines[N_PIPELINES];
+  g_autofree CoglPipeline **entries = NULL;
+  g_autofree int *entry_templates = NULL;
+  int64_t start_us, cold_us, compare_us, hash_us;
+  unsigned int hash_sum = 0;
+  int n_expected_batches = 1;
+  int n_batches;
+  int frame;
+  int i;
+
+  for (i = 0; i < N_TEXTURES; i++)
+    {
+      g_autoptr (CoglTexture) texture = NULL;
+
+      texture = test_utils_texture_new_with_size (test_ctx, 64, 64,
+                                                  TEST_UTILS_TEXTURE_NONE,
+                                                  COGL_TEXTURE_COMPONENTS_RGBA);
+
+      templates[i] = cogl_pipeline_new (test_ctx);
+      cogl_pipeline_set_layer_texture (templates[i], 0, texture);
+
+      /* Mix glyph pipelines with plain textured ones */
+      if (i % 2 == 0)
+        {
+          cogl_pipeline_set_layer_combine (templates[i], 0,
+                                           "RGBA = MODULATE (PREVIOUS, "
+                                           "TEXTURE[A])",
+                                           NULL);
+        }
+    }
+
+  for (i = 0; i < N_PIPELINES; i++)
+    pipelines[i] = create_glyph_pipeline (templates[i % N_TEXTURES], i);
+
+  /* Runs of entries sharing a glyph cache texture, with varying colors */
+  entries = g_new0 (CoglPipeline *, N_ENTRIES);
+  entry_templates = g_new0 (int, N_ENTRIES);
+  for (i = 0; i < N_ENTRIES; i++)
+    {
+      int run = i / 16;
+      int pipeline_index = (run * 5 + i * N_TEXTURES) % N_PIPELINES;
+
+      entries[i] = pipelines[pipeline_index];
+      entry_templates[i] = pipeline_index % N_TEXTURES;
+
+      if (i > 0 && entry_templates[i] != entry_templates[i - 1])
+        n_expected_batches++;
+    }
+
+  start_us = g_get_monotonic_time ();
+  cold_us = 0;
+
+  for (frame = 0; frame < N_FRAMES; frame++)
+    {
+      n_batches = 1;
+
+      for (i = 1; i < N_ENTRIES; i++)
+        {
+          if (!_cogl_pipeline_equal (entries[i - 1], entries[i],
+                                     JOURNAL_STATE_GROUPS,
+                                     COGL_PIPELINE_LAYER_STATE_ALL))
+            n_batches++;
+        }
+
+      g_assert_cmpint (n_batches, ==, n_expected_batches);
+
+      if (frame == 0)
+        {
+          cold_us = g_get_monotonic_time () - start_us;
+          start_us = g_get_monotonic_time ();
+        }
+    }
+
+  compare_us = g_get_monotonic_time () - start_us;
+
+  start_us = g_get_monotonic_time ();
+
+  for (frame = 0; frame < N_FRAMES; frame++)
+    {
+      for (i = 0; i < N_ENTRIES; i++)
+        {
+          hash_sum += _cogl_pipeline_hash (entries[i],
+                                           JOURNAL_STATE_GROUPS &
+                                           ~COGL_PIPELINE_STATE_UNIFORMS,
+                                           COGL_PIPELINE_LAYER_STATE_ALL);
+        }
+    }
+
+  hash_us = g_get_monotonic_time () - start_us;
+
+  g_print ("# pipelines: %d, entries per frame: %d, batches: %d, "
+           "frames: %d\n",
+           N_PIPELINES, N_ENTRIES, n_expected_batches, N_FRAMES);
+  g_print ("# hash checksum: %u\n", hash_sum);
+  g_print ("%.3f us for the first frame of comparisons\n",
+           (double) cold_us);
+  g_print ("%.3f ns per comparison\n",
+           compare_us * 1000.0 / ((N_FRAMES - 1) * (double) (N_ENTRIES - 1)));
+  g_print ("%.3f ns per hash\n",
+           hash_us * 1000.0 / (N_FRAMES * (double) N_ENTRIES));
+
+  for (i = 0; i < N_PIPELINES; i++)
+    g_object_unref (pipelines[i]);
+  for (i = 0; i < N_TEXTURES; i++)
+    g_object_unref (templates[i]);
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/pipeline/bench/compare", bench_pipeline_compare);
+)
@@ -0,0 +1,96 @@
+#include "config.h"
+
+#include "cogl/cogl.h"
+#include "cogl/cogl-matrix-stack-private.h"
+#include "tests/cogl-test-utils.h"
+
+static void
+check_translation_entries (void)
+{
+  CoglMatrixStack *stack;
+  CoglMatrixEntry *entry0;
+  CoglMatrixEntry *entry1;
+  graphene_point3d_t translation;
+  graphene_point3d_t expected;
+  float x, y, z;
+
+  stack = cogl_matrix_stack_new (test_ctx);
+
+  cogl_matrix_stack_translate (stack, 10.0f, 20.0f, 0.0f);
+
+  cogl_matrix_stack_push (stack);
+  cogl_matrix_stack_translate (stack, 5.0f, 5.0f, 0.0f);
+  entry0 = cogl_matrix_entry_ref (cogl_matrix_stack_get_entry (stack));
+  cogl_matrix_stack_pop (stack);
+
+  cogl_matrix_stack_push (stack);
+  cogl_matrix_stack_translate (stack, 5.0f, 5.0f, 1.0f);
+  entry1 = cogl_matrix_entry_ref (cogl_matrix_stack_get_entry (stack));
+  cogl_matrix_stack_pop (stack);
+
+  graphene_point3d_init (&expected, 15.0f, 25.0f, 0.0f);
+  g_assert_true (_cogl_matrix_entry_get_translation (entry0, &translation));
+  g_assert_true (graphene_point3d_equal (&translation, &expected));
+
+  g_assert_true (cogl_matrix_entry_calculate_translation (entry0, entry1,
+                                                          &x, &y, &z));
+  g_assert_cmpfloat (x, ==, 0.0f);
+  g_assert_cmpfloat (y, ==, 0.0f);
+  g_assert_cmpfloat (z, ==, 1.0f);
+
+  cogl_matrix_stack_scale (stack, 2.0f, 2.0f, 1.0f);
+  g_assert_false (_cogl_matrix_entry_get_translation (cogl_matrix_stack_get_entry (stack),
+                                                      &translation));
+
+  cogl_matrix_entry_unref (entry1);
+  cogl_matrix_entry_unref (entry0);
+  g_object_unref (stack);
+}
+
+static void
+check_composed_matrices (void)
+{
+  CoglMatrixStack *stack;
+  graphene_matrix_t expected;
+  graphene_matrix_t matrix;
+  graphene_point3d_t translation;
+  graphene_vec3_t axis;
+  int i;
+
+  stack = cogl_matrix_stack_new (test_ctx);
+
+  cogl_matrix_stack_translate (stack, 10.0f, 20.0f, 0.0f);
+  cogl_matrix_stack_push (stack);
+  cogl_matrix_stack_scale (stack, 2.0f, 3.0f, 1.0f);
+  cogl_matrix_stack_rotate (stack, 30.0f, 0.0f, 0.0f, 1.0f);
+  cogl_matrix_stack_translate (stack, 4.0f, 0.0f, 0.0f);
+
+  /* The operations closest to the top of the stack apply first */
+  graphene_point3d_init (&translation, 4.0f, 0.0f, 0.0f);
+  graphene_matrix_init_translate (&expected, &translation);
+  graphene_vec3_init (&axis, 0.0f, 0.0f, 1.0f);
+  graphene_matrix_rotate (&expected, 30.0f, &axis);
+  graphene_matrix_scale (&expected, 2.0f, 3.0f, 1.0f);
+  graphene_point3d_init (&translation, 10.0f, 20.0f, 0.0f);
+  graphene_matrix_translate (&expected, &translation);
+
+  /* The second lookup is served from the cache and must match */
+  for (i = 0; i < 2; i++)
+    {
+      cogl_matrix_stack_get (stack, &matrix);
+      g_assert_true (graphene_matrix_near (&matrix, &expected, 0.0001f));
+    }
+
+  cogl_matrix_stack_pop (stack);
+
+  graphene_matrix_init_translate (&expected, &translation);
+  cogl_matrix_stack_get (stack, &matrix);
+  g_assert_true (graphene_matrix_near (&matrix, &expected, 0.0001f));
+
+  g_object_unref (stack);
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/matrix-stack/translation", check_translation_entries);
+  g_test_add_func ("/matrix-stack/composed", check_composed_matrices);
+)
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how long constraining a window takes while it is moved and
+ * resized the way an interactive grab would, across a set of virtual
+ * monitors of alternating sizes.
+ *
+ * Each step is a user move or move-and-resize of a window, walking it
+ * over all monitors and partially off the screen edges, so that the
+ * monitor relative and the onscreen constraints all get to do work.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "backends/meta-virtual-monitor.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-test-utils.h"
+
+typedef struct _BenchMode
+{
+  const char *name;
+  gboolean resize;
+} BenchMode;
+
+static const BenchMode bench_modes[] = {
+  { "move", FALSE },
+  { "move-resize", TRUE },
+};
+
+static MetaContext *test_context;
+
+static int n_monitors = 3;
+static int n_steps = 20000;
+
+static const GOptionEntry bench_options[] = {
+  {
+    "monitors", 0, 0, G_OPTION_ARG_INT,
+    &n_monitors,
+    "Number of virtual monitors to lay out (default: 3)",
+    "N"
+  },
+  {
+    "steps", 0, 0, G_OPTION_ARG_INT,
+    &n_steps,
+    "Number of move or resize steps per mode (default: 20000)",
+    "N"
+  },
+  { NULL }
+};
+
+static void
+get_stage_size (int *stage_width,
+                int *stage_height)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+
+  meta_display_get_size (display, stage_width, stage_height);
+}
+
+static int64_t
+run_steps (MetaWindow      *window,
+           const BenchMode *mode)
+{
+  int stage_width, stage_height;
+  int64_t start_us;
+  int i;
+
+  get_stage_size (&stage_width, &stage_height);
+
+  start_us = g_get_monotonic_time ();
+
+  for (i = 0; i < n_steps; i++)
+    {
+      int width = 400;
+      int height = 300;
+      int x, y;
+
+      if (mode->resize)
+        {
+          width += (i * 7) % 900;
+          height += (i * 5) % 600;
+        }
+
+      /* Sweep over all monitors, going past the screen edges */
+      x = (i * 13) % (stage_width + width) - width / 2;
+      y = (i * 11) % (stage_height + height) - height / 2;
+
+      meta_window_move_resize_frame (window, TRUE, x, y, width, height);
+    }
+
+  return g_get_monotonic_time () - start_us;
+}
+
+static void
+bench_constraints (void)
+{
+  g_autoptr (GPtrArray) virtual_monitors = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaTestClient *test_client;
+  MetaWindow *window;
+  int i;
+
+  virtual_monitors =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+  for (i = 0; i < n_monitors; i++)
+    {
+      if (i % 2 == 0)
+        g_ptr_array_add (virtual_monitors,
+                         meta_create_test_monitor (test_context,
+                                                   1920, 1080, 60.0f));
+      else
+        g_ptr_array_add (virtual_monitors,
+                         meta_create_test_monitor (test_context,
+                                                   2560, 1440, 60.0f));
+    }
+  meta_wait_for_paint (test_context);
+
+  test_client = meta_test_client_new (test_context, "constraints-bench",
+                                      META_WINDOW_CLIENT_TYPE_WAYLAND,
+                                      &error);
+  g_assert_no_error (error);
+  meta_test_client_run (test_client,
+                        "create 1\n"
+                        "show 1\n");
+
+  window = meta_test_client_find_window (test_client, "1", &error);
+  g_assert_no_error (error);
+  meta_wait_for_window_shown (window);
+
+  for (i = 0; i < G_N_ELEMENTS (bench_modes); i++)
+    {
+      int64_t elapsed_us;
+
+      elapsed_us = run_steps (window, &bench_modes[i]);
+
+      g_print ("%s: %d monitors, %d steps in %" G_GINT64_FORMAT " us, "
+               "%.2f us per step\n",
+               bench_modes[i].name,
+               n_monitors,
+               n_steps,
+               elapsed_us,
+               (double) elapsed_us / n_steps);
+    }
+
+  meta_test_client_destroy (test_client);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      (META_CONTEXT_TEST_FLAG_NO_X11 |
+                                       META_CONTEXT_TEST_FLAG_NO_ANIMATIONS));
+  meta_context_add_option_entries (context, bench_options, NULL);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  if (n_monitors <= 0 || n_steps <= 0)
+    {
+      g_printerr ("Invalid benchmark parameters\n");
+      return EXIT_FAILURE;
+    }
+
+  test_context = context;
+
+  g_test_add_func ("/bench/constraints", bench_constraints);
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
@@ -19,7 +19,9 @@
 #include "config.h"
 
 #include "backends/meta-backend-private.h"
+#include "backends/meta-renderer.h"
 #include "meta-test/meta-context-test.h"
+#include "tests/meta-test-utils.h"
 
 static MetaContext *test_context;
 
@@ -88,6 +90,170 @@ meta_test_debug_control_inhibit_hw_cursor (void)
   g_assert_false (meta_backend_is_hw_cursors_inhibited (backend));
 }
 
+static void
+get_frame_records_cb (GObject      *source_object,
+                      GAsyncResult *res,
+                      gpointer      user_data)
+{
+  g_autoptr (GError) error = NULL;
+  GVariant **ret = user_data;
+
+  *ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object),
+                                   res,
+                                   &error);
+  g_assert_no_error (error);
+}
+
+static void
+meta_test_debug_control_frame_records (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GDBusProxy) proxy = NULL;
+  g_autoptr (GVariant) ret = NULL;
+  g_autoptr (GVariant) views = NULL;
+  GVariantIter views_iter;
+  const char *view_name;
+  GVariant *records;
+  int n_views = 0;
+
+  /* The stage emits 'presented' before the frame clock records the frame,
+   * so make sure at least one frame has been fully processed.
+   */
+  meta_wait_for_paint (test_context);
+  meta_wait_for_paint (test_context);
+
+  proxy = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                         G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+                                         NULL,
+                                         "org.gnome.Mutter.DebugControl",
+                                         "/org/gnome/Mutter/DebugControl",
+                                         "org.gnome.Mutter.DebugControl",
+                                         NULL,
+                                         &error);
+  g_assert_nonnull (proxy);
+  g_assert_no_error (error);
+
+  g_dbus_proxy_call (proxy,
+                     "GetFrameRecords",
+                     NULL,
+                     G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                     -1,
+                     NULL,
+                     get_frame_records_cb,
+                     &ret);
+  while (!ret)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_true (g_variant_is_of_type (ret, G_VARIANT_TYPE ("(a{sa(xxxxxbu)})")));
+  views = g_variant_get_child_value (ret, 0);
+
+  g_variant_iter_init (&views_iter, views);
+  while (g_variant_iter_loop (&views_iter, "{&s@a(xxxxxbu)}",
+                              &view_name, &records))
+    {
+      GVariantIter records_iter;
+      int64_t frame_count, dispatch_time_us, cpu_duration_us,
+              gpu_duration_us, presentation_time_us;
+      int64_t prev_frame_count = -1;
+      gboolean missed_vblank;
+      uint32_t kind;
+
+      g_assert_cmpuint (g_variant_n_children (records), >, 0);
+
+      g_variant_iter_init (&records_iter, records);
+      while (g_variant_iter_next (&records_iter, "(xxxxxbu)",
+                                  &frame_count,
+                                  &dispatch_time_us,
+                                  &cpu_duration_us,
+                                  &gpu_duration_us,
+                                  &presentation_time_us,
+                                  &missed_vblank,
+                                  &kind))
+        {
+          g_assert_cmpint (frame_count, >, prev_frame_count);
+          g_assert_cmpint (dispatch_time_us, >, 0);
+          g_assert_cmpint (cpu_duration_us, >=, 0);
+          g_assert_cmpint (gpu_duration_us, >=, 0);
+          g_assert_cmpuint (kind, <=, CLUTTER_FRAME_KIND_CURSOR_ONLY);
+          prev_frame_count = frame_count;
+        }
+
+      n_views++;
+    }
+
+  g_assert_cmpint (n_views, ==, g_list_length (meta_renderer_get_views (renderer)));
+}
+
+static void
+meta_test_debug_control_client_stats (void)
+{
+  MetaDebugControl *debug_control = meta_context_get_debug_control (test_context);
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GDBusProxy) proxy = NULL;
+  g_autoptr (GVariant) ret = NULL;
+  g_autoptr (GVariant) stats = NULL;
+  MetaTestClient *test_client;
+  MetaWindow *window;
+  GVariantIter iter;
+  int32_t pid;
+  uint64_t n_requests, n_commits;
+  uint32_t commit_rate;
+  uint64_t total_commits = 0;
+
+  g_object_set (debug_control, "client-stats", TRUE, NULL);
+
+  test_client = meta_test_client_new (test_context, "client-stats",
+                                      META_WINDOW_CLIENT_TYPE_WAYLAND,
+                                      &error);
+  g_assert_no_error (error);
+  meta_test_client_run (test_client,
+                        "create 1\n"
+                        "show 1\n");
+  window = meta_test_client_find_window (test_client, "1", &error);
+  g_assert_no_error (error);
+  meta_wait_for_window_shown (window);
+
+  proxy = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                         G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+                                         NULL,
+                                         "org.gnome.Mutter.DebugControl",
+                                         "/org/gnome/Mutter/DebugControl",
+                                         "org.gnome.Mutter.DebugControl",
+                                         NULL,
+                                         &error);
+  g_assert_nonnull (proxy);
+  g_assert_no_error (error);
+
+  g_dbus_proxy_call (proxy,
+                     "GetClientStats",
+                     NULL,
+                     G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                     -1,
+                     NULL,
+                     get_frame_records_cb,
+                     &ret);
+  while (!ret)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_true (g_variant_is_of_type (ret, G_VARIANT_TYPE ("(a(ittu))")));
+  stats = g_variant_get_child_value (ret, 0);
+
+  g_variant_iter_init (&iter, stats);
+  while (g_variant_iter_next (&iter, "(ittu)",
+                              &pid, &n_requests, &n_commits, &commit_rate))
+    {
+      g_assert_cmpuint (n_requests, >=, n_commits);
+      total_commits += n_commits;
+    }
+
+  g_assert_cmpuint (total_commits, >, 0);
+
+  meta_test_client_destroy (test_client);
+  g_object_set (debug_control, "client-stats", FALSE, NULL);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -106,6 +272,10 @@ main (int    argc,
 
   g_test_add_func ("/debug-control/inhibit-hw-cursor",
                    meta_test_debug_control_inhibit_hw_cursor);
+  g_test_add_func ("/debug-control/frame-records",
+                   meta_test_debug_control_frame_records);
+  g_test_add_func ("/debug-control/client-stats",
+                   meta_test_debug_control_client_stats);
 
   return meta_context_test_run_tests (META_CONTEXT_TEST (context),
                                       META_TEST_RUN_FLAG_NONE);
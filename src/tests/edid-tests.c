@@ -66,6 +66,7 @@ main (int    argc,
       char **argv)
 {
   g_autoptr (MetaEdidInfo) edid_info = NULL;
+  g_autoptr (MetaEdidInfo) edid_info_copy = NULL;
   edid_info = meta_edid_info_new_parse (edid_blob,edid_blob_len);
 
   g_assert_nonnull (edid_info);
@@ -78,4 +79,12 @@ main (int    argc,
   g_assert_true (edid_info->hdr_static_metadata.pq);
   g_assert_true (edid_info->colorimetry.bt2020_rgb);
   g_assert_true (edid_info->colorimetry.bt2020_ycc);
+
+  edid_info_copy = meta_edid_info_copy (edid_info);
+  g_assert_true (edid_info_copy->manufacturer_code !=
+                 edid_info->manufacturer_code);
+  g_assert_cmpstr (edid_info_copy->manufacturer_code, ==, "GSM");
+  g_assert_cmpstr (edid_info_copy->dsc_product_name, ==,
+                   edid_info->dsc_product_name);
+  g_assert_cmpint (edid_info_copy->product_code, ==, 23507);
 }
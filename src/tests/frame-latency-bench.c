@@ -0,0 +1,438 @@
+/*
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures end-to-end frame latency of the compositor while a number of
+ * Wayland clients keep committing new buffers.
+ *
+ * Each stage update is timed from the moment the frame clock dispatches
+ * it until the frame is presented. The dispatch and paint durations are
+ * taken from the stage update and paint signals, the GPU rendering
+ * duration and presentation time from the frame info passed along with
+ * the presentation feedback.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "backends/meta-virtual-monitor.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-test-utils.h"
+#include "tests/meta-wayland-test-driver.h"
+#include "tests/meta-wayland-test-utils.h"
+
+typedef enum _BenchMetric
+{
+  BENCH_METRIC_DISPATCH,
+  BENCH_METRIC_PAINT,
+  BENCH_METRIC_GPU,
+  BENCH_METRIC_PRESENTATION,
+
+  BENCH_N_METRICS
+} BenchMetric;
+
+static const char *bench_metric_names[BENCH_N_METRICS] = {
+  [BENCH_METRIC_DISPATCH] = "dispatch",
+  [BENCH_METRIC_PAINT] = "paint",
+  [BENCH_METRIC_GPU] = "gpu",
+  [BENCH_METRIC_PRESENTATION] = "presentation",
+};
+
+typedef struct _BenchViewState
+{
+  int64_t update_start_us;
+  int64_t paint_start_us;
+
+  /* Dispatch start times of painted frames waiting for presentation */
+  GQueue pending_frames;
+} BenchViewState;
+
+typedef struct _Bench
+{
+  ClutterStage *stage;
+
+  GHashTable *view_states;
+
+  gboolean recording;
+  int n_presented_frames;
+  GArray *samples[BENCH_N_METRICS];
+} Bench;
+
+static MetaContext *test_context;
+
+static int n_clients = 4;
+static double commit_rate = 0.0;
+static int width = 1920;
+static int height = 1080;
+static double refresh_rate = 60.0;
+static double warmup_seconds = 1.0;
+static double duration_seconds = 5.0;
+
+static const GOptionEntry bench_options[] = {
+  {
+    "clients", 0, 0, G_OPTION_ARG_INT,
+    &n_clients,
+    "Number of Wayland clients to spawn (default: 4)",
+    "N"
+  },
+  {
+    "commit-rate", 0, 0, G_OPTION_ARG_DOUBLE,
+    &commit_rate,
+    "Rate in Hz at which clients commit, 0 to follow frame callbacks "
+    "(default: 0)",
+    "HZ"
+  },
+  {
+    "width", 0, 0, G_OPTION_ARG_INT,
+    &width,
+    "Width of the virtual monitor (default: 1920)",
+    "WIDTH"
+  },
+  {
+    "height", 0, 0, G_OPTION_ARG_INT,
+    &height,
+    "Height of the virtual monitor (default: 1080)",
+    "HEIGHT"
+  },
+  {
+    "refresh-rate", 0, 0, G_OPTION_ARG_DOUBLE,
+    &refresh_rate,
+    "Refresh rate of the virtual monitor (default: 60)",
+    "HZ"
+  },
+  {
+    "warmup", 0, 0, G_OPTION_ARG_DOUBLE,
+    &warmup_seconds,
+    "Seconds to run before recording (default: 1)",
+    "SECONDS"
+  },
+  {
+    "duration", 0, 0, G_OPTION_ARG_DOUBLE,
+    &duration_seconds,
+    "Seconds to record frames for (default: 5)",
+    "SECONDS"
+  },
+  { NULL }
+};
+
+static void
+bench_view_state_free (BenchViewState *view_state)
+{
+  g_queue_clear_full (&view_state->pending_frames, g_free);
+  g_free (view_state);
+}
+
+static BenchViewState *
+ensure_view_state (Bench            *bench,
+                   ClutterStageView *view)
+{
+  BenchViewState *view_state;
+
+  view_state = g_hash_table_lookup (bench->view_states, view);
+  if (!view_state)
+    {
+      view_state = g_new0 (BenchViewState, 1);
+      g_queue_init (&view_state->pending_frames);
+      g_hash_table_insert (bench->view_states, view, view_state);
+    }
+
+  return view_state;
+}
+
+static void
+add_sample (Bench       *bench,
+            BenchMetric  metric,
+            int64_t      value_us)
+{
+  if (!bench->recording)
+    return;
+
+  g_array_append_val (bench->samples[metric], value_us);
+}
+
+static void
+on_before_update (ClutterStage     *stage,
+                  ClutterStageView *view,
+                  ClutterFrame     *frame,
+                  Bench            *bench)
+{
+  BenchViewState *view_state = ensure_view_state (bench, view);
+
+  view_state->update_start_us = g_get_monotonic_time ();
+}
+
+static void
+on_before_paint (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 ClutterFrame     *frame,
+                 Bench            *bench)
+{
+  BenchViewState *view_state = ensure_view_state (bench, view);
+
+  view_state->paint_start_us = g_get_monotonic_time ();
+}
+
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame,
+                Bench            *bench)
+{
+  BenchViewState *view_state = ensure_view_state (bench, view);
+  int64_t *update_start_us;
+
+  add_sample (bench, BENCH_METRIC_PAINT,
+              g_get_monotonic_time () - view_state->paint_start_us);
+
+  /* Only painted frames end up being presented */
+  update_start_us = g_new (int64_t, 1);
+  *update_start_us = view_state->update_start_us;
+  g_queue_push_tail (&view_state->pending_frames, update_start_us);
+}
+
+static void
+on_after_update (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 ClutterFrame     *frame,
+                 Bench            *bench)
+{
+  BenchViewState *view_state = ensure_view_state (bench, view);
+
+  add_sample (bench, BENCH_METRIC_DISPATCH,
+              g_get_monotonic_time () - view_state->update_start_us);
+}
+
+static void
+on_presented (ClutterStage     *stage,
+              ClutterStageView *view,
+              ClutterFrameInfo *frame_info,
+              Bench            *bench)
+{
+  BenchViewState *view_state = ensure_view_state (bench, view);
+  g_autofree int64_t *update_start_us = NULL;
+
+  update_start_us = g_queue_pop_head (&view_state->pending_frames);
+  if (!update_start_us)
+    return;
+
+  if (bench->recording)
+    bench->n_presented_frames++;
+
+  if (frame_info->has_valid_gpu_rendering_duration)
+    {
+      add_sample (bench, BENCH_METRIC_GPU,
+                  frame_info->gpu_rendering_duration_ns / 1000);
+    }
+
+  if (frame_info->presentation_time > 0)
+    {
+      add_sample (bench, BENCH_METRIC_PRESENTATION,
+                  frame_info->presentation_time - *update_start_us);
+    }
+}
+
+static int
+compare_samples (gconstpointer a,
+                 gconstpointer b)
+{
+  int64_t sample_a = *(const int64_t *) a;
+  int64_t sample_b = *(const int64_t *) b;
+
+  if (sample_a < sample_b)
+    return -1;
+  else if (sample_a > sample_b)
+    return 1;
+  else
+    return 0;
+}
+
+static int64_t
+get_percentile (GArray *sorted_samples,
+                int     percentile)
+{
+  unsigned int rank;
+
+  rank = (sorted_samples->len * percentile + 99) / 100;
+  rank = CLAMP (rank, 1, sorted_samples->len);
+
+  return g_array_index (sorted_samples, int64_t, rank - 1);
+}
+
+static void
+print_results (Bench   *bench,
+               int64_t  recorded_us)
+{
+  g_autofree char *commit_rate_string = NULL;
+  BenchMetric metric;
+
+  if (commit_rate > 0.0)
+    commit_rate_string = g_strdup_printf ("%.2f Hz", commit_rate);
+  else
+    commit_rate_string = g_strdup ("frame callbacks");
+
+  g_print ("# clients: %d, commit rate: %s, monitor: %dx%d@%.2f\n",
+           n_clients, commit_rate_string,
+           width, height, refresh_rate);
+  g_print ("# presented %d frames in %.2f s (%.2f fps)\n",
+           bench->n_presented_frames,
+           recorded_us / (double) G_USEC_PER_SEC,
+           bench->n_presented_frames * (double) G_USEC_PER_SEC / recorded_us);
+  g_print ("%-14s %8s %10s %10s %10s %10s\n",
+           "metric (us)", "samples", "p50", "p90", "p99", "max");
+
+  for (metric = 0; metric < BENCH_N_METRICS; metric++)
+    {
+      GArray *samples = bench->samples[metric];
+
+      if (samples->len == 0)
+        {
+          g_print ("%-14s %8u %10s %10s %10s %10s\n",
+                   bench_metric_names[metric], 0, "-", "-", "-", "-");
+          continue;
+        }
+
+      g_array_sort (samples, compare_samples);
+
+      g_print ("%-14s %8u %10" G_GINT64_FORMAT " %10" G_GINT64_FORMAT
+               " %10" G_GINT64_FORMAT " %10" G_GINT64_FORMAT "\n",
+               bench_metric_names[metric],
+               samples->len,
+               get_percentile (samples, 50),
+               get_percentile (samples, 90),
+               get_percentile (samples, 99),
+               g_array_index (samples, int64_t, samples->len - 1));
+    }
+}
+
+static void
+run_main_loop_for (double seconds)
+{
+  int64_t end_time_us;
+
+  end_time_us = g_get_monotonic_time () + (int64_t) (seconds * G_USEC_PER_SEC);
+
+  while (g_get_monotonic_time () < end_time_us)
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static void
+bench_frame_latency (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (test_context);
+  g_autoptr (MetaVirtualMonitor) virtual_monitor = NULL;
+  g_autoptr (MetaWaylandTestDriver) test_driver = NULL;
+  g_autoptr (GPtrArray) clients = NULL;
+  char commit_rate_buf[G_ASCII_DTOSTR_BUF_SIZE];
+  Bench bench = { 0 };
+  BenchMetric metric;
+  int64_t record_start_us;
+  int64_t recorded_us;
+  gulong handler_ids[5];
+  int i;
+
+  virtual_monitor = meta_create_test_monitor (test_context,
+                                              width, height,
+                                              (float) refresh_rate);
+  test_driver = meta_wayland_test_driver_new (compositor);
+
+  bench.stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  bench.view_states =
+    g_hash_table_new_full (NULL, NULL,
+                           NULL, (GDestroyNotify) bench_view_state_free);
+  for (metric = 0; metric < BENCH_N_METRICS; metric++)
+    bench.samples[metric] = g_array_new (FALSE, FALSE, sizeof (int64_t));
+
+  handler_ids[0] = g_signal_connect (bench.stage, "before-update",
+                                     G_CALLBACK (on_before_update), &bench);
+  handler_ids[1] = g_signal_connect (bench.stage, "before-paint",
+                                     G_CALLBACK (on_before_paint), &bench);
+  handler_ids[2] = g_signal_connect (bench.stage, "after-paint",
+                                     G_CALLBACK (on_after_paint), &bench);
+  handler_ids[3] = g_signal_connect (bench.stage, "after-update",
+                                     G_CALLBACK (on_after_update), &bench);
+  handler_ids[4] = g_signal_connect (bench.stage, "presented",
+                                     G_CALLBACK (on_presented), &bench);
+
+  g_ascii_dtostr (commit_rate_buf, sizeof (commit_rate_buf), commit_rate);
+
+  clients = g_ptr_array_new ();
+  for (i = 0; i < n_clients; i++)
+    {
+      g_autofree char *title = g_strdup_printf ("frame-load-%d", i);
+
+      g_ptr_array_add (clients,
+                       meta_wayland_test_client_new_with_args (test_context,
+                                                               "frame-load",
+                                                               title,
+                                                               commit_rate_buf,
+                                                               NULL));
+      meta_wait_for_client_window (test_context, title);
+    }
+
+  run_main_loop_for (warmup_seconds);
+
+  bench.recording = TRUE;
+  record_start_us = g_get_monotonic_time ();
+  run_main_loop_for (duration_seconds);
+  recorded_us = g_get_monotonic_time () - record_start_us;
+  bench.recording = FALSE;
+
+  meta_wayland_test_driver_emit_sync_event (test_driver, 0);
+  for (i = 0; i < clients->len; i++)
+    meta_wayland_test_client_finish (g_ptr_array_index (clients, i));
+
+  for (i = 0; i < G_N_ELEMENTS (handler_ids); i++)
+    g_signal_handler_disconnect (bench.stage, handler_ids[i]);
+
+  print_results (&bench, recorded_us);
+
+  g_assert_cmpint (bench.n_presented_frames, >, 0);
+
+  for (metric = 0; metric < BENCH_N_METRICS; metric++)
+    g_array_unref (bench.samples[metric]);
+  g_hash_table_destroy (bench.view_states);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      (META_CONTEXT_TEST_FLAG_NO_X11 |
+                                       META_CONTEXT_TEST_FLAG_NO_ANIMATIONS));
+  meta_context_add_option_entries (context, bench_options, NULL);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  if (n_clients < 0 || width <= 0 || height <= 0 || refresh_rate <= 0.0 ||
+      commit_rate < 0.0 || warmup_seconds < 0.0 || duration_seconds <= 0.0)
+    {
+      g_printerr ("Invalid benchmark parameters\n");
+      return EXIT_FAILURE;
+    }
+
+  test_context = context;
+
+  g_test_add_func ("/bench/frame-latency", bench_frame_latency);
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
@@ -827,6 +827,25 @@ meta_create_monitor_test_setup (MetaBackend          *backend,
       test_setup->outputs = g_list_append (test_setup->outputs, output);
     }
 
+  for (i = 0; i < setup->n_outputs; i++)
+    {
+      MetaOutput *output = g_list_nth_data (test_setup->outputs, i);
+      int j;
+
+      if (!setup->outputs[i].can_clone)
+        continue;
+
+      for (j = 0; j < setup->n_outputs; j++)
+        {
+          if (j == i || !setup->outputs[j].can_clone)
+            continue;
+
+          meta_output_add_possible_clone (output,
+                                          g_list_nth_data (test_setup->outputs,
+                                                           j));
+        }
+    }
+
   return test_setup;
 }
 
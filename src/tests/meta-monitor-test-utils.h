@@ -118,6 +118,8 @@ typedef struct _MonitorTestCaseOutput
   int backlight_max;
   gboolean has_edid_info;
   MetaEdidInfo edid_info;
+  /* Whether the output can be cloned with the other outputs that can */
+  gboolean can_clone;
 } MonitorTestCaseOutput;
 
 typedef struct _MonitorTestCaseCrtc
@@ -7484,6 +7484,146 @@ meta_test_monitor_custom_mirrored_config (void)
   check_monitor_test_clients_state ();
 }
 
+static void
+meta_test_monitor_custom_mirrored_clone_config (void)
+{
+  MonitorTestCase test_case = {
+    .setup = {
+      .modes = {
+        {
+          .width = 800,
+          .height = 600,
+          .refresh_rate = 60.000495910644531
+        }
+      },
+      .n_modes = 1,
+      .outputs = {
+        {
+          .crtc = 0,
+          .modes = { 0 },
+          .n_modes = 1,
+          .preferred_mode = 0,
+          .possible_crtcs = { 0, 1 },
+          .n_possible_crtcs = 2,
+          .width_mm = 222,
+          .height_mm = 125,
+          .serial = "0x123456a",
+          .can_clone = TRUE,
+        },
+        {
+          .crtc = 1,
+          .modes = { 0 },
+          .n_modes = 1,
+          .preferred_mode = 0,
+          .possible_crtcs = { 0, 1 },
+          .n_possible_crtcs = 2,
+          .width_mm = 220,
+          .height_mm = 124,
+          .serial = "0x123456b",
+          .can_clone = TRUE,
+        }
+      },
+      .n_outputs = 2,
+      .crtcs = {
+        {
+          .current_mode = 0
+        },
+        {
+          .current_mode = 0
+        }
+      },
+      .n_crtcs = 2
+    },
+
+    .expect = {
+      .monitors = {
+        {
+          .outputs = { 0 },
+          .n_outputs = 1,
+          .modes = {
+            {
+              .width = 800,
+              .height = 600,
+              .refresh_rate = 60.000495910644531,
+              .crtc_modes = {
+                {
+                  .output = 0,
+                  .crtc_mode = 0
+                }
+              }
+            }
+          },
+          .n_modes = 1,
+          .current_mode = 0,
+          .width_mm = 222,
+          .height_mm = 125
+        },
+        {
+          .outputs = { 1 },
+          .n_outputs = 1,
+          .modes = {
+            {
+              .width = 800,
+              .height = 600,
+              .refresh_rate = 60.000495910644531,
+              .crtc_modes = {
+                {
+                  .output = 1,
+                  .crtc_mode = 0
+                }
+              }
+            }
+          },
+          .n_modes = 1,
+          .current_mode = 0,
+          .width_mm = 220,
+          .height_mm = 124
+        }
+      },
+      .n_monitors = 2,
+      .logical_monitors = {
+        {
+          .monitors = { 0, 1 },
+          .n_monitors = 2,
+          .layout = { .x = 0, .y = 0, .width = 800, .height = 600 },
+          .scale = 1
+        }
+      },
+      .n_logical_monitors = 1,
+      .primary_logical_monitor = 0,
+      .n_outputs = 2,
+      .crtcs = {
+        {
+          .current_mode = 0,
+        },
+        {
+          .current_mode = -1,
+        }
+      },
+      .n_crtcs = 2,
+      .n_tiled_monitors = 0,
+      .screen_width = 800,
+      .screen_height = 600
+    }
+  };
+  MetaMonitorTestSetup *test_setup;
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+
+  test_setup = meta_create_monitor_test_setup (test_backend,
+                                               &test_case.setup,
+                                               MONITOR_TEST_FLAG_NONE);
+  meta_set_custom_monitor_config (test_context, "mirrored.xml");
+  emulate_hotplug (test_setup);
+
+  /* Both outputs are driven by the first CRTC, painted by a single view */
+  META_TEST_LOG_CALL ("Checking monitor configuration",
+                      meta_check_monitor_configuration (test_context,
+                                                        &test_case.expect));
+  g_assert_cmpuint (g_list_length (meta_renderer_get_views (renderer)), ==, 1);
+  check_monitor_test_clients_state ();
+}
+
 static void
 meta_test_monitor_custom_first_rotated_config (void)
 {
@@ -10867,6 +11007,8 @@ init_monitor_tests (void)
                     meta_test_monitor_custom_tiled_non_preferred_config);
   add_monitor_test ("/backends/monitor/custom/mirrored-config",
                     meta_test_monitor_custom_mirrored_config);
+  add_monitor_test ("/backends/monitor/custom/mirrored-clone-config",
+                    meta_test_monitor_custom_mirrored_clone_config);
   add_monitor_test ("/backends/monitor/custom/first-rotated-config",
                     meta_test_monitor_custom_first_rotated_config);
   add_monitor_test ("/backends/monitor/custom/second-rotated-config",
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays the region operations done per frame by the damage tracking of
+ * the stage and by MetaCullable for a scene of many windows, and reports
+ * the time spent per frame.
+ */
+
+#include "config.h"
+#include "mtk/mtk.h"
+
+#include <glib.h>
+#include <stdlib.h>
+
+#include "tests/perf-report.h"
+
+#define STAGE_WIDTH 3840
+#define STAGE_HEIGHT 2160
+
+typedef struct _BenchWindow
+{
+  graphene_matrix_t transform;
+  graphene_matrix_t inverse_transform;
+  MtkRectangle opaque_rect;
+  MtkRectangle damage_rect;
+} BenchWindow;
+
+static int n_windows = 128;
+static int n_frames = 2000;
+static int n_warmup_frames = 200;
+static int n_runs = 7;
+static int n_damaged_windows = 8;
+static unsigned int seed = 42;
+
+static const GOptionEntry options[] = {
+  {
+    "windows", 0, 0, G_OPTION_ARG_INT,
+    &n_windows,
+    "Number of windows in the scene (default: 128)",
+    "N"
+  },
+  {
+    "frames", 0, 0, G_OPTION_ARG_INT,
+    &n_frames,
+    "Number of frames to process per run (default: 2000)",
+    "N"
+  },
+  {
+    "warmup-frames", 0, 0, G_OPTION_ARG_INT,
+    &n_warmup_frames,
+    "Number of frames to process before measuring (default: 200)",
+    "N"
+  },
+  {
+    "runs", 0, 0, G_OPTION_ARG_INT,
+    &n_runs,
+    "Number of measured runs (default: 7)",
+    "N"
+  },
+  {
+    "damaged-windows", 0, 0, G_OPTION_ARG_INT,
+    &n_damaged_windows,
+    "Number of windows damaged each frame (default: 8)",
+    "N"
+  },
+  { NULL }
+};
+
+static BenchWindow *
+create_windows (GRand *rng)
+{
+  BenchWindow *windows;
+  int i;
+
+  windows = g_new0 (BenchWindow, n_windows);
+  for (i = 0; i < n_windows; i++)
+    {
+      BenchWindow *window = &windows[i];
+      int width, height, x, y;
+
+      width = g_rand_int_range (rng, 200, 1600);
+      height = g_rand_int_range (rng, 150, 1000);
+      x = g_rand_int_range (rng, -100, STAGE_WIDTH - width / 2);
+      y = g_rand_int_range (rng, -100, STAGE_HEIGHT - height / 2);
+
+      graphene_matrix_init_translate (&window->transform,
+                                      &GRAPHENE_POINT3D_INIT (x, y, 0));
+      graphene_matrix_init_translate (&window->inverse_transform,
+                                      &GRAPHENE_POINT3D_INIT (-x, -y, 0));
+
+      /* Leave room for client side shadows and rounded corners */
+      window->opaque_rect = MTK_RECTANGLE_INIT (24, 24 + 8,
+                                                width - 48,
+                                                height - 48 - 16);
+      window->damage_rect = MTK_RECTANGLE_INIT (x, y, width, height);
+    }
+
+  return windows;
+}
+
+static MtkRegion *
+accumulate_damage (BenchWindow *windows,
+                   GRand       *rng)
+{
+  MtkRegion *damage;
+  int i;
+
+  damage = mtk_region_create ();
+
+  for (i = 0; i < n_damaged_windows; i++)
+    {
+      BenchWindow *window = &windows[g_rand_int_range (rng, 0, n_windows)];
+      MtkRectangle rect = window->damage_rect;
+
+      /* Clients mostly damage parts of their surface */
+      rect.width = MAX (rect.width / 3, 1);
+      rect.height = MAX (rect.height / 4, 1);
+
+      mtk_region_union_rectangle (damage, &rect);
+    }
+
+  return damage;
+}
+
+static void
+cull_windows (BenchWindow *windows,
+              MtkRegion   *clip_region)
+{
+  int i;
+
+  for (i = n_windows - 1; i >= 0; i--)
+    {
+      BenchWindow *window = &windows[i];
+      g_autoptr (MtkRegion) window_region = NULL;
+      g_autoptr (MtkRegion) window_clip = NULL;
+      g_autoptr (MtkRegion) reduced_region = NULL;
+
+      window_region =
+        mtk_region_apply_matrix_transform_expand (clip_region,
+                                                  &window->inverse_transform);
+
+      /* What the surface keeps around to clip its painting with */
+      window_clip = mtk_region_copy (window_region);
+
+      mtk_region_subtract_rectangle (window_region, &window->opaque_rect);
+
+      reduced_region =
+        mtk_region_apply_matrix_transform_expand (window_region,
+                                                  &window->transform);
+      mtk_region_intersect (clip_region, reduced_region);
+    }
+}
+
+static void
+process_frames (BenchWindow *windows,
+                GRand       *rng,
+                int          frames)
+{
+  int frame;
+
+  for (frame = 0; frame < frames; frame++)
+    {
+      g_autoptr (MtkRegion) damage = NULL;
+      g_autoptr (MtkRegion) clip_region = NULL;
+
+      damage = accumulate_damage (windows, rng);
+
+      /* Every other frame repaints the whole stage */
+      if (frame % 2 == 0)
+        {
+          clip_region = mtk_region_copy (damage);
+        }
+      else
+        {
+          clip_region =
+            mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (0, 0,
+                                                              STAGE_WIDTH,
+                                                              STAGE_HEIGHT));
+        }
+
+      cull_windows (windows, clip_region);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (GOptionContext) option_context = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree BenchWindow *windows = NULL;
+  g_autoptr (PerfReport) report = NULL;
+  GRand *rng;
+  int run;
+
+  option_context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (option_context, options, NULL);
+  if (!g_option_context_parse (option_context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  if (n_windows <= 0 || n_frames <= 0 || n_warmup_frames < 0 ||
+      n_runs <= 0 || n_damaged_windows < 0)
+    {
+      g_printerr ("Invalid benchmark parameters\n");
+      return EXIT_FAILURE;
+    }
+
+  rng = g_rand_new_with_seed (seed);
+  windows = create_windows (rng);
+
+  report = perf_report_new ("region", "us/frame", n_warmup_frames, n_frames);
+  perf_report_add_parameter (report, "windows", n_windows);
+  perf_report_add_parameter (report, "damaged_windows", n_damaged_windows);
+
+  process_frames (windows, rng, n_warmup_frames);
+
+  for (run = 0; run < n_runs; run++)
+    {
+      int64_t start_us, elapsed_us;
+
+      start_us = g_get_monotonic_time ();
+      process_frames (windows, rng, n_frames);
+      elapsed_us = g_get_monotonic_time () - start_us;
+
+      perf_report_add_run (report, elapsed_us / (double) n_frames);
+    }
+
+  perf_report_print (report);
+
+  g_rand_free (rng);
+
+  return EXIT_SUCCESS;
+}
@@ -76,6 +76,165 @@ test_region (void)
   g_assert_cmpint (extents.height, ==, rect.height);
 }
 
+static MtkRegion *
+create_test_region (void)
+{
+  const MtkRectangle rects[] = {
+    MTK_RECTANGLE_INIT (0, 0, 10, 10),
+    MTK_RECTANGLE_INIT (20, 0, 10, 10),
+    MTK_RECTANGLE_INIT (5, 10, 30, 5),
+    MTK_RECTANGLE_INIT (-7, 15, 3, 2),
+  };
+
+  return mtk_region_create_rectangles (rects, G_N_ELEMENTS (rects));
+}
+
+static MtkRegion *
+scale_translate_rectangles (MtkRegion *region,
+                            int        x_scale,
+                            int        y_scale,
+                            int        dx,
+                            int        dy)
+{
+  g_autofree MtkRectangle *rects = NULL;
+  int n_rects, i;
+
+  n_rects = mtk_region_num_rectangles (region);
+  rects = g_new (MtkRectangle, n_rects);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+
+      rects[i] = MTK_RECTANGLE_INIT (rect.x * x_scale + dx,
+                                     rect.y * y_scale + dy,
+                                     rect.width * x_scale,
+                                     rect.height * y_scale);
+    }
+
+  return mtk_region_create_rectangles (rects, n_rects);
+}
+
+static void
+test_scale (void)
+{
+  g_autoptr (MtkRegion) region = NULL;
+  g_autoptr (MtkRegion) single = NULL;
+  int scale;
+
+  region = create_test_region ();
+  single = mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (-3, 4, 5, 6));
+
+  for (scale = 1; scale <= 3; scale++)
+    {
+      g_autoptr (MtkRegion) scaled = NULL;
+      g_autoptr (MtkRegion) expected = NULL;
+      g_autoptr (MtkRegion) scaled_single = NULL;
+      g_autoptr (MtkRegion) expected_single = NULL;
+      MtkRectangle extents, expected_extents;
+
+      scaled = mtk_region_scale (region, scale);
+      expected = scale_translate_rectangles (region, scale, scale, 0, 0);
+      g_assert_true (mtk_region_equal (scaled, expected));
+      g_assert_cmpint (mtk_region_num_rectangles (scaled), ==,
+                       mtk_region_num_rectangles (region));
+
+      extents = mtk_region_get_extents (scaled);
+      expected_extents = mtk_region_get_extents (expected);
+      g_assert_true (mtk_rectangle_equal (&extents, &expected_extents));
+
+      scaled_single = mtk_region_scale (single, scale);
+      expected_single = scale_translate_rectangles (single, scale, scale, 0, 0);
+      g_assert_true (mtk_region_equal (scaled_single, expected_single));
+    }
+}
+
+static void
+test_apply_matrix_transform (void)
+{
+  g_autoptr (MtkRegion) region = NULL;
+  g_autoptr (MtkRegion) empty = NULL;
+  g_autoptr (MtkRegion) transformed = NULL;
+  g_autoptr (MtkRegion) expected = NULL;
+  graphene_matrix_t matrix;
+  MtkRectangle extents;
+
+  region = create_test_region ();
+
+  graphene_matrix_init_translate (&matrix,
+                                  &GRAPHENE_POINT3D_INIT (-13, 7, 0));
+  transformed = mtk_region_apply_matrix_transform_expand (region, &matrix);
+  expected = scale_translate_rectangles (region, 1, 1, -13, 7);
+  g_assert_true (mtk_region_equal (transformed, expected));
+  g_clear_pointer (&transformed, mtk_region_unref);
+  g_clear_pointer (&expected, mtk_region_unref);
+
+  graphene_matrix_init_scale (&matrix, 2, 3, 1);
+  graphene_matrix_translate (&matrix, &GRAPHENE_POINT3D_INIT (5, -4, 0));
+  transformed = mtk_region_apply_matrix_transform_expand (region, &matrix);
+  expected = scale_translate_rectangles (region, 2, 3, 5, -4);
+  g_assert_true (mtk_region_equal (transformed, expected));
+  g_clear_pointer (&transformed, mtk_region_unref);
+  g_clear_pointer (&expected, mtk_region_unref);
+
+  /* Fractional transforms grow to the enclosing pixels */
+  graphene_matrix_init_scale (&matrix, 0.5, 0.5, 1);
+  graphene_matrix_translate (&matrix, &GRAPHENE_POINT3D_INIT (0.25, 0, 0));
+  transformed = mtk_region_apply_matrix_transform_expand (region, &matrix);
+  extents = mtk_region_get_extents (transformed);
+  g_assert_cmpint (extents.x, ==, -4);
+  g_assert_cmpint (extents.y, ==, 0);
+  g_assert_cmpint (extents.width, ==, 22);
+  g_assert_cmpint (extents.height, ==, 9);
+  g_clear_pointer (&transformed, mtk_region_unref);
+
+  empty = mtk_region_create ();
+  graphene_matrix_init_translate (&matrix,
+                                  &GRAPHENE_POINT3D_INIT (10, 10, 0));
+  transformed = mtk_region_apply_matrix_transform_expand (empty, &matrix);
+  g_assert_true (mtk_region_is_empty (transformed));
+}
+
+static gpointer
+unref_region_thread_func (gpointer data)
+{
+  mtk_region_unref (data);
+
+  return NULL;
+}
+
+static void
+test_ref_count (void)
+{
+  g_autoptr (MtkRegion) region = NULL;
+  MtkRegion *other;
+  GThread *thread;
+  int i;
+
+  region = create_test_region ();
+  other = mtk_region_ref (region);
+  g_assert_true (other == region);
+  mtk_region_unref (other);
+  g_assert_cmpint (mtk_region_num_rectangles (region), ==, 4);
+
+  /* Exercise reusing freed regions */
+  for (i = 0; i < 1000; i++)
+    {
+      g_autoptr (MtkRegion) copy = NULL;
+      g_autoptr (MtkRegion) rect = NULL;
+
+      copy = mtk_region_copy (region);
+      rect = mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (i, i, 1, 1));
+      mtk_region_union (copy, rect);
+      g_assert_true (mtk_region_contains_point (copy, i, i));
+    }
+
+  /* Regions can be freed on another thread than they were created on */
+  thread = g_thread_new ("unref region",
+                         unref_region_thread_func,
+                         mtk_region_copy (region));
+  g_thread_join (thread);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -85,6 +244,10 @@ main (int    argc,
   g_test_add_func ("/mtk/region/region", test_region);
   g_test_add_func ("/mtk/region/contains-point", test_contains_point);
   g_test_add_func ("/mtk/region/translate", test_translate);
+  g_test_add_func ("/mtk/region/scale", test_scale);
+  g_test_add_func ("/mtk/region/apply-matrix-transform",
+                   test_apply_matrix_transform);
+  g_test_add_func ("/mtk/region/ref-count", test_ref_count);
 
   return g_test_run ();
 }
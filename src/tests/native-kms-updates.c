@@ -280,11 +280,12 @@ typedef struct _PageFlipData
 } PageFlipData;
 
 static void
-page_flip_feedback_flipped (MetaKmsCrtc  *kms_crtc,
-                            unsigned int  sequence,
-                            unsigned int  tv_sec,
-                            unsigned int  tv_usec,
-                            gpointer      user_data)
+page_flip_feedback_flipped (MetaKmsCrtc         *kms_crtc,
+                            unsigned int         sequence,
+                            unsigned int         tv_sec,
+                            unsigned int         tv_usec,
+                            MetaKmsPageFlipFlag  flags,
+                            gpointer             user_data)
 {
   PageFlipData *data = user_data;
 
@@ -109,6 +109,69 @@ queue_callback_func (MetaThreadImpl  *thread_impl,
   return GINT_TO_POINTER (TRUE);
 }
 
+#define N_BATCHED_CALLBACKS 100
+
+typedef struct
+{
+  int n_dispatched;
+  int n_destroyed;
+} BatchData;
+
+typedef struct
+{
+  BatchData *batch_data;
+  int index;
+} BatchedCallbackData;
+
+static void
+batched_callback_func (MetaThread *thread,
+                       gpointer    user_data)
+{
+  BatchedCallbackData *callback_data = user_data;
+  BatchData *batch_data = callback_data->batch_data;
+
+  meta_assert_not_in_thread_impl (thread);
+
+  g_assert_cmpint (callback_data->index, ==, batch_data->n_dispatched);
+  batch_data->n_dispatched++;
+}
+
+static void
+batched_callback_destroy (gpointer user_data)
+{
+  BatchedCallbackData *callback_data = user_data;
+
+  callback_data->batch_data->n_destroyed++;
+  g_free (callback_data);
+}
+
+static gpointer
+queue_batched_callbacks_func (MetaThreadImpl  *thread_impl,
+                              gpointer         user_data,
+                              GError         **error)
+{
+  BatchData *batch_data = user_data;
+  int i;
+
+  meta_assert_in_thread_impl (meta_thread_impl_get_thread (thread_impl));
+
+  for (i = 0; i < N_BATCHED_CALLBACKS; i++)
+    {
+      BatchedCallbackData *callback_data;
+
+      callback_data = g_new0 (BatchedCallbackData, 1);
+      callback_data->batch_data = batch_data;
+      callback_data->index = i;
+      meta_thread_queue_callback (meta_thread_impl_get_thread (thread_impl),
+                                  NULL,
+                                  batched_callback_func,
+                                  callback_data,
+                                  batched_callback_destroy);
+    }
+
+  return GINT_TO_POINTER (TRUE);
+}
+
 typedef struct
 {
   int fd;
@@ -642,6 +705,8 @@ run_thread_tests (MetaThread *thread)
   GError *error = NULL;
   gpointer retval;
   int state;
+  BatchData batch_data;
+  int i;
   int fds[2];
   int buf;
   PipeData pipe_data;
@@ -679,6 +744,19 @@ run_thread_tests (MetaThread *thread)
   meta_thread_flush_callbacks (thread);
   g_assert_cmpint (state, ==, 3);
 
+  /* Test that batches of callbacks are dispatched in order, twice, to
+   * exercise both the initial and the recycled callback queue. */
+  g_debug ("Test batched callbacks");
+  for (i = 0; i < 2; i++)
+    {
+      batch_data = (BatchData) { 0 };
+      meta_thread_run_impl_task_sync (thread, queue_batched_callbacks_func,
+                                      &batch_data, NULL);
+      while (g_main_context_iteration (NULL, FALSE));
+      g_assert_cmpint (batch_data.n_dispatched, ==, N_BATCHED_CALLBACKS);
+      g_assert_cmpint (batch_data.n_destroyed, ==, N_BATCHED_CALLBACKS);
+    }
+
   /* Test fd source */
   g_debug ("Test fd source");
   pipe_data = (PipeData) { 0 };
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Reporting shared by the performance tests. A test measures the same
+ * thing in a number of runs, after a warmup that isn't measured, and
+ * reports the median of the runs and their median absolute deviation,
+ * which unlike the mean and the standard deviation aren't thrown off by
+ * the occasional run that got preempted.
+ *
+ * The report is a single JSON object, written to the file named by
+ * MUTTER_PERF_REPORT_FILE, appending if it exists, or to stdout, so that
+ * results of different releases can be collected and compared by tools.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <glib.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct _PerfReport
+{
+  char *name;
+  char *unit;
+  int warmup_iterations;
+  int iterations_per_run;
+  GArray *runs;
+  GString *parameters;
+} PerfReport;
+
+static inline PerfReport *
+perf_report_new (const char *name,
+                 const char *unit,
+                 int         warmup_iterations,
+                 int         iterations_per_run)
+{
+  PerfReport *report;
+
+  report = g_new0 (PerfReport, 1);
+  report->name = g_strdup (name);
+  report->unit = g_strdup (unit);
+  report->warmup_iterations = warmup_iterations;
+  report->iterations_per_run = iterations_per_run;
+  report->runs = g_array_new (FALSE, FALSE, sizeof (double));
+  report->parameters = g_string_new (NULL);
+
+  return report;
+}
+
+static inline void
+perf_report_free (PerfReport *report)
+{
+  g_free (report->name);
+  g_free (report->unit);
+  g_array_unref (report->runs);
+  g_string_free (report->parameters, TRUE);
+  g_free (report);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PerfReport, perf_report_free)
+
+static inline void
+perf_report_add_parameter (PerfReport *report,
+                           const char *name,
+                           int         value)
+{
+  g_string_append_printf (report->parameters, "%s\"%s\": %d",
+                          report->parameters->len > 0 ? ", " : "",
+                          name, value);
+}
+
+/* Adds the result of one run, e.g. the mean time per iteration */
+static inline void
+perf_report_add_run (PerfReport *report,
+                     double      value)
+{
+  g_array_append_val (report->runs, value);
+}
+
+static inline int
+perf_report_compare_doubles (gconstpointer a,
+                             gconstpointer b)
+{
+  double value_a = *(const double *) a;
+  double value_b = *(const double *) b;
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+static inline double
+perf_report_median (const double *values,
+                    int           n_values)
+{
+  g_autofree double *sorted = NULL;
+
+  if (n_values == 0)
+    return NAN;
+
+  sorted = g_memdup2 (values, n_values * sizeof (double));
+  qsort (sorted, n_values, sizeof (double), perf_report_compare_doubles);
+
+  if (n_values % 2 == 1)
+    return sorted[n_values / 2];
+  else
+    return (sorted[n_values / 2 - 1] + sorted[n_values / 2]) / 2.0;
+}
+
+static inline void
+perf_report_print (PerfReport *report)
+{
+  const double *runs = (const double *) report->runs->data;
+  int n_runs = (int) report->runs->len;
+  g_autofree double *deviations = NULL;
+  g_autoptr (GString) json = NULL;
+  const char *report_file;
+  double median;
+  double mad;
+  int i;
+
+  median = perf_report_median (runs, n_runs);
+
+  deviations = g_new0 (double, MAX (n_runs, 1));
+  for (i = 0; i < n_runs; i++)
+    deviations[i] = fabs (runs[i] - median);
+  mad = perf_report_median (deviations, n_runs);
+
+  json = g_string_new ("{");
+  g_string_append_printf (json, "\"name\": \"%s\", ", report->name);
+  g_string_append_printf (json, "\"unit\": \"%s\", ", report->unit);
+  g_string_append_printf (json, "\"parameters\": {%s}, ",
+                          report->parameters->str);
+  g_string_append_printf (json, "\"warmup_iterations\": %d, ",
+                          report->warmup_iterations);
+  g_string_append_printf (json, "\"iterations_per_run\": %d, ",
+                          report->iterations_per_run);
+  g_string_append (json, "\"runs\": [");
+  for (i = 0; i < n_runs; i++)
+    g_string_append_printf (json, "%s%.3f", i > 0 ? ", " : "", runs[i]);
+  g_string_append (json, "], ");
+  g_string_append_printf (json, "\"median\": %.3f, ", median);
+  g_string_append_printf (json, "\"mad\": %.3f", mad);
+  g_string_append (json, "}\n");
+
+  report_file = g_getenv ("MUTTER_PERF_REPORT_FILE");
+  if (report_file)
+    {
+      FILE *file;
+
+      file = fopen (report_file, "a");
+      if (!file)
+        {
+          g_warning ("Failed to open %s: %s",
+                     report_file, g_strerror (errno));
+          return;
+        }
+
+      fputs (json->str, file);
+      fclose (file);
+    }
+  else
+    {
+      g_print ("%s", json->str);
+    }
+}
+
+static inline int
+perf_report_get_env_int (const char *variable,
+                         int         default_value)
+{
+  const char *value;
+  uint64_t parsed;
+
+  value = g_getenv (variable);
+  if (!value)
+    return default_value;
+
+  if (!g_ascii_string_to_unsigned (value, 10, 1, G_MAXINT, &parsed, NULL))
+    {
+      g_warning ("Invalid %s '%s', using %d", variable, value, default_value);
+      return default_value;
+    }
+
+  return (int) parsed;
+}
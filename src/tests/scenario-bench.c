@@ -0,0 +1,577 @@
+/*
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays scripted scenarios on virtual monitors and measures the
+ * rendering work each of them causes per painted frame.
+ *
+ * For each scenario, the CPU paint duration is taken from the stage paint
+ * signals and the GPU rendering duration from the presentation feedback,
+ * while the number of journal flushes, program links and texture and
+ * buffer allocations is taken from the Cogl render stats.
+ *
+ * Results are printed as one JSON object per scenario and line, so that
+ * they can be collected and compared across releases.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "backends/meta-virtual-monitor.h"
+#include "meta-test/meta-context-test.h"
+#include "meta/meta-workspace-manager.h"
+#include "meta/workspace.h"
+#include "tests/meta-test-utils.h"
+#include "tests/meta-wayland-test-driver.h"
+#include "tests/meta-wayland-test-utils.h"
+
+typedef enum _BenchMetric
+{
+  BENCH_METRIC_PAINT,
+  BENCH_METRIC_GPU,
+
+  BENCH_N_METRICS
+} BenchMetric;
+
+static const char *bench_metric_names[BENCH_N_METRICS] = {
+  [BENCH_METRIC_PAINT] = "paint_us",
+  [BENCH_METRIC_GPU] = "gpu_us",
+};
+
+typedef struct _Bench
+{
+  ClutterStage *stage;
+  CoglContext *cogl_context;
+
+  GHashTable *paint_start_times;
+
+  gboolean recording;
+  int n_painted_frames;
+  int64_t record_start_us;
+  int64_t recorded_us;
+  CoglRenderStats start_stats;
+  CoglRenderStats end_stats;
+  GArray *samples[BENCH_N_METRICS];
+} Bench;
+
+typedef struct _BenchScenario
+{
+  const char *name;
+  int n_monitors;
+  void (* run) (Bench *bench);
+} BenchScenario;
+
+static MetaContext *test_context;
+
+static int n_windows = 50;
+static int n_steps = 100;
+static double video_seconds = 3.0;
+static char *output_path;
+
+static FILE *output;
+
+static const GOptionEntry bench_options[] = {
+  {
+    "windows", 0, 0, G_OPTION_ARG_INT,
+    &n_windows,
+    "Number of windows to open (default: 50)",
+    "N"
+  },
+  {
+    "steps", 0, 0, G_OPTION_ARG_INT,
+    &n_steps,
+    "Number of workspace switches and drag steps (default: 100)",
+    "N"
+  },
+  {
+    "video-duration", 0, 0, G_OPTION_ARG_DOUBLE,
+    &video_seconds,
+    "Seconds to play the fullscreen video for (default: 3)",
+    "SECONDS"
+  },
+  {
+    "output", 0, 0, G_OPTION_ARG_FILENAME,
+    &output_path,
+    "File to append results to instead of printing them",
+    "FILE"
+  },
+  { NULL }
+};
+
+static void
+on_before_paint (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 ClutterFrame     *frame,
+                 Bench            *bench)
+{
+  int64_t *paint_start_us;
+
+  paint_start_us = g_hash_table_lookup (bench->paint_start_times, view);
+  if (!paint_start_us)
+    {
+      paint_start_us = g_new0 (int64_t, 1);
+      g_hash_table_insert (bench->paint_start_times, view, paint_start_us);
+    }
+
+  *paint_start_us = g_get_monotonic_time ();
+}
+
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame,
+                Bench            *bench)
+{
+  int64_t *paint_start_us;
+  int64_t duration_us;
+
+  paint_start_us = g_hash_table_lookup (bench->paint_start_times, view);
+  if (!paint_start_us || !bench->recording)
+    return;
+
+  duration_us = g_get_monotonic_time () - *paint_start_us;
+  g_array_append_val (bench->samples[BENCH_METRIC_PAINT], duration_us);
+  bench->n_painted_frames++;
+}
+
+static void
+on_presented (ClutterStage     *stage,
+              ClutterStageView *view,
+              ClutterFrameInfo *frame_info,
+              Bench            *bench)
+{
+  int64_t duration_us;
+
+  if (!bench->recording || !frame_info->has_valid_gpu_rendering_duration)
+    return;
+
+  duration_us = frame_info->gpu_rendering_duration_ns / 1000;
+  g_array_append_val (bench->samples[BENCH_METRIC_GPU], duration_us);
+}
+
+static void
+start_recording (Bench *bench)
+{
+  meta_wait_for_paint (test_context);
+
+  cogl_context_get_render_stats (bench->cogl_context, &bench->start_stats);
+  bench->record_start_us = g_get_monotonic_time ();
+  bench->recording = TRUE;
+}
+
+static void
+stop_recording (Bench *bench)
+{
+  meta_wait_for_paint (test_context);
+
+  bench->recording = FALSE;
+  bench->recorded_us = g_get_monotonic_time () - bench->record_start_us;
+  cogl_context_get_render_stats (bench->cogl_context, &bench->end_stats);
+}
+
+static void
+run_main_loop_for (double seconds)
+{
+  int64_t end_time_us;
+
+  end_time_us = g_get_monotonic_time () + (int64_t) (seconds * G_USEC_PER_SEC);
+
+  while (g_get_monotonic_time () < end_time_us)
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static MetaTestClient *
+create_test_client (const char *id)
+{
+  g_autoptr (GError) error = NULL;
+  MetaTestClient *test_client;
+
+  test_client = meta_test_client_new (test_context, id,
+                                      META_WINDOW_CLIENT_TYPE_WAYLAND,
+                                      &error);
+  g_assert_no_error (error);
+
+  return test_client;
+}
+
+static MetaWindow *
+show_window (MetaTestClient *test_client,
+             const char     *window_id)
+{
+  g_autoptr (GError) error = NULL;
+  MetaWindow *window;
+
+  if (!meta_test_client_do (test_client, &error,
+                            "create", window_id, NULL) ||
+      !meta_test_client_do (test_client, &error,
+                            "show", window_id, NULL))
+    g_error ("Failed to show window '%s': %s", window_id, error->message);
+
+  window = meta_test_client_find_window (test_client, window_id, &error);
+  g_assert_no_error (error);
+  meta_wait_for_window_shown (window);
+
+  return window;
+}
+
+static void
+run_open_windows (Bench *bench)
+{
+  MetaTestClient *test_client;
+  int i;
+
+  test_client = create_test_client ("open-windows");
+
+  start_recording (bench);
+  for (i = 0; i < n_windows; i++)
+    {
+      g_autofree char *window_id = g_strdup_printf ("%d", i);
+
+      show_window (test_client, window_id);
+    }
+  stop_recording (bench);
+
+  meta_test_client_destroy (test_client);
+}
+
+static void
+run_workspace_switch (Bench *bench)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaWorkspaceManager *workspace_manager =
+    meta_display_get_workspace_manager (display);
+  MetaWorkspace *workspaces[2];
+  MetaTestClient *test_client;
+  int i;
+
+  test_client = create_test_client ("workspace-switch");
+
+  workspaces[0] = meta_workspace_manager_get_active_workspace (workspace_manager);
+  workspaces[1] = meta_workspace_manager_append_new_workspace (workspace_manager,
+                                                               FALSE,
+                                                               META_CURRENT_TIME);
+
+  /* Give both workspaces something to show */
+  for (i = 0; i < 8; i++)
+    {
+      g_autofree char *window_id = g_strdup_printf ("%d", i);
+      MetaWindow *window;
+
+      window = show_window (test_client, window_id);
+      meta_window_change_workspace (window, workspaces[i % 2]);
+    }
+
+  start_recording (bench);
+  for (i = 0; i < n_steps; i++)
+    {
+      meta_workspace_activate (workspaces[(i + 1) % 2], META_CURRENT_TIME);
+      meta_wait_for_paint (test_context);
+    }
+  stop_recording (bench);
+
+  meta_workspace_activate (workspaces[0], META_CURRENT_TIME);
+  meta_test_client_destroy (test_client);
+  meta_workspace_manager_remove_workspace (workspace_manager,
+                                           workspaces[1],
+                                           META_CURRENT_TIME);
+}
+
+static void
+run_window_drag (Bench *bench)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaTestClient *test_client;
+  MetaWindow *window;
+  MtkRectangle frame_rect;
+  int stage_width, stage_height;
+  int i;
+
+  test_client = create_test_client ("window-drag");
+  window = show_window (test_client, "1");
+
+  meta_display_get_size (display, &stage_width, &stage_height);
+  meta_window_get_frame_rect (window, &frame_rect);
+
+  /* Walk the window from the left edge of the first monitor to the right
+   * edge of the last one */
+  start_recording (bench);
+  for (i = 0; i < n_steps; i++)
+    {
+      int x;
+
+      x = (int) ((int64_t) i * (stage_width - frame_rect.width) / n_steps);
+      meta_window_move_frame (window, TRUE, x, frame_rect.y);
+      meta_wait_for_paint (test_context);
+    }
+  stop_recording (bench);
+
+  meta_test_client_destroy (test_client);
+}
+
+static void
+run_fullscreen_video (Bench *bench)
+{
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (test_context);
+  g_autoptr (MetaWaylandTestDriver) test_driver = NULL;
+  MetaWaylandTestClient *video_client;
+  MetaTestClient *test_client;
+  MetaWindow *video_window;
+  MetaWindow *overlay_window;
+
+  test_driver = meta_wayland_test_driver_new (compositor);
+
+  /* A client committing a new buffer each frame stands in for the video */
+  video_client = meta_wayland_test_client_new_with_args (test_context,
+                                                         "frame-load",
+                                                         "fullscreen-video",
+                                                         NULL);
+  video_window = meta_wait_for_client_window (test_context,
+                                              "fullscreen-video");
+  meta_window_make_fullscreen (video_window);
+
+  test_client = create_test_client ("fullscreen-video-overlay");
+  overlay_window = show_window (test_client, "overlay");
+  meta_window_make_above (overlay_window);
+
+  run_main_loop_for (0.5);
+
+  start_recording (bench);
+  run_main_loop_for (video_seconds);
+  stop_recording (bench);
+
+  meta_test_client_destroy (test_client);
+  meta_wayland_test_driver_emit_sync_event (test_driver, 0);
+  meta_wayland_test_client_finish (video_client);
+}
+
+static const BenchScenario bench_scenarios[] = {
+  { "open-windows", 1, run_open_windows },
+  { "workspace-switch", 1, run_workspace_switch },
+  { "window-drag", 2, run_window_drag },
+  { "fullscreen-video", 1, run_fullscreen_video },
+};
+
+static int
+compare_samples (gconstpointer a,
+                 gconstpointer b)
+{
+  int64_t sample_a = *(const int64_t *) a;
+  int64_t sample_b = *(const int64_t *) b;
+
+  if (sample_a < sample_b)
+    return -1;
+  else if (sample_a > sample_b)
+    return 1;
+  else
+    return 0;
+}
+
+static int64_t
+get_percentile (GArray *sorted_samples,
+                int     percentile)
+{
+  unsigned int rank;
+
+  rank = (sorted_samples->len * percentile + 99) / 100;
+  rank = CLAMP (rank, 1, sorted_samples->len);
+
+  return g_array_index (sorted_samples, int64_t, rank - 1);
+}
+
+static void
+append_per_frame (GString    *result,
+                  const char *name,
+                  uint64_t    count,
+                  int         n_frames)
+{
+  char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_ascii_formatd (buf, sizeof (buf), "%.3f",
+                   n_frames > 0 ? (double) count / n_frames : 0.0);
+  g_string_append_printf (result, ", \"%s_per_frame\": %s", name, buf);
+}
+
+static void
+print_results (const BenchScenario *scenario,
+               Bench               *bench)
+{
+  g_autoptr (GString) result = NULL;
+  BenchMetric metric;
+
+  result = g_string_new (NULL);
+  g_string_append_printf (result,
+                          "{\"scenario\": \"%s\", \"monitors\": %d, "
+                          "\"frames\": %d, \"duration_us\": %" G_GINT64_FORMAT,
+                          scenario->name,
+                          scenario->n_monitors,
+                          bench->n_painted_frames,
+                          bench->recorded_us);
+
+  for (metric = 0; metric < BENCH_N_METRICS; metric++)
+    {
+      GArray *samples = bench->samples[metric];
+
+      if (samples->len == 0)
+        {
+          g_string_append_printf (result, ", \"%s\": null",
+                                  bench_metric_names[metric]);
+          continue;
+        }
+
+      g_array_sort (samples, compare_samples);
+
+      g_string_append_printf (result,
+                              ", \"%s\": {\"p50\": %" G_GINT64_FORMAT
+                              ", \"p90\": %" G_GINT64_FORMAT
+                              ", \"p99\": %" G_GINT64_FORMAT
+                              ", \"max\": %" G_GINT64_FORMAT "}",
+                              bench_metric_names[metric],
+                              get_percentile (samples, 50),
+                              get_percentile (samples, 90),
+                              get_percentile (samples, 99),
+                              g_array_index (samples, int64_t,
+                                             samples->len - 1));
+    }
+
+  append_per_frame (result, "journal_flushes",
+                    (bench->end_stats.n_journal_flushes -
+                     bench->start_stats.n_journal_flushes),
+                    bench->n_painted_frames);
+  append_per_frame (result, "program_links",
+                    (bench->end_stats.n_program_links -
+                     bench->start_stats.n_program_links),
+                    bench->n_painted_frames);
+  append_per_frame (result, "texture_allocations",
+                    (bench->end_stats.n_texture_allocations -
+                     bench->start_stats.n_texture_allocations),
+                    bench->n_painted_frames);
+  append_per_frame (result, "buffer_allocations",
+                    (bench->end_stats.n_buffer_allocations -
+                     bench->start_stats.n_buffer_allocations),
+                    bench->n_painted_frames);
+  g_string_append (result, "}\n");
+
+  fputs (result->str, output);
+  fflush (output);
+}
+
+static void
+bench_scenario (gconstpointer data)
+{
+  const BenchScenario *scenario = data;
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  g_autoptr (GPtrArray) virtual_monitors = NULL;
+  Bench bench = { 0 };
+  BenchMetric metric;
+  gulong handler_ids[3];
+  int i;
+
+  virtual_monitors =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+  for (i = 0; i < scenario->n_monitors; i++)
+    {
+      g_ptr_array_add (virtual_monitors,
+                       meta_create_test_monitor (test_context,
+                                                 1920, 1080, 60.0f));
+    }
+  meta_wait_for_paint (test_context);
+
+  bench.stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  bench.cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  bench.paint_start_times = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  for (metric = 0; metric < BENCH_N_METRICS; metric++)
+    bench.samples[metric] = g_array_new (FALSE, FALSE, sizeof (int64_t));
+
+  handler_ids[0] = g_signal_connect (bench.stage, "before-paint",
+                                     G_CALLBACK (on_before_paint), &bench);
+  handler_ids[1] = g_signal_connect (bench.stage, "after-paint",
+                                     G_CALLBACK (on_after_paint), &bench);
+  handler_ids[2] = g_signal_connect (bench.stage, "presented",
+                                     G_CALLBACK (on_presented), &bench);
+
+  scenario->run (&bench);
+
+  for (i = 0; i < G_N_ELEMENTS (handler_ids); i++)
+    g_signal_handler_disconnect (bench.stage, handler_ids[i]);
+
+  print_results (scenario, &bench);
+
+  g_assert_cmpint (bench.n_painted_frames, >, 0);
+
+  for (metric = 0; metric < BENCH_N_METRICS; metric++)
+    g_array_unref (bench.samples[metric]);
+  g_hash_table_destroy (bench.paint_start_times);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+  int i;
+  int ret;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      (META_CONTEXT_TEST_FLAG_NO_X11 |
+                                       META_CONTEXT_TEST_FLAG_NO_ANIMATIONS));
+  meta_context_add_option_entries (context, bench_options, NULL);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  if (n_windows <= 0 || n_steps <= 0 || video_seconds <= 0.0)
+    {
+      g_printerr ("Invalid benchmark parameters\n");
+      return EXIT_FAILURE;
+    }
+
+  if (output_path)
+    {
+      output = fopen (output_path, "a");
+      if (!output)
+        {
+          g_printerr ("Failed to open '%s': %s\n",
+                      output_path, g_strerror (errno));
+          return EXIT_FAILURE;
+        }
+    }
+  else
+    {
+      output = stdout;
+    }
+
+  test_context = context;
+
+  for (i = 0; i < G_N_ELEMENTS (bench_scenarios); i++)
+    {
+      g_autofree char *path = NULL;
+
+      path = g_strdup_printf ("/bench/scenario/%s", bench_scenarios[i].name);
+      g_test_add_data_func (path, &bench_scenarios[i], bench_scenario);
+    }
+
+  ret = meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                     META_TEST_RUN_FLAG_NONE);
+
+  if (output != stdout)
+    fclose (output);
+
+  return ret;
+}
@@ -1317,6 +1317,139 @@ meta_test_timeline_actor_tree_clear (void)
   clutter_actor_destroy (container2);
 }
 
+typedef struct _SnapshotActor
+{
+  ClutterActor parent;
+
+  gboolean captured;
+  int texture_width;
+  int texture_height;
+  MtkRegion *updated_region;
+} SnapshotActor;
+
+typedef struct _SnapshotActorClass
+{
+  ClutterActorClass parent_class;
+} SnapshotActorClass;
+
+static GType snapshot_actor_get_type (void);
+
+G_DEFINE_TYPE (SnapshotActor, snapshot_actor, CLUTTER_TYPE_ACTOR)
+
+static void
+snapshot_actor_paint (ClutterActor        *actor,
+                      ClutterPaintContext *paint_context)
+{
+  SnapshotActor *snapshot_actor = (SnapshotActor *) actor;
+  ClutterStageView *view;
+  CoglTexture *texture;
+
+  view = clutter_paint_context_get_stage_view (paint_context);
+
+  g_clear_pointer (&snapshot_actor->updated_region, mtk_region_unref);
+  texture = clutter_stage_view_capture_snapshot (view, paint_context,
+                                                 &snapshot_actor->updated_region);
+  g_assert_nonnull (texture);
+
+  snapshot_actor->captured = TRUE;
+  snapshot_actor->texture_width = cogl_texture_get_width (texture);
+  snapshot_actor->texture_height = cogl_texture_get_height (texture);
+}
+
+static void
+snapshot_actor_finalize (GObject *object)
+{
+  SnapshotActor *snapshot_actor = (SnapshotActor *) object;
+
+  g_clear_pointer (&snapshot_actor->updated_region, mtk_region_unref);
+
+  G_OBJECT_CLASS (snapshot_actor_parent_class)->finalize (object);
+}
+
+static void
+snapshot_actor_class_init (SnapshotActorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  object_class->finalize = snapshot_actor_finalize;
+  actor_class->paint = snapshot_actor_paint;
+}
+
+static void
+snapshot_actor_init (SnapshotActor *snapshot_actor)
+{
+}
+
+static void
+meta_test_stage_view_snapshot (void)
+{
+  ClutterActor *stage;
+  ClutterStageView *view;
+  CoglFramebuffer *framebuffer;
+  ClutterActor *content;
+  SnapshotActor *snapshot_actor;
+  MtkRectangle layout;
+  MtkRectangle extents;
+
+  stage = meta_backend_get_stage (meta_context_get_backend (test_context));
+
+  ensure_view_count (1);
+
+  view = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage))->data;
+  framebuffer = clutter_stage_view_get_framebuffer (view);
+  if (!cogl_context_has_feature (cogl_framebuffer_get_context (framebuffer),
+                                 COGL_FEATURE_ID_BLIT_FRAMEBUFFER))
+    {
+      g_test_skip ("Framebuffer blits not supported");
+      return;
+    }
+
+  clutter_stage_view_get_layout (view, &layout);
+
+  content = clutter_actor_new ();
+  clutter_actor_set_background_color (content,
+                                      &COGL_COLOR_INIT (255, 0, 0, 255));
+  clutter_actor_set_size (content, 100, 100);
+  clutter_actor_add_child (stage, content);
+
+  snapshot_actor = g_object_new (snapshot_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (snapshot_actor), 10, 10);
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (snapshot_actor));
+
+  /* The first capture copies the whole view */
+  clutter_actor_queue_redraw (stage);
+  while (!snapshot_actor->captured)
+    wait_for_paint (stage);
+
+  g_assert_cmpint (snapshot_actor->texture_width,
+                   ==,
+                   cogl_framebuffer_get_width (framebuffer));
+  g_assert_cmpint (snapshot_actor->texture_height,
+                   ==,
+                   cogl_framebuffer_get_height (framebuffer));
+  g_assert_nonnull (snapshot_actor->updated_region);
+  extents = mtk_region_get_extents (snapshot_actor->updated_region);
+  g_assert_true (mtk_rectangle_equal (&extents, &layout));
+
+  /* Later ones copy what was redrawn */
+  snapshot_actor->captured = FALSE;
+  clutter_actor_queue_redraw (content);
+  while (!snapshot_actor->captured)
+    wait_for_paint (stage);
+
+  extents = mtk_region_get_extents (snapshot_actor->updated_region);
+  g_assert_true (mtk_rectangle_contains_rect (&layout, &extents));
+  g_assert_cmpint (mtk_region_contains_rectangle (snapshot_actor->updated_region,
+                                                  &MTK_RECTANGLE_INIT (0, 0,
+                                                                       100, 100)),
+                   ==,
+                   MTK_REGION_OVERLAP_IN);
+
+  clutter_actor_destroy (CLUTTER_ACTOR (snapshot_actor));
+  clutter_actor_destroy (content);
+}
+
 static void
 on_before_tests (MetaContext *context)
 {
@@ -1356,6 +1489,8 @@ init_tests (void)
                    meta_test_timeline_actor_destroyed);
   g_test_add_func ("/stage-views/timeline/tree-clear",
                    meta_test_timeline_actor_tree_clear);
+  g_test_add_func ("/stage-views/snapshot",
+                   meta_test_stage_view_snapshot);
 }
 
 int
@@ -33,6 +33,8 @@
 #include "meta/compositor.h"
 #include "meta/meta-context.h"
 #include "tests/boxes-tests.h"
+#include "tests/bypass-policy-unit-tests.h"
+#include "tests/cache-registry-unit-tests.h"
 #include "tests/monitor-store-unit-tests.h"
 #include "tests/monitor-transform-tests.h"
 #include "tests/meta-test-utils.h"
@@ -199,12 +201,94 @@ meta_test_util_later_schedule_from_later (void)
   g_assert_cmpint (data.state, ==, META_TEST_LATER_FINISHED);
 }
 
+typedef struct _MetaTestLaterBudgetData
+{
+  GMainLoop *loop;
+  int n_updates;
+  int expensive_update;
+  int deferrable_update;
+} MetaTestLaterBudgetData;
+
+static void
+on_before_update_count (ClutterStage            *stage,
+                        ClutterStageView        *stage_view,
+                        ClutterFrame            *frame,
+                        MetaTestLaterBudgetData *data)
+{
+  data->n_updates++;
+}
+
+static gboolean
+test_later_budget_expensive_callback (gpointer user_data)
+{
+  MetaTestLaterBudgetData *data = user_data;
+
+  data->expensive_update = data->n_updates;
+  g_usleep (5 * G_TIME_SPAN_MILLISECOND);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+test_later_budget_deferrable_callback (gpointer user_data)
+{
+  MetaTestLaterBudgetData *data = user_data;
+
+  data->deferrable_update = data->n_updates;
+  g_main_loop_quit (data->loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+meta_test_util_later_budget (void)
+{
+  MetaTestLaterBudgetData data = { 0 };
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaCompositor *compositor = meta_display_get_compositor (display);
+  MetaLaters *laters = meta_compositor_get_laters (compositor);
+  ClutterStage *stage = meta_compositor_get_stage (compositor);
+  gulong before_update_handler_id;
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.expensive_update = -1;
+  data.deferrable_update = -1;
+
+  before_update_handler_id =
+    g_signal_connect (stage, "before-update",
+                      G_CALLBACK (on_before_update_count), &data);
+
+  meta_laters_set_frame_budget (laters, G_TIME_SPAN_MILLISECOND);
+
+  /* Laters are invoked most recently added first, so the expensive one
+   * exhausts the budget before the deferrable one gets its turn. */
+  meta_laters_add_full (laters, META_LATER_BEFORE_REDRAW,
+                        META_LATER_FLAG_DEFERRABLE,
+                        test_later_budget_deferrable_callback,
+                        &data,
+                        NULL);
+  meta_laters_add (laters, META_LATER_BEFORE_REDRAW,
+                   test_later_budget_expensive_callback,
+                   &data,
+                   NULL);
+
+  g_main_loop_run (data.loop);
+  g_main_loop_unref (data.loop);
+
+  meta_laters_set_frame_budget (laters, 0);
+  g_signal_handler_disconnect (stage, before_update_handler_id);
+
+  g_assert_cmpint (data.expensive_update, >=, 0);
+  g_assert_cmpint (data.deferrable_update, >, data.expensive_update);
+}
+
 static void
 init_tests (void)
 {
   g_test_add_func ("/util/meta-later/order", meta_test_util_later_order);
   g_test_add_func ("/util/meta-later/schedule-from-later",
                    meta_test_util_later_schedule_from_later);
+  g_test_add_func ("/util/meta-later/budget", meta_test_util_later_budget);
 
   init_monitor_store_tests ();
   init_boxes_tests ();
@@ -212,6 +296,8 @@ init_tests (void)
   init_orientation_manager_tests ();
   init_hdr_metadata_tests ();
   init_button_transform_tests ();
+  init_bypass_policy_tests ();
+  init_cache_registry_tests ();
 }
 
 int
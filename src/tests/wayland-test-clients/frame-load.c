@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Maps a toplevel and keeps committing new buffers to it until the
+ * compositor emits a sync event.
+ *
+ * Usage: frame-load TITLE [COMMIT-RATE]
+ *
+ * With a commit rate of 0 (the default), a new buffer is committed each
+ * time the previous frame callback is done, otherwise buffers are
+ * committed at the given rate in Hz regardless of frame callbacks.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <wayland-client.h>
+
+#include "wayland-test-client-utils.h"
+
+static WaylandDisplay *display;
+static WaylandSurface *surface;
+static struct wl_callback *frame_callback;
+
+static int64_t commit_interval_us;
+static uint32_t n_commits;
+
+static gboolean running;
+
+static void commit_frame (void);
+
+static void
+handle_frame_callback (void               *data,
+                       struct wl_callback *callback,
+                       uint32_t            time)
+{
+  wl_callback_destroy (callback);
+  frame_callback = NULL;
+
+  if (running)
+    commit_frame ();
+}
+
+static const struct wl_callback_listener frame_listener = {
+  handle_frame_callback,
+};
+
+static void
+commit_frame (void)
+{
+  uint32_t color;
+
+  n_commits++;
+
+  /* Cycle through a few colors so each commit actually damages */
+  color = 0xff000000 | ((n_commits * 0x231d17) & 0x00ffffff);
+
+  draw_surface (display, surface->wl_surface,
+                surface->width, surface->height,
+                color);
+  wl_surface_damage_buffer (surface->wl_surface,
+                            0, 0,
+                            surface->width, surface->height);
+
+  if (commit_interval_us == 0)
+    {
+      frame_callback = wl_surface_frame (surface->wl_surface);
+      wl_callback_add_listener (frame_callback, &frame_listener, NULL);
+    }
+
+  wl_surface_commit (surface->wl_surface);
+}
+
+static void
+dispatch_with_timeout (int64_t timeout_us)
+{
+  struct pollfd pfd;
+  int timeout_ms;
+
+  while (wl_display_prepare_read (display->display) != 0)
+    {
+      if (wl_display_dispatch_pending (display->display) == -1)
+        g_error ("wl_display_dispatch_pending failed");
+    }
+
+  if (wl_display_flush (display->display) == -1)
+    g_error ("wl_display_flush failed");
+
+  if (timeout_us < 0)
+    timeout_ms = -1;
+  else
+    timeout_ms = (int) ((timeout_us + 999) / 1000);
+
+  pfd.fd = wl_display_get_fd (display->display);
+  pfd.events = POLLIN;
+
+  if (poll (&pfd, 1, timeout_ms) > 0)
+    {
+      if (wl_display_read_events (display->display) == -1)
+        g_error ("wl_display_read_events failed");
+    }
+  else
+    {
+      wl_display_cancel_read (display->display);
+    }
+
+  if (wl_display_dispatch_pending (display->display) == -1)
+    g_error ("wl_display_dispatch_pending failed");
+}
+
+static void
+on_sync_event (WaylandDisplay *wayland_display,
+               uint32_t        serial)
+{
+  g_assert_cmpint (serial, ==, 0);
+  running = FALSE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  const char *title;
+  int64_t next_commit_time_us = 0;
+
+  if (argc < 2)
+    {
+      g_printerr ("Usage: %s TITLE [COMMIT-RATE]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  title = argv[1];
+
+  if (argc > 2)
+    {
+      double commit_rate = g_ascii_strtod (argv[2], NULL);
+
+      if (commit_rate < 0.0)
+        {
+          g_printerr ("Invalid commit rate '%s'\n", argv[2]);
+          return EXIT_FAILURE;
+        }
+
+      if (commit_rate > 0.0)
+        commit_interval_us = (int64_t) (G_USEC_PER_SEC / commit_rate);
+    }
+
+  display = wayland_display_new (WAYLAND_DISPLAY_CAPABILITY_TEST_DRIVER);
+  g_signal_connect (display, "sync-event", G_CALLBACK (on_sync_event), NULL);
+
+  surface = wayland_surface_new (display, title, 200, 150, 0xff3465a4);
+  wl_surface_commit (surface->wl_surface);
+
+  wait_for_window_shown (display, surface->wl_surface);
+
+  running = TRUE;
+
+  if (commit_interval_us == 0)
+    commit_frame ();
+  else
+    next_commit_time_us = g_get_monotonic_time ();
+
+  while (running)
+    {
+      int64_t now_us;
+
+      if (commit_interval_us == 0)
+        {
+          wayland_display_dispatch (display);
+          continue;
+        }
+
+      now_us = g_get_monotonic_time ();
+      if (now_us >= next_commit_time_us)
+        {
+          commit_frame ();
+
+          next_commit_time_us += commit_interval_us;
+          /* Don't try to catch up if we fell behind */
+          if (next_commit_time_us < now_us)
+            next_commit_time_us = now_us + commit_interval_us;
+        }
+
+      dispatch_with_timeout (MAX (next_commit_time_us - g_get_monotonic_time (),
+                                  0));
+    }
+
+  g_debug ("Committed %u frames", n_commits);
+
+  g_clear_pointer (&frame_callback, wl_callback_destroy);
+  g_clear_object (&surface);
+  wl_display_roundtrip (display->display);
+  g_clear_object (&display);
+
+  return EXIT_SUCCESS;
+}
@@ -33,3 +33,6 @@ G_DECLARE_FINAL_TYPE (MetaSelectionSourceWayland,
 
 MetaSelectionSource * meta_selection_source_wayland_new (MetaWaylandDataSource *source);
 
+void meta_selection_source_wayland_send (MetaSelectionSourceWayland *source_wayland,
+                                         const char                 *mimetype,
+                                         int                         fd);
@@ -152,6 +152,19 @@ copy_string_array_to_list (struct wl_array *array)
   return l;
 }
 
+/*
+ * Lets the source client write straight into @fd, without the contents
+ * passing through the compositor, for when the receiver is a Wayland
+ * client as well.
+ */
+void
+meta_selection_source_wayland_send (MetaSelectionSourceWayland *source_wayland,
+                                    const char                 *mimetype,
+                                    int                         fd)
+{
+  meta_wayland_data_source_send (source_wayland->data_source, mimetype, fd);
+}
+
 MetaSelectionSource *
 meta_selection_source_wayland_new (MetaWaylandDataSource *data_source)
 {
@@ -27,6 +27,7 @@
 #include "compositor/meta-window-actor-wayland.h"
 #include "wayland/meta-wayland-buffer.h"
 #include "wayland/meta-wayland-surface-private.h"
+#include "wayland/meta-wayland-transaction.h"
 #include "wayland/meta-window-wayland.h"
 
 #ifdef HAVE_XWAYLAND
@@ -249,7 +250,14 @@ meta_wayland_actor_surface_real_sync_actor_state (MetaWaylandActorSurface *actor
       }
     else
       {
-        meta_surface_actor_set_opaque_region (surface_actor, NULL);
+        g_autoptr (MtkRegion) opaque_region = NULL;
+
+        /* Clients rarely set an opaque region on popups and subsurfaces,
+         * even when what they draw is opaque */
+        opaque_region = meta_wayland_surface_get_inferred_opaque_region (surface);
+        if (opaque_region)
+          mtk_region_intersect_rectangle (opaque_region, &surface_rect);
+        meta_surface_actor_set_opaque_region (surface_actor, opaque_region);
       }
   }
 
@@ -295,6 +303,12 @@ meta_wayland_actor_surface_sync_actor_state (MetaWaylandActorSurface *actor_surf
     META_WAYLAND_ACTOR_SURFACE_GET_CLASS (actor_surface);
   MetaWaylandActorSurfacePrivate *priv =
     meta_wayland_actor_surface_get_instance_private (actor_surface);
+  MetaWaylandSurface *surface =
+    meta_wayland_surface_role_get_surface (META_WAYLAND_SURFACE_ROLE (actor_surface));
+
+  if (meta_wayland_transaction_defer_actor_sync (surface->compositor,
+                                                 actor_surface))
+    return;
 
 #ifdef HAVE_XWAYLAND
   if (!META_IS_XWAYLAND_SURFACE (actor_surface))
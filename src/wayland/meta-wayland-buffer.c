@@ -50,6 +50,7 @@
 
 #include <drm_fourcc.h>
 #include <glib/gstdio.h>
+#include <string.h>
 
 #include "backends/meta-backend-private.h"
 #include "clutter/clutter.h"
@@ -693,6 +694,9 @@ meta_wayland_buffer_attach (MetaWaylandBuffer  *buffer,
 CoglSnippet *
 meta_wayland_buffer_create_snippet (MetaWaylandBuffer *buffer)
 {
+  if (buffer->type == META_WAYLAND_BUFFER_TYPE_DMA_BUF)
+    return meta_wayland_dma_buf_create_snippet (buffer->dma_buf.dma_buf);
+
 #ifdef HAVE_WAYLAND_EGLSTREAM
   if (!buffer->egl_stream.stream)
     return NULL;
@@ -760,12 +764,166 @@ meta_wayland_buffer_is_y_inverted (MetaWaylandBuffer *buffer)
   return buffer->is_y_inverted;
 }
 
+/* Damage smaller than this is uploaded straight from the shm pool. */
+#define SHM_STAGING_UPLOAD_MIN_SIZE (256 * 1024)
+#define SHM_STAGING_ROW_ALIGNMENT 16
+
+static size_t
+align_staging_row_size (size_t row_size)
+{
+  return ((row_size + SHM_STAGING_ROW_ALIGNMENT - 1) &
+          ~((size_t) SHM_STAGING_ROW_ALIGNMENT - 1));
+}
+
+static size_t
+calculate_shm_staging_size (MetaMultiTexture                 *texture,
+                            const MetaMultiTextureFormatInfo *mt_format_info,
+                            MtkRegion                        *region)
+{
+  int n_rectangles = mtk_region_num_rectangles (region);
+  size_t size = 0;
+  int i, j;
+
+  for (i = 0; i < mt_format_info->n_planes; i++)
+    {
+      CoglTexture *cogl_texture = meta_multi_texture_get_plane (texture, i);
+      CoglPixelFormat subformat = cogl_texture_get_format (cogl_texture);
+      int bpp = cogl_pixel_format_get_bytes_per_pixel (subformat, 0);
+
+      for (j = 0; j < n_rectangles; j++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (region, j);
+          size_t row_size;
+
+          row_size = (size_t) (rect.width / mt_format_info->hsub[i]) * bpp;
+          row_size = align_staging_row_size (row_size);
+          size += row_size * (rect.height / mt_format_info->vsub[i]);
+        }
+    }
+
+  return size;
+}
+
+/*
+ * Copies the damaged rows into a mapped range of the Cogl upload buffer and
+ * uploads the texture regions from it. The copy is all that happens
+ * synchronously; the texture update itself is a GPU side transfer that
+ * doesn't block the main thread.
+ */
+static gboolean
+upload_shm_damage_staged (MetaMultiTexture                 *texture,
+                          const MetaMultiTextureFormatInfo *mt_format_info,
+                          MtkRegion                        *region,
+                          const uint8_t                    *data,
+                          const int                        *shm_offset,
+                          const int                        *shm_stride,
+                          CoglPixelBuffer                  *staging_buffer,
+                          size_t                            staging_offset,
+                          uint8_t                          *staging_data,
+                          GError                          **error)
+{
+  int n_rectangles = mtk_region_num_rectangles (region);
+  size_t offset;
+  int i, j;
+
+  COGL_TRACE_BEGIN_SCOPED (UploadShmDamageStaged,
+                           "Meta::WaylandBuffer::upload_shm_damage_staged()");
+
+  offset = 0;
+  for (i = 0; i < mt_format_info->n_planes; i++)
+    {
+      CoglTexture *cogl_texture = meta_multi_texture_get_plane (texture, i);
+      CoglPixelFormat subformat = cogl_texture_get_format (cogl_texture);
+      int bpp = cogl_pixel_format_get_bytes_per_pixel (subformat, 0);
+      int plane_index = mt_format_info->plane_indices[i];
+      const uint8_t *plane_data = data + shm_offset[plane_index];
+      size_t plane_stride = shm_stride[plane_index];
+
+      for (j = 0; j < n_rectangles; j++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (region, j);
+          const uint8_t *rect_data;
+          size_t row_size, staging_stride;
+          int n_rows, row;
+
+          rect_data = plane_data + (rect.x * bpp / mt_format_info->hsub[i]) +
+                      (rect.y * plane_stride);
+          row_size = (size_t) (rect.width / mt_format_info->hsub[i]) * bpp;
+          staging_stride = align_staging_row_size (row_size);
+          n_rows = rect.height / mt_format_info->vsub[i];
+
+          for (row = 0; row < n_rows; row++)
+            {
+              memcpy (staging_data + offset + row * staging_stride,
+                      rect_data + row * plane_stride,
+                      row_size);
+            }
+
+          offset += staging_stride * n_rows;
+        }
+    }
+
+  cogl_buffer_unmap (COGL_BUFFER (staging_buffer));
+
+  offset = staging_offset;
+  for (i = 0; i < mt_format_info->n_planes; i++)
+    {
+      CoglTexture *cogl_texture = meta_multi_texture_get_plane (texture, i);
+      CoglPixelFormat subformat = cogl_texture_get_format (cogl_texture);
+      int bpp = cogl_pixel_format_get_bytes_per_pixel (subformat, 0);
+
+      for (j = 0; j < n_rectangles; j++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (region, j);
+          g_autoptr (CoglBitmap) bitmap = NULL;
+          size_t row_size, staging_stride;
+          int width, n_rows;
+
+          width = rect.width / mt_format_info->hsub[i];
+          n_rows = rect.height / mt_format_info->vsub[i];
+          row_size = (size_t) width * bpp;
+          staging_stride = align_staging_row_size (row_size);
+
+          if (width == 0 || n_rows == 0)
+            continue;
+
+          bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (staging_buffer),
+                                                subformat,
+                                                width, n_rows,
+                                                (int) staging_stride,
+                                                (int) offset);
+          if (!cogl_texture_set_region_from_bitmap (cogl_texture,
+                                                    0, 0,
+                                                    rect.x, rect.y,
+                                                    width, n_rows,
+                                                    bitmap))
+            {
+              g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           "Failed to upload shm damage from staging buffer");
+              return FALSE;
+            }
+
+          offset += staging_stride * n_rows;
+        }
+    }
+
+  return TRUE;
+}
+
 static gboolean
 process_shm_buffer_damage (MetaWaylandBuffer *buffer,
                            MetaMultiTexture  *texture,
                            MtkRegion         *region,
                            GError           **error)
 {
+  MetaContext *context =
+    meta_wayland_compositor_get_context (buffer->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (CoglPixelBuffer) staging_buffer = NULL;
+  size_t staging_offset = 0;
+  void *staging_data = NULL;
   const MetaFormatInfo *format_info;
   MetaMultiTextureFormat multi_format;
   const MetaMultiTextureFormatInfo *mt_format_info;
@@ -792,9 +950,40 @@ process_shm_buffer_damage (MetaWaylandBuffer *buffer,
 
   get_offset_and_stride (format_info, stride, height, shm_offset, shm_stride);
 
+  if (cogl_context_has_feature (cogl_context,
+                                COGL_FEATURE_ID_MAP_BUFFER_FOR_WRITE))
+    {
+      size_t staging_size;
+
+      staging_size = calculate_shm_staging_size (texture,
+                                                 mt_format_info,
+                                                 region);
+      if (staging_size >= SHM_STAGING_UPLOAD_MIN_SIZE)
+        staging_buffer = cogl_context_map_upload_range (cogl_context,
+                                                        staging_size,
+                                                        &staging_offset,
+                                                        &staging_data,
+                                                        NULL);
+    }
+
   wl_shm_buffer_begin_access (shm_buffer);
   data = wl_shm_buffer_get_data (shm_buffer);
 
+  if (staging_buffer)
+    {
+      gboolean ret;
+
+      ret = upload_shm_damage_staged (texture, mt_format_info,
+                                      region, data,
+                                      shm_offset, shm_stride,
+                                      staging_buffer,
+                                      staging_offset,
+                                      staging_data,
+                                      error);
+      wl_shm_buffer_end_access (shm_buffer);
+      return ret;
+    }
+
   for (i = 0; i < n_planes; i++)
     {
       CoglTexture *cogl_texture;
@@ -882,11 +1071,117 @@ meta_wayland_buffer_process_damage (MetaWaylandBuffer *buffer,
     }
 }
 
+#define OPAQUE_INFERENCE_TILE_SIZE 64
+
+static gboolean
+is_shm_rect_opaque (const uint8_t      *data,
+                    int                 stride,
+                    const MtkRectangle *rect)
+{
+  int x, y;
+
+  for (y = rect->y; y < rect->y + rect->height; y++)
+    {
+      const uint8_t *row = data + (size_t) y * stride + (size_t) rect->x * 4;
+
+      /* The alpha channel is the most significant byte of these little
+       * endian formats */
+      for (x = 0; x < rect->width; x++)
+        {
+          if (row[x * 4 + 3] != 0xff)
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+/**
+ * meta_wayland_buffer_infer_opaque_region:
+ * @buffer: a #MetaWaylandBuffer
+ * @region: the region of the buffer to look at, in buffer coordinates
+ *
+ * Finds the parts of @region where the content of the buffer is opaque,
+ * even though its format has an alpha channel. This is only possible for
+ * 8 bit per channel shm buffers, which are in CPU memory, and is done in
+ * tiles, so that a single translucent pixel, such as in a rounded corner,
+ * only makes its tile not count as opaque.
+ *
+ * Returns: (transfer full) (nullable): the opaque part of @region, or %NULL
+ *   if it can't be inferred for this buffer
+ */
+MtkRegion *
+meta_wayland_buffer_infer_opaque_region (MetaWaylandBuffer *buffer,
+                                         MtkRegion         *region)
+{
+  struct wl_shm_buffer *shm_buffer;
+  g_autoptr (GArray) opaque_rects = NULL;
+  const uint8_t *data;
+  uint32_t shm_format;
+  int stride;
+  int i, n_rectangles;
+
+  if (buffer->type != META_WAYLAND_BUFFER_TYPE_SHM)
+    return NULL;
+
+  shm_buffer = wl_shm_buffer_get (buffer->resource);
+  shm_format = wl_shm_buffer_get_format (shm_buffer);
+  if (shm_format != WL_SHM_FORMAT_ARGB8888 &&
+      shm_format != WL_SHM_FORMAT_ABGR8888)
+    return NULL;
+
+  COGL_TRACE_BEGIN_SCOPED (InferOpaqueRegion,
+                           "Meta::WaylandBuffer::infer_opaque_region()");
+
+  stride = wl_shm_buffer_get_stride (shm_buffer);
+  opaque_rects = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+
+  wl_shm_buffer_begin_access (shm_buffer);
+  data = wl_shm_buffer_get_data (shm_buffer);
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+      int tile_x, tile_y;
+
+      for (tile_y = rect.y - rect.y % OPAQUE_INFERENCE_TILE_SIZE;
+           tile_y < rect.y + rect.height;
+           tile_y += OPAQUE_INFERENCE_TILE_SIZE)
+        {
+          for (tile_x = rect.x - rect.x % OPAQUE_INFERENCE_TILE_SIZE;
+               tile_x < rect.x + rect.width;
+               tile_x += OPAQUE_INFERENCE_TILE_SIZE)
+            {
+              MtkRectangle tile = {
+                .x = tile_x,
+                .y = tile_y,
+                .width = OPAQUE_INFERENCE_TILE_SIZE,
+                .height = OPAQUE_INFERENCE_TILE_SIZE,
+              };
+              MtkRectangle part;
+
+              if (!mtk_rectangle_intersect (&rect, &tile, &part))
+                continue;
+
+              if (is_shm_rect_opaque (data, stride, &part))
+                g_array_append_val (opaque_rects, part);
+            }
+        }
+    }
+
+  wl_shm_buffer_end_access (shm_buffer);
+
+  return mtk_region_create_rectangles ((MtkRectangle *) opaque_rects->data,
+                                       opaque_rects->len);
+}
+
 static CoglScanout *
-try_acquire_egl_image_scanout (MetaWaylandBuffer     *buffer,
-                               CoglOnscreen          *onscreen,
-                               const graphene_rect_t *src_rect,
-                               const MtkRectangle    *dst_rect)
+try_acquire_egl_image_scanout (MetaWaylandBuffer             *buffer,
+                               CoglOnscreen                  *onscreen,
+                               const graphene_rect_t         *src_rect,
+                               const MtkRectangle            *dst_rect,
+                               MetaWaylandBufferScanoutFlags  scanout_flags)
 {
 #ifdef HAVE_NATIVE_BACKEND
   MetaContext *context =
@@ -902,6 +1197,7 @@ try_acquire_egl_image_scanout (MetaWaylandBuffer     *buffer,
   g_autoptr (MetaDrmBufferGbm) fb = NULL;
   g_autoptr (CoglScanout) scanout = NULL;
   g_autoptr (GError) error = NULL;
+  gboolean is_compatible;
 
   gpu_kms = meta_renderer_native_get_primary_gpu (renderer_native);
   device_file = meta_renderer_native_get_primary_device_file (renderer_native);
@@ -928,8 +1224,23 @@ try_acquire_egl_image_scanout (MetaWaylandBuffer     *buffer,
   scanout = cogl_scanout_new (COGL_SCANOUT_BUFFER (g_steal_pointer (&fb)),
                               dst_rect);
   cogl_scanout_set_src_rect (scanout, src_rect);
-  if (!meta_onscreen_native_is_buffer_scanout_compatible (onscreen, scanout))
-    return NULL;
+
+  /* Whether the plane can scale or crop the buffer as needed is up to the
+   * hardware, which the test commit will tell.
+   */
+  if (scanout_flags & META_WAYLAND_BUFFER_SCANOUT_FLAG_OVERLAY)
+    is_compatible = meta_onscreen_native_is_buffer_overlay_compatible (onscreen,
+                                                                       scanout);
+  else
+    is_compatible = meta_onscreen_native_is_buffer_scanout_compatible (onscreen,
+                                                                       scanout);
+
+  if (!is_compatible)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Buffer not scanout compatible (see also KMS debug topic)");
+      return NULL;
+    }
 
   return g_steal_pointer (&scanout);
 #else
@@ -948,10 +1259,11 @@ scanout_destroyed (gpointer  data,
 }
 
 CoglScanout *
-meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                         CoglOnscreen          *onscreen,
-                                         const graphene_rect_t *src_rect,
-                                         const MtkRectangle    *dst_rect)
+meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer             *buffer,
+                                         CoglOnscreen                  *onscreen,
+                                         const graphene_rect_t         *src_rect,
+                                         const MtkRectangle            *dst_rect,
+                                         MetaWaylandBufferScanoutFlags  flags)
 {
   CoglScanout *scanout = NULL;
 
@@ -976,23 +1288,19 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                   "Buffer type not scanout compatible");
       return NULL;
     case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
-      if (src_rect || dst_rect)
-        {
-          meta_topic (META_DEBUG_RENDER,
-                      "Buffer type does not support scaling operations");
-          return NULL;
-        }
       scanout = try_acquire_egl_image_scanout (buffer,
                                                onscreen,
                                                src_rect,
-                                               dst_rect);
+                                               dst_rect,
+                                               flags);
       break;
     case META_WAYLAND_BUFFER_TYPE_DMA_BUF:
       {
         scanout = meta_wayland_dma_buf_try_acquire_scanout (buffer,
                                                             onscreen,
                                                             src_rect,
-                                                            dst_rect);
+                                                            dst_rect,
+                                                            flags);
         break;
       }
     case META_WAYLAND_BUFFER_TYPE_UNKNOWN:
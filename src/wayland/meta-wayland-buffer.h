@@ -102,9 +102,12 @@ gboolean                meta_wayland_buffer_is_y_inverted       (MetaWaylandBuff
 void                    meta_wayland_buffer_process_damage      (MetaWaylandBuffer     *buffer,
                                                                  MetaMultiTexture      *texture,
                                                                  MtkRegion             *region);
-CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                                                 CoglOnscreen          *onscreen,
-                                                                 const graphene_rect_t *src_rect,
-                                                                 const MtkRectangle    *dst_rect);
+MtkRegion *             meta_wayland_buffer_infer_opaque_region (MetaWaylandBuffer     *buffer,
+                                                                 MtkRegion             *region);
+CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer             *buffer,
+                                                                 CoglOnscreen                  *onscreen,
+                                                                 const graphene_rect_t         *src_rect,
+                                                                 const MtkRectangle            *dst_rect,
+                                                                 MetaWaylandBufferScanoutFlags  flags);
 
 void meta_wayland_init_shm (MetaWaylandCompositor *compositor);
@@ -0,0 +1,247 @@
+/*
+ * Wayland Support
+ *
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Per client protocol accounting, to find clients flooding the compositor
+ * with requests, e.g. committing far more often than anything can be
+ * presented. It is enabled via the debug control, as counting requires a
+ * protocol logger, which is called for every request and event passing
+ * through the display.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-client-stats.h"
+
+#include <wayland-server.h>
+
+#include "cogl/cogl.h"
+#include "core/meta-debug-control-private.h"
+#include "wayland/meta-wayland-private.h"
+
+#define COMMIT_RATE_PERIOD_US G_USEC_PER_SEC
+
+typedef struct _MetaWaylandClientStats
+{
+  MetaWaylandClientStatsManager *manager;
+  struct wl_client *client;
+  struct wl_listener client_destroy_listener;
+
+  pid_t pid;
+
+  uint64_t n_requests;
+  uint64_t n_commits;
+
+  int64_t period_start_us;
+  unsigned int n_period_commits;
+  unsigned int commit_rate;
+} MetaWaylandClientStats;
+
+struct _MetaWaylandClientStatsManager
+{
+  MetaWaylandCompositor *compositor;
+
+  struct wl_protocol_logger *protocol_logger;
+  GHashTable *client_stats;
+};
+
+static void
+client_stats_free (MetaWaylandClientStats *stats)
+{
+  wl_list_remove (&stats->client_destroy_listener.link);
+  g_free (stats);
+}
+
+static void
+on_client_destroyed (struct wl_listener *listener,
+                     void               *user_data)
+{
+  MetaWaylandClientStats *stats =
+    wl_container_of (listener, stats, client_destroy_listener);
+
+  g_hash_table_remove (stats->manager->client_stats, stats->client);
+}
+
+static MetaWaylandClientStats *
+ensure_client_stats (MetaWaylandClientStatsManager *manager,
+                     struct wl_client              *client)
+{
+  MetaWaylandClientStats *stats;
+
+  stats = g_hash_table_lookup (manager->client_stats, client);
+  if (stats)
+    return stats;
+
+  stats = g_new0 (MetaWaylandClientStats, 1);
+  stats->manager = manager;
+  stats->client = client;
+  wl_client_get_credentials (client, &stats->pid, NULL, NULL);
+
+  stats->client_destroy_listener.notify = on_client_destroyed;
+  wl_client_add_destroy_listener (client, &stats->client_destroy_listener);
+
+  g_hash_table_insert (manager->client_stats, client, stats);
+
+  return stats;
+}
+
+static void
+record_commit (MetaWaylandClientStats *stats)
+{
+  int64_t now_us = g_get_monotonic_time ();
+  int64_t period_us;
+
+  stats->n_commits++;
+
+  period_us = now_us - stats->period_start_us;
+  if (period_us >= COMMIT_RATE_PERIOD_US)
+    {
+      /* Only count the last full period if it directly precedes this one */
+      if (period_us < 2 * COMMIT_RATE_PERIOD_US)
+        {
+          stats->commit_rate = (unsigned int)
+            (stats->n_period_commits * G_USEC_PER_SEC / period_us);
+        }
+      else
+        {
+          stats->commit_rate = 0;
+        }
+
+      stats->period_start_us = now_us;
+      stats->n_period_commits = 0;
+    }
+
+  stats->n_period_commits++;
+
+  COGL_TRACE_MESSAGE ("Meta::WaylandClientStats::commit()",
+                      "pid %d, %u commits per second",
+                      (int) stats->pid, stats->commit_rate);
+}
+
+static void
+protocol_logger_func (void                                    *user_data,
+                      enum wl_protocol_logger_type             type,
+                      const struct wl_protocol_logger_message *message)
+{
+  MetaWaylandClientStatsManager *manager = user_data;
+  MetaWaylandClientStats *stats;
+
+  if (type != WL_PROTOCOL_LOGGER_REQUEST)
+    return;
+
+  stats = ensure_client_stats (manager,
+                               wl_resource_get_client (message->resource));
+  stats->n_requests++;
+
+  if (wl_resource_instance_of (message->resource, &wl_surface_interface,
+                               NULL) &&
+      g_strcmp0 (message->message->name, "commit") == 0)
+    record_commit (stats);
+}
+
+static void
+update_enabled (MetaWaylandClientStatsManager *manager)
+{
+  MetaWaylandCompositor *compositor = manager->compositor;
+  MetaDebugControl *debug_control =
+    meta_context_get_debug_control (compositor->context);
+  gboolean is_enabled =
+    meta_debug_control_is_client_stats_enabled (debug_control);
+
+  if (is_enabled && !manager->protocol_logger)
+    {
+      manager->protocol_logger =
+        wl_display_add_protocol_logger (compositor->wayland_display,
+                                        protocol_logger_func,
+                                        manager);
+    }
+  else if (!is_enabled)
+    {
+      g_clear_pointer (&manager->protocol_logger, wl_protocol_logger_destroy);
+      g_hash_table_remove_all (manager->client_stats);
+    }
+}
+
+void
+meta_wayland_init_client_stats (MetaWaylandCompositor *compositor)
+{
+  MetaDebugControl *debug_control =
+    meta_context_get_debug_control (compositor->context);
+  MetaWaylandClientStatsManager *manager;
+
+  manager = g_new0 (MetaWaylandClientStatsManager, 1);
+  manager->compositor = compositor;
+  manager->client_stats =
+    g_hash_table_new_full (NULL, NULL,
+                           NULL, (GDestroyNotify) client_stats_free);
+  compositor->client_stats_manager = manager;
+
+  g_signal_connect_data (debug_control, "notify::client-stats",
+                         G_CALLBACK (update_enabled),
+                         manager, NULL,
+                         G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+
+  update_enabled (manager);
+}
+
+void
+meta_wayland_client_stats_finalize (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandClientStatsManager *manager = compositor->client_stats_manager;
+  MetaDebugControl *debug_control =
+    meta_context_get_debug_control (compositor->context);
+
+  if (!manager)
+    return;
+
+  g_signal_handlers_disconnect_by_func (debug_control,
+                                        update_enabled,
+                                        manager);
+
+  g_clear_pointer (&manager->protocol_logger, wl_protocol_logger_destroy);
+  g_clear_pointer (&manager->client_stats, g_hash_table_destroy);
+  g_clear_pointer (&compositor->client_stats_manager, g_free);
+}
+
+GVariant *
+meta_wayland_compositor_get_client_stats (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandClientStatsManager *manager = compositor->client_stats_manager;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  MetaWaylandClientStats *stats;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ittu)"));
+
+  if (!manager)
+    return g_variant_builder_end (&builder);
+
+  g_hash_table_iter_init (&iter, manager->client_stats);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &stats))
+    {
+      g_variant_builder_add (&builder, "(ittu)",
+                             (int32_t) stats->pid,
+                             stats->n_requests,
+                             stats->n_commits,
+                             stats->commit_rate);
+    }
+
+  return g_variant_builder_end (&builder);
+}
@@ -33,6 +33,7 @@
 
 #include "core/display-private.h"
 #include "primary-selection-unstable-v1-server-protocol.h"
+#include "wayland/meta-selection-source-wayland-private.h"
 #include "wayland/meta-wayland-data-offer.h"
 #include "wayland/meta-wayland-data-offer-primary.h"
 #include "wayland/meta-wayland-private.h"
@@ -71,12 +72,13 @@ primary_offer_receive (struct wl_client   *client,
 {
   MetaWaylandDataOffer *offer = wl_resource_get_user_data (resource);
   MetaDisplay *display = display_from_offer (offer);
+  MetaSelection *selection = meta_display_get_selection (display);
+  MetaSelectionSource *owner;
   GOutputStream *stream;
   GList *mime_types;
   gboolean found;
 
-  mime_types = meta_selection_get_mimetypes (meta_display_get_selection (display),
-                                             META_SELECTION_PRIMARY);
+  mime_types = meta_selection_get_mimetypes (selection, META_SELECTION_PRIMARY);
   found = g_list_find_custom (mime_types, mime_type, (GCompareFunc) g_strcmp0) != NULL;
   g_list_free_full (mime_types, g_free);
 
@@ -86,8 +88,17 @@ primary_offer_receive (struct wl_client   *client,
       return;
     }
 
+  owner = meta_selection_get_current_owner (selection, META_SELECTION_PRIMARY);
+  if (META_IS_SELECTION_SOURCE_WAYLAND (owner))
+    {
+      meta_selection_source_wayland_send (META_SELECTION_SOURCE_WAYLAND (owner),
+                                          mime_type, fd);
+      close (fd);
+      return;
+    }
+
   stream = g_unix_output_stream_new (fd, TRUE);
-  meta_selection_transfer_async (meta_display_get_selection (display),
+  meta_selection_transfer_async (selection,
                                  META_SELECTION_PRIMARY,
                                  mime_type,
                                  -1,
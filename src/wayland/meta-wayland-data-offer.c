@@ -32,6 +32,7 @@
 #include <unistd.h>
 
 #include "meta/meta-selection.h"
+#include "wayland/meta-selection-source-wayland-private.h"
 #include "wayland/meta-wayland-data-device.h"
 #include "wayland/meta-wayland-data-offer.h"
 #include "wayland/meta-wayland-private.h"
@@ -94,22 +95,31 @@ data_offer_receive (struct wl_client *client, struct wl_resource *resource,
 {
   MetaWaylandDataOffer *offer = wl_resource_get_user_data (resource);
   MetaDisplay *display = display_from_offer (offer);
+  MetaSelection *selection = meta_display_get_selection (display);
+  MetaSelectionSource *owner;
   MetaSelectionType selection_type;
   GList *mime_types;
   gboolean found;
 
   selection_type = offer->selection_type;
-  mime_types = meta_selection_get_mimetypes (meta_display_get_selection (display),
-                                             selection_type);
+  mime_types = meta_selection_get_mimetypes (selection, selection_type);
   found = g_list_find_custom (mime_types, mime_type, (GCompareFunc) g_strcmp0) != NULL;
   g_list_free_full (mime_types, g_free);
 
-  if (found)
+  owner = meta_selection_get_current_owner (selection, selection_type);
+
+  if (found && META_IS_SELECTION_SOURCE_WAYLAND (owner))
+    {
+      meta_selection_source_wayland_send (META_SELECTION_SOURCE_WAYLAND (owner),
+                                          mime_type, fd);
+      close (fd);
+    }
+  else if (found)
     {
       GOutputStream *stream;
 
       stream = g_unix_output_stream_new (fd, TRUE);
-      meta_selection_transfer_async (meta_display_get_selection (display),
+      meta_selection_transfer_async (selection,
                                      selection_type,
                                      mime_type,
                                      -1,
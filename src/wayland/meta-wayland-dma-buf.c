@@ -59,6 +59,7 @@
 #include "wayland/meta-wayland-linux-drm-syncobj.h"
 
 #ifdef HAVE_NATIVE_BACKEND
+#include "backends/native/meta-device-pool.h"
 #include "backends/native/meta-drm-buffer-gbm.h"
 #include "backends/native/meta-kms-device.h"
 #include "backends/native/meta-kms-plane.h"
@@ -71,6 +72,10 @@
 
 #define META_WAYLAND_DMA_BUF_MAX_FDS 4
 
+/* How long imports are kept around after the last buffer using them was
+ * destroyed, for clients recreating their wl_buffers */
+#define UNUSED_IMPORT_TIMEOUT_S 1
+
 /* Compatible with zwp_linux_dmabuf_feedback_v1.tranche_flags */
 typedef enum _MetaWaylandDmaBufTrancheFlags
 {
@@ -98,6 +103,7 @@ typedef struct _MetaWaylandDmaBufTranche
   GArray *formats;
   MetaWaylandDmaBufTrancheFlags flags;
   uint64_t scanout_crtc_id;
+  uint32_t scanout_plane_id;
 } MetaWaylandDmaBufTranche;
 
 typedef struct _MetaWaylandDmaBufFeedback
@@ -125,8 +131,53 @@ struct _MetaWaylandDmaBufManager
   GArray *formats;
   MetaAnonymousFile *format_table_file;
   MetaWaylandDmaBufFeedback *default_feedback;
+
+  GHashTable *imports;
+  GQueue unused_imports;
+  guint purge_imports_id;
+
+  /* DRM formats the driver failed to import as a single external image */
+  GHashTable *external_import_failures;
+  CoglSnippet *external_snippet;
 };
 
+/* Identifies the dma-bufs of a buffer independently of the file
+ * descriptors the client passed for them */
+typedef struct _MetaWaylandDmaBufImportKey
+{
+  struct wl_client *client;
+
+  int width;
+  int height;
+  uint32_t drm_format;
+  uint64_t drm_modifier;
+
+  int n_planes;
+  dev_t devices[META_WAYLAND_DMA_BUF_MAX_FDS];
+  ino_t inodes[META_WAYLAND_DMA_BUF_MAX_FDS];
+  uint32_t offsets[META_WAYLAND_DMA_BUF_MAX_FDS];
+  uint32_t strides[META_WAYLAND_DMA_BUF_MAX_FDS];
+} MetaWaylandDmaBufImportKey;
+
+/* The texture and scanout buffer imported for a set of dma-bufs, shared
+ * by all the buffers a client created for them */
+typedef struct _MetaWaylandDmaBufImport
+{
+  MetaWaylandDmaBufImportKey key;
+  MetaWaylandDmaBufManager *manager;
+
+  unsigned int n_users;
+  int64_t unused_since_us;
+  GList unused_link;
+
+  MetaMultiTexture *texture;
+  gboolean is_external;
+#ifdef HAVE_NATIVE_BACKEND
+  MetaDeviceFile *scanout_device_file;
+  MetaDrmBufferGbm *scanout_buffer;
+#endif
+} MetaWaylandDmaBufImport;
+
 struct _MetaWaylandDmaBufBuffer
 {
   GObject parent;
@@ -141,6 +192,12 @@ struct _MetaWaylandDmaBufBuffer
   int fds[META_WAYLAND_DMA_BUF_MAX_FDS];
   uint32_t offsets[META_WAYLAND_DMA_BUF_MAX_FDS];
   uint32_t strides[META_WAYLAND_DMA_BUF_MAX_FDS];
+
+  /* Whether the texture samples all planes through a single
+   * GL_TEXTURE_EXTERNAL_OES, with the driver converting from YUV */
+  bool is_external;
+
+  MetaWaylandDmaBufImport *import;
 };
 
 G_DEFINE_TYPE (MetaWaylandDmaBufBuffer, meta_wayland_dma_buf_buffer, G_TYPE_OBJECT);
@@ -355,6 +412,308 @@ meta_wayland_dma_buf_feedback_copy (MetaWaylandDmaBufFeedback *feedback)
   return new_feedback;
 }
 
+static unsigned int
+import_key_hash (gconstpointer data)
+{
+  const MetaWaylandDmaBufImportKey *key = data;
+  unsigned int hash;
+  int i;
+
+  hash = g_direct_hash (key->client);
+  hash = (hash * 31) + key->drm_format;
+
+  for (i = 0; i < key->n_planes; i++)
+    {
+      hash = (hash * 31) + (unsigned int) key->inodes[i];
+      hash = (hash * 31) + key->offsets[i];
+    }
+
+  return hash;
+}
+
+static gboolean
+import_key_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const MetaWaylandDmaBufImportKey *key_a = a;
+  const MetaWaylandDmaBufImportKey *key_b = b;
+  int i;
+
+  if (key_a->client != key_b->client ||
+      key_a->width != key_b->width ||
+      key_a->height != key_b->height ||
+      key_a->drm_format != key_b->drm_format ||
+      key_a->drm_modifier != key_b->drm_modifier ||
+      key_a->n_planes != key_b->n_planes)
+    return FALSE;
+
+  for (i = 0; i < key_a->n_planes; i++)
+    {
+      if (key_a->devices[i] != key_b->devices[i] ||
+          key_a->inodes[i] != key_b->inodes[i] ||
+          key_a->offsets[i] != key_b->offsets[i] ||
+          key_a->strides[i] != key_b->strides[i])
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+init_import_key (MetaWaylandDmaBufImportKey *key,
+                 struct wl_client           *client,
+                 MetaWaylandDmaBufBuffer    *dma_buf)
+{
+  int i;
+
+  *key = (MetaWaylandDmaBufImportKey) {
+    .client = client,
+    .width = dma_buf->width,
+    .height = dma_buf->height,
+    .drm_format = dma_buf->drm_format,
+    .drm_modifier = dma_buf->drm_modifier,
+  };
+
+  for (i = 0; i < META_WAYLAND_DMA_BUF_MAX_FDS; i++)
+    {
+      struct stat stat_buf;
+
+      if (dma_buf->fds[i] < 0)
+        break;
+
+      if (fstat (dma_buf->fds[i], &stat_buf) != 0)
+        return FALSE;
+
+      key->devices[i] = stat_buf.st_dev;
+      key->inodes[i] = stat_buf.st_ino;
+      key->offsets[i] = dma_buf->offsets[i];
+      key->strides[i] = dma_buf->strides[i];
+    }
+
+  key->n_planes = i;
+
+  return TRUE;
+}
+
+static void
+meta_wayland_dma_buf_import_free (MetaWaylandDmaBufImport *import)
+{
+  g_clear_object (&import->texture);
+#ifdef HAVE_NATIVE_BACKEND
+  g_clear_object (&import->scanout_buffer);
+  g_clear_pointer (&import->scanout_device_file, meta_device_file_release);
+#endif
+  g_free (import);
+}
+
+static MetaWaylandDmaBufImport *
+acquire_import (MetaWaylandDmaBufManager *dma_buf_manager,
+                struct wl_client         *client,
+                MetaWaylandDmaBufBuffer  *dma_buf)
+{
+  MetaWaylandDmaBufImportKey key;
+  MetaWaylandDmaBufImport *import;
+
+  if (!init_import_key (&key, client, dma_buf))
+    return NULL;
+
+  import = g_hash_table_lookup (dma_buf_manager->imports, &key);
+  if (import)
+    {
+      if (import->n_users == 0)
+        g_queue_unlink (&dma_buf_manager->unused_imports, &import->unused_link);
+
+      import->n_users++;
+      return import;
+    }
+
+  import = g_new0 (MetaWaylandDmaBufImport, 1);
+  import->key = key;
+  import->manager = dma_buf_manager;
+  import->n_users = 1;
+  import->unused_link.data = import;
+
+  g_hash_table_insert (dma_buf_manager->imports, &import->key, import);
+
+  return import;
+}
+
+static gboolean
+purge_unused_imports (gpointer user_data)
+{
+  MetaWaylandDmaBufManager *dma_buf_manager = user_data;
+  MetaWaylandDmaBufImport *import;
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+
+  while ((import = g_queue_peek_head (&dma_buf_manager->unused_imports)))
+    {
+      if (now_us - import->unused_since_us <
+          UNUSED_IMPORT_TIMEOUT_S * G_USEC_PER_SEC)
+        break;
+
+      g_queue_unlink (&dma_buf_manager->unused_imports, &import->unused_link);
+      g_hash_table_remove (dma_buf_manager->imports, &import->key);
+    }
+
+  if (g_queue_is_empty (&dma_buf_manager->unused_imports))
+    {
+      dma_buf_manager->purge_imports_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+release_import (MetaWaylandDmaBufImport *import)
+{
+  MetaWaylandDmaBufManager *dma_buf_manager = import->manager;
+
+  g_return_if_fail (import->n_users > 0);
+
+  import->n_users--;
+  if (import->n_users > 0)
+    return;
+
+  if (!dma_buf_manager)
+    {
+      meta_wayland_dma_buf_import_free (import);
+      return;
+    }
+
+  /* The file descriptors of the last buffer were closed, but the client
+   * might create a new one for the same dma-bufs soon. The texture keeps
+   * the dma-bufs alive meanwhile, so their inodes can't be reused */
+  import->unused_since_us = g_get_monotonic_time ();
+  g_queue_push_tail_link (&dma_buf_manager->unused_imports,
+                          &import->unused_link);
+
+  if (!dma_buf_manager->purge_imports_id)
+    {
+      dma_buf_manager->purge_imports_id =
+        g_timeout_add_seconds (UNUSED_IMPORT_TIMEOUT_S,
+                               purge_unused_imports,
+                               dma_buf_manager);
+    }
+}
+
+static gboolean
+can_import_external (MetaWaylandDmaBufBuffer *dma_buf,
+                     CoglContext             *cogl_context)
+{
+  MetaWaylandDmaBufManager *dma_buf_manager = dma_buf->manager;
+  int i;
+
+  if (!dma_buf_manager)
+    return FALSE;
+
+  if (!cogl_context_has_feature (cogl_context,
+                                 COGL_FEATURE_ID_TEXTURE_EGL_IMAGE_EXTERNAL))
+    return FALSE;
+
+  if (g_hash_table_contains (dma_buf_manager->external_import_failures,
+                             GUINT_TO_POINTER (dma_buf->drm_format)))
+    return FALSE;
+
+  /* Only formats and modifiers EGL advertised as importable are tried,
+   * anything else goes straight to importing the planes separately */
+  for (i = 0; i < dma_buf_manager->formats->len; i++)
+    {
+      MetaWaylandDmaBufFormat *format =
+        &g_array_index (dma_buf_manager->formats, MetaWaylandDmaBufFormat, i);
+
+      if (format->drm_format == dma_buf->drm_format &&
+          format->drm_modifier == dma_buf->drm_modifier)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Imports all planes of a YUV buffer as a single EGLImage sampled through
+ * GL_TEXTURE_EXTERNAL_OES, letting the driver do the color conversion,
+ * often in fixed function sampler hardware, instead of sampling every
+ * plane separately and converting in the fragment shader. */
+static gboolean
+try_import_external (MetaWaylandBuffer *buffer)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (buffer->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaEgl *egl = meta_backend_get_egl (backend);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  EGLDisplay egl_display = cogl_context_get_egl_display (cogl_context);
+  MetaWaylandDmaBufBuffer *dma_buf = buffer->dma_buf.dma_buf;
+  /* Match the BT.601 limited range conversion of the shader path */
+  EGLint hints[] = {
+    EGL_YUV_COLOR_SPACE_HINT_EXT, EGL_ITU_REC601_EXT,
+    EGL_SAMPLE_RANGE_HINT_EXT, EGL_YUV_NARROW_RANGE_EXT,
+    EGL_NONE
+  };
+  g_autoptr (GError) error = NULL;
+  MetaDrmFormatBuf format_buf;
+  EGLImageKHR egl_image;
+  CoglTexture *cogl_texture;
+  uint64_t modifiers[META_WAYLAND_DMA_BUF_MAX_FDS];
+  uint32_t n_planes;
+
+  for (n_planes = 0; n_planes < META_WAYLAND_DMA_BUF_MAX_FDS; n_planes++)
+    {
+      if (dma_buf->fds[n_planes] < 0)
+        break;
+
+      modifiers[n_planes] = dma_buf->drm_modifier;
+    }
+
+  egl_image = meta_egl_create_dmabuf_image_full (egl,
+                                                 egl_display,
+                                                 dma_buf->width,
+                                                 dma_buf->height,
+                                                 dma_buf->drm_format,
+                                                 n_planes,
+                                                 dma_buf->fds,
+                                                 dma_buf->strides,
+                                                 dma_buf->offsets,
+                                                 modifiers,
+                                                 hints,
+                                                 &error);
+  if (egl_image == EGL_NO_IMAGE_KHR)
+    goto err;
+
+  cogl_texture = cogl_texture_2d_new_from_egl_image (cogl_context,
+                                                     dma_buf->width,
+                                                     dma_buf->height,
+                                                     COGL_PIXEL_FORMAT_ANY,
+                                                     egl_image,
+                                                     COGL_EGL_IMAGE_FLAG_NO_GET_DATA |
+                                                     COGL_EGL_IMAGE_FLAG_EXTERNAL,
+                                                     &error);
+
+  meta_egl_destroy_image (egl, egl_display, egl_image, NULL);
+
+  if (!cogl_texture)
+    goto err;
+
+  buffer->dma_buf.texture = meta_multi_texture_new_simple (cogl_texture);
+
+  return TRUE;
+
+err:
+  meta_topic (META_DEBUG_WAYLAND,
+              "[dma-buf] Importing DRM format %s as an external texture "
+              "failed, falling back to importing planes: %s",
+              meta_drm_format_to_string (&format_buf, dma_buf->drm_format),
+              error->message);
+
+  g_hash_table_add (dma_buf->manager->external_import_failures,
+                    GUINT_TO_POINTER (dma_buf->drm_format));
+
+  return FALSE;
+}
+
 static gboolean
 meta_wayland_dma_buf_realize_texture (MetaWaylandBuffer  *buffer,
                                       GError            **error)
@@ -375,6 +734,14 @@ meta_wayland_dma_buf_realize_texture (MetaWaylandBuffer  *buffer,
   if (buffer->dma_buf.texture)
     return TRUE;
 
+  if (dma_buf->import && dma_buf->import->texture)
+    {
+      buffer->dma_buf.texture = g_object_ref (dma_buf->import->texture);
+      buffer->is_y_inverted = dma_buf->is_y_inverted;
+      dma_buf->is_external = dma_buf->import->is_external;
+      return TRUE;
+    }
+
   format_info = meta_format_info_from_drm_format (dma_buf->drm_format);
   if (!format_info)
     {
@@ -442,6 +809,11 @@ meta_wayland_dma_buf_realize_texture (MetaWaylandBuffer  *buffer,
       buffer->dma_buf.texture =
         meta_multi_texture_new_simple (cogl_texture);
     }
+  else if (can_import_external (dma_buf, cogl_context) &&
+           try_import_external (buffer))
+    {
+      dma_buf->is_external = TRUE;
+    }
   else
     {
       CoglTexture **textures;
@@ -510,6 +882,13 @@ meta_wayland_dma_buf_realize_texture (MetaWaylandBuffer  *buffer,
                                                         textures,
                                                         n_planes);
     }
+
+  if (dma_buf->import)
+    {
+      dma_buf->import->texture = g_object_ref (buffer->dma_buf.texture);
+      dma_buf->import->is_external = dma_buf->is_external;
+    }
+
   buffer->is_y_inverted = dma_buf->is_y_inverted;
 
   return TRUE;
@@ -603,13 +982,63 @@ import_scanout_gbm_bo (MetaWaylandDmaBufBuffer  *dma_buf,
 
   return gbm_bo;
 }
+
+static MetaDrmBufferGbm *
+ensure_scanout_buffer (MetaWaylandDmaBufBuffer  *dma_buf,
+                       MetaDeviceFile           *device_file,
+                       MetaGpuKms               *gpu_kms,
+                       int                       n_planes,
+                       GError                  **error)
+{
+  MetaWaylandDmaBufImport *import = dma_buf->import;
+  MetaDrmBufferGbm *fb;
+  MetaDrmBufferFlags buffer_flags;
+  struct gbm_bo *gbm_bo;
+  gboolean use_modifier;
+
+  if (import && import->scanout_buffer &&
+      import->scanout_device_file == device_file)
+    return g_object_ref (import->scanout_buffer);
+
+  gbm_bo = import_scanout_gbm_bo (dma_buf, gpu_kms, n_planes, &use_modifier,
+                                  error);
+  if (!gbm_bo)
+    {
+      g_prefix_error (error, "Failed to import scanout gbm_bo: ");
+      return NULL;
+    }
+
+  buffer_flags = META_DRM_BUFFER_FLAG_NONE;
+  if (!use_modifier)
+    buffer_flags |= META_DRM_BUFFER_FLAG_DISABLE_MODIFIERS;
+
+  fb = meta_drm_buffer_gbm_new_take (device_file, gbm_bo, buffer_flags, error);
+  if (!fb)
+    {
+      g_prefix_error (error, "Failed to create scanout buffer: ");
+      gbm_bo_destroy (gbm_bo);
+      return NULL;
+    }
+
+  if (import)
+    {
+      g_clear_object (&import->scanout_buffer);
+      g_clear_pointer (&import->scanout_device_file, meta_device_file_release);
+
+      import->scanout_buffer = g_object_ref (fb);
+      import->scanout_device_file = meta_device_file_acquire (device_file);
+    }
+
+  return fb;
+}
 #endif
 
 CoglScanout *
-meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                          CoglOnscreen          *onscreen,
-                                          const graphene_rect_t *src_rect,
-                                          const MtkRectangle    *dst_rect)
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer             *buffer,
+                                          CoglOnscreen                  *onscreen,
+                                          const graphene_rect_t         *src_rect,
+                                          const MtkRectangle            *dst_rect,
+                                          MetaWaylandBufferScanoutFlags  flags)
 {
 #ifdef HAVE_NATIVE_BACKEND
   MetaWaylandDmaBufBuffer *dma_buf;
@@ -619,12 +1048,10 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
   MetaRendererNative *renderer_native;
   MetaDeviceFile *device_file;
   MetaGpuKms *gpu_kms;
-  struct gbm_bo *gbm_bo;
   g_autoptr (MetaDrmBufferGbm) fb = NULL;
   g_autoptr (CoglScanout) scanout = NULL;
   g_autoptr (GError) error = NULL;
-  MetaDrmBufferFlags flags;
-  gboolean use_modifier;
+  gboolean is_compatible;
   int n_planes;
 
   dma_buf = meta_wayland_dma_buf_from_buffer (buffer);
@@ -644,25 +1071,10 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
 
   device_file = meta_renderer_native_get_primary_device_file (renderer_native);
   gpu_kms = meta_renderer_native_get_primary_gpu (renderer_native);
-  gbm_bo = import_scanout_gbm_bo (dma_buf, gpu_kms, n_planes, &use_modifier,
-                                  &error);
-  if (!gbm_bo)
-    {
-      meta_topic (META_DEBUG_RENDER,
-                  "Failed to import scanout gbm_bo: %s", error->message);
-      return NULL;
-    }
-
-  flags = META_DRM_BUFFER_FLAG_NONE;
-  if (!use_modifier)
-    flags |= META_DRM_BUFFER_FLAG_DISABLE_MODIFIERS;
-
-  fb = meta_drm_buffer_gbm_new_take (device_file, gbm_bo, flags, &error);
+  fb = ensure_scanout_buffer (dma_buf, device_file, gpu_kms, n_planes, &error);
   if (!fb)
     {
-      meta_topic (META_DEBUG_RENDER,
-                  "Failed to create scanout buffer: %s", error->message);
-      gbm_bo_destroy (gbm_bo);
+      meta_topic (META_DEBUG_RENDER, "%s", error->message);
       return NULL;
     }
 
@@ -670,7 +1082,14 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                               dst_rect);
   cogl_scanout_set_src_rect (scanout, src_rect);
 
-  if (!meta_onscreen_native_is_buffer_scanout_compatible (onscreen, scanout))
+  if (flags & META_WAYLAND_BUFFER_SCANOUT_FLAG_OVERLAY)
+    is_compatible = meta_onscreen_native_is_buffer_overlay_compatible (onscreen,
+                                                                       scanout);
+  else
+    is_compatible = meta_onscreen_native_is_buffer_scanout_compatible (onscreen,
+                                                                       scanout);
+
+  if (!is_compatible)
     {
       meta_topic (META_DEBUG_RENDER,
                   "Buffer not scanout compatible (see also KMS debug topic)");
@@ -829,6 +1248,37 @@ meta_wayland_dma_buf_fds_for_wayland_buffer (MetaWaylandBuffer *buffer)
 #endif
 }
 
+/**
+ * meta_wayland_dma_buf_create_snippet:
+ * @dma_buf: A #MetaWaylandDmaBufBuffer object
+ *
+ * Returns: (transfer full) (nullable): A #CoglSnippet sampling the texture
+ * of @dma_buf if it was imported as an external texture, or %NULL.
+ */
+CoglSnippet *
+meta_wayland_dma_buf_create_snippet (MetaWaylandDmaBufBuffer *dma_buf)
+{
+  MetaWaylandDmaBufManager *dma_buf_manager = dma_buf->manager;
+
+  if (!dma_buf->is_external)
+    return NULL;
+
+  if (!dma_buf_manager->external_snippet)
+    {
+      CoglSnippet *snippet;
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                                  "uniform samplerExternalOES tex_external;",
+                                  NULL);
+      cogl_snippet_set_replace (snippet,
+                                "cogl_texel = texture2D (tex_external,\n"
+                                "                        cogl_tex_coord.xy);");
+      dma_buf_manager->external_snippet = snippet;
+    }
+
+  return g_object_ref (dma_buf_manager->external_snippet);
+}
+
 /**
  * meta_wayland_dma_buf_from_buffer:
  * @buffer: A #MetaWaylandBuffer object
@@ -880,17 +1330,15 @@ is_fd_readable (int fd)
   return (poll_fd.revents & (G_IO_IN | G_IO_NVAL)) != 0;
 }
 
+/* Stops watching the file descriptors which have become readable, and
+ * returns whether all of them have */
 static gboolean
-meta_wayland_dma_buf_source_dispatch (GSource     *base,
-                                      GSourceFunc  callback,
-                                      gpointer     user_data)
+update_source_fds (MetaWaylandDmaBufSource *source)
 {
-  MetaWaylandDmaBufSource *source;
   MetaWaylandDmaBufBuffer *dma_buf;
   gboolean ready;
   uint32_t i;
 
-  source = (MetaWaylandDmaBufSource *) base;
   dma_buf = source->buffer->dma_buf.dma_buf;
   ready = TRUE;
 
@@ -917,7 +1365,17 @@ meta_wayland_dma_buf_source_dispatch (GSource     *base,
       g_clear_fd (&source->owned_sync_fd[i], NULL);
     }
 
-  if (!ready)
+  return ready;
+}
+
+static gboolean
+meta_wayland_dma_buf_source_dispatch (GSource     *base,
+                                      GSourceFunc  callback,
+                                      gpointer     user_data)
+{
+  MetaWaylandDmaBufSource *source = (MetaWaylandDmaBufSource *) base;
+
+  if (!update_source_fds (source))
     return G_SOURCE_CONTINUE;
 
   source->dispatch (source->buffer, source->user_data);
@@ -1079,6 +1537,34 @@ meta_wayland_drm_syncobj_create_source (MetaWaylandBuffer                *buffer
   return &source->base;
 }
 
+/**
+ * meta_wayland_dma_buf_source_try_dispatch:
+ * @source: A source created by meta_wayland_dma_buf_create_source() or
+ *   meta_wayland_drm_syncobj_create_source()
+ *
+ * Calls the dispatch callback of the source right away if the buffer has
+ * become ready since the main loop last polled it, instead of waiting for
+ * the next main loop iteration. The callback is expected to destroy the
+ * source.
+ *
+ * Returns: %TRUE if the dispatch callback was called
+ */
+gboolean
+meta_wayland_dma_buf_source_try_dispatch (GSource *source)
+{
+  MetaWaylandDmaBufSource *dma_buf_source = (MetaWaylandDmaBufSource *) source;
+
+  if (g_source_is_destroyed (source))
+    return FALSE;
+
+  if (!update_source_fds (dma_buf_source))
+    return FALSE;
+
+  dma_buf_source->dispatch (dma_buf_source->buffer, dma_buf_source->user_data);
+
+  return TRUE;
+}
+
 static void
 buffer_params_create_common (struct wl_client   *client,
                              struct wl_resource *params_resource,
@@ -1141,6 +1627,8 @@ buffer_params_create_common (struct wl_client   *client,
       return;
     }
 
+  dma_buf->import = acquire_import (dma_buf->manager, client, dma_buf);
+
   /* Create a new MetaWaylandBuffer wrapping our dmabuf, and immediately try
    * to realize it, so we can give the client success/fail feedback for the
    * import. */
@@ -1312,25 +1800,23 @@ has_modifier (GArray   *modifiers,
 }
 
 static gboolean
-crtc_supports_modifier (MetaCrtcKms *crtc_kms,
-                        uint32_t     drm_format,
-                        uint64_t     drm_modifier)
+plane_supports_modifier (MetaKmsPlane *plane,
+                         uint32_t      drm_format,
+                         uint64_t      drm_modifier)
 {
-  MetaKmsPlane *plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
-  GArray *crtc_modifiers;
-
-  g_return_val_if_fail (plane, FALSE);
+  GArray *plane_modifiers;
 
-  crtc_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
-  if (!crtc_modifiers)
+  plane_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
+  if (!plane_modifiers)
     return FALSE;
 
-  return has_modifier (crtc_modifiers, drm_modifier);
+  return has_modifier (plane_modifiers, drm_modifier);
 }
 
 static void
 ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
-                        MetaCrtc                         *crtc)
+                        MetaCrtc                         *crtc,
+                        MetaWaylandBufferScanoutFlags     scanout_flags)
 {
   MetaWaylandDmaBufManager *dma_buf_manager = surface_feedback->dma_buf_manager;
   MetaContext *context =
@@ -1349,7 +1835,13 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
   g_return_if_fail (META_IS_CRTC_KMS (crtc));
 
   crtc_kms = META_CRTC_KMS (crtc);
-  kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+
+  /* Surfaces that only fit on an overlay plane are given the formats of
+   * that plane, which may differ from the ones of the primary plane */
+  if (scanout_flags & META_WAYLAND_BUFFER_SCANOUT_FLAG_OVERLAY)
+    kms_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  else
+    kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
 
   g_return_if_fail (META_IS_KMS_PLANE (kms_plane));
 
@@ -1358,7 +1850,8 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
     {
       tranche = el->data;
 
-      if (tranche->scanout_crtc_id == meta_crtc_get_id (crtc))
+      if (tranche->scanout_crtc_id == meta_crtc_get_id (crtc) &&
+          tranche->scanout_plane_id == meta_kms_plane_get_id (kms_plane))
         return;
 
       meta_wayland_dma_buf_tranche_free (tranche);
@@ -1375,9 +1868,9 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
                            MetaWaylandDmaBufFormat,
                            i);
 
-          if (!crtc_supports_modifier (crtc_kms,
-                                       format.drm_format,
-                                       format.drm_modifier))
+          if (!plane_supports_modifier (kms_plane,
+                                        format.drm_format,
+                                        format.drm_modifier))
             continue;
 
           g_array_append_val (formats, format);
@@ -1415,6 +1908,7 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
                                               priority,
                                               flags);
   tranche->scanout_crtc_id = meta_crtc_get_id (crtc);
+  tranche->scanout_plane_id = meta_kms_plane_get_id (kms_plane);
   meta_wayland_dma_buf_feedback_add_tranche (feedback, tranche);
 }
 
@@ -1439,11 +1933,15 @@ static void
 update_surface_feedback_tranches (MetaWaylandDmaBufSurfaceFeedback *surface_feedback)
 {
 #ifdef HAVE_NATIVE_BACKEND
+  MetaWaylandSurface *surface = surface_feedback->surface;
   MetaCrtc *crtc;
 
-  crtc = meta_wayland_surface_get_scanout_candidate (surface_feedback->surface);
+  crtc = meta_wayland_surface_get_scanout_candidate (surface);
   if (crtc)
-    ensure_scanout_tranche (surface_feedback, crtc);
+    {
+      ensure_scanout_tranche (surface_feedback, crtc,
+                              meta_wayland_surface_get_scanout_candidate_flags (surface));
+    }
   else
     clear_scanout_tranche (surface_feedback);
 #endif /* HAVE_NATIVE_BACKEND */
@@ -1938,6 +2436,8 @@ meta_wayland_dma_buf_buffer_finalize (GObject *object)
   MetaWaylandDmaBufBuffer *dma_buf = META_WAYLAND_DMA_BUF_BUFFER (object);
   int i;
 
+  g_clear_pointer (&dma_buf->import, release_import);
+
   for (i = 0; i < META_WAYLAND_DMA_BUF_MAX_FDS; i++)
     g_clear_fd (&dma_buf->fds[i], NULL);
 
@@ -1963,6 +2463,21 @@ meta_wayland_dma_buf_buffer_class_init (MetaWaylandDmaBufBufferClass *klass)
   object_class->finalize = meta_wayland_dma_buf_buffer_finalize;
 }
 
+/* Imports still used by buffers are freed when the last one is destroyed */
+static gboolean
+detach_used_import (gpointer key,
+                    gpointer value,
+                    gpointer user_data)
+{
+  MetaWaylandDmaBufImport *import = value;
+
+  if (import->n_users == 0)
+    return FALSE;
+
+  import->manager = NULL;
+  return TRUE;
+}
+
 static void
 meta_wayland_dma_buf_manager_finalize (GObject *object)
 {
@@ -1975,6 +2490,16 @@ meta_wayland_dma_buf_manager_finalize (GObject *object)
   g_clear_pointer (&dma_buf_manager->default_feedback,
                    meta_wayland_dma_buf_feedback_free);
 
+  g_clear_handle_id (&dma_buf_manager->purge_imports_id, g_source_remove);
+  g_hash_table_foreach_steal (dma_buf_manager->imports,
+                              detach_used_import,
+                              NULL);
+  g_clear_pointer (&dma_buf_manager->imports, g_hash_table_destroy);
+  g_queue_init (&dma_buf_manager->unused_imports);
+  g_clear_pointer (&dma_buf_manager->external_import_failures,
+                   g_hash_table_unref);
+  g_clear_object (&dma_buf_manager->external_snippet);
+
   G_OBJECT_CLASS (meta_wayland_dma_buf_manager_parent_class)->finalize (object);
 }
 
@@ -1990,6 +2515,12 @@ meta_wayland_dma_buf_manager_class_init (MetaWaylandDmaBufManagerClass *klass)
 }
 
 static void
-meta_wayland_dma_buf_manager_init (MetaWaylandDmaBufManager *dma_buf)
-{
+meta_wayland_dma_buf_manager_init (MetaWaylandDmaBufManager *dma_buf_manager)
+{
+  dma_buf_manager->imports =
+    g_hash_table_new_full (import_key_hash, import_key_equal,
+                           NULL,
+                           (GDestroyNotify) meta_wayland_dma_buf_import_free);
+  g_queue_init (&dma_buf_manager->unused_imports);
+  dma_buf_manager->external_import_failures = g_hash_table_new (NULL, NULL);
 }
@@ -55,6 +55,9 @@ meta_wayland_dma_buf_fds_for_wayland_buffer (MetaWaylandBuffer *buffer);
 MetaWaylandDmaBufBuffer *
 meta_wayland_dma_buf_from_buffer (MetaWaylandBuffer *buffer);
 
+CoglSnippet *
+meta_wayland_dma_buf_create_snippet (MetaWaylandDmaBufBuffer *dma_buf);
+
 typedef void (*MetaWaylandDmaBufSourceDispatch) (MetaWaylandBuffer *buffer,
                                                  gpointer           user_data);
 
@@ -70,8 +73,11 @@ meta_wayland_drm_syncobj_create_source (MetaWaylandBuffer                *buffer
                                         MetaWaylandDmaBufSourceDispatch   dispatch,
                                         gpointer                          user_data);
 
+gboolean meta_wayland_dma_buf_source_try_dispatch (GSource *source);
+
 CoglScanout *
-meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                          CoglOnscreen          *onscreen,
-                                          const graphene_rect_t *src_rect,
-                                          const MtkRectangle    *dst_rect);
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer             *buffer,
+                                          CoglOnscreen                  *onscreen,
+                                          const graphene_rect_t         *src_rect,
+                                          const MtkRectangle            *dst_rect,
+                                          MetaWaylandBufferScanoutFlags  flags);
@@ -56,11 +56,25 @@
 #include "core/meta-anonymous-file.h"
 #include "wayland/meta-wayland-private.h"
 
+/* Number of serialized keymaps kept around, so that switching back to a
+ * previously used keymap doesn't serialize it into a new file again.
+ */
+#define MAX_CACHED_KEYMAP_FILES 4
+
+typedef struct
+{
+  struct xkb_keymap *keymap;
+  MetaAnonymousFile *rofile;
+} MetaWaylandKeymapFile;
+
 typedef struct
 {
   struct xkb_keymap *keymap;
   struct xkb_state *state;
+
+  /* Owned by an entry in keymap_files */
   MetaAnonymousFile *keymap_rofile;
+  GQueue keymap_files;
 } MetaWaylandXkbInfo;
 
 struct _MetaWaylandKeyboard
@@ -152,45 +166,91 @@ inform_clients_of_new_keymap (MetaWaylandKeyboard *keyboard)
 }
 
 static void
-meta_wayland_keyboard_take_keymap (MetaWaylandKeyboard *keyboard,
-				   struct xkb_keymap   *keymap)
+meta_wayland_keymap_file_free (MetaWaylandKeymapFile *keymap_file)
 {
-  MetaWaylandXkbInfo *xkb_info = &keyboard->xkb_info;
+  xkb_keymap_unref (keymap_file->keymap);
+  meta_anonymous_file_free (keymap_file->rofile);
+  g_free (keymap_file);
+}
+
+static MetaAnonymousFile *
+ensure_keymap_file (MetaWaylandXkbInfo *xkb_info,
+                    struct xkb_keymap  *keymap)
+{
+  MetaWaylandKeymapFile *keymap_file;
+  MetaAnonymousFile *rofile;
   char *keymap_string;
   size_t keymap_size;
+  GList *l;
 
-  if (keymap == NULL)
+  for (l = xkb_info->keymap_files.head; l; l = l->next)
     {
-      g_warning ("Attempting to set null keymap (compilation probably failed)");
-      return;
-    }
+      keymap_file = l->data;
 
-  xkb_keymap_unref (xkb_info->keymap);
-  xkb_info->keymap = xkb_keymap_ref (keymap);
+      if (keymap_file->keymap != keymap)
+        continue;
 
-  meta_wayland_keyboard_update_xkb_state (keyboard);
+      /* Keep the most recently used file first */
+      g_queue_unlink (&xkb_info->keymap_files, l);
+      g_queue_push_head_link (&xkb_info->keymap_files, l);
+
+      return keymap_file->rofile;
+    }
 
-  keymap_string =
-    xkb_keymap_get_as_string (xkb_info->keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+  keymap_string = xkb_keymap_get_as_string (keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
   if (!keymap_string)
     {
       g_warning ("Failed to get string version of keymap");
-      return;
+      return NULL;
     }
   keymap_size = strlen (keymap_string) + 1;
 
-  g_clear_pointer (&xkb_info->keymap_rofile, meta_anonymous_file_free);
-  xkb_info->keymap_rofile =
-    meta_anonymous_file_new (keymap_size, (const uint8_t *) keymap_string);
+  rofile = meta_anonymous_file_new (keymap_size, (const uint8_t *) keymap_string);
 
   free (keymap_string);
 
-  if (!xkb_info->keymap_rofile)
+  if (!rofile)
     {
       g_warning ("Failed to create anonymous file for keymap");
+      return NULL;
+    }
+
+  if (g_queue_get_length (&xkb_info->keymap_files) >= MAX_CACHED_KEYMAP_FILES)
+    meta_wayland_keymap_file_free (g_queue_pop_tail (&xkb_info->keymap_files));
+
+  keymap_file = g_new0 (MetaWaylandKeymapFile, 1);
+  keymap_file->keymap = xkb_keymap_ref (keymap);
+  keymap_file->rofile = rofile;
+  g_queue_push_head (&xkb_info->keymap_files, keymap_file);
+
+  return rofile;
+}
+
+static void
+meta_wayland_keyboard_take_keymap (MetaWaylandKeyboard *keyboard,
+				   struct xkb_keymap   *keymap)
+{
+  MetaWaylandXkbInfo *xkb_info = &keyboard->xkb_info;
+
+  if (keymap == NULL)
+    {
+      g_warning ("Attempting to set null keymap (compilation probably failed)");
       return;
     }
 
+  xkb_keymap_unref (xkb_info->keymap);
+  xkb_info->keymap = xkb_keymap_ref (keymap);
+
+  meta_wayland_keyboard_update_xkb_state (keyboard);
+
+  /* The backend hands out the same keymap object again when switching back
+   * to a previously used keymap, in which case the existing sealed file is
+   * shared with clients again instead of serializing the keymap anew.
+   */
+  xkb_info->keymap_rofile = ensure_keymap_file (xkb_info, xkb_info->keymap);
+  if (!xkb_info->keymap_rofile)
+    return;
+
   inform_clients_of_new_keymap (keyboard);
 
   notify_modifiers (keyboard);
@@ -579,7 +639,9 @@ meta_wayland_xkb_info_destroy (MetaWaylandXkbInfo *xkb_info)
 {
   g_clear_pointer (&xkb_info->keymap, xkb_keymap_unref);
   g_clear_pointer (&xkb_info->state, xkb_state_unref);
-  g_clear_pointer (&xkb_info->keymap_rofile, meta_anonymous_file_free);
+  xkb_info->keymap_rofile = NULL;
+  g_queue_clear_full (&xkb_info->keymap_files,
+                      (GDestroyNotify) meta_wayland_keymap_file_free);
 }
 
 void
@@ -60,12 +60,17 @@ struct _MetaWaylandOutput
   GList *resources;
   GList *xdg_output_resources;
 
-  /* Protocol state */
+  /* Protocol state, kept by value as the monitor and its modes are
+   * replaced on reconfiguration */
   MtkRectangle layout;
   MetaSubpixelOrder subpixel_order;
   MtkMonitorTransform transform;
-  MetaMonitorMode *mode;
-  MetaMonitorMode *preferred_mode;
+  int physical_width_mm;
+  int physical_height_mm;
+  uint32_t mode_flags;
+  int mode_width;
+  int mode_height;
+  int32_t refresh_rate_khz;
   float scale;
 
   MetaMonitor *monitor;
@@ -194,6 +199,27 @@ maybe_scale_for_xwayland (MetaWaylandOutput  *wayland_output,
 #endif
 }
 
+static uint32_t
+get_mode_flags (MetaMonitor *monitor)
+{
+  uint32_t mode_flags;
+
+  mode_flags = WL_OUTPUT_MODE_CURRENT;
+  if (meta_monitor_get_current_mode (monitor) ==
+      meta_monitor_get_preferred_mode (monitor))
+    mode_flags |= WL_OUTPUT_MODE_PREFERRED;
+
+  return mode_flags;
+}
+
+static int32_t
+get_refresh_rate_khz (MetaMonitor *monitor)
+{
+  MetaMonitorMode *mode = meta_monitor_get_current_mode (monitor);
+
+  return (int32_t) (meta_monitor_mode_get_refresh_rate (mode) * 1000);
+}
+
 static void
 send_output_events (struct wl_resource *resource,
                     MetaWaylandOutput  *wayland_output,
@@ -205,75 +231,48 @@ send_output_events (struct wl_resource *resource,
     meta_monitor_get_logical_monitor (monitor);
   int version = wl_resource_get_version (resource);
   MtkRectangle layout;
-  MtkRectangle old_layout;
   MtkMonitorTransform transform;
-  MtkMonitorTransform old_transform;
-  MetaMonitorMode *mode;
-  MetaMonitorMode *old_mode;
-  MetaMonitorMode *preferred_mode;
-  MetaMonitorMode *old_preferred_mode;
-  guint mode_flags;
-  guint old_mode_flags;
+  MetaSubpixelOrder subpixel_order;
+  int physical_width_mm;
+  int physical_height_mm;
+  uint32_t mode_flags;
   int32_t refresh_rate_khz;
-  int32_t old_refresh_rate_khz;
   int scale_int;
   int old_scale_int;
   int mode_width, mode_height;
-  int old_mode_width, old_mode_height;
   gboolean need_done = FALSE;
 
   layout = meta_logical_monitor_get_layout (logical_monitor);
-  old_layout = wayland_output->layout;
-
   transform = meta_logical_monitor_get_transform (logical_monitor);
-  old_transform = wayland_output->transform;
-
-  mode = meta_monitor_get_current_mode (monitor);
-  old_mode = wayland_output->mode;
-
-  preferred_mode = meta_monitor_get_preferred_mode (monitor);
-  old_preferred_mode = wayland_output->preferred_mode;
-
-  mode_flags = WL_OUTPUT_MODE_CURRENT;
-  if (mode == preferred_mode)
-    mode_flags |= WL_OUTPUT_MODE_PREFERRED;
-
-  old_mode_flags = WL_OUTPUT_MODE_CURRENT;
-  if (old_mode == old_preferred_mode)
-    old_mode_flags |= WL_OUTPUT_MODE_PREFERRED;
+  subpixel_order = meta_monitor_get_subpixel_order (monitor);
+  meta_monitor_get_physical_dimensions (monitor,
+                                        &physical_width_mm,
+                                        &physical_height_mm);
 
-  refresh_rate_khz =
-    (int32_t) (meta_monitor_mode_get_refresh_rate (mode) * 1000);
-  old_refresh_rate_khz =
-    (int32_t) (meta_monitor_mode_get_refresh_rate (old_mode) * 1000);
+  mode_flags = get_mode_flags (monitor);
+  refresh_rate_khz = get_refresh_rate_khz (monitor);
+  meta_monitor_mode_get_resolution (meta_monitor_get_current_mode (monitor),
+                                    &mode_width, &mode_height);
 
   scale_int = (int) ceilf (meta_logical_monitor_get_scale (logical_monitor));
   old_scale_int = (int) ceilf (wayland_output->scale);
 
-  meta_monitor_mode_get_resolution (mode, &mode_width, &mode_height);
-  meta_monitor_mode_get_resolution (old_mode,
-                                    &old_mode_width, &old_mode_height);
-
   if (need_all_events ||
-      old_layout.x != layout.x || old_layout.y != layout.y ||
-      old_transform != transform)
+      wayland_output->layout.x != layout.x ||
+      wayland_output->layout.y != layout.y ||
+      wayland_output->transform != transform ||
+      wayland_output->subpixel_order != subpixel_order ||
+      wayland_output->physical_width_mm != physical_width_mm ||
+      wayland_output->physical_height_mm != physical_height_mm)
     {
       const char *vendor;
       const char *product;
-      int physical_width_mm;
-      int physical_height_mm;
-      MetaSubpixelOrder subpixel_order;
       enum wl_output_subpixel wl_subpixel_order;
       uint32_t wl_transform;
 
       vendor = meta_monitor_get_vendor (monitor);
       product = meta_monitor_get_product (monitor);
 
-      meta_monitor_get_physical_dimensions (monitor,
-                                            &physical_width_mm,
-                                            &physical_height_mm);
-
-      subpixel_order = meta_monitor_get_subpixel_order (monitor);
       wl_subpixel_order =
         meta_subpixel_order_to_wl_output_subpixel (subpixel_order);
 
@@ -295,10 +294,10 @@ send_output_events (struct wl_resource *resource,
     }
 
   if (need_all_events ||
-      old_mode_width != mode_width ||
-      old_mode_height != mode_height ||
-      old_refresh_rate_khz != refresh_rate_khz ||
-      old_mode_flags != mode_flags)
+      wayland_output->mode_width != mode_width ||
+      wayland_output->mode_height != mode_height ||
+      wayland_output->refresh_rate_khz != refresh_rate_khz ||
+      wayland_output->mode_flags != mode_flags)
     {
       wl_output_send_mode (resource,
                            mode_flags,
@@ -354,7 +353,6 @@ bind_output (struct wl_client *client,
   struct wl_resource *resource;
 #ifdef WITH_VERBOSE_MODE
   MetaLogicalMonitor *logical_monitor;
-  int mode_width, mode_height;
 #endif
 
   resource = wl_resource_create (client, &wl_output_interface, version, id);
@@ -377,14 +375,13 @@ bind_output (struct wl_client *client,
 
 #ifdef WITH_VERBOSE_MODE
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
-  meta_monitor_mode_get_resolution (wayland_output->mode, &mode_width, &mode_height);
 
   meta_verbose ("Binding monitor %p/%s (%u, %u, %u, %u) x %f",
                 logical_monitor,
                 meta_monitor_get_product (monitor),
                 wayland_output->layout.x, wayland_output->layout.y,
-                mode_width, mode_height,
-                meta_monitor_mode_get_refresh_rate (wayland_output->mode));
+                wayland_output->mode_width, wayland_output->mode_height,
+                wayland_output->refresh_rate_khz / 1000.0);
 #endif
 
   send_output_events (resource, wayland_output, monitor, TRUE, NULL);
@@ -405,8 +402,14 @@ meta_wayland_output_set_monitor (MetaWaylandOutput *wayland_output,
   wayland_output->subpixel_order = meta_monitor_get_subpixel_order (monitor);
   wayland_output->transform =
     meta_logical_monitor_get_transform (logical_monitor);
-  wayland_output->mode = meta_monitor_get_current_mode (monitor);
-  wayland_output->preferred_mode = meta_monitor_get_preferred_mode (monitor);
+  meta_monitor_get_physical_dimensions (monitor,
+                                        &wayland_output->physical_width_mm,
+                                        &wayland_output->physical_height_mm);
+  wayland_output->mode_flags = get_mode_flags (monitor);
+  meta_monitor_mode_get_resolution (meta_monitor_get_current_mode (monitor),
+                                    &wayland_output->mode_width,
+                                    &wayland_output->mode_height);
+  wayland_output->refresh_rate_khz = get_refresh_rate_khz (monitor);
   wayland_output->scale = meta_logical_monitor_get_scale (logical_monitor);
 }
 
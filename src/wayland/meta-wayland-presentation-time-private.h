@@ -32,6 +32,9 @@ typedef struct _MetaWaylandPresentationFeedback
   struct wl_resource *resource;
 
   MetaWaylandSurface *surface;
+
+  /* Whether the surface was scanned out directly on its own plane */
+  gboolean is_zero_copy;
 } MetaWaylandPresentationFeedback;
 
 typedef struct _MetaWaylandPresentationTime
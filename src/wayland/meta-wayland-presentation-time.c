@@ -168,6 +168,19 @@ on_after_paint (ClutterStage          *stage,
 
       if (!wl_list_empty (&surface->presentation_time.feedback_list))
         {
+          MetaWaylandPresentationFeedback *feedback;
+          gboolean is_zero_copy;
+
+          /* A surface on an overlay plane is presented without being
+           * copied, even though the rest of the frame was composited. */
+          is_zero_copy =
+            meta_wayland_surface_is_overlay_scanout_on_view (surface,
+                                                             stage_view);
+          wl_list_for_each (feedback,
+                            &surface->presentation_time.feedback_list,
+                            link)
+            feedback->is_zero_copy = is_zero_copy;
+
           /* Add feedbacks to the list to be fired on presentation. */
           wl_list_insert_list (feedbacks,
                                &surface->presentation_time.feedback_list);
@@ -337,7 +350,12 @@ meta_wayland_presentation_feedback_present (MetaWaylandPresentationFeedback *fee
   tv_sec_lo = time_s;
   tv_nsec = (uint32_t) us2ns (time_us - s2us (time_s));
 
-  refresh_interval_ns = (uint32_t) (0.5 + s2ns (1) / frame_info->refresh_rate);
+  /* With a variable refresh rate, this is the fastest rate of the mode, as
+   * allowed by the protocol. An unknown rate is reported as 0. */
+  if (frame_info->refresh_rate > 0.0f)
+    refresh_interval_ns = (uint32_t) (0.5 + s2ns (1) / frame_info->refresh_rate);
+  else
+    refresh_interval_ns = 0;
 
   maybe_update_presentation_sequence (surface, frame_info, output);
 
@@ -349,7 +367,8 @@ meta_wayland_presentation_feedback_present (MetaWaylandPresentationFeedback *fee
   if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_HW_CLOCK)
     flags |= WP_PRESENTATION_FEEDBACK_KIND_HW_CLOCK;
 
-  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY)
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY ||
+      feedback->is_zero_copy)
     flags |= WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY;
 
   if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_VSYNC)
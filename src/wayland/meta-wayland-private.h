@@ -109,12 +109,21 @@ struct _MetaWaylandCompositor
 
   MetaWaylandPresentationTime presentation_time;
   MetaWaylandDmaBufManager *dma_buf_manager;
+  MetaWaylandClientStatsManager *client_stats_manager;
 
   /*
    * Queue of transactions which have been committed but not applied yet, in the
    * order they were committed.
    */
   GQueue committed_transactions;
+
+  /*
+   * Actor surfaces to synchronize once all states of the transaction being
+   * applied are, so that each is synchronized only once, or NULL when no
+   * transaction is being applied.
+   */
+  GHashTable *deferred_actor_syncs;
+  gboolean is_flushing_actor_syncs;
 };
 
 gboolean meta_wayland_compositor_is_egl_display_bound (MetaWaylandCompositor *compositor);
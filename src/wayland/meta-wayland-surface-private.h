@@ -138,6 +138,10 @@ struct _MetaWaylandSurfaceState
 
   gboolean has_new_color_state;
   ClutterColorState *color_state;
+
+  /* tearing-control */
+  gboolean has_new_allow_tearing;
+  gboolean allow_tearing;
 };
 
 struct _MetaWaylandDragDestFuncs
@@ -168,6 +172,9 @@ struct _MetaWaylandSurface
   MetaWaylandSurfaceRole *role;
   MtkRegion *input_region;
   MtkRegion *opaque_region;
+  /* Opaque part of the content in buffer coordinates, for when the client
+   * didn't set an opaque region */
+  MtkRegion *inferred_opaque_region;
   int32_t offset_x, offset_y;
   GHashTable *outputs;
   MtkMonitorTransform buffer_transform;
@@ -269,6 +276,10 @@ struct _MetaWaylandSurface
 
   /* dma-buf feedback */
   MetaCrtc *scanout_candidate;
+  MetaWaylandBufferScanoutFlags scanout_candidate_flags;
+
+  /* Stage view whose overlay plane the surface buffer is scanned out on */
+  ClutterStageView *overlay_scanout_view;
 
   /* Transactions */
   struct {
@@ -281,6 +292,14 @@ struct _MetaWaylandSurface
 
   /* color-management */
   ClutterColorState *color_state;
+
+  /* tearing-control */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+
+    gboolean allow_tearing;
+  } tearing_control;
 };
 
 void                meta_wayland_shell_init     (MetaWaylandCompositor *compositor);
@@ -358,6 +377,8 @@ MetaWaylandSurface * meta_wayland_surface_role_get_surface (MetaWaylandSurfaceRo
 
 MtkRegion * meta_wayland_surface_calculate_input_region (MetaWaylandSurface *surface);
 
+MtkRegion * meta_wayland_surface_get_inferred_opaque_region (MetaWaylandSurface *surface);
+
 
 gboolean            meta_wayland_surface_begin_grab_op (MetaWaylandSurface   *surface,
                                                         MetaWaylandSeat      *seat,
@@ -402,14 +423,26 @@ int                 meta_wayland_surface_get_buffer_width (MetaWaylandSurface *s
 META_EXPORT_TEST
 int                 meta_wayland_surface_get_buffer_height (MetaWaylandSurface *surface);
 
-CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
-                                                              CoglOnscreen       *onscreen,
-                                                              ClutterStageView   *stage_view);
+CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface            *surface,
+                                                              CoglOnscreen                  *onscreen,
+                                                              ClutterStageView              *stage_view,
+                                                              MetaWaylandBufferScanoutFlags  flags);
 
 MetaCrtc * meta_wayland_surface_get_scanout_candidate (MetaWaylandSurface *surface);
 
-void meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface *surface,
-                                                 MetaCrtc           *crtc);
+MetaWaylandBufferScanoutFlags meta_wayland_surface_get_scanout_candidate_flags (MetaWaylandSurface *surface);
+
+gboolean meta_wayland_surface_get_allow_tearing (MetaWaylandSurface *surface);
+
+void meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface            *surface,
+                                                 MetaCrtc                      *crtc,
+                                                 MetaWaylandBufferScanoutFlags  flags);
+
+void meta_wayland_surface_set_overlay_scanout_view (MetaWaylandSurface *surface,
+                                                    ClutterStageView   *stage_view);
+
+gboolean meta_wayland_surface_is_overlay_scanout_on_view (MetaWaylandSurface *surface,
+                                                          ClutterStageView   *stage_view);
 
 int meta_wayland_surface_get_geometry_scale (MetaWaylandSurface *surface);
 
@@ -22,6 +22,7 @@
 
 #include "wayland/meta-wayland-surface-private.h"
 
+#include <float.h>
 #include <gobject/gvaluecollector.h>
 #include <wayland-server.h>
 
@@ -295,6 +296,35 @@ region_transform (const MtkRegion     *region,
   return transformed_region;
 }
 
+static void
+update_inferred_opaque_region (MetaWaylandSurface *surface,
+                               MtkRegion          *buffer_region)
+{
+  g_autoptr (MtkRegion) opaque_region = NULL;
+
+  if (surface->opaque_region || meta_wayland_surface_is_xwayland (surface))
+    {
+      g_clear_pointer (&surface->inferred_opaque_region, mtk_region_unref);
+      return;
+    }
+
+  opaque_region = meta_wayland_buffer_infer_opaque_region (surface->buffer,
+                                                           buffer_region);
+  if (!opaque_region)
+    {
+      g_clear_pointer (&surface->inferred_opaque_region, mtk_region_unref);
+      return;
+    }
+
+  /* What is outside of the region didn't change, and is still as opaque
+   * as it was */
+  if (!surface->inferred_opaque_region)
+    surface->inferred_opaque_region = mtk_region_create ();
+
+  mtk_region_subtract (surface->inferred_opaque_region, buffer_region);
+  mtk_region_union (surface->inferred_opaque_region, opaque_region);
+}
+
 static void
 surface_process_damage (MetaWaylandSurface *surface,
                         MtkRegion          *surface_region,
@@ -385,6 +415,7 @@ surface_process_damage (MetaWaylandSurface *surface,
 
   meta_wayland_buffer_process_damage (buffer, surface->applied_state.texture,
                                       buffer_region);
+  update_inferred_opaque_region (surface, buffer_region);
 
   actor = meta_wayland_surface_get_actor (surface);
   if (actor)
@@ -456,6 +487,9 @@ meta_wayland_surface_state_set_default (MetaWaylandSurfaceState *state)
 
   state->has_new_color_state = FALSE;
   state->color_state = NULL;
+
+  state->has_new_allow_tearing = FALSE;
+  state->allow_tearing = FALSE;
 }
 
 static void
@@ -657,6 +691,12 @@ meta_wayland_surface_state_merge_into (MetaWaylandSurfaceState *from,
 
       to->has_new_color_state = TRUE;
     }
+
+  if (from->has_new_allow_tearing)
+    {
+      to->allow_tearing = from->allow_tearing;
+      to->has_new_allow_tearing = TRUE;
+    }
 }
 
 static void
@@ -755,6 +795,7 @@ meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
                                   MetaWaylandSurfaceState *state)
 {
   gboolean had_damage = FALSE;
+  gboolean texture_replaced = FALSE;
   int old_width, old_height;
 
   old_width = meta_wayland_surface_get_width (surface);
@@ -788,6 +829,7 @@ meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
         meta_wayland_buffer_dec_use_count (surface->buffer);
 
       g_set_object (&surface->buffer, state->buffer);
+      texture_replaced = surface->applied_state.texture != state->texture;
       g_clear_object (&surface->applied_state.texture);
       surface->applied_state.texture = g_steal_pointer (&state->texture);
 
@@ -873,9 +915,31 @@ meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
         surface->input_region = mtk_region_ref (state->input_region);
     }
 
+  /* A new texture was uploaded in full, not only where it was damaged */
+  if (texture_replaced)
+    {
+      g_clear_pointer (&surface->inferred_opaque_region, mtk_region_unref);
+
+      if (surface->buffer)
+        {
+          g_autoptr (MtkRegion) buffer_region = NULL;
+          MtkRectangle buffer_rect;
+
+          buffer_rect = (MtkRectangle) {
+            .width = meta_wayland_surface_get_buffer_width (surface),
+            .height = meta_wayland_surface_get_buffer_height (surface),
+          };
+          buffer_region = mtk_region_create_rectangle (&buffer_rect);
+          update_inferred_opaque_region (surface, buffer_region);
+        }
+    }
+
   if (state->has_new_color_state)
     g_set_object (&surface->color_state, state->color_state);
 
+  if (state->has_new_allow_tearing)
+    surface->tearing_control.allow_tearing = state->allow_tearing;
+
   /*
    * A new commit indicates a new content update, so any previous
    * content update did not go on screen and needs to be discarded.
@@ -1582,6 +1646,7 @@ meta_wayland_surface_dispose (GObject *object)
   MetaWaylandFrameCallback *cb, *next;
 
   g_clear_object (&surface->scanout_candidate);
+  g_clear_weak_pointer (&surface->overlay_scanout_view);
   g_clear_object (&surface->role);
 
   if (surface->unassigned.buffer)
@@ -1600,6 +1665,7 @@ meta_wayland_surface_dispose (GObject *object)
   g_clear_object (&surface->buffer);
 
   g_clear_pointer (&surface->opaque_region, mtk_region_unref);
+  g_clear_pointer (&surface->inferred_opaque_region, mtk_region_unref);
   g_clear_pointer (&surface->input_region, mtk_region_unref);
 
   meta_wayland_compositor_remove_frame_callback_surface (compositor, surface);
@@ -2285,6 +2351,51 @@ meta_wayland_surface_calculate_input_region (MetaWaylandSurface *surface)
   return region;
 }
 
+/* Returns the inferred opaque region in surface coordinates, shrunk to
+ * whole logical pixels */
+MtkRegion *
+meta_wayland_surface_get_inferred_opaque_region (MetaWaylandSurface *surface)
+{
+  int scale = surface->applied_state.scale;
+  g_autofree MtkRectangle *rects = NULL;
+  int i, n_rects, n_surface_rects = 0;
+
+  if (!surface->inferred_opaque_region)
+    return NULL;
+
+  /* Only the plain mapping from buffer to surface coordinates is handled */
+  if (surface->buffer_transform != MTK_MONITOR_TRANSFORM_NORMAL ||
+      surface->viewport.has_src_rect ||
+      surface->viewport.has_dst_size)
+    return NULL;
+
+  n_rects = mtk_region_num_rectangles (surface->inferred_opaque_region);
+  rects = g_new (MtkRectangle, MAX (n_rects, 1));
+
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect =
+        mtk_region_get_rectangle (surface->inferred_opaque_region, i);
+      int x1, y1, x2, y2;
+
+      x1 = (rect.x + scale - 1) / scale;
+      y1 = (rect.y + scale - 1) / scale;
+      x2 = (rect.x + rect.width) / scale;
+      y2 = (rect.y + rect.height) / scale;
+      if (x2 <= x1 || y2 <= y1)
+        continue;
+
+      rects[n_surface_rects++] = (MtkRectangle) {
+        .x = x1,
+        .y = y1,
+        .width = x2 - x1,
+        .height = y2 - y1,
+      };
+    }
+
+  return mtk_region_create_rectangles (rects, n_surface_rects);
+}
+
 void
 meta_wayland_surface_inhibit_shortcuts (MetaWaylandSurface *surface,
                                         MetaWaylandSeat    *seat)
@@ -2403,9 +2514,10 @@ meta_wayland_surface_get_buffer_height (MetaWaylandSurface *surface)
 }
 
 CoglScanout *
-meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
-                                          CoglOnscreen       *onscreen,
-                                          ClutterStageView   *stage_view)
+meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface            *surface,
+                                          CoglOnscreen                  *onscreen,
+                                          ClutterStageView              *stage_view,
+                                          MetaWaylandBufferScanoutFlags  flags)
 {
   MetaSurfaceActor *surface_actor;
   MtkMonitorTransform view_transform;
@@ -2417,6 +2529,8 @@ meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
   float view_scale;
   int view_crtc_width;
   int view_crtc_height;
+  int buffer_width;
+  int buffer_height;
 
   if (!surface->buffer)
     return NULL;
@@ -2465,16 +2579,39 @@ meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
                            view_crtc_height,
                            &crtc_dst_rect);
 
-  if (surface->viewport.has_src_rect)
+  buffer_width = meta_wayland_surface_get_buffer_width (surface);
+  buffer_height = meta_wayland_surface_get_buffer_height (surface);
+
+  /* A source rectangle covering the whole buffer, as e.g. set by clients
+   * rendering at a fractional scale, is the same as not having any.
+   */
+  if (surface->viewport.has_src_rect &&
+      !(G_APPROX_VALUE (surface->viewport.src_rect.origin.x, 0.0f, FLT_EPSILON) &&
+        G_APPROX_VALUE (surface->viewport.src_rect.origin.y, 0.0f, FLT_EPSILON) &&
+        G_APPROX_VALUE (surface->viewport.src_rect.size.width,
+                        (float) buffer_width, FLT_EPSILON) &&
+        G_APPROX_VALUE (surface->viewport.src_rect.size.height,
+                        (float) buffer_height, FLT_EPSILON)))
     {
       src_rect = surface->viewport.src_rect;
       src_rect_ptr = &src_rect;
     }
 
+  if (crtc_dst_rect.width != buffer_width ||
+      crtc_dst_rect.height != buffer_height)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Surface buffer (%dx%d) does not match its size on the CRTC "
+                  "(%dx%d), scanout requires scaling",
+                  buffer_width, buffer_height,
+                  crtc_dst_rect.width, crtc_dst_rect.height);
+    }
+
   return meta_wayland_buffer_try_acquire_scanout (surface->buffer,
                                                   onscreen,
                                                   src_rect_ptr,
-                                                  &crtc_dst_rect);
+                                                  &crtc_dst_rect,
+                                                  flags);
 }
 
 MetaCrtc *
@@ -2483,18 +2620,50 @@ meta_wayland_surface_get_scanout_candidate (MetaWaylandSurface *surface)
   return surface->scanout_candidate;
 }
 
+MetaWaylandBufferScanoutFlags
+meta_wayland_surface_get_scanout_candidate_flags (MetaWaylandSurface *surface)
+{
+  return surface->scanout_candidate_flags;
+}
+
+gboolean
+meta_wayland_surface_get_allow_tearing (MetaWaylandSurface *surface)
+{
+  return surface->tearing_control.allow_tearing;
+}
+
 void
-meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface *surface,
-                                            MetaCrtc           *crtc)
+meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface            *surface,
+                                            MetaCrtc                      *crtc,
+                                            MetaWaylandBufferScanoutFlags  flags)
 {
-  if (surface->scanout_candidate == crtc)
+  if (!crtc)
+    flags = META_WAYLAND_BUFFER_SCANOUT_FLAG_NONE;
+
+  if (surface->scanout_candidate == crtc &&
+      surface->scanout_candidate_flags == flags)
     return;
 
   g_set_object (&surface->scanout_candidate, crtc);
+  surface->scanout_candidate_flags = flags;
   g_object_notify_by_pspec (G_OBJECT (surface),
                             obj_props[PROP_SCANOUT_CANDIDATE]);
 }
 
+void
+meta_wayland_surface_set_overlay_scanout_view (MetaWaylandSurface *surface,
+                                               ClutterStageView   *stage_view)
+{
+  g_set_weak_pointer (&surface->overlay_scanout_view, stage_view);
+}
+
+gboolean
+meta_wayland_surface_is_overlay_scanout_on_view (MetaWaylandSurface *surface,
+                                                 ClutterStageView   *stage_view)
+{
+  return surface->overlay_scanout_view == stage_view;
+}
+
 int
 meta_wayland_surface_get_geometry_scale (MetaWaylandSurface *surface)
 {
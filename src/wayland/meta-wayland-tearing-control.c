@@ -0,0 +1,188 @@
+/*
+ * Wayland Support
+ *
+ * Copyright (C) 2024 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * wp_tearing_control_v1 lets clients, games in particular, hint that
+ * they prefer their content to be presented as soon as possible over
+ * it being presented without tearing. Xwayland uses it for X11 clients
+ * presenting with PresentOptionAsync.
+ *
+ * The hint is double-buffered surface state, and is only honored when
+ * the surface is scanned out directly.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-tearing-control.h"
+
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface-private.h"
+#include "wayland/meta-wayland-versions.h"
+
+#include "tearing-control-v1-server-protocol.h"
+
+static void
+set_pending_allow_tearing (MetaWaylandSurface *surface,
+                           gboolean            allow_tearing)
+{
+  MetaWaylandSurfaceState *pending =
+    meta_wayland_surface_get_pending_state (surface);
+
+  pending->has_new_allow_tearing = TRUE;
+  pending->allow_tearing = allow_tearing;
+}
+
+static void
+wp_tearing_control_destructor (struct wl_resource *resource)
+{
+  MetaWaylandSurface *surface;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    return;
+
+  /* Destroying the object reverts to the default on the next commit */
+  set_pending_allow_tearing (surface, FALSE);
+
+  g_clear_signal_handler (&surface->tearing_control.destroy_handler_id,
+                          surface);
+  surface->tearing_control.resource = NULL;
+}
+
+static void
+on_surface_destroyed (MetaWaylandSurface *surface)
+{
+  wl_resource_set_user_data (surface->tearing_control.resource, NULL);
+}
+
+static void
+wp_tearing_control_set_presentation_hint (struct wl_client   *client,
+                                          struct wl_resource *resource,
+                                          uint32_t            hint)
+{
+  MetaWaylandSurface *surface;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    return;
+
+  switch (hint)
+    {
+    case WP_TEARING_CONTROL_V1_PRESENTATION_HINT_VSYNC:
+      set_pending_allow_tearing (surface, FALSE);
+      break;
+    case WP_TEARING_CONTROL_V1_PRESENTATION_HINT_ASYNC:
+      set_pending_allow_tearing (surface, TRUE);
+      break;
+    default:
+      wl_resource_post_error (resource,
+                              WL_DISPLAY_ERROR_INVALID_METHOD,
+                              "Invalid presentation hint %u", hint);
+      break;
+    }
+}
+
+static void
+wp_tearing_control_destroy (struct wl_client   *client,
+                            struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct wp_tearing_control_v1_interface meta_wayland_tearing_control_interface = {
+  wp_tearing_control_set_presentation_hint,
+  wp_tearing_control_destroy,
+};
+
+static void
+wp_tearing_control_manager_destroy (struct wl_client   *client,
+                                    struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+wp_tearing_control_manager_get_tearing_control (struct wl_client   *client,
+                                                struct wl_resource *resource,
+                                                uint32_t            id,
+                                                struct wl_resource *surface_resource)
+{
+  MetaWaylandSurface *surface;
+  struct wl_resource *tearing_control_resource;
+
+  surface = wl_resource_get_user_data (surface_resource);
+  if (surface->tearing_control.resource)
+    {
+      wl_resource_post_error (resource,
+                              WP_TEARING_CONTROL_MANAGER_V1_ERROR_TEARING_CONTROL_EXISTS,
+                              "tearing control resource already exists on surface");
+      return;
+    }
+
+  tearing_control_resource = wl_resource_create (client,
+                                                 &wp_tearing_control_v1_interface,
+                                                 wl_resource_get_version (resource),
+                                                 id);
+  wl_resource_set_implementation (tearing_control_resource,
+                                  &meta_wayland_tearing_control_interface,
+                                  surface,
+                                  wp_tearing_control_destructor);
+
+  surface->tearing_control.resource = tearing_control_resource;
+  surface->tearing_control.destroy_handler_id =
+    g_signal_connect (surface,
+                      "destroy",
+                      G_CALLBACK (on_surface_destroyed),
+                      NULL);
+}
+
+static const struct wp_tearing_control_manager_v1_interface meta_wayland_tearing_control_manager_interface = {
+  wp_tearing_control_manager_destroy,
+  wp_tearing_control_manager_get_tearing_control,
+};
+
+static void
+wp_tearing_control_bind (struct wl_client *client,
+                         void             *data,
+                         uint32_t          version,
+                         uint32_t          id)
+{
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &wp_tearing_control_manager_v1_interface,
+                                 version,
+                                 id);
+  wl_resource_set_implementation (resource,
+                                  &meta_wayland_tearing_control_manager_interface,
+                                  data,
+                                  NULL);
+}
+
+void
+meta_wayland_init_tearing_control (MetaWaylandCompositor *compositor)
+{
+  if (wl_global_create (compositor->wayland_display,
+                        &wp_tearing_control_manager_v1_interface,
+                        META_WP_TEARING_CONTROL_V1_VERSION,
+                        compositor,
+                        wp_tearing_control_bind) == NULL)
+    g_error ("Failed to register a global wp_tearing_control object");
+}
@@ -27,6 +27,7 @@
 #include "wayland/meta-wayland-buffer.h"
 #include "wayland/meta-wayland-dma-buf.h"
 #include "wayland/meta-wayland-linux-drm-syncobj.h"
+#include "wayland/meta-wayland-private.h"
 
 #define META_WAYLAND_TRANSACTION_NONE ((void *)(uintptr_t) G_MAXSIZE)
 
@@ -164,20 +165,110 @@ ensure_next_candidate (MetaWaylandTransaction  *transaction,
   *candidate = transaction;
 }
 
+static int
+get_surface_depth (MetaWaylandSurface *surface)
+{
+  int depth = 0;
+
+  while ((surface = surface->applied_state.parent))
+    depth++;
+
+  return depth;
+}
+
+static int
+compare_actor_surface_depth (gconstpointer a,
+                             gconstpointer b)
+{
+  MetaWaylandSurfaceRole *surface_role1 = *(MetaWaylandSurfaceRole **) a;
+  MetaWaylandSurfaceRole *surface_role2 = *(MetaWaylandSurfaceRole **) b;
+  MetaWaylandSurface *surface1 =
+    meta_wayland_surface_role_get_surface (surface_role1);
+  MetaWaylandSurface *surface2 =
+    meta_wayland_surface_role_get_surface (surface_role2);
+
+  return get_surface_depth (surface1) - get_surface_depth (surface2);
+}
+
+gboolean
+meta_wayland_transaction_defer_actor_sync (MetaWaylandCompositor   *compositor,
+                                           MetaWaylandActorSurface *actor_surface)
+{
+  if (!compositor->deferred_actor_syncs)
+    return FALSE;
+
+  if (compositor->is_flushing_actor_syncs)
+    {
+      g_hash_table_remove (compositor->deferred_actor_syncs, actor_surface);
+      return FALSE;
+    }
+
+  g_hash_table_add (compositor->deferred_actor_syncs,
+                    g_object_ref (actor_surface));
+  return TRUE;
+}
+
+static void
+flush_deferred_actor_syncs (MetaWaylandCompositor *compositor)
+{
+  g_autoptr (GPtrArray) actor_surfaces = NULL;
+  GHashTableIter iter;
+  gpointer key;
+  unsigned int i;
+
+  actor_surfaces = g_ptr_array_new_with_free_func (g_object_unref);
+  g_hash_table_iter_init (&iter, compositor->deferred_actor_syncs);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    g_ptr_array_add (actor_surfaces, g_object_ref (key));
+
+  /*
+   * Synchronizing an actor surface also synchronizes its sub-surfaces, so
+   * going from ancestors to descendants, the deferred descendants of a
+   * synchronized surface are taken care of by it and are skipped.
+   */
+  g_ptr_array_sort (actor_surfaces, compare_actor_surface_depth);
+
+  compositor->is_flushing_actor_syncs = TRUE;
+
+  for (i = 0; i < actor_surfaces->len; i++)
+    {
+      MetaWaylandActorSurface *actor_surface =
+        g_ptr_array_index (actor_surfaces, i);
+
+      if (!g_hash_table_contains (compositor->deferred_actor_syncs,
+                                  actor_surface))
+        continue;
+
+      meta_wayland_actor_surface_sync_actor_state (actor_surface);
+    }
+
+  compositor->is_flushing_actor_syncs = FALSE;
+  g_clear_pointer (&compositor->deferred_actor_syncs, g_hash_table_unref);
+}
+
 static void
 meta_wayland_transaction_apply (MetaWaylandTransaction  *transaction,
                                 MetaWaylandTransaction **first_candidate)
 {
   g_autofree MetaWaylandSurface **surfaces = NULL;
   g_autofree MetaWaylandSurfaceState **states = NULL;
+  MetaWaylandCompositor *compositor = transaction->compositor;
   unsigned int num_surfaces;
   MetaWaylandSurface *surface;
   MetaWaylandTransactionEntry *entry;
+  gboolean defers_actor_syncs = FALSE;
   int i;
 
   if (g_hash_table_size (transaction->entries) == 0)
     goto free;
 
+  if (!compositor->deferred_actor_syncs)
+    {
+      compositor->deferred_actor_syncs =
+        g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+      defers_actor_syncs = TRUE;
+    }
+
   surfaces = (MetaWaylandSurface **)
     g_hash_table_get_keys_as_array (transaction->entries, &num_surfaces);
   states = g_new (MetaWaylandSurfaceState *, num_surfaces);
@@ -231,6 +322,9 @@ meta_wayland_transaction_apply (MetaWaylandTransaction  *transaction,
         meta_wayland_transaction_sync_child_states (surfaces[i]);
     }
 
+  if (defers_actor_syncs)
+    flush_deferred_actor_syncs (compositor);
+
 free:
   meta_wayland_transaction_free (transaction);
 }
@@ -643,6 +737,49 @@ meta_wayland_transaction_free (MetaWaylandTransaction *transaction)
   g_free (transaction);
 }
 
+/*
+ * Applies the committed transactions whose buffers became ready since the
+ * main loop last polled them, so that they make it into the frame which
+ * is about to be composed instead of the next one.
+ */
+void
+meta_wayland_transaction_latch_ready (MetaWaylandCompositor *compositor)
+{
+  g_autoptr (GPtrArray) sources = NULL;
+  GQueue *transactions;
+  GList *l;
+  unsigned int i;
+
+  transactions = meta_wayland_compositor_get_committed_transactions (compositor);
+
+  for (l = transactions->head; l; l = l->next)
+    {
+      MetaWaylandTransaction *transaction = l->data;
+      GHashTableIter iter;
+      GSource *source;
+
+      if (!transaction->buf_sources)
+        continue;
+
+      g_hash_table_iter_init (&iter, transaction->buf_sources);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &source))
+        {
+          if (!sources)
+            sources = g_ptr_array_new_with_free_func ((GDestroyNotify) g_source_unref);
+
+          g_ptr_array_add (sources, g_source_ref (source));
+        }
+    }
+
+  if (!sources)
+    return;
+
+  /* Dispatching a source may apply and free any of the transactions, which
+   * destroys their remaining sources; those are skipped */
+  for (i = 0; i < sources->len; i++)
+    meta_wayland_dma_buf_source_try_dispatch (g_ptr_array_index (sources, i));
+}
+
 void
 meta_wayland_transaction_finalize (MetaWaylandCompositor *compositor)
 {
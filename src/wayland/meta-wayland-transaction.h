@@ -49,6 +49,11 @@ MetaWaylandTransaction *meta_wayland_transaction_new (MetaWaylandCompositor *com
 
 void meta_wayland_transaction_free (MetaWaylandTransaction *transaction);
 
+void meta_wayland_transaction_latch_ready (MetaWaylandCompositor *compositor);
+
+gboolean meta_wayland_transaction_defer_actor_sync (MetaWaylandCompositor   *compositor,
+                                                    MetaWaylandActorSurface *actor_surface);
+
 void meta_wayland_transaction_finalize (MetaWaylandCompositor *compositor);
 
 void meta_wayland_transaction_init (MetaWaylandCompositor *compositor);
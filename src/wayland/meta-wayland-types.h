@@ -60,6 +60,8 @@ typedef struct _MetaWaylandActivation MetaWaylandActivation;
 
 typedef struct _MetaWaylandDmaBufManager MetaWaylandDmaBufManager;
 
+typedef struct _MetaWaylandClientStatsManager MetaWaylandClientStatsManager;
+
 typedef struct _MetaWaylandSyncobjTimeline MetaWaylandSyncobjTimeline;
 
 typedef struct _MetaWaylandXdgPositioner MetaWaylandXdgPositioner;
@@ -77,3 +79,9 @@ typedef struct _MetaWaylandDrmLeaseManager MetaWaylandDrmLeaseManager;
 typedef struct _MetaWaylandXdgSessionManager MetaWaylandXdgSessionManager;
 
 typedef struct _MetaWaylandToplevelDrag MetaWaylandToplevelDrag;
+
+typedef enum _MetaWaylandBufferScanoutFlags
+{
+  META_WAYLAND_BUFFER_SCANOUT_FLAG_NONE = 0,
+  META_WAYLAND_BUFFER_SCANOUT_FLAG_OVERLAY = 1 << 0,
+} MetaWaylandBufferScanoutFlags;
@@ -63,3 +63,4 @@
 #define META_XDG_SESSION_MANAGER_V1_VERSION 1
 #define META_WP_SYSTEM_BELL_V1_VERSION 1
 #define META_XDG_TOPLEVEL_DRAG_VERSION 1
+#define META_WP_TEARING_CONTROL_V1_VERSION 1
@@ -60,6 +60,11 @@ struct _MetaWaylandXdgSessionState
   MetaSessionState parent;
 
   GHashTable *toplevels;
+
+  /* Toplevels of the saved session, parsed only once a window
+   * is saved or restored under that name */
+  GvdbTable *saved_toplevels;
+  GHashTable *discarded_toplevels;
 };
 
 G_DEFINE_TYPE (MetaWaylandXdgSessionState,
@@ -162,9 +167,107 @@ meta_wayland_xdg_session_state_ensure_toplevel (MetaWaylandXdgSessionState *sess
                            g_strdup (name), toplevel_state);
     }
 
+  /* Replaces whatever was saved previously */
+  g_hash_table_add (session_state->discarded_toplevels, g_strdup (name));
+
   return toplevel_state;
 }
 
+static void
+parse_toplevel (MetaWaylandXdgToplevelState *toplevel_state,
+                GvdbTable                   *toplevel)
+{
+  g_autoptr (GVariant) state = NULL, floating_rect = NULL, tiled_rect = NULL;
+  g_autoptr (GVariant) is_minimized = NULL, workspace = NULL;
+
+  state = gvdb_table_get_value (toplevel, "state");
+  if (state && g_variant_is_of_type (state, G_VARIANT_TYPE ("u")))
+    toplevel_state->window_state = g_variant_get_uint32 (state);
+
+  floating_rect = gvdb_table_get_value (toplevel, "floating-rect");
+  if (floating_rect && g_variant_is_of_type (floating_rect, G_VARIANT_TYPE ("(iiii)")))
+    {
+      variant_to_rect (floating_rect, &toplevel_state->floating.rect);
+    }
+
+  tiled_rect = gvdb_table_get_value (toplevel, "tiled-rect");
+  if (tiled_rect && g_variant_is_of_type (tiled_rect, G_VARIANT_TYPE ("(iiii)")))
+    {
+      variant_to_rect (tiled_rect, &toplevel_state->tiled.rect);
+    }
+
+  is_minimized = gvdb_table_get_value (toplevel, "is-minimized");
+  if (is_minimized && g_variant_is_of_type (is_minimized, G_VARIANT_TYPE ("b")))
+    toplevel_state->is_minimized = g_variant_get_boolean (is_minimized);
+
+  workspace = gvdb_table_get_value (toplevel, "workspace");
+  if (workspace && g_variant_is_of_type (workspace, G_VARIANT_TYPE ("i")))
+    toplevel_state->workspace_idx = g_variant_get_int32 (workspace);
+}
+
+static MetaWaylandXdgToplevelState *
+meta_wayland_xdg_session_state_lookup_toplevel (MetaWaylandXdgSessionState *session_state,
+                                                const char                 *name)
+{
+  MetaWaylandXdgToplevelState *toplevel_state;
+  GvdbTable *toplevel;
+
+  toplevel_state = g_hash_table_lookup (session_state->toplevels, name);
+  if (toplevel_state)
+    return toplevel_state;
+
+  if (!session_state->saved_toplevels ||
+      g_hash_table_contains (session_state->discarded_toplevels, name))
+    return NULL;
+
+  toplevel = gvdb_table_get_table (session_state->saved_toplevels, name);
+  if (!toplevel)
+    return NULL;
+
+  meta_topic (META_DEBUG_SESSION_MANAGEMENT,
+              "Parsing toplevel state %s", name);
+
+  toplevel_state =
+    meta_wayland_xdg_session_state_ensure_toplevel (session_state, name);
+  parse_toplevel (toplevel_state, toplevel);
+  gvdb_table_free (toplevel);
+
+  return toplevel_state;
+}
+
+static void
+copy_saved_toplevel (GvdbTable  *saved_toplevels,
+                     const char *name,
+                     GHashTable *toplevels)
+{
+  GvdbTable *saved_toplevel;
+  GHashTable *toplevel;
+  g_auto (GStrv) names = NULL;
+  size_t i;
+
+  saved_toplevel = gvdb_table_get_table (saved_toplevels, name);
+  if (!saved_toplevel)
+    return;
+
+  toplevel = gvdb_hash_table_new (toplevels, name);
+  names = gvdb_table_get_names (saved_toplevel, NULL);
+
+  for (i = 0; names[i]; i++)
+    {
+      g_autoptr (GVariant) value = NULL;
+      GvdbItem *item;
+
+      value = gvdb_table_get_value (saved_toplevel, names[i]);
+      if (!value)
+        continue;
+
+      item = gvdb_hash_table_insert (toplevel, names[i]);
+      gvdb_item_set_value (item, value);
+    }
+
+  gvdb_table_free (saved_toplevel);
+}
+
 static void
 meta_wayland_xdg_session_state_dispose (GObject *object)
 {
@@ -172,6 +275,8 @@ meta_wayland_xdg_session_state_dispose (GObject *object)
     META_WAYLAND_XDG_SESSION_STATE (object);
 
   g_clear_pointer (&session_state->toplevels, g_hash_table_unref);
+  g_clear_pointer (&session_state->discarded_toplevels, g_hash_table_unref);
+  g_clear_pointer (&session_state->saved_toplevels, gvdb_table_free);
 
   G_OBJECT_CLASS (meta_wayland_xdg_session_state_parent_class)->dispose (object);
 }
@@ -234,6 +339,24 @@ meta_wayland_xdg_session_state_serialize (MetaSessionState *session_state,
                            g_variant_new_int32 (toplevel_state->workspace_idx));
     }
 
+  /* Carry over what was saved for windows that have not come back yet */
+  if (xdg_session_state->saved_toplevels)
+    {
+      g_auto (GStrv) names = NULL;
+      size_t i;
+
+      names = gvdb_table_get_names (xdg_session_state->saved_toplevels, NULL);
+      for (i = 0; names[i]; i++)
+        {
+          if (g_hash_table_contains (xdg_session_state->discarded_toplevels,
+                                     names[i]))
+            continue;
+
+          copy_saved_toplevel (xdg_session_state->saved_toplevels,
+                               names[i], toplevels);
+        }
+    }
+
   return TRUE;
 }
 
@@ -245,12 +368,10 @@ meta_wayland_xdg_session_state_parse (MetaSessionState  *session_state,
   MetaWaylandXdgSessionState *xdg_session_state =
     META_WAYLAND_XDG_SESSION_STATE (session_state);
   g_autoptr (GVariant) version = NULL;
-  GvdbTable *toplevels, *toplevel;
-  GStrv toplevel_names = NULL;
-  int i;
 
   version = gvdb_table_get_value (data, "version");
-  if (!g_variant_is_of_type (version, G_VARIANT_TYPE ("i")) ||
+  if (!version ||
+      !g_variant_is_of_type (version, G_VARIANT_TYPE ("i")) ||
       g_variant_get_int32 (version) > STATE_FORMAT_VERSION)
     {
       g_set_error (error,
@@ -260,54 +381,8 @@ meta_wayland_xdg_session_state_parse (MetaSessionState  *session_state,
       return FALSE;
     }
 
-  toplevels = gvdb_table_get_table (data, "toplevels");
-  toplevel_names = gvdb_table_get_names (toplevels, NULL);
-
-  for (i = 0; toplevel_names[i]; i++)
-    {
-      MetaWaylandXdgToplevelState * toplevel_state;
-      g_autoptr (GVariant) state = NULL, floating_rect = NULL, tiled_rect = NULL;
-      g_autoptr (GVariant) is_minimized = NULL, monitor = NULL, workspace = NULL;
-
-      meta_topic (META_DEBUG_SESSION_MANAGEMENT,
-                  "Parsing toplevel state %s", toplevel_names[i]);
-
-      toplevel_state =
-        meta_wayland_xdg_session_state_ensure_toplevel (xdg_session_state,
-                                                        toplevel_names[i]);
-
-      toplevel = gvdb_table_get_table (toplevels, toplevel_names[i]);
-
-      state = gvdb_table_get_value (toplevel, "state");
-
-      if (state && g_variant_is_of_type (state, G_VARIANT_TYPE ("u")))
-        toplevel_state->window_state = g_variant_get_uint32 (state);
-
-      floating_rect = gvdb_table_get_value (toplevel, "floating-rect");
-      if (floating_rect && g_variant_is_of_type (floating_rect, G_VARIANT_TYPE ("(iiii)")))
-        {
-          variant_to_rect (floating_rect, &toplevel_state->floating.rect);
-        }
-
-      tiled_rect = gvdb_table_get_value (toplevel, "tiled-rect");
-      if (tiled_rect && g_variant_is_of_type (tiled_rect, G_VARIANT_TYPE ("(iiii)")))
-        {
-          variant_to_rect (floating_rect, &toplevel_state->tiled.rect);
-        }
-
-      is_minimized = gvdb_table_get_value (toplevel, "is-minimized");
-      if (state && g_variant_is_of_type (state, G_VARIANT_TYPE ("b")))
-        toplevel_state->is_minimized = g_variant_get_boolean (is_minimized);
-
-      workspace = gvdb_table_get_value (toplevel, "workspace");
-      if (workspace && g_variant_is_of_type (workspace, G_VARIANT_TYPE ("i")))
-        toplevel_state->workspace_idx = g_variant_get_int32 (workspace);
-
-      gvdb_table_free (toplevel);
-    }
-
-  g_clear_pointer (&toplevel_names, g_strfreev);
-  gvdb_table_free (toplevels);
+  g_clear_pointer (&xdg_session_state->saved_toplevels, gvdb_table_free);
+  xdg_session_state->saved_toplevels = gvdb_table_get_table (data, "toplevels");
 
   return TRUE;
 }
@@ -379,7 +454,8 @@ meta_wayland_xdg_session_state_restore_window (MetaSessionState *state,
   MetaWaylandXdgToplevelState *toplevel_state;
   MtkRectangle *rect = NULL;
 
-  toplevel_state = g_hash_table_lookup (xdg_session_state->toplevels, name);
+  toplevel_state =
+    meta_wayland_xdg_session_state_lookup_toplevel (xdg_session_state, name);
   if (!toplevel_state)
     return FALSE;
 
@@ -459,6 +535,7 @@ meta_wayland_xdg_session_state_remove_window (MetaSessionState *state,
     META_WAYLAND_XDG_SESSION_STATE (state);
 
   g_hash_table_remove (xdg_session_state->toplevels, name);
+  g_hash_table_add (xdg_session_state->discarded_toplevels, g_strdup (name));
 }
 
 static void
@@ -485,4 +562,6 @@ meta_wayland_xdg_session_state_init (MetaWaylandXdgSessionState *session_state)
     g_hash_table_new_full (g_str_hash, g_str_equal,
                            g_free,
                            (GDestroyNotify) meta_wayland_xdg_toplevel_state_free);
+  session_state->discarded_toplevels =
+    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
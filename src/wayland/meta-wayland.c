@@ -34,11 +34,13 @@
 #endif
 
 #include "clutter/clutter.h"
+#include "clutter/clutter-mutter.h"
 #include "compositor/meta-surface-actor-wayland.h"
 #include "core/events.h"
 #include "core/meta-context-private.h"
 #include "wayland/meta-wayland-activation.h"
 #include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-client-stats.h"
 #include "wayland/meta-wayland-color-management.h"
 #include "wayland/meta-wayland-data-device.h"
 #include "wayland/meta-wayland-dma-buf.h"
@@ -57,6 +59,7 @@
 #include "wayland/meta-wayland-subsurface.h"
 #include "wayland/meta-wayland-system-bell.h"
 #include "wayland/meta-wayland-tablet-manager.h"
+#include "wayland/meta-wayland-tearing-control.h"
 #include "wayland/meta-wayland-transaction.h"
 #include "wayland/meta-wayland-xdg-dialog.h"
 #include "wayland/meta-wayland-xdg-foreign.h"
@@ -86,12 +89,24 @@ static guint signals[N_SIGNALS];
 
 static char *_display_name_override;
 
+/* Rate at which surfaces not visible on any view, e.g. because they are
+ * fully obscured, minimized or off screen, still get their frame callbacks
+ * emitted, so that clients keep going without rendering at full speed. */
+#define DEFAULT_HIDDEN_FRAME_CALLBACK_RATE_HZ 1
+
+/* Longest time flushing clients is held back while dispatching a burst of
+ * input events, e.g. from multi-finger touch or high rate tablet tools. */
+#define MAX_INPUT_BURST_FLUSH_DELAY_US 1000
+
 typedef struct _MetaWaylandCompositorPrivate
 {
   gboolean is_wayland_egl_display_bound;
 
   MetaWaylandFilterManager *filter_manager;
   GHashTable *frame_callback_sources;
+
+  unsigned int hidden_frame_callback_interval_ms;
+  guint hidden_frame_callbacks_timeout_id;
 } MetaWaylandCompositorPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaWaylandCompositor, meta_wayland_compositor,
@@ -101,6 +116,7 @@ typedef struct
 {
   GSource source;
   struct wl_display *display;
+  int64_t last_flush_us;
 } WaylandEventSource;
 
 typedef struct
@@ -124,10 +140,21 @@ wayland_event_source_prepare (GSource *base,
                               int     *timeout)
 {
   WaylandEventSource *source = (WaylandEventSource *)base;
+  int64_t now_us;
 
   *timeout = -1;
 
+  /* As long as input events are still queued, they'll be dispatched before
+   * blocking. Flush once the queue has been drained, so that clients receive
+   * the events of a burst, up to the frame event, in a single write, unless
+   * it takes too long. */
+  now_us = g_get_monotonic_time ();
+  if (clutter_events_pending () &&
+      now_us - source->last_flush_us < MAX_INPUT_BURST_FLUSH_DELAY_US)
+    return FALSE;
+
   wl_display_flush_clients (source->display);
+  source->last_flush_us = now_us;
 
   return FALSE;
 }
@@ -208,6 +235,122 @@ emit_frame_callbacks_for_stage_view (MetaWaylandCompositor *compositor,
     }
 }
 
+static gboolean
+is_surface_actor_primary_on_any_view (MetaSurfaceActor *actor)
+{
+  ClutterActor *stage;
+  GList *l;
+
+  stage = clutter_actor_get_stage (CLUTTER_ACTOR (actor));
+  if (!stage)
+    return FALSE;
+
+  for (l = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage)); l; l = l->next)
+    {
+      ClutterStageView *stage_view = l->data;
+
+      if (meta_surface_actor_wayland_is_view_primary (actor, stage_view))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+emit_hidden_frame_callbacks (gpointer user_data)
+{
+  MetaWaylandCompositor *compositor = user_data;
+  MetaWaylandCompositorPrivate *priv =
+    meta_wayland_compositor_get_instance_private (compositor);
+  GList *l;
+  int64_t now_us;
+
+  if (!compositor->frame_callback_surfaces)
+    {
+      priv->hidden_frame_callbacks_timeout_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  now_us = g_get_monotonic_time ();
+
+  l = compositor->frame_callback_surfaces;
+  while (l)
+    {
+      GList *l_cur = l;
+      MetaWaylandSurface *surface = l->data;
+      MetaSurfaceActor *actor;
+      MetaWaylandActorSurface *actor_surface;
+
+      l = l->next;
+
+      actor = meta_wayland_surface_get_actor (surface);
+      if (!actor)
+        continue;
+
+      /* Surfaces that are at least partially visible somewhere get their
+       * frame callbacks at the refresh rate of their primary view. */
+      if (is_surface_actor_primary_on_any_view (actor))
+        continue;
+
+      actor_surface = META_WAYLAND_ACTOR_SURFACE (surface->role);
+      meta_wayland_actor_surface_emit_frame_callbacks (actor_surface,
+                                                       now_us / 1000);
+
+      compositor->frame_callback_surfaces =
+        g_list_delete_link (compositor->frame_callback_surfaces, l_cur);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+ensure_hidden_frame_callbacks_timeout (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandCompositorPrivate *priv =
+    meta_wayland_compositor_get_instance_private (compositor);
+
+  if (priv->hidden_frame_callbacks_timeout_id)
+    return;
+
+  if (priv->hidden_frame_callback_interval_ms == 0)
+    return;
+
+  priv->hidden_frame_callbacks_timeout_id =
+    g_timeout_add (priv->hidden_frame_callback_interval_ms,
+                   emit_hidden_frame_callbacks,
+                   compositor);
+  g_source_set_name_by_id (priv->hidden_frame_callbacks_timeout_id,
+                           "[mutter] Wayland frame callbacks for hidden surfaces");
+}
+
+static unsigned int
+get_hidden_frame_callback_interval_ms (void)
+{
+  const char *rate_env;
+  uint64_t rate_hz = DEFAULT_HIDDEN_FRAME_CALLBACK_RATE_HZ;
+
+  rate_env = g_getenv ("MUTTER_DEBUG_HIDDEN_FRAME_CALLBACK_RATE");
+  if (rate_env)
+    {
+      g_autoptr (GError) error = NULL;
+
+      if (!g_ascii_string_to_unsigned (rate_env, 10, 0, 1000,
+                                       &rate_hz, &error))
+        {
+          g_warning ("Invalid MUTTER_DEBUG_HIDDEN_FRAME_CALLBACK_RATE: %s",
+                     error->message);
+          rate_hz = DEFAULT_HIDDEN_FRAME_CALLBACK_RATE_HZ;
+        }
+    }
+
+  /* A rate of 0 means hidden surfaces don't get any frame callbacks until
+   * they become visible again. */
+  if (rate_hz == 0)
+    return 0;
+
+  return (unsigned int) (1000 / rate_hz);
+}
+
 #ifdef HAVE_NATIVE_BACKEND
 
 static gboolean
@@ -357,6 +500,15 @@ ensure_source_for_stage_view (MetaWaylandCompositor *compositor,
 }
 #endif /* HAVE_NATIVE_BACKEND */
 
+static void
+on_before_update (ClutterStage          *stage,
+                  ClutterStageView      *stage_view,
+                  ClutterFrame          *frame,
+                  MetaWaylandCompositor *compositor)
+{
+  meta_wayland_transaction_latch_ready (compositor);
+}
+
 static void
 on_after_update (ClutterStage          *stage,
                  ClutterStageView      *stage_view,
@@ -576,6 +728,8 @@ meta_wayland_compositor_add_frame_callback_surface (MetaWaylandCompositor *compo
 
   compositor->frame_callback_surfaces =
     g_list_prepend (compositor->frame_callback_surfaces, surface);
+
+  ensure_hidden_frame_callbacks_timeout (compositor);
 }
 
 void
@@ -696,9 +850,11 @@ meta_wayland_compositor_finalize (GObject *object)
   meta_wayland_activation_finalize (compositor);
   meta_wayland_outputs_finalize (compositor);
   meta_wayland_presentation_time_finalize (compositor);
+  meta_wayland_client_stats_finalize (compositor);
 
   g_hash_table_destroy (compositor->scheduled_surface_associations);
 
+  g_signal_handlers_disconnect_by_func (stage, on_before_update, compositor);
   g_signal_handlers_disconnect_by_func (stage, on_after_update, compositor);
   g_signal_handlers_disconnect_by_func (stage, on_presented, compositor);
 
@@ -711,6 +867,7 @@ meta_wayland_compositor_finalize (GObject *object)
 
   g_clear_pointer (&priv->filter_manager, meta_wayland_filter_manager_free);
   g_clear_pointer (&priv->frame_callback_sources, g_hash_table_destroy);
+  g_clear_handle_id (&priv->hidden_frame_callbacks_timeout_id, g_source_remove);
 
   g_clear_pointer (&compositor->display_name, g_free);
   g_clear_pointer (&compositor->wayland_display, wl_display_destroy);
@@ -741,6 +898,8 @@ meta_wayland_compositor_init (MetaWaylandCompositor *compositor)
   priv->frame_callback_sources =
     g_hash_table_new_full (NULL, NULL, NULL,
                            (GDestroyNotify) g_source_destroy);
+  priv->hidden_frame_callback_interval_ms =
+    get_hidden_frame_callback_interval_ms ();
 }
 
 static void
@@ -854,6 +1013,8 @@ meta_wayland_compositor_new (MetaContext *context)
   compositor->source = wayland_event_source;
   g_source_unref (wayland_event_source);
 
+  g_signal_connect (stage, "before-update",
+                    G_CALLBACK (on_before_update), compositor);
   g_signal_connect (stage, "after-update",
                     G_CALLBACK (on_after_update), compositor);
   g_signal_connect (stage, "presented",
@@ -897,6 +1058,8 @@ meta_wayland_compositor_new (MetaContext *context)
   meta_wayland_init_color_management (compositor);
   meta_wayland_xdg_session_management_init (compositor);
   meta_wayland_init_system_bell (compositor);
+  meta_wayland_init_tearing_control (compositor);
+  meta_wayland_init_client_stats (compositor);
 
 #ifdef HAVE_NATIVE_BACKEND
   meta_wayland_drm_lease_manager_init (compositor);
@@ -25,6 +25,7 @@
 #include "wayland/meta-window-wayland.h"
 
 #include <errno.h>
+#include <math.h>
 #include <string.h>
 
 #include "backends/meta-backend-private.h"
@@ -54,6 +55,28 @@ enum
 
 static GParamSpec *obj_props[PROP_LAST];
 
+/* Never extrapolate the pointer motion further than this into the future */
+#define MAX_RESIZE_PREDICTION_US (50 * G_TIME_SPAN_MILLISECOND)
+
+typedef struct _MetaWindowWaylandResizePacing
+{
+  /* The latest size requested by the interactive resize, but not yet sent,
+   * since the client has not caught up with the previous configure. */
+  gboolean has_deferred_resize;
+  MtkRectangle deferred_rect;
+  MetaGravity deferred_gravity;
+  MetaMoveResizeFlags deferred_flags;
+
+  uint32_t sent_serial;
+  int64_t sent_time_us;
+  int64_t latency_us;
+
+  MtkRectangle last_requested_rect;
+  int64_t last_requested_time_us;
+  float width_velocity;
+  float height_velocity;
+} MetaWindowWaylandResizePacing;
+
 struct _MetaWindowWayland
 {
   MetaWindow parent;
@@ -74,6 +97,8 @@ struct _MetaWindowWayland
 
   MetaWaylandWindowConfiguration *last_acked_configuration;
 
+  MetaWindowWaylandResizePacing resize_pacing;
+
   gboolean has_been_shown;
 
   gboolean is_suspended;
@@ -230,12 +255,191 @@ surface_state_changed (MetaWindow *window)
   meta_window_wayland_configure (wl_window, configuration);
 }
 
+static gboolean
+is_window_being_resized_interactively (MetaWindow *window)
+{
+  MetaWindowDrag *window_drag;
+
+  window_drag =
+    meta_compositor_get_current_window_drag (window->display->compositor);
+
+  return (window_drag &&
+          meta_grab_op_is_resizing (meta_window_drag_get_grab_op (window_drag)) &&
+          meta_window_drag_get_window (window_drag) == window);
+}
+
+static gboolean
+has_pending_resize_configuration (MetaWindowWayland *wl_window)
+{
+  GList *l;
+
+  for (l = wl_window->pending_configurations; l; l = l->next)
+    {
+      MetaWaylandWindowConfiguration *configuration = l->data;
+
+      if (configuration->is_resizing)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+update_resize_velocity (MetaWindowWayland *wl_window,
+                        MtkRectangle       rect)
+{
+  MetaWindowWaylandResizePacing *pacing = &wl_window->resize_pacing;
+  int64_t now_us = g_get_monotonic_time ();
+  int64_t dt_us;
+
+  dt_us = now_us - pacing->last_requested_time_us;
+  if (pacing->last_requested_time_us && dt_us > 0)
+    {
+      float width_velocity, height_velocity;
+
+      width_velocity =
+        (rect.width - pacing->last_requested_rect.width) / (float) dt_us;
+      height_velocity =
+        (rect.height - pacing->last_requested_rect.height) / (float) dt_us;
+
+      pacing->width_velocity =
+        (pacing->width_velocity + width_velocity) / 2.0f;
+      pacing->height_velocity =
+        (pacing->height_velocity + height_velocity) / 2.0f;
+    }
+
+  pacing->last_requested_rect = rect;
+  pacing->last_requested_time_us = now_us;
+}
+
+static MtkRectangle
+predict_resize_rect (MetaWindowWayland *wl_window,
+                     MtkRectangle       rect,
+                     MetaGravity        gravity)
+{
+  MetaWindow *window = META_WINDOW (wl_window);
+  MetaWindowWaylandResizePacing *pacing = &wl_window->resize_pacing;
+  MtkRectangle predicted_rect = rect;
+  int64_t ahead_us;
+  int width, height;
+
+  /* By the time the client has drawn the configured size, the pointer will
+   * have moved on, so ask for the size it is expected to be at by then. */
+  ahead_us = MIN (pacing->latency_us, MAX_RESIZE_PREDICTION_US);
+  if (ahead_us <= 0)
+    return rect;
+
+  width = rect.width + (int) roundf (pacing->width_velocity * ahead_us);
+  height = rect.height + (int) roundf (pacing->height_velocity * ahead_us);
+
+  width = CLAMP (width,
+                 MAX (window->size_hints.min_width, 1),
+                 MAX (window->size_hints.max_width, 1));
+  height = CLAMP (height,
+                  MAX (window->size_hints.min_height, 1),
+                  MAX (window->size_hints.max_height, 1));
+
+  meta_rectangle_resize_with_gravity (&rect, &predicted_rect, gravity,
+                                      width, height);
+
+  return predicted_rect;
+}
+
+static void
+send_resize_configuration (MetaWindowWayland   *wl_window,
+                           MtkRectangle         rect,
+                           int                  geometry_scale,
+                           MetaMoveResizeFlags  flags,
+                           MetaGravity          gravity)
+{
+  MetaWindow *window = META_WINDOW (wl_window);
+  MetaWindowWaylandResizePacing *pacing = &wl_window->resize_pacing;
+  MetaWaylandWindowConfiguration *configuration;
+  int bounds_width;
+  int bounds_height;
+
+  if (!meta_window_calculate_bounds (window,
+                                     &bounds_width,
+                                     &bounds_height))
+    {
+      bounds_width = 0;
+      bounds_height = 0;
+    }
+
+  configuration =
+    meta_wayland_window_configuration_new (window,
+                                           rect,
+                                           bounds_width, bounds_height,
+                                           geometry_scale,
+                                           flags,
+                                           gravity);
+  meta_window_wayland_configure (wl_window, configuration);
+
+  pacing->sent_serial = configuration->serial;
+  pacing->sent_time_us = g_get_monotonic_time ();
+}
+
+static void
+maybe_send_deferred_resize (MetaWindowWayland *wl_window)
+{
+  MetaWindow *window = META_WINDOW (wl_window);
+  MetaWindowWaylandResizePacing *pacing = &wl_window->resize_pacing;
+  MtkRectangle rect;
+  int geometry_scale;
+
+  if (!pacing->has_deferred_resize)
+    return;
+
+  if (has_pending_resize_configuration (wl_window))
+    return;
+
+  pacing->has_deferred_resize = FALSE;
+
+  geometry_scale = meta_window_wayland_get_geometry_scale (window);
+  rect = predict_resize_rect (wl_window,
+                              pacing->deferred_rect,
+                              pacing->deferred_gravity);
+
+  send_resize_configuration (wl_window, rect, geometry_scale,
+                             pacing->deferred_flags,
+                             pacing->deferred_gravity);
+
+  wl_window->last_sent_rect = rect;
+  wl_window->last_sent_geometry_scale = geometry_scale;
+  wl_window->last_sent_gravity = pacing->deferred_gravity;
+}
+
+static void
+track_acked_resize_configuration (MetaWindowWayland              *wl_window,
+                                  MetaWaylandWindowConfiguration *configuration)
+{
+  MetaWindowWaylandResizePacing *pacing = &wl_window->resize_pacing;
+  int64_t latency_us;
+
+  if (!configuration || !pacing->sent_time_us ||
+      configuration->serial != pacing->sent_serial)
+    return;
+
+  latency_us = g_get_monotonic_time () - pacing->sent_time_us;
+  if (pacing->latency_us)
+    pacing->latency_us = (pacing->latency_us * 3 + latency_us) / 4;
+  else
+    pacing->latency_us = latency_us;
+
+  pacing->sent_time_us = 0;
+}
+
 static void
 meta_window_wayland_grab_op_began (MetaWindow *window,
                                    MetaGrabOp  op)
 {
+  MetaWindowWayland *wl_window = META_WINDOW_WAYLAND (window);
+
   if (meta_grab_op_is_resizing (op))
-    surface_state_changed (window);
+    {
+      wl_window->resize_pacing = (MetaWindowWaylandResizePacing) { 0 };
+      surface_state_changed (window);
+    }
 
   META_WINDOW_CLASS (meta_window_wayland_parent_class)->grab_op_began (window, op);
 }
@@ -244,8 +448,25 @@ static void
 meta_window_wayland_grab_op_ended (MetaWindow *window,
                                    MetaGrabOp  op)
 {
+  MetaWindowWayland *wl_window = META_WINDOW_WAYLAND (window);
+  MetaWindowWaylandResizePacing *pacing = &wl_window->resize_pacing;
+
   if (meta_grab_op_is_resizing (op))
-    surface_state_changed (window);
+    {
+      /* The state change configure carries the final, unpredicted, size */
+      if (pacing->has_deferred_resize)
+        {
+          wl_window->last_sent_rect = pacing->deferred_rect;
+          wl_window->last_sent_gravity = pacing->deferred_gravity;
+          pacing->has_deferred_resize = FALSE;
+        }
+      else if (pacing->last_requested_time_us)
+        {
+          wl_window->last_sent_rect = pacing->last_requested_rect;
+        }
+
+      surface_state_changed (window);
+    }
 
   META_WINDOW_CLASS (meta_window_wayland_parent_class)->grab_op_ended (window, op);
 }
@@ -263,6 +484,7 @@ meta_window_wayland_move_resize_internal (MetaWindow                *window,
 {
   MetaWindowWayland *wl_window = META_WINDOW_WAYLAND (window);
   gboolean can_move_now = FALSE;
+  gboolean is_deferred = FALSE;
   MtkRectangle configured_rect;
   MtkRectangle frame_rect;
   int geometry_scale;
@@ -396,9 +618,7 @@ meta_window_wayland_move_resize_internal (MetaWindow                *window,
                constrained_rect.height != frame_rect.height ||
                flags & META_MOVE_RESIZE_STATE_CHANGED)
         {
-          MetaWaylandWindowConfiguration *configuration;
-          int bounds_width;
-          int bounds_height;
+          MetaWindowWaylandResizePacing *pacing = &wl_window->resize_pacing;
 
           if (!meta_wayland_surface_get_buffer (wl_window->surface) &&
               !meta_window_is_maximized (window) &&
@@ -406,22 +626,38 @@ meta_window_wayland_move_resize_internal (MetaWindow                *window,
               !meta_window_is_fullscreen (window))
             return;
 
-          if (!meta_window_calculate_bounds (window,
-                                             &bounds_width,
-                                             &bounds_height))
+          if (is_window_being_resized_interactively (window) &&
+              !(flags & META_MOVE_RESIZE_STATE_CHANGED))
             {
-              bounds_width = 0;
-              bounds_height = 0;
+              update_resize_velocity (wl_window, configured_rect);
+
+              /* Keep at most one resizing configure in flight; while the
+               * client is still busy with the previous one, only remember
+               * the latest size, sent once the client caught up. */
+              if (has_pending_resize_configuration (wl_window))
+                {
+                  pacing->has_deferred_resize = TRUE;
+                  pacing->deferred_rect = configured_rect;
+                  pacing->deferred_gravity = gravity;
+                  pacing->deferred_flags = flags;
+                  is_deferred = TRUE;
+                }
+              else
+                {
+                  configured_rect = predict_resize_rect (wl_window,
+                                                         configured_rect,
+                                                         gravity);
+                  send_resize_configuration (wl_window, configured_rect,
+                                             geometry_scale, flags, gravity);
+                }
+            }
+          else
+            {
+              pacing->has_deferred_resize = FALSE;
+              send_resize_configuration (wl_window, configured_rect,
+                                         geometry_scale, flags, gravity);
             }
 
-          configuration =
-            meta_wayland_window_configuration_new (window,
-                                                   configured_rect,
-                                                   bounds_width, bounds_height,
-                                                   geometry_scale,
-                                                   flags,
-                                                   gravity);
-          meta_window_wayland_configure (wl_window, configuration);
           can_move_now = FALSE;
         }
       else
@@ -430,10 +666,13 @@ meta_window_wayland_move_resize_internal (MetaWindow                *window,
         }
     }
 
-  wl_window->has_last_sent_configuration = TRUE;
-  wl_window->last_sent_rect = configured_rect;
-  wl_window->last_sent_geometry_scale = geometry_scale;
-  wl_window->last_sent_gravity = gravity;
+  if (!is_deferred)
+    {
+      wl_window->has_last_sent_configuration = TRUE;
+      wl_window->last_sent_rect = configured_rect;
+      wl_window->last_sent_geometry_scale = geometry_scale;
+      wl_window->last_sent_gravity = gravity;
+    }
 
   if (can_move_now)
     {
@@ -1235,6 +1474,7 @@ meta_window_wayland_finish_move_resize (MetaWindow              *window,
 
   acked_configuration = acquire_acked_configuration (wl_window, pending,
                                                      &is_client_resize);
+  track_acked_resize_configuration (wl_window, acked_configuration);
 
   window_drag = meta_compositor_get_current_window_drag (display->compositor);
 
@@ -1335,6 +1575,9 @@ meta_window_wayland_finish_move_resize (MetaWindow              *window,
                                     META_PLACE_FLAG_NONE,
                                     gravity,
                                     rect);
+
+  if (is_window_being_resized)
+    maybe_send_deferred_resize (wl_window);
 }
 
 void
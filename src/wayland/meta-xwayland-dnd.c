@@ -1226,14 +1226,13 @@ meta_xwayland_init_dnd (MetaX11Display *x11_display)
     meta_context_get_wayland_compositor (context);
   MetaXWaylandManager *manager = &compositor->xwayland_manager;
   MetaXWaylandDnd *dnd = manager->dnd;
-  guint32 i;
 
   g_assert (manager->dnd == NULL);
 
   manager->dnd = dnd = g_new0 (MetaXWaylandDnd, 1);
 
-  for (i = 0; i < N_DND_ATOMS; i++)
-    xdnd_atoms[i] = XInternAtom (xdisplay, atom_names[i], False);
+  XInternAtoms (xdisplay, (char **) atom_names, N_DND_ATOMS, False,
+                xdnd_atoms);
 
   create_dnd_windows (dnd, x11_display);
   dnd->manager = manager;
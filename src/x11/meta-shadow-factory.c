@@ -23,6 +23,7 @@
 
 #include "x11/meta-shadow-factory.h"
 
+#include "clutter/clutter-mutter.h"
 #include "compositor/cogl-utils.h"
 #include "meta/util.h"
 
@@ -44,6 +45,10 @@
  *   in blocks, blur rows again, and then transpose back.
  *
  * - We approximate the 1D gaussian blur as 3 successive box filters.
+ *
+ * - The shape is normally blurred on the GPU with the passes of
+ *   ClutterBlur, rendering the shape into an offscreen texture; the box
+ *   filters on the CPU are only used when that fails.
  */
 
 typedef struct _MetaShadowCacheKey  MetaShadowCacheKey;
@@ -817,10 +822,194 @@ make_border_region (MtkRegion *region,
   return g_steal_pointer (&border_region);
 }
 
+static CoglFramebuffer *
+create_shadow_framebuffer (CoglContext  *cogl_context,
+                           int           width,
+                           int           height,
+                           CoglTexture **texture_out,
+                           GError      **error)
+{
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  CoglFramebuffer *framebuffer;
+  CoglColor transparent;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  if (!cogl_texture_allocate (texture, error))
+    return NULL;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  framebuffer = COGL_FRAMEBUFFER (offscreen);
+  if (!cogl_framebuffer_allocate (framebuffer, error))
+    return NULL;
+
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0, width, height, -1.0, 1.0);
+
+  cogl_color_init_from_4f (&transparent, 0.0, 0.0, 0.0, 0.0);
+  cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &transparent);
+
+  *texture_out = g_steal_pointer (&texture);
+
+  return COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+}
+
+/* Multiplies the rows of the band above the shape by their distance to
+ * the top of the shadow divided by top_fade, like fade_bytes() does */
 static void
-make_shadow (MetaShadow  *shadow,
-             CoglContext *cogl_context,
-             MtkRegion   *region)
+fade_shadow_top (MetaShadow      *shadow,
+                 CoglContext     *cogl_context,
+                 CoglFramebuffer *framebuffer,
+                 int              width,
+                 int              fade_height)
+{
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  g_autoptr (CoglPrimitive) primitive = NULL;
+  uint8_t bottom_alpha = (uint8_t) (fade_height * 255 / shadow->key.top_fade);
+  CoglVertexP2C4 vertices[] = {
+    { 0, 0, 0, 0, 0, 0 },
+    { width, 0, 0, 0, 0, 0 },
+    { 0, fade_height, 0, 0, 0, bottom_alpha },
+    { width, fade_height, 0, 0, 0, bottom_alpha },
+  };
+
+  pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_static_name (pipeline, "MetaShadowFactory (fade)");
+  cogl_pipeline_set_blend (pipeline,
+                           "RGBA = ADD (0, DST_COLOR * SRC_COLOR[A])",
+                           NULL);
+
+  primitive = cogl_primitive_new_p2c4 (cogl_context,
+                                       COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                       G_N_ELEMENTS (vertices),
+                                       vertices);
+  cogl_primitive_draw (primitive, framebuffer, pipeline);
+}
+
+/* Blurs the region with the GPU blur passes of ClutterBlur. The shape is
+ * drawn as opaque black, so the blurred texture can be painted in place
+ * of the alpha-only texture of the CPU path */
+static gboolean
+make_shadow_gpu (MetaShadow  *shadow,
+                 CoglContext *cogl_context,
+                 MtkRegion   *region)
+{
+  g_autoptr (GError) error = NULL;
+  int spread = get_shadow_spread (shadow->key.radius);
+  MtkRectangle extents;
+  g_autoptr (CoglTexture) mask_texture = NULL;
+  g_autoptr (CoglFramebuffer) mask_framebuffer = NULL;
+  g_autoptr (CoglTexture) shadow_texture = NULL;
+  g_autoptr (CoglFramebuffer) shadow_framebuffer = NULL;
+  g_autoptr (CoglPipeline) mask_pipeline = NULL;
+  g_autoptr (CoglPipeline) copy_pipeline = NULL;
+  g_autofree float *coordinates = NULL;
+  ClutterBlur *blur;
+  int mask_width, mask_height;
+  int shadow_width, shadow_height;
+  float src_x, src_y;
+  int n_rectangles, k;
+
+  extents = mtk_region_get_extents (region);
+
+  /* As with the CPU blur, the blur into the area above the window
+   * contributes back to the top pixels, so the whole area is blurred
+   * and only cropped when copying to the shadow texture */
+  mask_width = extents.width + 2 * spread;
+  mask_height = extents.height + 2 * spread;
+
+  mask_framebuffer = create_shadow_framebuffer (cogl_context,
+                                                mask_width, mask_height,
+                                                &mask_texture,
+                                                &error);
+  if (!mask_framebuffer)
+    {
+      g_debug ("Failed to allocate shadow mask: %s", error->message);
+      return FALSE;
+    }
+
+  mask_pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_static_name (mask_pipeline, "MetaShadowFactory (mask)");
+  cogl_pipeline_set_color4f (mask_pipeline, 0.0f, 0.0f, 0.0f, 1.0f);
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  coordinates = g_new (float, 4 * n_rectangles);
+  for (k = 0; k < n_rectangles; k++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (region, k);
+      coordinates[4 * k] = (float) (spread + rect.x);
+      coordinates[4 * k + 1] = (float) (spread + rect.y);
+      coordinates[4 * k + 2] = (float) (spread + rect.x + rect.width);
+      coordinates[4 * k + 3] = (float) (spread + rect.y + rect.height);
+    }
+  cogl_framebuffer_draw_rectangles (mask_framebuffer, mask_pipeline,
+                                    coordinates, n_rectangles);
+
+  /* The box filters approximate a gaussian with a standard deviation of
+   * the radius, while ClutterBlur uses half the radius it is given */
+  blur = clutter_blur_new (mask_texture, 2.0f * shadow->key.radius);
+  if (!blur)
+    return FALSE;
+
+  clutter_blur_apply (blur);
+
+  shadow_width = shadow->outer_border_left + extents.width +
+                 shadow->outer_border_right;
+  shadow_height = shadow->outer_border_top + extents.height +
+                  shadow->outer_border_bottom;
+
+  shadow_framebuffer = create_shadow_framebuffer (cogl_context,
+                                                  shadow_width, shadow_height,
+                                                  &shadow_texture,
+                                                  &error);
+  if (!shadow_framebuffer)
+    {
+      g_debug ("Failed to allocate shadow texture: %s", error->message);
+      clutter_blur_free (blur);
+      return FALSE;
+    }
+
+  copy_pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_static_name (copy_pipeline, "MetaShadowFactory (copy)");
+  cogl_pipeline_set_layer_texture (copy_pipeline, 0,
+                                   clutter_blur_get_texture (blur));
+  cogl_pipeline_set_blend (copy_pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+  /* The blurred texture may be downscaled, so crop it with normalized
+   * coordinates relative to the size of the mask */
+  src_x = (float) (spread - shadow->outer_border_left) / mask_width;
+  src_y = (float) (spread - shadow->outer_border_top) / mask_height;
+  cogl_framebuffer_draw_textured_rectangle (shadow_framebuffer, copy_pipeline,
+                                            0, 0,
+                                            shadow_width, shadow_height,
+                                            src_x, src_y,
+                                            src_x +
+                                            (float) shadow_width / mask_width,
+                                            src_y +
+                                            (float) shadow_height / mask_height);
+
+  if (shadow->key.top_fade > 0)
+    {
+      int fade_height = MIN (shadow->key.top_fade,
+                             extents.height + shadow->outer_border_bottom);
+
+      fade_shadow_top (shadow, cogl_context, shadow_framebuffer,
+                       shadow_width, fade_height);
+    }
+
+  clutter_blur_free (blur);
+
+  shadow->texture = g_steal_pointer (&shadow_texture);
+
+  return TRUE;
+}
+
+static void
+make_shadow_cpu (MetaShadow  *shadow,
+                 CoglContext *cogl_context,
+                 MtkRegion   *region)
 {
   GError *error = NULL;
   int d = get_box_filter_size (shadow->key.radius);
@@ -929,6 +1118,15 @@ make_shadow (MetaShadow  *shadow,
     }
 
   g_free (buffer);
+}
+
+static void
+make_shadow (MetaShadow  *shadow,
+             CoglContext *cogl_context,
+             MtkRegion   *region)
+{
+  if (!make_shadow_gpu (shadow, cogl_context, region))
+    make_shadow_cpu (shadow, cogl_context, region);
 
   shadow->pipeline = meta_create_texture_pipeline (cogl_context, shadow->texture);
   cogl_pipeline_set_static_name (shadow->pipeline, "MetaShadowFactory");
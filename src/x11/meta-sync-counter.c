@@ -44,6 +44,15 @@ typedef struct
   int64_t frame_drawn_time;
 } FrameData;
 
+/* The EWMH allows clients one second to respond to a sync request; once
+ * a client has shown how fast it usually responds, we stop waiting for
+ * it well before that, so that a single stalled client doesn't hold up
+ * an interactive resize for a full second each time.
+ */
+#define MAX_SYNC_REQUEST_TIMEOUT_MS 1000
+#define MIN_SYNC_REQUEST_TIMEOUT_MS 250
+#define SYNC_REQUEST_TIMEOUT_LATENCY_FACTOR 4
+
 void
 meta_sync_counter_init (MetaSyncCounter *sync_counter,
                         MetaWindow      *window,
@@ -194,10 +203,19 @@ sync_request_timeout (gpointer data)
 
   sync_counter->sync_request_timeout_id = 0;
 
-  /* We have now waited for more than a second for the
-   * application to respond to the sync request
+  /* We have now waited for considerably longer than the application
+   * usually takes to respond to the sync request; back off so that
+   * the next request is given more time.
    */
   sync_counter->disabled = TRUE;
+  sync_counter->avg_latency_us =
+    MIN (sync_counter->avg_latency_us * 2,
+         MAX_SYNC_REQUEST_TIMEOUT_MS * G_USEC_PER_SEC / 1000);
+
+  meta_topic (META_DEBUG_RESIZING,
+              "%s did not respond to sync request in time, "
+              "resizing unsynchronized",
+              window->desc);
 
   /* Reset the wait serial, so we don't continue freezing
    * window updates
@@ -214,6 +232,48 @@ sync_request_timeout (gpointer data)
     meta_window_x11_check_update_resize (window);
 }
 
+static unsigned int
+get_sync_request_timeout_ms (MetaSyncCounter *sync_counter)
+{
+  int64_t timeout_ms;
+
+  if (sync_counter->n_responses == 0)
+    return MAX_SYNC_REQUEST_TIMEOUT_MS;
+
+  timeout_ms = (sync_counter->avg_latency_us *
+                SYNC_REQUEST_TIMEOUT_LATENCY_FACTOR) / 1000;
+
+  return (unsigned int) CLAMP (timeout_ms,
+                               MIN_SYNC_REQUEST_TIMEOUT_MS,
+                               MAX_SYNC_REQUEST_TIMEOUT_MS);
+}
+
+static void
+record_sync_request_latency (MetaSyncCounter *sync_counter)
+{
+  MetaWindow *window = sync_counter->window;
+  int64_t latency_us;
+
+  latency_us = g_get_monotonic_time () - sync_counter->sync_request_time_us;
+
+  /* Exponential moving average, weighing the new sample by 1/8 */
+  if (sync_counter->n_responses == 0)
+    sync_counter->avg_latency_us = latency_us;
+  else
+    sync_counter->avg_latency_us += (latency_us - sync_counter->avg_latency_us) / 8;
+
+  sync_counter->max_latency_us = MAX (sync_counter->max_latency_us, latency_us);
+  sync_counter->n_responses++;
+
+  meta_topic (META_DEBUG_RESIZING,
+              "%s responded to sync request in %" G_GINT64_FORMAT " us "
+              "(average %" G_GINT64_FORMAT " us, max %" G_GINT64_FORMAT " us)",
+              window->desc,
+              latency_us,
+              sync_counter->avg_latency_us,
+              sync_counter->max_latency_us);
+}
+
 void
 meta_sync_counter_send_request (MetaSyncCounter *sync_counter)
 {
@@ -260,13 +320,15 @@ meta_sync_counter_send_request (MetaSyncCounter *sync_counter)
   XSendEvent (x11_display->xdisplay,
 	      sync_counter->xwindow, False, 0, (XEvent*) &ev);
 
-  /* We give the window 1 sec to respond to _NET_WM_SYNC_REQUEST;
+  /* We give the window at most 1 sec to respond to _NET_WM_SYNC_REQUEST;
    * if this time expires, we consider the window unresponsive
    * and resize it unsynchonized.
    */
-  sync_counter->sync_request_timeout_id = g_timeout_add_once (1000,
-                                                              sync_request_timeout,
-                                                              sync_counter);
+  sync_counter->sync_request_time_us = g_get_monotonic_time ();
+  sync_counter->sync_request_timeout_id =
+    g_timeout_add_once (get_sync_request_timeout_ms (sync_counter),
+                        sync_request_timeout,
+                        sync_counter);
   g_source_set_name_by_id (sync_counter->sync_request_timeout_id,
                            "[mutter] sync_request_timeout");
 
@@ -297,6 +359,7 @@ meta_sync_counter_update (MetaSyncCounter *sync_counter,
       (!sync_counter->extended_sync_request_counter ||
        new_counter_value % 2 == 0))
     {
+      record_sync_request_latency (sync_counter);
       g_clear_handle_id (&sync_counter->sync_request_timeout_id,
                          g_source_remove);
     }
@@ -321,9 +384,11 @@ meta_sync_counter_update (MetaSyncCounter *sync_counter,
 
       description =
         g_strdup_printf ("sync request serial: %" G_GINT64_FORMAT ", "
-                         "needs frame drawn: %s",
+                         "needs frame drawn: %s, "
+                         "average latency: %" G_GINT64_FORMAT " us",
                          new_counter_value,
-                         needs_frame_drawn ? "yes" : "no");
+                         needs_frame_drawn ? "yes" : "no",
+                         sync_counter->avg_latency_us);
       COGL_TRACE_DESCRIBE (MetaWindowSyncRequestCounter, description);
     }
 #endif
@@ -37,6 +37,13 @@ typedef struct
   /* alarm monitoring client's _NET_WM_SYNC_REQUEST_COUNTER */
   XSyncAlarm sync_request_alarm;
 
+  /* Response latency of the client to _NET_WM_SYNC_REQUEST, used to
+   * pick how long to wait for it before resizing unsynchronized */
+  int64_t sync_request_time_us;
+  int64_t avg_latency_us;
+  int64_t max_latency_us;
+  unsigned int n_responses;
+
   int64_t frame_drawn_time;
   GList *frames;
 
@@ -1418,17 +1418,23 @@ meta_x11_display_new (MetaDisplay  *display,
   gboolean replace_current_wm;
   Atom wm_sn_atom;
   Atom wm_cm_atom;
-  char buf[128];
+  char wm_sn_name[32];
+  char wm_cm_name[32];
   guint32 timestamp;
   Atom atom_restart_helper;
   Window restart_helper_window = None;
   gboolean is_restart = FALSE;
 
-  /* A list of all atom names, so that we can intern them in one go. */
+  /* A list of all atom names, so that we can intern them in one go. The
+   * screen specific manager selections come last, after the atoms that
+   * are kept in MetaX11Display. */
   const char *atom_names[] = {
 #define item(x) #x,
 #include "x11/atomnames.h"
 #undef item
+    "_MUTTER_RESTART_HELPER",
+    wm_sn_name,
+    wm_cm_name,
   };
   Atom atoms[G_N_ELEMENTS(atom_names)];
 
@@ -1476,7 +1482,17 @@ meta_x11_display_new (MetaDisplay  *display,
 
   xscreen = ScreenOfDisplay (xdisplay, number);
 
-  atom_restart_helper = XInternAtom (xdisplay, "_MUTTER_RESTART_HELPER", False);
+  g_snprintf (wm_sn_name, sizeof (wm_sn_name), "WM_S%d", number);
+  g_snprintf (wm_cm_name, sizeof (wm_cm_name), "_NET_WM_CM_S%d", number);
+
+  meta_verbose ("Creating %d atoms", (int) G_N_ELEMENTS (atom_names));
+  XInternAtoms (xdisplay, (char **)atom_names, G_N_ELEMENTS (atom_names),
+                False, atoms);
+
+  atom_restart_helper = atoms[G_N_ELEMENTS (atom_names) - 3];
+  wm_sn_atom = atoms[G_N_ELEMENTS (atom_names) - 2];
+  wm_cm_atom = atoms[G_N_ELEMENTS (atom_names) - 1];
+
   restart_helper_window = XGetSelectionOwner (xdisplay, atom_restart_helper);
   if (restart_helper_window)
     {
@@ -1501,10 +1517,6 @@ meta_x11_display_new (MetaDisplay  *display,
   x11_display->default_xvisual = DefaultVisualOfScreen (xscreen);
   x11_display->default_depth = DefaultDepthOfScreen (xscreen);
 
-  meta_verbose ("Creating %d atoms", (int) G_N_ELEMENTS (atom_names));
-  XInternAtoms (xdisplay, (char **)atom_names, G_N_ELEMENTS (atom_names),
-                False, atoms);
-
   i = 0;
 #define item(x) x11_display->atom_##x = atoms[i++];
 #include "x11/atomnames.h"
@@ -1695,9 +1707,6 @@ meta_x11_display_new (MetaDisplay  *display,
     meta_dnd_init_xdnd (x11_display);
 #endif
 
-  sprintf (buf, "WM_S%d", number);
-
-  wm_sn_atom = XInternAtom (xdisplay, buf, False);
   new_wm_sn_owner = take_manager_selection (x11_display,
                                             xroot,
                                             wm_sn_atom,
@@ -1716,9 +1725,6 @@ meta_x11_display_new (MetaDisplay  *display,
   x11_display->wm_sn_atom = wm_sn_atom;
   x11_display->wm_sn_timestamp = timestamp;
 
-  g_snprintf (buf, sizeof (buf), "_NET_WM_CM_S%d", number);
-  wm_cm_atom = XInternAtom (x11_display->xdisplay, buf, False);
-
   x11_display->wm_cm_selection_window =
     take_manager_selection (x11_display, xroot, wm_cm_atom, timestamp,
                             replace_current_wm);
@@ -19,10 +19,21 @@
 
 #include "meta-x11-event-source.h"
 
+/* Events dropped while coalescing a batch are marked with this type,
+ * which X never uses for events since 0 and 1 are errors and replies */
+#define DROPPED_EVENT_TYPE 0
+
 typedef struct {
   GSource base;
   GPollFD event_poll_fd;
   Display *xdisplay;
+
+  /* The events read from the queue in one dispatch, reused between
+   * dispatches to avoid reallocating */
+  GArray *batch;
+  /* Maps a hash of the window and atom of PropertyNotify events in the
+   * batch to their index */
+  GHashTable *property_events;
 } MetaX11EventSource;
 
 static gboolean
@@ -47,6 +58,95 @@ meta_x11_event_source_check (GSource *source)
          XEventsQueued (event_source->xdisplay, QueuedAlready) > 0;
 }
 
+static unsigned int
+hash_property_event (const XPropertyEvent *xproperty)
+{
+  return (unsigned int) (xproperty->window * 31 + xproperty->atom);
+}
+
+/* Adds an event to the batch, dropping events the new one makes
+ * redundant. Handlers look at the current state of the window rather
+ * than the state carried by these events, so only the most recent of
+ * them needs handling:
+ *
+ *  - a ConfigureNotify directly following a ConfigureNotify for the
+ *    same window replaces it. Only consecutive ones are merged, as the
+ *    stack tracker applies the sibling of each configure relative to
+ *    the events around it.
+ *  - a PropertyNotify for a window and atom that already changed
+ *    earlier in the batch drops the earlier one.
+ */
+static void
+add_to_batch (MetaX11EventSource *event_source,
+              const XEvent       *xevent)
+{
+  GArray *batch = event_source->batch;
+
+  if (xevent->type == ConfigureNotify && batch->len > 0)
+    {
+      XEvent *last = &g_array_index (batch, XEvent, batch->len - 1);
+
+      if (last->type == ConfigureNotify &&
+          last->xconfigure.send_event == xevent->xconfigure.send_event &&
+          last->xconfigure.event == xevent->xconfigure.event &&
+          last->xconfigure.window == xevent->xconfigure.window)
+        {
+          *last = *xevent;
+          return;
+        }
+    }
+  else if (xevent->type == PropertyNotify)
+    {
+      gpointer key = GUINT_TO_POINTER (hash_property_event (&xevent->xproperty));
+      gpointer index;
+
+      if (g_hash_table_lookup_extended (event_source->property_events,
+                                        key, NULL, &index))
+        {
+          XEvent *earlier =
+            &g_array_index (batch, XEvent, GPOINTER_TO_UINT (index));
+
+          if (earlier->type == PropertyNotify &&
+              earlier->xproperty.window == xevent->xproperty.window &&
+              earlier->xproperty.atom == xevent->xproperty.atom)
+            earlier->type = DROPPED_EVENT_TYPE;
+        }
+
+      g_hash_table_insert (event_source->property_events,
+                           key, GUINT_TO_POINTER (batch->len));
+    }
+
+  g_array_append_val (batch, *xevent);
+}
+
+/* Reads up to @max_events queued events into the batch. Generic events
+ * are never batched, because the data of their cookies only stays valid
+ * until the next event is read; instead they are handled on their own as
+ * soon as they reach the front of the queue. */
+static void
+fill_batch (MetaX11EventSource *event_source,
+            int                 max_events)
+{
+  Display *xdisplay = event_source->xdisplay;
+  int i;
+
+  for (i = 0; i < max_events; i++)
+    {
+      XEvent xevent;
+
+      /* Handlers may have pulled events out of the queue themselves */
+      if (XEventsQueued (xdisplay, QueuedAlready) == 0)
+        break;
+
+      XPeekEvent (xdisplay, &xevent);
+      if (xevent.type == GenericEvent)
+        break;
+
+      XNextEvent (xdisplay, &xevent);
+      add_to_batch (event_source, &xevent);
+    }
+}
+
 static gboolean
 meta_x11_event_source_dispatch (GSource     *source,
                                 GSourceFunc  callback,
@@ -54,6 +154,7 @@ meta_x11_event_source_dispatch (GSource     *source,
 {
   MetaX11EventSource *event_source = (MetaX11EventSource *) source;
   MetaX11EventFunc event_func = (MetaX11EventFunc) callback;
+  GArray *batch = event_source->batch;
   gboolean retval = G_SOURCE_CONTINUE;
   int pending;
 
@@ -61,21 +162,57 @@ meta_x11_event_source_dispatch (GSource     *source,
 
   while (retval == G_SOURCE_CONTINUE && pending > 0)
     {
-      XEvent xevent;
+      unsigned int i;
+
+      fill_batch (event_source, pending);
+
+      if (batch->len == 0)
+        {
+          XEvent xevent;
+
+          if (XEventsQueued (event_source->xdisplay, QueuedAlready) == 0)
+            break;
 
-      pending--;
+          pending--;
 
-      XNextEvent (event_source->xdisplay, &xevent);
-      retval = event_func (&xevent, user_data);
+          XNextEvent (event_source->xdisplay, &xevent);
+          retval = event_func (&xevent, user_data);
+          continue;
+        }
+
+      pending -= batch->len;
+      g_hash_table_remove_all (event_source->property_events);
+
+      for (i = 0; i < batch->len && retval == G_SOURCE_CONTINUE; i++)
+        {
+          XEvent *xevent = &g_array_index (batch, XEvent, i);
+
+          if (xevent->type == DROPPED_EVENT_TYPE)
+            continue;
+
+          retval = event_func (xevent, user_data);
+        }
+
+      g_array_set_size (batch, 0);
     }
 
   return retval;
 }
 
+static void
+meta_x11_event_source_finalize (GSource *source)
+{
+  MetaX11EventSource *event_source = (MetaX11EventSource *) source;
+
+  g_clear_pointer (&event_source->batch, g_array_unref);
+  g_clear_pointer (&event_source->property_events, g_hash_table_unref);
+}
+
 static GSourceFuncs meta_x11_event_source_funcs = {
   meta_x11_event_source_prepare,
   meta_x11_event_source_check,
   meta_x11_event_source_dispatch,
+  meta_x11_event_source_finalize,
 };
 
 GSource *
@@ -90,6 +227,8 @@ meta_x11_event_source_new (Display *xdisplay)
 
   event_source = (MetaX11EventSource *) source;
   event_source->xdisplay = xdisplay;
+  event_source->batch = g_array_new (FALSE, FALSE, sizeof (XEvent));
+  event_source->property_events = g_hash_table_new (NULL, NULL);
   event_source->event_poll_fd.fd = ConnectionNumber (xdisplay);
   event_source->event_poll_fd.events = G_IO_IN;
   g_source_add_poll (source, &event_source->event_poll_fd);
@@ -26,6 +26,11 @@
 #include "mtk/mtk-x11.h"
 #include "x11/meta-x11-display-private.h"
 
+/* Stop acknowledging INCR chunks while this much data hasn't been read
+ * yet, so the selection owner only sends more as the reader catches up.
+ */
+#define MAX_QUEUED_SIZE (1024 * 1024)
+
 typedef struct MetaX11SelectionInputStreamPrivate MetaX11SelectionInputStreamPrivate;
 
 struct _MetaX11SelectionInputStream
@@ -38,6 +43,7 @@ struct MetaX11SelectionInputStreamPrivate
   MetaX11Display *x11_display;
   Window window;
   GAsyncQueue *chunks;
+  size_t queued_size;
   Atom xselection;
   Atom xtarget;
   Atom xproperty;
@@ -49,6 +55,7 @@ struct MetaX11SelectionInputStreamPrivate
 
   guint complete : 1;
   guint incr : 1;
+  guint ack_pending : 1;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaX11SelectionInputStream,
@@ -115,23 +122,65 @@ meta_x11_selection_input_stream_fill_buffer (MetaX11SelectionInputStream *stream
   if (bytes)
     g_async_queue_push_front_unlocked (priv->chunks, bytes);
 
+  priv->queued_size -= result;
+
   g_async_queue_unlock (priv->chunks);
 
   return result;
 }
 
 static void
-meta_x11_selection_input_stream_flush (MetaX11SelectionInputStream *stream)
+meta_x11_selection_input_stream_push (MetaX11SelectionInputStream *stream,
+                                      GBytes                      *bytes)
 {
   MetaX11SelectionInputStreamPrivate *priv =
     meta_x11_selection_input_stream_get_instance_private (stream);
-  Display *xdisplay = priv->x11_display->xdisplay;
-  gssize written;
 
+  g_async_queue_lock (priv->chunks);
+  priv->queued_size += g_bytes_get_size (bytes);
+  g_async_queue_push_unlocked (priv->chunks, bytes);
+  g_async_queue_unlock (priv->chunks);
+}
+
+/* Deleting the property is what makes the selection owner send the next
+ * INCR chunk, so hold off while the reader hasn't caught up.
+ */
+static void
+meta_x11_selection_input_stream_maybe_ack (MetaX11SelectionInputStream *stream)
+{
+  MetaX11SelectionInputStreamPrivate *priv =
+    meta_x11_selection_input_stream_get_instance_private (stream);
+  Display *xdisplay;
+  size_t queued_size;
+
+  if (!priv->ack_pending || !priv->x11_display)
+    return;
+
+  g_async_queue_lock (priv->chunks);
+  queued_size = priv->queued_size;
+  g_async_queue_unlock (priv->chunks);
+
+  if (!priv->complete && queued_size >= MAX_QUEUED_SIZE)
+    return;
+
+  xdisplay = priv->x11_display->xdisplay;
   mtk_x11_error_trap_push (xdisplay);
   XDeleteProperty (xdisplay, priv->window, priv->xproperty);
   mtk_x11_error_trap_pop (xdisplay);
 
+  priv->ack_pending = FALSE;
+}
+
+static void
+meta_x11_selection_input_stream_flush (MetaX11SelectionInputStream *stream)
+{
+  MetaX11SelectionInputStreamPrivate *priv =
+    meta_x11_selection_input_stream_get_instance_private (stream);
+  gssize written;
+
+  priv->ack_pending = TRUE;
+  meta_x11_selection_input_stream_maybe_ack (stream);
+
   if (!meta_x11_selection_input_stream_has_data (stream))
     return;
 
@@ -146,6 +195,8 @@ meta_x11_selection_input_stream_flush (MetaX11SelectionInputStream *stream)
   g_clear_object (&priv->pending_task);
   priv->pending_data = NULL;
   priv->pending_size = 0;
+
+  meta_x11_selection_input_stream_maybe_ack (stream);
 }
 
 static void
@@ -177,8 +228,12 @@ meta_x11_selection_input_stream_read (GInputStream  *input_stream,
 {
   MetaX11SelectionInputStream *stream =
     META_X11_SELECTION_INPUT_STREAM (input_stream);
+  size_t size;
 
-  return meta_x11_selection_input_stream_fill_buffer (stream, buffer, count);
+  size = meta_x11_selection_input_stream_fill_buffer (stream, buffer, count);
+  meta_x11_selection_input_stream_maybe_ack (stream);
+
+  return size;
 }
 
 static gboolean
@@ -215,6 +270,8 @@ meta_x11_selection_input_stream_read_async (GInputStream        *input_stream,
       size = meta_x11_selection_input_stream_fill_buffer (stream, buffer, count);
       g_task_return_int (task, size);
       g_object_unref (task);
+
+      meta_x11_selection_input_stream_maybe_ack (stream);
     }
   else
     {
@@ -442,7 +499,7 @@ meta_x11_selection_input_stream_xevent (MetaX11SelectionInputStream *stream,
         }
       else
         {
-          g_async_queue_push (priv->chunks, bytes);
+          meta_x11_selection_input_stream_push (stream, bytes);
           meta_x11_selection_input_stream_flush (stream);
         }
       return FALSE;
@@ -499,7 +556,7 @@ meta_x11_selection_input_stream_xevent (MetaX11SelectionInputStream *stream,
                   }
                 else
                   {
-                    g_async_queue_push (priv->chunks, bytes);
+                    meta_x11_selection_input_stream_push (stream, bytes);
 
                     meta_x11_selection_input_stream_complete (stream);
                   }
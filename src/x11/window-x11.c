@@ -4031,27 +4031,155 @@ wm_state_to_string (int state)
 }
 #endif
 
-MetaWindow *
-meta_window_x11_new (MetaDisplay       *display,
-                     Window             xwindow,
-                     gboolean           must_be_viewable,
-                     MetaCompEffect     effect)
+/* Everything needed to decide whether to manage a window, requested up
+ * front so that the replies for several windows arrive in a single round
+ * trip, instead of XGetWindowAttributes() and the WM_STATE lookup each
+ * waiting for the server in turn */
+typedef struct _MetaX11WindowQuery
+{
+  Window xwindow;
+  gboolean query_wm_state;
+
+  xcb_get_window_attributes_cookie_t attributes_cookie;
+  xcb_get_geometry_cookie_t geometry_cookie;
+  xcb_get_property_cookie_t wm_state_cookie;
+} MetaX11WindowQuery;
+
+static void
+send_window_query (MetaX11Display     *x11_display,
+                   MetaX11WindowQuery *query,
+                   Window              xwindow,
+                   gboolean            query_wm_state)
+{
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+
+  query->xwindow = xwindow;
+  query->query_wm_state = query_wm_state;
+  query->attributes_cookie = xcb_get_window_attributes (xcb_conn, xwindow);
+  query->geometry_cookie = xcb_get_geometry (xcb_conn, xwindow);
+
+  if (query_wm_state)
+    {
+      query->wm_state_cookie = xcb_get_property (xcb_conn, FALSE, xwindow,
+                                                 x11_display->atom_WM_STATE,
+                                                 x11_display->atom_WM_STATE,
+                                                 0, 1);
+    }
+}
+
+static void
+fill_window_attributes (MetaX11Display                    *x11_display,
+                        xcb_get_window_attributes_reply_t *attributes_reply,
+                        xcb_get_geometry_reply_t          *geometry_reply,
+                        XWindowAttributes                 *attrs)
+{
+  Display *xdisplay = x11_display->xdisplay;
+  int i;
+
+  /* The same translation XGetWindowAttributes() does */
+  *attrs = (XWindowAttributes) {
+    .x = geometry_reply->x,
+    .y = geometry_reply->y,
+    .width = geometry_reply->width,
+    .height = geometry_reply->height,
+    .border_width = geometry_reply->border_width,
+    .depth = geometry_reply->depth,
+    .visual = _XVIDtoVisual (xdisplay, attributes_reply->visual),
+    .root = geometry_reply->root,
+    .class = attributes_reply->_class,
+    .bit_gravity = attributes_reply->bit_gravity,
+    .win_gravity = attributes_reply->win_gravity,
+    .backing_store = attributes_reply->backing_store,
+    .backing_planes = attributes_reply->backing_planes,
+    .backing_pixel = attributes_reply->backing_pixel,
+    .save_under = attributes_reply->save_under,
+    .colormap = attributes_reply->colormap,
+    .map_installed = attributes_reply->map_is_installed,
+    .map_state = attributes_reply->map_state,
+    .all_event_masks = attributes_reply->all_event_masks,
+    .your_event_mask = attributes_reply->your_event_mask,
+    .do_not_propagate_mask = attributes_reply->do_not_propagate_mask,
+    .override_redirect = attributes_reply->override_redirect,
+  };
+
+  for (i = 0; i < ScreenCount (xdisplay); i++)
+    {
+      if (RootWindow (xdisplay, i) == attrs->root)
+        {
+          attrs->screen = ScreenOfDisplay (xdisplay, i);
+          break;
+        }
+    }
+}
+
+/* Collects the replies of the query. When not returning FALSE, @wm_state
+ * is set to the WM_STATE of the window if it was queried and is valid,
+ * or to WithdrawnState */
+static gboolean
+collect_window_query (MetaX11Display     *x11_display,
+                      MetaX11WindowQuery *query,
+                      XWindowAttributes  *attrs,
+                      gboolean           *has_wm_state,
+                      uint32_t           *wm_state)
+{
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  g_autofree xcb_get_window_attributes_reply_t *attributes_reply = NULL;
+  g_autofree xcb_get_geometry_reply_t *geometry_reply = NULL;
+  g_autofree xcb_get_property_reply_t *wm_state_reply = NULL;
+  g_autofree xcb_generic_error_t *attributes_error = NULL;
+  g_autofree xcb_generic_error_t *geometry_error = NULL;
+  g_autofree xcb_generic_error_t *wm_state_error = NULL;
+
+  attributes_reply = xcb_get_window_attributes_reply (xcb_conn,
+                                                      query->attributes_cookie,
+                                                      &attributes_error);
+  geometry_reply = xcb_get_geometry_reply (xcb_conn,
+                                           query->geometry_cookie,
+                                           &geometry_error);
+
+  *has_wm_state = FALSE;
+  *wm_state = WithdrawnState;
+
+  if (query->query_wm_state)
+    {
+      wm_state_reply = xcb_get_property_reply (xcb_conn,
+                                               query->wm_state_cookie,
+                                               &wm_state_error);
+
+      /* WM_STATE isn't a cardinal, it's type WM_STATE, but is an int */
+      if (wm_state_reply &&
+          wm_state_reply->type == x11_display->atom_WM_STATE &&
+          wm_state_reply->format == 32 &&
+          xcb_get_property_value_length (wm_state_reply) >= 4)
+        {
+          *has_wm_state = TRUE;
+          *wm_state = *(uint32_t *) xcb_get_property_value (wm_state_reply);
+        }
+    }
+
+  if (!attributes_reply || !geometry_reply)
+    return FALSE;
+
+  fill_window_attributes (x11_display, attributes_reply, geometry_reply, attrs);
+
+  return TRUE;
+}
+
+static MetaWindow *
+manage_queried_xwindow (MetaDisplay        *display,
+                        MetaX11WindowQuery *query,
+                        gboolean            must_be_viewable,
+                        MetaCompEffect      effect)
 {
   MetaX11Display *x11_display = display->x11_display;
+  Window xwindow = query->xwindow;
   XWindowAttributes attrs;
+  gboolean has_wm_state;
+  uint32_t wm_state;
   gulong existing_wm_state;
   MetaWindow *window = NULL;
   gulong event_mask;
 
-  meta_verbose ("Attempting to manage 0x%lx", xwindow);
-
-  if (meta_x11_display_xwindow_is_a_no_focus_window (x11_display, xwindow))
-    {
-      meta_verbose ("Not managing no_focus_window 0x%lx",
-                    xwindow);
-      return NULL;
-    }
-
   mtk_x11_error_trap_push (x11_display->xdisplay); /* Push a trap over all of window
                                        * creation, to reduce XSync() calls
                                        */
@@ -4061,7 +4189,8 @@ meta_window_x11_new (MetaDisplay       *display,
    * so we must be careful with X error handling.
    */
 
-  if (!XGetWindowAttributes (x11_display->xdisplay, xwindow, &attrs))
+  if (!collect_window_query (x11_display, query,
+                             &attrs, &has_wm_state, &wm_state))
     {
       meta_verbose ("Failed to get attributes for window 0x%lx",
                     xwindow);
@@ -4096,21 +4225,15 @@ meta_window_x11_new (MetaDisplay       *display,
   if (must_be_viewable && attrs.map_state != IsViewable)
     {
       /* Only manage if WM_STATE is IconicState or NormalState */
-      uint32_t state;
-
-      /* WM_STATE isn't a cardinal, it's type WM_STATE, but is an int */
-      if (!(meta_prop_get_cardinal_with_atom_type (x11_display, xwindow,
-                                                   x11_display->atom_WM_STATE,
-                                                   x11_display->atom_WM_STATE,
-                                                   &state) &&
-            (state == IconicState || state == NormalState)))
+      if (!(has_wm_state &&
+            (wm_state == IconicState || wm_state == NormalState)))
         {
           meta_verbose ("Deciding not to manage unmapped or unviewable window 0x%lx",
                         xwindow);
           goto error;
         }
 
-      existing_wm_state = state;
+      existing_wm_state = wm_state;
       meta_verbose ("WM_STATE of %lx = %s", xwindow,
                     wm_state_to_string (existing_wm_state));
     }
@@ -4225,6 +4348,68 @@ error:
   return NULL;
 }
 
+static gboolean
+should_query_xwindow (MetaX11Display *x11_display,
+                      Window          xwindow)
+{
+  meta_verbose ("Attempting to manage 0x%lx", xwindow);
+
+  if (meta_x11_display_xwindow_is_a_no_focus_window (x11_display, xwindow))
+    {
+      meta_verbose ("Not managing no_focus_window 0x%lx",
+                    xwindow);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+MetaWindow *
+meta_window_x11_new (MetaDisplay       *display,
+                     Window             xwindow,
+                     gboolean           must_be_viewable,
+                     MetaCompEffect     effect)
+{
+  MetaX11Display *x11_display = display->x11_display;
+  MetaX11WindowQuery query;
+
+  if (!should_query_xwindow (x11_display, xwindow))
+    return NULL;
+
+  send_window_query (x11_display, &query, xwindow, must_be_viewable);
+
+  return manage_queried_xwindow (display, &query, must_be_viewable, effect);
+}
+
+/* Like meta_window_x11_new(), for several windows at once. The initial
+ * queries for all of them are sent before waiting for any reply. */
+void
+meta_window_x11_new_many (MetaDisplay    *display,
+                          const Window   *xwindows,
+                          int             n_xwindows,
+                          gboolean        must_be_viewable,
+                          MetaCompEffect  effect)
+{
+  MetaX11Display *x11_display = display->x11_display;
+  g_autofree MetaX11WindowQuery *queries = NULL;
+  int n_queries = 0;
+  int i;
+
+  queries = g_new0 (MetaX11WindowQuery, n_xwindows);
+
+  for (i = 0; i < n_xwindows; i++)
+    {
+      if (!should_query_xwindow (x11_display, xwindows[i]))
+        continue;
+
+      send_window_query (x11_display, &queries[n_queries++],
+                         xwindows[i], must_be_viewable);
+    }
+
+  for (i = 0; i < n_queries; i++)
+    manage_queried_xwindow (display, &queries[i], must_be_viewable, effect);
+}
+
 void
 meta_window_x11_recalc_window_type (MetaWindow *window)
 {
@@ -53,6 +53,12 @@ MetaWindow * meta_window_x11_new           (MetaDisplay        *display,
                                             gboolean            must_be_viewable,
                                             MetaCompEffect      effect);
 
+void meta_window_x11_new_many (MetaDisplay    *display,
+                               const Window   *xwindows,
+                               int             n_xwindows,
+                               gboolean        must_be_viewable,
+                               MetaCompEffect  effect);
+
 void meta_window_x11_set_net_wm_state            (MetaWindow *window);
 void meta_window_x11_set_wm_state                (MetaWindow *window);
 void meta_window_x11_set_wm_take_focus           (MetaWindow *window,
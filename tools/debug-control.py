@@ -77,6 +77,22 @@ def set_value(kv):
 
     debug_control.Set(INTERFACE, prop, value, dbus_interface=PROPS_IFACE)
 
+FRAME_KINDS = ['composited', 'composited-with-effects', 'direct-scanout',
+               'cursor-only']
+
+def frame_records():
+    debug_control = get_debug_control()
+    views = debug_control.GetFrameRecords(dbus_interface=INTERFACE)
+    for view, records in views.items():
+        print(f"{view}:")
+        for (frame_count, dispatch_time, cpu_duration, gpu_duration,
+             presentation_time, missed_vblank, kind) in records:
+            missed = " (missed vblank)" if missed_vblank else ""
+            print(f"  #{frame_count} {FRAME_KINDS[kind]}: "
+                  f"dispatched {dispatch_time} µs, cpu {cpu_duration} µs, "
+                  f"gpu {gpu_duration} µs, "
+                  f"presented {presentation_time} µs{missed}")
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser(description='Get and set debug state')
 
@@ -85,6 +101,7 @@ if __name__ == '__main__':
     parser.add_argument('--disable', metavar='PROPERTY', type=str, nargs='?')
     parser.add_argument('--toggle', metavar='PROPERTY', type=str, nargs='?')
     parser.add_argument('--set', metavar='PROPERTY', type=str, nargs=2)
+    parser.add_argument('--frame-records', action='store_true')
 
     args = parser.parse_args()
     if args.status:
@@ -97,5 +114,7 @@ if __name__ == '__main__':
         toggle(args.toggle)
     elif args.set:
         set_value(args.set)
+    elif args.frame_records:
+        frame_records()
     else:
         parser.print_usage()